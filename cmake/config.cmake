@@ -112,6 +112,13 @@ set(USE_SPIRV_KHR_INTEGER_DOT_PRODUCT OFF)
 # Whether enable RPC runtime
 set(USE_RPC ON)
 
+# Whether to compress the large tensor copies of the RPC with zstd
+# Possible values:
+# - ON: enable zstd with cmake's find search
+# - OFF: disable zstd
+# - /path/to/zstd: the installation directory of zstd
+set(USE_ZSTD OFF)
+
 # Whether to build the C++ RPC server binary
 set(USE_CPP_RPC OFF)
 
@@ -291,6 +298,13 @@ set(TVM_FFI_BACKTRACE_ON_SEGFAULT ON)
 # predefined variables to specify the path to the GTest package if needed.
 set(USE_GTEST AUTO)
 
+# Whether to build the `tvm_runtime_bench` target with Google Benchmark.
+# Possible values:
+# - ON: the package `benchmark` will be required for CMake to succeed.
+# - OFF: disable the benchmarks.
+# - AUTO: build the benchmarks if the package `benchmark` is found.
+set(USE_GBENCH AUTO)
+
 # Enable using CUTLASS as a BYOC backend
 # Need to have USE_CUDA=ON
 set(USE_CUTLASS OFF)
@@ -293,6 +293,7 @@ if(USE_HEXAGON_RPC)
       "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/minrpc/minrpc_server.h"
       "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/minrpc/rpc_reference.h"
       "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/rpc_module.cc"
+      "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/rpc_compression.cc"
       "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/rpc_endpoint.cc"
       "${TVM_CORE_RUNTIME_SOURCE_DIR}/rpc/rpc_session.cc"
       # TODO(masahi): Remove rpc_local_session.cc after verifying that things work without it
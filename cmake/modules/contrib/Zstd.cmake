@@ -0,0 +1,39 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# src/runtime/rpc/rpc_compression.cc is always part of the RPC sources. It only
+# offers the zstd codec when the TVM_USE_ZSTD macro is defined below.
+if(NOT USE_RPC OR ${USE_ZSTD} MATCHES ${IS_FALSE_PATTERN})
+  return()
+endif()
+
+if(${USE_ZSTD} MATCHES ${IS_TRUE_PATTERN})
+  find_path(ZSTD_INCLUDE_DIR zstd.h)
+  find_library(ZSTD_LIBRARY NAMES zstd)
+else()
+  find_path(ZSTD_INCLUDE_DIR zstd.h HINTS ${USE_ZSTD}/include NO_DEFAULT_PATH)
+  find_library(ZSTD_LIBRARY NAMES zstd HINTS ${USE_ZSTD}/lib NO_DEFAULT_PATH)
+endif()
+
+if(NOT ZSTD_INCLUDE_DIR OR NOT ZSTD_LIBRARY)
+  message(FATAL_ERROR "USE_ZSTD is ${USE_ZSTD}, but zstd was not found.")
+endif()
+
+message(STATUS "Build with zstd compression of RPC copies: ${ZSTD_LIBRARY}")
+include_directories(SYSTEM ${ZSTD_INCLUDE_DIR})
+add_definitions(-DTVM_USE_ZSTD=1)
+list(APPEND TVM_RUNTIME_LINKER_LIBS ${ZSTD_LIBRARY})
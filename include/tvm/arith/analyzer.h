@@ -410,6 +410,18 @@ class RewriteSimplifier {
    */
   TVM_DLL void SetMaximumRewriteSteps(int64_t maximum);
 
+  /*! \brief Set the number of top-level results kept in the memo table
+   *
+   * By default, the memo table is disabled.  If a positive size is
+   * set, the result of each top-level simplification is memoized,
+   * keyed by the structure of the expression and the state version
+   * of the analyzer, and the same expression simplified again under
+   * the same facts and constraints reuses the result.  The table is
+   * cleared once it holds `size` entries.  The `memo_hits` and
+   * `memo_misses` usage counters report its effectiveness.
+   */
+  TVM_DLL void SetMemoTableSize(int64_t size);
+
  private:
   friend class AnalyzerObj;
   friend class ConstraintContext;
@@ -443,6 +455,13 @@ class CanonicalSimplifier {
    */
   TVM_DLL void Update(const Var& var, const PrimExpr& new_expr, bool allow_override = false);
 
+  /*!
+   * \brief Set the number of top-level results kept in the memo table.
+   * \param size The maximum number of entries, a non-positive size disables the table.
+   * \sa RewriteSimplifier::SetMemoTableSize
+   */
+  TVM_DLL void SetMemoTableSize(int64_t size);
+
  private:
   friend class AnalyzerObj;
   friend class ConstraintContext;
@@ -883,6 +902,22 @@ class TVM_DLL AnalyzerObj : public ffi::Object {
    * \return A new Analyzer holding an independent copy of the facts.
    */
   Analyzer Clone() const;
+  /*!
+   * \brief The version of the facts and constraints known to the analyzer.
+   *
+   *  The version changes whenever a binding or a constraint scope changes what the
+   *  analyzer knows, and returns to its earlier value when a constraint scope exits
+   *  without any binding made inside it. Memoized results that depend on the known
+   *  facts can therefore be keyed by the version.
+   */
+  uint64_t state_version() const { return state_version_; }
+  /*!
+   * \brief Move the analyzer to a new state version.
+   *
+   *  Call this after updating a sub-analyzer directly, so that the memoized results
+   *  of the other sub-analyzers are not reused.
+   */
+  void BumpStateVersion() { state_version_ = ++last_state_version_; }
 
   /*!
    * \brief Analyzer methods update facts, constraints, caches, and stats.
@@ -895,6 +930,13 @@ class TVM_DLL AnalyzerObj : public ffi::Object {
    */
   static constexpr bool _type_mutable = true;
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("arith.Analyzer", AnalyzerObj, ffi::Object);
+
+ private:
+  friend class ConstraintContext;
+  /*! \brief The current state version */
+  uint64_t state_version_{0};
+  /*! \brief The last state version handed out */
+  uint64_t last_state_version_{0};
 };
 
 /*!
@@ -986,6 +1028,10 @@ class ConstraintContext {
   std::vector<std::function<void()>> recovery_functions_;
   /*! \brief Whether the constraint comes from an assumption. */
   bool is_assume_;
+  /*! \brief The state version of the analyzer before entering the scope. */
+  uint64_t outer_state_version_{0};
+  /*! \brief The state version of the analyzer inside the scope. */
+  uint64_t inner_state_version_{0};
 };
 
 }  // namespace arith
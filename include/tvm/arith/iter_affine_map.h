@@ -321,6 +321,29 @@ IterMapResult DetectIterMap(const ffi::Array<PrimExpr>& indices,
                             const arith::Analyzer& analyzer,
                             bool simplify_trivial_iterators = true);
 
+/*!
+ * \brief Detect the iter map of several index lists over the same input iterators.
+ *
+ *  The result of each list is the same as DetectIterMap on it, while the predicate is parsed
+ *  and its constraints are rewritten only once for all of them.
+ *
+ * \param indices_list The index lists to detect pattern for.
+ * \param input_iters Map from variable to iterator's range.
+ * \param predicate The predicate constraints on the input iterators
+ * \param check_level The iter mapping checking level.
+ * \param analyzer Analyzer used to get context information.
+ * \param simplify_trivial_iterators If true, iterators with extent of
+ *           1 will be replaced with a constant value.
+ *
+ * \return The detected iteration result of each index list.
+ * \sa DetectIterMap
+ */
+ffi::Array<IterMapResult> DetectIterMapBatch(
+    const ffi::Array<ffi::Array<PrimExpr>>& indices_list,
+    const ffi::Map<tirx::PrimVar, Range>& input_iters, const PrimExpr& predicate,
+    IterMapLevel check_level, const arith::Analyzer& analyzer,
+    bool simplify_trivial_iterators = true);
+
 /*!
  * \brief Use IterVarMap detector to rewrite and simplify the indices
  *
@@ -26,9 +26,12 @@
 #ifndef TVM_IR_INSTRUMENT_H_
 #define TVM_IR_INSTRUMENT_H_
 
+#include <tvm/ffi/container/array.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/ffi/string.h>
+#include <tvm/runtime/base.h>
 
+#include <chrono>
 #include <utility>
 #include <vector>
 
@@ -152,6 +155,38 @@ class PassInstrument : public ffi::ObjectRef {
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(PassInstrument, ffi::ObjectRef, PassInstrumentNode);
 };
 
+/*!
+ * \brief The scope of the work of a function pass on one function.
+ *
+ * A function pass opens the scope around each function it transforms. The profiling
+ * instruments among the instruments of the pass context that break passes down per function
+ * record the time spent in the scope under the running pass, and the scope is a no-op when there
+ * are none.
+ */
+class FunctionPassProfileScope {
+ public:
+  /*!
+   * \brief Enter the scope.
+   * \param instruments The instruments of the pass context.
+   * \param func_name The name of the function.
+   */
+  TVM_DLL FunctionPassProfileScope(const ffi::Array<PassInstrument>& instruments,
+                                   ffi::String func_name);
+  /*! \brief Exit the scope, recording its time to the profiling instruments. */
+  TVM_DLL ~FunctionPassProfileScope();
+
+  FunctionPassProfileScope(const FunctionPassProfileScope&) = delete;
+  FunctionPassProfileScope& operator=(const FunctionPassProfileScope&) = delete;
+
+ private:
+  /*! \brief The profiling instruments recording the scope. */
+  std::vector<PassInstrument> profilers_;
+  /*! \brief The name of the function. */
+  ffi::String func_name_;
+  /*! \brief The time when the scope was entered. */
+  std::chrono::steady_clock::time_point start_;
+};
+
 }  // namespace instrument
 }  // namespace tvm
 
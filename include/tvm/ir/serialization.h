@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/ir/serialization.h
+ * \brief The compact binary serialization of IR nodes.
+ *
+ * The binary form covers the same objects as the JSON graph of ffi::ToJSONGraph: the objects
+ * registered with reflection, the containers, the strings and the tensors, as well as the
+ * types with `__data_to_json__` and `__data_from_json__` hooks. Each string is stored once,
+ * an object reachable through several paths is stored once and shared again on load, and the
+ * field names of each type are stored once for all of its objects.
+ */
+#ifndef TVM_IR_SERIALIZATION_H_
+#define TVM_IR_SERIALIZATION_H_
+
+#include <tvm/ffi/any.h>
+#include <tvm/runtime/base.h>
+
+#include <string>
+#include <string_view>
+
+namespace tvm {
+
+/*!
+ * \brief Save an object graph in the binary form.
+ * \param node The root of the graph.
+ * \return The serialized bytes.
+ */
+TVM_DLL std::string SaveBinary(const ffi::Any& node);
+
+/*!
+ * \brief Load an object graph saved by SaveBinary.
+ * \param data The serialized bytes.
+ * \return The root of the graph.
+ */
+TVM_DLL ffi::Any LoadBinary(std::string_view data);
+
+}  // namespace tvm
+
+#endif  // TVM_IR_SERIALIZATION_H_
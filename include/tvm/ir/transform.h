@@ -236,6 +236,25 @@ class PassContext : public ffi::ObjectRef {
    */
   TVM_DLL bool PassEnabled(const PassInfo& info) const;
 
+  /*!
+   * \brief Make a pass context current on a worker thread while in scope.
+   *
+   *  A pass that runs part of its work on other threads uses this scope on each of them,
+   *  so that `PassContext::Current()` returns the context of the pass. Unlike entering the
+   *  context with `With<PassContext>`, the instruments are not called, since the context
+   *  is already entered on the thread that runs the pass.
+   */
+  class WorkerScope {
+   public:
+    TVM_DLL explicit WorkerScope(PassContext pass_ctx);
+    TVM_DLL ~WorkerScope();
+    WorkerScope(const WorkerScope&) = delete;
+    WorkerScope& operator=(const WorkerScope&) = delete;
+
+   private:
+    PassContext pass_ctx_;
+  };
+
   /*!
    * \brief Register a valid configuration option and its ValueType for validation.
    *
@@ -379,6 +398,62 @@ class PassInfo : public ffi::ObjectRef {
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(PassInfo, ffi::ObjectRef, PassInfoNode);
 };
 
+/*!
+ * \brief A persistent cache of the results of a function-level pass.
+ *
+ *  The cache is enabled by the `ir.pass_cache_dir` option of the pass context. It maps the
+ *  pass name, the pass configuration and the structure of an input function to the output
+ *  function, with one file per entry in that directory. It is only valid for passes whose
+ *  output depends on nothing but the input function and the pass context.
+ */
+class PassCache {
+ public:
+  /*! \brief A disabled cache. */
+  PassCache() = default;
+  /*!
+   * \brief Prepare the cache for one run of a pass.
+   * \param pass_ctx The pass context of the run.
+   * \param pass_info The pass information.
+   */
+  TVM_DLL PassCache(const PassContext& pass_ctx, const PassInfo& pass_info);
+
+  /*! \brief Whether the cache is enabled. */
+  bool enabled() const { return !cache_dir_.empty(); }
+
+  /*!
+   * \brief Look up the output of the pass on func.
+   * \param func The input function.
+   * \param key The key of func, to be passed to Insert on a miss.
+   * \return The cached output, or std::nullopt on a miss.
+   */
+  TVM_DLL ffi::Optional<BaseFunc> Lookup(const BaseFunc& func, uint64_t* key) const;
+
+  /*!
+   * \brief Store the output of the pass on func.
+   * \param key The key of func returned by Lookup.
+   * \param func The input function.
+   * \param result The output function.
+   */
+  TVM_DLL void Insert(uint64_t key, const BaseFunc& func, const BaseFunc& result) const;
+
+  /*! \brief The lookups and hits of each pass since the last ResetStats. */
+  TVM_DLL static ffi::Map<ffi::String, ffi::Array<int64_t>> Stats();
+
+  /*! \brief Reset the lookup and hit counters. */
+  TVM_DLL static void ResetStats();
+
+ private:
+  /*! \brief The path of the entry file of key. */
+  std::string EntryPath(uint64_t key) const;
+
+  /*! \brief The cache directory, empty when the cache is disabled */
+  std::string cache_dir_;
+  /*! \brief The name of the pass */
+  std::string pass_name_;
+  /*! \brief The hash of the pass name and the pass configuration */
+  uint64_t pass_key_{0};
+};
+
 /*!
  * \brief PassNode is the base type of differnt types of optimization passes.
  * It is designed as a pure class and implemented by different pass subclasses
@@ -66,6 +66,28 @@ struct AllGatherAttrs : public tvm::AttrsNode {
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.AllGatherAttrs", AllGatherAttrs, AttrsNode);
 };  // struct AllGatherAttrs
 
+/*! \brief Attributes used in reducescatter operators */
+struct ReduceScatterAttrs : public tvm::AttrsNode {
+  ffi::String op_type;
+  int num_workers;
+  bool in_group;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<ReduceScatterAttrs>()
+        .def_ro("op_type", &ReduceScatterAttrs::op_type,
+                "The type of reduction operation to be applied to the input data.")
+        .def_ro("num_workers", &ReduceScatterAttrs::num_workers,
+                "The number of workers, also the number of parts the reduced buffer is chunked "
+                "into along axis 0.")
+        .def_ro("in_group", &ReduceScatterAttrs::in_group,
+                "Whether the reducescatter operation performs in group or globally or in group "
+                "as default.");
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.ReduceScatterAttrs", ReduceScatterAttrs,
+                                    AttrsNode);
+};  // struct ReduceScatterAttrs
+
 /*! \brief Attributes used in scatter operators */
 struct ScatterCollectiveAttrs : public tvm::AttrsNode {
   int num_workers;
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file tvm/relax/attrs/moe.h
+ * \brief Attributes for Mixture-of-Experts operators.
+ */
+#ifndef TVM_RELAX_ATTRS_MOE_H_
+#define TVM_RELAX_ATTRS_MOE_H_
+
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/expr.h>
+
+namespace tvm {
+namespace relax {
+
+/*! \brief Attributes used in moe.topk_gating operator */
+struct MoETopKGatingAttrs : public AttrsNode {
+  int top_k;
+  bool normalize;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<MoETopKGatingAttrs>()
+        .def_ro("top_k", &MoETopKGatingAttrs::top_k, "The number of experts of each token.")
+        .def_ro("normalize", &MoETopKGatingAttrs::normalize,
+                "Whether the weights of the experts of each token are normalized to sum to 1.",
+                refl::DefaultValue(true));
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.MoETopKGatingAttrs", MoETopKGatingAttrs,
+                                    AttrsNode);
+};  // struct MoETopKGatingAttrs
+
+/*! \brief Attributes used in moe.permute operator */
+struct MoEPermuteAttrs : public AttrsNode {
+  int num_experts;
+  int capacity;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<MoEPermuteAttrs>()
+        .def_ro("num_experts", &MoEPermuteAttrs::num_experts, "The number of experts.")
+        .def_ro("capacity", &MoEPermuteAttrs::capacity,
+                "The number of rows of each expert, 0 for packing the rows of all tokens. "
+                "The rows beyond the capacity of an expert are dropped, and the unused rows are "
+                "filled with zeros.",
+                refl::DefaultValue(0));
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.MoEPermuteAttrs", MoEPermuteAttrs, AttrsNode);
+};  // struct MoEPermuteAttrs
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_ATTRS_MOE_H_
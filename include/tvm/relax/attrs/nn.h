@@ -710,6 +710,20 @@ struct NLLLossAttrs : public AttrsNode {
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.NLLLossAttrs", NLLLossAttrs, AttrsNode);
 };  // struct NLLLossAttrs
 
+/*! \brief Attributes used in embedding_bag operator */
+struct EmbeddingBagAttrs : public AttrsNode {
+  ffi::String mode;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<EmbeddingBagAttrs>().def_ro(
+        "mode", &EmbeddingBagAttrs::mode,
+        "The pooling of the embeddings of a bag. Can be 'sum', 'mean' or 'max'.",
+        refl::DefaultValue("sum"));
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.attrs.EmbeddingBagAttrs", EmbeddingBagAttrs, AttrsNode);
+};  // struct EmbeddingBagAttrs
+
 /*! \brief Attributes used in dropout operator */
 struct DropoutAttrs : public AttrsNode {
   double rate;
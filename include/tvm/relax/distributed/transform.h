@@ -26,6 +26,7 @@
 
 #include <tvm/ir/transform.h>
 #include <tvm/relax/dataflow_pattern.h>
+#include <tvm/relax/distributed/global_info.h>
 #include <tvm/relax/expr.h>
 #include <tvm/relax/transform.h>
 #include <tvm/tirx/function.h>
@@ -50,6 +51,20 @@ using tvm::transform::CreateModulePass;
  */
 TVM_DLL Pass PropagateSharding();
 
+/*!
+ * \brief Search the sharding annotations of the function parameters on the device mesh
+ * that minimize the estimated step time, and annotate them for PropagateSharding.
+ *
+ * \param device_mesh The device mesh to shard on.
+ * \param device_flops The FLOPs per second of a device.
+ * \param link_bandwidth The bytes per second a device sends in collectives.
+ * \param collective_latency The latency in seconds of a collective.
+ * \param memory_budget The bytes of parameters per device allowed, or 0 for no budget.
+ * \return The Pass.
+ */
+TVM_DLL Pass PlanSharding(DeviceMesh device_mesh, double device_flops, double link_bandwidth,
+                          double collective_latency, int64_t memory_budget);
+
 /*!
  * \brief Lower global view TensorIR into local view.
  *
@@ -60,9 +75,15 @@ TVM_DLL Pass LowerGlobalViewToLocalView();
 /*!
  * \brief Legalize redistribute op to ccl op.
  *
+ * An allgather feeding the lhs of a matmul is pipelined in chunks so that communication
+ * overlaps with the matmul, and an allreduce followed by a row sharding is lowered to a
+ * reduce-scatter.
+ *
+ * \param num_chunks The number of chunks an allgather feeding a matmul is split into.
+ * A value of 1 disables the pipelining.
  * \return The Pass.
  */
-TVM_DLL Pass LegalizeRedistribute();
+TVM_DLL Pass LegalizeRedistribute(int num_chunks = 4);
 
 /*!
  * \brief Lower DistIR to Relax
@@ -643,7 +643,8 @@ TVM_DLL Pass DeadCodeElimination(ffi::Array<ffi::String> entry_functions = {});
  * (generally, these are elementwise operations) in dataflow blocks into in-place implementations.
  * Supported operators will be replaced by calls to `call_tir_inplace` that invoke in-place
  * PrimFunc implementations of those operators (which are based on the legalizations of those
- * operators).
+ * operators). The `call_tir` of legalized modules are replaced as well when their PrimFunc only
+ * reads an input at the indices it writes the output to, or before it writes the output at all.
  * \note ConvertToDataflow may need to be called first to provide dataflow blocks.
  * \return The pass.
  */
@@ -655,12 +656,44 @@ TVM_DLL Pass DataflowUseInplaceCalls();
  * \param out_dtype The output data type of gemm/conv, which is the data type of the accumulator.
  * \param fp16_input_names The names of function parameters whose dtype should become fp16. The
  * function signature would change accordingly.
+ * \param op_profile The (error, speedup) measured by a calibration run for the calls, keyed by the
+ * names of the vars they are bound to. When given, the profiled calls are converted to fp16 for
+ * the most speedup whose total error stays within the budget, and the others are kept in fp32.
+ * \param error_budget The bound of the total error of the profiled calls converted to fp16.
  * \return The Pass.
  *
  * \note Mainly operates within dataflow blocks. ConvertToDataflow may need to be called first.
  */
 TVM_DLL Pass ToMixedPrecision(
-    DLDataType out_dtype, ffi::Optional<ffi::Array<ffi::String>> fp16_input_names = std::nullopt);
+    DLDataType out_dtype, ffi::Optional<ffi::Array<ffi::String>> fp16_input_names = std::nullopt,
+    ffi::Optional<ffi::Map<ffi::String, ffi::Array<double>>> op_profile = std::nullopt,
+    double error_budget = 0.0);
+
+/*!
+ * \brief Recompute tensors close to their late uses so that the peak live memory of each
+ * dataflow block fits a budget.
+ *
+ * Intended for training graphs produced by Gradient, where forward activations otherwise stay
+ * alive until the backward pass. A binding is recomputed only if all of its inputs are live at
+ * the point of recomputation; the candidate saving the most bytes per estimated FLOP is chosen
+ * first. Should run before LegalizeOps, while operators can still be identified.
+ *
+ * \param memory_budget The target peak of live tensor bytes within a dataflow block.
+ * \return The Pass.
+ */
+TVM_DLL Pass Rematerialize(int64_t memory_budget);
+
+/*!
+ * \brief Fold dequantize-op-quantize chains into integer kernels with fixed-point requantization.
+ *
+ * Rewrites `quantize(relu?(matmul(dequantize(a), dequantize(w)) + dequantize(bias)?))` into an
+ * int32-accumulating matmul on the quantized operands, and `quantize(dequantize(x))` into an
+ * integer requantize. The float rescale becomes a 31-bit multiplier and a rounding right shift.
+ * Scales and zero points must be constants; chains that do not fit are left unchanged.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass FakeQuantizationToInteger();
 
 /*!
  * \brief Rewrite a Relax module for executing with CUDA graph. This pass identifies
@@ -669,6 +702,31 @@ TVM_DLL Pass ToMixedPrecision(
  */
 TVM_DLL Pass RewriteCUDAGraph();
 
+/*!
+ * \brief Launch the kernels of independent dataflow branches on multiple device streams.
+ *
+ * The pass reads the number of streams from the pass config "relax.backend.num_device_streams",
+ * and keeps the module unchanged when it is at most 1 or when CUDA graph is enabled. The kernels
+ * are assigned to streams by their memory dependencies, with waits between the streams inserted
+ * for the dependencies across streams.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass AssignDeviceStreams();
+
+/*!
+ * \brief Pack independent `call_tir` bindings of a dataflow block into a single GPU kernel.
+ *
+ * Calls at the same dataflow level whose scheduled callees each consist of one kernel launch
+ * bound to `blockIdx.x`, with identical thread extents, are merged into one PrimFunc that
+ * dispatches on ranges of `blockIdx.x`. This reduces the number of launches for graphs with
+ * many small kernels, such as decoding.
+ *
+ * \param max_num_blocks Only kernels launching at most this many blocks are merged.
+ * \return The Pass.
+ */
+TVM_DLL Pass HorizontalFuseTIR(int64_t max_num_blocks = 256);
+
 /*!
  * \brief This pass updates the var_buffer mapping of PrimFunctions from the call_tir info.
  * Primarily used to update the VDevice information if any changes occurred from the caller.
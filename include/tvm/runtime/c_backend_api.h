@@ -95,6 +95,21 @@ typedef int (*FTVMParallelLambda)(int task_id, TVMParallelGroupEnv* penv, void*
  */
 TVM_RUNTIME_DLL int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task);
 
+/*!
+ * \brief Backend function for running parallel jobs partitioned by NUMA node.
+ *
+ *  The job is launched with all available threads, and the task ids are assigned to the
+ *  workers in NUMA node order, so that a contiguous range of task ids runs on the workers
+ *  of one node. Lambdas that split the data by task id thereby keep each data block on
+ *  one node. Binding the workers with the kNuma affinity mode spreads them over all nodes.
+ *
+ * \param flambda The parallel function to be launched.
+ * \param cdata The closure data.
+ *
+ * \return 0 when no error is thrown, -1 when failure happens
+ */
+TVM_RUNTIME_DLL int TVMBackendParallelLaunchNuma(FTVMParallelLambda flambda, void* cdata);
+
 /*!
  * \brief BSP barrrier between parallel threads
  * \param task_id the task id of the function.
@@ -103,6 +118,46 @@ TVM_RUNTIME_DLL int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* c
  */
 TVM_RUNTIME_DLL int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv);
 
+/*!
+ * \brief Backend function marking the start of a region instrumented by
+ *  InstrumentProfileIntrinsics.
+ *
+ *  Does nothing unless the loop profiler is started (runtime.LoopProfilerStart).
+ *
+ * \param func_name The name of the function containing the region.
+ * \param id The id of the instrumented region.
+ * \return 0 when no error is thrown, -1 when failure happens
+ */
+TVM_RUNTIME_DLL int TVMBackendProfileStart(const char* func_name, int32_t id);
+
+/*!
+ * \brief Backend function marking the end of a region instrumented by
+ *  InstrumentProfileIntrinsics.
+ *
+ * \param func_name The name of the function containing the region.
+ * \param id The id of the instrumented region.
+ * \return 0 when no error is thrown, -1 when failure happens
+ *
+ * \sa TVMBackendProfileStart
+ */
+TVM_RUNTIME_DLL int TVMBackendProfileEnd(const char* func_name, int32_t id);
+
+/*!
+ * \brief Backend function selecting the ISA variant of a kernel of a module built with
+ *  `codegen.llvm.isa_variants`.
+ *
+ *  The dispatcher of the kernel calls it once and keeps the result. The environment
+ *  variable TVM_CPU_ISA_VARIANT forces the variant of the given CPU name, or the base
+ *  build when set to "default".
+ *
+ * \param num_variants The number of variants, in the order of preference.
+ * \param names The CPU name each variant is built for.
+ * \param features The comma separated LLVM target features each variant requires.
+ * \return The index of the first variant the host supports, or -1 for the base build.
+ */
+TVM_RUNTIME_DLL int TVMBackendSelectISAVariant(int num_variants, const char** names,
+                                               const char** features);
+
 #ifdef __cplusplus
 }  // TVM_EXTERN_C
 #endif
@@ -87,6 +87,58 @@ TVM_RUNTIME_DLL void AllReduce(Tensor send, ReduceKind reduce_kind, bool in_grou
  * \param recv The array receives the outcome of allgather
  */
 TVM_RUNTIME_DLL void AllGather(Tensor send, bool in_group, Tensor recv);
+/*!
+ * \brief Perform an alltoall operation using the underlying communication library. The i-th
+ * equal chunk of `send` goes to the i-th worker, and the i-th chunk of `recv` comes from it.
+ * \param send The array send to perform alltoall on
+ * \param in_group Whether the alltoall operation performs globally or in group as default.
+ * \param recv The array receives the outcome of alltoall, which must not overlap `send`
+ */
+TVM_RUNTIME_DLL void AllToAll(Tensor send, bool in_group, Tensor recv);
+/*!
+ * \brief Perform a reducescatter operation using the underlying communication library. The
+ * buffers are reduced over the workers, and the i-th equal chunk of the result goes to the i-th
+ * worker.
+ * \param send The array send to perform reducescatter on
+ * \param reduce_kind The kind of reduction operation (e.g. sum, avg, min, max)
+ * \param in_group Whether the reducescatter operation performs globally or in group as default.
+ * \param recv The array receives the chunk of the worker
+ */
+TVM_RUNTIME_DLL void ReduceScatter(Tensor send, ReduceKind reduce_kind, bool in_group,
+                                   Tensor recv);
+/*!
+ * \brief Send a buffer to the next worker and receive one from the previous worker, with the
+ * workers in a ring. All the workers must exchange buffers of the same size.
+ * \param send The buffer to be sent to the next worker
+ * \param in_group Whether the ring is formed by the workers of the group or by all workers.
+ * \param recv The buffer to receive from the previous worker, which must not overlap `send`
+ */
+TVM_RUNTIME_DLL void RingExchange(Tensor send, bool in_group, Tensor recv);
+/*!
+ * \brief Start an allreduce on the communication stream of the worker, without blocking the
+ * compute stream. `send` and `recv` must not be touched until the collective is waited for.
+ * \param send The array send to perform allreduce on
+ * \param reduce_kind The kind of reduction operation (e.g. sum, avg, min, max)
+ * \param in_group Whether the allreduce operation performs globally or in group as default.
+ * \param recv The array receives the outcome of allreduce
+ * \return The handle to pass to `CollectiveWait`
+ */
+TVM_RUNTIME_DLL ffi::ObjectRef AllReduceStart(Tensor send, ReduceKind reduce_kind, bool in_group,
+                                              Tensor recv);
+/*!
+ * \brief Start an allgather on the communication stream of the worker, without blocking the
+ * compute stream. `send` and `recv` must not be touched until the collective is waited for.
+ * \param send The array send to perform allgather on
+ * \param in_group Whether the allgather operation performs globally or in group as default.
+ * \param recv The array receives the outcome of allgather
+ * \return The handle to pass to `CollectiveWait`
+ */
+TVM_RUNTIME_DLL ffi::ObjectRef AllGatherStart(Tensor send, bool in_group, Tensor recv);
+/*!
+ * \brief Make the compute stream wait for an asynchronous collective. The host does not block.
+ * \param handle The handle returned when the collective is started
+ */
+TVM_RUNTIME_DLL void CollectiveWait(ffi::ObjectRef handle);
 /*!
  * \brief Perform a broadcast operation from worker-0
  * \param send The buffer to be broadcasted
@@ -139,6 +191,20 @@ TVM_RUNTIME_DLL void SendToWorker(Tensor buffer, int receiver_id);
  * \param sender_id The global sender worker id.
  */
 TVM_RUNTIME_DLL void RecvFromWorker(Tensor buffer, int sender_id);
+/*!
+ * \brief Run micro-batches through the pipeline formed by the worker groups, group `g` being
+ * stage `g`. The activations flow to the corresponding worker in the next group, and the
+ * receive of the next micro-batch overlaps with the computation of the current one.
+ * \param stage_func The stage of this worker, called as `stage_func(input, micro_batch)`.
+ * \param num_micro_batches The number of micro-batches.
+ * \param inputs The micro-batches stacked on axis 0. Only used by the first group.
+ * \param outputs The outputs stacked on axis 0. Only written by the last group.
+ * \param act_shape The shape of the activation of one micro-batch between two stages.
+ * \param act_dtype The dtype of the activation between two stages.
+ */
+TVM_RUNTIME_DLL void PipelineRun(ffi::Function stage_func, int64_t num_micro_batches,
+                                 ffi::Optional<Tensor> inputs, ffi::Optional<Tensor> outputs,
+                                 ffi::Shape act_shape, DLDataType act_dtype);
 /*! \brief Get the local worker id */
 TVM_RUNTIME_DLL int WorkerId();
 /*!
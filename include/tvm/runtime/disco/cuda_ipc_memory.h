@@ -88,6 +88,8 @@ class CUDAIPCMemory : public ffi::ObjectRef {
    * function will raise exception.
    */
   TVM_RUNTIME_DLL static CUDAIPCMemory GetIPCMemoryFromDevicePtr(void* ptr);
+  /*! \brief Whether the given local CUDA data pointer is allocated as CUDAIPCMemory. */
+  TVM_RUNTIME_DLL static bool IsIPCMemory(void* ptr);
 
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(CUDAIPCMemory, ffi::ObjectRef, CUDAIPCMemoryObj);
 };
@@ -73,6 +73,7 @@
 #ifndef TVM_RUNTIME_DISCO_SESSION_H_
 #define TVM_RUNTIME_DISCO_SESSION_H_
 
+#include <tvm/ffi/container/array.h>
 #include <tvm/ffi/container/shape.h>
 #include <tvm/ffi/function.h>
 #include <tvm/runtime/tensor.h>
@@ -271,6 +272,19 @@ class SessionObj : public ffi::Object {
    */
   TVM_RUNTIME_DLL virtual void DebugSetRegister(int64_t reg_id, ffi::AnyView value,
                                                 int worker_id) = 0;
+  /*!
+   * \brief Start capturing a command graph. Until `EndCapture`, `CallWithPacked` records the
+   * calls instead of broadcasting them, and the returned DRefs denote the registers each replay
+   * writes to. Other commands are not captured and still run immediately.
+   */
+  TVM_RUNTIME_DLL virtual void BeginCapture() = 0;
+  /*!
+   * \brief Finish capturing, and send the captured calls to the workers in one message.
+   * \param inputs The registers bound to the arguments of a replay, in order.
+   * \return A function on the workers. Calling it replays all the captured calls, so a replay
+   * costs a single broadcast regardless of the number of calls.
+   */
+  TVM_RUNTIME_DLL virtual DRef EndCapture(ffi::Array<DRef> inputs) = 0;
 
   struct FFI;
   friend struct SessionObj::FFI;
@@ -305,12 +319,16 @@ class Session : public ffi::ObjectRef {
    * When `worker-id` is 0, it shuts down the process pool; Otherwise, it retursn a tuple
    * (read_fd, writefd) used to communicate with the corresponding worker.
    * \param entrypoint The entrypoint of DiscoWorker main worker function.
+   * \param transport "pipe" to send control messages through the pipes, or "shm" to send them
+   * through a shared-memory ring per worker, in which case the pipes only carry the handshake.
+   * "shm" is only supported on Linux.
    * \note Worker-0 is always co-located with the controler as a separate thread, and therefore
    * worker-0 does not exist in the process pool.
    */
   TVM_RUNTIME_DLL static Session ProcessSession(int num_workers, int num_groups,
                                                 ffi::String process_pool_creator,
-                                                ffi::String entrypoint);
+                                                ffi::String entrypoint,
+                                                ffi::String transport = "pipe");
 
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(Session, ffi::ObjectRef, SessionObj);
 };
@@ -41,6 +41,9 @@ namespace memory {
 enum AllocatorType {
   kNaive = 1,
   kPooled,
+  kBuddy,
+  /*! \brief Stream-ordered allocation from a cudaMallocAsync memory pool, CUDA only. */
+  kStreamOrdered,
 };
 
 struct Buffer {
@@ -124,6 +127,24 @@ class TVM_RUNTIME_DLL Allocator {
   AllocatorType type_;
 };
 
+/*!
+ * \brief Get the page-locked host device of a device.
+ * \param dev The device that copies from and to the host memory.
+ * \return The page-locked host device, or the CPU when the device has no page-locked memory.
+ */
+inline Device PinnedHostDevice(Device dev) {
+  switch (dev.device_type) {
+    case kDLCUDA:
+    case kDLCUDAHost:
+      return Device{kDLCUDAHost, 0};
+    case kDLROCM:
+    case kDLROCMHost:
+      return Device{kDLROCMHost, 0};
+    default:
+      return Device{kDLCPU, 0};
+  }
+}
+
 class MemoryManager {
  public:
   TVM_RUNTIME_DLL static MemoryManager* Global();
@@ -141,6 +162,13 @@ class MemoryManager {
    * \return The memory allocator.
    */
   TVM_RUNTIME_DLL static Allocator* GetAllocator(Device dev, AllocatorType type);
+  /*!
+   * \brief Get or create the pooled allocator of the page-locked host memory of a device.
+   *  The device copies from and to the page-locked memory asynchronously.
+   * \param dev The device that copies from and to the host memory.
+   * \return The memory allocator, whose buffers are on `PinnedHostDevice(dev)`.
+   */
+  TVM_RUNTIME_DLL static Allocator* GetOrCreatePinnedHostAllocator(Device dev);
   /*! \brief Clear the allocators. */
   static void Clear();
 
@@ -191,6 +219,7 @@ class Storage : public ffi::ObjectRef {
 using memory::Allocator;
 using memory::AllocatorType;
 using memory::MemoryManager;
+using memory::PinnedHostDevice;
 using memory::StorageObj;
 
 }  // namespace runtime
@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file include/tvm/runtime/metrics.h
+ * \brief A process-wide registry of runtime metrics: counters, gauges and histograms.
+ */
+#ifndef TVM_RUNTIME_METRICS_H_
+#define TVM_RUNTIME_METRICS_H_
+
+#include <tvm/runtime/base.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace metrics {
+
+/*! \brief A count that only goes up. */
+class Counter {
+ public:
+  void Increment(int64_t delta = 1) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/*! \brief A value that goes up and down, such as a number of bytes in use. */
+class Gauge {
+ public:
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/*! \brief The distribution of observed values over buckets of fixed upper bounds. */
+class Histogram {
+ public:
+  /*! \param bounds The increasing upper bounds of the buckets, an overflow bucket is added. */
+  explicit Histogram(std::vector<double> bounds)
+      : bounds_(std::move(bounds)),
+        counts_(std::make_unique<std::atomic<int64_t>[]>(bounds_.size() + 1)) {}
+
+  void Observe(double value) {
+    size_t bucket = 0;
+    while (bucket < bounds_.size() && value > bounds_[bucket]) ++bucket;
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+  }
+
+  /*! \brief The upper bounds of the buckets, without the overflow bucket. */
+  const std::vector<double>& bounds() const { return bounds_; }
+  /*! \brief The number of observations in a bucket, the last one being the overflow bucket. */
+  int64_t BucketCount(size_t bucket) const {
+    return counts_[bucket].load(std::memory_order_relaxed);
+  }
+  /*! \brief The sum of the observed values. */
+  double Sum() const { return sum_.load(std::memory_order_relaxed); }
+  /*! \brief The number of observations. */
+  int64_t Count() const {
+    int64_t count = 0;
+    for (size_t i = 0; i <= bounds_.size(); ++i) count += BucketCount(i);
+    return count;
+  }
+
+  /*! \brief The bounds start, start * factor, ..., start * factor^(num_buckets - 1). */
+  static std::vector<double> ExponentialBounds(double start, double factor, int num_buckets) {
+    std::vector<double> bounds;
+    for (int i = 0; i < num_buckets; ++i, start *= factor) bounds.push_back(start);
+    return bounds;
+  }
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+  std::atomic<double> sum_{0};
+};
+
+/*!
+ * \brief The process-wide registry of metrics.
+ *
+ * Metrics are created on first lookup and live until the process exits, so that a hot path
+ * looks its metric up once and then only updates it with relaxed atomics:
+ *
+ * \code{.cpp}
+ * static metrics::Counter* num_allocs =
+ *     metrics::Registry::Global()->GetCounter("tvm_pooled_allocator_allocs_total", "...");
+ * num_allocs->Increment();
+ * \endcode
+ *
+ * Metric names follow the Prometheus conventions, and looking up an existing name as another
+ * kind of metric is an error.
+ */
+class Registry {
+ public:
+  TVM_RUNTIME_DLL static Registry* Global();
+
+  /*!
+   * \brief Get or create a counter.
+   * \param name The name of the metric.
+   * \param help The description of the metric, used when it is created.
+   */
+  TVM_RUNTIME_DLL Counter* GetCounter(const std::string& name, const std::string& help = "");
+  /*! \brief Get or create a gauge. \sa GetCounter */
+  TVM_RUNTIME_DLL Gauge* GetGauge(const std::string& name, const std::string& help = "");
+  /*!
+   * \brief Get or create a histogram.
+   * \param name The name of the metric.
+   * \param help The description of the metric, used when it is created.
+   * \param bounds The bucket bounds used when it is created, by default from 1us to about 4s.
+   */
+  TVM_RUNTIME_DLL Histogram* GetHistogram(
+      const std::string& name, const std::string& help = "",
+      std::vector<double> bounds = Histogram::ExponentialBounds(1e-6, 4, 12));
+
+  /*! \brief Render all metrics in the Prometheus text exposition format. */
+  TVM_RUNTIME_DLL std::string PrometheusText();
+
+  /*!
+   * \brief The current value of every counter and gauge, and the count and sum of every
+   * histogram as `<name>_count` and `<name>_sum`.
+   */
+  TVM_RUNTIME_DLL std::map<std::string, double> Snapshot();
+
+ private:
+  enum class Kind { kCounter, kGauge, kHistogram };
+  struct Entry {
+    Kind kind;
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  /*! \brief Find or add the entry of a metric. Requires holding mutex_. */
+  Entry* GetEntry(const std::string& name, const std::string& help, Kind kind);
+
+  std::mutex mutex_;
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace metrics
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_METRICS_H_
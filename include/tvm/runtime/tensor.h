@@ -27,6 +27,7 @@
 #include <tvm/ffi/container/shape.h>
 #include <tvm/ffi/container/tensor.h>
 #include <tvm/ffi/dtype.h>
+#include <tvm/ffi/function.h>
 #include <tvm/ffi/optional.h>
 #include <tvm/ffi/string.h>
 #include <tvm/runtime/base.h>
@@ -155,6 +156,21 @@ class Tensor : public tvm::ffi::Tensor {
    */
   TVM_RUNTIME_DLL static Tensor Empty(ffi::Shape shape, DLDataType dtype, Device dev,
                                       ffi::Optional<ffi::String> mem_scope = std::nullopt);
+  /*!
+   * \brief Create a Tensor over a caller-owned buffer, without copying it.
+   * \param data The compact buffer of the tensor, which must outlive the tensor.
+   * \param shape The shape of the tensor.
+   * \param dtype The data type of the tensor.
+   * \param dev The device of the buffer.
+   * \param release Called once the last reference to the tensor is dropped, so that the caller
+   *        can free or recycle the buffer.
+   * \param alignment The required alignment of the buffer; the default matches the alignment
+   *        the kernels assume, as in FromDLPack.
+   * \return The created tensor.
+   */
+  TVM_RUNTIME_DLL static Tensor FromExternalBuffer(
+      void* data, ffi::Shape shape, DLDataType dtype, Device dev,
+      ffi::Optional<ffi::Function> release = std::nullopt, size_t alignment = kAllocAlignment);
   /*!
    * \brief Function to copy data from one array to another.
    * \param from The source array.
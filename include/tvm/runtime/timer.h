@@ -179,14 +179,22 @@ class Timer : public ffi::ObjectRef {
  * \param repeats_to_cooldown The number of repeats before the
  *        cooldown is activated.
  * \param cache_flush_bytes The number of bytes to flush from cache before
+ *        each `repeat`, through "runtime.cache_flush.<device>" when the device
+ *        registers it, and by a copy between two buffers otherwise.
  * \param f_preproc The function to be executed before we execute time
  *        evaluator.
+ * \param max_relative_ci When positive, `repeat` is the maximum number of repeats,
+ *        and the measurement stops once the 95% confidence interval of the mean
+ *        cost is narrower than this fraction of the mean, after at least 3 repeats.
+ * \param cold Whether to flush the caches before each run, and time the runs
+ *        one by one, instead of timing `number` back to back warm runs.
  * \return f_timer A timer function.
  */
 ffi::Function WrapTimeEvaluator(ffi::Function f, Device dev, int number, int repeat,
                                 int min_repeat_ms, int limit_zero_time_iterations,
                                 int cooldown_interval_ms, int repeats_to_cooldown,
-                                int cache_flush_bytes = 0, ffi::Function f_preproc = nullptr);
+                                int cache_flush_bytes = 0, ffi::Function f_preproc = nullptr,
+                                double max_relative_ci = 0.0, bool cold = false);
 
 }  // namespace runtime
 }  // namespace tvm
@@ -28,6 +28,7 @@
 #include <tvm/support/io.h>
 #include <tvm/support/serializer.h>
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -59,6 +60,11 @@ struct VMFuncInfo {
     kVMFunc = 1,
     /*! \brief VMTIR function. */
     kVMTIRFunc = 2,
+    /*!
+     * \brief Host kernel called through its direct C entry, `int32_t (*)(void* const* args)`.
+     *  The packed function of the same name in the kernel library returns the entry address.
+     */
+    kDirectFunc = 3,
   };
   /*! \brief The kind of function. */
   FuncKind kind;
@@ -75,6 +81,14 @@ struct VMFuncInfo {
   /*! \brief The function parameter names.*/
   std::vector<std::string> param_names;
 
+  /*!
+   * \brief The name prefix of the trailing parameters that receive the outputs of a function
+   *  compiled with the pass config "relax.memory_output_params".
+   */
+  static constexpr const char* kOutputParamPrefix = "output_buffer_";
+  /*! \brief The number of trailing parameters that receive the outputs of the function. */
+  Index NumOutputParams() const;
+
   // defined customized loader save
   void Save(support::Stream* writer) const;
   bool Load(support::Stream* reader);
@@ -143,6 +157,10 @@ class TVM_RUNTIME_DLL VMExecutable : public ffi::ModuleObj {
   bool HasFunction(const ffi::String& name) const;
   /*!
    * \brief Load VMExecutable from the file.
+   *
+   * The file is mapped read-only when the platform supports it, and the CPU tensor constants
+   * view into the mapping, so that the processes loading the same file share its pages.
+   *
    * \param file_name The path of the file that load the executable from.
    * \return The loaded executable, in the form of a `runtime::Module`.
    */
@@ -173,6 +191,24 @@ class TVM_RUNTIME_DLL VMExecutable : public ffi::ModuleObj {
   ffi::Optional<ffi::Function> GetFunction(const ffi::String& name) override;
 
  private:
+  /*! \brief The serialized executable in memory. */
+  struct SerializedData {
+    /*! \brief The serialized bytes. */
+    const char* data;
+    /*! \brief The number of serialized bytes. */
+    size_t size;
+    /*!
+     * \brief The owner of the read-only mapping of the bytes, which the tensor constants view
+     *  into. nullptr when the bytes are transient and the tensor constants are copied out.
+     */
+    std::shared_ptr<const void> mapping;
+  };
+  /*!
+   * \brief Load VMExecutable from the serialized bytes in memory.
+   * \param serialized The serialized executable.
+   * \return The loaded executable, in the form of a `runtime::Module`.
+   */
+  static ffi::Module Load(const SerializedData& serialized);
   /*!
    * \brief Save the globals.
    * \param strm The input stream.
@@ -188,6 +224,11 @@ class TVM_RUNTIME_DLL VMExecutable : public ffi::ModuleObj {
    * \param strm The input stream.
    */
   void SaveConstantSection(support::Stream* strm) const;
+  /*!
+   * \brief Save the data of the tensor constants, each aligned to kAllocAlignment.
+   * \param strm The output stream, which must be at an aligned position.
+   */
+  void SaveTensorDataSection(support::Stream* strm) const;
   /*!
    * \brief Save the instructions.
    * \param strm The input stream.
@@ -211,8 +252,12 @@ class TVM_RUNTIME_DLL VMExecutable : public ffi::ModuleObj {
   /*!
    * \brief Load the constant pool.
    * \param strm The input stream.
+   * \param header_magic The magic number of the serialized format.
+   * \param serialized The serialized executable, whose trailing tensor data section holds the
+   *  data of the tensor constants in the latest format.
    */
-  void LoadConstantSection(support::Stream* strm);
+  void LoadConstantSection(support::Stream* strm, uint64_t header_magic,
+                           const SerializedData& serialized);
   /*!
    * \brief Load the instructions.
    * \param strm The input stream.
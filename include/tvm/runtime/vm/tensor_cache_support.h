@@ -23,8 +23,10 @@
 #include <tvm/ffi/function.h>
 #include <tvm/runtime/tensor.h>
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -61,6 +63,11 @@ struct TensorCacheMetadata {
       int64_t nbytes;
       /*! \brief Offset from the raw stream */
       int64_t byte_offset;
+      /*!
+       * \brief Hash of the encoded bytes, empty if unknown. The parameters of the same hash,
+       *  format, dtype and shape share one tensor per device in the TensorCache.
+       */
+      std::string content_hash;
     };
 
     /*! \brief Load a FileRecord into memory */
@@ -69,6 +76,30 @@ struct TensorCacheMetadata {
                                             std::string* raw_data_buffer,    //
                                             ffi::Optional<Tensor>* staging_buffer = nullptr) const;
 
+    /*!
+     * \brief Load a FileRecord by memory-mapping the file, without reading it into a string.
+     *  On CPU, the parameters that need no decoding are zero-copy views over the mapping.
+     *  On CUDA and ROCm, the parameters are streamed from the mapping through a pinned,
+     *  double-buffered staging buffer. Falls back to Load when mapping is not supported.
+     * \param device The device to load the parameters onto.
+     * \param path_prefix The directory of the file.
+     * \param staging_buffer The staging buffer reused across the files, can be nullptr.
+     */
+    TVM_RUNTIME_DLL ffi::Array<Tensor> LoadMapped(
+        Device device, const std::string& path_prefix,
+        ffi::Optional<Tensor>* staging_buffer = nullptr) const;
+
+    /*!
+     * \brief Load a FileRecord from the content of its file.
+     * \param device The device to load the parameters onto.
+     * \param raw_data The content of the file.
+     * \param staging_buffer The staging buffer reused across the files, can be nullptr.
+     * \param stream The stream of the uploads to CUDA and ROCm.
+     */
+    TVM_RUNTIME_DLL ffi::Array<Tensor> LoadFromBytes(
+        Device device, const std::string& raw_data,
+        ffi::Optional<Tensor>* staging_buffer = nullptr, TVMStreamHandle stream = nullptr) const;
+
     /*! \brief Relative path to the bin file */
     std::string data_path;
     /*! \brief Format of the file */
@@ -90,6 +121,33 @@ struct TensorCacheMetadata {
                                                          const std::string& path);
 };
 
+/*!
+ * \brief Reads shard files ahead of their use on a pool of threads, so that the disk
+ *  reads overlap with each other and with the processing of the files already read.
+ *  The bytes read but not taken yet are capped, except that one file is always read.
+ */
+class ShardPrefetcher {
+ public:
+  /*!
+   * \brief Start reading the files.
+   * \param files The path and the size of each file, in the order they are taken.
+   * \param num_threads The number of reading threads.
+   * \param max_inflight_bytes The maximum bytes of the files read but not taken.
+   */
+  TVM_RUNTIME_DLL ShardPrefetcher(std::vector<std::pair<std::string, int64_t>> files,
+                                  int num_threads, int64_t max_inflight_bytes);
+  TVM_RUNTIME_DLL ~ShardPrefetcher();
+  /*!
+   * \brief Wait for and take the content of a file. The files must be taken in order.
+   * \param index The index of the file.
+   */
+  TVM_RUNTIME_DLL std::string Take(int index);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -171,6 +171,17 @@ class VirtualMachine : public ffi::ModuleObj {
    * \param instrument The instrument function.
    */
   virtual void SetInstrument(ffi::Function instrument) = 0;
+  /*!
+   * \brief Create an execution context of the initialized VM.
+   *
+   * The context shares the executable, the constants on the devices and the function pool of
+   * the VM, which are not modified after Init, and has its own frames, inputs, outputs,
+   * instrument and extensions. The contexts of a VM can run on different threads at the same
+   * time, while each context, as the VM itself, is used by one thread at a time.
+   *
+   * \return The created context.
+   */
+  virtual ffi::ObjectPtr<VirtualMachine> CreateContext() = 0;
 
   /*!
    * \brief Get or create a VM extension. Once created, the extension will be stored in the VM
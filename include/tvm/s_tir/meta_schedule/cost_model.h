@@ -26,6 +26,7 @@
 #include <tvm/ffi/string.h>
 #include <tvm/runtime/base.h>
 #include <tvm/s_tir/meta_schedule/arg_info.h>
+#include <tvm/s_tir/meta_schedule/feature_extractor.h>
 #include <tvm/s_tir/meta_schedule/measure_candidate.h>
 #include <tvm/s_tir/meta_schedule/runner.h>
 #include <tvm/s_tir/schedule/schedule.h>
@@ -145,6 +146,28 @@ class CostModel : public ffi::ObjectRef {
                                        PyCostModelNode::FSave f_save,      //
                                        PyCostModelNode::FUpdate f_update,  //
                                        PyCostModelNode::FPredict f_predict);
+  /*!
+   * \brief Create a gradient-boosted decision tree cost model that is trained and evaluated in
+   *  C++, with the objective of the XGBoost model.
+   * \param extractor The feature extractor.
+   * \param max_depth The maximum depth of a tree.
+   * \param eta The learning rate.
+   * \param gamma The minimum gain of a split.
+   * \param min_child_weight The minimum sum of hessians of a child of a split.
+   * \param reg_lambda The L2 regularization of the output of a leaf.
+   * \param max_num_trees The maximum number of trees trained from scratch.
+   * \param early_stopping_rounds The rounds without improvement to stop training after.
+   * \param num_incremental_trees The number of trees added when the model is not retrained.
+   * \param num_warmup_samples The number of samples to predict random scores before.
+   * \param adaptive_training Whether to retrain from scratch only when the data grows by 20%.
+   * \param seed The random seed of the scores predicted before warm-up.
+   * \return The cost model created.
+   */
+  TVM_DLL static CostModel GBDTModel(FeatureExtractor extractor, int max_depth, double eta,
+                                     double gamma, double min_child_weight, double reg_lambda,
+                                     int max_num_trees, int early_stopping_rounds,
+                                     int num_incremental_trees, int num_warmup_samples,
+                                     bool adaptive_training, int64_t seed);
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(CostModel, ffi::ObjectRef, CostModelNode);
 };
 
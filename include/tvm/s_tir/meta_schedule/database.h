@@ -495,6 +495,26 @@ class Database : public ffi::ObjectRef {
    */
   TVM_DLL static Database JSONDatabase(ffi::String path_workload, ffi::String path_tuning_record,
                                        bool allow_missing, ffi::String mod_eq_name = "structural");
+  /*!
+   * \brief Create a database that shards its workloads and tuning records over the files of a
+   * directory by workload hash, reading a shard only when one of its workloads is looked up.
+   * \param path The directory of the shards.
+   * \param num_shards The number of shards.
+   * \param allow_missing Whether to create the directory when it is not found.
+   * \param mod_eq_name A string to specify the module equality testing and hashing method.
+   */
+  TVM_DLL static Database ShardedJSONDatabase(ffi::String path, int num_shards,
+                                              bool allow_missing,
+                                              ffi::String mod_eq_name = "structural");
+  /*!
+   * \brief Create a database in a single binary file, which indexes the tuning records by run
+   * time on load and only decodes the trace of a record when it is selected.
+   * \param path The path to the database file.
+   * \param allow_missing Whether to create new file when the given path is not found.
+   * \param mod_eq_name A string to specify the module equality testing and hashing method.
+   */
+  TVM_DLL static Database BinaryDatabase(ffi::String path, bool allow_missing,
+                                         ffi::String mod_eq_name = "structural");
   /*!
    * \brief A database composed of multiple databases, allowing users to guide IR rewriting using
    * combined knowledge of those databases. To each query, it returns the best record among all the
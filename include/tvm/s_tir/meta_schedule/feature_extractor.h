@@ -27,12 +27,24 @@
 #include <tvm/runtime/tensor.h>
 #include <tvm/s_tir/meta_schedule/measure_candidate.h>
 
+#include <vector>
+
 namespace tvm {
 namespace s_tir {
 namespace meta_schedule {
 
 class TuneContext;
 
+/*! \brief The features of a batch of measure candidates, stored contiguously in one buffer. */
+struct FeatureBatch {
+  /*! \brief The length of a feature row */
+  int num_features = 0;
+  /*! \brief The feature rows of all the candidates in row-major order */
+  std::vector<float> rows;
+  /*! \brief The rows of candidate i are [row_ptr[i], row_ptr[i + 1]) */
+  std::vector<int64_t> row_ptr;
+};
+
 /*! \brief Extractor for features from measure candidates for use in cost model. */
 class FeatureExtractorNode : public ffi::Object {
  public:
@@ -52,6 +64,15 @@ class FeatureExtractorNode : public ffi::Object {
    */
   virtual ffi::Array<tvm::runtime::Tensor> ExtractFrom(
       const TuneContext& context, const ffi::Array<MeasureCandidate>& candidates) = 0;
+  /*!
+   * \brief Extract features from the given measure candidates into one float32 buffer.
+   * \param context The tuning context for feature extraction.
+   * \param candidates The measure candidates to extract features from.
+   * \param batch The batch to write the features to.
+   * \note The default implementation copies the tensors returned by `ExtractFrom`.
+   */
+  virtual void ExtractBatch(const TuneContext& context,
+                            const ffi::Array<MeasureCandidate>& candidates, FeatureBatch* batch);
   TVM_FFI_DECLARE_OBJECT_INFO("s_tir.meta_schedule.FeatureExtractor", FeatureExtractorNode,
                               ffi::Object);
 };
@@ -96,12 +117,14 @@ class FeatureExtractor : public ffi::ObjectRef {
    * curve.
    * \param cache_line_bytes The number of bytes in a cache line.
    * \param extract_workload Whether to extract features in the workload in tuning context or not.
+   * \param cache_size The number of scheduled modules whose features are cached, 0 to disable it.
    * \return The feature extractor created.
    */
   TVM_DLL static FeatureExtractor PerStoreFeature(int buffers_per_store = 5,
                                                   int arith_intensity_curve_num_samples = 10,
                                                   int cache_line_bytes = 64,
-                                                  bool extract_workload = false);
+                                                  bool extract_workload = false,
+                                                  int cache_size = 1024);
   /*!
    * \brief Create a feature extractor with customized methods on the python-side.
    * \param f_extract_from The packed function of `ExtractFrom`.
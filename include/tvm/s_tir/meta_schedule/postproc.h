@@ -151,6 +151,12 @@ class Postproc : public ffi::ObjectRef {
    * \return The postprocessor created
    */
   TVM_DLL static Postproc VerifyVTCMLimit();
+  /*!
+   * \brief Creates a postprocessor that verifies if the estimated register pressure of the
+   * lowered code fits the registers of the target, halving the auto-unroll steps until it does
+   * \return The postprocessor created
+   */
+  TVM_DLL static Postproc VerifyRegisterPressure();
   /*!
    * \brief Creates a postprocessor that rewrites the layout of input tensor
    * \note Weight layout rewrite is supported so far, activation layout rewrite will be added.
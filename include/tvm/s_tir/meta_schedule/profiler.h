@@ -27,7 +27,10 @@
 #include <tvm/ir/module.h>
 #include <tvm/target/target.h>
 
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -51,13 +54,39 @@ class ScopedTimer {
   ffi::TypedFunction<void()> deferred_;
 };
 
+/*! \brief A timed scope recorded by the profiler, a complete event of the trace */
+struct ProfilerEvent {
+  /*! \brief The name of the scope */
+  std::string name;
+  /*! \brief The name of the task being tuned when the scope started, empty if none */
+  std::string task;
+  /*! \brief The index of the thread, 0 for the thread that entered the profiler */
+  int64_t tid;
+  /*! \brief The start of the scope in microseconds since the profiler is created */
+  double start_us;
+  /*! \brief The duration of the scope in microseconds */
+  double dur_us;
+};
+
 /*! \brief A generic profiler */
 class ProfilerNode : public ffi::Object {
  public:
-  /*! \brief The segments that are already profiled */
+  /*! \brief The segments that are already profiled, on the thread that entered the profiler */
   std::unordered_map<std::string, double> stats_sec;
   /*! \brief Counter for the total time used */
   ffi::Function total_timer;
+  /*! \brief The timed scopes in the order they finish, on every thread */
+  std::vector<ProfilerEvent> events;
+  /*! \brief The name of the task being tuned, set by `Profiler::TaskScope` */
+  std::string current_task;
+  /*! \brief The time the profiler is created, the origin of the event timestamps */
+  std::chrono::high_resolution_clock::time_point origin;
+  /*! \brief The thread that entered the profiler */
+  std::thread::id owner_thread;
+  /*! \brief The indices of the threads that have recorded a scope */
+  std::unordered_map<std::thread::id, int64_t> thread_ids;
+  /*! \brief The mutex guarding the profiler against the worker threads */
+  std::mutex mutex;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -72,6 +101,21 @@ class ProfilerNode : public ffi::Object {
   ffi::Map<ffi::String, FloatImm> Get() const;
   /*! \brief Return a summary of profiling results as table format */
   ffi::String Table() const;
+  /*!
+   * \brief Return the timed scopes in the Chrome trace event format, which can be loaded in
+   *  Perfetto or chrome://tracing as a flame chart of the tuning phases of each task.
+   */
+  ffi::String ChromeTrace();
+  /*!
+   * \brief Record a finished scope.
+   * \param name The name of the scope.
+   * \param task The task being tuned when the scope started.
+   * \param start The start of the scope.
+   * \param end The end of the scope.
+   */
+  void Record(const std::string& name, const std::string& task,
+              std::chrono::high_resolution_clock::time_point start,
+              std::chrono::high_resolution_clock::time_point end);
 };
 
 /*!
@@ -87,7 +131,11 @@ class Profiler : public ffi::ObjectRef {
   void EnterWithScope();
   /*! \brief Exiting the scope of the context manager */
   void ExitWithScope();
-  /*! \brief Returns the current profiler */
+  /*!
+   * \brief Returns the current profiler. On a thread that has not entered any profiler, it is
+   *  the outermost profiler entered by any thread, so the scopes on the worker threads of a
+   *  profiled tuning are recorded too.
+   */
   static ffi::Optional<Profiler> Current();
   /*!
    * \brief Profile the time usage in the given scope in the given name.
@@ -95,6 +143,12 @@ class Profiler : public ffi::ObjectRef {
    * \return A scope timer for time profiling.
    */
   static ScopedTimer TimedScope(ffi::String name);
+  /*!
+   * \brief Attribute the scopes recorded in the given scope to a task.
+   * \param task_name The name of the task.
+   * \return A scope that restores the previous task when it exits.
+   */
+  static ScopedTimer TaskScope(ffi::String task_name);
 };
 
 }  // namespace meta_schedule
@@ -241,13 +241,33 @@ class ScheduleRule : public ffi::ObjectRef {
    */
   TVM_DLL static ScheduleRule AddRFactor(int max_jobs_per_core,  //
                                          ffi::Optional<int64_t> max_innermost_factor);
+  /*!
+   * \brief Create a rule: split the reduction of a GPU reduction block with little spatial
+   * parallelism across thread blocks, e.g. a skinny matmul, with the partial sums reduced by the
+   * original block in a second kernel
+   * \param split_factors Candidates of the number of thread blocks each reduction is split
+   * across (values are required to be larger than 1).
+   * \param thread_extents Candidates of thread axis extent (values are required to be positive).
+   * \param min_reduction_extent The minimum reduction extent for the rule to apply.
+   * \param max_spatial_extent The maximum spatial extent for the rule to apply.
+   * \param stream_k_num_blocks The number of thread blocks, usually the number of SMs, over which
+   * the Stream-K variant distributes all the partial sums. std::nullopt disables the variant.
+   * \return The schedule rule created
+   */
+  TVM_DLL static ScheduleRule SplitK(ffi::Array<int64_t> split_factors,
+                                     ffi::Array<int64_t> thread_extents,
+                                     int64_t min_reduction_extent, int64_t max_spatial_extent,
+                                     ffi::Optional<int64_t> stream_k_num_blocks);
   /*!
    * \brief Create a schedule rule which applies cross-thread reduction to some reduction blocks
    * correspondingly when needed
    * \param thread_extents Candidates of thread axis extent (values are required to be positive).
+   * \param cluster_extents Candidates of the number of thread blocks of a cluster that reduce a
+   * long row together on sm_90 or higher, empty to disable the reduction across thread blocks.
    * \return The schedule rule created
    */
-  TVM_DLL static ScheduleRule CrossThreadReduction(ffi::Array<int64_t> thread_extents);
+  TVM_DLL static ScheduleRule CrossThreadReduction(ffi::Array<int64_t> thread_extents,
+                                                   ffi::Array<int64_t> cluster_extents = {});
   /*!
    * \brief A rule that randomly select a compute-at location for a free block
    * \return The schedule rule created
@@ -270,6 +290,25 @@ class ScheduleRule : public ffi::ObjectRef {
                                                          int max_vectorize_extent,              //
                                                          ffi::Array<int64_t> unroll_max_steps,  //
                                                          bool unroll_explicit);
+  /*!
+   * \brief Prefetch the operands of tiled blocks into the CPU cache ahead of their use. The
+   * outermost reduction loop of each block tiled by MultiLevelTiling is marked as a prefetched
+   * software pipeline, see `s_tir::attr::software_pipeline_prefetch`.
+   * \param prefetch_distances The candidate numbers of iterations to prefetch ahead. The
+   * schedule without prefetch is kept as a candidate as well.
+   * \return The schedule rule created
+   */
+  TVM_DLL static ScheduleRule PrefetchPipeline(ffi::Array<int64_t> prefetch_distances);
+  /*!
+   * \brief Stage the operands of tiled blocks in Hexagon VTCM through double-buffered DMA. The
+   * tiles read by each iteration of the outermost reduction loop of a block tiled by
+   * MultiLevelTiling are cached into "global.vtcm", and the loop is marked as a software pipeline
+   * whose asynchronous copy stage overlaps with the compute on the resident tiles. The pipeline is
+   * lowered to DMA by LowerAsyncDMA when compiling with "tirx.use_async_copy". The schedule
+   * without the pipeline is kept as a candidate as well.
+   * \return The schedule rule created
+   */
+  TVM_DLL static ScheduleRule VTCMPipeline();
   /*!
    * \brief Auto bind loops around the block to BlockIdx and ThreadIdx
    * \param max_threadblocks The maximum number of threadblock on GPU
@@ -294,7 +333,7 @@ class ScheduleRule : public ffi::ObjectRef {
 
   /*! \brief Create default schedule rules for LLVM */
   TVM_DLL static ffi::Array<ScheduleRule, void> DefaultLLVM();
-  /*! \brief Create default schedule rules for x86 (AVX512 and VNNI) */
+  /*! \brief Create default schedule rules for x86 (AVX512, VNNI and AMX) */
   TVM_DLL static ffi::Array<ScheduleRule, void> DefaultX86(const ffi::String& type);
   /*! \brief Create default schedule rules for CUDA */
   TVM_DLL static ffi::Array<ScheduleRule, void> DefaultCUDA();
@@ -208,15 +208,36 @@ class SearchStrategy : public ffi::ObjectRef {
    * \param genetic_mutate_prob The probability of mutation.
    * \param genetic_max_fail_count The maximum number to try evolving the given trace.
    * \param eps_greedy The ratio to select samples in a greedy fashion via their predicted score.
+   * \param warm_start_top_k The number of best records of each database workload with the same
+   *  anchor block to warm-start the initial population with, 0 to disable it.
+   * \param design_space_keep_ratio The fraction of the design spaces kept for the search, ranked
+   *  by the cost model on a few random samples of each, 1.0 to keep all of them.
+   * \param design_space_prune_samples The number of samples of each design space to rank them.
    */
-  TVM_DLL static SearchStrategy EvolutionarySearch(int population_size,         //
-                                                   double init_measured_ratio,  //
-                                                   int init_min_unmeasured,     //
-                                                   int max_fail_count,          //
-                                                   int genetic_num_iters,       //
-                                                   double genetic_mutate_prob,  //
-                                                   int genetic_max_fail_count,  //
-                                                   double eps_greedy);
+  TVM_DLL static SearchStrategy EvolutionarySearch(int population_size,                   //
+                                                   double init_measured_ratio,            //
+                                                   int init_min_unmeasured,               //
+                                                   int max_fail_count,                    //
+                                                   int genetic_num_iters,                 //
+                                                   double genetic_mutate_prob,            //
+                                                   int genetic_max_fail_count,            //
+                                                   double eps_greedy,                     //
+                                                   int warm_start_top_k = 0,              //
+                                                   double design_space_keep_ratio = 1.0,  //
+                                                   int design_space_prune_samples = 8);
+
+  /*!
+   * \brief Constructor of transfer search strategy, which measures the best schedules of the
+   *  nearest tuned shape variant in the database applied to the workload before fine-tuning.
+   * \param fine_tune The strategy to fine-tune with, or to tune with when there is no variant.
+   * \param num_transfer_records The number of the best records of the variant to transfer.
+   * \param num_repair_trials The attempts with re-sampled decisions when the decisions misfit.
+   * \param max_fine_tune_trials The max number of fine-tuning trials after a transfer.
+   */
+  TVM_DLL static SearchStrategy TransferSearch(SearchStrategy fine_tune,  //
+                                               int num_transfer_records,  //
+                                               int num_repair_trials,     //
+                                               int max_fine_tune_trials);
 
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(SearchStrategy, ffi::ObjectRef, SearchStrategyNode);
 };
@@ -141,6 +141,12 @@ class TaskSchedulerNode : public ffi::Object {
   ffi::Optional<CostModel> cost_model_;
   /*! \brief The number of remaining tasks to be tuned. */
   int remaining_tasks_;
+  /*!
+   * \brief The max number of batches in flight in the pipelined mode, or 0 to disable it. In the
+   *  pipelined mode the scheduler prefers the tasks without a batch in flight, so that building
+   *  the batch of one task overlaps measuring the batches of the others.
+   */
+  int pipeline_depth = 0;
 
   /*! \brief The default destructor. */
   virtual ~TaskSchedulerNode() = default;
@@ -152,7 +158,8 @@ class TaskSchedulerNode : public ffi::Object {
         .def_ro("measure_callbacks_", &TaskSchedulerNode::measure_callbacks_)
         .def_ro("database_", &TaskSchedulerNode::database_)
         .def_ro("cost_model_", &TaskSchedulerNode::cost_model_)
-        .def_ro("remaining_tasks_", &TaskSchedulerNode::remaining_tasks_);
+        .def_ro("remaining_tasks_", &TaskSchedulerNode::remaining_tasks_)
+        .def_ro("pipeline_depth", &TaskSchedulerNode::pipeline_depth);
   }
 
   /*!
@@ -204,6 +211,17 @@ class TaskSchedulerNode : public ffi::Object {
 
   static constexpr const bool _type_mutable = true;
   TVM_FFI_DECLARE_OBJECT_INFO("s_tir.meta_schedule.TaskScheduler", TaskSchedulerNode, ffi::Object);
+
+ protected:
+  /*!
+   * \brief In the pipelined mode, join the oldest batches in flight until fewer than
+   *  `pipeline_depth` of them remain.
+   */
+  void WaitForPipelineSlot();
+
+ private:
+  /*! \brief The tasks with a batch in flight, in the order the batches were sent. */
+  std::vector<int> running_task_ids_;
 };
 
 class TaskScheduler;
@@ -267,19 +285,24 @@ class TaskScheduler : public ffi::ObjectRef {
   /*!
    * \brief Create a task scheduler that fetches tasks in a round-robin fashion.
    * \param logger The tuning task's logging function.
+   * \param pipeline_depth The max number of batches in flight in the pipelined mode, or 0 to
+   *  disable it.
    * \return The task scheduler created.
    */
-  TVM_DLL static TaskScheduler RoundRobin(ffi::Function logger);
+  TVM_DLL static TaskScheduler RoundRobin(ffi::Function logger, int pipeline_depth = 0);
   /*!
    * \brief Create a task scheduler that fetches tasks in a gradient based fashion.
    * \param logger The tuning task's logging function.
    * \param alpha The parameter alpha to control gradient computation.
    * \param window_size The parameter to control backward window size.
    * \param seed The random seed.
+   * \param pipeline_depth The max number of batches in flight in the pipelined mode, or 0 to
+   *  disable it.
    * \return The task scheduler created.
    */
   TVM_DLL static TaskScheduler GradientBased(ffi::Function logger, double alpha, int window_size,
-                                             LinearCongruentialEngine::TRandState seed);
+                                             LinearCongruentialEngine::TRandState seed,
+                                             int pipeline_depth = 0);
   /*!
    * \brief Create a task scheduler with customized methods on the python-side.
    * \param logger The tuning task's logging function.
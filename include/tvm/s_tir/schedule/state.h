@@ -23,6 +23,7 @@
 #ifndef TVM_S_TIR_SCHEDULE_STATE_H_
 #define TVM_S_TIR_SCHEDULE_STATE_H_
 
+#include <tvm/arith/analyzer.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/ir/module.h>
 #include <tvm/s_tir/sblock_scope.h>
@@ -63,6 +64,12 @@ struct SBlockInfo {
    * 3) All the statements in the scope are schedulable statements, i.e. SBlock and For
    */
   bool stage_pipeline{false};
+  /*!
+   * \brief The block that `scope` and `stage_pipeline` were fully computed from. The block is
+   * immutable, so while the sref still points to it, its subtree is unchanged and
+   * `ScheduleStateNode::UpdateScopeSBlockInfo` reuses the info instead of recomputing it.
+   */
+  ffi::Optional<SBlock> computed_from{std::nullopt};
 
   SBlockInfo() = default;
 
@@ -83,6 +90,8 @@ enum ScheduleDebugMask : uint32_t {
   kVerifySRefTree = 1,
   /*! \brief Verify the correctness of affine_binding, region_cover and stage_pipeline */
   kVerifyCachedFlags = 2,
+  /*! \brief Verify the dependencies of each block scope against a full recomputation */
+  kVerifySBlockScope = 4,
 };
 
 /*!
@@ -119,6 +128,19 @@ class ScheduleStateNode : public ffi::Object {
    * \brief Whether to enable prequisite checks for schedule primitives.
    */
   bool enable_check;
+  /*!
+   * \brief The analyzer shared by the block analysis across the schedule primitives, where the
+   *  loop vars are bound incrementally by `BindLoopVar`.
+   */
+  arith::Analyzer analyzer;
+  /*! \brief The ranges of the loop vars bound in `analyzer`, rebound when the loop is replaced */
+  std::unordered_map<Var, Range, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> bound_loop_ranges;
+  /*!
+   * \brief The memoized affine binding checks, keyed by the bindings and the predicate of a block
+   *  realize and the loop domain. The key holds everything the check depends on, so an entry
+   *  stays valid when the statements are replaced.
+   */
+  std::unordered_map<ffi::Any, bool, ffi::StructuralHash, ffi::StructuralEqual> affine_binding_memo;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -154,6 +176,7 @@ class ScheduleStateNode : public ffi::Object {
    * 1) If the bitmask `kVerifySRefTree` is on, verify the correctness of the sref tree.
    * 2) If the bitmask `kVerifyCachedFlags` is on, verify the correctness of `affine_binding`,
    * `region_cover` and `stage_pipeline`
+   * 3) If the bitmask `kVerifySBlockScope` is on, verify the dependencies of each block scope
    */
   TVM_DLL void DebugVerify() const;
 
@@ -167,8 +190,25 @@ class ScheduleStateNode : public ffi::Object {
    * \brief Recalculate the SBlockInfo recursively under stmt.
    * If stmt is a SBlock itself, we will not reset its affine binding flag unless it doesn't
    * have block vars, since the affine flag depends on the outer scope of stmt.
+   * The dependencies of nested blocks whose subtree is unchanged since their info was last
+   * computed are reused, only their affine binding flag is recomputed.
    */
   TVM_DLL void UpdateScopeSBlockInfo(const Stmt& stmt);
+  /*!
+   * \brief Bind the range of a loop var in `analyzer`, unless it is bound to the same range.
+   * \param loop_var The loop var
+   * \param dom The range of the loop var
+   */
+  TVM_DLL void BindLoopVar(const Var& loop_var, const Range& dom);
+  /*!
+   * \brief Check if a block realize has an affine binding under the loop domain, memoized in
+   *  `affine_binding_memo` across the schedule primitives.
+   * \param realize The block realize to be checked
+   * \param loop_var_ranges The ranges of the loops above the block realize
+   * \return A boolean flag indicating if the binding is affine
+   */
+  TVM_DLL bool IsAffineBindingMemoized(const SBlockRealize& realize,
+                                       const ffi::Map<Var, Range>& loop_var_ranges);
   /*!
    * \brief Get the SBlockScope correpsonding to the sref of scope root block
    * \param scope_root The block sref to be retrieved
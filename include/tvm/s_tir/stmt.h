@@ -71,6 +71,16 @@ constexpr const char* fragment_layout = "fragment_layout";
  */
 constexpr const char* pragma_loop_partition_hint = "pragma_loop_partition_hint";
 
+/*!
+ * \brief Mark the statements that only a warp-specialized subset of the threads executes.
+ *
+ *  The node is the IntImm id of a named barrier and the value is the number of threads that
+ *  execute the scope. ThreadSync synchronizes the shared memory accesses inside of the scope
+ *  with `bar.sync id, count` instead of a barrier of the whole block, so that the scope may be
+ *  guarded by a thread dependent condition. Only CUDA lowers the named barriers.
+ */
+constexpr const char* named_barrier_scope = "named_barrier_scope";
+
 /*! \brief Mark of reduce scope */
 constexpr const char* reduce_scope = "reduce_scope";
 
@@ -158,6 +168,21 @@ constexpr const char* software_pipeline_order = "software_pipeline_order";
  */
 constexpr const char* software_pipeline_async_stages = "software_pipeline_async_stages";
 
+/*! \brief Mark a software pipeline whose stages are prefetched into the CPU cache
+ * \note Instead of multi-versioned buffers, the reads of a statement in stage N are prefetched
+ *       N iterations ahead with `tirx.prefetch`, and the statements keep their original order.
+ */
+constexpr const char* software_pipeline_prefetch = "software_pipeline_prefetch";
+
+/*! \brief Mark a software pipeline whose stages run on separate producer and consumer warps
+ * \note The value is [num_stages, producer_extent, producer_regs, consumer_regs]. The statements
+ *       in stage 0 run on `producer_extent` extra threads of the outermost thread dimension and
+ *       fill `num_stages` versions of their shared buffers, the other statements run on the
+ *       original threads, and mbarriers hand each version over. Nonzero register counts are
+ *       reallocated with `setmaxnreg` when both roles are whole warpgroups.
+ */
+constexpr const char* software_pipeline_warp_specialize = "software_pipeline_warp_specialize";
+
 /*! \brief Mark the buffers which is const access and can be transformed layout. */
 constexpr const char* layout_free_buffers = "layout_free_buffers";
 
@@ -337,6 +337,24 @@ TVM_DLL const Op& tvm_struct_set();
  */
 TVM_DLL const Op& lookup_param();
 
+/*!
+ * \brief See pseudo code
+ * void* static_workspace_ptr(int64_t offset) {
+ *     return __tvm_static_workspace + offset;
+ * }
+ * \sa transform::PlanStaticWorkspace
+ */
+TVM_DLL const Op& static_workspace_ptr();
+
+/*!
+ * \brief See pseudo code
+ * void* function_address(ffi::String global_symbol) {
+ *     return &global_symbol;
+ * }
+ *  The function must be defined in the same module.
+ */
+TVM_DLL const Op& function_address();
+
 /*!
  * \brief See pesudo code
  *
@@ -493,6 +511,9 @@ TVM_DLL const Op& tvm_call_trace_packed_lowered();
  *     __sync(storage_scope);
  *     return 0;
  *  }
+ *
+ *  A "shared" sync may take the id of a named barrier and the number of threads that arrive
+ *  at it as two extra arguments, to only synchronize the threads of a warp-specialized scope.
  */
 TVM_DLL const Op& tvm_storage_sync();
 
@@ -361,6 +361,35 @@ constexpr const char* kIsEntryFunc = "tirx.is_entry_func";
  */
 constexpr const char* kIsGlobalFunc = "tirx.is_global_func";
 
+/*!
+ * \brief Mark the function to get an unchecked packed entry besides the checked one.
+ *
+ * MakePackedAPI then also emits a "<global_symbol>_unchecked" entry that decodes the packed
+ * arguments without validating them, for callers that prove the argument types, shapes and
+ * devices at compile time.
+ *
+ * Type: bool
+ */
+constexpr const char* kEmitUncheckedEntry = "tirx.emit_unchecked_entry";
+
+/*! \brief The suffix of the global symbol of the unchecked packed entry. */
+constexpr const char* kUncheckedEntrySuffix = "_unchecked";
+
+/*!
+ * \brief Mark the host function to get a direct C entry besides its packed entry.
+ *
+ * MakePackedAPI then also emits `int32_t <global_symbol>_direct_entry(void* const* args)`,
+ * which receives the data pointer of each buffer and the value of each integer parameter
+ * without boxing or checks, and a packed function "<global_symbol>_direct" that returns the
+ * address of the entry. The buffers must have static compact shapes.
+ *
+ * Type: bool
+ */
+constexpr const char* kEmitDirectEntry = "tirx.emit_direct_entry";
+
+/*! \brief The suffix of the packed function that returns the address of the direct entry. */
+constexpr const char* kDirectEntrySuffix = "_direct";
+
 /*!
  * \brief Mark the function as run on the host, mutually exclusive with kTarget.
  *
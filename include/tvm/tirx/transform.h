@@ -52,12 +52,18 @@ using tvm::transform::Sequential;
  * \param opt_level The optimization level of the function pass.
  * \param name The name of the function pass.
  * \param required The list of the passes that the function pass is dependent on.
+ * \param traceable Boolean that tells whether the pass is traceable.
+ * \param thread_safe Whether pass_func may run on several functions of a module at once.
+ *        Such a pass runs on `tirx.num_function_pass_threads` threads when the option is
+ *        larger than one, and its results are cached when `ir.pass_cache_dir` is set.
+ *        pass_func must then depend on nothing but its function and the pass context.
  *
  * \return The created function pass.
  */
 TVM_DLL Pass CreatePrimFuncPass(std::function<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
                                 int opt_level, ffi::String name,
-                                tvm::ffi::Array<ffi::String> required, bool traceable = false);
+                                tvm::ffi::Array<ffi::String> required, bool traceable = false,
+                                bool thread_safe = false);
 
 /*!
  * \brief Lower vectorization loops.
@@ -191,6 +197,25 @@ static constexpr const char* kDisableLowerTVMBuiltin = "disable_lower_builtin";
  */
 TVM_DLL Pass LowerTVMBuiltin();
 
+/*!
+ * \brief The module attribute of the bytes of the static workspace arena, set by
+ *  PlanStaticWorkspace.
+ */
+static constexpr const char* kStaticWorkspaceBytes = "tirx.static_workspace_bytes";
+
+/*!
+ * \brief Plan the workspaces of the C host functions into one static arena of the module.
+ *
+ *  The CPU allocations that LowerTVMBuiltin would lower to TVMBackendAllocWorkspace become
+ *  pointers at constant offsets of the arena, which the C host codegen emits as a static
+ *  buffer. The size of the arena is the peak workspace memory of the module, and is stored in
+ *  the kStaticWorkspaceBytes attribute of the module. The allocations with a dynamic shape, and
+ *  the ones inside of parallel loops, stay runtime workspaces.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass PlanStaticWorkspace();
+
 /*!
  * \brief Lower the target specific function intrinsics in each of the function.
  *
@@ -210,6 +235,9 @@ TVM_DLL Pass LowerWarpMemory();
  * \param target_bits The target bits
  *
  * \note Run this pass after storage flatten.
+ * \note With the pass config `tirx.narrow_datatype_runtime_check`, the expressions whose
+ *  bounds over the loops only depend on integer params are narrowed as well, and the body is
+ *  versioned on a runtime check of these bounds, falling back to the wide indices.
  * \return The pass.
  */
 TVM_DLL Pass NarrowDataType(int target_bits);
@@ -387,6 +387,22 @@ class Analyzer(Object):
         """
         _ffi_api.AnalyzerSetMaximumRewriteSteps(self, maximum)
 
+    def set_simplify_memo_table_size(self, size: int) -> None:
+        """Set the size of the memo tables of rewrite and canonical simplification.
+
+        When a positive size is set, top-level simplification results are
+        memoized under the current bindings and constraints, and simplifying
+        the same expression again reuses the result.  The ``memo_hits`` and
+        ``memo_misses`` fields of the rewrite-simplify stats count the lookups.
+
+        Parameters
+        ----------
+        size : int
+            The maximum number of memoized results, or a non-positive value to
+            disable memoization.
+        """
+        _ffi_api.AnalyzerSetSimplifyMemoTableSize(self, size)
+
     def bind(
         self,
         var: tirx.Var,
@@ -171,6 +171,56 @@ def detect_iter_map(
     )
 
 
+def detect_iter_map_batch(
+    indices_list,
+    input_iters,
+    predicate=True,
+    check_level=IterMapLevel.Surjective,
+    simplify_trivial_iterators=True,
+    analyzer=None,
+):
+    """Detect the iter map of several index lists over the same input iters
+
+    Each result is the same as :py:func:`detect_iter_map` on the corresponding list,
+    while the predicate is parsed and its constraints are rewritten only once.
+
+    Parameters
+    ----------
+    indices_list : List[List[Expr]]
+        The input index lists
+
+    input_iters : Map[tvm.tirx.Var, Range]
+        The domain of each input iterators.
+
+    predicate : Expr
+        The predicate constraints on the input iterators
+
+    check_level : Union[str, IterMapLevel]
+        Checking level of iteration mapping
+
+    simplify_trivial_iterators: bool
+        If true, iterators with extent of 1 will be replaced with a
+        constant value.
+
+    analyzer : Optional[tvm.arith.Analyzer]
+        The analyzer to use.  When provided, its accumulated bindings and
+        constraints are reused; otherwise a fresh analyzer is created.
+
+    Returns
+    -------
+    results : List[IterMapResult]
+        The iter map matching result of each index list.
+
+    """
+    if isinstance(check_level, str):
+        check_level = IterMapLevel.from_str(check_level)
+    elif check_level is None:
+        check_level = IterMapLevel.NoCheck
+    return _ffi_api.DetectIterMapBatch(
+        indices_list, input_iters, predicate, check_level, simplify_trivial_iterators, analyzer
+    )
+
+
 def normalize_to_iter_sum(index, input_iters, analyzer=None):
     """Normalize expr to iter sum.
 
@@ -92,3 +92,35 @@ def batch_matmul(lhs, rhs, transa=False, transb=False, iterative=False, **kwargs
         name="C",
         **kwargs,
     )
+
+
+def grouped_matmul(lhs, rhs, indptr, transb=False, **kwargs):
+    """Create an extern op that multiplies each row group of lhs by its own matrix with CBLAS,
+    as the tokens routed to each expert of a mixture of experts.
+
+    Parameters
+    ----------
+    lhs: Tensor
+        The left operand of shape [total_rows, k]
+    rhs: Tensor
+        The right operands of shape [num_groups, k, n], or [num_groups, n, k] if transb
+    indptr: Tensor
+        The int64 row offsets of the groups in lhs, of shape [num_groups + 1]
+    transb: bool
+        Whether transpose rhs
+
+    Returns
+    -------
+    C: Tensor
+        The result tensor of shape [total_rows, n].
+    """
+    m = rhs.shape[1] if transb else rhs.shape[2]
+    return te.extern(
+        (lhs.shape[0], m),
+        [lhs, rhs, indptr],
+        lambda ins, outs: tvm.tirx.call_packed(
+            "tvm.contrib.cblas.grouped_matmul", ins[0], ins[1], ins[2], outs[0], transb
+        ),
+        name="C",
+        **kwargs,
+    )
@@ -370,6 +370,15 @@ def instantiate_gemm_template(attrs):
                 ),
             }
         )
+    elif has_residual_block:
+        # The fused epilogue skips the bias vector if its pointer is null.
+        aux_map.update(
+            {
+                "bias_decl": "void* ptr_bias = nullptr;\n",
+                "ptr_c": "ptr_out",
+                "c_stride": attrs["ldc"],
+            }
+        )
     else:
         aux_map.update({"bias_decl": "", "ptr_c": "ptr_out", "c_stride": attrs["ldc"]})
 
@@ -128,6 +128,8 @@ class TensorCacheShardingManager:
             "dtype": dtype,
             "format": encode_format,
             "nbytes": len(data),
+            # identical parameters of several models share one tensor when loaded
+            "contentHash": hashlib.sha256(data).hexdigest(),
         }
         if name in self.name_to_record:
             if not allow_update:
@@ -199,6 +201,87 @@ class TensorCacheShardingManager:
         return len(self.curr_data)
 
 
+def _encode_tensor(origin_v, encode_format):
+    """Encode a tensor into the bytes of a tensor cache record.
+
+    Returns the encoded bytes, the shape, the dtype string, and whether
+    float32 data was converted to bfloat16.
+    """
+    shape = list(origin_v.shape)
+    v = origin_v
+    if not isinstance(v, np.ndarray):
+        v = v.numpy()
+
+    # prefer to preserve original dtype, especially if the format was bfloat16
+    dtype = origin_v.dtype if isinstance(origin_v, tvm.runtime.Tensor) else v.dtype
+
+    if dtype in DataType._NUMPY_DTYPE_TO_STR:
+        dtype = DataType._NUMPY_DTYPE_TO_STR[dtype]
+    else:
+        dtype = str(dtype)
+
+    # convert fp32 to bf16
+    if encode_format == "f32-to-bf16" and dtype == "float32":
+        return _convert_f32_to_bf16(v).tobytes(), shape, dtype, True
+    return v.tobytes(), shape, dtype, False
+
+
+def _decode_tensor(rec, buffer_source, device):
+    """Decode the bytes of a tensor cache record into a tensor on the device."""
+    shape = rec["shape"]
+    dtype = rec["dtype"]
+    encode_format = rec["format"]
+
+    arr = tvm.runtime.empty(shape, dtype, device=device)
+    if dtype == "float8_e4m3fn":
+        if ml_dtypes is not None:
+            dtype = ml_dtypes.float8_e4m3fn
+        else:
+            raise RuntimeError(
+                "ml_dtypes is not installed, cannot convert float8_e4m3fn array to numpy."
+            )
+    if dtype == "float8_e5m2":
+        if ml_dtypes is not None:
+            dtype = ml_dtypes.float8_e5m2
+        else:
+            raise RuntimeError(
+                "ml_dtypes is not installed, cannot convert float8_e5m2 array to numpy."
+            )
+    if encode_format == "f32-to-bf16" and dtype == "float32":
+        data = np.frombuffer(buffer_source, dtype="uint16").reshape(shape)
+        arr.copyfrom(_convert_bf16_to_f32(data))
+    elif dtype == "bfloat16":
+        data = np.frombuffer(buffer_source, dtype="uint16").reshape(shape)
+        arr.copyfrom(data)
+    else:
+        data = np.frombuffer(buffer_source, dtype=dtype).reshape(shape)
+        arr.copyfrom(data)
+    return arr
+
+
+def _save_tensor_cache_json(cache_dir, records, meta_data, f32_to_bf16_triggered):
+    """Write tensor-cache.json, and tensor-cache-b16.json when bfloat16 data was produced.
+
+    Returns the paths of the two files, the second one being None if it was not written.
+    """
+    nd_cache_json = os.path.join(cache_dir, "tensor-cache.json")
+    with open(nd_cache_json, "w") as outfile:
+        json.dump({"metadata": meta_data, "records": records}, outfile, indent=4)
+
+    if not f32_to_bf16_triggered:
+        return nd_cache_json, None
+    for shard in records:
+        for item in shard["records"]:
+            if item["dtype"] == "float32":
+                item["format"] = "raw"
+                item["dtype"] = "bfloat16"
+    b16_nd_cache_json = os.path.join(cache_dir, "tensor-cache-b16.json")
+    # also dump a file that contains bf16
+    with open(b16_nd_cache_json, "w") as outfile:
+        json.dump({"metadata": meta_data, "records": records}, outfile, indent=4)
+    return nd_cache_json, b16_nd_cache_json
+
+
 def dump_tensor_cache(
     params: Mapping[str, np.ndarray | tvm.runtime.Tensor]
     | Iterator[tuple[str, np.ndarray | tvm.runtime.Tensor]],
@@ -270,27 +353,9 @@ def dump_tensor_cache(
 
     param_generator = params.items() if not from_generator else params
     for k, origin_v in param_generator:
-        shape = list(origin_v.shape)
-        v = origin_v
-        if not isinstance(v, np.ndarray):
-            v = v.numpy()
-
-        # prefer to preserve original dtype, especially if the format was bfloat16
-        dtype = origin_v.dtype if isinstance(origin_v, tvm.runtime.Tensor) else v.dtype
-
-        if dtype in DataType._NUMPY_DTYPE_TO_STR:
-            dtype = DataType._NUMPY_DTYPE_TO_STR[dtype]
-        else:
-            dtype = str(dtype)
-
-        total_bytes += math.prod(v.shape) * np.dtype(v.dtype).itemsize
-
-        # convert fp32 to bf16
-        if encode_format == "f32-to-bf16" and dtype == "float32":
-            data = _convert_f32_to_bf16(v).tobytes()
-            f32_to_bf16_triggered = True
-        else:
-            data = v.tobytes()
+        data, shape, dtype, converted = _encode_tensor(origin_v, encode_format)
+        f32_to_bf16_triggered = f32_to_bf16_triggered or converted
+        total_bytes += len(data)
 
         shard_manager.append_or_update(
             data,
@@ -311,25 +376,148 @@ def dump_tensor_cache(
     records = shard_manager.finish()
     meta_data = {} if meta_data is None else meta_data if not callable(meta_data) else meta_data()
 
-    with open(nd_cache_json, "w") as outfile:
-        json.dump({"metadata": meta_data, "records": records}, outfile, indent=4)
+    _, b16_nd_cache_json = _save_tensor_cache_json(
+        cache_dir, records, meta_data, f32_to_bf16_triggered
+    )
     print(
         f"\nAll finished, {shard_manager.counter} total shards committed, record saved to {nd_cache_json}"
     )
-
-    if f32_to_bf16_triggered:
-        for shard in records:
-            for item in shard["records"]:
-                if item["dtype"] == "float32":
-                    item["format"] = "raw"
-                    item["dtype"] = "bfloat16"
-        b16_nd_cache_json = os.path.join(cache_dir, "tensor-cache-b16.json")
-        # also dump a file that contains bf16
-        with open(b16_nd_cache_json, "w") as outfile:
-            json.dump({"metadata": meta_data, "records": records}, outfile, indent=4)
+    if b16_nd_cache_json is not None:
         print(f"Also saved a bf16 record to {b16_nd_cache_json}")
 
 
+def _apply_shard_funcs(value, shard_funcs, mod):
+    """Run the shard functions of a parameter in order, as the disco ShardLoader does."""
+    if not isinstance(value, tvm.runtime.Tensor):
+        value = tvm.runtime.tensor(value)
+    for name, (shape, dtype), *func_params in shard_funcs:
+        if mod is not None and mod.implements_function(name):
+            func = mod.get_function(name)
+        else:
+            func = tvm.get_global_func(name, allow_missing=True)
+        if func is None:
+            raise ValueError(f"Undefined function: {name}")
+        out = tvm.runtime.empty(shape, dtype, device=value.device)
+        func(value, *func_params, out)
+        value = out
+    return value
+
+
+def dump_presharded_tensor_cache(
+    params: Mapping[str, np.ndarray | tvm.runtime.Tensor]
+    | Iterator[tuple[str, np.ndarray | tvm.runtime.Tensor]],
+    cache_dir: str,
+    shard_info: Mapping[str, list] | str,
+    num_shards: int,
+    mod: tvm.runtime.Module | None = None,
+    encode_format="raw",
+    meta_data=None,
+    shard_cap_mb=32,
+    show_progress: bool = True,
+):
+    """Run the shard functions once and dump the shards of every worker to Tensor cache.
+
+    The disco ShardLoader otherwise loads every unsharded parameter on worker 0, applies the
+    shard functions and scatters the slices at each startup. The cache dumped here is instead
+    loaded with `runtime.disco.ShardLoaderLoadAllPresharded`, where each worker reads only its
+    own shards, in parallel, without collective communication.
+
+    Shard k of the parameter `name` for worker i is stored as `{name}_shard-{i + 1}-of-{k}`.
+    The records are ordered by worker, and the binary files of different workers are disjoint.
+    Parameters without shard functions are replicated to every worker.
+
+    Parameters
+    ----------
+    params: Union[
+        Mapping[str, Union[np.ndarray, tvm.runtime.Tensor]],
+        Iterator[Tuple[str, Union[np.ndarray, tvm.runtime.Tensor]]],
+    ]
+        The unsharded parameter dictionary or generator, named `param_0`, `param_1`, etc.
+
+    cache_dir: str
+        The path to the cache
+
+    shard_info: Union[Mapping[str, list], str]
+        The shard functions of each parameter, in the format of the `get_shard_info`
+        function of the compiled module, or its JSON string. The output of the last shard
+        function of a parameter has the number of shards as its first dimension.
+
+    num_shards: int
+        The number of workers.
+
+    mod: Optional[tvm.runtime.Module]
+        The module to look up the shard functions in, before the global functions.
+
+    encode_format: {"f32-to-bf16", "raw"}
+        Encoding format.
+
+    meta_data: json-compatible-struct or Callable[[], Any]
+        Extra meta_data to be stored in the cache json file,
+        or a callable that returns the metadata.
+
+    shard_cap_mb: int
+        Maxinum number of MB to be kept per shard
+
+    show_progress: bool
+        A boolean indicating if to show the dump progress.
+    """
+    if encode_format not in ("raw", "f32-to-bf16"):
+        raise ValueError(f"Invalie encode_format {encode_format}")
+    if isinstance(shard_info, str):
+        shard_info = json.loads(shard_info)
+
+    if not os.path.exists(cache_dir):
+        os.makedirs(cache_dir)
+
+    print(f"Start storing presharded parameters to cache {cache_dir}")
+    # One sharding manager per worker, so that no binary file holds the data of two workers.
+    shard_cap_nbytes = shard_cap_mb * (1 << 20)
+    shard_managers = [
+        TensorCacheShardingManager(cache_dir, f"params_shard_{i}", shard_cap_nbytes)
+        for i in range(num_shards)
+    ]
+    f32_to_bf16_triggered = False
+    counter = 0
+    max_out_length = 0
+
+    param_generator = params.items() if not isinstance(params, GeneratorType) else params
+    for k, origin_v in param_generator:
+        shard_funcs = shard_info.get(k, [])
+        value = _apply_shard_funcs(origin_v, shard_funcs, mod)
+        if shard_funcs and (len(value.shape) == 0 or value.shape[0] != num_shards):
+            raise ValueError(
+                f"The first dimension of the sharded {k} must be the number of shards "
+                f"{num_shards}, but got shape {value.shape}"
+            )
+        value = value.numpy() if shard_funcs else value
+        for i, shard_manager in enumerate(shard_managers):
+            shard = value[i] if shard_funcs else value
+            data, shape, dtype, converted = _encode_tensor(shard, encode_format)
+            if shard_funcs:
+                dtype = shard_funcs[-1][1][1]
+            f32_to_bf16_triggered = f32_to_bf16_triggered or converted
+            shard_manager.append_or_update(
+                data,
+                name=f"{k}_shard-{i + 1}-of-{num_shards}",
+                shape=shape,
+                dtype=dtype,
+                encode_format=encode_format,
+            )
+
+        counter += 1
+        if show_progress:
+            last_cmd = f"[{counter:04d}] saving {k}"
+            flush = "\r" + (" " * max_out_length) + "\r"
+            max_out_length = max(len(last_cmd), max_out_length)
+            sys.stdout.write(flush + last_cmd)
+
+    records = [record for manager in shard_managers for record in manager.finish()]
+    meta_data = {} if meta_data is None else meta_data if not callable(meta_data) else meta_data()
+    _save_tensor_cache_json(cache_dir, records, meta_data, f32_to_bf16_triggered)
+    num_files = sum(manager.counter for manager in shard_managers)
+    print(f"\nAll finished, {num_files} total shards committed for {num_shards} workers")
+
+
 def load_tensor_cache(cachepath: str, device: tvm.runtime.Device):
     """Load the tensor cache from the directory or json.
 
@@ -357,43 +545,132 @@ def load_tensor_cache(cachepath: str, device: tvm.runtime.Device):
         assert shard_rec["nbytes"] == len(raw_data)
 
         for rec in shard_rec["records"]:
-            name = rec["name"]
-            shape = rec["shape"]
-            dtype = rec["dtype"]
-            encode_format = rec["format"]
             offset = rec["byteOffset"]
             nbytes = rec["nbytes"]
-
-            arr = tvm.runtime.empty(shape, dtype, device=device)
             assert offset + nbytes <= len(raw_data)
-            buffer_source = raw_data[offset : offset + nbytes]
-            if dtype == "float8_e4m3fn":
-                if ml_dtypes is not None:
-                    dtype = ml_dtypes.float8_e4m3fn
-                else:
-                    raise RuntimeError(
-                        "ml_dtypes is not installed, cannot convert float8_e4m3fn array to numpy."
-                    )
-            if dtype == "float8_e5m2":
-                if ml_dtypes is not None:
-                    dtype = ml_dtypes.float8_e5m2
-                else:
-                    raise RuntimeError(
-                        "ml_dtypes is not installed, cannot convert float8_e5m2 array to numpy."
-                    )
-            if encode_format == "f32-to-bf16" and dtype == "float32":
-                data = np.frombuffer(buffer_source, dtype="uint16").reshape(shape)
-                arr.copyfrom(_convert_bf16_to_f32(data))
-            elif dtype == "bfloat16":
-                data = np.frombuffer(buffer_source, dtype="uint16").reshape(shape)
-                arr.copyfrom(data)
-            else:
-                data = np.frombuffer(buffer_source, dtype=dtype).reshape(shape)
-                arr.copyfrom(data)
-            result_dict[name] = arr
+            result_dict[rec["name"]] = _decode_tensor(
+                rec, raw_data[offset : offset + nbytes], device
+            )
     return result_dict, json_info["metadata"]
 
 
+def stream_transform_params(
+    transform_func,
+    input_names: list[str],
+    output_names: list[str],
+    src_cache_dir: str,
+    cache_dir: str,
+    device: tvm.runtime.Device,
+    fget_item: str = "get_item",
+    fset_item: str = "set_item",
+    encode_format: str = "raw",
+    meta_data=None,
+    shard_cap_mb: int = 32,
+):
+    """Run a lazy parameter transformation from one tensor cache into another.
+
+    The transformation is a `transform_params` function rewritten by
+    `relax.transform.LazyTransformParams`, which requests every input
+    through the `fget_item` global function and hands every output to
+    `fset_item`. Inputs are read from `src_cache_dir` one raw shard at a
+    time, so that only the shard of the current input is resident, and
+    outputs are appended to the shards of `cache_dir` as soon as they are
+    produced. Peak memory thus stays near one input shard and one output
+    shard, instead of holding all of the transformed parameters at once.
+
+    Parameters
+    ----------
+    transform_func: Callable[[], Any]
+        The lazy transformation, e.g. `vm["transform_params"]`.
+
+    input_names: List[str]
+        The name in `src_cache_dir` of each input index of `fget_item`.
+
+    output_names: List[str]
+        The name to save in `cache_dir` for each output index of `fset_item`.
+
+    src_cache_dir: str
+        The tensor cache holding the raw parameters.
+
+    cache_dir: str
+        The directory of the tensor cache to write.
+
+    device: tvm.runtime.Device
+        The device on which the raw parameters are loaded.
+
+    fget_item: str
+        The name of the get_item function used by the transformation.
+
+    fset_item: str
+        The name of the set_item function used by the transformation.
+
+    encode_format: {"f32-to-bf16", "raw"}
+        Encoding format of the written tensor cache.
+
+    meta_data: json-compatible-struct or Callable[[], Any]
+        Extra meta_data to be stored in the cache json file,
+        or a callable that returns the metadata.
+
+    shard_cap_mb: int
+        Maxinum number of MB to be kept per output shard
+    """
+    if encode_format not in ("raw", "f32-to-bf16"):
+        raise ValueError(f"Invalie encode_format {encode_format}")
+    with open(os.path.join(src_cache_dir, "tensor-cache.json")) as infile:
+        src_shards = json.load(infile)["records"]
+    name_to_record = {}
+    for shard_idx, shard_rec in enumerate(src_shards):
+        assert shard_rec["format"] == "raw-shard"
+        for rec in shard_rec["records"]:
+            name_to_record[rec["name"]] = (shard_idx, rec)
+
+    if not os.path.exists(cache_dir):
+        os.makedirs(cache_dir)
+    shard_manager = TensorCacheShardingManager(cache_dir, "params_shard", shard_cap_mb * (1 << 20))
+    # Only the raw shard of the most recently requested input is kept in memory.
+    loaded_shard = {"index": None, "data": None}
+    written = set()
+    f32_to_bf16_triggered = False
+
+    def get_item(index):
+        shard_idx, rec = name_to_record[input_names[index]]
+        if loaded_shard["index"] != shard_idx:
+            loaded_shard["data"] = None
+            data_path = os.path.join(src_cache_dir, src_shards[shard_idx]["dataPath"])
+            with open(data_path, "rb") as infile:
+                loaded_shard["data"] = infile.read()
+            loaded_shard["index"] = shard_idx
+        offset = rec["byteOffset"]
+        return _decode_tensor(rec, loaded_shard["data"][offset : offset + rec["nbytes"]], device)
+
+    def set_item(index, value):
+        nonlocal f32_to_bf16_triggered
+        if index in written:
+            raise ValueError(f"Output {output_names[index]} is set more than once.")
+        written.add(index)
+        data, shape, dtype, converted = _encode_tensor(value, encode_format)
+        f32_to_bf16_triggered = f32_to_bf16_triggered or converted
+        shard_manager.append_or_update(
+            data,
+            name=output_names[index],
+            shape=shape,
+            dtype=dtype,
+            encode_format=encode_format,
+        )
+
+    tvm.register_global_func(fget_item, get_item, override=True)
+    tvm.register_global_func(fset_item, set_item, override=True)
+    transform_func()
+    loaded_shard["data"] = None
+
+    if len(written) != len(output_names):
+        missing = [name for i, name in enumerate(output_names) if i not in written]
+        raise ValueError(f"The transformation did not produce outputs {missing}.")
+    records = shard_manager.finish()
+    meta_data = {} if meta_data is None else meta_data if not callable(meta_data) else meta_data()
+    _save_tensor_cache_json(cache_dir, records, meta_data, f32_to_bf16_triggered)
+
+
 def export_runtime(runtime_dir):
     """Export TVMJS runtime to the runtime_dir
 
@@ -75,6 +75,7 @@ def compile(  # pylint: disable=redefined-builtin
     *,
     relax_pipeline: tvm.transform.Pass | Callable | str | None = "default",
     tir_pipeline: tvm.transform.Pass | Callable | str | None = "default",
+    exec_mode: str = "bytecode",
 ) -> Executable:
     """
     Compile an IRModule to a runtime executable.
@@ -94,6 +95,11 @@ def compile(  # pylint: disable=redefined-builtin
         Only used if the module contains Relax functions.
     tir_pipeline : Optional[Union[tvm.transform.Pass, Callable, str]]
         The compilation pipeline to use for TIR functions.
+    exec_mode : {"bytecode", "compiled"}
+        The execution mode of Relax functions.
+        "bytecode" interprets the VM bytecode, while "compiled" compiles every
+        Relax function to native host code, which removes the interpreter dispatch.
+        Only used if the module contains Relax functions.
 
     Returns
     -------
@@ -107,6 +113,7 @@ def compile(  # pylint: disable=redefined-builtin
             target,
             relax_pipeline=relax_pipeline,
             tir_pipeline=tir_pipeline,
+            exec_mode=exec_mode,
         )
     lib = tvm.tirx.build(mod, target, pipeline=tir_pipeline)
     return Executable(lib)
@@ -44,6 +44,11 @@ def _add_one_tensor(x: Tensor) -> Tensor:
     return tensor(x.numpy() + 1)
 
 
+@register_global_func("tests.disco.pipeline_stage_add_one", override=True)
+def _pipeline_stage_add_one(x: Tensor, micro_batch: int) -> Tensor:
+    return tensor(x.numpy() + micro_batch + 1, device=x.device)
+
+
 @register_global_func("tests.disco.str", override=True)
 def _str_func(x: str):
     return x + "_suffix"
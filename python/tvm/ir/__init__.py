@@ -27,7 +27,9 @@ from .base import (
     Span,
     SequentialSpan,
     assert_structural_equal,
+    load_binary,
     load_json,
+    save_binary,
     save_json,
 )
 
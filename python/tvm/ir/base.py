@@ -162,6 +162,43 @@ def save_json(node) -> str:
     return to_json_graph_str(node, {"tvm_version": __version__})
 
 
+def load_binary(data: bytes) -> Object:
+    """Load tvm object from the binary form saved by :py:func:`save_binary`.
+
+    Parameters
+    ----------
+    data : bytes
+        The serialized bytes.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return _ffi_api.LoadBinary(data)  # type: ignore # pylint: disable=no-member
+
+
+def save_binary(node) -> bytes:
+    """Save tvm object in the compact binary form.
+
+    The binary form covers the same objects as :py:func:`save_json`, stores each string and
+    each shared node once, and loads much faster than the JSON graph. It is meant for caching
+    compile artifacts with the same build of TVM, and does not upgrade the data of older
+    versions as :py:func:`load_json` does.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    data : bytes
+        The serialized bytes.
+    """
+    return bytes(_ffi_api.SaveBinary(node))  # type: ignore # pylint: disable=no-member
+
+
 def assert_structural_equal(lhs, rhs, map_free_vars=False):
     """Assert lhs and rhs are structurally equal to each other.
 
@@ -259,6 +259,102 @@ class PassTimingInstrument(tvm.runtime.Object):
         return _ffi_instrument_api.RenderTimePassProfiles()
 
 
+@tvm_ffi.register_object("instrument.PassInstrument")
+class PassCacheInstrument(tvm.runtime.Object):
+    """A wrapper to create a pass cache instrument that implemented in C++.
+
+    The instrument resets the lookup and hit counters of the pass cache, which is
+    enabled by the ``ir.pass_cache_dir`` config, when entering the pass context.
+    """
+
+    def __init__(self):
+        self.__init_handle_by_constructor__(_ffi_instrument_api.MakePassCacheInstrument)
+
+    @staticmethod
+    def render():
+        """Retrieve the rendered hit rates of the pass cache
+
+        Returns
+        -------
+        string : string
+            The hit rate of each cached pass, followed by the total hit rate
+
+        Examples
+        --------
+
+        .. code-block:: python
+
+            cache_inst = PassCacheInstrument()
+            config = {"ir.pass_cache_dir": "/tmp/tvm-pass-cache"}
+            with tvm.transform.PassContext(config=config, instruments=[cache_inst]):
+                mod = tvm.tirx.transform.StmtSimplify()(mod)
+                hit_rates = cache_inst.render()
+        """
+        return _ffi_instrument_api.RenderPassCacheStats()
+
+
+@tvm_ffi.register_object("instrument.PassProfilingInstrument")
+class PassProfilingInstrument(tvm.runtime.Object):
+    """A wrapper to create a pass profiling instrument that implemented in C++.
+
+    In addition to the duration of each pass, the instrument records the time of each pass
+    relative to the entry of the pass context and the peak resident set size of the process
+    after it. Optionally, it also counts the IR nodes of the module before and after each pass,
+    and breaks the function passes of Relax and TIR down per function. The profile of the last
+    pass context is kept after the context exits.
+
+    Parameters
+    ----------
+    count_nodes : bool
+        Whether to count the IR nodes of the module before and after each pass. Counting walks
+        the whole module twice per pass, which is not included in the times of the passes.
+
+    per_function : bool
+        Whether to record the time and the IR nodes of each function.
+    """
+
+    def __init__(self, count_nodes: bool = True, per_function: bool = True):
+        self.__init_handle_by_constructor__(
+            _ffi_instrument_api.MakePassProfilingInstrument, count_nodes, per_function
+        )
+
+    def render_json(self) -> str:
+        """Retrieve the profile as JSON
+
+        Returns
+        -------
+        string : string
+            A JSON object with the nested ``passes``, each with its ``name``, ``start_us``,
+            ``duration_us``, ``self_us``, ``peak_rss_kb``, the ``nodes_before`` and
+            ``nodes_after`` when counted and the per-function ``functions``, along with the
+            ``total_us`` and the ``peak_rss_kb`` of the whole run.
+        """
+        return _ffi_instrument_api.PassProfilingInstrumentRenderJSON(self)
+
+    def render_chrome_trace(self) -> str:
+        """Retrieve the profile as a Chrome trace
+
+        Returns
+        -------
+        string : string
+            The passes and the functions as events of the trace event format, which
+            ``chrome://tracing`` and Perfetto open, with the peak resident set size and the IR
+            nodes as counters.
+
+        Examples
+        --------
+
+        .. code-block:: python
+
+            profiling_inst = PassProfilingInstrument()
+            with tvm.transform.PassContext(instruments=[profiling_inst]):
+                ex = tvm.compile(mod, target="llvm")
+            with open("compile_trace.json", "w") as f:
+                f.write(profiling_inst.render_chrome_trace())
+        """
+        return _ffi_instrument_api.PassProfilingInstrumentRenderChromeTrace(self)
+
+
 @pass_instrument
 class PassPrintingInstrument:
     """A pass instrument to print if before or
@@ -19,7 +19,7 @@
 """The Relax IR namespace containing the IR, type, operator, builder, vm, etc."""
 
 from tvm.runtime import vm
-from tvm.runtime.vm import VirtualMachine, VMInstrumentReturnKind
+from tvm.runtime.vm import VirtualMachine, VirtualMachinePool, VMInstrumentReturnKind
 from tvm.ir import Call
 
 # Expr
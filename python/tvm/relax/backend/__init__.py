@@ -18,6 +18,9 @@
 """Relax backends"""
 
 from . import contrib, cpu_generic, cuda, gpu_generic, metal, rocm, adreno
+from .dispatch_lora import DispatchLoRA
+from .dispatch_moe import DispatchMoE
 from .dispatch_sampling import DispatchSampling
 from .dispatch_sort_scan import DispatchSortScan
+from .dispatch_sparse import DispatchSparse
 from .pattern_registry import get_pattern, get_patterns_with_prefix
@@ -24,6 +24,9 @@ def library_dispatch_passes(target: tvm.target.Target):  # pylint: disable=unuse
     """The default library dispatch passes for CPU backend."""
     return [
         relax.backend.DispatchSampling(),
+        relax.backend.DispatchMoE(),
+        relax.backend.DispatchLoRA(),
+        relax.backend.DispatchSparse(),
         relax.backend.DispatchSortScan(),
     ]
 
@@ -28,11 +28,13 @@ from tvm.relax.transform import PatternCheckContext
 
 from ..pattern_registry import get_patterns_with_prefix, register_patterns
 from ..patterns import (
+    make_matmul_channel_scale_pattern,
     make_matmul_dequantize_pattern,
     make_matmul_multiply_pattern,
     make_matmul_pattern,
+    make_residual_block_pattern,
 )
-from ..utils import has_leaking_intermediate_variables
+from ..utils import has_dependency, has_leaking_intermediate_variables
 
 
 def _is_supported_dtype(lhs_dtype, rhs_dtype, out_dtype):
@@ -128,6 +130,40 @@ def _check_matmul(context: PatternCheckContext) -> bool:
 
     analyzer = Analyzer()
 
+    if "residual" in context.annotated_expr or "channel_scale" in context.annotated_expr:
+        if out_dtype not in ["float16", "bfloat16", "float32"]:
+            return False
+
+    if "residual" in context.annotated_expr:
+        # The residual is read as the C matrix of the matmul, D = A * B + C, so it must have the
+        # shape and dtype of the output and must not be computed from it.
+        residual = context.annotated_expr["residual"]
+        if not isinstance(residual, tvm.relax.Var):
+            if residual not in context.value_to_bound_var:
+                return False
+            residual = context.value_to_bound_var[residual]
+        root_var = context.value_to_bound_var[matmul_call]
+        if has_dependency(from_var=residual, to_var=root_var, var_usages=context.var_usages):
+            return False
+        out_shape = matmul_call.ty.shape.values
+        residual_shape = residual.ty.shape.values
+        if residual.ty.dtype != out_dtype or len(residual_shape) != len(out_shape):
+            return False
+        if not all(analyzer.can_prove_equal(r, o) for r, o in zip(residual_shape, out_shape)):
+            return False
+
+    if "channel_scale" in context.annotated_expr:
+        # The scale vector is passed as the per-row alpha of cuBLASLt, which is in float32.
+        channel_scale = context.annotated_expr["channel_scale"]
+        out_channel = matmul_call.ty.shape.values[-1]
+        scale_shape = channel_scale.ty.shape.values
+        if channel_scale.ty.dtype != "float32" or out_dtype != "float32":
+            return False
+        if not scale_shape or not analyzer.can_prove_equal(scale_shape[-1], out_channel):
+            return False
+        if not analyzer.can_prove_equal(reduce(operator.mul, scale_shape, 1), out_channel):
+            return False
+
     # cuBLASLt does not seem to support batched GEMM with one of matrices having
     # one batch (with batch_stride 0). So for batched GEMM, the two batch counts
     # must be equal. If lhs is batched but rhs is not, we can use the regular GEMM by
@@ -206,6 +242,28 @@ register_patterns(
             ),
             _check_matmul,
         ),
+        *[
+            (
+                f"cublas.matmul{transposed}{bias}_residual_add",
+                *make_residual_block_pattern(
+                    make_matmul_pattern(with_bias=bool(bias), transposed_rhs=bool(transposed))
+                ),
+                _check_matmul,
+            )
+            for transposed in ["", "_transposed"]
+            for bias in ["", "_bias"]
+        ],
+        *[
+            (
+                f"cublas.matmul{transposed}_channel_scale{bias}",
+                *make_matmul_channel_scale_pattern(
+                    with_bias=bool(bias), transposed_rhs=bool(transposed)
+                ),
+                _check_matmul,
+            )
+            for transposed in ["", "_transposed"]
+            for bias in ["", "_bias"]
+        ],
         (
             "cublas.matmul_transposed_dequantize",
             *make_matmul_dequantize_pattern(transposed_rhs=True),
@@ -19,7 +19,6 @@
 """Pattern table for CUTLASS backend"""
 
 import operator
-from collections.abc import Mapping, Sequence
 from functools import reduce
 
 import tvm
@@ -48,7 +47,7 @@ from ..patterns import (
     make_rms_norm_pattern,
     make_stacked_attention_pattern,
 )
-from ..utils import has_leaking_intermediate_variables
+from ..utils import has_dependency, has_leaking_intermediate_variables
 
 
 def _is_supported_dtype(lhs_dtype, rhs_dtype):
@@ -64,24 +63,6 @@ def _shape_1d(shape):
     return reduce(operator.mul, shape, 1)
 
 
-def _has_dependency(from_var: Var, to_var: Var, var_usages: Mapping[Var, Sequence[Var]]):
-    if from_var == to_var:
-        return True
-
-    checked = set()
-    vars_to_check = [to_var]
-    while vars_to_check:
-        current_var = vars_to_check.pop()
-        for user in var_usages.get(current_var, []):
-            if user == from_var:
-                return True
-            if user not in checked:
-                checked.add(user)
-                vars_to_check.append(user)
-
-    return False
-
-
 def _is_same_shape(shape1, shape2):
     analyzer = tvm.arith.Analyzer()
     return all([analyzer.can_prove_equal(s1, s2) for s1, s2 in zip(shape1, shape2)])
@@ -101,7 +82,7 @@ def _check_residual(root_call: Call, context: PatternCheckContext) -> bool:
             residual = context.value_to_bound_var[residual]
 
         root_var = context.value_to_bound_var[root_call]
-        if _has_dependency(from_var=residual, to_var=root_var, var_usages=context.var_usages):
+        if has_dependency(from_var=residual, to_var=root_var, var_usages=context.var_usages):
             # If residual depends on the result of the root call, this cannot be handled by cutlass.
             return False
 
@@ -371,6 +352,25 @@ def residual_block_patterns():
                             )
                         )
 
+    # SiLU gating of SwiGLU, silu(x @ w_gate) * (x @ w_up), where the gate matmul is fused with
+    # the activation and the multiply by the output of the up matmul as its residual.
+    for transposed in ["", "_transposed"]:
+        for bias in ["", "_bias"]:
+            patterns.append(
+                (
+                    f"cutlass.matmul{transposed}{bias}_silu_residual_multiply",
+                    *make_residual_block_pattern(
+                        make_matmul_pattern(
+                            with_bias=bool(bias),
+                            activation="relax.nn.silu",
+                            transposed_rhs=bool(transposed),
+                        ),
+                        binary_op="relax.multiply",
+                    ),
+                    _check_matmul,
+                )
+            )
+
     return patterns
 
 
@@ -24,6 +24,9 @@ def library_dispatch_passes(target: tvm.target.Target):  # pylint: disable=unuse
     """The default library dispatch passes for CUDA backend."""
     return [
         relax.backend.DispatchSampling(),
+        relax.backend.DispatchMoE(),
+        relax.backend.DispatchLoRA(),
+        relax.backend.DispatchSparse(),
         relax.backend.DispatchSortScan(),
     ]
 
@@ -64,6 +67,7 @@ def finalize_passes(target: tvm.target.Target):  # pylint: disable=unused-argume
         relax.transform.StaticPlanBlockMemory(),
         relax.transform.RewriteCUDAGraph(),
         relax.transform.LowerAllocTensor(),
+        relax.transform.AssignDeviceStreams(),
         relax.transform.KillAfterLastUse(),
         relax.transform.LowerRuntimeBuiltin(),
         relax.transform.ComputePrimValue(),
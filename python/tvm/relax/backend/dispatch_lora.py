@@ -0,0 +1,67 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=invalid-name, unused-argument, redefined-argument-from-local
+"""Dispatch low-rank adaptation (LoRA) operators to platform dependent implementation."""
+
+from tvm import relax
+from tvm.ir import Op
+from tvm.ir.module import IRModule
+from tvm.ir.transform import PassContext, module_pass
+from tvm.relax import expr_functor
+
+from .utils import BackendDispatcher
+
+
+@expr_functor.mutator
+class LoRADispatcher(BackendDispatcher):
+    """Dispatcher to dispatch LoRA op."""
+
+    def _as_int32(self, expr: relax.Expr) -> relax.Expr:
+        _, dtype = self.get_shape_dtype(expr)
+        if dtype.dtype == "int32":
+            return expr
+        return self.builder_.emit(relax.op.astype(expr, "int32"))
+
+    def visit_call_(self, call: relax.Call) -> relax.Expr:
+        if not isinstance(call.op, Op) or call.op.name != "relax.lora.sgmv":
+            return super().visit_call_(call)
+
+        from tvm.relax.backend.gpu_generic import (  # pylint: disable=import-outside-toplevel
+            lora_sgmv,
+        )
+
+        gpu = self.is_gpu_target(self._get_target(call.ty))
+        prefix = "gpu" if gpu else "cpu"
+        data, weight, seg_indptr, weight_indices = call.args
+        _, dtype = self.get_shape_dtype(data)
+        func = lora_sgmv(dtype.dtype, gpu)
+        gv = self.builder_.add_func(func, f"{prefix}_lora_sgmv")
+        args = [data, weight, self._as_int32(seg_indptr), self._as_int32(weight_indices)]
+        return relax.call_tir(gv, args, out_ty=call.ty)
+
+
+@module_pass(opt_level=0, name="DispatchLoRA")
+class DispatchLoRA:
+    """Pass to dispatch LoRA operators to platform dependent implementation."""
+
+    def transform_module(self, mod: IRModule, ctx: PassContext) -> IRModule:
+        lora_dispatcher = LoRADispatcher(mod)
+        for gv, func in mod.functions_items():
+            if isinstance(func, relax.Function):
+                func = lora_dispatcher.visit_expr(func)
+                lora_dispatcher.builder_.update_func(gv, func)
+        return lora_dispatcher.builder_.finalize()
@@ -0,0 +1,102 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, unused-argument, redefined-argument-from-local
+"""Dispatch Mixture-of-Experts operators to platform dependent implementation."""
+
+from tvm import relax, tirx
+from tvm.ir import Op
+from tvm.ir.module import IRModule
+from tvm.ir.transform import PassContext, module_pass
+from tvm.relax import expr_functor
+
+from .utils import BackendDispatcher
+
+
+@expr_functor.mutator
+class MoEDispatcher(BackendDispatcher):
+    """Dispatcher to dispatch Mixture-of-Experts op."""
+
+    def _as_int32(self, expr: relax.Expr) -> relax.Expr:
+        _, dtype = self.get_shape_dtype(expr)
+        if dtype.dtype == "int32":
+            return expr
+        return self.builder_.emit(relax.op.astype(expr, "int32"))
+
+    def _out_ty(self, call: relax.Call):
+        if isinstance(call.ty, relax.TupleType):
+            return list(call.ty.fields)
+        return call.ty
+
+    def visit_call_(self, call: relax.Call) -> relax.Expr:
+        if not isinstance(call.op, Op) or not call.op.name.startswith("relax.moe."):
+            return super().visit_call_(call)
+
+        from tvm.relax.backend.gpu_generic import (  # pylint: disable=import-outside-toplevel
+            moe_group_matmul,
+            moe_permute,
+            moe_topk_gating,
+            moe_unpermute,
+        )
+
+        gpu = self.is_gpu_target(self._get_target(call.ty))
+        prefix = "gpu" if gpu else "cpu"
+        if call.op.name == "relax.moe.topk_gating":
+            (logits,) = call.args
+            _, dtype = self.get_shape_dtype(logits)
+            func = moe_topk_gating(dtype.dtype, call.attrs.top_k, call.attrs.normalize, gpu)
+            args = [logits]
+        elif call.op.name == "relax.moe.permute":
+            data, expert_indices = call.args
+            _, dtype = self.get_shape_dtype(data)
+            func = moe_permute(dtype.dtype, call.attrs.num_experts, call.attrs.capacity, gpu)
+            args = [data, self._as_int32(expert_indices)]
+        elif call.op.name == "relax.moe.group_matmul":
+            data, weight, expert_indptr = call.args
+            _, dtype = self.get_shape_dtype(data)
+            weight_shape, _ = self.get_shape_dtype(weight)
+            num_experts = weight_shape[0]
+            if not isinstance(num_experts, tirx.IntImm):
+                raise ValueError(
+                    f"moe.group_matmul requires a static number of experts, but got {num_experts}"
+                )
+            func = moe_group_matmul(dtype.dtype, num_experts.value, gpu)
+            args = [data, weight, self._as_int32(expert_indptr)]
+        elif call.op.name == "relax.moe.unpermute":
+            data, token_rows, weights = call.args
+            _, dtype = self.get_shape_dtype(data)
+            _, weights_dtype = self.get_shape_dtype(weights)
+            func = moe_unpermute(dtype.dtype, weights_dtype.dtype, gpu)
+            args = [data, self._as_int32(token_rows), weights]
+        else:
+            return super().visit_call_(call)
+
+        kernel_name = call.op.name[len("relax.moe.") :]
+        gv = self.builder_.add_func(func, f"{prefix}_moe_{kernel_name}")
+        return relax.call_tir(gv, args, out_ty=self._out_ty(call))
+
+
+@module_pass(opt_level=0, name="DispatchMoE")
+class DispatchMoE:
+    """Pass to dispatch Mixture-of-Experts operators to platform dependent implementation."""
+
+    def transform_module(self, mod: IRModule, ctx: PassContext) -> IRModule:
+        moe_dispatcher = MoEDispatcher(mod)
+        for gv, func in mod.functions_items():
+            if isinstance(func, relax.Function):
+                func = moe_dispatcher.visit_expr(func)
+                moe_dispatcher.builder_.update_func(gv, func)
+        return moe_dispatcher.builder_.finalize()
@@ -0,0 +1,100 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=invalid-name, unused-argument, redefined-argument-from-local
+"""Dispatch 2:4 structured-sparse operators to platform dependent implementation."""
+
+from functools import reduce
+
+from tvm import relax
+from tvm.ir import Op
+from tvm.ir.module import IRModule
+from tvm.ir.transform import PassContext, module_pass
+from tvm.relax import expr_functor
+from tvm.target import Target
+
+from .utils import BackendDispatcher
+
+
+def _has_sparse_tensor_core(target: Target) -> bool:
+    """Whether the target has the sparse tensor cores of `mma.sp`, from sm_80 on."""
+    if target.kind.name != "cuda":
+        return False
+    sm_version = str(target.attrs.get("arch", "")).replace("sm_", "")
+    return sm_version.isdigit() and int(sm_version) >= 80
+
+
+@expr_functor.mutator
+class SparseDispatcher(BackendDispatcher):
+    """Dispatcher to dispatch 2:4 structured-sparse op."""
+
+    def visit_call_(self, call: relax.Call) -> relax.Expr:
+        if not isinstance(call.op, Op) or not call.op.name.startswith("relax.sparse."):
+            return super().visit_call_(call)
+
+        from tvm.relax.backend.gpu_generic import (  # pylint: disable=import-outside-toplevel
+            sparse_compress_2_4,
+            sparse_matmul_2_4,
+            sparse_matmul_2_4_mma_sp,
+        )
+
+        target = self._get_target(call.ty)
+        gpu = self.is_gpu_target(target)
+        prefix = "gpu" if gpu else "cpu"
+        if call.op.name == "relax.sparse.compress_2_4":
+            (weight,) = call.args
+            _, dtype = self.get_shape_dtype(weight)
+            func = sparse_compress_2_4(dtype.dtype, gpu)
+            gv = self.builder_.add_func(func, f"{prefix}_sparse_compress_2_4")
+            return relax.call_tir(gv, [weight], out_ty=list(call.ty.fields))
+
+        if call.op.name == "relax.sparse.matmul_2_4":
+            data, values, metadata = call.args
+            shape, dtype = self.get_shape_dtype(data)
+            if _has_sparse_tensor_core(target) and dtype.dtype == "float16":
+                func, name = sparse_matmul_2_4_mma_sp(), "cuda_sparse_matmul_2_4_mma_sp"
+            else:
+                func, name = sparse_matmul_2_4(dtype.dtype, gpu), f"{prefix}_sparse_matmul_2_4"
+            gv = self.builder_.add_func(func, name)
+            if data.ty.ndim == 2:
+                return relax.call_tir(gv, [data, values, metadata], out_ty=call.ty)
+            # The kernels take the data as a matrix of rows.
+            out_shape, _ = self.get_shape_dtype(call)
+            if not isinstance(shape, relax.ShapeExpr) or not isinstance(out_shape, relax.ShapeExpr):
+                raise ValueError(
+                    f"sparse.matmul_2_4 requires the data of ndim other than 2 to have a shape "
+                    f"expression, but got {data} with {data.ty}"
+                )
+            num_rows = reduce(lambda x, y: x * y, list(shape.values)[:-1], 1)
+            data = self.builder_.emit(relax.op.reshape(data, (num_rows, shape.values[-1])))
+            out_ty = relax.TensorType([num_rows, out_shape.values[-1]], dtype, call.ty.vdevice)
+            out = self.builder_.emit(relax.call_tir(gv, [data, values, metadata], out_ty))
+            return relax.op.reshape(out, out_shape)
+
+        return super().visit_call_(call)
+
+
+@module_pass(opt_level=0, name="DispatchSparse")
+class DispatchSparse:
+    """Pass to dispatch 2:4 structured-sparse operators to platform dependent implementation."""
+
+    def transform_module(self, mod: IRModule, ctx: PassContext) -> IRModule:
+        sparse_dispatcher = SparseDispatcher(mod)
+        for gv, func in mod.functions_items():
+            if isinstance(func, relax.Function):
+                func = sparse_dispatcher.visit_expr(func)
+                sparse_dispatcher.builder_.update_func(gv, func)
+        return sparse_dispatcher.builder_.finalize()
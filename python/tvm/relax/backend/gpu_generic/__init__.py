@@ -18,6 +18,8 @@
 """The Relax Metal backend compilation pipeline and other passes."""
 
 from .cumsum import gpu_2d_continuous_cumsum
+from .lora import lora_sgmv
+from .moe import moe_group_matmul, moe_permute, moe_topk_gating, moe_unpermute
 from .pipeline import (
     dataflow_lower_passes,
     finalize_passes,
@@ -25,4 +27,9 @@ from .pipeline import (
     legalize_passes,
     library_dispatch_passes,
 )
-from .sampling import generic_get_sample_index, gpu_multinomial_from_uniform
+from .sampling import (
+    generic_get_sample_index,
+    gpu_fused_sampling_from_logits,
+    gpu_multinomial_from_uniform,
+)
+from .sparse import sparse_compress_2_4, sparse_matmul_2_4, sparse_matmul_2_4_mma_sp
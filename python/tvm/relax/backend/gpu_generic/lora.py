@@ -0,0 +1,151 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=invalid-name, too-many-locals
+"""Backend kernels for low-rank adaptation (LoRA) operators.
+
+Each generator returns a scheduled GPU kernel when `gpu` is set, and a kernel parallelized over
+the CPU threads otherwise.
+"""
+
+from tvm.script import tirx as T
+from tvm.tirx import PrimFunc
+
+
+def lora_sgmv(dtype: str, gpu: bool, tile: int = 16) -> PrimFunc:
+    """Generate the kernel of lora.sgmv in one launch over all segments.
+
+    On GPU, the row tiles of the segments are numbered one segment after the other, as in
+    moe.group_matmul. A block finds the segment of its tile from the offsets of the segments and
+    computes a tiled matmul with the weight of the slot of the segment, or writes zeros for a
+    segment without adapter, and the blocks past the last tile exit.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the rows and the weights.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tile : int
+        The size of the square output tile of a block.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    TILE = T.int64(tile)
+
+    @T.prim_func(private=True, s_tir=True)
+    def sgmv(
+        var_data: T.handle,
+        var_weight: T.handle,
+        var_indptr: T.handle,
+        var_indices: T.handle,
+        var_out: T.handle,
+    ):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_rows, in_features = T.int64(), T.int64()
+        num_slots, out_features = T.int64(), T.int64()
+        num_indptr, num_segs = T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_rows, in_features), dtype)
+        weight = T.match_buffer(var_weight, (num_slots, out_features, in_features), dtype)
+        # The segments are dynamic, `num_indptr` is `num_segs + 1`.
+        seg_indptr = T.match_buffer(var_indptr, (num_indptr,), "int32")
+        weight_indices = T.match_buffer(var_indices, (num_segs,), "int32")
+        out = T.match_buffer(var_out, (num_rows, out_features), dtype)
+        if gpu:
+            # Each segment adds at most one partial tile.
+            for by in T.thread_binding(T.ceildiv(num_rows, TILE) + num_segs, thread="blockIdx.y"):
+                for bx in T.thread_binding(T.ceildiv(out_features, TILE), thread="blockIdx.x"):
+                    for ty in T.thread_binding(TILE, thread="threadIdx.y"):
+                        for tx in T.thread_binding(TILE, thread="threadIdx.x"):
+                            with T.sblock():
+                                data_tile = T.sblock_alloc_buffer(
+                                    (TILE, TILE), "float32", scope="shared"
+                                )
+                                weight_tile = T.sblock_alloc_buffer(
+                                    (TILE, TILE + 1), "float32", scope="shared"
+                                )
+                                seg = T.sblock_alloc_buffer((), "int64", scope="local")
+                                row_begin = T.sblock_alloc_buffer((), "int64", scope="local")
+                                num_tiles = T.sblock_alloc_buffer((), "int64", scope="local")
+                                acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                                seg[()] = T.int64(-1)
+                                row_begin[()] = T.int64(0)
+                                num_tiles[()] = T.int64(0)
+                                for s in T.serial(num_segs):
+                                    seg_tiles: T.let[T.int64] = T.ceildiv(
+                                        T.Cast("int64", seg_indptr[s + 1] - seg_indptr[s]), TILE
+                                    )
+                                    if seg[()] < 0 and by < num_tiles[()] + seg_tiles:
+                                        seg[()] = s
+                                        row_begin[()] = (
+                                            T.Cast("int64", seg_indptr[s])
+                                            + (by - num_tiles[()]) * TILE
+                                        )
+                                    num_tiles[()] += seg_tiles
+                                if T.tvm_thread_invariant(seg[()] >= 0):
+                                    row_end: T.let[T.int64] = T.Cast(
+                                        "int64", seg_indptr[seg[()] + 1]
+                                    )
+                                    slot: T.let[T.int32] = weight_indices[seg[()]]
+                                    acc[()] = T.float32(0)
+                                    if T.tvm_thread_invariant(slot >= 0):
+                                        for kt in T.serial(T.ceildiv(in_features, TILE)):
+                                            k: T.let[T.int64] = kt * TILE + tx
+                                            data_tile[ty, tx] = T.if_then_else(
+                                                row_begin[()] + ty < row_end and k < in_features,
+                                                T.Cast("float32", data[row_begin[()] + ty, k]),
+                                                T.float32(0),
+                                            )
+                                            weight_tile[ty, tx] = T.if_then_else(
+                                                bx * TILE + ty < out_features and k < in_features,
+                                                T.Cast("float32", weight[slot, bx * TILE + ty, k]),
+                                                T.float32(0),
+                                            )
+                                            T.tvm_storage_sync("shared")
+                                            for kk in T.serial(TILE):
+                                                acc[()] += data_tile[ty, kk] * weight_tile[tx, kk]
+                                            T.tvm_storage_sync("shared")
+                                    if (
+                                        row_begin[()] + ty < row_end
+                                        and bx * TILE + tx < out_features
+                                    ):
+                                        out[row_begin[()] + ty, bx * TILE + tx] = T.Cast(
+                                            dtype, acc[()]
+                                        )
+        else:
+            for r in T.parallel(num_rows):
+                with T.sblock():
+                    slot = T.sblock_alloc_buffer((), "int32", scope="local")
+                    acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                    slot[()] = -1
+                    for s in T.serial(num_segs):
+                        if seg_indptr[s] <= r and r < seg_indptr[s + 1]:
+                            slot[()] = weight_indices[s]
+                    for n in T.serial(out_features):
+                        acc[()] = T.float32(0)
+                        if slot[()] >= 0:
+                            for k in T.serial(in_features):
+                                acc[()] += T.Cast("float32", data[r, k]) * T.Cast(
+                                    "float32", weight[slot[()], n, k]
+                                )
+                        out[r, n] = T.Cast(dtype, acc[()])
+
+    return sgmv
@@ -0,0 +1,489 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, too-many-arguments, too-many-locals
+"""Backend kernels for Mixture-of-Experts operators.
+
+Each generator returns a scheduled GPU kernel when `gpu` is set, and a kernel parallelized over
+the CPU threads otherwise.
+"""
+
+import math
+
+from tvm.script import tirx as T
+from tvm.tirx import PrimFunc
+
+
+def moe_topk_gating(
+    logits_dtype: str, top_k: int, normalize: bool, gpu: bool, tx_len: int = 128
+) -> PrimFunc:
+    """Generate the kernel of moe.topk_gating, one thread per token.
+
+    The k-th expert is the largest logit strictly after the (k-1)-th one in the order of
+    descending logits and ascending expert indices, which needs no sorting nor per-thread arrays.
+
+    Parameters
+    ----------
+    logits_dtype : str
+        The data type of the logits and the weights.
+
+    top_k : int
+        The number of experts of each token.
+
+    normalize : bool
+        Whether the weights of the experts of each token are renormalized to sum to 1.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tx_len : int
+        The length of `threadIdx.x`.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    TX = T.int64(tx_len)
+
+    @T.macro
+    def gating_row(logits: T.Buffer, weights: T.Buffer, indices: T.Buffer, t, num_experts):
+        with T.sblock():
+            probs = T.sblock_alloc_buffer((top_k,), "float32", scope="local")
+            row_max = T.sblock_alloc_buffer((), "float32", scope="local")
+            row_sum = T.sblock_alloc_buffer((), "float32", scope="local")
+            selected_sum = T.sblock_alloc_buffer((), "float32", scope="local")
+            prev_value = T.sblock_alloc_buffer((), "float32", scope="local")
+            prev_index = T.sblock_alloc_buffer((), "int32", scope="local")
+            best_value = T.sblock_alloc_buffer((), "float32", scope="local")
+            best_index = T.sblock_alloc_buffer((), "int32", scope="local")
+
+            row_max[()] = T.min_value("float32")
+            for e in T.serial(num_experts):
+                row_max[()] = T.max(row_max[()], T.Cast("float32", logits[t, e]))
+            row_sum[()] = T.float32(0)
+            for e in T.serial(num_experts):
+                row_sum[()] += T.exp(T.Cast("float32", logits[t, e]) - row_max[()])
+
+            prev_value[()] = T.max_value("float32")
+            prev_index[()] = -1
+            selected_sum[()] = T.float32(0)
+            for j in T.serial(top_k):
+                best_value[()] = T.min_value("float32")
+                best_index[()] = -1
+                for e in T.serial(num_experts):
+                    value: T.let[T.float32] = T.Cast("float32", logits[t, e])
+                    index: T.let[T.int32] = T.Cast("int32", e)
+                    if (
+                        value < prev_value[()]
+                        or (value == prev_value[()] and index > prev_index[()])
+                    ) and (best_index[()] < 0 or value > best_value[()]):
+                        best_value[()] = value
+                        best_index[()] = index
+                probs[j] = T.exp(best_value[()] - row_max[()]) / row_sum[()]
+                indices[t, j] = best_index[()]
+                selected_sum[()] += probs[j]
+                prev_value[()] = best_value[()]
+                prev_index[()] = best_index[()]
+            for j in T.serial(top_k):
+                if normalize:
+                    weights[t, j] = T.Cast(logits_dtype, probs[j] / selected_sum[()])
+                else:
+                    weights[t, j] = T.Cast(logits_dtype, probs[j])
+
+    @T.prim_func(private=True, s_tir=True)
+    def topk_gating(var_logits: T.handle, var_weights: T.handle, var_indices: T.handle):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_tokens, num_experts = T.int64(), T.int64()
+        logits = T.match_buffer(var_logits, (num_tokens, num_experts), logits_dtype)
+        weights = T.match_buffer(var_weights, (num_tokens, top_k), logits_dtype)
+        indices = T.match_buffer(var_indices, (num_tokens, top_k), "int32")
+        if gpu:
+            for bx in T.thread_binding(T.ceildiv(num_tokens, TX), thread="blockIdx.x"):
+                for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                    if bx * TX + tx < num_tokens:
+                        gating_row(logits, weights, indices, bx * TX + tx, num_experts)
+        else:
+            for t in T.parallel(num_tokens):
+                gating_row(logits, weights, indices, t, num_experts)
+
+    return topk_gating
+
+
+def moe_permute(
+    dtype: str, num_experts: int, capacity: int, gpu: bool, tx_len: int = 256
+) -> PrimFunc:
+    """Generate the kernel of moe.permute.
+
+    The rank of each row within its expert is a stable counting sort. On GPU, one block per expert
+    scans the expert indices with a block prefix sum, then the offsets of the experts are summed
+    up, and one block per row copies the row of the token.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the rows.
+
+    num_experts : int
+        The number of experts.
+
+    capacity : int
+        The number of rows of each expert, 0 for packing the rows of all tokens.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tx_len : int
+        The length of `threadIdx.x`, a power of 2.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    if tx_len <= 0 or tx_len & (tx_len - 1) != 0:
+        raise ValueError(f"tx_len must be a power of 2, but got {tx_len}")
+    TX = T.int64(tx_len)
+    LOG_TX = int(math.log2(tx_len))
+
+    def row_of(expert_indptr: T.Buffer, expert, rank):
+        if capacity > 0:
+            return T.if_then_else(rank < capacity, expert * capacity + rank, T.int32(-1))
+        return expert_indptr[expert] + rank
+
+    @T.macro
+    def copy_row(
+        data: T.Buffer,
+        rows: T.Buffer,
+        token_rows: T.Buffer,
+        expert_indices: T.Buffer,
+        expert_indptr: T.Buffer,
+        slot,
+        top_k,
+        hidden_size,
+        tx,
+        stride,
+    ):
+        t: T.let[T.int64] = slot // top_k
+        j: T.let[T.int64] = slot % top_k
+        row: T.let[T.int32] = row_of(expert_indptr, expert_indices[t, j], token_rows[t, j])
+        if gpu:
+            # All threads have read the rank before it is overwritten.
+            T.tvm_storage_sync("shared")
+        if tx == 0:
+            token_rows[t, j] = row
+        if row >= 0:
+            for i in T.serial(T.ceildiv(hidden_size, stride)):
+                h: T.let[T.int64] = i * stride + tx
+                if h < hidden_size:
+                    rows[T.Cast("int64", row), h] = data[t, h]
+
+    @T.prim_func(private=True, s_tir=True)
+    def permute(
+        var_data: T.handle,
+        var_expert_indices: T.handle,
+        var_rows: T.handle,
+        var_expert_indptr: T.handle,
+        var_token_rows: T.handle,
+    ):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_tokens, hidden_size, top_k, num_rows = T.int64(), T.int64(), T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_tokens, hidden_size), dtype)
+        expert_indices = T.match_buffer(var_expert_indices, (num_tokens, top_k), "int32")
+        rows = T.match_buffer(var_rows, (num_rows, hidden_size), dtype)
+        expert_indptr = T.match_buffer(var_expert_indptr, (num_experts + 1,), "int32")
+        # Holds the rank of each row within its expert until the rows are copied.
+        token_rows = T.match_buffer(var_token_rows, (num_tokens, top_k), "int32")
+        num_slots: T.let[T.int64] = num_tokens * top_k
+        if gpu:
+            if capacity > 0:
+                for bx in T.thread_binding(num_rows, thread="blockIdx.x"):
+                    for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                        for i in T.serial(T.ceildiv(hidden_size, TX)):
+                            if i * TX + tx < hidden_size:
+                                rows[bx, i * TX + tx] = T.Cast(dtype, 0)
+            for bx in T.thread_binding(num_experts, thread="blockIdx.x"):
+                for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                    with T.sblock():
+                        flags = T.sblock_alloc_buffer((TX,), "int32", scope="shared")
+                        base = T.sblock_alloc_buffer((), "int32", scope="local")
+                        base[()] = 0
+                        for i in T.serial(T.ceildiv(num_slots, TX)):
+                            slot: T.let[T.int64] = i * TX + tx
+                            matched: T.let[T.int32] = T.if_then_else(
+                                slot < num_slots,
+                                T.if_then_else(
+                                    expert_indices[slot // top_k, slot % top_k]
+                                    == T.Cast("int32", bx),
+                                    1,
+                                    0,
+                                ),
+                                0,
+                            )
+                            flags[tx] = matched
+                            T.tvm_storage_sync("shared")
+                            # Inclusive prefix sum of the matches in the block.
+                            for s in T.unroll(LOG_TX):
+                                left: T.let[T.int32] = T.if_then_else(
+                                    tx >= (1 << s), flags[tx - (1 << s)], 0
+                                )
+                                T.tvm_storage_sync("shared")
+                                flags[tx] += left
+                                T.tvm_storage_sync("shared")
+                            if matched == 1:
+                                token_rows[slot // top_k, slot % top_k] = base[()] + flags[tx] - 1
+                            base[()] += flags[TX - 1]
+                            T.tvm_storage_sync("shared")
+                        if tx == 0:
+                            expert_indptr[bx + 1] = base[()]
+            for bx in T.thread_binding(1, thread="blockIdx.x"):
+                for tx in T.thread_binding(1, thread="threadIdx.x"):
+                    expert_indptr[0] = 0
+                    for e in T.serial(num_experts):
+                        if capacity > 0:
+                            expert_indptr[e + 1] = T.Cast("int32", (e + 1) * capacity)
+                        else:
+                            expert_indptr[e + 1] += expert_indptr[e]
+            for bx in T.thread_binding(num_slots, thread="blockIdx.x"):
+                for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                    copy_row(
+                        data,
+                        rows,
+                        token_rows,
+                        expert_indices,
+                        expert_indptr,
+                        bx,
+                        top_k,
+                        hidden_size,
+                        tx,
+                        TX,
+                    )
+        else:
+            if capacity > 0:
+                for r, h in T.grid(num_rows, hidden_size):
+                    rows[r, h] = T.Cast(dtype, 0)
+            for e in T.serial(num_experts + 1):
+                expert_indptr[e] = 0
+            for slot in T.serial(num_slots):
+                expert: T.let[T.int32] = expert_indices[slot // top_k, slot % top_k]
+                token_rows[slot // top_k, slot % top_k] = expert_indptr[expert + 1]
+                expert_indptr[expert + 1] += 1
+            for e in T.serial(num_experts):
+                if capacity > 0:
+                    expert_indptr[e + 1] = T.Cast("int32", (e + 1) * capacity)
+                else:
+                    expert_indptr[e + 1] += expert_indptr[e]
+            for slot in T.parallel(num_slots):
+                copy_row(
+                    data,
+                    rows,
+                    token_rows,
+                    expert_indices,
+                    expert_indptr,
+                    slot,
+                    top_k,
+                    hidden_size,
+                    0,
+                    1,
+                )
+
+    return permute
+
+
+def moe_group_matmul(dtype: str, num_experts: int, gpu: bool, tile: int = 16) -> PrimFunc:
+    """Generate the kernel of moe.group_matmul in one launch over all experts.
+
+    On GPU, the row tiles of the experts are numbered one expert after the other. A block finds
+    the expert of its tile from the offsets of the experts and computes a tiled matmul, and the
+    blocks past the last tile exit.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the rows and the weights.
+
+    num_experts : int
+        The number of experts.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tile : int
+        The size of the square output tile of a block.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    TILE = T.int64(tile)
+
+    @T.prim_func(private=True, s_tir=True)
+    def group_matmul(
+        var_data: T.handle, var_weight: T.handle, var_indptr: T.handle, var_out: T.handle
+    ):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_rows, in_features, out_features = T.int64(), T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_rows, in_features), dtype)
+        weight = T.match_buffer(var_weight, (num_experts, out_features, in_features), dtype)
+        expert_indptr = T.match_buffer(var_indptr, (num_experts + 1,), "int32")
+        out = T.match_buffer(var_out, (num_rows, out_features), dtype)
+        if gpu:
+            # Each expert adds at most one partial tile.
+            for by in T.thread_binding(
+                T.ceildiv(num_rows, TILE) + num_experts, thread="blockIdx.y"
+            ):
+                for bx in T.thread_binding(T.ceildiv(out_features, TILE), thread="blockIdx.x"):
+                    for ty in T.thread_binding(TILE, thread="threadIdx.y"):
+                        for tx in T.thread_binding(TILE, thread="threadIdx.x"):
+                            with T.sblock():
+                                data_tile = T.sblock_alloc_buffer(
+                                    (TILE, TILE), "float32", scope="shared"
+                                )
+                                weight_tile = T.sblock_alloc_buffer(
+                                    (TILE, TILE + 1), "float32", scope="shared"
+                                )
+                                expert = T.sblock_alloc_buffer((), "int32", scope="local")
+                                row_begin = T.sblock_alloc_buffer((), "int64", scope="local")
+                                num_tiles = T.sblock_alloc_buffer((), "int64", scope="local")
+                                acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                                expert[()] = -1
+                                row_begin[()] = T.int64(0)
+                                num_tiles[()] = T.int64(0)
+                                for e in T.serial(num_experts):
+                                    expert_tiles: T.let[T.int64] = T.ceildiv(
+                                        T.Cast("int64", expert_indptr[e + 1] - expert_indptr[e]),
+                                        TILE,
+                                    )
+                                    if expert[()] < 0 and by < num_tiles[()] + expert_tiles:
+                                        expert[()] = T.Cast("int32", e)
+                                        row_begin[()] = (
+                                            T.Cast("int64", expert_indptr[e])
+                                            + (by - num_tiles[()]) * TILE
+                                        )
+                                    num_tiles[()] += expert_tiles
+                                if T.tvm_thread_invariant(expert[()] >= 0):
+                                    row_end: T.let[T.int64] = T.Cast(
+                                        "int64", expert_indptr[expert[()] + 1]
+                                    )
+                                    acc[()] = T.float32(0)
+                                    for kt in T.serial(T.ceildiv(in_features, TILE)):
+                                        k: T.let[T.int64] = kt * TILE + tx
+                                        data_tile[ty, tx] = T.if_then_else(
+                                            row_begin[()] + ty < row_end and k < in_features,
+                                            T.Cast("float32", data[row_begin[()] + ty, k]),
+                                            T.float32(0),
+                                        )
+                                        weight_tile[ty, tx] = T.if_then_else(
+                                            bx * TILE + ty < out_features and k < in_features,
+                                            T.Cast(
+                                                "float32",
+                                                weight[expert[()], bx * TILE + ty, k],
+                                            ),
+                                            T.float32(0),
+                                        )
+                                        T.tvm_storage_sync("shared")
+                                        for kk in T.serial(TILE):
+                                            acc[()] += data_tile[ty, kk] * weight_tile[tx, kk]
+                                        T.tvm_storage_sync("shared")
+                                    if (
+                                        row_begin[()] + ty < row_end
+                                        and bx * TILE + tx < out_features
+                                    ):
+                                        out[row_begin[()] + ty, bx * TILE + tx] = T.Cast(
+                                            dtype, acc[()]
+                                        )
+        else:
+            for r in T.parallel(num_rows):
+                with T.sblock():
+                    expert = T.sblock_alloc_buffer((), "int32", scope="local")
+                    acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                    expert[()] = -1
+                    for e in T.serial(num_experts):
+                        if expert_indptr[e] <= r and r < expert_indptr[e + 1]:
+                            expert[()] = T.Cast("int32", e)
+                    if expert[()] >= 0:
+                        for n in T.serial(out_features):
+                            acc[()] = T.float32(0)
+                            for k in T.serial(in_features):
+                                acc[()] += T.Cast("float32", data[r, k]) * T.Cast(
+                                    "float32", weight[expert[()], n, k]
+                                )
+                            out[r, n] = T.Cast(dtype, acc[()])
+
+    return group_matmul
+
+
+def moe_unpermute(dtype: str, weights_dtype: str, gpu: bool, tx_len: int = 256) -> PrimFunc:
+    """Generate the kernel of moe.unpermute, one block per token on GPU.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the rows.
+
+    weights_dtype : str
+        The data type of the weights of the experts.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tx_len : int
+        The length of `threadIdx.x`.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    TX = T.int64(tx_len)
+
+    @T.macro
+    def combine(
+        data: T.Buffer, token_rows: T.Buffer, weights: T.Buffer, out: T.Buffer, t, n, top_k
+    ):
+        with T.sblock():
+            acc = T.sblock_alloc_buffer((), "float32", scope="local")
+            acc[()] = T.float32(0)
+            for j in T.serial(top_k):
+                if token_rows[t, j] >= 0:
+                    acc[()] += T.Cast("float32", weights[t, j]) * T.Cast(
+                        "float32", data[T.Cast("int64", token_rows[t, j]), n]
+                    )
+            out[t, n] = T.Cast(dtype, acc[()])
+
+    @T.prim_func(private=True, s_tir=True)
+    def unpermute(
+        var_data: T.handle, var_token_rows: T.handle, var_weights: T.handle, var_out: T.handle
+    ):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_rows, hidden_size, num_tokens, top_k = T.int64(), T.int64(), T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_rows, hidden_size), dtype)
+        token_rows = T.match_buffer(var_token_rows, (num_tokens, top_k), "int32")
+        weights = T.match_buffer(var_weights, (num_tokens, top_k), weights_dtype)
+        out = T.match_buffer(var_out, (num_tokens, hidden_size), dtype)
+        if gpu:
+            for bx in T.thread_binding(num_tokens, thread="blockIdx.x"):
+                for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                    for i in T.serial(T.ceildiv(hidden_size, TX)):
+                        if i * TX + tx < hidden_size:
+                            combine(data, token_rows, weights, out, bx, i * TX + tx, top_k)
+        else:
+            for t in T.parallel(num_tokens):
+                for n in T.serial(hidden_size):
+                    combine(data, token_rows, weights, out, t, n, top_k)
+
+    return unpermute
@@ -24,6 +24,9 @@ def library_dispatch_passes(target: tvm.target.Target):  # pylint: disable=unuse
     """The default library dispatch passes for generic GPU backend."""
     return [
         relax.backend.DispatchSampling(),
+        relax.backend.DispatchMoE(),
+        relax.backend.DispatchLoRA(),
+        relax.backend.DispatchSparse(),
         relax.backend.DispatchSortScan(),
     ]
 
@@ -58,10 +61,15 @@ def dataflow_lower_passes(target: tvm.target.Target):  # pylint: disable=unused-
     ]
 
 
-def finalize_passes(target: tvm.target.Target):  # pylint: disable=unused-argument
+def finalize_passes(target: tvm.target.Target):
     """The default finalization passes for generic GPU backend."""
+    # Vulkan and Metal replay the static regions from reusable command buffers, like CUDA graphs.
+    graph_passes = (
+        [relax.transform.RewriteCUDAGraph()] if target.kind.name in ("vulkan", "metal") else []
+    )
     return [
         relax.transform.StaticPlanBlockMemory(),
+        *graph_passes,
         relax.transform.LowerAllocTensor(),
         relax.transform.KillAfterLastUse(),
         relax.transform.LowerRuntimeBuiltin(),
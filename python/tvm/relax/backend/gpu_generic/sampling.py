@@ -343,3 +343,272 @@ def generic_get_sample_index(
                         output_index[v_ax0, 0] = v_ax1
 
     return _get_sample_index
+
+
+def gpu_fused_sampling_from_logits(
+    logits_dtype: str = "float32",
+    dtype: str = "int64",
+    num_threads: int = 256,
+    num_search_iters: int = 24,
+    eps: float = 1e-6,
+) -> PrimFunc:
+    """Generate the GPU kernel which samples token ids from logits in one pass, so that the
+    logits never leave the device.
+
+    Each block processes one row. It applies the penalties and the temperature, filters the
+    probabilities by top-k, top-p and min-p, and draws from the kept ones. Instead of sorting,
+    the top-k and top-p cutoffs are found by a bisection on the unnormalized probabilities,
+    which lie in (0, 1] after subtracting the max logit.
+
+    The penalty token ids of a row must be distinct and padded with negative ids. The
+    repetition penalty is applied before the presence and frequency penalties, and rows that
+    do not use a penalty pass the neutral values 1, 0 and 0. A row samples the argmax when its
+    temperature is below `eps`, and disables top-k with a non-positive top_k.
+
+    Parameters
+    ----------
+    logits_dtype : str
+        The logits data type
+
+    dtype : str
+        The output data type
+
+    num_threads : int
+        The length of `threadIdx.x`
+
+    num_search_iters : int
+        The number of bisection steps of the top-k and top-p cutoffs
+
+    eps : float
+        The tolerance of the temperature and the sampling
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function, whose workspace output holds the unnormalized probabilities
+    """
+    if not _is_power_of_two(num_threads):
+        raise ValueError(f"num_threads must be power of 2, but got {num_threads}")
+
+    TX = T.int64(num_threads)
+    LOG_TX = T.int64(int(math.log2(num_threads)))
+
+    def op_reduce_max(a, b):
+        return T.max(a, b)
+
+    def op_reduce_min(a, b):
+        return T.min(a, b)
+
+    def op_reduce_sum(a, b):
+        return a + b
+
+    @T.macro
+    def block_reduce(tx: T.int64, value, output_local: T.Buffer, dtype: str, reduce_op: Callable):
+        with T.sblock():
+            shared_buf = T.sblock_alloc_buffer((TX,), dtype, scope="shared")
+            shared_buf[tx] = value
+            for i in T.unroll(LOG_TX):
+                if tx % (1 << (i + 1)) == 0:
+                    shared_buf[tx] = reduce_op(shared_buf[tx], shared_buf[tx + (1 << i)])
+            output_local[()] = shared_buf[0]
+
+    @T.prim_func(s_tir=True)
+    def fused_sampling_from_logits(
+        var_logits: T.handle,
+        var_penalty_token_ids: T.handle,
+        var_penalty_token_freqs: T.handle,
+        var_repetition_penalty: T.handle,
+        var_presence_penalty: T.handle,
+        var_frequency_penalty: T.handle,
+        var_temperature: T.handle,
+        var_top_p: T.handle,
+        var_top_k: T.handle,
+        var_min_p: T.handle,
+        var_uniform_samples: T.handle,
+        var_workspace: T.handle,
+        var_sampled_token_ids: T.handle,
+    ):
+        T.func_attr({"tirx.is_scheduled": True})
+        batch_size, vocab_size, num_penalty_tokens = T.int64(), T.int64(), T.int64()
+        # match buffers
+        logits = T.match_buffer(var_logits, (batch_size, vocab_size), logits_dtype)
+        penalty_token_ids = T.match_buffer(
+            var_penalty_token_ids, (batch_size, num_penalty_tokens), "int32"
+        )
+        penalty_token_freqs = T.match_buffer(
+            var_penalty_token_freqs, (batch_size, num_penalty_tokens), "int32"
+        )
+        repetition_penalty = T.match_buffer(var_repetition_penalty, (batch_size, 1), "float32")
+        presence_penalty = T.match_buffer(var_presence_penalty, (batch_size, 1), "float32")
+        frequency_penalty = T.match_buffer(var_frequency_penalty, (batch_size, 1), "float32")
+        temperature = T.match_buffer(var_temperature, (batch_size, 1), "float32")
+        top_p = T.match_buffer(var_top_p, (batch_size, 1), "float32")
+        top_k = T.match_buffer(var_top_k, (batch_size, 1), "int32")
+        min_p = T.match_buffer(var_min_p, (batch_size, 1), "float32")
+        uniform_samples = T.match_buffer(var_uniform_samples, (batch_size, 1), "float32")
+        workspace = T.match_buffer(var_workspace, (batch_size, vocab_size), "float32")
+        token_ids = T.match_buffer(var_sampled_token_ids, (batch_size, 1), dtype)
+        # local buffers
+        thread_max = T.sblock_alloc_buffer((), "float32", scope="local")
+        thread_argmax = T.sblock_alloc_buffer((), "int64", scope="local")
+        thread_count = T.sblock_alloc_buffer((), "int32", scope="local")
+        thread_sum = T.sblock_alloc_buffer((), "float32", scope="local")
+        row_max = T.sblock_alloc_buffer((), "float32", scope="local")
+        row_argmax = T.sblock_alloc_buffer((), "int64", scope="local")
+        row_count = T.sblock_alloc_buffer((), "int32", scope="local")
+        row_sum = T.sblock_alloc_buffer((), "float32", scope="local")
+        row_target = T.sblock_alloc_buffer((), "float32", scope="local")
+        top_k_lo = T.sblock_alloc_buffer((), "float32", scope="local")
+        top_k_hi = T.sblock_alloc_buffer((), "float32", scope="local")
+        top_p_lo = T.sblock_alloc_buffer((), "float32", scope="local")
+        top_p_hi = T.sblock_alloc_buffer((), "float32", scope="local")
+        cutoff = T.sblock_alloc_buffer((), "float32", scope="local")
+        prefix = T.sblock_alloc_buffer((), "float32", scope="local")
+        found = T.sblock_alloc_buffer((), "bool", scope="local")
+        thread_sums = T.sblock_alloc_buffer((TX,), "float32", scope="shared")
+
+        for bx in T.thread_binding(batch_size, thread="blockIdx.x"):
+            for tx in T.thread_binding(TX, thread="threadIdx.x"):
+                # Copy the logits to the workspace, each thread owns the entries tx + i * TX.
+                for i in T.serial(T.ceildiv(vocab_size, TX)):
+                    idx: T.let[T.int64] = i * TX + tx
+                    if idx < vocab_size:
+                        workspace[bx, idx] = T.Cast("float32", logits[bx, idx])
+                T.tvm_storage_sync("shared")
+                # Apply the penalties, whose tokens are owned by other threads.
+                for i in T.serial(T.ceildiv(num_penalty_tokens, TX)):
+                    j: T.let[T.int64] = i * TX + tx
+                    if j < num_penalty_tokens:
+                        token_id: T.let[T.int64] = T.Cast("int64", penalty_token_ids[bx, j])
+                        if token_id >= 0:
+                            x: T.let[T.float32] = workspace[bx, token_id]
+                            x_rep: T.let[T.float32] = T.if_then_else(
+                                x > T.float32(0),
+                                x / repetition_penalty[bx, 0],
+                                x * repetition_penalty[bx, 0],
+                            )
+                            workspace[bx, token_id] = (
+                                x_rep
+                                - T.Cast("float32", penalty_token_freqs[bx, j])
+                                * frequency_penalty[bx, 0]
+                                - presence_penalty[bx, 0]
+                            )
+                T.tvm_storage_sync("shared")
+
+                # The max logit and the first index holding it.
+                thread_max[()] = T.min_value("float32")
+                thread_argmax[()] = vocab_size - 1
+                for i in T.serial(T.ceildiv(vocab_size, TX)):
+                    idx: T.let[T.int64] = i * TX + tx
+                    if idx < vocab_size:
+                        if workspace[bx, idx] > thread_max[()]:
+                            thread_max[()] = workspace[bx, idx]
+                            thread_argmax[()] = idx
+                block_reduce(tx, thread_max[()], row_max, "float32", op_reduce_max)
+                block_reduce(
+                    tx,
+                    T.if_then_else(thread_max[()] == row_max[()], thread_argmax[()], vocab_size),
+                    row_argmax,
+                    "int64",
+                    op_reduce_min,
+                )
+                if tx == 0:
+                    token_ids[bx, 0] = T.Cast(dtype, T.min(row_argmax[()], vocab_size - 1))
+
+                if T.tvm_thread_invariant(temperature[bx, 0] >= T.float32(eps)):
+                    # Unnormalized probabilities in (0, 1], the argmax is 1.
+                    for i in T.serial(T.ceildiv(vocab_size, TX)):
+                        idx: T.let[T.int64] = i * TX + tx
+                        if idx < vocab_size:
+                            workspace[bx, idx] = T.exp(
+                                (workspace[bx, idx] - row_max[()]) / temperature[bx, 0]
+                            )
+                    thread_sum[()] = T.float32(0)
+                    for i in T.serial(T.ceildiv(vocab_size, TX)):
+                        idx: T.let[T.int64] = i * TX + tx
+                        if idx < vocab_size:
+                            thread_sum[()] += workspace[bx, idx]
+                    block_reduce(tx, thread_sum[()], row_sum, "float32", op_reduce_sum)
+
+                    # Bisect the smallest cutoff keeping at most top_k entries, and the largest
+                    # cutoff keeping a mass of at least top_p.
+                    top_k_lo[()] = T.float32(0)
+                    top_k_hi[()] = T.float32(1)
+                    top_p_lo[()] = T.float32(0)
+                    top_p_hi[()] = T.float32(1)
+                    if T.tvm_thread_invariant(
+                        top_p[bx, 0] < T.float32(1)
+                        or (
+                            top_k[bx, 0] > 0
+                            and T.Cast("int64", top_k[bx, 0]) < vocab_size
+                        )
+                    ):
+                        for _ in T.serial(num_search_iters):
+                            thread_count[()] = 0
+                            thread_sum[()] = T.float32(0)
+                            for i in T.serial(T.ceildiv(vocab_size, TX)):
+                                idx: T.let[T.int64] = i * TX + tx
+                                if idx < vocab_size:
+                                    e: T.let[T.float32] = workspace[bx, idx]
+                                    if e >= (top_k_lo[()] + top_k_hi[()]) * T.float32(0.5):
+                                        thread_count[()] += 1
+                                    if e >= (top_p_lo[()] + top_p_hi[()]) * T.float32(0.5):
+                                        thread_sum[()] += e
+                            block_reduce(tx, thread_count[()], row_count, "int32", op_reduce_sum)
+                            block_reduce(tx, thread_sum[()], row_target, "float32", op_reduce_sum)
+                            if row_count[()] <= top_k[bx, 0]:
+                                top_k_hi[()] = (top_k_lo[()] + top_k_hi[()]) * T.float32(0.5)
+                            else:
+                                top_k_lo[()] = (top_k_lo[()] + top_k_hi[()]) * T.float32(0.5)
+                            if row_target[()] >= top_p[bx, 0] * row_sum[()]:
+                                top_p_lo[()] = (top_p_lo[()] + top_p_hi[()]) * T.float32(0.5)
+                            else:
+                                top_p_hi[()] = (top_p_lo[()] + top_p_hi[()]) * T.float32(0.5)
+                    cutoff[()] = T.min(
+                        T.max(
+                            T.max(
+                                T.if_then_else(
+                                    top_k[bx, 0] > 0
+                                    and T.Cast("int64", top_k[bx, 0]) < vocab_size,
+                                    top_k_hi[()],
+                                    T.float32(0),
+                                ),
+                                T.if_then_else(
+                                    top_p[bx, 0] < T.float32(1), top_p_lo[()], T.float32(0)
+                                ),
+                            ),
+                            min_p[bx, 0],
+                        ),
+                        T.float32(1),
+                    )
+
+                    # Draw from the kept entries, ordered by the owning thread then the index.
+                    thread_sum[()] = T.float32(0)
+                    for i in T.serial(T.ceildiv(vocab_size, TX)):
+                        idx: T.let[T.int64] = i * TX + tx
+                        if idx < vocab_size:
+                            if workspace[bx, idx] >= cutoff[()]:
+                                thread_sum[()] += workspace[bx, idx]
+                    thread_sums[tx] = thread_sum[()]
+                    block_reduce(tx, thread_sum[()], row_sum, "float32", op_reduce_sum)
+                    row_target[()] = uniform_samples[bx, 0] * row_sum[()]
+                    prefix[()] = T.float32(0)
+                    for j in T.serial(tx):
+                        prefix[()] += thread_sums[j]
+                    T.tvm_storage_sync("shared")
+                    if (
+                        thread_sum[()] > T.float32(0)
+                        and prefix[()] <= row_target[()]
+                        and row_target[()] < prefix[()] + thread_sum[()]
+                    ):
+                        found[()] = False
+                        for i in T.serial(T.ceildiv(vocab_size, TX)):
+                            idx: T.let[T.int64] = i * TX + tx
+                            if idx < vocab_size and not found[()]:
+                                if workspace[bx, idx] >= cutoff[()]:
+                                    prefix[()] += workspace[bx, idx]
+                                    if row_target[()] < prefix[()]:
+                                        token_ids[bx, 0] = T.Cast(dtype, idx)
+                                        found[()] = True
+
+    return fused_sampling_from_logits
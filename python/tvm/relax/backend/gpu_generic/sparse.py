@@ -0,0 +1,284 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=invalid-name, too-many-locals
+"""Backend kernels for 2:4 structured-sparse operators.
+
+The generic generators return a GPU kernel when `gpu` is set, and a kernel parallelized over
+the CPU threads otherwise. The metadata layout is the one of the `mma.sp` m16n8k16 instruction,
+as described in `relax.op.sparse`.
+"""
+
+from tvm.script import tirx as T
+from tvm.tirx import PrimFunc
+
+
+def sparse_compress_2_4(dtype: str, gpu: bool, num_threads: int = 256) -> PrimFunc:
+    """Generate the kernel of sparse.compress_2_4.
+
+    Each thread, or each iteration on CPU, produces one metadata word, and the 16 kept values
+    of the two rows of the weight whose positions the word holds.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the weight.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    num_threads : int
+        The number of threads of a block on GPU.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+
+    @T.macro
+    def compress_word(weight: T.Buffer, values: T.Buffer, metadata: T.Buffer, word: T.int64):
+        with T.sblock():
+            pos = T.sblock_alloc_buffer((2,), "int32", scope="local")
+            bits = T.sblock_alloc_buffer((), "uint32", scope="local")
+            num_col_tiles: T.let[T.int64] = metadata.shape[1]
+            tile_row: T.let[T.int64] = word // (num_col_tiles * 8)
+            tile_col: T.let[T.int64] = word // 8 % num_col_tiles
+            g: T.let[T.int64] = word % 8
+            bits[()] = T.uint32(0)
+            for half in T.serial(2):
+                n: T.let[T.int64] = tile_row * 16 + half * 8 + g
+                for q in T.serial(4):
+                    k: T.let[T.int64] = tile_col * 16 + q * 4
+                    # Keep the first two nonzeros of the group, or zeros next to them.
+                    pos[0] = -1
+                    pos[1] = -1
+                    for p in T.serial(4):
+                        if weight[n, k + p] != T.Cast(dtype, 0):
+                            if pos[0] < 0:
+                                pos[0] = p
+                            elif pos[1] < 0:
+                                pos[1] = p
+                    if pos[0] < 0:
+                        pos[0] = 0
+                        pos[1] = 1
+                    elif pos[1] < 0:
+                        if pos[0] == 3:
+                            pos[0] = 2
+                            pos[1] = 3
+                        else:
+                            pos[1] = pos[0] + 1
+                    for i in T.serial(2):
+                        values[n, tile_col * 8 + q * 2 + i] = weight[n, k + pos[i]]
+                        bits[()] = bits[()] | (
+                            T.Cast("uint32", pos[i])
+                            << T.Cast("uint32", half * 16 + q * 4 + i * 2)
+                        )
+            metadata[tile_row, tile_col, g] = bits[()]
+
+    @T.prim_func(private=True, s_tir=True)
+    def compress(var_weight: T.handle, var_values: T.handle, var_metadata: T.handle):
+        T.func_attr({"tirx.is_scheduled": True})
+        out_features, in_features = T.int64(), T.int64()
+        weight = T.match_buffer(var_weight, (out_features, in_features), dtype)
+        values = T.match_buffer(var_values, (out_features, in_features // 2), dtype)
+        metadata = T.match_buffer(
+            var_metadata, (out_features // 16, in_features // 16, 8), "uint32"
+        )
+        num_words: T.let[T.int64] = out_features // 16 * (in_features // 16) * 8
+        if gpu:
+            for bx in T.thread_binding(T.ceildiv(num_words, num_threads), thread="blockIdx.x"):
+                for tx in T.thread_binding(num_threads, thread="threadIdx.x"):
+                    if bx * num_threads + tx < num_words:
+                        compress_word(weight, values, metadata, bx * num_threads + tx)
+        else:
+            for word in T.parallel(num_words):
+                compress_word(weight, values, metadata, word)
+
+    return compress
+
+
+def sparse_matmul_2_4(dtype: str, gpu: bool, tile: int = 16) -> PrimFunc:
+    """Generate the kernel of sparse.matmul_2_4 with the compressed weight read directly.
+
+    Each output element decodes the positions of the kept values of its row of the weight from
+    the metadata, and gathers the matching elements of its row of the data.
+
+    Parameters
+    ----------
+    dtype : str
+        The data type of the data and the weight.
+
+    gpu : bool
+        Whether to generate a GPU kernel.
+
+    tile : int
+        The size of the square output tile of a block on GPU.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+
+    @T.macro
+    def dot(
+        data: T.Buffer,
+        values: T.Buffer,
+        metadata: T.Buffer,
+        acc: T.Buffer,
+        m: T.int64,
+        n: T.int64,
+    ):
+        acc[()] = T.float32(0)
+        for c in T.serial(values.shape[1]):
+            tile_col: T.let[T.int64] = c // 8
+            shift: T.let[T.uint32] = T.Cast("uint32", n % 16 // 8 * 16 + c % 8 * 2)
+            pos: T.let[T.int64] = T.Cast(
+                "int64", (metadata[n // 16, tile_col, n % 8] >> shift) & T.uint32(3)
+            )
+            acc[()] += T.Cast("float32", data[m, tile_col * 16 + c % 8 // 2 * 4 + pos]) * T.Cast(
+                "float32", values[n, c]
+            )
+
+    TILE = T.int64(tile)
+
+    @T.prim_func(private=True, s_tir=True)
+    def matmul(var_data: T.handle, var_values: T.handle, var_metadata: T.handle, var_out: T.handle):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_rows, out_features, in_features = T.int64(), T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_rows, in_features), dtype)
+        values = T.match_buffer(var_values, (out_features, in_features // 2), dtype)
+        metadata = T.match_buffer(
+            var_metadata, (out_features // 16, in_features // 16, 8), "uint32"
+        )
+        out = T.match_buffer(var_out, (num_rows, out_features), dtype)
+        if gpu:
+            for by in T.thread_binding(T.ceildiv(num_rows, TILE), thread="blockIdx.y"):
+                for bx in T.thread_binding(T.ceildiv(out_features, TILE), thread="blockIdx.x"):
+                    for ty in T.thread_binding(TILE, thread="threadIdx.y"):
+                        for tx in T.thread_binding(TILE, thread="threadIdx.x"):
+                            with T.sblock():
+                                acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                                if by * TILE + ty < num_rows and bx * TILE + tx < out_features:
+                                    dot(data, values, metadata, acc, by * TILE + ty, bx * TILE + tx)
+                                    out[by * TILE + ty, bx * TILE + tx] = T.Cast(dtype, acc[()])
+        else:
+            for m in T.parallel(num_rows):
+                for n in T.serial(out_features):
+                    with T.sblock():
+                        acc = T.sblock_alloc_buffer((), "float32", scope="local")
+                        dot(data, values, metadata, acc, m, n)
+                        out[m, n] = T.Cast(dtype, acc[()])
+
+    return matmul
+
+
+def sparse_matmul_2_4_mma_sp(num_warps: int = 4, tile_m: int = 32) -> PrimFunc:
+    """Generate the float16 kernel of sparse.matmul_2_4 on the sparse tensor cores of CUDA.
+
+    The weight is the sparse operand `A` of `mma.sp` m16n8k16, so that the kernel computes the
+    transposed output `weight @ data.T`. Each warp multiplies a tile of 16 rows of the weight
+    with `tile_m` rows of the data, which are loaded without staging through shared memory, and
+    the metadata of a tile of the weight is one word per thread.
+
+    Parameters
+    ----------
+    num_warps : int
+        The number of warps of a block, each on its own tile of rows of the weight.
+
+    tile_m : int
+        The number of rows of the data of a block, a multiple of 8.
+
+    Returns
+    -------
+    func : PrimFunc
+        The generated function.
+    """
+    dtype = "float16"
+    num_tiles = tile_m // 8
+    TILE_M = T.int64(tile_m)
+
+    @T.prim_func(private=True, s_tir=True)
+    def matmul(var_data: T.handle, var_values: T.handle, var_metadata: T.handle, var_out: T.handle):
+        T.func_attr({"tirx.is_scheduled": True})
+        num_rows, out_features, in_features = T.int64(), T.int64(), T.int64()
+        data = T.match_buffer(var_data, (num_rows, in_features), dtype)
+        values = T.match_buffer(var_values, (out_features, in_features // 2), dtype)
+        metadata = T.match_buffer(
+            var_metadata, (out_features // 16, in_features // 16, 8), "uint32"
+        )
+        out = T.match_buffer(var_out, (num_rows, out_features), dtype)
+        for by in T.thread_binding(T.ceildiv(num_rows, TILE_M), thread="blockIdx.y"):
+            for bx in T.thread_binding(
+                T.ceildiv(out_features, 16 * num_warps), thread="blockIdx.x"
+            ):
+                for ty in T.thread_binding(num_warps, thread="threadIdx.y"):
+                    for tx in T.thread_binding(32, thread="threadIdx.x"):
+                        with T.sblock():
+                            a_frag = T.sblock_alloc_buffer((4,), dtype, scope="local")
+                            b_frag = T.sblock_alloc_buffer((num_tiles * 4,), dtype, scope="local")
+                            acc = T.sblock_alloc_buffer((num_tiles * 4,), "float32", scope="local")
+                            meta = T.sblock_alloc_buffer((1,), "uint32", scope="local")
+                            tile_row: T.let[T.int64] = bx * num_warps + ty
+                            if tile_row * 16 < out_features:
+                                for i in T.serial(num_tiles * 4):
+                                    acc[i] = T.float32(0)
+                                for tile_col in T.serial(in_features // 16):
+                                    meta[0] = metadata[tile_row, tile_col, tx // 4]
+                                    for i in T.serial(4):
+                                        a_frag[i] = values[
+                                            tile_row * 16 + i // 2 * 8 + tx // 4,
+                                            tile_col * 8 + tx % 4 * 2 + i % 2,
+                                        ]
+                                    for t, i in T.grid(num_tiles, 4):
+                                        m: T.let[T.int64] = by * TILE_M + t * 8 + tx // 4
+                                        k: T.let[T.int64] = (
+                                            tile_col * 16 + i // 2 * 8 + tx % 4 * 2 + i % 2
+                                        )
+                                        b_frag[t * 4 + i] = T.if_then_else(
+                                            m < num_rows, data[m, k], T.float16(0)
+                                        )
+                                    for t in T.serial(num_tiles):
+                                        T.evaluate(
+                                            T.ptx.mma.sp(
+                                                "m16n8k16",
+                                                "row",
+                                                "col",
+                                                "fp16",
+                                                "fp16",
+                                                "fp32",
+                                                a_frag.data,
+                                                0,
+                                                b_frag.data,
+                                                t * 4,
+                                                acc.data,
+                                                t * 4,
+                                                meta.data,
+                                                0,
+                                                0,
+                                                False,
+                                                dtype="float32",
+                                            )
+                                        )
+                                for t, i in T.grid(num_tiles, 4):
+                                    row: T.let[T.int64] = by * TILE_M + t * 8 + tx % 4 * 2 + i % 2
+                                    if row < num_rows:
+                                        out[row, tile_row * 16 + i // 2 * 8 + tx // 4] = T.Cast(
+                                            dtype, acc[t * 4 + i]
+                                        )
+
+    return matmul
@@ -440,6 +440,46 @@ def make_matmul_multiply_pattern(
     return out, annotations
 
 
+def make_matmul_channel_scale_pattern(
+    with_bias: bool = False,
+    transposed_rhs: bool = False,
+) -> tuple[DFPattern, Mapping[str, DFPattern]]:
+    """
+    Create pattern for matrix multiplication whose output channels are scaled by a vector, e.g.
+    the per-channel dequantization scale of the weight, optionally followed by bias addition.
+
+    Parameters
+    ----------
+    with_bias: bool
+        Whether or not to include bias addition
+
+    transposed_rhs: bool
+        Whether the right hand side of multiplication is transposed.
+
+    Returns
+    -------
+    pattern: DFPattern
+        The resulting pattern describing a matrix multiplication.
+
+    annotations: Mapping[str, DFPattern]
+        A mapping from name to sub pattern. It can be used to extract important expressions from
+        match result, to power the partition check function and codegen.
+    """
+
+    lhs = wildcard()
+    rhs = wildcard()
+    channel_scale = wildcard()
+    annotations = {"lhs": lhs, "rhs": rhs, "channel_scale": channel_scale}
+
+    if transposed_rhs:
+        rhs = is_op("relax.permute_dims")(rhs)
+    out = is_op("relax.matmul")(lhs, rhs)
+    annotations["root"] = out
+    out = is_op("relax.multiply")(out, channel_scale)
+
+    return _with_bias_activation_pattern(out, annotations, with_bias)
+
+
 def make_attention_rewrite_pattern(
     qkv_layout: str, out_layout: str, with_bias: bool, with_cast: bool, with_kv_repeat: bool = False
 ):
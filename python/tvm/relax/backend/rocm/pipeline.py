@@ -24,6 +24,9 @@ def library_dispatch_passes(target: tvm.target.Target):  # pylint: disable=unuse
     """The default library dispatch passes for ROCm backend."""
     return [
         relax.backend.DispatchSampling(),
+        relax.backend.DispatchMoE(),
+        relax.backend.DispatchLoRA(),
+        relax.backend.DispatchSparse(),
         relax.backend.DispatchSortScan(),
     ]
 
@@ -62,7 +65,9 @@ def finalize_passes(target: tvm.target.Target):  # pylint: disable=unused-argume
     """The default finalization passes for ROCm backend."""
     return [
         relax.transform.StaticPlanBlockMemory(),
+        relax.transform.RewriteCUDAGraph(),
         relax.transform.LowerAllocTensor(),
+        relax.transform.AssignDeviceStreams(),
         relax.transform.KillAfterLastUse(),
         relax.transform.LowerRuntimeBuiltin(),
         relax.transform.ComputePrimValue(),
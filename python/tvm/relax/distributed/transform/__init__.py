@@ -19,6 +19,7 @@
 
 from .transform import (
     PropagateSharding,
+    PlanSharding,
     LowerGlobalViewToLocalView,
     LegalizeRedistribute,
     LowerDistIR,
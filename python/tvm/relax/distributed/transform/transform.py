@@ -19,6 +19,7 @@
 
 import tvm.ir
 
+from ..global_info import DeviceMesh
 from . import _ffi_api
 
 
@@ -33,6 +34,53 @@ def PropagateSharding() -> tvm.ir.transform.Pass:
     return _ffi_api.PropagateSharding()  # type: ignore
 
 
+def PlanSharding(
+    device_mesh: DeviceMesh,
+    device_flops: float = 1e14,
+    link_bandwidth: float = 1e11,
+    collective_latency: float = 1e-5,
+    memory_budget: int = 0,
+) -> tvm.ir.transform.Pass:
+    """Search the sharding of the function parameters on the device mesh.
+
+    Starting from all the parameters replicated, the pass greedily shards one parameter axis
+    on one mesh dimension at a time. Each plan is propagated with PropagateSharding and scored
+    by the estimated step time: the matmul FLOPs and the element counts of the other operators
+    on one device, plus the bytes moved by redistribute, by the all-reduce of the matmul with
+    a sharded reduction axis, and by gathering the sharded outputs. Plans whose parameters
+    exceed the memory budget per device are ranked after those within the budget.
+
+    The public functions without sharding annotations are planned. The result carries the
+    chosen plan as ``annotate_sharding`` on the parameters and is consumed by
+    PropagateSharding.
+
+    Parameters
+    ----------
+    device_mesh : DeviceMesh
+        The device mesh to shard on.
+
+    device_flops : float
+        The FLOPs per second of a device.
+
+    link_bandwidth : float
+        The bytes per second a device sends in collectives.
+
+    collective_latency : float
+        The latency in seconds of a collective.
+
+    memory_budget : int
+        The bytes of parameters per device allowed, or 0 for no budget.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass
+    """
+    return _ffi_api.PlanSharding(  # type: ignore
+        device_mesh, device_flops, link_bandwidth, collective_latency, memory_budget
+    )
+
+
 def LowerGlobalViewToLocalView() -> tvm.ir.transform.Pass:
     """Lower global view TIR to local view
 
@@ -44,17 +92,28 @@ def LowerGlobalViewToLocalView() -> tvm.ir.transform.Pass:
     return _ffi_api.LowerGlobalViewToLocalView()  # type: ignore
 
 
-def LegalizeRedistribute() -> tvm.ir.transform.Pass:
+def LegalizeRedistribute(num_chunks: int = 4) -> tvm.ir.transform.Pass:
     """Legalize redistribute op to ccl op.
     S->R: R.ccl.allgather
     R->S: R.dist.redistribute_replica_to_shard
 
+    The collectives are fused with the neighboring compute when possible:
+    S[0]->R feeding the lhs of R.matmul: chunked R.ccl.allgather and R.matmul pipeline
+    R.ccl.allreduce followed by R->S[0]: R.ccl.reducescatter
+
+    Parameters
+    ----------
+    num_chunks : int
+        The number of chunks an allgather feeding a matmul is split into, so that the
+        allgather of one chunk overlaps with the matmul of another. 1 disables the
+        pipelining.
+
     Returns
     -------
     ret : tvm.transform.Pass
         The registered pass
     """
-    return _ffi_api.LegalizeRedistribute()  # type: ignore
+    return _ffi_api.LegalizeRedistribute(num_chunks)  # type: ignore
 
 
 def LowerDistIR() -> tvm.ir.transform.Pass:
@@ -27,6 +27,7 @@ Contents:
 - KV-cache enums (``AttnKind``, ``RopeMode``)
 - Small TVMScript helpers (``_var``, ``_var_cpu``, ``_causal_mask``, ``_rope``)
 - Length-info accessors for sliding-window-aware indexing
+- Quantized KV storage helpers (``_kv_scale``, ``_quantize_kv``, ``_dequantize_kv_pages``)
 - Buffer allocators for the tiled online-softmax state used by every prefill kernel
 - ``_make_prefill_macros`` — the ``@T.macro`` bundle invoked by the prefill kernels
 - Tiling config (``_get_prefill_kernel_config``) and scheduling (``_schedule_prefill_kernel``)
@@ -161,6 +162,71 @@ def _get_seq_offset(pos, seq_id, length_info, sliding_window):
     )
 
 
+def _kv_storage_max_value(kv_storage_dtype: str) -> float:
+    """Return the largest magnitude the quantized KV storage dtype represents."""
+    if kv_storage_dtype == "int8":
+        return 127.0
+    if kv_storage_dtype == "float8_e4m3fn":
+        return 448.0
+    if kv_storage_dtype == "float8_e5m2":
+        return 57344.0
+    raise ValueError(f"Unsupported quantized KV storage dtype: {kv_storage_dtype}")
+
+
+def _kv_scale(absmax, kv_storage_dtype: str):
+    """The float32 scale of a K/V head vector, given the absolute maximum of its values."""
+    return tirx.max(absmax, tirx.const(1e-6, "float32")) / tirx.const(_kv_storage_max_value(kv_storage_dtype), "float32")
+
+
+def _quantize_kv(value, scale, kv_storage_dtype: str):
+    """Quantize the float32 K/V value with its scale into the KV storage dtype."""
+    max_value = tirx.const(_kv_storage_max_value(kv_storage_dtype), "float32")
+    quantized = tirx.min(tirx.max(value / scale, -max_value), max_value)
+    if kv_storage_dtype == "int8":
+        quantized = tirx.round(quantized)
+    return quantized.astype(kv_storage_dtype)
+
+
+def _dequantize_kv_pages(func: tirx.PrimFunc, kv_storage_dtype: str) -> tirx.PrimFunc:
+    """Rewrite a kernel that reads the MHA KV pages into the one that reads the pages
+    quantized in ``kv_storage_dtype``, dequantizing every loaded value with its scale.
+
+    The returned kernel takes the float32 page scales in layout
+    ``(num_pages, page_size, 2, num_kv_heads)`` right after the pages.
+    """
+    pages_param = next(param for param in func.params if param in func.buffer_map and func.buffer_map[param].name == "pages")
+    pages = func.buffer_map[pages_param]
+    num_pages, _, num_kv_heads, page_size, _ = pages.shape
+    quantized_pages = tirx.decl_buffer(pages.shape, kv_storage_dtype, "pages", elem_offset=pages.elem_offset)
+    page_scales = tirx.decl_buffer((num_pages, page_size, 2, num_kv_heads), "float32", "page_scales")
+
+    def _postorder(op):
+        if isinstance(op, tirx.BufferLoad) and op.buffer.same_as(pages):
+            page_no, kv, head, page_offset, _ = op.indices
+            scale = tirx.BufferLoad(page_scales, [page_no, page_offset, kv, head])
+            return (tirx.BufferLoad(quantized_pages, op.indices).astype("float32") * scale).astype(pages.dtype)
+        if isinstance(op, tirx.SBlock) and any(region.buffer.same_as(pages) for region in op.reads):
+            reads = []
+            for region in op.reads:
+                if not region.buffer.same_as(pages):
+                    reads.append(region)
+                    continue
+                page_no, kv, head, page_offset, _ = region.region
+                reads.append(tirx.BufferRegion(quantized_pages, region.region))
+                reads.append(tirx.BufferRegion(page_scales, [page_no, page_offset, kv, head]))
+            return tirx.SBlock(op.iter_vars, reads, op.writes, op.name_hint, op.body, op.init, op.alloc_buffers, op.match_buffers, op.annotations)
+        return op
+
+    body = tirx.stmt_functor.ir_transform(func.body, None, _postorder, ["tirx.BufferLoad", "tirx.SBlock"])
+    page_scales_param = tirx.Var("var_page_scales", "handle")
+    params = list(func.params)
+    params.insert(params.index(pages_param) + 1, page_scales_param)
+    buffer_map = dict(func.buffer_map)
+    buffer_map[pages_param] = quantized_pages
+    buffer_map[page_scales_param] = page_scales
+    return tirx.PrimFunc(params, body, func.ret_type, buffer_map, func.attrs)
+
+
 def _alloc_softmax_state_buffers(tile_x, tile_z, bdx, num_warps):
     """Allocate the shared/local online-softmax working state used by every tiled prefill kernel.
 
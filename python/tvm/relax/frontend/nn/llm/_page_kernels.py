@@ -21,7 +21,8 @@
 
 This module contains:
 - Append helpers that transpose/write new K/V tokens into the paged layout
-  (``_kv_cache_transpose_append`` and its MLA variant).
+  (``_kv_cache_transpose_append``, its MLA variant, and its quantized variant
+  ``_kv_cache_transpose_append_quantized``).
 - Debug helpers that extract K/V from the paged layout for inspection
   (``_kv_cache_debug_get_kv``, ``_kv_cache_debug_get_kv_mla``).
 - Copy helpers used by the cache runtime for forking/sharing pages
@@ -34,7 +35,7 @@ This module contains:
 from tvm.script import tirx as T
 from tvm.target import Target
 
-from ._kernel_common import get_max_num_threads_per_block
+from ._kernel_common import _kv_scale, _quantize_kv, get_max_num_threads_per_block
 
 
 def _kv_cache_transpose_append(num_key_value_heads, head_dim, dtype, page_size: int = 16):
@@ -74,6 +75,71 @@ def _kv_cache_transpose_append(num_key_value_heads, head_dim, dtype, page_size:
     return tir_kv_cache_transpose_append
 
 
+def _kv_cache_transpose_append_quantized(num_key_value_heads, head_dim, dtype, kv_storage_dtype, page_size: int = 16):
+    """Return the TIR function that quantizes and appends new k/v data to PagedKVCache.
+    Each K/V head vector of a token is quantized with its own scale, which is
+    written to the page scales in layout ``(num_pages, page_size, 2, num_kv_heads)``.
+    """
+
+    @T.prim_func(s_tir=True)
+    def tir_kv_cache_transpose_append_quantized(
+        var_pages: T.handle,
+        var_page_scales: T.handle,
+        var_k_data: T.handle,
+        var_v_data: T.handle,
+        var_position_map: T.handle,
+    ):
+        T.func_attr({"tirx.noalias": True})
+        ntoken = T.Var("num_tokens_excluding_cache", "int64")
+        num_pages = T.int64()
+        pages_elem_offset = T.int64()
+        position_map_elem_offset = T.int32()
+        pages = T.match_buffer(var_pages, (num_pages, 2, num_key_value_heads, page_size, head_dim), kv_storage_dtype, elem_offset=pages_elem_offset)
+        page_scales = T.match_buffer(var_page_scales, (num_pages, page_size, 2, num_key_value_heads), "float32")
+        k_data = T.match_buffer(var_k_data, (ntoken, num_key_value_heads, head_dim), dtype)
+        v_data = T.match_buffer(var_v_data, (ntoken, num_key_value_heads, head_dim), dtype)
+        position_map = T.match_buffer(var_position_map, (ntoken,), "int32", elem_offset=position_map_elem_offset)
+        k_absmax = T.alloc_buffer((ntoken, num_key_value_heads), "float32")
+        v_absmax = T.alloc_buffer((ntoken, num_key_value_heads), "float32")
+        for global_pos, h, f in T.grid(ntoken, num_key_value_heads, head_dim):
+            with T.sblock("k_absmax"):
+                vgpos, vh, vf = T.axis.remap("SSR", [global_pos, h, f])
+                with T.init():
+                    k_absmax[vgpos, vh] = T.float32(0)
+                k_absmax[vgpos, vh] = T.max(k_absmax[vgpos, vh], T.fabs(T.Cast("float32", k_data[vgpos, vh, vf])))
+        for global_pos, h, f in T.grid(ntoken, num_key_value_heads, head_dim):
+            with T.sblock("v_absmax"):
+                vgpos, vh, vf = T.axis.remap("SSR", [global_pos, h, f])
+                with T.init():
+                    v_absmax[vgpos, vh] = T.float32(0)
+                v_absmax[vgpos, vh] = T.max(v_absmax[vgpos, vh], T.fabs(T.Cast("float32", v_data[vgpos, vh, vf])))
+        for global_pos, h in T.grid(ntoken, num_key_value_heads):
+            if position_map[global_pos] != T.int32(-1):
+                with T.sblock("scale_append"):
+                    vgpos, vh = T.axis.remap("SS", [global_pos, h])
+                    T.reads(position_map[vgpos], k_absmax[vgpos, vh], v_absmax[vgpos, vh])
+                    T.writes(page_scales[position_map[vgpos] // page_size, position_map[vgpos] % page_size, 0:2, vh])
+                    position: T.int32 = position_map[vgpos]  # type: ignore
+                    page_scales[T.floordiv(position, page_size), T.floormod(position, page_size), 0, vh] = _kv_scale(k_absmax[vgpos, vh], kv_storage_dtype)
+                    page_scales[T.floordiv(position, page_size), T.floormod(position, page_size), 1, vh] = _kv_scale(v_absmax[vgpos, vh], kv_storage_dtype)
+        for global_pos, h, f in T.grid(ntoken, num_key_value_heads, head_dim):
+            if position_map[global_pos] != T.int32(-1):
+                with T.sblock("k_transpose_append"):
+                    vgpos, vh, vf = T.axis.remap("SSS", [global_pos, h, f])
+                    T.reads(position_map[vgpos], k_data[vgpos, vh, vf], k_absmax[vgpos, vh])
+                    T.writes(pages[position_map[vgpos] // page_size, 0, vh, position_map[vgpos] % page_size, vf])
+                    position: T.int32 = position_map[vgpos]  # type: ignore[name-defined,no-redef]
+                    pages[T.floordiv(position, page_size), 0, vh, T.floormod(position, page_size), vf] = _quantize_kv(T.Cast("float32", k_data[vgpos, vh, vf]), _kv_scale(k_absmax[vgpos, vh], kv_storage_dtype), kv_storage_dtype)
+                with T.sblock("v_transpose_append"):
+                    vgpos, vh, vf = T.axis.remap("SSS", [global_pos, h, f])
+                    T.reads(position_map[vgpos], v_data[vgpos, vh, vf], v_absmax[vgpos, vh])
+                    T.writes(pages[position_map[vgpos] // page_size, 1, vh, position_map[vgpos] % page_size, vf])
+                    position: T.int32 = position_map[vgpos]  # type: ignore[name-defined,no-redef]
+                    pages[T.floordiv(position, page_size), 1, vh, T.floormod(position, page_size), vf] = _quantize_kv(T.Cast("float32", v_data[vgpos, vh, vf]), _kv_scale(v_absmax[vgpos, vh], kv_storage_dtype), kv_storage_dtype)
+
+    return tir_kv_cache_transpose_append_quantized
+
+
 def _kv_cache_transpose_append_mla(d_qk: int, dtype, page_size: int = 16):
     """Return the TIR function that appends new compressed KV data to PagedKVCache for MLA."""
 
@@ -0,0 +1,146 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+"""Multi-adapter LoRA modeling.
+
+The ``LoRAAdapterPool`` holds the weights of the loaded LoRA adapters on device, one slot per
+adapter, and lets one batch mix the sequences of different adapters. The runtime loads and
+unloads adapters with ``vm.builtin.lora_adapter_pool_load`` and
+``vm.builtin.lora_adapter_pool_unload``, and gives the adapter of each sequence of a round of
+forwarding to ``vm.builtin.lora_adapter_pool_begin_forward``. The model adds the low-rank delta
+of the adapter of each sequence to a projection with ``LoRAAdapterPool.apply``, which runs the
+segmented low-rank GEMM ``relax.lora.sgmv`` over all sequences of the batch.
+"""
+
+from tvm import relax as rx
+from tvm.relax.frontend.nn import Object, Tensor, op
+
+
+class LoRAAdapterPool(Object):  # pylint: disable=too-few-public-methods
+    """The pool of LoRA adapters for batches mixing several adapters.
+
+    Each adapted projection of a layer is given by a pair of weights in the pool: the shrink
+    weight of shape `(rank, in_features)` followed by the expand weight of shape
+    `(out_features, rank)`. Adapters of a lower rank are zero-padded to the rank of the pool.
+
+    Parameters
+    ----------
+    num_hidden_layers : int
+        The number of layers of the model.
+
+    num_slots : int
+        The number of adapters the pool holds at once.
+
+    weight_shapes : list[tuple[int, ...]]
+        The shapes of the weights of a layer.
+
+    dtype : str
+        The data type of the weights.
+    """
+
+    def __init__(
+        self,
+        num_hidden_layers: int,
+        num_slots: int,
+        weight_shapes: list[tuple[int, ...]],
+        dtype: str,
+        name: str = "lora_adapter_pool",
+    ) -> None:
+        self.num_slots = num_slots
+        self.weight_shapes = [tuple(shape) for shape in weight_shapes]
+        self.dtype = dtype
+        super().__init__(
+            _expr=rx.call_pure_packed(
+                "vm.builtin.lora_adapter_pool_create",
+                rx.PrimValue(num_hidden_layers),
+                rx.PrimValue(num_slots),
+                rx.Tuple([rx.ShapeExpr(shape) for shape in self.weight_shapes]),
+                rx.op.zeros((), dtype),
+                ty_args=rx.AnyType(),
+            ),
+            _name=name,
+        )
+
+    def get_weight(self, layer_id: int, weight_id: int) -> Tensor:
+        """Get the weights of all slots of the weight of a layer, of shape
+        `(num_slots, *weight_shape)`."""
+        shape = (self.num_slots, *self.weight_shapes[weight_id])
+        return Tensor(
+            _expr=rx.BlockBuilder.current().emit(
+                rx.call_pure_packed(
+                    "vm.builtin.lora_adapter_pool_get_weight",
+                    self._expr,
+                    rx.PrimValue(layer_id),
+                    rx.PrimValue(weight_id),
+                    ty_args=rx.TensorType(shape, self.dtype),
+                )
+            )
+        )
+
+    def get_segments(self) -> tuple[Tensor, Tensor]:
+        """Get the int32 row offsets and the slots of the segments of the current round of
+        forwarding, where a segment is a run of consecutive sequences of the same adapter."""
+        bb = rx.BlockBuilder.current()
+        seg_indptr, weight_indices = (
+            Tensor(
+                _expr=bb.emit(
+                    rx.call_pure_packed(
+                        f"vm.builtin.lora_adapter_pool_get_{func}",
+                        self._expr,
+                        ty_args=rx.TensorType(ndim=1, dtype="int32"),
+                    )
+                )
+            )
+            for func in ["seg_indptr", "weight_indices"]
+        )
+        return seg_indptr, weight_indices
+
+    def apply(self, layer_id: int, weight_id: int, x: Tensor, scaling: float = 1.0) -> Tensor:
+        """Compute the LoRA delta of a projection for the rows of all sequences of the batch,
+        with the adapter of each sequence.
+
+        Parameters
+        ----------
+        layer_id : int
+            The layer of the projection.
+
+        weight_id : int
+            The index of the shrink weight of the projection, followed by its expand weight.
+
+        x : Tensor
+            The input of the projection of shape `(*batch, in_features)`, whose rows are the
+            tokens of the sequences one after the other.
+
+        scaling : float
+            The scaling of the delta, `alpha / rank` in the LoRA paper.
+
+        Returns
+        -------
+        delta : Tensor
+            The delta of shape `(*batch, out_features)`, zeros for the sequences without
+            adapter.
+        """
+        *batch, in_features = x.shape
+        out_features = self.weight_shapes[weight_id + 1][0]
+        x = x.reshape(-1, in_features)
+        seg_indptr, weight_indices = self.get_segments()
+        shrink = self.get_weight(layer_id, weight_id)
+        expand = self.get_weight(layer_id, weight_id + 1)
+        h = op.lora_sgmv(x, shrink, seg_indptr, weight_indices, name="lora_shrink")
+        delta = op.lora_sgmv(h, expand, seg_indptr, weight_indices, name="lora_expand")
+        if scaling != 1.0:
+            delta = delta * scaling
+        return delta.reshape(*batch, out_features)
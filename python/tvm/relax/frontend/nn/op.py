@@ -26,7 +26,7 @@ from typing import Any, TypeVar
 import numpy as np
 
 import tvm
-from tvm import te
+from tvm import te, topi
 from tvm import tirx as _tir
 from tvm.script import tirx as T
 
@@ -1974,6 +1974,67 @@ def ccl_allgather(x: Tensor, num_workers: int, name="ccl_allgather"):
     return wrap_nested(_op.ccl.allgather(x._expr, num_workers), name)
 
 
+def ccl_alltoall(x: Tensor, num_workers: int, in_group: bool = True, name="ccl_alltoall"):
+    """CCL AllToAll operator
+
+    Parameters
+    ----------
+    x : Tensor
+      The input tensor, whose first dimension is split into equal chunks, one sent to each
+      worker in order.
+
+    num_workers : int
+      Number of workers.
+
+    in_group : bool
+      Whether the exchange is among the workers of the group or among all workers.
+
+    name : str
+        Name hint for this operation.
+
+    Returns
+    -------
+    result : Tensor
+      The result tensor of alltoall, whose i-th chunk is received from worker i.
+    """
+    return wrap_nested(_op.ccl.alltoall(x._expr, num_workers, in_group), name)
+
+
+def ccl_reducescatter(
+    x: Tensor,
+    num_workers: int,
+    op_type: str = "sum",
+    in_group: bool = True,
+    name="ccl_reducescatter",
+):
+    """CCL ReduceScatter operator
+
+    Parameters
+    ----------
+    x : Tensor
+      The input tensor, whose first dimension is divisible by the number of workers.
+
+    num_workers : int
+      Number of workers.
+
+    op_type : str
+      The type of reduction operation to be applied to the input data.
+      Now "sum", "prod", "min", "max" and "avg" are supported.
+
+    in_group : bool
+      Whether the reduction operation performs globally or in group as default.
+
+    name : str
+        Name hint for this operation.
+
+    Returns
+    -------
+    result : Tensor
+      The chunk of the reduced tensor kept by the worker.
+    """
+    return wrap_nested(_op.ccl.reducescatter(x._expr, op_type, num_workers, in_group), name)
+
+
 def ccl_broadcast_from_worker0(x: Tensor, name="broadcast_from_worker"):
     """Broadcast data from worker-0 to all other workers.
 
@@ -1992,6 +2053,210 @@ def ccl_broadcast_from_worker0(x: Tensor, name="broadcast_from_worker"):
     return wrap_nested(_op.ccl.broadcast_from_worker0(x._expr), name)
 
 
+def moe_topk_gating(
+    logits: Tensor, top_k: int, normalize: bool = True, name: str = "moe_topk_gating"
+) -> tuple[Tensor, Tensor]:
+    """Route each token to the experts of the top-k routing logits.
+
+    Parameters
+    ----------
+    logits : Tensor
+        The routing logits of shape `(num_tokens, num_experts)`.
+
+    top_k : int
+        The number of experts of each token.
+
+    normalize : bool
+        Whether the softmax weights of the selected experts are renormalized to sum to 1.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    weights, expert_indices : Tuple[Tensor, Tensor]
+        The weights and the int32 indices of the experts, of shape `(num_tokens, top_k)`.
+    """
+    return wrap_nested(_op.moe.topk_gating(logits._expr, top_k, normalize), name)
+
+
+def moe_permute(
+    x: Tensor,
+    expert_indices: Tensor,
+    num_experts: int,
+    capacity: int = 0,
+    name: str = "moe_permute",
+) -> tuple[Tensor, Tensor, Tensor]:
+    """Group the rows of the tokens by expert.
+
+    Parameters
+    ----------
+    x : Tensor
+        The tokens of shape `(num_tokens, hidden_size)`.
+
+    expert_indices : Tensor
+        The experts of each token of shape `(num_tokens, top_k)`.
+
+    num_experts : int
+        The number of experts.
+
+    capacity : int
+        The number of rows of each expert, 0 for packing the rows of all tokens.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    rows, expert_indptr, token_rows : Tuple[Tensor, Tensor, Tensor]
+        The rows grouped by expert, the offsets of the rows of each expert and the row of each
+        token and expert pair. See `relax.op.moe.permute`.
+    """
+    return wrap_nested(
+        _op.moe.permute(x._expr, expert_indices._expr, num_experts, capacity), name
+    )
+
+
+def moe_group_matmul(
+    x: Tensor, weight: Tensor, expert_indptr: Tensor, name: str = "moe_group_matmul"
+) -> Tensor:
+    """Multiply the rows of each expert with the weight of the expert.
+
+    Parameters
+    ----------
+    x : Tensor
+        The rows grouped by expert of shape `(num_rows, in_features)`.
+
+    weight : Tensor
+        The weights of shape `(num_experts, out_features, in_features)`.
+
+    expert_indptr : Tensor
+        The offsets of the rows of each expert of shape `(num_experts + 1,)`.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The result of shape `(num_rows, out_features)`.
+    """
+    return wrap_nested(_op.moe.group_matmul(x._expr, weight._expr, expert_indptr._expr), name)
+
+
+def moe_unpermute(
+    x: Tensor, token_rows: Tensor, weights: Tensor, name: str = "moe_unpermute"
+) -> Tensor:
+    """Sum up the rows of the experts of each token, scaled by the weights of the experts.
+
+    Parameters
+    ----------
+    x : Tensor
+        The rows grouped by expert of shape `(num_rows, hidden_size)`.
+
+    token_rows : Tensor
+        The row of each token and expert pair of shape `(num_tokens, top_k)`, negative for
+        the dropped pairs.
+
+    weights : Tensor
+        The weights of the experts of shape `(num_tokens, top_k)`.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The result of shape `(num_tokens, hidden_size)`.
+    """
+    return wrap_nested(_op.moe.unpermute(x._expr, token_rows._expr, weights._expr), name)
+
+
+def moe_expert_parallel_matmul(
+    x: Tensor, weight: Tensor, num_workers: int, name: str = "moe_expert_parallel_matmul"
+) -> Tensor:
+    """Multiply the rows of each expert with the weight of the expert, where the experts are
+    sharded evenly over the workers.
+
+    The rows come from `moe_permute` with a capacity, so that each worker exchanges the same
+    number of rows with every other worker. Each worker sends the rows of the experts of the
+    other workers to them, multiplies the rows received for its own experts, and sends the
+    results back.
+
+    Parameters
+    ----------
+    x : Tensor
+        The rows of the local tokens of shape `(num_experts * capacity, in_features)`.
+
+    weight : Tensor
+        The weights of the local experts of shape
+        `(num_experts // num_workers, out_features, in_features)`.
+
+    num_workers : int
+        Number of workers.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The result of shape `(num_experts * capacity, out_features)`.
+    """
+    num_rows, in_features = x.shape
+    num_local_experts, out_features, _ = weight.shape
+    rows_per_chunk = num_rows // num_workers
+    capacity = rows_per_chunk // num_local_experts
+    # The i-th chunk of the rows holds the rows of the experts of worker i.
+    x = ccl_alltoall(x, num_workers, name=f"{name}_dispatch")
+    x = reshape(x, [num_workers, num_local_experts, capacity, in_features])
+    x = permute_dims(x, [1, 0, 2, 3])
+    x = reshape(x, [num_local_experts, num_workers * capacity, in_features])
+    x = matmul(x, permute_dims(weight, [0, 2, 1]))
+    x = reshape(x, [num_local_experts, num_workers, capacity, out_features])
+    x = permute_dims(x, [1, 0, 2, 3])
+    x = reshape(x, [num_rows, out_features])
+    return ccl_alltoall(x, num_workers, name=f"{name}_combine")
+
+
+def lora_sgmv(
+    x: Tensor,
+    weight: Tensor,
+    seg_indptr: Tensor,
+    weight_indices: Tensor,
+    name: str = "lora_sgmv",
+) -> Tensor:
+    """Multiply the rows of each segment with the low-rank weight of the adapter slot of the
+    segment.
+
+    Parameters
+    ----------
+    x : Tensor
+        The rows grouped by segment of shape `(num_rows, in_features)`.
+
+    weight : Tensor
+        The weights of the adapter slots of shape `(num_slots, out_features, in_features)`.
+
+    seg_indptr : Tensor
+        The offsets of the rows of each segment of shape `(num_segs + 1,)`.
+
+    weight_indices : Tensor
+        The slot of each segment of shape `(num_segs,)`, negative for the segments without
+        adapter, whose results are zeros.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The result of shape `(num_rows, out_features)`.
+    """
+    return wrap_nested(
+        _op.lora.sgmv(x._expr, weight._expr, seg_indptr._expr, weight_indices._expr), name
+    )
+
+
 def tensor_expr_op(
     tensor_expr_func: Callable,
     name_hint: str,
@@ -2706,6 +2971,98 @@ def multinomial_from_uniform(
     )
 
 
+def philox_uniform(
+    state: Tensor,
+    shape: Sequence[IntExpr],
+    dtype: str = "float32",
+    name: str = "philox_uniform",
+) -> Tensor:
+    """Draws uniform samples in [0, 1) from the counter-based Philox4x32-10 generator.
+
+    Notes
+    -----
+    The samples are a pure function of the state and of their flat index, so the stream is the
+    same on every backend. A call consumes ceil(numel / 4) counters of the stream, and the caller
+    advances the offset of the state by that many before the next call.
+
+    Parameters
+    ----------
+    state : Tensor
+        The uint64 tensor of shape (2,) holding [seed, offset].
+
+    shape : Sequence[IntExpr]
+        The shape of the output.
+
+    dtype : str
+        The float data type of the output.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The uniform samples.
+
+    Examples
+    --------
+    .. code-block:: python
+
+        uniform_sample = philox_uniform(state, (batch, 1))
+        token = multinomial_from_uniform(prob, uniform_sample)
+    """
+    assert state.dtype == "uint64", f"The Philox state must be uint64, but got {state.dtype}"
+    shape = list(shape)
+    return tensor_expr_op(
+        lambda state_te: topi.random.philox_uniform(state_te, shape, dtype),
+        name_hint=name,
+        args=[state],
+    )
+
+
+def philox_dropout(
+    x: Tensor,
+    state: Tensor,
+    rate: float = 0.5,
+    name: str = "philox_dropout",
+) -> tuple[Tensor, Tensor]:
+    """Applies the training dropout, with the drop decisions drawn from the counter-based
+    Philox4x32-10 generator.
+
+    Notes
+    -----
+    Each element is dropped with the probability rate and the kept elements are scaled by
+    1 / (1 - rate). The mask consumes ceil(numel / 4) counters of the stream, like
+    :py:func:`philox_uniform`, so the same state regenerates the same mask in the backward pass.
+
+    Parameters
+    ----------
+    x : Tensor
+        The input tensor.
+
+    state : Tensor
+        The uint64 tensor of shape (2,) holding [seed, offset].
+
+    rate : float
+        The probability for an element to be dropped, in [0, 1).
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tuple[Tensor, Tensor]
+        The output of the dropout, and the mask of the kept elements in the dtype of x.
+    """
+    assert state.dtype == "uint64", f"The Philox state must be uint64, but got {state.dtype}"
+    out, mask = tensor_expr_op(
+        lambda x_te, state_te: topi.random.philox_dropout(x_te, state_te, rate),
+        name_hint=name,
+        args=[x, state],
+    )
+    return out, mask
+
+
 def sample_top_p_top_k_from_sorted_prob(
     sorted_prob: Tensor,
     sorted_index: Tensor,
@@ -2944,3 +3301,104 @@ def renormalize_top_p_top_k_prob(prob, sorted_prob, top_p, top_k):
     )
     renorm_prob = filtered_prob / sum(filtered_prob, axis=1, keepdims=True)
     return renorm_prob
+
+
+def fused_sample_from_logits(
+    logits: Tensor,
+    penalty_token_ids: Tensor,
+    penalty_token_freqs: Tensor,
+    repetition_penalty: Tensor,
+    presence_penalty: Tensor,
+    frequency_penalty: Tensor,
+    temperature: Tensor,
+    top_p: Tensor,
+    top_k: Tensor,
+    min_p: Tensor,
+    uniform_sample: Tensor,
+    dtype: str = "int64",
+    name: str = "fused_sample_from_logits",
+):
+    """Samples token ids from logits on GPU in one kernel, applying the penalties, the
+    temperature, the top-k, top-p and min-p filters and the multinomial draw, so that only
+    the token ids are left for the host to read.
+
+    Notes
+    -----
+    This operator only runs on GPU targets. The penalty token ids of a row must be distinct.
+
+    Parameters
+    ----------
+    logits : Tensor
+        A 2-D tensor of shape (batch, vocab_size).
+
+    penalty_token_ids : Tensor
+        The int32 tensor of shape (batch, num_tokens) holding the appeared token ids of each
+        row, padded with negative ids.
+
+    penalty_token_freqs : Tensor
+        The int32 tensor of shape (batch, num_tokens) holding the frequency of each
+        penalty token.
+
+    repetition_penalty : Tensor
+        The float32 tensor of shape (batch, 1), 1 for no repetition penalty.
+
+    presence_penalty : Tensor
+        The float32 tensor of shape (batch, 1), 0 for no presence penalty.
+
+    frequency_penalty : Tensor
+        The float32 tensor of shape (batch, 1), 0 for no frequency penalty.
+
+    temperature : Tensor
+        The float32 tensor of shape (batch, 1), 0 for greedy sampling.
+
+    top_p : Tensor
+        The float32 tensor of shape (batch, 1), 1 for no top-p filtering.
+
+    top_k : Tensor
+        The int32 tensor of shape (batch, 1), 0 for no top-k filtering.
+
+    min_p : Tensor
+        The float32 tensor of shape (batch, 1) of the minimum probability relative to the
+        largest one, 0 for no min-p filtering.
+
+    uniform_sample : Tensor
+        The float32 tensor of shape (batch, 1) of the uniform samples in [0, 1).
+
+    dtype : str
+        The data type of the output tensor.
+
+    name : str
+        Name hint.
+
+    Returns
+    -------
+    result : Tensor
+        The sampled token ids with shape (batch, 1).
+    """
+    from tvm.relax.backend.gpu_generic import (  # pylint: disable=import-outside-toplevel
+        gpu_fused_sampling_from_logits,
+    )
+
+    batch, vocab_size = logits.shape
+    _, sampled_token_ids = tensor_ir_op(
+        gpu_fused_sampling_from_logits(logits.dtype, dtype),
+        name,
+        args=[
+            logits,
+            penalty_token_ids,
+            penalty_token_freqs,
+            repetition_penalty,
+            presence_penalty,
+            frequency_penalty,
+            temperature,
+            top_p,
+            top_k,
+            min_p,
+            uniform_sample,
+        ],
+        out=[
+            Tensor.placeholder([batch, vocab_size], "float32"),
+            Tensor.placeholder([batch, 1], dtype),
+        ],
+    )
+    return sampled_token_ids
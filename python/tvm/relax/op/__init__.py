@@ -19,7 +19,20 @@
 """Relax core operators."""
 
 # Register operator gradient functions
-from . import _op_gradient, builtin, ccl, distributed, grad, image, memory, nn, op_attrs
+from . import (
+    _op_gradient,
+    builtin,
+    ccl,
+    distributed,
+    grad,
+    image,
+    lora,
+    memory,
+    moe,
+    nn,
+    op_attrs,
+    sparse,
+)
 
 # Operators
 from .base import (
@@ -89,7 +102,7 @@ from .create import (
 )
 from .datatype import astype, wrap_param
 from .index import dynamic_strided_slice, strided_slice, take
-from .linear_algebra import einsum, linear, matmul, outer
+from .linear_algebra import csr_matmul, einsum, linear, matmul, outer
 from .manipulate import (
     broadcast_to,
     collapse_sum_like,
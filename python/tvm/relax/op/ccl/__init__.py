@@ -17,4 +17,11 @@
 # under the License.
 """CCL related operators."""
 
-from .ccl import allgather, allreduce, broadcast_from_worker0, scatter_from_worker0
+from .ccl import (
+    allgather,
+    allreduce,
+    alltoall,
+    broadcast_from_worker0,
+    reducescatter,
+    scatter_from_worker0,
+)
@@ -70,6 +70,58 @@ def allgather(x, num_workers: int, in_group: bool = True):  # pylint: disable=in
     return _ffi_api.allgather(x, num_workers, in_group)  # type: ignore # pylint: disable=no-member
 
 
+def alltoall(x, num_workers: int, in_group: bool = True):  # pylint: disable=invalid-name
+    """AllToAll operator, which sends the i-th chunk along axis 0 of the input to the i-th worker,
+    and receives the i-th chunk of the output from the i-th worker.
+
+    Parameters
+    ----------
+    x : relax.Expr
+      The input tensor, whose axis 0 is divisible by the number of workers.
+
+    num_workers : int
+      The number of workers to exchange data with.
+
+    in_group : bool
+      Whether the exchange performs globally or in group as default.
+
+    Returns
+    -------
+    result : relax.Expr
+      The result of alltoall, with the same shape as the input.
+    """
+    return _ffi_api.alltoall(x, num_workers, in_group)  # type: ignore # pylint: disable=no-member
+
+
+def reducescatter(x, op_type: str = "sum", num_workers: int = 1, in_group: bool = True):
+    """ReduceScatter operator, which reduces the input over the workers and keeps the i-th chunk
+    along axis 0 of the result on the i-th worker.
+
+    Parameters
+    ----------
+    x : relax.Expr
+      The input tensor, whose axis 0 is divisible by the number of workers.
+
+    op_type : str
+      The type of reduction operation to be applied to the input data.
+      Now "sum", "prod", "min", "max" and "avg" are supported.
+
+    num_workers : int
+      The number of workers, also the number of chunks of the result.
+
+    in_group : bool
+      Whether the reduction operation performs globally or in group as default.
+
+    Returns
+    -------
+    result : relax.Expr
+      The chunk of the result kept by the worker.
+    """
+    return _ffi_api.reducescatter(  # type: ignore # pylint: disable=no-member
+        x, op_type, num_workers, in_group
+    )
+
+
 def broadcast_from_worker0(x: Expr) -> Expr:
     """Broadcast data from worker-0 to all other workers.
 
@@ -137,3 +137,32 @@ def outer(x1: Expr, x2: Expr) -> Expr:
         The resulting expression representing the outer product.
     """
     return _ffi_api.outer(x1, x2)
+
+
+def csr_matmul(data: Expr, indices: Expr, indptr: Expr, dense: Expr) -> Expr:
+    """Multiply a sparse matrix in CSR format with a dense matrix.
+
+    Row r of the sparse matrix holds the nonzeros ``data[indptr[r]:indptr[r + 1]]`` in the
+    columns ``indices[indptr[r]:indptr[r + 1]]``.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The 1-D nonzero values of the sparse matrix.
+
+    indices : relax.Expr
+        The 1-D integer column of each nonzero.
+
+    indptr : relax.Expr
+        The 1-D integer start position of each row in the nonzeros, followed by the number of
+        nonzeros, so of shape ``(num_rows + 1,)``.
+
+    dense : relax.Expr
+        The 2-D dense matrix of shape ``(num_cols, N)``.
+
+    Returns
+    -------
+    result : relax.Expr
+        The dense result of shape ``(num_rows, N)``.
+    """
+    return _ffi_api.csr_matmul(data, indices, indptr, dense)  # type: ignore
@@ -0,0 +1,57 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+"""Relax low-rank adaptation (LoRA) operators.
+
+A batch that mixes the requests of several LoRA adapters keeps the rows of each request
+contiguous. The rows of a request form a segment, and `sgmv` applies the low-rank weight of the
+adapter of each segment in one launch over all segments, in the style of the segmented
+gather matrix-vector multiplication (SGMV) of Punica. The delta of a LoRA layer is
+`sgmv(sgmv(x, A, ...), B, ...) * scaling`, with the shrink weight `A` of shape
+`(num_slots, rank, in_features)` and the expand weight `B` of shape
+`(num_slots, out_features, rank)`.
+"""
+
+from ...expr import Expr
+from . import _ffi_api
+
+
+def sgmv(data: Expr, weight: Expr, seg_indptr: Expr, weight_indices: Expr) -> Expr:
+    """Multiply the rows of each segment with the transposed weight of the adapter slot of the
+    segment.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The rows grouped by segment of shape `(num_rows, in_features)`.
+
+    weight : relax.Expr
+        The weights of the adapter slots of shape `(num_slots, out_features, in_features)`.
+
+    seg_indptr : relax.Expr
+        The offsets of the rows of each segment of shape `(num_segs + 1,)`. The rows beyond the
+        last offset are left unspecified.
+
+    weight_indices : relax.Expr
+        The weight slot of each segment of shape `(num_segs,)`. The rows of the segments with a
+        negative slot, which run the base model only, are zeros.
+
+    Returns
+    -------
+    result : relax.Expr
+        The output rows of shape `(num_rows, out_features)`.
+    """
+    return _ffi_api.sgmv(data, weight, seg_indptr, weight_indices)  # type: ignore
@@ -0,0 +1,127 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+"""Relax Mixture-of-Experts (MoE) operators.
+
+A MoE layer routes each token to `top_k` experts chosen by `topk_gating`, groups the rows of the
+tokens by expert with `permute`, applies the weights of all experts at once with
+`group_matmul`, and combines the expert outputs of each token with `unpermute`.
+"""
+
+from ...expr import Expr
+from . import _ffi_api
+
+
+def topk_gating(logits: Expr, top_k: int, normalize: bool = True) -> Expr:
+    """Select the top-k experts of each token from the softmax of the gating logits.
+
+    Parameters
+    ----------
+    logits : relax.Expr
+        The gating logits of shape `(num_tokens, num_experts)`.
+
+    top_k : int
+        The number of experts of each token.
+
+    normalize : bool
+        Whether the weights of the experts of each token are renormalized to sum to 1.
+
+    Returns
+    -------
+    result : relax.Expr
+        A tuple of the weights of shape `(num_tokens, top_k)` in the dtype of the logits, and the
+        int32 expert indices of shape `(num_tokens, top_k)`, in descending order of the weights.
+    """
+    return _ffi_api.topk_gating(logits, top_k, normalize)  # type: ignore
+
+
+def permute(data: Expr, expert_indices: Expr, num_experts: int, capacity: int = 0) -> Expr:
+    """Gather the rows of the tokens grouped by expert.
+
+    The rows of an expert keep the order of the tokens. With a positive capacity, the expert `e`
+    owns the rows `[e * capacity, (e + 1) * capacity)`, the rows beyond the capacity are dropped
+    and the unused rows are zeros, which gives the fixed layout exchanged in expert parallelism.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The rows of the tokens of shape `(num_tokens, hidden_size)`.
+
+    expert_indices : relax.Expr
+        The int32 experts of each token of shape `(num_tokens, top_k)`.
+
+    num_experts : int
+        The number of experts.
+
+    capacity : int
+        The number of rows of each expert, 0 for packing the rows of all tokens.
+
+    Returns
+    -------
+    result : relax.Expr
+        A tuple of the rows of shape `(num_rows, hidden_size)`, where `num_rows` is
+        `num_tokens * top_k`, or `num_experts * capacity` with a capacity, the int32 offsets of the
+        rows of each expert of shape `(num_experts + 1,)`, and the int32 row of each expert of each
+        token of shape `(num_tokens, top_k)`, -1 for the dropped ones.
+    """
+    return _ffi_api.permute(data, expert_indices, num_experts, capacity)  # type: ignore
+
+
+def group_matmul(data: Expr, weight: Expr, expert_indptr: Expr) -> Expr:
+    """Multiply the rows of each expert with the transposed weight of the expert, in one launch
+    over the variable-sized groups of rows.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The rows grouped by expert of shape `(num_rows, in_features)`.
+
+    weight : relax.Expr
+        The weights of the experts of shape `(num_experts, out_features, in_features)`.
+
+    expert_indptr : relax.Expr
+        The offsets of the rows of each expert of shape `(num_experts + 1,)`. The rows beyond the
+        last offset are left unspecified.
+
+    Returns
+    -------
+    result : relax.Expr
+        The output rows of shape `(num_rows, out_features)`.
+    """
+    return _ffi_api.group_matmul(data, weight, expert_indptr)  # type: ignore
+
+
+def unpermute(data: Expr, token_rows: Expr, weights: Expr) -> Expr:
+    """Sum the expert rows of each token with their weights.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The output rows grouped by expert of shape `(num_rows, hidden_size)`.
+
+    token_rows : relax.Expr
+        The int32 row of each expert of each token of shape `(num_tokens, top_k)` given by
+        `permute`, where the negative rows are skipped.
+
+    weights : relax.Expr
+        The weight of each expert of each token of shape `(num_tokens, top_k)`.
+
+    Returns
+    -------
+    result : relax.Expr
+        The outputs of the tokens of shape `(num_tokens, hidden_size)`.
+    """
+    return _ffi_api.unpermute(data, token_rows, weights)  # type: ignore
@@ -37,6 +37,7 @@ from .nn import (
     conv3d_transpose,
     cross_entropy_with_logits,
     dropout,
+    embedding_bag,
     gelu,
     gelu_tanh,
     group_norm,
@@ -2052,6 +2052,47 @@ def nll_loss(
     return _ffi_api.nll_loss(predictions, targets, weights, reduction, ignore_index)  # type: ignore
 
 
+def embedding_bag(
+    weight: Expr,
+    indices: Expr,
+    offsets: Expr,
+    per_sample_weights: Expr | None = None,
+    mode: str = "sum",
+) -> Expr:
+    """Pool the rows of an embedding table over ragged bags of indices.
+
+    Bag `b` holds the indices `indices[offsets[b]:offsets[b + 1]]`, the last bag running to the
+    end of the indices, and `output[b, :]` pools the rows `weight[indices[i], :]` of the bag,
+    each scaled by `per_sample_weights[i]` when given. Empty bags produce zeros.
+
+    Parameters
+    ----------
+    weight : relax.Expr
+      The embedding table of shape `(num_embeddings, embedding_dim)`.
+
+    indices : relax.Expr
+      The 1-D indices of all the bags, concatenated. Must be of int dtype.
+
+    offsets : relax.Expr
+      The 1-D start position of each bag in the indices, of shape `(num_bags,)`.
+      Must be of int dtype.
+
+    per_sample_weights : Optional[relax.Expr]
+      The 1-D weight of each index, with the shape of the indices. Only in "sum" mode.
+
+    mode : str
+      The pooling of a bag. Possible values are "sum", "mean" and "max".
+
+    Returns
+    -------
+    result : relax.Expr
+      The pooled bags of shape `(num_bags, embedding_dim)`.
+    """
+    return _ffi_api.embedding_bag(  # type: ignore
+        weight, indices, offsets, per_sample_weights, mode
+    )
+
+
 def attention(
     query: Expr,
     key: Expr,
@@ -346,6 +346,11 @@ class NLLLossAttrs(Attrs):
     """Attributes used in nll_loss operator"""
 
 
+@tvm_ffi.register_object("relax.attrs.EmbeddingBagAttrs")
+class EmbeddingBagAttrs(Attrs):
+    """Attributes used in embedding_bag operator"""
+
+
 @tvm_ffi.register_object("relax.attrs.AllReduceAttrs")
 class AllReduceAttrs(Attrs):
     """Attributes used in allreduce operator"""
@@ -0,0 +1,74 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+"""Relax 2:4 structured-sparse operators.
+
+A 2:4 sparse weight has at most two nonzeros in each group of four consecutive elements along
+its reduction axis, which the sparse tensor cores of Ampere and later GPUs multiply at twice
+the dense throughput. `compress_2_4` stores the two kept values of each group, and their 2-bit
+positions within the group in the metadata layout of the `mma.sp` m16n8k16 instruction:
+word `g` of tile `(i, j)` holds the positions of the 8 kept values in columns `16 * j` to
+`16 * j + 15` of row `16 * i + g` in its lower half, and of row `16 * i + g + 8` in its upper
+half. `matmul_2_4` multiplies with the compressed weight.
+"""
+
+from ...expr import Expr
+from . import _ffi_api
+
+
+def compress_2_4(weight: Expr) -> Expr:
+    """Compress a 2:4 sparse weight.
+
+    The two kept values of a group are its first two nonzeros. A group with fewer nonzeros
+    keeps zeros next to them, and a group with more nonzeros, which is not 2:4 sparse, drops
+    the ones after the first two.
+
+    Parameters
+    ----------
+    weight : relax.Expr
+        The weight of shape `(out_features, in_features)`, both multiples of 16.
+
+    Returns
+    -------
+    result : relax.Expr
+        The tuple of the kept values of shape `(out_features, in_features / 2)`, and of the
+        uint32 metadata of shape `(out_features / 16, in_features / 16, 8)`.
+    """
+    return _ffi_api.compress_2_4(weight)  # type: ignore
+
+
+def matmul_2_4(data: Expr, values: Expr, metadata: Expr) -> Expr:
+    """Multiply the data with the transposed 2:4 sparse weight, as `matmul(data, weight.T)`.
+
+    Parameters
+    ----------
+    data : relax.Expr
+        The input of shape `(..., in_features)`.
+
+    values : relax.Expr
+        The kept values of the weight of shape `(out_features, in_features / 2)`, as given by
+        `compress_2_4`.
+
+    metadata : relax.Expr
+        The metadata of the weight of shape `(out_features / 16, in_features / 16, 8)`, as
+        given by `compress_2_4`.
+
+    Returns
+    -------
+    result : relax.Expr
+        The output of shape `(..., out_features)`.
+    """
+    return _ffi_api.matmul_2_4(data, values, metadata)  # type: ignore
@@ -85,6 +85,9 @@ def default_build_pipeline():
         seq = tvm.transform.Sequential(
             [
                 backend.DispatchSampling(),
+                backend.DispatchMoE(),
+                backend.DispatchLoRA(),
+                backend.DispatchSparse(),
                 backend.DispatchSortScan(),
                 transform.LegalizeOps(),
                 transform.RewriteDataflowReshape(),
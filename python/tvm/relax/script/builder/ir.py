@@ -78,6 +78,7 @@ from tvm.relax.op import (
     concat,
     cos,
     cosh,
+    csr_matmul,
     cumprod,
     cumsum,
     dequantize,
@@ -124,6 +125,7 @@ from tvm.relax.op import (
     logical_not,
     logical_or,
     logical_xor,
+    lora,
     make_closure,
     matmul,
     max,
@@ -135,6 +137,7 @@ from tvm.relax.op import (
     min,
     minimum,
     mod,
+    moe,
     multinomial_from_uniform,
     multiply,
     negative,
@@ -168,6 +171,7 @@ from tvm.relax.op import (
     size,
     slice_scatter,
     sort,
+    sparse,
     split,
     sqrt,
     square,
@@ -847,6 +851,7 @@ __all__ = [
     "cos",
     "cosh",
     "cpu",
+    "csr_matmul",
     "cuda",
     "cumprod",
     "cumsum",
@@ -911,6 +916,7 @@ __all__ = [
     "logical_not",
     "logical_or",
     "logical_xor",
+    "lora",
     "make_closure",
     "matmul",
     "max",
@@ -923,6 +929,7 @@ __all__ = [
     "min",
     "minimum",
     "mod",
+    "moe",
     "multinomial_from_uniform",
     "multiply",
     "negative",
@@ -962,6 +969,7 @@ __all__ = [
     "size",
     "slice_scatter",
     "sort",
+    "sparse",
     "split",
     "sqrt",
     "square",
@@ -28,7 +28,7 @@ import tvm
 from ..block_builder import BlockBuilder
 from ..expr import Function, TupleGetItem, Var, const
 from ..expr import Tuple as RxTuple
-from ..op import add, divide, multiply, sqrt, subtract
+from ..op import add, concat, divide, multiply, reshape, split, sqrt, subtract
 from ..type import TensorType, TupleType
 
 
@@ -42,6 +42,15 @@ class Optimizer:
     name : str
         The name of the optimizer function. This parameter is provided by subclasses.
 
+    fused : bool
+        Whether to update all parameters at once in one contiguous buffer (default: False).
+
+        The optimizer function of a fused optimizer flattens the parameters and the gradients
+        into one buffer each, and keeps each kind of per-parameter state, such as the momentum,
+        as one flat buffer. The update is then a single chain of elementwise ops for all
+        parameters, which FuseOps turns into one kernel instead of a few kernels per parameter.
+        The arguments and the results of the function stay tuples of parameters.
+
     Attributes
     ----------
     dtype : str
@@ -106,8 +115,9 @@ class Optimizer:
     param_list: list[Var]
     state: tvm_ffi.Array
 
-    def __init__(self, name: str) -> None:
+    def __init__(self, name: str, fused: bool = False) -> None:
         self.name = name
+        self.fused = fused
         self.param_list = None
         self.state = None
         self.dtype = None
@@ -177,6 +187,62 @@ class Optimizer:
         if self.param_list is None or self.state is None or self.dtype is None:
             raise RuntimeError("Please call init() for the optimizer before calling get_function()")
 
+    def _slot_types(self) -> list[TensorType]:
+        """The types of the buffers the update runs on. A per-parameter state has one tensor of
+        each of these types.
+        """
+        if not self.fused:
+            return [p.ty for p in self.param_list]
+        numel = sum(int(np.prod(_get_shape_as_int_list(p))) for p in self.param_list)
+        return [TensorType((numel,), self.dtype)]
+
+    def _zero_slot_states(self) -> list[tvm.runtime.Tensor]:
+        """The initial value of a per-parameter state, such as the momentum."""
+        return [
+            tvm.runtime.tensor(np.zeros(_get_shape_as_int_list(ty), ty.dtype.dtype))
+            for ty in self._slot_types()
+        ]
+
+    def _emit_slots(self, builder: BlockBuilder, param_var: Var, grad_var: Var):
+        """Emit the parameter and the gradient of each slot the update runs on, and yield them
+        as (name, param, grad).
+
+        The bindings of a slot are emitted when the slot is reached, so that they interleave
+        with the updates. A fused optimizer has one slot, which holds the concatenation of all
+        flattened parameters.
+        """
+        if not self.fused:
+            for i, p in enumerate(self.param_list):
+                param = builder.emit(TupleGetItem(param_var, i), p.name)
+                grad = builder.emit(TupleGetItem(grad_var, i), p.name + "_grad")
+                yield p.name, param, grad
+            return
+
+        numels = [int(np.prod(_get_shape_as_int_list(p))) for p in self.param_list]
+
+        def flatten(tuple_var: Var):
+            parts = [reshape(TupleGetItem(tuple_var, i), (n,)) for i, n in enumerate(numels)]
+            return concat(parts, axis=0)
+
+        param = builder.emit(flatten(param_var), "flat")
+        grad = builder.emit(flatten(grad_var), "flat_grad")
+        yield "flat", param, grad
+
+    def _emit_unflatten(self, builder: BlockBuilder, slots_new: list[Var]) -> list[Var]:
+        """Emit the updated parameters from the updated slots."""
+        if not self.fused:
+            return slots_new
+        shapes = [_get_shape_as_int_list(p) for p in self.param_list]
+        if len(shapes) == 1:
+            name = self.param_list[0].name + "_new"
+            return [builder.emit(reshape(slots_new[0], shapes[0]), name)]
+        offsets = np.cumsum([int(np.prod(shape)) for shape in shapes])[:-1]
+        parts = builder.emit(split(slots_new[0], [int(i) for i in offsets], axis=0), "flat_split")
+        return [
+            builder.emit(reshape(TupleGetItem(parts, i), shape), p.name + "_new")
+            for i, (p, shape) in enumerate(zip(self.param_list, shapes))
+        ]
+
     def get_function(self) -> Function:
         """Use blockbuilder to construct an optimizer function that executes updates of the
         parameters and the optimizer state.
@@ -230,8 +296,9 @@ class Optimizer:
 
 
 # TODO(chaofan, yixin): Support symbolic shapes
-def _get_shape_as_int_list(var: Var) -> list[int]:
-    return [int(val) for val in var.ty.shape]
+def _get_shape_as_int_list(var: Var | TensorType) -> list[int]:
+    ty = var if isinstance(var, TensorType) else var.ty
+    return [int(val) for val in ty.shape]
 
 
 # We need to subtract on hyperparameters, but do not want to introduce floating point error.
@@ -265,10 +332,13 @@ class SGD(Optimizer):
 
     weight_decay : float
         weight decay (L2 penalty) (default: 0)
+
+    fused : bool
+        update all parameters in one contiguous buffer, see `Optimizer` (default: False)
     """
 
-    def __init__(self, lr: float, weight_decay: float = 0) -> None:
-        super().__init__("SGD")
+    def __init__(self, lr: float, weight_decay: float = 0, fused: bool = False) -> None:
+        super().__init__("SGD", fused)
         self.lr = float(lr)
         self.weight_decay = float(weight_decay)
 
@@ -313,7 +383,6 @@ class SGD(Optimizer):
         self._check_init()
 
         plist = self.param_list
-        len_param = len(plist)
         dtype = self.dtype
 
         # input variables
@@ -337,16 +406,14 @@ class SGD(Optimizer):
                 state_list_new.append(num_steps_new)
 
                 # computation logics
-                for i in range(len_param):
-                    name = self.param_list[i].name
-                    p = builder.emit(TupleGetItem(param_var, i), name)
-                    g = builder.emit(TupleGetItem(grad_var, i), name + "_grad")
+                for name, p, g in self._emit_slots(builder, param_var, grad_var):
                     if self.weight_decay:
                         g = builder.emit(add(multiply(weight_decay, p), g), name + "_grad_new")
                     p_new = builder.emit(subtract(p, multiply(lr, g)), name + "_new")
                     param_list_new.append(p_new)
 
                 # handle return values
+                param_list_new = self._emit_unflatten(builder, param_list_new)
                 params_new = builder.emit_output(RxTuple(param_list_new), "params_new")
                 optim_states_new = builder.emit_output(RxTuple(state_list_new), "optim_states_new")
             builder.emit_func_output((params_new, optim_states_new))
@@ -397,6 +464,9 @@ class MomentumSGD(Optimizer):
 
     nesterov : bool
         enables Nesterov momentum (default: False)
+
+    fused : bool
+        update all parameters in one contiguous buffer, see `Optimizer` (default: False)
     """
 
     def __init__(
@@ -406,8 +476,9 @@ class MomentumSGD(Optimizer):
         dampening: float = 0,
         weight_decay: float = 0,
         nesterov: bool = False,
+        fused: bool = False,
     ) -> None:
-        super().__init__("MomentumSGD")
+        super().__init__("MomentumSGD", fused)
         self.lr = float(lr)
         self.momentum = float(momentum)
         self.weight_decay = float(weight_decay)
@@ -419,7 +490,8 @@ class MomentumSGD(Optimizer):
         optimizer.
 
         The state of MomentumSGD is
-        `(num_steps, velocity_of_param_0, ..., velocity_of_param_n-1)`.
+        `(num_steps, velocity_of_param_0, ..., velocity_of_param_n-1)`, or
+        `(num_steps, velocity_of_all_params)` if fused, where the velocity is flat.
 
         Parameters
         ----------
@@ -442,10 +514,7 @@ class MomentumSGD(Optimizer):
             # num_steps = 0
             tvm.runtime.tensor(np.zeros((), "int64")),
             # v_{param} is initialized to all zeros
-            *(
-                tvm.runtime.tensor(np.zeros(_get_shape_as_int_list(p), p.ty.dtype.dtype))
-                for p in self.param_list
-            ),
+            *self._zero_slot_states(),
         )
         return self
 
@@ -460,7 +529,6 @@ class MomentumSGD(Optimizer):
         """
         self._check_init()
         plist = self.param_list
-        len_param = len(plist)
         dtype = self.dtype
 
         # input variables
@@ -468,7 +536,7 @@ class MomentumSGD(Optimizer):
         grad_var = Var("gradients", TupleType([p.ty for p in plist]))
         state_var = Var(
             "optim_states",
-            TupleType([TensorType((), "int64"), *(p.ty for p in plist)]),
+            TupleType([TensorType((), "int64"), *self._slot_types()]),
         )
 
         # constants
@@ -489,10 +557,7 @@ class MomentumSGD(Optimizer):
                 state_list_new.append(num_steps_new)
 
                 # computation logics
-                for i in range(len_param):
-                    name = self.param_list[i].name
-                    p = builder.emit(TupleGetItem(param_var, i), name)
-                    g = builder.emit(TupleGetItem(grad_var, i), name + "_grad")
+                for i, (name, p, g) in enumerate(self._emit_slots(builder, param_var, grad_var)):
                     v = builder.emit(TupleGetItem(state_var, i + 1), name + "_v")
                     if self.weight_decay:
                         g = builder.emit(add(multiply(weight_decay, p), g), name + "_grad_new")
@@ -508,6 +573,7 @@ class MomentumSGD(Optimizer):
                     state_list_new.append(v_new)
 
                 # handle return values
+                param_list_new = self._emit_unflatten(builder, param_list_new)
                 params_new = builder.emit_output(RxTuple(param_list_new), "params_new")
                 optim_states_new = builder.emit_output(RxTuple(state_list_new), "optim_states_new")
             builder.emit_func_output((params_new, optim_states_new))
@@ -562,6 +628,9 @@ class Adam(Optimizer):
 
     weight_decay : float
         weight decay (L2 penalty) (default: 0)
+
+    fused : bool
+        update all parameters in one contiguous buffer, see `Optimizer` (default: False)
     """
 
     def __init__(
@@ -570,8 +639,9 @@ class Adam(Optimizer):
         betas: tuple[float, float] = (0.9, 0.999),
         eps: float = 1e-08,
         weight_decay: float = 0,
+        fused: bool = False,
     ) -> None:
-        super().__init__("Adam")
+        super().__init__("Adam", fused)
         self.lr = float(lr)
         self.beta1 = float(betas[0])
         self.beta2 = float(betas[1])
@@ -594,6 +664,9 @@ class Adam(Optimizer):
                 second_momentum_of_param_0, ..., second_momentum_of_param_n-1
             )
 
+        If fused, the optimizer has one flat first momentum and one flat second momentum for
+        all parameters.
+
         Parameters
         ----------
         params : Union[Var, List[Var]]
@@ -617,15 +690,9 @@ class Adam(Optimizer):
             tvm.runtime.tensor(np.ones((), self.dtype)),
             tvm.runtime.tensor(np.ones((), self.dtype)),
             # first_momentum
-            *(
-                tvm.runtime.tensor(np.zeros(_get_shape_as_int_list(p), p.ty.dtype.dtype))
-                for p in self.param_list
-            ),
+            *self._zero_slot_states(),
             # second_momentum
-            *(
-                tvm.runtime.tensor(np.zeros(_get_shape_as_int_list(p), p.ty.dtype.dtype))
-                for p in self.param_list
-            ),
+            *self._zero_slot_states(),
         )
         return self
 
@@ -640,7 +707,8 @@ class Adam(Optimizer):
         """
         self._check_init()
         plist = self.param_list
-        len_param = len(plist)
+        slot_types = self._slot_types()
+        len_slot = len(slot_types)
         dtype = self.dtype
 
         # input variables
@@ -653,8 +721,8 @@ class Adam(Optimizer):
                     TensorType((), "int64"),
                     TensorType((), dtype),
                     TensorType((), dtype),
-                    *(p.ty for p in plist),
-                    *(p.ty for p in plist),
+                    *slot_types,
+                    *slot_types,
                 ]
             ),
         )
@@ -674,7 +742,7 @@ class Adam(Optimizer):
         with builder.function(self.name, [param_var, grad_var, state_var]):
             with builder.dataflow():
                 param_list_new = []
-                state_list_new = [None] * (len_param * 2 + 3)  # type: List[Optional[Var]]
+                state_list_new = [None] * (len_slot * 2 + 3)  # type: List[Optional[Var]]
 
                 # handle num_steps
                 num_steps = builder.emit(TupleGetItem(state_var, 0), "num_steps")
@@ -686,12 +754,9 @@ class Adam(Optimizer):
                 state_list_new[2] = beta2_prod
 
                 # computation logics
-                for i in range(len_param):
-                    name = self.param_list[i].name
-                    p = builder.emit(TupleGetItem(param_var, i), name)
-                    g = builder.emit(TupleGetItem(grad_var, i), name + "_grad")
+                for i, (name, p, g) in enumerate(self._emit_slots(builder, param_var, grad_var)):
                     m = builder.emit(TupleGetItem(state_var, i + 3), name + "_m")
-                    v = builder.emit(TupleGetItem(state_var, i + 3 + len_param), name + "_v")
+                    v = builder.emit(TupleGetItem(state_var, i + 3 + len_slot), name + "_v")
                     if self.weight_decay:
                         g = builder.emit(add(multiply(weight_decay, p), g), name + "_grad_new")
                     m_new = builder.emit(
@@ -713,9 +778,10 @@ class Adam(Optimizer):
                     )
                     param_list_new.append(p_new)
                     state_list_new[i + 3] = m_new
-                    state_list_new[i + 3 + len_param] = v_new
+                    state_list_new[i + 3 + len_slot] = v_new
 
                 # handle return values
+                param_list_new = self._emit_unflatten(builder, param_list_new)
                 params_new = builder.emit_output(RxTuple(param_list_new), "params_new")
                 optim_states_new = builder.emit_output(RxTuple(state_list_new), "optim_states_new")
             builder.emit_func_output((params_new, optim_states_new))
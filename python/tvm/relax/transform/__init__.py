@@ -22,6 +22,7 @@ from .transform import (
     AllocateWorkspace,
     AlterOpImpl,
     AnnotateTIROpPattern,
+    AssignDeviceStreams,
     AttachAttrLayoutFreeBuffers,
     AttachGlobalSymbol,
     BindParams,
@@ -41,6 +42,7 @@ from .transform import (
     EliminateCommonSubexpr,
     ExpandMatmulOfSum,
     ExpandTupleArguments,
+    FakeQuantizationToInteger,
     FoldConstant,
     FunctionPass,
     FuseOps,
@@ -48,6 +50,7 @@ from .transform import (
     FuseTIR,
     FusionPattern,
     Gradient,
+    HorizontalFuseTIR,
     InlinePrivateFunctions,
     KillAfterLastUse,
     LambdaLift,
@@ -65,6 +68,7 @@ from .transform import (
     NormalizeGlobalVar,
     PatternCheckContext,
     RealizeVDevice,
+    Rematerialize,
     RemovePurityChecking,
     RemoveUnusedOutputs,
     RemoveUnusedParameters,
@@ -89,8 +93,10 @@ from .transform import (
 )
 
 from .attach_external_modules import AttachExternModules
+from .compress_sparse_weights import CompressSparseWeights
 from .fast_math import FastMathTransform
 from .fuse_transpose_matmul import FuseTransposeMatmul
+from .group_quantize_weights import GroupQuantizeWeights
 from .ipc_allreduce_rewrite import IPCAllReduceRewrite
 from .lazy_transform_params import LazyTransformParams
 from .lower_gpu_ipc_alloc_storage import LowerGPUIPCAllocStorage
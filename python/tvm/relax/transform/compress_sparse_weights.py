@@ -0,0 +1,129 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""A compiler pass that compresses 2:4 sparse matmul weights.
+
+A weight is annotated as 2:4 sparse, with at most two nonzeros in each group of four
+consecutive elements along its reduction axis, by listing the name of its parameter in
+``func.attrs["sparse_2_4_params"]``. Each matmul on such a weight is rewritten into
+``R.sparse.matmul_2_4`` on the output of ``R.sparse.compress_2_4``, which ``DispatchSparse``
+lowers onto the sparse tensor cores of CUDA (``mma.sp``) for float16 on sm_80 and later, and
+onto generic kernels that read the compressed weight otherwise.
+
+Note that
+1. The pass should run before LegalizeOps, while matmul can still be identified.
+2. The compression of a weight is emitted on its parameter, which ``LiftTransformParams`` moves
+   into the parameter transformation, so that the inference function only reads the compressed
+   weight. The weights should thus be parameters after the first ``func.attrs["num_input"]``.
+3. Both ``matmul(x, w)`` and ``matmul(x, permute_dims(w))`` (as emitted by ``R.linear``) are
+   handled. Weights must be 2-D with static extents divisible by 16, and the matmul must keep
+   the dtype of its input.
+"""
+
+from typing import Dict, Optional, Set, Tuple
+
+import tvm
+from tvm import IRModule, relax, tirx
+from tvm.relax.expr_functor import PyExprMutator, mutator
+
+
+@tvm.transform.module_pass(opt_level=0, name="CompressSparseWeights")
+class CompressSparseWeights:  # pylint: disable=too-few-public-methods
+    """Compress the matmul weights annotated as 2:4 sparse, and use sparse matmuls on them."""
+
+    def transform_module(self, mod: IRModule, _ctx: tvm.transform.PassContext) -> IRModule:
+        """IRModule-level transformation"""
+        compressor = _WeightCompressor(mod)
+        for g_var, func in mod.functions_items():
+            if isinstance(func, relax.Function):
+                if func.attrs is None or "sparse_2_4_params" not in func.attrs:
+                    continue
+                names = {str(name) for name in func.attrs["sparse_2_4_params"]}
+                compressor.weight_params = {
+                    param for param in func.params if param.name_hint in names
+                }
+                func = compressor.visit_expr(func)
+                compressor.builder_.update_func(g_var, relax.analysis.remove_all_unused(func))
+        return compressor.builder_.get()
+
+
+# pylint: disable=missing-docstring,invalid-name
+
+
+@mutator
+class _WeightCompressor(PyExprMutator):  # pylint: disable=abstract-method
+    def __init__(self, mod: IRModule):
+        super().__init__(mod)
+        self.weight_params: Set[relax.Var] = set()
+        self._compressed: Dict[Tuple[relax.Var, bool], Tuple[relax.Var, relax.Var]] = {}
+
+    def visit_binding_block_(self, block: relax.BindingBlock) -> relax.BindingBlock:
+        self._compressed = {}
+        return super().visit_binding_block_(block)
+
+    def visit_dataflow_block_(self, block: relax.DataflowBlock) -> relax.BindingBlock:
+        self._compressed = {}
+        return super().visit_dataflow_block_(block)
+
+    def _get_weight(self, expr: relax.Expr) -> Optional[Tuple[relax.Var, bool]]:
+        """The weight and whether it is laid out [K, N], if `expr` is a compressible operand."""
+        transpose = True
+        if isinstance(expr, relax.Var) and expr not in self.weight_params:
+            value = self.lookup_binding(expr)
+            if (
+                isinstance(value, relax.Call)
+                and value.op == tvm.ir.Op.get("relax.permute_dims")
+                and value.args[0].ty.ndim == 2
+                and (value.attrs.axes is None or list(value.attrs.axes) == [1, 0])
+            ):
+                expr = value.args[0]
+                transpose = False
+        if expr not in self.weight_params:
+            return None
+        ty = expr.ty
+        if not isinstance(ty, relax.TensorType) or ty.ndim != 2 or ty.shape is None:
+            return None
+        if str(ty.dtype.dtype) not in ("float16", "bfloat16", "float32"):
+            return None
+        for extent in (ty.shape[0], ty.shape[1]):
+            if not isinstance(extent, tirx.IntImm) or int(extent) % 16:
+                return None
+        return expr, transpose
+
+    def visit_call_(  # pylint: disable=arguments-renamed
+        self,
+        call: relax.Call,
+    ) -> relax.Expr:
+        if call.op != tvm.ir.Op.get("relax.matmul") or call.args[0].ty.ndim < 1:
+            return super().visit_call_(call)
+        weight = self._get_weight(call.args[1])
+        dtypes = {str(expr.ty.dtype.dtype) for expr in (call, call.args[0], call.args[1])}
+        if weight is None or len(dtypes) != 1:
+            return super().visit_call_(call)
+        if weight not in self._compressed:
+            # The compressed weight is laid out [N, K], with the reduction axis last.
+            dense = weight[0]
+            if weight[1]:
+                dense = self.builder_.emit(relax.op.permute_dims(dense, [1, 0]))
+            compressed = self.builder_.emit(
+                relax.op.sparse.compress_2_4(dense), name_hint="compressed_weight"
+            )
+            self._compressed[weight] = (
+                self.builder_.emit(relax.TupleGetItem(compressed, 0)),
+                self.builder_.emit(relax.TupleGetItem(compressed, 1)),
+            )
+        return relax.op.sparse.matmul_2_4(self.visit_expr(call.args[0]), *self._compressed[weight])
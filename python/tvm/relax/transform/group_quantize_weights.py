@@ -0,0 +1,274 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""A compiler pass that quantizes matmul weights to grouped int4/int8.
+
+Each weight is stored as unsigned integers packed into ``uint32`` words, with one scale (and,
+for asymmetric quantization, one zero point) per ``group_size`` consecutive elements along the
+reduction axis. The matmul is rewritten into a single ``call_tir`` whose PrimFunc decodes the
+packed weight in one block and multiplies in the next; the GEMV and matmul rules of DLight, as
+well as ``AutoInline`` in MetaSchedule, inline the decode block so that the kernel reads the
+packed weight directly. Memory-bound decode GEMVs read 4x (int4) or 2x (int8) fewer weight bytes
+than with float16 weights.
+
+Note that
+1. The pass should run before LegalizeOps, while matmul can still be identified.
+2. Weights must be constants, or parameters after the first ``func.attrs["num_input"]``. The
+   encoding of a parameter is emitted as a ``call_tir`` on it, which ``LiftTransformParams``
+   moves into the parameter transformation; the encoding of a constant is folded by
+   ``FoldConstant``.
+3. Both ``matmul(x, w)`` and ``matmul(x, permute_dims(w))`` (as emitted by ``R.linear``) are
+   handled. Weights must be 2-D with a static reduction extent divisible by ``group_size``.
+"""
+
+from typing import Dict, List, Optional, Set, Tuple
+
+import tvm
+from tvm import IRModule, relax, te, tirx
+from tvm.relax.expr_functor import PyExprMutator, mutator
+
+
+@tvm.transform.module_pass(opt_level=0, name="GroupQuantizeWeights")
+class GroupQuantizeWeights:  # pylint: disable=too-few-public-methods
+    """Quantize matmul weights to grouped int4/int8 and fuse their dequantization.
+
+    Parameters
+    ----------
+    bits : int
+        The number of bits of each quantized element, 4 or 8.
+    group_size : int
+        The number of consecutive elements along the reduction axis sharing one scale. Must be
+        a multiple of the number of elements packed into one ``uint32``.
+    symmetric : bool
+        Whether to quantize symmetrically around zero with an implicit zero point. Otherwise
+        each group stores a zero point as well, and uses the full unsigned range between the
+        group minimum and maximum.
+    """
+
+    def __init__(self, bits: int = 4, group_size: int = 32, symmetric: bool = True):
+        if bits not in (4, 8):
+            raise ValueError(f"GroupQuantizeWeights supports 4 and 8 bits, but got {bits}")
+        if group_size <= 0 or group_size % (32 // bits) != 0:
+            raise ValueError(
+                f"group_size must be a positive multiple of {32 // bits} for {bits}-bit "
+                f"quantization, but got {group_size}"
+            )
+        self.bits = bits
+        self.group_size = group_size
+        self.symmetric = symmetric
+
+    def transform_module(self, mod: IRModule, _ctx: tvm.transform.PassContext) -> IRModule:
+        """IRModule-level transformation"""
+        quantizer = _WeightQuantizer(mod, self.bits, self.group_size, self.symmetric)
+        for g_var, func in mod.functions_items():
+            if isinstance(func, relax.Function):
+                quantizer.weight_params = set()
+                if func.attrs is not None and "num_input" in func.attrs:
+                    quantizer.weight_params = set(list(func.params)[int(func.attrs["num_input"]) :])
+                func = quantizer.visit_expr(func)
+                quantizer.builder_.update_func(g_var, relax.analysis.remove_all_unused(func))
+        return quantizer.builder_.get()
+
+
+# pylint: disable=missing-docstring,invalid-name
+
+
+def _encode(weight: te.Tensor, bits: int, group_size: int, symmetric: bool, transpose: bool):
+    """The packed weight, scales and zero points of an [N, K] weight ([K, N] if transposed)."""
+    N, K = (weight.shape[1], weight.shape[0]) if transpose else weight.shape
+    num_groups = K // group_size
+    per_word = 32 // bits
+    max_q = (1 << bits) - 1
+
+    def w(n, k):
+        value = weight[k, n] if transpose else weight[n, k]
+        return value.astype("float32")
+
+    r = te.reduce_axis((0, group_size), name="r")
+    if symmetric:
+        max_abs = te.compute(
+            (N, num_groups),
+            lambda n, g: te.max(te.abs(w(n, g * group_size + r)), axis=r),
+            name="max_abs",
+        )
+        # q = round(w / scale) + zero lies in [0, 2 * zero], centered on the zero point.
+        zero_point = float(max_q // 2)
+        scale = te.compute(
+            (N, num_groups),
+            lambda n, g: te.max(max_abs[n, g], tirx.const(1e-6, "float32")) / zero_point,
+            name="scale",
+        )
+        zeros = None
+    else:
+        r_min = te.reduce_axis((0, group_size), name="r_min")
+        min_value = te.compute(
+            (N, num_groups),
+            lambda n, g: te.min(w(n, g * group_size + r_min), axis=r_min),
+            name="min_value",
+        )
+        max_value = te.compute(
+            (N, num_groups),
+            lambda n, g: te.max(w(n, g * group_size + r), axis=r),
+            name="max_value",
+        )
+        scale = te.compute(
+            (N, num_groups),
+            lambda n, g: te.max(max_value[n, g] - min_value[n, g], tirx.const(1e-6, "float32"))
+            / float(max_q),
+            name="scale",
+        )
+        zeros = te.compute(
+            (N, num_groups),
+            lambda n, g: te.min(
+                te.max(te.round(-min_value[n, g] / scale[n, g]), tirx.const(0, "float32")),
+                tirx.const(max_q, "float32"),
+            ),
+            name="zeros",
+        )
+
+    def quantized(n, k):
+        g = k // group_size
+        zero = tirx.const(zero_point, "float32") if zeros is None else zeros[n, g]
+        value = te.round(w(n, k) / scale[n, g]) + zero
+        value = te.min(te.max(value, tirx.const(0, "float32")), tirx.const(max_q, "float32"))
+        return value.astype("uint32")
+
+    e = te.reduce_axis((0, per_word), name="e")
+    packed = te.compute(
+        (N, K // per_word),
+        lambda n, j: te.sum(
+            quantized(n, j * per_word + e) << (e.var.astype("uint32") * bits), axis=e
+        ),
+        name="packed",
+    )
+    dtype = weight.dtype
+    scale_out = te.compute((N, num_groups), lambda n, g: scale[n, g].astype(dtype), name="scales")
+    if zeros is None:
+        return [packed, scale_out]
+    zeros_out = te.compute(
+        (N, num_groups), lambda n, g: zeros[n, g].astype(dtype), name="zero_points"
+    )
+    return [packed, scale_out, zeros_out]
+
+
+def _decode_matmul(x: te.Tensor, packed: te.Tensor, scales: te.Tensor, *zeros, **kwargs):
+    """The matmul of x [..., K] and the decoded weight [N, K], as two TIR blocks."""
+    bits, group_size, out_dtype = kwargs["bits"], kwargs["group_size"], kwargs["out_dtype"]
+    per_word = 32 // bits
+    N = packed.shape[0]
+    K = x.shape[-1]
+    dtype = scales.dtype
+    mask = tirx.const((1 << bits) - 1, "uint32")
+    zero_point = tirx.const((1 << bits) // 2 - 1, dtype)
+
+    def decode_compute(n, k):
+        word = packed[n, k // per_word]
+        shift = (k % per_word).astype("uint32") * tirx.const(bits, "uint32")
+        value = ((word >> shift) & mask).astype(dtype)
+        zero = zeros[0][n, k // group_size] if zeros else zero_point
+        return (value - zero) * scales[n, k // group_size]
+
+    decode = te.compute((N, K), decode_compute, name="decode")
+    k = te.reduce_axis((0, K), name="k")
+    out_shape = list(x.shape[:-1]) + [N]
+
+    def matmul_compute(*idx):
+        return te.sum(
+            x(*idx[:-1], k).astype(out_dtype) * decode[idx[-1], k].astype(out_dtype), axis=k
+        )
+
+    return te.compute(out_shape, matmul_compute, name="matmul")
+
+
+@mutator
+class _WeightQuantizer(PyExprMutator):  # pylint: disable=abstract-method
+    def __init__(self, mod: IRModule, bits: int, group_size: int, symmetric: bool):
+        super().__init__(mod)
+        self.bits = bits
+        self.group_size = group_size
+        self.symmetric = symmetric
+        self.weight_params: Set[relax.Var] = set()
+        self._encoded: Dict[Tuple[relax.Expr, bool], List[relax.Var]] = {}
+
+    def visit_binding_block_(self, block: relax.BindingBlock) -> relax.BindingBlock:
+        self._encoded = {}
+        return super().visit_binding_block_(block)
+
+    def visit_dataflow_block_(self, block: relax.DataflowBlock) -> relax.BindingBlock:
+        self._encoded = {}
+        return super().visit_dataflow_block_(block)
+
+    def _get_weight(self, expr: relax.Expr) -> Optional[Tuple[relax.Expr, bool]]:
+        """The weight and whether it is laid out [K, N], if `expr` is a quantizable operand."""
+        transpose = True
+        if isinstance(expr, relax.Var) and expr not in self.weight_params:
+            value = self.lookup_binding(expr)
+            if (
+                isinstance(value, relax.Call)
+                and value.op == tvm.ir.Op.get("relax.permute_dims")
+                and value.args[0].ty.ndim == 2
+                and (value.attrs.axes is None or list(value.attrs.axes) == [1, 0])
+            ):
+                expr = value.args[0]
+                transpose = False
+        if not isinstance(expr, relax.Constant) and expr not in self.weight_params:
+            return None
+        ty = expr.ty
+        if not isinstance(ty, relax.TensorType) or ty.ndim != 2 or ty.shape is None:
+            return None
+        if str(ty.dtype.dtype) not in ("float16", "bfloat16", "float32"):
+            return None
+        reduce_extent = ty.shape[1] if not transpose else ty.shape[0]
+        if not isinstance(reduce_extent, tirx.IntImm) or int(reduce_extent) % self.group_size:
+            return None
+        return expr, transpose
+
+    def visit_call_(  # pylint: disable=arguments-renamed
+        self,
+        call: relax.Call,
+    ) -> relax.Expr:
+        if call.op != tvm.ir.Op.get("relax.matmul") or call.args[0].ty.ndim < 1:
+            return super().visit_call_(call)
+        weight = self._get_weight(call.args[1])
+        if weight is None:
+            return super().visit_call_(call)
+        if weight not in self._encoded:
+            encoded = self.builder_.emit(
+                self.builder_.call_te(
+                    _encode,
+                    weight[0],
+                    bits=self.bits,
+                    group_size=self.group_size,
+                    symmetric=self.symmetric,
+                    transpose=weight[1],
+                    primfunc_name_hint=f"encode_int{self.bits}",
+                ),
+                name_hint="encoded_weight",
+            )
+            self._encoded[weight] = [
+                self.builder_.emit(relax.TupleGetItem(encoded, i))
+                for i in range(2 if self.symmetric else 3)
+            ]
+        return self.builder_.call_te(
+            _decode_matmul,
+            call.args[0],
+            *self._encoded[weight],
+            bits=self.bits,
+            group_size=self.group_size,
+            out_dtype=str(call.ty.dtype.dtype),
+            primfunc_name_hint=f"decode_int{self.bits}_matmul",
+        )
@@ -348,6 +348,10 @@ class LazyTransformParams:
 
     Note: ToNonDataflow() and RemovePurityTracking() should be invoked before this pass.
 
+    To transform weights stored in a tensor cache without materializing all of them,
+    run the resulting function with `tvm.contrib.tvmjs.stream_transform_params`, which
+    loads the inputs shard by shard and writes each output into the shards of a new cache.
+
     Parameters
     ----------
     fget_item: str
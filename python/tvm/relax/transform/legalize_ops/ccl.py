@@ -28,9 +28,7 @@ from ...type import ShapeType, TensorType
 from .common import register_legalize
 
 
-@register_legalize("relax.ccl.allreduce")
-def _allreduce(_bb: BlockBuilder, call: Call) -> Expr:
-    op_type_str = call.attrs.op_type
+def _reduce_kind(op_type_str: str) -> ShapeExpr:
     op_type_map = {
         "sum": 0,
         "prod": 1,
@@ -43,13 +41,27 @@ def _allreduce(_bb: BlockBuilder, call: Call) -> Expr:
             f"Unsupported reduction operation: {op_type_str}. "
             f"Supported operations are {op_type_map.keys()}."
         )
+    return ShapeExpr([op_type_map[op_type_str]])
+
+
+@register_legalize("relax.ccl.allreduce")
+def _allreduce(_bb: BlockBuilder, call: Call) -> Expr:
     return call_dps_packed(
         "runtime.disco.allreduce",
-        [call.args[0], ShapeExpr([op_type_map[op_type_str]]), call.attrs.in_group],
+        [call.args[0], _reduce_kind(call.attrs.op_type), call.attrs.in_group],
         out_ty=call.args[0].ty,
     )
 
 
+@register_legalize("relax.ccl.reducescatter")
+def _reducescatter(_bb: BlockBuilder, call: Call) -> Expr:
+    return call_dps_packed(
+        "runtime.disco.reducescatter",
+        [call.args[0], _reduce_kind(call.attrs.op_type), call.attrs.in_group],
+        out_ty=call.ty,
+    )
+
+
 @register_legalize("relax.ccl.allgather")
 def _allgather(_bb: BlockBuilder, call: Call) -> Expr:
     output_shape = []
@@ -73,6 +85,15 @@ def _allgather(_bb: BlockBuilder, call: Call) -> Expr:
     )
 
 
+@register_legalize("relax.ccl.alltoall")
+def _alltoall(_bb: BlockBuilder, call: Call) -> Expr:
+    return call_dps_packed(
+        "runtime.disco.alltoall",
+        [call.args[0], call.attrs.in_group],
+        out_ty=call.args[0].ty,
+    )
+
+
 @register_legalize("relax.ccl.broadcast_from_worker0")
 def _broadcast_from_worker0(_bb: BlockBuilder, call: Call) -> Expr:
     return call_dps_packed(
@@ -23,6 +23,7 @@ from tvm.ir import Call
 from ...block_builder import BlockBuilder
 from ...expr import Expr, Tuple, TupleGetItem, Var
 from .common import register_legalize
+from .manipulate import _is_gpu_target
 
 
 @register_legalize("relax.matmul")
@@ -156,3 +157,9 @@ def _outer(bb: BlockBuilder, call: Call) -> Expr:
 
     lhs, rhs = call.args
     return bb.call_te(te_outer, lhs, rhs, primfunc_name_hint="outer")
+
+
+@register_legalize("relax.csr_matmul")
+def _csr_matmul(bb: BlockBuilder, call: Call) -> Expr:
+    te_func = topi.gpu.csr_matmul if _is_gpu_target() else topi.csr_matmul
+    return bb.call_te(te_func, *call.args, primfunc_name_hint="csr_matmul")
@@ -26,6 +26,7 @@ from tvm.ir import Call
 from ...block_builder import BlockBuilder
 from ...expr import Expr
 from .common import _call_topi_without_attr, register_legalize
+from .manipulate import _is_gpu_target
 
 
 @register_legalize("relax.nn.conv1d")
@@ -783,6 +784,17 @@ def _nn_nll_loss(bb: BlockBuilder, call: Call) -> Expr:
     )
 
 
+@register_legalize("relax.nn.embedding_bag")
+def _nn_embedding_bag(bb: BlockBuilder, call: Call) -> Expr:
+    te_func = topi.gpu.embedding_bag if _is_gpu_target() else topi.embedding_bag
+    return bb.call_te(
+        te_func,
+        *call.args,
+        mode=call.attrs.mode,
+        primfunc_name_hint="embedding_bag",
+    )
+
+
 @register_legalize("relax.nn.batch_flatten")
 def _nn_batch_flatten(bb: BlockBuilder, call: Call) -> Expr:
     if call.ty.shape is None:
@@ -247,7 +247,12 @@ def TopologicalSort(order="depth-first", direction="from-inputs") -> tvm.ir.tran
     order: str
 
         The order in which bindings should be emitted.  Allowed values
-        are "depth-first" and "breadth-first".
+        are "depth-first", "breadth-first" and "min-memory".  The
+        "min-memory" order greedily emits the ready binding that least
+        increases the bytes of live tensors, as computed from the
+        static shapes of their types, which lowers the peak memory
+        later found by StaticPlanBlockMemory.  It requires the
+        "from-inputs" direction.
 
     direciton: str
 
@@ -287,7 +292,9 @@ def DataflowUseInplaceCalls() -> tvm.ir.transform.Pass:
     (generally, these are elementwise operations) into in-place implementations.
     Supported operators will be replaced by calls to `call_tir_inplace` that invoke
     in-place PrimFunc implementations of those operators (which are based on the legalizations of
-    those operators).
+    those operators). The `call_tir` of legalized modules are replaced as well when their PrimFunc
+    only reads an input at the indices it writes the output to, or before it writes the output at
+    all.
 
     Note: ConvertToDataflow may need to be called first to provide dataflow blocks.
 
@@ -534,6 +541,27 @@ def StaticPlanBlockMemory() -> tvm.ir.transform.Pass:
     signature will have upper bound 1024. And we will use 1024 as its value
     during memory planning.
 
+    The TIR variables defined by a :code:`R.match_cast` are additionally bounded
+    by the known upper bounds of the extents they are matched against, so that
+    the tensors shaped by them can be planned without extra annotations.
+
+    With the pass config :code:`"relax.memory_plan_arena": True`, the static-size
+    global tensors of each binding block are packed into one arena storage at
+    best-fit offsets derived from their live intervals, instead of reusing whole
+    storages. The planned peak arena size of each function is reported in its
+    :code:`"relax.memory_plan_peak_bytes"` attribute. Functions that never run at
+    the same time, such as prefill and decode, can be annotated with the same
+    :code:`"relax.memory_arena_group"` attribute to size their arenas to the peak
+    of the group, so that they share one allocation through the pooled allocator.
+
+    With the pass config :code:`"relax.memory_output_params": True`, the tensors that
+    a public function allocates and returns are treated as externally owned: each of
+    them becomes a trailing parameter named :code:`output_buffer_<i>`, through which
+    the caller passes the buffer to write the output into, e.g. with
+    :code:`VirtualMachine.set_output_buffers`. Their number is recorded in the
+    :code:`"relax.num_output_params"` function attribute. A function returning any
+    other value, such as one of its inputs, keeps its signature.
+
     Returns
     -------
     ret : tvm.ir.transform.Pass
@@ -564,6 +592,10 @@ def LowerAllocTensor() -> tvm.ir.transform.Pass:
 def KillAfterLastUse() -> tvm.ir.transform.Pass:
     """Drop all tensor/storage objects after last use
 
+    The last use is found on each path of the control flow. An object that is live into an `If`
+    is dropped in each branch, after its last use there or on entry to a branch that does not use
+    it, and a closure is dropped after its last invocation.
+
     Returns
     -------
     ret : tvm.ir.transform.Pass
@@ -617,6 +649,11 @@ def VMBuiltinLower() -> tvm.ir.transform.Pass:
 def VMShapeLower(*, emit_err_ctx: bool = True) -> tvm.ir.transform.Pass:
     """Lower the symbolic shape and argument and match-cast structinfo matching.
 
+    With the :code:`"relax.backend.cache_shape_heap"` pass config, the functions that call no
+    relax function or closure keep their shape heap across calls, and the shape computations at
+    their boundary are skipped while the symbolic vars of the parameters keep their values, as in
+    decode loops with a fixed batch.
+
     Parameters
     ----------
     emit_err_ctx: Optional[bool]
@@ -798,6 +835,17 @@ def FuseOps(fuse_opt_level=-1) -> tvm.ir.transform.Pass:
 
     Note: ConvertToDataflow may need to be called first to provide dataflow blocks.
 
+    The fusion decisions can be tuned with the following pass configs:
+
+    - :code:`"relax.FuseOps.cost_hook"`: the name of a global function
+      :code:`(lhs, rhs, num_bytes, horizontal) -> bool`, called before two groups are
+      fused. The fusion is refused when it returns False. :code:`lhs` and :code:`rhs`
+      are the bound vars being fused, and :code:`num_bytes` is the static size of
+      the intermediate tensor (or of the shared input for horizontal fusion), -1 if
+      unknown.
+    - :code:`"relax.FuseOps.horizontal"`: also fuse the sibling elementwise and
+      broadcast groups that read the same dataflow var.
+
     Parameters
     ----------
     fuse_opt_level : int
@@ -1341,6 +1389,16 @@ def ConvertLayout(
 ) -> tvm.ir.transform.Pass:
     """Automatic layout conversion pass.
 
+    The layouts can be planned for the whole graph with the following pass configs:
+
+    - :code:`"relax.ConvertLayout.plan_globally"`: rather than converting every op that has a
+      desired layout, choose for each of them whether to convert it or to follow the layout of
+      its inputs, minimizing the number of layout transforms of the activations minus the gains
+      of the converted ops.
+    - :code:`"relax.ConvertLayout.cost_hook"`: the name of a global function
+      :code:`(call, desired_layouts) -> float` returning the gain of converting the call, as the
+      kernel time saved in units of one layout transform. It defaults to 1 for every op.
+
     Parameters
     ----------
     desired_layouts : Dict[str, List[str]]
@@ -1391,7 +1449,10 @@ def DeadCodeElimination(entry_functions: list[str] | None = None) -> tvm.ir.tran
 
 
 def ToMixedPrecision(
-    out_dtype="float32", fp16_input_names: list[str] | None = None
+    out_dtype="float32",
+    fp16_input_names: list[str] | None = None,
+    op_profile: dict[str, tuple[float, float]] | None = None,
+    error_budget: float = 0.0,
 ) -> tvm.ir.transform.Pass:
     """Automatic mixed precision pass. Currently the pass assumes the input module to be fp32
     only, and will automatically cast fp32 to fp16 for certain ops.
@@ -1405,13 +1466,28 @@ def ToMixedPrecision(
     fp16_input_names : List[str]
         The names of function parameters whose dtype should become fp16. The  function signature
         would change accordingly.
+    op_profile : Optional[Dict[str, Tuple[float, float]]]
+        The measurements of a calibration run, mapping the name of the var a call is bound to to
+        the pair (error, speedup): the numerical error the call adds to the outputs in fp16, and
+        the time it saves. The profiled calls that save time are converted to fp16 for the most
+        speedup whose total error stays within error_budget, and the others are kept in fp32,
+        which replaces hand-maintained keep-in-fp32 lists. The calls not in the profile follow
+        the policies of their ops.
+    error_budget : float
+        The bound of the total error of the profiled calls converted to fp16.
 
     Returns
     -------
     ret : tvm.transform.Pass
         The registered pass for mixed precision.
     """
-    return _ffi_api.ToMixedPrecision(out_dtype, fp16_input_names)  # type: ignore
+    if op_profile is not None:
+        op_profile = {
+            name: [float(value) for value in measure] for name, measure in op_profile.items()
+        }
+    return _ffi_api.ToMixedPrecision(  # type: ignore
+        out_dtype, fp16_input_names, op_profile, error_budget
+    )
 
 
 def SplitCallTIRByPattern(patterns: list[PrimFunc], fcodegen: Callable) -> tvm.ir.transform.Pass:
@@ -1556,6 +1632,83 @@ def CombineParallelMatmul(check=None):
     return _ffi_api.CombineParallelMatmul(check)  # type: ignore
 
 
+def Rematerialize(memory_budget: int) -> tvm.ir.transform.Pass:
+    """Recompute tensors close to their late uses to keep the peak memory within a budget.
+
+    The output of `Gradient` keeps forward activations alive until the backward bindings that
+    consume them. Within each dataflow block, this pass finds the binding with the most live
+    tensor bytes and recomputes a tensor live across it right before its next use, so the
+    original is released early. A tensor is only recomputed if all of its inputs are live at
+    that point anyway, and candidates saving more bytes per estimated FLOP are preferred. This
+    repeats until the peak fits `memory_budget` or no candidate is left.
+
+    The shortened lifetimes are picked up by `KillAfterLastUse` and `StaticPlanBlockMemory`.
+    The pass should run before `LegalizeOps`, while operators can still be identified.
+
+    Parameters
+    ----------
+    memory_budget : int
+        The target peak of live tensor bytes within a dataflow block.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass.
+    """
+    return _ffi_api.Rematerialize(memory_budget)  # type: ignore
+
+
+def FakeQuantizationToInteger() -> tvm.ir.transform.Pass:
+    """Fold dequantize-op-quantize chains into integer kernels.
+
+    Quantized models are often imported as float operators between `R.dequantize` and
+    `R.quantize`. This pass rewrites
+
+    - ``quantize(relu?(matmul(dequantize(a), dequantize(w)) + dequantize(bias)?))`` into an
+      int32-accumulating matmul of the quantized operands, with the zero points applied
+      through row and column sums, and
+    - ``quantize(dequantize(x))`` into an integer requantize,
+
+    followed by a fixed-point requantization: the rescale ``s_a * s_w / s_y`` becomes a 31-bit
+    multiplier and a rounding right shift in 64-bit arithmetic, then the output zero point is
+    added and the result clipped to the output type.
+
+    Scales and zero points must be constants. The weight and output scales may be per channel
+    along the output axis; a bias must be quantized with the product scale and a zero zero
+    point. Chains that do not fit are left unchanged.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass.
+    """
+    return _ffi_api.FakeQuantizationToInteger()  # type: ignore
+
+
+def HorizontalFuseTIR(max_num_blocks: int = 256) -> tvm.ir.transform.Pass:
+    """Pack independent `call_tir` bindings of a dataflow block into a single GPU kernel.
+
+    Two calls are independent when neither consumes the output of the other. A call is a
+    candidate when its scheduled callee consists of a single kernel launch, i.e. one outermost
+    loop bound to `blockIdx.x` with a constant extent. Candidates at the same dataflow level
+    whose kernels use the same thread extents are merged into one PrimFunc that dispatches on
+    ranges of `blockIdx.x`, cutting the number of kernel launches. The callees that are no
+    longer used can be removed with `DeadCodeElimination`.
+
+    Parameters
+    ----------
+    max_num_blocks : int
+        Only kernels launching at most this many thread blocks are merged, so that kernels
+        which already fill the device are left alone.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass.
+    """
+    return _ffi_api.HorizontalFuseTIR(max_num_blocks)  # type: ignore
+
+
 def RewriteCUDAGraph() -> tvm.ir.transform.Pass:
     """Rewrite a Relax module for executing with CUDA graph. This pass identifies the regions that
     can be executed with CUDA graph and lifts them into new functions for runtime graph capturing.
@@ -1568,6 +1721,22 @@ def RewriteCUDAGraph() -> tvm.ir.transform.Pass:
     return _ffi_api.RewriteCUDAGraph()  # type: ignore
 
 
+def AssignDeviceStreams() -> tvm.ir.transform.Pass:
+    """Launch the kernels of independent dataflow branches on multiple device streams.
+
+    The number of streams is read from the pass config ``relax.backend.num_device_streams``. The
+    module is unchanged when it is at most 1 or when CUDA graph is enabled. A kernel continues the
+    stream of a kernel it depends on, otherwise it branches to another stream, and the streams
+    are joined at the end of each binding block and before any operation other than a kernel.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+        The registered pass for assigning device streams
+    """
+    return _ffi_api.AssignDeviceStreams()  # type: ignore
+
+
 def AllocateWorkspace() -> tvm.ir.transform.Pass:
     """Allocate a workspace, represented by a tensor of size big enough for all external
     functions that require a temporary storage, and append it to the arguments of external
@@ -272,7 +272,12 @@ def build(
     ext_libs, constants = _extract_attrs(mod)
     params.update(dict(constants))
     builder = relax.ExecBuilder()
-    mod = _vmcodegen(builder, mod, exec_mode)
+    if target is None:
+        mod = _vmcodegen(builder, mod, exec_mode)
+    else:
+        # The codegen tells the kernels that run on the host by the target.
+        with target:
+            mod = _vmcodegen(builder, mod, exec_mode)
     return _vmlink(
         builder=builder,
         target=target,
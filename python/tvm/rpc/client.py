@@ -18,6 +18,7 @@
 # ruff: noqa: F401
 """RPC client tools"""
 
+import contextlib
 import os
 import socket
 import stat
@@ -94,6 +95,60 @@ class RPCSession:
         dev._rpc_sess = self
         return dev
 
+    @contextlib.contextmanager
+    def pipelined(self):
+        """Pipeline the copies to the remote within the scope.
+
+        A copy to the remote sends its request without waiting for the reply, so that a
+        sequence of uploads costs a single round trip. The first error of a pending copy is
+        raised by the next request that waits for its reply, or when leaving the scope.
+
+        Examples
+        --------
+        .. code-block:: python
+
+            args = [tvm.runtime.empty(data.shape, data.dtype, dev) for data in inputs]
+            with sess.pipelined():
+                for arg, data in zip(args, inputs):
+                    arg.copyfrom(data)
+            func(*args)
+        """
+        _ffi_api.SessionSetPipelined(self._sess, True)
+        try:
+            yield self
+        finally:
+            _ffi_api.SessionSetPipelined(self._sess, False)
+
+    def enable_compression(self, codec="zstd", min_bytes=64 << 10):
+        """Compress the tensor copies of the session, when both ends support the codec.
+
+        Parameters
+        ----------
+        codec : str
+            The codec, "zstd" or "none" to stop compressing.
+
+        min_bytes : int
+            The smallest copy to compress, smaller copies are sent raw.
+
+        Returns
+        -------
+        enabled : bool
+            Whether the copies are compressed. It is False with servers that do not
+            support the codec, which keep receiving raw copies.
+        """
+        return _ffi_api.SessionSetCompression(self._sess, codec, min_bytes)
+
+    def transfer_stats(self):
+        """The statistics of the tensor copies of the session.
+
+        Returns
+        -------
+        stats : Dict[str, int]
+            The logical bytes of the copies in "logical_bytes", and the payload bytes they
+            took on the wire in "wire_bytes".
+        """
+        return dict(_ffi_api.SessionGetTransferStats(self._sess))
+
     def upload(self, data, target=None):
         """Upload file to remote runtime temp folder
 
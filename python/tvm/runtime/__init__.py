@@ -34,7 +34,7 @@ from .executable import Executable
 
 # function exposures
 from ._tensor import device, device_from_target, cpu, cuda, opencl, vulkan, metal
-from ._tensor import vpi, rocm, ext_dev, from_dlpack
+from ._tensor import vpi, rocm, ext_dev, from_dlpack, from_external_buffer
 from .module import load_module, enabled, system_lib, load_static_library, num_threads
 from .object_generic import const
 from .params import (
@@ -43,6 +43,8 @@ from .params import (
     save_param_dict_to_file,
     load_param_dict_from_file,
 )
+from . import loop_profiler
+from . import metrics
 
 try:
     from . import disco
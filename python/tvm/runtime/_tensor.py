@@ -333,6 +333,43 @@ def empty(shape, dtype="float32", device=None, mem_scope=None):
     return arr
 
 
+def from_external_buffer(ptr, shape, dtype="float32", device=None, release=None, alignment=64):
+    """Create a tensor over a buffer owned by the caller, without copying it
+
+    Parameters
+    ----------
+    ptr : Union[int, ctypes.c_void_p]
+        The address of the buffer.
+
+    shape : Union[tvm_ffi.Shape, Sequence[typing.SupportsInt]]
+        The shape of the tensor.
+
+    dtype : type or str
+        The data type of the tensor.
+
+    device : Device
+        The device of the buffer.
+
+    release : Optional[Callable[[], None]]
+        Called once the tensor and its views no longer use the buffer.
+
+    alignment : int
+        The alignment in bytes that the address must have.
+
+    Returns
+    -------
+    arr : tvm.runtime.Tensor
+        The tensor viewing the buffer.
+    """
+    device = device or cpu()
+    if not isinstance(shape, tvm_ffi.Shape):
+        shape = tvm_ffi.Shape([int(dim) for dim in shape])
+    dtype = tvm_ffi.dtype(dtype)
+    if not isinstance(ptr, ctypes.c_void_p):
+        ptr = ctypes.c_void_p(ptr)
+    return _ffi_api.TVMTensorFromExternalBuffer(ptr, shape, dtype, device, release, alignment)
+
+
 def tensor(arr, device=None, mem_scope=None):
     """Create an tensor from source arr.
 
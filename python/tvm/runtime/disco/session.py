@@ -235,6 +235,31 @@ class Session(Object):
         """
         return _ffi_api.SessionCallPacked(self, 0, 0, func, *args)  # type: ignore # pylint: disable=no-member
 
+    def begin_capture(self) -> None:
+        """Start capturing a command graph. Until `end_capture`, calls of packed functions are
+        recorded instead of sent to the workers, and the DRefs they return denote the registers
+        each replay writes to. Other commands, such as copies and syncs, are not captured and
+        still run immediately.
+        """
+        _ffi_api.SessionBeginCapture(self)  # type: ignore # pylint: disable=no-member
+
+    def end_capture(self, inputs: Sequence[DRef] = ()) -> DPackedFunc:
+        """Finish capturing, and send the captured calls to the workers in one message.
+
+        Parameters
+        ----------
+        inputs : Sequence[DRef]
+            The registers bound to the arguments of a replay, in order.
+
+        Returns
+        -------
+        graph : DPackedFunc
+            Calling it with one argument per input replays all the captured calls with a single
+            broadcast, regardless of the number of calls.
+        """
+        graph = _ffi_api.SessionEndCapture(self, list(inputs))  # type: ignore # pylint: disable=no-member
+        return DPackedFunc(graph, self)
+
     def _sync_worker(self, worker_id: int) -> None:
         """Synchronize the controller with a worker, and it will wait until the worker finishes
         executing all the existing instructions. This function is usually used for worker-0, because
@@ -534,6 +559,142 @@ class Session(Object):
         func = self._get_cached_method("runtime.disco.allgather")
         func(src, in_group, dst)
 
+    def ring_exchange(
+        self,
+        src: DRef,
+        dst: DRef,
+        in_group: bool = True,
+    ) -> DRef:
+        """Send an array to the next worker and receive one from the previous worker, with the
+        workers in a ring.
+
+        Parameters
+        ----------
+        src : DRef
+            The array to be sent to the next worker.
+
+        dst : DRef
+            The array to receive from the previous worker, which must not overlap `src`.
+
+        in_group : bool
+            Whether the ring is formed by the workers of the group or by all workers.
+        """
+        func = self._get_cached_method("runtime.disco.ring_exchange")
+        func(src, in_group, dst)
+
+    def allreduce_start(
+        self,
+        src: DRef,
+        dst: DRef,
+        op: str = "sum",  # pylint: disable=invalid-name
+        in_group: bool = True,
+    ) -> DRef:
+        """Start an allreduce on the communication stream of each worker, so that independent
+        work queued before `collective_wait` overlaps with it. `src` and `dst` must not be used
+        until the returned handle is waited for.
+
+        Parameters
+        ----------
+        src : DRef
+            The array to be reduced.
+
+        dst : DRef
+            The array to hold the result.
+
+        op : str = "sum"
+            The reduce operation to be performed, the same options as `allreduce`.
+
+        in_group : bool
+            Whether the reduce operation performs globally or in group as default.
+
+        Returns
+        -------
+        handle : DRef
+            The handle to pass to `collective_wait`.
+        """
+        if op not in REDUCE_OPS:
+            raise ValueError(f"Unsupported reduce op: {op}. Available ops are: {REDUCE_OPS.keys()}")
+        op = Shape([REDUCE_OPS[op]])
+        func = self._get_cached_method("runtime.disco.allreduce_start")
+        return func(src, op, in_group, dst)
+
+    def allgather_start(
+        self,
+        src: DRef,
+        dst: DRef,
+        in_group: bool = True,
+    ) -> DRef:
+        """Start an allgather on the communication stream of each worker. `src` and `dst` must not
+        be used until the returned handle is waited for.
+
+        Parameters
+        ----------
+        src : DRef
+            The array to be gathered from.
+
+        dst : DRef
+            The array to be gathered to.
+
+        in_group : bool
+            Whether the gather operation performs globally or in group as default.
+
+        Returns
+        -------
+        handle : DRef
+            The handle to pass to `collective_wait`.
+        """
+        func = self._get_cached_method("runtime.disco.allgather_start")
+        return func(src, in_group, dst)
+
+    def collective_wait(self, handle: DRef) -> None:
+        """Make the compute stream of each worker wait for an asynchronous collective.
+
+        Parameters
+        ----------
+        handle : DRef
+            The handle returned by `allreduce_start` or `allgather_start`.
+        """
+        func = self._get_cached_method("runtime.disco.collective_wait")
+        func(handle)
+
+    def pipeline_run(  # pylint: disable=too-many-arguments
+        self,
+        stage_func: DRef,
+        num_micro_batches: int,
+        inputs: Optional[DRef],
+        outputs: Optional[DRef],
+        act_shape: Sequence[int],
+        act_dtype: str,
+    ) -> None:
+        """Run micro-batches through the pipeline formed by the worker groups, group `g` being
+        stage `g`. Each worker runs the whole schedule locally: the activations flow to the
+        corresponding worker in the next group, and the receive of the next micro-batch overlaps
+        with the computation of the current one.
+
+        Parameters
+        ----------
+        stage_func : DRef
+            The stage of each worker, called as `stage_func(input, micro_batch)` and returning
+            the activation for the next stage.
+
+        num_micro_batches : int
+            The number of micro-batches.
+
+        inputs : Optional[DRef]
+            The micro-batches stacked on axis 0. Only used by the first group.
+
+        outputs : Optional[DRef]
+            The outputs stacked on axis 0. Only written by the last group.
+
+        act_shape : Sequence[int]
+            The shape of the activation of one micro-batch between two stages.
+
+        act_dtype : str
+            The dtype of the activation between two stages.
+        """
+        func = self._get_cached_method("runtime.disco.pipeline_run")
+        func(stage_func, num_micro_batches, inputs, outputs, Shape(act_shape), act_dtype)
+
     def _clear_ipc_memory_pool(self):
         # Clear the IPC memory allocator when the allocator exists.
         name = "runtime.disco.cuda_ipc.cuda_ipc_memory_allocator_clear"
@@ -556,13 +717,31 @@ class ThreadedSession(Session):
 
 @register_object("runtime.disco.ProcessSession")
 class ProcessSession(Session):
-    """A Disco session backed by pipe-based multi-processing."""
+    """A Disco session backed by multi-processing.
+
+    Parameters
+    ----------
+    num_workers : int
+        The number of workers.
+
+    num_groups : int
+        The number of worker groups.
+
+    entrypoint : str
+        The module that runs the worker process.
+
+    transport : str
+        How the controller talks to the worker processes. "pipe" sends the messages through
+        pipes. "shm" sends them through a shared-memory ring per worker, which avoids a system
+        call per message and is only supported on Linux.
+    """
 
     def __init__(
         self,
         num_workers: int,
         num_groups: int = 1,
         entrypoint: str = "tvm.exec.disco_worker",
+        transport: str = "pipe",
     ) -> None:
         self.__init_handle_by_constructor__(
             _ffi_api.SessionProcess,  # type: ignore # pylint: disable=no-member
@@ -570,6 +749,7 @@ class ProcessSession(Session):
             num_groups,
             "runtime.disco.create_process_pool",
             entrypoint,
+            transport,
         )
         self._configure_structlog()
 
@@ -0,0 +1,152 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Per-loop hardware counters of kernels instrumented with profile intrinsics.
+
+Build with the pass config ``"tirx.instrument_lwp": True`` so that
+``InstrumentProfileIntrinsics`` marks the loops, then run the kernels between
+:py:func:`start` and :py:func:`report`.
+
+- CPU kernels record elapsed time and, where ``perf_event`` is available, the
+  cycles, instructions, L1D read misses, LLC misses and branch misses of each
+  loop on the calling thread.
+- CUDA kernels record the ``clock64()`` cycles of each region on the first
+  thread of every block.
+
+.. code-block:: python
+
+    with tvm.transform.PassContext(config={"tirx.instrument_lwp": True}):
+        lib = tvm.compile(mod, target="llvm")
+    loop_profiler.start()
+    lib["main"](a, b)
+    baseline = loop_profiler.report(lib)
+    # Rebuild with another schedule, run it, and compare.
+    candidate = loop_profiler.report(new_lib)
+    print(candidate.diff(baseline))
+"""
+
+import json
+from typing import Dict, List, Tuple
+
+from . import _ffi_api
+
+
+class LoopProfileReport:
+    """The measurements of each instrumented loop, keyed by kernel name and loop id.
+
+    Parameters
+    ----------
+    counters : List[str]
+        The names of the measured quantities, besides "calls".
+    loops : List[dict]
+        One entry per loop with the keys "kernel", "loop", "calls" and the counters.
+    """
+
+    def __init__(self, counters: List[str], loops: List[dict]):
+        self.counters = counters
+        self.loops = loops
+
+    def records(self) -> Dict[Tuple[str, int], dict]:
+        """The loop entries keyed by (kernel, loop id)."""
+        return {(entry["kernel"], entry["loop"]): entry for entry in self.loops}
+
+    def table(self) -> str:
+        """Render the report as a table with one row per loop."""
+        header = ["kernel", "loop", "calls"] + self.counters
+        rows = [[str(entry.get(key, "")) for key in header] for entry in self.loops]
+        return _format_table(header, rows)
+
+    def diff(self, baseline: "LoopProfileReport") -> str:
+        """Render the ratio of each counter to the same loop in ``baseline``.
+
+        Loops are matched by kernel name and loop id, which stay the same across schedules
+        of one kernel as long as the loop nest keeps its shape.
+        """
+        base = baseline.records()
+        counters = [name for name in self.counters if name in baseline.counters]
+        header = ["kernel", "loop"] + counters
+        rows = []
+        for key, entry in sorted(self.records().items()):
+            row = [key[0], str(key[1])]
+            for name in counters:
+                new, old = entry.get(name), base.get(key, {}).get(name)
+                row.append(f"{new / old:.3f}x" if new is not None and old else "-")
+            rows.append(row)
+        return _format_table(header, rows)
+
+    def __str__(self) -> str:
+        return self.table()
+
+
+def _format_table(header: List[str], rows: List[List[str]]) -> str:
+    widths = [max(len(row[i]) for row in [header] + rows) for i in range(len(header))]
+    lines = ["  ".join(cell.ljust(width) for cell, width in zip(row, widths)) for row in rows]
+    return "\n".join(["  ".join(h.ljust(w) for h, w in zip(header, widths))] + lines)
+
+
+def _collect_cuda_modules(module) -> list:
+    if hasattr(module, "jit"):
+        module = module.jit()
+    visited, stack, cuda_modules = set(), [module], []
+    while stack:
+        mod = stack.pop()
+        if mod in visited:
+            continue
+        visited.add(mod)
+        if mod.kind == "cuda":
+            cuda_modules.append(mod)
+        stack.extend(mod.imports)
+    return cuda_modules
+
+
+def start():
+    """Clear the measurements and start recording CPU loops."""
+    _ffi_api.LoopProfilerStart()  # type: ignore
+
+
+def stop():
+    """Stop recording CPU loops. The measurements so far are kept."""
+    _ffi_api.LoopProfilerStop()  # type: ignore
+
+
+def report(module=None, device_id: int = 0, reset: bool = True) -> LoopProfileReport:
+    """Collect the measurements of all instrumented loops.
+
+    Parameters
+    ----------
+    module : Optional[Union[tvm.runtime.Module, tvm.runtime.Executable]]
+        The module whose imported CUDA modules are read as well.
+    device_id : int
+        The CUDA device whose counters are read.
+    reset : bool
+        Whether to clear the CUDA counters after reading them.
+
+    Returns
+    -------
+    report : LoopProfileReport
+        The CPU loops followed by the CUDA regions.
+    """
+    cpu = json.loads(_ffi_api.LoopProfilerReport())  # type: ignore
+    counters: List[str] = ["time_ns"] + cpu["counters"]
+    loops: List[dict] = cpu["loops"]
+    cuda_loops: List[dict] = []
+    if module is not None:
+        for cuda_module in _collect_cuda_modules(module):
+            fread = cuda_module.get_function("__tvm_profile_read")
+            cuda_loops.extend(json.loads(fread(device_id, reset)))
+    if cuda_loops and "cycles" not in counters:
+        counters.append("cycles")
+    return LoopProfileReport(counters, loops + cuda_loops)
@@ -0,0 +1,67 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""The always-on runtime metrics of the process.
+
+The runtime keeps counters, gauges and histograms for the pooled allocator,
+the workspace pools, the thread pool, the paged KV caches and the Disco
+message channels. Updates are relaxed atomic operations, so the metrics stay
+enabled in production.
+
+.. code-block:: python
+
+    from tvm.runtime import metrics
+
+    print(metrics.snapshot()["tvm_pooled_allocator_in_use_bytes"])
+    # Serve the text at a "/metrics" endpoint for Prometheus to scrape.
+    text = metrics.prometheus_text()
+"""
+
+from typing import Dict
+
+from . import _ffi_api
+
+
+def snapshot() -> Dict[str, float]:
+    """Read the current value of every metric.
+
+    Returns
+    -------
+    values : Dict[str, float]
+        The value of each counter and gauge, and the "<name>_count" and
+        "<name>_sum" of each histogram.
+    """
+    return {str(name): float(value) for name, value in _ffi_api.MetricsSnapshot().items()}
+
+
+def prometheus_text() -> str:
+    """Export every metric in the Prometheus text exposition format."""
+    return str(_ffi_api.MetricsPrometheusText())
+
+
+def increment(name: str, delta: int = 1) -> None:
+    """Add to a counter, creating it when it does not exist yet."""
+    _ffi_api.MetricsIncrement(name, delta)
+
+
+def set_gauge(name: str, value: int) -> None:
+    """Set a gauge, creating it when it does not exist yet."""
+    _ffi_api.MetricsSetGauge(name, value)
+
+
+def observe(name: str, value: float) -> None:
+    """Record a value in a histogram, creating it when it does not exist yet."""
+    _ffi_api.MetricsObserve(name, value)
@@ -19,6 +19,7 @@
 # pylint: disable=invalid-name, unused-import, import-outside-toplevel, inconsistent-return-statements
 """Runtime Module namespace."""
 
+import concurrent.futures
 import json
 import os
 import struct
@@ -76,6 +77,9 @@ class BenchmarkResult:
             Standard deviation in seconds of runtimes. If py:meth:`Module.time_evaluator` is called
             with `number` > 0, then each result is already the mean of a `number` of runtimes, so
             this becomes the standard deviation of means.
+        p99 : float
+            The 99th percentile in seconds of all results, which shows the tail of the runtimes
+            that the mean and the median hide.
         results : Sequence[float]
             The collected runtimes (in seconds). This may be a series of mean runtimes if
             py:meth:`Module.time_evaluator` or `benchmark` was run with `number` > 1.
@@ -86,11 +90,12 @@ class BenchmarkResult:
         self.median = np.median(self.results)
         self.min = np.min(self.results)
         self.max = np.max(self.results)
+        self.p99 = np.percentile(self.results, 99)
 
     def __repr__(self):
         return (
             f"BenchmarkResult(min={self.min}, mean={self.mean}, median={self.median}, "
-            f"max={self.max}, std={self.std}, results={self.results})"
+            f"max={self.max}, std={self.std}, p99={self.p99}, results={self.results})"
         )
 
     def __str__(self):
@@ -145,6 +150,51 @@ class Module(_Module):
         """Collect all compilation exportable modules from the import tree."""
         return self._collect_from_import_tree(lambda m: m.is_compilation_exportable())
 
+    def preload(self, func_names=None, device_ids=None, background=False):
+        """Load the device kernels of the CUDA, OpenCL and Vulkan modules in the import tree
+        ahead of their first launch, e.g. while the model is loaded rather than during the first
+        request. The devices are loaded in parallel. OpenCL programs are built and Vulkan
+        pipelines are created, which is the compilation a first launch would otherwise pay for.
+
+        Parameters
+        ----------
+        func_names : Optional[List[str]]
+            The kernels to load. All the kernels of each module if None.
+
+        device_ids : Optional[List[int]]
+            The devices to load on. All the devices of each module if None.
+
+        background : bool
+            Whether to load on a background thread, so that the kernels are compiled while
+            e.g. the weights are loaded. A kernel launched before its compilation is done
+            waits for it.
+
+        Returns
+        -------
+        future : Optional[concurrent.futures.Future]
+            The future of the loading when background is True, whose result raises the error
+            of the loading, if any.
+        """
+        modules = self._collect_from_import_tree(lambda m: m.kind in ("cuda", "opencl", "vulkan"))
+
+        def _preload():
+            for module in modules:
+                names = func_names
+                if names is not None:
+                    # Only the kernels defined in this module.
+                    names = [name for name in names if module.implements_function(name)]
+                    if not names:
+                        continue
+                module.get_function("__tvm_preload")(names or [], device_ids or [])
+
+        if not background:
+            _preload()
+            return None
+        executor = concurrent.futures.ThreadPoolExecutor(max_workers=1)
+        future = executor.submit(_preload)
+        executor.shutdown(wait=False)
+        return future
+
     def export_library(
         self,
         file_name,
@@ -263,6 +313,9 @@ class Module(_Module):
             module.write_to_file(path_obj)
             files.append(path_obj)
             if module.kind == "llvm":
+                # An LLVM module may be emitted into several object files, see the
+                # "codegen.llvm.num_object_shards" config.
+                files.extend(module.get_function("get_object_shard_files")(path_obj))
                 is_system_lib = module.get_function("__tvm_is_system_module")()
                 llvm_target = module.get_function("_get_target_string")()
                 system_lib_prefix = module.get_function("__tvm_get_system_lib_prefix")()
@@ -334,6 +387,8 @@ class Module(_Module):
         repeats_to_cooldown=1,
         cache_flush_bytes=0,
         f_preproc="",
+        max_relative_ci=0.0,
+        cold=False,
     ):
         """Get an evaluator that measures time cost of running function.
 
@@ -376,11 +431,22 @@ class Module(_Module):
             The number of repeats before the cooldown is activated.
 
         cache_flush_bytes: int, optional
-            The number of bytes to flush from the cache before each repeat.
+            The number of bytes to flush from the cache before each repeat. The flush uses the
+            `runtime.cache_flush.<device>` function when the device registers one.
 
         f_preproc: str, optional
             The preprocess function name we want to execute before executing the time evaluator.
 
+        max_relative_ci: float, optional
+            When positive, `repeat` becomes the maximum number of repeats, and the measurement
+            stops after at least 3 repeats once the 95% confidence interval of the mean cost is
+            narrower than this fraction of the mean. For example, 0.02 stops at +-1%.
+
+        cold: bool, optional
+            Whether to measure cold runs: the caches are flushed before every run, and the runs
+            of a repeat are timed one by one. It needs `cache_flush_bytes` > 0. By default the runs
+            of a repeat are timed back to back, warm.
+
         Note
         ----
         The function will be invoked  (1 + number x repeat) times,
@@ -406,13 +472,16 @@ class Module(_Module):
                 repeats_to_cooldown,
                 cache_flush_bytes,
                 f_preproc,
+                max_relative_ci,
+                cold,
             )
 
             def evaluator(*args):
                 """Internal wrapped evaluator."""
                 # Wrap feval so we can add more stats in future.
                 blob = feval(*args)
-                fmt = "@" + ("d" * repeat)
+                # An adaptive measurement may stop before `repeat` costs.
+                fmt = "@" + ("d" * (len(blob) // struct.calcsize("d")))
                 results = struct.unpack(fmt, blob)
                 return BenchmarkResult(results)
 
@@ -18,7 +18,10 @@
 # ruff: noqa: RUF005
 """The Relax virtual machine."""
 
-from collections.abc import Callable
+import json
+import threading
+from collections.abc import Callable, Iterator
+from contextlib import contextmanager
 from enum import IntEnum
 from numbers import Integral, Number
 from typing import Any
@@ -43,6 +46,8 @@ class VirtualMachine:
 
     NAIVE_ALLOCATOR = 1
     POOLED_ALLOCATOR = 2
+    BUDDY_ALLOCATOR = 3
+    STREAM_ORDERED_ALLOCATOR = 4
 
     def __init__(
         self,
@@ -63,11 +68,13 @@ class VirtualMachine:
 
         memory_cfg : Optional[Union[str, Dict[Device, str]]]
             Config the type of memory allocator. The allocator type can be ["naive",
-            "pooled"]. If memory_cfg is None, all devices will use pooled allocator
-            by default. If memory_cfg is string, all devices will use the specified
-            allocator type. If memory_cfg is a dict, each device uses the allocator
+            "pooled", "buddy", "stream_ordered"]. If memory_cfg is None, all devices will use
+            pooled allocator by default. If memory_cfg is string, all devices will use the
+            specified allocator type. If memory_cfg is a dict, each device uses the allocator
             type specified in the dict, or pooled allocator if not specified in the
-            dict.
+            dict. The "stream_ordered" allocator allocates from cudaMallocAsync memory pools on
+            the current stream, so it only applies to CUDA devices, and the other devices use
+            pooled allocator.
         """
         if not isinstance(rt_mod, tvm.runtime.Module):
             if isinstance(rt_mod, tvm.runtime.Executable):
@@ -75,17 +82,40 @@ class VirtualMachine:
             else:
                 raise ValueError("Expect the rt_mod to be an runtime.Module")
 
-        self.module = rt_mod["vm_load_executable"]()
+        self._bind_module(rt_mod["vm_load_executable"]())
+        self._setup_device(device, memory_cfg)
+
+    def _bind_module(self, module: tvm.runtime.Module) -> None:
+        """Bind the wrapper to a VM module."""
+        self.module = module
         self._invoke_closure = self.module["invoke_closure"]
         self._save_function = self.module["save_function"]
         self._set_input = self.module["set_input"]
+        self._set_input_zero_copy = self.module["set_input_zero_copy"]
+        self._set_output_buffers = self.module["set_output_buffers"]
         self._invoke_stateful = self.module["invoke_stateful"]
         self._get_output = self.module["get_output"]
         self._get_output_arity = self.module["get_output_arity"]
         self._get_function_arity = self.module["get_function_arity"]
         self._get_function_param_name = self.module["get_function_param_name"]
         self._set_instrument = self.module["set_instrument"]
-        self._setup_device(device, memory_cfg)
+
+    def create_context(self) -> "VirtualMachine":
+        """Create an execution context of the VM.
+
+        The context shares the executable, the constants on the devices and the function pool
+        of the VM, so creating it does not load or initialize anything again. It has its own
+        call frames, inputs, outputs and instrument. The contexts of a VM can run on different
+        threads at the same time, while each of them is used by one thread at a time.
+
+        Returns
+        -------
+        ctx : VirtualMachine
+            The context, which has the interface of the VM.
+        """
+        ctx = VirtualMachine.__new__(VirtualMachine)
+        ctx._bind_module(self.module["create_context"]())
+        return ctx
 
     def _setup_device(self, dev: Device, memory_cfg: str | dict[Device, str]) -> None:
         """init devices and allocators."""
@@ -103,10 +133,20 @@ class VirtualMachine:
         if memory_cfg is None:
             memory_cfg = {}
         elif isinstance(memory_cfg, str):
-            assert memory_cfg in ["naive", "pooled"]
+            assert memory_cfg in ["naive", "pooled", "buddy", "stream_ordered"]
             if memory_cfg == "naive":
                 default_alloc_type = VirtualMachine.NAIVE_ALLOCATOR
-            memory_cfg = {}
+            elif memory_cfg == "buddy":
+                default_alloc_type = VirtualMachine.BUDDY_ALLOCATOR
+            if memory_cfg == "stream_ordered":
+                cuda_type = tvm.cuda().dlpack_device_type()
+                memory_cfg = {
+                    device: VirtualMachine.STREAM_ORDERED_ALLOCATOR
+                    for device in devs
+                    if device.dlpack_device_type() % RPC_SESS_MASK == cuda_type
+                }
+            else:
+                memory_cfg = {}
         elif not isinstance(memory_cfg, dict):
             raise TypeError(
                 "memory_cfg is expected be string or dictionary, "
@@ -275,6 +315,54 @@ class VirtualMachine:
 
         self._set_input(func_name, *cargs)
 
+    def set_input_zero_copy(self, func_name: str, *args: Any, **kwargs: Any) -> None:
+        """Set the inputs to a function without copying them.
+
+        Unlike `set_input`, the tensors are adopted as they are, and must already be on the
+        device of the VM. This includes the buffers wrapped with
+        `tvm.runtime.from_external_buffer`, whose owner keeps them alive and unmodified
+        until the inputs are set again.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+        args: List[tvm.runtime.Tensor]
+            The arguments to the function.
+        kwargs: dict of str to tvm.runtime.Tensor
+            Named arguments to the function.
+        """
+        cargs: list[Any] = []
+
+        if kwargs:
+            args = self._convert_func_named_args(func_name, args, **kwargs)
+
+        for arg in args:
+            self._convert(arg, cargs)
+
+        self._set_input_zero_copy(func_name, *cargs)
+
+    def set_output_buffers(self, func_name: str, *outputs: Any) -> None:
+        """Bind the outputs of a function to preallocated tensors.
+
+        After each `invoke_stateful`, the tensors of the result, in the order of a flattened
+        tuple, are written into the bound tensors, which `get_outputs` then returns. An output
+        that already shares storage with its bound tensor, as the result of a function in
+        destination-passing style, is not copied. Call with no outputs to unbind them.
+
+        A function compiled with the pass config ``"relax.memory_output_params"`` takes the
+        bound tensors as its trailing output parameters, and writes its outputs into them
+        without a copy. Its inputs are then set without the output parameters.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+        outputs: List[tvm.runtime.Tensor]
+            The tensors to write the outputs into, on the device of the VM.
+        """
+        self._set_output_buffers(func_name, *outputs)
+
     def invoke_stateful(self, func_name: str) -> None:
         """
         Call the named function from the VM module using the arguments set using `set_input`.
@@ -362,6 +450,55 @@ class VirtualMachine:
         """
         self._set_instrument(instrument)
 
+    def profiler_start(self) -> None:
+        """Start profiling the packed function calls of the VM.
+
+        Each call records its device time, measured by the timer of the first VM device,
+        the shapes of its tensor arguments, its stream, and the memory taken from the VM
+        allocators. The device timers are only synchronized in batches, so the calls keep
+        running asynchronously. Starting again discards the previous records.
+        """
+        self.module["profiler_start"]()
+
+    def profiler_stop(self) -> None:
+        """Stop profiling. The records are kept for `profiler_report` and
+        `profiler_chrome_trace`."""
+        self.module["profiler_stop"]()
+
+    def profiler_report(self) -> dict[str, Any]:
+        """Get the per-function statistics of the profiled calls.
+
+        Returns
+        -------
+        report : Dict[str, Any]
+            The total device time, the peak allocator usage, and for each function, in order
+            of decreasing total time, its number of calls, its total, mean, min and max device
+            time in nanoseconds, its share of the total time and the bytes it allocated.
+        """
+        return json.loads(self.module["profiler_report"]())
+
+    def profiler_chrome_trace(self, path: str | None = None) -> str:
+        """Export the profiled calls in the Chrome trace event format.
+
+        Each call is an event starting at its host launch time and lasting its device time,
+        with one track per stream and a counter track of the allocator usage.
+
+        Parameters
+        ----------
+        path : Optional[str]
+            The file to write the trace to.
+
+        Returns
+        -------
+        trace : str
+            The trace in JSON.
+        """
+        trace = self.module["profiler_chrome_trace"]()
+        if path is not None:
+            with open(path, "w") as f:
+                f.write(trace)
+        return trace
+
     def time_evaluator(
         self,
         func_name: str,
@@ -472,6 +609,58 @@ class VirtualMachine:
         )
 
 
+class VirtualMachinePool:
+    """A thread-safe pool of the execution contexts of a VM.
+
+    Serving threads acquire a context per request and return it afterwards, so that the
+    contexts, and the frames and register files they keep, are reused across requests
+    instead of loading the executable for each thread.
+
+    .. code-block:: python
+
+        pool = relax.VirtualMachinePool(relax.VirtualMachine(ex, tvm.cuda()))
+        with pool.acquire() as vm:
+            out = vm["main"](data)
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The initialized VM whose contexts are pooled.
+
+    max_idle : Optional[int]
+        The maximum number of idle contexts kept by the pool, unbounded if None.
+    """
+
+    def __init__(self, vm: VirtualMachine, max_idle: int | None = None) -> None:
+        self.vm = vm
+        self.max_idle = max_idle
+        self._idle: list[VirtualMachine] = []
+        self._lock = threading.Lock()
+
+    @contextmanager
+    def acquire(self) -> Iterator[VirtualMachine]:
+        """Take a context out of the pool, creating one if none is idle.
+
+        The context is returned to the pool when the with-block exits, and must not be
+        used by other threads until then.
+        """
+        with self._lock:
+            ctx = self._idle.pop() if self._idle else None
+        if ctx is None:
+            ctx = self.vm.create_context()
+        try:
+            yield ctx
+        finally:
+            with self._lock:
+                if self.max_idle is None or len(self._idle) < self.max_idle:
+                    self._idle.append(ctx)
+
+    def num_idle(self) -> int:
+        """The number of idle contexts in the pool."""
+        with self._lock:
+            return len(self._idle)
+
+
 @register_global_func("vm.builtin.debug_print")
 def _print(lineo: str, array) -> None:
     print(f"{lineo}: shape = {array.shape}, dtype = {array.dtype}, data =\n{array}")
@@ -23,3 +23,4 @@ and then export
 
 from .builder import Builder, BuilderInput, BuilderResult, PyBuilder, create
 from .local_builder import LocalBuilder
+from .rpc_builder import RPCBuilder, start_builder_server
@@ -116,7 +116,7 @@ class BuilderResult(Object):
 class Builder(Object):
     """The abstract builder interface."""
 
-    BuilderType = Union["Builder", Literal["local"]]
+    BuilderType = Union["Builder", Literal["local", "rpc"]]
 
     def build(self, build_inputs: list[BuilderInput]) -> list[BuilderResult]:
         """Build the given inputs.
@@ -134,7 +134,7 @@ class Builder(Object):
 
     @staticmethod
     def create(  # pylint: disable=keyword-arg-before-vararg
-        kind: Literal["local"] = "local",
+        kind: Literal["local", "rpc"] = "local",
         *args,
         **kwargs,
     ) -> "Builder":
@@ -142,18 +142,20 @@ class Builder(Object):
 
         Parameters
         ----------
-        kind : Literal["local"]
-            The kind of the builder. For now, only "local" is supported.
+        kind : Literal["local", "rpc"]
+            The kind of the builder. "local" and "rpc" are supported.
 
         Returns
         -------
         builder : Builder
             The builder created.
         """
-        from . import LocalBuilder  # pylint: disable=import-outside-toplevel
+        from . import LocalBuilder, RPCBuilder  # pylint: disable=import-outside-toplevel
 
         if kind == "local":
             return LocalBuilder(*args, **kwargs)  # type: ignore
+        if kind == "rpc":
+            return RPCBuilder(*args, **kwargs)  # type: ignore
         raise ValueError(f"Unknown Builder: {kind}")
 
 
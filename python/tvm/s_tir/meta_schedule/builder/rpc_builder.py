@@ -0,0 +1,243 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""RPC builder that compiles on a fleet of builder hosts behind the RPC tracker"""
+
+import concurrent.futures
+import os
+import tempfile
+
+from tvm_ffi import register_global_func
+
+from tvm.error import RPCError
+from tvm.ir import load_json, save_json
+from tvm.ir.utils import derived_object
+
+from ..logging import get_logger
+from ..runner.config import RPCConfig
+from ..utils import get_global_func_with_default_on_worker
+from .builder import BuilderInput, BuilderResult, PyBuilder
+from .local_builder import (
+    T_BUILD,
+    T_EXPORT,
+    _deserialize_params,
+    _serialize_params,
+    default_build,
+    default_export,
+)
+
+logger = get_logger(__name__)  # pylint: disable=invalid-name
+
+REMOTE_BUILD_FUNC = "s_tir.meta_schedule.builder.remote_build"
+
+
+@derived_object
+class RPCBuilder(PyBuilder):
+    """A builder that sends the given inputs to the builder hosts registered in the RPC tracker.
+
+    Each input is built in its own session, requested from the tracker under the key of the
+    builders, so that the tracker queues the builds of all the tuning processes that share the
+    fleet. A build that fails because its host or session was lost is retried on another host,
+    while a build that fails to compile is reported in the result.
+
+    Parameters
+    ----------
+    rpc_config : RPCConfig
+        The RPC configuration, whose tracker key refers to the builder hosts.
+    max_workers : int
+        The max number of concurrent builds.
+    max_retries : int
+        The max number of times to retry a build whose session is lost.
+    f_build : Union[None, str, T_BUILD]
+        Name of the build function to be used on the builder hosts.
+        Defaults to `meta_schedule.builder.default_build`.
+    f_export : Union[None, str, T_EXPORT]
+        Name of the export function to be used on the builder hosts.
+        Defaults to `meta_schedule.builder.default_export`.
+
+    Note
+    ----
+    A builder host is an RPC server started by `start_builder_server`, which registers the
+    remote build function.
+    """
+
+    rpc_config: RPCConfig
+    max_workers: int
+    max_retries: int
+    f_build: str | None
+    f_export: str | None
+
+    def __init__(
+        self,
+        rpc_config: RPCConfig | None = None,
+        *,
+        max_workers: int = 8,
+        max_retries: int = 2,
+        f_build: str | None = None,
+        f_export: str | None = None,
+    ) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        rpc_config : Optional[RPCConfig]
+            The RPC configuration, whose tracker key refers to the builder hosts.
+        max_workers : int
+            The max number of concurrent builds.
+        max_retries : int
+            The max number of times to retry a build whose session is lost.
+        f_build : Optional[str]
+            Name of the build function to be used on the builder hosts.
+        f_export : Optional[str]
+            Name of the export function to be used on the builder hosts.
+        """
+        super().__init__()
+        self.rpc_config = RPCConfig._normalized(rpc_config)
+        self.max_workers = max_workers
+        self.max_retries = max_retries
+        self.f_build = f_build
+        self.f_export = f_export
+        logger.info("RPCBuilder: max_workers = %d", max_workers)
+
+    def build(self, build_inputs: list[BuilderInput]) -> list[BuilderResult]:
+        with concurrent.futures.ThreadPoolExecutor(max_workers=self.max_workers) as pool:
+            return list(pool.map(self._build_one, build_inputs))
+
+    def _build_one(self, build_input: BuilderInput) -> BuilderResult:
+        mod_json = save_json(build_input.mod)
+        target_json = save_json(build_input.target)
+        params = _serialize_params(build_input.params) or bytearray()
+        error_msg = ""
+        for attempt in range(self.max_retries + 1):
+            try:
+                session = self.rpc_config.connect_server()
+                f_remote_build = session.get_function(REMOTE_BUILD_FUNC)
+            except Exception as exception:  # pylint: disable=broad-except
+                error_msg = "RPCBuilder: Cannot connect to a builder host\n" + str(exception)
+                logger.warning("Attempt %d: %s", attempt, error_msg)
+                continue
+            try:
+                artifact = f_remote_build(
+                    mod_json, target_json, params, self.f_build or "", self.f_export or ""
+                )
+            except (RPCError, ConnectionError, TimeoutError) as exception:
+                error_msg = "RPCBuilder: The builder session is lost\n" + str(exception)
+                logger.warning("Attempt %d: %s", attempt, error_msg)
+                continue
+            except Exception as exception:  # pylint: disable=broad-except
+                return BuilderResult(None, "RPCBuilder: An exception occurred\n" + str(exception))
+            return BuilderResult(_save_artifact(bytes(artifact)), None)
+        return BuilderResult(None, error_msg)
+
+
+def _save_artifact(artifact: bytes) -> str:
+    from tvm.support.tar import tar  # pylint: disable=import-outside-toplevel
+
+    artifact_path = os.path.join(tempfile.mkdtemp(), "tvm_tmp_mod." + tar.output_format)
+    with open(artifact_path, "wb") as file:
+        file.write(artifact)
+    return artifact_path
+
+
+@register_global_func(REMOTE_BUILD_FUNC)
+def remote_build(
+    mod_json: str,
+    target_json: str,
+    params: bytearray,
+    f_build_name: str,
+    f_export_name: str,
+) -> bytearray:
+    """Build a module on a builder host, and return the content of the exported artifact.
+
+    Parameters
+    ----------
+    mod_json : str
+        The IRModule to be built, in JSON.
+    target_json : str
+        The target to be built for, in JSON.
+    params : bytearray
+        The serialized parameters, empty if there are none.
+    f_build_name : str
+        Name of the build function, empty for the default one.
+    f_export_name : str
+        Name of the export function, empty for the default one.
+
+    Returns
+    -------
+    artifact : bytearray
+        The content of the exported artifact.
+    """
+    f_build: T_BUILD = get_global_func_with_default_on_worker(f_build_name or None, default_build)
+    f_export: T_EXPORT = get_global_func_with_default_on_worker(
+        f_export_name or None, default_export
+    )
+    rt_mod = f_build(
+        load_json(mod_json), load_json(target_json), _deserialize_params(params or None)
+    )
+    artifact_path = f_export(rt_mod)
+    try:
+        with open(artifact_path, "rb") as file:
+            return bytearray(file.read())
+    finally:
+        os.remove(artifact_path)
+        os.rmdir(os.path.dirname(artifact_path))
+
+
+def _builder_server_init() -> None:
+    # pylint: disable=import-outside-toplevel,unused-import
+    import tvm.s_tir.meta_schedule.builder.rpc_builder
+
+
+def start_builder_server(
+    tracker_host: str,
+    tracker_port: int,
+    tracker_key: str = "builder",
+    host: str = "0.0.0.0",
+    port: int = 9090,
+    port_end: int = 9199,
+):
+    """Start a builder host that registers to the RPC tracker.
+
+    Parameters
+    ----------
+    tracker_host : str
+        The host of the RPC tracker.
+    tracker_port : int
+        The port of the RPC tracker.
+    tracker_key : str
+        The key of the builder hosts in the tracker.
+    host : str
+        The host of the server.
+    port : int
+        The first port to try for the server.
+    port_end : int
+        The last port to try for the server.
+
+    Returns
+    -------
+    server : tvm.rpc.Server
+        The server, which stops when it is deleted.
+    """
+    from tvm.rpc.server import Server  # pylint: disable=import-outside-toplevel
+
+    return Server(
+        host=host,
+        port=port,
+        port_end=port_end,
+        tracker_addr=(tracker_host, tracker_port),
+        key=tracker_key,
+        server_init_callback=_builder_server_init,
+    )
@@ -41,7 +41,7 @@ from ..tune_context import TuneContext
 class CostModel(Object):
     """Cost model."""
 
-    CostModelType = Union["CostModel", Literal["xgb", "mlp", "random"]]
+    CostModelType = Union["CostModel", Literal["xgb", "gbdt", "mlp", "random"]]
 
     def load(self, path: str) -> None:
         """Load the cost model from given file location.
@@ -109,7 +109,7 @@ class CostModel(Object):
 
     @staticmethod
     def create(
-        kind: Literal["xgb", "mlp", "random", "none"],
+        kind: Literal["xgb", "gbdt", "mlp", "random", "none"],
         *args,
         **kwargs,
     ) -> "CostModel":
@@ -117,15 +117,19 @@ class CostModel(Object):
 
         Parameters
         ----------
-        kind : Literal["xgb", "mlp", "random", "none"]
-            The kind of the cost model. Can be "xgb", "mlp", "random" or "none".
+        kind : Literal["xgb", "gbdt", "mlp", "random", "none"]
+            The kind of the cost model. Can be "xgb", "gbdt", "mlp", "random" or "none".
 
         Returns
         -------
         cost_model : CostModel
             The created cost model.
         """
-        from . import RandomModel, XGBModel  # pylint: disable=import-outside-toplevel
+        from . import (  # pylint: disable=import-outside-toplevel
+            GBDTModel,
+            RandomModel,
+            XGBModel,
+        )
 
         if kind == "xgb":
             return XGBModel(*args, **kwargs)  # type: ignore
@@ -137,6 +141,8 @@ class CostModel(Object):
             if param in kwargs:
                 kwargs.pop(param)
 
+        if kind == "gbdt":
+            return GBDTModel(*args, **kwargs)  # type: ignore
         if kind == "random":
             return RandomModel(*args, **kwargs)  # type: ignore
         if kind == "mlp":
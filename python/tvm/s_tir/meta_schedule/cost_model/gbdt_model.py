@@ -0,0 +1,106 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Native gradient-boosted decision tree cost model."""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from ..feature_extractor import FeatureExtractor
+from .cost_model import CostModel
+
+
+@register_object("s_tir.meta_schedule.GBDTModel")
+class GBDTModel(CostModel):
+    """A gradient-boosted decision tree cost model trained and evaluated in C++.
+
+    It optimizes the same objective as XGBModel, but the features of the candidates never leave
+    C++, and prediction runs on all tuning threads without taking the GIL.
+
+    Parameters
+    ----------
+    extractor : FeatureExtractor.FeatureExtractorType
+        The feature extractor for the model.
+    max_depth : int
+        The maximum depth of a tree.
+    eta : float
+        The learning rate.
+    gamma : float
+        The minimum gain of a split.
+    min_child_weight : float
+        The minimum sum of hessians of a child of a split.
+    reg_lambda : float
+        The L2 regularization of the output of a leaf.
+    max_num_trees : int
+        The maximum number of trees when the model is trained from scratch.
+    early_stopping_rounds : int
+        The number of rounds without improvement of the training error to stop training after.
+    num_incremental_trees : int
+        The number of trees added to the model on an update that does not retrain it.
+    num_warmup_samples : int
+        The number of samples before which random scores are predicted.
+    adaptive_training : bool
+        Whether to retrain from scratch only when the data grows by more than 20%.
+    seed : int
+        The random seed of the scores predicted during warm-up.
+    """
+
+    extractor: FeatureExtractor
+    max_depth: int
+    eta: float
+    gamma: float
+    min_child_weight: float
+    reg_lambda: float
+    max_num_trees: int
+    early_stopping_rounds: int
+    num_incremental_trees: int
+    num_warmup_samples: int
+    adaptive_training: bool
+    data_size: int
+
+    def __init__(
+        self,
+        *,
+        extractor: FeatureExtractor.FeatureExtractorType = "per-store-feature",
+        max_depth: int = 10,
+        eta: float = 0.2,
+        gamma: float = 0.001,
+        min_child_weight: float = 0.0,
+        reg_lambda: float = 1.0,
+        max_num_trees: int = 1000,
+        early_stopping_rounds: int = 50,
+        num_incremental_trees: int = 10,
+        num_warmup_samples: int = 100,
+        adaptive_training: bool = True,
+        seed: int = 43,
+    ):
+        if not isinstance(extractor, FeatureExtractor):
+            extractor = FeatureExtractor.create(extractor)
+        self.__init_handle_by_constructor__(
+            _ffi_api.CostModelGBDTModel,  # type: ignore # pylint: disable=no-member
+            extractor,
+            max_depth,
+            eta,
+            gamma,
+            min_child_weight,
+            reg_lambda,
+            max_num_trees,
+            early_stopping_rounds,
+            num_incremental_trees,
+            num_warmup_samples,
+            adaptive_training,
+            seed,
+        )
@@ -32,6 +32,7 @@ from ....runtime import Tensor
 from ..cost_model import PyCostModel
 from ..feature_extractor import FeatureExtractor
 from ..logging import get_logger
+from ..profiler import Profiler
 from ..runner import RunnerResult
 from ..search_strategy import MeasureCandidate
 from ..utils import cpu_count, shash2hex
@@ -549,7 +550,8 @@ class XGBModel(PyCostModel):
             ]
             cost_ratios = np.concatenate(cost_ratio_list, axis=0)
 
-        self._train(xs=feature_list, ys=cost_ratios)
+        with Profiler.timeit("XGBModel/Train"):
+            self._train(xs=feature_list, ys=cost_ratios)
 
     def predict(
         self,
@@ -571,15 +573,15 @@ class XGBModel(PyCostModel):
             The predicted normalized score.
         """
         if self.data_size >= self.num_warmup_samples and self.booster is not None:
-            ret = self._predict(
-                xs=[
-                    x.numpy().astype("float32")
-                    for x in self.extractor.extract_from(
-                        context,
-                        candidates,
-                    )
-                ]
-            )
+            xs = [
+                x.numpy().astype("float32")
+                for x in self.extractor.extract_from(
+                    context,
+                    candidates,
+                )
+            ]
+            with Profiler.timeit("XGBModel/Predict"):
+                ret = self._predict(xs=xs)
         else:
             ret = np.random.uniform(
                 low=0,
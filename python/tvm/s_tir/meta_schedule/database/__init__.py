@@ -20,9 +20,11 @@ The tvm.s_tir.meta_schedule.database package.
 The database that stores serialized tuning records and workloads
 """
 
+from .binary_database import BinaryDatabase, convert_json_to_binary
 from .database import Database, PyDatabase, TuningRecord, Workload, create
 from .json_database import JSONDatabase
 from .memory_database import MemoryDatabase
 from .ordered_union_database import OrderedUnionDatabase
 from .schedule_fn_database import ScheduleFnDatabase
+from .sharded_json_database import ShardedJSONDatabase
 from .union_database import UnionDatabase
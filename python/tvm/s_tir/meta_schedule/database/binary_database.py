@@ -0,0 +1,84 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""The database in a binary file with lazily decoded tuning records"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .database import Database
+
+
+@register_object("s_tir.meta_schedule.BinaryDatabase")
+class BinaryDatabase(Database):
+    """Database class backed by a single binary file.
+
+    The file stores the run times of each tuning record in binary, so that loading only indexes
+    the records. The trace, the target and the argument information of a record are decoded the
+    first time the record is returned. Use `convert_json_to_binary` to convert a `JSONDatabase`.
+
+    Parameters
+    ----------
+    path : str
+        The path to the database file.
+    module_equality : Optional[str]
+        A string to specify the module equality testing and hashing method.
+        See `JSONDatabase` for the supported methods.
+    """
+
+    path: str
+
+    def __init__(
+        self,
+        path: str,
+        *,
+        allow_missing: bool = True,
+        module_equality: str = "structural",
+    ) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        path : str
+            The path to the database file.
+        allow_missing : bool
+            Whether to create new file when the given path is not found.
+        module_equality : str
+            A string to specify the module equality testing and hashing method.
+        """
+        self.__init_handle_by_constructor__(
+            _ffi_api.DatabaseBinaryDatabase,  # type: ignore # pylint: disable=no-member
+            path,
+            allow_missing,
+            module_equality,
+        )
+
+
+def convert_json_to_binary(path_workload: str, path_tuning_record: str, path: str) -> None:
+    """Convert the files of a `JSONDatabase` to the file of a `BinaryDatabase`.
+
+    Parameters
+    ----------
+    path_workload : str
+        The path to the workload table of the JSON database.
+    path_tuning_record : str
+        The path to the tuning record table of the JSON database.
+    path : str
+        The path to the binary database file to write.
+    """
+    _ffi_api.DatabaseConvertJSONToBinary(  # type: ignore # pylint: disable=no-member
+        path_workload, path_tuning_record, path
+    )
@@ -380,7 +380,8 @@ class Database(Object):
     @staticmethod
     def create(  # pylint: disable=keyword-arg-before-vararg
         kind: (
-            Literal["json", "memory", "union", "ordered_union"] | Callable[[Schedule], bool]
+            Literal["json", "sharded_json", "binary", "memory", "union", "ordered_union"]
+            | Callable[[Schedule], bool]
         ) = "json",
         *args,
         **kwargs,
@@ -389,10 +390,11 @@ class Database(Object):
 
         Parameters
         ----------
-        kind : str = "json" | "memory" | "union" | "ordered_union" | Callable[[tvm.s_tir.Schedule],
-        bool]
+        kind : str = "json" | "sharded_json" | "binary" | "memory" | "union" | "ordered_union" |
+        Callable[[tvm.s_tir.Schedule], bool]
             The kind of the database to be created. The following kinds are supported:
-            "json", "memory", "union", "ordered_union", and a custom schedule function.
+            "json", "sharded_json", "binary", "memory", "union", "ordered_union", and a custom
+            schedule function.
 
         Returns
         -------
@@ -400,10 +402,12 @@ class Database(Object):
             The created database.
         """
         from . import (  # pylint: disable=import-outside-toplevel
+            BinaryDatabase,
             JSONDatabase,
             MemoryDatabase,
             OrderedUnionDatabase,
             ScheduleFnDatabase,
+            ShardedJSONDatabase,
             UnionDatabase,
         )
 
@@ -411,6 +415,10 @@ class Database(Object):
             return ScheduleFnDatabase(kind, *args, **kwargs)  # type: ignore
         if kind == "json":
             return JSONDatabase(*args, **kwargs)
+        if kind == "binary":
+            return BinaryDatabase(*args, **kwargs)
+        if kind == "sharded_json":
+            return ShardedJSONDatabase(*args, **kwargs)
         if kind == "memory":
             return MemoryDatabase(*args, **kwargs)  # type: ignore
         if kind == "union":
@@ -0,0 +1,75 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""A database that shards its tuning records over the JSON files of a directory"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .database import Database
+
+
+@register_object("s_tir.meta_schedule.ShardedJSONDatabase")
+class ShardedJSONDatabase(Database):
+    """Database class backed by JSON files sharded by workload hash.
+
+    A shard is only read the first time one of its workloads is looked up, and its records are
+    indexed by workload and sorted by mean run time. The files are append-only, and concurrent
+    tuners can commit to the same directory.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the shards.
+    num_shards : int
+        The number of shards.
+    module_equality : Optional[str]
+        A string to specify the module equality testing and hashing method.
+        See `JSONDatabase` for the supported methods.
+    """
+
+    path: str
+    num_shards: int
+
+    def __init__(
+        self,
+        path: str,
+        num_shards: int = 64,
+        *,
+        allow_missing: bool = True,
+        module_equality: str = "structural",
+    ) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        path : str
+            The directory of the shards.
+        num_shards : int
+            The number of shards. A directory must always be opened with the same number of
+            shards.
+        allow_missing : bool
+            Whether to create the directory when it is not found.
+        module_equality : str
+            A string to specify the module equality testing and hashing method.
+        """
+        self.__init_handle_by_constructor__(
+            _ffi_api.DatabaseShardedJSONDatabase,  # type: ignore # pylint: disable=no-member
+            path,
+            num_shards,
+            allow_missing,
+            module_equality,
+        )
@@ -39,6 +39,9 @@ class PerStoreFeature(FeatureExtractor):
         The number of bytes in a cache line.
     extract_workload : bool
         Whether to extract features in the workload in tuning context or not.
+    cache_size : int
+        The number of scheduled modules whose features are cached and reused when the same
+        candidate is seen again. 0 disables the cache.
     """
 
     buffers_per_store: int
@@ -49,6 +52,8 @@ class PerStoreFeature(FeatureExtractor):
     """The number of bytes in a cache line."""
     extract_workload: bool
     """Whether to extract features in the workload in tuning context or not."""
+    cache_size: int
+    """The number of scheduled modules whose features are cached."""
     feature_vector_length: int
     """Length of the feature vector."""
 
@@ -58,6 +63,7 @@ class PerStoreFeature(FeatureExtractor):
         arith_intensity_curve_num_samples: int = 10,
         cache_line_bytes: int = 64,
         extract_workload: bool = False,
+        cache_size: int = 1024,
     ):
         self.__init_handle_by_constructor__(
             _ffi_api.FeatureExtractorPerStoreFeature,  # type: ignore # pylint: disable=no-member
@@ -65,4 +71,5 @@ class PerStoreFeature(FeatureExtractor):
             arith_intensity_curve_num_samples,
             cache_line_bytes,
             extract_workload,
+            cache_size,
         )
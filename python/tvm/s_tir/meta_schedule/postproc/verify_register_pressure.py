@@ -0,0 +1,39 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""A postprocessor that verifies if the register pressure fits the target"""
+
+from tvm_ffi.registry import register_object
+
+from .. import _ffi_api
+from .postproc import Postproc
+
+
+@register_object("s_tir.meta_schedule.VerifyRegisterPressure")
+class VerifyRegisterPressure(Postproc):
+    """A postprocessor that verifies if the estimated register pressure of the lowered code fits
+    the registers of the target. The auto-unroll steps of the schedule are halved until it fits,
+    and candidates that still spill without unrolling are rejected.
+
+    GPUs use the "registers_per_block" attribute of the target, shared by the threads of a block
+    and capped at 255 per thread. CPUs use "num-vector-registers" when set, otherwise 32 on
+    AVX-512, AArch64 and RISC-V V, and 16 elsewhere.
+    """
+
+    def __init__(self) -> None:
+        self.__init_handle_by_constructor__(
+            _ffi_api.PostprocVerifyRegisterPressure,  # type: ignore # pylint: disable=no-member
+        )
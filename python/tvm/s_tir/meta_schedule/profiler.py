@@ -44,6 +44,22 @@ class Profiler(Object):
         """Get the profiling results in a table format"""
         return _ffi_api.ProfilerTable(self)  # type: ignore # pylint: disable=no-member
 
+    def chrome_trace(self) -> str:
+        """Get the timed scopes of every thread in the Chrome trace event format, attributed to
+        the tasks being tuned. It can be loaded in Perfetto or chrome://tracing."""
+        return _ffi_api.ProfilerChromeTrace(self)  # type: ignore # pylint: disable=no-member
+
+    def export_chrome_trace(self, path: str) -> None:
+        """Write the timed scopes to a file in the Chrome trace event format
+
+        Parameters
+        ----------
+        path : str
+            The path of the JSON file.
+        """
+        with open(path, "w", encoding="utf-8") as file:
+            file.write(self.chrome_trace())
+
     def __enter__(self) -> "Profiler":
         """Entering the scope of the context manager"""
         _ffi_api.ProfilerEnterWithScope(self)  # type: ignore # pylint: disable=no-member
@@ -72,3 +88,18 @@ class Profiler(Object):
                     f()
 
         return _timeit()
+
+    @staticmethod
+    def task(name: str):
+        """Attribute the scopes timed in a block of code to a task"""
+
+        @contextmanager
+        def _task():
+            try:
+                f = _ffi_api.ProfilerTaskScope(name)  # type: ignore # pylint: disable=no-member
+                yield
+            finally:
+                if f:
+                    f()
+
+        return _task()
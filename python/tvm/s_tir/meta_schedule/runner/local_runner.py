@@ -18,7 +18,9 @@
 
 import logging
 import subprocess
+import threading
 from collections.abc import Callable
+from concurrent.futures import ThreadPoolExecutor
 from contextlib import contextmanager
 
 import tvm
@@ -123,6 +125,7 @@ def _worker_func(
     alloc_repeat: int,
     artifact_path: str,
     device_type: str,
+    device_id: int,
     args_info: T_ARG_INFO_JSON_OBJ_LIST,
 ) -> list[float]:
     f_alloc_argument: T_ALLOC_ARGUMENT = get_global_func_with_default_on_worker(
@@ -148,7 +151,7 @@ def _worker_func(
             rt_mod = tvm.runtime.load_module(artifact_path)
         # Step 2: Allocate input arguments
         with Profiler.timeit("LocalRunner/alloc_argument"):
-            device = tvm.runtime.device(device_type, 0)
+            device = tvm.runtime.device(device_type, device_id)
             repeated_args: list[T_ARGUMENT_LIST] = f_alloc_argument(
                 device,
                 args_info,
@@ -183,8 +186,12 @@ class LocalRunner(PyRunner):
         The function name to run the evaluator or the function itself.
     f_cleanup: Optional[str, Callable]
         The function name to cleanup the session or the function itself.
+    device_ids: List[int]
+        The local devices to measure on, with one worker pinned to each device.
+    pools: List[PopenPoolExecutor]
+        The popen pool executor of each device.
     pool: PopenPoolExecutor
-        The popen pool executor.
+        The popen pool executor of the first device.
 
     Attributes
     ----------
@@ -231,6 +238,8 @@ class LocalRunner(PyRunner):
     f_run_evaluator: T_RUN_EVALUATOR | str | None
     f_cleanup: T_CLEANUP | str | None
 
+    device_ids: list[int]
+    pools: list[PopenPoolExecutor]
     pool: PopenPoolExecutor
 
     def __init__(
@@ -243,6 +252,7 @@ class LocalRunner(PyRunner):
         f_run_evaluator: T_RUN_EVALUATOR | str | None = None,
         f_cleanup: T_CLEANUP | str | None = None,
         initializer: Callable[[], None] | None = None,
+        device_ids: list[int] | None = None,
     ) -> None:
         """Constructor
 
@@ -264,6 +274,10 @@ class LocalRunner(PyRunner):
             The function name to cleanup the session or the function itself.
         initializer: Optional[Callable[[], None]]
             The initializer function.
+        device_ids: Optional[List[int]]
+            The local devices to measure on, e.g. `list(range(8))` for the 8 GPUs of a host.
+            Each device gets a worker that runs its candidates one at a time, and the
+            candidates of a batch go to whichever device is free next. Defaults to device 0.
         """
         super().__init__()
         self.timeout_sec = timeout_sec
@@ -278,41 +292,68 @@ class LocalRunner(PyRunner):
         if logger.root.level <= logging.DEBUG:
             err_path = subprocess.STDOUT
 
-        logger.info("LocalRunner: max_workers = 1")
-        self.pool = PopenPoolExecutor(
-            max_workers=1,  # one local worker
-            timeout=timeout_sec,
-            initializer=initializer,
-            stderr=err_path,  # suppress the stderr output
-        )
+        self.device_ids = list(device_ids) if device_ids is not None else [0]
+        if not self.device_ids:
+            raise ValueError("LocalRunner: device_ids must not be empty")
+
+        logger.info("LocalRunner: max_workers = %d", len(self.device_ids))
+        self.pools = [
+            PopenPoolExecutor(
+                max_workers=1,  # one local worker per device
+                timeout=timeout_sec,
+                initializer=initializer,
+                stderr=err_path,  # suppress the stderr output
+            )
+            for _ in self.device_ids
+        ]
+        self.pool = self.pools[0]
         self._sanity_check()
 
     def run(self, runner_inputs: list[RunnerInput]) -> list[RunnerFuture]:
-        results: list[RunnerFuture] = []
-        for runner_input in runner_inputs:
-            future = self.pool.submit(
-                _worker_func,
-                self.f_alloc_argument,
-                self.f_run_evaluator,
-                self.f_cleanup,
-                self.evaluator_config,
-                self.alloc_repeat,
-                str(runner_input.artifact_path),
-                str(runner_input.device_type),
-                tuple(arg_info.as_json() for arg_info in runner_input.args_info),
-            )
-            try:
-                result: list[float] = future.result()
-                error_message: str = None
-            except TimeoutError:
-                result = None
-                error_message = f"LocalRunner: Timeout, killed after {self.timeout_sec} seconds\n"
-            except Exception as exception:  # pylint: disable=broad-except
-                result = None
-                error_message = "LocalRunner: An exception occurred\n" + str(exception)
-            local_future = LocalRunnerFuture(res=result, error_message=error_message)
-            results.append(local_future)  # type: ignore
-        return results
+        if len(self.pools) == 1:
+            return [self._run_on(0, runner_input) for runner_input in runner_inputs]
+
+        # Each device takes the next candidate when it is free, and the results
+        # keep the order of the inputs.
+        results: list[RunnerFuture | None] = [None] * len(runner_inputs)
+        pending = iter(range(len(runner_inputs)))
+        lock = threading.Lock()
+
+        def _drain(worker: int) -> None:
+            while True:
+                with lock:
+                    index = next(pending, None)
+                if index is None:
+                    return
+                results[index] = self._run_on(worker, runner_inputs[index])
+
+        with ThreadPoolExecutor(max_workers=len(self.pools)) as executor:
+            list(executor.map(_drain, range(len(self.pools))))
+        return results  # type: ignore
+
+    def _run_on(self, worker: int, runner_input: RunnerInput) -> RunnerFuture:
+        future = self.pools[worker].submit(
+            _worker_func,
+            self.f_alloc_argument,
+            self.f_run_evaluator,
+            self.f_cleanup,
+            self.evaluator_config,
+            self.alloc_repeat,
+            str(runner_input.artifact_path),
+            str(runner_input.device_type),
+            self.device_ids[worker],
+            tuple(arg_info.as_json() for arg_info in runner_input.args_info),
+        )
+        try:
+            result: list[float] = future.result()
+            error_message: str = None
+        except TimeoutError:
+            result = None
+            error_message = f"LocalRunner: Timeout, killed after {self.timeout_sec} seconds\n"
+        except Exception as exception:  # pylint: disable=broad-except
+            result = None
+            error_message = "LocalRunner: An exception occurred\n" + str(exception)
+        return LocalRunnerFuture(res=result, error_message=error_message)  # type: ignore
 
     def _sanity_check(self) -> None:
         def _check(
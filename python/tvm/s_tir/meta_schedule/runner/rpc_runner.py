@@ -21,6 +21,7 @@ import os.path as osp
 from collections.abc import Callable
 from contextlib import contextmanager
 
+from tvm.error import RPCError
 from tvm.ir.utils import derived_object
 from tvm.rpc import RPCSession
 from tvm.runtime import Device, Module
@@ -158,6 +159,10 @@ class RPCRunner(PyRunner):
         The function name to cleanup the session or the function itself.
     pool: PopenPoolExecutor
         The popen pool executor.
+    device_keys: Dict[str, str]
+        The tracker key of the devices of each device type, overriding the key of `rpc_config`.
+    max_retries: int
+        The max number of times to retry a measurement whose session is lost.
 
     Attributes
     ----------
@@ -232,6 +237,8 @@ class RPCRunner(PyRunner):
     f_cleanup: T_CLEANUP | str | None
 
     pool: PopenPoolExecutor
+    device_keys: dict[str, str]
+    max_retries: int
 
     def __init__(
         self,
@@ -246,6 +253,8 @@ class RPCRunner(PyRunner):
         f_cleanup: T_CLEANUP | str | None = None,
         max_workers: int | None = None,
         initializer: Callable[[], None] | None = None,
+        device_keys: dict[str, str] | None = None,
+        max_retries: int = 0,
     ) -> None:
         """Constructor
 
@@ -273,6 +282,12 @@ class RPCRunner(PyRunner):
             The maximum number of connections. Defaults to 1.
         initializer: Optional[Callable[[], None]]
             The initializer function.
+        device_keys: Optional[Dict[str, str]]
+            The tracker key of the devices of each device type, e.g. {"cuda": "a100"}. The
+            device types not listed use the tracker key of `rpc_config`.
+        max_retries: int
+            The max number of times to retry a measurement whose session is lost, each time on
+            a device that the tracker assigns anew.
         """
         super().__init__()
         self.rpc_config = RPCConfig._normalized(rpc_config)
@@ -284,6 +299,8 @@ class RPCRunner(PyRunner):
         self.f_alloc_argument = f_alloc_argument
         self.f_run_evaluator = f_run_evaluator
         self.f_cleanup = f_cleanup
+        self.device_keys = dict(device_keys or {})
+        self.max_retries = max_retries
         if max_workers is None:
             max_workers = 1
         logger.info("RPCRunner: max_workers = %d", max_workers)
@@ -304,18 +321,24 @@ class RPCRunner(PyRunner):
                     self.f_alloc_argument,
                     self.f_run_evaluator,
                     self.f_cleanup,
-                    self.rpc_config,
+                    self._rpc_config_of(str(runner_input.device_type)),
                     self.evaluator_config,
                     self.alloc_repeat,
                     str(runner_input.artifact_path),
                     str(runner_input.device_type),
                     tuple(arg_info.as_json() for arg_info in runner_input.args_info),
+                    self.max_retries,
                 ),
                 timeout_sec=self.rpc_config.session_timeout_sec,
             )
             results.append(future)  # type: ignore
         return results
 
+    def _rpc_config_of(self, device_type: str) -> RPCConfig:
+        if device_type in self.device_keys:
+            return self.rpc_config._replace(tracker_key=self.device_keys[device_type])
+        return self.rpc_config
+
     def _sanity_check(self) -> None:
         def _check(
             f_create_session,
@@ -353,6 +376,7 @@ def _worker_func(
     artifact_path: str,
     device_type: str,
     args_info: T_ARG_INFO_JSON_OBJ_LIST,
+    max_retries: int = 0,
 ) -> list[float]:
     # Step 0. Get the registered functions
     f_create_session: T_CREATE_SESSION = get_global_func_with_default_on_worker(
@@ -368,6 +392,41 @@ def _worker_func(
         _f_run_evaluator, default_run_evaluator
     )
     f_cleanup: T_CLEANUP = get_global_func_with_default_on_worker(_f_cleanup, default_cleanup)
+    args = (
+        f_create_session,
+        f_upload_module,
+        f_alloc_argument,
+        f_run_evaluator,
+        f_cleanup,
+        rpc_config,
+        evaluator_config,
+        alloc_repeat,
+        artifact_path,
+        device_type,
+        args_info,
+    )
+    # A lost session is retried on the device that the tracker assigns next.
+    for attempt in range(max_retries):
+        try:
+            return _run_on_session(*args)
+        except (RPCError, ConnectionError) as exception:
+            logger.warning("RPCRunner: Attempt %d lost its session: %s", attempt, exception)
+    return _run_on_session(*args)
+
+
+def _run_on_session(  # pylint: disable=too-many-arguments
+    f_create_session: T_CREATE_SESSION,
+    f_upload_module: T_UPLOAD_MODULE,
+    f_alloc_argument: T_ALLOC_ARGUMENT,
+    f_run_evaluator: T_RUN_EVALUATOR,
+    f_cleanup: T_CLEANUP,
+    rpc_config: RPCConfig,
+    evaluator_config: EvaluatorConfig,
+    alloc_repeat: int,
+    artifact_path: str,
+    device_type: str,
+    args_info: T_ARG_INFO_JSON_OBJ_LIST,
+) -> list[float]:
     # Managed resources
     session: RPCSession | None = None
     remote_path: str | None = None
@@ -392,7 +451,7 @@ def _worker_func(
             local_path: str = artifact_path
             rt_mod: Module = f_upload_module(session, local_path, remote_path)
         # Step 3: Allocate input arguments
-        with Profiler.timeit("RPCRunner/alloc_argument"):
+        with Profiler.timeit("RPCRunner/alloc_argument"), session.pipelined():
             repeated_args: list[T_ARGUMENT_LIST] = f_alloc_argument(
                 session,
                 device,
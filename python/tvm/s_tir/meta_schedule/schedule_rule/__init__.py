@@ -34,5 +34,8 @@ from .multi_level_tiling import (
     ReuseType,
 )
 from .parallel_vectorize_unroll import ParallelizeVectorizeUnroll
+from .prefetch_pipeline import PrefetchPipeline
 from .random_compute_location import RandomComputeLocation
 from .schedule_rule import PyScheduleRule, ScheduleRule
+from .split_k import SplitK
+from .vtcm_pipeline import VTCMPipeline
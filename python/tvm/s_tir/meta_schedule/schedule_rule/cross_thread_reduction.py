@@ -31,10 +31,16 @@ class CrossThreadReduction(ScheduleRule):
     ----------
     thread_extents: List[int]
         Candidates of thread axis extent (values are required to be positive).
+    cluster_extents: Optional[List[int]]
+        Candidates of the number of thread blocks of a cluster that reduce a long row together,
+        in [2, 8]. On sm_90 or higher, a reduction too long for one thread block is also split
+        across the thread blocks of a cluster, which combine their results through the
+        distributed shared memory. None disables it.
     """
 
-    def __init__(self, thread_extents: list[int]) -> None:
+    def __init__(self, thread_extents: list[int], cluster_extents: list[int] | None = None) -> None:
         self.__init_handle_by_constructor__(
             _ffi_api.ScheduleRuleCrossThreadReduction,  # type: ignore # pylint: disable=no-member
             thread_extents,
+            cluster_extents or [],
         )
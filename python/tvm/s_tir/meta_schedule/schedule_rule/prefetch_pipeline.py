@@ -0,0 +1,44 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Rule that pipelines the reduction loop of tiled CPU blocks with software prefetches"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .schedule_rule import ScheduleRule
+
+
+@register_object("s_tir.meta_schedule.PrefetchPipeline")
+class PrefetchPipeline(ScheduleRule):
+    """Rule that annotates the outermost reduction loop of blocks tiled by MultiLevelTiling for
+    CPU software pipelining, so that InjectSoftwarePipeline prefetches the data read by later
+    iterations. The unannotated schedule is kept as a candidate as well.
+
+    Parameters
+    ----------
+    prefetch_distances: Optional[List[int]]
+        The candidate numbers of iterations to prefetch ahead.
+        Defaults to [1, 2].
+    """
+
+    def __init__(self, prefetch_distances: list[int] | None = None) -> None:
+        if prefetch_distances is None:
+            prefetch_distances = [1, 2]
+        self.__init_handle_by_constructor__(
+            _ffi_api.ScheduleRulePrefetchPipeline,  # type: ignore # pylint: disable=no-member
+            prefetch_distances,
+        )
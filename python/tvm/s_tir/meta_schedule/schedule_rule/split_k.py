@@ -0,0 +1,69 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Split-K Rule that splits the reduction of skinny GPU reductions across thread blocks"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .schedule_rule import ScheduleRule
+
+
+@register_object("s_tir.meta_schedule.SplitK")
+class SplitK(ScheduleRule):
+    """A schedule rule which splits the reduction of a GPU reduction block with little spatial
+    parallelism, e.g. a matmul with a few rows and a long reduction, across thread blocks.
+
+    The partial sums are computed by an rfactor block into an intermediate global buffer, and
+    reduced by the original block in a second kernel. With `stream_k_num_blocks`, a Stream-K
+    variant additionally distributes all the (output, split) pairs over a fixed grid of thread
+    blocks.
+
+    Parameters
+    ----------
+    split_factors: List[int]
+        Candidates of the number of thread blocks each reduction is split across.
+    thread_extents: List[int]
+        Candidates of thread axis extent (values are required to be positive).
+    min_reduction_extent: int
+        The minimum reduction extent for the rule to apply.
+    max_spatial_extent: int
+        The maximum spatial extent for the rule to apply.
+    stream_k_num_blocks: Optional[int] = None
+        The number of thread blocks of the Stream-K variant, usually the number of SMs. None
+        disables the variant.
+    """
+
+    def __init__(
+        self,
+        split_factors: list[int] | None = None,
+        thread_extents: list[int] | None = None,
+        min_reduction_extent: int = 1024,
+        max_spatial_extent: int = 4096,
+        stream_k_num_blocks: int | None = None,
+    ) -> None:
+        if split_factors is None:
+            split_factors = [4, 8, 16]
+        if thread_extents is None:
+            thread_extents = [32, 64, 128, 256]
+        self.__init_handle_by_constructor__(
+            _ffi_api.ScheduleRuleSplitK,  # type: ignore # pylint: disable=no-member
+            split_factors,
+            thread_extents,
+            min_reduction_extent,
+            max_spatial_extent,
+            stream_k_num_blocks,
+        )
@@ -0,0 +1,37 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Rule that stages the operands of tiled Hexagon blocks in VTCM with double-buffered DMA"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .schedule_rule import ScheduleRule
+
+
+@register_object("s_tir.meta_schedule.VTCMPipeline")
+class VTCMPipeline(ScheduleRule):
+    """Rule that caches the tiles read by each iteration of the outermost reduction loop of blocks
+    tiled by MultiLevelTiling into "global.vtcm", and marks the loop as a software pipeline whose
+    asynchronous copy stage overlaps with the compute on the resident tiles. The pipeline is
+    lowered to double-buffered DMA by LowerAsyncDMA when compiling with "tirx.use_async_copy".
+    The schedule without the pipeline is kept as a candidate as well.
+    """
+
+    def __init__(self) -> None:
+        self.__init_handle_by_constructor__(
+            _ffi_api.ScheduleRuleVTCMPipeline,  # type: ignore # pylint: disable=no-member
+        )
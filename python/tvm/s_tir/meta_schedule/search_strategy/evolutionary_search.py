@@ -46,6 +46,21 @@ class EvolutionarySearch(SearchStrategy):
         The maximum number to retry mutation.
     eps_greedy : float
         The ratio of greedy selected samples in the final picks.
+    warm_start_top_k : int
+        The number of best records taken from each workload in the database that has the same
+        anchor block as the tuned one, and transferred into the initial population. 0 disables
+        the warm start.
+    design_space_keep_ratio : float
+        The fraction of the design spaces kept for the search. Every design space is ranked by
+        the best score that the cost model predicts for its random samples, and the low scorers
+        are dropped before the search starts. 1.0 keeps all of them.
+    design_space_prune_samples : int
+        The number of random samples of each design space scored to rank them.
+
+    Note
+    ----
+    The schedules that the database already holds for the tuned workload are never measured
+    again.
     """
 
     population_size: int
@@ -55,6 +70,9 @@ class EvolutionarySearch(SearchStrategy):
     genetic_mutate_prob: float
     genetic_max_fail_count: int
     eps_greedy: float
+    warm_start_top_k: int
+    design_space_keep_ratio: float
+    design_space_prune_samples: int
 
     def __init__(
         self,
@@ -67,6 +85,9 @@ class EvolutionarySearch(SearchStrategy):
         genetic_mutate_prob: float = 0.85,
         genetic_max_fail_count: int = 10,
         eps_greedy: float = 0.05,
+        warm_start_top_k: int = 0,
+        design_space_keep_ratio: float = 1.0,
+        design_space_prune_samples: int = 8,
     ) -> None:
         """Constructor"""
         self.__init_handle_by_constructor__(
@@ -79,4 +100,7 @@ class EvolutionarySearch(SearchStrategy):
             genetic_mutate_prob,
             genetic_max_fail_count,
             eps_greedy,
+            warm_start_top_k,
+            design_space_keep_ratio,
+            design_space_prune_samples,
         )
@@ -200,6 +200,7 @@ class SearchStrategy(Object):
             "evolutionary",
             "replay-trace",
             "replay-func",
+            "transfer",
         ] = "evolutionary",
         *args,
         **kwargs,
@@ -209,6 +210,7 @@ class SearchStrategy(Object):
             EvolutionarySearch,
             ReplayFunc,
             ReplayTrace,
+            TransferSearch,
         )
 
         if kind == "evolutionary":
@@ -217,6 +219,8 @@ class SearchStrategy(Object):
             return ReplayTrace(*args, **kwargs)
         if kind == "replay-func":
             return ReplayFunc(*args, **kwargs)  # type: ignore
+        if kind == "transfer":
+            return TransferSearch(*args, **kwargs)
         raise ValueError(f"Unknown SearchStrategy: {kind}")
 
 
@@ -0,0 +1,70 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Transfer Search Strategy"""
+
+from tvm_ffi import register_object
+
+from .. import _ffi_api
+from .evolutionary_search import EvolutionarySearch
+from .search_strategy import SearchStrategy
+
+
+@register_object("s_tir.meta_schedule.TransferSearch")
+class TransferSearch(SearchStrategy):
+    """
+    Transfer Search Strategy reuses the tuning records of a shape variant of the workload, e.g.
+    another sequence length bucket of a dynamic-shape model. It finds the nearest tuned variant in
+    the database, measures its best schedules applied to the workload first, and then fine-tunes
+    around them with a small trial budget.
+
+    Parameters
+    ----------
+    fine_tune : Optional[SearchStrategy]
+        The strategy to fine-tune with, or to tune with when no shape variant is found.
+        EvolutionarySearch by default.
+    num_transfer_records : int
+        The number of the best records of the shape variant to transfer.
+    num_repair_trials : int
+        The number of attempts with re-sampled decisions when the decisions of a record do not fit
+        the new shape.
+    max_fine_tune_trials : int
+        The max number of fine-tuning trials after the transferred candidates.
+    """
+
+    fine_tune: SearchStrategy
+    num_transfer_records: int
+    num_repair_trials: int
+    max_fine_tune_trials: int
+
+    def __init__(
+        self,
+        fine_tune: SearchStrategy | None = None,
+        *,
+        num_transfer_records: int = 8,
+        num_repair_trials: int = 2,
+        max_fine_tune_trials: int = 64,
+    ) -> None:
+        """Constructor"""
+        if fine_tune is None:
+            fine_tune = EvolutionarySearch()
+        self.__init_handle_by_constructor__(
+            _ffi_api.SearchStrategyTransferSearch,  # type: ignore # pylint: disable=no-member
+            fine_tune,
+            num_transfer_records,
+            num_repair_trials,
+            max_fine_tune_trials,
+        )
@@ -35,6 +35,7 @@ class GradientBased(TaskScheduler):
         alpha: float = 0.2,
         window_size: int = 3,
         seed: int = -1,
+        pipeline_depth: int = 0,
     ) -> None:
         """Constructor.
 
@@ -46,6 +47,10 @@ class GradientBased(TaskScheduler):
             The parameter to control backward window size in gradient computation.
         seed : int = -1
             The random seed.
+        pipeline_depth : int = 0
+            The max number of batches in flight, 0 to disable the pipelined mode. In the
+            pipelined mode, tasks without a batch in flight are preferred, so that building one
+            task overlaps measuring the others.
         """
         self.__init_handle_by_constructor__(
             _ffi_api.TaskSchedulerGradientBased,  # type: ignore # pylint: disable=no-member
@@ -53,4 +58,5 @@ class GradientBased(TaskScheduler):
             alpha,
             window_size,
             seed,
+            pipeline_depth,
         )
@@ -29,9 +29,18 @@ logger = get_logger(__name__)  # pylint: disable=invalid-name
 class RoundRobin(TaskScheduler):
     """Round Robin Task Scheduler"""
 
-    def __init__(self) -> None:
-        """Constructor."""
+    def __init__(self, *, pipeline_depth: int = 0) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        pipeline_depth : int = 0
+            The max number of batches in flight, 0 to disable the pipelined mode. In the
+            pipelined mode, tasks without a batch in flight are preferred, so that building one
+            task overlaps measuring the others.
+        """
         self.__init_handle_by_constructor__(
             _ffi_api.TaskSchedulerRoundRobin,  # type: ignore # pylint: disable=no-member
             get_logging_func(logger),
+            pipeline_depth,
         )
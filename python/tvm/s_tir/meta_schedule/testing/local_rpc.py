@@ -16,6 +16,8 @@
 # under the License.
 """RPC tracker and server running locally"""
 
+from collections.abc import Callable
+
 from tvm.rpc.server import Server
 from tvm.rpc.tracker import Tracker
 
@@ -31,6 +33,8 @@ class LocalRPC:
         The port of the tracker
     tracker_key: str
         The key used in the tracker to refer to a worker
+    server_init_callback: Optional[Callable[[], None]]
+        The initialization function of the server
     """
 
     tracker_host: str
@@ -42,6 +46,7 @@ class LocalRPC:
         tracker_key: str = "key",
         silent: bool = False,
         no_fork: bool = False,
+        server_init_callback: Callable[[], None] | None = None,
     ) -> None:
         self.tracker = Tracker(
             silent=silent,
@@ -57,6 +62,7 @@ class LocalRPC:
             no_fork=no_fork,
             port=9190,
             port_end=12345,
+            server_init_callback=server_init_callback,
         )
         self.tracker_host = self.tracker.host
         self.tracker_port = self.tracker.port
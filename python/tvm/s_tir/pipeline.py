@@ -123,10 +123,16 @@ def default_s_tir_pipeline():
 
 def finalize_host_passes():  # pylint: disable=unused-argument
     """The default finalization passes for TIR backend."""
-    host_pass_list = [
-        tirx.transform.LowerTVMBuiltin(),
-        tirx.transform.LowerIntrin(),
-    ]
+    config = tvm.transform.PassContext.current().config
+    host_pass_list = []
+    if bool(config.get("tirx.static_workspace_plan", False)):
+        host_pass_list.append(tirx.transform.PlanStaticWorkspace())
+    host_pass_list.extend(
+        [
+            tirx.transform.LowerTVMBuiltin(),
+            tirx.transform.LowerIntrin(),
+        ]
+    )
     return tvm.ir.transform.Sequential(host_pass_list)
 
 
@@ -45,10 +45,13 @@ class ScheduleDebugMask(IntEnum):
         Verify the correctness of the sref tree
     VERIFY_CACHED_FLAGS : int = 2
         Verify the correctness of affine_binding, region_cover and stage_pipeline
+    VERIFY_SBLOCK_SCOPE : int = 4
+        Verify the dependencies of each block scope against a full recomputation
     """
 
     VERIFY_SREF_TREE = 1
     VERIFY_CACHED_FLAGS = 2
+    VERIFY_SBLOCK_SCOPE = 4
 
 
 def _parse_mod(mod: PrimFunc | IRModule) -> IRModule:
@@ -62,7 +65,11 @@ def _parse_mod(mod: PrimFunc | IRModule) -> IRModule:
 def _parse_debug_mask(debug_mask: str | int) -> int:
     if isinstance(debug_mask, str):
         if debug_mask == "all":
-            debug_mask = ScheduleDebugMask.VERIFY_SREF_TREE | ScheduleDebugMask.VERIFY_CACHED_FLAGS
+            debug_mask = (
+                ScheduleDebugMask.VERIFY_SREF_TREE
+                | ScheduleDebugMask.VERIFY_CACHED_FLAGS
+                | ScheduleDebugMask.VERIFY_SBLOCK_SCOPE
+            )
         elif debug_mask == "none":
             debug_mask = 0
         else:
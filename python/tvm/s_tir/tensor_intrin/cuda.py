@@ -38,6 +38,11 @@ def shared_16x32_to_ldmatrix_32x16_layout(i, j):
     return thread_id, 8 * (j // 16) + (i // 8) * 4 + j % 4
 
 
+def shared_16x64_to_ldmatrix_32x32_layout(i, j):
+    thread_id = 4 * (i % 8) + (j % 32) // 8
+    return thread_id, 16 * (j // 32) + (i // 8) * 8 + j % 8
+
+
 def shared_32x16_to_ldmatrix_32x16_layout(i, j):
     thread_id = (i % 16) // 4 + 4 * (j % 8)
     return thread_id, 8 * (j // 8) + (i // 16) * 4 + i % 4
@@ -120,6 +125,21 @@ def get_ldmatrix_intrin(
             smem_offset = lambda tx, stride: (
                 stride * (tx % HALF_WARP_expr) + 8 * (tx // HALF_WARP_expr)
             )
+    elif k_dim == 64:
+        # Sub-byte elements cannot be transposed by ldmatrix, so int4 only supports the "row.col"
+        # layout of mma.sync, i.e. A in [M, K] and B in [N, K].
+        assert dtype == "int4", "Only int4 is supported for k_dim == 64"
+        assert transposed == (matrix_name == "B"), "int4 matmul requires A in [M, K], B in [N, K]"
+        index_map = shared_16x64_to_ldmatrix_32x32_layout
+        # Every thread passes the address of one 16-byte row, i.e. 32 int4 elements.
+        if matrix_name == "B":
+            smem_offset = lambda tx, stride: (
+                stride * 8 * (tx // HALF_WARP_expr)
+                + (tx % 8) * stride
+                + 32 * ((tx % HALF_WARP_expr) // 8)
+            )
+        else:
+            smem_offset = lambda tx, stride: stride * (tx % 16) + 32 * (tx // 16)
     else:
         # TODO(yixin): Support TN and TT matmul for int8
         assert matrix_name == "B" or not transposed, (
@@ -285,6 +305,69 @@ TensorIntrin.register(
     LDMATRIX_e5m2_B_TRANS_INTRIN, *get_ldmatrix_intrin(32, "float8_e5m2", "B", True)
 )
 
+LDMATRIX_i4_A_INTRIN = "mma_ldmatrix_i4_a"
+TensorIntrin.register(LDMATRIX_i4_A_INTRIN, *get_ldmatrix_intrin(64, "int4", "A", False))
+
+LDMATRIX_i4_B_TRANS_INTRIN = "mma_ldmatrix_i4_b_trans"
+TensorIntrin.register(LDMATRIX_i4_B_TRANS_INTRIN, *get_ldmatrix_intrin(64, "int4", "B", True))
+
+LDMATRIX_i8_A_DYN_INTRIN = "mma_ldmatrix_i8_a_dyn"
+TensorIntrin.register(
+    LDMATRIX_i8_A_DYN_INTRIN, *get_ldmatrix_intrin(32, "int8", "A", False, "shared.dyn")
+)
+
+LDMATRIX_i8_B_DYN_INTRIN = "mma_ldmatrix_i8_b_dyn"
+TensorIntrin.register(
+    LDMATRIX_i8_B_DYN_INTRIN, *get_ldmatrix_intrin(32, "int8", "B", False, "shared.dyn")
+)
+
+LDMATRIX_i8_B_TRANS_DYN_INTRIN = "mma_ldmatrix_i8_b_trans_dyn"
+TensorIntrin.register(
+    LDMATRIX_i8_B_TRANS_DYN_INTRIN, *get_ldmatrix_intrin(32, "int8", "B", True, "shared.dyn")
+)
+
+LDMATRIX_e4m3_A_DYN_INTRIN = "mma_ldmatrix_e4m3_a_dyn"
+TensorIntrin.register(
+    LDMATRIX_e4m3_A_DYN_INTRIN, *get_ldmatrix_intrin(32, "float8_e4m3fn", "A", False, "shared.dyn")
+)
+
+LDMATRIX_e4m3_B_DYN_INTRIN = "mma_ldmatrix_e4m3_b_dyn"
+TensorIntrin.register(
+    LDMATRIX_e4m3_B_DYN_INTRIN, *get_ldmatrix_intrin(32, "float8_e4m3fn", "B", False, "shared.dyn")
+)
+
+LDMATRIX_e4m3_B_TRANS_DYN_INTRIN = "mma_ldmatrix_e4m3_b_trans_dyn"
+TensorIntrin.register(
+    LDMATRIX_e4m3_B_TRANS_DYN_INTRIN,
+    *get_ldmatrix_intrin(32, "float8_e4m3fn", "B", True, "shared.dyn"),
+)
+
+LDMATRIX_e5m2_A_DYN_INTRIN = "mma_ldmatrix_e5m2_a_dyn"
+TensorIntrin.register(
+    LDMATRIX_e5m2_A_DYN_INTRIN, *get_ldmatrix_intrin(32, "float8_e5m2", "A", False, "shared.dyn")
+)
+
+LDMATRIX_e5m2_B_DYN_INTRIN = "mma_ldmatrix_e5m2_b_dyn"
+TensorIntrin.register(
+    LDMATRIX_e5m2_B_DYN_INTRIN, *get_ldmatrix_intrin(32, "float8_e5m2", "B", False, "shared.dyn")
+)
+
+LDMATRIX_e5m2_B_TRANS_DYN_INTRIN = "mma_ldmatrix_e5m2_b_trans_dyn"
+TensorIntrin.register(
+    LDMATRIX_e5m2_B_TRANS_DYN_INTRIN,
+    *get_ldmatrix_intrin(32, "float8_e5m2", "B", True, "shared.dyn"),
+)
+
+LDMATRIX_i4_A_DYN_INTRIN = "mma_ldmatrix_i4_a_dyn"
+TensorIntrin.register(
+    LDMATRIX_i4_A_DYN_INTRIN, *get_ldmatrix_intrin(64, "int4", "A", False, "shared.dyn")
+)
+
+LDMATRIX_i4_B_TRANS_DYN_INTRIN = "mma_ldmatrix_i4_b_trans_dyn"
+TensorIntrin.register(
+    LDMATRIX_i4_B_TRANS_DYN_INTRIN, *get_ldmatrix_intrin(64, "int4", "B", True, "shared.dyn")
+)
+
 
 def get_mma_intrin(
     k_dim,
@@ -310,6 +393,9 @@ def get_mma_intrin(
         index_map_A = shared_16x32_to_ldmatrix_32x16_layout
         index_map_B = shared_32x16_to_ldmatrix_32x16_layout
         mma_prefix = "m16n8k32"
+    elif k_dim == 64 and b_transposed:
+        index_map_A = index_map_B = shared_16x64_to_ldmatrix_32x32_layout
+        mma_prefix = "m16n8k64"
     else:
         assert False
 
@@ -317,6 +403,7 @@ def get_mma_intrin(
         "float16": "fp16",
         "float32": "fp32",
         "int8": "int8",
+        "int4": "int4",
         "int32": "int32",
         "float8_e4m3fn": "e4m3",
         "float8_e5m2": "e5m2",
@@ -546,6 +633,11 @@ TensorIntrin.register(
     *get_mma_intrin(32, "float8_e4m3fn", "float8_e4m3fn", "float32", False, True),
 )
 
+MMA_i4i4i32_TRANS_B_INTRIN = "mma_i4i4i32_trans_b"
+TensorIntrin.register(
+    MMA_i4i4i32_TRANS_B_INTRIN, *get_mma_intrin(64, "int4", "int4", "int32", False, True)
+)
+
 
 def get_mma_fill_intrin(dtype, local_size):
     zero = IntImm("int32", 0).astype(dtype)
@@ -710,7 +802,7 @@ TensorIntrin.register(
 def get_mma_intrin_group(
     load_scope: Literal["shared", "shared.dyn"],
     store_scope: Literal["global", "shared", "shared.dyn"],
-    in_dtype: Literal["float16", "int8", "float8_e4m3fn", "float8_e5m2"],
+    in_dtype: Literal["float16", "int8", "int4", "float8_e4m3fn", "float8_e5m2"],
     out_dtype: Literal["float16", "float32", "int32"],
     trans_a: bool,
     trans_b: bool,
@@ -757,8 +849,14 @@ def get_mma_intrin_group(
     """
     assert load_scope in ["shared", "shared.dyn"]
     assert store_scope in ["global", "shared", "shared.dyn"]
-    assert in_dtype in ["float16", "int8", "float8_e4m3fn", "float8_e5m2"]
+    assert in_dtype in ["float16", "int8", "int4", "float8_e4m3fn", "float8_e5m2"]
     assert out_dtype in ["float16", "float32", "int32"]
+    if in_dtype == "int4":
+        assert not trans_a and trans_b, "int4 mma requires A in [M, K] and B in [N, K]"
+    if in_dtype in ["int8", "int4"]:
+        assert out_dtype == "int32", f"{in_dtype} mma accumulates in int32"
+    if in_dtype.startswith("float8"):
+        assert out_dtype == "float32", f"{in_dtype} mma accumulates in float32"
 
     shape = "16x16"
 
@@ -766,6 +864,7 @@ def get_mma_intrin_group(
         "float16": "f16",
         "float32": "f32",
         "int8": "i8",
+        "int4": "i4",
         "float8_e4m3fn": "e4m3",
         "float8_e5m2": "e5m2",
         "int32": "i32",
@@ -1409,11 +1508,17 @@ def get_wmma_intrin_group(
     """
     assert load_scope in ["shared", "shared.dyn"]
     assert store_scope in ["global", "shared", "shared.dyn"]
-    assert in_dtype in ["float16", "int8"]
+    assert in_dtype in ["float16", "int8", "int4"]
     assert out_dtype in ["float16", "float32", "int32"]
 
-    shape = "16x16x16"
-    in_dtype = "f16" if in_dtype == "float16" else "s8"
+    if in_dtype == "int4":
+        # Sub-byte wmma only has the m8n8k32 "row.col" shape, i.e. B in [N, K].
+        assert out_dtype == "int32" and trans_b, "int4 wmma requires int32 output and B in [N, K]"
+        shape = "8x8x32"
+        in_dtype = "s4"
+    else:
+        shape = "16x16x16"
+        in_dtype = "f16" if in_dtype == "float16" else "s8"
     out_dtype = "f16" if out_dtype == "float16" else "f32" if out_dtype == "float32" else "s32"
     # convert "shared.dyn" to "shared_dyn"
     load_scope = load_scope.replace(".", "_")
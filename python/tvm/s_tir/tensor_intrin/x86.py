@@ -110,3 +110,100 @@ AVX512_DOT_16x4_INTRIN = "dot_16x4_avx512"
 TensorIntrin.register(
     AVX512_DOT_16x4_INTRIN, dot_product_16x4_u8i8i32_desc, dot_product_16x4_u8i8i32_avx512
 )
+
+
+def get_amx_dot_intrin(a_dtype, b_dtype):
+    """Generator of the 16x16 AMX tile GEMM intrinsics of Sapphire Rapids.
+
+    A is a tile of 16 rows and 64 bytes, B holds the same number of bytes packed in the VNNI
+    layout [K // pack, 16, pack] where pack is 4 for int8 and 2 for bfloat16, and C is a tile
+    of 16x16 accumulators. The implementation uses tmm0 for C, tmm1 for A and tmm2 for B, and
+    relies on the x86 codegen to load a tile configuration of 16 rows of 64 bytes at the entry
+    of the function. On Linux, the process must request the AMX state with `runtime.amx_init`
+    before running the kernel.
+    """
+    if a_dtype == "bfloat16":
+        acc_dtype, pack, elem_bytes, llvm_intrin = "float32", 2, 2, "llvm.x86.tdpbf16ps"
+    else:
+        acc_dtype, pack, elem_bytes = "int32", 4, 1
+        llvm_intrin = {"uint8": "llvm.x86.tdpbusd", "int8": "llvm.x86.tdpbssd"}[a_dtype]
+    K = 64 // elem_bytes
+
+    @T.prim_func(s_tir=True)
+    def desc(a: T.handle, b: T.handle, c: T.handle) -> None:
+        A = T.match_buffer(a, (16, K), a_dtype, offset_factor=1)
+        B = T.match_buffer(b, (K // pack, 16, pack), b_dtype, offset_factor=1)
+        C = T.match_buffer(c, (16, 16), acc_dtype, offset_factor=1)
+        with T.sblock("root"):
+            T.reads(C[0:16, 0:16], A[0:16, 0:K], B[0 : K // pack, 0:16, 0:pack])
+            T.writes(C[0:16, 0:16])
+            for i, j, k in T.grid(16, 16, K):
+                with T.sblock("update"):
+                    vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                    C[vi, vj] = C[vi, vj] + T.cast(A[vi, vk], acc_dtype) * T.cast(
+                        B[vk // pack, vj, vk % pack], acc_dtype
+                    )
+
+    @T.prim_func(s_tir=True)
+    def impl(a: T.handle, b: T.handle, c: T.handle) -> None:
+        sa = T.int32()
+        sb = T.int32()
+        sc = T.int32()
+        A = T.match_buffer(a, (16, K), a_dtype, offset_factor=1, strides=[sa, 1])
+        B = T.match_buffer(
+            b, (K // pack, 16, pack), b_dtype, offset_factor=1, strides=[sb, pack, 1]
+        )
+        C = T.match_buffer(c, (16, 16), acc_dtype, offset_factor=1, strides=[sc, 1])
+        with T.sblock("root"):
+            T.reads(C[0:16, 0:16], A[0:16, 0:K], B[0 : K // pack, 0:16, 0:pack])
+            T.writes(C[0:16, 0:16])
+            T.evaluate(
+                T.call_llvm_intrin(
+                    "void",
+                    "llvm.x86.tileloadd64",
+                    T.int8(0),
+                    C.access_ptr("r"),
+                    T.Cast("int64", sc * 4),
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    "void",
+                    "llvm.x86.tileloadd64",
+                    T.int8(1),
+                    A.access_ptr("r"),
+                    T.Cast("int64", sa * elem_bytes),
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    "void",
+                    "llvm.x86.tileloadd64",
+                    T.int8(2),
+                    B.access_ptr("r"),
+                    T.Cast("int64", sb * elem_bytes),
+                )
+            )
+            T.evaluate(T.call_llvm_intrin("void", llvm_intrin, T.int8(0), T.int8(1), T.int8(2)))
+            T.evaluate(
+                T.call_llvm_intrin(
+                    "void",
+                    "llvm.x86.tilestored64",
+                    T.int8(0),
+                    C.access_ptr("w"),
+                    T.Cast("int64", sc * 4),
+                )
+            )
+
+    return desc, impl
+
+
+AMX_DOT_16x16x64_u8i8i32_INTRIN = "dot_16x16x64_u8i8i32_amx"
+AMX_DOT_16x16x64_i8i8i32_INTRIN = "dot_16x16x64_i8i8i32_amx"
+AMX_DOT_16x16x32_bf16bf16f32_INTRIN = "dot_16x16x32_bf16bf16f32_amx"
+
+TensorIntrin.register(AMX_DOT_16x16x64_u8i8i32_INTRIN, *get_amx_dot_intrin("uint8", "int8"))
+TensorIntrin.register(AMX_DOT_16x16x64_i8i8i32_INTRIN, *get_amx_dot_intrin("int8", "int8"))
+TensorIntrin.register(
+    AMX_DOT_16x16x32_bf16bf16f32_INTRIN, *get_amx_dot_intrin("bfloat16", "bfloat16")
+)
@@ -171,6 +171,15 @@ def UnifyThreadBinding():
 def InjectSoftwarePipeline():
     """Transform annotated loops into pipelined one that parallelize producers and consumers
 
+    On CPU targets, a loop also annotated with "software_pipeline_prefetch" is not
+    multi-buffered. Instead, the reads of each statement in stage N are prefetched
+    N iterations ahead with ``tirx.prefetch``, and the statements keep their order.
+
+    On CUDA, a loop annotated with "software_pipeline_warp_specialize" runs its stage 0
+    statements on extra producer warps, which hand the versions of their shared buffers to
+    the consumer warps through mbarriers, optionally rebalancing registers with
+    ``setmaxnreg``.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -220,6 +229,16 @@ class LoopPartitionConfig(_ffi.Object):
 def LoopPartition():
     """Partition loops in the stmt.
 
+    When the pass config "tirx.vectorize_masked_tail" is enabled, conditions inside
+    vectorized loops are not partitioned, since VectorizeLoop lowers them to masked
+    loads and stores.
+
+    When "max_code_growth" of the "s_tir.LoopPartition" config is set, the size of each
+    function after partitioning is bounded by that ratio of its size before. The inner
+    loops are partitioned first, the conditions of a partition that does not fit stay as
+    predicates, and the growth is reported in the "s_tir.loop_partition_code_growth"
+    attribute of the function.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -335,6 +354,9 @@ def InjectPTXLDG32(enable_inject_ptx_intrin=True):
 def InstrumentProfileIntrinsics():
     """Insert intrinsic calls to instrument function and loop level profiling.
 
+    On CPU and CUDA targets, the measurements of the instrumented regions are
+    collected with :py:mod:`tvm.runtime.loop_profiler`.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -375,6 +397,10 @@ def LowerVtcmAlloc():
 def ThreadSync(storage_scope):
     """Insert sync between parallel read/write of shared buffers.
 
+    The accesses whose indices are affine in the thread index with offsets that never coincide
+    are not synchronized, adjacent syncs are merged, and the syncs inside of a
+    ``named_barrier_scope`` use the named barrier of the scope.
+
     Parameters
     ----------
     storage_scope: str
@@ -402,6 +428,10 @@ def InferFragment():
 def LowerThreadAllreduce():
     """Lower cross thread allreduce.
 
+    A reduction over blockIdx.x on CUDA is lowered to a reduction across the thread blocks of a
+    cluster, of at most 8 thread blocks. Each thread block reduces its threads first, then the
+    thread blocks exchange their results through the distributed shared memory.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -436,6 +466,12 @@ def MergeSharedMemoryAllocations():
     """This pass merges multiple TIR-level shared memory allocations
     into one allocation.
 
+    With the pass config ``"tirx.merge_smem_packing": True``, the offsets are assigned by
+    packing the live ranges of constant-size buffers, largest first, at the lowest aligned
+    offset that does not overlap a buffer live at the same time. Buffers used by async copies
+    are then aligned to ``"tirx.merge_smem_async_copy_align"`` bytes (16 by default, 128 for
+    swizzled TMA copies).
+
     Returns
     -------
     fpass : tvm.transform.Pass
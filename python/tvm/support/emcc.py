@@ -73,8 +73,9 @@ def create_tvmjs_wasm(output, objects, options=None, cc="emcc", libs=None):
     objects : list
         List of object files.
 
-    options : str
-        The additional options.
+    options : List[str]
+        The additional options. With "-pthread", the parallel loops run on Web Workers, which
+        needs the runtime to be built with ``make USE_THREADS=1``.
 
     cc : str, optional
         The compile string.
@@ -96,7 +97,9 @@ def create_tvmjs_wasm(output, objects, options=None, cc="emcc", libs=None):
     # cmd += ["-fwasm-exceptions"]
     cmd += ["-s", "WASM_BIGINT=1"]
     cmd += ["-s", "ERROR_ON_UNDEFINED_SYMBOLS=0"]
-    cmd += ["-s", "STANDALONE_WASM=1"]
+    # The pthreads of emscripten spawn their Web Workers from the JS glue.
+    if not options or "-pthread" not in options:
+        cmd += ["-s", "STANDALONE_WASM=1"]
     cmd += ["-s", "ALLOW_MEMORY_GROWTH=1"]
     cmd += ["-s", "TOTAL_MEMORY=160MB"]
 
@@ -71,14 +71,15 @@ def mma_schedule(
     def fetch_to_shared(block, idx, ndim):
         block_read = sch.cache_read(block, idx, shared_scope)
         sch.compute_at(block_read, k0)
-        vector_size = 16 if in_dtype == "int8" else 8
+        # Every thread copies 16 bytes at once.
+        vector_size = {"int8": 16, "int4": 32}.get(in_dtype, 8)
         warp_size = 32
         fused = sch.fuse(*sch.get_loops(block_read)[-ndim:])
         _, f_1, f_2, f_3 = sch.split(fused, factors=[None, num_ty, warp_size, vector_size])
         sch.bind(f_2, "threadIdx.x")
         sch.bind(f_1, "threadIdx.y")
         sch.vectorize(f_3)
-        offset = 8 if in_dtype == "float16" else 16
+        offset = {"float16": 8, "int4": 32}.get(in_dtype, 16)
         sch.storage_align(block_read, 0, axis=-2, factor=32, offset=offset)
 
         return block_read
@@ -187,7 +188,8 @@ def mfma_schedule(
     def fetch_to_shared(block, idx, ndim):
         block_read = sch.cache_read(block, idx, shared_scope)
         sch.compute_at(block_read, k0)
-        vector_size = 16 if in_dtype == "int8" else 8
+        # Every thread copies 16 bytes at once.
+        vector_size = {"int8": 16, "int4": 32}.get(in_dtype, 8)
         fused = sch.fuse(*sch.get_loops(block_read)[-ndim:])
         _, f_1, f_2, f_3 = sch.split(fused, factors=[None, num_ty, warp_size, vector_size])
         sch.bind(f_2, "threadIdx.x")
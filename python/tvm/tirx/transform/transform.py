@@ -52,6 +52,16 @@ def Apply(ftransform):
 def VectorizeLoop(enable_vectorize: bool = True):
     """Lower vectorization loops.
 
+    On targets with scalable vectors (AArch64 SVE, RISC-V V), the pass config
+    "tirx.vectorize_scalable" lowers vectorized loops with a constant or symbolic extent
+    to chunks of vscale-multiple lanes whose tail is predicated, instead of a fixed lane
+    count. It defaults to enabled on RISC-V V only.
+
+    The pass config "tirx.vectorize_masked_tail" splits vectorized loops whose extent is
+    symbolic or not a multiple of the native vector width into full-width chunks, and lowers
+    the last chunk to masked loads and stores on targets that support them (AVX-512, SVE,
+    RISC-V V) rather than scalar code. It is disabled by default.
+
     Parameters
     ----------
     enable_vectorize : bool
@@ -203,6 +213,12 @@ def FP8StorageLegalize():
 def CommonSubexprElim():
     """Replace redundant computations by new variables.
 
+    With ``{"tirx.CommonSubexprElim": {"hoist_loop_invariant": True}}`` in the pass
+    config, the bindings are also hoisted out of the serial and unrolled loops they
+    are invariant in, including complex enough expressions that are used only once.
+    On GPU targets ``max_hoisted_per_loop`` bounds the bindings hoisted in front of
+    each loop.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -283,6 +299,15 @@ def SplitHostDevice():
     then splits them into host and device-side PrimFuncs, and finally
     lowers host-to-device calls into the device kernel launch ABI.
 
+    With the ``"tirx.SplitHostDevice"`` config ``{"coalesce_kernels": True}``,
+    consecutive device regions with the same target and thread extents are
+    merged into one kernel, to save the launch overhead of small kernels.
+    Independent regions are dispatched by block.  CUDA regions that depend on
+    an earlier region are merged into a persistent kernel of
+    ``grid_sync_blocks`` blocks, with grid-wide syncs between them under a
+    cooperative launch, when ``grid_sync_blocks`` is set to at most the
+    number of blocks that can be resident on the device at once.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -324,6 +349,24 @@ def LowerTVMBuiltin():
     return _ffi_api.LowerTVMBuiltin()  # type: ignore
 
 
+def PlanStaticWorkspace():
+    """Plan the workspaces of the C host functions into one static arena of the module.
+
+    The CPU allocations that LowerTVMBuiltin would lower to ``TVMBackendAllocWorkspace`` get
+    constant offsets in an arena that the C host codegen emits as a static buffer, so that the
+    generated code allocates no memory at runtime. The size of the arena, i.e. the peak workspace
+    memory of the module, is stored in the ``"tirx.static_workspace_bytes"`` module attribute.
+
+    The pass runs before LowerTVMBuiltin when the ``"tirx.static_workspace_plan"`` config is set.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.PlanStaticWorkspace()  # type: ignore
+
+
 def LowerIntrin():
     """Lower target specific intrinsic calls.
 
@@ -351,6 +394,11 @@ def NarrowDataType(target_bits: int):
     Note
     ----
     Run this pass after FlattenBuffer.
+
+    When the pass config ``tirx.narrow_datatype_runtime_check`` is set, the indices that only
+    fit for some values of the integer parameters, e.g. ``i * n + j`` for ``i, j < n``, are
+    narrowed as well. The body then runs on the narrowed parameters when a runtime check of the
+    bounds passes, and on the conservatively narrowed indices otherwise.
     """
     return _ffi_api.NarrowDataType(target_bits)  # type: ignore
 
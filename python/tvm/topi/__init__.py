@@ -43,6 +43,7 @@ from .sort import *
 from .scatter import *
 from .scatter_elements import *
 from .slice_scatter import *
+from .sparse import *
 from .sparse_reshape import *
 from .scan import *
 from .einsum import *
@@ -54,6 +55,7 @@ from . import utils
 from . import image
 from . import vision
 from . import gpu
+from . import random
 
 # error reporting
 from .utils import InvalidShapeError
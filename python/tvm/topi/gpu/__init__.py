@@ -23,3 +23,4 @@ from .scan import cumsum, cumprod
 from .scatter_elements import scatter_elements
 from .scatter_nd import scatter_nd
 from .sort import *
+from .sparse import csr_matmul, embedding_bag
@@ -0,0 +1,158 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Embedding bag and sparse-dense matmul operators on GPU"""
+
+import tvm
+from tvm import te, tirx
+from tvm.script.ir_builder import IRBuilder
+from tvm.script.ir_builder import tirx as T
+
+from ..math import cast
+from ..sparse import _bag_init, _bag_range, _bag_update, verify_embedding_bag_inputs
+from ..utils import ceil_div
+
+
+def embedding_bag(weight, indices, offsets, per_sample_weights=None, mode="sum"):
+    """GPU implementation of embedding_bag.
+
+    A block pools one bag, each thread one feature of it, so that the threads of a warp read
+    consecutive elements of an embedding row and the feature accumulates in a register.
+    """
+    verify_embedding_bag_inputs(weight, indices, offsets, per_sample_weights, mode)
+    out_shape = [offsets.shape[0], weight.shape[1]]
+
+    def gen_ir(weight_buf, indices_buf, offsets_buf, psw_buf, out_buf):
+        weight = T.buffer_proxy(weight_buf)
+        indices = T.buffer_proxy(indices_buf)
+        offsets = T.buffer_proxy(offsets_buf)
+        out = T.buffer_proxy(out_buf)
+        num_bags, dim = out_buf.shape
+        num_indices = indices_buf.shape[0]
+        dtype = out_buf.dtype
+        max_threads = int(tvm.target.Target.current(allow_none=False).attrs["max_num_threads"])
+
+        with IRBuilder() as ib:
+            nthread_tx = max_threads
+            tx = te.thread_axis("threadIdx.x")
+            bx = te.thread_axis("blockIdx.x")
+            by = te.thread_axis("blockIdx.y")
+            acc_buf = T.decl_buffer([1], dtype, scope="local")
+            with T.frame_scope(
+                [
+                    T.attr(bx, "thread_extent", cast(num_bags, "int32")),
+                    T.attr(by, "thread_extent", cast(ceil_div(dim, nthread_tx), "int32")),
+                    T.attr(tx, "thread_extent", nthread_tx),
+                ]
+            ):
+                acc = T.buffer_proxy(acc_buf)
+                j = by * nthread_tx + tx
+                with T.If(j < dim):
+                    with T.Then():
+                        start, end = _bag_range(offsets, num_bags, num_indices, bx)
+                        acc[0] = _bag_init(mode, dtype)
+                        with T.serial(start, end) as i:
+                            value = weight[indices[i], j]
+                            if psw_buf is not None:
+                                value = value * T.buffer_proxy(psw_buf)[i]
+                            acc[0] = _bag_update(mode, acc[0], value)
+                        if mode == "max":
+                            out[bx, j] = tirx.if_then_else(
+                                end == start, tirx.const(0, dtype), acc[0]
+                            )
+                        elif mode == "mean":
+                            out[bx, j] = acc[0] / cast(tirx.max(end - start, 1), dtype)
+                        else:
+                            out[bx, j] = acc[0]
+
+            return ib.get()
+
+    inputs = [weight, indices, offsets]
+    if per_sample_weights is not None:
+        inputs.append(per_sample_weights)
+    out_buf = tirx.decl_buffer(out_shape, weight.dtype, "out_buf", layout=None)
+    return te.extern(
+        [out_shape],
+        inputs,
+        lambda ins, outs: gen_ir(
+            ins[0], ins[1], ins[2], ins[3] if len(ins) == 4 else None, outs[0]
+        ),
+        dtype=weight.dtype,
+        out_buffers=[out_buf],
+        name="embedding_bag.gpu",
+        tag="embedding_bag.gpu",
+    )
+
+
+def csr_matmul(data, indices, indptr, dense):
+    """GPU implementation of csr_matmul.
+
+    A block computes one row of the output, each thread one column of it, so that the threads
+    of a warp read consecutive elements of a dense row and the column accumulates in a register.
+    """
+    assert len(data.shape) == 1, "The nonzeros of csr_matmul must be 1-D"
+    assert len(indices.shape) == 1, "The column indices of csr_matmul must be 1-D"
+    assert len(indptr.shape) == 1, "The row pointers of csr_matmul must be 1-D"
+    assert len(dense.shape) == 2, "The dense operand of csr_matmul must be 2-D"
+    out_shape = [indptr.shape[0] - 1, dense.shape[1]]
+
+    def gen_ir(data_buf, indices_buf, indptr_buf, dense_buf, out_buf):
+        data = T.buffer_proxy(data_buf)
+        indices = T.buffer_proxy(indices_buf)
+        indptr = T.buffer_proxy(indptr_buf)
+        dense = T.buffer_proxy(dense_buf)
+        out = T.buffer_proxy(out_buf)
+        num_rows, N = out_buf.shape
+        dtype = out_buf.dtype
+        max_threads = int(tvm.target.Target.current(allow_none=False).attrs["max_num_threads"])
+
+        with IRBuilder() as ib:
+            nthread_tx = max_threads
+            tx = te.thread_axis("threadIdx.x")
+            bx = te.thread_axis("blockIdx.x")
+            by = te.thread_axis("blockIdx.y")
+            acc_buf = T.decl_buffer([1], dtype, scope="local")
+            with T.frame_scope(
+                [
+                    T.attr(bx, "thread_extent", cast(num_rows, "int32")),
+                    T.attr(by, "thread_extent", cast(ceil_div(N, nthread_tx), "int32")),
+                    T.attr(tx, "thread_extent", nthread_tx),
+                ]
+            ):
+                acc = T.buffer_proxy(acc_buf)
+                j = by * nthread_tx + tx
+                with T.If(j < N):
+                    with T.Then():
+                        start = cast(indptr[bx], "int64")
+                        end = cast(indptr[bx + 1], "int64")
+                        acc[0] = tirx.const(0, dtype)
+                        with T.serial(start, end) as k:
+                            acc[0] = acc[0] + cast(data[k], dtype) * dense[indices[k], j]
+                        out[bx, j] = acc[0]
+
+            return ib.get()
+
+    out_buf = tirx.decl_buffer(out_shape, dense.dtype, "out_buf", layout=None)
+    return te.extern(
+        [out_shape],
+        [data, indices, indptr, dense],
+        lambda ins, outs: gen_ir(ins[0], ins[1], ins[2], ins[3], outs[0]),
+        dtype=dense.dtype,
+        out_buffers=[out_buf],
+        name="csr_matmul.gpu",
+        tag="csr_matmul.gpu",
+    )
@@ -0,0 +1,206 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Counter-based random number generation with the Philox4x32-10 generator.
+
+Every output element is a pure function of the (seed, offset) state and of its flat index, so
+the computations are elementwise. The streams are bit-identical on every target and for any
+schedule or thread count, and they fuse with their consumers like any other elementwise op.
+
+The state is a uint64 tensor of shape (2,) holding [seed, offset]. Element i of the output takes
+lane i % 4 of the Philox block for counter offset + i // 4, keyed by the seed, so a call consumes
+ceil(numel / 4) counters and the caller advances the offset by that many for the next call.
+"""
+
+from tvm import te, tirx
+
+from . import tag
+
+# Multipliers and Weyl constants of Philox4x32 (Salmon et al., "Parallel random numbers: as
+# easy as 1, 2, 3", SC 2011).
+_PHILOX_M0 = 0xD2511F53
+_PHILOX_M1 = 0xCD9E8D57
+_PHILOX_W0 = 0x9E3779B9
+_PHILOX_W1 = 0xBB67AE85
+_PHILOX_ROUNDS = 10
+
+# The number of random bits that map exactly onto [0, 1) for each float dtype.
+_UNIFORM_BITS = {"float16": 11, "bfloat16": 8, "float32": 24, "float64": 32}
+
+
+def _u32(value):
+    return tirx.Cast("uint32", value)
+
+
+def _u64(value):
+    return tirx.Cast("uint64", value)
+
+
+def philox4x32_10(counter, key):
+    """Compute one Philox4x32-10 block.
+
+    The intermediate words are bound to variables, so that the expression stays linear in the
+    number of rounds.
+
+    Parameters
+    ----------
+    counter : List[PrimExpr]
+        The four uint32 words of the counter.
+
+    key : List[PrimExpr]
+        The two uint32 words of the key.
+
+    Returns
+    -------
+    bindings : List[Tuple[tirx.Var, PrimExpr]]
+        The variables the words depend on, in binding order. See :py:func:`with_bindings`.
+
+    words : List[tirx.Var]
+        The four uint32 output words.
+    """
+    bindings = []
+
+    def _bind(name, value):
+        var = tirx.Var(name, value.dtype)
+        bindings.append((var, value))
+        return var
+
+    words = [_bind(f"ctr{i}", _u32(word)) for i, word in enumerate(counter)]
+    key0 = _bind("key0", _u32(key[0]))
+    key1 = _bind("key1", _u32(key[1]))
+    for r in range(_PHILOX_ROUNDS):
+        round_key0 = key0 + tirx.const((r * _PHILOX_W0) & 0xFFFFFFFF, "uint32")
+        round_key1 = key1 + tirx.const((r * _PHILOX_W1) & 0xFFFFFFFF, "uint32")
+        prod0 = _bind(f"prod0_{r}", tirx.const(_PHILOX_M0, "uint64") * _u64(words[0]))
+        prod1 = _bind(f"prod1_{r}", tirx.const(_PHILOX_M1, "uint64") * _u64(words[2]))
+        shift = tirx.const(32, "uint64")
+        words = [
+            _bind(f"r{r}w0", _u32(prod1 >> shift) ^ words[1] ^ round_key0),
+            _bind(f"r{r}w1", _u32(prod1)),
+            _bind(f"r{r}w2", _u32(prod0 >> shift) ^ words[3] ^ round_key1),
+            _bind(f"r{r}w3", _u32(prod0)),
+        ]
+    return bindings, words
+
+
+def with_bindings(bindings, body):
+    """Wrap the body into the let bindings returned by :py:func:`philox4x32_10`."""
+    for var, value in reversed(bindings):
+        body = tirx.Let(var, value, body)
+    return body
+
+
+def _uniform_at(state, shape, indices, dtype):
+    """The uniform sample in [0, 1) at the indices of an output of the given shape."""
+    if dtype not in _UNIFORM_BITS:
+        raise ValueError(f"Philox uniform samples do not support dtype {dtype}")
+    flat = tirx.const(0, "int64")
+    for dim, index in zip(shape, indices):
+        flat = flat * tirx.Cast("int64", dim) + tirx.Cast("int64", index)
+    counter = state[1] + _u64(tirx.floordiv(flat, 4))
+    seed = state[0]
+    mask = tirx.const(0xFFFFFFFF, "uint64")
+    shift = tirx.const(32, "uint64")
+    bindings, words = philox4x32_10(
+        [counter & mask, counter >> shift, tirx.const(0, "uint32"), tirx.const(0, "uint32")],
+        [seed & mask, seed >> shift],
+    )
+    lane = tirx.floormod(flat, 4)
+    word = tirx.Select(
+        lane == 0,
+        words[0],
+        tirx.Select(lane == 1, words[1], tirx.Select(lane == 2, words[2], words[3])),
+    )
+    bits = _UNIFORM_BITS[dtype]
+    # The top bits of the word scaled by 2^-bits are exact in the compute dtype.
+    compute_dtype = "float64" if dtype == "float64" else "float32"
+    value = tirx.Cast(compute_dtype, word >> tirx.const(32 - bits, "uint32")) * tirx.const(
+        2.0**-bits, compute_dtype
+    )
+    return with_bindings(bindings, tirx.Cast(dtype, value))
+
+
+def philox_uniform(state, shape, dtype="float32"):
+    """Draw uniform samples in [0, 1) from the Philox stream of the state.
+
+    Parameters
+    ----------
+    state : te.Tensor
+        The uint64 tensor of shape (2,) holding [seed, offset].
+
+    shape : List[PrimExpr]
+        The shape of the output.
+
+    dtype : str
+        The float dtype of the output.
+
+    Returns
+    -------
+    out : te.Tensor
+        The uniform samples.
+    """
+    return te.compute(
+        shape,
+        lambda *indices: _uniform_at(state, shape, indices, dtype),
+        name="philox_uniform",
+        tag=tag.ELEMWISE,
+    )
+
+
+def philox_dropout(data, state, rate):
+    """Zero the elements of the data with the probability rate, and scale the others by
+    1 / (1 - rate), as dropout does in training.
+
+    Parameters
+    ----------
+    data : te.Tensor
+        The input tensor.
+
+    state : te.Tensor
+        The uint64 tensor of shape (2,) holding [seed, offset].
+
+    rate : float
+        The probability for an element to be zeroed, in [0, 1).
+
+    Returns
+    -------
+    out : te.Tensor
+        The result of the dropout.
+
+    mask : te.Tensor
+        The mask of the kept elements, 1 for kept and 0 for dropped, in the dtype of the data.
+    """
+    if not 0.0 <= rate < 1.0:
+        raise ValueError(f"The dropout rate must be in [0, 1), but got {rate}")
+    shape = data.shape
+    mask = te.compute(
+        shape,
+        lambda *indices: tirx.Select(
+            _uniform_at(state, shape, indices, "float32") >= tirx.const(rate, "float32"),
+            tirx.const(1, data.dtype),
+            tirx.const(0, data.dtype),
+        ),
+        name="philox_dropout_mask",
+        tag=tag.ELEMWISE,
+    )
+    scale = tirx.const(1.0 / (1.0 - rate), data.dtype)
+    out = te.compute(
+        shape,
+        lambda *indices: data(*indices) * mask(*indices) * scale,
+        name="philox_dropout",
+        tag=tag.ELEMWISE,
+    )
+    return out, mask
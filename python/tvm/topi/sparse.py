@@ -0,0 +1,229 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Embedding bag and sparse-dense matmul operators"""
+
+from tvm import te, tirx
+from tvm.script.ir_builder import IRBuilder
+from tvm.script.ir_builder import tirx as T
+
+from .math import cast
+
+EMBEDDING_BAG_MODES = ("sum", "mean", "max")
+
+
+def _bag_range(offsets, num_bags, num_indices, b):
+    """The [start, end) range of the indices of bag b, in int64."""
+    start = cast(offsets[b], "int64")
+    end = tirx.if_then_else(
+        b + 1 < num_bags, cast(offsets[b + 1], "int64"), cast(num_indices, "int64")
+    )
+    return start, end
+
+
+def _prefetch_row(buf, row):
+    """Prefetch the row of a 2-D buffer into the data cache for reading."""
+    address = tirx.address_of(tirx.BufferLoad(buf, [row, 0]))
+    T.evaluate(tirx.call_intrin("void", "tirx.prefetch", address, 0, 3, 1))
+
+
+def _bag_init(mode, dtype):
+    return tirx.min_value(dtype) if mode == "max" else tirx.const(0, dtype)
+
+
+def _bag_update(mode, acc, value):
+    return tirx.max(acc, value) if mode == "max" else acc + value
+
+
+def verify_embedding_bag_inputs(weight, indices, offsets, per_sample_weights, mode):
+    """Check the ranks of the embedding bag inputs and the pooling mode."""
+    if mode not in EMBEDDING_BAG_MODES:
+        raise ValueError(f"embedding_bag mode must be one of {EMBEDDING_BAG_MODES}, got {mode}")
+    assert len(weight.shape) == 2, "The embedding table of embedding_bag must be 2-D"
+    assert len(indices.shape) == 1, "The indices of embedding_bag must be 1-D"
+    assert len(offsets.shape) == 1, "The offsets of embedding_bag must be 1-D"
+    if per_sample_weights is not None:
+        assert mode == "sum", "embedding_bag supports per sample weights only in sum mode"
+
+
+def embedding_bag(weight, indices, offsets, per_sample_weights=None, mode="sum"):
+    """Pool the rows of an embedding table over ragged bags of indices.
+
+    Bag b holds the indices in ``indices[offsets[b]:offsets[b + 1]]``, the last bag running to the
+    end of the indices, and
+
+    .. code-block::
+
+        output[b, :] = pool(weight[indices[i], :] * per_sample_weights[i] for i in bag b)
+
+    where pool sums, averages or takes the maximum as the mode says. Empty bags produce zeros.
+    The bags run in parallel, and the row of the next index is prefetched while the current one
+    is accumulated.
+
+    Parameters
+    ----------
+    weight : tvm.te.Tensor
+        The 2-D embedding table of shape (num_embeddings, embedding_dim).
+
+    indices : tvm.te.Tensor
+        The 1-D integer indices of all the bags, concatenated.
+
+    offsets : tvm.te.Tensor
+        The 1-D integer start position of each bag in the indices.
+
+    per_sample_weights : Optional[tvm.te.Tensor]
+        The 1-D weight of each index, with the shape of the indices. Only in "sum" mode.
+
+    mode : str
+        The pooling of a bag, "sum", "mean" or "max".
+
+    Returns
+    -------
+    out : tvm.te.Tensor
+        The pooled bags of shape (num_bags, embedding_dim).
+    """
+    verify_embedding_bag_inputs(weight, indices, offsets, per_sample_weights, mode)
+    out_shape = [offsets.shape[0], weight.shape[1]]
+
+    def gen_ir(weight_buf, indices_buf, offsets_buf, psw_buf, out_buf):
+        weight = T.buffer_proxy(weight_buf)
+        indices = T.buffer_proxy(indices_buf)
+        offsets = T.buffer_proxy(offsets_buf)
+        out = T.buffer_proxy(out_buf)
+        num_bags, dim = out_buf.shape
+        num_indices = indices_buf.shape[0]
+        dtype = out_buf.dtype
+
+        with IRBuilder() as ib:
+            with T.parallel(0, num_bags) as b:
+                start, end = _bag_range(offsets, num_bags, num_indices, b)
+                with T.serial(0, dim) as j:
+                    out[b, j] = _bag_init(mode, dtype)
+                with T.serial(start, end) as i:
+                    row = indices[i]
+                    with T.If(i + 1 < end):
+                        with T.Then():
+                            _prefetch_row(weight_buf, indices[i + 1])
+                    with T.serial(0, dim) as j:
+                        value = weight[row, j]
+                        if psw_buf is not None:
+                            value = value * T.buffer_proxy(psw_buf)[i]
+                        out[b, j] = _bag_update(mode, out[b, j], value)
+                if mode == "max":
+                    with T.If(end == start):
+                        with T.Then():
+                            with T.serial(0, dim) as j:
+                                out[b, j] = tirx.const(0, dtype)
+                elif mode == "mean":
+                    count = cast(tirx.max(end - start, 1), dtype)
+                    with T.serial(0, dim) as j:
+                        out[b, j] = out[b, j] / count
+
+            return ib.get()
+
+    inputs = [weight, indices, offsets]
+    if per_sample_weights is not None:
+        inputs.append(per_sample_weights)
+    out_buf = tirx.decl_buffer(out_shape, weight.dtype, "out_buf", layout=None)
+    return te.extern(
+        [out_shape],
+        inputs,
+        lambda ins, outs: gen_ir(
+            ins[0], ins[1], ins[2], ins[3] if len(ins) == 4 else None, outs[0]
+        ),
+        dtype=weight.dtype,
+        out_buffers=[out_buf],
+        name="embedding_bag.generic",
+        tag="embedding_bag.generic",
+    )
+
+
+def csr_matmul(data, indices, indptr, dense):
+    """Multiply a sparse matrix in CSR format with a dense matrix.
+
+    Row r of the sparse matrix holds ``data[indptr[r]:indptr[r + 1]]`` in the columns
+    ``indices[indptr[r]:indptr[r + 1]]``, and
+
+    .. code-block::
+
+        output[r, :] = sum(data[k] * dense[indices[k], :] for k in indptr[r]:indptr[r + 1])
+
+    The rows run in parallel, and the dense row of the next nonzero is prefetched while the
+    current one is accumulated.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        The 1-D nonzero values of the sparse matrix.
+
+    indices : tvm.te.Tensor
+        The 1-D integer column of each nonzero.
+
+    indptr : tvm.te.Tensor
+        The 1-D integer start position of each row in the nonzeros, plus the number of
+        nonzeros, so of shape (num_rows + 1,).
+
+    dense : tvm.te.Tensor
+        The 2-D dense matrix of shape (num_cols, N).
+
+    Returns
+    -------
+    out : tvm.te.Tensor
+        The dense result of shape (num_rows, N).
+    """
+    assert len(data.shape) == 1, "The nonzeros of csr_matmul must be 1-D"
+    assert len(indices.shape) == 1, "The column indices of csr_matmul must be 1-D"
+    assert len(indptr.shape) == 1, "The row pointers of csr_matmul must be 1-D"
+    assert len(dense.shape) == 2, "The dense operand of csr_matmul must be 2-D"
+    out_shape = [indptr.shape[0] - 1, dense.shape[1]]
+
+    def gen_ir(data_buf, indices_buf, indptr_buf, dense_buf, out_buf):
+        data = T.buffer_proxy(data_buf)
+        indices = T.buffer_proxy(indices_buf)
+        indptr = T.buffer_proxy(indptr_buf)
+        dense = T.buffer_proxy(dense_buf)
+        out = T.buffer_proxy(out_buf)
+        num_rows, N = out_buf.shape
+        dtype = out_buf.dtype
+
+        with IRBuilder() as ib:
+            with T.parallel(0, num_rows) as r:
+                start = cast(indptr[r], "int64")
+                end = cast(indptr[r + 1], "int64")
+                with T.serial(0, N) as j:
+                    out[r, j] = tirx.const(0, dtype)
+                with T.serial(start, end) as k:
+                    col = indices[k]
+                    value = cast(data[k], dtype)
+                    with T.If(k + 1 < end):
+                        with T.Then():
+                            _prefetch_row(dense_buf, indices[k + 1])
+                    with T.serial(0, N) as j:
+                        out[r, j] = out[r, j] + value * dense[col, j]
+
+            return ib.get()
+
+    out_buf = tirx.decl_buffer(out_shape, dense.dtype, "out_buf", layout=None)
+    return te.extern(
+        [out_shape],
+        [data, indices, indptr, dense],
+        lambda ins, outs: gen_ir(ins[0], ins[1], ins[2], ins[3], outs[0]),
+        dtype=dense.dtype,
+        out_buffers=[out_buf],
+        name="csr_matmul.generic",
+        tag="csr_matmul.generic",
+    )
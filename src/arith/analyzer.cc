@@ -54,6 +54,7 @@ void AnalyzerObj::Bind(const Var& var, const PrimExpr& expr, bool allow_override
   this->int_set.Update(var, this->int_set(new_expr), allow_override);
   this->transitive_comparisons.Bind(var, expr, allow_override);
   this->z3_prover.Bind(var, expr, allow_override);
+  this->BumpStateVersion();
 }
 
 void AnalyzerObj::Bind(const Var& var, const Range& range, bool allow_override) {
@@ -65,6 +66,7 @@ void AnalyzerObj::Bind(const Var& var, const Range& range, bool allow_override)
     this->int_set.Bind(var, range, allow_override);
     this->transitive_comparisons.Bind(var, range, allow_override);
     this->z3_prover.Bind(var, range, allow_override);
+    this->BumpStateVersion();
   }
   // skip modular_set
   // skip rewrite simplify
@@ -118,6 +120,7 @@ void AnalyzerObj::MarkGlobalNonNegValue(const PrimExpr& value) {
     // during bound proof which is not our intention
     this->const_int_bound.Update(var, ConstIntBound(-offset, ConstIntBound::kPosInf),
                                  allow_override);
+    this->BumpStateVersion();
   }
 }
 
@@ -136,6 +139,9 @@ void ConstraintContext::EnterWithScope() {
   recovery_functions_.push_back(analyzer_->int_set.EnterConstraint(constraint_));
   recovery_functions_.push_back(analyzer_->transitive_comparisons.EnterConstraint(constraint_));
   recovery_functions_.push_back(analyzer_->z3_prover.EnterConstraint(constraint_));
+  outer_state_version_ = analyzer_->state_version_;
+  analyzer_->BumpStateVersion();
+  inner_state_version_ = analyzer_->state_version_;
 }
 
 void ConstraintContext::ExitWithScope() {
@@ -146,6 +152,12 @@ void ConstraintContext::ExitWithScope() {
     }
     recovery_functions_.pop_back();
   }
+  // The facts are those from before the scope, unless a binding was made inside it.
+  if (analyzer_->state_version_ == inner_state_version_) {
+    analyzer_->state_version_ = outer_state_version_;
+  } else {
+    analyzer_->BumpStateVersion();
+  }
 }
 
 bool AnalyzerObj::CanProveGreaterEqual(const PrimExpr& expr, int64_t lower_bound) {
@@ -288,16 +300,19 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def("arith.AnalyzerConstIntBoundUpdate",
            [](Analyzer analyzer, const Var& var, const ConstIntBound& info, bool allow_override) {
              analyzer->const_int_bound.Update(var, info, allow_override);
+             analyzer->BumpStateVersion();
            })
       .def("arith.AnalyzerConstIntBoundIsBound",
            [](Analyzer analyzer, const Var& var) { return analyzer->const_int_bound.IsBound(var); })
       .def("arith.AnalyzerModularSetUpdate",
            [](Analyzer analyzer, const Var& var, const ModularSet& info, bool allow_override) {
              analyzer->modular_set.Update(var, info, allow_override);
+             analyzer->BumpStateVersion();
            })
       .def("arith.AnalyzerIntSetUpdate",
            [](Analyzer analyzer, const Var& var, const IntSet& info, bool allow_override) {
              analyzer->int_set.Update(var, info, allow_override);
+             analyzer->BumpStateVersion();
            })
       .def("arith.AnalyzerModularSet",
            [](Analyzer analyzer, const PrimExpr& expr) { return analyzer->modular_set(expr); })
@@ -341,6 +356,11 @@ TVM_FFI_STATIC_INIT_BLOCK() {
            [](Analyzer analyzer, int64_t maximum) {
              analyzer->rewrite_simplify.SetMaximumRewriteSteps(maximum);
            })
+      .def("arith.AnalyzerSetSimplifyMemoTableSize",
+           [](Analyzer analyzer, int64_t size) {
+             analyzer->rewrite_simplify.SetMemoTableSize(size);
+             analyzer->canonical_simplify.SetMemoTableSize(size);
+           })
       .def("arith.AnalyzerEnterConstraintContext",
            [](Analyzer analyzer, const PrimExpr& constraint) {
              // can't use make_shared due to noexcept(false) decl in destructor,
@@ -1465,9 +1465,13 @@ Expr CanonicalSimplifier::Impl::VisitExpr_(const LTNode* op) {
 }
 
 PrimExpr CanonicalSimplifier::operator()(const PrimExpr& expr) {
-  return impl_->CanonicalSimplify(expr);
+  return impl_->MemoizedSimplify(expr, [this](PrimExpr res) {
+    return impl_->CanonicalSimplify(std::move(res));
+  });
 }
 
+void CanonicalSimplifier::SetMemoTableSize(int64_t size) { impl_->SetMemoTableSize(size); }
+
 void CanonicalSimplifier::Update(const Var& var, const PrimExpr& info, bool override) {
   impl_->Update(var, info, override);
 }
@@ -1153,9 +1153,13 @@ ffi::Map<Var, arith::IntSet> AsIntSet(const ffi::Map<Var, Range>& var_dom) {
   return result;
 }
 
-/*! \brief Helper function to convert IterSumExpr to the actual touched range. */
+/*!
+ * \brief Helper function to convert IterSumExpr to the actual touched range.
+ * \param cover_stride Whether a split whose scale is wider than the extent is covered by the
+ *        hull of its accesses, which is only valid for an upper bound.
+ */
 static ffi::Optional<IntSet> EvalIterSum(const IterSumExpr& iter_min, const PrimExpr& extent,
-                                         AnalyzerObj* analyzer) {
+                                         AnalyzerObj* analyzer, bool cover_stride = false) {
   if (analyzer->CanProve(extent == 0)) {
     return IntSet::Nothing();
   }
@@ -1167,7 +1171,7 @@ static ffi::Optional<IntSet> EvalIterSum(const IterSumExpr& iter_min, const Prim
   if (analyzer->CanProve(split->extent == 0)) {
     return IntSet::Nothing();
   }
-  if (!analyzer->CanProve(extent >= split->scale)) {
+  if (!cover_stride && !analyzer->CanProve(extent >= split->scale)) {
     return std::nullopt;
   }
 
@@ -1255,24 +1259,25 @@ ffi::Array<IntSet> EstimateRegionUpperBound(const ffi::Array<Range>& region,
   for (const auto& [var, range] : var_dom) {
     input_iters.Set(var.as_or_throw<PrimVar>(), range);
   }
-  // try estimate each dimension independently
+  // try estimate each dimension independently, while the predicate is analyzed only once
+  ffi::Array<ffi::Array<PrimExpr>> indices_list;
+  indices_list.reserve(region.size());
   for (const Range& range : region) {
-    auto res = DetectIterMap(
-        /*indices=*/{range->min}, /*input_iters=*/input_iters,
-        /*predicate=*/predicate, /*check_level=*/IterMapLevel::Surjective, analyzer);
+    indices_list.push_back({range->min});
+  }
+  ffi::Array<IterMapResult> iter_maps = DetectIterMapBatch(
+      /*indices_list=*/indices_list, /*input_iters=*/input_iters,
+      /*predicate=*/predicate, /*check_level=*/IterMapLevel::Surjective, analyzer);
+  for (size_t i = 0; i < region.size(); ++i) {
+    const Range& range = region[i];
+    const IterMapResult& res = iter_maps[i];
     if (!res->indices.empty()) {
       TVM_FFI_ICHECK_EQ(res->indices.size(), 1U);
       IterSumExpr sum_expr = res->indices[0];
-
-      // dynamic extent is not supported yet.
-      PrimExpr extent = range->extent;
-      if (!is_const_number(extent)) {
-        IntSet relaxed = EvalSet(extent, AsIntSet(var_dom));
-        TVM_FFI_ICHECK(relaxed.HasUpperBound());
-        extent = relaxed.max();
-      }
-
-      if (ffi::Optional<IntSet> int_set = EvalIterSum(sum_expr, range->extent, analyzer_ptr)) {
+      // Covering the stride also accepts extents that cannot be compared with the scale, such
+      // as dynamic ones, and the hull still respects the predicate, which EvalSet ignores.
+      if (ffi::Optional<IntSet> int_set =
+              EvalIterSum(sum_expr, range->extent, analyzer_ptr, /*cover_stride=*/true)) {
         result.push_back(int_set.value());
         continue;
       }
@@ -30,7 +30,10 @@
 #include <tvm/tirx/op.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <optional>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "../support/utils.h"
 #include "const_fold.h"
@@ -179,7 +182,7 @@ class IterMapRewriter : public ExprMutator {
                            ffi::Array<ffi::String>* errors)
       : analyzer_(analyzer),
         check_level_(check_level),
-        errors_(*errors),
+        errors_(errors),
         padding_predicate_(IntImm::Bool(false)) {
     for (auto kv : input_iters) {
       const PrimVar& var = kv.first;
@@ -203,6 +206,13 @@ class IterMapRewriter : public ExprMutator {
   PrimExpr padding_predicate() const { return padding_predicate_; }
   bool requires_padding() const { return requires_padding_; }
 
+  /*!
+   * \brief Redirect the error messages, used when a copy of a rewriter whose constraints are
+   *  already rewritten detects the map of another index list.
+   * \param errors The array that collects the error messages.
+   */
+  void SetErrors(ffi::Array<ffi::String>* errors) { errors_ = errors; }
+
   IterSumExpr Rewrite(const PrimExpr& expr) {
     return NormalizeToIterWithOffset(ToIterSumExpr(DirectMutate(expr)));
   }
@@ -217,8 +227,11 @@ class IterMapRewriter : public ExprMutator {
   IterSumExpr RewriteIterConstraint(const PrimExpr& expr,
                                     const ffi::Optional<PrimExpr>& predicate_induced_min,
                                     const ffi::Optional<PrimExpr>& predicate_induced_max) {
-    return NormalizeToIterOnBoundExpr(ToIterSumExpr(DirectMutate(expr)), predicate_induced_min,
-                                      predicate_induced_max);
+    IterSumExpr res = NormalizeToIterOnBoundExpr(ToIterSumExpr(DirectMutate(expr)),
+                                                 predicate_induced_min, predicate_induced_max);
+    // The constraint adds a fused mark that later rewrites can match against.
+    mutate_memo_.clear();
+    return res;
   }
 
   /**
@@ -326,7 +339,21 @@ class IterMapRewriter : public ExprMutator {
 
   // Normal mutation without normalization.
   PrimExpr DirectMutate(const PrimExpr& expr) {
-    return ExprMutator::VisitExpr(expr).as_or_throw<PrimExpr>();
+    // Fused index expressions share their subexpressions between the indices of an access,
+    // e.g. the fused loop in [fused // 64, fused % 64], so rewrite each of them only once.
+    if (memo_padding_mode_ != update_iterator_padding_) {
+      mutate_memo_.clear();
+      memo_padding_mode_ = update_iterator_padding_;
+    }
+    auto it = mutate_memo_.find(expr);
+    if (it != mutate_memo_.end()) return it->second;
+    size_t num_errors = errors_->size();
+    PrimExpr res = ExprMutator::VisitExpr(expr).as_or_throw<PrimExpr>();
+    // Failed rewrites are not cached so that each occurrence reports its error.
+    if (errors_->size() == num_errors) {
+      mutate_memo_.emplace(expr, res);
+    }
+    return res;
   }
 
   Expr VisitExpr_(const VarNode* op) final;
@@ -374,7 +401,7 @@ class IterMapRewriter : public ExprMutator {
   class ErrorLogger {
    public:
     explicit ErrorLogger(IterMapRewriter* rewriter) : rewriter(rewriter) {}
-    ~ErrorLogger() { rewriter->errors_.push_back(os.str()); }
+    ~ErrorLogger() { rewriter->errors_->push_back(os.str()); }
 
     template <typename T>
     ErrorLogger& operator<<(T&& t) {
@@ -437,9 +464,13 @@ class IterMapRewriter : public ExprMutator {
   // Iter map check level
   IterMapLevel check_level_;
   // Error messages for each unresolved expression.
-  ffi::Array<ffi::String>& errors_;
+  ffi::Array<ffi::String>* errors_;
   // The var map
   std::unordered_map<Var, PrimExpr> var_map_;
+  // Results of DirectMutate for the current padding mode, keyed by expression identity.
+  std::unordered_map<PrimExpr, PrimExpr, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> mutate_memo_;
+  // The value of update_iterator_padding_ when mutate_memo_ was filled.
+  bool memo_padding_mode_{false};
   // input iter marks
   std::vector<IterMark> input_marks_;
 
@@ -1436,26 +1467,26 @@ bool IterRangeSanityCheck(const ffi::Map<PrimVar, Range>& iter_ranges) {
   return true;
 }
 
-IterMapResult DetectIterMap(const ffi::Array<PrimExpr>& indices,
-                            const ffi::Map<PrimVar, Range>& input_iters, const PrimExpr& predicate,
-                            IterMapLevel check_level, const arith::Analyzer& analyzer,
-                            bool simplify_trivial_iterators) {
-  arith::AnalyzerObj* analyzer_ptr = analyzer.get();
-  IterMapResult result;
-
-  // Overall detection algorithm is divided into two steps:
-  // - Step0: IterMapRewriter rewrites the expression to use IterMapExpr patterns.
-  // - Step1: IterIndependenceChecker checks if the iterator are independent.
+/*!
+ * \brief Parse the predicate into constraints on the input iterators and rewrite them, which
+ *  is shared by every index list detected over the same iterators.
+ * \param errors The array that collects the reason of a failure.
+ * \return The rewriter ready to rewrite indices, or nullopt on failure.
+ */
+static std::optional<IterMapRewriter> MakeConstrainedRewriter(
+    const ffi::Map<PrimVar, Range>& input_iters, const PrimExpr& predicate,
+    IterMapLevel check_level, arith::AnalyzerObj* analyzer_ptr, bool simplify_trivial_iterators,
+    ffi::Array<ffi::String>* errors) {
   if (!IterRangeSanityCheck(input_iters)) {
-    result->errors.push_back("Invalid iterators.  Iterators may not be expressions of each other.");
-    return result;
+    errors->push_back("Invalid iterators.  Iterators may not be expressions of each other.");
+    return std::nullopt;
   }
   ffi::Map<PrimVar, Range> constrained_input_iters = input_iters;
   std::vector<IterConstraint> constraints;
   if (!is_one(predicate) &&
       !MatchBoundConstraints(predicate, &constrained_input_iters, &constraints)) {
-    result->errors.push_back("Could not parse predicate as constraints on the input iterators.");
-    return result;
+    errors->push_back("Could not parse predicate as constraints on the input iterators.");
+    return std::nullopt;
   }
   // We have to make sure when we visit an iterator, all the constraints related with its successors
   // in the iter var graph has been visited, where the expression of this iterator will contain the
@@ -1468,21 +1499,31 @@ IterMapResult DetectIterMap(const ffi::Array<PrimExpr>& indices,
       constraints.begin(), constraints.end(),
       [](const IterConstraint& a, const IterConstraint& b) { return a.expr_size < b.expr_size; });
 
-  IterMapRewriter rewriter(analyzer_ptr, constrained_input_iters, check_level,
-                           simplify_trivial_iterators, &result->errors);
+  std::optional<IterMapRewriter> rewriter;
+  rewriter.emplace(analyzer_ptr, constrained_input_iters, check_level, simplify_trivial_iterators,
+                   errors);
   // Step0.0: rewrite constraints in the order from size-small ones to size-big ones
   for (const IterConstraint& constraint : constraints) {
-    auto res = rewriter.RewriteIterConstraint(constraint.iter, constraint.lower_bound,
-                                              constraint.upper_bound);
-    if (result->errors.size() > 0) {
-      return result;
+    auto res = rewriter->RewriteIterConstraint(constraint.iter, constraint.lower_bound,
+                                               constraint.upper_bound);
+    if (errors->size() > 0) {
+      return std::nullopt;
     }
   }
-  if (!rewriter.CheckConstraints()) {
-    result->errors.push_back("Invalid constraints.");
-    return result;
+  if (!rewriter->CheckConstraints()) {
+    errors->push_back("Invalid constraints.");
+    return std::nullopt;
   }
+  return rewriter;
+}
 
+/*!
+ * \brief Rewrite the indices with a rewriter whose constraints are rewritten, and check that
+ *  they form an iter map.
+ */
+static void DetectIterMapWithRewriter(const ffi::Array<PrimExpr>& indices,
+                                      IterMapLevel check_level, IterMapRewriter* rewriter,
+                                      const IterMapResult& result) {
   // Step0.1: Rewrite indicies and determine required padding,
   // if there is no padding, it should be the final result.
   ffi::Array<IterSumExpr> rewrite_indices;
@@ -1490,39 +1531,84 @@ IterMapResult DetectIterMap(const ffi::Array<PrimExpr>& indices,
   bool allow_padding = check_level != IterMapLevel::Bijective;
   if (allow_padding) {
     for (PrimExpr value : indices) {
-      rewrite_indices.push_back(rewriter.RewriteAndUpdatePadding(value));
+      rewrite_indices.push_back(rewriter->RewriteAndUpdatePadding(value));
       if (result->errors.size() > 0) {
-        return result;
+        return;
       }
     }
   }
 
   // Step0.2: Rewrite indices in the second round.
-  if (!allow_padding || rewriter.requires_padding()) {
+  if (!allow_padding || rewriter->requires_padding()) {
     rewrite_indices.clear();
     for (PrimExpr value : indices) {
-      rewrite_indices.push_back(rewriter.Rewrite(value));
+      rewrite_indices.push_back(rewriter->Rewrite(value));
       if (result->errors.size() > 0) {
-        return result;
+        return;
       }
     }
   }
-  result->padding_predicate = rewriter.padding_predicate();
+  result->padding_predicate = rewriter->padding_predicate();
   //
 
   // Step1: IterIndependenceChecker checks if the iterator are independent.
-  if (!rewriter.CheckMapping(rewrite_indices, check_level)) {
+  if (!rewriter->CheckMapping(rewrite_indices, check_level)) {
     if (check_level == IterMapLevel::Bijective) {
       result->errors.push_back("Index mapping does not form a bijective transform.");
     } else {
       result->errors.push_back("Mapped indices are not independent.");
     }
-    return result;
+    return;
   }
   result->indices = rewrite_indices;
+}
+
+IterMapResult DetectIterMap(const ffi::Array<PrimExpr>& indices,
+                            const ffi::Map<PrimVar, Range>& input_iters, const PrimExpr& predicate,
+                            IterMapLevel check_level, const arith::Analyzer& analyzer,
+                            bool simplify_trivial_iterators) {
+  IterMapResult result;
+
+  // Overall detection algorithm is divided into two steps:
+  // - Step0: IterMapRewriter rewrites the expression to use IterMapExpr patterns.
+  // - Step1: IterIndependenceChecker checks if the iterator are independent.
+  std::optional<IterMapRewriter> rewriter =
+      MakeConstrainedRewriter(input_iters, predicate, check_level, analyzer.get(),
+                              simplify_trivial_iterators, &result->errors);
+  if (!rewriter.has_value()) {
+    return result;
+  }
+  DetectIterMapWithRewriter(indices, check_level, &rewriter.value(), result);
   return result;
 }
 
+ffi::Array<IterMapResult> DetectIterMapBatch(const ffi::Array<ffi::Array<PrimExpr>>& indices_list,
+                                             const ffi::Map<PrimVar, Range>& input_iters,
+                                             const PrimExpr& predicate, IterMapLevel check_level,
+                                             const arith::Analyzer& analyzer,
+                                             bool simplify_trivial_iterators) {
+  ffi::Array<ffi::String> errors;
+  std::optional<IterMapRewriter> prepared =
+      MakeConstrainedRewriter(input_iters, predicate, check_level, analyzer.get(),
+                              simplify_trivial_iterators, &errors);
+  ffi::Array<IterMapResult> results;
+  results.reserve(indices_list.size());
+  for (const ffi::Array<PrimExpr>& indices : indices_list) {
+    IterMapResult result;
+    if (!prepared.has_value()) {
+      result->errors = errors;
+    } else {
+      // Padding is decided per index list, so each list starts from a copy of the state
+      // right after the constraints were rewritten.
+      IterMapRewriter rewriter = prepared.value();
+      rewriter.SetErrors(&result->errors);
+      DetectIterMapWithRewriter(indices, check_level, &rewriter, result);
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
   refl::GlobalDef().def(
@@ -1534,6 +1620,15 @@ TVM_FFI_STATIC_INIT_BLOCK() {
         return DetectIterMap(indices, input_iters, input_pred, IterMapLevel(check_level), ana,
                              simplify_trivial_iterators);
       });
+  refl::GlobalDef().def(
+      "arith.DetectIterMapBatch",
+      [](const ffi::Array<ffi::Array<PrimExpr>>& indices_list,
+         const ffi::Map<PrimVar, Range>& input_iters, const PrimExpr& input_pred, int check_level,
+         bool simplify_trivial_iterators, ffi::Optional<Analyzer> opt_analyzer) {
+        Analyzer ana = opt_analyzer.has_value() ? opt_analyzer.value() : Analyzer();
+        return DetectIterMapBatch(indices_list, input_iters, input_pred,
+                                  IterMapLevel(check_level), ana, simplify_trivial_iterators);
+      });
 }
 
 IterSumExpr NormalizeToIterSum(PrimExpr index, const ffi::Map<PrimVar, Range>& input_iters,
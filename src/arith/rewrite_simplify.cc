@@ -562,7 +562,10 @@ std::function<void()> RewriteSimplifier::Impl::EnterConstraint(const PrimExpr& c
   return frecover;
 }
 
-void RewriteSimplifier::Impl::SetEnabledExtensions(Extension flags) { enabled_extensions_ = flags; }
+void RewriteSimplifier::Impl::SetEnabledExtensions(Extension flags) {
+  if (flags != enabled_extensions_) memo_.Clear();
+  enabled_extensions_ = flags;
+}
 
 RewriteSimplifier::Extension RewriteSimplifier::Impl::GetEnabledExtensions() const {
   return enabled_extensions_;
@@ -2471,15 +2474,16 @@ Expr RewriteSimplifier::Impl::VisitExpr_(const LetNode* op) {
 }
 
 PrimExpr RewriteSimplifier::operator()(const PrimExpr& expr) {
-  // Run simplification in post order
-  PrimExpr res = expr;
-  int max_iter = 2;
-  for (int i = 0; i < max_iter; ++i) {
-    PrimExpr new_expr = impl_->VisitPrimExpr(res);
-    if (new_expr.same_as(res)) return res;
-    res = new_expr;
-  }
-  return res;
+  return impl_->MemoizedSimplify(expr, [this](PrimExpr res) {
+    // Run simplification in post order
+    int max_iter = 2;
+    for (int i = 0; i < max_iter; ++i) {
+      PrimExpr new_expr = impl_->VisitPrimExpr(res);
+      if (new_expr.same_as(res)) return res;
+      res = new_expr;
+    }
+    return res;
+  });
 }
 
 void RewriteSimplifier::Update(const Var& var, const PrimExpr& info, bool allow_override) {
@@ -2505,6 +2509,8 @@ void RewriteSimplifier::SetMaximumRewriteSteps(int64_t maximum) {
   impl_->SetMaximumRewriteSteps(maximum);
 }
 
+void RewriteSimplifier::SetMemoTableSize(int64_t size) { impl_->SetMemoTableSize(size); }
+
 RewriteSimplifier::RewriteSimplifier(AnalyzerObj* parent) : impl_(new Impl(parent)) {}
 
 RewriteSimplifier::~RewriteSimplifier() { delete impl_; }
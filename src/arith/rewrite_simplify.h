@@ -25,6 +25,8 @@
 #define TVM_ARITH_REWRITE_SIMPLIFY_H_
 
 #include <tvm/arith/analyzer.h>
+#include <tvm/ffi/extra/structural_equal.h>
+#include <tvm/ffi/extra/structural_hash.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/ir/cow.h>
 #include <tvm/tirx/op.h>
@@ -33,6 +35,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "../support/utils.h"
 #include "const_fold.h"
 #include "ir_mutator_with_analyzer.h"
 #include "pattern_match.h"
@@ -54,6 +57,8 @@ struct RewriteSimplifierStatsNode : ffi::Object {
   int64_t rewrites_performed{0};
   int64_t max_recursive_depth{0};
   int64_t num_recursive_rewrites{0};
+  int64_t memo_hits{0};
+  int64_t memo_misses{0};
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -63,7 +68,9 @@ struct RewriteSimplifierStatsNode : ffi::Object {
         .def_ro("rewrites_attempted", &RewriteSimplifierStatsNode::rewrites_attempted)
         .def_ro("rewrites_performed", &RewriteSimplifierStatsNode::rewrites_performed)
         .def_ro("max_recursive_depth", &RewriteSimplifierStatsNode::max_recursive_depth)
-        .def_ro("num_recursive_rewrites", &RewriteSimplifierStatsNode::num_recursive_rewrites);
+        .def_ro("num_recursive_rewrites", &RewriteSimplifierStatsNode::num_recursive_rewrites)
+        .def_ro("memo_hits", &RewriteSimplifierStatsNode::memo_hits)
+        .def_ro("memo_misses", &RewriteSimplifierStatsNode::memo_misses);
   }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("arith.RewriteSimplifierStats", RewriteSimplifierStatsNode,
                                     ffi::Object);
@@ -79,6 +86,59 @@ struct RewriteSimplifierStats : ffi::ObjectRef {
   TVM_DEFINE_OBJECT_REF_COW_METHOD(RewriteSimplifierStatsNode);
 };
 
+/*!
+ * \brief Bounded memo table of top-level simplification results.
+ *
+ * Entries are keyed by the structure of the input expression and the
+ * state version of the analyzer, so a result is only reused under the
+ * same bindings and constraints.  The table is cleared once it is full.
+ */
+class SimplifyMemoTable {
+ public:
+  /*! \brief Set the maximum number of entries, a non-positive size disables the table. */
+  void SetSize(int64_t size) {
+    size_ = size;
+    table_.clear();
+  }
+
+  /*! \brief Whether the table is enabled. */
+  bool enabled() const { return size_ > 0; }
+
+  /*! \brief Drop all entries. */
+  void Clear() { table_.clear(); }
+
+  /*! \brief Look up the memoized result, nullptr if there is none. */
+  const PrimExpr* Find(const PrimExpr& expr, uint64_t version) const {
+    auto it = table_.find(Key{expr, version});
+    return it == table_.end() ? nullptr : &it->second;
+  }
+
+  /*! \brief Memoize the result of simplifying expr. */
+  void Insert(const PrimExpr& expr, uint64_t version, PrimExpr result) {
+    if (static_cast<int64_t>(table_.size()) >= size_) table_.clear();
+    table_.emplace(Key{expr, version}, std::move(result));
+  }
+
+ private:
+  struct Key {
+    PrimExpr expr;
+    uint64_t version;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return support::HashCombine(ffi::StructuralHash()(key.expr), key.version);
+    }
+  };
+  struct KeyEqual {
+    bool operator()(const Key& lhs, const Key& rhs) const {
+      return lhs.version == rhs.version && ffi::StructuralEqual()(lhs.expr, rhs.expr);
+    }
+  };
+
+  int64_t size_{0};
+  std::unordered_map<Key, PrimExpr, KeyHash, KeyEqual> table_;
+};
+
 /*!
  * \brief Rewrite-based simplifier.
  *
@@ -136,11 +196,48 @@ class RewriteSimplifier::Impl : public IRMutatorWithAnalyzer {
 
   void SetMaximumRewriteSteps(int64_t maximum) { maximum_rewrite_steps_ = maximum; }
 
+  void SetMemoTableSize(int64_t size) { memo_.SetSize(size); }
+
+  /*!
+   * \brief Simplify expr with fsimplify, reusing the memoized result if there is one.
+   *
+   *  Only top-level calls are memoized, since the result of a nested call may depend on
+   *  the state of the enclosing rewrite.
+   */
+  template <typename FSimplify>
+  PrimExpr MemoizedSimplify(const PrimExpr& expr, FSimplify fsimplify) {
+    if (!memo_.enabled() || recur_depth_ != 0 || recursively_visiting_boolean_ ||
+        memo_depth_ != 0 || expr->IsInstance<IntImmNode>()) {
+      return fsimplify(expr);
+    }
+    uint64_t version = analyzer_->state_version();
+    if (const PrimExpr* res = memo_.Find(expr, version)) {
+      stats_.memo_hits++;
+      return *res;
+    }
+    stats_.memo_misses++;
+    ++memo_depth_;
+    PrimExpr res;
+    try {
+      res = fsimplify(expr);
+    } catch (...) {
+      --memo_depth_;
+      throw;
+    }
+    --memo_depth_;
+    // Simplifying may itself bind variables, in which case the result is not memoized.
+    if (analyzer_->state_version() == version) {
+      memo_.Insert(expr, version, res);
+    }
+    return res;
+  }
+
   void CopyFrom(const Impl& other) {
     var_map_ = other.var_map_;
     literal_constraints_ = other.literal_constraints_;
     enabled_extensions_ = other.enabled_extensions_;
     maximum_rewrite_steps_ = other.maximum_rewrite_steps_;
+    memo_.Clear();
   }
 
  protected:
@@ -167,6 +264,11 @@ class RewriteSimplifier::Impl : public IRMutatorWithAnalyzer {
   // Optionally enabled extensions
   Extension enabled_extensions_{kNone};
 
+  // memo of top-level results
+  SimplifyMemoTable memo_;
+  // depth of the memoized calls being evaluated
+  int64_t memo_depth_{0};
+
   /*! Whether the simplifier is current
    */
   bool recursively_visiting_boolean_{false};
@@ -180,6 +180,7 @@ void CodeGenCUDA::Init(bool output_ssa) {
 
 void CodeGenCUDA::PrintFunctionSignature(const ffi::String& function_name, const PrimFunc& func,
                                          std::ostream& os) {
+  current_function_name_ = function_name;
   CallingConv calling_conv =
       func->GetAttr<CallingConv>(tvm::attr::kCallingConv, CallingConv::kDefault).value();
   if (calling_conv == CallingConv::kDeviceKernelLaunch) {
@@ -273,6 +274,15 @@ std::string CodeGenCUDA::Finish() {
     decl_stream << code;
   }
 
+  // The region table read back by the CUDA module together with the profile counters.
+  if (!profile_regions_.empty()) {
+    decl_stream << "extern \"C\" __device__ const char __tvm_profile_regions[] = \"";
+    for (const auto& [id, name] : profile_regions_) {
+      decl_stream << id << ":" << name << ";";
+    }
+    decl_stream << "\";\n";
+  }
+
   return CodeGenC::Finish();
 }
 
@@ -735,6 +745,13 @@ void CodeGenCUDA::PrintStorageSync(const CallNode* op) {
   const std::string& sync = op->args[0].as<StringImmNode>()->value;
   if (sync == "warp") {
     // DO nothing.
+  } else if ((sync == "shared" || sync == "shared.dyn") && op->args.size() == 3) {
+    // A named barrier of the threads of a warp-specialized scope.
+    std::string barrier_id = PrintExpr(op->args[1]);
+    std::string thread_count = PrintExpr(op->args[2]);
+    this->PrintIndent();
+    this->stream << "asm volatile(\"bar.sync %0, %1;\" : : \"r\"(" << barrier_id << "), \"r\"("
+                 << thread_count << ") : \"memory\");\n";
   } else if (sync == "shared" || sync == "shared.dyn") {
     this->PrintIndent();
     this->stream << "__syncthreads();\n";
@@ -1573,6 +1590,35 @@ void CodeGenCUDA::VisitExpr_(const CallNode* op, std::ostream& os) {
     print_cuda_func_call(op, os);
   } else if (op->op.same_as(builtin::thread_return())) {
     os << "return";
+  } else if (op->op.same_as(builtin::start_profile_intrinsic()) ||
+             op->op.same_as(builtin::end_profile_intrinsic())) {
+    // The first thread of each block accumulates the clock64() cycles of the region. The start
+    // value is subtracted up front, which stays exact modulo 2^64 once the end is added.
+    const int64_t* id = as_const_int(op->args[0].as_or_throw<PrimExpr>());
+    TVM_FFI_ICHECK(id) << "The id of a profile intrinsic must be a constant";
+    profile_regions_[*id] = current_function_name_;
+    AddUtilFunction("tvm_builtin_profile",
+                    "extern \"C\" {\n"
+                    "__device__ unsigned long long __tvm_profile_cycles[4096];\n"
+                    "__device__ unsigned long long __tvm_profile_calls[4096];\n"
+                    "}\n"
+                    "__forceinline__ __device__ bool tvm_builtin_profile_leader(int id) {\n"
+                    "  return id >= 0 && id < 4096 && threadIdx.x == 0 && threadIdx.y == 0 &&\n"
+                    "         threadIdx.z == 0;\n"
+                    "}\n"
+                    "__forceinline__ __device__ void tvm_builtin_profile_start(int id) {\n"
+                    "  if (!tvm_builtin_profile_leader(id)) return;\n"
+                    "  atomicAdd(&__tvm_profile_cycles[id],\n"
+                    "            0ULL - (unsigned long long)clock64());\n"
+                    "}\n"
+                    "__forceinline__ __device__ void tvm_builtin_profile_end(int id) {\n"
+                    "  if (!tvm_builtin_profile_leader(id)) return;\n"
+                    "  atomicAdd(&__tvm_profile_cycles[id], (unsigned long long)clock64());\n"
+                    "  atomicAdd(&__tvm_profile_calls[id], 1ULL);\n"
+                    "}\n");
+    os << (op->op.same_as(builtin::start_profile_intrinsic()) ? "tvm_builtin_profile_start("
+                                                               : "tvm_builtin_profile_end(")
+       << *id << ")";
   } else {
     CodeGenC::VisitExpr_(op, os);
   }
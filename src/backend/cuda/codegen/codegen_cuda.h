@@ -28,6 +28,7 @@
 #include <tvm/tirx/expr.h>
 #include <tvm/tirx/op.h>
 
+#include <map>
 #include <string>
 #include <unordered_map>
 
@@ -121,6 +122,11 @@ class CodeGenCUDA final : public CodeGenC {
   // Functions to be added to the util functions during codegen
   std::unordered_map<std::string, std::string> util_funcs_;
 
+  // The name of the function being generated
+  std::string current_function_name_;
+  // The function of each region instrumented with profile intrinsics, by region id
+  std::map<int64_t, std::string> profile_regions_;
+
   // The name prefix of the cuda::barrier array in shared memory
   const std::string cuda_barrier_name_ = "cubar";
   // The name prefix of the cuda::barrier::arrival_token array in registers
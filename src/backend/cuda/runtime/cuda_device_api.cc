@@ -32,6 +32,9 @@
 #include <tvm/runtime/timer.h>
 
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include "../../../runtime/workspace_pool.h"
 
@@ -362,6 +365,30 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                         [](Device dev) { return Timer(ffi::make_object<CUDATimerNode>()); });
 }
 
+/*!
+ * \brief Flush the L2 cache of the device for the time evaluator, by a memset of a device buffer
+ *  of the given size on the current stream, which evicts the data of the previous runs.
+ */
+void CUDACacheFlush(Device dev, int64_t nbytes) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::pair<void*, int64_t>> buffers;
+  std::lock_guard<std::mutex> lock(mutex);
+  CUDADeviceAPI::Global()->SetDevice(dev);
+  auto& [data, size] = buffers[dev.device_id];
+  if (size < nbytes) {
+    if (data != nullptr) TVM_FFI_CHECK_CUDA_ERROR(cudaFree(data));
+    TVM_FFI_CHECK_CUDA_ERROR(cudaMalloc(&data, nbytes));
+    size = nbytes;
+  }
+  cudaStream_t stream = static_cast<cudaStream_t>(TVMFFIEnvGetStream(kDLCUDA, dev.device_id));
+  TVM_FFI_CHECK_CUDA_ERROR(cudaMemsetAsync(data, 0, nbytes, stream));
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("runtime.cache_flush.cuda", CUDACacheFlush);
+}
+
 TVM_RUNTIME_DLL ffi::String GetCudaFreeMemory() {
   size_t free_mem, total_mem;
   TVM_FFI_CHECK_CUDA_ERROR(cudaMemGetInfo(&free_mem, &total_mem));
@@ -33,15 +33,22 @@
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <exception>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "../../../runtime/metadata.h"
 #include "../../../runtime/pack_args.h"
 #include "../../../runtime/thread_storage_scope.h"
 #include "../../../support/bytes_io.h"
+#include "../../../support/utils.h"
 
 namespace tvm {
 namespace runtime {
@@ -64,7 +71,8 @@ static constexpr const int kMaxNumGPUs = 32;
 // Module to support thread-safe multi-GPU execution.
 // cuModule is a per-GPU module
 // The runtime will contain a per-device module table
-// The modules will be lazily loaded
+// The modules will be lazily loaded, each under the lock of its device so that
+// the devices load in parallel
 class CUDAModuleNode : public ffi::ModuleObj {
  public:
   CUDAModuleNode(ffi::Bytes code, ffi::String fmt, ffi::Map<ffi::String, FunctionInfo> fmap,
@@ -136,7 +144,7 @@ class CUDAModuleNode : public ffi::ModuleObj {
 
   // get a CUfunction from primary context in device_id
   CUfunction GetFunc(int device_id, const std::string& func_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(mutex_[device_id]);
     // must recheck under the lock scope
     if (module_[device_id] == nullptr) {
       CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), code_.data()));
@@ -145,6 +153,9 @@ class CUDAModuleNode : public ffi::ModuleObj {
         (*nvshmem_init_hook)(static_cast<void*>(module_[device_id]));
       }
     }
+    if (auto it = func_cache_[device_id].find(func_name); it != func_cache_[device_id].end()) {
+      return it->second;
+    }
     CUfunction func;
     CUresult result = cuModuleGetFunction(&func, module_[device_id], func_name.c_str());
     if (result != CUDA_SUCCESS) {
@@ -153,9 +164,123 @@ class CUDAModuleNode : public ffi::ModuleObj {
       TVM_FFI_THROW(CUDAError) << "cuModuleGetFunction " << func_name
                                << " failed with error: " << msg;
     }
+    func_cache_[device_id][func_name] = func;
     return func;
   }
 
+  /*!
+   * \brief Load the module and the kernels on the devices ahead of the first launch, e.g. while
+   * the model is loaded. Under lazy module loading, the kernels are only loaded by the driver
+   * once they are requested, so that listing the kernels of the first request keeps the others
+   * unloaded.
+   *
+   * \param func_names The kernels to load, all the kernels of the module if empty.
+   * \param device_ids The devices to load on, one thread each, all the devices if empty.
+   */
+  void Preload(const ffi::Array<ffi::String>& func_names, const ffi::Array<int64_t>& device_ids) {
+    std::vector<std::string> names;
+    if (func_names.empty()) {
+      for (const auto& kv : fmap_) {
+        names.push_back(kv.first);
+      }
+    } else {
+      for (const ffi::String& name : func_names) {
+        TVM_FFI_CHECK(fmap_.count(name), ValueError)
+            << "The CUDA module has no function named " << name;
+        names.push_back(name);
+      }
+    }
+    std::vector<int> devices;
+    if (device_ids.empty()) {
+      int num_devices = 0;
+      TVM_FFI_CHECK_CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+      for (int i = 0; i < std::min(num_devices, kMaxNumGPUs); ++i) {
+        devices.push_back(i);
+      }
+    } else {
+      for (int64_t device_id : device_ids) {
+        TVM_FFI_CHECK(device_id >= 0 && device_id < kMaxNumGPUs, ValueError)
+            << "Invalid CUDA device id " << device_id;
+        devices.push_back(static_cast<int>(device_id));
+      }
+    }
+    std::vector<std::exception_ptr> errors(devices.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < devices.size(); ++i) {
+      threads.emplace_back([&, i]() {
+        try {
+          TVM_FFI_CHECK_CUDA_ERROR(cudaSetDevice(devices[i]));
+          // Initialize the primary context, which the module is loaded into.
+          TVM_FFI_CHECK_CUDA_ERROR(cudaFree(nullptr));
+          for (const std::string& name : names) {
+            GetFunc(devices[i], name);
+          }
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+      if (error) std::rethrow_exception(error);
+    }
+  }
+
+  /*!
+   * \brief Read the clock64() counters of the profile intrinsics on a device.
+   *
+   * \param device_id The device whose module instance is read.
+   * \param reset Whether to clear the counters after reading them.
+   * \return A JSON list of the regions that ran, with their kernel, call count and cycles.
+   */
+  ffi::String ReadProfileCounters(int device_id, bool reset) {
+    std::lock_guard<std::mutex> lock(mutex_[device_id]);
+    if (module_[device_id] == nullptr) return "[]";
+    TVM_FFI_CHECK_CUDA_ERROR(cudaSetDevice(device_id));
+    auto read_global = [&](const char* name, std::string* out) {
+      CUdeviceptr ptr;
+      size_t nbytes;
+      if (cuModuleGetGlobal(&ptr, &nbytes, module_[device_id], name) != CUDA_SUCCESS) {
+        return false;
+      }
+      out->resize(nbytes);
+      CUDA_DRIVER_CALL(cuMemcpyDtoH(out->data(), ptr, nbytes));
+      if (reset && std::string(name) != "__tvm_profile_regions") {
+        CUDA_DRIVER_CALL(cuMemsetD8(ptr, 0, nbytes));
+      }
+      return true;
+    };
+    std::string cycles, calls, regions;
+    if (!read_global("__tvm_profile_regions", &regions) ||
+        !read_global("__tvm_profile_cycles", &cycles) ||
+        !read_global("__tvm_profile_calls", &calls)) {
+      return "[]";
+    }
+    const auto* cycle_values = reinterpret_cast<const uint64_t*>(cycles.data());
+    const auto* call_values = reinterpret_cast<const uint64_t*>(calls.data());
+    size_t num_ids = calls.size() / sizeof(uint64_t);
+    // The region table has the form "<id>:<kernel>;<id>:<kernel>;...".
+    std::ostringstream os;
+    os << "[";
+    bool first = true;
+    std::istringstream table(std::string(regions.c_str()));
+    std::string entry;
+    while (std::getline(table, entry, ';')) {
+      size_t colon = entry.find(':');
+      if (colon == std::string::npos) continue;
+      size_t id = std::stoul(entry.substr(0, colon));
+      if (id >= num_ids || call_values[id] == 0) continue;
+      os << (first ? "" : ", ") << "{\"kernel\": \"" << entry.substr(colon + 1)
+         << "\", \"loop\": " << id << ", \"calls\": " << call_values[id]
+         << ", \"cycles\": " << cycle_values[id] << "}";
+      first = false;
+    }
+    os << "]";
+    return os.str();
+  }
+
   /*!
    * \brief JIT-compile raw CUDA C++ source to PTX/cubin/fatbin via the Python
    *        compile callback.  Called from BOTH the
@@ -197,8 +322,10 @@ class CUDAModuleNode : public ffi::ModuleObj {
   ffi::Map<ffi::String, ffi::String> source_;
   // the internal modules per GPU, to be lazily initialized.
   std::array<CUmodule, kMaxNumGPUs> module_;
-  // internal mutex when updating the module
-  std::mutex mutex_;
+  // the functions per GPU already looked up in the module.
+  std::array<std::unordered_map<std::string, CUfunction>, kMaxNumGPUs> func_cache_;
+  // internal mutex per GPU when updating its module
+  std::array<std::mutex, kMaxNumGPUs> mutex_;
 };
 
 // a wrapped function class to get packed func.
@@ -212,6 +339,22 @@ class CUDAWrappedFunc {
     func_name_ = func_name;
     std::fill(fcache_.begin(), fcache_.end(), nullptr);
     launch_param_config_.Init(num_void_args, launch_param_tags);
+    // The launch tags fix these attributes, so build them once instead of on every launch.
+    num_static_attrs_ = 0;
+    // Programmatic stream serialization
+    if (launch_param_config_.use_programtic_dependent_launch()) {
+      CUlaunchAttribute& attr = static_attrs_[num_static_attrs_++];
+      attr = CUlaunchAttribute{};
+      attr.id = CU_LAUNCH_ATTRIBUTE_PROGRAMMATIC_STREAM_SERIALIZATION;
+      attr.value.programmaticStreamSerializationAllowed = 1;
+    }
+    // Cooperative
+    if (launch_param_config_.use_cooperative_launch()) {
+      CUlaunchAttribute& attr = static_attrs_[num_static_attrs_++];
+      attr = CUlaunchAttribute{};
+      attr.id = CU_LAUNCH_ATTRIBUTE_COOPERATIVE;
+      attr.value.cooperative = 1;
+    }
   }
   // invoke the function with void arguments
   void operator()(ffi::PackedArgs args, ffi::Any* rv, void** void_args) const {
@@ -233,43 +376,34 @@ class CUDAWrappedFunc {
       }
     }
     CUstream strm = static_cast<CUstream>(TVMFFIEnvGetStream(kDLCUDA, device_id));
-    std::vector<CUlaunchAttribute> attrs;
+    // The attributes live on the stack: at most the two cluster shapes and the static ones.
+    std::array<CUlaunchAttribute, kMaxLaunchAttrs> attrs;
+    unsigned int num_attrs = 0;
 
     // 1) Cluster
     if (wl.cluster_dim(0) != 1 || wl.cluster_dim(1) != 1 || wl.cluster_dim(2) != 1) {
-      CUlaunchAttribute attr{};
+      CUlaunchAttribute& attr = attrs[num_attrs++];
+      attr = CUlaunchAttribute{};
       attr.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
       attr.value.clusterDim.x = wl.cluster_dim(0);
       attr.value.clusterDim.y = wl.cluster_dim(1);
       attr.value.clusterDim.z = wl.cluster_dim(2);
-      attrs.push_back(attr);
     }
 
     // 1b) Preferred cluster (CUDA 12.8+, cudaLaunchAttributePreferredClusterDimension)
     if (wl.preferred_cluster_dim(0) != 1 || wl.preferred_cluster_dim(1) != 1 ||
         wl.preferred_cluster_dim(2) != 1) {
-      CUlaunchAttribute attr{};
+      CUlaunchAttribute& attr = attrs[num_attrs++];
+      attr = CUlaunchAttribute{};
       attr.id = CU_LAUNCH_ATTRIBUTE_PREFERRED_CLUSTER_DIMENSION;
       attr.value.clusterDim.x = wl.preferred_cluster_dim(0);
       attr.value.clusterDim.y = wl.preferred_cluster_dim(1);
       attr.value.clusterDim.z = wl.preferred_cluster_dim(2);
-      attrs.push_back(attr);
-    }
-
-    // 2) Programmatic stream serialization
-    if (launch_param_config_.use_programtic_dependent_launch()) {
-      CUlaunchAttribute attr{};
-      attr.id = CU_LAUNCH_ATTRIBUTE_PROGRAMMATIC_STREAM_SERIALIZATION;
-      attr.value.programmaticStreamSerializationAllowed = 1;
-      attrs.push_back(attr);
     }
 
-    // 3) Cooperative
-    if (launch_param_config_.use_cooperative_launch()) {
-      CUlaunchAttribute attr{};
-      attr.id = CU_LAUNCH_ATTRIBUTE_COOPERATIVE;
-      attr.value.cooperative = 1;
-      attrs.push_back(attr);
+    // 2) Programmatic stream serialization and cooperative launch, built in Init
+    for (size_t i = 0; i < num_static_attrs_; ++i) {
+      attrs[num_attrs++] = static_attrs_[i];
     }
 
     // 4) Launch
@@ -282,8 +416,8 @@ class CUDAWrappedFunc {
     config.blockDimZ = wl.block_dim(2);
     config.sharedMemBytes = wl.dyn_shmem_size;
     config.hStream = strm;
-    config.attrs = attrs.empty() ? nullptr : attrs.data();
-    config.numAttrs = static_cast<unsigned int>(attrs.size());
+    config.attrs = num_attrs == 0 ? nullptr : attrs.data();
+    config.numAttrs = num_attrs;
 
     CUresult result = cuLaunchKernelEx(&config, fcache_[device_id], void_args, nullptr);
 
@@ -318,11 +452,28 @@ class CUDAWrappedFunc {
   mutable std::array<CUfunction, kMaxNumGPUs> fcache_;
   // launch parameters configuration
   LaunchParamConfig launch_param_config_;
+  // The most launch attributes a single launch sets.
+  static constexpr size_t kMaxLaunchAttrs = 4;
+  // Launch attributes fixed by the launch tags, built once in Init.
+  std::array<CUlaunchAttribute, 2> static_attrs_;
+  // Number of valid entries in static_attrs_.
+  size_t num_static_attrs_{0};
 };
 
 ffi::Optional<ffi::Function> CUDAModuleNode::GetFunction(const ffi::String& name) {
   ffi::ObjectPtr<ffi::Object> sptr_to_self = ffi::GetObjectPtr<ffi::Object>(this);
   TVM_FFI_ICHECK_EQ(sptr_to_self.get(), this);
+  if (name == "__tvm_profile_read") {
+    return ffi::Function::FromTyped([sptr_to_self, this](int device_id, bool reset) {
+      return this->ReadProfileCounters(device_id, reset);
+    });
+  }
+  if (name == "__tvm_preload") {
+    return ffi::Function::FromTyped(
+        [sptr_to_self, this](ffi::Array<ffi::String> func_names, ffi::Array<int64_t> device_ids) {
+          this->Preload(func_names, device_ids);
+        });
+  }
   auto opt_info = fmap_.Get(name);
   if (!opt_info.has_value()) return ffi::Function();
   FunctionInfo info = opt_info.value();
@@ -368,6 +519,42 @@ static ffi::Module CUDAModuleLoadFromBytes(const ffi::Bytes& bytes) {
                               ffi::Map<ffi::String, ffi::String>());
 }
 
+/*!
+ * \brief Make the CUDA driver load the kernels of a module on their first use instead of all at
+ * once when the module is loaded. The driver reads CUDA_MODULE_LOADING at initialization, so this
+ * has no effect once CUDA is initialized in the process.
+ */
+static void EnableLazyModuleLoading() {
+  int num_devices;
+  if (cuDeviceGetCount(&num_devices) != CUDA_ERROR_NOT_INITIALIZED) {
+    LOG(WARNING) << "CUDA is already initialized, lazy module loading only takes effect if it "
+                 << "is enabled before, e.g. by TVM_CUDA_MODULE_LAZY_LOADING=1";
+  }
+  // An explicit setting of the driver takes precedence.
+  if (std::getenv("CUDA_MODULE_LOADING") == nullptr) {
+#ifdef _WIN32
+    _putenv_s("CUDA_MODULE_LOADING", "LAZY");
+#else
+    setenv("CUDA_MODULE_LOADING", "LAZY", 0);
+#endif
+  }
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  if (support::BoolEnvironmentVar("TVM_CUDA_MODULE_LAZY_LOADING")) {
+    EnableLazyModuleLoading();
+  }
+  refl::GlobalDef()
+      .def("runtime.cuda.EnableLazyModuleLoading", EnableLazyModuleLoading)
+      .def("runtime.cuda.ModuleLoadingMode", []() -> ffi::String {
+        CUDA_DRIVER_CALL(cuInit(0));
+        CUmoduleLoadingMode mode;
+        CUDA_DRIVER_CALL(cuModuleGetLoadingMode(&mode));
+        return mode == CU_MODULE_LAZY_LOADING ? "lazy" : "eager";
+      });
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
   // Registry: "ffi.Module.create.cuda" — codegen-time CUDA module factory.
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cuda_stream_ordered_allocator.cc
+ * \brief The stream-ordered allocator of CUDA devices, backed by cudaMallocAsync memory pools.
+ *
+ * Buffers are allocated and freed on the current stream of the device with
+ * cudaMallocFromPoolAsync and cudaFreeAsync, which do not synchronize the device. A freed
+ * block is reused by later allocations on any stream, as the pool tracks the stream
+ * dependencies, and inside of CUDA graph captures. The pool keeps the freed memory up to the
+ * release threshold, and returns the rest to the driver at the next synchronization, so that
+ * other processes on a shared GPU can use it.
+ */
+#include <cuda_runtime.h>
+#include <tvm/ffi/container/map.h>
+#include <tvm/ffi/extra/c_env_api.h>
+#include <tvm/ffi/extra/cuda/base.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/memory/memory_manager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#include "../../../support/env.h"
+
+namespace tvm {
+namespace runtime {
+namespace memory {
+
+// The memory pools of the stream-ordered allocator need CUDA 11.2.
+#if CUDART_VERSION >= 11020
+
+/*! \brief The statistics of a stream-ordered allocator, in bytes. */
+struct CUDAStreamOrderedAllocatorStats {
+  /*! \brief The device memory held by the pool, in use or not. */
+  uint64_t reserved_bytes = 0;
+  /*! \brief The memory of the live allocations of the pool. */
+  uint64_t used_bytes = 0;
+  /*! \brief The peak of the reserved memory. */
+  uint64_t reserved_bytes_high = 0;
+  /*! \brief The release threshold of the pool. */
+  uint64_t release_threshold = 0;
+};
+
+/*!
+ * \brief An allocator over a cudaMallocAsync memory pool per device.
+ *
+ * The release threshold of a new pool is read from TVM_CUDA_MEM_POOL_RELEASE_THRESHOLD, in
+ * bytes, and defaults to keeping all freed memory, as the pooled allocator does.
+ */
+class CUDAStreamOrderedAllocator final : public Allocator {
+ public:
+  CUDAStreamOrderedAllocator()
+      : Allocator(kStreamOrdered),
+        release_threshold_(support::GetEnv<uint64_t>("TVM_CUDA_MEM_POOL_RELEASE_THRESHOLD",
+                                                     std::numeric_limits<uint64_t>::max())) {}
+
+  Buffer Alloc(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) final {
+    TVM_FFI_ICHECK_EQ(256 % alignment, 0U) << "CUDA space is aligned at 256 bytes";
+    TVM_FFI_CHECK_CUDA_ERROR(cudaSetDevice(dev.device_id));
+    cudaMemPool_t pool = GetPool(dev.device_id);
+    cudaStream_t stream = CurrentStream(dev);
+    Buffer buf;
+    buf.device = dev;
+    buf.size = nbytes;
+    buf.alloc_type = kStreamOrdered;
+    cudaError_t err = cudaMallocFromPoolAsync(&buf.data, nbytes, pool, stream);
+    if (err == cudaErrorMemoryAllocation) {
+      // Release the memory the pool holds but does not use, once the pending frees are done.
+      cudaGetLastError();
+      LOG(WARNING) << "cudaMallocAsync of " << nbytes << " bytes failed, trimming the pool of "
+                   << dev << " and retrying";
+      TVM_FFI_CHECK_CUDA_ERROR(cudaStreamSynchronize(stream));
+      TVM_FFI_CHECK_CUDA_ERROR(cudaMemPoolTrimTo(pool, 0));
+      err = cudaMallocFromPoolAsync(&buf.data, nbytes, pool, stream);
+    }
+    TVM_FFI_CHECK_CUDA_ERROR(err);
+    used_memory_.fetch_add(nbytes, std::memory_order_relaxed);
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) final {
+    if (std::uncaught_exceptions() && cudaPeekAtLastError() == cudaErrorIllegalAddress) {
+      // The driver is in a sticky error state, see CUDADeviceAPI::FreeDataSpace.
+      return;
+    }
+    TVM_FFI_CHECK_CUDA_ERROR(cudaSetDevice(buffer.device.device_id));
+    TVM_FFI_CHECK_CUDA_ERROR(cudaFreeAsync(buffer.data, CurrentStream(buffer.device)));
+    used_memory_.fetch_sub(buffer.size, std::memory_order_relaxed);
+  }
+
+  void Clear() final {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& [device_id, pool] : pools_) {
+      TVM_FFI_CHECK_CUDA_ERROR(cudaSetDevice(device_id));
+      TVM_FFI_CHECK_CUDA_ERROR(cudaDeviceSynchronize());
+      TVM_FFI_CHECK_CUDA_ERROR(cudaMemPoolTrimTo(pool, 0));
+    }
+  }
+
+  size_t UsedMemory() const final { return used_memory_.load(std::memory_order_relaxed); }
+
+  /*! \brief Set the release threshold of the pools, including the ones created later. */
+  void SetReleaseThreshold(uint64_t release_threshold) {
+    std::lock_guard<std::mutex> lock(mu_);
+    release_threshold_ = release_threshold;
+    for (const auto& [device_id, pool] : pools_) {
+      TVM_FFI_CHECK_CUDA_ERROR(
+          cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &release_threshold_));
+    }
+  }
+
+  CUDAStreamOrderedAllocatorStats GetStats(Device dev) {
+    CUDAStreamOrderedAllocatorStats stats;
+    cudaMemPool_t pool = GetPool(dev.device_id);
+    TVM_FFI_CHECK_CUDA_ERROR(
+        cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemCurrent, &stats.reserved_bytes));
+    TVM_FFI_CHECK_CUDA_ERROR(
+        cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemCurrent, &stats.used_bytes));
+    TVM_FFI_CHECK_CUDA_ERROR(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemHigh,
+                                                     &stats.reserved_bytes_high));
+    TVM_FFI_CHECK_CUDA_ERROR(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReleaseThreshold,
+                                                     &stats.release_threshold));
+    return stats;
+  }
+
+ private:
+  static cudaStream_t CurrentStream(Device dev) {
+    return static_cast<cudaStream_t>(TVMFFIEnvGetStream(kDLCUDA, dev.device_id));
+  }
+
+  /*! \brief Get the pool of the device, creating it on the first use. */
+  cudaMemPool_t GetPool(int device_id) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = pools_.find(device_id);
+    if (it != pools_.end()) return it->second;
+    int supported = 0;
+    TVM_FFI_CHECK_CUDA_ERROR(
+        cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, device_id));
+    TVM_FFI_ICHECK(supported) << "CUDA device " << device_id
+                              << " does not support stream-ordered memory pools";
+    cudaMemPoolProps props = {};
+    props.allocType = cudaMemAllocationTypePinned;
+    props.handleTypes = cudaMemHandleTypeNone;
+    props.location.type = cudaMemLocationTypeDevice;
+    props.location.id = device_id;
+    cudaMemPool_t pool;
+    TVM_FFI_CHECK_CUDA_ERROR(cudaMemPoolCreate(&pool, &props));
+    TVM_FFI_CHECK_CUDA_ERROR(
+        cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &release_threshold_));
+    VLOG(1) << "New stream-ordered memory pool on CUDA device " << device_id
+            << " with release threshold " << release_threshold_;
+    pools_.emplace(device_id, pool);
+    return pool;
+  }
+
+  std::mutex mu_;
+  std::unordered_map<int, cudaMemPool_t> pools_;
+  uint64_t release_threshold_;
+  std::atomic<size_t> used_memory_{0};
+};
+
+/*! \brief Get the stream-ordered allocator of the device, creating it if needed. */
+CUDAStreamOrderedAllocator* GetStreamOrderedAllocator(Device dev) {
+  auto* allocator = dynamic_cast<CUDAStreamOrderedAllocator*>(
+      MemoryManager::GetOrCreateAllocator(dev, kStreamOrdered));
+  TVM_FFI_ICHECK(allocator != nullptr)
+      << "The stream-ordered allocator of " << dev << " is not a CUDAStreamOrderedAllocator";
+  return allocator;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("DeviceAllocator.cuda",
+           [](Device dev, int type) -> void* {
+             // The other allocator types use the generic allocators.
+             if (type != kStreamOrdered) return nullptr;
+             return static_cast<Allocator*>(new CUDAStreamOrderedAllocator());
+           })
+      .def("vm.builtin.memory_manager.stream_ordered_allocator_set_release_threshold",
+           [](Device dev, int64_t release_threshold) {
+             TVM_FFI_ICHECK_GE(release_threshold, 0);
+             GetStreamOrderedAllocator(dev)->SetReleaseThreshold(
+                 static_cast<uint64_t>(release_threshold));
+           })
+      .def("vm.builtin.memory_manager.stream_ordered_allocator_stats", [](Device dev) {
+        CUDAStreamOrderedAllocatorStats stats = GetStreamOrderedAllocator(dev)->GetStats(dev);
+        ffi::Map<ffi::String, int64_t> result;
+        result.Set("reserved_bytes", static_cast<int64_t>(stats.reserved_bytes));
+        result.Set("used_bytes", static_cast<int64_t>(stats.used_bytes));
+        result.Set("reserved_bytes_high", static_cast<int64_t>(stats.reserved_bytes_high));
+        result.Set("release_threshold",
+                   static_cast<int64_t>(std::min<uint64_t>(
+                       stats.release_threshold, std::numeric_limits<int64_t>::max())));
+        return result;
+      });
+}
+
+#endif  // CUDART_VERSION >= 11020
+
+}  // namespace memory
+}  // namespace runtime
+}  // namespace tvm
@@ -200,6 +200,16 @@ void HexagonDeviceAPI::CopyDataFromTo(const void* from, size_t from_offset, void
   memcpy(static_cast<char*>(to) + to_offset, static_cast<const char*>(from) + from_offset, size);
 }
 
+bool ParallelLaunchOnHvxThreads(FTVMParallelLambda flambda, void* cdata, int num_task,
+                                int* result) {
+  HexagonDeviceAPI* api = HexagonDeviceAPI::Global();
+  if (!api->HasThreadManager() || api->ThreadManager()->NumHvxThreads() == 0) {
+    return false;
+  }
+  *result = api->ThreadManager()->ParallelLaunch(flambda, cdata, num_task);
+  return true;
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
   refl::GlobalDef()
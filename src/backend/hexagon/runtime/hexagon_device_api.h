@@ -149,6 +149,9 @@ class HexagonDeviceAPI final : public DeviceAPI {
    */
   void CopyDataFromTo(DLTensor* from, DLTensor* to, TVMStreamHandle stream) final;
 
+  //! \brief Whether the runtime threads have been created by AcquireResources.
+  bool HasThreadManager() const { return runtime_threads != nullptr; }
+
   HexagonThreadManager* ThreadManager() {
     TVM_FFI_ICHECK(runtime_threads) << "runtime_threads has not been created";
     return runtime_threads.get();
@@ -201,6 +204,19 @@ class HexagonDeviceAPI final : public DeviceAPI {
   //! \brief Hexagon power manager
   std::unique_ptr<HexagonPowerManager> runtime_power_manager;
 };
+
+/*!
+ * \brief Run a parallel launch on the HVX threads of the runtime thread manager.
+ * \param flambda The parallel lambda of `TVMBackendParallelLaunch`.
+ * \param cdata The closure data of the lambda.
+ * \param num_task Number of tasks; 0 launches one task per HVX thread.
+ * \param result The return value of the launch.
+ * \returns Whether the launch ran; false if the resources are not acquired or there is no HVX
+ * thread, in which case the caller falls back to the generic thread pool.
+ */
+bool ParallelLaunchOnHvxThreads(FTVMParallelLambda flambda, void* cdata, int num_task,
+                                int* result);
+
 }  // namespace hexagon
 }  // namespace runtime
 }  // namespace tvm
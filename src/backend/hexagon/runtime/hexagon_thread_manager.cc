@@ -21,10 +21,43 @@
 
 #include <tvm/runtime/logging.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace tvm {
 namespace runtime {
 namespace hexagon {
 
+namespace {
+
+//! \brief Stride of the sync counters, in the layout `TVMBackendParallelBarrier` reads them.
+constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
+
+inline bool IsHvx(HardwareResourceType resource_type) {
+  return (resource_type == HVX_0) || (resource_type == HVX_1) || (resource_type == HVX_2) ||
+         (resource_type == HVX_3);
+}
+
+//! \brief One task of a parallel launch; dispatched to an HVX thread.
+struct ParallelTask {
+  FTVMParallelLambda flambda;
+  void* cdata;
+  int task_id;
+  TVMParallelGroupEnv* env;
+  std::atomic<int>* num_failed;
+  qurt_sem_t* done;
+};
+
+void RunParallelTask(void* args) {
+  ParallelTask* task = static_cast<ParallelTask*>(args);
+  if ((*task->flambda)(task->task_id, task->env, task->cdata) != 0) {
+    task->num_failed->fetch_add(1, std::memory_order_relaxed);
+  }
+  qurt_sem_up(task->done);
+}
+
+}  // namespace
+
 HexagonThreadManager::HexagonThreadManager(unsigned num_threads, unsigned thread_stack_size_bytes,
                                            unsigned thread_pipe_size_words,
                                            const std::vector<HardwareResourceType> hw_resources) {
@@ -266,6 +299,60 @@ void HexagonThreadManager::WaitOnThreads() {
   }
 }
 
+unsigned HexagonThreadManager::NumHvxThreads() const {
+  return std::count_if(hw_resources_.begin(), hw_resources_.end(), IsHvx);
+}
+
+int HexagonThreadManager::ParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
+  // The managed threads run their commands in order, so a launch from one of them would wait on
+  // itself. Run it inline instead.
+  if (std::find(threads_.begin(), threads_.end(), qurt_thread_get_id()) != threads_.end()) {
+    std::atomic<int> sync_counter{0};
+    TVMParallelGroupEnv env;
+    env.num_task = 1;
+    env.sync_handle = &sync_counter;
+    return (*flambda)(0, &env, cdata);
+  }
+
+  std::vector<TVMStreamHandle> hvx_threads;
+  for (unsigned i = 0; i < hw_resources_.size(); i++) {
+    if (IsHvx(hw_resources_[i])) {
+      hvx_threads.push_back(reinterpret_cast<TVMStreamHandle>(i));
+    }
+  }
+  TVM_FFI_ICHECK(!hvx_threads.empty()) << "No HVX thread to run the parallel launch on";
+  int num_hvx = static_cast<int>(hvx_threads.size());
+  num_task = num_task <= 0 ? num_hvx : std::min(num_task, num_hvx);
+
+  std::lock_guard<std::mutex> lock(parallel_launch_mutex_);
+  // In case Start() was never explicitly called, call it now to prevent deadlock
+  if (qurt_sem_get_val(&start_semaphore_) == 0) {
+    Start();
+  }
+
+  std::unique_ptr<std::atomic<int>[]> sync_counters(new std::atomic<int>[num_task * kSyncStride]());
+  TVMParallelGroupEnv env;
+  env.num_task = num_task;
+  env.sync_handle = sync_counters.get();
+  std::atomic<int> num_failed{0};
+  qurt_sem_t done;
+  qurt_sem_init_val(&done, 0);
+
+  std::vector<ParallelTask> tasks(num_task);
+  for (int i = 0; i < num_task; i++) {
+    tasks[i] = {flambda, cdata, i, &env, &num_failed, &done};
+    bool success = Dispatch(hvx_threads[i], RunParallelTask, &tasks[i]);
+    while (!success) {
+      success = Dispatch(hvx_threads[i], RunParallelTask, &tasks[i]);
+    }
+  }
+  for (int i = 0; i < num_task; i++) {
+    qurt_sem_down(&done);
+  }
+  qurt_sem_destroy(&done);
+  return num_failed.load(std::memory_order_relaxed) == 0 ? 0 : -1;
+}
+
 void HexagonThreadManager::CheckSemaphore(unsigned syncID) {
   // We want the success case to be fast, so do not lock the mutex
   if (semaphores_.find(syncID) == semaphores_.end()) {
@@ -328,8 +415,7 @@ void HexagonThreadManager::thread_exit(void* context) {
   unsigned index = tc->index;
   HardwareResourceType resource_type = tc->resource_type;
 
-  if ((resource_type == HVX_0) || (resource_type == HVX_1) || (resource_type == HVX_2) ||
-      (resource_type == HVX_3)) {
+  if (IsHvx(resource_type)) {
     tc->hvx->Unlock();
     DLOG(INFO) << "Thread " << index << " unlocked an HVX instance";
   } else if (resource_type == HTP_0) {
@@ -350,8 +436,7 @@ void HexagonThreadManager::thread_main(void* context) {
 
   DLOG(INFO) << "Thread " << index << " spawned";
 
-  if ((resource_type == HVX_0) || (resource_type == HVX_1) || (resource_type == HVX_2) ||
-      (resource_type == HVX_3)) {
+  if (IsHvx(resource_type)) {
     tc->hvx->Lock();
     DLOG(INFO) << "Thread " << index << " locked an HVX instance";
   } else if (resource_type == HTP_0) {
@@ -23,8 +23,10 @@
 #include <tvm/ffi/error.h>
 #include <tvm/ffi/function.h>
 #include <tvm/runtime/base.h>
+#include <tvm/runtime/c_backend_api.h>
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -144,6 +146,19 @@ class HexagonThreadManager {
   //! \brief Unblock threads to start execution if `Start` has not already been called; blocking
   //! call to wait until all threads have empty pipes.
   void WaitOnThreads();
+  /*!
+   * \brief Run the tasks of a parallel launch on the HVX threads and wait for them to finish.
+   * \param flambda The parallel lambda of `TVMBackendParallelLaunch`.
+   * \param cdata The closure data of the lambda.
+   * \param num_task Number of tasks; 0 launches one task per HVX thread.
+   * \returns 0 when all tasks succeed, -1 otherwise.
+   * \note The number of tasks is clamped to the number of HVX threads, so that the tasks run
+   * concurrently and may sync with `TVMBackendParallelBarrier`. A launch from one of the managed
+   * threads, e.g. a nested launch, runs inline as a single task.
+   */
+  int ParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task);
+  //! \brief Number of threads that own an HVX instance.
+  unsigned NumHvxThreads() const;
 
  private:
   struct ThreadContext {
@@ -216,6 +231,9 @@ class HexagonThreadManager {
   //! \brief Protects updates to semaphores_
   std::mutex semaphores_mutex_;
 
+  //! \brief Serializes the parallel launches from different caller threads.
+  std::mutex parallel_launch_mutex_;
+
   //! \brief Start semaphore created at time of construction; signled by `Start`.
   qurt_sem_t start_semaphore_;
 
@@ -35,6 +35,7 @@
 #include <tvm/runtime/base.h>
 #include <tvm/runtime/device_api.h>
 
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -102,6 +103,55 @@ class AutoReleasePoolWrapper {
   AutoReleasePoolWrapper& operator=(const AutoReleasePoolWrapper&) = delete;
 };
 
+/*! \brief A kernel dispatch recorded by Stream::BeginCapture/EndCapture. */
+struct MetalDispatch {
+  /*! \brief The pipeline state, created with indirect command buffer support. */
+  id<MTLComputePipelineState> pipeline_state = nil;
+  /*! \brief The buffer arguments, bound from index 0. */
+  std::vector<id<MTLBuffer>> buffers;
+  /*! \brief The packed scalar arguments, bound after the buffers, empty when there are none. */
+  std::vector<uint8_t> bytes;
+  /*! \brief The number of threadgroups. */
+  MTLSize grid;
+  /*! \brief The number of threads of a threadgroup. */
+  MTLSize block;
+};
+
+/*!
+ * \brief A sequence of kernel dispatches recorded once by Stream::BeginCapture/EndCapture,
+ * and replayed any number of times by Stream::Replay, the Metal counterpart of an
+ * instantiated CUDA graph.
+ *
+ * The dispatches are encoded into an indirect command buffer, with a barrier before each
+ * dispatch to keep them in order, so a replay costs a single encoder call instead of one
+ * per kernel.  Since the buffers and the scalar arguments of the kernels are baked into the
+ * commands, a graph may only be replayed while the contents of the buffers it accesses are
+ * alive.  The graph retains the buffers, so replaying after they are freed does not crash.
+ */
+class MetalCommandGraph {
+ public:
+  MetalCommandGraph(id<MTLDevice> device, const std::vector<MetalDispatch>& dispatches);
+  ~MetalCommandGraph();
+
+  MetalCommandGraph(const MetalCommandGraph&) = delete;
+  MetalCommandGraph& operator=(const MetalCommandGraph&) = delete;
+
+  /*! \brief Execute the recorded dispatches from the compute encoder. */
+  void Encode(id<MTLComputeCommandEncoder> encoder) const;
+
+ private:
+  // The recorded commands, nil when no dispatch was recorded.
+  id<MTLIndirectCommandBuffer> icb_ = nil;
+  // The packed scalar arguments of all dispatches.
+  id<MTLBuffer> arg_buffer_ = nil;
+  // The retained buffers that the commands access, made resident on every replay.
+  std::vector<id<MTLResource>> resources_;
+  // The retained pipeline states of the commands.
+  std::vector<id<MTLComputePipelineState>> pipeline_states_;
+  // Number of recorded commands.
+  NSUInteger num_commands_{0};
+};
+
 /*!
  * \brief Metal command stream with batched dispatch support.
  *
@@ -118,7 +168,7 @@ class AutoReleasePoolWrapper {
  */
 class Stream {
  public:
-  explicit Stream(id<MTLDevice> device) { queue_ = [device newCommandQueue]; }
+  explicit Stream(id<MTLDevice> device) : device_(device) { queue_ = [device newCommandQueue]; }
   // Stream is only destroyed during MetalWorkspace teardown (process exit
   // or ReinitializeDefaultStreams), so no GPU work is in flight. We flush
   // to commit any pending CB but do not wait for completion.
@@ -172,6 +222,59 @@ class Stream {
     return pending_compute_encoder_;
   }
 
+  /*!
+   * \brief Bind a pipeline state to the pending compute encoder.
+   *
+   * The encoder keeps its pipeline state and argument table across
+   * dispatches, so binding the state it already holds is skipped.
+   */
+  void SetComputePipelineState(id<MTLComputePipelineState> state) {
+    TVM_FFI_ICHECK(pending_compute_encoder_ != nil);
+    if (bound_pipeline_state_ == state) {
+      profile.skipped_bindings++;
+      return;
+    }
+    [pending_compute_encoder_ setComputePipelineState:state];
+    bound_pipeline_state_ = state;
+  }
+
+  /*!
+   * \brief Bind a buffer at the argument index of the pending compute encoder,
+   *  unless the same buffer is bound there already.
+   *
+   * The cached buffers are not retained: they stay valid because
+   * FreeDataSpace flushes the stream, which ends the encoder and drops the cache.
+   */
+  void SetComputeBuffer(id<MTLBuffer> buffer, size_t index) {
+    TVM_FFI_ICHECK(pending_compute_encoder_ != nil);
+    ComputeBinding& binding = GetComputeBinding(index);
+    if (binding.bytes.empty() && binding.buffer == buffer) {
+      profile.skipped_bindings++;
+      return;
+    }
+    [pending_compute_encoder_ setBuffer:buffer offset:0 atIndex:index];
+    binding.buffer = buffer;
+    binding.bytes.clear();
+  }
+
+  /*!
+   * \brief Copy the bytes to the argument index of the pending compute encoder,
+   *  unless the same bytes are bound there already.
+   */
+  void SetComputeBytes(const void* bytes, size_t length, size_t index) {
+    TVM_FFI_ICHECK(pending_compute_encoder_ != nil);
+    ComputeBinding& binding = GetComputeBinding(index);
+    if (binding.bytes.size() == length && length != 0 &&
+        std::memcmp(binding.bytes.data(), bytes, length) == 0) {
+      profile.skipped_bindings++;
+      return;
+    }
+    [pending_compute_encoder_ setBytes:bytes length:length atIndex:index];
+    const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+    binding.buffer = nil;
+    binding.bytes.assign(begin, begin + length);
+  }
+
   /*!
    * \brief Get a blit encoder on the pending command buffer.
    *
@@ -185,6 +288,8 @@ class Stream {
    * and before subsequent ones.
    */
   id<MTLBlitCommandEncoder> GetBlitEncoderOnPendingBuffer() {
+    TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+        << "Cannot copy on a Metal stream while its dispatches are captured";
     EndPendingComputeEncoder();
     id<MTLCommandBuffer> cb = GetOrCreatePendingCommandBuffer();
     profile.blits++;
@@ -210,6 +315,8 @@ class Stream {
    * \brief Flush pending work, then wait for all submitted work to complete.
    */
   void Synchronize() {
+    TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+        << "Cannot synchronize a Metal stream while its dispatches are captured";
     FlushCommandBuffer();
     id<MTLCommandBuffer> cb = [queue_ commandBuffer];
     [cb addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
@@ -225,6 +332,48 @@ class Stream {
 
   bool HasPendingWork() const { return pending_command_buffer_ != nil; }
 
+  /*!
+   * \brief Start recording the kernel dispatches into a MetalCommandGraph.
+   *
+   * Until EndCapture, the launched kernels are recorded but not
+   * executed, while copies and synchronizations are errors.
+   */
+  void BeginCapture() {
+    TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+        << "The dispatches of the Metal stream are already captured";
+    capturing_ = true;
+  }
+
+  /*! \brief Stop recording and return the recorded dispatches. */
+  std::unique_ptr<MetalCommandGraph> EndCapture() {
+    TVM_FFI_CHECK(IsCapturing(), RuntimeError)
+        << "The dispatches of the Metal stream are not captured";
+    capturing_ = false;
+    std::vector<MetalDispatch> dispatches;
+    std::swap(dispatches, captured_dispatches_);
+    return std::make_unique<MetalCommandGraph>(device_, dispatches);
+  }
+
+  /*! \brief Whether the stream is recording a MetalCommandGraph. */
+  bool IsCapturing() const { return capturing_; }
+
+  /*! \brief Record a kernel dispatch while capturing. */
+  void RecordDispatch(MetalDispatch dispatch) {
+    TVM_FFI_ICHECK(IsCapturing());
+    captured_dispatches_.push_back(std::move(dispatch));
+  }
+
+  /*! \brief Execute the recorded dispatches on the pending compute encoder. */
+  void Replay(const MetalCommandGraph& graph) {
+    TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+        << "Cannot replay a captured Metal command graph while capturing another";
+    graph.Encode(GetPendingComputeEncoder());
+    // The executed commands leave the bindings of the encoder undefined.
+    bound_pipeline_state_ = nil;
+    bound_args_.clear();
+    profile.replays++;
+  }
+
   /*! \brief Profiling counters for diagnosing dispatch/copy/sync overhead. */
   struct ProfileCounters {
     size_t dispatches = 0;
@@ -235,6 +384,8 @@ class Stream {
     size_t cpu_to_gpu = 0;
     size_t gpu_to_gpu = 0;
     size_t free_syncs = 0;  // FreeDataSpace calls that triggered a sync
+    size_t skipped_bindings = 0;  // encoder bindings that were already set
+    size_t replays = 0;           // replays of captured command graphs
 
     void Reset() { *this = ProfileCounters(); }
   };
@@ -276,14 +427,40 @@ class Stream {
       [pending_compute_encoder_ release];
       pending_compute_encoder_ = nil;
     }
+    bound_pipeline_state_ = nil;
+    bound_args_.clear();
+  }
+
+  /*! \brief An argument binding of the pending compute encoder. */
+  struct ComputeBinding {
+    // The bound buffer, nil when bytes are bound.
+    id<MTLBuffer> buffer = nil;
+    // A copy of the bound bytes, empty when a buffer is bound.
+    std::vector<uint8_t> bytes;
+  };
+
+  /*! \brief Get the cached binding at the argument index of the pending compute encoder. */
+  ComputeBinding& GetComputeBinding(size_t index) {
+    if (bound_args_.size() <= index) bound_args_.resize(index + 1);
+    return bound_args_[index];
   }
 
+  // The device of the queue
+  id<MTLDevice> device_;
   // Queue
   id<MTLCommandQueue> queue_;
   // Pending command buffer (shared by compute and blit encoders)
   id<MTLCommandBuffer> pending_command_buffer_ = nil;
   // Active compute encoder on the pending command buffer (nil when paused/blit)
   id<MTLComputeCommandEncoder> pending_compute_encoder_ = nil;
+  // Pipeline state bound to the active compute encoder
+  id<MTLComputePipelineState> bound_pipeline_state_ = nil;
+  // Argument bindings of the active compute encoder, indexed by argument index
+  std::vector<ComputeBinding> bound_args_;
+  // Whether the dispatches are recorded instead of encoded
+  bool capturing_{false};
+  // The dispatches recorded since BeginCapture
+  std::vector<MetalDispatch> captured_dispatches_;
   // Last dispatched kernel name (for error diagnostics)
   std::string last_dispatched_kernel_;
   // Check if error happened in one previous run
@@ -24,6 +24,11 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/timer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
 #include "metal_common.h"
 
 namespace tvm {
@@ -224,6 +229,88 @@ Stream* MetalWorkspace::CastStreamOrGetDefault(TVMStreamHandle stream, int devic
   return default_streams_[device_id];
 }
 
+MetalCommandGraph::MetalCommandGraph(id<MTLDevice> device,
+                                     const std::vector<MetalDispatch>& dispatches)
+    : num_commands_(dispatches.size()) {
+  if (dispatches.empty()) return;
+  // The offset of a buffer bound to a kernel must be aligned, 256 bytes is enough on all GPUs.
+  constexpr size_t kArgAlignment = 256;
+  auto aligned_size = [](size_t size) {
+    return (size + kArgAlignment - 1) / kArgAlignment * kArgAlignment;
+  };
+  size_t arg_buffer_size = 0;
+  NSUInteger max_bind_count = 1;
+  for (const MetalDispatch& dispatch : dispatches) {
+    arg_buffer_size += aligned_size(dispatch.bytes.size());
+    NSUInteger bind_count = dispatch.buffers.size() + (dispatch.bytes.empty() ? 0 : 1);
+    max_bind_count = std::max(max_bind_count, bind_count);
+  }
+  if (arg_buffer_size != 0) {
+    arg_buffer_ = [device newBufferWithLength:arg_buffer_size
+                                      options:MTLResourceStorageModeShared];
+    TVM_FFI_ICHECK(arg_buffer_ != nil)
+        << "Failed to allocate the argument buffer of size " << arg_buffer_size;
+    resources_.push_back([arg_buffer_ retain]);
+  }
+
+  MTLIndirectCommandBufferDescriptor* desc = [[MTLIndirectCommandBufferDescriptor alloc] init];
+  desc.commandTypes = MTLIndirectCommandTypeConcurrentDispatch;
+  desc.inheritBuffers = NO;
+  desc.inheritPipelineState = NO;
+  desc.maxKernelBufferBindCount = max_bind_count;
+  icb_ = [device newIndirectCommandBufferWithDescriptor:desc
+                                        maxCommandCount:num_commands_
+                                                options:0];
+  [desc release];
+  TVM_FFI_ICHECK(icb_ != nil) << "Failed to create an indirect command buffer of "
+                              << num_commands_ << " commands";
+
+  std::unordered_set<void*> retained;
+  size_t arg_offset = 0;
+  for (NSUInteger i = 0; i < num_commands_; ++i) {
+    const MetalDispatch& dispatch = dispatches[i];
+    id<MTLIndirectComputeCommand> cmd = [icb_ indirectComputeCommandAtIndex:i];
+    [cmd setComputePipelineState:dispatch.pipeline_state];
+    pipeline_states_.push_back([dispatch.pipeline_state retain]);
+    for (size_t j = 0; j < dispatch.buffers.size(); ++j) {
+      id<MTLBuffer> buffer = dispatch.buffers[j];
+      [cmd setKernelBuffer:buffer offset:0 atIndex:j];
+      if (retained.insert((void*)(buffer)).second) {
+        resources_.push_back([buffer retain]);
+      }
+    }
+    if (!dispatch.bytes.empty()) {
+      std::memcpy(static_cast<char*>([arg_buffer_ contents]) + arg_offset, dispatch.bytes.data(),
+                  dispatch.bytes.size());
+      [cmd setKernelBuffer:arg_buffer_ offset:arg_offset atIndex:dispatch.buffers.size()];
+      arg_offset += aligned_size(dispatch.bytes.size());
+    }
+    // A kernel may read the outputs of the previous one, as on a serial encoder.
+    [cmd setBarrier];
+    [cmd concurrentDispatchThreadgroups:dispatch.grid threadsPerThreadgroup:dispatch.block];
+  }
+}
+
+MetalCommandGraph::~MetalCommandGraph() {
+  for (id<MTLResource> resource : resources_) {
+    [resource release];
+  }
+  for (id<MTLComputePipelineState> state : pipeline_states_) {
+    [state release];
+  }
+  if (arg_buffer_ != nil) [arg_buffer_ release];
+  if (icb_ != nil) [icb_ release];
+}
+
+void MetalCommandGraph::Encode(id<MTLComputeCommandEncoder> encoder) const {
+  if (num_commands_ == 0) return;
+  // The commands of an indirect command buffer do not make their buffers resident.
+  [encoder useResources:resources_.data()
+                  count:resources_.size()
+                  usage:MTLResourceUsageRead | MTLResourceUsageWrite];
+  [encoder executeCommandsInBuffer:icb_ withRange:NSMakeRange(0, num_commands_)];
+}
+
 void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void* to,
                                     size_t to_offset, size_t size, Device dev_from, Device dev_to,
                                     DLDataType type_hint, TVMStreamHandle stream) {
@@ -234,6 +321,8 @@ void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
     if (s->HasErrorHappened()) {
       LOG(FATAL) << "GPUError: " << s->ErrorDescription();
     }
+    TVM_FFI_CHECK(!s->IsCapturing(), RuntimeError)
+        << "Cannot copy on a Metal stream while its dispatches are captured";
     int from_dev_type = static_cast<int>(dev_from.device_type);
     int to_dev_type = static_cast<int>(dev_to.device_type);
 
@@ -416,6 +505,8 @@ TVM_FFI_STATIC_INIT_BLOCK() {
              result.Set("cpu_to_gpu", static_cast<int64_t>(p.cpu_to_gpu));
              result.Set("gpu_to_gpu", static_cast<int64_t>(p.gpu_to_gpu));
              result.Set("free_syncs", static_cast<int64_t>(p.free_syncs));
+             result.Set("skipped_bindings", static_cast<int64_t>(p.skipped_bindings));
+             result.Set("replays", static_cast<int64_t>(p.replays));
              return result;
            })
       .def("metal.ResetProfileCounters", [](int device_id) {
@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file metal_graph_builtin.mm
+ * \brief The Metal command graph related builtin functions for Relax virtual machine, the
+ * counterpart of the CUDA graph builtins.
+ */
+
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/vm/vm.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../../runtime/vm/device_graph.h"
+#include "metal_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace metal {
+
+namespace {
+
+using vm::DeviceGraphCaptureKey;
+using vm::DeviceGraphCaptureKeyEqual;
+using vm::DeviceGraphCaptureKeyHash;
+
+/*! \brief The stream of the current thread on the device. */
+Stream* GetStream(int device_id) {
+  MetalThreadEntry* t = MetalThreadEntry::ThreadLocal();
+  return MetalWorkspace::Global()->CastStreamOrGetDefault(t->stream[device_id], device_id);
+}
+
+/*! \brief The captured state of a Metal command graph */
+struct MetalGraphCapturedState {
+  /*!
+   * \brief Tuple of intemediate tensors in the capture func that will be used outside the
+   * capture func
+   */
+  ffi::ObjectRef states;
+  /*! \brief The device the graph was captured on. */
+  int device_id;
+  /*! \brief The recorded commands */
+  std::unique_ptr<MetalCommandGraph> graph;
+};
+
+}  // namespace
+
+/*! \brief The VM extension of Metal command graphs. */
+class MetalGraphExtensionNode : public vm::VMExtensionNode {
+ public:
+  ~MetalGraphExtensionNode() { this->Synchronize(); }
+
+  /*!
+   * \brief Replay the command graph if it has been cached, otherwise execute it in capture mode.
+   * \param vm The virtual machine.
+   * \param capture_func The function of type (args...) -> Tuple[ffi::ObjectRef], where 'args' are
+   * the static arguments that are the same for all invocations of the capture function, the
+   * returned tuple contains the intermediate tensors that will be used outside the capture
+   * function.
+   * \param args The static arguments of the capture function
+   * \param entry_index The unique index of the capture function used for lookup.
+   * \return The return value of the capture function.
+   */
+  ffi::ObjectRef RunOrCapture(vm::VirtualMachine* vm, const ffi::ObjectRef& capture_func,
+                              Any args, int64_t entry_index,
+                              ffi::Optional<ffi::Shape> shape_expr) {
+    DeviceGraphCaptureKey entry_key{entry_index, shape_expr};
+    if (auto it = capture_cache_.find(entry_key); it != capture_cache_.end()) {
+      // Mark the graph as the most recently used one.
+      capture_lru_.splice(capture_lru_.begin(), capture_lru_, it->second);
+      const MetalGraphCapturedState& entry = it->second->second;
+      AUTORELEASEPOOL { GetStream(entry.device_id)->Replay(*entry.graph); };
+      return entry.states;
+    }
+
+    // Set up arguments for the graph execution
+    ffi::Array<Any> tuple_args = args.cast<ffi::Array<Any>>();
+    int nargs = static_cast<int>(tuple_args.size());
+
+    std::vector<AnyView> packed_args(nargs);
+    for (int i = 0; i < nargs; ++i) {
+      packed_args[i] = tuple_args[i];
+    }
+
+    ffi::Any capture_func_rv;
+    // Run the function without capturing. This is a warm up step to do necessary initialization
+    // of the Metal module such as compiling the pipeline states.
+    vm->InvokeClosurePacked(capture_func, ffi::PackedArgs(packed_args.data(), nargs),
+                            &capture_func_rv);
+
+    // Run the function in capture mode
+    MetalGraphCapturedState entry;
+    entry.device_id = MetalThreadEntry::ThreadLocal()->device.device_id;
+    Stream* stream = GetStream(entry.device_id);
+    stream->BeginCapture();
+    try {
+      vm->InvokeClosurePacked(capture_func, ffi::PackedArgs(packed_args.data(), nargs),
+                              &capture_func_rv);
+    } catch (...) {
+      stream->EndCapture();
+      throw;
+    }
+    AUTORELEASEPOOL { entry.graph = stream->EndCapture(); };
+    entry.states = capture_func_rv.cast<ffi::ObjectRef>();
+
+    ffi::ObjectRef states = entry.states;
+
+    capture_lru_.emplace_front(entry_key, std::move(entry));
+    capture_cache_.emplace(entry_key, capture_lru_.begin());
+    this->EvictCapturedGraphs();
+
+    return states;
+  }
+
+  /*!
+   * \brief Set the maximum number of captured graphs kept alive, 0 for no limit.
+   * \param max_captured_graphs The maximum number of captured graphs.
+   */
+  void SetMaxCapturedGraphs(int64_t max_captured_graphs) {
+    TVM_FFI_ICHECK_GE(max_captured_graphs, 0);
+    max_captured_graphs_ = max_captured_graphs;
+    this->EvictCapturedGraphs();
+  }
+
+  /*!
+   * \brief Get the cached allocation from the cache or run the allocation function.
+   * \param vm The virtual machine.
+   * \param alloc_func The function of type () -> ffi::ObjectRef, where the returned object is the
+   * tuple of allocated storage objects.
+   * \param entry_index The unique index of the allocation function used for lookup.
+   */
+  ffi::ObjectRef GetCachedAllocation(vm::VirtualMachine* vm, const ffi::ObjectRef& alloc_func,
+                                     int64_t entry_index) {
+    if (auto it = alloc_cache_.find(entry_index); it != alloc_cache_.end()) {
+      return it->second;
+    }
+    ffi::Any alloc_func_rv;
+    vm->InvokeClosurePacked(alloc_func, ffi::PackedArgs(nullptr, 0), &alloc_func_rv);
+    ffi::ObjectRef alloc_result = alloc_func_rv.cast<ffi::ObjectRef>();
+    alloc_cache_[entry_index] = alloc_result;
+    return alloc_result;
+  }
+
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("vm.MetalGraphExtension", MetalGraphExtensionNode,
+                                    vm::VMExtensionNode);
+
+ private:
+  using CaptureLRUList = std::list<std::pair<DeviceGraphCaptureKey, MetalGraphCapturedState>>;
+
+  /*!
+   * \brief Wait for the pending replays, which reference the recorded command buffers, before
+   * any graph is destroyed.
+   */
+  void Synchronize() {
+    for (const auto& [key, entry] : capture_lru_) {
+      Stream* stream = GetStream(entry.device_id);
+      if (!stream->IsCapturing()) {
+        AUTORELEASEPOOL { stream->Synchronize(); };
+      }
+    }
+  }
+
+  /*!
+   * \brief Evict the least recently used graphs beyond the limit. The states of an evicted graph
+   * stay alive as long as they are referenced outside.
+   */
+  void EvictCapturedGraphs() {
+    if (max_captured_graphs_ == 0 ||
+        static_cast<int64_t>(capture_lru_.size()) <= max_captured_graphs_) {
+      return;
+    }
+    this->Synchronize();
+    while (static_cast<int64_t>(capture_lru_.size()) > max_captured_graphs_) {
+      capture_cache_.erase(capture_lru_.back().first);
+      capture_lru_.pop_back();
+    }
+  }
+
+  /*! \brief The captured graphs, ordered from the most to the least recently used. */
+  CaptureLRUList capture_lru_;
+  /*!
+   * \brief The cache of captured graphs. The key is a unique index for the capture function.
+   * The value is the position of the result of the capture in `capture_lru_`.
+   */
+  std::unordered_map<DeviceGraphCaptureKey, CaptureLRUList::iterator, DeviceGraphCaptureKeyHash,
+                     DeviceGraphCaptureKeyEqual>
+      capture_cache_;
+  /*! \brief The maximum number of captured graphs, 0 for no limit. */
+  int64_t max_captured_graphs_{0};
+  /*!
+   * \brief The cache of allocations. The key is a unique index for the allocation function.
+   * The value is the cached allocations, which is a tuple of storages.
+   */
+  std::unordered_map<int64_t, ffi::ObjectRef> alloc_cache_;
+};
+
+/*! Managed reference to MetalGraphExtensionNode */
+class MetalGraphExtension : public vm::VMExtension {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(MetalGraphExtension, vm::VMExtension,
+                                             MetalGraphExtensionNode);
+  static MetalGraphExtension Create() {
+    auto data_ = ffi::make_object<MetalGraphExtensionNode>();
+    // Bound the captured graphs of the symbolic-shape regions, e.g. one per batch size.
+    if (const char* val = std::getenv("TVM_METAL_GRAPH_MAX_CAPTURED")) {
+      data_->SetMaxCapturedGraphs(std::atoll(val));
+    }
+    return MetalGraphExtension(std::move(data_));
+  }
+};
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def_packed("vm.builtin.metal_graph.run_or_capture",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    TVM_FFI_ICHECK(args.size() == 5 || args.size() == 4);
+                    vm::VirtualMachine* vm = vm::VirtualMachine::GetContextPtr(args[0]);
+                    auto extension = vm->GetOrCreateExtension<MetalGraphExtension>();
+                    auto capture_func = args[1].cast<ffi::ObjectRef>();
+                    Any func_args = args[2];
+                    int64_t entry_index = args[3].cast<int64_t>();
+                    ffi::Optional<ffi::Shape> shape_expr = std::nullopt;
+                    if (args.size() == 5) {
+                      shape_expr = args[4].cast<ffi::Shape>();
+                    }
+                    *rv = extension->RunOrCapture(vm, capture_func, func_args, entry_index,
+                                                  shape_expr);
+                  })
+      .def_packed("vm.builtin.metal_graph.get_cached_alloc",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    TVM_FFI_ICHECK_EQ(args.size(), 3);
+                    vm::VirtualMachine* vm = vm::VirtualMachine::GetContextPtr(args[0]);
+                    auto extension = vm->GetOrCreateExtension<MetalGraphExtension>();
+                    auto alloc_func = args[1].cast<ffi::ObjectRef>();
+                    int64_t entry_index = args[2].cast<int64_t>();
+                    *rv = extension->GetCachedAllocation(vm, alloc_func, entry_index);
+                  });
+}
+
+}  // namespace metal
+}  // namespace runtime
+}  // namespace tvm
@@ -117,7 +117,9 @@ class MetalModuleNode final : public ffi::ModuleObj {
   }
 
   // get a from primary context in device_id
-  id<MTLComputePipelineState> GetPipelineState(size_t device_id, const std::string& func_name) {
+  // indirect selects a pipeline state that can be encoded into an indirect command buffer.
+  id<MTLComputePipelineState> GetPipelineState(size_t device_id, const std::string& func_name,
+                                               bool indirect = false) {
     metal::MetalWorkspace* w = metal::MetalWorkspace::Global();
     TVM_FFI_ICHECK_LT(device_id, w->devices.size());
     // start lock scope.
@@ -126,8 +128,9 @@ class MetalModuleNode final : public ffi::ModuleObj {
       finfo_.resize(device_id + 1, DeviceEntry());
     }
     DeviceEntry& e = finfo_[device_id];
-    auto it = e.smap.find(func_name);
-    if (it != e.smap.end()) return it->second;
+    auto& cache = indirect ? e.indirect_smap : e.smap;
+    auto it = cache.find(func_name);
+    if (it != cache.end()) return it->second;
     // compile
     NSError* err_msg = nil;
     id<MTLLibrary> lib = nil;
@@ -173,8 +176,19 @@ class MetalModuleNode final : public ffi::ModuleObj {
     }
     id<MTLFunction> f = [lib newFunctionWithName:[NSString stringWithUTF8String:func_name.c_str()]];
     TVM_FFI_ICHECK(f != nil) << "cannot find function " << func_name;
-    id<MTLComputePipelineState> state =
-        [w->devices[device_id] newComputePipelineStateWithFunction:f error:&err_msg];
+    id<MTLComputePipelineState> state = nil;
+    if (indirect) {
+      MTLComputePipelineDescriptor* desc = [[MTLComputePipelineDescriptor alloc] init];
+      desc.computeFunction = f;
+      desc.supportIndirectCommandBuffers = YES;
+      state = [w->devices[device_id] newComputePipelineStateWithDescriptor:desc
+                                                                   options:MTLPipelineOptionNone
+                                                                reflection:nil
+                                                                     error:&err_msg];
+      [desc release];
+    } else {
+      state = [w->devices[device_id] newComputePipelineStateWithFunction:f error:&err_msg];
+    }
     TVM_FFI_ICHECK(state != nil) << "cannot get state:"
                                  << " for function " << func_name
                                  << [[err_msg localizedDescription] UTF8String];
@@ -184,8 +198,8 @@ class MetalModuleNode final : public ffi::ModuleObj {
     // to the resource constraint in kernel, so it is not strictly hold
     // Turn of warp aware optimziation for now.
     // TVM_FFI_ICHECK_EQ(state.threadExecutionWidth, w->warp_size[device_id]);
-    if (e.smap[func_name] != nil) [e.smap[func_name] release];
-    e.smap[func_name] = state;
+    if (cache[func_name] != nil) [cache[func_name] release];
+    cache[func_name] = state;
     return state;
   }
 
@@ -194,11 +208,16 @@ class MetalModuleNode final : public ffi::ModuleObj {
   struct DeviceEntry {
     // state cache;
     std::unordered_map<std::string, id<MTLComputePipelineState>> smap;
+    // state cache of the kernels recorded into indirect command buffers;
+    std::unordered_map<std::string, id<MTLComputePipelineState>> indirect_smap;
 
     ~DeviceEntry() {
       for (auto&& kv : smap) {
         [kv.second release];
       }
+      for (auto&& kv : indirect_smap) {
+        [kv.second release];
+      }
     }
   };
   // Per-kernel payload: kernel-name -> bytes (MSL source for fmt="metal" /
@@ -254,22 +273,35 @@ class MetalWrappedFunc {
       int blockSize = wl.block_dim(0) * wl.block_dim(1) * wl.block_dim(2);
       auto maxTotalThreadsPerThreadgroup = scache_[device_id].maxTotalThreadsPerThreadgroup;
       TVM_FFI_ICHECK_LE(blockSize, maxTotalThreadsPerThreadgroup);
+      MTLSize dimGrid = MTLSizeMake(wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2));
+      MTLSize dimBlock = MTLSizeMake(wl.block_dim(0), wl.block_dim(1), wl.block_dim(2));
+      if (stream->IsCapturing()) {
+        // Record the dispatch for an indirect command buffer instead of encoding it.
+        metal::MetalDispatch dispatch;
+        dispatch.pipeline_state = m_->GetPipelineState(device_id, func_name_, /*indirect=*/true);
+        for (size_t i = 0; i < num_buffer_args_; ++i) {
+          dispatch.buffers.push_back((id<MTLBuffer>)(args[static_cast<int>(i)].cast<void*>()));
+        }
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(pack_args);
+        dispatch.bytes.assign(bytes, bytes + num_pack_args_ * sizeof(ArgUnion64));
+        dispatch.grid = dimGrid;
+        dispatch.block = dimBlock;
+        stream->RecordDispatch(std::move(dispatch));
+        return;
+      }
       // Reuse the pending compute encoder to batch dispatches.
       // The encoder is flushed on sync, copy, or buffer deallocation.
+      // The stream skips the bindings the encoder holds from the previous dispatch.
       id<MTLComputeCommandEncoder> encoder = stream->GetPendingComputeEncoder(func_name_);
-      [encoder setComputePipelineState:scache_[device_id]];
+      stream->SetComputePipelineState(scache_[device_id]);
       for (size_t i = 0; i < num_buffer_args_; ++i) {
         void* buf = args[static_cast<int>(i)].cast<void*>();
-        [encoder setBuffer:(id<MTLBuffer>)(buf) offset:0 atIndex:i];
+        stream->SetComputeBuffer((id<MTLBuffer>)(buf), i);
       }
       if (num_pack_args_ != 0) {
-        [encoder setBytes:pack_args
-                   length:num_pack_args_ * sizeof(ArgUnion64)
-                  atIndex:num_buffer_args_];
+        stream->SetComputeBytes(pack_args, num_pack_args_ * sizeof(ArgUnion64), num_buffer_args_);
       }
       // launch
-      MTLSize dimGrid = MTLSizeMake(wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2));
-      MTLSize dimBlock = MTLSizeMake(wl.block_dim(0), wl.block_dim(1), wl.block_dim(2));
       [encoder dispatchThreadgroups:dimGrid threadsPerThreadgroup:dimBlock];
     };
   }
@@ -533,8 +533,16 @@ class OpenCLModuleNode : public OpenCLModuleNodeBase {
   // install a new kernel to thread local entry
   cl_kernel InstallKernel(cl::OpenCLWorkspace* w, cl::OpenCLThreadEntry* t,
                           const std::string& func_name, const KTRefEntry& e) override;
+  /*!
+   * \brief Build the programs of the kernels ahead of their first launch.
+   * \param func_names The kernels to build, all the kernels of the module if empty.
+   * \param device_ids The devices to build for, one thread each, all the devices if empty.
+   */
+  void Preload(const ffi::Array<ffi::String>& func_names, const ffi::Array<int64_t>& device_ids);
 
  private:
+  // Create and build the program of the function from the program binary cache, if it hits.
+  bool LoadCachedProgram(cl::OpenCLWorkspace* w, const std::string& func_name, int device_id);
   // The single-binary code payload: for fmt=="cl" the bytes are the
   // OpenCL C source; for fmt=="xclbin"/"awsxclbin"/"aocx" the bytes
   // are a pre-compiled OpenCL binary.
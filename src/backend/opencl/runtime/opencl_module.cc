@@ -31,12 +31,15 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/support/io.h>
 
+#include <exception>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "../../../support/bytes_io.h"
 #include "opencl_common.h"
+#include "opencl_program_cache.h"
 #include "source_utils.h"
 
 namespace tvm {
@@ -115,6 +118,17 @@ class OpenCLWrappedFunc {
   LaunchParamConfig launch_param_config_;
 };
 
+// Get the binary of a program built for a single device.
+static std::string GetProgramBinary(cl_program program) {
+  size_t size;
+  OPENCL_CALL(clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &size, nullptr));
+  std::string binary(size, '\0');
+  unsigned char* data = reinterpret_cast<unsigned char*>(binary.data());
+  OPENCL_CALL(
+      clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char*), &data, nullptr));
+  return binary;
+}
+
 OpenCLModuleNodeBase::~OpenCLModuleNodeBase() {
   {
     // free the kernel ids in global table.
@@ -240,13 +254,42 @@ bool OpenCLModuleNode::IsProgramCreated(const std::string& func_name, int device
   return false;
 }
 
+bool OpenCLModuleNode::LoadCachedProgram(cl::OpenCLWorkspace* w, const std::string& func_name,
+                                         int device_id) {
+  cl::ProgramBinaryCache* cache = cl::ProgramBinaryCache::Global();
+  const std::string& source = parsed_kernels_[func_name];
+  cl_device_id dev = w->devices[device_id];
+  std::string binary;
+  if (!cache->Load(dev, source, &binary)) return false;
+  auto platform = w->device_info[w->GetCLDeviceID(device_id)].platform_id;
+  const unsigned char* s = reinterpret_cast<const unsigned char*>(binary.data());
+  size_t len = binary.size();
+  cl_int binary_status = CL_SUCCESS;
+  cl_int err;
+  cl_program program =
+      clCreateProgramWithBinary(w->contexts[platform], 1, &dev, &len, &s, &binary_status, &err);
+  if (err == CL_SUCCESS && binary_status == CL_SUCCESS &&
+      clBuildProgram(program, 1, &dev, nullptr, nullptr, nullptr) == CL_SUCCESS) {
+    programs_[func_name][device_id] = program;
+    return true;
+  }
+  // The driver rejects the binary, fall back to the source and replace the entry.
+  if (err == CL_SUCCESS) OPENCL_CALL(clReleaseProgram(program));
+  cache->Remove(dev, source);
+  return false;
+}
+
 cl_kernel OpenCLModuleNode::InstallKernel(cl::OpenCLWorkspace* w, cl::OpenCLThreadEntry* t,
                                           const std::string& func_name, const KTRefEntry& e) {
   std::lock_guard<std::mutex> lock(build_lock_);
   int device_id = t->device.device_id;
   auto did = w->GetCLDeviceID(device_id);
   auto platform = w->device_info[did].platform_id;
-  if (!IsProgramCreated(func_name, device_id)) {
+  bool created = IsProgramCreated(func_name, device_id);
+  if (!created && fmt_ == "cl") {
+    created = LoadCachedProgram(w, func_name, device_id);
+  }
+  if (!created) {
     // create program
     if (fmt_ == "cl") {
       const char* s = parsed_kernels_[func_name].c_str();
@@ -282,6 +325,10 @@ cl_kernel OpenCLModuleNode::InstallKernel(cl::OpenCLWorkspace* w, cl::OpenCLThre
                                    << "\nError: " << cl::CLGetErrorString(err) << "\n"
                                    << log;
     }
+    if (fmt_ == "cl" && cl::ProgramBinaryCache::Global()->enabled()) {
+      cl::ProgramBinaryCache::Global()->Save(dev, parsed_kernels_[func_name],
+                                             GetProgramBinary(programs_[func_name][device_id]));
+    }
   }
   // build kernel
   cl_int err;
@@ -293,6 +340,64 @@ cl_kernel OpenCLModuleNode::InstallKernel(cl::OpenCLWorkspace* w, cl::OpenCLThre
   return kernel;
 }
 
+void OpenCLModuleNode::Preload(const ffi::Array<ffi::String>& func_names,
+                               const ffi::Array<int64_t>& device_ids) {
+  workspace_->Init();
+  std::vector<std::string> names;
+  if (func_names.empty()) {
+    for (const auto& kv : fmap_) {
+      names.push_back(kv.first);
+    }
+  } else {
+    for (const ffi::String& name : func_names) {
+      TVM_FFI_CHECK(fmap_.count(name), ValueError)
+          << "The OpenCL module has no function named " << name;
+      names.push_back(name);
+    }
+  }
+  int num_devices = static_cast<int>(workspace_->devices.size());
+  std::vector<int> devices;
+  if (device_ids.empty()) {
+    for (int i = 0; i < num_devices; ++i) {
+      devices.push_back(i);
+    }
+  } else {
+    for (int64_t device_id : device_ids) {
+      TVM_FFI_CHECK(device_id >= 0 && device_id < num_devices, ValueError)
+          << "Invalid OpenCL device id " << device_id;
+      devices.push_back(static_cast<int>(device_id));
+    }
+  }
+  std::vector<std::exception_ptr> errors(devices.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      try {
+        // The kernels are installed to the entry of this thread, while the built programs are
+        // shared with the threads that launch the kernels.
+        cl::OpenCLThreadEntry* t = workspace_->GetThreadEntry();
+        t->device.device_id = devices[i];
+        t->kernel_table.resize(workspace_->num_registered_kernels);
+        for (const std::string& name : names) {
+          {
+            std::lock_guard<std::mutex> lock(build_lock_);
+            if (IsProgramCreated(name, devices[i])) continue;
+          }
+          InstallKernel(workspace_, t, name, kid_map_.at(name));
+        }
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
 void OpenCLModuleNode::SetPreCompiledPrograms(const std::string& bytes) {
   workspace_->Init();
   support::BytesInStream strm(bytes);
@@ -365,7 +470,12 @@ std::string OpenCLModuleNode::GetPreCompiledPrograms() {
 ffi::Optional<ffi::Function> OpenCLModuleNode::GetFunction(const ffi::String& name) {
   ffi::ObjectPtr<ffi::Object> sptr_to_self = ffi::GetObjectPtr<ffi::Object>(this);
   TVM_FFI_ICHECK_EQ(sptr_to_self.get(), this);
-  if (name == "opencl.GetPreCompiledPrograms") {
+  if (name == "__tvm_preload") {
+    return ffi::Function::FromTyped(
+        [sptr_to_self, this](ffi::Array<ffi::String> func_names, ffi::Array<int64_t> device_ids) {
+          this->Preload(func_names, device_ids);
+        });
+  } else if (name == "opencl.GetPreCompiledPrograms") {
     return ffi::Function([sptr_to_self, this](ffi::PackedArgs args, ffi::Any* rv) {
       *rv = this->GetPreCompiledPrograms();
     });
@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file opencl_program_cache.cc
+ */
+#include "opencl_program_cache.h"
+
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "../../../support/bytes_io.h"
+#include "../../../support/env.h"
+
+namespace tvm {
+namespace runtime {
+namespace cl {
+
+std::string GetDeviceInfo(cl_device_id pid, cl_device_info param_name);
+
+namespace {
+
+namespace fs = std::filesystem;
+
+/*! \brief The magic number leading each entry, bumped when the entry layout changes. */
+constexpr uint64_t kProgramCacheMagic = 0x54564D434C42494EULL;
+/*! \brief The file extension of the entries. */
+constexpr const char* kEntryExtension = ".clbin";
+
+/*! \brief The 64-bit FNV-1a hash, which unlike std::hash is stable across builds. */
+std::string HashHex(const std::string& data) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * 0x100000001B3ULL;
+  }
+  std::ostringstream os;
+  os << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return os.str();
+}
+
+}  // namespace
+
+ProgramBinaryCache* ProgramBinaryCache::Global() {
+  static ProgramBinaryCache* inst = new ProgramBinaryCache();
+  return inst;
+}
+
+ProgramBinaryCache::ProgramBinaryCache() {
+  Configure(support::GetEnv("TVM_OPENCL_PROGRAM_CACHE_DIR", std::string()),
+            support::GetEnv<int64_t>("TVM_OPENCL_PROGRAM_CACHE_MAX_BYTES", int64_t{64} << 20));
+}
+
+void ProgramBinaryCache::Configure(std::string dir, int64_t max_bytes) {
+  std::lock_guard<std::mutex> lock(mu_);
+  TVM_FFI_CHECK(max_bytes > 0, ValueError)
+      << "The size bound of the OpenCL program cache must be positive, but got " << max_bytes;
+  std::error_code ec;
+  if (!dir.empty() && !fs::create_directories(dir, ec) && !fs::is_directory(dir, ec)) {
+    LOG(WARNING) << "Cannot create the OpenCL program cache directory " << dir
+                 << ", the cache is disabled";
+    dir.clear();
+  }
+  dir_ = std::move(dir);
+  max_bytes_ = max_bytes;
+  checked_devices_.clear();
+}
+
+bool ProgramBinaryCache::enabled() {
+  std::lock_guard<std::mutex> lock(mu_);
+  return !dir_.empty();
+}
+
+std::string ProgramBinaryCache::DevicePrefix(cl_device_id dev) {
+  std::string device = HashHex(GetDeviceInfo(dev, CL_DEVICE_NAME));
+  std::string prefix = device + "-" + HashHex(GetDeviceInfo(dev, CL_DRIVER_VERSION)) + "-";
+  if (checked_devices_.insert(dev).second) {
+    // Binaries of another driver version of the device will not load anymore.
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir_, ec)) {
+      std::string name = entry.path().filename().string();
+      if (name.rfind(device + "-", 0) == 0 && name.rfind(prefix, 0) != 0) {
+        fs::remove(entry.path(), ec);
+      }
+    }
+  }
+  return prefix;
+}
+
+std::string ProgramBinaryCache::EntryPath(cl_device_id dev, const std::string& source) {
+  return (fs::path(dir_) / (DevicePrefix(dev) + HashHex(source) + kEntryExtension)).string();
+}
+
+bool ProgramBinaryCache::Load(cl_device_id dev, const std::string& source, std::string* binary) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (dir_.empty()) return false;
+  std::string path = EntryPath(dev, source);
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  if (fin.fail()) return false;
+  std::string data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+  fin.close();
+  support::BytesInStream strm(data);
+  uint64_t magic = 0, source_size = 0;
+  if (!strm.Read(&magic) || magic != kProgramCacheMagic || !strm.Read(&source_size) ||
+      source_size != source.size() || !strm.Read(binary) || binary->empty()) {
+    std::error_code ec;
+    fs::remove(path, ec);
+    return false;
+  }
+  // Mark the entry as recently used.
+  std::error_code ec;
+  fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+  return true;
+}
+
+void ProgramBinaryCache::Save(cl_device_id dev, const std::string& source,
+                              const std::string& binary) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (dir_.empty() || binary.empty()) return;
+  std::string data;
+  support::BytesOutStream strm(&data);
+  strm.Write(kProgramCacheMagic);
+  strm.Write(static_cast<uint64_t>(source.size()));
+  strm.Write(binary);
+  // Write to a temporary file and rename it, so that a killed process leaves no partial entry.
+  std::string path = EntryPath(dev, source);
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path, std::ios::out | std::ios::binary);
+    if (fout.fail()) return;
+    fout.write(data.data(), data.size());
+    if (fout.fail()) return;
+  }
+  std::error_code ec;
+  fs::rename(tmp_path, path, ec);
+  if (ec) {
+    fs::remove(tmp_path, ec);
+    return;
+  }
+  Evict();
+}
+
+void ProgramBinaryCache::Remove(cl_device_id dev, const std::string& source) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (dir_.empty()) return;
+  std::error_code ec;
+  fs::remove(EntryPath(dev, source), ec);
+}
+
+void ProgramBinaryCache::Evict() {
+  std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+  int64_t total_bytes = 0;
+  std::error_code ec;
+  for (const fs::directory_entry& entry : fs::directory_iterator(dir_, ec)) {
+    if (entry.path().extension() != kEntryExtension) continue;
+    uintmax_t size = entry.file_size(ec);
+    if (ec) continue;
+    total_bytes += static_cast<int64_t>(size);
+    entries.emplace_back(entry.last_write_time(ec), entry.path());
+  }
+  std::sort(entries.begin(), entries.end());
+  for (const auto& [time, path] : entries) {
+    if (total_bytes <= max_bytes_) break;
+    uintmax_t size = fs::file_size(path, ec);
+    if (!ec && fs::remove(path, ec)) {
+      total_bytes -= static_cast<int64_t>(size);
+    }
+  }
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("runtime.opencl.SetProgramBinaryCache",
+                        [](ffi::String dir, int64_t max_bytes) {
+                          ProgramBinaryCache::Global()->Configure(std::string(dir), max_bytes);
+                        });
+}
+
+}  // namespace cl
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file opencl_program_cache.h
+ * \brief Persistent on-disk cache of OpenCL program binaries built from source.
+ */
+#ifndef TVM_RUNTIME_OPENCL_OPENCL_PROGRAM_CACHE_H_
+#define TVM_RUNTIME_OPENCL_OPENCL_PROGRAM_CACHE_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "opencl_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace cl {
+
+/*!
+ * \brief A process-wide cache of the CL_PROGRAM_BINARIES of programs built from source, so that
+ * later processes skip the source compilation, which takes seconds on mobile GPUs.
+ *
+ * Each entry is a file in the cache directory named after the hashes of the device name, the
+ * driver version and the program source. Entries of a device whose driver version has changed
+ * are removed when the device is first used, and the least recently used entries are removed
+ * once the total size exceeds the bound.
+ *
+ * The cache is disabled unless a directory is given, either by the environment variable
+ * TVM_OPENCL_PROGRAM_CACHE_DIR or by the global function
+ * "runtime.opencl.SetProgramBinaryCache". TVM_OPENCL_PROGRAM_CACHE_MAX_BYTES overrides the
+ * default size bound of 64 MiB.
+ */
+class ProgramBinaryCache {
+ public:
+  /*! \brief The process-wide cache. */
+  static ProgramBinaryCache* Global();
+  /*!
+   * \brief Set the cache directory and size bound.
+   * \param dir The cache directory, created if missing. An empty string disables the cache.
+   * \param max_bytes The maximum total size of the entries.
+   */
+  void Configure(std::string dir, int64_t max_bytes);
+  /*! \brief Whether the cache is enabled. */
+  bool enabled();
+  /*!
+   * \brief Look up the program binary built from the source for the device.
+   * \param dev The device.
+   * \param source The program source.
+   * \param binary The program binary on a cache hit.
+   * \return Whether the cache hits.
+   */
+  bool Load(cl_device_id dev, const std::string& source, std::string* binary);
+  /*!
+   * \brief Store the program binary built from the source for the device.
+   * \param dev The device.
+   * \param source The program source.
+   * \param binary The program binary.
+   */
+  void Save(cl_device_id dev, const std::string& source, const std::string& binary);
+  /*!
+   * \brief Remove the entry of the source for the device, e.g. after the binary failed to build.
+   * \param dev The device.
+   * \param source The program source.
+   */
+  void Remove(cl_device_id dev, const std::string& source);
+
+ private:
+  ProgramBinaryCache();
+  /*! \brief The file name prefix shared by all the entries of the device and its driver. */
+  std::string DevicePrefix(cl_device_id dev);
+  /*! \brief The path of the entry of the source for the device. */
+  std::string EntryPath(cl_device_id dev, const std::string& source);
+  /*! \brief Remove the least recently used entries until the size bound is met. */
+  void Evict();
+
+  /*! \brief The cache directory, empty if the cache is disabled. */
+  std::string dir_;
+  /*! \brief The maximum total size of the entries. */
+  int64_t max_bytes_;
+  /*! \brief The devices whose stale entries have been removed. */
+  std::unordered_set<cl_device_id> checked_devices_;
+  /*! \brief The mutex guarding the cache, shared by all the modules. */
+  std::mutex mu_;
+};
+
+}  // namespace cl
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_OPENCL_OPENCL_PROGRAM_CACHE_H_
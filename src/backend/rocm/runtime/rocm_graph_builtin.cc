@@ -0,0 +1,308 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rocm_graph_builtin.cc
+ * \brief The HIP graph related builtin functions for Relax virtual machine, the counterpart of
+ * the CUDA graph builtins.
+ */
+
+#include <hip/hip_runtime_api.h>
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/extra/c_env_api.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/vm/vm.h>
+
+#include <cstdlib>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../../runtime/vm/device_graph.h"
+#include "rocm_common.h"
+
+namespace tvm {
+namespace runtime {
+
+namespace {
+
+using vm::DeviceGraphCaptureKey;
+using vm::DeviceGraphCaptureKeyEqual;
+using vm::DeviceGraphCaptureKeyHash;
+
+/*! \brief The captured state of a HIP graph */
+struct HIPGraphCapturedState {
+  HIPGraphCapturedState() {}
+
+  HIPGraphCapturedState(const HIPGraphCapturedState&) = delete;
+  HIPGraphCapturedState(HIPGraphCapturedState&& other) { *this = std::move(other); }
+
+  HIPGraphCapturedState& operator=(const HIPGraphCapturedState&) = delete;
+  HIPGraphCapturedState& operator=(HIPGraphCapturedState&& other) {
+    std::swap(states, other.states);
+    std::swap(exec, other.exec);
+    return *this;
+  }
+
+  ~HIPGraphCapturedState() {
+    if (exec) {
+      ROCM_CALL(hipGraphExecDestroy(exec));
+    }
+  }
+
+  /*!
+   * \brief Tuple of intemediate tensors in the capture func that will be used outside the
+   * capture func
+   */
+  ffi::ObjectRef states;
+  /*! \brief The instantiated hip graph */
+  hipGraphExec_t exec = nullptr;
+};
+
+class ScopedHIPStream {
+ public:
+  ScopedHIPStream() { ROCM_CALL(hipStreamCreate(&stream_)); }
+  ~ScopedHIPStream() { hipStreamDestroy(stream_); }
+  ScopedHIPStream(const ScopedHIPStream&) = delete;
+  ScopedHIPStream(ScopedHIPStream&&) = delete;
+  ScopedHIPStream& operator=(const ScopedHIPStream&) = delete;
+  ScopedHIPStream& operator=(ScopedHIPStream&&) = delete;
+
+  operator hipStream_t() const { return stream_; }
+
+ private:
+  hipStream_t stream_;
+};
+
+class HIPCaptureStream {
+ public:
+  explicit HIPCaptureStream(hipGraph_t* graph) : output_graph_(graph) {
+    ROCM_CALL(hipGetDevice(&device_id_));
+    TVM_FFI_CHECK_SAFE_CALL(
+        TVMFFIEnvSetStream(kDLROCM, device_id_, capture_stream_,
+                           reinterpret_cast<TVMFFIStreamHandle*>(&prev_default_stream_)));
+    ROCM_CALL(hipStreamBeginCapture(capture_stream_, hipStreamCaptureModeGlobal));
+  }
+  ~HIPCaptureStream() noexcept(false) {
+    hipError_t capture_error = hipStreamEndCapture(capture_stream_, output_graph_);
+    if (capture_error != hipSuccess) {
+      // The capture may have been invalidated by the exception that is
+      // currently unwinding the stack.  Do not throw a second exception from
+      // this destructor, but clear HIP's thread-local error so that it is not
+      // reported by an unrelated HIP call later in the same host thread.
+      hipGetLastError();
+    }
+    TVM_FFI_CHECK_SAFE_CALL(TVMFFIEnvSetStream(kDLROCM, device_id_, prev_default_stream_, nullptr));
+  }
+
+ private:
+  int device_id_;
+  hipStream_t prev_default_stream_;
+  ScopedHIPStream capture_stream_;
+
+  hipGraph_t* output_graph_;
+};
+
+}  // namespace
+
+/*! \brief The VM extension of HIP graph. */
+class HIPGraphExtensionNode : public vm::VMExtensionNode {
+ public:
+  /*!
+   * \brief Launch the hip graph if it has been cached, otherwise execute it in capture mode.
+   * \param vm The virtual machine.
+   * \param capture_func The function of type (args...) -> Tuple[ffi::ObjectRef], where 'args' are
+   * the static arguments that are the same for all invocations of the capture function, the
+   * returned tuple contains the intermediate tensors that will be used outside the capture
+   * function.
+   * \param args The static arguments of the capture function
+   * \param entry_index The unique index of the capture function used for lookup.
+   * \return The return value of the capture function.
+   */
+  ffi::ObjectRef RunOrCapture(vm::VirtualMachine* vm, const ffi::ObjectRef& capture_func,
+                              Any args, int64_t entry_index,
+                              ffi::Optional<ffi::Shape> shape_expr) {
+    DeviceGraphCaptureKey entry_key{entry_index, shape_expr};
+    if (auto it = capture_cache_.find(entry_key); it != capture_cache_.end()) {
+      // Mark the graph as the most recently used one.
+      capture_lru_.splice(capture_lru_.begin(), capture_lru_, it->second);
+      // Launch HIP graph
+      const auto& [states, exec] = it->second->second;
+      int device_id;
+      ROCM_CALL(hipGetDevice(&device_id));
+      ROCM_CALL(
+          hipGraphLaunch(exec, static_cast<hipStream_t>(TVMFFIEnvGetStream(kDLROCM, device_id))));
+      return states;
+    }
+
+    // Set up arguments for the graph execution
+    ffi::Array<Any> tuple_args = args.cast<ffi::Array<Any>>();
+    int nargs = static_cast<int>(tuple_args.size());
+
+    std::vector<AnyView> packed_args(nargs);
+    for (int i = 0; i < nargs; ++i) {
+      packed_args[i] = tuple_args[i];
+    }
+
+    ffi::Any capture_func_rv;
+    // Run the function without HIP graph. This is a warm up step to do necessary initialization
+    // of the ROCm module such as loading module data.
+    vm->InvokeClosurePacked(capture_func, ffi::PackedArgs(packed_args.data(), nargs),
+                            &capture_func_rv);
+
+    // Run the graph in capture mode
+    hipGraph_t graph;
+
+    {
+      HIPCaptureStream capture_stream(&graph);
+      vm->InvokeClosurePacked(capture_func, ffi::PackedArgs(packed_args.data(), nargs),
+                              &capture_func_rv);
+    }
+
+    HIPGraphCapturedState entry;
+    entry.states = capture_func_rv.cast<ffi::ObjectRef>();
+    ROCM_CALL(hipGraphInstantiate(&entry.exec, graph, nullptr, nullptr, 0));
+    ROCM_CALL(hipGraphDestroy(graph));
+
+    ffi::ObjectRef states = entry.states;
+
+    capture_lru_.emplace_front(entry_key, std::move(entry));
+    capture_cache_.emplace(entry_key, capture_lru_.begin());
+    this->EvictCapturedGraphs();
+
+    return states;
+  }
+
+  /*!
+   * \brief Set the maximum number of captured graphs kept alive, 0 for no limit.
+   * \param max_captured_graphs The maximum number of captured graphs.
+   */
+  void SetMaxCapturedGraphs(int64_t max_captured_graphs) {
+    TVM_FFI_ICHECK_GE(max_captured_graphs, 0);
+    max_captured_graphs_ = max_captured_graphs;
+    this->EvictCapturedGraphs();
+  }
+
+  /*!
+   * \brief Get the cached allocation from the cache or run the allocation function.
+   * \param vm The virtual machine.
+   * \param alloc_func The function of type () -> ffi::ObjectRef, where the returned object is the
+   * tuple of allocated storage objects.
+   * \param entry_index The unique index of the allocation function used for lookup.
+   */
+  ffi::ObjectRef GetCachedAllocation(vm::VirtualMachine* vm, const ffi::ObjectRef& alloc_func,
+                                     int64_t entry_index) {
+    if (auto it = alloc_cache_.find(entry_index); it != alloc_cache_.end()) {
+      return it->second;
+    }
+    ffi::Any alloc_func_rv;
+    vm->InvokeClosurePacked(alloc_func, ffi::PackedArgs(nullptr, 0), &alloc_func_rv);
+    ffi::ObjectRef alloc_result = alloc_func_rv.cast<ffi::ObjectRef>();
+    alloc_cache_[entry_index] = alloc_result;
+    return alloc_result;
+  }
+
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("vm.HIPGraphExtension", HIPGraphExtensionNode,
+                                    vm::VMExtensionNode);
+
+ private:
+  using CaptureLRUList = std::list<std::pair<DeviceGraphCaptureKey, HIPGraphCapturedState>>;
+
+  /*!
+   * \brief Evict the least recently used graphs beyond the limit. The states of an evicted graph
+   * stay alive as long as they are referenced outside.
+   */
+  void EvictCapturedGraphs() {
+    while (max_captured_graphs_ > 0 &&
+           static_cast<int64_t>(capture_lru_.size()) > max_captured_graphs_) {
+      capture_cache_.erase(capture_lru_.back().first);
+      capture_lru_.pop_back();
+    }
+  }
+
+  /*! \brief The captured hip graphs, ordered from the most to the least recently used. */
+  CaptureLRUList capture_lru_;
+  /*!
+   * \brief The cache of captured hip graphs. The key is a unique index for the capture function.
+   * The value is the position of the result of the capture in `capture_lru_`.
+   */
+  std::unordered_map<DeviceGraphCaptureKey, CaptureLRUList::iterator, DeviceGraphCaptureKeyHash,
+                     DeviceGraphCaptureKeyEqual>
+      capture_cache_;
+  /*!
+   * \brief The maximum number of captured graphs, 0 for no limit. Graphs captured for many
+   * distinct symbolic shapes are evicted in least recently used order beyond this limit.
+   */
+  int64_t max_captured_graphs_{0};
+  /*!
+   * \brief The cache of allocations. The key is a unique index for the allocation function.
+   * The value is the cached allocations, which is a tuple of storages.
+   */
+  std::unordered_map<int64_t, ffi::ObjectRef> alloc_cache_;
+};
+
+/*! Managed reference to HIPGraphExtensionNode */
+class HIPGraphExtension : public vm::VMExtension {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(HIPGraphExtension, vm::VMExtension,
+                                             HIPGraphExtensionNode);
+  static HIPGraphExtension Create() {
+    auto data_ = ffi::make_object<HIPGraphExtensionNode>();
+    // Bound the captured graphs of the symbolic-shape regions, e.g. one per batch size.
+    if (const char* val = std::getenv("TVM_ROCM_GRAPH_MAX_CAPTURED")) {
+      data_->SetMaxCapturedGraphs(std::atoll(val));
+    }
+    return HIPGraphExtension(std::move(data_));
+  }
+};
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def_packed("vm.builtin.rocm_graph.run_or_capture",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    TVM_FFI_ICHECK(args.size() == 5 || args.size() == 4);
+                    vm::VirtualMachine* vm = vm::VirtualMachine::GetContextPtr(args[0]);
+                    auto extension = vm->GetOrCreateExtension<HIPGraphExtension>();
+                    auto capture_func = args[1].cast<ffi::ObjectRef>();
+                    Any func_args = args[2];
+                    int64_t entry_index = args[3].cast<int64_t>();
+                    ffi::Optional<ffi::Shape> shape_expr = std::nullopt;
+                    if (args.size() == 5) {
+                      shape_expr = args[4].cast<ffi::Shape>();
+                    }
+                    *rv = extension->RunOrCapture(vm, capture_func, func_args, entry_index,
+                                                  shape_expr);
+                  })
+      .def_packed("vm.builtin.rocm_graph.get_cached_alloc",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    TVM_FFI_ICHECK_EQ(args.size(), 3);
+                    vm::VirtualMachine* vm = vm::VirtualMachine::GetContextPtr(args[0]);
+                    auto extension = vm->GetOrCreateExtension<HIPGraphExtension>();
+                    auto alloc_func = args[1].cast<ffi::ObjectRef>();
+                    int64_t entry_index = args[2].cast<int64_t>();
+                    *rv = extension->GetCachedAllocation(vm, alloc_func, entry_index);
+                  });
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -50,6 +50,7 @@ void RegisterTargetKind() {
       .add_attr_option<bool>("supports_dedicated_allocation")
       .add_attr_option<bool>("supports_integer_dot_product")
       .add_attr_option<bool>("supports_cooperative_matrix")
+      .add_attr_option<bool>("supports_timeline_semaphore")
       .add_attr_option<int64_t>("supported_subgroup_operations")
       .add_attr_option<int64_t>("max_num_threads", refl::DefaultValue(256))
       .add_attr_option<int64_t>("max_threads_per_block", refl::DefaultValue(256))
@@ -38,7 +38,7 @@ VkBufferCreateInfo MakeBufferCreateInfo(size_t nbytes, VkBufferUsageFlags usage)
 }
 
 VulkanBuffer::VulkanBuffer(const VulkanDevice& device, size_t nbytes, VkBufferUsageFlags usage,
-                           uint32_t mem_type_index)
+                           uint32_t mem_type_index, VulkanMemoryAllocator* allocator)
     : device_(device) {
   // Create a buffer
   VkBufferCreateInfo buffer_info = MakeBufferCreateInfo(nbytes, usage);
@@ -56,6 +56,18 @@ VulkanBuffer::VulkanBuffer(const VulkanDevice& device, size_t nbytes, VkBufferUs
   if (use_dedicated_allocation) {
     dedicated_info.buffer = buffer;
     mem_info.pNext = &dedicated_info;
+  } else if (allocator) {
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(device, buffer, &req);
+    if (allocator->Accepts(req)) {
+      // Place the buffer in a shared memory block
+      allocation_ = allocator->Allocate(req, mem_type_index);
+      allocator_ = allocator;
+      memory = allocation_.memory;
+      memory_offset = allocation_.offset;
+      VULKAN_CALL(vkBindBufferMemory(device, buffer, memory, memory_offset));
+      return;
+    }
   }
 
   VULKAN_CALL(vkAllocateMemory(device, &mem_info, nullptr, &memory));
@@ -68,22 +80,34 @@ VulkanBuffer::~VulkanBuffer() {
   if (buffer) {
     vkDestroyBuffer(device_, buffer, nullptr);
   }
-  if (memory) {
+  if (allocator_) {
+    allocator_->Free(allocation_);
+  } else if (memory) {
     vkFreeMemory(device_, memory, nullptr);
   }
 }
 
 VulkanBuffer::VulkanBuffer(VulkanBuffer&& other)
-    : device_(other.device_), buffer(other.buffer), memory(other.memory) {
+    : device_(other.device_),
+      buffer(other.buffer),
+      memory(other.memory),
+      memory_offset(other.memory_offset),
+      allocator_(other.allocator_),
+      allocation_(other.allocation_) {
   other.device_ = VK_NULL_HANDLE;
   other.buffer = VK_NULL_HANDLE;
   other.memory = VK_NULL_HANDLE;
+  other.memory_offset = 0;
+  other.allocator_ = nullptr;
 }
 
 VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) {
   std::swap(device_, other.device_);
   std::swap(buffer, other.buffer);
   std::swap(memory, other.memory);
+  std::swap(memory_offset, other.memory_offset);
+  std::swap(allocator_, other.allocator_);
+  std::swap(allocation_, other.allocation_);
   return *this;
 }
 
@@ -25,6 +25,8 @@
 #include <memory>
 #include <unordered_map>
 
+#include "vulkan_memory_allocator.h"
+
 namespace tvm {
 namespace runtime {
 namespace vulkan {
@@ -46,9 +48,14 @@ class VulkanBuffer {
    * \param mem_type_index The memory type to index.  This should be
    * an index to a compatible memory located in
    * VkPhysicalDeviceMemoryProperties.
+   *
+   * \param allocator The allocator to place the buffer in one of its
+   * memory blocks, or nullptr to always allocate memory for the
+   * buffer alone.  Buffers that need a dedicated allocation, or that
+   * the allocator does not accept, get memory of their own.
    */
   VulkanBuffer(const VulkanDevice& device, size_t nbytes, VkBufferUsageFlags usage,
-               uint32_t mem_type_index);
+               uint32_t mem_type_index, VulkanMemoryAllocator* allocator = nullptr);
 
   //! \brief Destructor, deallocates the memory and buffer.
   ~VulkanBuffer();
@@ -103,6 +110,16 @@ class VulkanBuffer {
   //! \brief Handle to the physical device memory
   VkDeviceMemory memory{VK_NULL_HANDLE};
 
+  //! \brief The offset of the buffer in the memory, non-zero only if sub-allocated
+  VkDeviceSize memory_offset{0};
+
+ private:
+  //! \brief The allocator the memory was taken from, nullptr if owned by the buffer
+  VulkanMemoryAllocator* allocator_{nullptr};
+
+  //! \brief The placement of the buffer in a block of the allocator
+  VulkanMemoryAllocation allocation_;
+
   friend class VulkanHostVisibleBuffer;
 };
 
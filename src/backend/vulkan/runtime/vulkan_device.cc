@@ -70,6 +70,8 @@ VulkanDeviceProperties::VulkanDeviceProperties(const VulkanInstance& instance,
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES};
   VkPhysicalDeviceShaderFloat16Int8Features float16_int8 = {
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES};
+  VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
 
   // Set up linked list for feature query
   {
@@ -86,6 +88,10 @@ VulkanDeviceProperties::VulkanDeviceProperties(const VulkanInstance& instance,
       *pp_next = &float16_int8;
       pp_next = &float16_int8.pNext;
     }
+    if (device.HasExtension("VK_KHR_timeline_semaphore")) {
+      *pp_next = &timeline_semaphore;
+      pp_next = &timeline_semaphore.pNext;
+    }
   }
 
   if (instance.HasExtension("VK_KHR_get_physical_device_properties2")) {
@@ -138,6 +144,12 @@ VulkanDeviceProperties::VulkanDeviceProperties(const VulkanInstance& instance,
 
   supports_cooperative_matrix = device.HasExtension("VK_NV_cooperative_matrix");
 
+  // Support is available based on this extension, but allow it to
+  // be disabled based on an environment variable.
+  supports_timeline_semaphore =
+      timeline_semaphore.timelineSemaphore &&
+      !support::BoolEnvironmentVar("TVM_VULKAN_DISABLE_TIMELINE_SEMAPHORE");
+
   // The check of VK_SHADER_STAGE_COMPUTE_BIT isn't technically
   // needed, since it will be set so long at least one queue has
   // VK_QUEUE_COMPUTE_BIT.  Including it to avoid potential future
@@ -241,6 +253,11 @@ VulkanGetBufferMemoryRequirements2Functions::VulkanGetBufferMemoryRequirements2F
       vkGetDeviceProcAddr(device, "vkGetBufferMemoryRequirements2KHR"));
 }
 
+VulkanTimelineSemaphoreKHRFunctions::VulkanTimelineSemaphoreKHRFunctions(VkDevice device) {
+  vkWaitSemaphoresKHR = (PFN_vkWaitSemaphoresKHR)TVM_FFI_ICHECK_NOTNULL(
+      vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+}
+
 VulkanQueueInsertDebugUtilsLabelFunctions::VulkanQueueInsertDebugUtilsLabelFunctions(
     VkInstance instance) {
   vkQueueInsertDebugUtilsLabelEXT = (PFN_vkQueueInsertDebugUtilsLabelEXT)TVM_FFI_ICHECK_NOTNULL(
@@ -351,6 +368,12 @@ VulkanDevice::VulkanDevice(const VulkanInstance& instance, VkPhysicalDevice phy_
     queue_insert_debug_utils_label_functions =
         std::make_unique<VulkanQueueInsertDebugUtilsLabelFunctions>(instance);
   }
+
+  if (device_properties.supports_timeline_semaphore) {
+    timeline_semaphore_functions = std::make_unique<VulkanTimelineSemaphoreKHRFunctions>(device_);
+  }
+
+  memory_allocator = std::make_unique<VulkanMemoryAllocator>(device_, compute_memory_size);
 }
 
 VulkanDevice::~VulkanDevice() {
@@ -361,6 +384,7 @@ VulkanDevice::~VulkanDevice() {
   stream_per_thread.Clear();
   staging_buffer_per_thread.Clear();
   uniform_buffer_per_thread.Clear();
+  memory_allocator.reset();
 
   if (device_) {
     vkDestroyDevice(device_, nullptr);
@@ -391,8 +415,10 @@ void VulkanDevice::do_swap(VulkanDevice&& other) {
             other.get_buffer_memory_requirements_2_functions);
   std::swap(queue_insert_debug_utils_label_functions,
             other.queue_insert_debug_utils_label_functions);
+  std::swap(timeline_semaphore_functions, other.timeline_semaphore_functions);
   std::swap(compute_mtype_index, other.compute_mtype_index);
   std::swap(compute_memory_size, other.compute_memory_size);
+  std::swap(memory_allocator, other.memory_allocator);
   std::swap(queue, other.queue);
   std::swap(queue_family_index, other.queue_family_index);
   std::swap(physical_device_, other.physical_device_);
@@ -451,7 +477,8 @@ std::vector<const char*> VulkanDevice::SelectEnabledExtensions() const {
                                                "VK_KHR_dedicated_allocation",
                                                "VK_KHR_spirv_1_4",
                                                "VK_KHR_shader_integer_dot_product",
-                                               "VK_NV_cooperative_matrix"};
+                                               "VK_NV_cooperative_matrix",
+                                               "VK_KHR_timeline_semaphore"};
 
   uint32_t device_extension_prop_count;
   VULKAN_CALL(vkEnumerateDeviceExtensionProperties(physical_device_, nullptr,
@@ -477,6 +504,8 @@ void VulkanDevice::CreateVkDevice(const VulkanInstance& instance) {
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES};
   VkPhysicalDeviceShaderFloat16Int8Features float16_int8 = {
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES};
+  VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
 
   void** pp_next = &enabled_features.pNext;
   bool needs_float16_int8 = false;
@@ -513,6 +542,11 @@ void VulkanDevice::CreateVkDevice(const VulkanInstance& instance) {
     *pp_next = &float16_int8;
     pp_next = &float16_int8.pNext;
   }
+  if (device_properties.supports_timeline_semaphore) {
+    timeline_semaphore.timelineSemaphore = true;
+    *pp_next = &timeline_semaphore;
+    pp_next = &timeline_semaphore.pNext;
+  }
 
   float priority = 1.0f;
 
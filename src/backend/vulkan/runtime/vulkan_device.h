@@ -57,6 +57,12 @@ struct VulkanGetBufferMemoryRequirements2Functions {
   PFN_vkGetBufferMemoryRequirements2KHR vkGetBufferMemoryRequirements2KHR{nullptr};
 };
 
+struct VulkanTimelineSemaphoreKHRFunctions {
+  explicit VulkanTimelineSemaphoreKHRFunctions(VkDevice device);
+
+  PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR{nullptr};
+};
+
 struct VulkanQueueInsertDebugUtilsLabelFunctions {
   explicit VulkanQueueInsertDebugUtilsLabelFunctions(VkInstance instance);
 
@@ -89,6 +95,7 @@ struct VulkanDeviceProperties {
   bool supports_dedicated_allocation{false};
   bool supports_integer_dot_product{false};
   bool supports_cooperative_matrix{false};
+  bool supports_timeline_semaphore{false};
   uint32_t supported_subgroup_operations{0};
   uint32_t max_num_threads{1};
   uint32_t thread_warp_size{1};
@@ -221,10 +228,13 @@ class VulkanDevice {
       get_buffer_memory_requirements_2_functions{nullptr};
   std::unique_ptr<VulkanQueueInsertDebugUtilsLabelFunctions>
       queue_insert_debug_utils_label_functions{nullptr};
+  std::unique_ptr<VulkanTimelineSemaphoreKHRFunctions> timeline_semaphore_functions{nullptr};
   // Memory type index for compute
   uint32_t compute_mtype_index{0};
   // maximum memory size for compute
   int64_t compute_memory_size{0};
+  // Sub-allocator of the compute buffers, destroyed before the device
+  std::unique_ptr<VulkanMemoryAllocator> memory_allocator{nullptr};
 
   // queue family_index;
   uint32_t queue_family_index{uint32_t(-1)};
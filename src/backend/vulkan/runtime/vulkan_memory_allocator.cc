@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "vulkan_memory_allocator.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+#include "../../../support/env.h"
+#include "vulkan_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace vulkan {
+
+namespace {
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(VkDevice device, int64_t heap_size)
+    : device_(device) {
+  std::string mode = support::GetEnv<std::string>("TVM_VULKAN_SUBALLOCATOR", "free_list");
+  if (mode == "free_list") {
+    mode_ = Mode::kFreeList;
+  } else if (mode == "linear") {
+    mode_ = Mode::kLinear;
+  } else if (mode == "none") {
+    mode_ = Mode::kNone;
+  } else {
+    TVM_FFI_THROW(ValueError) << "Unknown TVM_VULKAN_SUBALLOCATOR " << mode
+                              << ", expected one of free_list, linear and none";
+  }
+  int64_t block_size = support::GetEnv<int64_t>("TVM_VULKAN_MEMORY_BLOCK_BYTES", 256 << 20);
+  TVM_FFI_CHECK_GT(block_size, 0, ValueError) << "TVM_VULKAN_MEMORY_BLOCK_BYTES must be positive";
+  // A block should not take a large share of a small heap, e.g. of an integrated GPU.
+  if (heap_size > 0) {
+    block_size = std::min(block_size, heap_size / 8);
+  }
+  block_size_ = static_cast<VkDeviceSize>(block_size);
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+  for (auto& [block_id, block] : blocks_) {
+    vkFreeMemory(device_, block.memory, nullptr);
+  }
+}
+
+bool VulkanMemoryAllocator::Accepts(const VkMemoryRequirements& req) const {
+  return mode_ != Mode::kNone && req.size + req.alignment <= block_size_ / 2;
+}
+
+bool VulkanMemoryAllocator::PlaceIn(Block* block, const VkMemoryRequirements& req,
+                                    VkDeviceSize* offset) {
+  if (mode_ == Mode::kLinear) {
+    VkDeviceSize begin = AlignUp(block->top, req.alignment);
+    if (begin + req.size > block->size) return false;
+    block->top = begin + req.size;
+    *offset = begin;
+    return true;
+  }
+  for (auto it = block->free_ranges.begin(); it != block->free_ranges.end(); ++it) {
+    VkDeviceSize range_begin = it->first;
+    VkDeviceSize range_end = it->first + it->second;
+    VkDeviceSize begin = AlignUp(range_begin, req.alignment);
+    if (begin + req.size > range_end) continue;
+    block->free_ranges.erase(it);
+    // Keep the padding before the buffer and the rest after it free.
+    if (begin > range_begin) {
+      block->free_ranges[range_begin] = begin - range_begin;
+    }
+    if (begin + req.size < range_end) {
+      block->free_ranges[begin + req.size] = range_end - begin - req.size;
+    }
+    *offset = begin;
+    return true;
+  }
+  return false;
+}
+
+VulkanMemoryAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& req,
+                                                       uint32_t mem_type_index) {
+  TVM_FFI_ICHECK(Accepts(req));
+  std::lock_guard<std::mutex> lock(mutex_);
+  VulkanMemoryAllocation allocation;
+  allocation.size = req.size;
+  for (auto& [block_id, block] : blocks_) {
+    if (block.mem_type_index != mem_type_index) continue;
+    if (PlaceIn(&block, req, &allocation.offset)) {
+      allocation.memory = block.memory;
+      allocation.block_id = block_id;
+      block.num_allocations += 1;
+      num_allocations_ += 1;
+      return allocation;
+    }
+  }
+
+  Block block;
+  block.mem_type_index = mem_type_index;
+  block.size = block_size_;
+  block.free_ranges[0] = block_size_;
+  VkMemoryAllocateInfo mem_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+  mem_info.allocationSize = block_size_;
+  mem_info.memoryTypeIndex = mem_type_index;
+  VULKAN_CALL(vkAllocateMemory(device_, &mem_info, nullptr, &block.memory));
+  VLOG(1) << "New Vulkan memory block of " << block_size_ << " bytes of memory type "
+          << mem_type_index;
+  TVM_FFI_ICHECK(PlaceIn(&block, req, &allocation.offset));
+  block.num_allocations = 1;
+  allocation.memory = block.memory;
+  allocation.block_id = next_block_id_++;
+  blocks_.emplace(allocation.block_id, std::move(block));
+  num_allocations_ += 1;
+  return allocation;
+}
+
+void VulkanMemoryAllocator::Free(const VulkanMemoryAllocation& allocation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = blocks_.find(allocation.block_id);
+  TVM_FFI_ICHECK(it != blocks_.end()) << "Freeing a Vulkan buffer of an unknown memory block";
+  Block& block = it->second;
+  num_allocations_ -= 1;
+  if (mode_ == Mode::kFreeList) {
+    VkDeviceSize begin = allocation.offset;
+    VkDeviceSize end = allocation.offset + allocation.size;
+    // Merge the range with its free neighbours.
+    auto next = block.free_ranges.lower_bound(begin);
+    if (next != block.free_ranges.end() && next->first == end) {
+      end = next->first + next->second;
+      next = block.free_ranges.erase(next);
+    }
+    if (next != block.free_ranges.begin()) {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == begin) {
+        begin = prev->first;
+        block.free_ranges.erase(prev);
+      }
+    }
+    block.free_ranges[begin] = end - begin;
+  }
+  if (--block.num_allocations > 0) return;
+  block.top = 0;
+  // Keep the last block of a memory type, so that a steady state of
+  // allocations does not allocate and free a block over and over.
+  bool has_other = std::any_of(blocks_.begin(), blocks_.end(), [&](const auto& kv) {
+    return kv.first != allocation.block_id && kv.second.mem_type_index == block.mem_type_index;
+  });
+  if (has_other) {
+    vkFreeMemory(device_, block.memory, nullptr);
+    blocks_.erase(it);
+  }
+}
+
+int64_t VulkanMemoryAllocator::NumBlocks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int64_t>(blocks_.size());
+}
+
+int64_t VulkanMemoryAllocator::NumAllocations() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_allocations_;
+}
+
+}  // namespace vulkan
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TVM_RUNTIME_VULKAN_VULKAN_MEMORY_ALLOCATOR_H_
+#define TVM_RUNTIME_VULKAN_VULKAN_MEMORY_ALLOCATOR_H_
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace runtime {
+namespace vulkan {
+
+/*! \brief The placement of a buffer in a memory block of a VulkanMemoryAllocator. */
+struct VulkanMemoryAllocation {
+  //! \brief The memory of the block
+  VkDeviceMemory memory{VK_NULL_HANDLE};
+  //! \brief The offset of the buffer in the block
+  VkDeviceSize offset{0};
+  //! \brief The size of the buffer in the block
+  VkDeviceSize size{0};
+  //! \brief The id of the block in its allocator
+  int64_t block_id{-1};
+};
+
+/*! \brief Sub-allocates buffers out of large VkDeviceMemory blocks, one pool per memory type
+ *
+ * Drivers cap the number of live vkAllocateMemory allocations
+ * (maxMemoryAllocationCount, often 4096), and each of them is slow.
+ * The allocator carves the buffers out of blocks of a fixed size
+ * instead, and only the buffers larger than half of a block get a
+ * memory allocation of their own.
+ *
+ * In the free-list mode, the free ranges of each block are kept
+ * sorted by offset, a buffer takes the first range it fits in, and a
+ * freed range is merged with its free neighbours.  In the linear
+ * mode, the buffers are bumped from the top of a block, which is
+ * reset once all of them are freed.  The linear mode suits the
+ * statically planned storage, which is allocated once and freed
+ * together, while the free-list mode handles dynamic allocations.
+ *
+ * The mode is read from TVM_VULKAN_SUBALLOCATOR, one of "free_list"
+ * (the default), "linear" or "none", and the block size from
+ * TVM_VULKAN_MEMORY_BLOCK_BYTES, 256MB by default.
+ */
+class VulkanMemoryAllocator {
+ public:
+  enum class Mode {
+    //! \brief Every buffer has a memory allocation of its own
+    kNone,
+    //! \brief First-fit placement over the free ranges of the blocks
+    kFreeList,
+    //! \brief Bump placement, a block is reused once it is empty
+    kLinear,
+  };
+
+  /*! \brief Create the allocator of a device
+   *
+   * \param device The device to allocate on, which should outlive the allocator.
+   *
+   * \param heap_size The size of the heap of the compute memory type, which bounds the
+   * block size.
+   */
+  VulkanMemoryAllocator(VkDevice device, int64_t heap_size);
+
+  //! \brief Destructor, frees the memory of all blocks.
+  ~VulkanMemoryAllocator();
+
+  VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+  VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+  /*! \brief Whether a buffer of the memory requirements is sub-allocated from the blocks */
+  bool Accepts(const VkMemoryRequirements& req) const;
+
+  /*! \brief Place a buffer in a block of the memory type, allocating a new block if needed
+   *
+   * \param req The memory requirements of the buffer, which should be accepted.
+   *
+   * \param mem_type_index The memory type of the block.
+   */
+  VulkanMemoryAllocation Allocate(const VkMemoryRequirements& req, uint32_t mem_type_index);
+
+  /*! \brief Return the range of a buffer to its block */
+  void Free(const VulkanMemoryAllocation& allocation);
+
+  //! \brief The number of blocks allocated
+  int64_t NumBlocks() const;
+
+  //! \brief The number of buffers placed in the blocks
+  int64_t NumAllocations() const;
+
+ private:
+  struct Block {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    uint32_t mem_type_index{0};
+    VkDeviceSize size{0};
+    //! \brief The free ranges of the free-list mode, from offset to size
+    std::map<VkDeviceSize, VkDeviceSize> free_ranges;
+    //! \brief The top of the linear mode
+    VkDeviceSize top{0};
+    //! \brief The number of buffers placed in the block
+    int64_t num_allocations{0};
+  };
+
+  /*! \brief Try to place a buffer in a block, returns whether it fits */
+  bool PlaceIn(Block* block, const VkMemoryRequirements& req, VkDeviceSize* offset);
+
+  VkDevice device_{VK_NULL_HANDLE};
+  Mode mode_{Mode::kFreeList};
+  VkDeviceSize block_size_{0};
+  std::unordered_map<int64_t, Block> blocks_;
+  int64_t next_block_id_{0};
+  int64_t num_allocations_{0};
+  mutable std::mutex mutex_;
+};
+
+}  // namespace vulkan
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VULKAN_VULKAN_MEMORY_ALLOCATOR_H_
@@ -19,6 +19,9 @@
 
 #include "vulkan_stream.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "../../../support/utils.h"
 #include "vulkan_device.h"
 
@@ -50,6 +53,16 @@ VulkanStream::VulkanStream(const VulkanDevice* device)
   fence_cinfo.flags = 0;  // VK_FENCE_CREATE_SIGNALED_BIT;
   VULKAN_CALL(vkCreateFence(*device_, &fence_cinfo, nullptr, &(state_->fence_)));
 
+  if (device_->timeline_semaphore_functions) {
+    VkSemaphoreTypeCreateInfo semaphore_type_cinfo = {
+        VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    semaphore_type_cinfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphore_type_cinfo.initialValue = timeline_value_;
+    VkSemaphoreCreateInfo semaphore_cinfo = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    semaphore_cinfo.pNext = &semaphore_type_cinfo;
+    VULKAN_CALL(vkCreateSemaphore(*device_, &semaphore_cinfo, nullptr, &timeline_semaphore_));
+  }
+
   VkCommandBufferBeginInfo cb_begin;
   cb_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   cb_begin.pNext = nullptr;
@@ -63,6 +76,9 @@ VulkanStream::VulkanStream(const VulkanDevice* device)
 }
 
 VulkanStream::~VulkanStream() {
+  if (timeline_semaphore_ != VK_NULL_HANDLE) {
+    vkDestroySemaphore(*device_, timeline_semaphore_, nullptr);
+  }
   vkDestroyFence(*device_, state_->fence_, nullptr);
   vkDestroyCommandPool(*device_, cmd_pool_, nullptr);
 
@@ -72,6 +88,9 @@ VulkanStream::~VulkanStream() {
 }
 
 void VulkanStream::Launch(const std::function<void(VulkanStreamState*)>& kernel) {
+  // While capturing, the kernel is recorded into the graph rather
+  // than into the command buffer to be submitted.
+  has_pending_commands_ |= !IsCapturing();
   if (device_->UseImmediate()) {
     kernel(state_.get());
   } else {
@@ -83,6 +102,7 @@ void VulkanStream::LaunchDeferred(const std::function<void()>& deferred_initiali
                                   const std::function<void(VulkanStreamState*)>& deferred_kernel,
                                   const VulkanStreamToken& deferred_token) {
   TVM_FFI_ICHECK(!device_->UseImmediate());
+  has_pending_commands_ = true;
 
   // If the new kernel uses the same descriptor set as one of the
   // kernels already in the command buffer, we need to synchronize
@@ -118,6 +138,11 @@ void VulkanStream::LaunchDeferred(const std::function<void()>& deferred_initiali
 }
 
 void VulkanStream::Synchronize() {
+  TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+      << "Cannot synchronize a Vulkan stream while its commands are captured";
+  if (!has_pending_commands_) {
+    return;
+  }
   if (!device_->UseImmediate()) {
     for (const auto& deferred_kernel : deferred_kernels_) {
       deferred_kernel(state_.get());
@@ -141,20 +166,62 @@ void VulkanStream::Synchronize() {
   cb_submit.signalSemaphoreCount = 0;
   cb_submit.pSignalSemaphores = nullptr;
 
+  // With a timeline semaphore, the submission signals the next value of
+  // the semaphore instead of a fence, which needs no reset afterwards.
+  uint64_t signal_value = timeline_value_ + 1;
+  VkTimelineSemaphoreSubmitInfo timeline_submit = {
+      VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+  timeline_submit.signalSemaphoreValueCount = 1;
+  timeline_submit.pSignalSemaphoreValues = &signal_value;
+  if (timeline_semaphore_ != VK_NULL_HANDLE) {
+    cb_submit.pNext = &timeline_submit;
+    cb_submit.signalSemaphoreCount = 1;
+    cb_submit.pSignalSemaphores = &timeline_semaphore_;
+  }
+
   if (profiler_) {
     profiler_->capture();
   }
 
-  device_->QueueSubmit(cb_submit, state_->fence_);
-
   uint64_t timeout = 1UL << 30UL;
   VkResult res;
-  do {
-    res = vkWaitForFences(*device_, 1, &(state_->fence_), 0, timeout);
-  } while (res == VK_TIMEOUT);
-  VULKAN_CHECK_ERROR(res);
+  if (timeline_semaphore_ != VK_NULL_HANDLE) {
+    device_->QueueSubmit(cb_submit, VK_NULL_HANDLE);
+    timeline_value_ = signal_value;
+    VkSemaphoreWaitInfo wait_info = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline_semaphore_;
+    wait_info.pValues = &signal_value;
+    do {
+      res = device_->timeline_semaphore_functions->vkWaitSemaphoresKHR(*device_, &wait_info,
+                                                                      timeout);
+    } while (res == VK_TIMEOUT);
+    VULKAN_CHECK_ERROR(res);
+  } else {
+    device_->QueueSubmit(cb_submit, state_->fence_);
+    do {
+      res = vkWaitForFences(*device_, 1, &(state_->fence_), 0, timeout);
+    } while (res == VK_TIMEOUT);
+    VULKAN_CHECK_ERROR(res);
+    VULKAN_CALL(vkResetFences(*device_, 1, &(state_->fence_)));
+  }
   VULKAN_CALL(vkResetCommandBuffer(state_->cmd_buffer_, 0));
-  VULKAN_CALL(vkResetFences(*device_, 1, &(state_->fence_)));
+  has_pending_commands_ = false;
+
+  // The uploads have completed, keep their staging buffers for reuse
+  // up to the bound on the pending uploads.
+  size_t free_bytes = 0;
+  for (const auto& buffer : free_uploads_) {
+    free_bytes += buffer->size;
+  }
+  for (auto& buffer : pending_uploads_) {
+    if (free_bytes + buffer->size <= kMaxPendingUploadBytes) {
+      free_bytes += buffer->size;
+      free_uploads_.push_back(std::move(buffer));
+    }
+  }
+  pending_uploads_.clear();
+  pending_upload_bytes_ = 0;
 
   // Re-initialize the command buffer
   VkCommandBufferBeginInfo cb_begin;
@@ -165,6 +232,89 @@ void VulkanStream::Synchronize() {
   VULKAN_CALL(vkBeginCommandBuffer(state_->cmd_buffer_, &cb_begin));
 }
 
+VulkanStagingBuffer& VulkanStream::UploadStagingBuffer(size_t size) {
+  TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+      << "Cannot copy from the host to a Vulkan stream while its commands are captured";
+  if (!pending_uploads_.empty() && pending_upload_bytes_ + size > kMaxPendingUploadBytes) {
+    Synchronize();
+  }
+  // Reuse the smallest free staging buffer that is large enough.
+  auto it = free_uploads_.end();
+  for (auto cand = free_uploads_.begin(); cand != free_uploads_.end(); ++cand) {
+    if ((*cand)->size >= size && (it == free_uploads_.end() || (*cand)->size < (*it)->size)) {
+      it = cand;
+    }
+  }
+  if (it != free_uploads_.end()) {
+    pending_uploads_.push_back(std::move(*it));
+    free_uploads_.erase(it);
+  } else {
+    auto usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    pending_uploads_.push_back(
+        std::make_unique<VulkanStagingBuffer>(*device_, size, usage, device_->staging_mtype_index));
+  }
+  pending_upload_bytes_ += pending_uploads_.back()->size;
+  return *pending_uploads_.back();
+}
+
+void VulkanStream::BeginCapture() {
+  TVM_FFI_CHECK(device_->UseImmediate(), RuntimeError)
+      << "Capturing the commands of a Vulkan stream requires VK_KHR_push_descriptor";
+  TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+      << "The commands of the Vulkan stream are already captured";
+  capture_ = std::make_unique<VulkanCommandGraph>(device_);
+  capture_primary_cmd_buffer_ = state_->cmd_buffer_;
+  state_->cmd_buffer_ = capture_->cmd_buffer_;
+}
+
+std::unique_ptr<VulkanCommandGraph> VulkanStream::EndCapture() {
+  TVM_FFI_CHECK(IsCapturing(), RuntimeError)
+      << "The commands of the Vulkan stream are not captured";
+  state_->cmd_buffer_ = capture_primary_cmd_buffer_;
+  capture_primary_cmd_buffer_ = VK_NULL_HANDLE;
+  std::unique_ptr<VulkanCommandGraph> graph = std::move(capture_);
+  VULKAN_CALL(vkEndCommandBuffer(graph->cmd_buffer_));
+  return graph;
+}
+
+void VulkanStream::Replay(const VulkanCommandGraph& graph) {
+  TVM_FFI_CHECK(!IsCapturing(), RuntimeError)
+      << "Cannot replay a captured Vulkan command graph while capturing another";
+  Launch([&](VulkanStreamState* state) {
+    vkCmdExecuteCommands(state->cmd_buffer_, 1, &graph.cmd_buffer_);
+  });
+}
+
+VulkanCommandGraph::VulkanCommandGraph(const VulkanDevice* device) : device_(device) {
+  VkCommandPoolCreateInfo cmd_pool_cinfo;
+  cmd_pool_cinfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  cmd_pool_cinfo.pNext = nullptr;
+  cmd_pool_cinfo.flags = 0;
+  cmd_pool_cinfo.queueFamilyIndex = device_->queue_family_index;
+  VULKAN_CALL(vkCreateCommandPool(*device_, &cmd_pool_cinfo, nullptr, &cmd_pool_));
+
+  VkCommandBufferAllocateInfo buffer_alloc_info;
+  buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  buffer_alloc_info.pNext = nullptr;
+  buffer_alloc_info.commandPool = cmd_pool_;
+  buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+  buffer_alloc_info.commandBufferCount = 1;
+  VULKAN_CALL(vkAllocateCommandBuffers(*device_, &buffer_alloc_info, &cmd_buffer_));
+
+  // Compute commands are recorded outside of any render pass, so
+  // nothing is inherited from the primary command buffer.
+  VkCommandBufferInheritanceInfo inheritance_info = {
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+  VkCommandBufferBeginInfo cb_begin;
+  cb_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  cb_begin.pNext = nullptr;
+  cb_begin.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+  cb_begin.pInheritanceInfo = &inheritance_info;
+  VULKAN_CALL(vkBeginCommandBuffer(cmd_buffer_, &cb_begin));
+}
+
+VulkanCommandGraph::~VulkanCommandGraph() { vkDestroyCommandPool(*device_, cmd_pool_, nullptr); }
+
 }  // namespace vulkan
 }  // namespace runtime
 }  // namespace tvm
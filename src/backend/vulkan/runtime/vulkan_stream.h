@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "vulkan_amdrgp.h"
+#include "vulkan_buffer.h"
 #include "vulkan_common.h"
 
 namespace tvm {
@@ -46,6 +47,33 @@ struct VulkanStreamToken {
   std::vector<VkBuffer> buffers_;
 };
 
+/*!
+ * \brief A sequence of commands recorded once by VulkanStream::BeginCapture/EndCapture,
+ * and replayed any number of times by VulkanStream::Replay, the Vulkan counterpart of an
+ * instantiated CUDA graph.
+ *
+ * The commands are recorded into a secondary command buffer with the simultaneous use flag,
+ * which each replay executes from the primary command buffer of the stream, so that a replay
+ * is batched into the same queue submission as the surrounding commands.  Since the buffers
+ * and the scalar arguments of the kernels are baked into the commands, a graph may only be
+ * replayed while the buffers it accesses are alive.
+ */
+class VulkanCommandGraph {
+ public:
+  explicit VulkanCommandGraph(const VulkanDevice* device);
+  ~VulkanCommandGraph();
+
+  VulkanCommandGraph(const VulkanCommandGraph&) = delete;
+  VulkanCommandGraph& operator=(const VulkanCommandGraph&) = delete;
+
+  //! \brief The recorded secondary command buffer.
+  VkCommandBuffer cmd_buffer_{VK_NULL_HANDLE};
+
+ private:
+  const VulkanDevice* device_;
+  VkCommandPool cmd_pool_{VK_NULL_HANDLE};
+};
+
 /*!
  *  \brief Wrapper around a vulkan command buffer
  *
@@ -117,9 +145,58 @@ class VulkanStream {
   // Synchronize the current stream `state_` with respect to the host.
   void Synchronize();
 
+  /*! \brief Return a staging buffer for a host to device copy on the stream.
+   *
+   * Unlike VulkanDevice::ThreadLocalStagingBuffer, the buffer stays
+   * reserved until the next Synchronize, so host to device copies need
+   * not wait for the GPU and are batched into one queue submission
+   * with the kernels that follow them.  Synchronizes first if the
+   * pending uploads would exceed kMaxPendingUploadBytes.
+   *
+   * \param size The size in bytes of the staging buffer.
+   */
+  VulkanStagingBuffer& UploadStagingBuffer(size_t size);
+
+  /*! \brief Start recording the commands launched on the stream into a VulkanCommandGraph
+   *
+   * Until EndCapture, the launched kernels and device to device
+   * copies are recorded but not executed, while synchronizations and
+   * copies from or to the host are errors.  Requires the device to
+   * support push descriptors, as the descriptor sets of the deferred
+   * path are updated at launch rather than at replay.
+   */
+  void BeginCapture();
+
+  //! \brief Stop recording and return the recorded commands.
+  std::unique_ptr<VulkanCommandGraph> EndCapture();
+
+  //! \brief Whether the stream is recording a VulkanCommandGraph.
+  bool IsCapturing() const { return capture_ != nullptr; }
+
+  //! \brief Execute the recorded commands within the stream's command buffer.
+  void Replay(const VulkanCommandGraph& graph);
+
+  //! \brief The maximum total size of the staging buffers of the pending uploads.
+  static constexpr size_t kMaxPendingUploadBytes = size_t{64} << 20;
+
  private:
   const VulkanDevice* device_;
   std::unique_ptr<VulkanStreamState> state_;
+  // Whether any command was recorded into the command buffer since the
+  // last submission, so that synchronizing an idle stream is free.
+  bool has_pending_commands_{false};
+  // The timeline semaphore signalled by each submission, used instead
+  // of the fence if the device supports timeline semaphores.
+  VkSemaphore timeline_semaphore_{VK_NULL_HANDLE};
+  uint64_t timeline_value_{0};
+  // The staging buffers of the uploads pending until the next
+  // Synchronize, and those free to be reused.
+  std::vector<std::unique_ptr<VulkanStagingBuffer>> pending_uploads_;
+  std::vector<std::unique_ptr<VulkanStagingBuffer>> free_uploads_;
+  size_t pending_upload_bytes_{0};
+  // The graph being recorded, and the primary command buffer it replaces meanwhile.
+  std::unique_ptr<VulkanCommandGraph> capture_;
+  VkCommandBuffer capture_primary_cmd_buffer_{VK_NULL_HANDLE};
   // An index of deferred tokens, allowing us to efficiently detect duplicated
   // deferred_initializer blocks.
   std::unordered_map<VkDescriptorSet, std::vector<VulkanStreamToken>> deferred_tokens_;
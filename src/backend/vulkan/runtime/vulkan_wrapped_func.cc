@@ -22,7 +22,11 @@
 #include <tvm/ffi/cast.h>
 #include <tvm/support/io.h>
 
+#include <exception>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "../../../support/bytes_io.h"
 #include "vulkan_device_api.h"
@@ -49,6 +53,11 @@ void VulkanWrappedFunc::operator()(ffi::PackedArgs args, ffi::Any* rv,
   auto& device = VulkanDeviceAPI::Global()->device(device_id);
   if (!scache_[device_id]) {
     scache_[device_id] = m_->GetPipeline(device_id, func_name_, num_pack_args_);
+    // The pipeline may have been created on another thread, e.g. by Preload, which allocated
+    // the uniform buffer of that thread only.
+    if (scache_[device_id]->use_ubo) {
+      device.AllocateThreadLocalUniformBuffer(num_pack_args_ * sizeof(ArgUnion64));
+    }
   }
   const auto& pipeline = scache_[device_id];
   ThreadWorkLoad wl = launch_param_config_.Extract(args);
@@ -72,6 +81,10 @@ void VulkanWrappedFunc::operator()(ffi::PackedArgs args, ffi::Any* rv,
     descriptor_buffers.push_back(binfo);
   }
   if (device.UseImmediate()) {
+    // The uniform buffer is written at launch, so a replay of the captured
+    // dispatch would read the arguments of the latest launch.
+    TVM_FFI_CHECK(!pipeline->use_ubo || !device.ThreadLocalStream().IsCapturing(), RuntimeError)
+        << "Cannot capture " << func_name_ << ", whose arguments exceed the push constants";
     // Can safely capture by reference as this lambda is immediately executed on the calling thread.
     device.ThreadLocalStream().Launch([&](VulkanStreamState* state) {
       vkCmdBindPipeline(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
@@ -209,6 +222,12 @@ VulkanModuleNode::~VulkanModuleNode() {
 ffi::Optional<ffi::Function> VulkanModuleNode::GetFunction(const ffi::String& name) {
   ffi::ObjectPtr<ffi::Object> sptr_to_self = ffi::GetObjectPtr<ffi::Object>(this);
   TVM_FFI_ICHECK_EQ(sptr_to_self.get(), this);
+  if (name == "__tvm_preload") {
+    return ffi::Function::FromTyped(
+        [sptr_to_self, this](ffi::Array<ffi::String> func_names, ffi::Array<int64_t> device_ids) {
+          this->Preload(func_names, device_ids);
+        });
+  }
   auto opt_info = fmap_.Get(name);
   if (!opt_info.has_value()) return std::nullopt;
   FunctionInfo info = opt_info.value();
@@ -219,6 +238,59 @@ ffi::Optional<ffi::Function> VulkanModuleNode::GetFunction(const ffi::String& na
   return PackFuncNonBufferArg(std::move(f), info->arg_types);
 }
 
+void VulkanModuleNode::Preload(const ffi::Array<ffi::String>& func_names,
+                               const ffi::Array<int64_t>& device_ids) {
+  std::vector<std::string> names;
+  if (func_names.empty()) {
+    for (const auto& kv : fmap_) {
+      names.push_back(kv.first);
+    }
+  } else {
+    for (const ffi::String& name : func_names) {
+      TVM_FFI_CHECK(fmap_.count(name), ValueError)
+          << "The Vulkan module has no function named " << name;
+      names.push_back(name);
+    }
+  }
+  std::vector<size_t> devices;
+  if (device_ids.empty()) {
+    for (size_t i = 0; i < kVulkanMaxNumDevice; ++i) {
+      ffi::Any exist;
+      VulkanDeviceAPI::Global()->GetAttr({kDLVulkan, static_cast<int>(i)}, kExist, &exist);
+      if (!exist.cast<int>()) break;
+      devices.push_back(i);
+    }
+  } else {
+    for (int64_t device_id : device_ids) {
+      TVM_FFI_CHECK(device_id >= 0 && device_id < static_cast<int64_t>(kVulkanMaxNumDevice),
+                    ValueError)
+          << "Invalid Vulkan device id " << device_id;
+      devices.push_back(static_cast<size_t>(device_id));
+    }
+  }
+  std::vector<std::exception_ptr> errors(devices.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      try {
+        for (const std::string& name : names) {
+          FunctionInfo info = fmap_.Get(name).value();
+          size_t num_pack_args = info->arg_types.size() - NumBufferArgs(info->arg_types);
+          GetPipeline(devices[i], name, num_pack_args);
+        }
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
 std::shared_ptr<VulkanPipeline> VulkanModuleNode::GetPipeline(size_t device_id,
                                                               const std::string& func_name,
                                                               size_t num_pack_args) {
@@ -105,6 +105,13 @@ class VulkanModuleNode final : public ffi::ModuleObj {
   std::shared_ptr<VulkanPipeline> GetPipeline(size_t device_id, const std::string& func_name,
                                               size_t num_pack_args);
 
+  /*!
+   * \brief Create the pipelines of the kernels ahead of their first launch.
+   * \param func_names The kernels to create, all the kernels of the module if empty.
+   * \param device_ids The devices to create on, one thread each, all the devices if empty.
+   */
+  void Preload(const ffi::Array<ffi::String>& func_names, const ffi::Array<int64_t>& device_ids);
+
   ffi::Bytes SaveToBytes() const final;
   ffi::String InspectSource(const ffi::String& format) const final;
 
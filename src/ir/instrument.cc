@@ -21,16 +21,32 @@
  * \file src/ir/instrument.cc
  * \brief Infrastructure for instrumentation.
  */
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/extra/dataclass.h>
+#include <tvm/ffi/extra/json.h>
 #include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/accessor.h>
 #include <tvm/ffi/reflection/registry.h>
+#include <tvm/ir/function.h>
 #include <tvm/ir/instrument.h>
+#include <tvm/ir/source_map.h>
 #include <tvm/ir/transform.h>
 #include <tvm/runtime/logging.h>
 
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <map>
+#include <sstream>
 #include <stack>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 namespace instrument {
@@ -211,6 +227,26 @@ struct PassProfile {
   Duration duration;
   /*! \brief PassProfiles for all sub-passes invoked during the execution of the pass. */
   std::vector<PassProfile> children;
+  /*! \brief The number of IR nodes of the module before the pass, -1 when not counted. */
+  int64_t nodes_before{-1};
+  /*! \brief The number of IR nodes of the module after the pass, -1 when not counted. */
+  int64_t nodes_after{-1};
+  /*! \brief The peak resident set size of the process after the pass in KiB, -1 if unknown. */
+  int64_t peak_rss_kb{-1};
+
+  /*! \brief The work of the pass on one function. */
+  struct FunctionProfile {
+    /*! \brief The time when the pass started on the function. */
+    Time start;
+    /*! \brief The time the pass spent on the function, 0 when not a function pass. */
+    Duration duration{0};
+    /*! \brief The number of IR nodes of the function before the pass, -1 when absent. */
+    int64_t nodes_before{-1};
+    /*! \brief The number of IR nodes of the function after the pass, -1 when absent. */
+    int64_t nodes_after{-1};
+  };
+  /*! \brief The work of the pass on each function, ordered by name. */
+  std::map<std::string, FunctionProfile> functions;
 
   explicit PassProfile(ffi::String name)
       : name(name), start(Clock::now()), end(Clock::now()), children() {}
@@ -336,5 +372,338 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       });
 }
 
+/*!
+ * \brief Count the IR nodes reachable from a value, each shared node once.
+ *
+ * The containers, strings, shapes and spans are not counted as nodes.
+ */
+int64_t CountIRNodes(const ffi::Any& root) {
+  std::unordered_set<const ffi::Object*> visited;
+  std::vector<const ffi::Object*> stack;
+  auto push = [&](const ffi::Any& value) {
+    if (value.type_index() < ffi::TypeIndex::kTVMFFIStaticObjectBegin) return;
+    const ffi::Object* obj = value.as<ffi::Object>();
+    if (visited.insert(obj).second) stack.push_back(obj);
+  };
+  push(root);
+  int64_t count = 0;
+  // An explicit stack, since the statement and binding chains are deep.
+  while (!stack.empty()) {
+    const ffi::Object* obj = stack.back();
+    stack.pop_back();
+    int32_t type_index = obj->type_index();
+    if (type_index == ffi::TypeIndex::kTVMFFIArray) {
+      for (const ffi::Any& element : *static_cast<const ffi::ArrayObj*>(obj)) {
+        push(element);
+      }
+    } else if (type_index == ffi::TypeIndex::kTVMFFIMap) {
+      for (const auto& [key, value] : *static_cast<const ffi::MapObj*>(obj)) {
+        push(key);
+        push(value);
+      }
+    } else if (type_index != ffi::TypeIndex::kTVMFFIStr &&
+               type_index != ffi::TypeIndex::kTVMFFIBytes &&
+               type_index != ffi::TypeIndex::kTVMFFIShape && !obj->IsInstance<SpanNode>()) {
+      ++count;
+      const TVMFFITypeInfo* tinfo = TVMFFIGetTypeInfo(type_index);
+      if (tinfo->metadata != nullptr) {
+        ffi::reflection::ForEachFieldInfo(tinfo, [&](const TVMFFIFieldInfo* field_info) {
+          push(ffi::reflection::FieldGetter(field_info)(obj));
+        });
+      }
+    }
+  }
+  return count;
+}
+
+/*! \brief The peak resident set size of the process in KiB, -1 when unknown. */
+int64_t GetPeakRSSKB() {
+#if defined(_WIN32)
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+  // In bytes on macOS, and in KiB on Linux.
+  return static_cast<int64_t>(usage.ru_maxrss) / 1024;
+#else
+  return static_cast<int64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+/*!
+ * \brief The instrument profiling the passes in detail.
+ *
+ * In addition to the duration of each pass as PassTimingInstrument, it records the time of each
+ * pass relative to the entry of the pass context, the peak resident set size after the pass and,
+ * optionally, the number of IR nodes of the module before and after the pass, and the time and
+ * the nodes of each function. The profile of the last pass context is kept after the context
+ * exits, and renders as JSON or as a Chrome trace.
+ */
+class PassProfilingInstrumentNode : public PassInstrumentNode {
+ public:
+  /*! \brief Whether to count the IR nodes of the module before and after each pass. */
+  bool count_nodes{false};
+  /*! \brief Whether to break each pass down per function. */
+  bool per_function{false};
+
+  void EnterPassContext() const final {
+    root_ = PassProfile("root");
+    stack_.clear();
+    epoch_ = PassProfile::Clock::now();
+  }
+
+  void ExitPassContext() const final { stack_.clear(); }
+
+  bool ShouldRun(const IRModule&, const transform::PassInfo&) const final { return true; }
+
+  void RunBeforePass(const IRModule& mod, const transform::PassInfo& info) const final {
+    PassProfile* parent = Current();
+    parent->children.emplace_back(info->name);
+    PassProfile* profile = &parent->children.back();
+    stack_.push_back(profile);
+    if (count_nodes) {
+      profile->nodes_before = 0;
+      for (const auto& [gvar, func] : mod->functions) {
+        int64_t num_nodes = CountIRNodes(func);
+        profile->nodes_before += num_nodes;
+        if (per_function) profile->functions[gvar->name_hint].nodes_before = num_nodes;
+      }
+    }
+    // Started after counting, so that the counts do not add to the time of the pass.
+    profile->start = PassProfile::Clock::now();
+  }
+
+  void RunAfterPass(const IRModule& mod, const transform::PassInfo& info) const final {
+    TVM_FFI_ICHECK(!stack_.empty() && stack_.back()->name == info->name)
+        << "mismatched enter/exit for pass profiling";
+    PassProfile* profile = stack_.back();
+    profile->end = PassProfile::Clock::now();
+    profile->duration = profile->end - profile->start;
+    profile->peak_rss_kb = GetPeakRSSKB();
+    if (count_nodes) {
+      profile->nodes_after = 0;
+      for (const auto& [gvar, func] : mod->functions) {
+        int64_t num_nodes = CountIRNodes(func);
+        profile->nodes_after += num_nodes;
+        if (per_function) profile->functions[gvar->name_hint].nodes_after = num_nodes;
+      }
+    }
+    stack_.pop_back();
+  }
+
+  /*! \brief Record the work of the running pass on one function. */
+  void RecordFunction(const ffi::String& func_name, PassProfile::Time start,
+                      PassProfile::Time end) const {
+    if (stack_.empty()) return;
+    PassProfile::FunctionProfile& function = stack_.back()->functions[func_name];
+    // A pass may run several times on a function, as the fixed-point passes do.
+    if (function.duration.count() == 0) function.start = start;
+    function.duration += end - start;
+  }
+
+  /*! \brief Render the profile as a JSON object. */
+  ffi::String RenderJSON() const {
+    namespace json = ::tvm::ffi::json;
+    json::Object root;
+    PassProfile::Duration total(0);
+    for (const PassProfile& profile : root_.children) total += profile.duration;
+    root.Set("total_us", total.count());
+    root.Set("peak_rss_kb", GetPeakRSSKB());
+    root.Set("passes", RenderPassesJSON(root_.children));
+    return ffi::String(std::string(json::Stringify(root, 2)));
+  }
+
+  /*! \brief Render the profile in the trace event format of Chrome and Perfetto. */
+  ffi::String RenderChromeTrace() const {
+    namespace json = ::tvm::ffi::json;
+    json::Array events;
+    std::stack<const PassProfile*> profiles;
+    for (auto it = root_.children.rbegin(); it != root_.children.rend(); ++it) profiles.push(&*it);
+    while (!profiles.empty()) {
+      const PassProfile* profile = profiles.top();
+      profiles.pop();
+      json::Object args;
+      SetNodeCounts(&args, profile->nodes_before, profile->nodes_after);
+      events.push_back(MakeCompleteEvent(profile->name, "pass", profile->start, profile->duration,
+                                         std::move(args)));
+      for (const auto& [name, function] : profile->functions) {
+        if (function.duration.count() == 0) continue;
+        json::Object function_args;
+        SetNodeCounts(&function_args, function.nodes_before, function.nodes_after);
+        events.push_back(MakeCompleteEvent(ffi::String(name), "function", function.start,
+                                           function.duration, std::move(function_args)));
+      }
+      json::Object counters;
+      counters.Set("peak_rss_kb", profile->peak_rss_kb);
+      if (profile->nodes_after >= 0) counters.Set("ir_nodes", profile->nodes_after);
+      json::Object counter_event;
+      counter_event.Set("name", ffi::String("memory"));
+      counter_event.Set("ph", ffi::String("C"));
+      counter_event.Set("ts", ToMicros(profile->end));
+      counter_event.Set("pid", static_cast<int64_t>(0));
+      counter_event.Set("args", std::move(counters));
+      events.push_back(std::move(counter_event));
+      for (auto it = profile->children.rbegin(); it != profile->children.rend(); ++it) {
+        profiles.push(&*it);
+      }
+    }
+    json::Object root;
+    root.Set("traceEvents", std::move(events));
+    root.Set("displayTimeUnit", ffi::String("ms"));
+    return ffi::String(std::string(json::Stringify(root)));
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("instrument.PassProfilingInstrument",
+                                    PassProfilingInstrumentNode, PassInstrumentNode);
+
+ private:
+  PassProfile* Current() const { return stack_.empty() ? &root_ : stack_.back(); }
+
+  double ToMicros(PassProfile::Time time) const {
+    return std::chrono::duration_cast<PassProfile::Duration>(time - epoch_).count();
+  }
+
+  static void SetNodeCounts(ffi::json::Object* obj, int64_t nodes_before, int64_t nodes_after) {
+    if (nodes_before >= 0) obj->Set("nodes_before", nodes_before);
+    if (nodes_after >= 0) obj->Set("nodes_after", nodes_after);
+  }
+
+  ffi::json::Object MakeCompleteEvent(const ffi::String& name, const char* category,
+                                      PassProfile::Time start, PassProfile::Duration duration,
+                                      ffi::json::Object args) const {
+    ffi::json::Object event;
+    event.Set("name", name);
+    event.Set("cat", ffi::String(category));
+    event.Set("ph", ffi::String("X"));
+    event.Set("ts", ToMicros(start));
+    event.Set("dur", duration.count());
+    event.Set("pid", static_cast<int64_t>(0));
+    event.Set("tid", static_cast<int64_t>(0));
+    event.Set("args", std::move(args));
+    return event;
+  }
+
+  ffi::json::Array RenderPassesJSON(const std::vector<PassProfile>& profiles) const {
+    ffi::json::Array passes;
+    for (const PassProfile& profile : profiles) {
+      ffi::json::Object pass;
+      PassProfile::Duration self_duration = profile.duration;
+      for (const PassProfile& child : profile.children) self_duration -= child.duration;
+      pass.Set("name", profile.name);
+      pass.Set("start_us", ToMicros(profile.start));
+      pass.Set("duration_us", profile.duration.count());
+      pass.Set("self_us", self_duration.count());
+      pass.Set("peak_rss_kb", profile.peak_rss_kb);
+      SetNodeCounts(&pass, profile.nodes_before, profile.nodes_after);
+      // Only the functions that the pass transformed or changed the size of.
+      ffi::json::Array functions;
+      for (const auto& [name, function] : profile.functions) {
+        if (function.duration.count() == 0 && function.nodes_before == function.nodes_after) {
+          continue;
+        }
+        ffi::json::Object func;
+        func.Set("name", ffi::String(name));
+        func.Set("duration_us", function.duration.count());
+        SetNodeCounts(&func, function.nodes_before, function.nodes_after);
+        functions.push_back(std::move(func));
+      }
+      if (!functions.empty()) pass.Set("functions", std::move(functions));
+      if (!profile.children.empty()) pass.Set("passes", RenderPassesJSON(profile.children));
+      passes.push_back(std::move(pass));
+    }
+    return passes;
+  }
+
+  /*! \brief The placeholder top-level profile of the passes of the pass context. */
+  mutable PassProfile root_{"root"};
+  /*! \brief The profiles of the passes currently running, innermost last. */
+  mutable std::vector<PassProfile*> stack_;
+  /*! \brief The time when the pass context was entered. */
+  mutable PassProfile::Time epoch_{PassProfile::Clock::now()};
+};
+
+FunctionPassProfileScope::FunctionPassProfileScope(const ffi::Array<PassInstrument>& instruments,
+                                                   ffi::String func_name)
+    : func_name_(std::move(func_name)), start_(PassProfile::Clock::now()) {
+  for (const PassInstrument& pi : instruments) {
+    const auto* node = pi.as<PassProfilingInstrumentNode>();
+    if (node != nullptr && node->per_function) profilers_.push_back(pi);
+  }
+}
+
+FunctionPassProfileScope::~FunctionPassProfileScope() {
+  if (profilers_.empty()) return;
+  PassProfile::Time end = PassProfile::Clock::now();
+  for (const PassInstrument& pi : profilers_) {
+    pi.as<PassProfilingInstrumentNode>()->RecordFunction(func_name_, start_, end);
+  }
+}
+
+const PassProfilingInstrumentNode* GetPassProfiler(const PassInstrument& pi) {
+  const auto* node = pi.as<PassProfilingInstrumentNode>();
+  TVM_FFI_ICHECK(node != nullptr) << "expected a PassProfilingInstrument, but got " << pi->GetTypeKey();
+  return node;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::ObjectDef<PassProfilingInstrumentNode>()
+      .def_ro("count_nodes", &PassProfilingInstrumentNode::count_nodes)
+      .def_ro("per_function", &PassProfilingInstrumentNode::per_function);
+  refl::GlobalDef()
+      .def("instrument.MakePassProfilingInstrument",
+           [](bool count_nodes, bool per_function) {
+             auto n = ffi::make_object<PassProfilingInstrumentNode>();
+             n->name = "PassProfilingInstrument";
+             n->count_nodes = count_nodes;
+             n->per_function = per_function;
+             return PassInstrument(n);
+           })
+      .def("instrument.PassProfilingInstrumentRenderJSON",
+           [](PassInstrument pi) { return GetPassProfiler(pi)->RenderJSON(); })
+      .def("instrument.PassProfilingInstrumentRenderChromeTrace",
+           [](PassInstrument pi) { return GetPassProfiler(pi)->RenderChromeTrace(); });
+}
+
+ffi::String RenderPassCacheStats() {
+  std::vector<std::pair<std::string, ffi::Array<int64_t>>> stats;
+  for (const auto& [name, count] : transform::PassCache::Stats()) {
+    stats.emplace_back(name, count);
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  int64_t total_lookups = 0;
+  int64_t total_hits = 0;
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(2);
+  for (const auto& [name, count] : stats) {
+    int64_t lookups = count[0];
+    int64_t hits = count[1];
+    total_lookups += lookups;
+    total_hits += hits;
+    os << name << ": " << hits << "/" << lookups << " hits (" << 100.0 * hits / lookups << "%)\n";
+  }
+  if (total_lookups > 0) {
+    os << "total: " << total_hits << "/" << total_lookups << " hits ("
+       << 100.0 * total_hits / total_lookups << "%)\n";
+  }
+  return os.str();
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("instrument.RenderPassCacheStats", RenderPassCacheStats)
+      .def("instrument.MakePassCacheInstrument", []() {
+        auto enter_pass_ctx = []() { transform::PassCache::ResetStats(); };
+        return BasePassInstrument("PassCacheInstrument", enter_pass_ctx,
+                                  /* exit_pass_ctx */ nullptr,
+                                  /* should_run */ nullptr, /* run_before_pass */ nullptr,
+                                  /* run_after_pass */ nullptr);
+      });
+}
+
 }  // namespace instrument
 }  // namespace tvm
@@ -0,0 +1,542 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file serialization.cc
+ * \brief The compact binary serialization of IR nodes.
+ *
+ * The data starts with kMagic, followed by the string table, the type table, the nodes and the
+ * root value:
+ *  - strings: the count, then the length and the bytes of each string.
+ *  - types: the count, then the string ids of the type key and of the field names of each type.
+ *  - nodes: the count, then the kind and the payload of each node. The children of a node come
+ *    before it, so a node is decoded in one pass once its payload is read.
+ *  - root: a value, which is a tag and its payload, and refers to a node by its index.
+ * The integers are LEB128 varints, zigzag-encoded when they are signed.
+ */
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/container/map.h>
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/accessor.h>
+#include <tvm/ffi/reflection/creator.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/ffi/string.h>
+#include <tvm/ir/serialization.h>
+#include <tvm/runtime/tensor.h>
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../support/bytes_io.h"
+
+namespace tvm {
+namespace {
+
+constexpr const char kMagic[8] = {'T', 'V', 'M', 'I', 'R', 'B', 'N', '1'};
+
+/*! \brief The tag of a value. */
+enum ValueTag : uint8_t {
+  kNone = 0,
+  kBool = 1,
+  kInt = 2,
+  kFloat = 3,
+  kDataType = 4,
+  kDevice = 5,
+  kString = 6,
+  kBytes = 7,
+  kNode = 8,
+};
+
+/*! \brief The kind of a node. */
+enum NodeKind : uint8_t {
+  kArray = 0,
+  kMap = 1,
+  kShape = 2,
+  kTensor = 3,
+  /*! \brief An object saved through its `__data_to_json__` hook. */
+  kCustom = 4,
+  /*! \brief An object saved through the reflection of its fields. */
+  kObject = 5,
+};
+
+/*! \brief The `__data_to_json__` hooks of the types, which save an object as plain data. */
+const ffi::reflection::TypeAttrColumn& DataToJSONColumn() {
+  static ffi::reflection::TypeAttrColumn column("__data_to_json__");
+  return column;
+}
+
+/*! \brief The `__data_from_json__` hooks of the types, which load an object from its data. */
+const ffi::reflection::TypeAttrColumn& DataFromJSONColumn() {
+  static ffi::reflection::TypeAttrColumn column("__data_from_json__");
+  return column;
+}
+
+int32_t TypeKeyToIndex(const ffi::String& type_key) {
+  int32_t type_index;
+  TVMFFIByteArray type_key_array{type_key.data(), type_key.size()};
+  TVM_FFI_CHECK_SAFE_CALL(TVMFFITypeKeyToIndex(&type_key_array, &type_index));
+  return type_index;
+}
+
+class BinaryWriter {
+ public:
+  void WriteByte(uint8_t value) { buffer_.push_back(static_cast<char>(value)); }
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(value));
+  }
+
+  void WriteSigned(int64_t value) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  void WriteRaw(const void* data, size_t size) {
+    buffer_.append(static_cast<const char*>(data), size);
+  }
+
+  void WriteBlob(std::string_view blob) {
+    WriteVarint(blob.size());
+    WriteRaw(blob.data(), blob.size());
+  }
+
+  std::string& buffer() { return buffer_; }
+
+ private:
+  std::string buffer_;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view data) : data_(data) {}
+
+  uint8_t ReadByte() {
+    Require(1);
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      TVM_FFI_CHECK_LT(shift, 64, ValueError) << "Corrupted binary IR: a varint is too long";
+      uint8_t byte = ReadByte();
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+  }
+
+  int64_t ReadSigned() {
+    uint64_t value = ReadVarint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  std::string_view ReadRaw(size_t size) {
+    Require(size);
+    std::string_view result = data_.substr(pos_, size);
+    pos_ += size;
+    return result;
+  }
+
+  std::string_view ReadBlob() { return ReadRaw(ReadVarint()); }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  void Require(size_t size) {
+    TVM_FFI_CHECK_LE(size, data_.size() - pos_, ValueError)
+        << "Corrupted binary IR: unexpected end of data";
+  }
+
+  std::string_view data_;
+  size_t pos_{0};
+};
+
+class BinaryEncoder {
+ public:
+  std::string Encode(const ffi::Any& root) {
+    BinaryWriter root_writer;
+    this->WriteValue(&root_writer, root);
+
+    BinaryWriter writer;
+    writer.WriteRaw(kMagic, sizeof(kMagic));
+    writer.WriteVarint(strings_.size());
+    for (const std::string& str : strings_) {
+      writer.WriteBlob(str);
+    }
+    writer.WriteVarint(types_.size());
+    for (const std::vector<uint64_t>& type : types_) {
+      // The type key, then the field names.
+      writer.WriteVarint(type.size() - 1);
+      for (uint64_t str_id : type) {
+        writer.WriteVarint(str_id);
+      }
+    }
+    writer.WriteVarint(num_nodes_);
+    writer.WriteRaw(nodes_.buffer().data(), nodes_.buffer().size());
+    writer.WriteRaw(root_writer.buffer().data(), root_writer.buffer().size());
+    return std::move(writer.buffer());
+  }
+
+ private:
+  uint64_t InternString(std::string_view str) {
+    auto it = string_ids_.find(str);
+    if (it != string_ids_.end()) return it->second;
+    strings_.emplace_back(str);
+    uint64_t str_id = strings_.size() - 1;
+    string_ids_.emplace(strings_.back(), str_id);
+    return str_id;
+  }
+
+  void WriteValue(BinaryWriter* writer, const ffi::Any& value) {
+    switch (value.type_index()) {
+      case ffi::TypeIndex::kTVMFFINone: {
+        writer->WriteByte(kNone);
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFIBool: {
+        writer->WriteByte(kBool);
+        writer->WriteByte(value.cast<bool>());
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFIInt: {
+        writer->WriteByte(kInt);
+        writer->WriteSigned(value.cast<int64_t>());
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFIFloat: {
+        double v = value.cast<double>();
+        writer->WriteByte(kFloat);
+        writer->WriteRaw(&v, sizeof(v));
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFIDataType: {
+        DLDataType dtype = value.cast<DLDataType>();
+        writer->WriteByte(kDataType);
+        writer->WriteByte(dtype.code);
+        writer->WriteByte(dtype.bits);
+        writer->WriteVarint(dtype.lanes);
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFIDevice: {
+        DLDevice device = value.cast<DLDevice>();
+        writer->WriteByte(kDevice);
+        writer->WriteVarint(device.device_type);
+        writer->WriteSigned(device.device_id);
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFISmallStr:
+      case ffi::TypeIndex::kTVMFFIStr: {
+        ffi::String str = value.cast<ffi::String>();
+        writer->WriteByte(kString);
+        writer->WriteVarint(InternString(std::string_view(str.data(), str.size())));
+        return;
+      }
+      case ffi::TypeIndex::kTVMFFISmallBytes:
+      case ffi::TypeIndex::kTVMFFIBytes: {
+        ffi::Bytes bytes = value.cast<ffi::Bytes>();
+        writer->WriteByte(kBytes);
+        writer->WriteBlob(std::string_view(bytes.data(), bytes.size()));
+        return;
+      }
+      default: {
+        TVM_FFI_CHECK_GE(value.type_index(), ffi::TypeIndex::kTVMFFIStaticObjectBegin, TypeError)
+            << "Cannot serialize a value of type " << ffi::TypeIndexToTypeKey(value.type_index());
+        uint64_t node_id = this->VisitNode(value);
+        writer->WriteByte(kNode);
+        writer->WriteVarint(node_id);
+        return;
+      }
+    }
+  }
+
+  /*! \brief Write a node after its children, returning its index. */
+  uint64_t VisitNode(const ffi::Any& value) {
+    const ffi::Object* obj = value.as<ffi::Object>();
+    auto it = node_ids_.find(obj);
+    if (it != node_ids_.end()) return it->second;
+
+    BinaryWriter payload;
+    int32_t type_index = obj->type_index();
+    if (type_index == ffi::TypeIndex::kTVMFFIArray) {
+      const auto* array = static_cast<const ffi::ArrayObj*>(obj);
+      payload.WriteByte(kArray);
+      payload.WriteVarint(array->size());
+      for (const ffi::Any& element : *array) {
+        this->WriteValue(&payload, element);
+      }
+    } else if (type_index == ffi::TypeIndex::kTVMFFIMap) {
+      const auto* map = static_cast<const ffi::MapObj*>(obj);
+      payload.WriteByte(kMap);
+      payload.WriteVarint(map->size());
+      for (const auto& [key, val] : *map) {
+        this->WriteValue(&payload, key);
+        this->WriteValue(&payload, val);
+      }
+    } else if (type_index == ffi::TypeIndex::kTVMFFIShape) {
+      ffi::Shape shape = value.cast<ffi::Shape>();
+      payload.WriteByte(kShape);
+      payload.WriteVarint(shape.size());
+      for (int64_t dim : shape) {
+        payload.WriteSigned(dim);
+      }
+    } else if (type_index == ffi::TypeIndex::kTVMFFITensor) {
+      // The tensor data is kept raw, while the JSON hook of tensors encodes it in base64.
+      std::string blob;
+      support::BytesOutStream strm(&blob);
+      runtime::SaveDLTensor(&strm, static_cast<const ffi::TensorObj*>(obj));
+      payload.WriteByte(kTensor);
+      payload.WriteBlob(blob);
+    } else if (ffi::AnyView to_json = DataToJSONColumn()[type_index];
+               to_json.type_index() != ffi::TypeIndex::kTVMFFINone) {
+      ffi::Any data = to_json.cast<ffi::Function>()(value);
+      uint64_t type_key = InternString(obj->GetTypeKey());
+      payload.WriteByte(kCustom);
+      payload.WriteVarint(type_key);
+      this->WriteValue(&payload, data);
+    } else {
+      const TVMFFITypeInfo* tinfo = TVMFFIGetTypeInfo(type_index);
+      TVM_FFI_CHECK(tinfo->metadata != nullptr, TypeError)
+          << "Object `" << obj->GetTypeKey()
+          << "` misses reflection registration and do not support serialization";
+      payload.WriteByte(kObject);
+      payload.WriteVarint(this->GetTypeId(tinfo));
+      ffi::reflection::ForEachFieldInfo(tinfo, [&](const TVMFFIFieldInfo* field_info) {
+        this->WriteValue(&payload, ffi::reflection::FieldGetter(field_info)(obj));
+      });
+    }
+    nodes_.WriteRaw(payload.buffer().data(), payload.buffer().size());
+    uint64_t node_id = num_nodes_++;
+    node_ids_.emplace(obj, node_id);
+    return node_id;
+  }
+
+  uint64_t GetTypeId(const TVMFFITypeInfo* tinfo) {
+    auto it = type_ids_.find(tinfo->type_index);
+    if (it != type_ids_.end()) return it->second;
+    std::vector<uint64_t> type{InternString(std::string_view(tinfo->type_key.data,
+                                                             tinfo->type_key.size))};
+    ffi::reflection::ForEachFieldInfo(tinfo, [&](const TVMFFIFieldInfo* field_info) {
+      type.push_back(InternString(std::string_view(field_info->name.data, field_info->name.size)));
+    });
+    types_.push_back(std::move(type));
+    uint64_t type_id = types_.size() - 1;
+    type_ids_.emplace(tinfo->type_index, type_id);
+    return type_id;
+  }
+
+  /*! \brief The strings, in a deque so that the views of string_ids_ stay valid. */
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string_view, uint64_t> string_ids_;
+  /*! \brief The string ids of the type key and the field names of each type. */
+  std::vector<std::vector<uint64_t>> types_;
+  std::unordered_map<int32_t, uint64_t> type_ids_;
+  BinaryWriter nodes_;
+  uint64_t num_nodes_{0};
+  std::unordered_map<const ffi::Object*, uint64_t> node_ids_;
+};
+
+class BinaryDecoder {
+ public:
+  explicit BinaryDecoder(std::string_view data) : reader_(data) {}
+
+  ffi::Any Decode() {
+    TVM_FFI_CHECK(reader_.ReadRaw(sizeof(kMagic)) == std::string_view(kMagic, sizeof(kMagic)),
+                  ValueError)
+        << "The data is not in the binary IR form";
+    uint64_t num_strings = reader_.ReadVarint();
+    strings_.reserve(num_strings);
+    for (uint64_t i = 0; i < num_strings; ++i) {
+      std::string_view str = reader_.ReadBlob();
+      strings_.push_back(ffi::String(str.data(), str.size()));
+    }
+    uint64_t num_types = reader_.ReadVarint();
+    types_.reserve(num_types);
+    for (uint64_t i = 0; i < num_types; ++i) {
+      TypeEntry type;
+      uint64_t num_fields = reader_.ReadVarint();
+      int32_t type_index = TypeKeyToIndex(ReadString());
+      type.creator.emplace(ffi::TypeIndexToTypeKey(type_index));
+      type.field_names.reserve(num_fields);
+      for (uint64_t j = 0; j < num_fields; ++j) {
+        type.field_names.push_back(ReadString());
+      }
+      types_.push_back(std::move(type));
+    }
+    uint64_t num_nodes = reader_.ReadVarint();
+    nodes_.reserve(num_nodes);
+    for (uint64_t i = 0; i < num_nodes; ++i) {
+      nodes_.push_back(this->ReadNode());
+    }
+    ffi::Any root = this->ReadValue();
+    TVM_FFI_CHECK(reader_.AtEnd(), ValueError) << "Corrupted binary IR: trailing data";
+    return root;
+  }
+
+ private:
+  struct TypeEntry {
+    std::optional<ffi::reflection::ObjectCreator> creator;
+    std::vector<ffi::String> field_names;
+  };
+
+  const ffi::String& ReadString() {
+    uint64_t str_id = reader_.ReadVarint();
+    TVM_FFI_CHECK_LT(str_id, strings_.size(), ValueError)
+        << "Corrupted binary IR: unknown string #" << str_id;
+    return strings_[str_id];
+  }
+
+  ffi::Any ReadValue() {
+    uint8_t tag = reader_.ReadByte();
+    switch (tag) {
+      case kNone:
+        return ffi::Any(nullptr);
+      case kBool:
+        return ffi::Any(static_cast<bool>(reader_.ReadByte()));
+      case kInt:
+        return ffi::Any(reader_.ReadSigned());
+      case kFloat: {
+        double value;
+        std::memcpy(&value, reader_.ReadRaw(sizeof(value)).data(), sizeof(value));
+        return ffi::Any(value);
+      }
+      case kDataType: {
+        DLDataType dtype;
+        dtype.code = reader_.ReadByte();
+        dtype.bits = reader_.ReadByte();
+        dtype.lanes = static_cast<uint16_t>(reader_.ReadVarint());
+        return ffi::Any(dtype);
+      }
+      case kDevice: {
+        DLDevice device;
+        device.device_type = static_cast<DLDeviceType>(reader_.ReadVarint());
+        device.device_id = static_cast<int32_t>(reader_.ReadSigned());
+        return ffi::Any(device);
+      }
+      case kString:
+        return ffi::Any(ReadString());
+      case kBytes: {
+        std::string_view bytes = reader_.ReadBlob();
+        return ffi::Any(ffi::Bytes(bytes.data(), bytes.size()));
+      }
+      case kNode: {
+        uint64_t node_id = reader_.ReadVarint();
+        TVM_FFI_CHECK_LT(node_id, nodes_.size(), ValueError)
+            << "Corrupted binary IR: node #" << nodes_.size() << " refers to the node #"
+            << node_id << " that is not before it";
+        return nodes_[node_id];
+      }
+      default:
+        TVM_FFI_THROW(ValueError) << "Corrupted binary IR: unknown value tag " << int(tag);
+    }
+    return ffi::Any(nullptr);
+  }
+
+  ffi::Any ReadNode() {
+    uint8_t kind = reader_.ReadByte();
+    switch (kind) {
+      case kArray: {
+        uint64_t size = reader_.ReadVarint();
+        ffi::Array<ffi::Any> array;
+        array.reserve(size);
+        for (uint64_t i = 0; i < size; ++i) {
+          array.push_back(this->ReadValue());
+        }
+        return array;
+      }
+      case kMap: {
+        uint64_t size = reader_.ReadVarint();
+        ffi::Map<ffi::Any, ffi::Any> map;
+        for (uint64_t i = 0; i < size; ++i) {
+          ffi::Any key = this->ReadValue();
+          map.Set(key, this->ReadValue());
+        }
+        return map;
+      }
+      case kShape: {
+        std::vector<int64_t> dims(reader_.ReadVarint());
+        for (int64_t& dim : dims) {
+          dim = reader_.ReadSigned();
+        }
+        return ffi::Shape(dims.begin(), dims.end());
+      }
+      case kTensor: {
+        std::string_view blob = reader_.ReadBlob();
+        support::BytesInStream strm(blob.data(), blob.size());
+        runtime::Tensor tensor;
+        TVM_FFI_CHECK(tensor.Load(&strm), ValueError) << "Corrupted binary IR: invalid tensor";
+        return tensor;
+      }
+      case kCustom: {
+        const ffi::String& type_key = ReadString();
+        ffi::Any data = this->ReadValue();
+        ffi::AnyView from_json = DataFromJSONColumn()[TypeKeyToIndex(type_key)];
+        TVM_FFI_CHECK(from_json.type_index() != ffi::TypeIndex::kTVMFFINone, TypeError)
+            << "Type `" << type_key << "` does not have a `__data_from_json__` hook";
+        return from_json.cast<ffi::Function>()(data);
+      }
+      case kObject: {
+        uint64_t type_id = reader_.ReadVarint();
+        TVM_FFI_CHECK_LT(type_id, types_.size(), ValueError)
+            << "Corrupted binary IR: unknown type #" << type_id;
+        const TypeEntry& type = types_[type_id];
+        ffi::Map<ffi::String, ffi::Any> fields;
+        for (const ffi::String& field_name : type.field_names) {
+          fields.Set(field_name, this->ReadValue());
+        }
+        return (*type.creator)(fields);
+      }
+      default:
+        TVM_FFI_THROW(ValueError) << "Corrupted binary IR: unknown node kind " << int(kind);
+    }
+    return ffi::Any(nullptr);
+  }
+
+  BinaryReader reader_;
+  std::vector<ffi::String> strings_;
+  std::vector<TypeEntry> types_;
+  std::vector<ffi::Any> nodes_;
+};
+
+}  // namespace
+
+std::string SaveBinary(const ffi::Any& node) { return BinaryEncoder().Encode(node); }
+
+ffi::Any LoadBinary(std::string_view data) { return BinaryDecoder(data).Decode(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("ir.SaveBinary", [](ffi::Any node) { return ffi::Bytes(SaveBinary(node)); })
+      .def("ir.LoadBinary", [](ffi::Bytes data) {
+        return LoadBinary(std::string_view(data.data(), data.size()));
+      });
+}
+
+}  // namespace tvm
@@ -22,6 +22,9 @@
  * \brief Infrastructure for transformation passes.
  */
 #include <tvm/ffi/extra/dataclass.h>
+#include <tvm/ffi/extra/json.h>
+#include <tvm/ffi/extra/serialization.h>
+#include <tvm/ffi/extra/structural_equal.h>
 #include <tvm/ffi/extra/structural_hash.h>
 #include <tvm/ffi/extra/visit_error_context.h>
 #include <tvm/ffi/function.h>
@@ -29,13 +32,26 @@
 #include <tvm/ffi/rvalue_ref.h>
 #include <tvm/ir/transform.h>
 #include <tvm/relax/expr.h>
+#include <tvm/runtime/base.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <stack>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "../support/utils.h"
 
 namespace tvm {
 namespace transform {
@@ -43,6 +59,7 @@ namespace transform {
 using tvm::ffi::Any;
 
 TVM_REGISTER_PASS_CONFIG_OPTION("testing.immutable_module", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("ir.pass_cache_dir", ffi::String);
 
 struct PassContextThreadLocalEntry {
   /*! \brief The default pass context. */
@@ -78,6 +95,16 @@ void PassContext::ExitWithScope() {
   InstrumentExitPassContext();
 }
 
+PassContext::WorkerScope::WorkerScope(PassContext pass_ctx) : pass_ctx_(std::move(pass_ctx)) {
+  PassContextThreadLocalStoreGet()->context_stack.push(pass_ctx_);
+}
+
+PassContext::WorkerScope::~WorkerScope() {
+  PassContextThreadLocalEntry* entry = PassContextThreadLocalStoreGet();
+  TVM_FFI_DCHECK(!entry->context_stack.empty() && entry->context_stack.top().same_as(pass_ctx_));
+  entry->context_stack.pop();
+}
+
 PassContext PassContext::Current() {
   PassContextThreadLocalEntry* entry = PassContextThreadLocalStoreGet();
   if (!entry->context_stack.empty()) {
@@ -470,6 +497,108 @@ PassInfo::PassInfo(int opt_level, ffi::String name, tvm::ffi::Array<ffi::String>
   data_ = std::move(pass_info);
 }
 
+/*! \brief The lookups and hits of the pass cache, per pass name. */
+struct PassCacheCounters {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::pair<int64_t, int64_t>> counts;
+
+  static PassCacheCounters* Global() {
+    static PassCacheCounters* inst = new PassCacheCounters();
+    return inst;
+  }
+
+  void Record(const std::string& pass_name, bool hit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& [lookups, hits] = counts[pass_name];
+    ++lookups;
+    hits += hit;
+  }
+};
+
+PassCache::PassCache(const PassContext& pass_ctx, const PassInfo& pass_info) {
+  const char* kCacheDir = "ir.pass_cache_dir";
+  ffi::Optional<ffi::String> cache_dir = pass_ctx->GetConfig<ffi::String>(kCacheDir);
+  if (!cache_dir.has_value() || cache_dir.value().empty()) return;
+  ffi::Map<ffi::String, Any> config;
+  for (const auto& kv : pass_ctx->config) {
+    if (kv.first != kCacheDir) config.Set(kv.first, kv.second);
+  }
+  cache_dir_ = cache_dir.value();
+  pass_name_ = pass_info->name;
+  pass_key_ = ffi::StructuralHash()(ffi::String(TVM_VERSION));
+  pass_key_ = support::HashCombine(pass_key_, ffi::StructuralHash()(pass_info->name));
+  pass_key_ = support::HashCombine(pass_key_, pass_ctx->opt_level);
+  pass_key_ = support::HashCombine(pass_key_, ffi::StructuralHash()(config));
+}
+
+std::string PassCache::EntryPath(uint64_t key) const {
+  std::ostringstream os;
+  for (char c : pass_name_) {
+    os << (std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+  }
+  os << "-" << std::hex << std::setw(16) << std::setfill('0') << key << ".json";
+  return (std::filesystem::path(cache_dir_) / os.str()).string();
+}
+
+ffi::Optional<BaseFunc> PassCache::Lookup(const BaseFunc& func, uint64_t* key) const {
+  *key = support::HashCombine(pass_key_, ffi::StructuralHash()(func));
+  ffi::Optional<BaseFunc> result = std::nullopt;
+  std::ifstream fin(EntryPath(*key));
+  if (fin) {
+    std::stringstream buffer;
+    buffer << fin.rdbuf();
+    try {
+      auto entry = ffi::FromJSONGraph(ffi::json::Parse(buffer.str()))
+                       .cast<ffi::Map<ffi::String, BaseFunc>>();
+      // Guard against hash collisions, and against functions referring to other functions
+      // of their module, which do not survive the round trip.
+      if (ffi::StructuralEqual()(entry.at("input"), func)) {
+        result = entry.at("output");
+      }
+    } catch (const ffi::Error& e) {
+      LOG(WARNING) << "Ignoring the invalid pass cache entry " << EntryPath(*key) << ": "
+                   << e.what();
+    }
+  }
+  PassCacheCounters::Global()->Record(pass_name_, result.has_value());
+  return result;
+}
+
+void PassCache::Insert(uint64_t key, const BaseFunc& func, const BaseFunc& result) const {
+  ffi::Map<ffi::String, BaseFunc> entry{{"input", func}, {"output", result}};
+  std::string path = EntryPath(key);
+  std::error_code ec;
+  std::filesystem::create_directories(cache_dir_, ec);
+  // Write a temporary file first, so that a concurrent reader never sees a partial entry.
+  std::ostringstream tmp_path;
+  tmp_path << path << "." << std::this_thread::get_id() << "."
+           << std::chrono::steady_clock::now().time_since_epoch().count() << ".tmp";
+  {
+    std::ofstream fout(tmp_path.str());
+    if (!fout) return;
+    fout << ffi::json::Stringify(ffi::ToJSONGraph(entry));
+  }
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.str().c_str());
+  }
+}
+
+ffi::Map<ffi::String, ffi::Array<int64_t>> PassCache::Stats() {
+  PassCacheCounters* counters = PassCacheCounters::Global();
+  std::lock_guard<std::mutex> lock(counters->mutex);
+  ffi::Map<ffi::String, ffi::Array<int64_t>> stats;
+  for (const auto& [pass_name, count] : counters->counts) {
+    stats.Set(pass_name, ffi::Array<int64_t>{count.first, count.second});
+  }
+  return stats;
+}
+
+void PassCache::ResetStats() {
+  PassCacheCounters* counters = PassCacheCounters::Global();
+  std::lock_guard<std::mutex> lock(counters->mutex);
+  counters->counts.clear();
+}
+
 ModulePass::ModulePass(std::function<IRModule(IRModule, PassContext)> pass_func,
                        PassInfo pass_info) {
   auto n = ffi::make_object<ModulePassNode>();
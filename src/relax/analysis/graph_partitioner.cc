@@ -20,7 +20,10 @@
 #include "./graph_partitioner.h"
 
 #include <tvm/ffi/cast.h>
+#include <tvm/relax/expr.h>
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 namespace tvm {
@@ -110,6 +113,9 @@ std::vector<GraphPartitioner::Group*> GraphPartitioner::Partition(
   for (int phase = 0; phase < 3; ++phase) {
     this->RunFuse(graph, post_dom_tree, phase);
   }
+  if (horizontal_fusion_) {
+    this->RunHorizontalFuse(graph);
+  }
   return std::move(groups_);
 }
 
@@ -129,6 +135,24 @@ GraphPartitioner::Group* GraphPartitioner::Group::FindRoot() {
   return root;
 }
 
+/*! \brief The number of bytes of the static-shape tensor bound to a graph node, or -1. */
+int64_t GetStaticTensorBytes(const tvm::ffi::Object* ref) {
+  const auto* var = ffi::GetRef<ffi::ObjectRef>(ref).as<VarNode>();
+  if (var == nullptr) return -1;
+  const auto* ty = var->ty.as<TensorTypeNode>();
+  if (ty == nullptr || ty->IsUnknownDtype() || !ty->shape.has_value()) return -1;
+  const auto* shape = ty->shape.value().as<ShapeExprNode>();
+  if (shape == nullptr) return -1;
+  DLDataType dtype = ty->dtype.value()->dtype;
+  int64_t bytes = (static_cast<int64_t>(dtype.bits) * dtype.lanes + 7) / 8;
+  for (const PrimExpr& dim : shape->values) {
+    const auto* int_dim = dim.as<IntImmNode>();
+    if (int_dim == nullptr) return -1;
+    bytes *= int_dim->value;
+  }
+  return bytes;
+}
+
 template <typename F>
 bool GraphPartitioner::CheckPath_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
                                   F fcond) {
@@ -342,6 +366,7 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
           auto* src = it->second;
           auto* snode = post_dom_tree.nodes[src->index]->parent->gnode;
           if (groups_[snode->index]->anchor_ref != nullptr) continue;
+          if (!AcceptFusion(src, snode, GetStaticTensorBytes(src->ref), false)) continue;
           CommitFuse(src, snode);
         }
       }
@@ -379,7 +404,9 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
         // dom_root_group can also be tuple, as in inception layers
         // CheckPath is needed to avoid fusing two intermediate tuples
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+            AcceptFusion(graph_node, dom_node->parent->gnode,
+                         GetStaticTensorBytes(graph_node->ref), false)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -402,7 +429,9 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
         TVM_FFI_ICHECK(dom_node->parent->gnode != nullptr);
         // The fuse can be executed if all the intermediate ops are still broadcast.
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+            AcceptFusion(graph_node, dom_node->parent->gnode,
+                         GetStaticTensorBytes(graph_node->ref), false)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -422,7 +451,9 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
                     kind == kOutEWiseFusable);
           }
         };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+            AcceptFusion(graph_node, dom_node->parent->gnode,
+                         GetStaticTensorBytes(graph_node->ref), false)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -432,7 +463,9 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
       if (phase != 1) continue;
       // Check if all path are injective.
       auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
-      if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+      if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+          AcceptFusion(graph_node, dom_node->parent->gnode, GetStaticTensorBytes(graph_node->ref),
+                       false)) {
         CommitFuse(graph_node, dom_node->parent->gnode);
       }
     } else {
@@ -442,5 +475,63 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
   }
 }
 
+bool GraphPartitioner::AcceptFusion(const IndexedForwardGraph::Node* lhs,
+                                    const IndexedForwardGraph::Node* rhs, int64_t bytes,
+                                    bool horizontal) {
+  if (!fcost_.has_value()) return true;
+  return fcost_.value()(ffi::GetRef<ffi::ObjectRef>(lhs->ref),
+                        ffi::GetRef<ffi::ObjectRef>(rhs->ref), bytes, horizontal);
+}
+
+bool GraphPartitioner::GroupReaches(const IndexedForwardGraph& graph, Group* from, Group* to) {
+  std::vector<IndexedForwardGraph::Node*> stack;
+  std::unordered_set<IndexedForwardGraph::Node*> visited;
+  for (IndexedForwardGraph::Node* node : graph.post_dfs_order) {
+    if (groups_[node->index]->FindRoot() == from) {
+      stack.push_back(node);
+      visited.insert(node);
+    }
+  }
+  while (!stack.empty()) {
+    IndexedForwardGraph::Node* node = stack.back();
+    stack.pop_back();
+    for (auto link = node->outputs.head; link != nullptr; link = link->next) {
+      IndexedForwardGraph::Node* next = link->value.node;
+      if (groups_[next->index]->FindRoot() == to) return true;
+      if (visited.insert(next).second) stack.push_back(next);
+    }
+  }
+  return false;
+}
+
+void GraphPartitioner::RunHorizontalFuse(const IndexedForwardGraph& graph) {
+  for (IndexedForwardGraph::Node* producer : graph.post_dfs_order) {
+    // A dataflow var is only used inside its own dataflow block, which keeps the siblings in
+    // the same block.
+    if (!ffi::GetRef<ffi::ObjectRef>(producer->ref).as<DataflowVarNode>()) continue;
+    int64_t bytes = GetStaticTensorBytes(producer->ref);
+    Group* merged = nullptr;
+    IndexedForwardGraph::Node* merged_node = nullptr;
+    for (auto link = producer->outputs.head; link != nullptr; link = link->next) {
+      IndexedForwardGraph::Node* consumer = link->value.node;
+      Group* group = groups_[consumer->index]->FindRoot();
+      if (group->pattern > kBroadcast || group->anchor_ref != nullptr) continue;
+      if (merged == nullptr) {
+        merged = group;
+        merged_node = consumer;
+        continue;
+      }
+      if (group == merged) continue;
+      if (merged->num_nodes + group->num_nodes > max_fuse_depth_) continue;
+      // Refuse the fusion when one sibling group depends on the other, as merging them would
+      // introduce a cycle between the groups.
+      if (GroupReaches(graph, merged, group) || GroupReaches(graph, group, merged)) continue;
+      if (!AcceptFusion(merged_node, consumer, bytes, true)) continue;
+      MergeFromTo(group, merged);
+      merged->pattern = std::max(merged->pattern, group->pattern);
+    }
+  }
+}
+
 }  // namespace relax
 }  // namespace tvm
@@ -26,6 +26,7 @@
 #define TVM_RELAX_ANALYSIS_GRAPH_PARTITIONER_H_
 
 #include <tvm/ffi/cast.h>
+#include <tvm/ffi/function.h>
 #include <tvm/relax/op_attr_types.h>
 #include <tvm/relax/type.h>
 #include <tvm/runtime/logging.h>
@@ -165,12 +166,26 @@ class DominatorTree {
  */
 class GraphPartitioner {
  public:
+  /*!
+   * \brief The fusion cost hook. It is called as `fcost(lhs, rhs, bytes, horizontal)` before
+   * two groups are fused, where `lhs` and `rhs` are the bound vars of the nodes being fused.
+   * For a vertical fusion, `lhs` is the producer, `rhs` its post-dominator and `bytes` the size
+   * of the intermediate tensor `lhs` that the fusion keeps on chip. For a horizontal fusion,
+   * `lhs` and `rhs` are siblings and `bytes` the size of the input they share. `bytes` is -1
+   * when the size is not static. The fusion is refused when the hook returns false.
+   */
+  using FCost = ffi::TypedFunction<bool(ffi::ObjectRef, ffi::ObjectRef, int64_t, bool)>;
+
   explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth,
-                            size_t max_function_args)
+                            size_t max_function_args,
+                            ffi::Optional<FCost> fcost = std::nullopt,
+                            bool horizontal_fusion = false)
       : arena_(arena),
         opt_level_(opt_level),
         max_fuse_depth_(max_fuse_depth),
-        max_function_args_(max_function_args) {}
+        max_function_args_(max_function_args),
+        fcost_(std::move(fcost)),
+        horizontal_fusion_(horizontal_fusion) {}
   /*!
    * \brief Group as a union find data structure.
    */
@@ -218,6 +233,10 @@ class GraphPartitioner {
   size_t max_fuse_depth_;
   /*! \brief The maximum number of arguments in one fused function */
   size_t max_function_args_;
+  /*! \brief The optional fusion cost hook */
+  ffi::Optional<FCost> fcost_;
+  /*! \brief Whether to fuse the sibling elementwise groups that read the same input */
+  bool horizontal_fusion_;
   /*! \brief The internal groups. */
   std::vector<Group*> groups_;
   /*! \brief internal field used for deduplication */
@@ -300,6 +319,25 @@ class GraphPartitioner {
 
   // execute the fusion algorithm.
   void RunFuse(const IndexedForwardGraph& graph, const DominatorTree& post_dom_tree, int phase);
+
+  /*!
+   * \brief Ask the fusion cost hook, if any, whether the groups of two nodes may be fused.
+   * \param lhs The producer, or the first sibling for a horizontal fusion.
+   * \param rhs The post-dominator, or the second sibling for a horizontal fusion.
+   * \param bytes The size of the tensor the fusion saves a round trip of, -1 if unknown.
+   * \param horizontal Whether the fusion is horizontal.
+   */
+  bool AcceptFusion(const IndexedForwardGraph::Node* lhs, const IndexedForwardGraph::Node* rhs,
+                    int64_t bytes, bool horizontal);
+
+  // Check whether any node of group `from` reaches a node of group `to` in the graph.
+  bool GroupReaches(const IndexedForwardGraph& graph, Group* from, Group* to);
+
+  /*!
+   * \brief Fuse the sibling elementwise and broadcast groups that read the same input,
+   * so that the input is loaded once by a single kernel.
+   */
+  void RunHorizontalFuse(const IndexedForwardGraph& graph);
 };
 
 }  // namespace relax
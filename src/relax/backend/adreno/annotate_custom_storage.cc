@@ -245,7 +245,9 @@
 #include <tvm/relax/op_attr_types.h>
 #include <tvm/tirx/index_map.h>
 
+#include <map>
 #include <tuple>
+#include <unordered_set>
 
 #include "../../op/tensor/manipulate.h"
 #include "../../transform/infer_layout_utils.h"
@@ -354,6 +356,10 @@ class CollectConsumerScopeInfo : public ExprVisitor {
     }
 
     auto is_texture_supported = SupportsTexture(op_attrs, op_pattern.value());
+    // Elementwise and injective kernels read either scope, so their demand is only a preference.
+    if (op_pattern.value() < OpPatternKind::kCommReduce) {
+      flexible_calls_.insert(call);
+    }
 
     ffi::Array<ffi::String> arg_scope;
     for (uint32_t i = 0; i < func_args->fields.size(); ++i) {
@@ -375,6 +381,9 @@ class CollectConsumerScopeInfo : public ExprVisitor {
     call_scope_info.Set(ffi::GetRef<Expr>(call), arg_scope);
   }
 
+  /*! \brief The calls whose argument scopes may follow their producers. */
+  const std::unordered_set<const CallNode*>& flexible_calls() const { return flexible_calls_; }
+
  private:
   template <typename T>
   ffi::Array<Attrs> ExtractAttrs(const T& func) {
@@ -463,6 +472,8 @@ class CollectConsumerScopeInfo : public ExprVisitor {
   ffi::Map<Expr, ffi::Array<ffi::String>> call_scope_info;
   ffi::Map<Expr, ffi::Map<Expr, int>> tuple_item_to_binding;
   ffi::Map<Expr, ffi::Array<Expr>> tuples_to_binding;
+  /* The calls that read either scope, see flexible_calls() */
+  std::unordered_set<const CallNode*> flexible_calls_;
   IRModule mod_;
   Target target_;
 };
@@ -471,7 +482,9 @@ class CollectConsumerScopeInfo : public ExprVisitor {
  * \brief producer scope information consolidated based on consumer demands.
  * \return producer_info which is a map of each call node and corresponding out Type
  * This pass considers all consumers and their scope demand.
- * Any mismatches here introduces copies as needed.
+ * The demands of the consumers that need a scope win over the demands of the flexible
+ * consumers, which later read the producer scope as is. Any remaining mismatch introduces
+ * a copy.
  */
 class CollectProducerScopeInfo : public ExprVisitor {
  public:
@@ -480,9 +493,11 @@ class CollectProducerScopeInfo : public ExprVisitor {
   ffi::Map<Expr, Type> Collect(
       const IRModule& mod, Function func,
       const ffi::Map<Expr, ffi::Map<Expr, ffi::Array<ffi::String>>>& scope_info,
-      const Target& target, const BlockBuilder& builder) {
+      const std::unordered_set<const CallNode*>& flexible_calls, const Target& target,
+      const BlockBuilder& builder) {
     mod_ = mod;
     scope_info_ = scope_info;
+    flexible_calls_ = &flexible_calls;
     target_ = target;
     builder_ = builder;
     VisitExpr(func->body);
@@ -508,35 +523,44 @@ class CollectProducerScopeInfo : public ExprVisitor {
       out_ty = op_map_infer_ty[op](ffi::GetRef<Call>(call), builder_);
     }
 
-    std::unordered_map<ffi::String, int> scope_count;
+    // Count the demands of the consumers that need a scope apart from the flexible ones.
+    std::map<std::string, int> strict_count;
+    std::map<std::string, int> flexible_count;
 
     // Decide the final scope based on the max consumer demand. Rest will use to_device.
     auto arg_var = binding->var.as<VarNode>();
     if (scope_info_.find(ffi::GetRef<Expr>(arg_var)) != scope_info_.end()) {
       for (const auto& val : scope_info_[ffi::GetRef<Expr>(arg_var)]) {
-        auto call_node = val.first.as_or_throw<Call>();
-        if (scope_count.find(val.second[0]) == scope_count.end()) {
-          scope_count.insert({val.second[0], 1});
-        } else {
-          auto curr_count = scope_count[val.second[0]];
-          scope_count.emplace(val.second[0], curr_count + 1);
-        }
-      }
-    }
-    ffi::String final_scope = "global";
-    int count = 0;
-    for (const auto& sval : scope_count) {
-      if (sval.second > count) {
-        final_scope = sval.first;
-        count = sval.second;
+        const CallNode* consumer = val.first.as<CallNode>();
+        auto& scope_count = flexible_calls_->count(consumer) ? flexible_count : strict_count;
+        scope_count[val.second[0]]++;
       }
     }
+    ffi::String final_scope =
+        MaxDemandScope(strict_count.empty() ? flexible_count : strict_count);
+    var_scope_.Set(binding->var, final_scope);
     // Applying same scope for outputs
     Type updated_ret_ty = UpdateOutputType(out_ty, {final_scope});
     producer_ty.Set(ffi::GetRef<Expr>(call), updated_ret_ty);
   }
 
+  /*! \brief The scope decided for each var bound to a call. */
+  const ffi::Map<Var, ffi::String>& var_scope() const { return var_scope_; }
+
  private:
+  /*! \brief The most demanded scope, preferring a texture on a tie. */
+  static ffi::String MaxDemandScope(const std::map<std::string, int>& scope_count) {
+    std::string final_scope = "global";
+    int count = 0;
+    for (const auto& [scope, num] : scope_count) {
+      if (num > count || (num == count && final_scope == "global")) {
+        final_scope = scope;
+        count = num;
+      }
+    }
+    return final_scope;
+  }
+
   Type UpdateOutputType(const Type& out_ty, ffi::Array<ffi::String> scope) {
     if (out_ty->IsInstance<TensorTypeNode>()) {
       auto tensor_ty = out_ty.as_or_throw<TensorType>();
@@ -565,7 +589,9 @@ class CollectProducerScopeInfo : public ExprVisitor {
   }
 
   ffi::Map<Expr, ffi::Map<Expr, ffi::Array<ffi::String>>> scope_info_;
+  const std::unordered_set<const CallNode*>* flexible_calls_ = nullptr;
   ffi::Map<Expr, Type> producer_ty;
+  ffi::Map<Var, ffi::String> var_scope_;
   IRModule mod_;
   Target target_;
   BlockBuilder builder_;
@@ -591,11 +617,16 @@ class DefineVDevice : ExprMutator {
         if (base_func->HasNonzeroAttr(attr::kPrimitive)) {
           continue;
         }
-        auto info = CollectConsumerScopeInfo().Collect(mod_, func.as_or_throw<Function>(), target_);
+        Function relax_func = func.as_or_throw<Function>();
+        CollectConsumerScopeInfo consumer_info;
+        auto info = consumer_info.Collect(mod_, relax_func, target_);
         call_scope_info_ = info.first;
         scope_info_ = info.second;
-        producer_ty_ = CollectProducerScopeInfo().Collect(mod_, func.as_or_throw<Function>(),
-                                                          scope_info_, target_, builder_);
+        CollectProducerScopeInfo producer_info;
+        producer_ty_ = producer_info.Collect(mod_, relax_func, scope_info_,
+                                             consumer_info.flexible_calls(), target_, builder_);
+        AlignFlexibleConsumers(relax_func, consumer_info.flexible_calls(),
+                               producer_info.var_scope());
         relax::Function update_func = VisitExpr(func).as_or_throw<Function>();
         updates_->Add(gv, update_func);
       }
@@ -700,6 +731,42 @@ class DefineVDevice : ExprMutator {
   }
 
  private:
+  /*!
+   * \brief Let the flexible consumers read their arguments in the scope of the producer, so
+   * that the whole graph, rather than each op, decides where a scope change copy is needed.
+   */
+  void AlignFlexibleConsumers(const Function& func,
+                              const std::unordered_set<const CallNode*>& flexible_calls,
+                              const ffi::Map<Var, ffi::String>& var_scope) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    std::unordered_set<const VarNode*> params;
+    for (const Var& param : func->params) {
+      params.insert(param.get());
+    }
+    for (const CallNode* call : flexible_calls) {
+      Expr call_expr = ffi::GetRef<Expr>(call);
+      auto it = call_scope_info_.find(call_expr);
+      if (it == call_scope_info_.end()) continue;
+      ffi::Array<ffi::String> arg_scope = (*it).second;
+      ffi::Array<Expr> args =
+          call->op.same_as(call_tir_op) ? call->args[1].as_or_throw<Tuple>()->fields : call->args;
+      size_t arg_idx = 0;
+      for (const Expr& arg : args) {
+        if (!GetType(arg).as<TensorType>()) continue;
+        if (const auto* var = arg.as<VarNode>()) {
+          if (auto scope = var_scope.Get(ffi::GetRef<Var>(var))) {
+            arg_scope.Set(arg_idx, scope.value());
+          } else if (params.count(var)) {
+            // The parameters stay in buffers.
+            arg_scope.Set(arg_idx, "global");
+          }
+        }
+        ++arg_idx;
+      }
+      call_scope_info_.Set(call_expr, arg_scope);
+    }
+  }
+
   VDevice MakeGlobalVDevice(VDevice vdev) {
     int device_type = vdev->target->GetTargetDeviceType();
     for (size_t i = 0; i < vdevices_.size(); ++i) {
@@ -64,17 +64,14 @@ class CublasJSONSerializer : public JSONSerializer {
       inputs_tmp.insert(inputs_tmp.end(), res.begin(), res.end());
     }
 
-    TVM_FFI_ICHECK(inputs_tmp.size() <= 4);
-    NodeEntries inputs(inputs_tmp.size());
-
+    // The runtime expects the inputs present in the pattern in this order.
+    NodeEntries inputs;
     auto arg_idx = backend::ExtractArgIdx(composite_name, fn);
-    inputs[0] = inputs_tmp[arg_idx["lhs"]->value];
-    inputs[1] = inputs_tmp[arg_idx["rhs"]->value];
-    if (inputs_tmp.size() == 3) {
-      inputs[2] = inputs_tmp[arg_idx["bias"]->value];
-    } else if (inputs_tmp.size() == 4) {
-      inputs[2] = inputs_tmp[arg_idx["scaleA"]->value];
-      inputs[3] = inputs_tmp[arg_idx["scaleB"]->value];
+    for (const char* name :
+         {"lhs", "rhs", "bias", "scaleA", "scaleB", "residual", "channel_scale"}) {
+      if (arg_idx.count(name)) {
+        inputs.push_back(inputs_tmp[arg_idx[name]->value]);
+      }
     }
 
     auto node = std::make_shared<JSONGraphNode>(composite_name, /* name_ */
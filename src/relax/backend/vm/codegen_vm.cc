@@ -23,15 +23,18 @@
  */
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/reflection/registry.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relax/exec_builder.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/op_attr_types.h>
 #include <tvm/runtime/vm/bytecode.h>
 #include <tvm/target/target.h>
 #include <tvm/tirx/function.h>
+#include <tvm/tirx/op.h>
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../../../runtime/const_loader_module.h"
@@ -47,13 +50,98 @@ using namespace relax;
 using namespace tvm::runtime;
 using namespace tvm::runtime::vm;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.backend.use_unchecked_kernel_entry", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.backend.use_direct_kernel_call", bool);
+
+/*!
+ * \brief Whether the types of the arguments prove every check that the packed entry of the
+ *  PrimFunc makes on them: static shapes, dtypes and devices of compact tensors, and the
+ *  dtypes of scalars.
+ */
+bool ArgsProvenForPrimFunc(const tirx::PrimFunc& func, const ffi::Array<Expr>& args) {
+  if (func->params.size() != args.size()) return false;
+  ffi::Optional<Target> target = func->GetAttr<Target>(tvm::attr::kTarget);
+  for (size_t i = 0; i < args.size(); ++i) {
+    const tirx::Var& param = func->params[i];
+    if (auto opt_buffer = func->buffer_map.Get(param)) {
+      const tirx::Buffer& buffer = opt_buffer.value();
+      const auto* tensor = args[i]->ty.as<TensorTypeNode>();
+      if (tensor == nullptr || !tensor->dtype.has_value() ||
+          tensor->dtype.value()->dtype != buffer->dtype->dtype) {
+        return false;
+      }
+      // The tensors of the VM are compact and start at their data pointer.
+      if (!buffer->strides.empty() || !tirx::is_zero(buffer->elem_offset)) return false;
+      ffi::Optional<ffi::Array<PrimExpr>> shape = tensor->GetShape();
+      if (!shape.has_value() || shape.value().size() != buffer->shape.size()) return false;
+      for (size_t k = 0; k < buffer->shape.size(); ++k) {
+        const auto* expected = buffer->shape[k].as<IntImmNode>();
+        const auto* actual = shape.value()[k].as<IntImmNode>();
+        if (expected == nullptr || actual == nullptr || expected->value != actual->value) {
+          return false;
+        }
+      }
+      // A tensor without a virtual device is on the device of the kernel.
+      if (tensor->vdevice.has_value() && target.has_value() &&
+          tensor->vdevice.value()->target->GetTargetDeviceType() !=
+              target.value()->GetTargetDeviceType()) {
+        return false;
+      }
+    } else {
+      const auto* expected = param->ty.as<PrimTypeNode>();
+      const auto* actual = args[i]->ty.as<PrimTypeNode>();
+      if (expected == nullptr || actual == nullptr || expected->dtype != actual->dtype) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief Whether the PrimFunc called with the proven arguments can get a direct C entry: it
+ *  runs on the host, and takes only tensors on the host and integers.
+ */
+bool IsDirectCallable(const tirx::PrimFunc& func, const ffi::Array<Expr>& args) {
+  // A PrimFunc without a target is compiled for the target of the build.
+  ffi::Optional<Target> target = func->GetAttr<Target>(tvm::attr::kTarget);
+  if (!target.has_value()) {
+    Target current = Target::Current(/*allow_not_defined=*/true);
+    if (current.defined()) target = current;
+  }
+  if (!target.has_value() || target.value()->GetTargetDeviceType() != kDLCPU) return false;
+  if (!IsVoidType(func->ret_type)) return false;
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (const auto* tensor = args[i]->ty.as<TensorTypeNode>()) {
+      if (tensor->vdevice.has_value() &&
+          tensor->vdevice.value()->target->GetTargetDeviceType() != kDLCPU) {
+        return false;
+      }
+    } else {
+      auto prim_type = func->params[i]->ty.as<PrimType>();
+      if (!prim_type.has_value() ||
+          !prim_type.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt,
+                                         DLDataTypeCode::kDLBool)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 /*!
  * \brief A class to generate VM executable for Relax functions.
  */
 class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
  public:
   explicit CodeGenVM(relax::ExecBuilder builder, IRModule ctx_mod)
-      : builder_(builder), ctx_mod_(ctx_mod) {}
+      : builder_(builder), ctx_mod_(ctx_mod) {
+    tvm::transform::PassContext pass_ctx = tvm::transform::PassContext::Current();
+    use_unchecked_entry_ =
+        pass_ctx->GetConfig<bool>("relax.backend.use_unchecked_kernel_entry").value_or(false);
+    use_direct_call_ =
+        pass_ctx->GetConfig<bool>("relax.backend.use_direct_kernel_call").value_or(false);
+  }
 
   static IRModule Run(relax::ExecBuilder builder, IRModule mod) {
     IRModule res_mod = mod;
@@ -66,6 +154,16 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
         res_mod->Remove(gvar);
       }
     }
+    // Let MakePackedAPI emit the unchecked entries that the VM calls.
+    for (const GlobalVar& gvar : codegen.unchecked_callees_) {
+      auto prim_func = mod->Lookup(gvar).as<tirx::PrimFunc>().value();
+      res_mod->Update(gvar, WithAttr(std::move(prim_func), tirx::attr::kEmitUncheckedEntry, true));
+    }
+    // Let MakePackedAPI emit the direct entries that the VM calls.
+    for (const GlobalVar& gvar : codegen.direct_callees_) {
+      auto prim_func = res_mod->Lookup(gvar).as<tirx::PrimFunc>().value();
+      res_mod->Update(gvar, WithAttr(std::move(prim_func), tirx::attr::kEmitDirectEntry, true));
+    }
     return res_mod;
   }
 
@@ -389,8 +487,39 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
 
     builder_->EmitCall(func, args, dst_reg);
   }
+  /*!
+   * \brief Get the function that a call invokes. A PrimFunc whose arguments are proven at
+   *  compile time is called through its direct entry or its unchecked entry, if enabled.
+   */
+  Instruction::Arg VisitCallee(const Call& call_node) {
+    const auto* gvar = call_node->op.as<GlobalVarNode>();
+    if ((!use_unchecked_entry_ && !use_direct_call_) || gvar == nullptr) {
+      return VisitExpr(call_node->op);
+    }
+    auto it = ctx_mod_->functions.find(ffi::GetRef<GlobalVar>(gvar));
+    if (it == ctx_mod_->functions.end()) return VisitExpr(call_node->op);
+    auto prim_func = (*it).second.as<tirx::PrimFunc>();
+    if (!prim_func.has_value() ||
+        prim_func.value()->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol).value_or("") !=
+            gvar->name_hint ||
+        !ArgsProvenForPrimFunc(prim_func.value(), call_node->args)) {
+      return VisitExpr(call_node->op);
+    }
+    if (use_direct_call_ && IsDirectCallable(prim_func.value(), call_node->args)) {
+      ffi::String symbol = gvar->name_hint + tirx::attr::kDirectEntrySuffix;
+      direct_callees_.insert(ffi::GetRef<GlobalVar>(gvar));
+      builder_->DeclareFunction(symbol, VMFuncInfo::FuncKind::kDirectFunc);
+      return builder_->GetFunction(symbol);
+    }
+    if (!use_unchecked_entry_) return VisitExpr(call_node->op);
+    ffi::String symbol = gvar->name_hint + tirx::attr::kUncheckedEntrySuffix;
+    unchecked_callees_.insert(ffi::GetRef<GlobalVar>(gvar));
+    builder_->DeclareFunction(symbol, VMFuncInfo::FuncKind::kPackedFunc);
+    return builder_->GetFunction(symbol);
+  }
+
   void EmitNormalCall(const Call& call_node, RegName dst_reg) {
-    Instruction::Arg func = VisitExpr(call_node->op);
+    Instruction::Arg func = VisitCallee(call_node);
     std::vector<Instruction::Arg> args = VisitArray(call_node->args);
 
     if (func.kind() == vm::Instruction::ArgKind::kFuncIdx) {
@@ -426,6 +555,14 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
   size_t registers_num_ = 0;
   /*! \brief Map from var to register number. */
   std::unordered_map<Var, Instruction::Arg> var_arg_map_;
+  /*! \brief Whether proven calls to PrimFuncs use their unchecked entry. */
+  bool use_unchecked_entry_{false};
+  /*! \brief The PrimFuncs that are called through their unchecked entry. */
+  std::unordered_set<GlobalVar, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> unchecked_callees_;
+  /*! \brief Whether proven calls to host kernels use their direct entry. */
+  bool use_direct_call_{false};
+  /*! \brief The PrimFuncs that are called through their direct entry. */
+  std::unordered_set<GlobalVar, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> direct_callees_;
   /*! \brief the context module. */
   IRModule ctx_mod_;
   /*! \brief Cache ops that need to be frequently used later to reduce lookup overhead. */
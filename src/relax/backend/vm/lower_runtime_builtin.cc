@@ -35,12 +35,17 @@
 namespace tvm {
 namespace relax {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.backend.async_host_to_device_copy", bool);
+
 // This pass lowers most ops to VM specific builtins.
 // TODO(relax-team): revisit after PrimExpr.
 class LowerRuntimeBuiltinMutator : public ExprMutator {
  public:
   using ExprMutator::VisitExpr_;
 
+  explicit LowerRuntimeBuiltinMutator(bool async_host_to_device_copy)
+      : async_host_to_device_copy_(async_host_to_device_copy) {}
+
   Expr VisitExpr_(const CallNode* call_node) final {
     static const auto& lower_builtin_fmap = Op::GetAttrMap<FLowerBuiltin>("FLowerBuiltin");
     // post-order mutation
@@ -179,7 +184,12 @@ class LowerRuntimeBuiltinMutator : public ExprMutator {
     args.push_back(IntImm::Int64(dev_type));
     args.push_back(IntImm::Int64(dev_id));
     args.push_back(storage_scope);
-    return Call(Type::Missing(), builtin_to_device_, args, call_node->attrs, {GetType(call_node)});
+    // The asynchronous copies to the accelerators let the uploads of the next step overlap with
+    // the kernels of the current step. The copies from the device memory stay synchronous.
+    const ExternFunc& builtin = async_host_to_device_copy_ && dev_type != kDLCPU
+                                    ? builtin_to_device_async_
+                                    : builtin_to_device_;
+    return Call(Type::Missing(), builtin, args, call_node->attrs, {GetType(call_node)});
   }
 
   Expr MakeClosure(const Call& call_node) {
@@ -246,17 +256,24 @@ class LowerRuntimeBuiltinMutator : public ExprMutator {
   const ExternFunc builtin_tensor_to_shape_{"vm.builtin.tensor_to_shape"};
   const ExternFunc builtin_call_py_func_{"vm.builtin.call_py_func"};
   const ExternFunc builtin_to_device_{"vm.builtin.to_device"};
+  const ExternFunc builtin_to_device_async_{"vm.builtin.to_device_async"};
   const ExternFunc builtin_make_closure_{"vm.builtin.make_closure"};
   const ExternFunc builtin_invoke_closure_{"vm.builtin.invoke_closure"};
+  // Whether to lower the copies to the accelerators to asynchronous copies.
+  const bool async_host_to_device_copy_;
 };
 
-Expr LowerRuntimeBuiltin(const Expr& e) { return LowerRuntimeBuiltinMutator().VisitExpr(e); }
+Expr LowerRuntimeBuiltin(const Expr& e, bool async_host_to_device_copy) {
+  return LowerRuntimeBuiltinMutator(async_host_to_device_copy).VisitExpr(e);
+}
 
 namespace transform {
 
 Pass LowerRuntimeBuiltin() {
   auto pass_func = [=](Function f, IRModule m, PassContext pc) {
-    return LowerRuntimeBuiltin(f).as_or_throw<Function>();
+    bool async_host_to_device_copy =
+        pc->GetConfig<bool>("relax.backend.async_host_to_device_copy").value_or(false);
+    return LowerRuntimeBuiltin(f, async_host_to_device_copy).as_or_throw<Function>();
   };
   return CreateFunctionPass(pass_func, 0, "LowerRuntimeBuiltin", {});
 }
@@ -273,14 +273,32 @@ class PrimExprSlotCollector : public ExprVisitor, public TypeVisitor {
  * shape_func at the function boundary. If there are follow-up match_cast points,
  * that defines new variable, then we might we will generate new shape functions
  * to compute expressions that depend on these variables.
+ *
+ * With `relax.backend.cache_shape_heap`, the functions that cannot re-enter themselves keep
+ * their shape heap across calls, and the shape_func at the function boundary is memoized on the
+ * vars matched from the parameters. The heap then holds, after the n slots, the values of the
+ * vars at the last computation (at the index of their slot plus n) and a flag at index 2n telling
+ * whether they are valid, so that a decode loop with a fixed batch skips the computation.
+ *
+ * \code
+ *
+ * @T.prim_func
+ * def shape_func(H: T.Buffer([7], "int64")):
+ *     if H[6] == 0 or H[5] != H[2] or H[3] != H[0]:
+ *         H[1] = H[2] + 1
+ *         H[5] = H[2]
+ *         H[3] = H[0]
+ *         H[6] = 1
+ *
+ * \endcode
  */
 class VMShapeLowerMutator
     : public ExprMutator,
       public TypeFunctor<void(const Type&, Expr, bool, bool, const ffi::String&,
                               std::vector<MatchShapeTodoItem>*)> {
  public:
-  static IRModule Lower(IRModule mod, bool emit_err_ctx) {
-    VMShapeLowerMutator mutator(mod, emit_err_ctx);
+  static IRModule Lower(IRModule mod, bool emit_err_ctx, bool cache_shape_heap) {
+    VMShapeLowerMutator mutator(mod, emit_err_ctx, cache_shape_heap);
 
     for (auto& kv : mod->functions) {
       if (auto* func = kv.second.as<FunctionNode>()) {
@@ -292,8 +310,28 @@ class VMShapeLowerMutator
   }
 
  private:
-  explicit VMShapeLowerMutator(IRModule mod, bool emit_err_ctx)
-      : ExprMutator(mod), emit_err_ctx_(emit_err_ctx) {}
+  explicit VMShapeLowerMutator(IRModule mod, bool emit_err_ctx, bool cache_shape_heap)
+      : ExprMutator(mod), emit_err_ctx_(emit_err_ctx), cache_shape_heap_(cache_shape_heap) {}
+
+  /*!
+   * \brief Whether the function may run again before it returns, through the relax functions or
+   *  the closures it calls, in which case the calls cannot share a shape heap.
+   */
+  bool MayReenter(const Function& func) {
+    bool may_reenter = false;
+    IRModule mod = builder_->GetContextIRModule();
+    PostOrderVisit(func->body, [&](const Expr& node) {
+      if (const auto* gv = node.as<GlobalVarNode>()) {
+        if (mod->ContainGlobalVar(gv->name_hint) &&
+            mod->Lookup(gv->name_hint)->IsInstance<FunctionNode>()) {
+          may_reenter = true;
+        }
+      } else if (const auto* call = node.as<CallNode>()) {
+        if (call->op->IsInstance<VarNode>()) may_reenter = true;
+      }
+    });
+    return may_reenter;
+  }
 
   using ExprMutator::VisitExpr_;
 
@@ -342,7 +380,11 @@ class VMShapeLowerMutator
     slot_map_.clear();
     current_gvar_ = gvar;
     PrimExprSlotCollector::Collect(func, &slot_vec_, &slot_map_);
-    heap_size_ = IntImm(tvm::PrimType(ShapeDType()), static_cast<int64_t>(slot_vec_.size()));
+    num_slots_ = static_cast<int64_t>(slot_vec_.size());
+    use_cached_heap_ = cache_shape_heap_ && num_slots_ > 0 && !MayReenter(func);
+    // The cached heap also holds the memoization keys and their valid flag.
+    int64_t heap_size = use_cached_heap_ ? 2 * num_slots_ + 1 : num_slots_;
+    heap_size_ = IntImm(tvm::PrimType(ShapeDType()), heap_size);
     VarBinding shape_heap_binding = this->AllocShapeHeapBinding(heap_size_);
     shape_heap_ = shape_heap_binding->var;
 
@@ -377,7 +419,7 @@ class VMShapeLowerMutator
       }
       // insert heap generation logic.
       match_todos = this->RunMatch(match_todos, false);
-      this->EmitOutstandingPrimExprCompute();
+      this->EmitOutstandingPrimExprCompute(/*memoize=*/use_cached_heap_);
       this->RunMatch(match_todos, true);
 
       BindingBlock pre_block = builder_->EndBlock();
@@ -471,8 +513,13 @@ class VMShapeLowerMutator
       TensorType heap_ty(PrimType(ShapeDType()), 1);
       Var var("shape_heap", heap_ty);
       // set up the builtin func.
+      Tuple args = use_cached_heap_
+                       ? Tuple({PrimExpr(heap_size), StringImm(current_gvar_.value()->name_hint)})
+                       : Tuple({PrimExpr(heap_size)});
       Call call(Type::Missing(), call_builtin_with_ctx_op_,
-                {builtin_alloc_shape_heap_, Tuple({PrimExpr(heap_size)})}, Attrs(), {heap_ty});
+                {use_cached_heap_ ? builtin_alloc_cached_shape_heap_ : builtin_alloc_shape_heap_,
+                 args},
+                Attrs(), {heap_ty});
       UpdateType(call, heap_ty);
       return VarBinding(var, call);
     } else {
@@ -700,9 +747,11 @@ class VMShapeLowerMutator
    *
    * We will then clear the ready_vars.
    *
+   * \param memoize Whether to skip the computation when the computed vars of the heap have the
+   *  values they had at the last computation, see the cached shape heap above.
    * \return Number of PrimExpr computed.
    */
-  size_t EmitOutstandingPrimExprCompute() {
+  size_t EmitOutstandingPrimExprCompute(bool memoize = false) {
     std::vector<PrimExprSlot*> to_compute = GetReadyPrimExprSlots();
     if (to_compute.size() == 0) return 0;
     TVM_FFI_ICHECK_GT(heap_size_->value, 0);
@@ -721,16 +770,33 @@ class VMShapeLowerMutator
       }
     }
 
+    auto heap_index = [](int64_t index) { return IntImm(tvm::PrimType(ShapeDType()), index); };
     ffi::Array<tirx::Stmt> seq;
     for (PrimExprSlot* slot : to_compute) {
       TVM_FFI_ICHECK(!slot->value_computed);
       slot->value_computed = true;
       PrimExpr value = tirx::Substitute(slot->expr, var_map);
-      seq.push_back(
-          tirx::BufferStore(buffer, value, {IntImm(tvm::PrimType(ShapeDType()), slot->index)}));
+      seq.push_back(tirx::BufferStore(buffer, value, {heap_index(slot->index)}));
     }
 
-    tirx::Stmt body = tirx::SeqStmt::Flatten(seq);
+    tirx::Stmt body;
+    if (memoize) {
+      // Recompute when the flag is unset or any computed var changed, and save the vars.
+      PrimExpr flag = tirx::BufferLoad(buffer, {heap_index(2 * num_slots_)});
+      PrimExpr changed = flag == IntImm(tvm::PrimType(ShapeDType()), 0);
+      for (const auto& slot : slot_vec_) {
+        if (!slot->expr.as<tirx::VarNode>() || !slot->value_computed) continue;
+        PrimExpr value = tirx::BufferLoad(buffer, {heap_index(slot->index)});
+        PrimExpr saved = tirx::BufferLoad(buffer, {heap_index(num_slots_ + slot->index)});
+        changed = changed || saved != value;
+        seq.push_back(tirx::BufferStore(buffer, value, {heap_index(num_slots_ + slot->index)}));
+      }
+      seq.push_back(tirx::BufferStore(buffer, IntImm(tvm::PrimType(ShapeDType()), 1),
+                                      {heap_index(2 * num_slots_)}));
+      body = tirx::IfThenElse(changed, tirx::SeqStmt::Flatten(seq));
+    } else {
+      body = tirx::SeqStmt::Flatten(seq);
+    }
     ffi::Array<tirx::Var> params{heap};
     Type ret_type = VoidType();
 
@@ -903,6 +969,12 @@ class VMShapeLowerMutator
   //-------------------------------------------------------
   /*! \brief whether to emit error context, can be turned off for testing purposes. */
   bool emit_err_ctx_{true};
+  /*! \brief whether to keep the shape heap of the functions across calls when it is safe. */
+  bool cache_shape_heap_{false};
+  /*! \brief whether the current function keeps its shape heap across calls. */
+  bool use_cached_heap_{false};
+  /*! \brief The number of PrimExpr slots of the current function. */
+  int64_t num_slots_{0};
   /*! \brief heap ptr to store the PrimExpr slots. */
   Var shape_heap_;
   /*! \brief heap size. */
@@ -925,6 +997,7 @@ class VMShapeLowerMutator
   const Type void_ty_ = TupleType(ffi::Array<Type>({}));
   // check function
   const ExternFunc builtin_alloc_shape_heap_{"vm.builtin.alloc_shape_heap"};
+  const ExternFunc builtin_alloc_cached_shape_heap_{"vm.builtin.alloc_cached_shape_heap"};
   const ExternFunc builtin_match_shape_{"vm.builtin.match_shape"};
   const ExternFunc builtin_make_shape_{"vm.builtin.make_shape"};
   const ExternFunc builtin_check_shape_info_{"vm.builtin.check_shape_info"};
@@ -939,9 +1012,12 @@ class VMShapeLowerMutator
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.backend.cache_shape_heap", bool);
+
 Pass VMShapeLower(bool emit_err_ctx) {
   auto pass_func = [=](IRModule mod, PassContext pc) {
-    return VMShapeLowerMutator::Lower(mod, emit_err_ctx);
+    bool cache_shape_heap = pc->GetConfig<bool>("relax.backend.cache_shape_heap", false).value();
+    return VMShapeLowerMutator::Lower(mod, emit_err_ctx, cache_shape_heap);
   };
   return CreateModulePass(pass_func, 0, "VMShapeLower", {});
 }
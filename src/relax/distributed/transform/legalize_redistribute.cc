@@ -23,16 +23,23 @@
  */
 
 #include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/analysis.h>
 #include <tvm/relax/attrs/ccl.h>
 #include <tvm/relax/attrs/distributed.h>
+#include <tvm/relax/attrs/linear_algebra.h>
 #include <tvm/relax/distributed/axis_group_graph.h>
 #include <tvm/relax/distributed/transform.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "../../../s_tir/schedule/transform.h"
 #include "../../op/ccl/ccl.h"
 #include "../../op/distributed/distributed.h"
+#include "../../op/tensor/linear_algebra.h"
+#include "../../op/tensor/manipulate.h"
 
 namespace tvm {
 namespace relax {
@@ -40,12 +47,13 @@ namespace distributed {
 
 class RedistributeLegalizer : public ExprMutator {
  public:
-  static IRModule LegalizeRedistribute(IRModule mod) {
-    return RedistributeLegalizer(mod).Legalize();
+  static IRModule LegalizeRedistribute(IRModule mod, int num_chunks) {
+    return RedistributeLegalizer(mod, num_chunks).Legalize();
   }
 
  private:
-  explicit RedistributeLegalizer(IRModule mod) : ExprMutator(mod) {}
+  explicit RedistributeLegalizer(IRModule mod, int num_chunks)
+      : ExprMutator(mod), num_chunks_(num_chunks) {}
 
   IRModule Legalize() {
     auto mod = builder_->GetContextIRModule();
@@ -54,6 +62,7 @@ class RedistributeLegalizer : public ExprMutator {
       if (func_ == nullptr) {
         continue;
       }
+      CollectFusionCandidates(ffi::GetRef<Function>(func_));
       Expr new_func_body = VisitExpr(func_->body);
       auto new_func = ffi::make_object<FunctionNode>(*func_);
       new_func->body = new_func_body;
@@ -61,6 +70,232 @@ class RedistributeLegalizer : public ExprMutator {
     }
     return builder_->GetContextIRModule();
   }
+
+  /*!
+   * \brief Find the collectives that can be fused with the compute next to them:
+   *  - `matmul(redistribute(x, "R"), w)` with x sharded on its rows, which is lowered to a
+   *    chunked allgather-matmul pipeline;
+   *  - `redistribute(allreduce(x), "S[0]")`, which is lowered to a single reduce-scatter.
+   * The producer binding of each pattern is folded into the lowering of its only user.
+   */
+  void CollectFusionCandidates(const Function& func) {
+    static Op redistribute_op = Op::Get("relax.dist.redistribute");
+    static Op allreduce_op = Op::Get("relax.ccl.allreduce");
+    static Op matmul_op = Op::Get("relax.matmul");
+    folded_bindings_.clear();
+    fused_producers_.clear();
+    VarUsageInfo usage = CollectVarUsage(func);
+    std::unordered_set<Var> outputs(usage.outputs.begin(), usage.outputs.end());
+    for (const auto& [var, value] : usage.bound_values) {
+      const auto* producer = value.as<CallNode>();
+      if (producer == nullptr || outputs.count(var)) {
+        continue;
+      }
+      ffi::Optional<ffi::Array<Var>> users = usage.downstream_usage.Get(var);
+      if (!users.has_value() || users.value().size() != 1) {
+        continue;
+      }
+      Var user = users.value()[0];
+      ffi::Optional<Expr> user_value = usage.bound_values.Get(user);
+      const auto* consumer = user_value.has_value() ? user_value.value().as<CallNode>() : nullptr;
+      if (consumer == nullptr) {
+        continue;
+      }
+      bool fusible = false;
+      if (producer->op.same_as(redistribute_op) && consumer->op.same_as(matmul_op) &&
+          consumer->args[0].same_as(var)) {
+        fusible = IsAllGatherMatmul(producer, consumer, user);
+      } else if (producer->op.same_as(allreduce_op) && consumer->op.same_as(redistribute_op)) {
+        fusible = IsAllReduceScatter(producer, consumer);
+      }
+      if (fusible) {
+        folded_bindings_.insert(var);
+        fused_producers_[user] = ffi::GetRef<Call>(producer);
+      }
+    }
+  }
+
+  /*! \brief Whether the redistribute is a row allgather whose result is the lhs of a matmul. */
+  bool IsAllGatherMatmul(const CallNode* redistribute_call, const CallNode* matmul_call,
+                         const Var& matmul_var) {
+    if (num_chunks_ <= 1 || matmul_call->args[1].same_as(matmul_call->args[0])) {
+      return false;
+    }
+    const auto* input_ty = redistribute_call->args[0]->ty.as<DTensorTypeNode>();
+    const auto* lhs_ty = matmul_call->args[0]->ty.as<DTensorTypeNode>();
+    const auto* rhs_ty = matmul_call->args[1]->ty.as<DTensorTypeNode>();
+    const auto* out_ty = matmul_var->ty.as<DTensorTypeNode>();
+    if (input_ty == nullptr || lhs_ty == nullptr || rhs_ty == nullptr || out_ty == nullptr ||
+        input_ty->device_mesh->shape.size() != 1 || input_ty->tensor_ty->ndim != 2 ||
+        rhs_ty->tensor_ty->ndim != 2 || !input_ty->tensor_ty->GetShape().has_value() ||
+        !out_ty->tensor_ty->GetShape().has_value()) {
+      return false;
+    }
+    PlacementSpec input_spec = input_ty->placement->dim_specs[0];
+    PlacementSpec lhs_spec = lhs_ty->placement->dim_specs[0];
+    PlacementSpec out_spec = out_ty->placement->dim_specs[0];
+    if (input_spec->kind != PlacementSpecKind::kSharding || input_spec->axis != 0 ||
+        lhs_spec->kind != PlacementSpecKind::kReplica ||
+        (out_spec->kind == PlacementSpecKind::kSharding && out_spec->axis == 0)) {
+      return false;
+    }
+    // Each worker gathers `num_chunks_` equal slices of its rows.
+    const auto* num_rows = input_ty->tensor_ty->GetShape().value()[0].as<IntImmNode>();
+    int64_t num_workers = input_ty->device_mesh->shape[0];
+    return num_rows != nullptr && num_rows->value % (num_workers * num_chunks_) == 0;
+  }
+
+  /*! \brief Whether the redistribute keeps only the local rows of an allreduce result. */
+  bool IsAllReduceScatter(const CallNode* allreduce_call, const CallNode* redistribute_call) {
+    const auto* allreduce_attrs = allreduce_call->attrs.as<AllReduceAttrs>();
+    const auto* attrs = redistribute_call->attrs.as<DistributionAttrs>();
+    const auto* input_ty = allreduce_call->args[0]->ty.as<DTensorTypeNode>();
+    if (allreduce_attrs == nullptr || attrs == nullptr || input_ty == nullptr ||
+        input_ty->device_mesh->shape.size() != 1 ||
+        !ffi::StructuralEqual()(input_ty->device_mesh, attrs->device_mesh)) {
+      return false;
+    }
+    PlacementSpec output_spec = attrs->placement->dim_specs[0];
+    return output_spec->kind == PlacementSpecKind::kSharding && output_spec->axis == 0;
+  }
+
+  /*! \brief Emit the call with the given DistIR type instead of inferring it. */
+  Var EmitWithType(Expr expr, Type ty) {
+    UpdateType(expr, ty);
+    return builder_->Emit(expr);
+  }
+
+  DTensorType WithShape(const DTensorType& ty, ffi::Array<PrimExpr> shape, Placement placement) {
+    TensorType tensor_ty(ShapeExpr(shape), ty->tensor_ty->dtype, ty->tensor_ty->vdevice);
+    return DTensorType(tensor_ty, ty->device_mesh, placement);
+  }
+
+  /*!
+   * \brief Lower `matmul(redistribute(x, "R"), w)` to a pipeline of chunked allgathers and
+   * matmuls. The rows of x are viewed as (num_workers, num_chunks, chunk_rows). Chunk c gathers
+   * slice c of every worker and multiplies it, and the products are concatenated back along the
+   * chunk axis. The chunks are independent until the final concat, so the allgather of one
+   * chunk can overlap with the matmul of another when branches are launched on separate streams.
+   */
+  Expr LowerAllGatherMatmul(const CallNode* matmul_call, const Call& redistribute_call,
+                            const Var& out_var) {
+    DTensorType input_ty = GetType(redistribute_call->args[0]).as_or_throw<DTensorType>();
+    DTensorType out_ty = GetType(out_var).as_or_throw<DTensorType>();
+    Expr x = VisitExpr(redistribute_call->args[0]);
+    Expr w = VisitExpr(matmul_call->args[1]);
+    const auto* matmul_attrs = matmul_call->attrs.as<MatmulAttrs>();
+    TVM_FFI_ICHECK(matmul_attrs);
+
+    int64_t num_workers = input_ty->device_mesh->shape[0];
+    ffi::Array<PrimExpr> input_shape = input_ty->tensor_ty->GetShape().value();
+    ffi::Array<PrimExpr> out_shape = out_ty->tensor_ty->GetShape().value();
+    int64_t num_rows = input_shape[0].as<IntImmNode>()->value;
+    PrimExpr chunk_rows = IntImm(DataType::Int(64), num_rows / (num_workers * num_chunks_));
+    PrimExpr workers = IntImm(DataType::Int(64), num_workers);
+    PrimExpr chunks = IntImm(DataType::Int(64), num_chunks_);
+    PrimExpr k = input_shape[1];
+    PrimExpr n = out_shape[out_shape.size() - 1];
+
+    Placement row_sharded = input_ty->placement;
+    Placement replicated = Placement::FromText("R");
+    // The output is either replicated or sharded on its columns, which stay the last axis.
+    Placement out_placement = out_ty->placement;
+    Placement out_placement_4d = out_placement->dim_specs[0]->kind == PlacementSpecKind::kReplica
+                                     ? replicated
+                                     : Placement::FromText("S[3]");
+
+    Var x_4d = EmitWithType(reshape(x, ffi::Array<PrimExpr>{workers, chunks, chunk_rows, k}),
+                            WithShape(input_ty, {workers, chunks, chunk_rows, k}, row_sharded));
+    ffi::Array<Type> slice_tys;
+    for (int i = 0; i < num_chunks_; ++i) {
+      slice_tys.push_back(WithShape(input_ty, {workers, 1, chunk_rows, k}, row_sharded));
+    }
+    Var slices = EmitWithType(split(x_4d, IntImm(DataType::Int(64), num_chunks_), 1),
+                              TupleType(slice_tys));
+    ffi::Array<Expr> products;
+    for (int i = 0; i < num_chunks_; ++i) {
+      Var slice = builder_->Emit(TupleGetItem(slices, i));
+      Var rows = EmitWithType(reshape(slice, ffi::Array<PrimExpr>{workers * chunk_rows, k}),
+                              WithShape(input_ty, {workers * chunk_rows, k}, row_sharded));
+      Var gathered = EmitWithType(allgather(rows, num_workers, /*in_group=*/true),
+                                  WithShape(input_ty, {workers * chunk_rows, k}, replicated));
+      Var product = EmitWithType(matmul(gathered, w, matmul_attrs->out_dtype),
+                                 WithShape(out_ty, {workers * chunk_rows, n}, out_placement));
+      products.push_back(
+          EmitWithType(reshape(product, ffi::Array<PrimExpr>{workers, 1, chunk_rows, n}),
+                       WithShape(out_ty, {workers, 1, chunk_rows, n}, out_placement_4d)));
+    }
+    Var out_4d =
+        EmitWithType(concat(Tuple(products), 1),
+                     WithShape(out_ty, {workers, chunks, chunk_rows, n}, out_placement_4d));
+    Expr out = reshape(out_4d, out_shape);
+    UpdateType(out, out_ty);
+    return out;
+  }
+
+  /*! \brief Lower `redistribute(allreduce(x), "S[0]")` to a reduce-scatter of x. */
+  Expr LowerAllReduceScatter(const Call& allreduce_call, const Var& out_var) {
+    const auto* attrs = allreduce_call->attrs.as<AllReduceAttrs>();
+    DTensorType out_ty = GetType(out_var).as_or_throw<DTensorType>();
+    Expr out = reducescatter(VisitExpr(allreduce_call->args[0]), attrs->op_type,
+                             out_ty->device_mesh->shape[0], attrs->in_group);
+    UpdateType(out, out_ty);
+    return out;
+  }
+
+  /*!
+   * \brief Lower "S[x]" -> "R" to an allgather. The collective gathers along the leading axis,
+   * so other sharding axes are moved to the front before and back after it.
+   */
+  Expr LowerAllGather(const Call& call) {
+    const auto* attrs = call->attrs.as<DistributionAttrs>();
+    DTensorType input_ty = GetType(call->args[0]).as_or_throw<DTensorType>();
+    int axis = input_ty->placement->dim_specs[0]->axis;
+    int num_workers = attrs->device_mesh->shape[0];
+    DTensorType out_ty(input_ty->tensor_ty, attrs->device_mesh, attrs->placement);
+    if (axis == 0) {
+      Expr out = allgather(call->args[0], num_workers, /*in_group=*/true);
+      UpdateType(out, out_ty);
+      return out;
+    }
+    ffi::Array<PrimExpr> shape = input_ty->tensor_ty->GetShape().value();
+    ffi::Array<int64_t> perm{axis};
+    ffi::Array<int64_t> inverse_perm;
+    ffi::Array<PrimExpr> permuted_shape{shape[axis]};
+    for (int i = 0; i < static_cast<int>(shape.size()); ++i) {
+      if (i != axis) {
+        perm.push_back(i);
+        permuted_shape.push_back(shape[i]);
+      }
+      inverse_perm.push_back(i < axis ? i + 1 : (i == axis ? 0 : i));
+    }
+    Var permuted = EmitWithType(permute_dims(call->args[0], perm),
+                                WithShape(input_ty, permuted_shape, Placement::FromText("S[0]")));
+    Var gathered = EmitWithType(allgather(permuted, num_workers, /*in_group=*/true),
+                                WithShape(input_ty, permuted_shape, attrs->placement));
+    Expr out = permute_dims(gathered, inverse_perm);
+    UpdateType(out, out_ty);
+    return out;
+  }
+
+  using ExprMutator::VisitBinding_;
+  void VisitBinding_(const VarBindingNode* binding, const CallNode* val) final {
+    if (folded_bindings_.count(binding->var)) {
+      // Lowered together with its only user.
+      return;
+    }
+    auto it = fused_producers_.find(binding->var);
+    if (it == fused_producers_.end()) {
+      ExprMutator::VisitBinding_(binding, val);
+      return;
+    }
+    static Op allreduce_op = Op::Get("relax.ccl.allreduce");
+    Expr new_value = it->second->op.same_as(allreduce_op)
+                         ? LowerAllReduceScatter(it->second, binding->var)
+                         : LowerAllGatherMatmul(val, it->second, binding->var);
+    ReEmitBinding(binding, builder_->Normalize(new_value));
+  }
+
   using ExprMutator::VisitExpr_;
   Expr VisitExpr_(const CallNode* op) final {
     Call call = ExprMutator::VisitExpr_(op).as_or_throw<Call>();
@@ -94,7 +329,7 @@ class RedistributeLegalizer : public ExprMutator {
       } else if (input_spec->kind == PlacementSpecKind::kSharding &&
                  output_spec->kind == PlacementSpecKind::kReplica) {
         // "S[x]" -> "R"
-        TVM_FFI_THROW(InternalError) << "Allgather not implemented yet";
+        return LowerAllGather(call);
       } else if (input_spec->kind == PlacementSpecKind::kReplica &&
                  output_spec->kind == PlacementSpecKind::kSharding) {
         // "R" -> "S[x]"
@@ -106,13 +341,20 @@ class RedistributeLegalizer : public ExprMutator {
     }
     return call;
   }
+
+  /*! \brief The number of chunks an allgather feeding a matmul is pipelined in. */
+  int num_chunks_;
+  /*! \brief The producer bindings that are lowered together with their only user. */
+  std::unordered_set<Var> folded_bindings_;
+  /*! \brief The users of the folded bindings, mapped to the folded producer call. */
+  std::unordered_map<Var, Call> fused_producers_;
 };
 
 namespace transform {
 
-Pass LegalizeRedistribute() {
+Pass LegalizeRedistribute(int num_chunks) {
   auto pass_func = [=](IRModule m, PassContext pc) {
-    return RedistributeLegalizer::LegalizeRedistribute(m);
+    return RedistributeLegalizer::LegalizeRedistribute(m, num_chunks);
   };
   return CreateModulePass(pass_func, 1, "LegalizeRedistribute", {});
 }
@@ -0,0 +1,380 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/relax/distributed/transform/plan_sharding.cc
+ * \brief Pass for searching the sharding annotations with a cost model.
+ */
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/attrs/distributed.h>
+#include <tvm/relax/distributed/transform.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/utils.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../../op/distributed/distributed.h"
+#include "utils.h"
+
+namespace tvm {
+namespace relax {
+namespace distributed {
+
+/*! \brief The cost of a sharding plan. Plans are ordered by the memory overflow first. */
+struct ShardingPlanCost {
+  /*! \brief The bytes of parameters per device beyond the memory budget. */
+  double overflow_bytes = 0;
+  /*! \brief The estimated time of a step in seconds. */
+  double step_time = 0;
+
+  bool operator<(const ShardingPlanCost& other) const {
+    if (overflow_bytes != other.overflow_bytes) {
+      return overflow_bytes < other.overflow_bytes;
+    }
+    return step_time < other.step_time;
+  }
+};
+
+/*!
+ * \brief Estimate the cost of a DistIR function on the devices.
+ * The computation of matmul is its FLOPs and that of the other operators is the number of
+ * output elements. The communication is the bytes moved by redistribute, the all-reduce of
+ * the matmul whose reduction axis is sharded, and the gather of the sharded outputs.
+ * Symbolic dimensions are counted as one.
+ */
+class ShardingCostEstimator : public ExprVisitor {
+ public:
+  static ShardingPlanCost Estimate(const Function& func, double device_flops,
+                                   double link_bandwidth, double collective_latency,
+                                   int64_t memory_budget) {
+    ShardingCostEstimator estimator(device_flops, link_bandwidth, collective_latency);
+    double param_bytes = 0;
+    for (const Var& param : func->params) {
+      if (const auto* dtensor_ty = param->ty.as<DTensorTypeNode>()) {
+        param_bytes += LocalBytes(dtensor_ty);
+      }
+    }
+    estimator.VisitExpr(func->body);
+    estimator.AddGatherOutput(func->body->body->ty);
+    ShardingPlanCost cost;
+    if (memory_budget > 0) {
+      cost.overflow_bytes = std::max(0.0, param_bytes - static_cast<double>(memory_budget));
+    }
+    cost.step_time = estimator.step_time_;
+    return cost;
+  }
+
+ private:
+  explicit ShardingCostEstimator(double device_flops, double link_bandwidth,
+                                 double collective_latency)
+      : device_flops_(device_flops),
+        link_bandwidth_(link_bandwidth),
+        collective_latency_(collective_latency) {}
+
+  /*! \brief The number of shards of the given tensor axis. */
+  static int64_t NumShards(const DTensorTypeNode* dtensor_ty, int axis) {
+    int64_t num_shards = 1;
+    const ffi::Array<PlacementSpec>& dim_specs = dtensor_ty->placement->dim_specs;
+    for (int i = 0; i < static_cast<int>(dim_specs.size()); ++i) {
+      if (dim_specs[i]->kind == PlacementSpecKind::kSharding && dim_specs[i]->axis == axis) {
+        num_shards *= dtensor_ty->device_mesh->shape[i];
+      }
+    }
+    return num_shards;
+  }
+
+  /*! \brief The static length of the given tensor axis on one device. */
+  static double LocalLength(const DTensorTypeNode* dtensor_ty, int axis) {
+    const auto* shape = dtensor_ty->tensor_ty->shape.as<ShapeExprNode>();
+    if (shape == nullptr) {
+      return 1;
+    }
+    const auto* length = shape->values[axis].as<IntImmNode>();
+    return length != nullptr ? static_cast<double>(length->value) / NumShards(dtensor_ty, axis)
+                             : 1;
+  }
+
+  static double LocalNumel(const DTensorTypeNode* dtensor_ty) {
+    double numel = 1;
+    for (int i = 0; i < dtensor_ty->tensor_ty->ndim; ++i) {
+      numel *= LocalLength(dtensor_ty, i);
+    }
+    return numel;
+  }
+
+  static double LocalBytes(const DTensorTypeNode* dtensor_ty) {
+    if (dtensor_ty->tensor_ty->IsUnknownDtype()) {
+      return LocalNumel(dtensor_ty);
+    }
+    PrimType dtype = dtensor_ty->tensor_ty->dtype.value();
+    return LocalNumel(dtensor_ty) * ((dtype.bits() * dtype.lanes() + 7) / 8);
+  }
+
+  /*! \brief The time of a collective moving the given bytes per device. */
+  double CollectiveTime(double bytes) const {
+    return collective_latency_ + bytes / link_bandwidth_;
+  }
+
+  void VisitBinding_(const VarBindingNode* binding, const CallNode* call) final {
+    static const Op& redistribute_op = Op::Get("relax.dist.redistribute");
+    static const Op& matmul_op = Op::Get("relax.matmul");
+    const auto* out_ty = binding->var->ty.as<DTensorTypeNode>();
+    if (out_ty == nullptr) {
+      ExprVisitor::VisitBinding_(binding, call);
+      return;
+    }
+    if (call->op.same_as(redistribute_op)) {
+      if (const auto* src_ty = call->args[0]->ty.as<DTensorTypeNode>()) {
+        AddRedistribute(src_ty, out_ty);
+      }
+    } else if (call->op.same_as(matmul_op)) {
+      const auto* lhs_ty = call->args[0]->ty.as<DTensorTypeNode>();
+      double reduction_length = 1;
+      if (lhs_ty != nullptr && lhs_ty->tensor_ty->ndim > 0) {
+        int reduction_axis = lhs_ty->tensor_ty->ndim - 1;
+        reduction_length = LocalLength(lhs_ty, reduction_axis);
+        int64_t num_shards = NumShards(lhs_ty, reduction_axis);
+        if (num_shards > 1) {
+          // The partial sums are all-reduced with a ring.
+          step_time_ += CollectiveTime(2.0 * (num_shards - 1) / num_shards * LocalBytes(out_ty));
+        }
+      }
+      step_time_ += 2 * LocalNumel(out_ty) * reduction_length / device_flops_;
+    } else {
+      step_time_ += LocalNumel(out_ty) / device_flops_;
+    }
+    ExprVisitor::VisitBinding_(binding, call);
+  }
+
+  void AddRedistribute(const DTensorTypeNode* src_ty, const DTensorTypeNode* dst_ty) {
+    const ffi::Array<PlacementSpec>& src_specs = src_ty->placement->dim_specs;
+    const ffi::Array<PlacementSpec>& dst_specs = dst_ty->placement->dim_specs;
+    if (src_specs.size() != dst_specs.size()) {
+      // Moving to another device mesh sends the whole local data.
+      step_time_ += CollectiveTime(LocalBytes(dst_ty));
+      return;
+    }
+    for (int i = 0; i < static_cast<int>(src_specs.size()); ++i) {
+      if (src_specs[i]->kind != PlacementSpecKind::kSharding) {
+        // Replica to sharding takes the local slice without communication.
+        continue;
+      }
+      double num_shards = static_cast<double>(src_ty->device_mesh->shape[i]);
+      if (dst_specs[i]->kind == PlacementSpecKind::kReplica) {
+        step_time_ += CollectiveTime((num_shards - 1) / num_shards * LocalBytes(dst_ty));
+      } else if (dst_specs[i]->axis != src_specs[i]->axis) {
+        step_time_ += CollectiveTime((num_shards - 1) / num_shards * LocalBytes(src_ty));
+      }
+    }
+  }
+
+  /*! \brief The sharded outputs are gathered to be replicated. */
+  void AddGatherOutput(const Type& ty) {
+    if (const auto* tuple_ty = ty.as<TupleTypeNode>()) {
+      for (const Type& field : tuple_ty->fields) {
+        AddGatherOutput(field);
+      }
+    } else if (const auto* dtensor_ty = ty.as<DTensorTypeNode>()) {
+      double num_shards = 1;
+      for (int i = 0; i < dtensor_ty->tensor_ty->ndim; ++i) {
+        num_shards *= NumShards(dtensor_ty, i);
+      }
+      if (num_shards > 1) {
+        step_time_ += CollectiveTime((num_shards - 1) * LocalBytes(dtensor_ty));
+      }
+    }
+  }
+
+  double device_flops_;
+  double link_bandwidth_;
+  double collective_latency_;
+  double step_time_ = 0;
+};
+
+/*!
+ * \brief Search the sharding annotations of the function parameters on the device mesh.
+ * Starting from all the parameters replicated, each round tries sharding one more axis of a
+ * parameter on one mesh dimension, propagates the sharding with PropagateSharding, and keeps
+ * the cheapest plan, until no plan in the round lowers the cost.
+ */
+class ShardingPlanner {
+ public:
+  explicit ShardingPlanner(IRModule mod, DeviceMesh device_mesh, double device_flops,
+                           double link_bandwidth, double collective_latency,
+                           int64_t memory_budget)
+      : mod_(std::move(mod)),
+        device_mesh_(std::move(device_mesh)),
+        device_flops_(device_flops),
+        link_bandwidth_(link_bandwidth),
+        collective_latency_(collective_latency),
+        memory_budget_(memory_budget) {}
+
+  IRModule Plan() {
+    IRModule new_mod = mod_->ShallowCopy();
+    for (const auto& [gv, base_func] : mod_->functions) {
+      const auto* func = base_func.as<FunctionNode>();
+      if (func == nullptr || !func->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol).has_value() ||
+          IsShardingAnnotatedFunc(ffi::GetRef<Function>(func))) {
+        continue;
+      }
+      ffi::Optional<Function> planned = PlanFunction(gv, ffi::GetRef<Function>(func));
+      if (planned.has_value()) {
+        new_mod->Update(gv, planned.value());
+      }
+    }
+    return new_mod;
+  }
+
+ private:
+  using ParamPlacements = std::vector<std::vector<PlacementSpec>>;
+
+  ffi::Optional<Function> PlanFunction(const GlobalVar& gv, const Function& func) {
+    std::vector<int> tensor_params;
+    for (int i = 0; i < static_cast<int>(func->params.size()); ++i) {
+      if (GetTypeAs<TensorTypeNode>(func->params[i])) {
+        tensor_params.push_back(i);
+      }
+    }
+    if (tensor_params.empty()) {
+      return std::nullopt;
+    }
+    int mesh_ndim = device_mesh_->shape.size();
+    ParamPlacements best_plan(tensor_params.size(),
+                              std::vector<PlacementSpec>(mesh_ndim, PlacementSpec::Replica()));
+    ffi::Optional<ShardingPlanCost> best_cost = Evaluate(gv, func, tensor_params, best_plan);
+    TVM_FFI_ICHECK(best_cost.has_value())
+        << "Function " << gv->name_hint << " cannot be replicated on the device mesh.";
+    bool improved = true;
+    while (improved) {
+      improved = false;
+      ParamPlacements round_best_plan = best_plan;
+      for (int p = 0; p < static_cast<int>(tensor_params.size()); ++p) {
+        const auto* tensor_ty = GetTypeAs<TensorTypeNode>(func->params[tensor_params[p]]);
+        const auto* shape = tensor_ty->shape.as<ShapeExprNode>();
+        if (shape == nullptr) {
+          continue;
+        }
+        for (int mesh_dim = 0; mesh_dim < mesh_ndim; ++mesh_dim) {
+          if (best_plan[p][mesh_dim]->kind == PlacementSpecKind::kSharding) {
+            continue;
+          }
+          for (int axis = 0; axis < tensor_ty->ndim; ++axis) {
+            if (!IsShardable(best_plan[p], shape->values[axis], axis, mesh_dim)) {
+              continue;
+            }
+            ParamPlacements plan = best_plan;
+            plan[p][mesh_dim] = PlacementSpec::Sharding(axis);
+            ffi::Optional<ShardingPlanCost> cost = Evaluate(gv, func, tensor_params, plan);
+            if (cost.has_value() && cost.value() < best_cost.value()) {
+              best_cost = cost;
+              round_best_plan = plan;
+              improved = true;
+            }
+          }
+        }
+      }
+      best_plan = round_best_plan;
+    }
+    return AnnotateParams(func, tensor_params, best_plan);
+  }
+
+  /*! \brief Whether the axis can be sharded on the mesh dimension in addition to the specs. */
+  bool IsShardable(const std::vector<PlacementSpec>& specs, const PrimExpr& length, int axis,
+                   int mesh_dim) const {
+    const auto* static_length = length.as<IntImmNode>();
+    if (static_length == nullptr) {
+      return false;
+    }
+    int64_t num_shards = device_mesh_->shape[mesh_dim];
+    for (int i = 0; i < static_cast<int>(specs.size()); ++i) {
+      if (specs[i]->kind == PlacementSpecKind::kSharding && specs[i]->axis == axis) {
+        num_shards *= device_mesh_->shape[i];
+      }
+    }
+    return num_shards > 1 && static_length->value % num_shards == 0;
+  }
+
+  /*! \brief Propagate the plan and estimate its cost, or nullopt if the plan is illegal. */
+  ffi::Optional<ShardingPlanCost> Evaluate(const GlobalVar& gv, const Function& func,
+                                           const std::vector<int>& tensor_params,
+                                           const ParamPlacements& plan) {
+    IRModule mod = mod_->ShallowCopy();
+    mod->Update(gv, AnnotateParams(func, tensor_params, plan));
+    try {
+      IRModule sharded_mod = transform::PropagateSharding()(mod);
+      Function sharded_func = sharded_mod->Lookup(gv).as_or_throw<Function>();
+      return ShardingCostEstimator::Estimate(sharded_func, device_flops_, link_bandwidth_,
+                                             collective_latency_, memory_budget_);
+    } catch (const ffi::Error& e) {
+      return std::nullopt;
+    }
+  }
+
+  /*! \brief Annotate the sharding of the tensor parameters at the beginning of the function. */
+  Function AnnotateParams(const Function& func, const std::vector<int>& tensor_params,
+                          const ParamPlacements& plan) {
+    BlockBuilder builder = BlockBuilder::Create(std::nullopt);
+    builder->BeginBindingBlock();
+    ffi::Map<Var, Expr> param_remap;
+    for (int p = 0; p < static_cast<int>(tensor_params.size()); ++p) {
+      const Var& param = func->params[tensor_params[p]];
+      Var annotated = builder->Emit(
+          annotate_sharding(param, device_mesh_, Placement(ffi::Array<PlacementSpec>(plan[p]))),
+          param->name);
+      param_remap.Set(param, annotated);
+    }
+    BindingBlock annotation_block = builder->EndBlock();
+    SeqExpr body = Bind(func->body, param_remap).as_or_throw<SeqExpr>();
+    ffi::Array<BindingBlock> blocks{annotation_block};
+    blocks.insert(blocks.end(), body->blocks.begin(), body->blocks.end());
+    ffi::ObjectPtr<FunctionNode> n = ffi::make_object<FunctionNode>(*func.get());
+    n->body = SeqExpr(blocks, body->body);
+    return Function(n);
+  }
+
+  IRModule mod_;
+  DeviceMesh device_mesh_;
+  double device_flops_;
+  double link_bandwidth_;
+  double collective_latency_;
+  int64_t memory_budget_;
+};
+
+namespace transform {
+
+Pass PlanSharding(DeviceMesh device_mesh, double device_flops, double link_bandwidth,
+                  double collective_latency, int64_t memory_budget) {
+  auto pass_func = [=](IRModule m, PassContext pc) {
+    return ShardingPlanner(m, device_mesh, device_flops, link_bandwidth, collective_latency,
+                           memory_budget)
+        .Plan();
+  };
+  return CreateModulePass(pass_func, 1, "PlanSharding", {});
+}
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.distributed.transform.PlanSharding", PlanSharding);
+}
+}  // namespace transform
+
+}  // namespace distributed
+}  // namespace relax
+}  // namespace tvm
@@ -68,7 +68,8 @@ void CollectAxisGraphUnary(const VarBindingNode* binding, const CallNode* call,
       "square", "sqrt",     "tan",
       "tanh",   "clip",     "isfinite",
       "isinf",  "isnan",    "dist.annotate_sharding",
-      "erf",    "nn.gelu",  "builtin.stop_lift_params"};
+      "erf",    "nn.gelu",  "builtin.stop_lift_params",
+      "ccl.alltoall"};
   for (const auto& op_name : unary_op_names) {
     const Op& unary_op = Op::Get("relax." + op_name);
     if (call->op.same_as(unary_op)) {
@@ -90,6 +91,23 @@ void CollectAxisGraphReduce(const VarBindingNode* binding, const CallNode* call,
   }
 }
 
+void CollectAxisGraphReduceScatter(const VarBindingNode* binding, const CallNode* call,
+                                   AxisGroupGraph* axis_group_graph) {
+  static const Op& reducescatter_op = Op::Get("relax.ccl.reducescatter");
+  if (!call->op.same_as(reducescatter_op) || !call->args[0]->IsInstance<VarNode>()) {
+    return;
+  }
+  const auto* tensor_ty = GetTypeAs<TensorTypeNode>(binding->var);
+  if (!tensor_ty) {
+    return;
+  }
+  // Axis 0 is chunked over the workers, and the other axes are kept.
+  for (int i = 1; i < tensor_ty->ndim; i++) {
+    axis_group_graph->JoinAxis({call->args[0].get(), i}, {binding->var.get(), i},
+                               distributed::AxisGroupGraph::EdgeType::kDescend);
+  }
+}
+
 void CollectAxisGraphMatmul(const VarBindingNode* binding, const CallNode* call,
                             AxisGroupGraph* axis_group_graph) {
   static const Op& matmul_op = Op::Get("relax.matmul");
@@ -154,6 +172,7 @@ class AxisGroupGraphBuilder : public ExprVisitor {
     CollectAxisGraphBinary(binding, val, axis_group_graph_);
     CollectAxisGraphUnary(binding, val, axis_group_graph_);
     CollectAxisGraphReduce(binding, val, axis_group_graph_);
+    CollectAxisGraphReduceScatter(binding, val, axis_group_graph_);
     CollectAxisGraphMatmul(binding, val, axis_group_graph_);
     CollectAxisGraphPermuteDims(binding, val, axis_group_graph_);
     CollectAxisGraphReshape(binding, val, axis_group_graph_);
@@ -130,6 +130,8 @@ IRModule FunctionPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
       // currently-processed function (the access path is function-rooted).
       Function updated_func;
       try {
+        instrument::FunctionPassProfileScope profile_scope(pass_ctx->instruments,
+                                                           it.first->name_hint);
         updated_func = pass_func(func, updated_mod, pass_ctx);
       } catch (ffi::Error& err) {
         throw tvm::transform::EnrichPassErrorWithContext(err, updated_mod, pass_info->name,
@@ -33,6 +33,7 @@ namespace relax {
 TVM_FFI_STATIC_INIT_BLOCK() {
   AllReduceAttrs::RegisterReflection();
   AllGatherAttrs::RegisterReflection();
+  ReduceScatterAttrs::RegisterReflection();
   ScatterCollectiveAttrs::RegisterReflection();
 }
 
@@ -102,6 +103,90 @@ TVM_REGISTER_OP("relax.ccl.allgather")
     .set_attr<FRelaxInferLayout>("FRelaxInferLayout", InferLayoutUnaryEwise)
     .set_attr<bool>("FPurity", true);
 
+/* relax.ccl.alltoall */
+
+Expr alltoall(Expr x, int num_workers, bool in_group) {
+  ffi::ObjectPtr<AllGatherAttrs> attrs = ffi::make_object<AllGatherAttrs>();
+  attrs->num_workers = std::move(num_workers);
+  attrs->in_group = std::move(in_group);
+
+  static const Op& op = Op::Get("relax.ccl.alltoall");
+  return Call(Type::Missing(), op, {std::move(x)}, Attrs{attrs}, {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.ccl.alltoall", alltoall);
+}
+
+Type InferTypeAllToAll(const Call& call, const BlockBuilder& ctx) {
+  TensorType input_ty = GetUnaryInputTensorType(call, ctx);
+  const auto* attrs = call->attrs.as<AllGatherAttrs>();
+  auto input_shape = input_ty->GetShape();
+  if (input_shape.has_value() && !input_shape.value().empty() &&
+      ctx->GetAnalyzer()->CanProve(
+          floormod(input_shape.value()[0], PrimExpr(attrs->num_workers)) != 0)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "alltoall expects the size of axis 0 of input tensor to be divisible by the "
+           "num_workers. However, axis 0 of input tensor is "
+        << input_shape.value() << " while num_workers is " << attrs->num_workers;
+  }
+  return input_ty;
+}
+
+TVM_REGISTER_OP("relax.ccl.alltoall")
+    .set_num_inputs(1)
+    .add_argument("x", "Tensor",
+                  "The buffer whose i-th chunk along axis 0 is exchanged with the i-th worker.")
+    .set_attr<FInferType>("FInferType", InferTypeAllToAll)
+    .set_attr<bool>("FPurity", true);
+
+/* relax.ccl.reducescatter */
+
+Expr reducescatter(Expr x, ffi::String op_type, int num_workers, bool in_group) {
+  ffi::ObjectPtr<ReduceScatterAttrs> attrs = ffi::make_object<ReduceScatterAttrs>();
+  attrs->op_type = std::move(op_type);
+  attrs->num_workers = std::move(num_workers);
+  attrs->in_group = std::move(in_group);
+
+  static const Op& op = Op::Get("relax.ccl.reducescatter");
+  return Call(Type::Missing(), op, {std::move(x)}, Attrs{attrs}, {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.ccl.reducescatter", reducescatter);
+}
+
+Type InferTypeReduceScatter(const Call& call, const BlockBuilder& ctx) {
+  TensorType input_ty = GetUnaryInputTensorType(call, ctx);
+  const auto* attrs = call->attrs.as<ReduceScatterAttrs>();
+  int num_workers = attrs->num_workers;
+
+  auto input_shape = input_ty->GetShape();
+  if (!input_shape.has_value()) {
+    return input_ty;
+  }
+  ffi::Array<PrimExpr> output_shape = input_shape.value();
+  if (ctx->GetAnalyzer()->CanProve(floormod(output_shape[0], PrimExpr(num_workers)) != 0)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "reducescatter expects the size of axis 0 of input tensor to be divisible by the "
+           "num_workers. However, axis 0 of input tensor is "
+        << input_shape.value() << " while num_workers is " << num_workers;
+  }
+  output_shape.Set(0, floordiv(output_shape[0], num_workers));
+  return TensorType(ShapeExpr(output_shape), input_ty->dtype, input_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.ccl.reducescatter")
+    .set_attrs_type<ReduceScatterAttrs>()
+    .set_num_inputs(1)
+    .add_argument("x", "Tensor",
+                  "Input to be reduced, whose i-th chunk along axis 0 of the result is kept by "
+                  "the i-th worker.")
+    .set_attr<FInferType>("FInferType", InferTypeReduceScatter)
+    .set_attr<bool>("FPurity", true);
+
 /* relax.ccl.broadcast_from_worker0 */
 Expr broadcast_from_worker0(Expr x) {
   static const Op& op = Op::Get("relax.ccl.broadcast_from_worker0");
@@ -38,6 +38,12 @@ Expr allreduce(Expr data, ffi::String op_type, bool in_group);
 /*! \brief AllGather. */
 Expr allgather(Expr data, int num_workers, bool in_group);
 
+/*! \brief AllToAll, exchanging equal chunks of the given buffer between all workers. */
+Expr alltoall(Expr data, int num_workers, bool in_group);
+
+/*! \brief ReduceScatter, reducing the given buffer and keeping the chunk of each worker. */
+Expr reducescatter(Expr data, ffi::String op_type, int num_workers, bool in_group);
+
 /*! \brief Broadcast data from worker-0 to all other workers. */
 Expr broadcast_from_worker0(Expr data);
 
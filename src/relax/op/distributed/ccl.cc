@@ -40,6 +40,36 @@ Type InferDistTypeAllReduce(const Call& call, const BlockBuilder& ctx) {
 TVM_REGISTER_OP("relax.ccl.allreduce")
     .set_attr<FInferType>("dist.FInferType", InferDistTypeAllReduce);
 
+Type InferDistTypeAllToAll(const Call& call, const BlockBuilder& ctx) {
+  ffi::Array<DTensorType> input_dtensor_tys = GetInputDTensorType(call, ctx);
+  TVM_FFI_ICHECK(input_dtensor_tys.size() == 1);
+  // The chunks are exchanged in place, so the layout of the buffer is kept.
+  return input_dtensor_tys[0];
+}
+
+TVM_REGISTER_OP("relax.ccl.alltoall")
+    .set_attr<FInferType>("dist.FInferType", InferDistTypeAllToAll);
+
+Type InferDistTypeReduceScatter(const Call& call, const BlockBuilder& ctx) {
+  ffi::Array<DTensorType> input_dtensor_tys = GetInputDTensorType(call, ctx);
+  TVM_FFI_ICHECK(input_dtensor_tys.size() == 1);
+  DTensorType input_dtensor_ty = input_dtensor_tys[0];
+  TensorType tensor_ty = input_dtensor_ty->tensor_ty;
+  DeviceMesh device_mesh = input_dtensor_ty->device_mesh;
+  const auto* attrs = call->attrs.as<ReduceScatterAttrs>();
+  if (ffi::Optional<ffi::Array<PrimExpr>> shape = tensor_ty->GetShape()) {
+    ffi::Array<PrimExpr> output_shape = shape.value();
+    output_shape.Set(0, floordiv(output_shape[0], attrs->num_workers));
+    tensor_ty = TensorType(ShapeExpr(output_shape), tensor_ty->dtype, tensor_ty->vdevice);
+  }
+  // FIXME: this is a hack where there's only 1d mesh
+  return DTensorType(tensor_ty, device_mesh,
+                     Placement::FromText(std::string(device_mesh->shape.size(), 'R')));
+}
+
+TVM_REGISTER_OP("relax.ccl.reducescatter")
+    .set_attr<FInferType>("dist.FInferType", InferDistTypeReduceScatter);
+
 }  // namespace distributed
 }  // namespace relax
 }  // namespace tvm
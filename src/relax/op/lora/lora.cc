@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lora.cc
+ * \brief Low-rank adaptation (LoRA) operators.
+ */
+
+#include "lora.h"
+
+#include <tvm/ffi/extra/visit_error_context.h>
+#include <tvm/ffi/reflection/registry.h>
+
+#include <utility>
+
+namespace tvm {
+namespace relax {
+
+/* relax.lora.sgmv */
+
+Expr sgmv(Expr data, Expr weight, Expr seg_indptr, Expr weight_indices) {
+  static const Op& op = Op::Get("relax.lora.sgmv");
+  return Call(Type::Missing(), op,
+              {std::move(data), std::move(weight), std::move(seg_indptr),
+               std::move(weight_indices)},
+              Attrs(), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.lora.sgmv", sgmv);
+}
+
+Type InferTypeSgmv(const Call& call, const BlockBuilder& ctx) {
+  CheckNumArguments(call, ctx);
+  TensorType data_ty = GetInputTensorType(call, 0, ctx);
+  TensorType weight_ty = GetInputTensorType(call, 1, ctx);
+  TensorType indptr_ty = GetInputTensorType(call, 2, ctx);
+  TensorType indices_ty = GetInputTensorType(call, 3, ctx);
+  auto check_ndim = [&](const TensorType& ty, const char* name, int ndim) {
+    if (!ty->IsUnknownNdim() && ty->ndim != ndim) {
+      TVM_FFI_VISIT_THROW(ValueError, call)
+          << "lora.sgmv requires the input " << name << " to be a " << ndim
+          << "-D tensor. However, the given " << name << " has ndim " << ty->ndim;
+    }
+  };
+  auto check_int_dtype = [&](const TensorType& ty, const char* name) {
+    if (!ty->IsUnknownDtype() &&
+        !ty->dtype.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt)) {
+      TVM_FFI_VISIT_THROW(TypeError, call)
+          << "lora.sgmv requires the input " << name
+          << " to have int dtype. However, the given dtype is " << ty->dtype;
+    }
+  };
+  check_ndim(data_ty, "data", 2);
+  check_ndim(weight_ty, "weight", 3);
+  check_ndim(indptr_ty, "seg_indptr", 1);
+  check_ndim(indices_ty, "weight_indices", 1);
+  check_int_dtype(indptr_ty, "seg_indptr");
+  check_int_dtype(indices_ty, "weight_indices");
+  if (!data_ty->IsUnknownDtype() && !weight_ty->IsUnknownDtype() &&
+      data_ty->dtype != weight_ty->dtype) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << "lora.sgmv requires the input data and weight to have the same dtype. However, they "
+           "are "
+        << data_ty->dtype << " and " << weight_ty->dtype;
+  }
+
+  // Expected to be `(num_rows, in_features)`, `(num_slots, out_features, in_features)`,
+  // `(num_segs + 1,)` and `(num_segs,)`
+  const auto* data_shape = data_ty->shape.as<ShapeExprNode>();
+  const auto* weight_shape = weight_ty->shape.as<ShapeExprNode>();
+  const auto* indptr_shape = indptr_ty->shape.as<ShapeExprNode>();
+  const auto* indices_shape = indices_ty->shape.as<ShapeExprNode>();
+  if (indptr_shape != nullptr && indices_shape != nullptr &&
+      ctx->GetAnalyzer()->CanProve(indptr_shape->values[0] != indices_shape->values[0] + 1)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "lora.sgmv requires seg_indptr to have one more element than weight_indices. "
+           "However, their lengths are "
+        << indptr_shape->values[0] << " and " << indices_shape->values[0];
+  }
+  if (data_shape == nullptr || weight_shape == nullptr) {
+    return TensorType(data_ty->dtype, 2, data_ty->vdevice);
+  }
+  if (ctx->GetAnalyzer()->CanProve(data_shape->values[1] != weight_shape->values[2])) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "lora.sgmv requires the in_features of data and weight to match. However, they are "
+        << data_shape->values[1] << " and " << weight_shape->values[2];
+  }
+  return TensorType(ShapeExpr({data_shape->values[0], weight_shape->values[1]}), data_ty->dtype,
+                    data_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.lora.sgmv")
+    .set_num_inputs(4)
+    .add_argument("data", "Tensor", "The rows of the tokens, grouped by segment.")
+    .add_argument("weight", "Tensor", "The low-rank weights of the adapter slots.")
+    .add_argument("seg_indptr", "Tensor", "The offsets of the rows of each segment.")
+    .add_argument("weight_indices", "Tensor", "The weight slot of each segment, -1 for none.")
+    .set_attr<FInferType>("FInferType", InferTypeSgmv)
+    .set_attr<bool>("FPurity", true);
+
+}  // namespace relax
+}  // namespace tvm
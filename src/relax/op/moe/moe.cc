@@ -0,0 +1,295 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file moe.cc
+ * \brief Mixture-of-Experts operators.
+ */
+
+#include "moe.h"
+
+#include <tvm/ffi/extra/visit_error_context.h>
+#include <tvm/ffi/reflection/registry.h>
+
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  MoETopKGatingAttrs::RegisterReflection();
+  MoEPermuteAttrs::RegisterReflection();
+}
+
+/*! \brief Check the ndim of an input of a MoE operator, when it is known. */
+void CheckMoEInputNdim(const Call& call, const TensorType& ty, const char* name, int ndim) {
+  if (!ty->IsUnknownNdim() && ty->ndim != ndim) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << call->op.as_or_throw<Op>()->name << " requires the input " << name << " to be a "
+        << ndim << "-D tensor. However, the given " << name << " has ndim " << ty->ndim;
+  }
+}
+
+/*! \brief Check the element kind of an input of a MoE operator, when it is known. */
+void CheckMoEInputIntDtype(const Call& call, const TensorType& ty, const char* name) {
+  // Only the element kind matters here; shape inference does not depend on vector lanes.
+  if (!ty->IsUnknownDtype() &&
+      !ty->dtype.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt)) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << call->op.as_or_throw<Op>()->name << " requires the input " << name
+        << " to have int dtype. However, the given dtype is " << ty->dtype;
+  }
+}
+
+/*! \brief Check two dimensions of the inputs of a MoE operator are equal, when it is known. */
+void CheckMoEDimEqual(const Call& call, const BlockBuilder& ctx, const PrimExpr& lhs,
+                      const PrimExpr& rhs, const char* desc) {
+  if (ctx->GetAnalyzer()->CanProve(lhs != rhs)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << call->op.as_or_throw<Op>()->name << " requires " << desc
+        << " to match. However, they are " << lhs << " and " << rhs;
+  }
+}
+
+/* relax.moe.topk_gating */
+
+Expr topk_gating(Expr logits, int top_k, bool normalize) {
+  ffi::ObjectPtr<MoETopKGatingAttrs> attrs = ffi::make_object<MoETopKGatingAttrs>();
+  attrs->top_k = top_k;
+  attrs->normalize = normalize;
+
+  static const Op& op = Op::Get("relax.moe.topk_gating");
+  return Call(Type::Missing(), op, {std::move(logits)}, Attrs(attrs), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.moe.topk_gating", topk_gating);
+}
+
+Type InferTypeTopKGating(const Call& call, const BlockBuilder& ctx) {
+  TensorType logits_ty = GetUnaryInputTensorType(call, ctx);
+  const auto* attrs = call->attrs.as<MoETopKGatingAttrs>();
+  if (attrs->top_k <= 0) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "moe.topk_gating requires top_k to be positive. However, top_k is " << attrs->top_k;
+  }
+  // Only the element kind matters here; shape inference does not depend on vector lanes.
+  if (!logits_ty->IsUnknownDtype() &&
+      !logits_ty->dtype.value().MatchesCode(DLDataTypeCode::kDLFloat, DLDataTypeCode::kDLBfloat)) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << "moe.topk_gating requires the input logits to have float dtype. However, the given "
+           "logits dtype is "
+        << logits_ty->dtype;
+  }
+  CheckMoEInputNdim(call, logits_ty, "logits", 2);
+
+  // Expected to be `(num_tokens, num_experts)`
+  const auto* logits_shape = logits_ty->shape.as<ShapeExprNode>();
+  if (logits_shape == nullptr) {
+    return TupleType(ffi::Array<Type>{TensorType(logits_ty->dtype, 2, logits_ty->vdevice),
+                                      TensorType(PrimType::Int(32), 2, logits_ty->vdevice)});
+  }
+  if (ctx->GetAnalyzer()->CanProve(logits_shape->values[1] < attrs->top_k)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "moe.topk_gating requires top_k to be at most the number of experts. However, top_k "
+           "is "
+        << attrs->top_k << " and the number of experts is " << logits_shape->values[1];
+  }
+  ShapeExpr out_shape({logits_shape->values[0], IntImm::Int64(attrs->top_k)});
+  return TupleType(
+      ffi::Array<Type>{TensorType(out_shape, logits_ty->dtype, logits_ty->vdevice),
+                       TensorType(out_shape, PrimType::Int(32), logits_ty->vdevice)});
+}
+
+TVM_REGISTER_OP("relax.moe.topk_gating")
+    .set_attrs_type<MoETopKGatingAttrs>()
+    .set_num_inputs(1)
+    .add_argument("logits", "Tensor", "The gating logits of the tokens over the experts.")
+    .set_attr<FInferType>("FInferType", InferTypeTopKGating)
+    .set_attr<bool>("FPurity", true);
+
+/* relax.moe.permute */
+
+Expr permute(Expr data, Expr expert_indices, int num_experts, int capacity) {
+  ffi::ObjectPtr<MoEPermuteAttrs> attrs = ffi::make_object<MoEPermuteAttrs>();
+  attrs->num_experts = num_experts;
+  attrs->capacity = capacity;
+
+  static const Op& op = Op::Get("relax.moe.permute");
+  return Call(Type::Missing(), op, {std::move(data), std::move(expert_indices)}, Attrs(attrs), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.moe.permute", permute);
+}
+
+Type InferTypePermute(const Call& call, const BlockBuilder& ctx) {
+  CheckNumArguments(call, ctx);
+  TensorType data_ty = GetInputTensorType(call, 0, ctx);
+  TensorType indices_ty = GetInputTensorType(call, 1, ctx);
+  const auto* attrs = call->attrs.as<MoEPermuteAttrs>();
+  if (attrs->num_experts <= 0 || attrs->capacity < 0) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "moe.permute requires a positive num_experts and a non-negative capacity. However, "
+           "num_experts is "
+        << attrs->num_experts << " and capacity is " << attrs->capacity;
+  }
+  CheckMoEInputNdim(call, data_ty, "data", 2);
+  CheckMoEInputNdim(call, indices_ty, "expert_indices", 2);
+  CheckMoEInputIntDtype(call, indices_ty, "expert_indices");
+
+  TensorType indptr_ty(ShapeExpr({IntImm::Int64(attrs->num_experts + 1)}), PrimType::Int(32),
+                       data_ty->vdevice);
+  // Expected to be `(num_tokens, hidden_size)` and `(num_tokens, top_k)`
+  const auto* data_shape = data_ty->shape.as<ShapeExprNode>();
+  const auto* indices_shape = indices_ty->shape.as<ShapeExprNode>();
+  if (data_shape == nullptr || indices_shape == nullptr) {
+    return TupleType(ffi::Array<Type>{TensorType(data_ty->dtype, 2, data_ty->vdevice), indptr_ty,
+                                      TensorType(PrimType::Int(32), 2, data_ty->vdevice)});
+  }
+  CheckMoEDimEqual(call, ctx, data_shape->values[0], indices_shape->values[0],
+                   "the numbers of tokens of data and expert_indices");
+  PrimExpr num_rows =
+      attrs->capacity > 0
+          ? PrimExpr(IntImm::Int64(static_cast<int64_t>(attrs->num_experts) * attrs->capacity))
+          : indices_shape->values[0] * indices_shape->values[1];
+  TensorType rows_ty(ShapeExpr({num_rows, data_shape->values[1]}), data_ty->dtype,
+                     data_ty->vdevice);
+  TensorType token_rows_ty(ffi::GetRef<ShapeExpr>(indices_shape), PrimType::Int(32),
+                           data_ty->vdevice);
+  return TupleType(ffi::Array<Type>{rows_ty, indptr_ty, token_rows_ty});
+}
+
+TVM_REGISTER_OP("relax.moe.permute")
+    .set_attrs_type<MoEPermuteAttrs>()
+    .set_num_inputs(2)
+    .add_argument("data", "Tensor", "The rows of the tokens.")
+    .add_argument("expert_indices", "Tensor", "The experts of each token.")
+    .set_attr<FInferType>("FInferType", InferTypePermute)
+    .set_attr<bool>("FPurity", true);
+
+/* relax.moe.group_matmul */
+
+Expr group_matmul(Expr data, Expr weight, Expr expert_indptr) {
+  static const Op& op = Op::Get("relax.moe.group_matmul");
+  return Call(Type::Missing(), op, {std::move(data), std::move(weight), std::move(expert_indptr)},
+              Attrs(), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.moe.group_matmul", group_matmul);
+}
+
+Type InferTypeGroupMatmul(const Call& call, const BlockBuilder& ctx) {
+  CheckNumArguments(call, ctx);
+  TensorType data_ty = GetInputTensorType(call, 0, ctx);
+  TensorType weight_ty = GetInputTensorType(call, 1, ctx);
+  TensorType indptr_ty = GetInputTensorType(call, 2, ctx);
+  CheckMoEInputNdim(call, data_ty, "data", 2);
+  CheckMoEInputNdim(call, weight_ty, "weight", 3);
+  CheckMoEInputNdim(call, indptr_ty, "expert_indptr", 1);
+  CheckMoEInputIntDtype(call, indptr_ty, "expert_indptr");
+  if (!data_ty->IsUnknownDtype() && !weight_ty->IsUnknownDtype() &&
+      data_ty->dtype != weight_ty->dtype) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << "moe.group_matmul requires the input data and weight to have the same dtype. "
+           "However, they are "
+        << data_ty->dtype << " and " << weight_ty->dtype;
+  }
+
+  // Expected to be `(num_rows, in_features)`, `(num_experts, out_features, in_features)` and
+  // `(num_experts + 1,)`
+  const auto* data_shape = data_ty->shape.as<ShapeExprNode>();
+  const auto* weight_shape = weight_ty->shape.as<ShapeExprNode>();
+  const auto* indptr_shape = indptr_ty->shape.as<ShapeExprNode>();
+  if (data_shape == nullptr || weight_shape == nullptr) {
+    return TensorType(data_ty->dtype, 2, data_ty->vdevice);
+  }
+  CheckMoEDimEqual(call, ctx, data_shape->values[1], weight_shape->values[2],
+                   "the in_features of data and weight");
+  if (indptr_shape != nullptr) {
+    CheckMoEDimEqual(call, ctx, weight_shape->values[0] + 1, indptr_shape->values[0],
+                     "the numbers of experts of weight and expert_indptr");
+  }
+  return TensorType(ShapeExpr({data_shape->values[0], weight_shape->values[1]}), data_ty->dtype,
+                    data_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.moe.group_matmul")
+    .set_num_inputs(3)
+    .add_argument("data", "Tensor", "The rows grouped by expert.")
+    .add_argument("weight", "Tensor", "The weights of the experts.")
+    .add_argument("expert_indptr", "Tensor", "The offsets of the rows of each expert.")
+    .set_attr<FInferType>("FInferType", InferTypeGroupMatmul)
+    .set_attr<bool>("FPurity", true);
+
+/* relax.moe.unpermute */
+
+Expr unpermute(Expr data, Expr token_rows, Expr weights) {
+  static const Op& op = Op::Get("relax.moe.unpermute");
+  return Call(Type::Missing(), op, {std::move(data), std::move(token_rows), std::move(weights)},
+              Attrs(), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.moe.unpermute", unpermute);
+}
+
+Type InferTypeUnpermute(const Call& call, const BlockBuilder& ctx) {
+  CheckNumArguments(call, ctx);
+  TensorType data_ty = GetInputTensorType(call, 0, ctx);
+  TensorType rows_ty = GetInputTensorType(call, 1, ctx);
+  TensorType weights_ty = GetInputTensorType(call, 2, ctx);
+  CheckMoEInputNdim(call, data_ty, "data", 2);
+  CheckMoEInputNdim(call, rows_ty, "token_rows", 2);
+  CheckMoEInputNdim(call, weights_ty, "weights", 2);
+  CheckMoEInputIntDtype(call, rows_ty, "token_rows");
+
+  // Expected to be `(num_rows, hidden_size)`, `(num_tokens, top_k)` and `(num_tokens, top_k)`
+  const auto* data_shape = data_ty->shape.as<ShapeExprNode>();
+  const auto* rows_shape = rows_ty->shape.as<ShapeExprNode>();
+  const auto* weights_shape = weights_ty->shape.as<ShapeExprNode>();
+  if (data_shape == nullptr || rows_shape == nullptr) {
+    return TensorType(data_ty->dtype, 2, data_ty->vdevice);
+  }
+  if (weights_shape != nullptr) {
+    for (int i = 0; i < 2; ++i) {
+      CheckMoEDimEqual(call, ctx, rows_shape->values[i], weights_shape->values[i],
+                       "the shapes of token_rows and weights");
+    }
+  }
+  return TensorType(ShapeExpr({rows_shape->values[0], data_shape->values[1]}), data_ty->dtype,
+                    data_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.moe.unpermute")
+    .set_num_inputs(3)
+    .add_argument("data", "Tensor", "The rows grouped by expert.")
+    .add_argument("token_rows", "Tensor", "The row of each expert of each token, -1 if dropped.")
+    .add_argument("weights", "Tensor", "The weight of each expert of each token.")
+    .set_attr<FInferType>("FInferType", InferTypeUnpermute)
+    .set_attr<bool>("FPurity", true);
+
+}  // namespace relax
+}  // namespace tvm
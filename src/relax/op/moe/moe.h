@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file moe.h
+ * \brief The functions to make Relax Mixture-of-Experts operator calls.
+ */
+
+#ifndef TVM_RELAX_OP_MOE_MOE_H_
+#define TVM_RELAX_OP_MOE_MOE_H_
+
+#include <tvm/relax/attrs/moe.h>
+
+#include "../op_common.h"
+
+namespace tvm {
+namespace relax {
+
+/*! \brief Select the top-k experts of each token from the gating logits, with their weights. */
+Expr topk_gating(Expr logits, int top_k, bool normalize);
+
+/*! \brief Gather the rows of the tokens grouped by expert. */
+Expr permute(Expr data, Expr expert_indices, int num_experts, int capacity);
+
+/*! \brief Multiply the rows of each expert with the weight of the expert. */
+Expr group_matmul(Expr data, Expr weight, Expr expert_indptr);
+
+/*! \brief Scatter the expert rows back to the tokens, summed with their weights. */
+Expr unpermute(Expr data, Expr token_rows, Expr weights);
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_OP_MOE_MOE_H_
@@ -40,6 +40,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   InstanceNormAttrs::RegisterReflection();
   RMSNormAttrs::RegisterReflection();
   NLLLossAttrs::RegisterReflection();
+  EmbeddingBagAttrs::RegisterReflection();
   DropoutAttrs::RegisterReflection();
   PadAttrs::RegisterReflection();
   PixelShuffleAttrs::RegisterReflection();
@@ -1236,5 +1237,80 @@ TVM_REGISTER_OP("relax.nn.batch_flatten")
     .set_attr<TMixedPrecisionPolicy>("TMixedPrecisionPolicy", MixedPrecisionPolicyKind::kFollow)
     .set_attr<bool>("FPurity", true);
 
+/* relax.nn.embedding_bag */
+
+Expr embedding_bag(Expr weight, Expr indices, Expr offsets, ffi::Optional<Expr> per_sample_weights,
+                   ffi::String mode) {
+  TVM_FFI_ICHECK(mode == "sum" || mode == "mean" || mode == "max")
+      << "The argument mode of embedding_bag should be one of the following values: sum, mean, "
+         "max. However, the given value is "
+      << mode;
+  TVM_FFI_ICHECK(!per_sample_weights.has_value() || mode == "sum")
+      << "embedding_bag supports per sample weights only in sum mode, but the mode is " << mode;
+  ffi::ObjectPtr<EmbeddingBagAttrs> attrs = ffi::make_object<EmbeddingBagAttrs>();
+  attrs->mode = std::move(mode);
+
+  static const Op& op = Op::Get("relax.nn.embedding_bag");
+  ffi::Array<Expr> args = {std::move(weight), std::move(indices), std::move(offsets)};
+  if (per_sample_weights.has_value()) args.push_back(per_sample_weights.value());
+  return Call(Type::Missing(), op, args, Attrs{attrs}, {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.nn.embedding_bag", embedding_bag);
+}
+
+Type InferTypeEmbeddingBag(const Call& call, const BlockBuilder& ctx) {
+  if (call->args.size() < 3 || call->args.size() > 4) {
+    TVM_FFI_VISIT_THROW(ValueError, call) << "EmbeddingBag op should take 3 or 4 arguments";
+  }
+  static const char* kArgNames[] = {"weight", "indices", "offsets", "per_sample_weights"};
+  std::vector<TensorType> arg_ty;
+  for (size_t i = 0; i < call->args.size(); ++i) {
+    const auto* ty = GetTypeAs<TensorTypeNode>(call->args[i]);
+    if (ty == nullptr) {
+      TVM_FFI_VISIT_THROW(TypeError, call)
+          << "EmbeddingBag requires the argument " << kArgNames[i]
+          << " to be Tensor. However, the given one is " << call->args[i]->ty->GetTypeKey();
+    }
+    int expected_ndim = i == 0 ? 2 : 1;
+    if (!ty->IsUnknownNdim() && ty->ndim != expected_ndim) {
+      TVM_FFI_VISIT_THROW(ValueError, call)
+          << "EmbeddingBag expects the ndim of " << kArgNames[i] << " to be " << expected_ndim
+          << ". However, the ndim of " << kArgNames[i] << " is " << ty->ndim;
+    }
+    arg_ty.push_back(ffi::GetRef<TensorType>(ty));
+  }
+  for (int i : {1, 2}) {
+    if (!arg_ty[i]->IsUnknownDtype() &&
+        !arg_ty[i]->dtype.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt)) {
+      TVM_FFI_VISIT_THROW(TypeError, call)
+          << "EmbeddingBag expects the dtype of " << kArgNames[i]
+          << " to be int/uint. However, the dtype of " << kArgNames[i] << " is "
+          << arg_ty[i]->dtype;
+    }
+  }
+
+  const TensorType& weight_ty = arg_ty[0];
+  const auto* weight_shape = weight_ty->shape.as<ShapeExprNode>();
+  const auto* offsets_shape = arg_ty[2]->shape.as<ShapeExprNode>();
+  if (weight_shape == nullptr || offsets_shape == nullptr) {
+    return TensorType(weight_ty->dtype, 2, weight_ty->vdevice);
+  }
+  ffi::Array<PrimExpr> output_shape = {offsets_shape->values[0], weight_shape->values[1]};
+  return TensorType(ShapeExpr(output_shape), weight_ty->dtype, weight_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.nn.embedding_bag")
+    .set_attrs_type<EmbeddingBagAttrs>()
+    .set_num_inputs(4)
+    .add_argument("weight", "Tensor", "The embedding table.")
+    .add_argument("indices", "Tensor", "The indices of all the bags, concatenated.")
+    .add_argument("offsets", "Tensor", "The start position of each bag in the indices.")
+    .add_argument("per_sample_weights", "ffi::Optional<Tensor>", "The weight of each index.")
+    .set_attr<FInferType>("FInferType", InferTypeEmbeddingBag)
+    .set_attr<bool>("FPurity", true);
+
 }  // namespace relax
 }  // namespace tvm
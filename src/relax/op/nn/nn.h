@@ -117,6 +117,18 @@ Expr nll_loss(Expr predictions, Expr targets, ffi::Optional<Expr> weights, ffi::
 /*! \brief Batch flatten: flatten all dimensions except the first (batch) dimension. */
 Expr batch_flatten(Expr data);
 
+/*!
+ * \brief Pool the rows of an embedding table over ragged bags of indices.
+ * \param weight The 2-D embedding table.
+ * \param indices The 1-D indices of all the bags, concatenated.
+ * \param offsets The 1-D start position of each bag in the indices.
+ * \param per_sample_weights The optional 1-D weight of each index, only in sum mode.
+ * \param mode The pooling of a bag, "sum", "mean" or "max".
+ * \return The pooled bags, of shape (num_bags, embedding_dim).
+ */
+Expr embedding_bag(Expr weight, Expr indices, Expr offsets, ffi::Optional<Expr> per_sample_weights,
+                   ffi::String mode);
+
 }  // namespace relax
 }  // namespace tvm
 
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file sparse.cc
+ * \brief 2:4 structured-sparse operators.
+ */
+
+#include "sparse.h"
+
+#include <tvm/ffi/extra/visit_error_context.h>
+#include <tvm/ffi/reflection/registry.h>
+
+#include <utility>
+
+namespace tvm {
+namespace relax {
+
+/*! \brief The number of rows and columns of the weight covered by one tile of metadata. */
+constexpr int kSparseTileSize = 16;
+/*! \brief The number of metadata words of one tile. */
+constexpr int kSparseTileWords = 8;
+
+/*! \brief Check the ndim of an input of a sparse operator, when it is known. */
+void CheckSparseInputNdim(const Call& call, const TensorType& ty, const char* name, int ndim) {
+  if (!ty->IsUnknownNdim() && ty->ndim != ndim) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << call->op.as_or_throw<Op>()->name << " requires the input " << name << " to be a "
+        << ndim << "-D tensor. However, the given " << name << " has ndim " << ty->ndim;
+  }
+}
+
+/*! \brief Check the float dtype of an input of a sparse operator, when it is known. */
+void CheckSparseInputFloatDtype(const Call& call, const TensorType& ty, const char* name) {
+  if (!ty->IsUnknownDtype() &&
+      !ty->dtype.value().MatchesCode(DLDataTypeCode::kDLFloat, DLDataTypeCode::kDLBfloat)) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << call->op.as_or_throw<Op>()->name << " requires the input " << name
+        << " to have float dtype. However, the given dtype is " << ty->dtype;
+  }
+}
+
+/*! \brief Check a dimension of the weight is a multiple of the tile size, when it is known. */
+void CheckSparseTileMultiple(const Call& call, const BlockBuilder& ctx, const PrimExpr& dim,
+                             const char* desc) {
+  if (ctx->GetAnalyzer()->CanProve(floormod(dim, kSparseTileSize) != 0)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << call->op.as_or_throw<Op>()->name << " requires " << desc << " to be a multiple of "
+        << kSparseTileSize << ". However, it is " << dim;
+  }
+}
+
+/* relax.sparse.compress_2_4 */
+
+Expr compress_2_4(Expr weight) {
+  static const Op& op = Op::Get("relax.sparse.compress_2_4");
+  return Call(Type::Missing(), op, {std::move(weight)}, Attrs(), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.sparse.compress_2_4", compress_2_4);
+}
+
+Type InferTypeCompress24(const Call& call, const BlockBuilder& ctx) {
+  TensorType weight_ty = GetUnaryInputTensorType(call, ctx);
+  CheckSparseInputNdim(call, weight_ty, "weight", 2);
+  CheckSparseInputFloatDtype(call, weight_ty, "weight");
+
+  // Expected to be `(out_features, in_features)`
+  const auto* weight_shape = weight_ty->shape.as<ShapeExprNode>();
+  if (weight_shape == nullptr) {
+    return TupleType(ffi::Array<Type>{TensorType(weight_ty->dtype, 2, weight_ty->vdevice),
+                                      TensorType(PrimType::UInt(32), 3, weight_ty->vdevice)});
+  }
+  PrimExpr out_features = weight_shape->values[0];
+  PrimExpr in_features = weight_shape->values[1];
+  CheckSparseTileMultiple(call, ctx, out_features, "the out_features of the weight");
+  CheckSparseTileMultiple(call, ctx, in_features, "the in_features of the weight");
+  arith::Analyzer analyzer = ctx->GetAnalyzer();
+  TensorType values_ty(ShapeExpr({out_features, analyzer->Simplify(floordiv(in_features, 2))}),
+                       weight_ty->dtype, weight_ty->vdevice);
+  TensorType metadata_ty(ShapeExpr({analyzer->Simplify(floordiv(out_features, kSparseTileSize)),
+                                    analyzer->Simplify(floordiv(in_features, kSparseTileSize)),
+                                    IntImm::Int64(kSparseTileWords)}),
+                         PrimType::UInt(32), weight_ty->vdevice);
+  return TupleType(ffi::Array<Type>{values_ty, metadata_ty});
+}
+
+TVM_REGISTER_OP("relax.sparse.compress_2_4")
+    .set_num_inputs(1)
+    .add_argument("weight", "Tensor", "The 2:4 sparse weight of the layer.")
+    .set_attr<FInferType>("FInferType", InferTypeCompress24)
+    .set_attr<bool>("FPurity", true);
+
+/* relax.sparse.matmul_2_4 */
+
+Expr matmul_2_4(Expr data, Expr values, Expr metadata) {
+  static const Op& op = Op::Get("relax.sparse.matmul_2_4");
+  return Call(Type::Missing(), op, {std::move(data), std::move(values), std::move(metadata)},
+              Attrs(), {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.sparse.matmul_2_4", matmul_2_4);
+}
+
+Type InferTypeMatmul24(const Call& call, const BlockBuilder& ctx) {
+  CheckNumArguments(call, ctx);
+  TensorType data_ty = GetInputTensorType(call, 0, ctx);
+  TensorType values_ty = GetInputTensorType(call, 1, ctx);
+  TensorType metadata_ty = GetInputTensorType(call, 2, ctx);
+  if (!data_ty->IsUnknownNdim() && data_ty->ndim < 1) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "sparse.matmul_2_4 requires the input data to have at least one dimension";
+  }
+  CheckSparseInputNdim(call, values_ty, "values", 2);
+  CheckSparseInputNdim(call, metadata_ty, "metadata", 3);
+  CheckSparseInputFloatDtype(call, data_ty, "data");
+  if (!metadata_ty->IsUnknownDtype() && metadata_ty->dtype != PrimType::UInt(32)) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << "sparse.matmul_2_4 requires the input metadata to have uint32 dtype. However, the "
+           "given dtype is "
+        << metadata_ty->dtype;
+  }
+  if (!data_ty->IsUnknownDtype() && !values_ty->IsUnknownDtype() &&
+      data_ty->dtype != values_ty->dtype) {
+    TVM_FFI_VISIT_THROW(TypeError, call)
+        << "sparse.matmul_2_4 requires the input data and values to have the same dtype. "
+           "However, they are "
+        << data_ty->dtype << " and " << values_ty->dtype;
+  }
+
+  // Expected to be `(..., in_features)`, `(out_features, in_features / 2)` and
+  // `(out_features / 16, in_features / 16, 8)`
+  const auto* data_shape = data_ty->shape.as<ShapeExprNode>();
+  const auto* values_shape = values_ty->shape.as<ShapeExprNode>();
+  const auto* metadata_shape = metadata_ty->shape.as<ShapeExprNode>();
+  arith::Analyzer analyzer = ctx->GetAnalyzer();
+  if (values_shape != nullptr && metadata_shape != nullptr &&
+      (analyzer->CanProve(values_shape->values[0] !=
+                          metadata_shape->values[0] * kSparseTileSize) ||
+       analyzer->CanProve(values_shape->values[1] * 2 !=
+                          metadata_shape->values[1] * kSparseTileSize) ||
+       analyzer->CanProve(metadata_shape->values[2] != kSparseTileWords))) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "sparse.matmul_2_4 requires the metadata to cover the values in tiles of "
+        << kSparseTileSize << "x" << kSparseTileSize
+        << " of the weight. However, the values have shape " << ffi::GetRef<ShapeExpr>(values_shape)
+        << " and the metadata has shape " << ffi::GetRef<ShapeExpr>(metadata_shape);
+  }
+  if (data_shape == nullptr || values_shape == nullptr) {
+    return TensorType(data_ty->dtype, data_ty->ndim, data_ty->vdevice);
+  }
+  if (analyzer->CanProve(data_shape->values.back() != values_shape->values[1] * 2)) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "sparse.matmul_2_4 requires the in_features of data to be twice the number of values "
+           "of a row of the weight. However, they are "
+        << data_shape->values.back() << " and " << values_shape->values[1];
+  }
+  ffi::Array<PrimExpr> out_shape = data_shape->values;
+  out_shape.Set(out_shape.size() - 1, values_shape->values[0]);
+  return TensorType(ShapeExpr(out_shape), data_ty->dtype, data_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.sparse.matmul_2_4")
+    .set_num_inputs(3)
+    .add_argument("data", "Tensor", "The input rows.")
+    .add_argument("values", "Tensor", "The nonzero values of the 2:4 sparse weight.")
+    .add_argument("metadata", "Tensor", "The positions of the values within their groups.")
+    .set_attr<FInferType>("FInferType", InferTypeMatmul24)
+    .set_attr<bool>("FPurity", true);
+
+}  // namespace relax
+}  // namespace tvm
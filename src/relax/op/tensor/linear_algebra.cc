@@ -298,5 +298,67 @@ TVM_REGISTER_OP("relax.outer")
     .set_attr<TMixedPrecisionPolicy>("TMixedPrecisionPolicy", MixedPrecisionPolicyKind::kAlways)
     .set_attr<bool>("FPurity", true);
 
+/* relax.csr_matmul */
+
+Expr csr_matmul(Expr data, Expr indices, Expr indptr, Expr dense) {
+  static const Op& op = Op::Get("relax.csr_matmul");
+  return Call(Type::Missing(), op,
+              {std::move(data), std::move(indices), std::move(indptr), std::move(dense)}, {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.op.csr_matmul", csr_matmul);
+}
+
+Type InferTypeCSRMatmul(const Call& call, const BlockBuilder& ctx) {
+  auto input_ty = GetInputTensorType(call, ctx);
+  static const char* kArgNames[] = {"data", "indices", "indptr", "dense"};
+  for (int i = 0; i < 4; ++i) {
+    int expected_ndim = i == 3 ? 2 : 1;
+    if (!input_ty[i]->IsUnknownNdim() && input_ty[i]->ndim != expected_ndim) {
+      TVM_FFI_VISIT_THROW(ValueError, call)
+          << "CSRMatmul expects the ndim of " << kArgNames[i] << " to be " << expected_ndim
+          << ". However, the ndim of " << kArgNames[i] << " is " << input_ty[i]->ndim;
+    }
+  }
+  for (int i : {1, 2}) {
+    if (!input_ty[i]->IsUnknownDtype() &&
+        !input_ty[i]->dtype.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt)) {
+      TVM_FFI_VISIT_THROW(TypeError, call)
+          << "CSRMatmul expects the dtype of " << kArgNames[i]
+          << " to be int/uint. However, the dtype of " << kArgNames[i] << " is "
+          << input_ty[i]->dtype;
+    }
+  }
+
+  const auto* data_shape = input_ty[0]->shape.as<ShapeExprNode>();
+  const auto* indices_shape = input_ty[1]->shape.as<ShapeExprNode>();
+  if (data_shape != nullptr && indices_shape != nullptr &&
+      ctx->GetAnalyzer()->CanProve(data_shape->values[0] != indices_shape->values[0])) {
+    TVM_FFI_VISIT_THROW(ValueError, call)
+        << "CSRMatmul expects one column index per nonzero. However, there are "
+        << data_shape->values[0] << " nonzeros and " << indices_shape->values[0] << " indices";
+  }
+
+  const TensorType& dense_ty = input_ty[3];
+  const auto* indptr_shape = input_ty[2]->shape.as<ShapeExprNode>();
+  const auto* dense_shape = dense_ty->shape.as<ShapeExprNode>();
+  if (indptr_shape == nullptr || dense_shape == nullptr) {
+    return TensorType(dense_ty->dtype, 2, dense_ty->vdevice);
+  }
+  ffi::Array<PrimExpr> output_shape = {indptr_shape->values[0] - 1, dense_shape->values[1]};
+  return TensorType(ShapeExpr(output_shape), dense_ty->dtype, dense_ty->vdevice);
+}
+
+TVM_REGISTER_OP("relax.csr_matmul")
+    .set_num_inputs(4)
+    .add_argument("data", "Tensor", "The nonzero values of the sparse matrix.")
+    .add_argument("indices", "Tensor", "The column of each nonzero.")
+    .add_argument("indptr", "Tensor", "The start position of each row in the nonzeros.")
+    .add_argument("dense", "Tensor", "The dense matrix.")
+    .set_attr<FInferType>("FInferType", InferTypeCSRMatmul)
+    .set_attr<bool>("FPurity", true);
+
 }  // namespace relax
 }  // namespace tvm
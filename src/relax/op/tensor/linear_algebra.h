@@ -59,6 +59,16 @@ Expr einsum(Expr operands, ffi::String subscripts);
  */
 Expr outer(Expr x1, Expr x2);
 
+/*!
+ * \brief Multiply a sparse matrix in CSR format with a dense matrix.
+ * \param data The 1-D nonzero values of the sparse matrix.
+ * \param indices The 1-D column of each nonzero.
+ * \param indptr The 1-D start position of each row in the nonzeros, plus the number of nonzeros.
+ * \param dense The 2-D dense matrix.
+ * \return The dense result, of shape (num_rows, dense.shape[1]).
+ */
+Expr csr_matmul(Expr data, Expr indices, Expr indptr, Expr dense);
+
 }  // namespace relax
 }  // namespace tvm
 
@@ -0,0 +1,421 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/assign_device_streams.cc
+ * \brief Launch the kernels of independent dataflow branches on multiple device streams.
+ *
+ * The pass runs on the lowered functions, where the kernels are calls to PrimFuncs writing their
+ * output arguments. Walking the bindings in program order, a kernel depends on the earlier kernels
+ * that write a memory it accesses, or access a memory it writes. A kernel continues the stream of
+ * one of its dependencies that is the last kernel there, otherwise it starts a new branch on
+ * another stream. The dependencies on the other streams are synchronized before the launch.
+ *
+ * Memory is tracked at the granularity of the storages, so the tensors sharing a storage after
+ * memory planning are ordered. A side stream first waits for the default stream, so it is ordered
+ * after the earlier work on the device, and the default stream waits for all streams at the end
+ * of each binding block and before any other operation. The storages used in between stay alive
+ * until then, so that no memory is freed and reused while a kernel of another stream may still
+ * access it.
+ */
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relax/utils.h>
+#include <tvm/tirx/builtin.h>
+#include <tvm/tirx/function.h>
+#include <tvm/tirx/stmt_functor.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.backend.num_device_streams", int64_t);
+
+namespace {
+
+/*!
+ * \brief Collect the parameters of a PrimFunc that it may write. All the parameters are considered
+ * written when the function writes through an opaque call or pointer.
+ */
+class WrittenParamCollector : public tirx::StmtExprVisitor {
+ public:
+  static std::vector<bool> Collect(const tirx::PrimFunc& func) {
+    WrittenParamCollector collector;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      const tirx::Var& param = func->params[i];
+      if (auto buffer = func->buffer_map.Get(param)) {
+        collector.param_index_[buffer.value()->data.get()] = i;
+      } else {
+        collector.param_index_[param.get()] = i;
+      }
+    }
+    collector(func->body);
+    std::vector<bool> written(func->params.size(), collector.opaque_);
+    for (const auto& [data, index] : collector.param_index_) {
+      if (collector.written_.count(data)) {
+        written[index] = true;
+      }
+    }
+    return written;
+  }
+
+ private:
+  using tirx::StmtExprVisitor::VisitExpr_;
+  using tirx::StmtExprVisitor::VisitStmt_;
+
+  void VisitStmt_(const tirx::BufferStoreNode* op) final {
+    MarkWritten(op->buffer);
+    tirx::StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const tirx::SBlockNode* op) final {
+    for (const tirx::MatchBufferRegion& match : op->match_buffers) {
+      alias_[match->buffer->data.get()] = Resolve(match->source->buffer->data.get());
+    }
+    for (const tirx::BufferRegion& region : op->writes) {
+      MarkWritten(region->buffer);
+    }
+    tirx::StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const tirx::TilePrimitiveCallNode* op) final { opaque_ = true; }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->op.same_as(tirx::builtin::call_extern()) ||
+        op->op.same_as(tirx::builtin::call_llvm_intrin()) ||
+        op->op.same_as(tirx::builtin::tvm_call_packed()) ||
+        op->op.same_as(tirx::builtin::tvm_call_cpacked()) ||
+        op->op.same_as(tirx::builtin::tvm_call_packed_lowered()) ||
+        op->op.same_as(tirx::builtin::tvm_call_cpacked_lowered()) ||
+        op->op.same_as(tirx::builtin::tvm_access_ptr()) ||
+        op->op.same_as(tirx::builtin::address_of())) {
+      opaque_ = true;
+    }
+    tirx::StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitBufferDef(const tirx::Buffer& buffer, bool alloc_data) final {
+    if (alloc_data) {
+      local_.insert(buffer->data.get());
+    }
+    tirx::StmtExprVisitor::VisitBufferDef(buffer, alloc_data);
+  }
+
+  const tirx::VarNode* Resolve(const tirx::VarNode* data) const {
+    auto it = alias_.find(data);
+    return it == alias_.end() ? data : it->second;
+  }
+
+  void MarkWritten(const tirx::Buffer& buffer) {
+    const tirx::VarNode* data = Resolve(buffer->data.get());
+    if (param_index_.count(data)) {
+      written_.insert(data);
+    } else if (!local_.count(data)) {
+      // The buffer may alias a parameter in an unknown way.
+      opaque_ = true;
+    }
+  }
+
+  std::unordered_map<const tirx::VarNode*, size_t> param_index_;
+  std::unordered_map<const tirx::VarNode*, const tirx::VarNode*> alias_;
+  std::unordered_set<const tirx::VarNode*> local_;
+  std::unordered_set<const tirx::VarNode*> written_;
+  bool opaque_ = false;
+};
+
+/*! \brief A kernel launched in the current binding block. */
+struct KernelRecord {
+  /*! \brief The storages the kernel reads. */
+  std::unordered_set<const VarNode*> reads;
+  /*! \brief The storages the kernel writes. */
+  std::unordered_set<const VarNode*> writes;
+  /*! \brief The stream of the kernel. */
+  int stream;
+  /*! \brief The number of kernels on the stream up to the kernel. */
+  int64_t position;
+};
+
+bool Intersects(const std::unordered_set<const VarNode*>& lhs,
+                const std::unordered_set<const VarNode*>& rhs) {
+  return std::any_of(lhs.begin(), lhs.end(), [&](const VarNode* var) { return rhs.count(var); });
+}
+
+class DeviceStreamAssigner : public ExprMutator {
+ public:
+  DeviceStreamAssigner(IRModule mod, int num_streams)
+      : ExprMutator(mod), mod_(mod), num_streams_(num_streams) {}
+
+  IRModule Run() {
+    for (const auto& [gvar, func] : mod_->functions) {
+      if (auto relax_func = func.as<Function>()) {
+        auto new_func = VisitExpr(relax_func.value()).as_or_throw<Function>();
+        builder_->UpdateFunction(gvar, new_func);
+      }
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitBindingBlock_;
+
+  BindingBlock VisitBindingBlock_(const BindingBlockNode* block) final {
+    builder_->BeginBindingBlock();
+    ResetStreams();
+    for (const Binding& binding : block->bindings) {
+      AssignBinding(binding);
+    }
+    Join();
+    return builder_->EndBlock();
+  }
+
+ private:
+  void AssignBinding(const Binding& binding) {
+    static const Op& mem_alloc_storage_op = Op::Get("relax.memory.alloc_storage");
+    static const Op& mem_alloc_tensor_op = Op::Get("relax.memory.alloc_tensor");
+    static const Op& builtin_alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
+    static const Op& reshape_op = Op::Get("relax.reshape");
+    static const Op& null_value_op = Op::Get("relax.null_value");
+
+    const VarNode* var = binding->var.get();
+    Expr value = GetBoundValue(binding);
+    if (value->IsInstance<VarNode>() || value->IsInstance<TupleNode>() ||
+        value->IsInstance<TupleGetItemNode>()) {
+      // The aliases of the memory of their components.
+      storages_[var] = GetStorages(value);
+    } else if (value->IsInstance<ConstantNode>() || value->IsInstance<ShapeExprNode>() ||
+               value->IsInstance<PrimExprNode>() || value->IsInstance<StringImmNode>() ||
+               value->IsInstance<DataTypeImmNode>()) {
+      // Host values that no kernel writes.
+    } else if (const auto* call = value.as<CallNode>()) {
+      if (call->op.same_as(mem_alloc_storage_op) || call->op.same_as(builtin_alloc_tensor_op)) {
+        storages_[var] = {binding->var};
+      } else if (call->op.same_as(mem_alloc_tensor_op) || call->op.same_as(reshape_op)) {
+        storages_[var] = GetStorages(call->args[0]);
+      } else if (call->op.same_as(null_value_op)) {
+      } else if (IsKernel(call->op)) {
+        AssignKernel(binding, call->op.as_or_throw<GlobalVar>(), call);
+        return;
+      } else {
+        AssignBarrier(binding);
+        return;
+      }
+    } else {
+      AssignBarrier(binding);
+      return;
+    }
+    ExprMutator::VisitBinding(binding);
+  }
+
+  /*! \brief Whether the callee is a PrimFunc of the module. */
+  bool IsKernel(const Expr& op) const {
+    const auto* gvar = op.as<GlobalVarNode>();
+    return gvar != nullptr && mod_->ContainGlobalVar(gvar->name_hint) &&
+           mod_->Lookup(ffi::GetRef<GlobalVar>(gvar))->IsInstance<tirx::PrimFuncNode>();
+  }
+
+  /*! \brief Run an operation that may access the device memory after all the kernels. */
+  void AssignBarrier(const Binding& binding) {
+    Join();
+    ExprMutator::VisitBinding(binding);
+    ResetStreams();
+  }
+
+  void AssignKernel(const Binding& binding, const GlobalVar& gvar, const CallNode* call) {
+    auto it = written_params_.find(gvar.get());
+    if (it == written_params_.end()) {
+      tirx::PrimFunc func = mod_->Lookup(gvar).as_or_throw<tirx::PrimFunc>();
+      it = written_params_.emplace(gvar.get(), WrittenParamCollector::Collect(func)).first;
+    }
+    const std::vector<bool>& written = it->second;
+
+    KernelRecord kernel;
+    for (size_t i = 0; i < call->args.size(); ++i) {
+      // The tensor arguments precede the symbolic shape arguments of the PrimFunc.
+      bool is_written = i >= written.size() || written[i];
+      for (const Var& storage : GetStorages(call->args[i])) {
+        (is_written ? kernel.writes : kernel.reads).insert(storage.get());
+        if (touched_set_.insert(storage.get()).second) {
+          touched_.push_back(storage);
+        }
+      }
+    }
+    std::vector<const KernelRecord*> deps;
+    for (const KernelRecord& prev : kernels_) {
+      if (Intersects(prev.writes, kernel.reads) || Intersects(prev.writes, kernel.writes) ||
+          Intersects(prev.reads, kernel.writes)) {
+        deps.push_back(&prev);
+      }
+    }
+
+    kernel.stream = ChooseStream(deps);
+    if (kernel.stream != 0 && !forked_[kernel.stream]) {
+      EmitWait(0, kernel.stream);
+      forked_[kernel.stream] = true;
+    }
+    for (const KernelRecord* dep : deps) {
+      if (dep->stream != kernel.stream && waited_[kernel.stream][dep->stream] < dep->position) {
+        EmitWait(dep->stream, kernel.stream);
+      }
+    }
+    if (kernel.stream != current_stream_) {
+      EmitCall("vm.builtin.device_stream.set_current", {PrimExpr(IntImm::Int64(kernel.stream))});
+      current_stream_ = kernel.stream;
+    }
+    ExprMutator::VisitBinding(binding);
+    kernel.position = ++num_kernels_[kernel.stream];
+    kernels_.push_back(std::move(kernel));
+  }
+
+  /*!
+   * \brief Continue the stream of the latest dependency that is the last kernel of its stream,
+   * otherwise branch to the least used stream other than the one of the previous kernel.
+   */
+  int ChooseStream(const std::vector<const KernelRecord*>& deps) const {
+    for (auto it = deps.rbegin(); it != deps.rend(); ++it) {
+      if ((*it)->position == num_kernels_[(*it)->stream]) {
+        return (*it)->stream;
+      }
+    }
+    if (kernels_.empty()) return 0;
+    int prev_stream = kernels_.back().stream;
+    int stream = prev_stream == 0 ? 1 : 0;
+    for (int i = 0; i < num_streams_; ++i) {
+      if (i != prev_stream && num_kernels_[i] < num_kernels_[stream]) {
+        stream = i;
+      }
+    }
+    return stream;
+  }
+
+  /*! \brief Make the default stream wait for all streams, and switch back to it. */
+  void Join() {
+    if (std::none_of(forked_.begin(), forked_.end(), [](bool forked) { return forked; })) {
+      return;
+    }
+    ffi::Array<PrimExpr> streams;
+    for (int i = 1; i < num_streams_; ++i) {
+      if (waited_[0][i] < num_kernels_[i]) {
+        streams.push_back(IntImm::Int64(i));
+      }
+    }
+    // The storages are passed to keep them alive until all their kernels are done.
+    ffi::Array<Expr> args{ShapeExpr(streams)};
+    for (const Var& storage : touched_) {
+      args.push_back(VisitExpr(storage));
+    }
+    EmitCall("vm.builtin.device_stream.join", args);
+    current_stream_ = 0;
+    ResetStreams();
+  }
+
+  void EmitWait(int src, int dst) {
+    EmitCall("vm.builtin.device_stream.wait",
+             {PrimExpr(IntImm::Int64(src)), PrimExpr(IntImm::Int64(dst))});
+    waited_[dst][src] = num_kernels_[src];
+  }
+
+  void EmitCall(const char* builtin, ffi::Array<Expr> args) {
+    static const Op& call_builtin_with_ctx_op = Op::Get("relax.call_builtin_with_ctx");
+    // The kernels run on the first device of the VM.
+    args.insert(args.begin(), PrimExpr(IntImm::Int64(0)));
+    builder_->Emit(Call(Type::Missing(), call_builtin_with_ctx_op,
+                        {ExternFunc(builtin), Tuple(args)}, Attrs(), {void_ty_}),
+                   "_");
+  }
+
+  void ResetStreams() {
+    kernels_.clear();
+    num_kernels_.assign(num_streams_, 0);
+    waited_.assign(num_streams_, std::vector<int64_t>(num_streams_, 0));
+    forked_.assign(num_streams_, false);
+    touched_.clear();
+    touched_set_.clear();
+  }
+
+  ffi::Array<Var> GetStorages(const Expr& expr) const {
+    ffi::Array<Var> storages;
+    if (const auto* var = expr.as<VarNode>()) {
+      auto it = storages_.find(var);
+      // The parameters own their memory.
+      return it == storages_.end() ? ffi::Array<Var>{ffi::GetRef<Var>(var)} : it->second;
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) {
+        for (const Var& storage : GetStorages(field)) {
+          storages.push_back(storage);
+        }
+      }
+    } else if (const auto* tuple_get_item = expr.as<TupleGetItemNode>()) {
+      return GetStorages(tuple_get_item->tuple);
+    }
+    return storages;
+  }
+
+  IRModule mod_;
+  /*! \brief The number of streams to assign. */
+  const int num_streams_;
+  const Type void_ty_ = TupleType(ffi::Array<Type>({}));
+  /*! \brief The storages each variable may refer to. */
+  std::unordered_map<const VarNode*, ffi::Array<Var>> storages_;
+  /*! \brief The written parameters of the called PrimFuncs. */
+  std::unordered_map<const GlobalVarNode*, std::vector<bool>> written_params_;
+  /*! \brief The kernels since the streams were last joined. */
+  std::vector<KernelRecord> kernels_;
+  /*! \brief The number of kernels launched on each stream since the last join. */
+  std::vector<int64_t> num_kernels_;
+  /*! \brief `waited_[dst][src]` is the number of kernels of `src` that `dst` waits for. */
+  std::vector<std::vector<int64_t>> waited_;
+  /*! \brief Whether each stream waits for the default stream since the last join. */
+  std::vector<bool> forked_;
+  /*! \brief The storages accessed by the kernels since the last join. */
+  std::vector<Var> touched_;
+  std::unordered_set<const VarNode*> touched_set_;
+  /*! \brief The stream the kernels are currently launched on. */
+  int current_stream_ = 0;
+};
+
+}  // namespace
+
+namespace transform {
+
+Pass AssignDeviceStreams() {
+  auto pass_func = [=](IRModule mod, PassContext pc) {
+    int64_t num_streams = pc->GetConfig<int64_t>("relax.backend.num_device_streams").value_or(1);
+    bool use_cuda_graph = pc->GetConfig<bool>("relax.backend.use_cuda_graph").value_or(false);
+    // The captured graphs replay on the stream of the capture.
+    if (num_streams <= 1 || use_cuda_graph) {
+      return mod;
+    }
+    return DeviceStreamAssigner(mod, static_cast<int>(num_streams)).Run();
+  };
+  return CreateModulePass(pass_func, 0, "AssignDeviceStreams", {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.transform.AssignDeviceStreams", AssignDeviceStreams);
+}
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
@@ -30,6 +30,9 @@
 #include <tvm/relax/transform.h>
 #include <tvm/tirx/index_map.h>
 
+#include <unordered_set>
+#include <vector>
+
 #include "../op/tensor/manipulate.h"
 #include "infer_layout_utils.h"
 #include "utils.h"
@@ -77,12 +80,32 @@ using LayoutCb = tvm::relax::transform::LayoutCb;
  *
  * Note that currently the layout conversion of conv2d only support axis swapping, such as NCHW to
  * NWHC. Packed layout such as NCHW to NCHW4c is not supported now.
+ *
+ * The calls bound to the vars of `follow_input` ignore their desired layout and propagate the
+ * layout of their inputs instead, which is how LayoutPlanner labels the graph.
  */
 class LayoutConvertMutator : public ExprMutator {
  public:
   explicit LayoutConvertMutator(
-      const ffi::Map<ffi::String, ffi::Array<ffi::String>>& desired_layouts, LayoutCb layout_cb)
-      : desired_layouts_(desired_layouts), layout_cb_(layout_cb) {}
+      const ffi::Map<ffi::String, ffi::Array<ffi::String>>& desired_layouts, LayoutCb layout_cb,
+      std::unordered_set<Var> follow_input = {})
+      : desired_layouts_(desired_layouts),
+        layout_cb_(layout_cb),
+        follow_input_(std::move(follow_input)) {}
+
+  /*! \brief The desired layouts of the call, from the callback when there is one. */
+  static ffi::Map<ffi::String, ffi::Array<ffi::String>> DesiredLayoutsOf(
+      const Call& call, const ffi::Map<ffi::String, ffi::Array<ffi::String>>& desired_layouts,
+      const LayoutCb& layout_cb) {
+    return layout_cb != nullptr ? layout_cb(call) : desired_layouts;
+  }
+
+  /*!
+   * \brief The number of layout conversions of the values computed in the block, so not
+   *  counting those of the constants and of the function parameters that FoldConstant or
+   *  LiftTransformParams move out of the block.
+   */
+  int64_t num_activation_transforms() const { return num_activation_transforms_; }
 
  private:
   ffi::Array<int64_t> LayoutToIntegers(const SLayout& layout) {
@@ -122,6 +145,13 @@ class LayoutConvertMutator : public ExprMutator {
           << "Cannot convert when exactly one of the layouts is unknown";
       const auto* tensor = GetTypeAs<TensorTypeNode>(expr);
       TVM_FFI_ICHECK(tensor != nullptr) << "Expect a tensor, but got: " << expr;
+      if (const auto* var = expr.as<VarNode>()) {
+        if (var->IsInstance<DataflowVarNode>() || var_layout_map_.count(ffi::GetRef<Var>(var))) {
+          ++num_activation_transforms_;
+        }
+      } else if (!expr->IsInstance<ConstantNode>()) {
+        ++num_activation_transforms_;
+      }
 
       if (from.LeafValue()->layout.ndim() == to.LeafValue()->layout.ndim()) {
         SLayout axes = TransposeLike(InitialLayoutDecision(tensor->ndim)->layout,
@@ -202,7 +232,7 @@ class LayoutConvertMutator : public ExprMutator {
   ffi::Optional<InferLayoutOutput> GetInferLayoutInfo(
       const CallNode* call_node,
       const ffi::Map<ffi::String, ffi::Array<ffi::String>>& desired_layouts,
-      const LayoutCb& layout_cb, const VarLayoutMap& var_layout_map) {
+      const LayoutCb& layout_cb, const VarLayoutMap& var_layout_map, bool follow_input) {
     const OpNode* op_node = call_node->op.as<OpNode>();
     if (op_node == nullptr) return std::nullopt;
     Op op = ffi::GetRef<Op>(op_node).as_or_throw<Op>();
@@ -211,12 +241,10 @@ class LayoutConvertMutator : public ExprMutator {
       // If the op has FRelaxInferLayout, and all the input tensors have known ndim
       FRelaxInferLayout f = attr_map[op];
       auto call = ffi::GetRef<Call>(call_node);
-      if (layout_cb != nullptr) {
-        auto custom_layouts = layout_cb(call);
-        return f(call, custom_layouts, var_layout_map);
-      } else {
-        return f(call, desired_layouts, var_layout_map);
+      if (follow_input) {
+        return f(call, {}, var_layout_map);
       }
+      return f(call, DesiredLayoutsOf(call, desired_layouts, layout_cb), var_layout_map);
     } else {
       // Otherwise, we use the default policy.
       return std::nullopt;
@@ -225,7 +253,8 @@ class LayoutConvertMutator : public ExprMutator {
 
   void VisitBinding_(const VarBindingNode* binding, const CallNode* call_node) final {
     ffi::Optional<InferLayoutOutput> res =
-        GetInferLayoutInfo(call_node, desired_layouts_, layout_cb_, var_layout_map_);
+        GetInferLayoutInfo(call_node, desired_layouts_, layout_cb_, var_layout_map_,
+                           follow_input_.count(binding->var) != 0);
     ffi::ObjectPtr<CallNode> new_call = ffi::make_object<CallNode>(*call_node);
     new_call->ty = Type::Missing();
     if (!res.has_value() ||
@@ -342,22 +371,141 @@ class LayoutConvertMutator : public ExprMutator {
   std::unordered_map<Var, NLayout> var_layout_map_;
   ffi::Map<ffi::String, ffi::Array<ffi::String>> desired_layouts_;
   LayoutCb layout_cb_;
+  std::unordered_set<Var> follow_input_;
+  int64_t num_activation_transforms_ = 0;
 };  // namespace relax
 
+/*!
+ * \brief Graph-level layout assignment of a dataflow block.
+ *
+ * Applying every desired layout op by op leaves round-trip transposes wherever a converted op
+ * neighbors ops that do not convert, e.g. a lone conv2d in an attention block. The planner
+ * instead labels each call that has a desired layout as either converted or following the
+ * layout of its inputs, and minimizes
+ *
+ *   cost = #activation transforms - sum of the gains of the converted calls,
+ *
+ * where the transforms are counted on the block the mutator produces for the labeling, and the
+ * gain of a call is the kernel time its desired layout saves in units of one layout transform.
+ * The gain is 1 by default, and the global function named by `relax.ConvertLayout.cost_hook`
+ * overrides it, e.g. with latencies from meta-schedule database records. The labeling is found by
+ * local search over single flips, started from both all-converted and none-converted, which
+ * keeps the solution to a single mutator run per candidate flip.
+ */
+class LayoutPlanner {
+ public:
+  using FGain = ffi::TypedFunction<double(Call, ffi::Map<ffi::String, ffi::Array<ffi::String>>)>;
+
+  LayoutPlanner(const ffi::Map<ffi::String, ffi::Array<ffi::String>>& desired_layouts,
+                LayoutCb layout_cb, ffi::Optional<FGain> fgain)
+      : desired_layouts_(desired_layouts), layout_cb_(layout_cb), fgain_(std::move(fgain)) {}
+
+  /*! \brief Return the calls of the block that should follow their inputs. */
+  std::unordered_set<Var> Plan(const DataflowBlock& block) {
+    const auto attr_map = Op::GetAttrMap<FRelaxInferLayout>("FRelaxInferLayout");
+    for (const Binding& binding : block->bindings) {
+      const auto* var_binding = binding.as<VarBindingNode>();
+      if (var_binding == nullptr) continue;
+      const auto* call = var_binding->value.as<CallNode>();
+      if (call == nullptr) continue;
+      const auto* op = call->op.as<OpNode>();
+      if (op == nullptr || !attr_map.count(ffi::GetRef<Op>(op))) continue;
+      Call call_ref = ffi::GetRef<Call>(call);
+      auto desired = LayoutConvertMutator::DesiredLayoutsOf(call_ref, desired_layouts_, layout_cb_);
+      if (!desired.count(op->name)) continue;
+      candidates_.push_back(var_binding->var);
+      gains_.push_back(fgain_.has_value() ? fgain_.value()(call_ref, desired) : 1.0);
+    }
+    if (candidates_.empty()) return {};
+
+    std::vector<bool> all_converted(candidates_.size(), true);
+    std::vector<bool> none_converted(candidates_.size(), false);
+    double best_cost = 0;
+    std::vector<bool> best = LocalSearch(block, all_converted, &best_cost);
+    double cost = 0;
+    std::vector<bool> other = LocalSearch(block, none_converted, &cost);
+    if (cost < best_cost) best = std::move(other);
+    return FollowInput(best);
+  }
+
+ private:
+  std::unordered_set<Var> FollowInput(const std::vector<bool>& converted) const {
+    std::unordered_set<Var> follow_input;
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      if (!converted[i]) follow_input.insert(candidates_[i]);
+    }
+    return follow_input;
+  }
+
+  double Cost(const DataflowBlock& block, const std::vector<bool>& converted) const {
+    LayoutConvertMutator mutator(desired_layouts_, layout_cb_, FollowInput(converted));
+    mutator.VisitBindingBlock(block);
+    double cost = static_cast<double>(mutator.num_activation_transforms());
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      if (converted[i]) cost -= gains_[i];
+    }
+    return cost;
+  }
+
+  std::vector<bool> LocalSearch(const DataflowBlock& block, std::vector<bool> converted,
+                                double* cost) const {
+    *cost = Cost(block, converted);
+    for (bool improved = true; improved;) {
+      improved = false;
+      for (size_t i = 0; i < converted.size(); ++i) {
+        converted[i] = !converted[i];
+        double flipped_cost = Cost(block, converted);
+        if (flipped_cost < *cost) {
+          *cost = flipped_cost;
+          improved = true;
+        } else {
+          converted[i] = !converted[i];
+        }
+      }
+    }
+    return converted;
+  }
+
+  ffi::Map<ffi::String, ffi::Array<ffi::String>> desired_layouts_;
+  LayoutCb layout_cb_;
+  ffi::Optional<FGain> fgain_;
+  std::vector<Var> candidates_;
+  std::vector<double> gains_;
+};
+
 DataflowBlock ConvertLayoutPass(const DataflowBlock& df_block,
                                 ffi::Map<ffi::String, ffi::Array<ffi::String>> desired_layouts,
-                                LayoutCb layout_cb) {
-  LayoutConvertMutator mutator(desired_layouts, layout_cb);
+                                LayoutCb layout_cb, bool plan_globally,
+                                ffi::Optional<LayoutPlanner::FGain> fgain) {
+  std::unordered_set<Var> follow_input;
+  if (plan_globally) {
+    follow_input = LayoutPlanner(desired_layouts, layout_cb, std::move(fgain)).Plan(df_block);
+  }
+  LayoutConvertMutator mutator(desired_layouts, layout_cb, std::move(follow_input));
   return mutator.VisitBindingBlock(df_block).as_or_throw<DataflowBlock>();
 }
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.ConvertLayout.plan_globally", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.ConvertLayout.cost_hook", ffi::String);
+
 Pass ConvertLayout(ffi::Map<ffi::String, ffi::Array<ffi::String>> desired_layouts,
                    LayoutCb layout_cb) {
   ffi::TypedFunction<DataflowBlock(DataflowBlock, IRModule, PassContext)> pass_func =
       [=](DataflowBlock df_block, IRModule m, PassContext pc) {
-        return ConvertLayoutPass(df_block, desired_layouts, layout_cb);
+        bool plan_globally =
+            pc->GetConfig<bool>("relax.ConvertLayout.plan_globally", false).value();
+        // The cost hook is the name of a global function, see LayoutPlanner::FGain.
+        ffi::Optional<LayoutPlanner::FGain> fgain = std::nullopt;
+        if (auto hook = pc->GetConfig<ffi::String>("relax.ConvertLayout.cost_hook")) {
+          auto func = ffi::Function::GetGlobal(hook.value());
+          TVM_FFI_CHECK(func.has_value(), ValueError)
+              << "The layout cost hook " << hook.value() << " is not a registered global function";
+          fgain = LayoutPlanner::FGain(func.value());
+        }
+        return ConvertLayoutPass(df_block, desired_layouts, layout_cb, plan_globally,
+                                 std::move(fgain));
       };
   return CreateDataflowBlockPass(pass_func, 0, "ConvertLayout", {});
 }
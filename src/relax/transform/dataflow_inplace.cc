@@ -32,8 +32,11 @@
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
 #include <tvm/relax/utils.h>
+#include <tvm/tirx/analysis.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <vector>
+
 #include "utils.h"
 
 namespace tvm {
@@ -72,22 +75,22 @@ std::unordered_set<int> GetVarAliasSetFromExpr(
 // alias id; -1 in the other operand's set does not skip checking other ids. Same var twice
 // (e.g. add(z, z)) is allowed.
 bool InplaceArgDisjointFromOtherCallArgs(
-    const CallNode* call_node, int candidate,
+    const ffi::Array<Expr>& args, int candidate,
     const std::unordered_map<Var, std::unordered_set<int>>& alias_sets) {
-  const auto* cand_var_node = call_node->args[candidate].as<VarNode>();
+  const auto* cand_var_node = args[candidate].as<VarNode>();
   if (!cand_var_node) {
     return false;
   }
-  auto cand_set = GetVarAliasSetFromExpr(call_node->args[candidate], alias_sets);
+  auto cand_set = GetVarAliasSetFromExpr(args[candidate], alias_sets);
   if (cand_set.count(-1)) {
     return false;
   }
-  for (size_t j = 0; j < call_node->args.size(); j++) {
+  for (size_t j = 0; j < args.size(); j++) {
     if (static_cast<int>(j) == candidate) {
       continue;
     }
-    const Expr& other_arg = call_node->args[j];
-    if (other_arg.same_as(call_node->args[candidate])) {
+    const Expr& other_arg = args[j];
+    if (other_arg.same_as(args[candidate])) {
       continue;
     }
     auto other_set = GetVarAliasSetFromExpr(other_arg, alias_sets);
@@ -577,11 +580,117 @@ bool InplaceConditionsMet(
 }
 
 // this is obviously not a complete list
-static std::unordered_set<std::string> SUPPORTED_OPS = {"relax.add",      "relax.subtract",
-                                                        "relax.multiply", "relax.divide",
-                                                        "relax.nn.silu",  "relax.nn.relu"};
+static std::unordered_set<std::string> SUPPORTED_OPS = {
+    "relax.add",     "relax.subtract",   "relax.multiply", "relax.divide",  "relax.maximum",
+    "relax.minimum", "relax.nn.silu",    "relax.nn.relu",  "relax.nn.gelu", "relax.nn.gelu_tanh",
+    "relax.sigmoid", "relax.tanh",       "relax.exp",      "relax.sqrt",    "relax.rsqrt",
+    "relax.negative"};
 bool OpSupportsInplace(const Op& op) { return SUPPORTED_OPS.count(op->name); }
 
+// The PrimFunc of a call_tir with a single output and without tir_vars, whose arguments are
+// the fields of a tuple, or nullopt for other calls.
+ffi::Optional<tirx::PrimFunc> GetCallTIRInplaceCandidate(const CallNode* call_node,
+                                                         const BlockBuilder& ctx) {
+  static const Op& call_tir_op = Op::Get("relax.call_tir");
+  if (!call_node->op.same_as(call_tir_op) || call_node->args.size() != 2 ||
+      !call_node->args[1]->IsInstance<TupleNode>() ||
+      call_node->ty.as<TensorTypeNode>() == nullptr) {
+    return std::nullopt;
+  }
+  const auto* gv = call_node->args[0].as<GlobalVarNode>();
+  if (gv == nullptr) return std::nullopt;
+  IRModule mod = ctx->GetContextIRModule();
+  if (!mod->ContainGlobalVar(gv->name_hint)) return std::nullopt;
+  return mod->Lookup(ffi::GetRef<GlobalVar>(gv)).as<tirx::PrimFunc>();
+}
+
+// Whether the output of the PrimFunc can be written into the storage of the inputs of
+// `input_idxs` (the candidate and the other arguments bound to the same var). This holds when
+// the inputs have the shape and dtype of the output, are never written, and every read of them
+// either is in the value stored to the output at the very same indices, or happens in a statement
+// of the body that runs before the first write of the output (e.g. the reductions of a norm).
+bool PrimFuncSupportsInplace(const tirx::PrimFunc& func, const std::vector<size_t>& input_idxs) {
+  const tirx::Buffer& output = func->buffer_map.at(func->params.back());
+  std::unordered_set<const tirx::BufferNode*> inputs;
+  for (size_t idx : input_idxs) {
+    const tirx::Buffer& input = func->buffer_map.at(func->params[idx]);
+    if (input->dtype != output->dtype || input->shape.size() != output->shape.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < input->shape.size(); ++i) {
+      if (!tirx::ExprDeepEqual()(input->shape[i], output->shape[i])) return false;
+    }
+    inputs.insert(input.get());
+  }
+
+  // Classify the accesses of one statement of the body.
+  class AccessChecker : public tirx::StmtExprVisitor {
+   public:
+    AccessChecker(const tirx::BufferNode* output,
+                  const std::unordered_set<const tirx::BufferNode*>& inputs)
+        : output_(output), inputs_(inputs) {}
+
+    void Check(const tirx::Stmt& stmt) { VisitStmt(stmt); }
+
+    bool writes_output = false;
+    bool writes_input = false;
+    bool other_input_reads = false;
+
+   private:
+    void VisitStmt_(const tirx::BufferStoreNode* op) final {
+      if (inputs_.count(op->buffer.get())) writes_input = true;
+      if (op->buffer.get() != output_) {
+        tirx::StmtExprVisitor::VisitStmt_(op);
+        return;
+      }
+      writes_output = true;
+      for (const PrimExpr& index : op->indices) VisitExpr(index);
+      store_indices_ = &op->indices;
+      VisitExpr(op->value);
+      store_indices_ = nullptr;
+    }
+
+    void VisitExpr_(const tirx::BufferLoadNode* op) final {
+      if (inputs_.count(op->buffer.get()) && !SameIndices(op->indices)) {
+        other_input_reads = true;
+      }
+      tirx::StmtExprVisitor::VisitExpr_(op);
+    }
+
+    bool SameIndices(const ffi::Array<PrimExpr>& indices) const {
+      if (store_indices_ == nullptr || store_indices_->size() != indices.size()) return false;
+      for (size_t i = 0; i < indices.size(); ++i) {
+        if (!tirx::ExprDeepEqual()((*store_indices_)[i], indices[i])) return false;
+      }
+      return true;
+    }
+
+    const tirx::BufferNode* output_;
+    const std::unordered_set<const tirx::BufferNode*>& inputs_;
+    const ffi::Array<PrimExpr>* store_indices_ = nullptr;
+  };
+
+  tirx::Stmt body = func->body;
+  if (const auto* realize = body.as<tirx::SBlockRealizeNode>()) {
+    body = realize->block->body;
+  }
+  std::vector<tirx::Stmt> stmts;
+  if (const auto* seq = body.as<tirx::SeqStmtNode>()) {
+    stmts.assign(seq->seq.begin(), seq->seq.end());
+  } else {
+    stmts.push_back(body);
+  }
+  bool output_written = false;
+  for (const tirx::Stmt& stmt : stmts) {
+    AccessChecker checker(output.get(), inputs);
+    checker.Check(stmt);
+    if (checker.writes_input) return false;
+    if (checker.other_input_reads && (output_written || checker.writes_output)) return false;
+    output_written = output_written || checker.writes_output;
+  }
+  return true;
+}
+
 /*! \brief Corresponds to a binding where at least one argument meets the conditions to be
  *  made in-place. Contains the binding index and indices of the applicable arguments
  */
@@ -684,9 +793,14 @@ FindInplaceOpportunities(const DataflowBlock& block, const ffi::Array<Var>& inpu
 
     if (auto* call_node = value.as<CallNode>()) {
       if (auto* op_node = call_node->op.as<OpNode>()) {
-        if (!OpSupportsInplace(ffi::GetRef<Op>(op_node))) {
+        // A call_tir is eligible from the access pattern of its PrimFunc, where the
+        // arguments are the fields of the tuple.
+        ffi::Optional<tirx::PrimFunc> tir_func = GetCallTIRInplaceCandidate(call_node, ctx);
+        if (!tir_func.has_value() && !OpSupportsInplace(ffi::GetRef<Op>(op_node))) {
           continue;
         }
+        ffi::Array<Expr> args =
+            tir_func.has_value() ? call_node->args[1].as<TupleNode>()->fields : call_node->args;
 
         std::unordered_set<int> candidates;
         std::unordered_set<int> exact_match_candidates;
@@ -698,8 +812,8 @@ FindInplaceOpportunities(const DataflowBlock& block, const ffi::Array<Var>& inpu
         }
 
         // Check that at least one argument matches size with the result
-        for (size_t j = 0; j < call_node->args.size(); j++) {
-          auto arg = call_node->args[j];
+        for (size_t j = 0; j < args.size(); j++) {
+          auto arg = args[j];
           for (auto target : target_ty) {
             auto [matches_size, matches_exactly] = SizeMatches(target, GetType(arg), ctx);
             if (matches_size) {
@@ -719,9 +833,19 @@ FindInplaceOpportunities(const DataflowBlock& block, const ffi::Array<Var>& inpu
         std::unordered_set<int> remove_candidates;
         for (auto candidate : candidates) {
           if (!InplaceConditionsMet(live_ranges, alias_sets, tuple_map, currently_live,
-                                    call_node->args[candidate], i) ||
-              !InplaceArgDisjointFromOtherCallArgs(call_node, candidate, alias_sets)) {
+                                    args[candidate], i) ||
+              !InplaceArgDisjointFromOtherCallArgs(args, candidate, alias_sets)) {
             remove_candidates.insert(candidate);
+            continue;
+          }
+          if (tir_func.has_value()) {
+            std::vector<size_t> input_idxs;
+            for (size_t j = 0; j < args.size(); j++) {
+              if (args[j].same_as(args[candidate])) input_idxs.push_back(j);
+            }
+            if (!PrimFuncSupportsInplace(tir_func.value(), input_idxs)) {
+              remove_candidates.insert(candidate);
+            }
           }
         }
         // (remove now to avoid modifying the list as we iterate on it)
@@ -930,16 +1054,25 @@ class ModuleInplaceTransformer : public ExprMutator {
   // (Made public for testing.)
   Call CreateInplaceCall(const Call& call, const ffi::Array<int64_t>& inplace_indices) {
     static const auto& legalize_map = Op::GetAttrMap<FLegalize>("FLegalize");
+    static const auto& call_tir_op = Op::Get("relax.call_tir");
     static const auto& call_tir_inplace_op = Op::Get("relax.call_tir_inplace");
 
-    auto op = call->op.as_or_throw<Op>();
-    auto legalized_call = legalize_map[op](builder_, call).as_or_throw<Call>();
+    // Legalize the op calls, while the call_tir of legalized modules are rewritten directly
+    bool is_call_tir = call->op.same_as(call_tir_op);
+    Call legalized_call = call;
+    if (!is_call_tir) {
+      auto op = call->op.as_or_throw<Op>();
+      legalized_call = legalize_map[op](builder_, call).as_or_throw<Call>();
+    }
     auto* legalized_call_cow = legalized_call.CopyOnWrite();
 
     // The legalized call should be call_tir. We will replace it with call_tir_inplace
     // and replace the called PrimFunc with an inplace version
     auto legal_op = legalized_call->args[0].as_or_throw<GlobalVar>();
-    legalizers_added.push_back(legal_op);
+    if (!is_call_tir) {
+      // the PrimFuncs called by call_tir may have other callers, so only those we added go
+      legalizers_added.push_back(legal_op);
+    }
     auto inline_legal_op_name = legal_op->name_hint + "_inplace";
 
     auto mod = builder_->GetContextIRModule();
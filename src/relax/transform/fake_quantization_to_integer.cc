@@ -0,0 +1,368 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/transform/fake_quantization_to_integer.cc
+ * \brief Fold dequantize-op-quantize chains into integer kernels.
+ *
+ * Frontends express quantized models as float operators between `dequantize` and `quantize`.
+ * Legalized as written, every operator round-trips through float32. This pass rewrites
+ *
+ *     quantize(relu?(matmul(dequantize(a), dequantize(w)) + dequantize(bias)?))
+ *     quantize(dequantize(x))
+ *
+ * into an int32-accumulating matmul on the quantized operands, followed by a fixed-point
+ * requantization: the float multiplier `M = s_a * s_w / s_y` becomes `M0 * 2^-shift` with a
+ * 31-bit `M0`, applied as a 64-bit multiply, a rounding right shift, the output zero point and a
+ * clip to the output range. Zero points of the operands are applied through row and column sums,
+ * so the matmul itself stays on the narrow integer inputs.
+ *
+ * Scales and zero points must be constants. Per-channel scales are supported along the output
+ * channel; chains that do not fit are left unchanged.
+ */
+
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/attrs/qdq.h>
+#include <tvm/relax/dataflow_matcher.h>
+#include <tvm/relax/expr.h>
+#include <tvm/relax/transform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../op/tensor/binary.h"
+#include "../op/tensor/datatype.h"
+#include "../op/tensor/linear_algebra.h"
+#include "../op/tensor/statistical.h"
+#include "../op/tensor/unary.h"
+#include "utils.h"
+
+namespace tvm {
+namespace relax {
+
+namespace {
+
+/*! \brief The values of a constant float or integer tensor, or std::nullopt. */
+std::optional<std::vector<double>> ReadConstant(const Expr& expr) {
+  const auto* constant = expr.as<ConstantNode>();
+  if (constant == nullptr || constant->data->device.device_type != kDLCPU) return std::nullopt;
+  const runtime::Tensor& data = constant->data;
+  int64_t numel = 1;
+  for (int i = 0; i < data->ndim; ++i) numel *= data->shape[i];
+  std::vector<double> values(numel);
+  DLDataType dtype = data->dtype;
+  for (int64_t i = 0; i < numel; ++i) {
+    if (dtype == DLDataType{kDLFloat, 32, 1}) {
+      values[i] = static_cast<const float*>(data->data)[i];
+    } else if (dtype == DLDataType{kDLInt, 8, 1}) {
+      values[i] = static_cast<const int8_t*>(data->data)[i];
+    } else if (dtype == DLDataType{kDLUInt, 8, 1}) {
+      values[i] = static_cast<const uint8_t*>(data->data)[i];
+    } else if (dtype == DLDataType{kDLInt, 16, 1}) {
+      values[i] = static_cast<const int16_t*>(data->data)[i];
+    } else if (dtype == DLDataType{kDLUInt, 16, 1}) {
+      values[i] = static_cast<const uint16_t*>(data->data)[i];
+    } else if (dtype == DLDataType{kDLInt, 32, 1}) {
+      values[i] = static_cast<const int32_t*>(data->data)[i];
+    } else {
+      return std::nullopt;
+    }
+  }
+  return values;
+}
+
+/*! \brief The range of an integer data type. */
+std::optional<std::pair<int64_t, int64_t>> GetIntegerRange(DLDataType dtype) {
+  if (dtype.lanes != 1 || dtype.bits > 32) return std::nullopt;
+  if (dtype.code == kDLInt) {
+    return std::make_pair(-(int64_t{1} << (dtype.bits - 1)), (int64_t{1} << (dtype.bits - 1)) - 1);
+  } else if (dtype.code == kDLUInt) {
+    return std::make_pair(int64_t{0}, (int64_t{1} << dtype.bits) - 1);
+  }
+  return std::nullopt;
+}
+
+/*! \brief An int64 constant of the given values, shaped to broadcast along `axis` of `ndim`. */
+Constant MakeInt64Constant(const std::vector<int64_t>& values, int axis, int ndim) {
+  std::vector<int64_t> shape;
+  if (values.size() > 1) {
+    shape.push_back(static_cast<int64_t>(values.size()));
+    for (int i = axis + 1; i < ndim; ++i) shape.push_back(1);
+  }
+  runtime::Tensor data =
+      runtime::Tensor::Empty(ffi::Shape(shape), DLDataType{kDLInt, 64, 1}, {kDLCPU, 0});
+  std::copy(values.begin(), values.end(), static_cast<int64_t*>(data->data));
+  return Constant(data);
+}
+
+/*!
+ * \brief Requantize an int32 tensor by fixed-point multipliers.
+ *
+ * \param acc The int32 tensor, with the input zero points already subtracted.
+ * \param multipliers The float multipliers, one or one per channel along `axis`.
+ * \param output_zero_points The zero points of the output, one or one per channel.
+ * \param axis The channel axis of `acc`.
+ * \param ndim The number of dimensions of `acc`.
+ * \param out_dtype The integer output type.
+ * \param relu Whether the output is clipped below its zero point as well.
+ * \return The requantized tensor, or std::nullopt if a multiplier is out of range.
+ */
+std::optional<Expr> Requantize(Expr acc, const std::vector<double>& multipliers,
+                               const std::vector<double>& output_zero_points, int axis, int ndim,
+                               DLDataType out_dtype, bool relu) {
+  auto range = GetIntegerRange(out_dtype);
+  if (!range.has_value()) return std::nullopt;
+  size_t channels = std::max(multipliers.size(), output_zero_points.size());
+  std::vector<int64_t> m0(channels), shift(channels), rounding(channels), zero_points(channels);
+  for (size_t i = 0; i < channels; ++i) {
+    double multiplier = multipliers[multipliers.size() == 1 ? 0 : i];
+    if (!(multiplier > 0) || !std::isfinite(multiplier)) return std::nullopt;
+    // multiplier = fraction * 2^exponent with fraction in [0.5, 1).
+    int exponent = 0;
+    double fraction = std::frexp(multiplier, &exponent);
+    int64_t q31 = static_cast<int64_t>(std::llround(fraction * (int64_t{1} << 31)));
+    if (q31 == (int64_t{1} << 31)) {
+      q31 /= 2;
+      ++exponent;
+    }
+    int64_t right_shift = 31 - exponent;
+    // The product of an int32 accumulator and a 31-bit multiplier fits in 62 bits.
+    if (right_shift > 62) {
+      q31 >>= right_shift - 62;
+      right_shift = 62;
+    }
+    if (right_shift < 1) return std::nullopt;
+    m0[i] = q31;
+    shift[i] = right_shift;
+    rounding[i] = int64_t{1} << (right_shift - 1);
+    zero_points[i] = std::llround(output_zero_points[output_zero_points.size() == 1 ? 0 : i]);
+  }
+  Expr wide = astype(acc, DLDataType{kDLInt, 64, 1});
+  Expr scaled = multiply(wide, MakeInt64Constant(m0, axis, ndim));
+  Expr shifted = right_shift(add(scaled, MakeInt64Constant(rounding, axis, ndim)),
+                             MakeInt64Constant(shift, axis, ndim));
+  Expr result = add(shifted, MakeInt64Constant(zero_points, axis, ndim));
+  int64_t lower = range->first;
+  if (relu) {
+    // The zero point is where relu clips; per-channel zero points cannot share one bound.
+    if (zero_points.size() != 1 && std::adjacent_find(zero_points.begin(), zero_points.end(),
+                                                      std::not_equal_to<>()) != zero_points.end()) {
+      return std::nullopt;
+    }
+    lower = std::max(lower, zero_points[0]);
+  }
+  result = clip(result, IntImm::Int64(lower), IntImm::Int64(range->second));
+  return astype(result, out_dtype);
+}
+
+struct QuantizeParams {
+  std::vector<double> scale;
+  std::vector<double> zero_point;
+  int axis;
+};
+
+/*! \brief The constant quantization parameters of a qdq call, or std::nullopt. */
+std::optional<QuantizeParams> GetQuantizeParams(const Expr& call_expr) {
+  const auto* call = call_expr.as<CallNode>();
+  const auto* attrs = call->attrs.as<QuantizeAttrs>();
+  const auto* data_ty = call->args[0]->ty.as<TensorTypeNode>();
+  if (attrs == nullptr || data_ty == nullptr || data_ty->IsUnknownNdim()) return std::nullopt;
+  auto scale = ReadConstant(call->args[1]);
+  auto zero_point = ReadConstant(call->args[2]);
+  if (!scale.has_value() || !zero_point.has_value()) return std::nullopt;
+  int axis = attrs->axis < 0 ? attrs->axis + data_ty->ndim : attrs->axis;
+  return QuantizeParams{scale.value(), zero_point.value(), axis};
+}
+
+/*! \brief The dtype of a tensor expression, or std::nullopt. */
+std::optional<DLDataType> GetDType(const Expr& expr) {
+  const auto* ty = expr->ty.as<TensorTypeNode>();
+  if (ty == nullptr || ty->IsUnknownDtype()) return std::nullopt;
+  return ty->dtype.value()->dtype;
+}
+
+/*! \brief Whether all values are zero. */
+bool AllZero(const std::vector<double>& values) {
+  return std::all_of(values.begin(), values.end(), [](double v) { return v == 0; });
+}
+
+std::tuple<DFPattern, ffi::TypedFunction<Expr(Expr, ffi::Map<DFPattern, Expr>)>>
+CreateMatmulPatterns() {
+  auto pat_a = WildcardPattern();
+  auto pat_w = WildcardPattern();
+  auto pat_bias = WildcardPattern();
+  auto pat_dq_a = IsOp("relax.dequantize")(pat_a, WildcardPattern(), WildcardPattern());
+  auto pat_dq_w = IsOp("relax.dequantize")(pat_w, WildcardPattern(), WildcardPattern());
+  auto pat_dq_bias = IsOp("relax.dequantize")(pat_bias, WildcardPattern(), WildcardPattern());
+  auto pat_matmul = IsOp("relax.matmul")(pat_dq_a, pat_dq_w);
+  auto pat_biased = IsOp("relax.add")(pat_matmul, pat_dq_bias);
+  auto pat_core = pat_matmul | pat_biased;
+  auto pat_relu = IsOp("relax.nn.relu")(pat_core);
+  auto pat_quantize =
+      IsOp("relax.quantize")(pat_core | pat_relu, WildcardPattern(), WildcardPattern());
+
+  auto rewriter = [=](Expr expr, ffi::Map<DFPattern, Expr> matches) -> Expr {
+    Expr a = matches[pat_a];
+    Expr w = matches[pat_w];
+    auto a_dtype = GetDType(a);
+    auto w_dtype = GetDType(w);
+    const auto* a_ty = a->ty.as<TensorTypeNode>();
+    const auto* w_ty = w->ty.as<TensorTypeNode>();
+    const auto* out_ty = expr->ty.as<TensorTypeNode>();
+    if (!a_dtype.has_value() || !w_dtype.has_value() || !GetIntegerRange(*a_dtype) ||
+        !GetIntegerRange(*w_dtype) || a_dtype->bits > 16 || w_dtype->bits > 16 ||
+        a_ty->IsUnknownNdim() || w_ty->ndim < 2 || out_ty == nullptr || out_ty->IsUnknownNdim()) {
+      return expr;
+    }
+    auto a_params = GetQuantizeParams(matches[pat_dq_a]);
+    auto w_params = GetQuantizeParams(matches[pat_dq_w]);
+    auto y_params = GetQuantizeParams(expr);
+    if (!a_params || !w_params || !y_params) return expr;
+    int ndim = out_ty->ndim;
+    // The activation must be per-tensor; the weight and the output may be per output channel.
+    if (a_params->scale.size() != 1 || a_params->zero_point.size() != 1) return expr;
+    if (w_params->scale.size() != 1 && w_params->axis != w_ty->ndim - 1) return expr;
+    if (y_params->scale.size() != 1 && y_params->axis != ndim - 1) return expr;
+    if (w_params->zero_point.size() != 1) return expr;
+    double a_zero_point = a_params->zero_point[0];
+    double w_zero_point = w_params->zero_point[0];
+
+    // acc = (a - za) @ (w - zw), expanded so that the matmul runs on the quantized inputs.
+    DLDataType i32{kDLInt, 32, 1};
+    Expr acc;
+    if (*a_dtype == *w_dtype) {
+      acc = matmul(a, w, i32);
+    } else {
+      acc = matmul(astype(a, i32), astype(w, i32), i32);
+    }
+    if (a_zero_point != 0) {
+      Expr w_sums = sum(astype(w, i32), ffi::Array<int64_t>{-2}, /*keepdims=*/true);
+      acc = subtract(acc, multiply(w_sums, relax::MakeConstantScalar(a_zero_point, i32)));
+    }
+    if (w_zero_point != 0) {
+      Expr a_sums = sum(astype(a, i32), ffi::Array<int64_t>{-1}, /*keepdims=*/true);
+      acc = subtract(acc, multiply(a_sums, relax::MakeConstantScalar(w_zero_point, i32)));
+    }
+    if (a_zero_point != 0 && w_zero_point != 0) {
+      auto a_shape = a_ty->GetShape();
+      const auto* k = a_shape.has_value() ? a_shape.value().back().as<IntImmNode>() : nullptr;
+      if (k == nullptr) return expr;
+      acc = add(acc, relax::MakeConstantScalar(k->value * a_zero_point * w_zero_point, i32));
+    }
+
+    // The product scale of the accumulator, per output channel if the weight is.
+    std::vector<double> acc_scale;
+    for (double w_scale : w_params->scale) acc_scale.push_back(a_params->scale[0] * w_scale);
+    if (matches.count(pat_biased)) {
+      Expr bias = matches[pat_bias];
+      auto bias_params = GetQuantizeParams(matches[pat_dq_bias]);
+      auto bias_dtype = GetDType(bias);
+      if (!bias_params || !bias_dtype || !GetIntegerRange(*bias_dtype) ||
+          !AllZero(bias_params->zero_point)) {
+        return expr;
+      }
+      // The bias must be quantized with the accumulator scale to be added as is.
+      for (size_t i = 0; i < std::max(acc_scale.size(), bias_params->scale.size()); ++i) {
+        double expected = acc_scale[acc_scale.size() == 1 ? 0 : i];
+        double actual = bias_params->scale[bias_params->scale.size() == 1 ? 0 : i];
+        if (std::abs(actual - expected) > 1e-6 * expected) return expr;
+      }
+      acc = add(acc, astype(bias, i32));
+    }
+
+    size_t channels = std::max(acc_scale.size(), y_params->scale.size());
+    std::vector<double> multipliers(channels);
+    for (size_t i = 0; i < channels; ++i) {
+      multipliers[i] = acc_scale[acc_scale.size() == 1 ? 0 : i] /
+                       y_params->scale[y_params->scale.size() == 1 ? 0 : i];
+    }
+    const auto* attrs = expr.as<CallNode>()->attrs.as<QuantizeAttrs>();
+    auto result = Requantize(acc, multipliers, y_params->zero_point, ndim - 1, ndim,
+                             attrs->out_dtype, matches.count(pat_relu) > 0);
+    return result.value_or(expr);
+  };
+  return {pat_quantize, rewriter};
+}
+
+std::tuple<DFPattern, ffi::TypedFunction<Expr(Expr, ffi::Map<DFPattern, Expr>)>>
+CreateRequantizePatterns() {
+  auto pat_x = WildcardPattern();
+  auto pat_dq = IsOp("relax.dequantize")(pat_x, WildcardPattern(), WildcardPattern());
+  auto pat_quantize = IsOp("relax.quantize")(pat_dq, WildcardPattern(), WildcardPattern());
+
+  auto rewriter = [=](Expr expr, ffi::Map<DFPattern, Expr> matches) -> Expr {
+    Expr x = matches[pat_x];
+    auto x_dtype = GetDType(x);
+    const auto* x_ty = x->ty.as<TensorTypeNode>();
+    if (!x_dtype || !GetIntegerRange(*x_dtype) || x_ty->IsUnknownNdim()) return expr;
+    auto x_params = GetQuantizeParams(matches[pat_dq]);
+    auto y_params = GetQuantizeParams(expr);
+    if (!x_params || !y_params) return expr;
+    if (x_params->scale.size() != 1 && y_params->scale.size() != 1 &&
+        x_params->axis != y_params->axis) {
+      return expr;
+    }
+    if (x_params->zero_point.size() != 1) return expr;
+    int axis = x_params->scale.size() != 1 ? x_params->axis : y_params->axis;
+    DLDataType i32{kDLInt, 32, 1};
+    Expr acc = astype(x, i32);
+    if (x_params->zero_point[0] != 0) {
+      acc = subtract(acc, relax::MakeConstantScalar(x_params->zero_point[0], i32));
+    }
+    size_t channels = std::max(x_params->scale.size(), y_params->scale.size());
+    std::vector<double> multipliers(channels);
+    for (size_t i = 0; i < channels; ++i) {
+      multipliers[i] = x_params->scale[x_params->scale.size() == 1 ? 0 : i] /
+                       y_params->scale[y_params->scale.size() == 1 ? 0 : i];
+    }
+    const auto* attrs = expr.as<CallNode>()->attrs.as<QuantizeAttrs>();
+    auto result = Requantize(acc, multipliers, y_params->zero_point, axis, x_ty->ndim,
+                             attrs->out_dtype, /*relu=*/false);
+    return result.value_or(expr);
+  };
+  return {pat_quantize, rewriter};
+}
+
+}  // namespace
+
+namespace transform {
+
+Pass FakeQuantizationToInteger() {
+  auto pass_func = [=](Function func, IRModule mod, PassContext pc) {
+    auto [matmul_pattern, matmul_rewriter] = CreateMatmulPatterns();
+    func = RewriteCall(matmul_pattern, matmul_rewriter, func);
+    auto [requantize_pattern, requantize_rewriter] = CreateRequantizePatterns();
+    return RewriteCall(requantize_pattern, requantize_rewriter, func);
+  };
+  return CreateFunctionPass(pass_func, 0, "FakeQuantizationToInteger", {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.transform.FakeQuantizationToInteger", FakeQuantizationToInteger);
+}
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
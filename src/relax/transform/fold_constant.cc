@@ -27,16 +27,434 @@
 #include <tvm/relax/transform.h>
 #include <tvm/relax/type.h>
 #include <tvm/runtime/logging.h>
+#include <tvm/tirx/expr_functor.h>
 #include <tvm/tirx/function.h>
 #include <tvm/tirx/op.h>
+#include <tvm/tirx/stmt_functor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 namespace relax {
 
+/*!
+ * \brief An interpreter of tiny PrimFuncs, which folds them without the LLVM JIT compilation
+ * that costs far more than executing them.
+ *
+ * It runs the loop nests, blocks, stores and arithmetic of elementwise and broadcast PrimFuncs
+ * over scalars of float32, float64, integer and boolean buffers. Every result is rounded to the
+ * dtype of its expression, so the results match the compiled PrimFunc. Anything else, such as
+ * calls to math intrinsics or reductions, makes the interpretation fail, in which case the
+ * PrimFunc is compiled instead.
+ */
+class TinyPrimFuncInterpreter : private tirx::ExprFunctor<double(const Expr&)>,
+                                private tirx::StmtFunctor<void(const tirx::Stmt&)> {
+ public:
+  /*! \brief The maximum total number of elements of the buffers of an interpreted PrimFunc. */
+  static constexpr int64_t kMaxElements = 4096;
+  /*! \brief The maximum number of loop iterations and stores of an interpreted PrimFunc. */
+  static constexpr int64_t kMaxSteps = 64 * kMaxElements;
+
+  /*!
+   * \brief Check if the PrimFunc only takes small buffers of the supported dtypes.
+   * \note It does not check the body, which may still fail the interpretation.
+   */
+  static bool IsTiny(const tirx::PrimFunc& func) {
+    int64_t num_elements = 0;
+    for (const tirx::Var& param : func->params) {
+      ffi::Optional<tirx::Buffer> buffer = func->buffer_map.Get(param);
+      if (!buffer.has_value() || !IsSupportedDType(buffer.value()->dtype->dtype) ||
+          !buffer.value()->strides.empty()) {
+        return false;
+      }
+      int64_t buffer_elements = 1;
+      for (const PrimExpr& dim : buffer.value()->shape) {
+        const auto* int_dim = dim.as<IntImmNode>();
+        if (int_dim == nullptr || int_dim->value < 0) return false;
+        buffer_elements *= int_dim->value;
+        if (buffer_elements > kMaxElements) return false;
+      }
+      num_elements += buffer_elements;
+      if (num_elements > kMaxElements) return false;
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Interpret the PrimFunc on the given tensors.
+   * \return Whether the interpretation succeeded. The output tensors are partially written
+   * when it fails.
+   */
+  static bool Run(const tirx::PrimFunc& func, const std::vector<runtime::Tensor>& args) {
+    try {
+      TinyPrimFuncInterpreter interpreter;
+      TVM_FFI_ICHECK_EQ(func->params.size(), args.size());
+      for (size_t i = 0; i < args.size(); ++i) {
+        interpreter.BindTensor(func->buffer_map.at(func->params[i]), args[i]);
+      }
+      interpreter.VisitStmt(func->body);
+      return true;
+    } catch (const ffi::Error& err) {
+      DLOG(INFO) << "Cannot interpret function " << func << ", Error message: " << err.what();
+      return false;
+    }
+  }
+
+ private:
+  /*! \brief The tensor bound to a buffer of the PrimFunc. */
+  struct BoundTensor {
+    char* data;
+    DLDataType dtype;
+    std::vector<int64_t> shape;
+  };
+
+  static bool IsSupportedDType(DLDataType dtype) {
+    if (dtype.lanes != 1) return false;
+    switch (dtype.code) {
+      case kDLFloat:
+        return dtype.bits == 32 || dtype.bits == 64;
+      case kDLInt:
+      case kDLUInt:
+        return dtype.bits == 8 || dtype.bits == 16 || dtype.bits == 32 || dtype.bits == 64;
+      case kDLBool:
+        return dtype.bits == 8;
+      default:
+        return false;
+    }
+  }
+
+  /*!
+   * \brief Round a value to the given dtype, the way storing it in the dtype does.
+   * Integers are held as doubles, which is exact for every integer reached by the tiny
+   * PrimFuncs up to 2^53.
+   */
+  static double Round(double value, DLDataType dtype) {
+    TVM_FFI_CHECK(IsSupportedDType(dtype), ValueError)
+        << "Unsupported dtype " << dtype << " in the interpreter";
+    if (dtype.code == kDLFloat) {
+      return dtype.bits == 32 ? static_cast<double>(static_cast<float>(value)) : value;
+    }
+    if (dtype.code == kDLBool) {
+      return value != 0 ? 1 : 0;
+    }
+    TVM_FFI_CHECK(std::isfinite(value) && std::fabs(value) < 9007199254740992.0, ValueError)
+        << "Integer value out of the range of the interpreter";
+    int64_t int_value = static_cast<int64_t>(value);
+    if (dtype.bits == 64) {
+      TVM_FFI_CHECK(dtype.code == kDLInt || int_value >= 0, ValueError)
+          << "Negative value wrapped to uint64";
+      return value;
+    }
+    // Wrap the value around the bit width of the dtype.
+    uint64_t mask = (uint64_t{1} << dtype.bits) - 1;
+    uint64_t bits = static_cast<uint64_t>(int_value) & mask;
+    if (dtype.code == kDLInt && (bits >> (dtype.bits - 1)) != 0) {
+      bits |= ~mask;
+    }
+    return static_cast<double>(static_cast<int64_t>(bits));
+  }
+
+  static DLDataType DTypeOf(const ExprNode* op) {
+    return op->ty.as_or_throw<PrimType>()->dtype;
+  }
+
+  static bool IsFloat(const PrimExpr& expr) { return expr.ty().MatchesCode(kDLFloat); }
+
+  void BindTensor(const tirx::Buffer& buffer, const runtime::Tensor& tensor) {
+    TVM_FFI_CHECK(tensor->device.device_type == kDLCPU && tensor.IsContiguous(), ValueError)
+        << "The interpreter only takes contiguous CPU tensors";
+    TVM_FFI_CHECK(tensor.DataType() == buffer->dtype->dtype, ValueError)
+        << "The tensor dtype mismatches the buffer " << buffer->name;
+    TVM_FFI_CHECK_EQ(tensor->ndim, static_cast<int>(buffer->shape.size()), ValueError);
+    BoundTensor bound{static_cast<char*>(tensor->data) + tensor->byte_offset, tensor->dtype,
+                      std::vector<int64_t>(tensor->shape, tensor->shape + tensor->ndim)};
+    for (int i = 0; i < tensor->ndim; ++i) {
+      TVM_FFI_CHECK_EQ(bound.shape[i], buffer->shape[i].as<IntImmNode>()->value, ValueError)
+          << "The tensor shape mismatches the buffer " << buffer->name;
+    }
+    tensors_[buffer.get()] = std::move(bound);
+  }
+
+  /*! \brief Get the address of the buffer element at the indices. */
+  char* ElementAddress(const tirx::Buffer& buffer, const ffi::Array<PrimExpr>& indices) {
+    auto it = tensors_.find(buffer.get());
+    TVM_FFI_CHECK(it != tensors_.end(), ValueError)
+        << "The interpreter only accesses the parameter buffers, but got " << buffer->name;
+    const BoundTensor& tensor = it->second;
+    TVM_FFI_CHECK_EQ(indices.size(), tensor.shape.size(), ValueError);
+    int64_t offset = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      TVM_FFI_CHECK(!IsFloat(indices[i]), ValueError) << "Float index " << indices[i];
+      int64_t index = static_cast<int64_t>(VisitExpr(indices[i]));
+      TVM_FFI_CHECK(index >= 0 && index < tensor.shape[i], ValueError)
+          << "Index " << index << " out of the bound of buffer " << buffer->name;
+      offset = offset * tensor.shape[i] + index;
+    }
+    return tensor.data + offset * (tensor.dtype.bits / 8);
+  }
+
+  static double Load(const char* addr, DLDataType dtype) {
+    switch (dtype.code) {
+      case kDLFloat:
+        return dtype.bits == 32 ? *reinterpret_cast<const float*>(addr)
+                                : *reinterpret_cast<const double*>(addr);
+      case kDLInt:
+        switch (dtype.bits) {
+          case 8:
+            return *reinterpret_cast<const int8_t*>(addr);
+          case 16:
+            return *reinterpret_cast<const int16_t*>(addr);
+          case 32:
+            return *reinterpret_cast<const int32_t*>(addr);
+          default:
+            return static_cast<double>(*reinterpret_cast<const int64_t*>(addr));
+        }
+      case kDLUInt:
+        switch (dtype.bits) {
+          case 8:
+            return *reinterpret_cast<const uint8_t*>(addr);
+          case 16:
+            return *reinterpret_cast<const uint16_t*>(addr);
+          case 32:
+            return *reinterpret_cast<const uint32_t*>(addr);
+          default:
+            return static_cast<double>(*reinterpret_cast<const uint64_t*>(addr));
+        }
+      default:
+        return *reinterpret_cast<const uint8_t*>(addr) != 0 ? 1 : 0;
+    }
+  }
+
+  static void Store(char* addr, DLDataType dtype, double value) {
+    value = Round(value, dtype);
+    switch (dtype.code) {
+      case kDLFloat:
+        if (dtype.bits == 32) {
+          *reinterpret_cast<float*>(addr) = static_cast<float>(value);
+        } else {
+          *reinterpret_cast<double*>(addr) = value;
+        }
+        return;
+      case kDLInt:
+        switch (dtype.bits) {
+          case 8:
+            *reinterpret_cast<int8_t*>(addr) = static_cast<int8_t>(value);
+            return;
+          case 16:
+            *reinterpret_cast<int16_t*>(addr) = static_cast<int16_t>(value);
+            return;
+          case 32:
+            *reinterpret_cast<int32_t*>(addr) = static_cast<int32_t>(value);
+            return;
+          default:
+            *reinterpret_cast<int64_t*>(addr) = static_cast<int64_t>(value);
+            return;
+        }
+      case kDLUInt:
+        switch (dtype.bits) {
+          case 8:
+            *reinterpret_cast<uint8_t*>(addr) = static_cast<uint8_t>(value);
+            return;
+          case 16:
+            *reinterpret_cast<uint16_t*>(addr) = static_cast<uint16_t>(value);
+            return;
+          case 32:
+            *reinterpret_cast<uint32_t*>(addr) = static_cast<uint32_t>(value);
+            return;
+          default:
+            *reinterpret_cast<uint64_t*>(addr) = static_cast<uint64_t>(value);
+            return;
+        }
+      default:
+        *reinterpret_cast<uint8_t*>(addr) = value != 0 ? 1 : 0;
+        return;
+    }
+  }
+
+  void Step() {
+    TVM_FFI_CHECK(++num_steps_ <= kMaxSteps, ValueError)
+        << "The PrimFunc takes too many steps to interpret";
+  }
+
+  // Expressions.
+  double VisitExpr_(const IntImmNode* op) final { return static_cast<double>(op->value); }
+  double VisitExpr_(const FloatImmNode* op) final { return op->value; }
+  double VisitExpr_(const tirx::VarNode* op) final {
+    auto it = var_values_.find(op);
+    TVM_FFI_CHECK(it != var_values_.end(), ValueError) << "Unbound variable " << op->name;
+    return it->second;
+  }
+  double VisitExpr_(const tirx::BufferLoadNode* op) final {
+    TVM_FFI_CHECK(!op->predicate.has_value(), ValueError) << "Predicated load";
+    return Load(ElementAddress(op->buffer, op->indices), op->buffer->dtype->dtype);
+  }
+  double VisitExpr_(const tirx::CastNode* op) final {
+    double value = VisitExpr(op->value);
+    DLDataType dtype = DTypeOf(op);
+    if (IsFloat(op->value) && dtype.code != kDLFloat && dtype.code != kDLBool) {
+      // Float-to-integer casts truncate toward zero.
+      value = std::trunc(value);
+    }
+    return Round(value, dtype);
+  }
+  double VisitExpr_(const tirx::AddNode* op) final {
+    return Round(VisitExpr(op->a) + VisitExpr(op->b), DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::SubNode* op) final {
+    return Round(VisitExpr(op->a) - VisitExpr(op->b), DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::MulNode* op) final {
+    return Round(VisitExpr(op->a) * VisitExpr(op->b), DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::DivNode* op) final {
+    double a = VisitExpr(op->a);
+    double b = VisitExpr(op->b);
+    if (IsFloat(op->a)) {
+      return Round(a / b, DTypeOf(op));
+    }
+    TVM_FFI_CHECK(b != 0, ValueError) << "Integer division by zero";
+    return Round(std::trunc(a / b), DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::ModNode* op) final {
+    TVM_FFI_CHECK(!IsFloat(op->a), ValueError) << "Float modulo";
+    double b = VisitExpr(op->b);
+    TVM_FFI_CHECK(b != 0, ValueError) << "Integer modulo by zero";
+    return Round(std::fmod(VisitExpr(op->a), b), DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::FloorDivNode* op) final {
+    TVM_FFI_CHECK(!IsFloat(op->a), ValueError) << "Float floordiv";
+    double a = VisitExpr(op->a);
+    double b = VisitExpr(op->b);
+    TVM_FFI_CHECK(b != 0, ValueError) << "Integer division by zero";
+    double quotient = std::trunc(a / b);
+    if (quotient * b != a && ((a < 0) != (b < 0))) {
+      quotient -= 1;
+    }
+    return Round(quotient, DTypeOf(op));
+  }
+  double VisitExpr_(const tirx::FloorModNode* op) final {
+    TVM_FFI_CHECK(!IsFloat(op->a), ValueError) << "Float floormod";
+    double a = VisitExpr(op->a);
+    double b = VisitExpr(op->b);
+    TVM_FFI_CHECK(b != 0, ValueError) << "Integer modulo by zero";
+    double remainder = std::fmod(a, b);
+    if (remainder != 0 && ((remainder < 0) != (b < 0))) {
+      remainder += b;
+    }
+    return Round(remainder, DTypeOf(op));
+  }
+  // Min and max select the same operands as the compiled comparisons when one of them is NaN.
+  double VisitExpr_(const tirx::MinNode* op) final {
+    double a = VisitExpr(op->a);
+    double b = VisitExpr(op->b);
+    return a < b ? a : b;
+  }
+  double VisitExpr_(const tirx::MaxNode* op) final {
+    double a = VisitExpr(op->a);
+    double b = VisitExpr(op->b);
+    return a > b ? a : b;
+  }
+  double VisitExpr_(const tirx::EQNode* op) final { return VisitExpr(op->a) == VisitExpr(op->b); }
+  double VisitExpr_(const tirx::NENode* op) final { return VisitExpr(op->a) != VisitExpr(op->b); }
+  double VisitExpr_(const tirx::LTNode* op) final { return VisitExpr(op->a) < VisitExpr(op->b); }
+  double VisitExpr_(const tirx::LENode* op) final { return VisitExpr(op->a) <= VisitExpr(op->b); }
+  double VisitExpr_(const tirx::GTNode* op) final { return VisitExpr(op->a) > VisitExpr(op->b); }
+  double VisitExpr_(const tirx::GENode* op) final { return VisitExpr(op->a) >= VisitExpr(op->b); }
+  double VisitExpr_(const tirx::AndNode* op) final {
+    return VisitExpr(op->a) != 0 && VisitExpr(op->b) != 0;
+  }
+  double VisitExpr_(const tirx::OrNode* op) final {
+    return VisitExpr(op->a) != 0 || VisitExpr(op->b) != 0;
+  }
+  double VisitExpr_(const tirx::NotNode* op) final { return VisitExpr(op->a) == 0; }
+  double VisitExpr_(const tirx::SelectNode* op) final {
+    return VisitExpr(op->condition) != 0 ? VisitExpr(op->true_value)
+                                         : VisitExpr(op->false_value);
+  }
+  double VisitExprDefault_(const ffi::Object* op) final {
+    TVM_FFI_THROW(ValueError) << "The interpreter does not support " << op->GetTypeKey();
+    TVM_FFI_UNREACHABLE();
+  }
+
+  // Statements.
+  void VisitStmt_(const tirx::SeqStmtNode* op) final {
+    for (const tirx::Stmt& stmt : op->seq) {
+      VisitStmt(stmt);
+    }
+  }
+  void VisitStmt_(const tirx::ForNode* op) final {
+    TVM_FFI_CHECK(op->kind != tirx::ForKind::kThreadBinding, ValueError) << "Thread binding";
+    double min = VisitExpr(op->min);
+    double extent = VisitExpr(op->extent);
+    double step = op->step.has_value() ? VisitExpr(op->step.value()) : 1;
+    TVM_FFI_CHECK_GT(step, 0, ValueError);
+    DLDataType loop_dtype = DTypeOf(op->loop_var.get());
+    for (double i = min; i < min + extent; i += step) {
+      Step();
+      var_values_[op->loop_var.get()] = Round(i, loop_dtype);
+      VisitStmt(op->body);
+    }
+  }
+  void VisitStmt_(const tirx::SBlockRealizeNode* op) final {
+    if (VisitExpr(op->predicate) == 0) {
+      return;
+    }
+    const tirx::SBlockNode* block = op->block.get();
+    TVM_FFI_CHECK_EQ(block->iter_vars.size(), op->iter_values.size(), ValueError);
+    for (size_t i = 0; i < block->iter_vars.size(); ++i) {
+      var_values_[block->iter_vars[i]->var.get()] = VisitExpr(op->iter_values[i]);
+    }
+    VisitStmt(op->block);
+  }
+  void VisitStmt_(const tirx::SBlockNode* op) final {
+    TVM_FFI_CHECK(!op->init.has_value() && op->alloc_buffers.empty() && op->match_buffers.empty(),
+                  ValueError)
+        << "The interpreter does not support reduction blocks or block buffers";
+    VisitStmt(op->body);
+  }
+  void VisitStmt_(const tirx::BufferStoreNode* op) final {
+    TVM_FFI_CHECK(!op->predicate.has_value(), ValueError) << "Predicated store";
+    Step();
+    double value = VisitExpr(op->value);
+    Store(ElementAddress(op->buffer, op->indices), op->buffer->dtype->dtype, value);
+  }
+  void VisitStmt_(const tirx::IfThenElseNode* op) final {
+    if (VisitExpr(op->condition) != 0) {
+      VisitStmt(op->then_case);
+    } else if (op->else_case.has_value()) {
+      VisitStmt(op->else_case.value());
+    }
+  }
+  void VisitStmt_(const tirx::BindNode* op) final {
+    var_values_[op->var.get()] = VisitExpr(op->value);
+  }
+  void VisitStmt_(const tirx::EvaluateNode* op) final {
+    TVM_FFI_CHECK(op->value.as<IntImmNode>() != nullptr, ValueError)
+        << "The interpreter does not support evaluating " << op->value;
+  }
+  void VisitStmtDefault_(const ffi::Object* op) final {
+    TVM_FFI_THROW(ValueError) << "The interpreter does not support " << op->GetTypeKey();
+  }
+
+  /*! \brief The tensors bound to the buffers of the PrimFunc. */
+  std::unordered_map<const tirx::BufferNode*, BoundTensor> tensors_;
+  /*! \brief The values of the loop, block and bound variables. */
+  std::unordered_map<const tirx::VarNode*, double> var_values_;
+  /*! \brief The number of steps taken. */
+  int64_t num_steps_ = 0;
+};
+
 class ConstantFolder : public ExprMutator {
  public:
   static Function Fold(Function func, IRModule ctx_module) {
     ConstantFolder folder(std::move(ctx_module));
+    folder.BuildFoldablePrimFuncs(func);
     func = RemoveAllUnused(folder(func)).as_or_throw<Function>();
     return func;
   }
@@ -104,10 +522,6 @@ class ConstantFolder : public ExprMutator {
    * \return The cached func, nullopt if func cannot be built.
    */
   ffi::Optional<ffi::Function> GetCachedBuild(tirx::PrimFunc func) {
-    // TODO(tvm-team): consider another way of bulk extract and build PrimFunc once
-    // would be helpful for future cases where PrimFunc recursively call into each other
-    Target eval_cpu_target{"llvm"};
-
     auto it = func_build_cache_.find(func);
     if (it != func_build_cache_.end()) {
       return it->second;
@@ -119,9 +533,7 @@ class ConstantFolder : public ExprMutator {
       // already scheduled to only work on GPU, we will need to skip this in the const folder for
       // now
       // TODO(Hongyi): further check and narrow the scope of foldable function
-      const auto pf = tvm::ffi::Function::GetGlobalRequired("tirx.build");
-      func = WithAttr(func, tvm::attr::kGlobalSymbol, ffi::String("tir_function"));
-      ffi::Module rt_module = pf(func, eval_cpu_target).cast<ffi::Module>();
+      ffi::Module rt_module = BuildModule({{"tir_function", func}});
       build_func = rt_module->GetFunction("tir_function");
     } catch (const tvm::ffi::Error& err) {
       // build failure may happen in which case we skip
@@ -131,6 +543,106 @@ class ConstantFolder : public ExprMutator {
     return build_func;
   }
 
+  /*! \brief Build the PrimFuncs, keyed by their global symbols, into one CPU module. */
+  static ffi::Module BuildModule(const std::vector<std::pair<ffi::String, tirx::PrimFunc>>& funcs) {
+    static const auto pf = tvm::ffi::Function::GetGlobalRequired("tirx.build");
+    Target eval_cpu_target{"llvm"};
+    ffi::Map<GlobalVar, BaseFunc> functions;
+    for (const auto& [symbol, func] : funcs) {
+      functions.Set(GlobalVar(symbol), WithAttr(func, tvm::attr::kGlobalSymbol, symbol));
+    }
+    return pf(IRModule(functions), eval_cpu_target).cast<ffi::Module>();
+  }
+
+  /*!
+   * \brief Build the PrimFuncs that \p func may fold in one module ahead of folding, so that
+   * they take one LLVM compilation instead of one each.
+   * \details A call_tir may be folded when all its arguments are constants or the results of
+   * calls that may be folded. Tiny PrimFuncs are left to the interpreter. The PrimFuncs created
+   * by legalizing operators during folding are still built one by one.
+   */
+  void BuildFoldablePrimFuncs(const Function& func) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    std::unordered_set<const VarNode*> foldable_vars;
+    auto is_foldable = [&foldable_vars](const Expr& arg) {
+      if (const auto* var = arg.as<VarNode>()) {
+        return foldable_vars.count(var) != 0;
+      }
+      return arg->IsInstance<ConstantNode>();
+    };
+
+    std::vector<tirx::PrimFunc> funcs_to_build;
+    std::unordered_set<tirx::PrimFunc, ffi::StructuralHash, ffi::StructuralEqual> visited;
+    for (const BindingBlock& block : func->body->blocks) {
+      for (const Binding& binding : block->bindings) {
+        const auto* var_binding = binding.as<VarBindingNode>();
+        if (var_binding == nullptr) continue;
+        if (const auto* tuple_get_item = var_binding->value.as<TupleGetItemNode>()) {
+          if (is_foldable(tuple_get_item->tuple)) {
+            foldable_vars.insert(binding->var.get());
+          }
+          continue;
+        }
+        const auto* call = var_binding->value.as<CallNode>();
+        if (call == nullptr || !call->op.same_as(call_tir_op) || call->args.size() != 2 ||
+            !call->args[0]->IsInstance<GlobalVarNode>() ||
+            !ShouldBeFolded(ffi::GetRef<Call>(call))) {
+          continue;
+        }
+        const auto* tir_args = call->args[1].as<TupleNode>();
+        ffi::Optional<tirx::PrimFunc> prim_func = MatchPrimFunc(call->args[0]);
+        if (tir_args == nullptr || !prim_func.has_value() ||
+            !std::all_of(tir_args->fields.begin(), tir_args->fields.end(), is_foldable)) {
+          continue;
+        }
+        foldable_vars.insert(binding->var.get());
+        if (!TinyPrimFuncInterpreter::IsTiny(prim_func.value()) &&
+            !func_build_cache_.count(prim_func.value()) &&
+            visited.insert(prim_func.value()).second) {
+          funcs_to_build.push_back(prim_func.value());
+        }
+      }
+    }
+    if (funcs_to_build.size() < 2) {
+      // A single PrimFunc is built when it is folded.
+      return;
+    }
+
+    std::vector<std::pair<ffi::String, tirx::PrimFunc>> symbol_funcs;
+    for (size_t i = 0; i < funcs_to_build.size(); ++i) {
+      symbol_funcs.emplace_back("tir_function_" + std::to_string(i), funcs_to_build[i]);
+    }
+    try {
+      ffi::Module rt_module = BuildModule(symbol_funcs);
+      for (const auto& [symbol, prim_func] : symbol_funcs) {
+        func_build_cache_[prim_func] = rt_module->GetFunction(symbol);
+      }
+    } catch (const tvm::ffi::Error& err) {
+      // One PrimFunc that cannot be built for CPU fails the whole module. Leave all of them to be
+      // built one by one when folded, which skips only the failing ones.
+      DLOG(WARNING) << "Bulk build failure for constant folding, Error message: " << err.what();
+    }
+  }
+
+  /*!
+   * \brief Run tir_func on the packed arguments, in the interpreter for tiny PrimFuncs.
+   * \return Whether tir_func ran, which fails when it cannot be built.
+   */
+  bool RunPrimFunc(const tirx::PrimFunc& tir_func, const std::vector<runtime::Tensor>& args) {
+    if (TinyPrimFuncInterpreter::IsTiny(tir_func) && !interpreter_failures_.count(tir_func)) {
+      if (TinyPrimFuncInterpreter::Run(tir_func, args)) {
+        return true;
+      }
+      interpreter_failures_.insert(tir_func);
+    }
+    ffi::Optional<ffi::Function> func = GetCachedBuild(tir_func);
+    if (!func) return false;
+    std::vector<AnyView> packed_args(args.begin(), args.end());
+    ffi::Any ret;
+    func.value().CallPacked(ffi::PackedArgs(packed_args.data(), packed_args.size()), &ret);
+    return true;
+  }
+
   /*!
    * \brief Checks if it is useful to fold \p expr.
    * \details Folding an expr is a trade-off - we are materializing a constant in the IRModule and
@@ -198,30 +710,13 @@ class ConstantFolder : public ExprMutator {
   ffi::Optional<Expr> ConstEvaluateCallTIR(tirx::PrimFunc tir_func,
                                            ffi::Array<runtime::Tensor> arr_args, ffi::Shape shape,
                                            DLDataType ret_type) {
-    // obtain function from the cache.
-    ffi::Optional<ffi::Function> func = GetCachedBuild(tir_func);
-    if (!func) return std::nullopt;
-
-    // here the vector size has an additional + 1 because we need to put ret_tensor at the end
-    std::vector<AnyView> packed_args(arr_args.size() + 1);
-
     DLDevice cpu_dev = {DLDeviceType::kDLCPU, 0};
     runtime::Tensor ret_tensor = runtime::Tensor::Empty(shape, ret_type, cpu_dev);
 
-    // avoid set rvalue ref which get de-allocated later, store args in a vector
-    // where temp_args[i] are lvalue ref that is stable
+    // the args are followed by ret_tensor
     std::vector<runtime::Tensor> temp_args(arr_args.begin(), arr_args.end());
-
-    size_t arg_offset = 0;
-    for (; arg_offset < arr_args.size(); ++arg_offset) {
-      packed_args[arg_offset] = temp_args[arg_offset];
-    }
-    // set return value
-    packed_args[arg_offset++] = ret_tensor;
-
-    ffi::Any ret;
-    // invoke
-    func.value().CallPacked(ffi::PackedArgs(packed_args.data(), packed_args.size()), &ret);
+    temp_args.push_back(ret_tensor);
+    if (!RunPrimFunc(tir_func, temp_args)) return std::nullopt;
     return Constant(ret_tensor);
   }
 
@@ -230,9 +725,6 @@ class ConstantFolder : public ExprMutator {
   ffi::Optional<Expr> ConstEvaluateCallTIRTuple(tirx::PrimFunc tir_func,
                                                 ffi::Array<runtime::Tensor> arr_args,
                                                 const TupleTypeNode* tuple_ty) {
-    ffi::Optional<ffi::Function> func = GetCachedBuild(tir_func);
-    if (!func) return std::nullopt;
-
     DLDevice cpu_dev = {DLDeviceType::kDLCPU, 0};
     size_t num_outputs = tuple_ty->fields.size();
 
@@ -249,17 +741,8 @@ class ConstantFolder : public ExprMutator {
 
     // Pack input args + all output tensors.
     std::vector<runtime::Tensor> temp_args(arr_args.begin(), arr_args.end());
-    std::vector<AnyView> packed_args;
-    packed_args.reserve(temp_args.size() + num_outputs);
-    for (const auto& arg : temp_args) {
-      packed_args.push_back(arg);
-    }
-    for (const auto& out_tensor : ret_tensors) {
-      packed_args.push_back(out_tensor);
-    }
-
-    ffi::Any ret;
-    func.value().CallPacked(ffi::PackedArgs(packed_args.data(), packed_args.size()), &ret);
+    temp_args.insert(temp_args.end(), ret_tensors.begin(), ret_tensors.end());
+    if (!RunPrimFunc(tir_func, temp_args)) return std::nullopt;
 
     ffi::Array<Expr> fields;
     for (size_t i = 0; i < num_outputs; ++i) {
@@ -424,6 +907,9 @@ class ConstantFolder : public ExprMutator {
   std::unordered_map<tirx::PrimFunc, ffi::Optional<ffi::Function>, ffi::StructuralHash,
                      ffi::StructuralEqual>
       func_build_cache_;
+  // the tiny PrimFuncs that the interpreter failed to run, via structural equality
+  std::unordered_set<tirx::PrimFunc, ffi::StructuralHash, ffi::StructuralEqual>
+      interpreter_failures_;
 };
 
 namespace transform {
@@ -105,6 +105,8 @@ using support::LinkNode;
 constexpr uint32_t kMaxFusedOps = 256;
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseOps.max_depth", int64_t);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseOps.cost_hook", ffi::String);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseOps.horizontal", bool);
 
 class GraphCreator : public ExprVisitor {
  public:
@@ -1074,7 +1076,8 @@ class OperatorFusor : public ExprMutator {
   bool lift_constants_{true};
 };
 
-IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth) {
+IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth,
+                 ffi::Optional<GraphPartitioner::FCost> fcost, bool horizontal_fusion) {
   support::Arena arena;
 
   // Step 1. Create the indexed-forward graph according to the input IRModule.
@@ -1082,7 +1085,9 @@ IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth) {
 
   // Step 2. Partition the graph by applying the fusion algorithm.
   std::vector<GraphPartitioner::Group*> groups =
-      GraphPartitioner(&arena, opt_level, max_fuse_depth, /*max_function_args=*/0).Partition(graph);
+      GraphPartitioner(&arena, opt_level, max_fuse_depth, /*max_function_args=*/0,
+                       std::move(fcost), horizontal_fusion)
+          .Partition(graph);
 
   // Step 3. Transform the IRModule by fusing the operators in accordance with the graph partition
   // results.
@@ -1476,7 +1481,17 @@ Pass FuseOps(int fuse_opt_level) {
       [=](IRModule m, PassContext pc) {
         int opt_level = fuse_opt_level == -1 ? pc->opt_level : fuse_opt_level;
         auto max_fuse_depth = pc->GetConfig<int64_t>("relax.FuseOps.max_depth", kMaxFusedOps);
-        return relax::FuseOps(m, opt_level, static_cast<size_t>(max_fuse_depth.value()));
+        // The cost hook is the name of a global function, see GraphPartitioner::FCost.
+        ffi::Optional<GraphPartitioner::FCost> fcost = std::nullopt;
+        if (auto hook = pc->GetConfig<ffi::String>("relax.FuseOps.cost_hook")) {
+          auto func = ffi::Function::GetGlobal(hook.value());
+          TVM_FFI_CHECK(func.has_value(), ValueError)
+              << "The fusion cost hook " << hook.value() << " is not a registered global function";
+          fcost = GraphPartitioner::FCost(func.value());
+        }
+        bool horizontal_fusion = pc->GetConfig<bool>("relax.FuseOps.horizontal", false).value();
+        return relax::FuseOps(m, opt_level, static_cast<size_t>(max_fuse_depth.value()),
+                              std::move(fcost), horizontal_fusion);
       };
   return CreateModulePass(/*pass_function=*/pass_func,  //
                           /*opt_level=*/0,              //
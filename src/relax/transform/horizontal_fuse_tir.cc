@@ -0,0 +1,410 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/transform/horizontal_fuse_tir.cc
+ * \brief Pack independent GPU kernels of a dataflow block into a single launch.
+ *
+ * Two `call_tir` bindings are independent when neither (transitively) consumes the output of
+ * the other. Bindings are assigned a dataflow level, one more than the deepest call they
+ * depend on, so calls at the same level are independent by construction.
+ *
+ * A callee is mergeable when, after scheduling, its body is one kernel: a single outermost
+ * loop bound to `blockIdx.x` with a constant extent and no other block-level binding inside.
+ * Mergeable calls at the same level whose kernels use the same thread extents are packed into
+ * one PrimFunc that dispatches on ranges of `blockIdx.x`:
+ *
+ * \code
+ *   for bx in T.thread_binding(N0 + N1, thread="blockIdx.x"):
+ *       if bx < N0:
+ *           body0(bx)
+ *       else:
+ *           body1(bx - N0)
+ * \endcode
+ *
+ * The branch condition is uniform within a thread block, so barriers inside the original
+ * bodies stay well-defined.
+ */
+
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/s_tir/transform.h>
+#include <tvm/tirx/op.h>
+#include <tvm/tirx/stmt_functor.h>
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+/*! \brief The single kernel launch a scheduled PrimFunc consists of. */
+struct KernelLaunch {
+  /*! \brief The outermost loop bound to blockIdx.x. */
+  tirx::For block_loop;
+  /*! \brief The buffers allocated by the root block, if any. */
+  ffi::Array<tirx::Buffer> alloc_buffers;
+  /*! \brief The extent of every other thread binding in the kernel. */
+  std::map<std::string, int64_t> thread_extents;
+
+  int64_t num_blocks() const { return block_loop->extent.as<IntImmNode>()->value; }
+};
+
+/*!
+ * \brief Match a PrimFunc against the single-kernel form the merge handles.
+ * \return The launch description, or std::nullopt if the function cannot be merged.
+ */
+std::optional<KernelLaunch> MatchKernelLaunch(const tirx::PrimFunc& func) {
+  KernelLaunch launch;
+  tirx::Stmt body = func->body;
+  if (const auto* realize = body.as<tirx::SBlockRealizeNode>()) {
+    const tirx::SBlock& root = realize->block;
+    if (!realize->iter_values.empty() || !root->iter_vars.empty() ||
+        !root->match_buffers.empty() || root->init.has_value()) {
+      return std::nullopt;
+    }
+    launch.alloc_buffers = root->alloc_buffers;
+    body = root->body;
+  }
+  const auto* loop = body.as<tirx::ForNode>();
+  if (loop == nullptr || loop->kind != tirx::ForKind::kThreadBinding ||
+      loop->thread_binding.value()->thread_tag != "blockIdx.x" || !tirx::is_zero(loop->min) ||
+      !loop->extent->IsInstance<IntImmNode>() || loop->step.has_value()) {
+    return std::nullopt;
+  }
+  launch.block_loop = ffi::GetRef<tirx::For>(loop);
+
+  bool mergeable = true;
+  tirx::PostOrderVisit(loop->body, [&](const ffi::ObjectRef& obj) {
+    if (const auto* inner = obj.as<tirx::ForNode>()) {
+      if (inner->kind != tirx::ForKind::kThreadBinding) return;
+      std::string tag = inner->thread_binding.value()->thread_tag;
+      const auto* extent = inner->extent.as<IntImmNode>();
+      if (tag.rfind("blockIdx.", 0) == 0 || tag.rfind("cluster", 0) == 0 || extent == nullptr) {
+        mergeable = false;
+        return;
+      }
+      auto [it, inserted] = launch.thread_extents.emplace(tag, extent->value);
+      if (!inserted && it->second != extent->value) mergeable = false;
+    } else if (const auto* attr = obj.as<tirx::AttrStmtNode>()) {
+      if (attr->attr_key == tirx::attr::thread_extent) mergeable = false;
+    }
+  });
+  if (!mergeable) return std::nullopt;
+  return launch;
+}
+
+/*!
+ * \brief Merge single-kernel PrimFuncs into one function that dispatches on blockIdx.x.
+ * \param funcs The functions to merge, in call order.
+ * \param num_inputs The number of input parameters of each function; the remaining
+ *        parameters are outputs.
+ * \return The merged function, whose parameters are all inputs followed by all outputs.
+ */
+tirx::PrimFunc MergeKernels(const std::vector<tirx::PrimFunc>& funcs,
+                            const std::vector<size_t>& num_inputs) {
+  std::vector<KernelLaunch> launches;
+  for (const tirx::PrimFunc& func : funcs) {
+    launches.push_back(MatchKernelLaunch(func).value());
+  }
+
+  PrimType index_ty = launches[0].block_loop->loop_var.ty();
+  int64_t total_blocks = 0;
+  for (const KernelLaunch& launch : launches) total_blocks += launch.num_blocks();
+  PrimVar block_idx("blockIdx.x", index_ty);
+
+  // Substitute each kernel's block index with its offset into the merged grid, and chain the
+  // kernels from the last one so that each branch tests a single upper bound.
+  std::vector<PrimExpr> offsets;
+  int64_t offset = 0;
+  for (const KernelLaunch& launch : launches) {
+    offsets.push_back(IntImm(index_ty, offset));
+    offset += launch.num_blocks();
+  }
+  tirx::Stmt body{nullptr};
+  for (int i = static_cast<int>(launches.size()) - 1; i >= 0; --i) {
+    const tirx::For& loop = launches[i].block_loop;
+    PrimExpr local_idx = block_idx - offsets[i];
+    if (loop->loop_var.ty() != index_ty) local_idx = cast(loop->loop_var.ty(), local_idx);
+    ffi::Map<tirx::Var, Expr> vmap{{loop->loop_var, local_idx}};
+    tirx::Stmt kernel = tirx::Substitute(loop->body, vmap);
+    if (body.defined()) {
+      body = tirx::IfThenElse(block_idx < offsets[i + 1], kernel, body);
+    } else {
+      body = kernel;
+    }
+  }
+  const tirx::IterVar& old_binding = launches[0].block_loop->thread_binding.value();
+  tirx::IterVar binding(Range::FromMinExtent(IntImm(index_ty, 0), IntImm(index_ty, total_blocks)),
+                        block_idx, old_binding->iter_type, old_binding->thread_tag);
+  body = tirx::For(block_idx, IntImm(index_ty, 0), IntImm(index_ty, total_blocks),
+                   tirx::ForKind::kThreadBinding, body, binding);
+
+  ffi::Array<tirx::Buffer> alloc_buffers;
+  for (const KernelLaunch& launch : launches) {
+    for (const tirx::Buffer& buffer : launch.alloc_buffers) alloc_buffers.push_back(buffer);
+  }
+  body = tirx::SBlockRealize(/*iter_values=*/{}, /*predicate=*/IntImm::Bool(true),
+                             tirx::SBlock(/*name_hint=*/"root", body, alloc_buffers));
+
+  ffi::Array<tirx::Var> params;
+  ffi::Map<tirx::Var, tirx::Buffer> buffer_map;
+  auto f_add_params = [&](const tirx::PrimFunc& func, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const tirx::Var& param = func->params[i];
+      params.push_back(param);
+      if (auto buffer = func->buffer_map.Get(param)) buffer_map.Set(param, buffer.value());
+    }
+  };
+  for (size_t i = 0; i < funcs.size(); ++i) f_add_params(funcs[i], 0, num_inputs[i]);
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    f_add_params(funcs[i], num_inputs[i], funcs[i]->params.size());
+  }
+
+  tirx::PrimFunc merged(params, body, VoidType(), buffer_map, funcs[0]->attrs);
+  return WithoutAttr(std::move(merged), tvm::attr::kGlobalSymbol);
+}
+
+/*! \brief Pack independent call_tir bindings of each dataflow block into merged kernels. */
+class HorizontalTIRFuser : public ExprMutator {
+ public:
+  HorizontalTIRFuser(IRModule mod, int64_t max_num_blocks)
+      : ExprMutator(mod), mod_(mod), max_num_blocks_(max_num_blocks) {}
+
+  IRModule Run() {
+    for (const auto& [gv, func] : mod_->functions) {
+      if (const auto* relax_func = func.as<FunctionNode>()) {
+        if (relax_func->HasNonzeroAttr(attr::kPrimitive)) continue;
+        Function new_func = VisitExpr(ffi::GetRef<Function>(relax_func)).as_or_throw<Function>();
+        if (!new_func.same_as(func)) builder_->UpdateFunction(gv, new_func);
+      }
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitBindingBlock_;
+
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* block) final {
+    std::vector<std::vector<size_t>> groups = PlanGroups(block);
+    if (groups.empty()) return ExprMutator::VisitBindingBlock_(block);
+
+    // Map the first binding of every group to the group, and mark the other members so that
+    // they are skipped when their original position is reached.
+    std::unordered_map<size_t, const std::vector<size_t>*> group_head;
+    std::unordered_set<size_t> merged_later;
+    for (const std::vector<size_t>& group : groups) {
+      group_head[group[0]] = &group;
+      for (size_t i = 1; i < group.size(); ++i) merged_later.insert(group[i]);
+    }
+
+    builder_->BeginDataflowBlock();
+    for (size_t i = 0; i < block->bindings.size(); ++i) {
+      if (merged_later.count(i)) continue;
+      auto it = group_head.find(i);
+      if (it == group_head.end()) {
+        VisitBinding(block->bindings[i]);
+      } else {
+        EmitMergedCall(block, *it->second);
+      }
+    }
+    return builder_->EndBlock();
+  }
+
+ private:
+  /*! \brief A call_tir binding whose callee is a mergeable kernel. */
+  struct Candidate {
+    size_t binding_index;
+    int level;
+    KernelLaunch launch;
+  };
+
+  /*! \brief Return the call_tir call of a binding if its callee can be merged. */
+  std::optional<KernelLaunch> GetMergeableLaunch(const Binding& binding) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* var_binding = binding.as<VarBindingNode>();
+    if (var_binding == nullptr) return std::nullopt;
+    const auto* call = var_binding->value.as<CallNode>();
+    if (call == nullptr || !call->op.same_as(call_tir_op) || call->args.size() != 2) {
+      return std::nullopt;
+    }
+    auto gv = call->args[0].as<GlobalVar>();
+    if (!gv.has_value()) return std::nullopt;
+    auto func = mod_->functions.Get(gv.value());
+    if (!func.has_value() || !func.value()->IsInstance<tirx::PrimFuncNode>()) {
+      return std::nullopt;
+    }
+    auto prim_func = func.value().as_or_throw<tirx::PrimFunc>();
+    const auto* args = call->args[1].as<TupleNode>();
+    size_t num_outputs = GetOutputTypes(call->ty_args[0]).size();
+    if (args == nullptr || num_outputs == 0 ||
+        args->fields.size() + num_outputs != prim_func->params.size()) {
+      return std::nullopt;
+    }
+    std::optional<KernelLaunch> launch = MatchKernelLaunch(prim_func);
+    if (!launch.has_value() || launch->num_blocks() > max_num_blocks_) return std::nullopt;
+    return launch;
+  }
+
+  /*!
+   * \brief Partition the mergeable calls of a dataflow block into groups of at least two
+   *        independent calls that can share a single launch.
+   * \return The binding indices of each group, in binding order.
+   */
+  std::vector<std::vector<size_t>> PlanGroups(const DataflowBlockNode* block) {
+    std::unordered_map<const VarNode*, int> var_level;
+    std::unordered_map<const VarNode*, size_t> var_index;
+    std::vector<std::vector<Candidate>> open_groups;
+
+    for (size_t i = 0; i < block->bindings.size(); ++i) {
+      const Binding& binding = block->bindings[i];
+      Expr value = GetBoundValue(binding);
+      ffi::Array<Var> free_vars = FreeVars(value);
+      int level = 0;
+      size_t last_def = 0;
+      bool has_local_def = false;
+      for (const Var& var : free_vars) {
+        if (auto it = var_level.find(var.get()); it != var_level.end()) {
+          level = std::max(level, it->second);
+          last_def = std::max(last_def, var_index[var.get()]);
+          has_local_def = true;
+        }
+      }
+      if (value->IsInstance<CallNode>()) ++level;
+      var_level[binding->var.get()] = level;
+      var_index[binding->var.get()] = i;
+
+      std::optional<KernelLaunch> launch = GetMergeableLaunch(binding);
+      if (!launch.has_value()) continue;
+      // The merged call is emitted at the position of the first member of its group, so every
+      // input of a later member must already be defined at that point.
+      bool merged = false;
+      for (std::vector<Candidate>& group : open_groups) {
+        const Candidate& head = group[0];
+        if (head.level != level || head.launch.thread_extents != launch->thread_extents ||
+            (has_local_def && last_def >= head.binding_index)) {
+          continue;
+        }
+        group.push_back({i, level, std::move(launch.value())});
+        merged = true;
+        break;
+      }
+      if (!merged) open_groups.push_back({{i, level, std::move(launch.value())}});
+    }
+
+    std::vector<std::vector<size_t>> groups;
+    for (const std::vector<Candidate>& group : open_groups) {
+      if (group.size() < 2) continue;
+      std::vector<size_t> indices;
+      for (const Candidate& candidate : group) indices.push_back(candidate.binding_index);
+      groups.push_back(std::move(indices));
+    }
+    return groups;
+  }
+
+  /*! \brief Emit one call to the merged kernel and rebind the outputs of every member. */
+  void EmitMergedCall(const DataflowBlockNode* block, const std::vector<size_t>& group) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    std::vector<tirx::PrimFunc> funcs;
+    std::vector<size_t> num_inputs;
+    ffi::Array<Expr> inputs;
+    ffi::Array<Type> output_types;
+    std::vector<const VarBindingNode*> bindings;
+    std::string name = "fused";
+    for (size_t index : group) {
+      const auto* binding = block->bindings[index].as<VarBindingNode>();
+      const auto* call = binding->value.as<CallNode>();
+      GlobalVar gv = call->args[0].as_or_throw<GlobalVar>();
+      // Renew the definitions so that a kernel called more than once is merged with distinct
+      // parameters and loop variables.
+      funcs.push_back(s_tir::RenewDefs(mod_->Lookup(gv).as_or_throw<tirx::PrimFunc>()));
+      ffi::Array<Expr> args = call->args[1].as<TupleNode>()->fields;
+      num_inputs.push_back(args.size());
+      for (const Expr& arg : args) inputs.push_back(VisitExpr(arg));
+      for (const TensorType& ty : GetOutputTypes(call->ty_args[0])) output_types.push_back(ty);
+      bindings.push_back(binding);
+      name += "_" + std::string(gv->name_hint);
+    }
+
+    GlobalVar merged_gv = builder_->AddFunction(MergeKernels(funcs, num_inputs), name);
+    Call merged_call(Type::Missing(), call_tir_op, {merged_gv, Tuple(inputs)}, {},
+                     {TupleType(output_types)});
+    Var merged_var = builder_->Emit(merged_call, name);
+
+    int output_index = 0;
+    for (const VarBindingNode* binding : bindings) {
+      const auto* call = binding->value.as<CallNode>();
+      Expr value{nullptr};
+      if (call->ty_args[0]->IsInstance<TensorTypeNode>()) {
+        value = TupleGetItem(merged_var, output_index++);
+      } else {
+        ffi::Array<Expr> fields;
+        for (size_t i = 0; i < GetOutputTypes(call->ty_args[0]).size(); ++i) {
+          fields.push_back(TupleGetItem(merged_var, output_index++));
+        }
+        value = Tuple(fields);
+      }
+      ReEmitBinding(binding, builder_->Normalize(value));
+    }
+  }
+
+  /*! \brief The output tensor types of a call_tir, or an empty array if any is not a tensor. */
+  static ffi::Array<TensorType> GetOutputTypes(const Type& out_ty) {
+    if (auto tensor_ty = out_ty.as<TensorType>()) return {tensor_ty.value()};
+    ffi::Array<TensorType> result;
+    if (const auto* tuple_ty = out_ty.as<TupleTypeNode>()) {
+      for (const Type& field : tuple_ty->fields) {
+        auto tensor_ty = field.as<TensorType>();
+        if (!tensor_ty.has_value()) return {};
+        result.push_back(tensor_ty.value());
+      }
+    }
+    return result;
+  }
+
+  IRModule mod_;
+  int64_t max_num_blocks_;
+};
+
+namespace transform {
+
+Pass HorizontalFuseTIR(int64_t max_num_blocks) {
+  auto pass_func = [=](IRModule mod, PassContext pc) {
+    return relax::HorizontalTIRFuser(mod, max_num_blocks).Run();
+  };
+  return CreateModulePass(/*pass_function=*/pass_func,        //
+                          /*opt_level=*/0,                    //
+                          /*pass_name=*/"HorizontalFuseTIR",  //
+                          /*required=*/{});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.transform.HorizontalFuseTIR", HorizontalFuseTIR);
+}
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
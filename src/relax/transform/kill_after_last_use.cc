@@ -29,6 +29,7 @@
 #include <tvm/relax/transform.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <vector>
@@ -91,6 +92,14 @@ class UnusedTrivialBindingRemover : public ExprMutator {
   std::unordered_set<const VarNode*> to_remove_;
 };
 
+/*!
+ * \brief Find the points where the objects of a function die, by a backward liveness analysis.
+ *
+ * A variable dies after the last binding that uses it on each path of the control flow.  A
+ * variable that is live before an `If` but not after it dies at its last use in each branch
+ * that uses it, and at the entry of each branch that does not use it.  A closure dies after its
+ * last invocation, which releases the tensors it captured.
+ */
 class CollectLastUsage : public ExprVisitor {
  public:
   struct LastUsage {
@@ -98,73 +107,40 @@ class CollectLastUsage : public ExprVisitor {
     std::vector<const VarNode*> storage;
     std::vector<const VarNode*> objects;
   };
-  using Result = std::unordered_map<const VarNode*, LastUsage>;
+  struct Result {
+    /*! \brief The objects to kill after a binding, keyed by the variable it binds. */
+    std::unordered_map<const VarNode*, LastUsage> after_binding;
+    /*! \brief The objects to kill at the entry of a branch. */
+    std::unordered_map<const SeqExprNode*, LastUsage> at_entry;
+  };
 
-  static Result Collect(const Expr& expr) {
+  static Result Collect(const Function& func) {
     CollectLastUsage visitor;
-    visitor(expr);
+    visitor(func->body);
+    visitor.ComputeLiveIn(Downcast<SeqExpr>(func->body), {});
 
     Result output;
-    for (const auto* var : visitor.binding_order_) {
-      if (auto it = visitor.last_usage_of_.find(var); it != visitor.last_usage_of_.end()) {
-        const auto* last_usage_point = it->second;
-        bool is_output = last_usage_point == nullptr;
-        bool already_killed = visitor.killed_objects_.count(var);
-
-        // Currently, the VM requires that objects to be killed
-        // objects only exist in VM registers.  This requires
-        // KillAfterLastUse to have more knowledge about the VM
-        // implementation than should exist at this stage of lowering.
-        // In the future, this may be handled more easily at the
-        // CodeGenVM level.
-        bool stored_in_vm_register =
-            !(visitor.constant_tensors_.count(var) || var->ty.as<FuncTypeNode>() ||
-              var->ty.as<ShapeTypeNode>() || var->ty.as<PrimTypeNode>());
-
-        if (!is_output && !already_killed) {
-          if (visitor.storage_objects_.count(var)) {
-            output[last_usage_point].storage.push_back(var);
-          } else if (var->ty.as<TensorTypeNode>() && stored_in_vm_register) {
-            output[last_usage_point].tensors.push_back(var);
-          } else if (stored_in_vm_register) {
-            output[last_usage_point].objects.push_back(var);
-          }
-        }
-      }
+    for (auto& [binding_var, vars] : visitor.dies_after_) {
+      output.after_binding[binding_var] = visitor.Classify(std::move(vars));
+    }
+    for (auto& [seq, vars] : visitor.dies_at_entry_) {
+      output.at_entry[seq] = visitor.Classify(std::move(vars));
     }
-
     return output;
   }
 
   void VisitBinding(const Binding& binding) override {
-    auto cache = current_binding_;
-    current_binding_ = binding->var.get();
-    binding_order_.push_back(current_binding_);
+    binding_order_.emplace(binding->var.get(), binding_order_.size());
     ExprVisitor::VisitBinding(binding);
-    current_binding_ = cache;
-  }
-
-  void VisitExpr_(const VarNode* op) override {
-    ExprVisitor::VisitExpr_(op);
-    // Overwrite any previous usage, such that after the visitor
-    // completes, last_usage_of_ contains the last usage point.  If
-    // this occurs in an output, then current_binding_ will be
-    // nullptr.
-    last_usage_of_[op] = current_binding_;
   }
 
   void VisitBinding_(const VarBindingNode* binding, const CallNode* val) override {
     static const Op& vm_alloc_storage = Op::Get("relax.vm.alloc_storage");
     static const Op& mem_alloc_storage = Op::Get("relax.memory.alloc_storage");
 
-    static const Op& mem_kill_tensor = Op::Get("relax.memory.kill_tensor");
-    static const Op& mem_kill_storage = Op::Get("relax.memory.kill_storage");
-    static const Op& vm_kill_object = Op::Get("relax.vm.kill_object");
-
     if (val->op.same_as(vm_alloc_storage) || val->op.same_as(mem_alloc_storage)) {
       storage_objects_.insert(binding->var.get());
-    } else if (val->op.same_as(mem_kill_tensor) || val->op.same_as(mem_kill_storage) ||
-               val->op.same_as(vm_kill_object)) {
+    } else if (IsKill(val)) {
       TVM_FFI_ICHECK_EQ(val->args.size(), 1)
           << "Operator " << val->op << " should have one argument, "
           << "but instead found " << val->args.size() << " arguments: " << val->args;
@@ -173,6 +149,10 @@ class CollectLastUsage : public ExprVisitor {
           << "Internal error: non-normalized expression " << ffi::GetRef<Call>(val);
       killed_objects_.insert(killed_object);
     } else {
+      // Closures produced by a call, such as R.make_closure, are held in VM registers.
+      if (binding->var->ty.as<FuncTypeNode>()) {
+        closure_objects_.insert(binding->var.get());
+      }
       // Only recursively visit if it isn't one of the special cases.
       ExprVisitor::VisitBinding_(binding, val);
     }
@@ -183,17 +163,121 @@ class CollectLastUsage : public ExprVisitor {
   }
 
  private:
-  // The current binding being visited, or nullptr if no binding is
-  // being visited.
-  const VarNode* current_binding_{nullptr};
+  using VarSet = std::unordered_set<const VarNode*>;
+
+  static bool IsKill(const CallNode* call) {
+    static const Op& mem_kill_tensor = Op::Get("relax.memory.kill_tensor");
+    static const Op& mem_kill_storage = Op::Get("relax.memory.kill_storage");
+    static const Op& vm_kill_object = Op::Get("relax.vm.kill_object");
+    return call->op.same_as(mem_kill_tensor) || call->op.same_as(mem_kill_storage) ||
+           call->op.same_as(vm_kill_object);
+  }
+
+  /*!
+   * \brief Compute the variables live at the entry of a sequence, from those live after it,
+   *  and record where the variables used in the sequence die.
+   */
+  VarSet ComputeLiveIn(const SeqExpr& seq, VarSet live) {
+    // The result of a sequence stays alive, as the output of the
+    // function or as the value of the `If` that merges the branch.
+    for (const Var& var : FreeVars(seq->body)) {
+      live.insert(var.get());
+    }
+    for (auto block_it = seq->blocks.rbegin(); block_it != seq->blocks.rend(); ++block_it) {
+      const auto& bindings = (*block_it)->bindings;
+      for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+        const Binding& binding = *it;
+        const VarNode* binding_var = binding->var.get();
+        live.erase(binding_var);
+        Expr value = GetBoundValue(binding);
+
+        if (const auto* call = value.as<CallNode>(); call && IsKill(call)) {
+          continue;
+        }
+
+        if (const auto* if_node = value.as<IfNode>()) {
+          auto true_branch = Downcast<SeqExpr>(if_node->true_branch);
+          auto false_branch = Downcast<SeqExpr>(if_node->false_branch);
+          VarSet live_true = ComputeLiveIn(true_branch, live);
+          VarSet live_false = ComputeLiveIn(false_branch, live);
+          // A variable used by one branch only dies on entry to the other.
+          for (const VarNode* var : live_true) {
+            if (!live_false.count(var)) dies_at_entry_[false_branch.get()].push_back(var);
+          }
+          for (const VarNode* var : live_false) {
+            if (!live_true.count(var)) dies_at_entry_[true_branch.get()].push_back(var);
+          }
+          for (const Var& var : FreeVars(if_node->cond)) {
+            if (!live.count(var.get()) && !live_true.count(var.get()) &&
+                !live_false.count(var.get())) {
+              dies_after_[binding_var].push_back(var.get());
+            }
+          }
+          live.insert(live_true.begin(), live_true.end());
+          live.insert(live_false.begin(), live_false.end());
+          for (const Var& var : FreeVars(if_node->cond)) {
+            live.insert(var.get());
+          }
+        } else {
+          for (const Var& var : FreeVars(value)) {
+            if (live.insert(var.get()).second) {
+              dies_after_[binding_var].push_back(var.get());
+            }
+          }
+        }
+      }
+    }
+    return live;
+  }
 
-  // Order of bindings, to ensure consistent order of destruction, in
-  // case a Binding is the last usage for more than one variable.
-  std::vector<const VarNode*> binding_order_;
+  /*! \brief Sort the dead variables by kind, keeping those that must and may be killed. */
+  LastUsage Classify(std::vector<const VarNode*> vars) const {
+    // Kill in the order of the bindings, for consistent output.
+    std::sort(vars.begin(), vars.end(), [this](const VarNode* a, const VarNode* b) {
+      return OrderOf(a) < OrderOf(b);
+    });
+    LastUsage output;
+    for (const VarNode* var : vars) {
+      // Function parameters are owned by the caller.
+      if (!binding_order_.count(var) || killed_objects_.count(var)) continue;
+
+      // Currently, the VM requires that objects to be killed
+      // objects only exist in VM registers.  This requires
+      // KillAfterLastUse to have more knowledge about the VM
+      // implementation than should exist at this stage of lowering.
+      // In the future, this may be handled more easily at the
+      // CodeGenVM level.
+      bool stored_in_vm_register =
+          !(constant_tensors_.count(var) ||
+            (var->ty.as<FuncTypeNode>() && !closure_objects_.count(var)) ||
+            var->ty.as<ShapeTypeNode>() || var->ty.as<PrimTypeNode>());
+
+      if (storage_objects_.count(var)) {
+        output.storage.push_back(var);
+      } else if (var->ty.as<TensorTypeNode>() && stored_in_vm_register) {
+        output.tensors.push_back(var);
+      } else if (stored_in_vm_register) {
+        output.objects.push_back(var);
+      }
+    }
+    return output;
+  }
+
+  size_t OrderOf(const VarNode* var) const {
+    auto it = binding_order_.find(var);
+    return it == binding_order_.end() ? 0 : it->second;
+  }
+
+  // Position of each binding, to ensure consistent order of
+  // destruction, in case a point is the last usage for more than one
+  // variable.  Function parameters are absent.
+  std::unordered_map<const VarNode*, size_t> binding_order_;
 
-  // Map from a variable to the last variable binding that makes use
-  // of it.
-  std::unordered_map<const VarNode*, const VarNode*> last_usage_of_;
+  // Map from a binding to the variables that die after it.
+  std::unordered_map<const VarNode*, std::vector<const VarNode*>> dies_after_;
+
+  // Map from a branch to the variables that die on entry to it.
+  std::unordered_map<const SeqExprNode*, std::vector<const VarNode*>> dies_at_entry_;
 
   // Storage objects, eligible for R.vm.kill_object.  This cannot be
   // determined solely from the Type, because the
@@ -204,49 +288,65 @@ class CollectLastUsage : public ExprVisitor {
   // R.builtin.kill_tensor called on them.
   std::unordered_set<const VarNode*> constant_tensors_;
 
+  // Closures returned by a call, which unlike the functions bound to
+  // a GlobalVar are held in a VM register.
+  std::unordered_set<const VarNode*> closure_objects_;
+
   // Set of objects that already have a call node to kill them.  Should not have a duplicate
   std::unordered_set<const VarNode*> killed_objects_;
-
-  // Trivial var-to-var bindings.
-  std::unordered_map<const VarNode*, const VarNode*> trivial_bindings_;
 };
 
 class KillInserter : public ExprMutator {
  private:
   Expr VisitExpr_(const FunctionNode* op) override {
-    last_usage_ = CollectLastUsage::Collect(ffi::GetRef<Expr>(op));
+    // Nested functions are planned on their own, as their bodies run
+    // when they are invoked.
+    auto cache = std::move(last_usage_);
+    last_usage_ = CollectLastUsage::Collect(ffi::GetRef<Function>(op));
     auto mutated = ExprMutator::VisitExpr_(op);
-    last_usage_.clear();
+    last_usage_ = std::move(cache);
     return mutated;
   }
 
   Expr VisitExpr_(const SeqExprNode* op) override {
-    last_usage_ = CollectLastUsage::Collect(ffi::GetRef<Expr>(op));
-    auto mutated = ExprMutator::VisitExpr_(op);
-    last_usage_.clear();
-    return mutated;
+    auto it = last_usage_.at_entry.find(op);
+    if (it == last_usage_.at_entry.end()) {
+      return ExprMutator::VisitExpr_(op);
+    }
+    builder_->BeginBindingBlock();
+    EmitKills(it->second);
+    BindingBlock entry = builder_->EndBlock();
+    auto mutated = Downcast<SeqExpr>(ExprMutator::VisitExpr_(op));
+    ffi::Array<BindingBlock> blocks = {entry};
+    blocks.insert(blocks.end(), mutated->blocks.begin(), mutated->blocks.end());
+    return SeqExpr(blocks, mutated->body);
   }
 
   void VisitBinding(const Binding& binding) override {
     ExprMutator::VisitBinding(binding);
-    if (auto it = last_usage_.find(binding->var.get()); it != last_usage_.end()) {
-      static const Op& mem_kill_tensor = Op::Get("relax.memory.kill_tensor");
-      for (const auto& tensor_obj : it->second.tensors) {
-        builder_->Emit(Call(Type::Missing(), mem_kill_tensor, {ffi::GetRef<Expr>(tensor_obj)}),
-                       /*name_hint=*/"_");
-      }
+    if (auto it = last_usage_.after_binding.find(binding->var.get());
+        it != last_usage_.after_binding.end()) {
+      EmitKills(it->second);
+    }
+  }
 
-      static const Op& mem_kill_storage = Op::Get("relax.memory.kill_storage");
-      for (const VarNode* storage_obj : it->second.storage) {
-        builder_->Emit(Call(Type::Missing(), mem_kill_storage, {ffi::GetRef<Expr>(storage_obj)}),
-                       /*name_hint=*/"_");
-      }
+  void EmitKills(const CollectLastUsage::LastUsage& last_usage) {
+    static const Op& mem_kill_tensor = Op::Get("relax.memory.kill_tensor");
+    for (const auto& tensor_obj : last_usage.tensors) {
+      builder_->Emit(Call(Type::Missing(), mem_kill_tensor, {ffi::GetRef<Expr>(tensor_obj)}),
+                     /*name_hint=*/"_");
+    }
 
-      static const Op& vm_kill_object = Op::Get("relax.vm.kill_object");
-      for (const VarNode* obj : it->second.objects) {
-        builder_->Emit(Call(Type::Missing(), vm_kill_object, {ffi::GetRef<Expr>(obj)}),
-                       /*name_hint=*/"_");
-      }
+    static const Op& mem_kill_storage = Op::Get("relax.memory.kill_storage");
+    for (const VarNode* storage_obj : last_usage.storage) {
+      builder_->Emit(Call(Type::Missing(), mem_kill_storage, {ffi::GetRef<Expr>(storage_obj)}),
+                     /*name_hint=*/"_");
+    }
+
+    static const Op& vm_kill_object = Op::Get("relax.vm.kill_object");
+    for (const VarNode* obj : last_usage.objects) {
+      builder_->Emit(Call(Type::Missing(), vm_kill_object, {ffi::GetRef<Expr>(obj)}),
+                     /*name_hint=*/"_");
     }
   }
 
@@ -24,6 +24,8 @@
  */
 
 #include <tvm/ffi/cast.h>
+#include <tvm/ffi/extra/structural_equal.h>
+#include <tvm/ffi/extra/structural_hash.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/relax/analysis.h>
 #include <tvm/relax/expr_functor.h>
@@ -33,7 +35,12 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/tirx/transform.h>
 
+#include <algorithm>
+#include <optional>
 #include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 namespace relax {
@@ -352,6 +359,23 @@ class LegalizeMutator : public ExprMutator {
       return visited_call;
     }
 
+    // Identical op instances (e.g. the same layer repeated many times
+    // in a model) legalize to the same PrimFunc.  Reuse the GlobalVar
+    // of an earlier legalization rather than regenerating the TE
+    // compute for every instance.
+    ffi::Optional<ffi::Array<ffi::Any>> cache_key = GetLegalizeCacheKey(visited_call);
+    if (cache_key) {
+      if (auto it = legalize_cache_.find(cache_key.value()); it != legalize_cache_.end()) {
+        const auto& [cached, arg_indices] = it->second;
+        ffi::Array<Expr> args;
+        for (int index : arg_indices) {
+          args.push_back(visited_call->args[index]);
+        }
+        return builder_->Normalize(Call(Type::Missing(), cached->op, {cached->args[0], Tuple(args)},
+                                        cached->attrs, cached->ty_args));
+      }
+    }
+
     // The legalization function may call `builder_->Emit()` as part
     // of its implementation.  In that case, any operations it emits
     // must be caught such that they be checked for recursive
@@ -394,9 +418,70 @@ class LegalizeMutator : public ExprMutator {
       legalized = VisitExpr(legalized);
     }
 
+    if (cache_key && prologue->bindings.empty()) {
+      if (auto arg_indices = GetReusableArgIndices(legalized, visited_call)) {
+        legalize_cache_.emplace(cache_key.value(),
+                                std::make_pair(legalized.as_or_throw<Call>(), *arg_indices));
+      }
+    }
+
     return legalized;
   }
 
+  /*!
+   * \brief Get the key under which the legalization of a call may be cached.
+   *
+   * The key holds the op, its attributes, the types of the arguments
+   * and the result, and which arguments are repeated.  Only calls whose
+   * arguments are all variables are cached, as legalizations may
+   * inspect the value of constant or shape arguments.
+   */
+  static ffi::Optional<ffi::Array<ffi::Any>> GetLegalizeCacheKey(const Call& call) {
+    ffi::Array<Type> arg_types;
+    ffi::Array<int64_t> first_occurrence;
+    for (const Expr& arg : call->args) {
+      if (!arg->IsInstance<VarNode>()) {
+        return std::nullopt;
+      }
+      arg_types.push_back(GetType(arg));
+      auto it = std::find_if(call->args.begin(), call->args.end(),
+                             [&](const Expr& other) { return other.same_as(arg); });
+      first_occurrence.push_back(std::distance(call->args.begin(), it));
+    }
+    return ffi::Array<ffi::Any>{call->op, call->attrs, arg_types, GetType(call), first_occurrence};
+  }
+
+  /*!
+   * \brief Check if a legalized expression is a call_tir of a GlobalVar whose
+   * inputs are all arguments of the original call, so that it can be rebuilt
+   * for another call with the same cache key.
+   * \return The index into the original arguments of each call_tir input, or
+   * std::nullopt if the legalized expression cannot be reused.
+   */
+  static std::optional<std::vector<int>> GetReusableArgIndices(const Expr& legalized,
+                                                               const Call& original) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* call = legalized.as<CallNode>();
+    if (call == nullptr || !call->op.same_as(call_tir_op) || call->args.size() != 2 ||
+        !call->args[0]->IsInstance<GlobalVarNode>()) {
+      return std::nullopt;
+    }
+    const auto* tuple = call->args[1].as<TupleNode>();
+    if (tuple == nullptr) {
+      return std::nullopt;
+    }
+    std::vector<int> arg_indices;
+    for (const Expr& field : tuple->fields) {
+      auto it = std::find_if(original->args.begin(), original->args.end(),
+                             [&](const Expr& arg) { return arg.same_as(field); });
+      if (it == original->args.end()) {
+        return std::nullopt;
+      }
+      arg_indices.push_back(std::distance(original->args.begin(), it));
+    }
+    return arg_indices;
+  }
+
   /*! \brief The context IRModule. */
   IRModule mod_;
   /*! \brief The customized legalization function map. */
@@ -412,6 +497,13 @@ class LegalizeMutator : public ExprMutator {
    * \brief List of ops to be skipped from legalization
    */
   std::set<Op, OpIdentityLess> skip_ops_;
+  /*!
+   * \brief Cache from (op, attrs, argument types, result type) to the legalized
+   * call_tir and the original argument index of each of its inputs.
+   */
+  std::unordered_map<ffi::Array<ffi::Any>, std::pair<Call, std::vector<int>>,
+                     ffi::StructuralHash, ffi::StructuralEqual>
+      legalize_cache_;
 };
 
 namespace transform {
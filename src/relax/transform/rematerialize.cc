@@ -0,0 +1,245 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/transform/rematerialize.cc
+ * \brief Recompute activations near their late uses to lower the peak live memory.
+ *
+ * The output of `Gradient` keeps every forward activation alive until the backward bindings
+ * that consume it. Within a dataflow block, a binding whose uses are separated by the point of
+ * peak live bytes is rematerialized: its value is recomputed right before its first use after
+ * the peak, and the later uses read the recomputed copy, so the original is released early.
+ *
+ * Only recomputations that do not extend the lifetime of any other tensor are considered: every
+ * input must be live at the point of recomputation anyway. Among the candidates, the one saving
+ * the most bytes per estimated FLOP is applied first, until the peak fits the memory budget.
+ *
+ * The rewrite only duplicates pure bindings, so `KillAfterLastUse` and `StaticPlanBlockMemory`
+ * pick up the shortened lifetimes afterwards without further information.
+ */
+
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relax/utils.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+namespace {
+
+/*! \brief The statically known number of elements of a tensor type, or -1. */
+int64_t GetStaticNumel(const Type& ty) {
+  const auto* tensor_ty = ty.as<TensorTypeNode>();
+  if (tensor_ty == nullptr || !tensor_ty->shape.has_value()) return -1;
+  const auto* shape = tensor_ty->shape.value().as<ShapeExprNode>();
+  if (shape == nullptr) return -1;
+  int64_t numel = 1;
+  for (const PrimExpr& dim : shape->values) {
+    const auto* int_dim = dim.as<IntImmNode>();
+    if (int_dim == nullptr) return -1;
+    numel *= int_dim->value;
+  }
+  return numel;
+}
+
+/*! \brief The statically known size in bytes of a tensor type, or -1. */
+int64_t GetStaticBytes(const Type& ty) {
+  const auto* tensor_ty = ty.as<TensorTypeNode>();
+  int64_t numel = GetStaticNumel(ty);
+  if (numel < 0 || tensor_ty->IsUnknownDtype()) return -1;
+  DLDataType dtype = tensor_ty->dtype.value()->dtype;
+  return numel * ((static_cast<int64_t>(dtype.bits) * dtype.lanes + 7) / 8);
+}
+
+/*!
+ * \brief A rough FLOP count of recomputing a call.
+ *
+ * Contractions cost one multiply-add per reduced element of every output; everything else is
+ * treated as elementwise.
+ */
+int64_t EstimateFlops(const CallNode* call) {
+  int64_t numel = std::max<int64_t>(GetStaticNumel(GetType(ffi::GetRef<Call>(call))), 1);
+  const std::string name = call->op.as<OpNode>()->name;
+  if (name == "relax.matmul" && !call->args.empty()) {
+    const auto* lhs = GetType(call->args[0]).as<TensorTypeNode>();
+    if (lhs != nullptr && lhs->shape.has_value()) {
+      const auto* shape = lhs->shape.value().as<ShapeExprNode>();
+      if (shape != nullptr && !shape->values.empty()) {
+        if (const auto* k = shape->values.back().as<IntImmNode>()) return 2 * numel * k->value;
+      }
+    }
+  } else if (name.rfind("relax.nn.conv", 0) == 0 && call->args.size() > 1) {
+    int64_t weight_numel = GetStaticNumel(GetType(call->args[1]));
+    const auto* weight = GetType(call->args[1]).as<TensorTypeNode>();
+    if (weight_numel > 0 && weight->shape.has_value()) {
+      const auto* shape = weight->shape.value().as<ShapeExprNode>();
+      int64_t out_channels = shape->values[0].as<IntImmNode>()->value;
+      return 2 * numel * (weight_numel / std::max<int64_t>(out_channels, 1));
+    }
+  }
+  return numel;
+}
+
+class Rematerializer : public ExprMutator {
+ public:
+  explicit Rematerializer(int64_t memory_budget) : memory_budget_(memory_budget) {}
+
+  using ExprMutator::VisitBindingBlock_;
+
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* op) final {
+    std::vector<Binding> bindings(op->bindings.begin(), op->bindings.end());
+    // Each rematerialization removes one gap from the lifetime of a tensor, so the number of
+    // original bindings bounds the useful iterations.
+    for (size_t iter = 0; iter < op->bindings.size(); ++iter) {
+      if (!RematerializeOnce(&bindings)) break;
+    }
+    if (bindings.size() == op->bindings.size()) {
+      return ExprMutator::VisitBindingBlock_(op);
+    }
+    DataflowBlock block(ffi::Array<Binding>(bindings.begin(), bindings.end()), op->span);
+    return ExprMutator::VisitBindingBlock_(block.get());
+  }
+
+ private:
+  /*! \brief The position of the definition and the positions of the uses of a variable. */
+  struct Lifetime {
+    int def = -1;
+    std::vector<int> uses;
+    int64_t bytes = 0;
+    int last_use = -1;
+  };
+
+  /*!
+   * \brief Rematerialize the binding that best lowers the current peak.
+   * \return Whether the peak exceeded the budget and a binding was rematerialized.
+   */
+  bool RematerializeOnce(std::vector<Binding>* bindings) {
+    int num_bindings = static_cast<int>(bindings->size());
+    if (num_bindings == 0) return false;
+    std::unordered_map<const VarNode*, Lifetime> lifetimes;
+    for (int i = 0; i < num_bindings; ++i) {
+      const Binding& binding = (*bindings)[i];
+      Expr value = GetBoundValue(binding);
+      for (const Var& var : FreeVars(value)) {
+        auto it = lifetimes.find(var.get());
+        if (it != lifetimes.end()) it->second.uses.push_back(i);
+      }
+      Lifetime& lifetime = lifetimes[binding->var.get()];
+      lifetime.def = i;
+      // Only calls allocate; other bindings alias the tensors they are derived from.
+      if (value->IsInstance<CallNode>()) {
+        lifetime.bytes = std::max<int64_t>(GetStaticBytes(GetType(binding->var)), 0);
+      }
+    }
+
+    // Variables that leave the block stay live until its end.
+    std::vector<int64_t> live_bytes(num_bindings, 0);
+    for (auto& [var, lifetime] : lifetimes) {
+      lifetime.last_use = lifetime.uses.empty() ? lifetime.def : lifetime.uses.back();
+      if (!var->IsInstance<DataflowVarNode>()) lifetime.last_use = num_bindings - 1;
+      for (int i = lifetime.def; i <= lifetime.last_use; ++i) live_bytes[i] += lifetime.bytes;
+    }
+    int peak = static_cast<int>(std::max_element(live_bytes.begin(), live_bytes.end()) -
+                                live_bytes.begin());
+    if (live_bytes[peak] <= memory_budget_) return false;
+
+    int best_index = -1;
+    int best_insert = -1;
+    double best_score = 0;
+    for (int i = 0; i < num_bindings; ++i) {
+      const auto* binding = (*bindings)[i].as<VarBindingNode>();
+      if (binding == nullptr || !binding->var->IsInstance<DataflowVarNode>()) continue;
+      const auto* call = binding->value.as<CallNode>();
+      if (call == nullptr || !call->op->IsInstance<OpNode>() ||
+          std::string(call->op.as<OpNode>()->name).rfind("relax.call", 0) == 0 ||
+          IsImpureCall(ffi::GetRef<Call>(call))) {
+        continue;
+      }
+      const Lifetime& lifetime = lifetimes[binding->var.get()];
+      if (lifetime.bytes <= 0 || lifetime.def >= peak) continue;
+      // The first use after the peak is where the value gets recomputed.  The value must not be
+      // used at the peak itself, since it would then be live across it either way.
+      auto next_use = std::upper_bound(lifetime.uses.begin(), lifetime.uses.end(), peak - 1);
+      if (next_use == lifetime.uses.end() || *next_use == peak) continue;
+      int insert = *next_use;
+      bool inputs_live = true;
+      for (const Var& input : FreeVars(binding->value)) {
+        auto it = lifetimes.find(input.get());
+        if (it != lifetimes.end() && it->second.last_use < insert) inputs_live = false;
+      }
+      if (!inputs_live) continue;
+      double score = static_cast<double>(lifetime.bytes) / EstimateFlops(call);
+      if (best_index < 0 || score > best_score) {
+        best_index = i;
+        best_insert = insert;
+        best_score = score;
+      }
+    }
+    if (best_index < 0) return false;
+
+    // Recompute the value right before its first use after the peak, and redirect that use
+    // and every later one to the recomputed copy.
+    const auto* binding = (*bindings)[best_index].as<VarBindingNode>();
+    DataflowVar remat(binding->var->name + "_remat", GetType(binding->var));
+    ffi::Map<Var, Expr> remap{{binding->var, remat}};
+    for (int i = best_insert; i < num_bindings; ++i) {
+      Binding& use = (*bindings)[i];
+      Expr value = Bind(GetBoundValue(use), remap);
+      if (const auto* match_cast = use.as<MatchCastNode>()) {
+        use = MatchCast(match_cast->var, value, match_cast->ty, match_cast->span);
+      } else {
+        use = VarBinding(use->var, value, use->span);
+      }
+    }
+    bindings->insert(bindings->begin() + best_insert, VarBinding(remat, binding->value));
+    return true;
+  }
+
+  int64_t memory_budget_;
+};
+
+}  // namespace
+
+namespace transform {
+
+Pass Rematerialize(int64_t memory_budget) {
+  auto pass_func = [=](Function func, IRModule, PassContext) {
+    return Rematerializer(memory_budget)(func).as_or_throw<Function>();
+  };
+  return CreateFunctionPass(/*pass_function=*/pass_func,    //
+                            /*opt_level=*/0,                //
+                            /*pass_name=*/"Rematerialize",  //
+                            /*required=*/{});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("relax.transform.Rematerialize", Rematerialize);
+}
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
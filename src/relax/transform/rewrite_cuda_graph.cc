@@ -24,6 +24,7 @@
  * CUDA graph provides a way to capture a sequence of CUDA kernel launches in the runtime and
  * save them as a graph. The graph can be executed multiple times with less overhead than launching
  * kernels individually. This pass rewrites the Relax module to execute with CUDA graph.
+ * Under a Vulkan target, the regions are captured into reusable Vulkan command buffers instead.
  *
  * The transformation is done in two steps:
  *
@@ -55,10 +56,12 @@
 #include <tvm/relax/backend.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/utils.h>
+#include <tvm/target/target.h>
 #include <tvm/tirx/expr.h>
 #include <tvm/tirx/expr_functor.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -742,7 +745,18 @@ Function MergeAllocationPlans(const std::vector<LiftedFunctionRewritePlan*>& all
 /*! \brief The rewriter for CUDA graph */
 class CUDAGraphRewriter : public ExprMutator {
  public:
-  explicit CUDAGraphRewriter(const IRModule& mod) : ExprMutator(mod) {}
+  explicit CUDAGraphRewriter(const IRModule& mod) : ExprMutator(mod) {
+    // With a ROCm target, the regions are captured into HIP graphs, with a Vulkan target into
+    // reusable Vulkan command buffers, and with a Metal target into indirect command buffers.
+    Target target = Target::Current(true);
+    if (target.defined() && target->kind->name == "rocm") {
+      graph_builtin_prefix_ = "vm.builtin.rocm_graph";
+    } else if (target.defined() && target->kind->name == "vulkan") {
+      graph_builtin_prefix_ = "vm.builtin.vulkan_graph";
+    } else if (target.defined() && target->kind->name == "metal") {
+      graph_builtin_prefix_ = "vm.builtin.metal_graph";
+    }
+  }
 
   IRModule Rewrite() {
     CUDAGraphRewritePlanner planner(builder_->GetContextIRModule(), &arena_);
@@ -779,9 +793,8 @@ class CUDAGraphRewriter : public ExprMutator {
 
   void LaunchSubgraph(const VarBindingNode* op, const LiftedFunctionRewritePlan* plan) {
     static const auto& call_builtin_with_ctx_op = Op::Get("relax.call_builtin_with_ctx");
-    static const auto& builtin_run_or_capture = ExternFunc("vm.builtin.cuda_graph.run_or_capture");
-    static const auto& builtin_get_cached_alloc =
-        ExternFunc("vm.builtin.cuda_graph.get_cached_alloc");
+    ExternFunc builtin_run_or_capture(graph_builtin_prefix_ + ".run_or_capture");
+    ExternFunc builtin_get_cached_alloc(graph_builtin_prefix_ + ".get_cached_alloc");
 
     Expr launch_subgraph;
     if (plan->is_alloc) {
@@ -882,6 +895,8 @@ class CUDAGraphRewriter : public ExprMutator {
   support::Arena arena_;
   ffi::Optional<GlobalVar> gv_global_alloc_ = std::nullopt;
   ffi::Optional<GlobalVar> current_func_ = std::nullopt;
+  // The prefix of the VM builtins that capture and replay the regions on the target.
+  std::string graph_builtin_prefix_ = "vm.builtin.cuda_graph";
 };
 
 IRModule RewriteCUDAGraph(IRModule mod) {
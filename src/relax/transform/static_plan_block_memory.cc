@@ -64,6 +64,28 @@
  * It means the maximum value of variable that names "n" in the function
  * signature will have upper bound 1024. And we will use 1024 as its value
  * during memory planning.
+ *
+ * Without annotations, the TIR variables defined by a `match_cast` are bounded
+ * by the extents of the value being cast, whenever those extents themselves have
+ * a known upper bound. For example, casting a tensor of shape `(m,)` with the
+ * annotated bound `m <= 1024` to the shape `(n,)` bounds `n` by 1024 as well.
+ *
+ * With the pass config "relax.memory_plan_arena", the constant-size global
+ * tensors of each binding block are not planned by whole-token reuse but
+ * packed into one arena storage per block. Each tensor gets a byte offset in
+ * the arena, assigned with best-fit packing against the tensors whose live
+ * intervals interfere with it. The planned peak arena size is reported in the
+ * function attribute "relax.memory_plan_peak_bytes". The functions annotated
+ * with the same "relax.memory_arena_group" attribute (e.g., the prefill and
+ * decode functions of a model, which never run at the same time) size their
+ * arenas to the peak of the group, so that the runtime pooled allocator can
+ * serve all of them with the same block of memory.
+ *
+ * With the pass config "relax.memory_output_params", the tensors that a public
+ * function allocates and returns are treated as externally owned storage: each
+ * of them is replaced by a new trailing parameter, through which the caller
+ * passes the buffer the output is written into. The number of the output
+ * parameters is recorded in the function attribute "relax.num_output_params".
  */
 #include <tvm/arith/analyzer.h>
 #include <tvm/ffi/cast.h>
@@ -72,10 +94,17 @@
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/nested_msg.h>
 #include <tvm/relax/transform.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/vm/executable.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "../../backend/opencl/runtime/texture.h"
@@ -84,6 +113,9 @@
 namespace tvm {
 namespace relax {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.memory_plan_arena", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.memory_output_params", bool);
+
 /*!
  * \brief A representation of a block of reusable memory required at runtime.
  * \details Only the tensors whose memory can be "possibly reused" will have
@@ -111,6 +143,11 @@ class StorageTokenNode : public ffi::Object {
   std::string storage_scope;
   /*! \brief The VDevice information. */
   ffi::Optional<VDevice> vdevice;
+  /*!
+   * \brief The 2D texture extent (width, height, depth, channel) the token is allocated for.
+   * Empty for buffers and for textures of symbolic shape.
+   */
+  std::vector<int64_t> texture_extent;
   /*! \brief The storage id, reserved for debug and demo use. */
   int storage_id{-1};
 
@@ -145,9 +182,11 @@ class StorageToken : public ffi::ObjectRef {
     PrimExpr size = IntImm::Int64(1);
     bool size_computed = false;
 
+    std::vector<int64_t> texture_extent;
     if (vdevice.has_value()) {
       VDevice vdev = vdevice.value();
       std::string dev_kind = vdev->target->kind->name;
+      texture_extent = GetTextureExtent(shape, vdev->memory_scope);
 
       if (vdev->memory_scope != "global") {
         auto device_size_handler =
@@ -183,9 +222,26 @@ class StorageToken : public ffi::ObjectRef {
     n->dtype = dtype;
     n->storage_scope = std::move(storage_scope);
     n->vdevice = std::move(vdevice);
+    n->texture_extent = std::move(texture_extent);
     data_ = std::move(n);
   }
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NOTNULLABLE(StorageToken, ffi::ObjectRef, StorageTokenNode);
+
+ private:
+  /*! \brief The flattened 2D extent of a texture of static shape, or empty otherwise. */
+  static std::vector<int64_t> GetTextureExtent(const ffi::Array<PrimExpr>& shape,
+                                               const std::string& memory_scope) {
+    if (!runtime::IsTextureStorage(memory_scope) || shape.empty()) return {};
+    std::vector<int64_t> dims;
+    for (const PrimExpr& dim_len : shape) {
+      const IntImmNode* const_dim_len = dim_len.as<IntImmNode>();
+      if (const_dim_len == nullptr) return {};
+      dims.push_back(const_dim_len->value);
+    }
+    size_t axis = runtime::DefaultTextureLayoutSeparator(dims.size(), memory_scope);
+    auto texture = runtime::ApplyTexture2DFlattening<int64_t>(dims, dims.size(), axis);
+    return {texture.width, texture.height, texture.depth, texture.channel};
+  }
 };
 
 // We use NestedMsg to store the tokens used by each Expr.
@@ -242,7 +298,21 @@ class TokenAllocatorMixed {
     auto begin = pool.lower_bound(size / match_range_);
     auto mid = pool.lower_bound(size);
     auto end = pool.upper_bound(size * match_range_);
-    // Step 3. Search for memory block that equals or is larger than the requested size.
+    // Step 3. A texture first reuses the block of a texture with the same 2D extent, which keeps
+    // the row pitch of the image and needs no enlargement.
+    if (!prototype->texture_extent.empty()) {
+      for (auto it = mid; it != end; ++it) {
+        StorageToken available_token = it->second;
+        if (available_token->texture_extent == prototype->texture_extent) {
+          TVM_FFI_ICHECK_EQ(available_token->ref_counter, 0)
+              << "Available tokens are expected to have 0 reference.";
+          available_token->ref_counter = prototype->ref_counter;
+          pool.erase(it);
+          return available_token;
+        }
+      }
+    }
+    // Step 4. Search for memory block that equals or is larger than the requested size.
     if (mid != end) {
       StorageToken available_token = mid->second;
       TVM_FFI_ICHECK_EQ(available_token->ref_counter, 0)
@@ -252,7 +322,7 @@ class TokenAllocatorMixed {
       pool.erase(mid);
       return available_token;
     }
-    // Step 4. Then search for memory block that is smaller than the requested size.
+    // Step 5. Then search for memory block that is smaller than the requested size.
     if (mid != begin) {
       --mid;
       StorageToken available_token = mid->second;
@@ -606,8 +676,61 @@ class StorageAllocatorInit : public StorageAllocatorBaseVisitor {
     DiscardTokensIn(body_tokens);
   }
 
+  void VisitBinding_(const MatchCastNode* binding) final {
+    ExprVisitor::VisitBinding_(binding);
+    this->BindMatchCastBounds(binding);
+  }
+
   /******************** Utilities ********************/
 
+  /*! \brief Get the shape values of a tensor or shape type, if they are known. */
+  static ffi::Optional<ffi::Array<PrimExpr>> GetShapeValues(const Type& ty) {
+    if (const auto* tensor_ty = ty.as<TensorTypeNode>()) {
+      if (tensor_ty->shape.has_value()) {
+        if (const auto* shape = tensor_ty->shape.value().as<ShapeExprNode>()) {
+          return shape->values;
+        }
+      }
+    } else if (const auto* shape_ty = ty.as<ShapeTypeNode>()) {
+      return shape_ty->values;
+    }
+    return std::nullopt;
+  }
+
+  /*!
+   * \brief Bound the TIR variables that a match_cast defines by the upper bounds of the
+   * corresponding extents of the value, so that the tensors shaped by these variables
+   * can be planned statically without explicit annotations.
+   * \param binding The match_cast binding.
+   */
+  void BindMatchCastBounds(const MatchCastNode* binding) {
+    ffi::Optional<ffi::Array<PrimExpr>> pattern = GetShapeValues(binding->ty);
+    ffi::Optional<ffi::Array<PrimExpr>> value = GetShapeValues(binding->value->ty);
+    if (!pattern.has_value() || !value.has_value() ||
+        pattern.value().size() != value.value().size()) {
+      return;
+    }
+    for (size_t i = 0; i < pattern.value().size(); ++i) {
+      const auto* var = pattern.value()[i].as<tirx::VarNode>();
+      if (var == nullptr) {
+        continue;
+      }
+      tirx::Var tir_var = ffi::GetRef<tirx::Var>(var);
+      // Keep the bounds from the annotations and the earlier match_casts.
+      if (analyzer_->const_int_bound(tir_var)->max_value != arith::ConstIntBound::kPosInf) {
+        continue;
+      }
+      int64_t max_bound = analyzer_->const_int_bound(value.value()[i])->max_value;
+      if (max_bound == arith::ConstIntBound::kPosInf || max_bound < 0) {
+        continue;
+      }
+      tvm::Range range =
+          tvm::Range::FromMinExtent(tvm::IntImm::Int64(0), tvm::IntImm::Int64(max_bound + 1));
+      analyzer_->Bind(tir_var, range);
+      dom_map_.Set(tir_var, arith::IntSet::FromRange(range));
+    }
+  }
+
   /*!
    * \brief Check if the input op is GlobalVar corresponding to a PrimFunc inside the ctx module.
    * \param op The op to be checked
@@ -756,12 +879,14 @@ class StorageAllocatorInit : public StorageAllocatorBaseVisitor {
 class StorageAllocator : public StorageAllocatorBaseVisitor {
  public:
   explicit StorageAllocator(std::unordered_map<const ExprNode*, Tokens> token_map,
-                            arith::AnalyzerObj* analyzer)
-      : allocator_(analyzer) {
+                            arith::AnalyzerObj* analyzer, bool plan_arena)
+      : allocator_(analyzer), plan_arena_(plan_arena) {
     this->token_map_ = std::move(token_map);
   }
 
   void Allocate(const IRModule& mod) {
+    std::unordered_map<std::string, int64_t> group_peak_bytes;
+    std::unordered_map<const GlobalVarNode*, std::vector<int>> func_arenas;
     for (auto it : mod->functions) {
       const auto* func = it.second.as<FunctionNode>();
       if (func == nullptr) {
@@ -769,10 +894,42 @@ class StorageAllocator : public StorageAllocatorBaseVisitor {
       }
       // Clear the allocator to make the planning of different functions independent.
       allocator_.Clear();
+      cur_func_arenas_.clear();
       this->VisitExpr_(func);
+      if (!plan_arena_) {
+        continue;
+      }
+      int64_t peak_bytes = 0;
+      for (int arena_id : cur_func_arenas_) {
+        peak_bytes = std::max(peak_bytes, arena_bytes[arena_id]);
+      }
+      func_peak_bytes[it.first.get()] = peak_bytes;
+      if (auto group = func->GetAttr<ffi::String>("relax.memory_arena_group")) {
+        int64_t& group_peak = group_peak_bytes[group.value()];
+        group_peak = std::max(group_peak, peak_bytes);
+        func_arenas[it.first.get()] = cur_func_arenas_;
+      }
+    }
+    // The functions of one group never run at the same time, so they can share a single
+    // arena of the peak size of the group.
+    for (const auto& [gvar, arena_ids] : func_arenas) {
+      auto group = mod->Lookup(ffi::GetRef<GlobalVar>(gvar))
+                       ->GetAttr<ffi::String>("relax.memory_arena_group")
+                       .value();
+      for (int arena_id : arena_ids) {
+        arena_bytes[arena_id] = group_peak_bytes.at(group);
+      }
     }
   }
 
+  /*! \brief The placement of a storage token inside an arena. */
+  struct ArenaSlot {
+    /*! \brief The index of the arena in `arena_bytes`. */
+    int arena_id;
+    /*! \brief The byte offset of the token in the arena. */
+    int64_t offset;
+  };
+
   /*!
    * \brief The mapping from each `builtin.alloc_tensor` to its corresponding
    * underlying storage token that it is using.
@@ -780,11 +937,30 @@ class StorageAllocator : public StorageAllocatorBaseVisitor {
   std::unordered_map<const ExprNode*, StorageToken> alloc_tensor2token;
   /*! \brief The mapping from each binding block to the storage tokens that are create inside. */
   std::unordered_map<const BindingBlockNode*, std::vector<const StorageTokenNode*>> block2tokens;
+  /*! \brief The arena placement of each token planned in an arena. */
+  std::unordered_map<const StorageTokenNode*, ArenaSlot> token2arena_slot;
+  /*! \brief The number of bytes of each arena. */
+  std::vector<int64_t> arena_bytes;
+  /*! \brief The planned peak arena bytes of each function, when arenas are planned. */
+  std::unordered_map<const GlobalVarNode*, int64_t> func_peak_bytes;
 
  private:
   using ExprVisitor::VisitBinding_;
   using ExprVisitor::VisitExpr_;
 
+  /*! \brief The live interval of a token planned in an arena. */
+  struct ArenaInterval {
+    StorageToken token;
+    /*! \brief The aligned number of bytes of the token. */
+    int64_t bytes;
+    /*! \brief The binding index at which the token is allocated. */
+    int64_t start;
+    /*! \brief The binding index of the last use of the token. */
+    int64_t end;
+    /*! \brief The planned byte offset in the arena. */
+    int64_t offset;
+  };
+
   void VisitBindingBlock_(const BindingBlockNode* block) final {
     StorageAllocatorBaseVisitor::VisitBindingBlock_(block);
     // Sanity check: each token allocated inside the block should not be
@@ -792,10 +968,17 @@ class StorageAllocator : public StorageAllocatorBaseVisitor {
     for (const StorageTokenNode* token : block2tokens[block]) {
       TVM_FFI_ICHECK_EQ(token->ref_counter, 0);
     }
+    this->PlanBlockArenas(block);
+  }
+
+  void VisitBindingBlock_(const DataflowBlockNode* block) final {
+    StorageAllocatorBaseVisitor::VisitBindingBlock_(block);
+    this->PlanBlockArenas(block);
   }
 
   void VisitBinding_(const VarBindingNode* binding, const CallNode* call) final {
     static const Op& alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
+    ++binding_index_;
     if (call->op.same_as(alloc_tensor_op)) {
       auto it = token_map_.find(call);
       TVM_FFI_ICHECK(it != token_map_.end());
@@ -806,7 +989,22 @@ class StorageAllocator : public StorageAllocatorBaseVisitor {
         return;
       }
       TVM_FFI_ICHECK(it->second.IsLeaf());
-      StorageToken new_token = this->RequestReuseOrAlloc(it->second.LeafValue());
+      StorageToken prototype = it->second.LeafValue();
+      const auto* device_index = call->args[2].as<IntImmNode>();
+      StorageToken new_token{nullptr};
+      if (plan_arena_ && device_index != nullptr && prototype->const_bytes() >= 0 &&
+          prototype->storage_scope == "global" && !prototype->vdevice.has_value()) {
+        // The token gets a slot of its own in the arena of the block instead of a reuse.
+        new_token = allocator_.Alloc(prototype, this->n_storage_++);
+        int64_t aligned_bytes = (new_token->const_bytes() + runtime::kAllocAlignment - 1) /
+                                runtime::kAllocAlignment * runtime::kAllocAlignment;
+        TVM_FFI_ICHECK(!block_stack_.empty());
+        block2arena_intervals_[block_stack_.back()][device_index->value].push_back(
+            ArenaInterval{new_token, aligned_bytes, binding_index_, binding_index_, 0});
+        arena_token_release_[new_token.get()] = binding_index_;
+      } else {
+        new_token = this->RequestReuseOrAlloc(prototype);
+      }
 
       // Record that this alloc_tensor is using the token.
       alloc_tensor2token.insert({call, new_token});
@@ -866,21 +1064,154 @@ class StorageAllocator : public StorageAllocatorBaseVisitor {
     TVM_FFI_ICHECK_GE(token->ref_counter, 0);
 
     if (token->ref_counter == 0) {
-      allocator_.Release(token);
+      auto it_arena = arena_token_release_.find(token.get());
+      if (it_arena != arena_token_release_.end()) {
+        // Arena tokens are never reused as a whole. Only record the end of their lifetime.
+        it_arena->second = binding_index_;
+      } else {
+        allocator_.Release(token);
+      }
       auto it = token2cur_tensor_.find(token.get());
       TVM_FFI_ICHECK(it != token2cur_tensor_.end());
       token2cur_tensor_.erase(it);
     }
   }
 
+  /*! \brief Plan one arena for the tokens of each device allocated inside the block. */
+  void PlanBlockArenas(const BindingBlockNode* block) {
+    auto it = block2arena_intervals_.find(block);
+    if (it == block2arena_intervals_.end()) {
+      return;
+    }
+    for (auto& [device_index, intervals] : it->second) {
+      int arena_id = static_cast<int>(arena_bytes.size());
+      arena_bytes.push_back(this->PackArena(&intervals, arena_id));
+      cur_func_arenas_.push_back(arena_id);
+    }
+    block2arena_intervals_.erase(it);
+  }
+
+  /*!
+   * \brief Assign the offsets of the tokens of one arena with best-fit packing.
+   * \param intervals The live intervals of the tokens in the arena.
+   * \param arena_id The index of the arena.
+   * \return The number of bytes of the arena.
+   */
+  int64_t PackArena(std::vector<ArenaInterval>* intervals, int arena_id) {
+    for (ArenaInterval& interval : *intervals) {
+      interval.end = arena_token_release_.at(interval.token.get());
+    }
+    // Place the larger tokens first, each into the tightest gap left by the already placed
+    // tokens whose lifetime interferes with it.
+    std::stable_sort(intervals->begin(), intervals->end(),
+                     [](const ArenaInterval& a, const ArenaInterval& b) {
+                       return a.bytes > b.bytes;
+                     });
+    int64_t total_bytes = 0;
+    for (size_t i = 0; i < intervals->size(); ++i) {
+      ArenaInterval& cur = (*intervals)[i];
+      std::vector<const ArenaInterval*> conflicts;
+      for (size_t j = 0; j < i; ++j) {
+        const ArenaInterval& other = (*intervals)[j];
+        if (other.start <= cur.end && cur.start <= other.end) {
+          conflicts.push_back(&other);
+        }
+      }
+      std::sort(conflicts.begin(), conflicts.end(),
+                [](const ArenaInterval* a, const ArenaInterval* b) {
+                  return a->offset < b->offset;
+                });
+      int64_t best_offset = -1;
+      int64_t best_gap = std::numeric_limits<int64_t>::max();
+      int64_t prev_end = 0;
+      for (const ArenaInterval* other : conflicts) {
+        int64_t gap = other->offset - prev_end;
+        if (gap >= cur.bytes && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+        prev_end = std::max(prev_end, other->offset + other->bytes);
+      }
+      cur.offset = best_offset == -1 ? prev_end : best_offset;
+      total_bytes = std::max(total_bytes, cur.offset + cur.bytes);
+      token2arena_slot[cur.token.get()] = ArenaSlot{arena_id, cur.offset};
+    }
+    return total_bytes;
+  }
+
   /*! \brief Number of allocated storages. */
   int n_storage_{0};
   /*! \brief The 1D memory allocator. */
   TokenAllocatorMixed allocator_;
   /*! \brief The mapping from each token to the tensors that are currently using it. */
   std::unordered_map<const StorageTokenNode*, std::vector<Var>> token2cur_tensor_;
+  /*! \brief A boolean indicating whether to plan constant-size tokens in arenas. */
+  bool plan_arena_;
+  /*! \brief The index of the call binding being visited, as the clock of token lifetimes. */
+  int64_t binding_index_{0};
+  /*! \brief The arena tokens of each binding block and device index. */
+  std::unordered_map<const BindingBlockNode*, std::map<int64_t, std::vector<ArenaInterval>>>
+      block2arena_intervals_;
+  /*! \brief The binding index of the last use of each arena token. */
+  std::unordered_map<const StorageTokenNode*, int64_t> arena_token_release_;
+  /*! \brief The arenas planned in the function being visited. */
+  std::vector<int> cur_func_arenas_;
 };
 
+/*!
+ * \brief Collect the builtin alloc_tensors of a function whose tensors are returned as they are.
+ * \param func The function to be analyzed.
+ * \return The allocations in the order of the flattened return value, or nullopt if some
+ * returned tensor is not such an allocation, or its shape is not defined by the parameters.
+ */
+ffi::Optional<ffi::Array<Call>> CollectOutputAllocs(const Function& func) {
+  static const Op& alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
+  const auto* seq = func->body.as<SeqExprNode>();
+  if (seq == nullptr) {
+    return std::nullopt;
+  }
+  std::unordered_map<const VarNode*, Expr> var2value;
+  for (const BindingBlock& block : seq->blocks) {
+    for (const Binding& binding : block->bindings) {
+      if (const auto* var_binding = binding.as<VarBindingNode>()) {
+        var2value[var_binding->var.get()] = var_binding->value;
+      }
+    }
+  }
+  std::unordered_set<const tirx::VarNode*> param_tir_vars;
+  for (const Var& param : func->params) {
+    for (const tirx::Var& tir_var : DefinableTIRVarsInType(GetType(param))) {
+      param_tir_vars.insert(tir_var.get());
+    }
+  }
+
+  ffi::Array<Call> allocs;
+  std::unordered_set<const CallNode*> visited;
+  std::function<bool(Expr)> f_collect = [&](Expr expr) -> bool {
+    while (const auto* var = expr.as<VarNode>()) {
+      auto it = var2value.find(var);
+      if (it == var2value.end()) return false;
+      expr = it->second;
+    }
+    if (const auto* tuple = expr.as<TupleNode>()) {
+      return std::all_of(tuple->fields.begin(), tuple->fields.end(), f_collect);
+    }
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr || !call->op.same_as(alloc_tensor_op) || !visited.insert(call).second) {
+      return false;
+    }
+    for (const tirx::Var& tir_var : TIRVarsInType(call->ty)) {
+      if (!param_tir_vars.count(tir_var.get())) return false;
+    }
+    allocs.push_back(ffi::GetRef<Call>(call));
+    return true;
+  };
+  if (!f_collect(seq->body)) {
+    return std::nullopt;
+  }
+  return allocs;
+}
+
 /*!
  * \brief The rewriter class based on the token allocation planning.
  * \details
@@ -892,10 +1223,17 @@ class StorageAllocationRewriter : public ExprMutator {
   explicit StorageAllocationRewriter(
       IRModule mod, std::unordered_map<const ExprNode*, StorageToken> alloc_tensor2token,
       std::unordered_map<const BindingBlockNode*, std::vector<const StorageTokenNode*>>
-          block2tokens)
+          block2tokens,
+      std::unordered_map<const StorageTokenNode*, StorageAllocator::ArenaSlot> token2arena_slot,
+      std::vector<int64_t> arena_bytes,
+      std::unordered_map<const GlobalVarNode*, int64_t> func_peak_bytes, bool output_params)
       : ExprMutator(std::move(mod)),
         alloc_tensor2token_(std::move(alloc_tensor2token)),
-        block2tokens_(std::move(block2tokens)) {}
+        block2tokens_(std::move(block2tokens)),
+        token2arena_slot_(std::move(token2arena_slot)),
+        arena_bytes_(std::move(arena_bytes)),
+        func_peak_bytes_(std::move(func_peak_bytes)),
+        output_params_(output_params) {}
 
   IRModule Rewrite() {
     const IRModule& mod = builder_->GetContextIRModule();
@@ -911,10 +1249,36 @@ class StorageAllocationRewriter : public ExprMutator {
         SetTIRVarRangeConstraints(ffi::GetRef<Function>(func_), ana_.get(), &dom_map_);
       }
       token2storage_var_.clear();
+      output_alloc2param_.clear();
+      ffi::Array<Var> output_params;
+      if (output_params_ && func_->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol).has_value()) {
+        // The returned tensors are owned by the caller, who passes them as the output parameters.
+        if (auto allocs = CollectOutputAllocs(ffi::GetRef<Function>(func_))) {
+          for (const Call& alloc : allocs.value()) {
+            std::string name = runtime::vm::VMFuncInfo::kOutputParamPrefix +
+                               std::to_string(output_params.size());
+            Var param(name, alloc->ty);
+            output_alloc2param_[alloc.get()] = param;
+            output_params.push_back(param);
+          }
+        }
+      }
       Function func = this->VisitExpr_(func_).as_or_throw<Function>();
+      if (!output_params.empty()) {
+        ffi::Array<Var> params = func->params;
+        for (const Var& param : output_params) {
+          params.push_back(param);
+        }
+        func = WithAttr(Function(params, func->body, func->ret_ty, func->is_pure, func->attrs,
+                                 func->span),
+                        "relax.num_output_params", IntImm::Int64(output_params.size()));
+      }
       if (plan_dynamic_output_) {
         func = WithoutAttr(func, plan_dyn_attr_);
       }
+      if (auto it = func_peak_bytes_.find(gv.get()); it != func_peak_bytes_.end()) {
+        func = WithAttr(func, "relax.memory_plan_peak_bytes", IntImm::Int64(it->second));
+      }
       builder_->UpdateFunction(gv, func);
     }
     return builder_->GetContextIRModule();
@@ -927,6 +1291,10 @@ class StorageAllocationRewriter : public ExprMutator {
     static const Op& alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
     static const Op& mem_alloc_storage = Op::Get("relax.memory.alloc_storage");
     static const Op& mem_alloc_tensor = Op::Get("relax.memory.alloc_tensor");
+    if (auto it_param = output_alloc2param_.find(call); it_param != output_alloc2param_.end()) {
+      // Case 0. The returned tensor is the buffer passed by the caller.
+      return it_param->second;
+    }
     auto it = alloc_tensor2token_.find(call);
     if (it != alloc_tensor2token_.end()) {
       // Case 1. This `alloc_tensor` is planned for memory reuse.
@@ -936,9 +1304,33 @@ class StorageAllocationRewriter : public ExprMutator {
       TVM_FFI_ICHECK_NOTNULL(ty->shape.as<ShapeExprNode>());
       PrimExpr runtime_device_index = call->args[2].as_or_throw<PrimExpr>();
 
+      StorageToken token = it->second;
+      if (auto it_slot = token2arena_slot_.find(token.get()); it_slot != token2arena_slot_.end()) {
+        // The tensor lives at its planned offset of the arena of its block. The arena is
+        // allocated as a byte storage at its first use.
+        const StorageAllocator::ArenaSlot& slot = it_slot->second;
+        Var arena_var{nullptr};
+        auto it_arena = arena2storage_var_.find(slot.arena_id);
+        if (it_arena == arena2storage_var_.end()) {
+          Call alloc_storage(Type::Missing(), mem_alloc_storage,
+                             {ShapeExpr({IntImm::Int64(arena_bytes_[slot.arena_id])}),
+                              runtime_device_index, StringImm("global"),
+                              DataTypeImm(DLDataType{kDLUInt, 8, 1})},
+                             Attrs());
+          arena_var = builder_->Emit(alloc_storage, "storage");
+          arena2storage_var_[slot.arena_id] = arena_var;
+        } else {
+          arena_var = it_arena->second;
+        }
+        DLDataType dtype = ty->dtype.value()->dtype;
+        return Call(Type::Missing(), mem_alloc_tensor,
+                    {arena_var, IntImm::Int64(slot.offset), ty->shape.value(), DataTypeImm(dtype),
+                     call->args[2]},
+                    Attrs());
+      }
+
       // If the token is visited for the first time, create a storage variable using
       // `memory.alloc_storage` for it.
-      StorageToken token = it->second;
       Var storage_var{nullptr};
       auto it_token = token2storage_var_.find(token.get());
       if (it_token == token2storage_var_.end()) {
@@ -1020,21 +1412,36 @@ class StorageAllocationRewriter : public ExprMutator {
   std::unordered_map<const BindingBlockNode*, std::vector<const StorageTokenNode*>> block2tokens_;
   /*! \brief The mapping from each token to its corresponding storage var in each function. */
   std::unordered_map<const StorageTokenNode*, Var> token2storage_var_;
+  /*! \brief The arena placement of each token planned in an arena. */
+  std::unordered_map<const StorageTokenNode*, StorageAllocator::ArenaSlot> token2arena_slot_;
+  /*! \brief The number of bytes of each arena. */
+  std::vector<int64_t> arena_bytes_;
+  /*! \brief The planned peak arena bytes of each function, reported as a function attribute. */
+  std::unordered_map<const GlobalVarNode*, int64_t> func_peak_bytes_;
+  /*! \brief The mapping from each arena to its storage var. */
+  std::unordered_map<int, Var> arena2storage_var_;
+  /*! \brief A boolean indicating whether to turn the returned tensors into output parameters. */
+  bool output_params_;
+  /*! \brief The mapping from each returned `builtin.alloc_tensor` to its output parameter. */
+  std::unordered_map<const CallNode*, Var> output_alloc2param_;
 };
 
-IRModule StaticPlanBlockMemory(IRModule mod) {
+IRModule StaticPlanBlockMemory(IRModule mod, bool plan_arena, bool output_params) {
   arith::Analyzer ana;
 
   // Step 1. Initialize.
   std::unordered_map<const ExprNode*, Tokens> token_map =
       StorageAllocatorInit::Initialize(mod, ana.get());
   // Step 2. Collect the memory allocation info.
-  StorageAllocator allocator(std::move(token_map), ana.get());
+  StorageAllocator allocator(std::move(token_map), ana.get(), plan_arena);
   allocator.Allocate(mod);
   // Step 3. Rewrite the function.
   StorageAllocationRewriter rewriter(std::move(mod),  //
                                      std::move(allocator.alloc_tensor2token),
-                                     std::move(allocator.block2tokens));
+                                     std::move(allocator.block2tokens),
+                                     std::move(allocator.token2arena_slot),
+                                     std::move(allocator.arena_bytes),
+                                     std::move(allocator.func_peak_bytes), output_params);
   return rewriter.Rewrite();
 }
 
@@ -1042,7 +1449,9 @@ namespace transform {
 
 Pass StaticPlanBlockMemory() {
   auto pass_func = [=](IRModule m, PassContext pc) {
-    return relax::StaticPlanBlockMemory(std::move(m));
+    bool plan_arena = pc->GetConfig<bool>("relax.memory_plan_arena", false).value();
+    bool output_params = pc->GetConfig<bool>("relax.memory_output_params", false).value();
+    return relax::StaticPlanBlockMemory(std::move(m), plan_arena, output_params);
   };
   return CreateModulePass(pass_func, /*opt_level=*/0, "StaticPlanBlockMemory", {});
 }
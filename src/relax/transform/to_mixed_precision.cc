@@ -27,9 +27,12 @@
 #include <tvm/relax/op_attr_types.h>
 #include <tvm/relax/transform.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "../op/nn/convolution.h"
 #include "../op/tensor/datatype.h"
@@ -50,6 +53,81 @@ int GetMixedPrecisionInfo(const CallNode* call_node) {
   return attr_map.count(op) ? attr_map[op] : MixedPrecisionPolicyKind::kNever;
 }
 
+/*! \brief The policy of the call bound to the var, which is kNever if the var is kept in fp32. */
+int GetMixedPrecisionInfo(const CallNode* call_node, const Var& var,
+                          const std::unordered_set<Var>& keep_fp32) {
+  int policy = GetMixedPrecisionInfo(call_node);
+  if (policy != -1 && keep_fp32.count(var)) return MixedPrecisionPolicyKind::kNever;
+  return policy;
+}
+
+/*! \brief Collect the vars bound to calls, in the order of the bindings. */
+class CallBindingCollector : public ExprVisitor {
+ public:
+  static std::vector<std::pair<Var, Call>> Collect(const Function& func) {
+    CallBindingCollector collector;
+    collector.VisitExpr(func);
+    return std::move(collector.bindings_);
+  }
+
+ private:
+  void VisitBinding_(const VarBindingNode* binding, const CallNode* call_node) final {
+    bindings_.emplace_back(binding->var, ffi::GetRef<Call>(call_node));
+    ExprVisitor::VisitBinding_(binding, call_node);
+  }
+
+  std::vector<std::pair<Var, Call>> bindings_;
+};
+
+/*!
+ * \brief Choose the calls to keep in fp32 from the profile of a calibration run.
+ *
+ * The profile maps the name of the var a call is bound to to the pair (error, speedup): the
+ * numerical error the call adds to the outputs when run in fp16, and the time it saves. The calls
+ * that do not save time are kept in fp32. The others are all converted, and while their total
+ * error exceeds the budget, the call with the least speedup per unit of error is kept in fp32,
+ * which is the greedy solution of the knapsack maximizing the speedup within the budget. The calls
+ * the profile does not mention follow their op policies as usual.
+ */
+std::unordered_set<Var> SelectFP32Calls(const Function& func,
+                                        const ffi::Map<ffi::String, ffi::Array<double>>& profile,
+                                        double error_budget) {
+  struct Candidate {
+    Var var;
+    double error;
+    double speedup;
+  };
+  std::vector<Candidate> candidates;
+  std::unordered_set<Var> keep_fp32;
+  for (const auto& [var, value] : CallBindingCollector::Collect(func)) {
+    auto it = profile.find(var->name_hint());
+    if (it == profile.end()) continue;
+    ffi::Array<double> measure = (*it).second;
+    TVM_FFI_CHECK(measure.size() == 2, ValueError)
+        << "The profile of " << var->name_hint() << " must be the pair (error, speedup), but got "
+        << measure.size() << " values";
+    if (measure[1] <= 0) {
+      keep_fp32.insert(var);
+    } else {
+      candidates.push_back({var, measure[0], measure[1]});
+    }
+  }
+  double total_error = 0;
+  for (const Candidate& candidate : candidates) total_error += candidate.error;
+  // The least speedup per unit of error first, comparing a / b < c / d as a * d < c * b.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& lhs, const Candidate& rhs) {
+                     return lhs.speedup * rhs.error < rhs.speedup * lhs.error;
+                   });
+  for (const Candidate& candidate : candidates) {
+    if (total_error <= error_budget) break;
+    if (candidate.error <= 0) continue;
+    keep_fp32.insert(candidate.var);
+    total_error -= candidate.error;
+  }
+  return keep_fp32;
+}
+
 /*!
  * \brief Main logic to automatically cast fp32 input modules to fp16 for certain ops.
  *
@@ -116,10 +194,13 @@ int GetMixedPrecisionInfo(const CallNode* call_node) {
  */
 class DTypeDecisionCollector : public ExprVisitor {
  public:
-  explicit DTypeDecisionCollector(DLDataType output_dtype) : output_dtype_(output_dtype) {}
+  explicit DTypeDecisionCollector(DLDataType output_dtype,
+                                  const std::unordered_set<Var>& keep_fp32)
+      : output_dtype_(output_dtype), keep_fp32_(keep_fp32) {}
 
-  static VarDTypeMap Collect(Function func, DLDataType output_dtype) {
-    DTypeDecisionCollector collector(output_dtype);
+  static VarDTypeMap Collect(Function func, DLDataType output_dtype,
+                             const std::unordered_set<Var>& keep_fp32) {
+    DTypeDecisionCollector collector(output_dtype, keep_fp32);
     collector.VisitExpr(func);
     return std::move(collector.only_fp16_map_);
   }
@@ -191,7 +272,7 @@ class DTypeDecisionCollector : public ExprVisitor {
   void VisitExpr_(const VarNode* op) final { VisitVars_(op); }
 
   void VisitBinding_(const VarBindingNode* binding, const CallNode* call_node) final {
-    auto policy = GetMixedPrecisionInfo(call_node);
+    auto policy = GetMixedPrecisionInfo(call_node, binding->var, keep_fp32_);
     if (policy == -1) {
       ExprVisitor::VisitBinding_(binding, call_node);
       return;
@@ -266,16 +347,19 @@ class DTypeDecisionCollector : public ExprVisitor {
   DLDataType fp16_ = DLDataType{kDLFloat, 16, 1};
   DLDataType fp32_ = DLDataType{kDLFloat, 32, 1};
   DLDataType output_dtype_;
+  const std::unordered_set<Var>& keep_fp32_;
   VarDTypeMap only_fp16_map_;
 };
 
 class ToMixedPrecisionRewriter : public ExprMutator {
  public:
   explicit ToMixedPrecisionRewriter(const VarDTypeMap* only_fp16_map, DLDataType output_dtype,
-                                    const std::unordered_set<std::string>& fp16_input_names)
+                                    const std::unordered_set<std::string>& fp16_input_names,
+                                    const std::unordered_set<Var>& keep_fp32)
       : only_fp16_map_(only_fp16_map),
         output_dtype_(output_dtype),
-        fp16_input_names_(fp16_input_names) {}
+        fp16_input_names_(fp16_input_names),
+        keep_fp32_(keep_fp32) {}
 
  private:
   Var GetRemapped(const Var& var) {
@@ -457,7 +541,7 @@ class ToMixedPrecisionRewriter : public ExprMutator {
       ExprMutator::VisitBinding_(binding, call_node);
       return;
     }
-    auto policy = GetMixedPrecisionInfo(call_node);
+    auto policy = GetMixedPrecisionInfo(call_node, binding->var, keep_fp32_);
     if (policy == -1) {
       // not an op call
       ExprMutator::VisitBinding_(binding, call_node);
@@ -597,27 +681,37 @@ class ToMixedPrecisionRewriter : public ExprMutator {
   DLDataType output_dtype_;
   ffi::Array<Var> params_;
   std::unordered_set<std::string> fp16_input_names_;
+  const std::unordered_set<Var>& keep_fp32_;
 
   const Op& wrap_param_op = Op::Get("relax.wrap_param");
 };
 
 Expr ToMixedPrecision(const Function& f, DLDataType out_dtype,
-                      ffi::Optional<ffi::Array<ffi::String>> fp16_input_names) {
-  VarDTypeMap only_fp16_map = DTypeDecisionCollector::Collect(f, out_dtype);
+                      ffi::Optional<ffi::Array<ffi::String>> fp16_input_names,
+                      ffi::Optional<ffi::Map<ffi::String, ffi::Array<double>>> op_profile,
+                      double error_budget) {
+  std::unordered_set<Var> keep_fp32;
+  if (op_profile) {
+    keep_fp32 = SelectFP32Calls(f, op_profile.value(), error_budget);
+  }
+  VarDTypeMap only_fp16_map = DTypeDecisionCollector::Collect(f, out_dtype, keep_fp32);
   std::unordered_set<std::string> fp16_input_names_set;
   if (fp16_input_names) {
     fp16_input_names_set.insert(fp16_input_names.value().begin(), fp16_input_names.value().end());
   }
-  ToMixedPrecisionRewriter mutator(&only_fp16_map, out_dtype, fp16_input_names_set);
+  ToMixedPrecisionRewriter mutator(&only_fp16_map, out_dtype, fp16_input_names_set, keep_fp32);
   return mutator(f);
 }
 
 namespace transform {
 
 Pass ToMixedPrecision(DLDataType out_dtype,
-                      ffi::Optional<ffi::Array<ffi::String>> fp16_input_names) {
+                      ffi::Optional<ffi::Array<ffi::String>> fp16_input_names,
+                      ffi::Optional<ffi::Map<ffi::String, ffi::Array<double>>> op_profile,
+                      double error_budget) {
   auto pass_func = [=](Function f, IRModule m, PassContext pc) {
-    return ToMixedPrecision(f, out_dtype, fp16_input_names).as_or_throw<Function>();
+    return ToMixedPrecision(f, out_dtype, fp16_input_names, op_profile, error_budget)
+        .as_or_throw<Function>();
   };
   return CreateFunctionPass(pass_func, 0, "ToMixedPrecision", {});
 }
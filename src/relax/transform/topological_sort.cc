@@ -26,6 +26,7 @@
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
 #include <tvm/relax/type.h>
+#include <tvm/relax/utils.h>
 
 #include <algorithm>
 #include <deque>
@@ -77,6 +78,8 @@ namespace {
 enum class TraversalOrder {
   DepthFirst,
   BreadthFirst,
+  /* Greedily emit the ready binding that least increases the live tensor bytes. */
+  MinMemory,
 };
 
 enum class StartingLocation {
@@ -168,6 +171,29 @@ class BindingOrderCollector : ExprVisitor {
   Dependencies dependencies_;
 };
 
+/*! \brief The statically known size in bytes of a tensor, or tuple of tensors, or zero. */
+int64_t GetStaticBytes(const Type& ty) {
+  if (const auto* tuple_ty = ty.as<TupleTypeNode>()) {
+    int64_t bytes = 0;
+    for (const Type& field : tuple_ty->fields) bytes += GetStaticBytes(field);
+    return bytes;
+  }
+  const auto* tensor_ty = ty.as<TensorTypeNode>();
+  if (tensor_ty == nullptr || tensor_ty->IsUnknownDtype() || !tensor_ty->shape.has_value()) {
+    return 0;
+  }
+  const auto* shape = tensor_ty->shape.value().as<ShapeExprNode>();
+  if (shape == nullptr) return 0;
+  DLDataType dtype = tensor_ty->dtype.value()->dtype;
+  int64_t bytes = (static_cast<int64_t>(dtype.bits) * dtype.lanes + 7) / 8;
+  for (const PrimExpr& dim : shape->values) {
+    const auto* int_dim = dim.as<IntImmNode>();
+    if (int_dim == nullptr) return 0;
+    bytes *= int_dim->value;
+  }
+  return bytes;
+}
+
 class TopologicalSorter : public ExprMutator {
  public:
   TopologicalSorter(TraversalOrder order, StartingLocation starting_location)
@@ -256,6 +282,62 @@ class TopologicalSorter : public ExprMutator {
 
     std::unordered_set<DataflowNode> visited;
 
+    // For the memory-aware order, the bytes allocated by each binding of the block and its
+    // position in the original order, used to break ties.  Only calls allocate; other
+    // bindings such as tuple accesses alias an existing allocation.
+    std::unordered_map<DataflowNode, int64_t> allocated_bytes;
+    std::unordered_map<DataflowNode, size_t> original_index;
+    if (order_ == TraversalOrder::MinMemory) {
+      for (size_t i = 0; i < block->bindings.size(); ++i) {
+        const Binding& binding = block->bindings[i];
+        original_index[binding->var] = i;
+        allocated_bytes[binding->var] =
+            GetBoundValue(binding)->IsInstance<CallNode>() ? GetStaticBytes(GetType(binding->var))
+                                                           : 0;
+      }
+    }
+
+    // The change of live bytes caused by emitting a binding: its own output becomes live, and
+    // every input of the block whose other users were all emitted is released.
+    auto memory_delta = [&](const DataflowNode& node) -> int64_t {
+      auto it_bytes = allocated_bytes.find(node);
+      if (it_bytes == allocated_bytes.end()) return 0;
+      int64_t delta = it_bytes->second;
+      std::unordered_set<DataflowNode> released;
+      for (const auto& input : dependencies_.upstream_requirements[node]) {
+        auto it_input = allocated_bytes.find(input);
+        if (it_input == allocated_bytes.end() || released.count(input)) continue;
+        const auto& users = dependencies_.downstream_users[input];
+        bool last_use = std::all_of(users.begin(), users.end(), [&](const DataflowNode& user) {
+          return user == node || visited.count(user);
+        });
+        if (last_use) {
+          released.insert(input);
+          delta -= it_input->second;
+        }
+      }
+      return delta;
+    };
+
+    auto index = [&](const DataflowNode& node) -> size_t {
+      auto it_index = original_index.find(node);
+      return it_index == original_index.end() ? 0 : it_index->second;
+    };
+    auto pop_min_memory = [&]() -> DataflowNode {
+      auto best = deque.begin();
+      int64_t best_delta = memory_delta(*best);
+      for (auto it = std::next(deque.begin()); it != deque.end(); ++it) {
+        int64_t delta = memory_delta(*it);
+        if (delta < best_delta || (delta == best_delta && index(*it) < index(*best))) {
+          best = it;
+          best_delta = delta;
+        }
+      }
+      DataflowNode node = *best;
+      deque.erase(best);
+      return node;
+    };
+
     // Given a variable that has just been defined (or std::nullopt for the
     // function's output), mark nodes as ready to visit.
     auto push_descendents_to_stack = [&](const DataflowNode& var) {
@@ -298,6 +380,10 @@ class TopologicalSorter : public ExprMutator {
           deque.pop_front();
           break;
         }
+        case TraversalOrder::MinMemory: {
+          visiting = pop_min_memory();
+          break;
+        }
         default: {
           TVM_FFI_THROW(InternalError)
               << "Invalid value for TraversalOrder: " << static_cast<int>(order_);
@@ -363,10 +449,13 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                               return TraversalOrder::DepthFirst;
                             } else if (order_str == "breadth-first") {
                               return TraversalOrder::BreadthFirst;
+                            } else if (order_str == "min-memory") {
+                              return TraversalOrder::MinMemory;
                             } else {
                               TVM_FFI_THROW(ValueError)
                                   << "Invalid value for traversal order: \"" << order_str << "\".  "
-                                  << "Allowed values are \"depth-first\" or \"breadth-first\"";
+                                  << "Allowed values are \"depth-first\", \"breadth-first\" "
+                                  << "or \"min-memory\"";
                             }
                           }();
 
@@ -383,6 +472,10 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                             }
                           }();
 
+                          TVM_FFI_CHECK(order != TraversalOrder::MinMemory ||
+                                            starting_location == StartingLocation::FromInputs,
+                                        ValueError)
+                              << "The \"min-memory\" order only supports \"from-inputs\"";
                           return TopologicalSort(order, starting_location);
                         });
 }
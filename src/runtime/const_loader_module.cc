@@ -41,7 +41,9 @@
 #include <tvm/support/io.h>
 
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -50,16 +52,54 @@
 namespace tvm {
 namespace runtime {
 
+namespace {
+
+/*! \brief Skip over a tensor written by Tensor::Save, without allocating it. */
+void SkipTensor(support::BytesInStream* strm) {
+  uint64_t header, reserved;
+  Device dev;
+  int ndim;
+  DLDataType dtype;
+  TVM_FFI_ICHECK(strm->Read(&header) && strm->Read(&reserved) && header == kTVMTensorMagic)
+      << "Invalid DLTensor file format";
+  TVM_FFI_ICHECK(strm->Read(&dev) && strm->Read(&ndim) && strm->Read(&dtype))
+      << "Invalid DLTensor file format";
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    TVM_FFI_ICHECK(strm->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+  }
+  int64_t data_byte_size;
+  TVM_FFI_ICHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
+  TVM_FFI_ICHECK_EQ(strm->Skip(data_byte_size), static_cast<size_t>(data_byte_size))
+      << "Invalid DLTensor file format";
+}
+
+}  // namespace
+
 /*!
  * \brief The const-loader module is designed to manage initialization of the
  * imported submodules for the C++ runtime.
+ *
+ * A submodule is initialized on the first call of its function, and the constants of a loaded
+ * module are deserialized when the first submodule that needs them is initialized.  The
+ * constants with identical serialized content are loaded once and shared by every submodule
+ * that references them.
  */
 class ConstLoaderModuleObj : public ffi::ModuleObj {
  public:
+  /*! \brief A constant, either loaded or still serialized in the bytes of the module. */
+  struct Constant {
+    Tensor tensor;
+    std::string_view serialized;
+  };
+
   ConstLoaderModuleObj(
-      const std::unordered_map<std::string, Tensor>& const_var_tensor,
-      const std::unordered_map<std::string, std::vector<std::string>>& const_vars_by_symbol)
-      : const_var_tensor_(const_var_tensor), const_vars_by_symbol_(const_vars_by_symbol) {
+      const std::unordered_map<std::string, Constant>& constants,
+      const std::unordered_map<std::string, std::vector<std::string>>& const_vars_by_symbol,
+      ffi::Bytes bytes = ffi::Bytes())
+      : constants_(constants),
+        const_vars_by_symbol_(const_vars_by_symbol),
+        bytes_(std::move(bytes)) {
     VLOG(1) << "Creating ConstLoaderModule";
     // Only the related submodules are cached to reduce the number of runtime
     // symbol lookup for initialization. Otherwise, symbols/primitives in the
@@ -68,30 +108,25 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
       for (const auto& var : kv.second) {
         VLOG(1) << "ConstLoaderModuleNode has constant '" << var << "' for function '" << kv.first
                 << "'";
-        TVM_FFI_ICHECK_GT(const_var_tensor_.count(var), 0)
+        TVM_FFI_ICHECK_GT(constants_.count(var), 0)
             << "ConstLoaderModuleNode is missing entry for constant '" << var << "' for function '"
             << kv.first << "'";
       }
-      initialized_[kv.first] = false;
+      // Constructed in place, and never rehashed afterwards.
+      initialized_[kv.first];
     }
   }
 
   ffi::Optional<ffi::Function> GetFunction(const ffi::String& name) final {
     VLOG(1) << "ConstLoaderModuleNode::GetFunction(" << name << ")";
-    // Initialize and memoize the module.
-    // Usually, we have some warmup runs. The module initialization should be
-    // done at this stage. Therefore, runtime overhead is not a concern.
-    if (initialized_.count(name) && !initialized_.at(name)) {
-      this->InitSubModule(name);
-      initialized_[name] = true;
-    }
     ffi::ObjectRef _self = ffi::GetRef<ffi::ObjectRef>(this);
 
     if (name == "get_const_var_tensor") {
       return ffi::Function([_self, this](ffi::PackedArgs args, ffi::Any* rv) {
+        std::lock_guard<std::mutex> lock(mutex_);
         ffi::Map<ffi::String, ffi::Any> ret_map;
-        for (const auto& kv : const_var_tensor_) {
-          ret_map.Set(kv.first, kv.second);
+        for (const auto& kv : constants_) {
+          ret_map.Set(kv.first, GetConstant(kv.first));
         }
         *rv = ret_map;
       });
@@ -103,7 +138,17 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
     TVM_FFI_ICHECK(!this->imports_.empty());
     for (const Any& it : this->imports_) {
       ffi::Optional<ffi::Function> pf = it.cast<ffi::Module>()->GetFunction(name);
-      if (pf.has_value()) return pf.value();
+      if (!pf.has_value()) continue;
+      auto init_it = initialized_.find(std::string(name));
+      if (init_it == initialized_.end()) return pf.value();
+      // Initialize the submodule with its constants on the first call, so that
+      // the functions that never run never load their constants.
+      std::once_flag* initialized = &init_it->second;
+      return ffi::Function([_self, this, initialized, symbol = std::string(name),
+                            f = pf.value()](ffi::PackedArgs args, ffi::Any* rv) {
+        std::call_once(*initialized, [this, &symbol]() { this->InitSubModule(symbol); });
+        f.CallPacked(args, rv);
+      });
     }
     return std::nullopt;
   }
@@ -119,14 +164,15 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
    * \return The list of needed Tensor.
    */
   ffi::Array<Tensor> GetRequiredConstants(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
     ffi::Array<Tensor> ret;
-    TVM_FFI_ICHECK_GT(const_vars_by_symbol_.count(symbol), 0U)
+    auto it = const_vars_by_symbol_.find(symbol);
+    TVM_FFI_ICHECK(it != const_vars_by_symbol_.end())
         << "No constants known for function '" << symbol << "'";
-    std::vector<std::string> vars = const_vars_by_symbol_[symbol];
-    for (const auto& var : vars) {
-      TVM_FFI_ICHECK_GT(const_var_tensor_.count(var), 0U)
+    for (const auto& var : it->second) {
+      TVM_FFI_ICHECK_GT(constants_.count(var), 0U)
           << "No such constant variable '" << var << "' for function '" << symbol << "'";
-      ret.push_back(const_var_tensor_[var]);
+      ret.push_back(GetConstant(var));
     }
     return ret;
   }
@@ -165,20 +211,24 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
     support::BytesOutStream stream(&result);
 
     std::vector<std::string> variables;
-    std::vector<Tensor> const_var_tensor;
-    for (const auto& it : const_var_tensor_) {
-      ffi::String var_name = it.first;
-      variables.push_back(var_name);
-      const_var_tensor.push_back(it.second);
+    std::vector<const Constant*> constants;
+    for (const auto& it : constants_) {
+      variables.push_back(it.first);
+      constants.push_back(&it.second);
     }
 
     // Save all variables in the function.
     stream.Write(variables);
-    // Save all constant data.
-    uint64_t sz = static_cast<uint64_t>(const_var_tensor.size());
+    // Save all constant data.  The constants that were never loaded are
+    // copied from the bytes they were loaded from.
+    uint64_t sz = static_cast<uint64_t>(constants.size());
     stream.Write(sz);
     for (uint64_t i = 0; i < sz; i++) {
-      const_var_tensor[i].Save(&stream);
+      if (constants[i]->tensor.defined()) {
+        constants[i]->tensor.Save(&stream);
+      } else {
+        stream.Write(constants[i]->serialized.data(), constants[i]->serialized.size());
+      }
     }
 
     // Save the symbol to list of required constant variables mapping
@@ -208,18 +258,14 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
     TVM_FFI_ICHECK(stream.Read(&sz, sizeof(sz))) << "Loading number of vars failed";
     TVM_FFI_ICHECK_EQ(static_cast<size_t>(sz), variables.size())
         << "The number of variables and ndarray counts must match";
-    // Load the list of ndarray.
-    std::vector<Tensor> arrays;
+    // Record where each ndarray is serialized, to load it on first use.
+    std::unordered_map<std::string, Constant> constants;
     for (uint64_t i = 0; i < sz; i++) {
-      Tensor temp;
-      temp.Load(&stream);
-      arrays.push_back(temp);
-    }
-
-    std::unordered_map<std::string, Tensor> const_var_tensor;
-    for (uint64_t i = 0; i < sz; i++) {
-      TVM_FFI_ICHECK_EQ(const_var_tensor.count(variables[i]), 0U);
-      const_var_tensor[variables[i]] = arrays[i];
+      size_t begin = stream.Tell();
+      SkipTensor(&stream);
+      TVM_FFI_ICHECK_EQ(constants.count(variables[i]), 0U);
+      constants[variables[i]].serialized =
+          std::string_view(bytes.data() + begin, stream.Tell() - begin);
     }
 
     // Load the symbol to list of required constant variables mapping
@@ -239,26 +285,54 @@ class ConstLoaderModuleObj : public ffi::ModuleObj {
       const_vars_by_symbol[symbols[i]] = const_vars[i];
     }
 
-    auto n = ffi::make_object<ConstLoaderModuleObj>(const_var_tensor, const_vars_by_symbol);
+    // The serialized constants point into the bytes, which the module keeps alive.
+    auto n = ffi::make_object<ConstLoaderModuleObj>(constants, const_vars_by_symbol, bytes);
     return ffi::Module(n);
   }
 
  private:
+  /*!
+   * \brief Get a constant, loading it on first use.  The constants with the
+   *  same serialized content share one Tensor.  Requires mutex_ to be held.
+   */
+  Tensor GetConstant(const std::string& var) {
+    Constant& constant = constants_.at(var);
+    if (!constant.tensor.defined()) {
+      auto [it, inserted] = loaded_by_content_.try_emplace(constant.serialized);
+      if (inserted) {
+        support::BytesInStream stream(constant.serialized.data(), constant.serialized.size());
+        it->second.Load(&stream);
+      }
+      constant.tensor = it->second;
+    }
+    return constant.tensor;
+  }
+
   /*!
    * \brief Record if a module is initialized. It is needed by imported
    * modules using execution engine.
    */
-  std::unordered_map<std::string, bool> initialized_;
-  /*! \brief Variable name to Tensor mapping. */
-  std::unordered_map<std::string, Tensor> const_var_tensor_;
+  std::unordered_map<std::string, std::once_flag> initialized_;
+  /*! \brief Variable name to constant mapping. */
+  std::unordered_map<std::string, Constant> constants_;
   /*! \brief Symbol name to required constant variables mapping. */
   std::unordered_map<std::string, std::vector<std::string>> const_vars_by_symbol_;
+  /*! \brief The bytes the module was loaded from, which hold the constants not loaded yet. */
+  ffi::Bytes bytes_;
+  /*! \brief The loaded constants, by their serialized content. */
+  std::unordered_map<std::string_view, Tensor> loaded_by_content_;
+  /*! \brief Guards the loading of constants by the submodules initialized concurrently. */
+  std::mutex mutex_;
 };
 
 static ffi::Module ConstLoaderModuleCreateImpl(
     const std::unordered_map<std::string, Tensor>& const_var_tensor,
     const std::unordered_map<std::string, std::vector<std::string>>& const_vars_by_symbol) {
-  auto n = ffi::make_object<ConstLoaderModuleObj>(const_var_tensor, const_vars_by_symbol);
+  std::unordered_map<std::string, ConstLoaderModuleObj::Constant> constants;
+  for (const auto& kv : const_var_tensor) {
+    constants[kv.first].tensor = kv.second;
+  }
+  auto n = ffi::make_object<ConstLoaderModuleObj>(constants, const_vars_by_symbol);
   return ffi::Module(n);
 }
 
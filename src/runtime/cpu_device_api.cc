@@ -20,14 +20,18 @@
 /*!
  * \file cpu_device_api.cc
  */
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/error.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/device_api.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
+#include "threading_backend.h"
 #include "workspace_pool.h"
 
 #ifdef __ANDROID__
@@ -38,6 +42,11 @@
 #include <sys/sysinfo.h>
 #endif
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -51,6 +60,12 @@ namespace tvm {
 namespace runtime {
 class CPUDeviceAPI final : public DeviceAPI {
  public:
+  /*!
+   * \brief Constructor.
+   * \param numa_node The NUMA node that the allocations are placed on, -1 for no placement.
+   */
+  explicit CPUDeviceAPI(int numa_node = -1) : numa_node_(numa_node) {}
+
   void SetDevice(Device dev) final {}
   void GetAttr(Device dev, DeviceAttrKind kind, ffi::Any* rv) final {
     if (kind == kExist) {
@@ -93,6 +108,10 @@ class CPUDeviceAPI final : public DeviceAPI {
     }
   }
   void* AllocDataSpace(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) final {
+    if (numa_node_ >= 0) {
+      // the memory policy is set on whole pages
+      alignment = std::max(alignment, kNumaPageSize);
+    }
     void* ptr;
 #if _MSC_VER
     ptr = _aligned_malloc(nbytes, alignment);
@@ -105,6 +124,9 @@ class CPUDeviceAPI final : public DeviceAPI {
     int ret = posix_memalign(&ptr, alignment, nbytes);
     if (ret != 0) throw std::bad_alloc();
 #endif
+    if (numa_node_ >= 0) {
+      BindToNumaNode(ptr, nbytes);
+    }
     return ptr;
   }
 
@@ -130,16 +152,54 @@ class CPUDeviceAPI final : public DeviceAPI {
     return inst;
   }
 
+  /*! \brief Get the device API whose allocations are placed on the given NUMA node. */
+  static CPUDeviceAPI* NumaLocal(int numa_node) {
+    static auto* insts = [] {
+      auto* insts = new std::vector<CPUDeviceAPI*>();
+      for (size_t i = 0; i < threading::NumaNodeCpus().size(); ++i) {
+        insts->push_back(new CPUDeviceAPI(static_cast<int>(i)));
+      }
+      return insts;
+    }();
+    TVM_FFI_ICHECK_LT(numa_node, static_cast<int>(insts->size()));
+    return (*insts)[numa_node];
+  }
+
  protected:
   void CopyDataFromTo(const void* from, size_t from_offset, void* to, size_t to_offset, size_t size,
                       Device dev_from, Device dev_to, DLDataType type_hint,
                       TVMStreamHandle stream) final {
     memcpy(static_cast<char*>(to) + to_offset, static_cast<const char*>(from) + from_offset, size);
   }
+
+ private:
+  static constexpr size_t kNumaPageSize = 4096;
+
+  /*! \brief Prefer the NUMA node of this device API for the pages of the allocation. */
+  void BindToNumaNode(void* ptr, size_t nbytes) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    // MPOL_PREFERRED in <linux/mempolicy.h>
+    constexpr int kMpolPreferred = 1;
+    constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+    std::vector<unsigned long> nodemask(numa_node_ / kBitsPerMask + 1, 0);  // NOLINT(runtime/int)
+    nodemask[numa_node_ / kBitsPerMask] |= 1UL << (numa_node_ % kBitsPerMask);
+    // The kernel reads maxnode - 1 bits of the mask. The placement is only a hint, so a
+    // failure leaves the default first-touch placement.
+    syscall(SYS_mbind, ptr, nbytes, kMpolPreferred, nodemask.data(),
+            nodemask.size() * kBitsPerMask + 1, 0);
+#endif
+  }
+
+  // the NUMA node of the allocations, -1 for no placement
+  int numa_node_;
 };
 
 struct CPUWorkspacePool : public WorkspacePool {
-  CPUWorkspacePool() : WorkspacePool(kDLCPU, CPUDeviceAPI::Global()) {}
+  // With NUMA-aware placement, the pool of each thread allocates on the node of the thread.
+  CPUWorkspacePool()
+      : WorkspacePool(kDLCPU, threading::NumaAwarePlacement()
+                                  ? CPUDeviceAPI::NumaLocal(threading::CurrentNumaNode())
+                                  : CPUDeviceAPI::Global()) {}
 };
 
 static CPUWorkspacePool* CPUWorkspacePoolThreadLocal() {
@@ -157,10 +217,23 @@ void CPUDeviceAPI::FreeWorkspace(Device dev, void* data) {
 
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
-  refl::GlobalDef().def_packed("device_api.cpu", [](ffi::PackedArgs args, ffi::Any* rv) {
-    DeviceAPI* ptr = CPUDeviceAPI::Global();
-    *rv = static_cast<void*>(ptr);
-  });
+  refl::GlobalDef()
+      .def_packed("device_api.cpu",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    DeviceAPI* ptr = CPUDeviceAPI::Global();
+                    *rv = static_cast<void*>(ptr);
+                  })
+      .def("runtime.cpu_workspace_pool_stats", []() {
+        // the counters of the workspace pool of the calling thread
+        WorkspacePoolStats stats = CPUWorkspacePoolThreadLocal()->GetStats();
+        ffi::Map<ffi::String, int64_t> result;
+        result.Set("num_hits", stats.num_hits);
+        result.Set("num_misses", stats.num_misses);
+        result.Set("num_reallocs", stats.num_reallocs);
+        result.Set("allocated_bytes", stats.allocated_bytes);
+        result.Set("free_bytes", stats.free_bytes);
+        return result;
+      });
 }
 }  // namespace runtime
 }  // namespace tvm
@@ -0,0 +1,230 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/cpu_features.cc
+ * \brief Host CPU feature detection and the ISA variant selection of multi-versioned kernels.
+ *
+ * A module built with `codegen.llvm.isa_variants` holds every kernel once per CPU, and the
+ * exported symbol of a kernel dispatches to the first variant whose target features the host
+ * supports, as decided by TVMBackendSelectISAVariant on the first call. The features are
+ * detected by CPUID and XGETBV on x86, so that the extensions whose register state the OS does
+ * not save count as missing, and by the hardware capabilities of the kernel on AArch64.
+ */
+#include "cpu_features.h"
+
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/logging.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TVM_CPU_FEATURES_X86 1
+#include <cpuid.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#elif defined(__aarch64__) && defined(__linux__)
+#define TVM_CPU_FEATURES_AARCH64_LINUX 1
+#include <sys/auxv.h>
+#elif defined(__aarch64__) && defined(__APPLE__)
+#define TVM_CPU_FEATURES_AARCH64_APPLE 1
+#include <sys/sysctl.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+/*! \brief The LLVM target features the runtime detects, on x86 and on AArch64. */
+constexpr const char* kDetectableFeatures[] = {
+    // x86
+    "sse4.2", "avx", "fma", "f16c", "bmi", "bmi2", "avx2", "avxvnni", "avx512f", "avx512dq",
+    "avx512cd", "avx512bw", "avx512vl", "avx512vbmi", "avx512vnni", "avx512bf16", "avx512fp16",
+    "amx-tile", "amx-int8", "amx-bf16", "amx-fp16",
+    // AArch64
+    "fp-armv8", "neon", "fullfp16", "dotprod", "i8mm", "bf16", "sve", "sve2", "sme"};
+
+#if TVM_CPU_FEATURES_X86
+inline bool Bit(unsigned reg, int bit) { return (reg >> bit) & 1u; }
+
+/*! \brief The register state the OS saves on a context switch. */
+uint64_t ReadXCR0() {
+  uint32_t eax = 0, edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+/*! \brief Request the AMX tile data state from Linux, as runtime.amx_init does. */
+bool RequestTileData() {
+#if defined(__linux__) && defined(SYS_arch_prctl)
+  constexpr int kArchReqXCompPerm = 0x1023;
+  constexpr int kXFeatureXTileData = 18;
+  return syscall(SYS_arch_prctl, kArchReqXCompPerm, kXFeatureXTileData) == 0;
+#else
+  return true;
+#endif
+}
+
+void DetectHostFeatures(std::unordered_set<std::string>* features) {
+  auto add = [features](const char* name, bool supported) {
+    if (supported) features->insert(name);
+  };
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return;
+  uint64_t xcr0 = Bit(ecx, 27) ? ReadXCR0() : 0;
+  // The XMM and YMM state, plus the opmask and the upper ZMM state for AVX-512.
+  bool os_avx = (xcr0 & 0x6) == 0x6;
+  bool os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+  add("sse4.2", Bit(ecx, 20));
+  add("fma", Bit(ecx, 12) && os_avx);
+  add("avx", Bit(ecx, 28) && os_avx);
+  add("f16c", Bit(ecx, 29) && os_avx);
+  if (__get_cpuid_max(0, nullptr) < 7) return;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  unsigned max_subleaf = eax;
+  // The tile config and tile data state.
+  bool os_amx = Bit(edx, 24) && (xcr0 & 0x60000) == 0x60000 && RequestTileData();
+  add("bmi", Bit(ebx, 3));
+  add("avx2", Bit(ebx, 5) && os_avx);
+  add("bmi2", Bit(ebx, 8));
+  add("avx512f", Bit(ebx, 16) && os_avx512);
+  add("avx512dq", Bit(ebx, 17) && os_avx512);
+  add("avx512cd", Bit(ebx, 28) && os_avx512);
+  add("avx512bw", Bit(ebx, 30) && os_avx512);
+  add("avx512vl", Bit(ebx, 31) && os_avx512);
+  add("avx512vbmi", Bit(ecx, 1) && os_avx512);
+  add("avx512vnni", Bit(ecx, 11) && os_avx512);
+  add("amx-bf16", Bit(edx, 22) && os_amx);
+  add("avx512fp16", Bit(edx, 23) && os_avx512);
+  add("amx-tile", os_amx);
+  add("amx-int8", Bit(edx, 25) && os_amx);
+  if (max_subleaf < 1) return;
+  __cpuid_count(7, 1, eax, ebx, ecx, edx);
+  add("avxvnni", Bit(eax, 4) && os_avx);
+  add("avx512bf16", Bit(eax, 5) && os_avx512);
+  add("amx-fp16", Bit(eax, 21) && os_amx);
+}
+#elif TVM_CPU_FEATURES_AARCH64_LINUX
+void DetectHostFeatures(std::unordered_set<std::string>* features) {
+  auto add = [features](const char* name, bool supported) {
+    if (supported) features->insert(name);
+  };
+  // The HWCAP_* and HWCAP2_* bits of asm/hwcap.h.
+  uint64_t hwcap = getauxval(AT_HWCAP);
+  uint64_t hwcap2 = getauxval(AT_HWCAP2);
+  add("fp-armv8", hwcap & (1ULL << 0));
+  add("neon", hwcap & (1ULL << 1));
+  add("fullfp16", hwcap & (1ULL << 10));
+  add("dotprod", hwcap & (1ULL << 20));
+  add("sve", hwcap & (1ULL << 22));
+  add("sve2", hwcap2 & (1ULL << 1));
+  add("i8mm", hwcap2 & (1ULL << 13));
+  add("bf16", hwcap2 & (1ULL << 14));
+  add("sme", hwcap2 & (1ULL << 23));
+}
+#elif TVM_CPU_FEATURES_AARCH64_APPLE
+void DetectHostFeatures(std::unordered_set<std::string>* features) {
+  auto add_sysctl = [features](const char* name, const char* key) {
+    int value = 0;
+    size_t size = sizeof(value);
+    if (sysctlbyname(key, &value, &size, nullptr, 0) == 0 && value != 0) features->insert(name);
+  };
+  // Every Apple silicon CPU has these.
+  features->insert("fp-armv8");
+  features->insert("neon");
+  add_sysctl("fullfp16", "hw.optional.arm.FEAT_FP16");
+  add_sysctl("dotprod", "hw.optional.arm.FEAT_DotProd");
+  add_sysctl("i8mm", "hw.optional.arm.FEAT_I8MM");
+  add_sysctl("bf16", "hw.optional.arm.FEAT_BF16");
+  add_sysctl("sme", "hw.optional.arm.FEAT_SME");
+}
+#else
+void DetectHostFeatures(std::unordered_set<std::string>* features) {}
+#endif
+
+/*! \brief The features of the host, detected on the first use. */
+const std::unordered_set<std::string>& HostFeatures() {
+  static const std::unordered_set<std::string> features = []() {
+    std::unordered_set<std::string> features;
+    DetectHostFeatures(&features);
+    return features;
+  }();
+  return features;
+}
+
+/*! \brief Whether the host supports every feature of the comma separated list. */
+bool HostSupportsAll(const char* feature_list) {
+  std::istringstream is(feature_list);
+  std::string feature;
+  while (std::getline(is, feature, ',')) {
+    if (!feature.empty() && !HostSupportsCPUFeature(feature)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool IsDetectableCPUFeature(const std::string& feature) {
+  for (const char* name : kDetectableFeatures) {
+    if (feature == name) return true;
+  }
+  return false;
+}
+
+bool HostSupportsCPUFeature(const std::string& feature) {
+  return HostFeatures().count(feature) != 0;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("runtime.HostSupportsCPUFeature", [](const ffi::String& feature) {
+    return HostSupportsCPUFeature(feature);
+  });
+}
+
+}  // namespace runtime
+}  // namespace tvm
+
+int TVMBackendSelectISAVariant(int num_variants, const char** names, const char** features) {
+  if (const char* forced = std::getenv("TVM_CPU_ISA_VARIANT"); forced && forced[0] != '\0') {
+    if (std::strcmp(forced, "default") == 0) return -1;
+    for (int i = 0; i < num_variants; ++i) {
+      if (std::strcmp(forced, names[i]) == 0) return i;
+    }
+    static std::atomic<bool> warned{false};
+    if (!warned.exchange(true)) {
+      LOG(WARNING) << "TVM_CPU_ISA_VARIANT=" << forced
+                   << " names no variant of the module, selecting by the host features";
+    }
+  }
+  for (int i = 0; i < num_variants; ++i) {
+    if (tvm::runtime::HostSupportsAll(features[i])) return i;
+  }
+  return -1;
+}
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/cpu_features.h
+ * \brief Detection of the instruction set extensions of the host CPU.
+ */
+#ifndef TVM_RUNTIME_CPU_FEATURES_H_
+#define TVM_RUNTIME_CPU_FEATURES_H_
+
+#include <string>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Whether the runtime knows how to detect the feature on its architecture.
+ * \param feature The name of the LLVM target feature, e.g. "avx512f" or "dotprod".
+ * \return true for the features of any architecture the runtime detects.
+ */
+bool IsDetectableCPUFeature(const std::string& feature);
+
+/*!
+ * \brief Whether the host CPU and the operating system support the feature.
+ * \param feature The name of the LLVM target feature, e.g. "avx512f" or "dotprod".
+ * \return false for unknown features and for the features of other architectures.
+ */
+bool HostSupportsCPUFeature(const std::string& feature);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_CPU_FEATURES_H_
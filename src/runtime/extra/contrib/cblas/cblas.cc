@@ -123,6 +123,31 @@ struct CblasDgemmBatchIterativeOp {
   }
 };
 
+// Generic CBLAS has no grouped or batched entry point, so the groups run one after another.
+struct CblasSgemmGroupedOp {
+  typedef float TDatatype;
+  void operator()(int group_count, bool ta, int M, const int* N, int K, float alpha, float** A,
+                  int lda, float** B, int ldb, float beta, float** C, int ldc) {
+    CBLAS_TRANSPOSE trans_a = CBLASBooleanToTranspose(ta);
+    for (int g = 0; g < group_count; ++g) {
+      cblas_sgemm(CblasColMajor, trans_a, CblasNoTrans, M, N[g], K, alpha, A[g], lda, B[g], ldb,
+                  beta, C[g], ldc);
+    }
+  }
+};
+
+struct CblasDgemmGroupedOp {
+  typedef double TDatatype;
+  void operator()(int group_count, bool ta, int M, const int* N, int K, double alpha, double** A,
+                  int lda, double** B, int ldb, double beta, double** C, int ldc) {
+    CBLAS_TRANSPOSE trans_a = CBLASBooleanToTranspose(ta);
+    for (int g = 0; g < group_count; ++g) {
+      cblas_dgemm(CblasColMajor, trans_a, CblasNoTrans, M, N[g], K, alpha, A[g], lda, B[g], ldb,
+                  beta, C[g], ldc);
+    }
+  }
+};
+
 // matrix multiplication for row major
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
@@ -159,6 +184,17 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     } else {
                       CallBatchGemm(args, ret, CblasDgemmBatchIterativeOp());
                     }
+                  })
+      .def_packed("tvm.contrib.cblas.grouped_matmul",
+                  [](ffi::PackedArgs args, ffi::Any* ret) {
+                    auto A = args[0].cast<DLTensor*>();
+                    TVM_FFI_ICHECK((A->dtype == DLDataType{kDLFloat, 32, 1} ||
+                                    A->dtype == DLDataType{kDLFloat, 64, 1}));
+                    if (A->dtype == DLDataType{kDLFloat, 32, 1}) {
+                      CallGroupedGemm(args, ret, CblasSgemmGroupedOp());
+                    } else {
+                      CallGroupedGemm(args, ret, CblasDgemmGroupedOp());
+                    }
                   });
 }
 }  // namespace contrib
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 namespace tvm {
 namespace contrib {
@@ -242,6 +243,70 @@ inline void CallBatchGemm(ffi::PackedArgs args, ffi::Any* ret, TBatchGemmOp op)
      static_cast<typename TBatchGemmOp::TDatatype>(beta), C_data, C_stride, ColumnStride3D(C));
 }
 
+/*!
+ * \brief Call a grouped gemm over the row groups of A, as the tokens routed to each expert of a
+ *  mixture of experts: C[indptr[g]:indptr[g + 1]] = A[indptr[g]:indptr[g + 1]] * B[g].
+ *  A is [total_rows, K], B is [num_groups, K, N] ([num_groups, N, K] when transb), indptr is an
+ *  int64 host tensor of num_groups + 1 offsets and C is [total_rows, N]. Empty groups are skipped,
+ *  and the remaining groups are passed to the op at once so it may run them concurrently.
+ */
+template <typename TGroupedGemmOp>
+inline void CallGroupedGemm(ffi::PackedArgs args, ffi::Any* ret, TGroupedGemmOp op) {
+  using DType = typename TGroupedGemmOp::TDatatype;
+  auto A = args[0].cast<DLTensor*>();
+  auto B = args[1].cast<DLTensor*>();
+  auto indptr = args[2].cast<DLTensor*>();
+  auto C = args[3].cast<DLTensor*>();
+  bool transb = args[4].cast<bool>();
+  int bit_depth = sizeof(DType) * 8;
+
+  TVM_FFI_ICHECK_EQ(A->ndim, 2);
+  TVM_FFI_ICHECK_EQ(B->ndim, 3);
+  TVM_FFI_ICHECK_EQ(C->ndim, 2);
+  TVM_FFI_ICHECK_EQ(indptr->ndim, 1);
+  TVM_FFI_ICHECK(A->strides == nullptr && B->strides == nullptr && C->strides == nullptr)
+      << "grouped gemm requires compact operands";
+  TVM_FFI_ICHECK((indptr->dtype == DLDataType{kDLInt, 64, 1}));
+  TVM_FFI_ICHECK_EQ(indptr->device.device_type, kDLCPU);
+  TVM_FFI_ICHECK((B->dtype == DLDataType{kDLFloat, static_cast<uint8_t>(bit_depth), 1}));
+  TVM_FFI_ICHECK((C->dtype == DLDataType{kDLFloat, static_cast<uint8_t>(bit_depth), 1}));
+
+  int num_groups = B->shape[0];
+  int K = A->shape[1];
+  int N = ColumnCount3D(B, transb);
+  TVM_FFI_ICHECK_EQ(indptr->shape[0], num_groups + 1);
+  TVM_FFI_ICHECK_EQ(RowCount3D(B, transb), K);
+  TVM_FFI_ICHECK_EQ(C->shape[0], A->shape[0]);
+  TVM_FFI_ICHECK_EQ(C->shape[1], N);
+
+  double alpha = args.size() > 5 ? args[5].cast<double>() : 1.0;
+  double beta = args.size() > 6 ? args[6].cast<double>() : 0.0;
+
+  const int64_t* offsets = reinterpret_cast<const int64_t*>(static_cast<char*>(indptr->data) +
+                                                            indptr->byte_offset);
+  DType* A_data = reinterpret_cast<DType*>(static_cast<char*>(A->data) + A->byte_offset);
+  DType* B_data = reinterpret_cast<DType*>(static_cast<char*>(B->data) + B->byte_offset);
+  DType* C_data = reinterpret_cast<DType*>(static_cast<char*>(C->data) + C->byte_offset);
+  TVM_FFI_ICHECK_EQ(offsets[0], 0);
+  TVM_FFI_ICHECK_EQ(offsets[num_groups], A->shape[0]);
+
+  // In column major, group g computes C_g^T[N, rows] = B_g^T[N, K] * A_g^T[K, rows].
+  std::vector<int> rows;
+  std::vector<DType*> A_array, B_array, C_array;
+  for (int g = 0; g < num_groups; ++g) {
+    TVM_FFI_ICHECK_LE(offsets[g], offsets[g + 1]) << "indptr must be non-decreasing";
+    if (offsets[g] == offsets[g + 1]) continue;
+    rows.push_back(static_cast<int>(offsets[g + 1] - offsets[g]));
+    A_array.push_back(A_data + offsets[g] * K);
+    B_array.push_back(B_data + static_cast<int64_t>(g) * K * N);
+    C_array.push_back(C_data + offsets[g] * N);
+  }
+  if (rows.empty()) return;
+  op(static_cast<int>(rows.size()), transb, N, rows.data(), K, static_cast<DType>(alpha),
+     B_array.data(), transb ? K : N, A_array.data(), K, static_cast<DType>(beta), C_array.data(),
+     N);
+}
+
 }  // namespace contrib
 }  // namespace tvm
 #endif  // TVM_RUNTIME_CONTRIB_CBLAS_GEMM_COMMON_H_
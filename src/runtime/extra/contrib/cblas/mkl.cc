@@ -28,8 +28,13 @@
 
 extern "C" {
 #include <mkl_cblas.h>
+#include <mkl_service.h>
+#include <mkl_version.h>
 }
 
+#include <vector>
+
+#include "../../../threading_backend.h"
 #include "gemm_common.h"
 
 namespace tvm {
@@ -54,6 +59,23 @@ inline CBLAS_OFFSET MKLStringToOffset(const std::string offset_type) {
 
 inline char MKLBooleanToTransposeChar(bool trans) { return trans ? 'T' : 'N'; }
 
+// The strided batch API avoids building the pointer arrays of cblas_?gemm_batch.
+#define TVM_MKL_HAS_GEMM_BATCH_STRIDED (INTEL_MKL_VERSION >= 20200002)
+
+/*!
+ * \brief Limit the MKL threads of the calling thread to the TVM runtime's thread count while in
+ *  scope, so that MKL does not oversubscribe the cores given to the TVM thread pool.
+ */
+class MKLThreadScope {
+ public:
+  MKLThreadScope() : prev_(mkl_set_num_threads_local(runtime::threading::NumThreads())) {}
+  // A previous value of 0 restores the global MKL setting.
+  ~MKLThreadScope() { mkl_set_num_threads_local(prev_); }
+
+ private:
+  int prev_;
+};
+
 struct MKLGemmU8S8S32Op {
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, const void* A, int lda,
                   int offset_a, const void* B, int ldb, int offset_b, float beta, int* C, int ldc,
@@ -89,6 +111,14 @@ struct MKLSgemmBatchOp {
                   int c_stride, int ldc) {
     CBLAS_TRANSPOSE trans_a = MKLBooleanToTranspose(ta);
     CBLAS_TRANSPOSE trans_b = MKLBooleanToTranspose(tb);
+#if TVM_MKL_HAS_GEMM_BATCH_STRIDED
+    // A zero stride broadcasts an operand, which the strided API does not accept.
+    if (a_stride != 0 && b_stride != 0) {
+      cblas_sgemm_batch_strided(CblasColMajor, trans_a, trans_b, M, N, K, alpha, A, lda, a_stride,
+                                 B, ldb, b_stride, beta, C, ldc, c_stride, batch_size);
+      return;
+    }
+#endif
     std::vector<const float*> A_array(batch_size);
     std::vector<const float*> B_array(batch_size);
     std::vector<float*> C_array(batch_size);
@@ -125,6 +155,14 @@ struct MKLDgemmBatchOp {
                   int c_stride, int ldc) {
     CBLAS_TRANSPOSE trans_a = MKLBooleanToTranspose(ta);
     CBLAS_TRANSPOSE trans_b = MKLBooleanToTranspose(tb);
+#if TVM_MKL_HAS_GEMM_BATCH_STRIDED
+    // A zero stride broadcasts an operand, which the strided API does not accept.
+    if (a_stride != 0 && b_stride != 0) {
+      cblas_dgemm_batch_strided(CblasColMajor, trans_a, trans_b, M, N, K, alpha, A, lda, a_stride,
+                                 B, ldb, b_stride, beta, C, ldc, c_stride, batch_size);
+      return;
+    }
+#endif
     std::vector<const double*> A_array(batch_size);
     std::vector<const double*> B_array(batch_size);
     std::vector<double*> C_array(batch_size);
@@ -154,6 +192,45 @@ struct MKLDgemmBatchIterativeOp {
   }
 };
 
+/*!
+ * \brief Run each group of CallGroupedGemm as a group of size one of a single cblas_?gemm_batch
+ *  call, so that MKL schedules the GEMMs of all groups together.
+ */
+template <typename DType, typename FGemmBatch>
+inline void MKLGroupedGemm(int group_count, bool ta, int M, const int* N, int K, DType alpha,
+                           DType** A, int lda, DType** B, int ldb, DType beta, DType** C, int ldc,
+                           FGemmBatch gemm_batch) {
+  std::vector<CBLAS_TRANSPOSE> trans_a(group_count, MKLBooleanToTranspose(ta));
+  std::vector<CBLAS_TRANSPOSE> trans_b(group_count, CblasNoTrans);
+  std::vector<int> m(group_count, M), k(group_count, K), group_size(group_count, 1);
+  std::vector<int> lda_array(group_count, lda), ldb_array(group_count, ldb);
+  std::vector<int> ldc_array(group_count, ldc);
+  std::vector<DType> alpha_array(group_count, alpha), beta_array(group_count, beta);
+  std::vector<const DType*> A_array(A, A + group_count), B_array(B, B + group_count);
+  gemm_batch(CblasColMajor, trans_a.data(), trans_b.data(), m.data(), N, k.data(),
+             alpha_array.data(), A_array.data(), lda_array.data(), B_array.data(),
+             ldb_array.data(), beta_array.data(), C, ldc_array.data(), group_count,
+             group_size.data());
+}
+
+struct MKLSgemmGroupedOp {
+  typedef float TDatatype;
+  void operator()(int group_count, bool ta, int M, const int* N, int K, float alpha, float** A,
+                  int lda, float** B, int ldb, float beta, float** C, int ldc) {
+    MKLGroupedGemm(group_count, ta, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc,
+                   cblas_sgemm_batch);
+  }
+};
+
+struct MKLDgemmGroupedOp {
+  typedef double TDatatype;
+  void operator()(int group_count, bool ta, int M, const int* N, int K, double alpha, double** A,
+                  int lda, double** B, int ldb, double beta, double** C, int ldc) {
+    MKLGroupedGemm(group_count, ta, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc,
+                   cblas_dgemm_batch);
+  }
+};
+
 // matrix multiplication for row major
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
@@ -162,6 +239,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
     TVM_FFI_ICHECK(
         (A->dtype == DLDataType{kDLFloat, 32, 1} || A->dtype == DLDataType{kDLFloat, 64, 1}));
 
+    MKLThreadScope thread_scope;
     if (A->dtype == DLDataType{kDLFloat, 32, 1})
       CallGemm(args, ret, MKLSgemmOp());
     else
@@ -181,7 +259,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     TVM_FFI_ICHECK((A->dtype == DLDataType{kDLUInt, 8, 1} &&
                                     B->dtype == DLDataType{kDLInt, 8, 1} &&
                                     C->dtype == DLDataType{kDLInt, 32, 1}));
-
+                    MKLThreadScope thread_scope;
                     CallU8S8S32Gemm(args, ret, MKLGemmU8S8S32Op());
                   })
       .def_packed("tvm.contrib.mkl.batch_matmul",
@@ -189,6 +267,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     auto A = args[0].cast<DLTensor*>();
                     TVM_FFI_ICHECK((A->dtype == DLDataType{kDLFloat, 32, 1} ||
                                     A->dtype == DLDataType{kDLFloat, 64, 1}));
+                    MKLThreadScope thread_scope;
                     if (A->dtype == DLDataType{kDLFloat, 32, 1}) {
                       CallBatchGemm(args, ret, MKLSgemmBatchOp());
                     } else {
@@ -200,11 +279,24 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     auto A = args[0].cast<DLTensor*>();
                     TVM_FFI_ICHECK((A->dtype == DLDataType{kDLFloat, 32, 1} ||
                                     A->dtype == DLDataType{kDLFloat, 64, 1}));
+                    MKLThreadScope thread_scope;
                     if (A->dtype == DLDataType{kDLFloat, 32, 1}) {
                       CallBatchGemm(args, ret, MKLSgemmBatchIterativeOp());
                     } else {
                       CallBatchGemm(args, ret, MKLDgemmBatchIterativeOp());
                     }
+                  })
+      .def_packed("tvm.contrib.mkl.grouped_matmul",
+                  [](ffi::PackedArgs args, ffi::Any* ret) {
+                    auto A = args[0].cast<DLTensor*>();
+                    TVM_FFI_ICHECK((A->dtype == DLDataType{kDLFloat, 32, 1} ||
+                                    A->dtype == DLDataType{kDLFloat, 64, 1}));
+                    MKLThreadScope thread_scope;
+                    if (A->dtype == DLDataType{kDLFloat, 32, 1}) {
+                      CallGroupedGemm(args, ret, MKLSgemmGroupedOp());
+                    } else {
+                      CallGroupedGemm(args, ret, MKLDgemmGroupedOp());
+                    }
                   });
 }
 }  // namespace contrib
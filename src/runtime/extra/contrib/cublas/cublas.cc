@@ -27,6 +27,9 @@
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 
+#include <algorithm>
+#include <sstream>
+
 #include "../../../../../3rdparty/compiler-rt/builtin_fp16.h"
 #include "../cblas/gemm_common.h"
 #include "cublas_utils.h"
@@ -143,7 +146,8 @@ void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream,
                   const DLTensor* bias, const DLTensor* scaleA, const DLTensor* scaleB,
                   const DLTensor* C, bool transa, bool transb, void* workspace_ptr,
                   size_t workspace_size, cublasLtEpilogue_t epilogue,
-                  std::optional<float> dq_scale) {
+                  std::optional<float> dq_scale, const DLTensor* residual,
+                  const DLTensor* channel_scale) {
   TVM_FFI_ICHECK(A->dtype == B->dtype);
   // Reversed strides indicates an in-place transpose operation.
   transa = IsInPlaceTransposed(A) ? !transa : transa;
@@ -227,6 +231,39 @@ void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream,
                                                       &epilogue, sizeof(epilogue)));
   }
 
+  if (residual != nullptr) {
+    // The residual is read as the C matrix, D = alpha * A * B + beta * C.
+    TVM_FFI_ICHECK(residual->dtype == C->dtype && residual->ndim == C->ndim &&
+                   std::equal(residual->shape, residual->shape + residual->ndim, C->shape))
+        << "The residual must have the shape and dtype of the output";
+    TVM_FFI_ICHECK(c_type != CUDA_R_32I) << "Residual is not supported for IGEMM";
+    beta = &one_fp32;
+  }
+
+#if CUDART_VERSION >= 11000
+  if (channel_scale != nullptr) {
+    // The scale is a per-row alpha vector of the column-major output.
+    TVM_FFI_ICHECK(channel_scale->dtype == DLDataType{kDLFloat, 32, 1} && scale_type == CUDA_R_32F)
+        << "The channel scale must be a float32 vector";
+    int64_t scale_size = 1;
+    for (int i = 0; i < channel_scale->ndim; ++i) {
+      scale_size *= channel_scale->shape[i];
+    }
+    TVM_FFI_ICHECK_EQ(scale_size, C->shape[C->ndim - 1])
+        << "The channel scale must have one element per output channel";
+    TVM_FFI_ICHECK(residual == nullptr && !dq_scale)
+        << "The channel scale cannot be combined with a residual or a dequantization scale";
+    cublasLtPointerMode_t pointer_mode = CUBLASLT_POINTER_MODE_ALPHA_DEVICE_VECTOR_BETA_ZERO;
+    CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(op_desc, CUBLASLT_MATMUL_DESC_POINTER_MODE,
+                                                      &pointer_mode, sizeof(pointer_mode)));
+    alpha = static_cast<char*>(channel_scale->data) + channel_scale->byte_offset;
+  }
+#else
+  if (channel_scale != nullptr) {
+    TVM_FFI_THROW(InternalError) << "Channel scale is only supported in CUDA 11.0 and above.";
+  }
+#endif
+
   int batch_offset_A = A->ndim - 2;
   int batch_offset_B = B->ndim - 2;
 
@@ -294,22 +331,31 @@ void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream,
   auto A_data = static_cast<char*>(A->data) + A->byte_offset;
   auto B_data = static_cast<char*>(B->data) + B->byte_offset;
   auto C_data = static_cast<char*>(C->data) + C->byte_offset;
+  auto residual_data =
+      residual ? static_cast<char*>(residual->data) + residual->byte_offset : C_data;
 
   cublasLtMatmulPreferenceSetAttribute(matmul_pref_desc, CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES,
                                        &workspace_size, sizeof(size_t));
 
-  cublasLtMatmulHeuristicResult_t heuristic_result = {};
-  int returned_result = 0;
-  CHECK_CUBLAS_ERROR(cublasLtMatmulAlgoGetHeuristic(hdl, op_desc, A_desc, B_desc, C_desc, C_desc,
-                                                    matmul_pref_desc, 1, &heuristic_result,
-                                                    &returned_result));
-  if (returned_result == 0) {
-    CHECK_CUBLAS_ERROR(CUBLAS_STATUS_NOT_SUPPORTED);
+  std::ostringstream problem;
+  problem << (transa ? "t" : "n") << (transb ? "t" : "n") << "-m" << M << "n" << N << "k" << K
+          << "-ld" << lda << "_" << ldb << "_" << ldc << "-ab" << ab_type << "c" << c_type << "s"
+          << compute_type << "-e" << epilogue << (bias ? "b" : "") << (scaleA ? "x" : "")
+          << (scaleB ? "y" : "") << (residual ? "r" : "") << (channel_scale ? "v" : "") << "-w"
+          << workspace_size << "-batch";
+  if (use_batched_gemm) {
+    for (int i = 0; i < C->ndim - 2; ++i) {
+      problem << "_" << C->shape[i];
+    }
   }
-
-  CHECK_CUBLAS_ERROR(cublasLtMatmul(hdl, op_desc, alpha, B_data, A_desc, A_data, B_desc, beta,
-                                    C_data, C_desc, C_data, C_desc, &heuristic_result.algo,
-                                    workspace_ptr, workspace_size, stream));
+  auto run = [&](const cublasLtMatmulAlgo_t& algo) {
+    return static_cast<int>(cublasLtMatmul(hdl, op_desc, alpha, B_data, A_desc, A_data, B_desc,
+                                           beta, residual_data, C_desc, C_data, C_desc, &algo,
+                                           workspace_ptr, workspace_size, stream));
+  };
+  cublasLtMatmulAlgo_t algo = CublasLtAlgoCache::Global()->Get(
+      hdl, stream, op_desc, A_desc, B_desc, C_desc, matmul_pref_desc, problem.str(), run);
+  CHECK_CUBLAS_ERROR(run(algo));
 
   cublasLtMatmulDescDestroy(op_desc);
   cublasLtMatrixLayoutDestroy(A_desc);
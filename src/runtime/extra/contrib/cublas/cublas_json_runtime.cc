@@ -101,17 +101,6 @@ class CublasJSONRuntime : public JSONRuntimeBase {
       return dl_tensors[eid];
     };
 
-    auto get_inputs = [=](const JSONGraphNode& node, bool has_bias, bool has_scale) {
-      const DLTensor *bias = nullptr, *scaleA = nullptr, *scaleB = nullptr;
-      if (has_bias) {
-        bias = get_input(node, 2);
-      } else if (has_scale) {
-        scaleA = get_input(node, 2);
-        scaleB = get_input(node, 3);
-      }
-      return std::make_tuple(get_input(node, 0), get_input(node, 1), bias, scaleA, scaleB);
-    };
-
     for (size_t i = 0; i < nodes_.size(); ++i) {
       const auto& node = nodes_[i];
       if (node.GetOpType() == "kernel") {
@@ -134,9 +123,21 @@ class CublasJSONRuntime : public JSONRuntimeBase {
           epilogue = CUBLASLT_EPILOGUE_BIAS;
         }
 
+        // The optional inputs follow lhs and rhs in the order of the codegen.
+        int input_idx = 2;
+        auto get_optional_input = [&](bool present) -> const DLTensor* {
+          return present ? get_input(node, input_idx++) : nullptr;
+        };
         bool has_scale = op_name.find("multiply") != std::string::npos;
-        auto [a_ptr, b_ptr, bias_ptr, scaleA_ptr, scaleB_ptr] =
-            get_inputs(node, epilogue != CUBLASLT_EPILOGUE_DEFAULT, has_scale);
+        const DLTensor* a_ptr = get_input(node, 0);
+        const DLTensor* b_ptr = get_input(node, 1);
+        const DLTensor* bias_ptr = get_optional_input(epilogue != CUBLASLT_EPILOGUE_DEFAULT);
+        const DLTensor* scaleA_ptr = get_optional_input(has_scale);
+        const DLTensor* scaleB_ptr = get_optional_input(has_scale);
+        const DLTensor* residual_ptr =
+            get_optional_input(op_name.find("residual") != std::string::npos);
+        const DLTensor* channel_scale_ptr =
+            get_optional_input(op_name.find("channel_scale") != std::string::npos);
 
         std::optional<float> dq_scale = std::nullopt;
         if (op_name.find("dequantize") != std::string::npos) {
@@ -146,7 +147,7 @@ class CublasJSONRuntime : public JSONRuntimeBase {
         tvm::contrib::CallCublasLt(entry_ptr->handle, stream, entry_ptr->matmul_pref_desc, a_ptr,
                                    b_ptr, bias_ptr, scaleA_ptr, scaleB_ptr, out_ptr, transa, transb,
                                    entry_ptr->workspace_ptr, entry_ptr->workspace_size, epilogue,
-                                   dq_scale);
+                                   dq_scale, residual_ptr, channel_scale_ptr);
       }
     }
   }
@@ -25,6 +25,17 @@
 #include <tvm/ffi/extra/c_env_api.h>
 #include <tvm/ffi/extra/cuda/base.h>
 #include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "../../../../support/env.h"
 
 namespace tvm {
 namespace contrib {
@@ -73,5 +84,170 @@ CuBlasLtThreadEntry* CuBlasLtThreadEntry::ThreadLocal(DLDevice curr_device) {
   return &inst;
 }
 
+#if CUDART_VERSION >= 10010
+
+namespace {
+
+/*! \brief The number of timed runs of each candidate algorithm. */
+constexpr int kTuneRepeat = 5;
+
+std::string AlgoToHex(const cublasLtMatmulAlgo_t& algo) {
+  std::ostringstream os;
+  for (uint64_t word : algo.data) {
+    os << std::hex << std::setw(16) << std::setfill('0') << word;
+  }
+  return os.str();
+}
+
+bool AlgoFromHex(const std::string& hex, cublasLtMatmulAlgo_t* algo) {
+  constexpr size_t kNumWords = sizeof(algo->data) / sizeof(algo->data[0]);
+  if (hex.size() != kNumWords * 16) return false;
+  for (size_t i = 0; i < kNumWords; ++i) {
+    try {
+      algo->data[i] = std::stoull(hex.substr(i * 16, 16), nullptr, 16);
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+CublasLtAlgoCache* CublasLtAlgoCache::Global() {
+  static CublasLtAlgoCache* inst = new CublasLtAlgoCache();
+  return inst;
+}
+
+CublasLtAlgoCache::CublasLtAlgoCache() {
+  Configure(support::GetEnv("TVM_CUBLASLT_ALGO_CACHE", std::string()),
+            support::GetEnv<int64_t>("TVM_CUBLASLT_TUNE_TOP_N", 0));
+}
+
+void CublasLtAlgoCache::Configure(std::string path, int64_t tune_top_n) {
+  std::lock_guard<std::mutex> lock(mu_);
+  TVM_FFI_CHECK(tune_top_n >= 0, ValueError)
+      << "The number of cuBLASLt algorithms to tune must be non-negative, but got " << tune_top_n;
+  path_ = std::move(path);
+  tune_top_n_ = tune_top_n;
+  algos_.clear();
+  if (path_.empty()) return;
+  // Each line of the file is "<key> <algo>", later lines taking precedence.
+  std::ifstream fin(path_);
+  std::string key, hex;
+  while (fin >> key >> hex) {
+    cublasLtMatmulAlgo_t algo;
+    if (AlgoFromHex(hex, &algo)) {
+      algos_[key] = Entry{algo, false};
+    }
+  }
+}
+
+cublasLtMatmulAlgo_t CublasLtAlgoCache::Get(
+    cublasLtHandle_t hdl, cudaStream_t stream, cublasLtMatmulDesc_t op_desc,
+    cublasLtMatrixLayout_t A_desc, cublasLtMatrixLayout_t B_desc, cublasLtMatrixLayout_t C_desc,
+    cublasLtMatmulPreference_t pref, const std::string& problem,
+    const std::function<int(const cublasLtMatmulAlgo_t&)>& run) {
+  int device_id;
+  TVM_FFI_CHECK_CUDA_ERROR(cudaGetDevice(&device_id));
+  std::string key;
+  int64_t tune_top_n;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto [it, inserted] = device_prefix_.emplace(device_id, "");
+    if (inserted) {
+      cudaDeviceProp prop;
+      TVM_FFI_CHECK_CUDA_ERROR(cudaGetDeviceProperties(&prop, device_id));
+      std::string name = prop.name;
+      std::replace(name.begin(), name.end(), ' ', '_');
+      it->second = name + "-sm" + std::to_string(prop.major * 10 + prop.minor) + "-lt" +
+                   std::to_string(cublasLtGetVersion()) + "-";
+    }
+    key = it->second + problem;
+    tune_top_n = tune_top_n_;
+    if (auto entry = algos_.find(key); entry != algos_.end()) {
+      if (entry->second.checked) return entry->second.algo;
+      // An algorithm read from the file may not apply anymore, e.g. to a new workspace size.
+      cublasLtMatmulHeuristicResult_t check_result = {};
+      if (cublasLtMatmulAlgoCheck(hdl, op_desc, A_desc, B_desc, C_desc, C_desc,
+                                  &entry->second.algo, &check_result) == CUBLAS_STATUS_SUCCESS) {
+        entry->second.checked = true;
+        return entry->second.algo;
+      }
+      algos_.erase(entry);
+    }
+  }
+
+  std::vector<cublasLtMatmulHeuristicResult_t> results(std::max<int64_t>(tune_top_n, 1));
+  int returned_result = 0;
+  CHECK_CUBLAS_ERROR(cublasLtMatmulAlgoGetHeuristic(hdl, op_desc, A_desc, B_desc, C_desc, C_desc,
+                                                    pref, static_cast<int>(results.size()),
+                                                    results.data(), &returned_result));
+  if (returned_result == 0) {
+    CHECK_CUBLAS_ERROR(CUBLAS_STATUS_NOT_SUPPORTED);
+  }
+  if (tune_top_n == 0) {
+    std::lock_guard<std::mutex> lock(mu_);
+    algos_[key] = Entry{results[0].algo, true};
+    return results[0].algo;
+  }
+  // The timing synchronizes the stream, which a stream under graph capture cannot do, so leave
+  // the tuning to a later call.
+  cudaStreamCaptureStatus capture_status;
+  TVM_FFI_CHECK_CUDA_ERROR(cudaStreamIsCapturing(stream, &capture_status));
+  if (capture_status != cudaStreamCaptureStatusNone) {
+    return results[0].algo;
+  }
+  int best = returned_result > 1 ? Tune(stream, results.data(), returned_result, run) : 0;
+  cublasLtMatmulAlgo_t algo = results[best].algo;
+  std::lock_guard<std::mutex> lock(mu_);
+  algos_[key] = Entry{algo, true};
+  if (!path_.empty()) {
+    std::ofstream fout(path_, std::ios::app);
+    fout << key << " " << AlgoToHex(algo) << "\n";
+  }
+  return algo;
+}
+
+int CublasLtAlgoCache::Tune(cudaStream_t stream, const cublasLtMatmulHeuristicResult_t* results,
+                            int num_results,
+                            const std::function<int(const cublasLtMatmulAlgo_t&)>& run) {
+  cudaEvent_t start, stop;
+  TVM_FFI_CHECK_CUDA_ERROR(cudaEventCreate(&start));
+  TVM_FFI_CHECK_CUDA_ERROR(cudaEventCreate(&stop));
+  int best = 0;
+  float best_time = std::numeric_limits<float>::infinity();
+  for (int i = 0; i < num_results; ++i) {
+    if (results[i].state != CUBLAS_STATUS_SUCCESS) continue;
+    // The warm up run also skips the algorithms failing to launch.
+    if (run(results[i].algo) != CUBLAS_STATUS_SUCCESS) continue;
+    TVM_FFI_CHECK_CUDA_ERROR(cudaEventRecord(start, stream));
+    for (int r = 0; r < kTuneRepeat; ++r) {
+      run(results[i].algo);
+    }
+    TVM_FFI_CHECK_CUDA_ERROR(cudaEventRecord(stop, stream));
+    TVM_FFI_CHECK_CUDA_ERROR(cudaEventSynchronize(stop));
+    float time_ms;
+    TVM_FFI_CHECK_CUDA_ERROR(cudaEventElapsedTime(&time_ms, start, stop));
+    if (time_ms < best_time) {
+      best_time = time_ms;
+      best = i;
+    }
+  }
+  cudaEventDestroy(start);
+  cudaEventDestroy(stop);
+  return best;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("runtime.cublaslt.SetAlgoCache",
+                        [](ffi::String path, int64_t tune_top_n) {
+                          CublasLtAlgoCache::Global()->Configure(std::string(path), tune_top_n);
+                        });
+}
+
+#endif  // CUDART_VERSION >= 10010
+
 }  // namespace contrib
 }  // namespace tvm
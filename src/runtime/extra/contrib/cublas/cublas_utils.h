@@ -31,10 +31,14 @@
 #include <tvm/ffi/error.h>
 
 #include <cstdint>
+#include <functional>
 #if CUDART_VERSION >= 10010
 #include <cublasLt.h>
 #endif  // CUDART_VERSION >= 10010
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace tvm {
 namespace contrib {
@@ -125,13 +129,80 @@ inline cudaDataType_t GetCudaDataType(DLDataType type) {
   TVM_FFI_THROW(InternalError) << "Unsupported CUDA type";
 }
 
-/*! \brief Execute matrix multiply followed by the specified epilogue, using cuBLASLt. */
+#if CUDART_VERSION >= 10010
+/*!
+ * \brief A process-wide cache of the cuBLASLt algorithm of each matmul problem, keyed by the
+ * device, the cuBLASLt version, the shapes, data types, layouts and the epilogue.
+ *
+ * Without tuning, the cache holds the first heuristic result, so that the heuristic is queried
+ * once per problem rather than once per call. With tuning, the first call of a problem times the
+ * top heuristic results on the stream and keeps the fastest. The winners are appended to the
+ * cache file if one is given, from which later processes read them back.
+ *
+ * Configured by the environment variables TVM_CUBLASLT_ALGO_CACHE (the cache file) and
+ * TVM_CUBLASLT_TUNE_TOP_N (the number of heuristic results to time, 0 to disable tuning), or by
+ * the global function "runtime.cublaslt.SetAlgoCache".
+ */
+class CublasLtAlgoCache {
+ public:
+  /*! \brief The process-wide cache. */
+  static CublasLtAlgoCache* Global();
+  /*!
+   * \brief Set the cache file and the tuning, and read the algorithms cached in the file.
+   * \param path The cache file, empty to keep the cache in memory only.
+   * \param tune_top_n The number of heuristic results to time, 0 to take the first one.
+   */
+  void Configure(std::string path, int64_t tune_top_n);
+  /*!
+   * \brief Get the algorithm of the matmul, selecting it on the first call of the problem.
+   * \param problem The identity of the matmul problem on any device.
+   * \param run Run the matmul with the algorithm, returns the cuBLAS status.
+   * \return The algorithm.
+   */
+  cublasLtMatmulAlgo_t Get(cublasLtHandle_t hdl, cudaStream_t stream, cublasLtMatmulDesc_t op_desc,
+                           cublasLtMatrixLayout_t A_desc, cublasLtMatrixLayout_t B_desc,
+                           cublasLtMatrixLayout_t C_desc, cublasLtMatmulPreference_t pref,
+                           const std::string& problem,
+                           const std::function<int(const cublasLtMatmulAlgo_t&)>& run);
+
+ private:
+  CublasLtAlgoCache();
+  /*! \brief Time the candidates on the stream and return the index of the fastest. */
+  int Tune(cudaStream_t stream, const cublasLtMatmulHeuristicResult_t* results, int num_results,
+           const std::function<int(const cublasLtMatmulAlgo_t&)>& run);
+
+  /*! \brief The cache file, empty if the cache is in memory only. */
+  std::string path_;
+  /*! \brief The number of heuristic results to time, 0 to take the first one. */
+  int64_t tune_top_n_{0};
+  /*! \brief A selected algorithm. */
+  struct Entry {
+    cublasLtMatmulAlgo_t algo;
+    /*! \brief Whether the algorithm is known to be valid, false if read from the cache file. */
+    bool checked;
+  };
+  /*! \brief The selected algorithms. */
+  std::unordered_map<std::string, Entry> algos_;
+  /*! \brief The key prefix identifying each device and the cuBLASLt version. */
+  std::unordered_map<int, std::string> device_prefix_;
+  /*! \brief The mutex guarding the cache, shared by the threads. */
+  std::mutex mu_;
+};
+#endif  // CUDART_VERSION >= 10010
+
+/*!
+ * \brief Execute matrix multiply followed by the specified epilogue, using cuBLASLt.
+ *
+ * A residual of the output shape is accumulated into the result, and a channel scale, a float32
+ * vector over the last axis of the output, multiplies the matmul result before the epilogue.
+ */
 void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream,
                   cublasLtMatmulPreference_t matmul_pref_desc, const DLTensor* A, const DLTensor* B,
                   const DLTensor* bias, const DLTensor* scaleA, const DLTensor* scaleB,
                   const DLTensor* C, bool transa, bool transb, void* workspace_ptr,
                   size_t workspace_size, cublasLtEpilogue_t epilogue = CUBLASLT_EPILOGUE_DEFAULT,
-                  std::optional<float> dq_scale = std::nullopt);
+                  std::optional<float> dq_scale = std::nullopt, const DLTensor* residual = nullptr,
+                  const DLTensor* channel_scale = nullptr);
 
 }  // namespace contrib
 }  // namespace tvm
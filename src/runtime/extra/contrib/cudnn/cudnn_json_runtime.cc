@@ -60,14 +60,18 @@ class cuDNNJSONRuntime : public JSONRuntimeBase {
       if (node.GetOpType() == "kernel") {
         std::string op_name = node.GetOpName();
         if (op_name.find("conv2d") != std::string::npos) {
-          op_execs_[i] = GetConv2DExec(node);
+          op_execs_[i] = GetConv2DExec(node, i);
         } else if (op_name.find("attention") != std::string::npos) {
-          op_execs_[i] = GetAttentionExec(node);
+          op_execs_[i] = GetAttentionExec(node, i);
         } else {
           TVM_FFI_THROW(InternalError) << "Unsupported op: " << op_name;
         }
       }
     }
+    // The kernels chained within the graph exchange their results through a shared arena.
+    int device_id;
+    TVM_FFI_CHECK_CUDA_ERROR(cudaGetDevice(&device_id));
+    AllocateIntermediates(DLDevice{kDLCUDA, device_id});
   }
 
   const char* kind() const override { return "cudnn_json"; }  // May be overridden
@@ -101,16 +105,17 @@ class cuDNNJSONRuntime : public JSONRuntimeBase {
     return int_vec;
   }
 
-  std::function<void()> GetConv2DExec(const JSONGraphNode& node) {
+  std::function<void()> GetConv2DExec(const JSONGraphNode& node, uint32_t nid) {
     int device_id;
     TVM_FFI_CHECK_CUDA_ERROR(cudaGetDevice(&device_id));
     auto* entry_ptr = tvm::contrib::CuDNNThreadEntry::ThreadLocal(DLDevice{kDLCUDA, device_id});
     auto op_name = node.GetOpName();
 
     std::vector<int> input_dims, kernel_dims, output_dims;
-    auto input_node = nodes_[0];
-    auto input_shapes = input_node.GetOpShape()[0];
-    auto kernel_shapes = nodes_[1].GetOpShape()[0];
+    JSONGraphNodeEntry input_entry = node.GetInputs()[0];
+    JSONGraphNodeEntry kernel_entry = node.GetInputs()[1];
+    auto input_shapes = nodes_[input_entry.id_].GetOpShape()[input_entry.index_];
+    auto kernel_shapes = nodes_[kernel_entry.id_].GetOpShape()[kernel_entry.index_];
     auto output_shapes = node.GetOpShape()[0];
     for (const auto& _i : input_shapes) {
       input_dims.emplace_back(static_cast<int>(_i));
@@ -177,8 +182,7 @@ class cuDNNJSONRuntime : public JSONRuntimeBase {
       };
 
       auto [a_ptr, b_ptr, bias_ptr] = get_inputs(node, has_bias);
-      uint32_t output_eid = EntryID(outputs_[0]);
-      auto out_ptr = data_entry_[output_eid];
+      auto out_ptr = data_entry_[EntryID(nid, 0)];
       if (has_bias) {
         tvm::contrib::ConvolutionBiasActivationForward(
             mode, format, algo, dims, groups, act, coef, padding.data(), strides.data(),
@@ -192,7 +196,7 @@ class cuDNNJSONRuntime : public JSONRuntimeBase {
     return op_exec;
   }
 
-  std::function<void()> GetAttentionExec(const JSONGraphNode& node) {
+  std::function<void()> GetAttentionExec(const JSONGraphNode& node, uint32_t nid) {
 #ifdef TVM_USE_CUDNN_FRONTEND
     auto dtype = node.GetOpDataType()[0];
     int num_heads = static_cast<int>(node.GetAttr<int64_t>("num_heads"));
@@ -226,7 +230,7 @@ class cuDNNJSONRuntime : public JSONRuntimeBase {
     return [=, this]() {
       auto qkv = GetInput(node, 0);
       auto workspace = const_cast<DLTensor*>(GetInput(node, 1));
-      auto out = const_cast<DLTensor*>(data_entry_[EntryID(outputs_[0])]);
+      auto out = const_cast<DLTensor*>(data_entry_[EntryID(nid, 0)]);
       runner->Run(qkv, workspace, out);
     };
 #else
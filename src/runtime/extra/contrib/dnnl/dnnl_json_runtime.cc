@@ -28,9 +28,13 @@
 #include <tvm/runtime/tensor.h>
 
 #include <cstddef>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "../../../../support/env.h"
 #include "../json/json_node.h"
 #include "../json/json_runtime.h"
 
@@ -56,6 +60,44 @@ template <typename... Args>
 inline bool contains_any(const std::string& s, const Args&... args) {
   return (contains(s, args) || ...);
 }
+
+/*!
+ * \brief The CPU engine shared by all the DNNL subgraphs of the process.
+ *
+ * DNNL caches the primitives by their descriptor and engine, so that the layers which repeat
+ * across the subgraphs, and across the modules, compile once as long as they use the same engine.
+ * TVM_DNNL_PRIMITIVE_CACHE_CAPACITY overrides the number of primitives the cache keeps.
+ */
+const dnnl::engine& SharedEngine() {
+  static const dnnl::engine engine = []() {
+    int capacity = support::GetEnv("TVM_DNNL_PRIMITIVE_CACHE_CAPACITY", -1);
+    if (capacity >= 0) dnnl::set_primitive_cache_capacity(capacity);
+    return dnnl::engine(dnnl::engine::kind::cpu, 0);
+  }();
+  return engine;
+}
+
+/*! \brief The post ops of a composite name such as "dnnl.conv2d_bias_relu_add", in order. */
+std::vector<std::string> PostOpChain(const std::string& op_name) {
+  static const char* kPostOps[] = {"sum", "add",     "multiply", "relu", "tanh",
+                                   "clip", "sigmoid", "swish",    "gelu", "mish"};
+  std::vector<std::string> chain;
+  std::istringstream is(op_name);
+  std::string token;
+  // The first token holds the name of the main op.
+  std::getline(is, token, '_');
+  while (std::getline(is, token, '_')) {
+    for (const char* post_op : kPostOps) {
+      if (token == post_op) chain.push_back(token);
+    }
+  }
+  return chain;
+}
+
+/*! \brief Whether the post op takes a tensor operand. */
+inline bool HasPostOpOperand(const std::string& post_op) {
+  return post_op == "sum" || post_op == "add" || post_op == "multiply";
+}
 }  // namespace
 
 class DNNLJSONRuntime : public JSONRuntimeBase {
@@ -153,7 +195,17 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
       {"gelu_erf", dnnl::algorithm::eltwise_gelu_erf},
   };
 
-  dnnl::primitive_attr ParseAttrs(const size_t& nid, TensorRequisite* bias_tr) {
+  /*!
+   * \brief Parse the fused attributes of the node.
+   * \param nid The node id.
+   * \param bias_tr The bias input to fill, if any.
+   * \param post_op_args The operands of the binary post ops to fill, by their execution argument.
+   * \param dst_layout The layout of the output, which the operands of the binary post ops share.
+   * \return The primitive attributes.
+   */
+  dnnl::primitive_attr ParseAttrs(const size_t& nid, TensorRequisite* bias_tr,
+                                  std::unordered_map<int, TensorRequisite>* post_op_args = nullptr,
+                                  const std::string& dst_layout = "") {
     dnnl::primitive_attr attr;
 
     // Post op attributes based on named inputs.
@@ -201,33 +253,44 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // parsing of name to extract attributes
     auto op_name = nodes_[nid].GetOpName();
 
-    // Parsing post-ops.
+    // Parsing post-ops. They apply in the order of the name, and the operands of sum and of the
+    // binary post ops are the trailing inputs of the node, in the same order.
     dnnl::post_ops ops;
-    if (contains(op_name, "_sum")) {
-      ops.append_sum(1.f);
-    }
-    if (contains(op_name, "_relu")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
-    }
-    if (contains(op_name, "_tanh")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_tanh, 0.f, 0.f);
-    }
-    if (contains(op_name, "_clip")) {
-      float a_min = GetNodeAttr<float>(nodes_[nid], "a_min");
-      float a_max = GetNodeAttr<float>(nodes_[nid], "a_max");
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_clip, a_min, a_max);
-    }
-    if (contains(op_name, "_sigmoid")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_logistic, 0.f, 0.f);
-    }
-    if (contains(op_name, "_swish")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_swish, 1.f, 1.f);
-    }
-    if (contains(op_name, "_gelu")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_gelu_erf, 0.f, 0.f);
-    }
-    if (contains(op_name, "_mish")) {
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_mish, 1.f, 0.f);
+    int operand_idx = 0;
+    for (const auto& post_op : PostOpChain(op_name)) {
+      if (post_op == "sum") {
+        ops.append_sum(1.f);
+      } else if (post_op == "add" || post_op == "multiply") {
+        TVM_FFI_ICHECK(post_op_args) << "Binary post ops are not supported by " << op_name;
+        auto operand_tr = GetPostOpOperand(nid, operand_idx);
+        // Align the rank of the operand with the output, as numpy broadcasting does.
+        auto dims = operand_tr.dims();
+        dims.insert(dims.begin(), GetOutput(nid, 0).dims().size() - dims.size(), 1);
+        operand_tr = operand_tr.Reshape(dims);
+        if (dst_layout.size() == dims.size()) operand_tr = operand_tr.TreatAs(dst_layout);
+        auto algo =
+            post_op == "add" ? dnnl::algorithm::binary_add : dnnl::algorithm::binary_mul;
+        int arg = DNNL_ARG_ATTR_MULTIPLE_POST_OP(ops.len()) | DNNL_ARG_SRC_1;
+        ops.append_binary(algo, operand_tr.desc());
+        (*post_op_args)[arg] = operand_tr;
+      } else if (post_op == "relu") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
+      } else if (post_op == "tanh") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_tanh, 0.f, 0.f);
+      } else if (post_op == "clip") {
+        float a_min = GetNodeAttr<float>(nodes_[nid], "a_min");
+        float a_max = GetNodeAttr<float>(nodes_[nid], "a_max");
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_clip, a_min, a_max);
+      } else if (post_op == "sigmoid") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_logistic, 0.f, 0.f);
+      } else if (post_op == "swish") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_swish, 1.f, 1.f);
+      } else if (post_op == "gelu") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_gelu_erf, 0.f, 0.f);
+      } else if (post_op == "mish") {
+        ops.append_eltwise(1.f, dnnl::algorithm::eltwise_mish, 1.f, 0.f);
+      }
+      if (HasPostOpOperand(post_op)) operand_idx++;
     }
     if (ops.len() != 0) {
       attr.set_post_ops(ops);
@@ -241,7 +304,7 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
 
   // Build up the engine based on the input graph.
   void BuildEngine() {
-    engine_ = dnnl::engine(dnnl::engine::kind::cpu, 0);
+    engine_ = SharedEngine();
     stream_ = dnnl::stream(engine_);
 
     std::set<uint32_t> io_eid_set(run_arg_eid_.begin(), run_arg_eid_.end());
@@ -295,9 +358,6 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     auto dst_tr = GetOutput(nid, 0);
     auto bias_tr = TensorRequisite{};
 
-    auto attr = ParseAttrs(nid, &bias_tr);
-    attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
-
     auto strides = GetNodeAttr<std::vector<int64_t>>(node, "strides");
     auto dilates = GetNodeAttr<std::vector<int64_t>>(node, "dilation");
     auto padding = GetNodeAttr<std::vector<int64_t>>(node, "padding");
@@ -311,6 +371,10 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // dst_layout == "" means to use data_layout
     if (dst_layout.empty()) dst_layout = src_layout;
 
+    std::unordered_map<int, TensorRequisite> post_op_args;
+    auto attr = ParseAttrs(nid, &bias_tr, &post_op_args, dst_layout);
+    attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+
     // Minus one for DNNL representation. No dilation for DNNL is 0
     for (auto& d : dilates) d--;
 
@@ -370,17 +434,16 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // TODO(@apeskov): Simulation of inplace primitive. just as PoC.
     auto sum_in_tr = GetInputByName(nid, "sum_idx").TreatAs(dst_layout);
     if (op_name.find("_sum") != std::string::npos) {
-      sum_in_tr = GetInput(nid, node.GetInputs().size() - 1);
+      sum_in_tr = GetPostOpOperand(nid, "sum");
       sum_in_tr = sum_in_tr.TreatAs(dst_layout);
     }
 
-    Submit(dnnl::convolution_forward(conv_prim_desc),
-           {{DNNL_ARG_SRC, src_tr},
-            {DNNL_ARG_WEIGHTS, wgh_tr},
-            {DNNL_ARG_BIAS, bias_tr},
-            {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
-            {DNNL_ARG_DST, dst_tr}},
-           {sum_in_tr, DNNL_ARG_DST});
+    post_op_args.insert({{DNNL_ARG_SRC, src_tr},
+                         {DNNL_ARG_WEIGHTS, wgh_tr},
+                         {DNNL_ARG_BIAS, bias_tr},
+                         {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
+                         {DNNL_ARG_DST, dst_tr}});
+    Submit(dnnl::convolution_forward(conv_prim_desc), post_op_args, {sum_in_tr, DNNL_ARG_DST});
   }
 
   void Deconvolution(const size_t& nid) {
@@ -392,9 +455,6 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     auto dst_tr = GetOutput(nid, 0);
     auto bias_tr = TensorRequisite{};
 
-    auto attr = ParseAttrs(nid, &bias_tr);
-    attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
-
     auto strides = GetNodeAttr<std::vector<int64_t>>(node, "strides");
     auto dilates = GetNodeAttr<std::vector<int64_t>>(node, "dilation");
     auto padding = GetNodeAttr<std::vector<int64_t>>(node, "padding");
@@ -408,6 +468,10 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // dst_layout == "" means to use data_layout
     if (dst_layout.empty()) dst_layout = src_layout;
 
+    std::unordered_map<int, TensorRequisite> post_op_args;
+    auto attr = ParseAttrs(nid, &bias_tr, &post_op_args, dst_layout);
+    attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+
     // Minus one for DNNL representation. No dilation for DNNL is 0, for relax is 1.
     for (auto& d : dilates) d--;
 
@@ -443,11 +507,12 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
 
     auto scratchpad_tr = TensorRequisite::AsIs(deconv_prim_desc.scratchpad_desc());
 
-    Submit(dnnl::deconvolution_forward(deconv_prim_desc), {{DNNL_ARG_SRC, src_tr},
-                                                           {DNNL_ARG_WEIGHTS, wgh_tr},
-                                                           {DNNL_ARG_BIAS, bias_tr},
-                                                           {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
-                                                           {DNNL_ARG_DST, dst_tr}});
+    post_op_args.insert({{DNNL_ARG_SRC, src_tr},
+                         {DNNL_ARG_WEIGHTS, wgh_tr},
+                         {DNNL_ARG_BIAS, bias_tr},
+                         {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
+                         {DNNL_ARG_DST, dst_tr}});
+    Submit(dnnl::deconvolution_forward(deconv_prim_desc), post_op_args);
   }
 
   void Dense(const size_t& nid) {
@@ -460,7 +525,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     auto dst_tr = GetOutput(nid, 0);
     auto bias_tr = TensorRequisite{};
 
-    auto attr = ParseAttrs(nid, &bias_tr);
+    std::unordered_map<int, TensorRequisite> post_op_args;
+    auto attr = ParseAttrs(nid, &bias_tr, &post_op_args);
     attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
 
     // Assumption that bias is correct and can be squeezed to 1D
@@ -484,16 +550,15 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // TODO(@apeskov): Simulation of inplace primitive. just as PoC.
     auto sum_in_tr = GetInputByName(nid, "sum_idx");
     if (op_name.find("_sum") != std::string::npos) {
-      sum_in_tr = GetInput(nid, node.GetInputs().size() - 1);
+      sum_in_tr = GetPostOpOperand(nid, "sum");
     }
 
-    Submit(dnnl::inner_product_forward(dense_prim_desc),
-           {{DNNL_ARG_SRC, src_tr},
-            {DNNL_ARG_WEIGHTS, wgh_tr},
-            {DNNL_ARG_BIAS, bias_tr},
-            {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
-            {DNNL_ARG_DST, dst_tr}},
-           {sum_in_tr, DNNL_ARG_DST});
+    post_op_args.insert({{DNNL_ARG_SRC, src_tr},
+                         {DNNL_ARG_WEIGHTS, wgh_tr},
+                         {DNNL_ARG_BIAS, bias_tr},
+                         {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
+                         {DNNL_ARG_DST, dst_tr}});
+    Submit(dnnl::inner_product_forward(dense_prim_desc), post_op_args, {sum_in_tr, DNNL_ARG_DST});
   }
 
   void BatchMatMul(const size_t& nid) {
@@ -505,7 +570,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     auto dst_tr = GetOutput(nid, 0);
     auto bias_tr = TensorRequisite{};
 
-    auto attr = ParseAttrs(nid, &bias_tr);
+    std::unordered_map<int, TensorRequisite> post_op_args;
+    auto attr = ParseAttrs(nid, &bias_tr, &post_op_args);
     attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
 
     bool transpose_a = GetNodeAttr<bool>(node, "transpose_a");
@@ -535,11 +601,12 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
 
     auto scratchpad_tr = TensorRequisite::AsIs(bmm_prim_desc.scratchpad_desc());
 
-    Submit(dnnl::matmul(bmm_prim_desc), {{DNNL_ARG_SRC, src_tr},
-                                         {DNNL_ARG_WEIGHTS, wgh_tr},
-                                         {DNNL_ARG_BIAS, bias_tr},
-                                         {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
-                                         {DNNL_ARG_DST, dst_tr}});
+    post_op_args.insert({{DNNL_ARG_SRC, src_tr},
+                         {DNNL_ARG_WEIGHTS, wgh_tr},
+                         {DNNL_ARG_BIAS, bias_tr},
+                         {DNNL_ARG_SCRATCHPAD, scratchpad_tr},
+                         {DNNL_ARG_DST, dst_tr}});
+    Submit(dnnl::matmul(bmm_prim_desc), post_op_args);
   }
 
   void BatchNorm(const size_t& nid) {
@@ -818,6 +885,24 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     return GetInput(nid, idx);
   }
 
+  /*! \brief The operand of the pos-th post op taking one, among the trailing inputs of the node. */
+  TensorRequisite GetPostOpOperand(const size_t& nid, int pos) {
+    auto chain = PostOpChain(nodes_[nid].GetOpName());
+    int num_operands = std::count_if(chain.begin(), chain.end(), HasPostOpOperand);
+    TVM_FFI_ICHECK_LT(pos, num_operands);
+    return GetInput(nid, nodes_[nid].GetInputs().size() - num_operands + pos);
+  }
+
+  /*! \brief The operand of the first post op with the given name. */
+  TensorRequisite GetPostOpOperand(const size_t& nid, const std::string& post_op) {
+    int pos = 0;
+    for (const auto& name : PostOpChain(nodes_[nid].GetOpName())) {
+      if (name == post_op) return GetPostOpOperand(nid, pos);
+      if (HasPostOpOperand(name)) pos++;
+    }
+    return {};
+  }
+
   TensorRequisite GetOutput(const size_t& nid, const int idx) {
     if (idx == -1) return {};  // -1 reserved value for empty input.
     const JSONGraphNode& node = nodes_[nid];
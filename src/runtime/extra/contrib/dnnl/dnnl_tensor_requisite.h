@@ -549,22 +549,26 @@ class TensorRegistry {
 
     // 2) EID mapped tensor. Direct reference
     if (tr.eid_ != TensorRequisite::kUndefinedTid) {
+      ArgId res;
       if (ext_io_eid_.count(tr.eid_) == 0) {  // Not IO tensor, means it's intermediate
         if (eid2idx_tmp_.count(tr.eid_)) {
           auto idx = eid2idx_tmp_.at(tr.eid_);
-          return MakeArgReq(ArgReqFlag::TMP_STORAGE, idx);
+          res = MakeArgReq(ArgReqFlag::TMP_STORAGE, idx);
         } else {
           // register himself
           auto idx = tmp_mem_collection_.size();
           tmp_mem_collection_.push_back(tr.t_desc_);
           eid2idx_tmp_[tr.eid_] = idx;
-          return MakeArgReq(ArgReqFlag::TMP_STORAGE, static_cast<uint32_t>(idx));
+          res = MakeArgReq(ArgReqFlag::TMP_STORAGE, static_cast<uint32_t>(idx));
         }
       } else {
         auto idx = ext_mem_collection_.size();
         ext_mem_collection_.push_back({tr.eid_, tr.t_desc_});
-        return MakeArgReq(ArgReqFlag::EXT_EID, static_cast<uint32_t>(idx));
+        res = MakeArgReq(ArgReqFlag::EXT_EID, static_cast<uint32_t>(idx));
       }
+      // The tensor is rewritten, copies of its previous content in other layouts are stale.
+      if (tr.reverse_data_flow_) DropReorderedCopies(res);
+      return res;
     }
 
     // 3) Tensors with transform actions
@@ -639,6 +643,18 @@ class TensorRegistry {
 
     auto src_desc = src_ar.flag_ == TMP_STORAGE ? tmp_mem_collection_[src_ar.idx_]
                                                 : ext_mem_collection_[src_ar.idx_].second;
+    auto src_key = StorageKey(src_ar);
+
+    // The tensor was already reordered into this layout, by the layer which produced it or by a
+    // previous consumer. Share that buffer instead of reordering it once more.
+    if (!reverse_data_flow) {
+      for (const auto& copy : reordered_copies_) {
+        if (copy.src_key == src_key && copy.src_desc == src_desc && copy.desc == desc) {
+          return copy.dst_ar;
+        }
+      }
+    }
+
     auto idx = tmp_mem_collection_.size();
     tmp_mem_collection_.push_back(desc);
     auto dst_ar = MakeArgReq(TMP_STORAGE, idx);
@@ -653,8 +669,30 @@ class TensorRegistry {
       action->push_back(
           {dnnl::reorder(reorder_pd), {{DNNL_ARG_FROM, src_ar}, {DNNL_ARG_TO, dst_ar}}});
     }
+    reordered_copies_.push_back({src_key, src_desc, desc, dst_ar});
     return dst_ar;
   }
+
+  /*! rief Identify the memory buffer behind the ArgId, looking through reinterpretations. */
+  std::pair<ArgReqFlag, uint32_t> StorageKey(ArgId ar) const {
+    if (ar.flag_ == EXT_EID) return {EXT_EID, ext_mem_collection_[ar.idx_].first};
+    size_t idx = ar.idx_;
+    for (auto found = tmp_mem_mapping_.find(idx); found != tmp_mem_mapping_.end();
+         found = tmp_mem_mapping_.find(idx)) {
+      idx = found->second;
+    }
+    return {ar.flag_, static_cast<uint32_t>(idx)};
+  }
+
+  /*! rief Forget the reordered copies of the buffer behind the ArgId. */
+  void DropReorderedCopies(ArgId ar) {
+    auto key = StorageKey(ar);
+    reordered_copies_.erase(
+        std::remove_if(reordered_copies_.begin(), reordered_copies_.end(),
+                       [&key](const ReorderedCopy& copy) { return copy.src_key == key; }),
+        reordered_copies_.end());
+  }
+
   /*! \brief Implementation of memory solver */
   class MemSolverImpl {
    public:
@@ -732,6 +770,17 @@ class TensorRegistry {
   /* List of external eid */
   std::set<uint32_t> ext_io_eid_;
 
+  /*! \brief A temp buffer holding the content of another buffer in a different layout. */
+  struct ReorderedCopy {
+    std::pair<ArgReqFlag, uint32_t> src_key;
+    dnnl::memory::desc src_desc;
+    dnnl::memory::desc desc;
+    ArgId dst_ar;
+  };
+
+  /* Reordered copies which are still valid at the end of the registered actions */
+  std::vector<ReorderedCopy> reordered_copies_;
+
   /* Engine of all tensors existing in this registry */
   dnnl::engine eng_;
 
@@ -28,10 +28,13 @@
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/extra/json.h>
 #include <tvm/ffi/extra/module.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/tensor.h>
 #include <tvm/support/io.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <map>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -244,6 +247,121 @@ class JSONRuntimeBase : public ffi::ModuleObj {
     }
   }
 
+  /*!
+   * \brief Plan the intermediate entries, i.e. the outputs of the kernel nodes which are not
+   * outputs of the graph, into a single arena on the device and bind them to the data entries.
+   *
+   * The kernel nodes are visited in order. An entry is live from the node producing it to its last
+   * consumer, after which its range of the arena is reused by the entries produced later. Entries
+   * with dynamic shapes are left unbound.
+   *
+   * \param dev The device of the arena.
+   */
+  void AllocateIntermediates(Device dev) {
+    std::vector<bool> is_output(NumEntries(), false);
+    for (const auto& output : outputs_) {
+      is_output[EntryID(output)] = true;
+    }
+    // The last node reading each entry.
+    std::vector<size_t> last_use(NumEntries(), 0);
+    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+      for (const auto& input : nodes_[nid].GetInputs()) {
+        last_use[EntryID(input)] = nid;
+      }
+    }
+
+    std::vector<std::pair<int64_t, int64_t>> entry_range(NumEntries(), {-1, 0});
+    // The free ranges of the arena, from offset to size.
+    std::map<int64_t, int64_t> free_ranges;
+    std::vector<uint32_t> live_entries;
+    int64_t arena_size = 0;
+    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+      const auto& node = nodes_[nid];
+      if (node.GetOpType() != "kernel") continue;
+      // Release the entries no longer read, coalescing the adjacent free ranges.
+      for (auto it = live_entries.begin(); it != live_entries.end();) {
+        if (last_use[*it] >= nid) {
+          ++it;
+          continue;
+        }
+        auto [offset, size] = entry_range[*it];
+        auto next = free_ranges.lower_bound(offset);
+        if (next != free_ranges.end() && next->first == offset + size) {
+          size += next->second;
+          next = free_ranges.erase(next);
+        }
+        if (next != free_ranges.begin()) {
+          auto prev = std::prev(next);
+          if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            free_ranges.erase(prev);
+          }
+        }
+        free_ranges.emplace(offset, size);
+        it = live_entries.erase(it);
+      }
+      for (uint32_t i = 0; i < node.GetNumOutput(); ++i) {
+        uint32_t eid = EntryID(nid, i);
+        if (is_output[eid]) continue;
+        int64_t size = IntermediateBytes(node.GetOpShape()[i], node.GetOpDataType()[i]);
+        if (size < 0) continue;
+        // Take the first free range which fits, or grow the arena.
+        auto it = std::find_if(free_ranges.begin(), free_ranges.end(),
+                               [size](const auto& range) { return range.second >= size; });
+        int64_t offset = arena_size;
+        if (it != free_ranges.end()) {
+          offset = it->first;
+          if (it->second > size) {
+            free_ranges.emplace(offset + size, it->second - size);
+          }
+          free_ranges.erase(it);
+        } else if (!free_ranges.empty() &&
+                   std::prev(free_ranges.end())->first + std::prev(free_ranges.end())->second ==
+                       arena_size) {
+          // Extend the free range at the end of the arena.
+          offset = std::prev(free_ranges.end())->first;
+          free_ranges.erase(std::prev(free_ranges.end()));
+          arena_size = offset + size;
+        } else {
+          arena_size += size;
+        }
+        entry_range[eid] = {offset, size};
+        live_entries.push_back(eid);
+      }
+    }
+
+    intermediates_.clear();
+    if (arena_size == 0) return;
+    intermediate_arena_ = Tensor::Empty({arena_size}, DLDataType{kDLUInt, 8, 1}, dev);
+    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+      for (uint32_t i = 0; i < nodes_[nid].GetNumOutput(); ++i) {
+        uint32_t eid = EntryID(nid, i);
+        if (entry_range[eid].first < 0) continue;
+        std::vector<int64_t> shape;
+        for (int64_t dim : nodes_[nid].GetOpShape()[i]) {
+          shape.push_back(dim);
+        }
+        intermediates_.push_back(intermediate_arena_.CreateView(
+            ffi::Shape(shape), nodes_[nid].GetOpDataType()[i], entry_range[eid].first));
+        data_entry_[eid] = intermediates_.back().operator->();
+      }
+    }
+  }
+
+  /*!
+   * \brief The bytes of an intermediate entry in the arena, rounded up to the allocation
+   * alignment, or -1 if the shape is dynamic.
+   */
+  static int64_t IntermediateBytes(const ffi::Array<int64_t>& shape, DLDataType dtype) {
+    int64_t size = (dtype.bits * dtype.lanes + 7) / 8;
+    for (int64_t dim : shape) {
+      if (dim < 0) return -1;
+      size *= dim;
+    }
+    return (size + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+  }
+
   // Load the graph.
   void Load(ffi::json::Object root) {
     namespace json = ::tvm::ffi::json;
@@ -315,6 +433,10 @@ class JSONRuntimeBase : public ffi::ModuleObj {
   std::vector<uint32_t> input_var_eid_;
   /*! \brief input const node index. */
   std::vector<uint32_t> const_idx_;
+  /*! \brief The arena of the intermediate entries, see AllocateIntermediates. */
+  Tensor intermediate_arena_;
+  /*! \brief The views of the arena bound to the intermediate entries. */
+  std::vector<Tensor> intermediates_;
   /*! \brief Indicate if the engine has been initialized. */
   bool initialized_{false};
   /*! \brief Initializer mutex*/
@@ -23,6 +23,7 @@
 
 #include <android/log.h>
 #include <tvm/ffi/error.h>
+#include <tvm/runtime/logging.h>
 
 #include <algorithm>
 #include <iterator>
@@ -216,13 +217,24 @@ void NNAPIModelBuilder::Finish(const std::vector<NNAPIOperand>& model_input_oper
   TVM_FFI_ICHECK_EQ(ANeuralNetworksModel_finish(model_), ANEURALNETWORKS_NO_ERROR);
 }
 
-ANeuralNetworksCompilation* NNAPIModelBuilder::Compile() {
+ANeuralNetworksCompilation* NNAPIModelBuilder::Compile(const std::string& cache_dir,
+                                                       const uint8_t* token) {
   ANeuralNetworksCompilation* compilation;
   TVM_FFI_ICHECK_EQ(ANeuralNetworksCompilation_create(model_, &compilation),
                     ANEURALNETWORKS_NO_ERROR);
   TVM_FFI_ICHECK_EQ(ANeuralNetworksCompilation_setPreference(
                         compilation, ANEURALNETWORKS_PREFER_FAST_SINGLE_ANSWER),
                     ANEURALNETWORKS_NO_ERROR);
+  if (!cache_dir.empty()) {
+#if __ANDROID_API__ >= 29
+    TVM_FFI_ICHECK(token != nullptr) << "The NNAPI compilation cache needs a model token";
+    TVM_FFI_ICHECK_EQ(ANeuralNetworksCompilation_setCaching(compilation, cache_dir.c_str(), token),
+                      ANEURALNETWORKS_NO_ERROR);
+#else
+    LOG(WARNING) << "The NNAPI compilation cache needs Android API level 29, ignoring "
+                 << cache_dir;
+#endif
+  }
   TVM_FFI_ICHECK_EQ(ANeuralNetworksCompilation_finish(compilation), ANEURALNETWORKS_NO_ERROR);
   return compilation;
 }
@@ -24,6 +24,7 @@
 #include <android/NeuralNetworks.h>
 #include <dlpack/dlpack.h>
 
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -111,7 +112,14 @@ class NNAPIModelBuilder {
 
   void Finish(const std::vector<NNAPIOperand>& model_input_operands,
               const std::vector<NNAPIOperand>& model_output_operands);
-  ANeuralNetworksCompilation* Compile();
+  /*!
+   * \brief Compile the finished model.
+   * \param cache_dir If not empty, the directory where the drivers cache the compilation.
+   * \param token The ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN bytes that identify the model in
+   *  the cache, required with a cache_dir.
+   */
+  ANeuralNetworksCompilation* Compile(const std::string& cache_dir = "",
+                                      const uint8_t* token = nullptr);
 
  private:
   ANeuralNetworksModel* model_;
@@ -30,6 +30,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "../../../../support/env.h"
 #include "../json/json_node.h"
 #include "../json/json_runtime.h"
 
@@ -66,10 +67,22 @@ class NNAPIRuntime : public JSONRuntimeBase {
     NNAPIModelBuilder builder;
     ANeuralNetworksCompilation* compilation;
     std::vector<NNAPIOperand> model_output_operands;
+#if __ANDROID_API__ >= 29
+    /*! \brief Keeps the driver state of the compilation across the executions of Run. */
+    ANeuralNetworksBurst* burst = nullptr;
+#endif
   };
 
   std::optional<CompiledModel> compiled_model_;
 
+  ~NNAPIRuntime() {
+    if (!compiled_model_.has_value()) return;
+#if __ANDROID_API__ >= 29
+    if (compiled_model_->burst != nullptr) ANeuralNetworksBurst_free(compiled_model_->burst);
+#endif
+    ANeuralNetworksCompilation_free(compiled_model_->compilation);
+  }
+
   void Init(const ffi::Array<Tensor>& consts) final {
     TVM_FFI_ICHECK_EQ(consts.size(), const_idx_.size())
         << "The number of input constants must match the number of required constants.";
@@ -77,6 +90,37 @@ class NNAPIRuntime : public JSONRuntimeBase {
     CompileModel();
   }
 
+  /*!
+   * \brief The cache token of the model, from the hash of its graph and of its constants.
+   *
+   *  Four FNV-1a hashes with different offset bases fill the 32 bytes of the token, so that
+   *  models which differ in any weight get different cache entries.
+   */
+  std::vector<uint8_t> ModelCacheToken() const {
+    constexpr uint64_t kPrime = 0x100000001B3ULL;
+    uint64_t hashes[4] = {0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL, 0x9E3779B97F4A7C15ULL,
+                          0xC2B2AE3D27D4EB4FULL};
+    auto update = [&](const char* data, size_t size) {
+      for (uint64_t& hash : hashes) {
+        for (size_t i = 0; i < size; ++i) {
+          hash = (hash ^ static_cast<uint8_t>(data[i])) * kPrime;
+        }
+        hash = (hash ^ size) * kPrime;
+      }
+    };
+    update(symbol_name_.data(), symbol_name_.size());
+    update(graph_json_.data(), graph_json_.size());
+    for (uint32_t eid : const_idx_) {
+      const DLTensor* entry = data_entry_[EntryID(eid, 0)];
+      update(static_cast<const char*>(entry->data) + entry->byte_offset, ffi::GetDataSize(*entry));
+    }
+    std::vector<uint8_t> token(ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN, 0);
+    for (size_t i = 0; i < token.size(); ++i) {
+      token[i] = static_cast<uint8_t>(hashes[(i / 8) % 4] >> (8 * (i % 8)));
+    }
+    return token;
+  }
+
   void CompileModel() {
     NNAPIModelBuilder builder;
 
@@ -119,19 +163,28 @@ class NNAPIRuntime : public JSONRuntimeBase {
       model_output_operands.push_back(operand);
     }
 
-    // Finish and compile the model.
+    // Finish and compile the model, which the drivers cache under TVM_NNAPI_CACHE_DIR.
     builder.Finish(model_input_operands, model_output_operands);
-    ANeuralNetworksCompilation* compilation = builder.Compile();
+    std::string cache_dir = support::GetEnv("TVM_NNAPI_CACHE_DIR", std::string(""));
+    std::vector<uint8_t> token;
+    if (!cache_dir.empty()) token = ModelCacheToken();
+    ANeuralNetworksCompilation* compilation = builder.Compile(cache_dir, token.data());
 
     // Store the compilation
     compiled_model_.emplace(std::move(builder), compilation, model_output_operands);
+#if __ANDROID_API__ >= 29
+    if (support::GetEnv("TVM_NNAPI_USE_BURST", true)) {
+      TVM_FFI_ICHECK_EQ(ANeuralNetworksBurst_create(compilation, &compiled_model_->burst),
+                        ANEURALNETWORKS_NO_ERROR);
+    }
+#endif
   }
 
-  void ExecuteModel(ANeuralNetworksCompilation* compilation,
-                    const std::vector<NNAPIOperand>& model_output_operands) {
+  void ExecuteModel(const CompiledModel& compiled_model) {
+    const std::vector<NNAPIOperand>& model_output_operands = compiled_model.model_output_operands;
     // Execute the model.
     ANeuralNetworksExecution* execution;
-    TVM_FFI_ICHECK_EQ(ANeuralNetworksExecution_create(compilation, &execution),
+    TVM_FFI_ICHECK_EQ(ANeuralNetworksExecution_create(compiled_model.compilation, &execution),
                       ANEURALNETWORKS_NO_ERROR);
 
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
@@ -168,6 +221,15 @@ class NNAPIRuntime : public JSONRuntimeBase {
           ANEURALNETWORKS_NO_ERROR);
     }
 
+#if __ANDROID_API__ >= 29
+    if (compiled_model.burst != nullptr) {
+      // The burst reuses the resources the driver set up for the previous executions.
+      TVM_FFI_ICHECK_EQ(ANeuralNetworksExecution_burstCompute(execution, compiled_model.burst),
+                        ANEURALNETWORKS_NO_ERROR);
+      ANeuralNetworksExecution_free(execution);
+      return;
+    }
+#endif
     ANeuralNetworksEvent* compute_event;
     TVM_FFI_ICHECK_EQ(ANeuralNetworksExecution_startCompute(execution, &compute_event),
                       ANEURALNETWORKS_NO_ERROR);
@@ -179,8 +241,7 @@ class NNAPIRuntime : public JSONRuntimeBase {
 
   void Run() final {
     TVM_FFI_ICHECK(compiled_model_.has_value());
-    CompiledModel& compiled_model = compiled_model_.value();
-    ExecuteModel(compiled_model.compilation, compiled_model.model_output_operands);
+    ExecuteModel(compiled_model_.value());
   }
 
   void AddOperation(NNAPIModelBuilder& builder, uint32_t nid,  // NOLINT(*)
@@ -19,6 +19,7 @@
 #include <cuda_fp16.h>
 #include <dlpack/dlpack.h>
 #include <nvshmem.h>
+#include <nvshmemx.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/disco/disco_worker.h>
@@ -333,9 +334,51 @@ int _KVTransferPageToPage(DLTensor* remote_pages, DLTensor* local_pages,
   return 0;
 }
 
+int _KVTransferSignal(DLTensor* remote_signal, int64_t slot, int64_t remote_tp_group_pe_offset,
+                      TVMStreamHandle transfer_stream) {
+  TVM_FFI_ICHECK_EQ(remote_signal->device.device_type, kDLCUDA)
+      << "The device of remote_signal must be CUDA.";
+  TVM_FFI_ICHECK_EQ(remote_signal->ndim, 1);
+  TVM_FFI_ICHECK(remote_signal->dtype.code == kDLUInt && remote_signal->dtype.bits == 64)
+      << "The signal must be in uint64.";
+  TVM_FFI_ICHECK(slot >= 0 && slot < remote_signal->shape[0]) << "Invalid signal slot " << slot;
+  int local_tp_rank;
+  tvm::runtime::DiscoWorker* worker = tvm::runtime::ThreadLocalDiscoWorker::Get()->worker;
+  if (worker == nullptr) {
+    local_tp_rank = 0;
+  } else {
+    local_tp_rank = worker->worker_id;
+  }
+  uint64_t* signal_data = reinterpret_cast<uint64_t*>(
+      reinterpret_cast<char*>(remote_signal->data) + remote_signal->byte_offset);
+  cudaStream_t stream = static_cast<cudaStream_t>(transfer_stream);
+  // All the KV data put on the stream must be delivered before the signal.
+  nvshmemx_quiet_on_stream(stream);
+  nvshmemx_signal_op_on_stream(signal_data + slot, 1, NVSHMEM_SIGNAL_ADD,
+                               remote_tp_group_pe_offset + local_tp_rank, stream);
+  return 0;
+}
+
+int _KVTransferWaitSignal(DLTensor* signal, int64_t slot, int64_t value,
+                          TVMStreamHandle compute_stream) {
+  TVM_FFI_ICHECK_EQ(signal->device.device_type, kDLCUDA) << "The device of signal must be CUDA.";
+  TVM_FFI_ICHECK_EQ(signal->ndim, 1);
+  TVM_FFI_ICHECK(signal->dtype.code == kDLUInt && signal->dtype.bits == 64)
+      << "The signal must be in uint64.";
+  TVM_FFI_ICHECK(slot >= 0 && slot < signal->shape[0]) << "Invalid signal slot " << slot;
+  uint64_t* signal_data =
+      reinterpret_cast<uint64_t*>(reinterpret_cast<char*>(signal->data) + signal->byte_offset);
+  nvshmemx_signal_wait_until_on_stream(signal_data + slot, NVSHMEM_CMP_GE,
+                                       static_cast<uint64_t>(value),
+                                       static_cast<cudaStream_t>(compute_stream));
+  return 0;
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
   refl::GlobalDef()
       .def("nvshmem.KVTransfer", _KVTransfer)
-      .def("nvshmem.KVTransferPageToPage", _KVTransferPageToPage);
+      .def("nvshmem.KVTransferPageToPage", _KVTransferPageToPage)
+      .def("nvshmem.KVTransferSignal", _KVTransferSignal)
+      .def("nvshmem.KVTransferWaitSignal", _KVTransferWaitSignal);
 }
@@ -32,10 +32,39 @@
 #include <vector>
 
 #include "../../../../../3rdparty/compiler-rt/builtin_fp16.h"
+#include "../../../threading_backend.h"
 
 namespace tvm {
 namespace contrib {
 
+/*! \brief The minimum number of elements to sort for the rows to be sorted in parallel. */
+constexpr int64_t kMinParallelSortElements = 1 << 14;
+/*!
+ * \brief The ratio of the row length to k beyond which topk keeps a running heap of k elements
+ * instead of selecting them from the whole row.
+ */
+constexpr int64_t kTopkHeapRatio = 16;
+
+/*!
+ * \brief Run flambda(i, j) for each row of the sort axis, where i indexes the axes before it
+ * and j the axes after it. The rows are independent, so they are run on the runtime thread pool
+ * once there are enough elements to amortize the launch.
+ */
+template <typename F>
+void ForEachRow(int64_t axis_mul_before, int64_t axis_mul_after, int64_t axis_len, F flambda) {
+  int64_t num_rows = axis_mul_before * axis_mul_after;
+  if (num_rows > 1 && num_rows * axis_len >= kMinParallelSortElements) {
+    runtime::parallel_for_with_threading_backend(
+        [&](int64_t row) { flambda(row / axis_mul_after, row % axis_mul_after); }, 0, num_rows);
+  } else {
+    for (int64_t i = 0; i < axis_mul_before; ++i) {
+      for (int64_t j = 0; j < axis_mul_after; ++j) {
+        flambda(i, j);
+      }
+    }
+  }
+}
+
 template <typename DType, bool stable_comparison = false>
 bool CompareAscend(const std::pair<int64_t, DType>& lhs, const std::pair<int64_t, DType>& rhs) {
   if constexpr (stable_comparison) {
@@ -92,7 +121,6 @@ void RegisterArgsortNMS() {
         auto dtype = input->dtype;
         auto data_ptr = static_cast<float*>(input->data);
         auto sort_num_ptr = static_cast<int32_t*>(sort_num->data);
-        std::vector<std::pair<int32_t, float>> sorter;
         int64_t axis_mul_before = 1;
         int64_t axis_mul_after = 1;
 
@@ -119,42 +147,40 @@ void RegisterArgsortNMS() {
           }
         }
 
-        for (int64_t i = 0; i < axis_mul_before; ++i) {
-          for (int64_t j = 0; j < axis_mul_after; ++j) {
-            sorter.clear();
-            int32_t current_sort_num = *(sort_num_ptr + i * axis_mul_after + j);
-            int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-            for (int64_t k = 0; k < current_sort_num; ++k) {
-              int64_t full_idx = base_idx + k * axis_mul_after;
-              sorter.emplace_back(std::make_pair(k, *(data_ptr + full_idx)));
-            }
-            if (is_ascend) {
+        ForEachRow(axis_mul_before, axis_mul_after, input->shape[axis], [&](int64_t i, int64_t j) {
+          std::vector<std::pair<int32_t, float>> sorter;
+          int32_t current_sort_num = *(sort_num_ptr + i * axis_mul_after + j);
+          int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
+          for (int64_t k = 0; k < current_sort_num; ++k) {
+            int64_t full_idx = base_idx + k * axis_mul_after;
+            sorter.emplace_back(std::make_pair(k, *(data_ptr + full_idx)));
+          }
+          if (is_ascend) {
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-              if (dtype.bits == 16) {
-                std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<__fp16>);
-              } else {
+            if (dtype.bits == 16) {
+              std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<__fp16>);
+            } else {
 #endif
-                std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<float>);
+              std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<float>);
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-              }
+            }
 #endif
-            } else {
+          } else {
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-              if (dtype.bits == 16) {
-                std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<__fp16>);
-              } else {
+            if (dtype.bits == 16) {
+              std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<__fp16>);
+            } else {
 #endif
-                std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<float>);
+              std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<float>);
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-              }
-#endif
-            }
-            for (int32_t k = 0; k < input->shape[axis]; ++k) {
-              *(static_cast<int32_t*>(output->data) + base_idx + k * axis_mul_after) =
-                  k < static_cast<int32_t>(sorter.size()) ? sorter[k].first : k;
             }
+#endif
           }
-        }
+          for (int32_t k = 0; k < input->shape[axis]; ++k) {
+            *(static_cast<int32_t*>(output->data) + base_idx + k * axis_mul_after) =
+                k < static_cast<int32_t>(sorter.size()) ? sorter[k].first : k;
+          }
+        });
       });
 }
 
@@ -164,10 +190,9 @@ void sort_impl(
     std::function<void(OutType*, size_t, const std::pair<int64_t, DataType>&)> epilogue) {
   auto data_ptr = static_cast<DataType*>(input->data);
   auto out_ptr = static_cast<OutType*>(output->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -176,24 +201,23 @@ void sort_impl(
     }
   }
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
-      }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        epilogue(out_ptr, base_idx + k * axis_mul_after, sorter[k]);
-      }
+  ForEachRow(axis_mul_before, axis_mul_after, input->shape[axis], [&](int64_t i, int64_t j) {
+    std::vector<std::pair<int64_t, DataType>> sorter;
+    sorter.reserve(input->shape[axis]);
+    int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
+    for (int64_t k = 0; k < input->shape[axis]; ++k) {
+      int64_t full_idx = base_idx + k * axis_mul_after;
+      sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
     }
-  }
+    if (is_ascend) {
+      std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
+    } else {
+      std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
+    }
+    for (int64_t k = 0; k < input->shape[axis]; ++k) {
+      epilogue(out_ptr, base_idx + k * axis_mul_after, sorter[k]);
+    }
+  });
 }
 
 template <typename DataType, typename OutType>
@@ -367,14 +391,8 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
   IndicesType* indices_ptr =
       (out_indices == nullptr) ? nullptr : static_cast<IndicesType*>(out_indices->data);
 
-  // Maintain a min/max containing the top-k elements
-  std::vector<std::pair<int64_t, DataType>> running_heap;
-
-  // Need +1 when inserting new element before maintaining heap invariant
-  running_heap.reserve(k + 1);
-
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -382,65 +400,78 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
       axis_mul_after *= input->shape[i];
     }
   }
+  int64_t axis_len = input->shape[axis];
   if (k < 1) {
-    k = input->shape[axis];
+    k = axis_len;
   }
+  int64_t num_selected = std::min<int64_t>(k, axis_len);
+  using Element = std::pair<int64_t, DataType>;
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      running_heap.clear();
-      int64_t src_base_idx = i * input->shape[axis] * axis_mul_after + j;
+  auto topk_rows = [&](auto compare) {
+    ForEachRow(axis_mul_before, axis_mul_after, axis_len, [&](int64_t i, int64_t j) {
+      int64_t src_base_idx = i * axis_len * axis_mul_after + j;
       int64_t dst_base_idx = i * k * axis_mul_after + j;
-
-      // Start by creating min/max heap with fixed-k elements
-      int cur_axis_index = 0;
-      for (; cur_axis_index < k && cur_axis_index < input->shape[axis]; cur_axis_index++) {
-        int64_t full_idx = src_base_idx + cur_axis_index * axis_mul_after;
-        running_heap.emplace_back(std::make_pair(cur_axis_index, data_ptr[full_idx]));
-      }
-      if (!is_ascend) {
-        std::make_heap(running_heap.begin(), running_heap.end(), CompareDescend<DataType, true>);
+      std::vector<Element> selected;
+
+      if (num_selected * kTopkHeapRatio < axis_len) {
+        // Maintain a min/max heap containing the top-k elements, which rejects most elements with a
+        // single comparison against its root when k is small.
+        // Need +1 when inserting new element before maintaining heap invariant
+        selected.reserve(num_selected + 1);
+        int64_t cur_axis_index = 0;
+        for (; cur_axis_index < num_selected; cur_axis_index++) {
+          int64_t full_idx = src_base_idx + cur_axis_index * axis_mul_after;
+          selected.emplace_back(std::make_pair(cur_axis_index, data_ptr[full_idx]));
+        }
+        std::make_heap(selected.begin(), selected.end(), compare);
+        for (; cur_axis_index < axis_len; cur_axis_index++) {
+          int64_t full_idx = src_base_idx + cur_axis_index * axis_mul_after;
+          Element cur_val = {cur_axis_index, data_ptr[full_idx]};
+          if (compare(cur_val, selected[0])) {
+            selected.push_back(cur_val);
+            std::push_heap(selected.begin(), selected.end(), compare);
+            std::pop_heap(selected.begin(), selected.end(), compare);
+            selected.pop_back();
+          }
+        }
       } else {
-        std::make_heap(running_heap.begin(), running_heap.end(), CompareAscend<DataType, true>);
-      }
-
-      // Iterate through all elements, adding to heap along the way
-      for (; cur_axis_index < input->shape[axis]; cur_axis_index++) {
-        int64_t full_idx = src_base_idx + cur_axis_index * axis_mul_after;
-        std::pair<int64_t, DataType> cur_val = {cur_axis_index, data_ptr[full_idx]};
-
-        // Eq. to cur_val.second > running_heap.second
-        if (!is_ascend && CompareDescend<DataType, true>(cur_val, running_heap[0])) {
-          running_heap.push_back(cur_val);
-          std::push_heap(running_heap.begin(), running_heap.end(), CompareDescend<DataType, true>);
-          std::pop_heap(running_heap.begin(), running_heap.end(), CompareDescend<DataType, true>);
-          running_heap.pop_back();
-        } else if (is_ascend && CompareAscend<DataType, true>(cur_val, running_heap[0])) {
-          running_heap.push_back(cur_val);
-          std::push_heap(running_heap.begin(), running_heap.end(), CompareAscend<DataType, true>);
-          std::pop_heap(running_heap.begin(), running_heap.end(), CompareAscend<DataType, true>);
-          running_heap.pop_back();
+        // Select the top-k elements of the whole row in linear time, only they are sorted below.
+        selected.reserve(axis_len);
+        for (int64_t cur_axis_index = 0; cur_axis_index < axis_len; cur_axis_index++) {
+          int64_t full_idx = src_base_idx + cur_axis_index * axis_mul_after;
+          selected.emplace_back(std::make_pair(cur_axis_index, data_ptr[full_idx]));
+        }
+        if (num_selected < axis_len) {
+          std::nth_element(selected.begin(), selected.begin() + num_selected, selected.end(),
+                           compare);
+          selected.resize(num_selected);
         }
       }
 
-      // finally sort heap and deliver results
-      if (is_ascend) {
-        std::stable_sort(running_heap.begin(), running_heap.end(), CompareAscend<DataType, true>);
-      } else {
-        std::stable_sort(running_heap.begin(), running_heap.end(), CompareDescend<DataType, true>);
-      }
+      // The comparison breaks ties by index, so the order is the same as a stable sort.
+      std::sort(selected.begin(), selected.end(), compare);
 
-      for (uint32_t kk = 0; kk < running_heap.size(); ++kk) {
+      for (size_t kk = 0; kk < selected.size(); ++kk) {
         if (indices_ptr != nullptr) {
           indices_ptr[dst_base_idx + kk * axis_mul_after] =
-              static_cast<IndicesType>(running_heap[kk].first);
+              static_cast<IndicesType>(selected[kk].first);
         }
         if (values_ptr != nullptr) {
           values_ptr[dst_base_idx + kk * axis_mul_after] =
-              static_cast<DataType>(running_heap[kk].second);
+              static_cast<DataType>(selected[kk].second);
         }
       }
-    }
+    });
+  };
+  // Pass the comparisons as lambdas rather than function pointers so that they are inlined.
+  if (is_ascend) {
+    topk_rows([](const Element& lhs, const Element& rhs) {
+      return CompareAscend<DataType, true>(lhs, rhs);
+    });
+  } else {
+    topk_rows([](const Element& lhs, const Element& rhs) {
+      return CompareDescend<DataType, true>(lhs, rhs);
+    });
   }
 }
 
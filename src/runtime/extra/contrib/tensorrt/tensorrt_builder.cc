@@ -27,8 +27,10 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/tensor.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorrt_logger.h"
 #include "tensorrt_ops.h"
@@ -152,7 +154,8 @@ void TensorRTBuilder::AddLayer(int nid, const JSONGraphNode& node) {
   }
 }
 
-TensorRTEngineAndContext TensorRTBuilder::BuildEngine() {
+TensorRTEngineAndContext TensorRTBuilder::BuildEngine(
+    const std::vector<int64_t>& profile_batch_sizes) {
   // Build engine.
   config_ = builder_->createBuilderConfig();
   // TensorRT 10 replaced IBuilderConfig::setMaxWorkspaceSize with a tunable memory pool.
@@ -170,27 +173,37 @@ TensorRTEngineAndContext TensorRTBuilder::BuildEngine() {
     LOG(INFO) << "config finishes setting up calibrator as INT8 mode ... ";
   }
 
-  // Every network is explicit-batch in TRT10, so always add an optimization profile that pins each
-  // input to its concrete shape (with a minimum batch of 1 for dynamic batch dimensions).
-  auto profile = builder_->createOptimizationProfile();
-  for (int i = 0; i < network_->getNbInputs(); ++i) {
-    auto name = network_->getInput(i)->getName();
-    const uint32_t entry_id = entry_id_map_[name];
-    std::vector<int64_t> shape(data_entry_[entry_id]->shape,
-                               data_entry_[entry_id]->shape + data_entry_[entry_id]->ndim);
-    auto dims = VectorToTrtDims(shape);
-
-    profile->setDimensions(name, nvinfer1::OptProfileSelector::kOPT, dims);
-    profile->setDimensions(name, nvinfer1::OptProfileSelector::kMAX, dims);
-    // The network inputs are built with static shapes, so the profile must match them exactly; only
-    // lower kMIN for a genuinely dynamic (-1) leading dimension.
-    if (network_->getInput(i)->getDimensions().nbDims >= 1 &&
-        network_->getInput(i)->getDimensions().d[0] == -1) {
-      dims.d[0] = 1;
+  // Every network is explicit-batch in TRT10, so always add optimization profiles. Without batch
+  // sizes, a single profile pins each input to its concrete shape (with a minimum batch of 1 for
+  // dynamic batch dimensions). Otherwise, profile k covers the k-th range of batch sizes of the
+  // inputs with a dynamic batch dimension while the others stay pinned.
+  size_t num_profiles = std::max<size_t>(profile_batch_sizes.size(), 1);
+  for (size_t k = 0; k < num_profiles; ++k) {
+    auto profile = builder_->createOptimizationProfile();
+    for (int i = 0; i < network_->getNbInputs(); ++i) {
+      auto name = network_->getInput(i)->getName();
+      const uint32_t entry_id = entry_id_map_[name];
+      std::vector<int64_t> shape(data_entry_[entry_id]->shape,
+                                 data_entry_[entry_id]->shape + data_entry_[entry_id]->ndim);
+      auto dims = VectorToTrtDims(shape);
+      // The network inputs are built with static shapes, so the profile must match them exactly;
+      // only vary a genuinely dynamic (-1) leading dimension.
+      bool dynamic_batch = network_->getInput(i)->getDimensions().nbDims >= 1 &&
+                           network_->getInput(i)->getDimensions().d[0] == -1;
+      auto min_dims = dims;
+      if (dynamic_batch) {
+        min_dims.d[0] = 1;
+        if (!profile_batch_sizes.empty()) {
+          min_dims.d[0] = k == 0 ? 1 : profile_batch_sizes[k - 1] + 1;
+          dims.d[0] = profile_batch_sizes[k];
+        }
+      }
+      profile->setDimensions(name, nvinfer1::OptProfileSelector::kOPT, dims);
+      profile->setDimensions(name, nvinfer1::OptProfileSelector::kMAX, dims);
+      profile->setDimensions(name, nvinfer1::OptProfileSelector::kMIN, min_dims);
     }
-    profile->setDimensions(name, nvinfer1::OptProfileSelector::kMIN, dims);
+    config_->addOptimizationProfile(profile);
   }
-  config_->addOptimizationProfile(profile);
 
   // TensorRT 10 removed buildEngineWithConfig; build a serialized engine and deserialize it through
   // an IRuntime that is kept alive alongside the engine (TensorRTEngineAndContext::runtime).
@@ -108,9 +108,13 @@ class TensorRTBuilder {
   /*!
    * \brief Takes network definition and "compiles" a TensorRT engine which can be used for
    * inference. This step is time confusing.
+   * \param profile_batch_sizes The largest batch size of each optimization profile, in increasing
+   * order. Profile k serves the batch sizes in (profile_batch_sizes[k - 1], profile_batch_sizes[k]]
+   * of the inputs with a dynamic batch dimension. If empty, a single profile is built for the
+   * current input shapes.
    * \return TRT engine, context, and input/output information.
    */
-  TensorRTEngineAndContext BuildEngine();
+  TensorRTEngineAndContext BuildEngine(const std::vector<int64_t>& profile_batch_sizes = {});
 
  private:
   /*! \brief Convert a DLTensor to a TensorRT weight. */
@@ -28,10 +28,17 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/tensor.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../../../../support/env.h"
@@ -77,13 +84,12 @@ class TensorRTRuntime : public JSONRuntimeBase {
       : JSONRuntimeBase(symbol_name, graph_json, const_names),
         use_implicit_batch_(true),
         max_workspace_size_(size_t(1) << 30),
-        max_batch_size_(-1),
         multi_engine_mode_(false),
         use_fp16_(false) {
-    const bool use_int8 = support::GetEnv("TVM_TENSORRT_USE_INT8", false);
+    use_int8_ = support::GetEnv("TVM_TENSORRT_USE_INT8", false);
     multi_engine_mode_ = support::GetEnv("TVM_TENSORRT_MULTI_ENGINE", false);
     num_calibration_batches_remaining_ = support::GetEnv("TENSORRT_NUM_CALI_INT8", 0);
-    if (use_int8) {
+    if (use_int8_) {
       TVM_FFI_ICHECK(num_calibration_batches_remaining_ != 0)
           << "When using INT8 mode, "
           << "environment variable TENSORRT_NUM_CALI_INT8"
@@ -94,6 +100,18 @@ class TensorRTRuntime : public JSONRuntimeBase {
       TVM_FFI_ICHECK(multi_engine_mode_ == false) << "When using int8 mode, "
                                                   << "multi-engine is not allowed";
     }
+    // The upper bounds of the batch sizes served by the optimization profiles, e.g. "1,8,32".
+    std::istringstream profile_batch_sizes(
+        support::GetEnv("TVM_TENSORRT_PROFILE_BATCH_SIZES", std::string("")));
+    for (std::string size; std::getline(profile_batch_sizes, size, ',');) {
+      if (!size.empty()) profile_batch_sizes_.push_back(std::stoll(size));
+    }
+    std::sort(profile_batch_sizes_.begin(), profile_batch_sizes_.end());
+    profile_batch_sizes_.erase(
+        std::unique(profile_batch_sizes_.begin(), profile_batch_sizes_.end()),
+        profile_batch_sizes_.end());
+    TVM_FFI_ICHECK(profile_batch_sizes_.empty() || profile_batch_sizes_[0] > 0)
+        << "TVM_TENSORRT_PROFILE_BATCH_SIZES must be positive";
   }
 
   /*!
@@ -119,6 +137,13 @@ class TensorRTRuntime : public JSONRuntimeBase {
         << "The number of input constants must match the number of required.";
     LoadGlobalAttributes();
     SetupConstants(consts);
+    for (uint32_t nid : input_nodes_) {
+      if (nodes_[nid].GetOpType() != "input") continue;
+      for (size_t j = 0; j < nodes_[nid].GetOpShape().size(); ++j) {
+        input_entries_.emplace_back(nodes_[nid].GetOpName() + "_" + std::to_string(j),
+                                    EntryID(nid, j));
+      }
+    }
     GetCachedEnginesFromDisk();
   }
 
@@ -153,10 +178,15 @@ class TensorRTRuntime : public JSONRuntimeBase {
   void DestroyEngines() {
     for (auto& it : trt_engine_cache_) {
       // TensorRT 10 removed obj->destroy(); release with delete. The deserialization runtime must
-      // outlive the engine it produced, so delete the context, then the engine, then the runtime.
-      VLOG(1) << "Destroying TensorRT context for function '" << it.first.first << "' (batch size "
-              << it.first.second << ")";
-      delete it.second.context;
+      // outlive the engine it produced, so delete the contexts, then the engine, then the runtime.
+      VLOG(1) << "Destroying TensorRT contexts for function '" << it.first.first
+              << "' (batch size " << it.first.second << ")";
+      for (auto& [profile, contexts] : idle_contexts_[it.second.engine]) {
+        for (nvinfer1::IExecutionContext* context : contexts) {
+          delete context;
+        }
+      }
+      idle_contexts_.erase(it.second.engine);
       VLOG(1) << "Destroying TensorRT engine for function '" << it.first.first << "' (batch size "
               << it.first.second << ")";
       delete it.second.engine;
@@ -171,12 +201,82 @@ class TensorRTRuntime : public JSONRuntimeBase {
     VLOG(1) << "Destroyed TensorRT runtime";
   }
 
+  ffi::Optional<ffi::Function> GetFunction(const ffi::String& name) override {
+    // JSONRuntimeBase::SetInputOutputBuffers(...) binds the arguments to the shared data entries,
+    // which is not thread safe. Bind them to a copy of the data entries per call instead, so that
+    // the threads running the module share its engines, each on an execution context of its own.
+    ffi::ObjectPtr<ffi::Object> sptr_to_self = ffi::GetObjectPtr<ffi::Object>(this);
+    if (this->symbol_name_ == name) {
+      return ffi::Function([sptr_to_self, this](ffi::PackedArgs args, ffi::Any* rv) {
+        TVM_FFI_ICHECK(this->initialized_) << "The module has not been initialized";
+        TVM_FFI_ICHECK_EQ(args.size(), input_var_eid_.size() + outputs_.size())
+            << "Found mismatch in the number of provided data entries and required.";
+        std::vector<const DLTensor*> data_entry = data_entry_;
+        for (size_t i = 0; i < static_cast<size_t>(args.size()); i++) {
+          auto eid = i < input_var_eid_.size() ? input_var_eid_[i]
+                                               : EntryID(outputs_[i - input_var_eid_.size()]);
+          if (auto opt_nd = args[i].as<Tensor>()) {
+            Tensor arr = opt_nd.value();
+            data_entry[eid] = arr.operator->();
+          } else {
+            data_entry[eid] = args[i].cast<DLTensor*>();
+          }
+        }
+        this->Run(data_entry);
+      });
+    }
+    return JSONRuntimeBase::GetFunction(name);
+  }
+
   /*! \brief Run inference using built engine. */
-  void Run() override {
-    auto& engine_and_context = GetOrBuildEngine();
-    int batch_size = GetBatchSize();
+  void Run() override { Run(data_entry_); }
+
+  /*!
+   * \brief Run inference using built engine.
+   * \param data_entry The data entries with the inputs and outputs of this call bound.
+   */
+  void Run(const std::vector<const DLTensor*>& data_entry) {
+    int batch_size = GetBatchSize(data_entry);
     if (batch_size == 0) return;
-    auto context = engine_and_context.context;
+
+    // The INT8 calibration and the staging buffers of tensors off the GPU are shared by the
+    // calls, which are serialized then. Otherwise the calls only share the engines, which are
+    // replaced under the exclusive lock.
+    bool exclusive = use_int8_;
+    for (uint32_t eid : input_var_eid_) {
+      exclusive |= data_entry[eid]->device.device_type != kDLCUDA;
+    }
+    for (const auto& output : outputs_) {
+      exclusive |= data_entry[EntryID(output)]->device.device_type != kDLCUDA;
+    }
+    std::shared_lock<std::shared_mutex> shared_lock(engine_mu_, std::defer_lock);
+    std::unique_lock<std::shared_mutex> unique_lock(engine_mu_, std::defer_lock);
+    TensorRTEngineAndContext* engine_and_context = nullptr;
+    int profile = -1;
+    if (!exclusive) {
+      shared_lock.lock();
+      engine_and_context = FindCompatibleEngine(data_entry, &profile);
+      if (engine_and_context == nullptr) {
+        shared_lock.unlock();
+      }
+    }
+    if (engine_and_context == nullptr) {
+      unique_lock.lock();
+      engine_and_context = &GetOrBuildEngine(data_entry, &profile);
+    }
+
+    const DLDevice& dev = data_entry[input_var_eid_[0]]->device;
+    const int device_id = dev.device_type == kDLCUDA ? dev.device_id : 0;
+    cudaStream_t stream = static_cast<cudaStream_t>(TVMFFIEnvGetStream(kDLCUDA, device_id));
+    nvinfer1::IExecutionContext* context =
+        AcquireContext(*engine_and_context, profile, stream);
+    struct ContextReleaser {
+      TensorRTRuntime* self;
+      const nvinfer1::ICudaEngine* engine;
+      int profile;
+      nvinfer1::IExecutionContext* context;
+      ~ContextReleaser() { self->ReleaseContext(engine, profile, context); }
+    } releaser{this, engine_and_context->engine, profile, context};
 
     // TensorRT 10 uses named-tensor I/O (setInputShape/setTensorAddress/enqueueV3, no binding
     // indices). Track input device pointers and per-sample element counts for the INT8 calibrator.
@@ -184,36 +284,29 @@ class TensorRTRuntime : public JSONRuntimeBase {
     std::vector<size_t> input_binding_sizes;
 
     // Setup input bindings.
-    for (size_t i = 0; i < input_nodes_.size(); ++i) {
-      auto nid = input_nodes_[i];
-      if (nodes_[nid].GetOpType() == "input") {
-        for (size_t j = 0; j < nodes_[nid].GetOpShape().size(); ++j) {
-          uint32_t eid = EntryID(nid, j);
-          const std::string name = nodes_[nid].GetOpName() + "_" + std::to_string(j);
-          std::vector<int64_t> shape(data_entry_[eid]->shape,
-                                     data_entry_[eid]->shape + data_entry_[eid]->ndim);
-          auto dims = VectorToTrtDims(shape);
-          TVM_FFI_ICHECK(context->setInputShape(name.c_str(), dims));
-
-          void* device_ptr = nullptr;
-          if (data_entry_[eid]->device.device_type == kDLCUDA) {
-            device_ptr = data_entry_[eid]->data;
-          } else {
-            auto device_buffer = GetOrAllocateDeviceBuffer(name, eid);
-            device_buffer.CopyFrom(data_entry_[eid]);
-            device_ptr = device_buffer->data;
-          }
-          TVM_FFI_ICHECK(context->setTensorAddress(name.c_str(), device_ptr));
-
-          // Per-sample element count (exclude the batch dimension d[0]); the INT8 calibrator
-          // multiplies by the batch size itself when copying calibration data, so including the
-          // batch dim here would over-read the device buffer by a factor of batch_size.
-          int num_elements = 1;
-          for (int k = 1; k < dims.nbDims; ++k) num_elements *= dims.d[k];
-          input_bindings.push_back(device_ptr);
-          input_binding_sizes.push_back(static_cast<size_t>(num_elements));
-        }
+    for (const auto& [name, eid] : input_entries_) {
+      std::vector<int64_t> shape(data_entry[eid]->shape,
+                                 data_entry[eid]->shape + data_entry[eid]->ndim);
+      auto dims = VectorToTrtDims(shape);
+      TVM_FFI_ICHECK(context->setInputShape(name.c_str(), dims));
+
+      void* device_ptr = nullptr;
+      if (data_entry[eid]->device.device_type == kDLCUDA) {
+        device_ptr = data_entry[eid]->data;
+      } else {
+        auto device_buffer = GetOrAllocateDeviceBuffer(data_entry, name, eid);
+        device_buffer.CopyFrom(data_entry[eid]);
+        device_ptr = device_buffer->data;
       }
+      TVM_FFI_ICHECK(context->setTensorAddress(name.c_str(), device_ptr));
+
+      // Per-sample element count (exclude the batch dimension d[0]); the INT8 calibrator
+      // multiplies by the batch size itself when copying calibration data, so including the
+      // batch dim here would over-read the device buffer by a factor of batch_size.
+      int num_elements = 1;
+      for (int k = 1; k < dims.nbDims; ++k) num_elements *= dims.d[k];
+      input_bindings.push_back(device_ptr);
+      input_binding_sizes.push_back(static_cast<size_t>(num_elements));
     }
 
     // add batch data to calibrator
@@ -230,12 +323,12 @@ class TensorRTRuntime : public JSONRuntimeBase {
     // Setup output bindings.
     for (size_t i = 0; i < outputs_.size(); ++i) {
       uint32_t eid = EntryID(outputs_[i]);
-      const std::string& name = engine_and_context.outputs[i];
+      const std::string& name = engine_and_context->outputs[i];
       void* device_ptr = nullptr;
-      if (data_entry_[eid]->device.device_type == kDLCUDA) {
-        device_ptr = data_entry_[eid]->data;
+      if (data_entry[eid]->device.device_type == kDLCUDA) {
+        device_ptr = data_entry[eid]->data;
       } else {
-        auto device_buffer = GetOrAllocateDeviceBuffer(name, eid);
+        auto device_buffer = GetOrAllocateDeviceBuffer(data_entry, name, eid);
         device_ptr = device_buffer->data;
       }
       TVM_FFI_ICHECK(context->setTensorAddress(name.c_str(), device_ptr));
@@ -244,72 +337,101 @@ class TensorRTRuntime : public JSONRuntimeBase {
     // Run on TVM's current CUDA stream so the engine is ordered after the inputs produced upstream
     // (and to avoid TensorRT's default-stream synchronization warning). enqueueV3 is async-only in
     // TRT10, so synchronize afterwards to preserve Run()'s blocking semantics.
-    const DLDevice& dev = data_entry_[input_var_eid_[0]]->device;
-    const int device_id = dev.device_type == kDLCUDA ? dev.device_id : 0;
-    cudaStream_t stream = static_cast<cudaStream_t>(TVMFFIEnvGetStream(kDLCUDA, device_id));
     TVM_FFI_ICHECK(context->enqueueV3(stream)) << "Running TensorRT failed.";
     TVM_FFI_CHECK_CUDA_ERROR(cudaStreamSynchronize(stream));
 
     // Copy outputs from GPU buffers if needed.
     for (size_t i = 0; i < outputs_.size(); ++i) {
       uint32_t eid = EntryID(outputs_[i]);
-      const std::string& name = engine_and_context.outputs[i];
-      if (data_entry_[eid]->device.device_type != kDLCUDA) {
-        auto device_buffer = GetOrAllocateDeviceBuffer(name, eid);
-        device_buffer.CopyTo(const_cast<DLTensor*>(data_entry_[eid]));
+      const std::string& name = engine_and_context->outputs[i];
+      if (data_entry[eid]->device.device_type != kDLCUDA) {
+        auto device_buffer = GetOrAllocateDeviceBuffer(data_entry, name, eid);
+        device_buffer.CopyTo(const_cast<DLTensor*>(data_entry[eid]));
       }
     }
   }
 
  private:
   /*! \brief Get batch size for engine from the runtime input shapes. */
-  int GetBatchSize() {
-    return data_entry_[input_var_eid_[0]]->ndim == 0 ? 1 : data_entry_[input_var_eid_[0]]->shape[0];
+  int GetBatchSize(const std::vector<const DLTensor*>& data_entry) {
+    const DLTensor* input = data_entry[input_var_eid_[0]];
+    return input->ndim == 0 ? 1 : input->shape[0];
   }
 
-  /*! \brief Find an engine in the cache which we can reuse depending on the mode. If no compatible
-   * engine exists, return false to indicate that a new one should be built. */
-  bool FindCompatibleEngine(int batch_size, int* compatible_engine_batch_size) {
-    if (multi_engine_mode_) {
-      // Exact match is required for multi engine mode.
-      if (trt_engine_cache_.count(std::make_pair(symbol_name_, batch_size))) {
-        *compatible_engine_batch_size = batch_size;
-        return true;
+  /*!
+   * \brief Find the optimization profile of the engine which admits the input shapes.
+   * \return The index of the profile, or -1 if none does.
+   */
+  int FindProfile(const TensorRTEngineAndContext& engine_and_context,
+                  const std::vector<const DLTensor*>& data_entry) {
+    for (int profile = 0; profile < engine_and_context.engine->getNbOptimizationProfiles();
+         ++profile) {
+      bool admitted = true;
+      for (const auto& [name, eid] : input_entries_) {
+        nvinfer1::Dims min_dims = engine_and_context.engine->getProfileShape(
+            name.c_str(), profile, nvinfer1::OptProfileSelector::kMIN);
+        nvinfer1::Dims max_dims = engine_and_context.engine->getProfileShape(
+            name.c_str(), profile, nvinfer1::OptProfileSelector::kMAX);
+        const DLTensor* input = data_entry[eid];
+        admitted &= min_dims.nbDims == input->ndim;
+        for (int k = 0; admitted && k < input->ndim; ++k) {
+          admitted &= min_dims.d[k] <= input->shape[k] && input->shape[k] <= max_dims.d[k];
+        }
+        if (!admitted) break;
       }
-      return false;
+      if (admitted) return profile;
     }
-    // Single-engine mode: TensorRT 10 engines are explicit-batch and their optimization profile
-    // pins the built batch size, so a cached engine can only serve that exact batch. Require an
-    // exact match (otherwise a smaller batch would be rejected by setInputShape) and rebuild on any
-    // change. This replaces the implicit-batch "any batch <= max" reuse that TRT10 removed.
-    if (batch_size == max_batch_size_) {
-      *compatible_engine_batch_size = max_batch_size_;
-      return true;
+    return -1;
+  }
+
+  /*!
+   * \brief Find an engine in the cache which we can reuse depending on the mode, and the profile
+   * to run it with. If no compatible engine exists, return nullptr to indicate that a new one
+   * should be built.
+   */
+  TensorRTEngineAndContext* FindCompatibleEngine(const std::vector<const DLTensor*>& data_entry,
+                                                 int* profile) {
+    int batch_size = GetBatchSize(data_entry);
+    for (auto& [key, engine_and_context] : trt_engine_cache_) {
+      // Exact match of the batch size the engine was built for is required for multi engine
+      // mode, while any engine with a profile admitting the input shapes is reused otherwise.
+      if (multi_engine_mode_ && key.second != batch_size) continue;
+      *profile = FindProfile(engine_and_context, data_entry);
+      if (*profile >= 0) return &engine_and_context;
     }
-    return false;
+    return nullptr;
   }
 
   /*!
    * \brief Build TensorRT engine from JSON representation and cache it. If compatible engine is
-   * already built, do nothing.
+   * already built, do nothing. Requires the exclusive lock on the engines.
    */
-  TensorRTEngineAndContext& GetOrBuildEngine() {
-    int batch_size = GetBatchSize();
-    int compatible_engine_batch_size = -1;
-    bool find_engine_flag = FindCompatibleEngine(batch_size, &compatible_engine_batch_size);
-    const bool use_int8 = (support::GetEnv("TVM_TENSORRT_USE_INT8", 0) != 0);
+  TensorRTEngineAndContext& GetOrBuildEngine(const std::vector<const DLTensor*>& data_entry,
+                                             int* profile) {
+    int batch_size = GetBatchSize(data_entry);
+    TensorRTEngineAndContext* compatible_engine = FindCompatibleEngine(data_entry, profile);
     const bool int8_calibration_not_used_or_not_complete =
         (calibrator_ != nullptr && num_calibration_batches_remaining_ != 0);
-    if (find_engine_flag &&
-        (!use_int8 || calibrator_ == nullptr || int8_calibration_not_used_or_not_complete)) {
+    if (compatible_engine != nullptr &&
+        (!use_int8_ || calibrator_ == nullptr || int8_calibration_not_used_or_not_complete)) {
       // A compatible engine already exists.
-      return trt_engine_cache_.at(std::make_pair(symbol_name_, compatible_engine_batch_size));
+      return *compatible_engine;
     }
 
-    // For single engine mode, remove previous engine and update max_batch_size.
+    // The profiles cover the configured batch sizes, extended to the current one. Multi engine
+    // mode builds an engine per batch size, so it keeps a single profile.
+    std::vector<int64_t> profile_batch_sizes;
+    if (!multi_engine_mode_ && !profile_batch_sizes_.empty()) {
+      profile_batch_sizes = profile_batch_sizes_;
+      if (profile_batch_sizes.back() < batch_size) {
+        profile_batch_sizes.push_back(batch_size);
+      }
+    }
+    int engine_batch_size = profile_batch_sizes.empty() ? batch_size : profile_batch_sizes.back();
+
+    // For single engine mode, remove previous engine.
     if (!multi_engine_mode_) {
       DestroyEngines();
-      max_batch_size_ = batch_size;
     }
     DLOG(INFO) << "Building new TensorRT engine for subgraph " << symbol_name_
                << " with batch size " << batch_size;
@@ -317,27 +439,32 @@ class TensorRTRuntime : public JSONRuntimeBase {
     // Build engine.
     if (calibrator_ != nullptr && num_calibration_batches_remaining_ == 0) {
       // Calibration complete and build int8 engine
-      BuildEngineFromJson(batch_size);
+      BuildEngineFromJson(data_entry, engine_batch_size, profile_batch_sizes);
       calibrator_.reset(nullptr);
     } else {
       // Build new engine
-      BuildEngineFromJson(batch_size);
+      BuildEngineFromJson(data_entry, engine_batch_size, profile_batch_sizes);
       TensorRTEngineAndContext& engine_and_context =
-          trt_engine_cache_[std::make_pair(symbol_name_, batch_size)];
-      if (use_int8) {
-        this->CreateInt8Calibrator(engine_and_context);
+          trt_engine_cache_[std::make_pair(symbol_name_, engine_batch_size)];
+      if (use_int8_) {
+        this->CreateInt8Calibrator(engine_and_context, batch_size);
       }
     }
 
     VLOG(1) << "Finished building TensorRT engine for subgraph " << symbol_name_
             << " with batch size " << batch_size;
-    CacheEngineToDisk();
-    return trt_engine_cache_.at(std::make_pair(symbol_name_, batch_size));
+    TensorRTEngineAndContext& engine_and_context =
+        trt_engine_cache_.at(std::make_pair(symbol_name_, engine_batch_size));
+    CacheEngineToDisk(engine_and_context, engine_batch_size);
+    *profile = FindProfile(engine_and_context, data_entry);
+    TVM_FFI_ICHECK_GE(*profile, 0) << "The TensorRT engine does not admit the input shapes";
+    return engine_and_context;
   }
 
-  void BuildEngineFromJson(int batch_size) {
+  void BuildEngineFromJson(const std::vector<const DLTensor*>& data_entry, int engine_batch_size,
+                           const std::vector<int64_t>& profile_batch_sizes) {
     const bool use_fp16 = support::GetEnv("TVM_TENSORRT_USE_FP16", false) || use_fp16_;
-    TensorRTBuilder builder(&GetTensorRTLogger(), data_entry_, max_workspace_size_, use_fp16,
+    TensorRTBuilder builder(&GetTensorRTLogger(), data_entry, max_workspace_size_, use_fp16,
                             calibrator_.get());
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
       auto nid = input_nodes_[i];
@@ -348,7 +475,7 @@ class TensorRTRuntime : public JSONRuntimeBase {
       } else {
         TVM_FFI_ICHECK_EQ(node.GetOpType(), "const");
         uint32_t eid = EntryID(nid, 0);
-        builder.AddConstant(nid, data_entry_[eid]);
+        builder.AddConstant(nid, data_entry[eid]);
       }
     }
 
@@ -364,8 +491,45 @@ class TensorRTRuntime : public JSONRuntimeBase {
       builder.AddOutput(outputs_[i], EntryID(outputs_[i]));
     }
 
-    TensorRTEngineAndContext engine_and_context = builder.BuildEngine();
-    trt_engine_cache_[std::make_pair(symbol_name_, batch_size)] = engine_and_context;
+    AddEngine(engine_batch_size, builder.BuildEngine(profile_batch_sizes));
+  }
+
+  /*! \brief Add the engine to the cache, its context becoming the first idle one. */
+  void AddEngine(int engine_batch_size, const TensorRTEngineAndContext& engine_and_context) {
+    std::lock_guard<std::mutex> lock(context_mu_);
+    idle_contexts_[engine_and_context.engine][0].push_back(engine_and_context.context);
+    trt_engine_cache_[std::make_pair(symbol_name_, engine_batch_size)] = engine_and_context;
+  }
+
+  /*!
+   * \brief Take an idle execution context of the engine using the optimization profile, or create
+   * one, so that the threads running the engine do not share a context.
+   */
+  nvinfer1::IExecutionContext* AcquireContext(const TensorRTEngineAndContext& engine_and_context,
+                                              int profile, cudaStream_t stream) {
+    {
+      std::lock_guard<std::mutex> lock(context_mu_);
+      auto& contexts = idle_contexts_[engine_and_context.engine][profile];
+      if (!contexts.empty()) {
+        nvinfer1::IExecutionContext* context = contexts.back();
+        contexts.pop_back();
+        return context;
+      }
+    }
+    nvinfer1::IExecutionContext* context = engine_and_context.engine->createExecutionContext();
+    TVM_FFI_ICHECK(context) << "Failed to create the TensorRT execution context.";
+    if (profile != 0) {
+      TVM_FFI_ICHECK(context->setOptimizationProfileAsync(profile, stream))
+          << "Failed to select the optimization profile " << profile;
+    }
+    return context;
+  }
+
+  /*! \brief Return the execution context to the idle ones of the engine. */
+  void ReleaseContext(const nvinfer1::ICudaEngine* engine, int profile,
+                      nvinfer1::IExecutionContext* context) {
+    std::lock_guard<std::mutex> lock(context_mu_);
+    idle_contexts_[engine][profile].push_back(context);
   }
 
   /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will check that directory for
@@ -375,15 +539,28 @@ class TensorRTRuntime : public JSONRuntimeBase {
   bool GetCachedEnginesFromDisk() {
     std::string cache_dir = support::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
     if (cache_dir.empty()) return false;
-    std::string key = GetSubgraphKey();
-    std::string path = cache_dir + "/" + key + ".plan";
-    // Check if engine is in the cache.
-    std::ifstream infile(path, std::ios::binary);
-    if (!infile.good()) return false;
+    // The engines of the subgraph are named after the hash of their profiles, see EnginePath.
+    std::string prefix = GetSubgraphKey() + "_";
+    bool loaded = false;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir, ec)) {
+      std::string file_name = entry.path().filename().string();
+      if (entry.path().extension() != ".plan" || file_name.rfind(prefix, 0) != 0 ||
+          file_name.size() != prefix.size() + kProfileHashLength + 5) {
+        continue;
+      }
+      loaded |= LoadEngineFromDisk(entry.path().string());
+    }
+    return loaded;
+  }
+
+  /*! \brief Load the engine and its metadata cached at the path. */
+  bool LoadEngineFromDisk(const std::string& path) {
     LOG(INFO) << "Loading cached TensorRT engine from " << path;
-    infile.close();
     std::string serialized_engine;
     LoadBinaryFromFile(path, &serialized_engine);
+    std::string meta_path = path.substr(0, path.size() - 5) + ".meta";
+    if (!std::ifstream(meta_path).good()) return false;
     // Deserialize engine. TensorRT 10 dropped the trailing IPluginFactory* argument and the runtime
     // must outlive the engine, so it is owned by the cached TensorRTEngineAndContext.
     nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(GetTensorRTLogger());
@@ -401,11 +578,9 @@ class TensorRTRuntime : public JSONRuntimeBase {
     engine_and_context.context = engine_and_context.engine->createExecutionContext();
     // Load metadata
     namespace json = ::tvm::ffi::json;
-    std::string meta_path = cache_dir + "/" + key + ".meta";
     std::string serialized_meta;
     LoadBinaryFromFile(meta_path, &serialized_meta);
     auto meta_obj = json::Parse(serialized_meta).cast<json::Object>();
-    int batch_size;
     // Read inputs
     {
       auto arr = meta_obj.at(ffi::String("inputs")).cast<json::Array>();
@@ -423,9 +598,8 @@ class TensorRTRuntime : public JSONRuntimeBase {
       }
     }
     // Read batch_size
-    batch_size = static_cast<int>(meta_obj.at(ffi::String("batch_size")).cast<int64_t>());
-    trt_engine_cache_[std::make_pair(symbol_name_, batch_size)] = engine_and_context;
-    max_batch_size_ = batch_size;
+    int batch_size = static_cast<int>(meta_obj.at(ffi::String("batch_size")).cast<int64_t>());
+    AddEngine(batch_size, engine_and_context);
     LOG(INFO) << "finished loading engine and context ... ";
     return true;
   }
@@ -433,16 +607,14 @@ class TensorRTRuntime : public JSONRuntimeBase {
   /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will save the engine to that
    * directory so it can be loaded later.
    */
-  void CacheEngineToDisk() {
-    int batch_size = GetBatchSize();
+  void CacheEngineToDisk(const TensorRTEngineAndContext& engine_and_context,
+                         int engine_batch_size) {
     std::string cache_dir = support::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
     if (cache_dir.empty()) return;
-    std::string key = GetSubgraphKey();
-    std::string path = cache_dir + "/" + key + ".plan";
+    std::string path = EnginePath(cache_dir, engine_and_context);
     DLOG(INFO) << "Caching TensorRT engine to " << path;
     // Serialize engine to disk
-    nvinfer1::IHostMemory* serialized_engine =
-        trt_engine_cache_[std::make_pair(symbol_name_, batch_size)].engine->serialize();
+    nvinfer1::IHostMemory* serialized_engine = engine_and_context.engine->serialize();
     SaveBinaryToFile(path, std::string(static_cast<const char*>(serialized_engine->data()),
                                        serialized_engine->size()));
     delete serialized_engine;
@@ -451,23 +623,58 @@ class TensorRTRuntime : public JSONRuntimeBase {
     json::Object meta_obj;
     {
       json::Array inputs_arr;
-      for (const auto& s : trt_engine_cache_[std::make_pair(symbol_name_, batch_size)].inputs) {
+      for (const auto& s : engine_and_context.inputs) {
         inputs_arr.push_back(ffi::String(s));
       }
       meta_obj.Set(ffi::String("inputs"), std::move(inputs_arr));
     }
     {
       json::Array outputs_arr;
-      for (const auto& s : trt_engine_cache_[std::make_pair(symbol_name_, batch_size)].outputs) {
+      for (const auto& s : engine_and_context.outputs) {
         outputs_arr.push_back(ffi::String(s));
       }
       meta_obj.Set(ffi::String("outputs"), std::move(outputs_arr));
     }
-    meta_obj.Set(ffi::String("batch_size"), static_cast<int64_t>(batch_size));
-    std::string meta_path = cache_dir + "/" + key + ".meta";
+    meta_obj.Set(ffi::String("batch_size"), static_cast<int64_t>(engine_batch_size));
+    std::string meta_path = path.substr(0, path.size() - 5) + ".meta";
     SaveBinaryToFile(meta_path, std::string(json::Stringify(meta_obj)));
   }
 
+  /*!
+   * \brief The path of the cached engine, named after the subgraph key and the hash of the
+   * TensorRT version and the input shape ranges of all the optimization profiles of the engine,
+   * so that the engines built for different batch sizes do not overwrite each other.
+   */
+  std::string EnginePath(const std::string& cache_dir,
+                         const TensorRTEngineAndContext& engine_and_context) {
+    std::ostringstream profiles;
+    profiles << getInferLibVersion();
+    for (int profile = 0; profile < engine_and_context.engine->getNbOptimizationProfiles();
+         ++profile) {
+      for (const auto& [name, eid] : input_entries_) {
+        profiles << ";" << name;
+        for (auto selector :
+             {nvinfer1::OptProfileSelector::kMIN, nvinfer1::OptProfileSelector::kMAX}) {
+          nvinfer1::Dims dims =
+              engine_and_context.engine->getProfileShape(name.c_str(), profile, selector);
+          for (int k = 0; k < dims.nbDims; ++k) {
+            profiles << "," << dims.d[k];
+          }
+        }
+      }
+      profiles << "|";
+    }
+    // The 64-bit FNV-1a hash, which unlike std::hash is stable across builds.
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : profiles.str()) {
+      hash = (hash ^ c) * 0x100000001B3ULL;
+    }
+    std::ostringstream os;
+    os << cache_dir << "/" << GetSubgraphKey() << "_" << std::hex
+       << std::setw(kProfileHashLength) << std::setfill('0') << hash << ".plan";
+    return os.str();
+  }
+
   std::string GetSubgraphKey() {
     // Using this key will only allow a single model per TVM_TENSORRT_CACHE_DIR directory. We could
     // instead use a hash of graph_json and all weights to allow many models in the same directory,
@@ -477,42 +684,59 @@ class TensorRTRuntime : public JSONRuntimeBase {
 
   /*! \brief Retreive a GPU buffer for input or output or allocate if needed. Keyed by TensorRT IO
    * tensor name (TRT10 has no binding indices). */
-  Tensor GetOrAllocateDeviceBuffer(const std::string& name, int entry_id) {
-    std::vector<int64_t> shape(data_entry_[entry_id]->shape,
-                               data_entry_[entry_id]->shape + data_entry_[entry_id]->ndim);
+  Tensor GetOrAllocateDeviceBuffer(const std::vector<const DLTensor*>& data_entry,
+                                   const std::string& name, int entry_id) {
+    std::vector<int64_t> shape(data_entry[entry_id]->shape,
+                               data_entry[entry_id]->shape + data_entry[entry_id]->ndim);
     if (device_buffers_.count(name)) {
       // Buffer is already initialized.
       if (shape[0] > device_buffers_[name]->shape[0]) {
         // Buffer is too small. Need to allocate bigger buffer.
         device_buffers_[name] =
-            runtime::Tensor::Empty(shape, data_entry_[entry_id]->dtype, {kDLCUDA, 0});
+            runtime::Tensor::Empty(shape, data_entry[entry_id]->dtype, {kDLCUDA, 0});
       } else if (shape[0] < device_buffers_[name]->shape[0]) {
         // Buffer is too large. Create view.
-        return device_buffers_[name].CreateView(shape, data_entry_[entry_id]->dtype);
+        return device_buffers_[name].CreateView(shape, data_entry[entry_id]->dtype);
       }
     } else {
       // Buffer not initialized yet.
       device_buffers_[name] =
-          runtime::Tensor::Empty(shape, data_entry_[entry_id]->dtype, {kDLCUDA, 0});
+          runtime::Tensor::Empty(shape, data_entry[entry_id]->dtype, {kDLCUDA, 0});
     }
     return device_buffers_.at(name);
   }
 
-  void CreateInt8Calibrator(const TensorRTEngineAndContext& engine_and_context) {
+  void CreateInt8Calibrator(const TensorRTEngineAndContext& engine_and_context, int batch_size) {
     // Get input names in binding order.
     std::vector<std::string> input_names;
     for (size_t i = 0; i < engine_and_context.inputs.size(); i++) {
       std::string ele = engine_and_context.inputs[i];
       input_names.push_back(ele);
     }
-    const int batch_size = GetBatchSize();
     calibrator_.reset(new TensorRTCalibrator(batch_size, input_names));
   }
 
+  /*! \brief The number of hex digits of the profile hash in the cached engine file names. */
+  static constexpr int kProfileHashLength = 16;
+
   /*! \brief Map of function name and max batch size to TRT engine if built already. */
   std::unordered_map<std::pair<std::string, int>, TensorRTEngineAndContext, PairHash>
       trt_engine_cache_;
 
+  /*!
+   * \brief The mutex guarding trt_engine_cache_. The calls running an engine hold it shared, and
+   * building or replacing an engine holds it exclusively.
+   */
+  std::shared_mutex engine_mu_;
+
+  /*! \brief The execution contexts not running, per engine and optimization profile. */
+  std::unordered_map<const nvinfer1::ICudaEngine*,
+                     std::unordered_map<int, std::vector<nvinfer1::IExecutionContext*>>>
+      idle_contexts_;
+
+  /*! \brief The mutex guarding idle_contexts_. */
+  std::mutex context_mu_;
+
   /*! \brief Calibrator for INT8 mode. */
   std::unique_ptr<TensorRTCalibrator> calibrator_;
 
@@ -545,15 +769,20 @@ class TensorRTRuntime : public JSONRuntimeBase {
   /*! \brief Number of calibration batches until we are done. */
   int num_calibration_batches_remaining_;
 
-  /*! \brief Highest batch size that an engine has been built for, used in single-engine mode only
-   * (multi_engine_mode=false). */
-  int max_batch_size_;
+  /*! \brief Whether to calibrate and build an INT8 engine. */
+  bool use_int8_;
+
+  /*! \brief The sorted upper bounds of the batch sizes served by the optimization profiles. */
+  std::vector<int64_t> profile_batch_sizes_;
+
+  /*! \brief The TensorRT tensor names and the entry ids of the inputs, in binding order. */
+  std::vector<std::pair<std::string, uint32_t>> input_entries_;
 
   /*! \brief The strategy to use for dynamic batching. With multi_engine_mode=true, a new TensorRT
    * engine is created for each unique batch size encountered. With multi_engine_mode=false, only
-   * one TensorRT engine is alive at any given time. It is replaced if a higher batch size is
-   * encountered. Multi-engine mode should give better performance, at a cost of higher memory usage
-   * and more time spent building engines. */
+   * one TensorRT engine is alive at any given time. It is replaced if a batch size out of the range
+   * of its optimization profiles is encountered. Multi-engine mode should give better performance,
+   * at a cost of higher memory usage and more time spent building engines. */
   bool multi_engine_mode_;
 
   /*! \brief Use auto-conversion to fp16 */
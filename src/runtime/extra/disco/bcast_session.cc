@@ -20,13 +20,24 @@
 
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/disco/disco_worker.h>
 #include <tvm/runtime/disco/session.h>
 
+#include <algorithm>
+#include <memory>
 #include <sstream>
+#include <utility>
 
 namespace tvm {
 namespace runtime {
 
+/*! \brief The kind of an argument in an encoded command graph */
+enum DiscoGraphArgKind : int64_t {
+  kDiscoGraphLiteral = 0,
+  kDiscoGraphRegister = 1,
+};
+
 struct BcastSessionObj::Internal {
   template <typename... Args>
   TVM_FFI_INLINE static void BroadcastUnpacked(BcastSessionObj* self, DiscoAction action,
@@ -92,6 +103,16 @@ DRef BcastSessionObj::CallWithPacked(const ffi::PackedArgs& args) {
   ffi::AnyView* args_vec = const_cast<ffi::AnyView*>(args.data());
   // tranlsate args into remote calling convention
   int reg_id = AllocateReg();
+  if (capturing_) {
+    CapturedCall call;
+    call.ret = BcastSessionObj::Internal::MakeDRef(reg_id, ffi::GetRef<Session>(this));
+    call.args.reserve(args.size() - 2);
+    for (int i = 2; i < args.size(); ++i) {
+      call.args.emplace_back(args[i]);
+    }
+    captured_calls_.push_back(std::move(call));
+    return captured_calls_.back().ret;
+  }
   {
     DRef func = args[2].cast<DRef>();
     args_vec[0] = static_cast<int>(DiscoAction::kCallPacked);
@@ -102,9 +123,62 @@ DRef BcastSessionObj::CallWithPacked(const ffi::PackedArgs& args) {
   return BcastSessionObj::Internal::MakeDRef(reg_id, ffi::GetRef<Session>(this));
 }
 
+void BcastSessionObj::BeginCapture() {
+  TVM_FFI_CHECK(!capturing_, ValueError) << "A command graph is already being captured";
+  capturing_ = true;
+}
+
+DRef BcastSessionObj::EndCapture(ffi::Array<DRef> inputs) {
+  TVM_FFI_CHECK(capturing_, ValueError) << "EndCapture is called without BeginCapture";
+  capturing_ = false;
+  std::vector<CapturedCall> calls = std::move(captured_calls_);
+  captured_calls_.clear();
+  // Encoding: the number of inputs and their registers, then for each call its return register,
+  // its number of arguments including the function, and a kind and a value per argument.
+  std::vector<ffi::Any> encoded;
+  std::vector<DRef> refs;
+  encoded.emplace_back(static_cast<int64_t>(inputs.size()));
+  for (const DRef& input : inputs) {
+    encoded.emplace_back(input->reg_id);
+    refs.push_back(input);
+  }
+  for (const CapturedCall& call : calls) {
+    encoded.emplace_back(call.ret->reg_id);
+    encoded.emplace_back(static_cast<int64_t>(call.args.size()));
+    for (const ffi::Any& arg : call.args) {
+      if (auto opt_dref = arg.as<DRef>()) {
+        encoded.emplace_back(static_cast<int64_t>(kDiscoGraphRegister));
+        encoded.emplace_back(opt_dref.value()->reg_id);
+        refs.push_back(opt_dref.value());
+      } else {
+        encoded.emplace_back(static_cast<int64_t>(kDiscoGraphLiteral));
+        encoded.emplace_back(arg);
+      }
+    }
+    refs.push_back(call.ret);
+  }
+  DRef builder = this->GetGlobalFunc("runtime.disco.build_command_graph");
+  std::vector<ffi::AnyView> packed_args(encoded.size() + 3);
+  packed_args[0] = static_cast<int>(DiscoAction::kCallPacked);
+  packed_args[1] = 0;
+  packed_args[2] = builder;
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    packed_args[i + 3] = encoded[i];
+  }
+  DRef graph = this->CallWithPacked(ffi::PackedArgs(packed_args.data(), packed_args.size()));
+  graph_refs_[graph->reg_id] = std::move(refs);
+  return graph;
+}
+
 void BcastSessionObj::DeallocReg(int reg_id) {
   BcastSessionObj::Internal::BroadcastUnpacked(this, DiscoAction::kKillReg, reg_id);
   this->free_regs_.push_back(reg_id);
+  auto it = graph_refs_.find(reg_id);
+  if (it != graph_refs_.end()) {
+    // Releasing the registers of a graph may free more registers, which re-enters this method.
+    std::vector<DRef> refs = std::move(it->second);
+    graph_refs_.erase(it);
+  }
 }
 
 int BcastSessionObj::AllocateReg() {
@@ -121,5 +195,97 @@ void BcastSessionObj::AppendHostTensor(const Tensor& host_array) {
   worker_zero_data_.host_arrays.push(host_array);
 }
 
+/*!
+ * \brief The worker side of a command graph captured by `BcastSessionObj::EndCapture`. The
+ *  registers of each call are looked up on every replay, so a replay sees the latest values.
+ */
+class DiscoCommandGraph {
+ public:
+  explicit DiscoCommandGraph(const ffi::PackedArgs& encoded) {
+    int pos = 0;
+    auto next = [&encoded, &pos]() {
+      TVM_FFI_ICHECK_LT(pos, encoded.size()) << "Truncated disco command graph";
+      return encoded[pos++];
+    };
+    int64_t num_inputs = next().cast<int64_t>();
+    for (int64_t i = 0; i < num_inputs; ++i) {
+      input_regs_.push_back(UseReg(next().cast<int64_t>()));
+    }
+    while (pos < encoded.size()) {
+      Call call;
+      call.ret_reg = UseReg(next().cast<int64_t>());
+      int64_t num_args = next().cast<int64_t>();
+      TVM_FFI_ICHECK_GE(num_args, 1);
+      TVM_FFI_ICHECK_EQ(next().cast<int64_t>(), kDiscoGraphRegister)
+          << "The function of a captured call must be a DRef";
+      call.func_reg = UseReg(next().cast<int64_t>());
+      for (int64_t i = 1; i < num_args; ++i) {
+        int64_t kind = next().cast<int64_t>();
+        if (kind == kDiscoGraphRegister) {
+          call.reg_args.emplace_back(static_cast<int>(call.args.size()),
+                                     UseReg(next().cast<int64_t>()));
+          call.args.emplace_back(nullptr);
+        } else {
+          call.args.emplace_back(next());
+        }
+      }
+      calls_.push_back(std::move(call));
+    }
+  }
+
+  void Replay(const ffi::PackedArgs& args) {
+    TVM_FFI_CHECK_EQ(args.size(), input_regs_.size(), ValueError)
+        << "The command graph expects " << input_regs_.size() << " arguments, but got "
+        << args.size();
+    std::vector<ffi::Any>& regs = DiscoWorker::ThreadLocal()->register_file;
+    if (static_cast<int64_t>(regs.size()) <= max_reg_) {
+      regs.resize(max_reg_ + 1);
+    }
+    for (int i = 0; i < args.size(); ++i) {
+      regs[input_regs_[i]] = args[i];
+    }
+    std::vector<ffi::AnyView> call_args;
+    for (const Call& call : calls_) {
+      call_args.assign(call.args.begin(), call.args.end());
+      for (const auto& [index, reg_id] : call.reg_args) {
+        call_args[index] = regs[reg_id];
+      }
+      ffi::Function func = regs[call.func_reg].cast<ffi::Function>();
+      ffi::Any rv;
+      func.CallPacked(ffi::PackedArgs(call_args.data(), call_args.size()), &rv);
+      regs[call.ret_reg] = std::move(rv);
+    }
+  }
+
+ private:
+  struct Call {
+    int64_t ret_reg;
+    int64_t func_reg;
+    /*! \brief The arguments, where those read from registers are placeholders */
+    std::vector<ffi::Any> args;
+    /*! \brief The positions in `args` read from registers, and the registers */
+    std::vector<std::pair<int, int64_t>> reg_args;
+  };
+
+  int64_t UseReg(int64_t reg_id) {
+    max_reg_ = std::max(max_reg_, reg_id);
+    return reg_id;
+  }
+
+  std::vector<int64_t> input_regs_;
+  std::vector<Call> calls_;
+  int64_t max_reg_ = 0;
+};
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def_packed(
+      "runtime.disco.build_command_graph", [](ffi::PackedArgs args, ffi::Any* rv) {
+        auto graph = std::make_shared<DiscoCommandGraph>(args);
+        *rv = ffi::Function::FromPacked(
+            [graph](ffi::PackedArgs replay_args, ffi::Any* ret) { graph->Replay(replay_args); });
+      });
+}
+
 }  // namespace runtime
 }  // namespace tvm
@@ -23,6 +23,7 @@
 #include <tvm/runtime/disco/session.h>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace tvm {
@@ -42,6 +43,8 @@ class BcastSessionObj : public SessionObj {
   void SyncWorker(int worker_id) override;
   void Shutdown() override;
   void InitCCL(ffi::String ccl, ffi::Shape device_ids) override;
+  void BeginCapture() override;
+  DRef EndCapture(ffi::Array<DRef> inputs) override;
   ffi::Any DebugGetFromRemote(int64_t reg_id, int worker_id) override = 0;
   void DebugSetRegister(int64_t reg_id, ffi::AnyView value, int worker_id) override = 0;
 
@@ -91,6 +94,23 @@ class BcastSessionObj : public SessionObj {
   /*! \brief The regsiter ids that have been deallocated */
   std::vector<int64_t> free_regs_;
 
+  /*! \brief A call recorded between `BeginCapture` and `EndCapture` */
+  struct CapturedCall {
+    /*! \brief The register the call writes its return value to */
+    DRef ret;
+    /*! \brief The function and the arguments of the call */
+    std::vector<ffi::Any> args;
+  };
+  /*! \brief Whether `CallWithPacked` is being captured */
+  bool capturing_ = false;
+  /*! \brief The calls captured so far */
+  std::vector<CapturedCall> captured_calls_;
+  /*!
+   * \brief The DRefs used by each command graph, keyed by the register of the graph. They keep
+   * the registers of a graph from being freed and reused while the graph is alive.
+   */
+  std::unordered_map<int64_t, std::vector<DRef>> graph_refs_;
+
   struct Internal;
   friend struct Internal;
   friend class SocketSessionObj;
@@ -92,6 +92,29 @@ void AllGather(Tensor send, bool in_group, Tensor recv) {
   GetCCLFunc("allgather")(send, in_group, recv);
 }
 
+void AllToAll(Tensor send, bool in_group, Tensor recv) {
+  GetCCLFunc("alltoall")(send, in_group, recv);
+}
+
+void ReduceScatter(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+  GetCCLFunc("reducescatter")(send, static_cast<int>(reduce_kind), in_group, recv);
+}
+
+void RingExchange(Tensor send, bool in_group, Tensor recv) {
+  GetCCLFunc("ring_exchange")(send, in_group, recv);
+}
+
+ffi::ObjectRef AllReduceStart(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+  return GetCCLFunc("allreduce_start")(send, static_cast<int>(reduce_kind), in_group, recv)
+      .cast<ffi::ObjectRef>();
+}
+
+ffi::ObjectRef AllGatherStart(Tensor send, bool in_group, Tensor recv) {
+  return GetCCLFunc("allgather_start")(send, in_group, recv).cast<ffi::ObjectRef>();
+}
+
+void CollectiveWait(ffi::ObjectRef handle) { GetCCLFunc("collective_wait")(handle); }
+
 TVM_RUNTIME_DLL void BroadcastFromWorker0(Tensor send, bool in_group, Tensor recv) {
   GetCCLFunc("broadcast_from_worker0")(send, in_group, recv);
 }
@@ -118,6 +141,12 @@ void RecvFromWorker(Tensor buffer, int sender_id) {
   GetCCLFunc("recv_from_worker")(buffer, sender_id);
 }
 
+void PipelineRun(ffi::Function stage_func, int64_t num_micro_batches, ffi::Optional<Tensor> inputs,
+                 ffi::Optional<Tensor> outputs, ffi::Shape act_shape, DLDataType act_dtype) {
+  GetCCLFunc("pipeline_run")(stage_func, num_micro_batches, inputs, outputs, act_shape,
+                             act_dtype);
+}
+
 int WorkerId() { return DiscoWorker::ThreadLocal()->worker_id; }
 
 void SyncWorker() {
@@ -151,6 +180,22 @@ TVM_FFI_STATIC_INIT_BLOCK() {
              AllReduce(send, static_cast<ReduceKind>(kind), in_group, recv);
            })
       .def("runtime.disco.allgather", AllGather)
+      .def("runtime.disco.alltoall", AllToAll)
+      .def("runtime.disco.ring_exchange", RingExchange)
+      .def("runtime.disco.reducescatter",
+           [](Tensor send, ffi::Shape reduce_kind, bool in_group, Tensor recv) {
+             int kind = IntegerFromShape(reduce_kind);
+             TVM_FFI_CHECK(0 <= kind && kind <= 4, ValueError) << "Unknown ReduceKind: " << kind;
+             ReduceScatter(send, static_cast<ReduceKind>(kind), in_group, recv);
+           })
+      .def("runtime.disco.allreduce_start",
+           [](Tensor send, ffi::Shape reduce_kind, bool in_group, Tensor recv) {
+             int kind = IntegerFromShape(reduce_kind);
+             TVM_FFI_CHECK(0 <= kind && kind <= 4, ValueError) << "Unknown ReduceKind: " << kind;
+             return AllReduceStart(send, static_cast<ReduceKind>(kind), in_group, recv);
+           })
+      .def("runtime.disco.allgather_start", AllGatherStart)
+      .def("runtime.disco.collective_wait", CollectiveWait)
       .def("runtime.disco.broadcast_from_worker0", BroadcastFromWorker0)
       .def("runtime.disco.scatter_from_worker0", ScatterFromWorker0)
       .def("runtime.disco.gather_to_worker0", GatherToWorker0)
@@ -159,6 +204,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def("runtime.disco.recv_from_prev_group", RecvFromPrevGroup)
       .def("runtime.disco.send_to_worker", SendToWorker)
       .def("runtime.disco.recv_from_worker", RecvFromWorker)
+      .def("runtime.disco.pipeline_run", PipelineRun)
       .def("runtime.disco.worker_id", []() -> ffi::Shape { return ffi::Shape({WorkerId()}); })
       .def("runtime.disco.worker_rank", []() -> int64_t { return WorkerId(); })
       .def("runtime.disco.world_size",
@@ -85,6 +85,8 @@ class CUDAIPCMemoryAllocator final : public memory::PooledAllocator {
     return it->second;
   }
 
+  bool IsIPCMemory(void* ptr) const { return ipc_memory_map_.count(ptr) != 0; }
+
   /*! \brief Return the global CUDAIPCMemory singleton allocator. */
   static CUDAIPCMemoryAllocator* Global() {
     static CUDAIPCMemoryAllocator* allocator = new CUDAIPCMemoryAllocator();
@@ -236,6 +238,10 @@ CUDAIPCMemory CUDAIPCMemory::GetIPCMemoryFromDevicePtr(void* ptr) {
   return CUDAIPCMemoryAllocator::Global()->GetIPCMemoryFromDevicePtr(ptr);
 }
 
+bool CUDAIPCMemory::IsIPCMemory(void* ptr) {
+  return CUDAIPCMemoryAllocator::Global()->IsIPCMemory(ptr);
+}
+
 }  // namespace cuda_ipc
 }  // namespace runtime
 }  // namespace tvm
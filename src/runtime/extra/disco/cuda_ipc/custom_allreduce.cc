@@ -22,6 +22,11 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/disco/cuda_ipc_memory.h>
 #include <tvm/runtime/memory/memory_manager.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <functional>
+#include <string>
 
 #include "../../../../../3rdparty/tensorrt_llm/custom_allreduce_kernels.h"
 #include "../nccl/nccl_context.h"
@@ -113,9 +118,176 @@ void CustomAllReduce(DLTensor* send, int strategy, DLTensor* recv) {
                                 ctx->GetDefaultStream());
 }
 
+/*! \brief The all-reduce algorithms that `DispatchAllReduce` chooses from. */
+enum class AllReduceAlgo : int {
+  kNCCL = 0,
+  kIPCOneShot = 1,
+  kIPCTwoShot = 2,
+  kHierarchical = 3,
+};
+
+inline const char* AllReduceAlgoName(AllReduceAlgo algo) {
+  switch (algo) {
+    case AllReduceAlgo::kNCCL:
+      return "nccl";
+    case AllReduceAlgo::kIPCOneShot:
+      return "ipc_oneshot";
+    case AllReduceAlgo::kIPCTwoShot:
+      return "ipc_twoshot";
+    case AllReduceAlgo::kHierarchical:
+      return "hierarchical";
+  }
+  return "unknown";
+}
+
+/*!
+ * \brief Over PCIe the IPC kernels only beat NCCL for small messages, where the latency of
+ *  NCCL dominates.
+ */
+constexpr size_t kPCIeIPCMaxBytes = 64 << 10;
+
+/*!
+ * \brief Detect the node layout and the links between the local devices on first use. It splits
+ *  the global communicator, so every worker must reach it in the same order, which holds as the
+ *  workers run the same program.
+ */
+void InitTopology(nccl::CCLThreadLocalContext* ctx) {
+  if (ctx->workers_per_node != 0) {
+    return;
+  }
+  char hostname[256] = {0};
+  gethostname(hostname, sizeof(hostname) - 1);
+  int color = static_cast<int>(std::hash<std::string>()(hostname) & 0x7fffffff);
+  NCCL_CALL(ncclCommSplit(ctx->global_comm, color, ctx->worker->worker_id, &ctx->intra_node_comm,
+                          nullptr));
+  NCCL_CALL(ncclCommUserRank(ctx->intra_node_comm, &ctx->local_rank));
+  NCCL_CALL(ncclCommCount(ctx->intra_node_comm, &ctx->workers_per_node));
+  if (ctx->workers_per_node < ctx->worker->num_workers) {
+    NCCL_CALL(ncclCommSplit(ctx->global_comm, ctx->local_rank, ctx->worker->worker_id,
+                            &ctx->inter_node_comm, nullptr));
+  }
+  // Peers linked by NVLink support native atomics with each other, while PCIe peers do not.
+  int num_devices = 0;
+  TVM_FFI_CHECK_CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+  ctx->nvlink = true;
+  for (int device_id = 0; device_id < num_devices; ++device_id) {
+    if (device_id == ctx->device_id) continue;
+    int native_atomic = 0;
+    TVM_FFI_CHECK_CUDA_ERROR(cudaDeviceGetP2PAttribute(
+        &native_atomic, cudaDevP2PAttrNativeAtomicSupported, ctx->device_id, device_id));
+    ctx->nvlink = ctx->nvlink && native_atomic != 0;
+  }
+}
+
+AllReduceAlgo SelectAllReduceAlgo(nccl::CCLThreadLocalContext* ctx, const DLTensor* send,
+                                  ReduceKind reduce_kind, bool in_group, int64_t num_elements) {
+  int num_workers = ctx->worker->num_workers;
+  int workers_per_node = ctx->workers_per_node;
+  size_t nbytes = num_elements * ((send->dtype.bits * send->dtype.lanes + 7) / 8);
+  if (in_group && ctx->worker->num_groups > 1) {
+    // The groups have their own communicator, and are not split by node.
+    return AllReduceAlgo::kNCCL;
+  }
+  if (workers_per_node == num_workers) {
+    if (reduce_kind != ReduceKind::kSum || ctx->worker->num_groups != 1 ||
+        !CUDAIPCMemory::IsIPCMemory(send->data) ||
+        !CanApplyCustomAllReduce(num_elements, send->dtype) ||
+        (!ctx->nvlink && nbytes > kPCIeIPCMaxBytes)) {
+      return AllReduceAlgo::kNCCL;
+    }
+    tensorrt_llm::AllReduceStrategyType strategy =
+        tensorrt_llm::SelectImplementation(nbytes, num_workers);
+    if (strategy == tensorrt_llm::AllReduceStrategyType::RING) {
+      return AllReduceAlgo::kNCCL;
+    }
+    if (strategy == tensorrt_llm::AllReduceStrategyType::TWOSHOT &&
+        CanApplyTwoShotAllReduce(num_elements, send->dtype, num_workers)) {
+      return AllReduceAlgo::kIPCTwoShot;
+    }
+    return AllReduceAlgo::kIPCOneShot;
+  }
+  if (workers_per_node > 1 && num_elements % workers_per_node == 0) {
+    return AllReduceAlgo::kHierarchical;
+  }
+  return AllReduceAlgo::kNCCL;
+}
+
+/*!
+ * \brief Reduce-scatter within the node, allreduce each shard across the nodes, then allgather
+ *  within the node, so that only 1 / workers_per_node of the data crosses the nodes.
+ */
+void HierarchicalAllReduce(nccl::CCLThreadLocalContext* ctx, DLTensor* send,
+                           ReduceKind reduce_kind, DLTensor* recv, int64_t num_elements) {
+  deviceStream_t stream = ctx->GetDefaultStream();
+  ncclDataType_t dtype = nccl::AsNCCLDataType(send->dtype);
+  ncclRedOp_t op = nccl::AsNCCLRedOp(reduce_kind);
+  int64_t shard_elements = num_elements / ctx->workers_per_node;
+  size_t shard_bytes = shard_elements * ((send->dtype.bits * send->dtype.lanes + 7) / 8);
+  void* shard = static_cast<char*>(recv->data) + ctx->local_rank * shard_bytes;
+  NCCL_CALL(ncclReduceScatter(send->data, shard, shard_elements, dtype, op, ctx->intra_node_comm,
+                              stream));
+  NCCL_CALL(ncclAllReduce(shard, shard, shard_elements, dtype, op, ctx->inter_node_comm, stream));
+  NCCL_CALL(ncclAllGather(shard, recv->data, shard_elements, dtype, ctx->intra_node_comm, stream));
+}
+
+/*!
+ * \brief All-reduce that chooses the algorithm per call from the message size, the world size,
+ *  and the node layout and links. Set TVM_DISCO_LOG_ALLREDUCE=1 to log the choice of each call.
+ * \param send The input tensor of all-reduce.
+ * \param reduce_kind The kind of reduction.
+ * \param in_group Whether the all-reduce performs within the group.
+ * \param recv The output tensor of all-reduce.
+ */
+void DispatchAllReduce(DLTensor* send, ReduceKind reduce_kind, bool in_group, DLTensor* recv) {
+  static const bool log_choice = [] {
+    const char* env = std::getenv("TVM_DISCO_LOG_ALLREDUCE");
+    return env != nullptr && std::string(env) == "1";
+  }();
+  if (send->dtype == DLDataType{kDLFloat8_e4m3fn, 8, 1} ||
+      send->dtype == DLDataType{kDLFloat8_e5m2, 8, 1}) {
+    TVM_FFI_THROW(InternalError)
+        << "Float8 data type cannot be allreduced, as nccl does not support this data type.";
+  }
+  nccl::CCLThreadLocalContext* ctx = nccl::CCLThreadLocalContext::Get();
+  InitTopology(ctx);
+  int64_t num_elements = TensorSize(send);
+  AllReduceAlgo algo = SelectAllReduceAlgo(ctx, send, reduce_kind, in_group, num_elements);
+  if (log_choice) {
+    LOG(INFO) << "Worker " << ctx->worker->worker_id << " allreduces " << num_elements
+              << " elements of " << ffi::DLDataTypeToString(send->dtype) << " with "
+              << AllReduceAlgoName(algo) << " (" << ctx->workers_per_node << " workers per node, "
+              << (ctx->nvlink ? "nvlink" : "pcie") << ")";
+  }
+  switch (algo) {
+    case AllReduceAlgo::kIPCOneShot:
+      CustomAllReduce(send, static_cast<int>(tensorrt_llm::AllReduceStrategyType::ONESHOT), recv);
+      return;
+    case AllReduceAlgo::kIPCTwoShot:
+      CustomAllReduce(send, static_cast<int>(tensorrt_llm::AllReduceStrategyType::TWOSHOT), recv);
+      return;
+    case AllReduceAlgo::kHierarchical:
+      HierarchicalAllReduce(ctx, send, reduce_kind, recv, num_elements);
+      return;
+    case AllReduceAlgo::kNCCL:
+      NCCL_CALL(ncclAllReduce(send->data, recv->data, num_elements,
+                              /*datatype=*/nccl::AsNCCLDataType(send->dtype),
+                              /*op=*/nccl::AsNCCLRedOp(reduce_kind),
+                              in_group ? ctx->group_comm : ctx->global_comm,
+                              ctx->GetDefaultStream()));
+      return;
+  }
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
-  refl::GlobalDef().def("runtime.disco.cuda_ipc.custom_allreduce", CustomAllReduce);
+  refl::GlobalDef()
+      .def("runtime.disco.cuda_ipc.custom_allreduce", CustomAllReduce)
+      .def("runtime.disco.cuda_ipc.dispatch_allreduce",
+           [](DLTensor* send, int reduce_kind, bool in_group, DLTensor* recv) {
+             TVM_FFI_CHECK(0 <= reduce_kind && reduce_kind <= 4, ValueError)
+                 << "Unknown ReduceKind: " << reduce_kind;
+             DispatchAllReduce(send, static_cast<ReduceKind>(reduce_kind), in_group, recv);
+           });
 }
 
 }  // namespace cuda_ipc
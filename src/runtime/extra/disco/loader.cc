@@ -25,9 +25,11 @@
 #include <tvm/runtime/vm/tensor_cache_support.h>
 
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../../file_utils.h"
@@ -145,8 +147,27 @@ class ShardLoaderObj : public ffi::Object {
   mutable const FileRecord* current_file_;
   /*! \brief The context of the current file to be loaded from */
   mutable std::string current_file_stream_;
+  /*! \brief Reads the files ahead during LoadAll and LoadAllPresharded */
+  mutable std::unique_ptr<vm::ShardPrefetcher> prefetcher_;
+  /*! \brief The files to be taken from the prefetcher, in order */
+  mutable std::vector<const FileRecord*> prefetch_files_;
+  /*! \brief The index of the next file to be taken from the prefetcher */
+  mutable size_t prefetch_cursor_ = 0;
+
+  /*! \brief The number of threads reading the files ahead */
+  static constexpr int kNumReadThreads = 4;
+  /*! \brief The maximum bytes of the files read ahead but not loaded yet */
+  static constexpr int64_t kMaxInflightBytes = int64_t(2) << 30;
 
  private:
+  /*!
+   * \brief Start reading ahead the files of the given parameters, in the order of loading.
+   * \param weight_indices The parameters to be loaded by LoadDirect, in order.
+   */
+  void StartPrefetch(const std::vector<int>& weight_indices) const;
+  /*! \brief Make the given file the current file, taking it from the prefetcher if read ahead */
+  void OpenFile(const FileRecord* file) const;
+
   /*! \brief Load the i-th parameter without post-processing
    *
    * This function should not be called externally, as it does not
@@ -234,11 +255,7 @@ Tensor ShardLoaderObj::LoadParamOnWorker0(int weight_index) const {
   const FileRecord* file = param_info.file;
 
   auto load = [this, param, device, file]() {
-    if (file != current_file_) {
-      current_file_ = file;
-      std::string file_name = GetSiblingPath(this->metadata_.path, file->data_path);
-      LoadBinaryFromFile(file_name, &this->current_file_stream_);
-    }
+    OpenFile(file);
     return param->Load(device, &this->current_file_stream_);
   };
 
@@ -281,12 +298,44 @@ Tensor ShardLoaderObj::LoadDirect(int weight_index) const {
   DiscoWorker* worker = DiscoWorker::ThreadLocal();
   Device device = worker->default_device;
 
-  if (file != current_file_) {
-    current_file_ = file;
+  OpenFile(file);
+  return param->Load(device, &this->current_file_stream_);
+}
+
+void ShardLoaderObj::StartPrefetch(const std::vector<int>& weight_indices) const {
+  prefetcher_.reset();
+  prefetch_files_.clear();
+  prefetch_cursor_ = 0;
+  std::vector<std::pair<std::string, int64_t>> files;
+  const FileRecord* last = current_file_;
+  for (int weight_index : weight_indices) {
+    const FileRecord* file = param_info_.at(weight_index).file;
+    // a file is read again only when it is left and re-entered
+    if (file != last) {
+      prefetch_files_.push_back(file);
+      files.emplace_back(GetSiblingPath(this->metadata_.path, file->data_path), file->nbytes);
+      last = file;
+    }
+  }
+  if (!files.empty()) {
+    prefetcher_ =
+        std::make_unique<vm::ShardPrefetcher>(std::move(files), kNumReadThreads, kMaxInflightBytes);
+  }
+}
+
+void ShardLoaderObj::OpenFile(const FileRecord* file) const {
+  if (file == current_file_) return;
+  current_file_ = file;
+  if (prefetcher_ != nullptr && prefetch_cursor_ < prefetch_files_.size() &&
+      prefetch_files_[prefetch_cursor_] == file) {
+    this->current_file_stream_ = prefetcher_->Take(prefetch_cursor_++);
+    if (prefetch_cursor_ == prefetch_files_.size()) {
+      prefetcher_.reset();
+    }
+  } else {
     std::string file_name = GetSiblingPath(this->metadata_.path, file->data_path);
     LoadBinaryFromFile(file_name, &this->current_file_stream_);
   }
-  return param->Load(device, &this->current_file_stream_);
 }
 
 Tensor ShardLoaderObj::Load(int weight_index) const {
@@ -331,14 +380,28 @@ Tensor ShardLoaderObj::Load(int weight_index) const {
 
 ffi::Array<Tensor> ShardLoaderObj::LoadAll() const {
   int n = static_cast<int>(param_info_.size());
-  ffi::Array<Tensor> shards;
-  shards.reserve(n);
+  // A cache dumped by `tvmjs.dump_presharded_tensor_cache` holds only the shards of each worker,
+  // which the workers read on their own without a scatter.
+  if (n > 0 && !this->param_name_to_index_.count("param_0")) {
+    return LoadAllPresharded();
+  }
+  std::vector<int> shard_ids;
+  shard_ids.reserve(n);
   for (int i = 0; i < n; ++i) {
     std::string param_name = "param_" + std::to_string(i);
     TVM_FFI_ICHECK(this->param_name_to_index_.count(param_name));
-    int shard_id = this->param_name_to_index_.at(param_name);
+    shard_ids.push_back(this->param_name_to_index_.at(param_name));
+  }
+  // only worker 0 reads the files
+  if (DiscoWorker::ThreadLocal()->worker_id == 0) {
+    StartPrefetch(shard_ids);
+  }
+  ffi::Array<Tensor> shards;
+  shards.reserve(n);
+  for (int shard_id : shard_ids) {
     shards.push_back(this->Load(shard_id));
   }
+  prefetcher_.reset();
   return shards;
 }
 
@@ -374,8 +437,8 @@ ffi::Array<Tensor> ShardLoaderObj::LoadAllPresharded() const {
   size_t num_workers = static_cast<size_t>(worker->num_workers);
   size_t num_params = param_info_.size() / num_workers;
 
-  ffi::Array<Tensor> params;
-  params.reserve(num_params);
+  std::vector<int> param_ids;
+  param_ids.reserve(num_params);
   for (size_t i_param = 0; i_param < num_params; ++i_param) {
     std::string param_name = static_cast<const std::stringstream&>(
                                  std::stringstream() << "param_" << i_param << "_shard-"
@@ -385,9 +448,15 @@ ffi::Array<Tensor> ShardLoaderObj::LoadAllPresharded() const {
     auto it = param_name_to_index_.find(param_name);
     TVM_FFI_ICHECK(it != param_name_to_index_.end())
         << "Parameter " << param_name << " was not found in the parameter set";
-    int param_id = this->param_name_to_index_.at(param_name);
+    param_ids.push_back(this->param_name_to_index_.at(param_name));
+  }
+  StartPrefetch(param_ids);
+  ffi::Array<Tensor> params;
+  params.reserve(num_params);
+  for (int param_id : param_ids) {
     params.push_back(this->LoadDirect(param_id));
   }
+  prefetcher_.reset();
   return params;
 }
 
@@ -61,6 +61,9 @@ class DiscoStreamMessageQueue : private support::Stream,
 
  protected:
   void CommitSendAndNotifyEnqueue() {
+    const DiscoQueueMetrics& metrics = DiscoQueueMetrics::Global();
+    metrics.messages_sent->Increment();
+    metrics.bytes_sent->Increment(write_buffer_.size());
     stream_->Write(write_buffer_.data(), write_buffer_.size());
     write_buffer_.clear();
   }
@@ -38,23 +38,6 @@ CCLThreadLocalContext* CCLThreadLocalContext::Get() {
   return &ctx;
 }
 
-inline ncclRedOp_t AsNCCLRedOp(ReduceKind kind) {
-  switch (kind) {
-    case ReduceKind::kSum:
-      return ncclSum;
-    case ReduceKind::kProd:
-      return ncclProd;
-    case ReduceKind::kMin:
-      return ncclMin;
-    case ReduceKind::kMax:
-      return ncclMax;
-    case ReduceKind::kAvg:
-      return ncclAvg;
-  }
-  TVM_FFI_THROW(ValueError) << "Unknown ReduceKind: " << static_cast<int>(kind);
-  throw;
-}
-
 void InitCCL(Session sess, ffi::Shape device_ids) {
   DRef func = sess->GetGlobalFunc("runtime.disco." TVM_DISCO_CCL_NAME ".init_ccl_per_worker");
   DLOG(INFO) << "Initializing " TVM_DISCO_CCL_NAME " with devices: " << device_ids;
@@ -117,11 +100,49 @@ void InitCCLPerWorker(ffi::Shape device_ids, std::string unique_id_bytes) {
   }
 }
 
-void AllReduce(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+/*!
+ * \brief The handle of an asynchronous collective, an event recorded on the communication stream
+ *  right after the collective.
+ */
+class CollectiveEventObj : public ffi::Object {
+ public:
+  deviceEvent_t event = nullptr;
+
+  ~CollectiveEventObj() {
+    if (event != nullptr) {
+      EventDestroy(event);
+    }
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("runtime.disco." TVM_DISCO_CCL_NAME ".CollectiveEvent",
+                                    CollectiveEventObj, ffi::Object);
+};
+
+/*! \brief Order the communication stream after the work queued so far on the compute stream. */
+deviceStream_t BeginAsyncCollective(CCLThreadLocalContext* ctx) {
+  deviceStream_t comm_stream = ctx->GetCommStream();
+  deviceEvent_t ready;
+  EventCreate(&ready);
+  EventRecord(ready, ctx->GetDefaultStream());
+  StreamWaitEvent(comm_stream, ready);
+  // The wait has captured the event, which can be released without waiting for it.
+  EventDestroy(ready);
+  return comm_stream;
+}
+
+/*! \brief Record the handle of the collective just queued on the communication stream. */
+ffi::ObjectRef EndAsyncCollective(deviceStream_t comm_stream) {
+  ffi::ObjectPtr<CollectiveEventObj> n = ffi::make_object<CollectiveEventObj>();
+  EventCreate(&n->event);
+  EventRecord(n->event, comm_stream);
+  return ffi::ObjectRef(n);
+}
+
+void AllReduceOnStream(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv,
+                       deviceStream_t stream) {
   CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
   ffi::Shape shape = send.Shape();
   int64_t numel = shape->Product();
-  deviceStream_t stream = ctx->GetDefaultStream();
   DLDataType dtype = send->dtype;
   if (dtype == DLDataType{kDLFloat8_e4m3fn, 8, 1} || dtype == DLDataType{kDLFloat8_e5m2, 8, 1}) {
     TVM_FFI_THROW(InternalError)
@@ -133,16 +154,118 @@ void AllReduce(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv)
                           in_group ? ctx->group_comm : ctx->global_comm, stream));
 }
 
-void AllGather(Tensor send, bool in_group, Tensor recv) {
+void AllGatherOnStream(Tensor send, bool in_group, Tensor recv, deviceStream_t stream) {
   CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
   ffi::Shape shape = send.Shape();
   int64_t numel = shape->Product();
-  deviceStream_t stream = ctx->GetDefaultStream();
   NCCL_CALL(ncclAllGather(send->data, recv->data, numel,
                           /*datatype=*/AsNCCLDataType(send->dtype),
                           in_group ? ctx->group_comm : ctx->global_comm, stream));
 }
 
+void AllReduce(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+  AllReduceOnStream(send, reduce_kind, in_group, recv,
+                    CCLThreadLocalContext::Get()->GetDefaultStream());
+}
+
+void AllGather(Tensor send, bool in_group, Tensor recv) {
+  AllGatherOnStream(send, in_group, recv, CCLThreadLocalContext::Get()->GetDefaultStream());
+}
+
+void AllToAll(Tensor send, bool in_group, Tensor recv) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  int num_workers = ctx->worker->num_workers;
+  int num_peers = in_group ? num_workers / ctx->worker->num_groups : num_workers;
+  int64_t numel = send.Shape().Product();
+  TVM_FFI_CHECK_EQ(numel % num_peers, 0, ValueError)
+      << "AllToAll requires the number of elements in the buffer to be divisible by the number "
+         "of workers, but got numel = "
+      << numel << " and " << num_peers << " workers.";
+  TVM_FFI_CHECK_EQ(numel, recv.Shape().Product(), ValueError)
+      << "The number of elements in buffer `recv` must be the same as buffer `send`. "
+         "`send.size` is "
+      << numel << ", but `recv.size` is " << recv.Shape().Product() << ".";
+  DLDataType dtype = send->dtype;
+  int64_t numel_per_shard = numel / num_peers;
+  int64_t bytes_per_shard = numel_per_shard * ((dtype.bits * dtype.lanes + 7) / 8);
+  deviceStream_t stream = ctx->GetDefaultStream();
+  ncclComm_t comm = in_group ? ctx->group_comm : ctx->global_comm;
+  const uint8_t* send_data = static_cast<const uint8_t*>(send->data);
+  uint8_t* recv_data = static_cast<uint8_t*>(recv->data);
+  NCCL_CALL(ncclGroupStart());
+  for (int i = 0; i < num_peers; ++i) {
+    NCCL_CALL(ncclSend(send_data + i * bytes_per_shard, numel_per_shard, AsNCCLDataType(dtype), i,
+                       comm, stream));
+    NCCL_CALL(ncclRecv(recv_data + i * bytes_per_shard, numel_per_shard, AsNCCLDataType(dtype), i,
+                       comm, stream));
+  }
+  NCCL_CALL(ncclGroupEnd());
+}
+
+void RingExchange(Tensor send, bool in_group, Tensor recv) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  int num_workers = ctx->worker->num_workers;
+  int num_peers = in_group ? num_workers / ctx->worker->num_groups : num_workers;
+  int rank = in_group ? ctx->worker->worker_id % num_peers : ctx->worker->worker_id;
+  int64_t numel = send.Shape().Product();
+  TVM_FFI_CHECK_EQ(numel, recv.Shape().Product(), ValueError)
+      << "The number of elements in buffer `recv` must be the same as buffer `send`. "
+         "`send.size` is "
+      << numel << ", but `recv.size` is " << recv.Shape().Product() << ".";
+  deviceStream_t stream = ctx->GetDefaultStream();
+  ncclComm_t comm = in_group ? ctx->group_comm : ctx->global_comm;
+  // Grouped, so that no worker blocks on its send before the next worker posts its receive.
+  NCCL_CALL(ncclGroupStart());
+  NCCL_CALL(ncclSend(send->data, numel, AsNCCLDataType(send->dtype), (rank + 1) % num_peers,
+                     comm, stream));
+  NCCL_CALL(ncclRecv(recv->data, numel, AsNCCLDataType(recv->dtype),
+                     (rank + num_peers - 1) % num_peers, comm, stream));
+  NCCL_CALL(ncclGroupEnd());
+}
+
+void ReduceScatter(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  int num_workers = ctx->worker->num_workers;
+  int num_peers = in_group ? num_workers / ctx->worker->num_groups : num_workers;
+  int64_t numel = send.Shape().Product();
+  int64_t recv_numel = recv.Shape().Product();
+  TVM_FFI_CHECK_EQ(numel, recv_numel * num_peers, ValueError)
+      << "ReduceScatter requires the number of elements in buffer `send` to be the number of "
+         "workers times that of buffer `recv`, but got `send.size` = "
+      << numel << ", `recv.size` = " << recv_numel << " and " << num_peers << " workers.";
+  DLDataType dtype = send->dtype;
+  if (dtype == DLDataType{kDLFloat8_e4m3fn, 8, 1} || dtype == DLDataType{kDLFloat8_e5m2, 8, 1}) {
+    TVM_FFI_THROW(InternalError)
+        << "Float8 data type cannot be reducescattered, as nccl does not support this data type.";
+  }
+  NCCL_CALL(ncclReduceScatter(send->data, recv->data, recv_numel,
+                              /*datatype=*/AsNCCLDataType(dtype),
+                              /*op=*/AsNCCLRedOp(reduce_kind),
+                              in_group ? ctx->group_comm : ctx->global_comm,
+                              ctx->GetDefaultStream()));
+}
+
+ffi::ObjectRef AllReduceStart(Tensor send, ReduceKind reduce_kind, bool in_group, Tensor recv) {
+  deviceStream_t comm_stream = BeginAsyncCollective(CCLThreadLocalContext::Get());
+  AllReduceOnStream(send, reduce_kind, in_group, recv, comm_stream);
+  return EndAsyncCollective(comm_stream);
+}
+
+ffi::ObjectRef AllGatherStart(Tensor send, bool in_group, Tensor recv) {
+  deviceStream_t comm_stream = BeginAsyncCollective(CCLThreadLocalContext::Get());
+  AllGatherOnStream(send, in_group, recv, comm_stream);
+  return EndAsyncCollective(comm_stream);
+}
+
+void CollectiveWait(ffi::ObjectRef handle) {
+  const auto* event = handle.as<CollectiveEventObj>();
+  TVM_FFI_CHECK(event != nullptr, TypeError)
+      << "Expect the handle of an asynchronous " TVM_DISCO_CCL_NAME " collective, but got "
+      << handle->GetTypeKey();
+  // Only the compute stream waits, so the host returns immediately.
+  StreamWaitEvent(CCLThreadLocalContext::Get()->GetDefaultStream(), event->event);
+}
+
 void BroadcastFromWorker0(ffi::Optional<Tensor> send, bool in_group, Tensor recv) {
   CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
   int worker_id = ctx->worker->worker_id;
@@ -326,15 +449,164 @@ void RecvFromWorker(Tensor buffer, int sender_id) {
                      sender_id, ctx->global_comm, stream));
 }
 
+void KVTransferSend(Tensor k_data, Tensor v_data, int receiver_id, TVMStreamHandle stream) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  TVM_FFI_ICHECK(receiver_id >= 0 && receiver_id < ctx->worker->num_workers)
+      << "Invalid receiver id " << receiver_id << ". The world size is "
+      << ctx->worker->num_workers;
+  TVM_FFI_ICHECK_NE(ctx->worker->worker_id, receiver_id) << "Cannot send to worker itself.";
+  deviceStream_t transfer_stream = static_cast<deviceStream_t>(stream);
+  NCCL_CALL(ncclGroupStart());
+  NCCL_CALL(ncclSend(static_cast<char*>(k_data->data) + k_data->byte_offset,
+                     k_data.Shape().Product(), AsNCCLDataType(k_data.DataType()),
+                     receiver_id, ctx->global_comm, transfer_stream));
+  NCCL_CALL(ncclSend(static_cast<char*>(v_data->data) + v_data->byte_offset,
+                     v_data.Shape().Product(), AsNCCLDataType(v_data.DataType()),
+                     receiver_id, ctx->global_comm, transfer_stream));
+  NCCL_CALL(ncclGroupEnd());
+}
+
+void KVTransferRecv(Tensor k_data, Tensor v_data, int sender_id, TVMStreamHandle stream) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  TVM_FFI_ICHECK(sender_id >= 0 && sender_id < ctx->worker->num_workers)
+      << "Invalid sender id " << sender_id << ". The world size is " << ctx->worker->num_workers;
+  TVM_FFI_ICHECK_NE(ctx->worker->worker_id, sender_id)
+      << "Cannot receive from the worker itself.";
+  deviceStream_t transfer_stream = static_cast<deviceStream_t>(stream);
+  NCCL_CALL(ncclGroupStart());
+  NCCL_CALL(ncclRecv(static_cast<char*>(k_data->data) + k_data->byte_offset,
+                     k_data.Shape().Product(), AsNCCLDataType(k_data.DataType()),
+                     sender_id, ctx->global_comm, transfer_stream));
+  NCCL_CALL(ncclRecv(static_cast<char*>(v_data->data) + v_data->byte_offset,
+                     v_data.Shape().Product(), AsNCCLDataType(v_data.DataType()),
+                     sender_id, ctx->global_comm, transfer_stream));
+  NCCL_CALL(ncclGroupEnd());
+}
+
+/*! \brief The view of the micro-batch `index` of a tensor batched along its first dimension. */
+Tensor MicroBatchView(const Tensor& batched, int64_t index) {
+  ffi::Shape shape = batched.Shape();
+  TVM_FFI_CHECK_GE(shape.size(), 1, ValueError) << "The micro-batches must be stacked on axis 0";
+  ffi::Shape micro_batch_shape(shape.begin() + 1, shape.end());
+  DLDataType dtype = batched->dtype;
+  uint64_t micro_batch_bytes =
+      micro_batch_shape->Product() * ((dtype.bits * dtype.lanes + 7) / 8);
+  return batched.CreateView(micro_batch_shape, dtype, index * micro_batch_bytes);
+}
+
+Tensor PipelineStageInput(const ffi::Optional<Tensor>& inputs, int64_t micro_batch) {
+  TVM_FFI_CHECK(inputs.has_value(), ValueError)
+      << "The first pipeline stage requires the stacked micro-batch inputs";
+  return MicroBatchView(inputs.value(), micro_batch);
+}
+
+/*!
+ * \brief Run `num_micro_batches` micro-batches through the pipeline formed by the worker groups,
+ *  group `g` being stage `g`. Each worker runs the whole schedule locally, so the controller sends
+ *  a single command. The activations go to the same worker of the next group, through sends and
+ *  receives on the communication stream, which overlap with the stage computing on the compute
+ *  stream: the receive of micro-batch `i + 1` is in flight while micro-batch `i` is computed.
+ * \param stage_func The stage of this worker, called as `stage_func(input, micro_batch)`.
+ * \param num_micro_batches The number of micro-batches.
+ * \param inputs The micro-batches stacked on axis 0, only used by the first stage.
+ * \param outputs The outputs stacked on axis 0, only written by the last stage.
+ * \param act_shape The shape of the activation of a micro-batch between two stages.
+ * \param act_dtype The dtype of the activation between two stages.
+ */
+void PipelineRun(ffi::Function stage_func, int64_t num_micro_batches, ffi::Optional<Tensor> inputs,
+                 ffi::Optional<Tensor> outputs, ffi::Shape act_shape, DLDataType act_dtype) {
+  CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
+  DiscoWorker* worker = ctx->worker;
+  int group_size = worker->num_workers / worker->num_groups;
+  int stage = worker->worker_id / group_size;
+  bool is_first = stage == 0;
+  bool is_last = stage == worker->num_groups - 1;
+  deviceStream_t compute_stream = ctx->GetDefaultStream();
+  deviceStream_t comm_stream = ctx->GetCommStream();
+  ncclDataType_t nccl_dtype = AsNCCLDataType(act_dtype);
+  int64_t act_numel = act_shape->Product();
+  if (is_last) {
+    TVM_FFI_CHECK(outputs.has_value(), ValueError)
+        << "The last pipeline stage requires the tensor of stacked outputs";
+  }
+  // Two receive buffers, so that the next micro-batch lands while the current one is computed.
+  std::vector<Tensor> recv_buffers;
+  if (!is_first) {
+    for (int i = 0; i < 2; ++i) {
+      recv_buffers.push_back(DiscoEmptyTensor(act_shape, act_dtype, std::nullopt));
+    }
+  }
+  std::vector<deviceEvent_t> recv_done(num_micro_batches, nullptr);
+  std::vector<deviceEvent_t> compute_done(num_micro_batches, nullptr);
+  // The stage outputs are kept alive until their sends complete.
+  std::vector<Tensor> sent;
+  auto post_recv = [&](int64_t micro_batch) {
+    if (micro_batch >= 2) {
+      // The buffer is free once the compute of micro-batch `micro_batch - 2` has read it.
+      StreamWaitEvent(comm_stream, compute_done[micro_batch - 2]);
+    }
+    Tensor buffer = recv_buffers[micro_batch % 2];
+    NCCL_CALL(ncclRecv(buffer->data, act_numel, nccl_dtype, worker->worker_id - group_size,
+                       ctx->global_comm, comm_stream));
+    EventCreate(&recv_done[micro_batch]);
+    EventRecord(recv_done[micro_batch], comm_stream);
+  };
+  if (!is_first && num_micro_batches > 0) {
+    post_recv(0);
+  }
+  for (int64_t micro_batch = 0; micro_batch < num_micro_batches; ++micro_batch) {
+    if (!is_first && micro_batch + 1 < num_micro_batches) {
+      post_recv(micro_batch + 1);
+    }
+    Tensor input;
+    if (is_first) {
+      input = PipelineStageInput(inputs, micro_batch);
+    } else {
+      StreamWaitEvent(compute_stream, recv_done[micro_batch]);
+      input = recv_buffers[micro_batch % 2];
+    }
+    Tensor output = stage_func(input, micro_batch).cast<Tensor>();
+    if (is_last) {
+      Tensor dst = MicroBatchView(outputs.value(), micro_batch);
+      Tensor::CopyFromTo(output.operator->(), dst.operator->(), compute_stream);
+    }
+    EventCreate(&compute_done[micro_batch]);
+    EventRecord(compute_done[micro_batch], compute_stream);
+    if (!is_last) {
+      TVM_FFI_CHECK_EQ(output.Shape()->Product(), act_numel, ValueError)
+          << "The output of pipeline stage " << stage << " has " << output.Shape()->Product()
+          << " elements, but the activation has " << act_numel;
+      StreamWaitEvent(comm_stream, compute_done[micro_batch]);
+      NCCL_CALL(ncclSend(output->data, act_numel, nccl_dtype, worker->worker_id + group_size,
+                         ctx->global_comm, comm_stream));
+      sent.push_back(output);
+    }
+  }
+  // The compute stream must not run ahead of the last sends and receives, which read and write
+  // buffers this function frees.
+  StreamSynchronize(comm_stream);
+  for (deviceEvent_t event : recv_done) {
+    if (event != nullptr) EventDestroy(event);
+  }
+  for (deviceEvent_t event : compute_done) {
+    if (event != nullptr) EventDestroy(event);
+  }
+}
+
 void SyncWorker() {
   CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
   TVM_FFI_ICHECK(ctx->worker != nullptr);
   deviceStream_t stream = ctx->GetDefaultStream();
   StreamSynchronize(stream);
+  if (ctx->comm_stream != nullptr) {
+    // Also finish the asynchronous collectives that are not waited for yet.
+    StreamSynchronize(ctx->comm_stream);
+  }
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
+  refl::ObjectDef<CollectiveEventObj>();
   refl::GlobalDef()
       .def("runtime.disco.compiled_ccl", []() -> ffi::String { return TVM_DISCO_CCL_NAME; })
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".init_ccl", InitCCL)
@@ -346,6 +618,20 @@ TVM_FFI_STATIC_INIT_BLOCK() {
            })
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".allgather",
            [](Tensor send, bool in_group, Tensor recv) { nccl::AllGather(send, in_group, recv); })
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".alltoall", AllToAll)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".ring_exchange", RingExchange)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".reducescatter",
+           [](Tensor send, int kind, bool in_group, Tensor recv) {
+             TVM_FFI_CHECK(0 <= kind && kind <= 4, ValueError) << "Unknown ReduceKind: " << kind;
+             nccl::ReduceScatter(send, static_cast<ReduceKind>(kind), in_group, recv);
+           })
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".allreduce_start",
+           [](Tensor send, int kind, bool in_group, Tensor recv) {
+             TVM_FFI_CHECK(0 <= kind && kind <= 4, ValueError) << "Unknown ReduceKind: " << kind;
+             return nccl::AllReduceStart(send, static_cast<ReduceKind>(kind), in_group, recv);
+           })
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".allgather_start", AllGatherStart)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".collective_wait", CollectiveWait)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".broadcast_from_worker0", BroadcastFromWorker0)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".scatter_from_worker0", ScatterFromWorker0)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".gather_to_worker0", GatherToWorker0)
@@ -354,7 +640,10 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".recv_from_prev_group", RecvFromPrevGroup)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".send_to_worker", SendToWorker)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".recv_from_worker", RecvFromWorker)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".kv_transfer_send", KVTransferSend)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".kv_transfer_recv", KVTransferRecv)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".sync_worker", SyncWorker)
+      .def("runtime.disco." TVM_DISCO_CCL_NAME ".pipeline_run", PipelineRun)
       .def("runtime.disco." TVM_DISCO_CCL_NAME ".test_send_to_next_group_recv_from_prev_group",
            [](Tensor buffer) {
              CCLThreadLocalContext* ctx = CCLThreadLocalContext::Get();
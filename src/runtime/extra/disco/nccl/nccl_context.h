@@ -71,6 +71,17 @@ inline void StreamCreate(deviceStream_t* stream) {
 inline void StreamDestroy(deviceStream_t stream) {
   TVM_FFI_CHECK_CUDA_ERROR(cudaStreamDestroy(stream));
 }
+using deviceEvent_t = cudaEvent_t;
+inline void EventCreate(deviceEvent_t* event) {
+  TVM_FFI_CHECK_CUDA_ERROR(cudaEventCreateWithFlags(event, cudaEventDisableTiming));
+}
+inline void EventDestroy(deviceEvent_t event) { TVM_FFI_CHECK_CUDA_ERROR(cudaEventDestroy(event)); }
+inline void EventRecord(deviceEvent_t event, deviceStream_t stream) {
+  TVM_FFI_CHECK_CUDA_ERROR(cudaEventRecord(event, stream));
+}
+inline void StreamWaitEvent(deviceStream_t stream, deviceEvent_t event) {
+  TVM_FFI_CHECK_CUDA_ERROR(cudaStreamWaitEvent(stream, event, 0));
+}
 
 #else
 
@@ -83,6 +94,17 @@ inline void SetDevice(int device_id) { ROCM_CALL(hipSetDevice(device_id)); }
 inline void StreamSynchronize(deviceStream_t stream) { ROCM_CALL(hipStreamSynchronize(stream)); }
 inline void StreamCreate(deviceStream_t* stream) { ROCM_CALL(hipStreamCreate(stream)); }
 inline void StreamDestroy(deviceStream_t stream) { ROCM_CALL(hipStreamDestroy(stream)); }
+using deviceEvent_t = hipEvent_t;
+inline void EventCreate(deviceEvent_t* event) {
+  ROCM_CALL(hipEventCreateWithFlags(event, hipEventDisableTiming));
+}
+inline void EventDestroy(deviceEvent_t event) { ROCM_CALL(hipEventDestroy(event)); }
+inline void EventRecord(deviceEvent_t event, deviceStream_t stream) {
+  ROCM_CALL(hipEventRecord(event, stream));
+}
+inline void StreamWaitEvent(deviceStream_t stream, deviceEvent_t event) {
+  ROCM_CALL(hipStreamWaitEvent(stream, event, 0));
+}
 
 #endif
 
@@ -125,16 +147,57 @@ inline ncclDataType_t AsNCCLDataType(DLDataType dtype) {
   throw;
 }
 
+/*! \brief Convert ReduceKind to ncclRedOp_t. */
+inline ncclRedOp_t AsNCCLRedOp(ReduceKind kind) {
+  switch (kind) {
+    case ReduceKind::kSum:
+      return ncclSum;
+    case ReduceKind::kProd:
+      return ncclProd;
+    case ReduceKind::kMin:
+      return ncclMin;
+    case ReduceKind::kMax:
+      return ncclMax;
+    case ReduceKind::kAvg:
+      return ncclAvg;
+  }
+  TVM_FFI_THROW(ValueError) << "Unknown ReduceKind: " << static_cast<int>(kind);
+  throw;
+}
+
 struct CCLThreadLocalContext {
   DiscoWorker* worker = nullptr;
   int device_id;
   deviceStream_t default_stream = nullptr;
+  /*! \brief The stream of the asynchronous collectives, created on first use */
+  deviceStream_t comm_stream = nullptr;
   ncclComm_t global_comm = nullptr;
   ncclComm_t group_comm = nullptr;
+  /*!
+   * \brief The node layout used by the allreduce dispatcher, detected on first use.
+   *  `workers_per_node` is 0 until then.
+   */
+  int workers_per_node = 0;
+  int local_rank = 0;
+  /*! \brief Whether the devices on the node are connected by NVLink */
+  bool nvlink = false;
+  /*! \brief The workers on the same node */
+  ncclComm_t intra_node_comm = nullptr;
+  /*! \brief The workers with the same local rank on every node, null on a single node */
+  ncclComm_t inter_node_comm = nullptr;
 
   ~CCLThreadLocalContext() { Clear(); }
 
   void Clear() {
+    if (inter_node_comm) {
+      NCCL_CALL(ncclCommDestroy(inter_node_comm));
+      inter_node_comm = nullptr;
+    }
+    if (intra_node_comm) {
+      NCCL_CALL(ncclCommDestroy(intra_node_comm));
+      intra_node_comm = nullptr;
+    }
+    workers_per_node = 0;
     if (group_comm) {
       NCCL_CALL(ncclCommDestroy(group_comm));
       if (global_comm == group_comm) {
@@ -150,6 +213,10 @@ struct CCLThreadLocalContext {
       StreamDestroy(default_stream);
       default_stream = nullptr;
     }
+    if (comm_stream) {
+      StreamDestroy(comm_stream);
+      comm_stream = nullptr;
+    }
     worker = nullptr;
   }
 
@@ -160,6 +227,13 @@ struct CCLThreadLocalContext {
     return stream == nullptr ? default_stream : stream;
   }
 
+  deviceStream_t GetCommStream() {
+    if (comm_stream == nullptr) {
+      StreamCreate(&comm_stream);
+    }
+    return comm_stream;
+  }
+
   static CCLThreadLocalContext* Get();
 };
 
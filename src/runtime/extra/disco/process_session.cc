@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -32,35 +33,105 @@
 #include "./disco_worker_thread.h"
 #include "./message_queue.h"
 #include "./protocol.h"
+#include "./shm_channel.h"
 
 namespace tvm {
 namespace runtime {
 
+/*!
+ * \brief The channel between the controller and a worker process. Messages go through the
+ *  pipes by default, or through a shared-memory segment when the controller names one in
+ *  the handshake, in which case the pipes only carry the handshake.
+ */
 class DiscoProcessChannel final : public DiscoChannel {
  public:
   DiscoProcessChannel(int64_t controler_to_worker_fd, int64_t worker_to_controler_fd)
-      : controller_to_worker_pipe_(controler_to_worker_fd),
+      : controller_to_worker_fd_(controler_to_worker_fd),
+        worker_to_controller_fd_(worker_to_controler_fd),
+        controller_to_worker_pipe_(controler_to_worker_fd),
         worker_to_controller_pipe_(worker_to_controler_fd),
-        controler_to_worker_(&controller_to_worker_pipe_),
-        worker_to_controler_(&worker_to_controller_pipe_) {}
+        controler_to_worker_(
+            std::make_unique<DiscoStreamMessageQueue>(&controller_to_worker_pipe_)),
+        worker_to_controler_(
+            std::make_unique<DiscoStreamMessageQueue>(&worker_to_controller_pipe_)) {}
 
   DiscoProcessChannel(DiscoProcessChannel&& other) = delete;
   DiscoProcessChannel(const DiscoProcessChannel& other) = delete;
 
-  void Send(const ffi::PackedArgs& args) { controler_to_worker_.Send(args); }
-  ffi::PackedArgs Recv() { return controler_to_worker_.Recv(); }
-  void Reply(const ffi::PackedArgs& args) { worker_to_controler_.Send(args); }
-  ffi::PackedArgs RecvReply() { return worker_to_controler_.Recv(); }
+  /*!
+   * \brief Controller side of the handshake, sent before any message.
+   * \param use_shm Whether to move the channel to a new shared-memory segment.
+   */
+  void ConnectWorker(bool use_shm) {
+    if (!use_shm) {
+      uint64_t name_size = 0;
+      controller_to_worker_pipe_.Write(&name_size, sizeof(name_size));
+      return;
+    }
+#ifdef TVM_DISCO_SHM_SUPPORTED
+    std::string shm_name = DiscoShmSegment::UniqueName();
+    segment_ = std::make_unique<DiscoShmSegment>(DiscoShmSegment::Create(shm_name));
+    uint64_t name_size = shm_name.size();
+    controller_to_worker_pipe_.Write(&name_size, sizeof(name_size));
+    controller_to_worker_pipe_.Write(shm_name.data(), name_size);
+    UseShm(worker_to_controller_fd_);
+#else
+    TVM_FFI_THROW(ValueError) << "The shared memory transport is not supported on this platform";
+#endif
+  }
+
+  /*! \brief Worker side of the handshake, received before any message. */
+  void ConnectController() {
+    uint64_t name_size = 0;
+    TVM_FFI_ICHECK_EQ(controller_to_worker_pipe_.Read(&name_size, sizeof(name_size)),
+                      sizeof(name_size))
+        << "The disco controller exited before the handshake";
+    if (name_size == 0) return;
+#ifdef TVM_DISCO_SHM_SUPPORTED
+    std::string shm_name(name_size, '\0');
+    controller_to_worker_pipe_.Read(shm_name.data(), name_size);
+    segment_ = std::make_unique<DiscoShmSegment>(DiscoShmSegment::Attach(shm_name));
+    UseShm(controller_to_worker_fd_);
+#else
+    TVM_FFI_THROW(ValueError) << "The shared memory transport is not supported on this platform";
+#endif
+  }
+
+  void Send(const ffi::PackedArgs& args) { controler_to_worker_->Send(args); }
+  ffi::PackedArgs Recv() { return controler_to_worker_->Recv(); }
+  void Reply(const ffi::PackedArgs& args) { worker_to_controler_->Send(args); }
+  ffi::PackedArgs RecvReply() { return worker_to_controler_->Recv(); }
+
+ private:
+#ifdef TVM_DISCO_SHM_SUPPORTED
+  /*! \brief Move the message queues onto the segment, watching peer_fd for a hang up. */
+  void UseShm(int peer_fd) {
+    controller_to_worker_shm_ =
+        std::make_unique<DiscoShmRingStream>(segment_->controller_to_worker(), peer_fd);
+    worker_to_controller_shm_ =
+        std::make_unique<DiscoShmRingStream>(segment_->worker_to_controller(), peer_fd);
+    controler_to_worker_ =
+        std::make_unique<DiscoStreamMessageQueue>(controller_to_worker_shm_.get());
+    worker_to_controler_ =
+        std::make_unique<DiscoStreamMessageQueue>(worker_to_controller_shm_.get());
+  }
 
+  std::unique_ptr<DiscoShmSegment> segment_;
+  std::unique_ptr<DiscoShmRingStream> controller_to_worker_shm_;
+  std::unique_ptr<DiscoShmRingStream> worker_to_controller_shm_;
+#endif
+  int controller_to_worker_fd_;
+  int worker_to_controller_fd_;
   support::Pipe controller_to_worker_pipe_;
   support::Pipe worker_to_controller_pipe_;
-  DiscoStreamMessageQueue controler_to_worker_;
-  DiscoStreamMessageQueue worker_to_controler_;
+  std::unique_ptr<DiscoStreamMessageQueue> controler_to_worker_;
+  std::unique_ptr<DiscoStreamMessageQueue> worker_to_controler_;
 };
 
 class ProcessSessionObj final : public BcastSessionObj {
  public:
-  explicit ProcessSessionObj(int num_workers, int num_groups, ffi::Function process_pool)
+  explicit ProcessSessionObj(int num_workers, int num_groups, ffi::Function process_pool,
+                             const std::string& transport)
       : process_pool_(process_pool),
         worker_0_(
             std::make_unique<DiscoWorkerThread>(0, num_workers, num_groups, &worker_zero_data_)) {
@@ -78,6 +149,7 @@ class ProcessSessionObj final : public BcastSessionObj {
     }
     for (int i = 0; i < num_workers - 1; ++i) {
       workers_.emplace_back(std::make_unique<DiscoProcessChannel>(write_fds[i], read_fds[i]));
+      workers_.back()->ConnectWorker(/*use_shm=*/transport == "shm");
     }
   }
 
@@ -173,14 +245,18 @@ class ProcessSessionObj final : public BcastSessionObj {
 };
 
 Session Session::ProcessSession(int num_workers, int num_group, ffi::String process_pool_creator,
-                                ffi::String entrypoint) {
+                                ffi::String entrypoint, ffi::String transport) {
   TVM_FFI_ICHECK_EQ(num_workers % num_group, 0)
       << "The number of workers should be divisible by the number of worker group.";
+  TVM_FFI_CHECK(transport == "pipe" || transport == "shm", ValueError)
+      << "Unknown disco process transport \"" << transport << "\", expected \"pipe\" or \"shm\"";
+  TVM_FFI_CHECK(transport == "pipe" || DiscoShmSupported(), ValueError)
+      << "The shared memory transport is not supported on this platform";
   const auto pf = tvm::ffi::Function::GetGlobal(process_pool_creator);
   TVM_FFI_CHECK(pf, ValueError) << "Cannot find function " << process_pool_creator
                                 << " in the registry. Please check if it is registered.";
   auto process_pool = (*pf)(num_workers, num_group, entrypoint).cast<ffi::Function>();
-  auto n = ffi::make_object<ProcessSessionObj>(num_workers, num_group, process_pool);
+  auto n = ffi::make_object<ProcessSessionObj>(num_workers, num_group, process_pool, transport);
   return Session(n);
 }
 
@@ -189,6 +265,7 @@ void WorkerProcess(int worker_id, int num_workers, int num_group, int64_t read_f
   TVM_FFI_ICHECK_EQ(num_workers % num_group, 0)
       << "The number of workers should be divisible by the number of worker group.";
   DiscoProcessChannel channel(read_fd, write_fd);
+  channel.ConnectController();
   DiscoWorker worker(worker_id, num_workers, num_group, nullptr, &channel);
   worker.MainLoop();
 }
@@ -23,6 +23,7 @@
 #include <tvm/ffi/extra/serialization.h>
 #include <tvm/runtime/base.h>
 #include <tvm/runtime/disco/session.h>
+#include <tvm/runtime/metrics.h>
 #include <tvm/support/io.h>
 #include <tvm/support/serializer.h>
 
@@ -40,6 +41,27 @@
 namespace tvm {
 namespace runtime {
 
+/*! \brief The runtime metrics of the Disco message channels. */
+struct DiscoQueueMetrics {
+  metrics::Counter* messages_sent;
+  metrics::Counter* bytes_sent;
+  metrics::Gauge* queued_messages;
+
+  static const DiscoQueueMetrics& Global() {
+    static DiscoQueueMetrics global_metrics = [] {
+      metrics::Registry* registry = metrics::Registry::Global();
+      return DiscoQueueMetrics{
+          registry->GetCounter("tvm_disco_messages_sent_total",
+                               "Messages sent through the Disco message channels."),
+          registry->GetCounter("tvm_disco_message_bytes_sent_total",
+                               "Bytes sent through the Disco message channels."),
+          registry->GetGauge("tvm_disco_queued_messages",
+                             "Messages waiting in the in-process Disco message queues.")};
+    }();
+    return global_metrics;
+  }
+};
+
 /*!
  * \brief The communication protocol used by Disco message channel.
  * \tparam SubClassType The subclass type that inherits this protocol.
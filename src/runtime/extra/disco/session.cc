@@ -49,6 +49,8 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     Session self = args[0].cast<Session>();
                     *rv = SessionObj::FFI::CallWithPacked(self, args.Slice(1));
                   })
+      .def_method("runtime.disco.SessionBeginCapture", &SessionObj::BeginCapture)
+      .def_method("runtime.disco.SessionEndCapture", &SessionObj::EndCapture)
       .def_method("runtime.disco.SessionShutdown", &SessionObj::Shutdown);
 }
 
@@ -0,0 +1,313 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file shm_channel.h
+ * \brief Shared-memory byte streams between the disco controller and a worker process.
+ *
+ *  A segment holds two single-producer single-consumer rings, one per direction. The
+ *  producer and the consumer only exchange the head and tail counters, and a waiting side
+ *  spins briefly before it sleeps on a futex that the other side wakes.
+ */
+#ifndef TVM_RUNTIME_EXTRA_DISCO_SHM_CHANNEL_H_
+#define TVM_RUNTIME_EXTRA_DISCO_SHM_CHANNEL_H_
+
+#include <tvm/ffi/error.h>
+#include <tvm/support/io.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#define TVM_DISCO_SHM_SUPPORTED 1
+#endif
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief Whether the shared-memory transport is supported on this platform. */
+inline bool DiscoShmSupported() {
+#ifdef TVM_DISCO_SHM_SUPPORTED
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef TVM_DISCO_SHM_SUPPORTED
+
+/*! \brief The header of a ring in shared memory, each counter on its own cache line. */
+struct DiscoShmRingHeader {
+  /*! \brief The total bytes consumed, written by the consumer */
+  alignas(64) std::atomic<uint64_t> head;
+  /*! \brief The total bytes produced, written by the producer */
+  alignas(64) std::atomic<uint64_t> tail;
+  /*! \brief Bumped by the producer after producing, the futex word of the consumer */
+  alignas(64) std::atomic<uint32_t> data_seq;
+  std::atomic<uint32_t> consumer_waiting;
+  /*! \brief Bumped by the consumer after consuming, the futex word of the producer */
+  alignas(64) std::atomic<uint32_t> space_seq;
+  std::atomic<uint32_t> producer_waiting;
+  /*! \brief Set when either side closes the ring */
+  alignas(64) std::atomic<uint32_t> closed;
+};
+
+/*! \brief One direction of a shared-memory channel, used as a blocking byte stream. */
+class DiscoShmRingStream : public support::Stream {
+ public:
+  /*! \brief The bytes of data in each ring. */
+  static constexpr uint64_t kCapacity = 1 << 20;
+  /*! \brief The bytes of a ring in the segment. */
+  static constexpr size_t kRingBytes = sizeof(DiscoShmRingHeader) + kCapacity;
+
+  /*!
+   * \brief Wrap a ring in a mapped segment.
+   * \param ring The start of the ring.
+   * \param peer_fd A pipe end shared with the peer process, which hangs up when the peer
+   *  exits. It lets a waiting side notice a peer that died without closing the ring.
+   */
+  DiscoShmRingStream(void* ring, int peer_fd)
+      : header_(static_cast<DiscoShmRingHeader*>(ring)),
+        data_(static_cast<char*>(ring) + sizeof(DiscoShmRingHeader)),
+        peer_fd_(peer_fd) {}
+
+  ~DiscoShmRingStream() { Close(); }
+
+  using Stream::Read;
+  using Stream::Write;
+
+  /*! \brief Read exactly size bytes, or fewer once the ring is closed and drained. */
+  size_t Read(void* ptr, size_t size) final {
+    char* dst = static_cast<char*>(ptr);
+    size_t nread = 0;
+    while (nread < size) {
+      uint64_t head = header_->head.load(std::memory_order_relaxed);
+      uint64_t tail = header_->tail.load(std::memory_order_acquire);
+      if (tail == head) {
+        if (!Wait(&header_->data_seq, &header_->consumer_waiting, [this, head] {
+              return header_->tail.load(std::memory_order_acquire) != head;
+            })) {
+          break;
+        }
+        continue;
+      }
+      size_t n = std::min<uint64_t>(tail - head, size - nread);
+      CopyOut(head, dst + nread, n);
+      header_->head.store(head + n, std::memory_order_release);
+      Notify(&header_->space_seq, &header_->producer_waiting);
+      nread += n;
+    }
+    return nread;
+  }
+
+  /*! \brief Write size bytes, blocking while the ring is full. */
+  size_t Write(const void* ptr, size_t size) final {
+    const char* src = static_cast<const char*>(ptr);
+    size_t nwritten = 0;
+    while (nwritten < size) {
+      uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+      uint64_t head = header_->head.load(std::memory_order_acquire);
+      if (tail - head == kCapacity) {
+        bool ok = Wait(&header_->space_seq, &header_->producer_waiting, [this, tail] {
+          return tail - header_->head.load(std::memory_order_acquire) != kCapacity;
+        });
+        TVM_FFI_ICHECK(ok) << "The disco shared-memory channel is closed by the peer";
+        continue;
+      }
+      size_t n = std::min<uint64_t>(kCapacity - (tail - head), size - nwritten);
+      CopyIn(tail, src + nwritten, n);
+      header_->tail.store(tail + n, std::memory_order_release);
+      Notify(&header_->data_seq, &header_->consumer_waiting);
+      nwritten += n;
+    }
+    return nwritten;
+  }
+
+  /*! \brief Close the ring, waking the peer. */
+  void Close() {
+    header_->closed.store(1, std::memory_order_seq_cst);
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    header_->space_seq.fetch_add(1, std::memory_order_seq_cst);
+    FutexWake(&header_->data_seq);
+    FutexWake(&header_->space_seq);
+  }
+
+ private:
+  /*! \brief The spins before sleeping on the futex. */
+  static constexpr int kSpinCount = 4096;
+
+  void CopyOut(uint64_t pos, char* dst, size_t n) const {
+    size_t offset = pos % kCapacity;
+    size_t first = std::min<size_t>(n, kCapacity - offset);
+    std::memcpy(dst, data_ + offset, first);
+    std::memcpy(dst + first, data_, n - first);
+  }
+
+  void CopyIn(uint64_t pos, const char* src, size_t n) {
+    size_t offset = pos % kCapacity;
+    size_t first = std::min<size_t>(n, kCapacity - offset);
+    std::memcpy(data_ + offset, src, first);
+    std::memcpy(data_, src + first, n - first);
+  }
+
+  /*!
+   * \brief Wait until ready() holds. Returns false when the ring is closed, or when the
+   *  peer process has exited without closing it.
+   */
+  template <typename FReady>
+  bool Wait(std::atomic<uint32_t>* seq, std::atomic<uint32_t>* waiting, FReady ready) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (ready()) return true;
+      if (header_->closed.load(std::memory_order_acquire)) return ready();
+    }
+    while (true) {
+      uint32_t expected = seq->load(std::memory_order_seq_cst);
+      waiting->store(1, std::memory_order_seq_cst);
+      // Re-check after announcing the wait, the peer checks `waiting` after publishing.
+      if (ready()) break;
+      if (header_->closed.load(std::memory_order_seq_cst)) {
+        waiting->store(0, std::memory_order_relaxed);
+        return ready();
+      }
+      // Wake up regularly to detect a peer that died without closing the ring.
+      struct timespec timeout = {0, 100 * 1000 * 1000};
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(seq), FUTEX_WAIT, expected, &timeout,
+              nullptr, 0);
+      if (PeerHungUp()) {
+        waiting->store(0, std::memory_order_relaxed);
+        return ready();
+      }
+    }
+    waiting->store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool PeerHungUp() const {
+    struct pollfd pfd = {peer_fd_, 0, 0};
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLHUP | POLLERR)) != 0;
+  }
+
+  static void Notify(std::atomic<uint32_t>* seq, std::atomic<uint32_t>* waiting) {
+    seq->fetch_add(1, std::memory_order_seq_cst);
+    if (waiting->load(std::memory_order_seq_cst)) {
+      FutexWake(seq);
+    }
+  }
+
+  static void FutexWake(std::atomic<uint32_t>* seq) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(seq), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+
+  DiscoShmRingHeader* header_;
+  char* data_;
+  /*! \brief The pipe end that hangs up when the peer exits */
+  int peer_fd_;
+};
+
+/*!
+ * \brief A shared-memory segment with the rings of both directions of a channel.
+ *  The controller creates the segment and the worker attaches to it by name.
+ */
+class DiscoShmSegment {
+ public:
+  /*! \brief The bytes of a segment. */
+  static constexpr size_t kSegmentBytes = 2 * DiscoShmRingStream::kRingBytes;
+
+  /*! \brief A segment name that is unique within the running processes. */
+  static std::string UniqueName() {
+    static std::atomic<uint64_t> counter{0};
+    std::ostringstream os;
+    os << "/tvm-disco-" << getpid() << "-" << counter++;
+    return os.str();
+  }
+
+  /*! \brief Create a new segment on the controller. */
+  static DiscoShmSegment Create(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    TVM_FFI_ICHECK_GE(fd, 0) << "Cannot create the shared memory segment " << name << ": "
+                             << strerror(errno);
+    TVM_FFI_ICHECK_EQ(ftruncate(fd, kSegmentBytes), 0)
+        << "Cannot resize the shared memory segment " << name << ": " << strerror(errno);
+    // The pages of a new shared memory object are zero, which is the initial ring state.
+    return DiscoShmSegment(name, fd, /*owner=*/true);
+  }
+
+  /*! \brief Attach to the segment created by the controller. */
+  static DiscoShmSegment Attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    TVM_FFI_ICHECK_GE(fd, 0) << "Cannot open the shared memory segment " << name << ": "
+                             << strerror(errno);
+    // Both sides have mapped the segment now, so its name is no longer needed.
+    shm_unlink(name.c_str());
+    return DiscoShmSegment(name, fd, /*owner=*/false);
+  }
+
+  DiscoShmSegment(DiscoShmSegment&& other)
+      : name_(std::move(other.name_)), data_(other.data_), owner_(other.owner_) {
+    other.data_ = nullptr;
+  }
+  DiscoShmSegment(const DiscoShmSegment& other) = delete;
+
+  ~DiscoShmSegment() {
+    if (data_ != nullptr) {
+      munmap(data_, kSegmentBytes);
+    }
+    if (owner_) {
+      // in case the worker never attached
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  /*! \brief The ring from the controller to the worker. */
+  void* controller_to_worker() const { return data_; }
+  /*! \brief The ring from the worker to the controller. */
+  void* worker_to_controller() const {
+    return static_cast<char*>(data_) + DiscoShmRingStream::kRingBytes;
+  }
+
+ private:
+  DiscoShmSegment(std::string name, int fd, bool owner) : name_(std::move(name)), owner_(owner) {
+    data_ = mmap(nullptr, kSegmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    TVM_FFI_ICHECK(data_ != MAP_FAILED)
+        << "Cannot map the shared memory segment " << name_ << ": " << strerror(errno);
+  }
+
+  std::string name_;
+  void* data_;
+  bool owner_;
+};
+
+#endif  // TVM_DISCO_SHM_SUPPORTED
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_EXTRA_DISCO_SHM_CHANNEL_H_
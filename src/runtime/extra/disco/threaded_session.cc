@@ -56,6 +56,10 @@ class DiscoThreadedMessageQueue : private support::Stream,
 
  protected:
   void CommitSendAndNotifyEnqueue() {
+    const DiscoQueueMetrics& metrics = DiscoQueueMetrics::Global();
+    metrics.messages_sent->Increment();
+    metrics.bytes_sent->Increment(write_buffer_.size());
+    metrics.queued_messages->Add(1);
     bool need_notify = false;
     {
       std::lock_guard<std::mutex> lock{mutex_};
@@ -76,6 +80,7 @@ class DiscoThreadedMessageQueue : private support::Stream,
       condition_.wait(lock, [this] { return msg_cnt_.load() > 0; });
       dequeue_waiting_ = false;
       --msg_cnt_;
+      DiscoQueueMetrics::Global().queued_messages->Add(-1);
       uint64_t packet_nbytes = 0;
       ring_buffer_.Read(&packet_nbytes, sizeof(packet_nbytes));
       read_buffer_.resize(packet_nbytes);
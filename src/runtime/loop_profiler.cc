@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/loop_profiler.cc
+ * \brief Runtime handler of the profile intrinsics inserted by InstrumentProfileIntrinsics.
+ *
+ * CPU code generators lower `start_profile_intrinsic(id)` and `end_profile_intrinsic(id)` to
+ * TVMBackendProfileStart/End. While the profiler is enabled, every thread reads a group of
+ * hardware counters (cycles, instructions, L1D read misses, LLC misses, branch misses) through
+ * perf_event on Linux at both markers, and the differences are accumulated per kernel and per
+ * instrumented loop. Elapsed time is always recorded; the hardware counters are reported only
+ * when perf_event is available.
+ */
+
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/logging.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+/*! \brief The hardware events read at each marker, in report order. */
+constexpr const char* kEventNames[] = {"cycles", "instructions", "l1d_read_misses",
+                                       "llc_misses", "branch_misses"};
+constexpr int kNumEvents = sizeof(kEventNames) / sizeof(kEventNames[0]);
+
+using CounterValues = std::array<uint64_t, kNumEvents>;
+
+/*! \brief The accumulated measurements of one instrumented loop. */
+struct LoopRecord {
+  uint64_t calls = 0;
+  uint64_t time_ns = 0;
+  CounterValues counters{};
+};
+
+/*! \brief The per-thread perf_event group and the stack of open markers. */
+class ThreadCounters {
+ public:
+  ~ThreadCounters() {
+#if defined(__linux__)
+    for (int fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+#endif
+  }
+
+  /*! \brief Whether the hardware counters of this thread could be opened. */
+  bool Available() {
+    if (!initialized_) Open();
+    return leader() >= 0;
+  }
+
+  /*! \brief Read the current counter values, zero if they are unavailable. */
+  CounterValues Read() {
+    CounterValues values{};
+#if defined(__linux__)
+    if (!Available()) return values;
+    // PERF_FORMAT_GROUP: the number of events followed by their values.
+    uint64_t buffer[kNumEvents + 1] = {0};
+    if (read(leader(), buffer, sizeof(buffer)) > 0) {
+      for (uint64_t i = 0; i < buffer[0] && i < static_cast<uint64_t>(kNumEvents); ++i) {
+        values[slots_[i]] = buffer[i + 1];
+      }
+    }
+#endif
+    return values;
+  }
+
+  /*! \brief The open markers: the key of the loop, the start time, and the start counters. */
+  struct Marker {
+    std::pair<std::string, int32_t> key;
+    std::chrono::steady_clock::time_point start;
+    CounterValues counters;
+  };
+  std::vector<Marker> stack;
+
+ private:
+  int leader() const { return fds_.empty() ? -1 : fds_[0]; }
+
+  void Open() {
+    initialized_ = true;
+#if defined(__linux__)
+    const std::pair<uint32_t, uint64_t> events[kNumEvents] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    for (int i = 0; i < kNumEvents; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = events[i].first;
+      attr.config = events[i].second;
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.disabled = fds_.empty() ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader(), 0));
+      if (fd < 0) {
+        // Without a leader there is nothing to read; other events are optional.
+        if (fds_.empty()) return;
+        continue;
+      }
+      fds_.push_back(fd);
+      slots_.push_back(i);
+    }
+    ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  bool initialized_ = false;
+  std::vector<int> fds_;
+  /*! \brief The index in kEventNames of each opened event. */
+  std::vector<int> slots_;
+};
+
+class LoopProfiler {
+ public:
+  static LoopProfiler* Global() {
+    static LoopProfiler* inst = new LoopProfiler();
+    return inst;
+  }
+
+  void Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+    has_counters_ = false;
+    enabled_.store(true, std::memory_order_release);
+  }
+
+  void Stop() { enabled_.store(false, std::memory_order_release); }
+
+  bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  void Enter(const char* func_name, int32_t id) {
+    ThreadCounters* counters = GetThreadCounters();
+    counters->stack.push_back(
+        {{func_name, id}, std::chrono::steady_clock::now(), counters->Read()});
+  }
+
+  void Exit(const char* func_name, int32_t id) {
+    ThreadCounters* counters = GetThreadCounters();
+    CounterValues end_counters = counters->Read();
+    auto end = std::chrono::steady_clock::now();
+    // Markers are emitted in matching pairs; unwind to the matching one so that an early
+    // return between the markers does not corrupt the stack.
+    while (!counters->stack.empty()) {
+      ThreadCounters::Marker marker = std::move(counters->stack.back());
+      counters->stack.pop_back();
+      if (marker.key.second != id || marker.key.first != func_name) continue;
+      std::lock_guard<std::mutex> lock(mutex_);
+      LoopRecord& record = records_[marker.key];
+      record.calls += 1;
+      record.time_ns += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - marker.start).count());
+      for (int i = 0; i < kNumEvents; ++i) {
+        record.counters[i] += end_counters[i] - marker.counters[i];
+      }
+      has_counters_ |= counters->Available();
+      return;
+    }
+  }
+
+  /*! \brief A JSON report of the accumulated records, ordered by kernel and loop id. */
+  std::string Report() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream os;
+    os << "{\"counters\": [";
+    if (has_counters_) {
+      for (int i = 0; i < kNumEvents; ++i) {
+        os << (i ? ", " : "") << "\"" << kEventNames[i] << "\"";
+      }
+    }
+    os << "], \"loops\": [";
+    bool first = true;
+    for (const auto& [key, record] : records_) {
+      os << (first ? "" : ", ") << "{\"kernel\": \"" << key.first << "\", \"loop\": "
+         << key.second << ", \"calls\": " << record.calls << ", \"time_ns\": " << record.time_ns;
+      if (has_counters_) {
+        for (int i = 0; i < kNumEvents; ++i) {
+          os << ", \"" << kEventNames[i] << "\": " << record.counters[i];
+        }
+      }
+      os << "}";
+      first = false;
+    }
+    os << "]}";
+    return os.str();
+  }
+
+ private:
+  static ThreadCounters* GetThreadCounters() {
+    static thread_local ThreadCounters counters;
+    return &counters;
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::mutex mutex_;
+  bool has_counters_ = false;
+  std::map<std::pair<std::string, int32_t>, LoopRecord> records_;
+};
+
+}  // namespace
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("runtime.LoopProfilerStart", []() { LoopProfiler::Global()->Start(); })
+      .def("runtime.LoopProfilerStop", []() { LoopProfiler::Global()->Stop(); })
+      .def("runtime.LoopProfilerReport", []() { return LoopProfiler::Global()->Report(); });
+}
+
+}  // namespace runtime
+}  // namespace tvm
+
+int TVMBackendProfileStart(const char* func_name, int32_t id) {
+  tvm::runtime::LoopProfiler* profiler = tvm::runtime::LoopProfiler::Global();
+  if (profiler->enabled()) profiler->Enter(func_name, id);
+  return 0;
+}
+
+int TVMBackendProfileEnd(const char* func_name, int32_t id) {
+  tvm::runtime::LoopProfiler* profiler = tvm::runtime::LoopProfiler::Global();
+  if (profiler->enabled()) profiler->Exit(func_name, id);
+  return 0;
+}
@@ -0,0 +1,413 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/memory/buddy_allocator.h
+ * \brief A size-class buddy allocator that sub-allocates large device slabs.
+ */
+#ifndef TVM_RUNTIME_MEMORY_BUDDY_ALLOCATOR_H_
+#define TVM_RUNTIME_MEMORY_BUDDY_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/memory/memory_manager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace memory {
+
+/*! \brief The statistics of a buddy allocator, in bytes unless noted otherwise. */
+struct BuddyAllocatorStats {
+  /*! \brief The total device memory held by the allocator, in use or not. */
+  size_t reserved_bytes = 0;
+  /*! \brief The total size of the blocks handed out. */
+  size_t used_bytes = 0;
+  /*! \brief The total size requested by the live allocations. */
+  size_t requested_bytes = 0;
+  /*! \brief The total size of the free blocks held by the allocator. */
+  size_t free_bytes = 0;
+  /*! \brief The size of the largest free block. */
+  size_t largest_free_block = 0;
+  /*! \brief The number of device slabs. */
+  size_t num_slabs = 0;
+  /*! \brief The number of free blocks. */
+  size_t num_free_blocks = 0;
+};
+
+/*!
+ * \brief A buddy allocator over large device slabs.
+ *
+ * Requests are rounded up to a power-of-two size class no smaller than the
+ * minimum block size. A block of a size class is taken from the free list of
+ * that class, or split from a larger free block. Freed blocks are coalesced
+ * with their buddies, so memory released by one shape can be reused by
+ * another shape, which avoids the fragmentation of exact-size pooling under
+ * dynamic shapes.
+ *
+ * Requests larger than a slab, requests with an alignment larger than
+ * kAllocAlignment, and requests on devices whose data pointers are opaque
+ * handles (e.g., Vulkan and Metal) can not be carved out of a slab. They are
+ * allocated as whole blocks and cached by size class instead.
+ *
+ * When a device allocation fails, the allocator releases the memory it holds
+ * but does not use and retries, first with a full slab and then with a slab
+ * that only fits the request. Once a high-water mark is set, free memory is
+ * also released whenever the reserved memory goes above the mark.
+ */
+class BuddyAllocator final : public Allocator {
+ public:
+  static constexpr size_t kDefaultMinBlockSize = 4096;
+  static constexpr size_t kDefaultSlabSize = 64UL << 20;
+
+  explicit BuddyAllocator(size_t min_block_size = kDefaultMinBlockSize,
+                          size_t slab_size = kDefaultSlabSize)
+      : Allocator(kBuddy),
+        min_block_size_(min_block_size),
+        slab_size_(slab_size),
+        used_memory_(0) {
+    TVM_FFI_ICHECK(IsPowerOfTwo(min_block_size_))
+        << "The minimum block size must be a power of two, but got " << min_block_size_;
+    TVM_FFI_ICHECK(IsPowerOfTwo(slab_size_) && slab_size_ >= min_block_size_)
+        << "The slab size must be a power of two no smaller than the minimum block size, "
+        << "but got " << slab_size_;
+    free_blocks_.resize(Order(slab_size_) + 1);
+  }
+
+  ~BuddyAllocator() {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& [base, slab] : slabs_) {
+      DeviceAPI::Get(slab.device)->FreeDataSpace(slab.device, reinterpret_cast<void*>(base));
+    }
+    for (const auto& [size, blocks] : whole_block_pool_) {
+      for (const Buffer& buf : blocks) {
+        DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
+      }
+    }
+  }
+
+  Buffer Alloc(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) final {
+    std::lock_guard<std::mutex> lock(mu_);
+    Buffer buf;
+    buf.device = dev;
+    buf.size = SizeClass(std::max(nbytes, alignment));
+    buf.alloc_type = kBuddy;
+    bool in_slab =
+        buf.size <= slab_size_ && alignment <= kAllocAlignment && SupportsSubAllocation(dev);
+    if (in_slab) {
+      buf.data = reinterpret_cast<void*>(AllocFromSlabs(dev, buf.size, type_hint));
+    } else {
+      buf.data = AllocWholeBlock(dev, buf.size, alignment, type_hint);
+    }
+    live_blocks_.emplace(buf.data, LiveBlock{nbytes, in_slab});
+    requested_memory_ += nbytes;
+    used_memory_.fetch_add(buf.size, std::memory_order_relaxed);
+    VLOG(1) << "allocate " << buf.size << " B for " << nbytes << " B, used memory " << used_memory_
+            << " B, reserved memory " << reserved_memory_ << " B";
+    return buf;
+  }
+
+  Buffer Alloc(Device dev, ffi::Shape shape, DLDataType type_hint,
+               const std::string& mem_scope) final {
+    if (AllowMemoryScope(mem_scope)) {
+      return Allocator::Alloc(dev, shape, type_hint, mem_scope);
+    }
+    TVM_FFI_THROW(InternalError) << "BuddyAllocator does not support memory scope " << mem_scope;
+    return {};
+  }
+
+  void Free(const Buffer& buffer) final {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = live_blocks_.find(buffer.data);
+    TVM_FFI_ICHECK(it != live_blocks_.end())
+        << "The buffer to free is not allocated by this BuddyAllocator";
+    requested_memory_ -= it->second.requested;
+    if (it->second.in_slab) {
+      FreeToSlabs(reinterpret_cast<uintptr_t>(buffer.data), buffer.size);
+    } else {
+      whole_block_pool_[buffer.size].push_back(buffer);
+    }
+    live_blocks_.erase(it);
+    used_memory_.fetch_sub(buffer.size, std::memory_order_relaxed);
+    VLOG(1) << "reclaim buffer " << buffer.size;
+    if (high_water_mark_ != 0 && reserved_memory_ > high_water_mark_) {
+      Trim(high_water_mark_);
+    }
+  }
+
+  void Clear() final {
+    std::lock_guard<std::mutex> lock(mu_);
+    Trim(0);
+  }
+
+  size_t UsedMemory() const final { return used_memory_.load(std::memory_order_relaxed); }
+
+  /*!
+   * \brief Set the high-water mark of the reserved memory.
+   * Free memory is released whenever the reserved memory goes above the mark.
+   * \param high_water_mark The high-water mark in bytes. Zero disables the trim.
+   */
+  void SetHighWaterMark(size_t high_water_mark) {
+    std::lock_guard<std::mutex> lock(mu_);
+    high_water_mark_ = high_water_mark;
+    if (high_water_mark_ != 0 && reserved_memory_ > high_water_mark_) {
+      Trim(high_water_mark_);
+    }
+  }
+
+  /*! \brief Get the memory and fragmentation statistics of the allocator. */
+  BuddyAllocatorStats GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    BuddyAllocatorStats stats;
+    stats.reserved_bytes = reserved_memory_;
+    stats.used_bytes = used_memory_.load(std::memory_order_relaxed);
+    stats.requested_bytes = requested_memory_;
+    stats.num_slabs = slabs_.size();
+    for (size_t order = 0; order < free_blocks_.size(); ++order) {
+      if (free_blocks_[order].empty()) continue;
+      size_t block_size = min_block_size_ << order;
+      stats.free_bytes += block_size * free_blocks_[order].size();
+      stats.num_free_blocks += free_blocks_[order].size();
+      stats.largest_free_block = std::max(stats.largest_free_block, block_size);
+    }
+    for (const auto& [size, blocks] : whole_block_pool_) {
+      if (blocks.empty()) continue;
+      stats.free_bytes += size * blocks.size();
+      stats.num_free_blocks += blocks.size();
+      stats.largest_free_block = std::max(stats.largest_free_block, size);
+    }
+    return stats;
+  }
+
+ private:
+  /*! \brief A device slab that is split into buddy blocks. */
+  struct Slab {
+    Device device;
+    size_t size;
+  };
+
+  /*! \brief The bookkeeping of a block that is handed out. */
+  struct LiveBlock {
+    /*! \brief The requested size of the block. */
+    size_t requested;
+    /*! \brief Whether the block is carved out of a slab. */
+    bool in_slab;
+  };
+
+  static bool IsPowerOfTwo(size_t value) { return value != 0 && (value & (value - 1)) == 0; }
+
+  /*! \brief Whether the data pointers of the device support address arithmetic. */
+  static bool SupportsSubAllocation(Device dev) {
+    switch (static_cast<int>(dev.device_type)) {
+      case kDLCPU:
+      case kDLCUDA:
+      case kDLCUDAHost:
+      case kDLCUDAManaged:
+      case kDLROCM:
+      case kDLROCMHost:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /*! \brief The size class of a request: a power of two up to a slab, or whole slabs beyond. */
+  size_t SizeClass(size_t nbytes) const {
+    if (nbytes > slab_size_) {
+      return (nbytes + slab_size_ - 1) / slab_size_ * slab_size_;
+    }
+    size_t size = min_block_size_;
+    while (size < nbytes) size <<= 1;
+    return size;
+  }
+
+  /*! \brief The order of a block size, i.e., log2(block_size / min_block_size). */
+  size_t Order(size_t block_size) const {
+    size_t order = 0;
+    while ((min_block_size_ << order) < block_size) ++order;
+    return order;
+  }
+
+  /*! \brief Allocate a new slab, and add it to the free list as one block. */
+  void CreateSlab(Device dev, size_t size, DLDataType type_hint) {
+    void* data = DeviceAPI::Get(dev)->AllocDataSpace(dev, size, kAllocAlignment, type_hint);
+    uintptr_t base = reinterpret_cast<uintptr_t>(data);
+    slabs_.emplace(base, Slab{dev, size});
+    free_blocks_[Order(size)].insert(base);
+    reserved_memory_ += size;
+    VLOG(1) << "create slab of " << size << " B, reserved memory " << reserved_memory_ << " B";
+  }
+
+  /*! \brief Find the slab that contains the given address. */
+  std::map<uintptr_t, Slab>::iterator FindSlab(uintptr_t addr) {
+    auto it = slabs_.upper_bound(addr);
+    TVM_FFI_ICHECK(it != slabs_.begin());
+    --it;
+    TVM_FFI_ICHECK_LT(addr, it->first + it->second.size);
+    return it;
+  }
+
+  uintptr_t AllocFromSlabs(Device dev, size_t block_size, DLDataType type_hint) {
+    size_t order = Order(block_size);
+    size_t k = order;
+    while (k < free_blocks_.size() && free_blocks_[k].empty()) ++k;
+    if (k == free_blocks_.size()) {
+      try {
+        CreateSlab(dev, slab_size_, type_hint);
+      } catch (tvm::ffi::Error& err) {
+        LOG(WARNING) << "BuddyAllocator failed to allocate a slab of " << slab_size_
+                     << " B: " << err.what();
+        LOG(WARNING) << "Trying to release unused memory and reallocate...";
+        Trim(0);
+        try {
+          CreateSlab(dev, slab_size_, type_hint);
+        } catch (tvm::ffi::Error&) {
+          CreateSlab(dev, block_size, type_hint);
+        }
+      }
+      k = order;
+      while (free_blocks_[k].empty()) ++k;
+    }
+    // Take the lowest free block to keep the upper part of the slabs free.
+    uintptr_t addr = *free_blocks_[k].begin();
+    free_blocks_[k].erase(free_blocks_[k].begin());
+    // Split the block and put the upper halves back to the free lists.
+    while (k > order) {
+      --k;
+      free_blocks_[k].insert(addr + (min_block_size_ << k));
+    }
+    return addr;
+  }
+
+  void FreeToSlabs(uintptr_t addr, size_t block_size) {
+    auto slab_it = FindSlab(addr);
+    uintptr_t base = slab_it->first;
+    size_t slab_size = slab_it->second.size;
+    size_t order = Order(block_size);
+    // Coalesce with the buddy as long as the buddy is free.
+    while (block_size < slab_size) {
+      uintptr_t buddy = base + ((addr - base) ^ block_size);
+      auto it = free_blocks_[order].find(buddy);
+      if (it == free_blocks_[order].end()) break;
+      free_blocks_[order].erase(it);
+      addr = std::min(addr, buddy);
+      block_size <<= 1;
+      ++order;
+    }
+    free_blocks_[order].insert(addr);
+  }
+
+  void* AllocWholeBlock(Device dev, size_t size, size_t alignment, DLDataType type_hint) {
+    auto it = whole_block_pool_.find(size);
+    if (it != whole_block_pool_.end()) {
+      // Only reuse a cached block on the same device with sufficient alignment.
+      std::vector<Buffer>& pool = it->second;
+      for (auto buf_it = pool.begin(); buf_it != pool.end(); ++buf_it) {
+        if (buf_it->device.device_type == dev.device_type &&
+            buf_it->device.device_id == dev.device_id &&
+            (alignment == 0 || reinterpret_cast<uintptr_t>(buf_it->data) % alignment == 0)) {
+          void* data = buf_it->data;
+          pool.erase(buf_it);
+          return data;
+        }
+      }
+    }
+    void* data;
+    try {
+      data = DeviceAPI::Get(dev)->AllocDataSpace(dev, size, alignment, type_hint);
+    } catch (tvm::ffi::Error& err) {
+      LOG(WARNING) << "BuddyAllocator failed to allocate " << size << " B: " << err.what();
+      LOG(WARNING) << "Trying to release unused memory and reallocate...";
+      Trim(0);
+      data = DeviceAPI::Get(dev)->AllocDataSpace(dev, size, alignment, type_hint);
+    }
+    reserved_memory_ += size;
+    return data;
+  }
+
+  /*!
+   * \brief Release the free memory until the reserved memory is no more than the target.
+   * Cached whole blocks are released first, and then the slabs that are entirely free.
+   */
+  void Trim(size_t target) {
+    for (auto it = whole_block_pool_.begin();
+         it != whole_block_pool_.end() && reserved_memory_ > target;) {
+      std::vector<Buffer>& pool = it->second;
+      while (!pool.empty() && reserved_memory_ > target) {
+        const Buffer& buf = pool.back();
+        DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
+        reserved_memory_ -= buf.size;
+        pool.pop_back();
+      }
+      it = pool.empty() ? whole_block_pool_.erase(it) : std::next(it);
+    }
+    for (auto it = slabs_.begin(); it != slabs_.end() && reserved_memory_ > target;) {
+      auto [base, slab] = *it;
+      std::set<uintptr_t>& free_list = free_blocks_[Order(slab.size)];
+      auto free_it = free_list.find(base);
+      if (free_it == free_list.end()) {
+        ++it;
+        continue;
+      }
+      free_list.erase(free_it);
+      DeviceAPI::Get(slab.device)->FreeDataSpace(slab.device, reinterpret_cast<void*>(base));
+      reserved_memory_ -= slab.size;
+      it = slabs_.erase(it);
+    }
+    VLOG(1) << "trim to " << target << " B, reserved memory " << reserved_memory_ << " B";
+  }
+
+  /*! \brief The size of the smallest size class. */
+  size_t min_block_size_;
+  /*! \brief The size of the device slabs. */
+  size_t slab_size_;
+  /*! \brief The high-water mark of the reserved memory. Zero means no limit. */
+  size_t high_water_mark_ = 0;
+  /*! \brief The total size of the blocks handed out. */
+  std::atomic<size_t> used_memory_;
+  /*! \brief The total size requested by the live allocations. */
+  size_t requested_memory_ = 0;
+  /*! \brief The total device memory held by the allocator. */
+  size_t reserved_memory_ = 0;
+  /*! \brief The slabs, keyed by their base address. */
+  std::map<uintptr_t, Slab> slabs_;
+  /*! \brief The free lists of the slab blocks, indexed by order and sorted by address. */
+  std::vector<std::set<uintptr_t>> free_blocks_;
+  /*! \brief The cached whole blocks, keyed by size. */
+  std::unordered_map<size_t, std::vector<Buffer>> whole_block_pool_;
+  /*! \brief The blocks handed out, keyed by data pointer. */
+  std::unordered_map<void*, LiveBlock> live_blocks_;
+  std::mutex mu_;
+};
+
+}  // namespace memory
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_MEMORY_BUDDY_ALLOCATOR_H_
@@ -22,6 +22,7 @@
  * \brief Allocate and manage memory for the runtime.
  */
 #include <tvm/ffi/cast.h>
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/logging.h>
@@ -30,6 +31,7 @@
 #include <memory>
 #include <utility>
 
+#include "buddy_allocator.h"
 #include "naive_allocator.h"
 #include "pooled_allocator.h"
 
@@ -141,6 +143,9 @@ std::string DeviceTypeStr(DLDeviceType type) {
     case kDLVulkan:
       return "vulkan";
       break;
+    case kDLCUDA:
+      return "cuda";
+      break;
     default:
       return "";
   }
@@ -164,9 +169,20 @@ Allocator* GetDeviceSpecificAllocator(Device dev, AllocatorType type) {
       }
       case kPooled: {
         VLOG(1) << "New pooled allocator for " << dev;
-        allocator = new PooledAllocator();
+        allocator = new PooledAllocator(PooledAllocator::kDefaultPageSize,
+                                        /*use_thread_cache=*/true);
+        break;
+      }
+      case kBuddy: {
+        VLOG(1) << "New buddy allocator for " << dev;
+        allocator = new BuddyAllocator();
         break;
       }
+      case kStreamOrdered: {
+        TVM_FFI_THROW(InternalError)
+            << "The stream-ordered allocator is only available on CUDA devices of a runtime "
+            << "built with CUDA 11.2 or later, but got " << dev;
+      }
       default:
         TVM_FFI_THROW(InternalError) << "Unknown allocator type: " << type;
     }
@@ -206,6 +222,11 @@ Allocator* MemoryManager::GetAllocator(Device dev, AllocatorType type) {
   return it->second.at(type).get();
 }
 
+Allocator* MemoryManager::GetOrCreatePinnedHostAllocator(Device dev) {
+  // Page-locking is expensive, so the buffers are pooled.
+  return GetOrCreateAllocator(PinnedHostDevice(dev), kPooled);
+}
+
 void MemoryManager::Clear() {
   MemoryManager* m = MemoryManager::Global();
   std::lock_guard<std::mutex> lock(m->mu_);
@@ -262,6 +283,14 @@ Buffer Allocator::Alloc(Device dev, ffi::Shape shape, DLDataType type_hint,
   return {};
 }
 
+/*! \brief Get the buddy allocator of the device, creating it if needed. */
+BuddyAllocator* GetBuddyAllocator(Device dev) {
+  auto* allocator =
+      dynamic_cast<BuddyAllocator*>(MemoryManager::GetOrCreateAllocator(dev, kBuddy));
+  TVM_FFI_ICHECK(allocator != nullptr) << "The buddy allocator of " << dev << " is overridden";
+  return allocator;
+}
+
 void Allocator::Clear() {
   // This function by default does nothing.
   // For naive allocator, no explicit manual clear is needed.
@@ -270,7 +299,44 @@ void Allocator::Clear() {
 
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
-  refl::GlobalDef().def("vm.builtin.memory_manager.clear", MemoryManager::Clear);
+  refl::GlobalDef()
+      .def("vm.builtin.memory_manager.clear", MemoryManager::Clear)
+      .def("vm.builtin.memory_manager.pooled_allocator_stats",
+           [](Device dev) {
+             auto* allocator =
+                 dynamic_cast<PooledAllocator*>(MemoryManager::GetOrCreateAllocator(dev, kPooled));
+             TVM_FFI_ICHECK(allocator != nullptr)
+                 << "The pooled allocator of " << dev << " is not a PooledAllocator";
+             PooledAllocatorStats stats = allocator->GetStats();
+             ffi::Map<ffi::String, int64_t> result;
+             result.Set("used_bytes", static_cast<int64_t>(stats.used_bytes));
+             result.Set("pooled_bytes", static_cast<int64_t>(stats.pooled_bytes));
+             result.Set("thread_cached_bytes", static_cast<int64_t>(stats.thread_cached_bytes));
+             result.Set("num_allocs", static_cast<int64_t>(stats.num_allocs));
+             result.Set("num_thread_cache_hits",
+                        static_cast<int64_t>(stats.num_thread_cache_hits));
+             result.Set("num_pool_hits", static_cast<int64_t>(stats.num_pool_hits));
+             result.Set("num_device_allocs", static_cast<int64_t>(stats.num_device_allocs));
+             result.Set("num_thread_caches", static_cast<int64_t>(stats.num_thread_caches));
+             return result;
+           })
+      .def("vm.builtin.memory_manager.buddy_allocator_set_high_water_mark",
+           [](Device dev, int64_t high_water_mark) {
+             TVM_FFI_ICHECK_GE(high_water_mark, 0);
+             GetBuddyAllocator(dev)->SetHighWaterMark(static_cast<size_t>(high_water_mark));
+           })
+      .def("vm.builtin.memory_manager.buddy_allocator_stats", [](Device dev) {
+        BuddyAllocatorStats stats = GetBuddyAllocator(dev)->GetStats();
+        ffi::Map<ffi::String, int64_t> result;
+        result.Set("reserved_bytes", static_cast<int64_t>(stats.reserved_bytes));
+        result.Set("used_bytes", static_cast<int64_t>(stats.used_bytes));
+        result.Set("requested_bytes", static_cast<int64_t>(stats.requested_bytes));
+        result.Set("free_bytes", static_cast<int64_t>(stats.free_bytes));
+        result.Set("largest_free_block", static_cast<int64_t>(stats.largest_free_block));
+        result.Set("num_slabs", static_cast<int64_t>(stats.num_slabs));
+        result.Set("num_free_blocks", static_cast<int64_t>(stats.num_free_blocks));
+        return result;
+      });
 }
 
 }  // namespace memory
@@ -26,34 +26,103 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/memory/memory_manager.h>
+#include <tvm/runtime/metrics.h>
 
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
 namespace memory {
 
+/*! \brief The statistics of a pooled allocator, aggregated over all threads. */
+struct PooledAllocatorStats {
+  /*! \brief The device memory allocated by the allocator, in bytes. */
+  size_t used_bytes = 0;
+  /*! \brief The free memory in the global pool, in bytes. */
+  size_t pooled_bytes = 0;
+  /*! \brief The free memory in the thread caches, in bytes. */
+  size_t thread_cached_bytes = 0;
+  /*! \brief The number of allocations. */
+  size_t num_allocs = 0;
+  /*! \brief The number of allocations served by the thread caches. */
+  size_t num_thread_cache_hits = 0;
+  /*! \brief The number of allocations served by the global pool. */
+  size_t num_pool_hits = 0;
+  /*! \brief The number of allocations served by the device. */
+  size_t num_device_allocs = 0;
+  /*! \brief The number of live thread caches. */
+  size_t num_thread_caches = 0;
+};
+
 class PooledAllocator : public Allocator {
  public:
   static constexpr size_t kDefaultPageSize = 4096;
+  /*! \brief The number of free buffers of one size a thread cache holds before flushing half. */
+  static constexpr size_t kThreadCacheMaxBuffersPerSize = 16;
+  /*! \brief The free memory a thread cache holds before flushing all of it. */
+  static constexpr size_t kThreadCacheMaxBytes = 256UL << 20;
 
-  explicit PooledAllocator(size_t page_size = kDefaultPageSize)
-      : Allocator(kPooled), page_size_(page_size), used_memory_(0) {}
+  /*!
+   * \param page_size The granularity of the buffer sizes.
+   * \param use_thread_cache Whether to put a per-thread free-list cache in front of the global
+   * pool, so that frees and allocations served by the cache do not take the global lock.
+   */
+  explicit PooledAllocator(size_t page_size = kDefaultPageSize, bool use_thread_cache = false)
+      : Allocator(kPooled),
+        page_size_(page_size),
+        used_memory_(0),
+        use_thread_cache_(use_thread_cache),
+        id_(NextAllocatorId().fetch_add(1, std::memory_order_relaxed)) {}
 
-  ~PooledAllocator() { ReleaseAll(); }
+  ~PooledAllocator() {
+    {
+      std::lock_guard<std::mutex> registry_lock(ThreadCacheRegistryMutex());
+      std::lock_guard<std::recursive_mutex> lock(mu_);
+      for (const std::shared_ptr<ThreadCache>& cache : thread_caches_) {
+        std::lock_guard<std::mutex> cache_lock(cache->mu);
+        MoveToPool(&cache->pool);
+        cache->owner = nullptr;
+      }
+      thread_caches_.clear();
+    }
+    ReleaseAll();
+  }
 
   Buffer Alloc(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) override {
-    std::lock_guard<std::recursive_mutex> lock(mu_);
     size_t size = ((nbytes + page_size_ - 1) / page_size_) * page_size_;
+    const GlobalMetrics& global_metrics = GetGlobalMetrics();
+    global_metrics.num_allocs->Increment();
+    global_metrics.in_use_bytes->Add(size);
+    if (use_thread_cache_) {
+      ThreadCache* cache = GetThreadCache();
+      std::lock_guard<std::mutex> cache_lock(cache->mu);
+      ++cache->num_allocs;
+      auto it = cache->pool.find(size);
+      if (it != cache->pool.end() && !it->second.empty()) {
+        Buffer ret = it->second.back();
+        it->second.pop_back();
+        cache->cached_bytes -= size;
+        ++cache->num_hits;
+        return ret;
+      }
+    }
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    if (!use_thread_cache_) {
+      ++num_allocs_;
+    }
     auto&& it = memory_pool_.find(size);
     if (it != memory_pool_.end() && !it->second.empty()) {
       auto&& pool = it->second;
       auto ret = pool.back();
       pool.pop_back();
+      ++num_pool_hits_;
       return ret;
     }
     Buffer buf;
@@ -70,6 +139,9 @@ class PooledAllocator : public Allocator {
     }
 
     used_memory_.fetch_add(size, std::memory_order_relaxed);
+    ++num_device_allocs_;
+    global_metrics.device_bytes->Add(size);
+    global_metrics.num_device_allocs->Increment();
     VLOG(1) << "allocate " << size << " B, used memory " << used_memory_ << " B";
     return buf;
   }
@@ -84,6 +156,34 @@ class PooledAllocator : public Allocator {
   }
 
   void Free(const Buffer& buffer) override {
+    GetGlobalMetrics().in_use_bytes->Add(-static_cast<int64_t>(buffer.size));
+    if (use_thread_cache_) {
+      ThreadCache* cache = GetThreadCache();
+      std::unordered_map<size_t, std::vector<Buffer>> flushed;
+      {
+        std::lock_guard<std::mutex> cache_lock(cache->mu);
+        std::vector<Buffer>& pool = cache->pool[buffer.size];
+        pool.push_back(buffer);
+        cache->cached_bytes += buffer.size;
+        if (cache->cached_bytes > kThreadCacheMaxBytes) {
+          flushed = std::move(cache->pool);
+          cache->pool.clear();
+          cache->cached_bytes = 0;
+        } else if (pool.size() > kThreadCacheMaxBuffersPerSize) {
+          // Return the older half in one batch.
+          size_t num_flushed = pool.size() / 2;
+          flushed[buffer.size].assign(pool.begin(), pool.begin() + num_flushed);
+          pool.erase(pool.begin(), pool.begin() + num_flushed);
+          cache->cached_bytes -= num_flushed * buffer.size;
+        }
+      }
+      // Never take the global lock while holding a thread cache lock.
+      if (!flushed.empty()) {
+        std::lock_guard<std::recursive_mutex> lock(mu_);
+        MoveToPool(&flushed);
+      }
+      return;
+    }
     std::lock_guard<std::recursive_mutex> lock(mu_);
     if (memory_pool_.find(buffer.size) == memory_pool_.end()) {
       memory_pool_.emplace(buffer.size, std::vector<Buffer>{});
@@ -96,6 +196,28 @@ class PooledAllocator : public Allocator {
 
   size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
 
+  /*! \brief Get the statistics of the allocator, aggregated over the global pool and threads. */
+  PooledAllocatorStats GetStats() {
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    PooledAllocatorStats stats;
+    stats.used_bytes = used_memory_.load(std::memory_order_relaxed);
+    for (const auto& [size, pool] : memory_pool_) {
+      stats.pooled_bytes += size * pool.size();
+    }
+    stats.num_allocs = num_allocs_ + retired_num_allocs_;
+    stats.num_thread_cache_hits = retired_num_thread_cache_hits_;
+    for (const std::shared_ptr<ThreadCache>& cache : thread_caches_) {
+      std::lock_guard<std::mutex> cache_lock(cache->mu);
+      stats.thread_cached_bytes += cache->cached_bytes;
+      stats.num_allocs += cache->num_allocs;
+      stats.num_thread_cache_hits += cache->num_hits;
+    }
+    stats.num_pool_hits = num_pool_hits_;
+    stats.num_device_allocs = num_device_allocs_;
+    stats.num_thread_caches = thread_caches_.size();
+    return stats;
+  }
+
  protected:
   virtual void* DeviceAllocDataSpace(Device dev, size_t nbytes, size_t alignment,
                                      DLDataType type_hint) {
@@ -108,6 +230,11 @@ class PooledAllocator : public Allocator {
 
   virtual void ReleaseAll() {
     std::lock_guard<std::recursive_mutex> lock(mu_);
+    for (const std::shared_ptr<ThreadCache>& cache : thread_caches_) {
+      std::lock_guard<std::mutex> cache_lock(cache->mu);
+      MoveToPool(&cache->pool);
+      cache->cached_bytes = 0;
+    }
     for (auto const& it : memory_pool_) {
       auto const& pool = it.second;
       for (auto const& buf : pool) {
@@ -115,15 +242,138 @@ class PooledAllocator : public Allocator {
       }
     }
     memory_pool_.clear();
+    GetGlobalMetrics().device_bytes->Add(-static_cast<int64_t>(used_memory_.load()));
     used_memory_ = 0;
     VLOG(1) << "release all buffers";
   }
 
  protected:
+  /*!
+   * \brief The free buffers cached by one thread.
+   * \note Lock order: the registry mutex, then mu_, then the cache mutex. The cache mutex is
+   * only contended when the allocator drains all caches or collects statistics.
+   */
+  struct ThreadCache {
+    std::mutex mu;
+    /*! \brief The allocator of the cache, or nullptr once the allocator is destructed. */
+    PooledAllocator* owner{nullptr};
+    std::unordered_map<size_t, std::vector<Buffer>> pool;
+    size_t cached_bytes{0};
+    size_t num_allocs{0};
+    size_t num_hits{0};
+  };
+
+  /*! \brief The thread caches of the current thread, returned to their allocators on exit. */
+  struct ThreadLocalCaches {
+    std::unordered_map<uint64_t, std::shared_ptr<ThreadCache>> caches;
+
+    ~ThreadLocalCaches() {
+      std::lock_guard<std::mutex> registry_lock(ThreadCacheRegistryMutex());
+      for (const auto& [id, cache] : caches) {
+        if (cache->owner != nullptr) {
+          cache->owner->DetachThreadCache(cache.get());
+        }
+      }
+    }
+  };
+
+  /*!
+   * \brief The metrics of all pooled allocators. The device bytes minus the bytes in use are
+   * the free memory held in the pools and the thread caches.
+   */
+  struct GlobalMetrics {
+    metrics::Gauge* device_bytes;
+    metrics::Gauge* in_use_bytes;
+    metrics::Counter* num_allocs;
+    metrics::Counter* num_device_allocs;
+  };
+
+  static const GlobalMetrics& GetGlobalMetrics() {
+    static GlobalMetrics global_metrics = [] {
+      metrics::Registry* registry = metrics::Registry::Global();
+      return GlobalMetrics{
+          registry->GetGauge("tvm_pooled_allocator_device_bytes",
+                             "Device memory held by the pooled allocators."),
+          registry->GetGauge("tvm_pooled_allocator_in_use_bytes",
+                             "Memory of the pooled allocators handed out and not freed."),
+          registry->GetCounter("tvm_pooled_allocator_allocs_total",
+                               "Allocations from the pooled allocators."),
+          registry->GetCounter("tvm_pooled_allocator_device_allocs_total",
+                               "Allocations of the pooled allocators served by the device.")};
+    }();
+    return global_metrics;
+  }
+
+  /*! \brief The mutex that guards the owner of the thread caches of all allocators. */
+  static std::mutex& ThreadCacheRegistryMutex() {
+    static std::mutex mu;
+    return mu;
+  }
+
+  static std::atomic<uint64_t>& NextAllocatorId() {
+    static std::atomic<uint64_t> next_id{0};
+    return next_id;
+  }
+
+  /*! \brief Get the cache of the current thread, creating it on first use. */
+  ThreadCache* GetThreadCache() {
+    static thread_local ThreadLocalCaches local;
+    auto it = local.caches.find(id_);
+    if (it != local.caches.end()) {
+      return it->second.get();
+    }
+    auto cache = std::make_shared<ThreadCache>();
+    cache->owner = this;
+    {
+      std::lock_guard<std::recursive_mutex> lock(mu_);
+      thread_caches_.push_back(cache);
+    }
+    local.caches.emplace(id_, cache);
+    return cache.get();
+  }
+
+  /*! \brief Return the buffers of an exiting thread to the global pool. */
+  void DetachThreadCache(ThreadCache* cache) {
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    std::lock_guard<std::mutex> cache_lock(cache->mu);
+    MoveToPool(&cache->pool);
+    retired_num_allocs_ += cache->num_allocs;
+    retired_num_thread_cache_hits_ += cache->num_hits;
+    cache->owner = nullptr;
+    for (auto it = thread_caches_.begin(); it != thread_caches_.end(); ++it) {
+      if (it->get() == cache) {
+        thread_caches_.erase(it);
+        break;
+      }
+    }
+  }
+
+  /*! \brief Move the buffers to the global pool. Requires holding mu_. */
+  void MoveToPool(std::unordered_map<size_t, std::vector<Buffer>>* buffers) {
+    for (auto& [size, pool] : *buffers) {
+      std::vector<Buffer>& global_pool = memory_pool_[size];
+      global_pool.insert(global_pool.end(), pool.begin(), pool.end());
+    }
+    buffers->clear();
+  }
+
   size_t page_size_;
   std::atomic<size_t> used_memory_;
   std::unordered_map<size_t, std::vector<Buffer>> memory_pool_;
   std::recursive_mutex mu_;
+  /*! \brief Whether the per-thread caches are enabled. */
+  bool use_thread_cache_;
+  /*! \brief The unique id of the allocator, which keys the thread caches. */
+  uint64_t id_;
+  /*! \brief The live thread caches of the allocator. */
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_;
+  /*! \brief The allocation counters, guarded by mu_. */
+  size_t num_allocs_ = 0;
+  size_t num_pool_hits_ = 0;
+  size_t num_device_allocs_ = 0;
+  /*! \brief The counters of the thread caches of exited threads, guarded by mu_. */
+  size_t retired_num_allocs_ = 0;
+  size_t retired_num_thread_cache_hits_ = 0;
 };
 
 }  // namespace memory
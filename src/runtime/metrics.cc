@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/metrics.cc
+ * \brief The process-wide registry of runtime metrics and its FFI functions.
+ */
+#include <tvm/ffi/container/map.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/metrics.h>
+
+#include <limits>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+namespace metrics {
+
+Registry* Registry::Global() {
+  // Leaked on purpose so that metrics can be updated during static destruction.
+  static Registry* inst = new Registry();
+  return inst;
+}
+
+Registry::Entry* Registry::GetEntry(const std::string& name, const std::string& help,
+                                    Kind kind) {
+  auto [it, inserted] = entries_.try_emplace(name);
+  Entry& entry = it->second;
+  if (inserted) {
+    entry.kind = kind;
+    entry.help = help;
+  }
+  TVM_FFI_CHECK(entry.kind == kind, ValueError)
+      << "The metric " << name << " is already registered as another kind of metric";
+  return &entry;
+}
+
+Counter* Registry::GetCounter(const std::string& name, const std::string& help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = GetEntry(name, help, Kind::kCounter);
+  if (entry->counter == nullptr) entry->counter = std::make_unique<Counter>();
+  return entry->counter.get();
+}
+
+Gauge* Registry::GetGauge(const std::string& name, const std::string& help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = GetEntry(name, help, Kind::kGauge);
+  if (entry->gauge == nullptr) entry->gauge = std::make_unique<Gauge>();
+  return entry->gauge.get();
+}
+
+Histogram* Registry::GetHistogram(const std::string& name, const std::string& help,
+                                  std::vector<double> bounds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry* entry = GetEntry(name, help, Kind::kHistogram);
+  if (entry->histogram == nullptr) {
+    entry->histogram = std::make_unique<Histogram>(std::move(bounds));
+  }
+  return entry->histogram.get();
+}
+
+std::string Registry::PrometheusText() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream os;
+  os.precision(std::numeric_limits<double>::max_digits10);
+  for (const auto& [name, entry] : entries_) {
+    if (!entry.help.empty()) {
+      os << "# HELP " << name << " " << entry.help << "\n";
+    }
+    switch (entry.kind) {
+      case Kind::kCounter:
+        os << "# TYPE " << name << " counter\n" << name << " " << entry.counter->Value() << "\n";
+        break;
+      case Kind::kGauge:
+        os << "# TYPE " << name << " gauge\n" << name << " " << entry.gauge->Value() << "\n";
+        break;
+      case Kind::kHistogram: {
+        const Histogram& histogram = *entry.histogram;
+        os << "# TYPE " << name << " histogram\n";
+        // The bucket counts are cumulative in the exposition format.
+        int64_t count = 0;
+        for (size_t i = 0; i < histogram.bounds().size(); ++i) {
+          count += histogram.BucketCount(i);
+          os << name << "_bucket{le=\"" << histogram.bounds()[i] << "\"} " << count << "\n";
+        }
+        count += histogram.BucketCount(histogram.bounds().size());
+        os << name << "_bucket{le=\"+Inf\"} " << count << "\n";
+        os << name << "_sum " << histogram.Sum() << "\n";
+        os << name << "_count " << count << "\n";
+        break;
+      }
+    }
+  }
+  return os.str();
+}
+
+std::map<std::string, double> Registry::Snapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, double> values;
+  for (const auto& [name, entry] : entries_) {
+    switch (entry.kind) {
+      case Kind::kCounter:
+        values[name] = static_cast<double>(entry.counter->Value());
+        break;
+      case Kind::kGauge:
+        values[name] = static_cast<double>(entry.gauge->Value());
+        break;
+      case Kind::kHistogram:
+        values[name + "_count"] = static_cast<double>(entry.histogram->Count());
+        values[name + "_sum"] = entry.histogram->Sum();
+        break;
+    }
+  }
+  return values;
+}
+
+}  // namespace metrics
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("runtime.MetricsPrometheusText",
+           []() { return metrics::Registry::Global()->PrometheusText(); })
+      .def("runtime.MetricsSnapshot",
+           []() {
+             ffi::Map<ffi::String, double> values;
+             for (const auto& [name, value] : metrics::Registry::Global()->Snapshot()) {
+               values.Set(name, value);
+             }
+             return values;
+           })
+      .def("runtime.MetricsIncrement",
+           [](const std::string& name, int64_t delta) {
+             metrics::Registry::Global()->GetCounter(name)->Increment(delta);
+           })
+      .def("runtime.MetricsSetGauge",
+           [](const std::string& name, int64_t value) {
+             metrics::Registry::Global()->GetGauge(name)->Set(value);
+           })
+      .def("runtime.MetricsObserve", [](const std::string& name, double value) {
+        metrics::Registry::Global()->GetHistogram(name)->Observe(value);
+      });
+}
+
+}  // namespace runtime
+}  // namespace tvm
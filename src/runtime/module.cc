@@ -84,6 +84,9 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   TVM_INIT_CONTEXT_FUNC(TVMBackendFreeWorkspace);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelLaunch);
   TVM_INIT_CONTEXT_FUNC(TVMBackendParallelBarrier);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendProfileStart);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendProfileEnd);
+  TVM_INIT_CONTEXT_FUNC(TVMBackendSelectISAVariant);
 
   refl::GlobalDef().def("runtime.RuntimeEnabled", RuntimeEnabled);
 }
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rpc_compression.cc
+ * \brief Compression of the tensor copies of the RPC, and the server functions that copy
+ *  compressed payloads into and out of the tensors of the server.
+ */
+#include "rpc_compression.h"
+
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/ffi/string.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/tensor.h>
+
+#include <cstring>
+#include <vector>
+
+#ifdef TVM_USE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+
+RPCCompressionCodec RPCCompressionCodecFromString(const std::string& name) {
+  if (name == "none") return RPCCompressionCodec::kNone;
+  if (name == "zstd") return RPCCompressionCodec::kZstd;
+  TVM_FFI_THROW(ValueError) << "Unknown RPC compression codec \"" << name
+                            << "\", expected \"none\" or \"zstd\"";
+}
+
+bool RPCCompressionSupported(RPCCompressionCodec codec) {
+  switch (codec) {
+    case RPCCompressionCodec::kNone:
+      return true;
+    case RPCCompressionCodec::kZstd:
+#ifdef TVM_USE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+std::string RPCCompressPayload(RPCCompressionCodec codec, const void* data, size_t nbytes) {
+  std::string payload;
+#ifdef TVM_USE_ZSTD
+  if (codec == RPCCompressionCodec::kZstd) {
+    payload.resize(1 + ZSTD_compressBound(nbytes));
+    size_t size =
+        ZSTD_compress(&payload[1], payload.size() - 1, data, nbytes, ZSTD_CLEVEL_DEFAULT);
+    TVM_FFI_ICHECK(!ZSTD_isError(size)) << "zstd compression failed: " << ZSTD_getErrorName(size);
+    if (size < nbytes) {
+      payload[0] = static_cast<char>(RPCCompressionCodec::kZstd);
+      payload.resize(1 + size);
+      return payload;
+    }
+  }
+#endif
+  // The bytes do not compress, send them raw.
+  payload.resize(1 + nbytes);
+  payload[0] = static_cast<char>(RPCCompressionCodec::kNone);
+  std::memcpy(&payload[1], data, nbytes);
+  return payload;
+}
+
+void RPCDecompressPayload(const char* payload, size_t payload_nbytes, void* out, size_t nbytes) {
+  TVM_FFI_ICHECK_GE(payload_nbytes, 1U) << "Empty RPC copy payload";
+  auto codec = static_cast<RPCCompressionCodec>(payload[0]);
+  const char* data = payload + 1;
+  size_t data_nbytes = payload_nbytes - 1;
+  if (codec == RPCCompressionCodec::kNone) {
+    TVM_FFI_ICHECK_EQ(data_nbytes, nbytes) << "RPC copy payload size mismatch";
+    std::memcpy(out, data, nbytes);
+    return;
+  }
+#ifdef TVM_USE_ZSTD
+  if (codec == RPCCompressionCodec::kZstd) {
+    size_t size = ZSTD_decompress(out, nbytes, data, data_nbytes);
+    TVM_FFI_ICHECK(!ZSTD_isError(size))
+        << "zstd decompression failed: " << ZSTD_getErrorName(size);
+    TVM_FFI_ICHECK_EQ(size, nbytes) << "RPC copy payload size mismatch";
+    return;
+  }
+#endif
+  TVM_FFI_THROW(InternalError) << "Unsupported RPC compression codec "
+                               << static_cast<int>(codec);
+}
+
+namespace {
+
+/*! \brief A flat byte view of `*nbytes` bytes of a tensor, from its byte offset. */
+DLTensor ByteView(const DLTensor* tensor, int64_t* nbytes) {
+  DLTensor view = *tensor;
+  view.ndim = 1;
+  view.dtype = DLDataType{kDLUInt, 8, 1};
+  view.shape = nbytes;
+  view.strides = nullptr;
+  return view;
+}
+
+void CopyCompressedToRemote(DLTensor* to, ffi::Bytes payload, int64_t nbytes) {
+  if (to->device.device_type == kDLCPU) {
+    char* dst = static_cast<char*>(to->data) + to->byte_offset;
+    RPCDecompressPayload(payload.data(), payload.size(), dst, nbytes);
+    return;
+  }
+  std::vector<char> host(nbytes);
+  RPCDecompressPayload(payload.data(), payload.size(), host.data(), nbytes);
+  DLTensor src = ByteView(to, &nbytes);
+  src.data = host.data();
+  src.device = Device{kDLCPU, 0};
+  src.byte_offset = 0;
+  DLTensor dst = ByteView(to, &nbytes);
+  Tensor::CopyFromTo(&src, &dst, nullptr);
+  DeviceAPI::Get(to->device)->StreamSync(to->device, nullptr);
+}
+
+ffi::Bytes CopyCompressedFromRemote(DLTensor* from, int64_t codec, int64_t nbytes) {
+  auto compression_codec = static_cast<RPCCompressionCodec>(codec);
+  if (from->device.device_type == kDLCPU) {
+    const char* src = static_cast<const char*>(from->data) + from->byte_offset;
+    return ffi::Bytes(RPCCompressPayload(compression_codec, src, nbytes));
+  }
+  std::vector<char> host(nbytes);
+  DLTensor src = ByteView(from, &nbytes);
+  DLTensor dst = ByteView(from, &nbytes);
+  dst.data = host.data();
+  dst.device = Device{kDLCPU, 0};
+  dst.byte_offset = 0;
+  Tensor::CopyFromTo(&src, &dst, nullptr);
+  DeviceAPI::Get(from->device)->StreamSync(from->device, nullptr);
+  return ffi::Bytes(RPCCompressPayload(compression_codec, host.data(), nbytes));
+}
+
+}  // namespace
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("tvm.rpc.server.SupportsCompression",
+           [](int64_t codec) {
+             return RPCCompressionSupported(static_cast<RPCCompressionCodec>(codec));
+           })
+      .def("tvm.rpc.server.CopyCompressedToRemote", CopyCompressedToRemote)
+      .def("tvm.rpc.server.CopyCompressedFromRemote", CopyCompressedFromRemote);
+}
+
+}  // namespace runtime
+}  // namespace tvm
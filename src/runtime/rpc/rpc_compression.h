@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rpc_compression.h
+ * \brief Compression of the tensor copies of the RPC.
+ *
+ *  A compressed copy goes through the server functions registered in rpc_compression.cc
+ *  instead of the copy messages of the protocol, so a client finds out whether the server
+ *  supports a codec by looking the functions up, and talks to older servers unchanged.
+ *  A payload starts with the byte of the codec it is encoded with, which is kNone when the
+ *  codec does not make the bytes smaller.
+ */
+#ifndef TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
+#define TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The codec of a compressed RPC copy. */
+enum class RPCCompressionCodec : int {
+  kNone = 0,
+  kZstd = 1,
+};
+
+/*! \brief The copies below this size are sent raw by default. */
+constexpr int64_t kRPCCompressionMinBytesDefault = 64 << 10;
+
+/*!
+ * \brief Parse the name of a codec.
+ * \param name "none" or "zstd".
+ * \return The codec.
+ */
+RPCCompressionCodec RPCCompressionCodecFromString(const std::string& name);
+
+/*!
+ * \brief Whether this build supports a codec.
+ * \param codec The codec.
+ * \return Whether the codec is supported.
+ */
+bool RPCCompressionSupported(RPCCompressionCodec codec);
+
+/*!
+ * \brief Encode bytes into a payload.
+ * \param codec The codec to try, the payload is raw when it does not help.
+ * \param data The bytes.
+ * \param nbytes The number of bytes.
+ * \return The payload, starting with the byte of the codec used.
+ */
+std::string RPCCompressPayload(RPCCompressionCodec codec, const void* data, size_t nbytes);
+
+/*!
+ * \brief Decode a payload.
+ * \param payload The payload, starting with the byte of its codec.
+ * \param payload_nbytes The size of the payload.
+ * \param out The buffer of the decoded bytes.
+ * \param nbytes The number of decoded bytes, which must match the payload.
+ */
+void RPCDecompressPayload(const char* payload, size_t payload_nbytes, void* out, size_t nbytes);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
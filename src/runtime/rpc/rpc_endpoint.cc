@@ -27,6 +27,7 @@
 #include <tvm/ffi/function.h>
 #include <tvm/runtime/base.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/runtime/tensor.h>
 #include <tvm/support/serializer.h>
 
 #include <algorithm>
@@ -34,6 +35,7 @@
 #include <chrono>
 #include <cmath>
 #include <memory>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -42,6 +44,7 @@
 #include "../../support/arena.h"
 #include "../../support/ring_buffer.h"
 #include "../../support/utils.h"
+#include "rpc_compression.h"
 #include "rpc_local_session.h"
 
 namespace tvm {
@@ -347,6 +350,8 @@ class RPCEndpoint::EventHandler : public support::Stream {
   support::Arena arena_;
   // internal arena for temp objects
   std::vector<ffi::Any> any_arena_;
+  // Pinned double buffer of the device copies, kept across requests.
+  ffi::Optional<Tensor> staging_buffer_;
 
   // State switcher
   void SwitchToState(State state) {
@@ -509,6 +514,14 @@ class RPCEndpoint::EventHandler : public support::Stream {
     if (arr->device.device_type == kDLCPU && sess->IsLocalSession() && TVM_FFI_IO_NO_ENDIAN_SWAP) {
       char* data_ptr = reinterpret_cast<char*>(arr->data) + arr->byte_offset;
       fcopyack(data_ptr, data_bytes);
+    } else if (DLTensor* staging = GetPinnedStaging(sess, arr->device)) {
+      // Stream the device memory into the writer without staging the whole tensor.
+      RPCCode code = RPCCode::kCopyAck;
+      uint64_t packet_nbytes = sizeof(code) + data_bytes;
+      this->Write(packet_nbytes);
+      this->Write(code);
+      this->StreamFromDevice(arr, data_bytes, staging);
+      this->SwitchToState(kRecvPacketNumBytes);
     } else {
       char* temp_data = this->ArenaAlloc<char>(data_bytes);
       auto on_copy_complete = [this, elem_bytes, data_bytes, temp_data, fcopyack](
@@ -548,6 +561,11 @@ class RPCEndpoint::EventHandler : public support::Stream {
       }
       this->ReturnVoid();
       this->SwitchToState(kRecvPacketNumBytes);
+    } else if (DLTensor* staging = GetPinnedStaging(sess, arr->device)) {
+      // Stream the received bytes into the device without staging the whole tensor.
+      this->StreamToDevice(arr, data_bytes, staging);
+      this->ReturnVoid();
+      this->SwitchToState(kRecvPacketNumBytes);
     } else {
       char* temp_data = this->ArenaAlloc<char>(data_bytes);
       this->ReadArray(temp_data, data_bytes);
@@ -571,6 +589,92 @@ class RPCEndpoint::EventHandler : public support::Stream {
     }
   }
 
+  // The size of each half of the pinned staging buffer.
+  static constexpr uint64_t kStreamChunkBytes = 4 << 20;
+
+  /*!
+   * \brief Get the pinned staging buffer to stream a copy of the served session to or from
+   *  `device` through, or nullptr when the copy needs to go through the session.
+   */
+  DLTensor* GetPinnedStaging(RPCSession* sess, Device device) {
+    if (!sess->IsLocalSession() || !TVM_FFI_IO_NO_ENDIAN_SWAP) return nullptr;
+    if (device.device_type != kDLCUDA && device.device_type != kDLROCM) return nullptr;
+    Device host{device.device_type == kDLROCM ? kDLROCMHost : kDLCUDAHost, 0};
+    if (DeviceAPI::Get(host, /*allow_missing=*/true) == nullptr) return nullptr;
+    if (!staging_buffer_.has_value() ||
+        staging_buffer_.value()->device.device_type != host.device_type) {
+      staging_buffer_ = Tensor::Empty({2 * static_cast<int64_t>(kStreamChunkBytes)},
+                                      DLDataType{kDLUInt, 8, 1}, host);
+    }
+    return const_cast<DLTensor*>(staging_buffer_.value().operator->());
+  }
+
+  /*! \brief A flat byte view of `*nbytes` bytes at `byte_offset` of `data`. */
+  static DLTensor ByteView(void* data, Device device, uint64_t byte_offset, int64_t* nbytes) {
+    DLTensor view;
+    view.data = data;
+    view.device = device;
+    view.ndim = 1;
+    view.dtype = DLDataType{kDLUInt, 8, 1};
+    view.shape = nbytes;
+    view.strides = nullptr;
+    view.byte_offset = byte_offset;
+    return view;
+  }
+
+  /*!
+   * \brief Copy `nbytes` from the reader to `arr` through the two halves of the staging
+   *  buffer, so that draining the reader into one half overlaps with the transfer out of the
+   *  other half.
+   */
+  void StreamToDevice(DLTensor* arr, uint64_t nbytes, DLTensor* staging) {
+    DeviceAPI* device_api = DeviceAPI::Get(arr->device);
+    uint64_t chunk = 0;
+    for (uint64_t offset = 0; offset < nbytes; offset += kStreamChunkBytes, ++chunk) {
+      int64_t size = std::min(kStreamChunkBytes, nbytes - offset);
+      uint64_t half_offset = (chunk % 2) * kStreamChunkBytes;
+      if (chunk >= 2) {
+        // wait for the transfer out of this half two chunks ago
+        device_api->StreamSync(arr->device, nullptr);
+      }
+      this->ReadArray(static_cast<char*>(staging->data) + half_offset, size);
+      DLTensor src = ByteView(staging->data, staging->device, half_offset, &size);
+      DLTensor dst = ByteView(arr->data, arr->device, arr->byte_offset + offset, &size);
+      Tensor::CopyFromTo(&src, &dst, nullptr);
+    }
+    device_api->StreamSync(arr->device, nullptr);
+  }
+
+  /*!
+   * \brief Copy `nbytes` from `arr` to the writer through the two halves of the staging
+   *  buffer, so that the transfer into one half overlaps with writing out the other half.
+   */
+  void StreamFromDevice(DLTensor* arr, uint64_t nbytes, DLTensor* staging) {
+    DeviceAPI* device_api = DeviceAPI::Get(arr->device);
+    uint64_t num_chunks = (nbytes + kStreamChunkBytes - 1) / kStreamChunkBytes;
+    auto start_transfer = [&](uint64_t chunk) {
+      uint64_t offset = chunk * kStreamChunkBytes;
+      int64_t size = std::min(kStreamChunkBytes, nbytes - offset);
+      DLTensor src = ByteView(arr->data, arr->device, arr->byte_offset + offset, &size);
+      DLTensor dst = ByteView(staging->data, staging->device, (chunk % 2) * kStreamChunkBytes,
+                              &size);
+      Tensor::CopyFromTo(&src, &dst, nullptr);
+    };
+    if (num_chunks != 0) {
+      start_transfer(0);
+      device_api->StreamSync(arr->device, nullptr);
+    }
+    for (uint64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      if (chunk + 1 < num_chunks) {
+        start_transfer(chunk + 1);
+      }
+      uint64_t offset = chunk * kStreamChunkBytes;
+      this->WriteArray(static_cast<char*>(staging->data) + (chunk % 2) * kStreamChunkBytes,
+                       std::min(kStreamChunkBytes, nbytes - offset));
+      device_api->StreamSync(arr->device, nullptr);
+    }
+  }
+
   // Handle for packed call.
   void HandleNormalCallFunc() {
     uint64_t call_handle;
@@ -776,6 +880,7 @@ void RPCEndpoint::Init() {
     std::lock_guard<std::mutex> lock(mutex_);
     RPCCode code = static_cast<RPCCode>(all_args[0].cast<int>());
     ffi::PackedArgs args = all_args.Slice(1);
+    WaitForPendingReturns();
 
     // run transmission
     uint64_t packet_nbytes =
@@ -900,6 +1005,7 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, ffi::PackedArgs args,
   std::lock_guard<std::mutex> lock(mutex_);
 
   handler_->ValidateArguments(args);
+  WaitForPendingReturns();
   RPCCode code = RPCCode::kCallFunc;
   uint64_t handle = reinterpret_cast<uint64_t>(h);
 
@@ -928,12 +1034,21 @@ void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes)
   uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(to, code, nbytes);
   uint64_t packet_nbytes = overhead + nbytes;
 
+  if (pipelined_ && num_pending_returns_ == kMaxPendingReturns) {
+    WaitForPendingReturns();
+  }
   handler_->Write(packet_nbytes);
   handler_->Write(code);
   RPCReference::SendDLTensor(handler_, to);
   handler_->Write(nbytes);
   handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
-  TVM_FFI_ICHECK(HandleUntilReturnEvent(true, [](ffi::PackedArgs) {}) == RPCCode::kReturn);
+  if (pipelined_) {
+    // The reply is checked by the next request that waits, as replies arrive in order.
+    FlushWriter();
+    ++num_pending_returns_;
+  } else {
+    TVM_FFI_ICHECK(HandleUntilReturnEvent(true, [](ffi::PackedArgs) {}) == RPCCode::kReturn);
+  }
 }
 
 void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
@@ -947,6 +1062,7 @@ void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes
 
   uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(from, code, nbytes);
   uint64_t packet_nbytes = overhead;
+  WaitForPendingReturns();
 
   handler_->Write(packet_nbytes);
   handler_->Write(code);
@@ -958,6 +1074,39 @@ void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes
   handler_->FinishCopyAck();
 }
 
+void RPCEndpoint::SetPipelined(bool pipelined) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pipelined) {
+    WaitForPendingReturns();
+  }
+  pipelined_ = pipelined;
+}
+
+void RPCEndpoint::FlushWriter() {
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [this](const void* data, size_t size) { return channel_->Send(data, size); },
+        writer_.bytes_available());
+  }
+}
+
+void RPCEndpoint::WaitForPendingReturns() {
+  // Keep reading after an error, so that the replies of later requests are not taken
+  // for the reply of the next one.
+  std::optional<ffi::Error> first_error;
+  for (; num_pending_returns_ != 0; --num_pending_returns_) {
+    try {
+      RPCCode code = HandleUntilReturnEvent(true, [](ffi::PackedArgs) {});
+      TVM_FFI_ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
+    } catch (const ffi::Error& err) {
+      if (!first_error.has_value()) first_error = err;
+    }
+  }
+  if (first_error.has_value()) {
+    throw first_error.value();
+  }
+}
+
 // SysCallEventHandler functions
 void RPCGetGlobalFunc(RPCSession* handler, ffi::PackedArgs args, ffi::Any* rv) {
   auto name = args[0].cast<std::string>();
@@ -1126,7 +1275,43 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
     endpoint_->CallFunc(func, args, fencode_return);
   }
 
+  void SetPipelined(bool pipelined) final { endpoint_->SetPipelined(pipelined); }
+
+  bool SetCompression(const std::string& codec, int64_t min_bytes) final {
+    RPCCompressionCodec compression_codec = RPCCompressionCodecFromString(codec);
+    compression_codec_ = RPCCompressionCodec::kNone;
+    compression_min_bytes_ = min_bytes;
+    if (compression_codec == RPCCompressionCodec::kNone) return false;
+    TVM_FFI_CHECK(RPCCompressionSupported(compression_codec), ValueError)
+        << "RPC compression with " << codec << " requires building TVM with USE_ZSTD";
+    // Older servers do not have the compressed copies, keep copying raw with them.
+    PackedFuncHandle supports = GetFunction("tvm.rpc.server.SupportsCompression");
+    if (supports == nullptr) return false;
+    bool supported = false;
+    ffi::AnyView packed_args[1] = {static_cast<int64_t>(compression_codec)};
+    CallFunc(supports, ffi::PackedArgs(packed_args, 1),
+             [&supported](ffi::PackedArgs args) { supported = args[1].cast<bool>(); });
+    if (!supported) return false;
+    copy_compressed_to_remote_ = GetFunction("tvm.rpc.server.CopyCompressedToRemote");
+    copy_compressed_from_remote_ = GetFunction("tvm.rpc.server.CopyCompressedFromRemote");
+    compression_codec_ = compression_codec;
+    return true;
+  }
+
+  ffi::Map<ffi::String, int64_t> GetTransferStats() final {
+    return {{"logical_bytes", logical_bytes_}, {"wire_bytes", wire_bytes_}};
+  }
+
   void CopyToRemote(void* local_from_bytes, DLTensor* remote_to, uint64_t nbytes) final {
+    if (UseCompression(nbytes)) {
+      ffi::Bytes payload(RPCCompressPayload(compression_codec_, local_from_bytes, nbytes));
+      ffi::AnyView packed_args[3] = {remote_to, payload, static_cast<int64_t>(nbytes)};
+      CallFunc(copy_compressed_to_remote_, ffi::PackedArgs(packed_args, 3),
+               [](ffi::PackedArgs args) {});
+      RecordTransfer(nbytes, payload.size());
+      return;
+    }
+    RecordTransfer(nbytes, nbytes);
     RPCCode code = RPCCode::kCopyToRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_to, code, nbytes);
     uint64_t rpc_max_size = GetRPCMaxTransferSize();
@@ -1153,6 +1338,17 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   }
 
   void CopyFromRemote(DLTensor* remote_from, void* local_to_bytes, uint64_t nbytes) final {
+    if (UseCompression(nbytes)) {
+      ffi::AnyView packed_args[3] = {remote_from, static_cast<int64_t>(compression_codec_),
+                                     static_cast<int64_t>(nbytes)};
+      ffi::Bytes payload;
+      CallFunc(copy_compressed_from_remote_, ffi::PackedArgs(packed_args, 3),
+               [&payload](ffi::PackedArgs args) { payload = args[1].cast<ffi::Bytes>(); });
+      RPCDecompressPayload(payload.data(), payload.size(), local_to_bytes, nbytes);
+      RecordTransfer(nbytes, payload.size());
+      return;
+    }
+    RecordTransfer(nbytes, nbytes);
     RPCCode code = RPCCode::kCopyFromRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_from, code, nbytes);
     uint64_t rpc_max_size = GetRPCMaxTransferSize();
@@ -1273,8 +1469,30 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
     return (uint64_t)rpc_chunk_max_size_bytes_;
   }
 
+  bool UseCompression(uint64_t nbytes) {
+    // The compressed copies are not split into blocks, so they need an unbounded packet size.
+    return compression_codec_ != RPCCompressionCodec::kNone &&
+           nbytes >= static_cast<uint64_t>(compression_min_bytes_) &&
+           GetRPCMaxTransferSize() == kRPCMaxTransferSizeBytesDefault;
+  }
+
+  void RecordTransfer(uint64_t logical_bytes, uint64_t wire_bytes) {
+    logical_bytes_ += logical_bytes;
+    wire_bytes_ += wire_bytes;
+  }
+
   std::shared_ptr<RPCEndpoint> endpoint_;
   int64_t rpc_chunk_max_size_bytes_ = -1;
+  // The codec of the copies, kNone when they are not compressed.
+  RPCCompressionCodec compression_codec_ = RPCCompressionCodec::kNone;
+  // The smallest copy to compress.
+  int64_t compression_min_bytes_ = kRPCCompressionMinBytesDefault;
+  // The server functions of the compressed copies.
+  PackedFuncHandle copy_compressed_to_remote_ = nullptr;
+  PackedFuncHandle copy_compressed_from_remote_ = nullptr;
+  // The logical bytes of the copies, and their payload bytes in the transport.
+  int64_t logical_bytes_ = 0;
+  int64_t wire_bytes_ = 0;
 };
 
 std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> endpoint) {
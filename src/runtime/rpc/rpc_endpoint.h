@@ -65,7 +65,7 @@ enum class TrackerCode : int {
  * \brief Communication endpoints to connect local and remote RPC sessions.
  *        An endpoint can either be a client or a server.
  */
-class RPCEndpoint {
+class TVM_RUNTIME_DLL RPCEndpoint {
  public:
   /*! \brief virtual destructor
    * Closes the connection if the connection hasn't already been closed.
@@ -159,6 +159,18 @@ class RPCEndpoint {
    * \param type_hint Hint of content data type.
    */
   void CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes);
+  /*!
+   * \brief Enter or leave the pipelined mode.
+   *
+   *  In the pipelined mode, CopyToRemote sends its request without waiting for the reply, so
+   *  that a sequence of uploads costs a single round trip. The server handles the requests in
+   *  order, so the pending replies are read before the reply of the next request that waits,
+   *  which also raises the first error of the pending requests. Leaving the mode waits for the
+   *  pending replies.
+   *
+   * \param pipelined Whether to enter the pipelined mode.
+   */
+  void SetPipelined(bool pipelined);
 
   /*!
    * \brief Call a remote defined system function with arguments.
@@ -186,6 +198,10 @@ class RPCEndpoint {
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
+  // Read the replies of the requests sent in the pipelined mode, throwing the first error.
+  void WaitForPendingReturns();
+  // Send all the bytes in the writer.
+  void FlushWriter();
   // Initalization
   void Init();
   // Internal channel.
@@ -205,6 +221,13 @@ class RPCEndpoint {
   std::string remote_key_;
   // Invoked when the RPC session is terminated
   ffi::TypedFunction<void()> fcleanup_;
+  // The most requests whose replies are pending, which bounds the replies queued in the
+  // channel while the client is still sending.
+  static constexpr int kMaxPendingReturns = 64;
+  // Whether requests are pipelined.
+  bool pipelined_{false};
+  // The number of requests whose replies are pending.
+  int num_pending_returns_{0};
 };
 
 /*!
@@ -212,7 +235,8 @@ class RPCEndpoint {
  * \param endpoint The endpoint.
  * \return The created session.
  */
-std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> endpoint);
+TVM_RUNTIME_DLL std::shared_ptr<RPCSession> CreateClientSession(
+    std::shared_ptr<RPCEndpoint> endpoint);
 
 // implementation of inline functions
 template <typename... Args>
@@ -217,7 +217,8 @@ class RPCModuleNode final : public ffi::ModuleObj {
   ffi::Function GetTimeEvaluator(const std::string& name, Device dev, int number, int repeat,
                                  int min_repeat_ms, int limit_zero_time_iterations,
                                  int cooldown_interval_ms, int repeats_to_cooldown,
-                                 int cache_flush_bytes, const std::string& f_preproc_name) {
+                                 int cache_flush_bytes, const std::string& f_preproc_name,
+                                 double max_relative_ci, bool cold) {
     InitRemoteFunc(&remote_get_time_evaluator_, "runtime.RPCTimeEvaluator");
     // Remove session mask because we pass dev by parts.
     TVM_FFI_CHECK_EQ(GetRPCSessionIndex(dev), sess_->table_index(), ValueError)
@@ -228,12 +229,13 @@ class RPCModuleNode final : public ffi::ModuleObj {
       return remote_get_time_evaluator_(
           ffi::GetRef<ffi::Module>(this), name, static_cast<int>(dev.device_type), dev.device_id,
           number, repeat, min_repeat_ms, limit_zero_time_iterations, cooldown_interval_ms,
-          repeats_to_cooldown, cache_flush_bytes, f_preproc_name);
+          repeats_to_cooldown, cache_flush_bytes, f_preproc_name, max_relative_ci, cold);
     } else {
       return remote_get_time_evaluator_(
           ffi::Optional<ffi::Module>(std::nullopt), name, static_cast<int>(dev.device_type),
           dev.device_id, number, repeat, min_repeat_ms, limit_zero_time_iterations,
-          cooldown_interval_ms, repeats_to_cooldown, cache_flush_bytes, f_preproc_name);
+          cooldown_interval_ms, repeats_to_cooldown, cache_flush_bytes, f_preproc_name,
+          max_relative_ci, cold);
     }
   }
 
@@ -273,7 +275,7 @@ class RPCModuleNode final : public ffi::ModuleObj {
   std::shared_ptr<RPCSession> sess_;
   // remote function to get time evaluator
   ffi::TypedFunction<ffi::Function(ffi::Optional<ffi::Module>, std::string, int, int, int, int, int,
-                                   int, int, int, int, std::string)>
+                                   int, int, int, int, std::string, double, bool)>
       remote_get_time_evaluator_;
   // remote function getter for modules.
   ffi::TypedFunction<ffi::Function(ffi::Module, std::string, bool)> remote_mod_get_function_;
@@ -411,7 +413,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
            [](ffi::Optional<ffi::Module> opt_mod, std::string name, int device_type, int device_id,
               int number, int repeat, int min_repeat_ms, int limit_zero_time_iterations,
               int cooldown_interval_ms, int repeats_to_cooldown, int cache_flush_bytes,
-              std::string f_preproc_name) {
+              std::string f_preproc_name, double max_relative_ci, bool cold) {
              Device dev;
              dev.device_type = static_cast<DLDeviceType>(device_type);
              dev.device_id = device_id;
@@ -422,7 +424,8 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                  return static_cast<RPCModuleNode*>(m.operator->())
                      ->GetTimeEvaluator(name, dev, number, repeat, min_repeat_ms,
                                         limit_zero_time_iterations, cooldown_interval_ms,
-                                        repeats_to_cooldown, cache_flush_bytes, f_preproc_name);
+                                        repeats_to_cooldown, cache_flush_bytes, f_preproc_name,
+                                        max_relative_ci, cold);
                } else {
                  ffi::Function f_preproc;
                  if (!f_preproc_name.empty()) {
@@ -436,7 +439,8 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                      << "Cannot find " << name << "` in the global registry";
                  return WrapTimeEvaluator(*pf, dev, number, repeat, min_repeat_ms,
                                           limit_zero_time_iterations, cooldown_interval_ms,
-                                          repeats_to_cooldown, cache_flush_bytes, f_preproc);
+                                          repeats_to_cooldown, cache_flush_bytes, f_preproc,
+                                          max_relative_ci, cold);
                }
              } else {
                auto pf = tvm::ffi::Function::GetGlobal(name);
@@ -451,7 +455,8 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                }
                return WrapTimeEvaluator(*pf, dev, number, repeat, min_repeat_ms,
                                         limit_zero_time_iterations, cooldown_interval_ms,
-                                        repeats_to_cooldown, cache_flush_bytes, f_preproc);
+                                        repeats_to_cooldown, cache_flush_bytes, f_preproc,
+                                        max_relative_ci, cold);
              }
            })
       .def_packed("cache_flush_cpu_non_first_arg",
@@ -493,6 +498,16 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     TVM_FFI_ICHECK_EQ(tkey, "rpc");
                     *rv = static_cast<RPCModuleNode*>(m.operator->())->sess()->table_index();
                   })
+      .def("rpc.SessionSetPipelined",
+           [](ffi::Module sess, bool pipelined) {
+             RPCModuleGetSession(sess)->SetPipelined(pipelined);
+           })
+      .def("rpc.SessionSetCompression",
+           [](ffi::Module sess, ffi::String codec, int64_t min_bytes) {
+             return RPCModuleGetSession(sess)->SetCompression(codec, min_bytes);
+           })
+      .def("rpc.SessionGetTransferStats",
+           [](ffi::Module sess) { return RPCModuleGetSession(sess)->GetTransferStats(); })
       .def("tvm.rpc.TensorFromRemoteOpaqueHandle",
            [](ffi::Module mod, void* remote_array, DLTensor* template_tensor, Device dev,
               void* tensor_handle) -> Tensor {
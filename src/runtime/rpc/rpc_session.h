@@ -24,6 +24,7 @@
 #ifndef TVM_RUNTIME_RPC_RPC_SESSION_H_
 #define TVM_RUNTIME_RPC_RPC_SESSION_H_
 
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/extra/module.h>
 #include <tvm/ffi/function.h>
 #include <tvm/runtime/device_api.h>
@@ -184,6 +185,33 @@ class RPCSession {
    */
   virtual bool IsLocalSession() const = 0;
 
+  /*!
+   * \brief Enter or leave the pipelined mode, in which copies to the remote do not wait for
+   *  their replies, and report their errors at the next request that waits.
+   *
+   *  Sessions without a round trip to hide ignore it.
+   *
+   * \param pipelined Whether to enter the pipelined mode.
+   */
+  virtual void SetPipelined(bool pipelined) {}
+
+  /*!
+   * \brief Compress the copies of at least min_bytes with the given codec, when both ends
+   *  support it. Sessions without a transport to save ignore it.
+   *
+   * \param codec The name of the codec, "none" to stop compressing.
+   * \param min_bytes The smallest copy to compress.
+   * \return Whether the copies are compressed.
+   */
+  virtual bool SetCompression(const std::string& codec, int64_t min_bytes) { return false; }
+
+  /*!
+   * \brief The statistics of the tensor copies of the session.
+   * \return The logical bytes of the copies in "logical_bytes", and the payload bytes they
+   *  took in the transport in "wire_bytes".
+   */
+  virtual ffi::Map<ffi::String, int64_t> GetTransferStats() { return {}; }
+
   // Asynchrous variant of API
   // These APIs are used by the RPC server to allow sessions that
   // have special implementations for the async functions.
@@ -360,7 +388,7 @@ class RPCObjectRef : public ffi::ObjectRef {
  * \param sess The RPC session of the global module.
  * \return The created module.
  */
-ffi::Module CreateRPCSessionModule(std::shared_ptr<RPCSession> sess);
+TVM_RUNTIME_DLL ffi::Module CreateRPCSessionModule(std::shared_ptr<RPCSession> sess);
 
 /*!
  * \brief Get the session module from a RPC session Module.
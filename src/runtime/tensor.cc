@@ -27,6 +27,7 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/base.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/runtime/logging.h>
 #include <tvm/runtime/tensor.h>
 
 #include <algorithm>
@@ -140,6 +141,38 @@ Tensor Tensor::Empty(ffi::Shape shape, DLDataType dtype, Device dev,
   return ffi::Tensor::FromNDAlloc(DeviceAPIAlloc(), shape, dtype, dev, mem_scope);
 }
 
+Tensor Tensor::FromExternalBuffer(void* data, ffi::Shape shape, DLDataType dtype, Device dev,
+                                  ffi::Optional<ffi::Function> release, size_t alignment) {
+  TVM_FFI_CHECK(data != nullptr, ValueError) << "The external buffer is null";
+  TVM_FFI_CHECK(alignment > 0 && reinterpret_cast<uintptr_t>(data) % alignment == 0, ValueError)
+      << "The external buffer " << data << " is not aligned to " << alignment << " bytes";
+  VerifyDataType(dtype);
+
+  // helper allocator class that hands the buffer back to its owner with the tensor
+  class ExternalBufferAlloc {
+   public:
+    ExternalBufferAlloc(void* data, ffi::Optional<ffi::Function> release)
+        : data_(data), release_(std::move(release)) {}
+    void AllocData(DLTensor* tensor) { tensor->data = data_; }
+
+    void FreeData(DLTensor* tensor) {
+      if (!release_.has_value()) return;
+      // The tensor may be freed in a destructor, so the release callback must not throw.
+      try {
+        release_.value()();
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "The release callback of an external buffer failed: " << e.what();
+      }
+    }
+
+   private:
+    void* data_;
+    ffi::Optional<ffi::Function> release_;
+  };
+
+  return Tensor::FromNDAlloc(ExternalBufferAlloc(data, std::move(release)), shape, dtype, dev);
+}
+
 Tensor Tensor::CreateView(ffi::Shape shape, DLDataType dtype, uint64_t relative_byte_offset) const {
   TVM_FFI_ICHECK(data_ != nullptr);
 
@@ -291,6 +324,11 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef()
       .def("runtime.TVMTensorAllocWithScope", Tensor::Empty)
       .def_method("runtime.TVMTensorCreateView", &Tensor::CreateView)
+      .def("runtime.TVMTensorFromExternalBuffer",
+           [](void* data, ffi::Shape shape, DLDataType dtype, Device dev,
+              ffi::Optional<ffi::Function> release, int64_t alignment) {
+             return Tensor::FromExternalBuffer(data, shape, dtype, dev, release, alignment);
+           })
       .def("runtime.TVMTensorCopyFromBytes",
            [](DLTensor* arr, void* data, size_t nbytes) { TensorCopyFromBytes(arr, data, nbytes); })
       .def("runtime.TVMTensorCopyToBytes",
@@ -22,11 +22,13 @@
  * \brief Threadpool for multi-threading runtime.
  */
 #include <tvm/ffi/container/array.h>
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/error.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/base.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/metrics.h>
 
 #include "threading_backend.h"
 #if TVM_THREADPOOL_USE_OPENMP
@@ -34,10 +36,13 @@
 #endif
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -60,11 +65,130 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+/*! \brief The maximum spin count before a waiting thread parks, tunable at runtime. */
+std::atomic<uint32_t>& MaxSpinCount() {
+  static std::atomic<uint32_t> max_spin_count{GetSpinCount()};
+  return max_spin_count;
+}
+
+/*!
+ * \brief A spin budget that adapts to how soon the waited event arrives.
+ *  The budget doubles when the event arrives while spinning, and halves when the
+ *  waiter has to park, so that threads of an idle process stop burning CPU while
+ *  threads under steady load keep spinning through short gaps.
+ */
+class AdaptiveSpinBudget {
+ public:
+  uint32_t Get() const { return std::min(budget_, MaxSpinCount().load(std::memory_order_relaxed)); }
+  void OnSpinHit() {
+    uint32_t max_spin = MaxSpinCount().load(std::memory_order_relaxed);
+    budget_ = std::min(max_spin, std::max(Get(), 1U) * 2);
+  }
+  void OnPark() {
+    uint32_t max_spin = MaxSpinCount().load(std::memory_order_relaxed);
+    budget_ = std::max(max_spin >> kMaxShrinkShift, Get() / 2);
+  }
+
+ private:
+  // The budget never goes below max_spin >> kMaxShrinkShift.
+  static constexpr int kMaxShrinkShift = 8;
+  uint32_t budget_{std::numeric_limits<uint32_t>::max()};
+};
+
+/*! \brief The telemetry of the time that waiting threads spend spinning and parked. */
+struct WaitStats {
+  using Clock = std::chrono::steady_clock;
+
+  std::atomic<int64_t> spin_ns{0};
+  std::atomic<int64_t> park_ns{0};
+  std::atomic<int64_t> num_spin_wakeups{0};
+  std::atomic<int64_t> num_parks{0};
+
+  static int64_t Nanoseconds(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  }
+  /*! \brief The distribution of the wait times of all thread pools, in the metrics registry. */
+  static metrics::Histogram* WaitSeconds() {
+    static metrics::Histogram* histogram = metrics::Registry::Global()->GetHistogram(
+        "tvm_thread_pool_wait_seconds",
+        "Time the launching thread waits for the parallel tasks to finish.");
+    return histogram;
+  }
+  void RecordSpinWakeup(Clock::time_point spin_begin, Clock::time_point end) {
+    int64_t wait_ns = Nanoseconds(spin_begin, end);
+    spin_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    num_spin_wakeups.fetch_add(1, std::memory_order_relaxed);
+    WaitSeconds()->Observe(wait_ns * 1e-9);
+  }
+  void RecordPark(Clock::time_point spin_begin, Clock::time_point park_begin,
+                  Clock::time_point end) {
+    spin_ns.fetch_add(Nanoseconds(spin_begin, park_begin), std::memory_order_relaxed);
+    park_ns.fetch_add(Nanoseconds(park_begin, end), std::memory_order_relaxed);
+    num_parks.fetch_add(1, std::memory_order_relaxed);
+    WaitSeconds()->Observe(Nanoseconds(spin_begin, end) * 1e-9);
+  }
+};
+
+/*!
+ * \brief The number of tasks per worker in work-stealing mode, from envvar
+ *  TVM_THREAD_POOL_WORK_STEALING. Zero disables work stealing.
+ */
+int GetWorkStealingChunksPerWorker() {
+  const char* val = getenv("TVM_THREAD_POOL_WORK_STEALING");
+  if (!val) {
+    return 0;
+  }
+  return std::max(atoi(val), 0);
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
 
+/*!
+ * \brief The range of task ids owned by one worker in work-stealing mode.
+ *  The begin and end are packed into one word, so that the owner popping from
+ *  the front and thieves stealing from the back can both update it with a CAS.
+ */
+struct alignas(kL1CacheBytes) StealableRange {
+  std::atomic<uint64_t> range{0};
+
+  static uint64_t Pack(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+  }
+  static uint32_t Begin(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+  static uint32_t End(uint64_t range) { return static_cast<uint32_t>(range); }
+
+  /*! \brief Pop the first task id of the range. Only called by the owner. */
+  bool PopFront(int* task_id) {
+    uint64_t cur = range.load(std::memory_order_acquire);
+    while (Begin(cur) < End(cur)) {
+      if (range.compare_exchange_weak(cur, Pack(Begin(cur) + 1, End(cur)),
+                                      std::memory_order_acq_rel)) {
+        *task_id = static_cast<int>(Begin(cur));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Steal the back half of the range into the empty range of the thief. */
+  bool StealHalf(StealableRange* thief) {
+    uint64_t cur = range.load(std::memory_order_acquire);
+    while (Begin(cur) < End(cur)) {
+      uint32_t mid = End(cur) - (End(cur) - Begin(cur) + 1) / 2;
+      if (range.compare_exchange_weak(cur, Pack(Begin(cur), mid), std::memory_order_acq_rel)) {
+        thief->range.store(Pack(mid, End(cur)), std::memory_order_release);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+class ThreadPool;
+
 /*!
  * \brief Thread local main environment.
  */
@@ -76,14 +200,16 @@ class ParallelLauncher {
     this->cdata = cdata;
     this->flambda = flambda;
     this->env.num_task = num_task;
+    this->work_stealing = false;
     has_error_.store(false);
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    if (need_sync && num_task > sync_counter_capacity_) {
+      delete[] sync_counter_;
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
+      sync_counter_capacity_ = num_task;
     }
     if (need_sync) {
       for (int i = 0; i < num_task; ++i) {
@@ -94,12 +220,74 @@ class ParallelLauncher {
       this->env.sync_handle = nullptr;
     }
   }
+  /*!
+   * \brief Reset the task request in work-stealing mode.
+   *  The task ids are evenly split into the ranges of the workers, and every worker
+   *  signals once after it runs out of tasks to run or steal.
+   */
+  void InitWorkStealing(FTVMParallelLambda flambda, void* cdata, int num_task, int num_workers) {
+    // There is no barrier in work-stealing mode, as the tasks do not run concurrently.
+    Init(flambda, cdata, num_task, false);
+    num_pending_.store(num_workers);
+    this->work_stealing = true;
+    if (num_workers > num_ranges_) {
+      ranges_.reset(new StealableRange[num_workers]);
+      num_ranges_ = num_workers;
+    }
+    num_active_ranges_ = num_workers;
+    for (int i = 0; i < num_workers; ++i) {
+      uint32_t begin = static_cast<uint64_t>(num_task) * i / num_workers;
+      uint32_t end = static_cast<uint64_t>(num_task) * (i + 1) / num_workers;
+      ranges_[i].range.store(StealableRange::Pack(begin, end), std::memory_order_relaxed);
+    }
+  }
+  /*!
+   * \brief Run the tasks of a worker in work-stealing mode, then steal from the others.
+   * \param worker_index The index of the worker in the ranges.
+   */
+  void RunWorkStealing(int worker_index) {
+    StealableRange* own = &ranges_[worker_index];
+    int task_id;
+    while (true) {
+      if (!own->PopFront(&task_id)) {
+        bool stolen = false;
+        for (int k = 1; k < num_active_ranges_ && !stolen; ++k) {
+          stolen = ranges_[(worker_index + k) % num_active_ranges_].StealHalf(own);
+        }
+        if (!stolen) break;
+        continue;
+      }
+      ParallelLauncher* local = ParallelLauncher::ThreadLocal();
+      local->has_unsupported_barrier = false;
+      if ((*flambda)(task_id, &env, cdata) != 0 || local->has_unsupported_barrier) {
+        RecordJobError(task_id);
+      }
+    }
+    SignalJobFinish();
+  }
   ~ParallelLauncher() { delete[] sync_counter_; }
-  // Wait n jobs to finish
+  // Wait n jobs to finish, spin first and then park.
   int WaitForJobs() {
-    while (num_pending_.load() != 0) {
+    WaitStats::Clock::time_point spin_begin = WaitStats::Clock::now();
+    uint32_t spin_count = wait_spin_budget_.Get();
+    for (uint32_t i = 0; i < spin_count && num_pending_.load() != 0; ++i) {
       tvm::runtime::threading::YieldThread();
     }
+    if (num_pending_.load() != 0) {
+      WaitStats::Clock::time_point park_begin = WaitStats::Clock::now();
+      {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        // Paired with the load of waiter_parked_ after the last decrement of num_pending_.
+        waiter_parked_.store(true);
+        wait_cv_.wait(lock, [this] { return num_pending_.load() == 0; });
+        waiter_parked_.store(false);
+      }
+      wait_stats.RecordPark(spin_begin, park_begin, WaitStats::Clock::now());
+      wait_spin_budget_.OnPark();
+    } else {
+      wait_stats.RecordSpinWakeup(spin_begin, WaitStats::Clock::now());
+      wait_spin_budget_.OnSpinHit();
+    }
     if (!has_error_.load()) return 0;
     std::ostringstream os;
     for (size_t i = 0; i < par_errors_.size(); ++i) {
@@ -115,17 +303,38 @@ class ParallelLauncher {
   }
   // Signal that one job has finished.
   void SignalJobError(int task_id) {
-    num_pending_.fetch_sub(1);
+    RecordJobError(task_id);
+    SignalJobFinish();
+  }
+  // Signal that one job has finished, and wake up the waiter if it is parked.
+  void SignalJobFinish() {
+    if (num_pending_.fetch_sub(1) == 1 && waiter_parked_.load()) {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      wait_cv_.notify_one();
+    }
+  }
+  // Record the error of one job without signaling, used in work-stealing mode.
+  void RecordJobError(int task_id) {
     par_errors_[task_id] = tvm::ffi::details::MoveFromSafeCallRaised();
     has_error_.store(true);
   }
-  // Signal that one job has finished.
-  void SignalJobFinish() { num_pending_.fetch_sub(1); }
   // Get thread local version of the store.
   static ParallelLauncher* ThreadLocal() {
     static thread_local ParallelLauncher inst;
     return &inst;
   }
+  // Get thread local store for the nested launches issued by this thread.
+  static ParallelLauncher* NestedThreadLocal() {
+    static thread_local ParallelLauncher inst;
+    return &inst;
+  }
+  // Get the idle workers that the given task can use for nested launches.
+  const std::vector<int>* SubTeam(int task_id) const {
+    if (static_cast<size_t>(task_id) >= sub_teams.size() || sub_teams[task_id].empty()) {
+      return nullptr;
+    }
+    return &sub_teams[task_id];
+  }
   // The parallel lambda
   FTVMParallelLambda flambda;
   // The closure data
@@ -135,6 +344,22 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // Whether the current request runs in work-stealing mode.
+  bool work_stealing{false};
+  // Whether the task running on this thread called a barrier in work-stealing mode.
+  bool has_unsupported_barrier{false};
+  // Whether this thread is running a task of a parallel launch.
+  bool in_parallel_region{false};
+  // The thread pool of the parallel region.
+  ThreadPool* pool{nullptr};
+  // The idle workers this thread can use for nested launches in the parallel region.
+  const std::vector<int>* nested_team{nullptr};
+  // The idle workers of each task of the current request, which form its sub-team.
+  std::vector<std::vector<int>> sub_teams;
+  // Whether this launcher is running a nested launch.
+  bool in_use{false};
+  // The telemetry of WaitForJobs.
+  WaitStats wait_stats;
 
  private:
   // The pending jobs.
@@ -143,10 +368,52 @@ class ParallelLauncher {
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // The number of tasks the counter page can host.
+  int sync_counter_capacity_{0};
+  // The task ranges of the workers in work-stealing mode.
+  std::unique_ptr<StealableRange[]> ranges_;
+  // The number of allocated ranges.
+  int num_ranges_{0};
+  // The number of ranges used by the current request.
+  int num_active_ranges_{0};
+  // The spin budget of WaitForJobs.
+  AdaptiveSpinBudget wait_spin_budget_;
+  // Whether the waiter is parked, and the mutex and cv to park it.
+  std::atomic<bool> waiter_parked_{false};
+  std::mutex wait_mutex_;
+  std::condition_variable wait_cv_;
   // The error message
   std::vector<ffi::Optional<tvm::ffi::Error>> par_errors_;
 };
 
+/*!
+ * \brief Mark the calling thread as running a task of a parallel launch in its scope.
+ *  Parallel launches issued in the scope are nested launches.
+ */
+class ParallelRegionScope {
+ public:
+  ParallelRegionScope(ThreadPool* pool, const std::vector<int>* nested_team)
+      : local_(ParallelLauncher::ThreadLocal()),
+        in_parallel_region_(local_->in_parallel_region),
+        pool_(local_->pool),
+        nested_team_(local_->nested_team) {
+    local_->in_parallel_region = true;
+    local_->pool = pool;
+    local_->nested_team = nested_team;
+  }
+  ~ParallelRegionScope() {
+    local_->in_parallel_region = in_parallel_region_;
+    local_->pool = pool_;
+    local_->nested_team = nested_team_;
+  }
+
+ private:
+  ParallelLauncher* local_;
+  bool in_parallel_region_;
+  ThreadPool* pool_;
+  const std::vector<int>* nested_team_;
+};
+
 /*! \brief Lock-free single-producer-single-consumer queue for each thread */
 class SpscTaskQueue {
  public:
@@ -177,19 +444,29 @@ class SpscTaskQueue {
   /*!
    * \brief Pop a task out of the queue and condition wait if no tasks.
    * \param output The pointer to the task to be dequeued.
-   * \param spin_count The number of iterations to spin before sleep.
    * \return Whether pop is successful (true) or we need to exit now (false).
    */
-  bool Pop(Task* output, uint32_t spin_count) {
+  bool Pop(Task* output) {
     // Busy wait a bit when the queue is empty.
     // If a new task comes to the queue quickly, this wait avoid the worker from sleeping.
-    // The default spin count is set by following the typical omp convention
+    // The maximum spin count is set by following the typical omp convention, and the
+    // actual spin count adapts to how soon the tasks arrive.
+    WaitStats::Clock::time_point spin_begin = WaitStats::Clock::now();
+    uint32_t spin_count = spin_budget_.Get();
     for (uint32_t i = 0; i < spin_count && pending_.load() == 0; ++i) {
       tvm::runtime::threading::YieldThread();
     }
     if (pending_.fetch_sub(1) == 0) {
-      std::unique_lock<std::mutex> lock(mutex_);
-      cv_.wait(lock, [this] { return pending_.load() >= 0 || exit_now_.load(); });
+      WaitStats::Clock::time_point park_begin = WaitStats::Clock::now();
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return pending_.load() >= 0 || exit_now_.load(); });
+      }
+      wait_stats.RecordPark(spin_begin, park_begin, WaitStats::Clock::now());
+      spin_budget_.OnPark();
+    } else {
+      wait_stats.RecordSpinWakeup(spin_begin, WaitStats::Clock::now());
+      spin_budget_.OnSpinHit();
     }
     if (exit_now_.load(std::memory_order_relaxed)) {
       return false;
@@ -202,6 +479,9 @@ class SpscTaskQueue {
     return true;
   }
 
+  /*! \brief The telemetry of Pop. */
+  WaitStats wait_stats;
+
   /*!
    * \brief Signal to terminate the worker.
    */
@@ -255,6 +535,9 @@ class SpscTaskQueue {
   // signal for exit now
   std::atomic<bool> exit_now_{false};
 
+  // the spin budget of the consumer
+  AdaptiveSpinBudget spin_budget_;
+
   // internal mutex
   std::mutex mutex_;
   // cv for consumer
@@ -269,6 +552,7 @@ class ThreadPool {
     if (exclude_worker0 && atoi(exclude_worker0) == 0) {
       exclude_worker0_ = false;
     }
+    work_stealing_chunks_per_worker_ = GetWorkStealingChunksPerWorker();
     Init();
   }
 
@@ -289,11 +573,20 @@ class ThreadPool {
     Init();
   }
 
-  int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
+  /*!
+   * \brief Launch a parallel job.
+   * \param numa_order Whether to run the tasks on the workers in NUMA node order, so that
+   *  contiguous task ids run on the workers of the same node.
+   */
+  int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync,
+             bool numa_order = false) {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
-    TVM_FFI_ICHECK(!launcher->is_worker)
-        << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    TVM_FFI_ICHECK(!launcher->is_worker && !launcher->in_parallel_region)
+        << "Nested parallel job should be launched with LaunchNested";
     if (num_task == 0) {
+      if (work_stealing_chunks_per_worker_ > 0 && !numa_order) {
+        return LaunchWorkStealing(launcher, flambda, cdata);
+      }
       num_task = num_workers_used_;
     }
     if (need_sync != 0) {
@@ -302,15 +595,26 @@ class ThreadPool {
           << " workers=" << num_workers_used_ << " request=" << num_task;
     }
     launcher->Init(flambda, cdata, num_task, need_sync != 0);
+    // The workers not used by this request are split into the sub-teams of the tasks,
+    // which run the nested launches of the tasks.
+    launcher->sub_teams.resize(num_task);
+    for (std::vector<int>& team : launcher->sub_teams) {
+      team.clear();
+    }
+    for (int i = num_task; i < num_workers_used_; ++i) {
+      int worker = numa_order ? numa_task_order_[i] : i;
+      launcher->sub_teams[(i - num_task) % num_task].push_back(worker);
+    }
     SpscTaskQueue::Task tsk;
     tsk.launcher = launcher;
     // if worker0 is taken by the main, queues_[0] is abandoned
     for (int i = exclude_worker0_; i < num_task; ++i) {
       tsk.task_id = i;
-      queues_[i]->Push(tsk);
+      queues_[numa_order ? numa_task_order_[i] : i]->Push(tsk);
     }
     // use the main thread to run task 0
     if (exclude_worker0_) {
+      ParallelRegionScope scope(this, launcher->SubTeam(0));
       TVMParallelGroupEnv* penv = &(tsk.launcher->env);
       if ((*tsk.launcher->flambda)(0, penv, cdata) == 0) {
         tsk.launcher->SignalJobFinish();
@@ -327,6 +631,54 @@ class ThreadPool {
     return &inst;
   }
 
+  /*!
+   * \brief Launch a parallel job from a task of another parallel job.
+   *  The job runs on the sub-team of the calling thread, which consists of the calling
+   *  thread and the workers left idle by the outer job. When there is no idle worker,
+   *  or the job requests more tasks than the sub-team size, the tasks run inline.
+   */
+  int LaunchNested(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    const std::vector<int>* team = ParallelLauncher::ThreadLocal()->nested_team;
+    int team_size = 1 + (team != nullptr ? static_cast<int>(team->size()) : 0);
+    if (num_task == 0) {
+      num_task = team_size;
+    }
+    ParallelLauncher* launcher = ParallelLauncher::NestedThreadLocal();
+    if (team_size == 1 || num_task > team_size || launcher->in_use) {
+      return RunInline(flambda, cdata, num_task);
+    }
+    launcher->in_use = true;
+    launcher->Init(flambda, cdata, num_task, true);
+    launcher->sub_teams.clear();
+    // The sub-team is owned by the calling task, so it is the only producer of the queues.
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    for (int i = 1; i < num_task; ++i) {
+      tsk.task_id = i;
+      queues_[(*team)[i - 1]]->Push(tsk);
+    }
+    {
+      ParallelRegionScope scope(this, nullptr);
+      if ((*flambda)(0, &launcher->env, cdata) == 0) {
+        launcher->SignalJobFinish();
+      } else {
+        launcher->SignalJobError(0);
+      }
+    }
+    int res = launcher->WaitForJobs();
+    launcher->in_use = false;
+    return res;
+  }
+
+  /*!
+   * \brief Configure the work-stealing mode.
+   * \param chunks_per_worker The number of tasks per worker. Zero disables work stealing.
+   */
+  void ConfigureWorkStealing(int chunks_per_worker) {
+    TVM_FFI_ICHECK_GE(chunks_per_worker, 0);
+    work_stealing_chunks_per_worker_ = chunks_per_worker;
+  }
+
   void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads,
                                  const std::vector<unsigned int>& cpus) {
     // this will also reset the affinity of the ThreadGroup
@@ -335,11 +687,77 @@ class ThreadPool {
     // if MaxConcurrency restricted the number of workers (e.g., due to
     // hyperthreading), respect the restriction
     num_workers_used_ = std::min(num_workers_, num_workers_used_);
+    UpdateNumaTaskOrder();
   }
 
   int32_t NumThreads() const { return num_workers_used_; }
 
+  /*! \brief Get the spin and park telemetry of the workers and the launching thread. */
+  ffi::Map<ffi::String, int64_t> GetWaitStats() const {
+    int64_t worker_spin_ns = 0, worker_park_ns = 0;
+    int64_t worker_num_spin_wakeups = 0, worker_num_parks = 0;
+    for (const std::unique_ptr<SpscTaskQueue>& q : queues_) {
+      worker_spin_ns += q->wait_stats.spin_ns.load(std::memory_order_relaxed);
+      worker_park_ns += q->wait_stats.park_ns.load(std::memory_order_relaxed);
+      worker_num_spin_wakeups += q->wait_stats.num_spin_wakeups.load(std::memory_order_relaxed);
+      worker_num_parks += q->wait_stats.num_parks.load(std::memory_order_relaxed);
+    }
+    const WaitStats& main_stats = ParallelLauncher::ThreadLocal()->wait_stats;
+    ffi::Map<ffi::String, int64_t> result;
+    result.Set("worker_spin_ns", worker_spin_ns);
+    result.Set("worker_park_ns", worker_park_ns);
+    result.Set("worker_num_spin_wakeups", worker_num_spin_wakeups);
+    result.Set("worker_num_parks", worker_num_parks);
+    result.Set("main_spin_ns", main_stats.spin_ns.load(std::memory_order_relaxed));
+    result.Set("main_park_ns", main_stats.park_ns.load(std::memory_order_relaxed));
+    result.Set("main_num_spin_wakeups",
+               main_stats.num_spin_wakeups.load(std::memory_order_relaxed));
+    result.Set("main_num_parks", main_stats.num_parks.load(std::memory_order_relaxed));
+    return result;
+  }
+
  private:
+  /*!
+   * \brief Launch a request of num_task = 0 in work-stealing mode.
+   *  The request is split into chunks_per_worker tasks per worker, so that the
+   *  workers that finish early can steal the tasks of stragglers.
+   */
+  int LaunchWorkStealing(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata) {
+    int num_workers = num_workers_used_;
+    int num_task = num_workers * work_stealing_chunks_per_worker_;
+    launcher->InitWorkStealing(flambda, cdata, num_task, num_workers);
+    launcher->sub_teams.clear();
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    // The task id of the queued task is the worker index of the ranges.
+    for (int i = exclude_worker0_; i < num_workers; ++i) {
+      tsk.task_id = i;
+      queues_[i]->Push(tsk);
+    }
+    if (exclude_worker0_) {
+      ParallelRegionScope scope(this, nullptr);
+      launcher->RunWorkStealing(0);
+    }
+    return launcher->WaitForJobs();
+  }
+
+  /*! \brief Run all tasks of a nested job one by one on the calling thread. */
+  static int RunInline(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    ParallelLauncher* local = ParallelLauncher::ThreadLocal();
+    std::atomic<int32_t> sync_counter{0};
+    TVMParallelGroupEnv env;
+    env.num_task = num_task;
+    // A barrier can only be met when there is one task.
+    env.sync_handle = num_task == 1 ? &sync_counter : nullptr;
+    local->has_unsupported_barrier = false;
+    for (int i = 0; i < num_task; ++i) {
+      if ((*flambda)(i, &env, cdata) != 0 || local->has_unsupported_barrier) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
   // Shared initialization code
   void Init() {
     for (int i = 0; i < num_workers_; ++i) {
@@ -350,6 +768,24 @@ class ThreadPool {
         num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
         exclude_worker0_ /* include_main_thread */);
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
+    UpdateNumaTaskOrder();
+  }
+
+  /*!
+   * \brief Order the used workers by their NUMA node. Worker 0 stays first since the main
+   *  thread runs task 0, so its node comes first.
+   */
+  void UpdateNumaTaskOrder() {
+    numa_task_order_.resize(num_workers_used_);
+    std::iota(numa_task_order_.begin(), numa_task_order_.end(), 0);
+    std::vector<int> nodes(num_workers_used_);
+    for (int i = 0; i < num_workers_used_; ++i) {
+      nodes[i] = threads_->WorkerNumaNode(i);
+    }
+    // the node of worker 0 sorts before all other nodes
+    auto key = [&nodes](int worker) { return nodes[worker] == nodes[0] ? -1 : nodes[worker]; };
+    std::stable_sort(numa_task_order_.begin(), numa_task_order_.end(),
+                     [&key](int a, int b) { return key(a) < key(b); });
   }
 
   // Internal worker function.
@@ -357,12 +793,13 @@ class ThreadPool {
     SpscTaskQueue* queue = queues_[worker_id].get();
     SpscTaskQueue::Task task;
     ParallelLauncher::ThreadLocal()->is_worker = true;
-    // Initialize the spin count (from envvar TVM_THREAD_POOL_SPIN_COUNT) on
-    // the global first use of the ThreadPool.
-    // TODO(tulloch): should we make this configurable via standard APIs?
-    static size_t spin_count = GetSpinCount();
-    while (queue->Pop(&task, spin_count)) {
+    while (queue->Pop(&task)) {
       TVM_FFI_ICHECK(task.launcher != nullptr);
+      ParallelRegionScope scope(this, task.launcher->SubTeam(task.task_id));
+      if (task.launcher->work_stealing) {
+        task.launcher->RunWorkStealing(task.task_id);
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
       if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
@@ -377,6 +814,10 @@ class ThreadPool {
   int num_workers_used_;
   // if or not to exclude worker 0 and use main to run task 0
   bool exclude_worker0_{true};
+  // number of tasks per worker in work-stealing mode, 0 means disabled
+  int work_stealing_chunks_per_worker_{0};
+  // the worker of each task id in a NUMA-ordered launch
+  std::vector<int> numa_task_order_;
   std::vector<std::unique_ptr<SpscTaskQueue>> queues_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
@@ -404,6 +845,15 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                     }
                     threading::Configure(mode, nthreads, cpus);
                   })
+      .def("runtime.config_threadpool_work_stealing",
+           [](int chunks_per_worker) { threading::ConfigureWorkStealing(chunks_per_worker); })
+      .def("runtime.config_threadpool_spin_count",
+           [](int64_t spin_count) {
+             TVM_FFI_ICHECK_GE(spin_count, 0);
+             MaxSpinCount().store(static_cast<uint32_t>(spin_count), std::memory_order_relaxed);
+           })
+      .def("runtime.thread_pool_wait_stats",
+           []() { return ThreadPool::ThreadLocal()->GetWaitStats(); })
       .def("runtime.NumThreads", []() -> int32_t { return threading::NumThreads(); });
 }
 
@@ -463,7 +913,7 @@ void ResetThreadPool() { tvm::runtime::ThreadPool::ThreadLocal()->Reset(); }
 /*!
  * \brief configure the CPU id affinity
  * \param mode The preferred CPU type (1 = big, -1 = little, -2 = kSpecifyOneCorePerThread,
- *  -3 = kSpecifyThreadShareAllCore).
+ *  -3 = kSpecifyThreadShareAllCore, -4 = kNuma).
  * \param nthreads The number of threads to use (0 = use all).
  * \param cpus cpus A list of CPUs is used to set the 'cpu affinity' for the worker threads.
  *
@@ -478,11 +928,30 @@ TVM_RUNTIME_DLL void Configure(tvm::runtime::threading::ThreadGroup::AffinityMod
 #endif
 }
 int32_t NumThreads() { return tvm::runtime::ThreadPool::ThreadLocal()->NumThreads(); }
+void ConfigureWorkStealing(int chunks_per_worker) {
+#if !TVM_THREADPOOL_USE_OPENMP
+  tvm::runtime::ThreadPool::ThreadLocal()->ConfigureWorkStealing(chunks_per_worker);
+#endif
+}
 }  // namespace threading
+
+#if defined(__hexagon__)
+namespace hexagon {
+// Defined by the Hexagon device API, runs the launch on the HVX threads when they exist.
+bool ParallelLaunchOnHvxThreads(FTVMParallelLambda flambda, void* cdata, int num_task,
+                                int* result);
+}  // namespace hexagon
+#endif
 }  // namespace runtime
 }  // namespace tvm
 
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
+#if defined(__hexagon__)
+  int hvx_result = 0;
+  if (tvm::runtime::hexagon::ParallelLaunchOnHvxThreads(flambda, cdata, num_task, &hvx_result)) {
+    return hvx_result;
+  }
+#endif
   int num_workers = tvm::runtime::threading::MaxConcurrency();
   if (num_workers == 1) {
     std::atomic<int32_t> sync_counter{0};
@@ -493,6 +962,10 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
     return 0;
   } else {
 #if !TVM_THREADPOOL_USE_OPENMP
+    tvm::runtime::ParallelLauncher* local = tvm::runtime::ParallelLauncher::ThreadLocal();
+    if (local->in_parallel_region) {
+      return local->pool->LaunchNested(flambda, cdata, num_task);
+    }
     int res = tvm::runtime::ThreadPool::ThreadLocal()->Launch(flambda, cdata, num_task, 1);
     return res;
 #else
@@ -509,11 +982,40 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
   }
 }
 
+int TVMBackendParallelLaunchNuma(FTVMParallelLambda flambda, void* cdata) {
+#if defined(__hexagon__)
+  int hvx_result = 0;
+  if (tvm::runtime::hexagon::ParallelLaunchOnHvxThreads(flambda, cdata, 0, &hvx_result)) {
+    return hvx_result;
+  }
+#endif
+#if !TVM_THREADPOOL_USE_OPENMP
+  if (tvm::runtime::threading::MaxConcurrency() != 1) {
+    tvm::runtime::ParallelLauncher* local = tvm::runtime::ParallelLauncher::ThreadLocal();
+    if (local->in_parallel_region) {
+      return local->pool->LaunchNested(flambda, cdata, 0);
+    }
+    return tvm::runtime::ThreadPool::ThreadLocal()->Launch(flambda, cdata, 0, 1, true);
+  }
+#endif
+  return TVMBackendParallelLaunch(flambda, cdata, 0);
+}
+
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #if TVM_THREADPOOL_USE_OPENMP
 #pragma omp barrier
 #else
   using tvm::runtime::kSyncStride;
+  if (penv->sync_handle == nullptr) {
+    // The tasks of a work-stealing request or of an inlined nested request do not run
+    // concurrently, so they can not sync.
+    tvm::runtime::ParallelLauncher::ThreadLocal()->has_unsupported_barrier = true;
+    TVMFFIErrorSetRaisedFromCStr("RuntimeError",
+                                 "TVMBackendParallelBarrier is not supported when the tasks do "
+                                 "not run concurrently, i.e., in work-stealing mode or in a "
+                                 "nested parallel launch without enough idle workers");
+    return -1;
+  }
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
@@ -50,6 +50,9 @@ extern "C" {
 #define HEXAGON_STACK_ALIGNMENT 32
 #endif
 #include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <string>
 #include <thread>
 #define CURRENT_THREAD_HANDLE (static_cast<std::thread::native_handle_type>(0))
 namespace tvm {
@@ -143,6 +146,98 @@ void SetThreadAffinity(std::thread::native_handle_type thread,
 #endif
 }
 
+// Parse a kernel CPU list such as "0-11,24-35".
+static std::vector<unsigned int> ParseCpuList(const std::string& list) {
+  std::vector<unsigned int> cpus;
+  std::istringstream is(list);
+  std::string range;
+  while (std::getline(is, range, ',')) {
+    if (range.empty()) continue;
+    size_t dash = range.find('-');
+    unsigned int first = std::stoul(range.substr(0, dash));
+    unsigned int last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (unsigned int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+const std::vector<std::vector<unsigned int>>& NumaNodeCpus() {
+  static const std::vector<std::vector<unsigned int>> nodes = [] {
+    std::vector<std::vector<unsigned int>> nodes;
+#if defined(__linux__) && !defined(__ANDROID__)
+    for (int node = 0;; ++node) {
+      std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      if (ifs.fail()) break;
+      std::string list;
+      std::getline(ifs, list);
+      nodes.push_back(ParseCpuList(list));
+    }
+#endif
+    if (nodes.empty()) {
+      std::vector<unsigned int> cpus;
+      for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+        cpus.push_back(cpu);
+      }
+      nodes.push_back(cpus);
+    }
+    return nodes;
+  }();
+  return nodes;
+}
+
+static int NumaNodeOfCpu(unsigned int cpu) {
+  const std::vector<std::vector<unsigned int>>& nodes = NumaNodeCpus();
+  for (size_t node = 0; node < nodes.size(); ++node) {
+    if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end()) {
+      return static_cast<int>(node);
+    }
+  }
+  return 0;
+}
+
+int CurrentNumaNode() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return NumaNodeOfCpu(static_cast<unsigned int>(cpu));
+  }
+#endif
+  return 0;
+}
+
+static std::atomic<bool>& NumaAwarePlacementFlag() {
+  static std::atomic<bool> flag([] {
+    const char* val = getenv("TVM_NUMA_AWARE");
+    return val != nullptr && atoi(val) == 1;
+  }());
+  return flag;
+}
+
+bool NumaAwarePlacement() { return NumaAwarePlacementFlag().load(std::memory_order_relaxed); }
+
+/*!
+ * \brief Order the CPUs so that the first num_workers ones are spread evenly over the
+ *  NUMA nodes and the CPUs of one node are contiguous.
+ */
+static std::vector<unsigned int> NumaSortedOrder(int num_workers) {
+  std::vector<const std::vector<unsigned int>*> nodes;
+  for (const std::vector<unsigned int>& cpus : NumaNodeCpus()) {
+    // memory-only nodes have no CPU
+    if (!cpus.empty()) nodes.push_back(&cpus);
+  }
+  size_t per_node = (num_workers + nodes.size() - 1) / nodes.size();
+  std::vector<unsigned int> order, rest;
+  for (const std::vector<unsigned int>* cpus : nodes) {
+    for (size_t i = 0; i < cpus->size(); ++i) {
+      (i < per_node ? order : rest).push_back((*cpus)[i]);
+    }
+  }
+  order.insert(order.end(), rest.begin(), rest.end());
+  return order;
+}
+
 thread_local int max_concurrency = 0;
 class ThreadGroup::Impl {
  public:
@@ -190,10 +285,25 @@ class ThreadGroup::Impl {
     // and N/2 physical cores this will set affinity to the first N/2 logical
     // ones.
     num_workers_used = std::min(num_workers_, num_workers_used);
+    if (mode == kNuma) {
+      sorted_order_ = NumaSortedOrder(num_workers_used);
+      NumaAwarePlacementFlag().store(true, std::memory_order_relaxed);
+    }
+    mode_ = mode;
     SetAffinity(exclude_worker0, mode);
     return num_workers_used;
   }
 
+  int WorkerNumaNode(int worker_id) const {
+    // The workers are bound to single cores only when there are enough cores.
+    if (sorted_order_.size() < static_cast<size_t>(num_workers_) ||
+        mode_ == kSpecifyThreadShareAllCore) {
+      return 0;
+    }
+    size_t index = mode_ == kLittle ? sorted_order_.size() - worker_id - 1 : worker_id;
+    return NumaNodeOfCpu(sorted_order_[index]);
+  }
+
  private:
   // bind worker threads to disjoint cores
   // if worker 0 is offloaded to main, i.e. exclude_worker0 is true,
@@ -207,10 +317,11 @@ class ThreadGroup::Impl {
     // Do not set affinity if there are more workers than found cores and mode is not kSpecify*.
     if (sorted_order_.size() < static_cast<unsigned int>(num_workers_)) {
       switch (mode) {
-        // When the mode is kSpecifyOneCorePerThread or kSpecifyThreadShareAllCore, we should
-        // let the threads share all the cpu cores.
+        // When the mode is kSpecifyOneCorePerThread, kSpecifyThreadShareAllCore or kNuma,
+        // we should let the threads share all the cpu cores.
         case kSpecifyOneCorePerThread:
         case kSpecifyThreadShareAllCore:
+        case kNuma:
           for (unsigned i = 0; i < threads_.size(); ++i) {
             SetThreadFullCpuAffinity(threads_[i].native_handle(), mode);
           }
@@ -236,6 +347,7 @@ class ThreadGroup::Impl {
         case kLittle:
         case kBig:
         case kSpecifyOneCorePerThread:
+        case kNuma:
           for (unsigned i = 0; i < threads_.size(); ++i) {
             bool reverse = mode == kLittle;
             unsigned core_id;
@@ -279,6 +391,10 @@ class ThreadGroup::Impl {
           ids.push_back(sorted_order_[i]);
         }
         break;
+      case kNuma:
+        // Keep the thread on the NUMA node of the first core, where task 0 runs.
+        ids = NumaNodeCpus()[NumaNodeOfCpu(sorted_order_[0])];
+        break;
       case kLittle:
         for (int i = 0; i < little_count_; ++i) {
           ids.push_back(sorted_order_[sorted_order_.size() - i - 1]);
@@ -357,6 +473,7 @@ class ThreadGroup::Impl {
   std::vector<std::thread> threads_;
 #endif
   std::vector<unsigned int> sorted_order_;
+  AffinityMode mode_ = kBig;
   int big_count_ = 0;
   int little_count_ = 0;
 };
@@ -372,6 +489,8 @@ int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0
   return impl_->Configure(mode, nthreads, exclude_worker0, cpus);
 }
 
+int ThreadGroup::WorkerNumaNode(int worker_id) const { return impl_->WorkerNumaNode(worker_id); }
+
 void YieldThread() {
 #ifdef __hexagon__
   // QuRT doesn't have a yield API, so instead we sleep for the minimum amount
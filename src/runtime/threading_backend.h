@@ -92,6 +92,8 @@ class ThreadGroup {
     kSpecifyOneCorePerThread = -2,
     /*All threads will get the same core group affinity.*/
     kSpecifyThreadShareAllCore = -3,
+    /*Different threads will get different affinities, grouped by NUMA node.*/
+    kNuma = -4,
   };
   /*!
    * \brief configure the CPU id affinity
@@ -109,6 +111,13 @@ class ThreadGroup {
   TVM_RUNTIME_DLL int Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
                                 std::vector<unsigned int> cpus = {});
 
+  /*!
+   * \brief Get the NUMA node of the core that a worker is bound to.
+   * \param worker_id The id of the worker.
+   * \return The NUMA node, 0 when the worker is not bound to a single known core.
+   */
+  TVM_RUNTIME_DLL int WorkerNumaNode(int worker_id) const;
+
  private:
   Impl* impl_;
 };
@@ -143,6 +152,34 @@ TVM_RUNTIME_DLL void ResetThreadPool();
 TVM_RUNTIME_DLL void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode,
                                int nthreads, std::vector<unsigned int> cpus);
 
+/*!
+ * \brief Configure the work-stealing mode of the thread pool of the calling thread.
+ *  In work-stealing mode, a launch with num_task = 0 is split into chunks_per_worker
+ *  tasks per worker, and idle workers steal the tasks of the others. The tasks of a
+ *  launch do not run concurrently, so TVMBackendParallelBarrier is not supported.
+ *
+ *  Note that this does nothing when openmp is used.
+ * \param chunks_per_worker The number of tasks per worker. Zero disables work stealing.
+ */
+TVM_RUNTIME_DLL void ConfigureWorkStealing(int chunks_per_worker);
+
+/*!
+ * \brief Get the CPU ids of each NUMA node of the system.
+ *  When the NUMA topology is unknown, all CPUs are reported as one node.
+ */
+TVM_RUNTIME_DLL const std::vector<std::vector<unsigned int>>& NumaNodeCpus();
+
+/*!
+ * \brief Get the NUMA node of the CPU that the calling thread runs on.
+ */
+TVM_RUNTIME_DLL int CurrentNumaNode();
+
+/*!
+ * \brief Whether the CPU workspaces are placed on the NUMA node of the allocating thread.
+ *  It is enabled by TVM_NUMA_AWARE=1 or by configuring the thread pool in kNuma mode.
+ */
+TVM_RUNTIME_DLL bool NumaAwarePlacement();
+
 /*!
  * \brief Get the number of threads being used by the TVM runtime
  * \returns The number of threads used.
@@ -29,11 +29,17 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/timer.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <functional>
 #include <mutex>
+#include <numeric>
 #include <set>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace tvm {
 namespace runtime {
@@ -108,29 +114,78 @@ Timer Timer::Start(Device dev) {
   }
 }
 
+namespace {
+
+/*! \brief The two-sided 95% quantiles of the Student t distribution, by degrees of freedom. */
+constexpr double kStudentT95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                  2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                  2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                  2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+
+/*! \brief The least number of repeats before an adaptive measurement may stop. */
+constexpr size_t kMinAdaptiveRepeats = 3;
+
+/*! \brief Whether the 95% confidence interval of the mean cost is within the relative width. */
+bool ConfidenceIntervalWithin(const std::vector<double>& costs, double max_relative_ci) {
+  size_t n = costs.size();
+  if (n < kMinAdaptiveRepeats) return false;
+  double mean = std::accumulate(costs.begin(), costs.end(), 0.0) / n;
+  double sum_sq = 0.0;
+  for (double cost : costs) {
+    sum_sq += (cost - mean) * (cost - mean);
+  }
+  double stddev = std::sqrt(sum_sq / (n - 1));
+  constexpr size_t kNumQuantiles = sizeof(kStudentT95) / sizeof(kStudentT95[0]);
+  double t = n - 1 <= kNumQuantiles ? kStudentT95[n - 2] : 1.96;
+  return t * stddev / std::sqrt(static_cast<double>(n)) <= max_relative_ci * mean;
+}
+
+/*!
+ * \brief Get the function that flushes the given number of bytes from the caches of the device.
+ *  It is "runtime.cache_flush.<device>" when the device registers one, and otherwise a copy
+ *  between two buffers of that size on the device.
+ */
+std::function<void()> GetCacheFlush(Device dev, int cache_flush_bytes) {
+  auto fcache_flush = ffi::Function::GetGlobal(std::string("runtime.cache_flush.") +
+                                         DLDeviceType2Str(dev.device_type));
+  if (fcache_flush.has_value()) {
+    return [fcache_flush = fcache_flush.value(), dev, cache_flush_bytes]() {
+      fcache_flush(dev, static_cast<int64_t>(cache_flush_bytes));
+    };
+  }
+  Tensor arr1 = Tensor::Empty({cache_flush_bytes / 4}, {kDLInt, 32, 1}, dev);
+  Tensor arr2 = Tensor::Empty({cache_flush_bytes / 4}, {kDLInt, 32, 1}, dev);
+  return [arr1, arr2]() { arr1.CopyFrom(arr2); };
+}
+
+}  // namespace
+
 ffi::Function WrapTimeEvaluator(ffi::Function pf, Device dev, int number, int repeat,
                                 int min_repeat_ms, int limit_zero_time_iterations,
                                 int cooldown_interval_ms, int repeats_to_cooldown,
-                                int cache_flush_bytes, ffi::Function f_preproc) {
+                                int cache_flush_bytes, ffi::Function f_preproc,
+                                double max_relative_ci, bool cold) {
   TVM_FFI_ICHECK(pf != nullptr);
+  TVM_FFI_CHECK(!cold || cache_flush_bytes > 0, ValueError)
+      << "The cold measurement needs cache_flush_bytes > 0 to flush the caches before each run";
 
   auto ftimer = [pf, dev, number, repeat, min_repeat_ms, limit_zero_time_iterations,
-                 cooldown_interval_ms, repeats_to_cooldown, cache_flush_bytes,
-                 f_preproc](const ffi::AnyView* args, int num_args, ffi::Any* rv) mutable {
+                 cooldown_interval_ms, repeats_to_cooldown, cache_flush_bytes, f_preproc,
+                 max_relative_ci,
+                 cold](const ffi::AnyView* args, int num_args, ffi::Any* rv) mutable {
     ffi::Any temp;
     std::ostringstream os;
     // skip first time call, to activate lazy compilation components.
     pf.CallPacked(args, num_args, &temp);
 
-    // allocate two large arrays to flush L2 cache
-    Tensor arr1, arr2;
+    std::function<void()> flush_cache;
     if (cache_flush_bytes > 0) {
-      arr1 = Tensor::Empty({cache_flush_bytes / 4}, {kDLInt, 32, 1}, dev);
-      arr2 = Tensor::Empty({cache_flush_bytes / 4}, {kDLInt, 32, 1}, dev);
+      flush_cache = GetCacheFlush(dev, cache_flush_bytes);
     }
 
     DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
 
+    std::vector<double> costs;
     for (int i = 0; i < repeat; ++i) {
       if (f_preproc != nullptr) {
         f_preproc.CallPacked(args, num_args, &temp);
@@ -143,23 +198,41 @@ ffi::Function WrapTimeEvaluator(ffi::Function pf, Device dev, int number, int re
           number = static_cast<int>(
               std::max((min_repeat_ms / (duration_ms / number) + 1), number * golden_ratio));
         }
-        if (cache_flush_bytes > 0) {
-          arr1.CopyFrom(arr2);
+        int64_t t_nanos = 0;
+        if (cold) {
+          // Time each run alone, after the caches are flushed.
+          for (int j = 0; j < number; ++j) {
+            flush_cache();
+            DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+            Timer t = Timer::Start(dev);
+            pf.CallPacked(args, num_args, &temp);
+            t->Stop();
+            t_nanos += t->SyncAndGetElapsedNanos();
+          }
+        } else {
+          if (cache_flush_bytes > 0) {
+            flush_cache();
+          }
+          DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+          // start timing
+          Timer t = Timer::Start(dev);
+          for (int j = 0; j < number; ++j) {
+            pf.CallPacked(args, num_args, &temp);
+          }
+          t->Stop();
+          t_nanos = t->SyncAndGetElapsedNanos();
         }
-        DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
-        // start timing
-        Timer t = Timer::Start(dev);
-        for (int j = 0; j < number; ++j) {
-          pf.CallPacked(args, num_args, &temp);
-        }
-        t->Stop();
-        int64_t t_nanos = t->SyncAndGetElapsedNanos();
         if (t_nanos == 0) absolute_zero_times++;
         duration_ms = t_nanos / 1e6;
       } while (duration_ms < min_repeat_ms && absolute_zero_times < limit_zero_time_iterations);
 
       double speed = duration_ms / 1e3 / number;
       os.write(reinterpret_cast<char*>(&speed), sizeof(speed));
+      costs.push_back(speed);
+
+      if (max_relative_ci > 0.0 && ConfidenceIntervalWithin(costs, max_relative_ci)) {
+        break;
+      }
 
       if (cooldown_interval_ms > 0 && (i % repeats_to_cooldown) == 0) {
         std::this_thread::sleep_for(std::chrono::milliseconds(cooldown_interval_ms));
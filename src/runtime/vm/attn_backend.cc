@@ -43,6 +43,17 @@ std::unique_ptr<PagedPrefillFunc> ConvertPagedPrefillFunc(ffi::Array<ffi::Any> a
     return std::make_unique<FlashInferPagedPrefillFunc>(std::move(attn_func), std::move(plan_func),
                                                         attn_kind);
   }
+  if (backend_name == "auto") {
+    // The candidates follow the backend name, each in the arguments of its own backend.
+    TVM_FFI_ICHECK_GE(args.size(), 2);
+    std::vector<std::unique_ptr<PagedPrefillFunc>> candidates;
+    for (size_t i = 1; i < args.size(); ++i) {
+      candidates.push_back(
+          ConvertPagedPrefillFunc(args[i].cast<ffi::Array<ffi::Any>>(), attn_kind));
+      TVM_FFI_ICHECK(candidates.back() != nullptr) << "The candidate backends cannot be empty";
+    }
+    return std::make_unique<AutoPagedPrefillFunc>(std::move(candidates), attn_kind);
+  }
   TVM_FFI_THROW(InternalError) << "Cannot reach here";
   throw;
 }
@@ -75,6 +86,17 @@ std::unique_ptr<RaggedPrefillFunc> ConvertRaggedPrefillFunc(ffi::Array<ffi::Any>
                                                          attn_kind, qk_head_dim_override,
                                                          v_head_dim_override);
   }
+  if (backend_name == "auto") {
+    // The candidates follow the backend name, each in the arguments of its own backend.
+    TVM_FFI_ICHECK_GE(args.size(), 2);
+    std::vector<std::unique_ptr<RaggedPrefillFunc>> candidates;
+    for (size_t i = 1; i < args.size(); ++i) {
+      candidates.push_back(
+          ConvertRaggedPrefillFunc(args[i].cast<ffi::Array<ffi::Any>>(), attn_kind));
+      TVM_FFI_ICHECK(candidates.back() != nullptr) << "The candidate backends cannot be empty";
+    }
+    return std::make_unique<AutoRaggedPrefillFunc>(std::move(candidates), attn_kind);
+  }
   TVM_FFI_THROW(InternalError) << "Cannot reach here";
   throw;
 }
@@ -97,6 +119,16 @@ std::unique_ptr<PagedDecodeFunc> ConvertPagedDecodeFunc(ffi::Array<ffi::Any> arg
     return std::make_unique<FlashInferPagedDecodeFunc>(std::move(attn_func), std::move(plan_func),
                                                        attn_kind);
   }
+  if (backend_name == "auto") {
+    // The candidates follow the backend name, each in the arguments of its own backend.
+    TVM_FFI_ICHECK_GE(args.size(), 2);
+    std::vector<std::unique_ptr<PagedDecodeFunc>> candidates;
+    for (size_t i = 1; i < args.size(); ++i) {
+      candidates.push_back(ConvertPagedDecodeFunc(args[i].cast<ffi::Array<ffi::Any>>(), attn_kind));
+      TVM_FFI_ICHECK(candidates.back() != nullptr) << "The candidate backends cannot be empty";
+    }
+    return std::make_unique<AutoPagedDecodeFunc>(std::move(candidates), attn_kind);
+  }
   TVM_FFI_THROW(InternalError) << "Cannot reach here";
   throw;
 }
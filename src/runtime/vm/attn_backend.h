@@ -32,8 +32,12 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -47,6 +51,8 @@ namespace vm {
 enum class AttnBackendKind : int {
   kTIR = 0,
   kFlashInfer = 1,
+  /*! \brief Select one of multiple backends per batch shape, see AttnBackendSelector. */
+  kAuto = 2,
 };
 
 /*!
@@ -201,10 +207,12 @@ class PagedPrefillFunc : public AttnBackendFunc {
                             AttnBackendKind backend_kind)
       : AttnBackendFunc(std::move(attn_func), attn_kind, backend_kind) {}
 
-  virtual void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, Tensor page_indptr,
-                   Tensor page_indices, Tensor length_info, Tensor q_rope_position,
-                   Tensor k_rope_pos_offset, bool causal, RoPEMode rope_mode, double rotary_scale,
-                   double rotary_theta, double sm_scale, Tensor attn_output, Tensor attn_lse,
+  /*! \note The page scales are defined only when the KV data in pages is quantized. */
+  virtual void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages,
+                   ffi::Optional<Tensor> page_scales, Tensor page_indptr, Tensor page_indices,
+                   Tensor length_info, Tensor q_rope_position, Tensor k_rope_pos_offset,
+                   bool causal, RoPEMode rope_mode, double rotary_scale, double rotary_theta,
+                   double sm_scale, Tensor attn_output, Tensor attn_lse,
                    TVMStreamHandle compute_stream) {
     TVM_FFI_THROW(InternalError) << "MHA computation is not supported by the current backend";
   }
@@ -231,11 +239,20 @@ class TIRPagedPrefillFunc : public PagedPrefillFunc {
   explicit TIRPagedPrefillFunc(ffi::Function attn_func, AttnKind attn_kind)
       : PagedPrefillFunc(std::move(attn_func), attn_kind, AttnBackendKind::kTIR) {}
 
-  void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, Tensor page_indptr,
-           Tensor page_indices, Tensor length_info, Tensor q_rope_position,
+  void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor q_rope_position,
            Tensor k_rope_pos_offset, bool causal, RoPEMode rope_mode, double rotary_scale,
            double rotary_theta, double sm_scale, Tensor attn_output, Tensor attn_lse,
            TVMStreamHandle compute_stream) final {
+    if (page_scales.has_value()) {
+      // The kernel for quantized KV data takes the page scales right after the pages.
+      attn_func_(q, qo_indptr, pages, page_scales.value(), page_indptr, page_indices, length_info,
+                 k_rope_pos_offset, q_rope_position, attn_output, attn_lse,
+                 static_cast<int64_t>(causal),
+                 /*rotary_mode=*/static_cast<int64_t>(rope_mode == RoPEMode::kInline),
+                 rotary_scale, rotary_theta, sm_scale);
+      return;
+    }
     attn_func_(q, qo_indptr, pages, page_indptr, page_indices, length_info, k_rope_pos_offset,
                q_rope_position, attn_output, attn_lse, static_cast<int64_t>(causal),
                /*rotary_mode=*/static_cast<int64_t>(rope_mode == RoPEMode::kInline), rotary_scale,
@@ -258,8 +275,8 @@ class FlashInferPagedPrefillFunc : public PagedPrefillFunc {
       : PagedPrefillFunc(std::move(attn_func), attn_kind, AttnBackendKind::kFlashInfer),
         plan_func_(std::move(plan_func)) {}
 
-  void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, Tensor page_indptr,
-           Tensor page_indices, Tensor length_info, Tensor q_rope_position,
+  void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor q_rope_position,
            Tensor k_rope_pos_offset, bool causal, RoPEMode rope_mode, double rotary_scale,
            double rotary_theta, double sm_scale, Tensor attn_output, Tensor attn_lse,
            TVMStreamHandle compute_stream) final {
@@ -475,10 +492,12 @@ class PagedDecodeFunc : public AttnBackendFunc {
                            AttnBackendKind backend_kind)
       : AttnBackendFunc(std::move(attn_func), attn_kind, backend_kind) {}
 
-  virtual void MHA(int depth, Tensor q, Tensor pages, Tensor page_indptr, Tensor page_indices,
-                   Tensor length_info, Tensor k_rope_pos_offset, Tensor q_rope_position,
-                   RoPEMode rope_mode, double rotary_scale, double rotary_theta, double sm_scale,
-                   Tensor attn_output, Tensor attn_lse, TVMStreamHandle compute_stream) {
+  /*! \note The page scales are defined only when the KV data in pages is quantized. */
+  virtual void MHA(int depth, Tensor q, Tensor pages, ffi::Optional<Tensor> page_scales,
+                   Tensor page_indptr, Tensor page_indices, Tensor length_info,
+                   Tensor k_rope_pos_offset, Tensor q_rope_position, RoPEMode rope_mode,
+                   double rotary_scale, double rotary_theta, double sm_scale, Tensor attn_output,
+                   Tensor attn_lse, TVMStreamHandle compute_stream) {
     TVM_FFI_THROW(InternalError) << "MHA computation is not supported by the current backend";
   }
 
@@ -504,10 +523,19 @@ class TIRPagedDecodeFunc : public PagedDecodeFunc {
   explicit TIRPagedDecodeFunc(ffi::Function attn_func, AttnKind attn_kind)
       : PagedDecodeFunc(std::move(attn_func), attn_kind, AttnBackendKind::kTIR) {}
 
-  void MHA(int depth, Tensor q, Tensor pages, Tensor page_indptr, Tensor page_indices,
-           Tensor length_info, Tensor k_rope_pos_offset, Tensor q_rope_position, RoPEMode rope_mode,
-           double rotary_scale, double rotary_theta, double sm_scale, Tensor attn_output,
-           Tensor attn_lse, TVMStreamHandle compute_stream) final {
+  void MHA(int depth, Tensor q, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor k_rope_pos_offset,
+           Tensor q_rope_position, RoPEMode rope_mode, double rotary_scale, double rotary_theta,
+           double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
+    if (page_scales.has_value()) {
+      // The kernel for quantized KV data takes the page scales right after the pages.
+      attn_func_(q, pages, page_scales.value(), page_indptr, page_indices, length_info,
+                 k_rope_pos_offset, q_rope_position, attn_output, attn_lse,
+                 /*rotary_mode=*/static_cast<int64_t>(rope_mode == RoPEMode::kInline),
+                 rotary_scale, rotary_theta, sm_scale);
+      return;
+    }
     attn_func_(q, pages, page_indptr, page_indices, length_info, k_rope_pos_offset, q_rope_position,
                attn_output, attn_lse,
                /*rotary_mode=*/static_cast<int64_t>(rope_mode == RoPEMode::kInline), rotary_scale,
@@ -529,10 +557,11 @@ class FlashInferPagedDecodeFunc : public PagedDecodeFunc {
       : PagedDecodeFunc(std::move(attn_func), attn_kind, AttnBackendKind::kFlashInfer),
         plan_func_(std::move(plan_func)) {}
 
-  void MHA(int depth, Tensor q, Tensor pages, Tensor page_indptr, Tensor page_indices,
-           Tensor length_info, Tensor k_rope_pos_offset, Tensor q_rope_position, RoPEMode rope_mode,
-           double rotary_scale, double rotary_theta, double sm_scale, Tensor attn_output,
-           Tensor attn_lse, TVMStreamHandle compute_stream) final {
+  void MHA(int depth, Tensor q, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor k_rope_pos_offset,
+           Tensor q_rope_position, RoPEMode rope_mode, double rotary_scale, double rotary_theta,
+           double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
     auto [float_workspace_buffer, int_workspace_buffer, page_locked_int_workspace_buffer,
           plan_info_vec] = cached_buffers_[depth];
     double rope_rcp_scale = 1 / rotary_scale;
@@ -673,6 +702,267 @@ class TIRRaggedPrefillTreeMaskFunc : public RaggedPrefillTreeMaskFunc {
   }
 };
 
+/*!
+ * \brief The table that selects one of multiple attention backends for each batch shape.
+ *
+ * The batch shapes are keyed by the power-of-two buckets of their dimensions. The first
+ * forwards of a bucket run the candidates in turn and time their kernels on device, which is
+ * the warm-up, and the bucket then keeps the candidate of the smallest time. The selection is
+ * made in BeginForward for each depth, so that the plan and the kernels of a forward come from
+ * the same backend.
+ */
+class AttnBackendSelector {
+ public:
+  explicit AttnBackendSelector(int num_candidates) : num_candidates_(num_candidates) {}
+
+  /*! \brief The key of a batch shape, from the power-of-two buckets of its dimensions. */
+  static uint64_t ShapeKey(std::initializer_list<int64_t> dims) {
+    uint64_t key = 0;
+    for (int64_t dim : dims) {
+      uint64_t bucket = 0;
+      while ((int64_t{1} << bucket) < dim && bucket < 62) {
+        ++bucket;
+      }
+      key = (key << 6) | bucket;
+    }
+    return key;
+  }
+
+  /*! \brief Select the candidate of the depth for the batch shape of the given key. */
+  int Select(int depth, uint64_t key) {
+    if (depths_.size() <= static_cast<size_t>(depth)) {
+      depths_.resize(depth + 1);
+    }
+    DepthState& state = depths_[depth];
+    Flush(&state);
+    Measurement& measurement = table_[key];
+    if (measurement.min_time_us.empty()) {
+      measurement.min_time_us.resize(num_candidates_, std::numeric_limits<double>::max());
+    }
+    state.key = key;
+    state.measuring = measurement.num_runs < num_candidates_ * kNumWarmupRuns;
+    state.candidate =
+        state.measuring ? measurement.num_runs % num_candidates_ : measurement.best_candidate;
+    state.time_us = 0;
+    return state.candidate;
+  }
+
+  /*!
+   * \brief Run a kernel of the selected candidate of the depth, or of the first candidate when
+   * the depth has no selection. The kernel is timed in warm-up.
+   */
+  template <typename FRun>
+  void Run(int depth, Device device, TVMStreamHandle stream, FRun f_run) {
+    if (static_cast<size_t>(depth) >= depths_.size() || depths_[depth].candidate == -1) {
+      f_run(0);
+      return;
+    }
+    DepthState& state = depths_[depth];
+    if (!state.measuring) {
+      f_run(state.candidate);
+      return;
+    }
+    DeviceAPI::Get(device)->StreamSync(device, stream);
+    auto start = std::chrono::steady_clock::now();
+    f_run(state.candidate);
+    DeviceAPI::Get(device)->StreamSync(device, stream);
+    state.time_us +=
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+            .count();
+  }
+
+ private:
+  /*! \brief The runs of a candidate at warm-up for each bucket. */
+  static constexpr const int kNumWarmupRuns = 3;
+
+  /*! \brief The measured times of the candidates for a bucket. */
+  struct Measurement {
+    std::vector<double> min_time_us;
+    int num_runs = 0;
+    int best_candidate = 0;
+  };
+
+  /*! \brief The selection of a depth in the current forward. */
+  struct DepthState {
+    uint64_t key = 0;
+    int candidate = -1;
+    bool measuring = false;
+    double time_us = 0;
+  };
+
+  /*! \brief Record the time of the previous forward of the depth into the table. */
+  void Flush(DepthState* state) {
+    if (!state->measuring || state->time_us == 0) {
+      // No kernel ran with the selection, e.g. when the depth used the tree attention kernel.
+      state->measuring = false;
+      return;
+    }
+    Measurement& measurement = table_[state->key];
+    double& min_time_us = measurement.min_time_us[state->candidate];
+    min_time_us = std::min(min_time_us, state->time_us);
+    if (++measurement.num_runs == num_candidates_ * kNumWarmupRuns) {
+      measurement.best_candidate =
+          std::min_element(measurement.min_time_us.begin(), measurement.min_time_us.end()) -
+          measurement.min_time_us.begin();
+      VLOG(1) << "Attention backend " << measurement.best_candidate << " is selected for shape key "
+              << state->key << " with time " << measurement.min_time_us[measurement.best_candidate]
+              << "us";
+    }
+    state->measuring = false;
+  }
+
+  int num_candidates_;
+  std::unordered_map<uint64_t, Measurement> table_;
+  std::vector<DepthState> depths_;
+};
+
+/*! \brief The paged prefill attention function that selects among multiple backends. */
+class AutoPagedPrefillFunc : public PagedPrefillFunc {
+ public:
+  explicit AutoPagedPrefillFunc(std::vector<std::unique_ptr<PagedPrefillFunc>> candidates,
+                                AttnKind attn_kind)
+      : PagedPrefillFunc(ffi::Function(), attn_kind, AttnBackendKind::kAuto),
+        candidates_(std::move(candidates)),
+        selector_(static_cast<int>(candidates_.size())) {}
+
+  void MHA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor q_rope_position,
+           Tensor k_rope_pos_offset, bool causal, RoPEMode rope_mode, double rotary_scale,
+           double rotary_theta, double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
+    selector_.Run(depth, q->device, compute_stream, [&](int candidate) {
+      candidates_[candidate]->MHA(depth, q, qo_indptr, pages, page_scales, page_indptr,
+                                  page_indices, length_info, q_rope_position, k_rope_pos_offset,
+                                  causal, rope_mode, rotary_scale, rotary_theta, sm_scale,
+                                  attn_output, attn_lse, compute_stream);
+    });
+  }
+
+  void MLA(int depth, Tensor q, Tensor qo_indptr, Tensor pages, Tensor page_indptr,
+           Tensor page_indices, Tensor length_info, bool causal, double sm_scale,
+           Tensor attn_output, Tensor attn_lse, TVMStreamHandle compute_stream) final {
+    selector_.Run(depth, q->device, compute_stream, [&](int candidate) {
+      candidates_[candidate]->MLA(depth, q, qo_indptr, pages, page_indptr, page_indices,
+                                  length_info, causal, sm_scale, attn_output, attn_lse,
+                                  compute_stream);
+    });
+  }
+
+  void BeginForward(int depth, Tensor float_workspace_buffer, Tensor int_workspace_buffer,
+                    Tensor page_locked_int_workspace_buffer, HostMemoryVector* qo_indptr,
+                    HostMemoryVector* page_indptr, HostMemoryVector* last_page_len,
+                    int64_t batch_size, int64_t total_qo_len, int64_t page_size,
+                    int64_t num_qo_heads, int64_t num_kv_heads, int64_t qk_head_dim,
+                    int64_t v_head_dim, bool causal, TVMStreamHandle copy_stream) final {
+    int64_t num_pages = page_indptr->back();
+    uint64_t key = AttnBackendSelector::ShapeKey(
+        {batch_size, total_qo_len / std::max<int64_t>(batch_size, 1),
+         num_pages * page_size / std::max<int64_t>(batch_size, 1), num_qo_heads / num_kv_heads});
+    int candidate = selector_.Select(depth, key);
+    candidates_[candidate]->BeginForward(
+        depth, float_workspace_buffer, int_workspace_buffer, page_locked_int_workspace_buffer,
+        qo_indptr, page_indptr, last_page_len, batch_size, total_qo_len, page_size, num_qo_heads,
+        num_kv_heads, qk_head_dim, v_head_dim, causal, copy_stream);
+  }
+
+ private:
+  std::vector<std::unique_ptr<PagedPrefillFunc>> candidates_;
+  AttnBackendSelector selector_;
+};
+
+/*! \brief The ragged prefill attention function that selects among multiple backends. */
+class AutoRaggedPrefillFunc : public RaggedPrefillFunc {
+ public:
+  explicit AutoRaggedPrefillFunc(std::vector<std::unique_ptr<RaggedPrefillFunc>> candidates,
+                                 AttnKind attn_kind)
+      : RaggedPrefillFunc(ffi::Function(), attn_kind, AttnBackendKind::kAuto),
+        candidates_(std::move(candidates)),
+        selector_(static_cast<int>(candidates_.size())) {}
+
+  void MHA(Tensor q, Tensor k, Tensor v, Tensor qo_indptr, Tensor kv_indptr, Tensor q_rope_position,
+           Tensor k_rope_pos_offset, bool causal, RoPEMode rope_mode, double rotary_scale,
+           double rotary_theta, double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
+    selector_.Run(/*depth=*/0, q->device, compute_stream, [&](int candidate) {
+      candidates_[candidate]->MHA(q, k, v, qo_indptr, kv_indptr, q_rope_position,
+                                  k_rope_pos_offset, causal, rope_mode, rotary_scale,
+                                  rotary_theta, sm_scale, attn_output, attn_lse, compute_stream);
+    });
+  }
+
+  void BeginForward(Tensor float_workspace_buffer, Tensor int_workspace_buffer,
+                    Tensor page_locked_int_workspace_buffer, HostMemoryVector* qo_indptr,
+                    HostMemoryVector* kv_indptr, int64_t batch_size, int64_t total_qo_len,
+                    int64_t num_qo_heads, int64_t num_kv_heads, int64_t qk_head_dim,
+                    int64_t v_head_dim, bool causal, TVMStreamHandle copy_stream) final {
+    uint64_t key = AttnBackendSelector::ShapeKey(
+        {batch_size, total_qo_len / std::max<int64_t>(batch_size, 1), num_qo_heads / num_kv_heads});
+    int candidate = selector_.Select(/*depth=*/0, key);
+    candidates_[candidate]->BeginForward(float_workspace_buffer, int_workspace_buffer,
+                                         page_locked_int_workspace_buffer, qo_indptr, kv_indptr,
+                                         batch_size, total_qo_len, num_qo_heads, num_kv_heads,
+                                         qk_head_dim, v_head_dim, causal, copy_stream);
+  }
+
+ private:
+  std::vector<std::unique_ptr<RaggedPrefillFunc>> candidates_;
+  AttnBackendSelector selector_;
+};
+
+/*! \brief The paged decode attention function that selects among multiple backends. */
+class AutoPagedDecodeFunc : public PagedDecodeFunc {
+ public:
+  explicit AutoPagedDecodeFunc(std::vector<std::unique_ptr<PagedDecodeFunc>> candidates,
+                               AttnKind attn_kind)
+      : PagedDecodeFunc(ffi::Function(), attn_kind, AttnBackendKind::kAuto),
+        candidates_(std::move(candidates)),
+        selector_(static_cast<int>(candidates_.size())) {}
+
+  void MHA(int depth, Tensor q, Tensor pages, ffi::Optional<Tensor> page_scales,
+           Tensor page_indptr, Tensor page_indices, Tensor length_info, Tensor k_rope_pos_offset,
+           Tensor q_rope_position, RoPEMode rope_mode, double rotary_scale, double rotary_theta,
+           double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
+    selector_.Run(depth, q->device, compute_stream, [&](int candidate) {
+      candidates_[candidate]->MHA(depth, q, pages, page_scales, page_indptr, page_indices,
+                                  length_info, k_rope_pos_offset, q_rope_position, rope_mode,
+                                  rotary_scale, rotary_theta, sm_scale, attn_output, attn_lse,
+                                  compute_stream);
+    });
+  }
+
+  void MLA(int depth, Tensor q, Tensor pages, Tensor page_indptr, Tensor page_indices,
+           Tensor length_info, double sm_scale, Tensor attn_output, Tensor attn_lse,
+           TVMStreamHandle compute_stream) final {
+    selector_.Run(depth, q->device, compute_stream, [&](int candidate) {
+      candidates_[candidate]->MLA(depth, q, pages, page_indptr, page_indices, length_info,
+                                  sm_scale, attn_output, attn_lse, compute_stream);
+    });
+  }
+
+  void BeginForward(int depth, Tensor float_workspace_buffer, Tensor int_workspace_buffer,
+                    Tensor page_locked_int_workspace_buffer, HostMemoryVector* page_indptr,
+                    int64_t batch_size, int64_t page_size, int64_t num_qo_heads,
+                    int64_t num_kv_heads, int64_t qk_head_dim, int64_t v_head_dim,
+                    RoPEMode rope_mode, DLDataType q_dtype, DLDataType kv_dtype,
+                    TVMStreamHandle copy_stream) final {
+    int64_t num_pages = page_indptr->back();
+    uint64_t key = AttnBackendSelector::ShapeKey(
+        {batch_size, num_pages * page_size / std::max<int64_t>(batch_size, 1),
+         num_qo_heads / num_kv_heads});
+    int candidate = selector_.Select(depth, key);
+    candidates_[candidate]->BeginForward(depth, float_workspace_buffer, int_workspace_buffer,
+                                         page_locked_int_workspace_buffer, page_indptr,
+                                         batch_size, page_size, num_qo_heads, num_kv_heads,
+                                         qk_head_dim, v_head_dim, rope_mode, q_dtype, kv_dtype,
+                                         copy_stream);
+  }
+
+ private:
+  std::vector<std::unique_ptr<PagedDecodeFunc>> candidates_;
+  AttnBackendSelector selector_;
+};
+
 /*!
  * \brief Create a PagedPrefillFunc from the given arguments and the attention kind.
  * \param args The arguments that contains the backend kind and the runtime attention
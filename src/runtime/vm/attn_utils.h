@@ -31,6 +31,7 @@
 #include <tvm/support/cuda/nvtx.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -105,6 +106,12 @@ struct Block {
    * words, different blocks do not share pages).
    */
   std::vector<int32_t> page_ids;
+  /*!
+   * \brief The ids of the host pages that hold the KV data of the block
+   * when the block is swapped out to host memory. It is empty when the
+   * block resides on device, in which case `page_ids` is used.
+   */
+  std::vector<int32_t> host_page_ids;
   /*! \brief The total sequence length in the block. */
   int32_t seq_length = 0;
   /*!
@@ -142,6 +149,7 @@ struct Block {
   /*! \brief Reset the block data. */
   void Reset() {
     page_ids.clear();
+    host_page_ids.clear();
     seq_length = 0;
     start_pos = 0;
     sink_length = 0;
@@ -155,6 +163,8 @@ struct KVTransferMetadata {
   int64_t start = std::numeric_limits<int64_t>::max();
   std::vector<int64_t> remote_position_map;
   int32_t recver_pe_offset = -1;
+  /*! \brief The slot of the recver's completion signal, or -1 if the recver has no signal. */
+  int32_t recver_signal_slot = -1;
   std::vector<int64_t> local_position_map;
 };
 
@@ -199,6 +209,11 @@ struct Sequence {
    * this sequence are committed
    */
   bool accepted_indices_committed = true;
+  /*!
+   * \brief A boolean denoting whether the KV data of the blocks exclusively
+   * owned by this sequence are swapped out to host memory.
+   */
+  bool is_swapped_out = false;
 
   explicit Sequence(std::vector<Block>* global_block_pool, int32_t last_block_idx) {
     ++global_block_pool->at(last_block_idx).external_ref_cnt;
@@ -229,6 +244,40 @@ struct Sequence {
   }
 };
 
+/*!
+ * \brief The node structure of the prefix radix tree in paged KV cache.
+ * The radix tree is content-addressed by token ids. Each node holds
+ * a page-aligned segment of tokens appended to the tokens of its parent
+ * node, and keeps one external reference of the block whose block chain
+ * stores the KV data of all the tokens from the root to this node.
+ * The referenced block chain is read-only (copy-on-write) as long as
+ * the node is alive.
+ */
+struct PrefixTreeNode {
+  /*! \brief The token ids of this node, excluding the tokens of ancestors. */
+  std::vector<int32_t> token_ids;
+  /*! \brief The total number of tokens from the root to the end of this node. */
+  int32_t end_pos = 0;
+  /*! \brief The global index of the block referenced by this node, or -1 for the root. */
+  int32_t block_idx = -1;
+  /*! \brief The index of the parent node, or -1 for the root. */
+  int32_t parent_idx = -1;
+  /*! \brief The indices of the children nodes. */
+  std::vector<int32_t> child_indices;
+  /*! \brief The logical timestamp of the last access, used for LRU eviction. */
+  uint64_t last_access_time = 0;
+
+  /*! \brief Reset the node data. */
+  void Reset() {
+    token_ids.clear();
+    end_pos = 0;
+    block_idx = -1;
+    parent_idx = -1;
+    child_indices.clear();
+    last_access_time = 0;
+  }
+};
+
 /*!
  * \brief For the given list of sequences, check the block trace of
  * each sequence, and return the blocks ids used by the sequences
@@ -278,6 +327,25 @@ GetBlockIdsOnDepth(const std::vector<Sequence*>& sequences,
   return {block_ids_on_depths, trailing_block_traces};
 }
 
+/*!
+ * \brief The minimum ratio of the pages that the decode kernel reads on a depth to the pages
+ * that the coalesced attention reads, for a decode request to coalesce the depth.
+ *
+ * Coalescing the sequences that share the blocks of a depth gives the cascade attention: the
+ * attention over a shared prefix is computed once for all the queries of its sequences by the
+ * prefill kernel, and merged with the attention of the other depths. The decode kernel instead
+ * reads the shared pages once per sequence, so for n-best sampling of n sequences and for
+ * shared system prompts the coalescing cuts the KV reads of the prefix by n times.
+ * TVM_KV_CACHE_CASCADE_MIN_RATIO overrides the default.
+ */
+inline double CascadeMinCoalesceRatio() {
+  static const double ratio = []() {
+    const char* value = std::getenv("TVM_KV_CACHE_CASCADE_MIN_RATIO");
+    return value != nullptr ? std::atof(value) : 4.0;
+  }();
+  return ratio;
+}
+
 /*!
  * \brief This function considers an optimization which coalesces
  * adjacent decode attention computations into a single prefill
@@ -326,7 +394,7 @@ inline std::pair<std::vector<std::pair<int32_t, int32_t>>, bool> GetChunkedBlock
   double coalesce_ratio =
       page_counter_coalesced > 0 ? 1.0 * page_counter_uncoalesced / page_counter_coalesced : 0.0;
   // Do not coalesce and use batch decode kernel when coalesce ratio is small.
-  bool use_decode_kernel = is_decode_request && coalesce_ratio < 32;
+  bool use_decode_kernel = is_decode_request && coalesce_ratio < CascadeMinCoalesceRatio();
   return {use_decode_kernel || !enable_coalesce ? uncoalesced_block_ids : coalesced_block_ids,
           use_decode_kernel};
 }
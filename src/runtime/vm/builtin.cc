@@ -34,6 +34,9 @@
 #include <tvm/runtime/vm/bytecode.h>
 #include <tvm/runtime/vm/vm.h>
 
+#include <algorithm>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 
 namespace tvm {
@@ -66,9 +69,59 @@ Tensor AllocShapeHeap(void* ctx_ptr, int64_t size) {
   return alloc->Empty({size}, DLDataType{kDLInt, 64, 1}, vm->devices[host_device_index]);
 }
 
+/*! \brief The shape heaps kept across the calls of the functions of a VM. */
+class ShapeHeapCacheExtensionNode : public VMExtensionNode {
+ public:
+  /*!
+   * \brief Get the heap of the function, allocated and zero-filled on the first call.
+   * \param vm The VM.
+   * \param size The size of the heap.
+   * \param func_name The function the heap belongs to.
+   */
+  Tensor Get(VirtualMachine* vm, int64_t size, const ffi::String& func_name) {
+    auto it = heaps_.find(func_name);
+    if (it != heaps_.end() && it->second.Shape()[0] == size) return it->second;
+    Tensor heap = AllocShapeHeap(vm, size);
+    std::fill_n(static_cast<int64_t*>(heap->data), size, 0);
+    heaps_[func_name] = heap;
+    return heap;
+  }
+
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("vm.ShapeHeapCacheExtension", ShapeHeapCacheExtensionNode,
+                                    VMExtensionNode);
+
+ private:
+  std::unordered_map<std::string, Tensor> heaps_;
+};
+
+/*! Managed reference to ShapeHeapCacheExtensionNode */
+class ShapeHeapCacheExtension : public VMExtension {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(ShapeHeapCacheExtension, VMExtension,
+                                             ShapeHeapCacheExtensionNode);
+  static ShapeHeapCacheExtension Create() {
+    return ShapeHeapCacheExtension(ffi::make_object<ShapeHeapCacheExtensionNode>());
+  }
+};
+
+/*!
+ * \brief Builtin function to get the shape heap a function keeps across its calls.
+ * \param ctx_ptr The context module pointer.
+ * \param size the size of the heap.
+ * \param func_name The name of the function.
+ * \return The shape heap, whose values are those of the end of the last call.
+ */
+Tensor AllocCachedShapeHeap(void* ctx_ptr, int64_t size, ffi::String func_name) {
+  VirtualMachine* vm = static_cast<VirtualMachine*>(ctx_ptr);
+  return vm->GetOrCreateExtension<ShapeHeapCacheExtension>()->Get(vm, size, func_name);
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
-  refl::GlobalDef().def("vm.builtin.alloc_shape_heap", AllocShapeHeap);
+  refl::GlobalDef()
+      .def("vm.builtin.alloc_shape_heap", AllocShapeHeap)
+      .def("vm.builtin.alloc_cached_shape_heap", AllocCachedShapeHeap);
 }
 
 /*!
@@ -574,6 +627,113 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       });
 }
 
+//-------------------------------------
+//  Asynchronous host device copies.
+//-------------------------------------
+/*! \brief Whether the memory of the device is on the host. */
+bool IsHostDevice(Device dev) {
+  return dev.device_type == kDLCPU || dev.device_type == kDLCUDAHost ||
+         dev.device_type == kDLROCMHost;
+}
+
+/*!
+ * \brief Get the stream of a device that the asynchronous host to device copies are issued to,
+ *  created at the first use and alive until exit. nullptr when the device has no stream.
+ */
+TVMStreamHandle GetHostToDeviceCopyStream(Device dev) {
+  static std::mutex mutex;
+  static auto* streams = new std::unordered_map<Device, TVMStreamHandle>();
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = streams->find(dev);
+  if (it == streams->end()) {
+    it = streams->emplace(dev, DeviceAPI::Get(dev)->CreateStream(dev)).first;
+  }
+  return it->second;
+}
+
+/*!
+ * \brief Allocate a tensor in the page-locked host memory of a device.
+ * \param shape The shape of the tensor.
+ * \param dtype The data type of the tensor.
+ * \param device The device that copies from and to the tensor.
+ * \return The tensor on `PinnedHostDevice(device)`.
+ */
+Tensor AllocPinnedHostTensor(ffi::Shape shape, DLDataType dtype, Device device) {
+  return MemoryManager::GetOrCreatePinnedHostAllocator(device)->Empty(shape, dtype,
+                                                                      PinnedHostDevice(device));
+}
+
+/*!
+ * \brief Copy a host tensor to a device on the copy stream of the device, without blocking the
+ *  host. The current stream of the device waits for the copy, so the kernels launched earlier
+ *  overlap with it, while the kernels launched later consume its result.
+ *
+ *  The copy is only asynchronous when the host tensor is page-locked, in which case the host
+ *  tensor must not be modified until the device is synchronized, e.g. by alternating between
+ *  two page-locked input buffers across the steps. It falls back to a synchronous copy when
+ *  the tensor is not on the host or the device has no stream.
+ *
+ * \param data The host tensor.
+ * \param dst_device The device to copy to.
+ * \param mem_scope The memory scope of the result.
+ * \return The tensor on the device.
+ */
+Tensor ToDeviceAsync(Tensor data, Device dst_device, ffi::String mem_scope) {
+  if (!IsHostDevice(data->device) || IsHostDevice(dst_device)) {
+    return data.CopyTo(dst_device, mem_scope);
+  }
+  TVMStreamHandle copy_stream = GetHostToDeviceCopyStream(dst_device);
+  if (copy_stream == nullptr) {
+    return data.CopyTo(dst_device, mem_scope);
+  }
+  DeviceAPI* api = DeviceAPI::Get(dst_device);
+  // The memory is freshly allocated from the device rather than a pool, so there are no pending
+  // reads of its previous content on the current stream that the copy could overwrite.
+  Tensor result = Tensor::Empty(data.Shape(), data->dtype, dst_device, mem_scope);
+  DLTensor copy_dst = *result.operator->();
+  Tensor::CopyFromTo(data.operator->(), &copy_dst, copy_stream);
+  api->SyncStreamFromTo(dst_device, copy_stream, api->GetCurrentStream(dst_device));
+  return result;
+}
+
+/*!
+ * \brief Copy a device tensor to the page-locked host memory on the current stream of the
+ *  device, without blocking the host. The host must synchronize the device before reading the
+ *  result.
+ * \param data The device tensor.
+ * \return The tensor in the page-locked host memory of the device.
+ */
+Tensor ToHostAsync(Tensor data) {
+  Device src_device = data->device;
+  if (IsHostDevice(src_device)) {
+    return data;
+  }
+  Tensor result = AllocPinnedHostTensor(data.Shape(), data->dtype, src_device);
+  DLTensor copy_dst = *result.operator->();
+  Tensor::CopyFromTo(data.operator->(), &copy_dst,
+                     DeviceAPI::Get(src_device)->GetCurrentStream(src_device));
+  return result;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("vm.builtin.alloc_pinned_host_tensor", AllocPinnedHostTensor)
+      .def_packed("vm.builtin.to_device_async",
+                  [](ffi::PackedArgs args, ffi::Any* rv) {
+                    Tensor data = args[0].cast<Tensor>();
+                    int dev_type = args[1].cast<int>();
+                    int dev_id = args[2].cast<int>();
+                    Device dst_device = {(DLDeviceType)dev_type, dev_id};
+                    ffi::String mem_scope = "global";
+                    if (args.size() == 4) {
+                      mem_scope = args[3].cast<ffi::String>();
+                    }
+                    *rv = ToDeviceAsync(data, dst_device, mem_scope);
+                  })
+      .def("vm.builtin.to_host_async", ToHostAsync);
+}
+
 /*!
  * \brief Load the scalar value in cond and return the result value.
  * \param cond The condition
@@ -29,46 +29,17 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/vm/vm.h>
 
-#include "../../../support/utils.h"
+#include <cstdlib>
+#include <list>
+#include <utility>
+
+#include "../device_graph.h"
 namespace tvm {
 namespace runtime {
 namespace vm {
 
 namespace {
 
-struct CUDAGraphCaptureKey {
-  // The unique index of the capture function within the module
-  int64_t index;
-  // The symbolic variables the capture function depends on. When the capture function is ran with
-  // different symbolic variable values, the CUDA graph will be re-captured as a different version,
-  // identified by this shape tuple. This is default constructed as an empty tuple.
-  ffi::Shape shape_expr;
-
-  CUDAGraphCaptureKey(int64_t index, const ffi::Optional<ffi::Shape>& shape_expr) : index(index) {
-    if (shape_expr) {
-      this->shape_expr = shape_expr.value();
-    }
-  }
-};
-
-struct CUDAGraphCaptureKeyHash {
-  size_t operator()(const CUDAGraphCaptureKey& key) const {
-    std::hash<int64_t> hash_fn;
-    size_t hash = hash_fn(key.index);
-    for (const auto& shape : key.shape_expr) {
-      support::HashCombine(hash, hash_fn(shape));
-    }
-    return hash;
-  }
-};
-
-struct CUDAGraphCaptureKeyEqual {
-  bool operator()(const CUDAGraphCaptureKey& lhs, const CUDAGraphCaptureKey& rhs) const {
-    return lhs.index == rhs.index && std::equal(lhs.shape_expr.begin(), lhs.shape_expr.end(),
-                                                rhs.shape_expr.begin(), rhs.shape_expr.end());
-  }
-};
-
 /*! \brief The captured state of a CUDA graph */
 struct CUDAGraphCapturedState {
   CUDAGraphCapturedState() {}
@@ -160,10 +131,12 @@ class CUDAGraphExtensionNode : public VMExtensionNode {
    */
   ffi::ObjectRef RunOrCapture(VirtualMachine* vm, const ffi::ObjectRef& capture_func, Any args,
                               int64_t entry_index, ffi::Optional<ffi::Shape> shape_expr) {
-    CUDAGraphCaptureKey entry_key{entry_index, shape_expr};
+    DeviceGraphCaptureKey entry_key{entry_index, shape_expr};
     if (auto it = capture_cache_.find(entry_key); it != capture_cache_.end()) {
+      // Mark the graph as the most recently used one.
+      capture_lru_.splice(capture_lru_.begin(), capture_lru_, it->second);
       // Launch CUDA graph
-      const auto& [states, exec] = it->second;
+      const auto& [states, exec] = it->second->second;
       int device_id;
       TVM_FFI_CHECK_CUDA_ERROR(cudaGetDevice(&device_id));
       TVM_FFI_CHECK_CUDA_ERROR(
@@ -202,11 +175,23 @@ class CUDAGraphExtensionNode : public VMExtensionNode {
 
     ffi::ObjectRef states = entry.states;
 
-    capture_cache_[entry_key] = std::move(entry);
+    capture_lru_.emplace_front(entry_key, std::move(entry));
+    capture_cache_.emplace(entry_key, capture_lru_.begin());
+    this->EvictCapturedGraphs();
 
     return states;
   }
 
+  /*!
+   * \brief Set the maximum number of captured graphs kept alive, 0 for no limit.
+   * \param max_captured_graphs The maximum number of captured graphs.
+   */
+  void SetMaxCapturedGraphs(int64_t max_captured_graphs) {
+    TVM_FFI_ICHECK_GE(max_captured_graphs, 0);
+    max_captured_graphs_ = max_captured_graphs;
+    this->EvictCapturedGraphs();
+  }
+
   /*!
    * \brief Get the cached allocation from the cache or run the allocation function.
    * \param vm The virtual machine.
@@ -231,13 +216,34 @@ class CUDAGraphExtensionNode : public VMExtensionNode {
                                     VMExtensionNode);
 
  private:
+  using CaptureLRUList = std::list<std::pair<DeviceGraphCaptureKey, CUDAGraphCapturedState>>;
+
+  /*!
+   * \brief Evict the least recently used graphs beyond the limit. The states of an evicted graph
+   * stay alive as long as they are referenced outside.
+   */
+  void EvictCapturedGraphs() {
+    while (max_captured_graphs_ > 0 &&
+           static_cast<int64_t>(capture_lru_.size()) > max_captured_graphs_) {
+      capture_cache_.erase(capture_lru_.back().first);
+      capture_lru_.pop_back();
+    }
+  }
+
+  /*! \brief The captured cuda graphs, ordered from the most to the least recently used. */
+  CaptureLRUList capture_lru_;
   /*!
    * \brief The cache of captured cuda graphs. The key is a unique index for the capture function.
-   * The value is the result of the capture.
+   * The value is the position of the result of the capture in `capture_lru_`.
    */
-  std::unordered_map<CUDAGraphCaptureKey, CUDAGraphCapturedState, CUDAGraphCaptureKeyHash,
-                     CUDAGraphCaptureKeyEqual>
+  std::unordered_map<DeviceGraphCaptureKey, CaptureLRUList::iterator, DeviceGraphCaptureKeyHash,
+                     DeviceGraphCaptureKeyEqual>
       capture_cache_;
+  /*!
+   * \brief The maximum number of captured graphs, 0 for no limit. Graphs captured for many
+   * distinct symbolic shapes are evicted in least recently used order beyond this limit.
+   */
+  int64_t max_captured_graphs_{0};
   /*!
    * \brief The cache of allocations. The key is a unique index for the allocation function.
    * The value is the cached allocations, which is a tuple of storages.
@@ -252,6 +258,10 @@ class CUDAGraphExtension : public VMExtension {
                                              CUDAGraphExtensionNode);
   static CUDAGraphExtension Create() {
     auto data_ = ffi::make_object<CUDAGraphExtensionNode>();
+    // Bound the captured graphs of the symbolic-shape regions, e.g. one per batch size.
+    if (const char* val = std::getenv("TVM_CUDA_GRAPH_MAX_CAPTURED")) {
+      data_->SetMaxCapturedGraphs(std::atoll(val));
+    }
     return CUDAGraphExtension(std::move(data_));
   }
 };
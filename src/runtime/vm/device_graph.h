@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/device_graph.h
+ * \brief Internal helpers shared by the device graph builtins of the Relax virtual machine.
+ *
+ * Every backend that replays the regions lifted by RewriteCUDAGraph registers the pair of
+ * builtins
+ *
+ *   vm.builtin.<backend>_graph.run_or_capture(ctx, capture_func, args, entry_index[, shape])
+ *   vm.builtin.<backend>_graph.get_cached_alloc(ctx, alloc_func, entry_index)
+ *
+ * where <backend> is cuda, rocm, vulkan or metal.  The first call of run_or_capture for a key
+ * runs the capture function once to warm up and once in capture mode, and the later calls
+ * replay the captured graph.  get_cached_alloc runs the allocation function once and returns
+ * the cached storages afterwards.
+ */
+#ifndef TVM_RUNTIME_VM_DEVICE_GRAPH_H_
+#define TVM_RUNTIME_VM_DEVICE_GRAPH_H_
+
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/optional.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "../../support/utils.h"
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*! \brief The key of a captured device graph. */
+struct DeviceGraphCaptureKey {
+  // The unique index of the capture function within the module
+  int64_t index;
+  // The symbolic variables the capture function depends on. When the capture function is ran with
+  // different symbolic variable values, the graph will be re-captured as a different version,
+  // identified by this shape tuple. This is default constructed as an empty tuple.
+  ffi::Shape shape_expr;
+
+  DeviceGraphCaptureKey(int64_t index, const ffi::Optional<ffi::Shape>& shape_expr)
+      : index(index) {
+    if (shape_expr) {
+      this->shape_expr = shape_expr.value();
+    }
+  }
+};
+
+struct DeviceGraphCaptureKeyHash {
+  size_t operator()(const DeviceGraphCaptureKey& key) const {
+    std::hash<int64_t> hash_fn;
+    size_t hash = hash_fn(key.index);
+    for (const auto& shape : key.shape_expr) {
+      support::HashCombine(hash, hash_fn(shape));
+    }
+    return hash;
+  }
+};
+
+struct DeviceGraphCaptureKeyEqual {
+  bool operator()(const DeviceGraphCaptureKey& lhs, const DeviceGraphCaptureKey& rhs) const {
+    return lhs.index == rhs.index && std::equal(lhs.shape_expr.begin(), lhs.shape_expr.end(),
+                                                rhs.shape_expr.begin(), rhs.shape_expr.end());
+  }
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_VM_DEVICE_GRAPH_H_
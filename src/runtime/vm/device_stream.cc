@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/device_stream.cc
+ * \brief The builtin functions of the Relax virtual machine that run the kernels of independent
+ * dataflow branches on multiple streams of a device.
+ */
+
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/vm/vm.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*!
+ * \brief The VM extension of the device streams. The stream of index 0 of a device is its current
+ * stream at the first use, the others are created on demand and freed with the VM.
+ */
+class DeviceStreamExtensionNode : public VMExtensionNode {
+ public:
+  ~DeviceStreamExtensionNode() {
+    for (auto& [device, streams] : streams_) {
+      DeviceAPI* api = DeviceAPI::Get(device);
+      // The kernels in flight may still use the streams.
+      for (size_t i = 1; i < streams.size(); ++i) {
+        api->SyncStreamFromTo(device, streams[i], streams[0]);
+      }
+      api->SetStream(device, streams[0]);
+      api->StreamSync(device, streams[0]);
+      for (size_t i = 1; i < streams.size(); ++i) {
+        api->FreeStream(device, streams[i]);
+      }
+    }
+  }
+
+  /*!
+   * \brief Get the stream of the given index of a device, creating the missing streams.
+   * \param device The device.
+   * \param stream_index The index of the stream.
+   * \return The stream.
+   */
+  TVMStreamHandle GetStream(Device device, int64_t stream_index) {
+    TVM_FFI_ICHECK_GE(stream_index, 0);
+    std::vector<TVMStreamHandle>& streams = streams_[device];
+    DeviceAPI* api = DeviceAPI::Get(device);
+    if (streams.empty()) {
+      streams.push_back(api->GetCurrentStream(device));
+    }
+    while (static_cast<int64_t>(streams.size()) <= stream_index) {
+      streams.push_back(api->CreateStream(device));
+    }
+    return streams[stream_index];
+  }
+
+  /*!
+   * \brief Launch the following kernels of a device on the stream of the given index.
+   * \param device The device.
+   * \param stream_index The index of the stream.
+   */
+  void SetCurrentStream(Device device, int64_t stream_index) {
+    DeviceAPI::Get(device)->SetStream(device, GetStream(device, stream_index));
+  }
+
+  /*!
+   * \brief Make a stream wait for the kernels launched so far on another stream.
+   * \param device The device.
+   * \param src_index The index of the stream to wait for.
+   * \param dst_index The index of the waiting stream.
+   */
+  void Wait(Device device, int64_t src_index, int64_t dst_index) {
+    TVMStreamHandle src = GetStream(device, src_index);
+    TVMStreamHandle dst = GetStream(device, dst_index);
+    DeviceAPI::Get(device)->SyncStreamFromTo(device, src, dst);
+  }
+
+  /*!
+   * \brief Make the stream of index 0 wait for the given streams, and launch the following
+   * kernels of the device on it.
+   * \param device The device.
+   * \param stream_indices The indices of the streams to wait for.
+   */
+  void Join(Device device, const ffi::Shape& stream_indices) {
+    for (int64_t stream_index : stream_indices) {
+      Wait(device, stream_index, 0);
+    }
+    SetCurrentStream(device, 0);
+  }
+
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("vm.DeviceStreamExtension", DeviceStreamExtensionNode,
+                                    VMExtensionNode);
+
+ private:
+  /*! \brief The streams of each device. */
+  std::unordered_map<Device, std::vector<TVMStreamHandle>> streams_;
+};
+
+/*! Managed reference to DeviceStreamExtensionNode */
+class DeviceStreamExtension : public VMExtension {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(DeviceStreamExtension, VMExtension,
+                                             DeviceStreamExtensionNode);
+  static DeviceStreamExtension Create() {
+    return DeviceStreamExtension(ffi::make_object<DeviceStreamExtensionNode>());
+  }
+};
+
+/*! \brief Get the device of the given index of the VM. */
+Device GetVMDevice(VirtualMachine* vm, int64_t device_index) {
+  TVM_FFI_ICHECK_LT(device_index, vm->devices.size())
+      << "The device index is out of VM physical devices list";
+  return vm->devices[device_index];
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("vm.builtin.device_stream.set_current",
+           [](void* ctx_ptr, int64_t device_index, int64_t stream_index) {
+             VirtualMachine* vm = static_cast<VirtualMachine*>(ctx_ptr);
+             auto extension = vm->GetOrCreateExtension<DeviceStreamExtension>();
+             extension->SetCurrentStream(GetVMDevice(vm, device_index), stream_index);
+           })
+      .def("vm.builtin.device_stream.wait",
+           [](void* ctx_ptr, int64_t device_index, int64_t src_index, int64_t dst_index) {
+             VirtualMachine* vm = static_cast<VirtualMachine*>(ctx_ptr);
+             auto extension = vm->GetOrCreateExtension<DeviceStreamExtension>();
+             extension->Wait(GetVMDevice(vm, device_index), src_index, dst_index);
+           })
+      // The trailing arguments are the objects that must stay alive until the join.
+      .def_packed("vm.builtin.device_stream.join", [](ffi::PackedArgs args, ffi::Any* rv) {
+        TVM_FFI_ICHECK_GE(args.size(), 3);
+        VirtualMachine* vm = static_cast<VirtualMachine*>(args[0].cast<void*>());
+        auto extension = vm->GetOrCreateExtension<DeviceStreamExtension>();
+        extension->Join(GetVMDevice(vm, args[1].cast<int64_t>()), args[2].cast<ffi::Shape>());
+      });
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
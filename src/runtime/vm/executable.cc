@@ -28,13 +28,24 @@
 #include <tvm/runtime/vm/vm.h>
 #include <tvm/support/io.h>
 
+#include <cstring>
 #include <functional>
+#include <memory>
 #include <sstream>
+#include <utility>
 
 #include "../../support/bytes_io.h"
 #include "../file_utils.h"
 #include "./module_utils.h"
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TVM_VM_EXECUTABLE_USE_MMAP 1
+#endif
+
 namespace tvm {
 namespace runtime {
 namespace vm {
@@ -42,6 +53,11 @@ namespace vm {
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kTVMVMBytecodeMagic = 0xD225DE2F4214151D;
 constexpr uint64_t kTVMVMBytecodeMagicV2 = 0xD225DE2F4214151E;
+/*!
+ * \brief The magic number of the format that moves the data of the tensor constants into an
+ *  aligned section at the end of the file, so that they can be mapped in place.
+ */
+constexpr uint64_t kTVMVMBytecodeMagicV3 = 0xD225DE2F4214151F;
 
 #define STREAM_CHECK(val, section)                                                  \
   TVM_FFI_ICHECK(val) << "Invalid VM file format in the " << section << " section." \
@@ -160,7 +176,7 @@ Instruction VMExecutable::GetInstruction(Index i) const {
 }
 
 void SaveHeader(support::Stream* strm) {
-  uint64_t header = kTVMVMBytecodeMagicV2;
+  uint64_t header = kTVMVMBytecodeMagicV3;
   strm->Write(header);
   std::string version = VM_VERSION;
   strm->Write(version);
@@ -170,7 +186,9 @@ uint64_t LoadHeader(support::Stream* strm) {
   // Check header.
   uint64_t header;
   STREAM_CHECK(strm->Read(&header), "header");
-  STREAM_CHECK((header == kTVMVMBytecodeMagic) || (header == kTVMVMBytecodeMagicV2), "header");
+  STREAM_CHECK((header == kTVMVMBytecodeMagic) || (header == kTVMVMBytecodeMagicV2) ||
+                   (header == kTVMVMBytecodeMagicV3),
+               "header");
 
   // Check version.
   std::string version;
@@ -180,6 +198,53 @@ uint64_t LoadHeader(support::Stream* strm) {
   return header;
 }
 
+/*! \brief Round the size up to the alignment of the tensor data section. */
+size_t AlignTensorData(size_t nbytes) {
+  return (nbytes + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+}
+
+/*!
+ * \brief A read-only, shared mapping of an executable file.
+ *  It is shared by the tensor constants viewing into it and unmapped with the last of them.
+ */
+class MappedExecutableFile {
+ public:
+  /*! \brief Map a file, returns nullptr when the file can not be mapped. */
+  static std::shared_ptr<MappedExecutableFile> Open(const std::string& path) {
+#ifdef TVM_VM_EXECUTABLE_USE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      // The pages stay clean, so the processes mapping the same file share them.
+      data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    return std::shared_ptr<MappedExecutableFile>(
+        new MappedExecutableFile(static_cast<char*>(data), static_cast<size_t>(st.st_size)));
+#else
+    return nullptr;
+#endif
+  }
+
+  ~MappedExecutableFile() {
+#ifdef TVM_VM_EXECUTABLE_USE_MMAP
+    munmap(data_, size_);
+#endif
+  }
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedExecutableFile(char* data, size_t size) : data_(data), size_(size) {}
+
+  char* data_;
+  size_t size_;
+};
+
 ffi::Bytes VMExecutable::SaveToBytes() const {
   std::string result;
   support::BytesOutStream strm(&result);
@@ -199,6 +264,10 @@ ffi::Bytes VMExecutable::SaveToBytes() const {
   // Code section.
   SaveCodeSection(&strm);
 
+  // Tensor data section, which starts at an aligned offset of the file.
+  result.resize(AlignTensorData(result.size()), '\0');
+  SaveTensorDataSection(&strm);
+
   return ffi::Bytes(std::move(result));
 }
 
@@ -206,8 +275,8 @@ void VMExecutable::WriteToFile(const ffi::String& file_name, const ffi::String&
   runtime::SaveBinaryToFile(file_name, VMExecutable::SaveToBytes());
 }
 
-ffi::Module VMExecutable::LoadFromBytes(const ffi::Bytes& bytes) {
-  support::BytesInStream strm(bytes);
+ffi::Module VMExecutable::Load(const SerializedData& serialized) {
+  support::BytesInStream strm(serialized.data, serialized.size);
 
   ffi::ObjectPtr<VMExecutable> exec = ffi::make_object<VMExecutable>();
 
@@ -217,13 +286,13 @@ ffi::Module VMExecutable::LoadFromBytes(const ffi::Bytes& bytes) {
   // Global section.
   exec->LoadGlobalSection(&strm);
 
-  if (kTVMVMBytecodeMagicV2 == header_magic) {
+  if (header_magic != kTVMVMBytecodeMagic) {
     // Memory Scopes
     exec->LoadMemoryScopeSection(&strm);
   }
 
   // Constant section.
-  exec->LoadConstantSection(&strm);
+  exec->LoadConstantSection(&strm, header_magic, serialized);
 
   // Code section.
   exec->LoadCodeSection(&strm);
@@ -231,7 +300,16 @@ ffi::Module VMExecutable::LoadFromBytes(const ffi::Bytes& bytes) {
   return ffi::Module(exec);
 }
 
+ffi::Module VMExecutable::LoadFromBytes(const ffi::Bytes& bytes) {
+  return VMExecutable::Load({bytes.data(), bytes.size(), nullptr});
+}
+
 ffi::Module VMExecutable::LoadFromFile(const ffi::String& file_name) {
+  if (std::shared_ptr<MappedExecutableFile> file = MappedExecutableFile::Open(file_name)) {
+    const char* data = file->data();
+    size_t size = file->size();
+    return VMExecutable::Load({data, size, std::move(file)});
+  }
   std::string data;
   runtime::LoadBinaryFromFile(file_name, &data);
   return VMExecutable::LoadFromBytes(ffi::Bytes(data));
@@ -244,6 +322,15 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def("ffi.Module.load_from_bytes.relax.VMExecutable", VMExecutable::LoadFromBytes);
 }
 
+Index VMFuncInfo::NumOutputParams() const {
+  Index num_output_params = 0;
+  for (auto it = param_names.rbegin(); it != param_names.rend(); ++it) {
+    if (it->rfind(kOutputParamPrefix, 0) != 0) break;
+    ++num_output_params;
+  }
+  return num_output_params;
+}
+
 void VMFuncInfo::Save(support::Stream* strm) const {
   int32_t temp_kind = static_cast<int32_t>(kind);
   strm->Write(temp_kind);
@@ -283,10 +370,27 @@ void VMExecutable::SaveConstantSection(support::Stream* strm) const {
   // NOTE: pay close attention to the explicit type in write here
   // so the load/save is 32/64 bit compatible
   strm->Write(static_cast<uint64_t>(this->constants.size()));
+  // The data of the tensors are in the tensor data section, the constant pool only records
+  // their metadata and their offsets in the section.
+  uint64_t tensor_data_size = 0;
   for (const auto& it : this->constants) {
     if (auto opt_nd = it.as<runtime::Tensor>()) {
+      tensor_data_size += AlignTensorData(ffi::GetDataSize(*opt_nd.value().operator->()));
+    }
+  }
+  strm->Write(tensor_data_size);
+  uint64_t tensor_data_offset = 0;
+  for (const auto& it : this->constants) {
+    if (auto opt_nd = it.as<runtime::Tensor>()) {
+      const DLTensor* tensor = opt_nd.value().operator->();
+      uint64_t nbytes = ffi::GetDataSize(*tensor);
       strm->Write<int32_t>(ffi::TypeIndex::kTVMFFITensor);
-      runtime::SaveDLTensor(strm, opt_nd.value().operator->());
+      strm->Write(tensor->dtype);
+      strm->Write(tensor->ndim);
+      strm->WriteArray(tensor->shape, tensor->ndim);
+      strm->Write(nbytes);
+      strm->Write(tensor_data_offset);
+      tensor_data_offset += AlignTensorData(nbytes);
     } else if (auto opt_shape = it.as<ffi::Shape>()) {
       ffi::Shape shape = opt_shape.value();
       strm->Write<int32_t>(ffi::TypeIndex::kTVMFFIShape);
@@ -317,6 +421,31 @@ void VMExecutable::SaveCodeSection(support::Stream* strm) const {
   strm->Write(instr_data);
 }
 
+void VMExecutable::SaveTensorDataSection(support::Stream* strm) const {
+  std::vector<uint8_t> bytes;
+  for (const auto& it : this->constants) {
+    auto opt_nd = it.as<runtime::Tensor>();
+    if (!opt_nd) continue;
+    const DLTensor* tensor = opt_nd.value().operator->();
+    size_t nbytes = ffi::GetDataSize(*tensor);
+    if (TVM_FFI_IO_NO_ENDIAN_SWAP && tensor->device.device_type == kDLCPU &&
+        ffi::IsContiguous(*tensor)) {
+      strm->Write(static_cast<const char*>(tensor->data) + tensor->byte_offset, nbytes);
+    } else {
+      // Like the other sections, the data is saved in little endian.
+      bytes.resize(nbytes);
+      Tensor::CopyToBytes(const_cast<DLTensor*>(tensor), bytes.data(), nbytes);
+      if (!TVM_FFI_IO_NO_ENDIAN_SWAP) {
+        int elem_bytes = (tensor->dtype.bits + 7) / 8;
+        ffi::ByteSwap(bytes.data(), elem_bytes, nbytes / elem_bytes);
+      }
+      strm->Write(bytes.data(), nbytes);
+    }
+    bytes.assign(AlignTensorData(nbytes) - nbytes, 0);
+    strm->Write(bytes.data(), bytes.size());
+  }
+}
+
 void VMExecutable::LoadGlobalSection(support::Stream* strm) {
   STREAM_CHECK(strm->Read(&func_table), "Global Section");
   // setup func map
@@ -342,11 +471,75 @@ void VMExecutable::LoadMemoryScopeSection(support::Stream* strm) {
   }
 }
 
-void VMExecutable::LoadConstantSection(support::Stream* strm) {
+/*!
+ * \brief Load a tensor constant from the tensor data section.
+ * \param strm The input stream at the metadata of the tensor.
+ * \param tensor_data The start of the tensor data section.
+ * \param tensor_data_size The size of the tensor data section.
+ * \param mapping The owner of the mapping of the section, nullptr to copy the data out.
+ * \return The loaded tensor.
+ */
+Tensor LoadTensorConstant(support::Stream* strm, const char* tensor_data, size_t tensor_data_size,
+                          const std::shared_ptr<const void>& mapping) {
+  DLDataType dtype;
+  int ndim;
+  uint64_t nbytes, offset;
+  STREAM_CHECK(strm->Read(&dtype), "constant tensor");
+  STREAM_CHECK(strm->Read(&ndim) && ndim >= 0, "constant tensor");
+  std::vector<int64_t> shape(ndim);
+  STREAM_CHECK(strm->ReadArray(shape.data(), ndim), "constant tensor");
+  STREAM_CHECK(strm->Read(&nbytes) && strm->Read(&offset), "constant tensor");
+  STREAM_CHECK(offset <= tensor_data_size && nbytes <= tensor_data_size - offset,
+               "constant tensor");
+  const char* data = tensor_data + offset;
+  Device cpu_dev{kDLCPU, 0};
+  if (mapping != nullptr && TVM_FFI_IO_NO_ENDIAN_SWAP &&
+      reinterpret_cast<uintptr_t>(data) % kAllocAlignment == 0) {
+    // The kernels assume aligned data, so only the aligned tensors view into the mapping.
+    class MappedDataAlloc {
+     public:
+      MappedDataAlloc(std::shared_ptr<const void> mapping, const char* data)
+          : mapping_(std::move(mapping)), data_(data) {}
+      void AllocData(DLTensor* tensor) {
+        tensor->data = const_cast<char*>(data_);
+        tensor->byte_offset = 0;
+      }
+      void FreeData(DLTensor* tensor) {}
+
+     private:
+      std::shared_ptr<const void> mapping_;
+      const char* data_;
+    };
+    Tensor ret = Tensor::FromNDAlloc(MappedDataAlloc(mapping, data), ffi::Shape(shape), dtype,
+                                     cpu_dev);
+    STREAM_CHECK(ffi::GetDataSize(*ret.operator->()) == nbytes, "constant tensor");
+    return ret;
+  }
+  Tensor ret = Tensor::Empty(ffi::Shape(shape), dtype, cpu_dev);
+  STREAM_CHECK(ffi::GetDataSize(*ret.operator->()) == nbytes, "constant tensor");
+  std::memcpy(ret->data, data, nbytes);
+  if (!TVM_FFI_IO_NO_ENDIAN_SWAP) {
+    int elem_bytes = (dtype.bits + 7) / 8;
+    ffi::ByteSwap(ret->data, elem_bytes, nbytes / elem_bytes);
+  }
+  return ret;
+}
+
+void VMExecutable::LoadConstantSection(support::Stream* strm, uint64_t header_magic,
+                                       const SerializedData& serialized) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
 
+  // The tensor data section is at the end of the latest format.
+  const char* tensor_data = nullptr;
+  uint64_t tensor_data_size = 0;
+  if (header_magic == kTVMVMBytecodeMagicV3) {
+    STREAM_CHECK(strm->Read(&tensor_data_size), "constant");
+    STREAM_CHECK(tensor_data_size <= serialized.size, "constant");
+    tensor_data = serialized.data + serialized.size - tensor_data_size;
+  }
+
   size_t size = static_cast<size_t>(sz);
   runtime::Tensor ndarray;
   DLDataType dtype;
@@ -355,7 +548,11 @@ void VMExecutable::LoadConstantSection(support::Stream* strm) {
     int constant_type;
     STREAM_CHECK(strm->Read(&constant_type, sizeof(constant_type)), "constant");
     if (constant_type == ffi::TypeIndex::kTVMFFITensor) {
-      ndarray.Load(strm);
+      if (tensor_data != nullptr) {
+        ndarray = LoadTensorConstant(strm, tensor_data, tensor_data_size, serialized.mapping);
+      } else {
+        ndarray.Load(strm);
+      }
       ffi::Any cell;
       cell = ndarray;
       this->constants.push_back(cell);
@@ -472,6 +669,10 @@ ffi::String VMExecutable::AsText() const {
       os << "@" << gfunc.name << " packed_func;\n\n";
       continue;
     }
+    if (gfunc.kind == VMFuncInfo::FuncKind::kDirectFunc) {
+      os << "@" << gfunc.name << " direct_func;\n\n";
+      continue;
+    }
     if (gfunc.kind == VMFuncInfo::FuncKind::kVMTIRFunc) {
       os << "@" << gfunc.name << " num_inputs=" << gfunc.num_args << " vm_tir_func;\n\n";
       continue;
@@ -550,7 +751,8 @@ ffi::String VMExecutable::AsPython() const {
   os << "ib = rx.Builder()\n";
   for (size_t fidx = 0; fidx < this->func_table.size(); ++fidx) {
     const VMFuncInfo& gfunc = this->func_table[fidx];
-    if (gfunc.kind == VMFuncInfo::FuncKind::kPackedFunc) {
+    if (gfunc.kind == VMFuncInfo::FuncKind::kPackedFunc ||
+        gfunc.kind == VMFuncInfo::FuncKind::kDirectFunc) {
       continue;
     }
     if (gfunc.kind == VMFuncInfo::FuncKind::kVMTIRFunc) {
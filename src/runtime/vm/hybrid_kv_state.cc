@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/vm/hybrid_kv_state.cc
+ * \brief Runtime KV state of models interleaving attention and space state layers.
+ */
+
+#include <tvm/ffi/reflection/registry.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "kv_state.h"
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+//-----------------------------------------------------------------------------
+// We keep the implementation private as they may subject to future changes.
+//
+// Users can interact with it through the runtime API function calls
+//-----------------------------------------------------------------------------
+
+class HybridKVStateImpObj : public HybridKVStateObj {
+ private:
+  /*! \brief The attention KV cache of the attention layers. */
+  const AttentionKVCache kv_cache_;
+  /*! \brief The RNN state of the space state layers. */
+  const RNNState rnn_state_;
+  /*! \brief The mapping from the ids of the sequences to their lengths. */
+  std::unordered_map<int64_t, int64_t> seq_lengths_;
+  /*! \brief The sequence ids of the current round of forwarding. */
+  ffi::Shape cur_seq_ids_;
+  /*! \brief The append lengths of the sequences in the current round of forwarding. */
+  ffi::Shape cur_append_lengths_;
+
+ public:
+  /*! \brief Constructor. Take the components, which must hold no sequence. */
+  explicit HybridKVStateImpObj(AttentionKVCache kv_cache, RNNState rnn_state)
+      : kv_cache_(std::move(kv_cache)), rnn_state_(std::move(rnn_state)) {
+    Clear();
+  }
+
+  /*! \brief Reset the KV state. */
+  void Clear() final {
+    kv_cache_->Clear();
+    rnn_state_->Clear();
+    seq_lengths_.clear();
+  }
+
+  AttentionKVCache GetAttentionKVCache() const final { return kv_cache_; }
+
+  RNNState GetRNNState() const final { return rnn_state_; }
+
+  /************** Sequence Management **************/
+
+  void AddSequence(int64_t seq_id) final {
+    TVM_FFI_ICHECK(seq_lengths_.find(seq_id) == seq_lengths_.end())
+        << "The sequence \"" << seq_id << "\" is already in the hybrid KV state.";
+    kv_cache_->AddSequence(seq_id);
+    rnn_state_->AddSequence(seq_id);
+    seq_lengths_[seq_id] = 0;
+  }
+
+  void RemoveSequence(int64_t seq_id) final {
+    auto it = seq_lengths_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_lengths_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in the hybrid KV state.";
+    kv_cache_->RemoveSequence(seq_id);
+    rnn_state_->RemoveSequence(seq_id);
+    seq_lengths_.erase(it);
+  }
+
+  void ForkSequence(int64_t parent_seq_id, int64_t child_seq_id, int64_t fork_pos = -1) final {
+    auto parent_it = seq_lengths_.find(parent_seq_id);
+    TVM_FFI_ICHECK(parent_it != seq_lengths_.end()) << "The parent sequence \"" << parent_seq_id
+                                                    << "\" cannot be found in the hybrid KV state.";
+    TVM_FFI_ICHECK(seq_lengths_.find(child_seq_id) == seq_lengths_.end())
+        << "The child sequence \"" << child_seq_id << "\" is already in the hybrid KV state.";
+    int64_t parent_length = parent_it->second;
+    // The space state summarizes the whole sequence, so it cannot be forked in the middle.
+    TVM_FFI_CHECK(fork_pos == -1 || fork_pos == parent_length, ValueError)
+        << "The hybrid KV state can only fork at the end of the parent sequence of length "
+        << parent_length << ", but got fork position " << fork_pos;
+    kv_cache_->ForkSequence(parent_seq_id, child_seq_id, fork_pos);
+    rnn_state_->ForkSequence(parent_seq_id, child_seq_id, fork_pos);
+    seq_lengths_[child_seq_id] = parent_length;
+  }
+
+  void PopN(int64_t seq_id, int32_t n) final {
+    auto it = seq_lengths_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_lengths_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in the hybrid KV state.";
+    // The RNN state has the shorter rollback history, so it validates the length first.
+    rnn_state_->PopN(seq_id, n);
+    kv_cache_->PopN(seq_id, n);
+    it->second -= n;
+  }
+
+  /************** Interaction **************/
+
+  void BeginForward(const ffi::Shape& seq_ids, const ffi::Shape& append_lengths,
+                    const ffi::Optional<ffi::Shape>& opt_token_tree_parent_ptr) final {
+    TVM_FFI_ICHECK_EQ(seq_ids.size(), append_lengths.size())
+        << "The seq_ids size (" << seq_ids.size() << ") and append_lengths size ("
+        << append_lengths.size() << ") mismatch.";
+    for (int64_t seq_id : seq_ids) {
+      TVM_FFI_ICHECK(seq_lengths_.find(seq_id) != seq_lengths_.end())
+          << "The sequence \"" << seq_id << "\" cannot be found in the hybrid KV state.";
+    }
+    rnn_state_->BeginForward(seq_ids, append_lengths, opt_token_tree_parent_ptr);
+    kv_cache_->BeginForward(seq_ids, append_lengths, opt_token_tree_parent_ptr);
+    cur_seq_ids_ = seq_ids;
+    cur_append_lengths_ = append_lengths;
+  }
+
+  void EndForward() final {
+    kv_cache_->EndForward();
+    rnn_state_->EndForward();
+    for (size_t i = 0; i < cur_seq_ids_.size(); ++i) {
+      seq_lengths_[cur_seq_ids_[i]] += cur_append_lengths_[i];
+    }
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.vm.HybridKVStateImp", HybridKVStateImpObj,
+                                    HybridKVStateObj);
+};
+
+//-------------------------------------------------
+//  Register runtime functions
+//-------------------------------------------------
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("vm.builtin.hybrid_kv_state_create",
+                        [](AttentionKVCache kv_cache, RNNState rnn_state) {
+                          TVM_FFI_ICHECK(kv_cache.defined() && rnn_state.defined())
+                              << "The hybrid KV state requires both the attention KV cache and "
+                                 "the RNN state.";
+                          ffi::ObjectPtr<HybridKVStateImpObj> n =
+                              ffi::make_object<HybridKVStateImpObj>(std::move(kv_cache),
+                                                                    std::move(rnn_state));
+                          return HybridKVState(std::move(n));
+                        });
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
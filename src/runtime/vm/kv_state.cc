@@ -61,10 +61,28 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def_method("vm.builtin.kv_cache_disagg_prepare_recv",
                   &AttentionKVCacheObj::DisaggPrepareRecv)
       .def_method("vm.builtin.kv_cache_disagg_mark_send", &AttentionKVCacheObj::DisaggMarkSend)
+      .def_method("vm.builtin.kv_cache_disagg_wait_recv", &AttentionKVCacheObj::DisaggWaitRecv)
       .def_method("vm.builtin.attention_kv_cache_enable_sliding_window_for_seq",
                   &AttentionKVCacheObj::EnableSlidingWindowForSeq)
       .def_method("vm.builtin.attention_kv_cache_commit_accepted_token_tree_nodes",
                   &AttentionKVCacheObj::CommitAcceptedTokenTreeNodes)
+      .def_method("vm.builtin.attention_kv_cache_commit_sequence_prefix",
+                  &AttentionKVCacheObj::CommitSequencePrefix)
+      .def_method("vm.builtin.attention_kv_cache_add_sequence_with_prefix_match",
+                  &AttentionKVCacheObj::AddSequenceWithPrefixMatch)
+      .def_method("vm.builtin.attention_kv_cache_swap_out_sequence",
+                  &AttentionKVCacheObj::SwapOutSequence)
+      .def_method("vm.builtin.attention_kv_cache_swap_in_sequence",
+                  &AttentionKVCacheObj::SwapInSequence)
+      .def_method("vm.builtin.attention_kv_cache_save_sequence_snapshot",
+                  &AttentionKVCacheObj::SaveSequenceSnapshot)
+      .def_method("vm.builtin.attention_kv_cache_restore_sequence_snapshot",
+                  &AttentionKVCacheObj::RestoreSequenceSnapshot)
+      .def_method("vm.builtin.attention_kv_cache_batch_fork_sequence",
+                  &AttentionKVCacheObj::BatchForkSequence)
+      .def_method("vm.builtin.attention_kv_cache_batch_popn", &AttentionKVCacheObj::BatchPopN)
+      .def_method("vm.builtin.attention_kv_cache_begin_chunked_forward",
+                  &AttentionKVCacheObj::BeginChunkedForward)
       .def_method("vm.builtin.attention_kv_cache_empty", &AttentionKVCacheObj::Empty)
       .def_method("vm.builtin.attention_kv_cache_get_num_available_pages",
                   &AttentionKVCacheObj::GetNumAvailablePages)
@@ -88,6 +106,13 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                                      std::move(v_data), std::move(o_data), std::move(lse_data),
                                      sm_scale);
            })
+      .def("vm.builtin.attention_kv_cache_ring_self_attention",
+           [](AttentionKVCache kv_cache, int64_t layer_id, double sm_scale, Tensor q_data,
+              Tensor k_data, Tensor v_data, Tensor o_data, Tensor lse_data) {
+             kv_cache->RingSelfAttention(layer_id, std::move(q_data), std::move(k_data),
+                                         std::move(v_data), std::move(o_data),
+                                         std::move(lse_data), sm_scale);
+           })
       .def("vm.builtin.attention_kv_cache_cross_attention",
            [](AttentionKVCache kv_cache, int64_t layer_id, double sm_scale, Tensor q_data,
               Tensor o_data, Tensor lse_data) {
@@ -121,6 +146,15 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def_method("vm.builtin.rnn_state_debug_get", &RNNStateObj::DebugGet);
 }
 
+// Hybrid KV State methods
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def_method("vm.builtin.hybrid_kv_state_get_attention_kv_cache",
+                  &HybridKVStateObj::GetAttentionKVCache)
+      .def_method("vm.builtin.hybrid_kv_state_get_rnn_state", &HybridKVStateObj::GetRNNState);
+}
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -158,7 +158,136 @@ class AttentionKVCacheObj : public KVStateObj {
   virtual void CommitAcceptedTokenTreeNodes(const ffi::Shape& seq_ids,
                                             const ffi::Shape& leaf_indices) = 0;
 
-  /*! \brief Prepare for the disaggregation KV data receive for the specified sequence and length.*/
+  /************** Prefix Cache **************/
+
+  /*!
+   * \brief Commit the K/V data of the given sequence into the prefix cache,
+   * so that later sequences sharing the same leading tokens can reuse the
+   * K/V data instead of prefilling them again.
+   * Only the leading full pages of the given tokens are committed. The
+   * committed K/V data stay in the cache after the sequence is removed, and
+   * are evicted in LRU order when the KV cache runs out of free pages.
+   * \param seq_id The id of the sequence to commit.
+   * \param token_ids The token ids of the sequence, starting from the first
+   * token of the sequence. The length should not exceed the sequence length.
+   */
+  virtual void CommitSequencePrefix(int64_t seq_id, const ffi::Shape& token_ids) = 0;
+
+  /*!
+   * \brief Add a new sequence whose K/V data reuse the longest prefix of the
+   * given token ids found in the prefix cache.
+   * The reused K/V data are shared in a copy-on-write manner.
+   * \param seq_id The id of the new sequence to be added.
+   * \param token_ids The token ids of the new sequence. When the logits of the
+   * last token are required, the last token should be excluded by the caller,
+   * since the K/V data of a matched token will not be computed again.
+   * \return The number of leading tokens whose K/V data are reused. The caller
+   * only needs to prefill the tokens after this position.
+   */
+  virtual int64_t AddSequenceWithPrefixMatch(int64_t seq_id, const ffi::Shape& token_ids) = 0;
+
+  /************** Host Memory Swap **************/
+
+  /*!
+   * \brief Swap out the KV data of the given sequence to host memory, and
+   * release the device pages for other sequences. The pages shared with
+   * other sequences or the prefix cache stay on device.
+   * The copy is asynchronous, and later device computation is ordered after it.
+   * \param seq_id The id of the sequence to swap out.
+   */
+  virtual void SwapOutSequence(int64_t seq_id) = 0;
+
+  /*!
+   * \brief Swap in the KV data of the given swapped-out sequence onto device.
+   * The copy is asynchronous, and attention computation waits for its completion.
+   * BeginForward swaps in the swapped-out sequences automatically, and this
+   * method is useful for prefetching a sequence ahead of time.
+   * \param seq_id The id of the sequence to swap in.
+   */
+  virtual void SwapInSequence(int64_t seq_id) = 0;
+
+  /************** Persistent Snapshots **************/
+
+  /*!
+   * \brief Save the KV data of the given sequence to a file, together with its
+   * token ids, so that a later process of the same model can restore it
+   * instead of prefilling the tokens again. The file records the page layout,
+   * the KV storage dtype and the RoPE parameters, and the page data of each
+   * paged tensor is stored contiguously at a page-aligned offset, so that the
+   * file can be memory-mapped.
+   * \param seq_id The id of the sequence to save.
+   * \param token_ids The token ids of the sequence, whose length must be the
+   * length of the sequence.
+   * \param path The path of the snapshot file.
+   * \param model_hash The hash of the model weights, which versions the snapshot.
+   */
+  virtual void SaveSequenceSnapshot(int64_t seq_id, const ffi::Shape& token_ids,
+                                    const ffi::String& path, const ffi::String& model_hash) = 0;
+
+  /*!
+   * \brief Restore a sequence saved by SaveSequenceSnapshot into free pages as
+   * a new sequence. The copy to device is asynchronous on the copy stream, and
+   * attention computation waits for its completion.
+   * The snapshot is rejected when its model hash or its KV cache configuration
+   * does not match.
+   * \param seq_id The id of the new sequence.
+   * \param path The path of the snapshot file.
+   * \param model_hash The hash of the model weights.
+   * \return The token ids of the restored sequence.
+   */
+  virtual ffi::Shape RestoreSequenceSnapshot(int64_t seq_id, const ffi::String& path,
+                                             const ffi::String& model_hash) = 0;
+
+  /************** Batched Sequence Management **************/
+
+  /*!
+   * \brief Fork multiple child sequences in one call, which is equivalent to
+   * invoking ForkSequence for each element in order. The copies of the pages
+   * that the fork positions fall within are merged into as few kernel launches
+   * as possible.
+   * \param parent_seq_ids The ids of the parent sequences.
+   * \param child_seq_ids The ids of the child sequences to create.
+   * \param fork_pos The fork position of each child, or -1 for the last position.
+   */
+  virtual void BatchForkSequence(const ffi::Shape& parent_seq_ids,
+                                 const ffi::Shape& child_seq_ids,
+                                 const ffi::Shape& fork_pos) = 0;
+
+  /*!
+   * \brief Pop out the trailing tokens of multiple sequences in one call, which
+   * is equivalent to invoking PopN for each element in order.
+   * \param seq_ids The ids of the sequences to pop tokens from.
+   * \param ns The number of tokens to pop from each sequence.
+   */
+  virtual void BatchPopN(const ffi::Shape& seq_ids, const ffi::Shape& ns) = 0;
+
+  /************** Chunked Prefill **************/
+
+  /*!
+   * \brief Plan the incoming model forward under the given token budget, and
+   * begin the forward with the plan. The decode sequences (whose pending length
+   * is 1) are scheduled first, so that they advance in every step. The pending
+   * prefills are then split into chunks that fill the remaining budget in the
+   * order of the given sequences. The sequences with no scheduled tokens do not
+   * take part in the forward, and the order of the others is preserved.
+   * \param seq_ids The ids of the sequences that have pending tokens.
+   * \param pending_lengths The number of pending tokens of each sequence.
+   * \param token_budget The maximum number of tokens in the forward. It is
+   * further capped by the prefill chunk size of the KV cache.
+   * \return The number of tokens scheduled in the forward for each sequence.
+   */
+  virtual ffi::Shape BeginChunkedForward(const ffi::Shape& seq_ids,
+                                         const ffi::Shape& pending_lengths,
+                                         int64_t token_budget) = 0;
+
+  /*!
+   * \brief Prepare for the disaggregation KV data receive for the specified sequence and length.
+   * The pages of the received KV data are reserved in the sequence.
+   * \return The compressed position map of the reserved pages, in format
+   * "[n, begin_1, length_1, ..., begin_n, length_n, signal_slot]", which is passed to the
+   * DisaggMarkSend of the sender. The trailing signal slot identifies the receive when
+   * the sender signals the completion.
+   */
   virtual ffi::Shape DisaggPrepareRecv(int64_t seq_id, int length) = 0;
 
   /*! \brief Mark which tokens' KV cache needs to be sent to other devices */
@@ -166,6 +295,16 @@ class AttentionKVCacheObj : public KVStateObj {
                               const ffi::Shape& compressed_remote_position_map,
                               int32_t recver_pe_offset) = 0;
 
+  /*!
+   * \brief Wait for the disaggregation KV data of the specified sequence prepared by
+   * DisaggPrepareRecv to be fully received. The computation issued afterwards observes
+   * the received KV data.
+   * \param seq_id The id of the sequence to wait for.
+   * \param sender_pe_offset The PE offset of the sender group. It is only used when the
+   * KV data is transferred through the Disco CCL, where the receiver drives the receive.
+   */
+  virtual void DisaggWaitRecv(int64_t seq_id, int32_t sender_pe_offset) = 0;
+
   /************** Attention **************/
 
   /*!
@@ -195,6 +334,23 @@ class AttentionKVCacheObj : public KVStateObj {
   virtual void SelfAttention(int64_t layer_id, Tensor q_data, Tensor k_data, Tensor v_data,
                              Tensor o_data, Tensor lse_data, double sm_scale) = 0;
 
+  /*!
+   * \brief Fine-grained API that computes causal ragged self attention over the Q/K/V data
+   * sharded along the sequences over the workers of the Disco group, for sequence-parallel
+   * prefill. Every worker holds the same number of tokens of each sequence, and the shard of
+   * the i-th worker precedes the shard of the (i+1)-th worker. The K/V shards are rotated around
+   * the workers, and the partial attention of each earlier shard is merged into the output.
+   * \param layer_id The model layer where the attention compute happens.
+   * \param q_data The input Q data of the shard of the worker.
+   * \param k_data The input K data of the shard of the worker.
+   * \param v_data The input V data of the shard of the worker.
+   * \param o_data The output O data, in layout `(total_length, num_qo_heads, v_head_dim)`.
+   * \param lse_data The output attention LSE data, in layout `(total_length, num_qo_heads)`.
+   * \param sm_scale The additional attention scaling factor.
+   */
+  virtual void RingSelfAttention(int64_t layer_id, Tensor q_data, Tensor k_data, Tensor v_data,
+                                 Tensor o_data, Tensor lse_data, double sm_scale) = 0;
+
   /*!
    * \brief Fine-grained API that computes paged cross attention with Q and in-cache KV data.
    * \param layer_id The model layer where the attention compute happens.
@@ -346,6 +502,29 @@ class RNNState : public KVState {
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(RNNState, KVState, RNNStateObj);
 };
 
+/*!
+ * \brief The base class of the KV state of models interleaving attention and space state
+ * layers. It keeps one sequence table for an attention KV cache and an RNN state, and runs
+ * the sequence management and the forward bookkeeping of both in one call. The attention and
+ * space state layers query the components for their own computation.
+ */
+class HybridKVStateObj : public KVStateObj {
+ public:
+  /*! \brief Get the attention KV cache of the attention layers. */
+  virtual AttentionKVCache GetAttentionKVCache() const = 0;
+
+  /*! \brief Get the RNN state of the space state layers. */
+  virtual RNNState GetRNNState() const = 0;
+
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO("relax.vm.HybridKVState", HybridKVStateObj, KVStateObj);
+};
+
+class HybridKVState : public KVState {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(HybridKVState, KVState, HybridKVStateObj);
+};
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
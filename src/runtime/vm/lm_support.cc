@@ -45,7 +45,13 @@
 #include <tvm/runtime/tensor.h>
 #include <tvm/runtime/vm/vm.h>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../threading_backend.h"
 
 namespace tvm {
 namespace runtime {
@@ -426,40 +432,42 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef().def("vm.builtin.sample_top_p_from_logits", SampleTopPFromLogits);
 }
 
-int SampleTopPFromProb(Tensor prob, double top_p, double uniform_sample) {
-  TVM_FFI_ICHECK(prob.IsContiguous());
-  TVM_FFI_ICHECK((prob.DataType() == DLDataType{kDLFloat, 32, 1}));
-
-  if (prob->device.device_type != kDLCPU) {
-    prob = prob.CopyTo(DLDevice{kDLCPU, 0});
-  }
-
-  TVM_FFI_ICHECK(prob->device.device_type == kDLCPU);
-
-  for (int i = 0; i < prob->ndim - 1; ++i) {
-    TVM_FFI_ICHECK_EQ(prob->shape[i], 1) << "The leading dimensions of logits must be 1";
+/*!
+ * \brief The scratch buffer of the samplers on the current thread, which is grown but never
+ * shrunk so that sampling allocates nothing once warmed up.
+ */
+std::pair<float, int>* SamplingScratch(int64_t size) {
+  thread_local std::vector<std::pair<float, int>> scratch;
+  if (static_cast<int64_t>(scratch.size()) < size) {
+    scratch.resize(size);
   }
+  return scratch.data();
+}
 
+/*!
+ * \brief Sample from the top-p of a row of probabilities.
+ * \return The sampled index, or -1 if the row cannot be sampled from.
+ */
+int64_t SampleTopPFromProbRow(const float* p_prob, int64_t ndata, double top_p,
+                              double uniform_sample) {
   // Key observation: when we are doing top_p sampling
   // usually we only need to preserve some of the elements with
   // high probablities before we do sort
-  std::vector<std::pair<float, int>> data;
-  int64_t ndata = prob->shape[prob->ndim - 1];
-  const float* p_prob = static_cast<float*>(prob->data);
+  std::pair<float, int>* data = SamplingScratch(ndata);
 
   auto sample_top_p_with_filter = [&](float cuttoff) -> int64_t {
-    data.clear();
-    // filter the data with cuttoff
+    // filter the data with cuttoff, without branches so that the loop vectorizes
+    int64_t num_kept = 0;
     for (int64_t i = 0; i < ndata; ++i) {
-      if (p_prob[i] >= cuttoff) {
-        data.emplace_back(std::make_pair(p_prob[i], static_cast<int>(i)));
-      }
+      data[num_kept] = std::make_pair(p_prob[i], static_cast<int>(i));
+      num_kept += p_prob[i] >= cuttoff;
     }
-    if (data.size() == 0) return -1;
+    if (num_kept == 0) return -1;
+    std::pair<float, int>* data_end = data + num_kept;
     auto fcmp = [](const std::pair<float, int>& lhs, const std::pair<float, int>& rhs) {
       return lhs.first > rhs.first;
     };
-    std::sort(data.begin(), data.end(), fcmp);
+    std::sort(data, data_end, fcmp);
 
     // short cut, if we know that
     // uniform sample < p[0] / top_p
@@ -472,7 +480,7 @@ int SampleTopPFromProb(Tensor prob, double top_p, double uniform_sample) {
     // compute top_p_sum
     float cum_sum_prob = 0.0f;
     float top_p_sum = 0.0f;
-    for (auto it = data.begin(); it != data.end(); ++it) {
+    for (auto it = data; it != data_end; ++it) {
       float prob = it->first;
       if (cum_sum_prob < top_p) {
         top_p_sum += prob;
@@ -488,35 +496,53 @@ int SampleTopPFromProb(Tensor prob, double top_p, double uniform_sample) {
     // this means we might need to retry a smaller cutoff pt.
     if (cum_sum_prob < top_p && cuttoff != 0.0f) return -1;
 
-    for (auto it = data.begin(); it != data.end(); ++it) {
+    for (auto it = data; it != data_end; ++it) {
       if (uniform_sample < it->first / top_p_sum) {
         return it->second;
       }
     }
-    return data[data.size() - 1].second;
-  };
-
-  auto is_all_nan = [&]() -> bool {
-    return std::all_of(p_prob, p_prob + ndata, [](float x) { return std::isnan(x); });
+    return data[num_kept - 1].second;
   };
 
   if (top_p < 1) {
     // sample through cutoff by a number
     // by pigeonhole principle we will get at most 1024 elements
     // usually it is much less by applying this filtering(order of 10 - 20)
-    data.reserve(128);
     int64_t sampled_index = sample_top_p_with_filter(top_p / 1024);
     if (sampled_index >= 0) return sampled_index;
   }
   // fallback via full prob, rare case
-  data.reserve(ndata);
-  int64_t sampled_index = sample_top_p_with_filter(0.0f);
-  if (sampled_index < 0 && is_all_nan()) {
+  return sample_top_p_with_filter(0.0f);
+}
+
+/*! \brief Throw if a row of probabilities could not be sampled from. */
+void CheckSampledIndex(int64_t sampled_index, const float* p_prob, int64_t ndata) {
+  if (sampled_index >= 0) return;
+  if (std::all_of(p_prob, p_prob + ndata, [](float x) { return std::isnan(x); })) {
     TVM_FFI_THROW(InternalError) << "The output probabilities are all NaNs, can not sample from it";
-  } else if (sampled_index < 0) {
-    TVM_FFI_THROW(InternalError)
-        << "Cannot sample from the given probability distribution due to unknown reason";
   }
+  TVM_FFI_THROW(InternalError)
+      << "Cannot sample from the given probability distribution due to unknown reason";
+}
+
+int SampleTopPFromProb(Tensor prob, double top_p, double uniform_sample) {
+  TVM_FFI_ICHECK(prob.IsContiguous());
+  TVM_FFI_ICHECK((prob.DataType() == DLDataType{kDLFloat, 32, 1}));
+
+  if (prob->device.device_type != kDLCPU) {
+    prob = prob.CopyTo(DLDevice{kDLCPU, 0});
+  }
+
+  TVM_FFI_ICHECK(prob->device.device_type == kDLCPU);
+
+  for (int i = 0; i < prob->ndim - 1; ++i) {
+    TVM_FFI_ICHECK_EQ(prob->shape[i], 1) << "The leading dimensions of logits must be 1";
+  }
+
+  int64_t ndata = prob->shape[prob->ndim - 1];
+  const float* p_prob = static_cast<float*>(prob->data);
+  int64_t sampled_index = SampleTopPFromProbRow(p_prob, ndata, top_p, uniform_sample);
+  CheckSampledIndex(sampled_index, p_prob, ndata);
   return sampled_index;
 }
 
@@ -525,6 +551,72 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef().def("vm.builtin.sample_top_p_from_prob", SampleTopPFromProb);
 }
 
+/*! \brief The number of rows of a CPU float32 tensor whose last dimension is a row. */
+int64_t GetNumRows(const Tensor& tensor, const char* name) {
+  TVM_FFI_ICHECK(tensor.IsContiguous()) << name << " must be contiguous!";
+  TVM_FFI_ICHECK((tensor.DataType() == DLDataType{kDLFloat, 32, 1}))
+      << name << " data type is not float32!";
+  TVM_FFI_ICHECK(tensor->device.device_type == kDLCPU) << name << " device must be CPU!";
+  TVM_FFI_ICHECK_GE(tensor->ndim, 1) << name << " must have at least one dimension!";
+  int64_t num_rows = 1;
+  for (int i = 0; i < tensor->ndim - 1; ++i) {
+    num_rows *= tensor->shape[i];
+  }
+  return num_rows;
+}
+
+/*! \brief Check a CPU tensor holds one value of the dtype for each of the rows. */
+void CheckPerRowValues(const Tensor& tensor, DLDataType dtype, int64_t num_rows,
+                       const char* name) {
+  TVM_FFI_ICHECK(tensor.IsContiguous()) << name << " must be contiguous!";
+  TVM_FFI_ICHECK(tensor.DataType() == dtype) << name << " has unexpected data type!";
+  TVM_FFI_ICHECK(tensor->device.device_type == kDLCPU) << name << " device must be CPU!";
+  int64_t numel = 1;
+  for (int i = 0; i < tensor->ndim; ++i) {
+    numel *= tensor->shape[i];
+  }
+  TVM_FFI_ICHECK_EQ(numel, num_rows) << name << " must have one value for each row!";
+}
+
+/*!
+ * \brief Sample from the top-p of each row of probabilities. The rows are sampled in parallel
+ * on the runtime thread pool, with the per-thread scratch buffers so that no allocation
+ * happens per token.
+ * \param prob The probabilities of shape (batch_size, vocab_size).
+ * \param top_p The float32 top-p of each row, of shape (batch_size,).
+ * \param uniform_samples The float32 uniform sample of each row, of shape (batch_size,).
+ * \param sampled_indices The int64 output sampled index of each row, of shape (batch_size,).
+ */
+void BatchSampleTopPFromProb(Tensor prob, Tensor top_p, Tensor uniform_samples,
+                             Tensor sampled_indices) {
+  int64_t batch_size = GetNumRows(prob, "prob");
+  CheckPerRowValues(top_p, DLDataType{kDLFloat, 32, 1}, batch_size, "top_p");
+  CheckPerRowValues(uniform_samples, DLDataType{kDLFloat, 32, 1}, batch_size, "uniform_samples");
+  CheckPerRowValues(sampled_indices, DLDataType{kDLInt, 64, 1}, batch_size, "sampled_indices");
+  if (batch_size == 0) return;
+
+  int64_t ndata = prob->shape[prob->ndim - 1];
+  const float* p_prob = static_cast<float*>(prob->data);
+  const float* p_top_p = static_cast<float*>(top_p->data);
+  const float* p_uniform = static_cast<float*>(uniform_samples->data);
+  int64_t* p_sampled = static_cast<int64_t*>(sampled_indices->data);
+  // The errors are raised after the parallel loop, since the workers cannot throw.
+  parallel_for_with_threading_backend(
+      [&](int64_t i) {
+        p_sampled[i] =
+            SampleTopPFromProbRow(p_prob + i * ndata, ndata, p_top_p[i], p_uniform[i]);
+      },
+      0, batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    CheckSampledIndex(p_sampled[i], p_prob + i * ndata, ndata);
+  }
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("vm.builtin.batch_sample_top_p_from_prob", BatchSampleTopPFromProb);
+}
+
 Tensor MultinomialFromUniform(Tensor prob, Tensor uniform_sample) {
   TVM_FFI_ICHECK(prob.IsContiguous());
   TVM_FFI_ICHECK(uniform_sample.IsContiguous());
@@ -566,6 +658,19 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef().def("vm.builtin.multinomial_from_uniform", MultinomialFromUniform);
 }
 
+/*! \brief Apply the repetition penalty to the appeared tokens of a row of logits. */
+void ApplyRepetitionPenaltyRow(float* logits, const int* token_ids, int64_t num_token_ids,
+                               double penalty) {
+  for (int64_t i = 0; i < num_token_ids; ++i) {
+    int token_id = token_ids[i];
+    if (logits[token_id] <= 0) {
+      logits[token_id] *= penalty;
+    } else {  // logits > 0
+      logits[token_id] /= penalty;
+    }
+  }
+}
+
 // This is an inplace operation.
 void ApplyRepetitionPenalty(Tensor logits, Tensor token_ids, double penalty) {
   TVM_FFI_ICHECK(logits.IsContiguous());
@@ -577,15 +682,8 @@ void ApplyRepetitionPenalty(Tensor logits, Tensor token_ids, double penalty) {
   TVM_FFI_ICHECK(token_ids->device.device_type == kDLCPU) << "token_ids device must be CPU!";
   float* logits_raw_data = static_cast<float*>(logits->data);
   int* token_ids_data = static_cast<int*>(token_ids->data);
-  size_t num_token_ids = token_ids->shape[token_ids->ndim - 1];
-  for (size_t i = 0; i < num_token_ids; ++i) {
-    int token_id = token_ids_data[i];
-    if (logits_raw_data[token_id] <= 0) {
-      logits_raw_data[token_id] *= penalty;
-    } else {  // logits > 0
-      logits_raw_data[token_id] /= penalty;
-    }
-  }
+  int64_t num_token_ids = token_ids->shape[token_ids->ndim - 1];
+  ApplyRepetitionPenaltyRow(logits_raw_data, token_ids_data, num_token_ids, penalty);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -593,6 +691,47 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef().def("vm.builtin.apply_repetition_penalty", ApplyRepetitionPenalty);
 }
 
+/*!
+ * \brief Apply the repetition penalty to each row of logits in parallel. This is an inplace
+ * operation.
+ * \param logits The logits of shape (batch_size, vocab_size).
+ * \param token_ids The int32 appeared token ids of each row, of shape (batch_size, num_tokens).
+ * The rows with fewer appeared tokens are padded with negative ids, which are skipped.
+ * \param penalties The float32 penalty of each row, of shape (batch_size,).
+ */
+void BatchApplyRepetitionPenalty(Tensor logits, Tensor token_ids, Tensor penalties) {
+  int64_t batch_size = GetNumRows(logits, "logits");
+  CheckPerRowValues(penalties, DLDataType{kDLFloat, 32, 1}, batch_size, "penalties");
+  TVM_FFI_ICHECK(token_ids.IsContiguous());
+  TVM_FFI_ICHECK((token_ids.DataType() == DLDataType{kDLInt, 32, 1})) << "token ids must be int32!";
+  TVM_FFI_ICHECK(token_ids->device.device_type == kDLCPU) << "token_ids device must be CPU!";
+  TVM_FFI_ICHECK_EQ(token_ids->ndim, 2) << "token_ids must be of shape (batch_size, num_tokens)!";
+  TVM_FFI_ICHECK_EQ(token_ids->shape[0], batch_size);
+  if (batch_size == 0) return;
+
+  int64_t vocab_size = logits->shape[logits->ndim - 1];
+  int64_t num_token_ids = token_ids->shape[1];
+  float* logits_raw_data = static_cast<float*>(logits->data);
+  const int* token_ids_data = static_cast<int*>(token_ids->data);
+  const float* penalties_data = static_cast<float*>(penalties->data);
+  parallel_for_with_threading_backend(
+      [&](int64_t i) {
+        const int* row_token_ids = token_ids_data + i * num_token_ids;
+        // The padding is at the end of the row.
+        int64_t num_valid = std::find_if(row_token_ids, row_token_ids + num_token_ids,
+                                         [](int token_id) { return token_id < 0; }) -
+                            row_token_ids;
+        ApplyRepetitionPenaltyRow(logits_raw_data + i * vocab_size, row_token_ids, num_valid,
+                                  penalties_data[i]);
+      },
+      0, batch_size);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("vm.builtin.batch_apply_repetition_penalty", BatchApplyRepetitionPenalty);
+}
+
 /*!
  * \brief Apply presence and frequency penalty. This is an inplace operation.
  * \param logits The input logits before penalty.
@@ -634,27 +773,61 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                         ApplyPresenceAndFrequencyPenalty);
 }
 
+/*!
+ * \brief The number of independent accumulators of the row reductions. The reductions over
+ * floats are not reassociated by the compiler, so the accumulators are split by hand for the
+ * loops to vectorize.
+ */
+constexpr int kNumReductionLanes = 8;
+
+/*! \brief Apply softmax with temperature to a row of logits in place. */
+void ApplySoftmaxWithTemperatureRow(float* logits, int64_t vocab_size, float temperature) {
+  float inv_temp = 1.0f / temperature;
+  // Find the max logit, the temperature is positive so it is also the max scaled logit.
+  float lane_max[kNumReductionLanes];
+  std::fill(lane_max, lane_max + kNumReductionLanes, -std::numeric_limits<float>::infinity());
+  int64_t i = 0;
+  for (; i + kNumReductionLanes <= vocab_size; i += kNumReductionLanes) {
+    for (int lane = 0; lane < kNumReductionLanes; ++lane) {
+      lane_max[lane] = std::max(lane_max[lane], logits[i + lane]);
+    }
+  }
+  float m = *std::max_element(lane_max, lane_max + kNumReductionLanes);
+  for (; i < vocab_size; ++i) {
+    m = std::max(m, logits[i]);
+  }
+  // Exponentiate in place and sum.
+  float lane_sum[kNumReductionLanes] = {0.0f};
+  for (i = 0; i + kNumReductionLanes <= vocab_size; i += kNumReductionLanes) {
+    for (int lane = 0; lane < kNumReductionLanes; ++lane) {
+      float e = std::exp((logits[i + lane] - m) * inv_temp);
+      logits[i + lane] = e;
+      lane_sum[lane] += e;
+    }
+  }
+  double d = 0.0;
+  for (int lane = 0; lane < kNumReductionLanes; ++lane) {
+    d += lane_sum[lane];
+  }
+  for (; i < vocab_size; ++i) {
+    logits[i] = std::exp((logits[i] - m) * inv_temp);
+    d += logits[i];
+  }
+  float inv_sum = static_cast<float>(1.0 / d);
+  for (i = 0; i < vocab_size; ++i) {
+    logits[i] *= inv_sum;
+  }
+}
+
 // This is an inplace operation.
 void ApplySoftmaxWithTemperature(Tensor logits, double temperature) {
   TVM_FFI_ICHECK(logits.IsContiguous());
   TVM_FFI_ICHECK((logits.DataType() == DLDataType{kDLFloat, 32, 1}))
       << "Logits data type is not float32!";
   TVM_FFI_ICHECK(logits->device.device_type == kDLCPU) << "logits device must be CPU!";
-  int vocab_size = logits->shape[logits->ndim - 1];
+  int64_t vocab_size = logits->shape[logits->ndim - 1];
   float* logits_raw_data = static_cast<float*>(logits->data);
-  float inv_temp = 1.0f / temperature;
-  float m = std::numeric_limits<float>::min();
-  double d = 0.0f;
-  for (int i = 0; i < vocab_size; ++i) {
-    float x = logits_raw_data[i] * inv_temp;
-    float m_prev = m;
-    m = std::max(m, x);
-    d = d * std::exp(m_prev - m) + std::exp(x - m);
-  }
-  for (int i = 0; i < vocab_size; ++i) {
-    float x = logits_raw_data[i] * inv_temp;
-    logits_raw_data[i] = std::exp(x - m) / d;
-  }
+  ApplySoftmaxWithTemperatureRow(logits_raw_data, vocab_size, temperature);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -662,6 +835,34 @@ TVM_FFI_STATIC_INIT_BLOCK() {
   refl::GlobalDef().def("vm.builtin.apply_softmax_with_temperature", ApplySoftmaxWithTemperature);
 }
 
+/*!
+ * \brief Apply softmax with temperature to each row of logits in parallel. This is an inplace
+ * operation.
+ * \param logits The logits of shape (batch_size, vocab_size).
+ * \param temperatures The float32 positive temperature of each row, of shape (batch_size,).
+ */
+void BatchApplySoftmaxWithTemperature(Tensor logits, Tensor temperatures) {
+  int64_t batch_size = GetNumRows(logits, "logits");
+  CheckPerRowValues(temperatures, DLDataType{kDLFloat, 32, 1}, batch_size, "temperatures");
+  if (batch_size == 0) return;
+
+  int64_t vocab_size = logits->shape[logits->ndim - 1];
+  float* logits_raw_data = static_cast<float*>(logits->data);
+  const float* temperatures_data = static_cast<float*>(temperatures->data);
+  parallel_for_with_threading_backend(
+      [&](int64_t i) {
+        ApplySoftmaxWithTemperatureRow(logits_raw_data + i * vocab_size, vocab_size,
+                                       temperatures_data[i]);
+      },
+      0, batch_size);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("vm.builtin.batch_apply_softmax_with_temperature",
+                        BatchApplySoftmaxWithTemperature);
+}
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -0,0 +1,381 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/vm/lora_adapter_pool.cc
+ * \brief Runtime pool of LoRA adapter weights for batches mixing several adapters.
+ */
+
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/tensor.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+//-----------------------------------------------------------------------------
+// We keep the implementation private as they may subject to future changes.
+//
+// Users can interact with it through the runtime API function calls
+//-----------------------------------------------------------------------------
+
+/*!
+ * \brief A pool of LoRA adapters on device, for the segmented low-rank GEMM of batches whose
+ * sequences use different adapters.
+ *
+ * The pool is paged by adapter: it preallocates `num_slots` slots next to the KV cache, and
+ * each loaded adapter takes one slot holding all its weights. A layer has `num_weights`
+ * weights, e.g. the shrink and expand weights of each adapted projection, and the storage of
+ * a weight has layout `(num_slots, *weight_shape)`, so that `relax.lora.sgmv` indexes the slot
+ * of each segment of the batch. Adapters of a lower rank are zero-padded to the rank of the pool
+ * by the caller. Loading an adapter into a full pool evicts the least recently used adapter
+ * that the current round of forwarding does not use.
+ */
+class LoRAAdapterPoolObj : public ffi::Object {
+ private:
+  /*! \brief A loaded adapter. */
+  struct Adapter {
+    /*! \brief The slot holding the weights of the adapter. */
+    int64_t slot_id;
+    /*! \brief The forward round that last used the adapter, for the eviction. */
+    int64_t last_use;
+  };
+
+  /********************* Configuration *********************/
+
+  /*! \brief The number of layers in the model. */
+  const int64_t num_layers_;
+  /*! \brief The number of adapter slots in the storage. */
+  const int64_t num_slots_;
+  /*! \brief The shapes of the weights of a layer, excluding the slot dimension. */
+  const ffi::Array<ffi::Shape> weight_shapes_;
+  /*! \brief The data type of the weights. */
+  const DLDataType dtype_;
+  /*! \brief The device of the storage. */
+  const Device device_;
+  /*! \brief We fix int32 to be the index dtype of auxiliary data. */
+  const DLDataType dtype_aux_ = DLDataType{kDLInt, 32, 1};
+
+  /******************* Storage Structures *******************/
+
+  /*!
+   * \brief The storages of the weights.
+   * The array has `num_layers` arrays of `num_weights` Tensors, each of them has layout
+   * `(num_slots, *weight_shape)`.
+   */
+  ffi::Array<ffi::Array<Tensor>> storages_;
+  /*! \brief The ids of free slots, the lowest ones are used first. */
+  std::set<int64_t> free_slot_ids_;
+  /*! \brief The mapping from adapter ids to loaded adapters. */
+  std::unordered_map<int64_t, Adapter> adapters_;
+
+  /****************** Auxiliary Arrays ******************/
+
+  /*! \brief The number of rounds of forwarding so far. */
+  int64_t num_forwards_ = 0;
+  /*! \brief The number of segments of the current round of forwarding, -1 before the first. */
+  int64_t cur_num_segs_ = -1;
+  /*! \brief The adapters used by the current round of forwarding. */
+  std::set<int64_t> cur_adapter_ids_;
+  /*!
+   * \brief The device array holding the segment offsets followed by the slot of each segment,
+   * so that both are uploaded in a single copy. It grows with the number of segments.
+   */
+  Tensor aux_data_device_;
+  /*! \brief The view of the device array of the segment offsets. */
+  Tensor seg_indptr_view_;
+  /*! \brief The view of the device array of the slots of the segments. */
+  Tensor weight_indices_view_;
+
+ public:
+  /*! \brief Constructor. Take the pool configuration and allocate the storage. */
+  explicit LoRAAdapterPoolObj(int64_t num_layers, int64_t num_slots,
+                              ffi::Array<ffi::Shape> weight_shapes, DLDataType dtype,
+                              Device device)
+      : num_layers_(num_layers),
+        num_slots_(num_slots),
+        weight_shapes_(std::move(weight_shapes)),
+        dtype_(dtype),
+        device_(device) {
+    storages_.reserve(num_layers_);
+    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
+      ffi::Array<Tensor> layer_storages;
+      layer_storages.reserve(weight_shapes_.size());
+      for (const ffi::Shape& weight_shape : weight_shapes_) {
+        std::vector<int64_t> storage_shape = {num_slots_};
+        storage_shape.insert(storage_shape.end(), weight_shape.begin(), weight_shape.end());
+        layer_storages.push_back(Tensor::Empty(storage_shape, dtype_, device_));
+      }
+      storages_.push_back(layer_storages);
+    }
+    for (int64_t slot_id = 0; slot_id < num_slots_; ++slot_id) {
+      free_slot_ids_.insert(slot_id);
+    }
+  }
+
+  /************** Adapter Management **************/
+
+  /*!
+   * \brief Load the weights of an adapter into a slot, replacing the weights of the adapter
+   * if it is loaded already.
+   * \param adapter_id The non-negative id of the adapter.
+   * \param weights The `num_layers * num_weights` weights of the adapter, layer after layer,
+   * each of them in the shape of its weight in the pool.
+   */
+  void LoadAdapter(int64_t adapter_id, ffi::Array<Tensor> weights) {
+    TVM_FFI_CHECK_GE(adapter_id, 0, ValueError) << "The adapter id cannot be negative.";
+    int64_t num_weights = weight_shapes_.size();
+    TVM_FFI_CHECK_EQ(static_cast<int64_t>(weights.size()), num_layers_ * num_weights, ValueError)
+        << "Adapter " << adapter_id << " should have " << num_layers_ * num_weights
+        << " weights, " << num_weights << " for each of the " << num_layers_ << " layers.";
+    for (int64_t i = 0; i < static_cast<int64_t>(weights.size()); ++i) {
+      const ffi::Shape& expected = weight_shapes_[i % num_weights];
+      ffi::Shape shape = weights[i].Shape();
+      TVM_FFI_CHECK(shape.size() == expected.size() &&
+                        std::equal(shape.begin(), shape.end(), expected.begin()),
+                    ValueError)
+          << "Weight " << i << " of adapter " << adapter_id << " has shape " << shape
+          << ", while the pool expects " << expected;
+      TVM_FFI_CHECK(weights[i].DataType() == DataType(dtype_), ValueError)
+          << "Weight " << i << " of adapter " << adapter_id << " has dtype "
+          << weights[i].DataType() << ", while the pool expects " << DataType(dtype_);
+    }
+
+    auto it = adapters_.find(adapter_id);
+    if (it == adapters_.end()) {
+      it = adapters_.insert({adapter_id, Adapter{GetFreeSlot(), num_forwards_}}).first;
+    }
+    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
+      for (int64_t weight_id = 0; weight_id < num_weights; ++weight_id) {
+        DLTensor copy_dst = GetWeightPtrBySlot(layer_id, weight_id, it->second.slot_id);
+        Tensor::CopyFromTo(weights[layer_id * num_weights + weight_id].operator->(), &copy_dst);
+      }
+    }
+  }
+
+  /*! \brief Unload an adapter and free its slot. */
+  void UnloadAdapter(int64_t adapter_id) {
+    auto it = adapters_.find(adapter_id);
+    TVM_FFI_CHECK(it != adapters_.end(), ValueError)
+        << "The adapter \"" << adapter_id << "\" cannot be found in the LoRA adapter pool.";
+    free_slot_ids_.insert(it->second.slot_id);
+    adapters_.erase(it);
+    cur_adapter_ids_.erase(adapter_id);
+  }
+
+  /*! \brief Whether an adapter is loaded in the pool. */
+  bool HasAdapter(int64_t adapter_id) const { return adapters_.count(adapter_id); }
+
+  /*! \brief The number of free slots of the pool. */
+  int64_t GetNumFreeSlots() const { return free_slot_ids_.size(); }
+
+  /************** Interaction **************/
+
+  /*!
+   * \brief Prepare the segments of a round of forwarding, whose rows are the rows of the
+   * sequences one after the other.
+   * \param adapter_ids The adapter of each sequence, -1 for the base model only.
+   * \param append_lengths The number of rows of each sequence.
+   */
+  void BeginForward(const ffi::Shape& adapter_ids, const ffi::Shape& append_lengths) {
+    TVM_FFI_CHECK_EQ(adapter_ids.size(), append_lengths.size(), ValueError)
+        << "The adapter_ids size (" << adapter_ids.size() << ") and append_lengths size ("
+        << append_lengths.size() << ") mismatch.";
+    ++num_forwards_;
+    cur_adapter_ids_.clear();
+    // The consecutive sequences of the same adapter form one segment.
+    std::vector<int32_t> seg_indptr = {0};
+    std::vector<int32_t> weight_indices;
+    int64_t num_rows = 0;
+    for (size_t i = 0; i < adapter_ids.size(); ++i) {
+      int32_t slot_id = -1;
+      if (adapter_ids[i] >= 0) {
+        auto it = adapters_.find(adapter_ids[i]);
+        TVM_FFI_CHECK(it != adapters_.end(), ValueError)
+            << "The adapter \"" << adapter_ids[i]
+            << "\" cannot be found in the LoRA adapter pool.";
+        it->second.last_use = num_forwards_;
+        cur_adapter_ids_.insert(adapter_ids[i]);
+        slot_id = it->second.slot_id;
+      }
+      num_rows += append_lengths[i];
+      if (!weight_indices.empty() && weight_indices.back() == slot_id) {
+        seg_indptr.back() = num_rows;
+      } else {
+        weight_indices.push_back(slot_id);
+        seg_indptr.push_back(num_rows);
+      }
+    }
+    cur_num_segs_ = weight_indices.size();
+    SyncAuxArrayToDevice(seg_indptr, weight_indices);
+  }
+
+  /*! \brief Get the storage of a weight of a layer, of layout `(num_slots, *weight_shape)`. */
+  Tensor GetWeight(int64_t layer_id, int64_t weight_id) const {
+    TVM_FFI_CHECK(layer_id >= 0 && layer_id < num_layers_, IndexError)
+        << "The layer id " << layer_id << " is out of range [0, " << num_layers_ << ").";
+    TVM_FFI_CHECK(weight_id >= 0 && weight_id < static_cast<int64_t>(weight_shapes_.size()),
+                  IndexError)
+        << "The weight id " << weight_id << " is out of range [0, " << weight_shapes_.size()
+        << ").";
+    return storages_[layer_id][weight_id];
+  }
+
+  /*! \brief Get the int32 row offsets of the segments of the current round of forwarding. */
+  Tensor GetSegIndptr() const {
+    TVM_FFI_ICHECK_GE(cur_num_segs_, 0)
+        << "Please call `BeginForward` before getting the segments of the LoRA adapter pool.";
+    return seg_indptr_view_;
+  }
+
+  /*! \brief Get the int32 slot of each segment of the current round of forwarding. */
+  Tensor GetWeightIndices() const {
+    TVM_FFI_ICHECK_GE(cur_num_segs_, 0)
+        << "Please call `BeginForward` before getting the segments of the LoRA adapter pool.";
+    return weight_indices_view_;
+  }
+
+ private:
+  /*! \brief Round up an element offset of the auxiliary data to 16 bytes. */
+  int64_t AlignAuxOffset(int64_t num_elems) const {
+    int64_t align_elems = 16 / (dtype_aux_.bits / 8);
+    return (num_elems + align_elems - 1) / align_elems * align_elems;
+  }
+
+  /*! \brief Get the lowest free slot, evicting the least recently used adapter if needed. */
+  int64_t GetFreeSlot() {
+    if (free_slot_ids_.empty()) {
+      auto victim = adapters_.end();
+      for (auto it = adapters_.begin(); it != adapters_.end(); ++it) {
+        if (cur_adapter_ids_.count(it->first)) continue;
+        if (victim == adapters_.end() || it->second.last_use < victim->second.last_use) {
+          victim = it;
+        }
+      }
+      TVM_FFI_CHECK(victim != adapters_.end(), RuntimeError)
+          << "All " << num_slots_
+          << " slots of the LoRA adapter pool are used by the current batch.";
+      VLOG(1) << "Evict LoRA adapter " << victim->first << " from slot "
+              << victim->second.slot_id;
+      free_slot_ids_.insert(victim->second.slot_id);
+      adapters_.erase(victim);
+    }
+    int64_t slot_id = *free_slot_ids_.begin();
+    free_slot_ids_.erase(free_slot_ids_.begin());
+    return slot_id;
+  }
+
+  DLTensor GetWeightPtrBySlot(int64_t layer_id, int64_t weight_id, int64_t slot_id) {
+    Tensor storage = storages_[layer_id][weight_id];
+    int64_t weight_size = 1;
+    for (int64_t i = 1; i < storage->ndim; ++i) {
+      weight_size *= storage->shape[i];
+    }
+    // Create a new DLTensor with the same shape and dtype as the weight.
+    DLTensor weight = *(storage.operator->());
+    weight.byte_offset = slot_id * weight_size * storage->dtype.bits / 8;
+    weight.ndim = storage->ndim - 1;
+    weight.shape = const_cast<int64_t*>(weight.shape + 1);
+    weight.strides = weight.strides == nullptr ? nullptr : const_cast<int64_t*>(weight.strides + 1);
+    return weight;
+  }
+
+  /*! \brief Upload the segments of the current round of forwarding in a single copy. */
+  void SyncAuxArrayToDevice(const std::vector<int32_t>& seg_indptr,
+                            const std::vector<int32_t>& weight_indices) {
+    // The slots of the segments start at an aligned offset after the segment offsets.
+    int64_t indices_offset = AlignAuxOffset(seg_indptr.size());
+    std::vector<int32_t> aux_data(indices_offset + weight_indices.size(), 0);
+    std::copy(seg_indptr.begin(), seg_indptr.end(), aux_data.begin());
+    std::copy(weight_indices.begin(), weight_indices.end(), aux_data.begin() + indices_offset);
+    int64_t num_elems = aux_data.size();
+    if (!aux_data_device_.defined() || aux_data_device_->shape[0] < num_elems) {
+      aux_data_device_ = Tensor::Empty({std::max<int64_t>(2 * num_elems, 64)}, dtype_aux_, device_);
+    }
+    int64_t elem_bytes = dtype_aux_.bits / 8;
+    seg_indptr_view_ =
+        aux_data_device_.CreateView({static_cast<int64_t>(seg_indptr.size())}, dtype_aux_);
+    weight_indices_view_ = aux_data_device_.CreateView(
+        {static_cast<int64_t>(weight_indices.size())}, dtype_aux_, indices_offset * elem_bytes);
+
+    Tensor copy_view = aux_data_device_.CreateView({num_elems}, dtype_aux_);
+    DLTensor copy_dst = *copy_view.operator->();
+    DLTensor copy_src = copy_dst;
+    copy_src.data = aux_data.data();
+    copy_src.device = Device{kDLCPU, 0};
+    copy_src.byte_offset = 0;
+    Tensor::CopyFromTo(&copy_src, &copy_dst);
+  }
+
+ public:
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.vm.LoRAAdapterPool", LoRAAdapterPoolObj, ffi::Object);
+};
+
+class LoRAAdapterPool : public ffi::ObjectRef {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(LoRAAdapterPool, ffi::ObjectRef, LoRAAdapterPoolObj);
+};
+
+//-------------------------------------------------
+//  Register runtime functions
+//-------------------------------------------------
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("vm.builtin.lora_adapter_pool_create",
+           [](int64_t num_layers, int64_t num_slots, ffi::Array<ffi::Shape> weight_shapes,
+              Tensor init) {
+             // The dtype and device of the weights are given by the init tensor.
+             TVM_FFI_CHECK_GT(num_layers, 0, ValueError)
+                 << "The number of layers should be greater than 0.";
+             TVM_FFI_CHECK_GT(num_slots, 0, ValueError)
+                 << "The number of adapter slots should be greater than 0.";
+             TVM_FFI_CHECK(!weight_shapes.empty(), ValueError)
+                 << "The number of weights per layer should be greater than 0.";
+             ffi::ObjectPtr<LoRAAdapterPoolObj> n = ffi::make_object<LoRAAdapterPoolObj>(
+                 num_layers, num_slots, std::move(weight_shapes), init->dtype, init->device);
+             return LoRAAdapterPool(std::move(n));
+           })
+      .def_method("vm.builtin.lora_adapter_pool_load", &LoRAAdapterPoolObj::LoadAdapter)
+      .def_method("vm.builtin.lora_adapter_pool_unload", &LoRAAdapterPoolObj::UnloadAdapter)
+      .def_method("vm.builtin.lora_adapter_pool_has_adapter", &LoRAAdapterPoolObj::HasAdapter)
+      .def_method("vm.builtin.lora_adapter_pool_num_free_slots",
+                  &LoRAAdapterPoolObj::GetNumFreeSlots)
+      .def_method("vm.builtin.lora_adapter_pool_begin_forward", &LoRAAdapterPoolObj::BeginForward)
+      .def_method("vm.builtin.lora_adapter_pool_get_weight", &LoRAAdapterPoolObj::GetWeight)
+      .def_method("vm.builtin.lora_adapter_pool_get_seg_indptr",
+                  &LoRAAdapterPoolObj::GetSegIndptr)
+      .def_method("vm.builtin.lora_adapter_pool_get_weight_indices",
+                  &LoRAAdapterPoolObj::GetWeightIndices);
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
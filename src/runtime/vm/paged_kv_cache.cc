@@ -27,12 +27,19 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/disco/disco_worker.h>
 #include <tvm/runtime/memory/memory_manager.h>
+#include <tvm/runtime/metrics.h>
 #include <tvm/runtime/tensor.h>
 #include <tvm/support/cuda/nvtx.h>
 
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <numeric>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -52,6 +59,34 @@ namespace vm {
 // runtime API function calls
 //-------------------------------------------
 
+/*! \brief The copy of the leading KV data of a page to another page. */
+struct PagePrefixCopy {
+  /*! \brief The id of the page to copy from. */
+  int32_t src_page_id;
+  /*! \brief The id of the page to copy to. */
+  int32_t tgt_page_id;
+  /*! \brief The number of leading slots to copy. */
+  int32_t copy_length;
+};
+
+/*! \brief The process-wide occupancy metrics of the paged KV caches. */
+struct KVCacheMetrics {
+  metrics::Gauge* total_pages;
+  metrics::Gauge* free_pages;
+  metrics::Gauge* sequences;
+
+  static KVCacheMetrics& Get() {
+    static KVCacheMetrics kv_cache_metrics = [] {
+      metrics::Registry* registry = metrics::Registry::Global();
+      return KVCacheMetrics{
+          registry->GetGauge("tvm_kv_cache_total_pages", "Pages of all the paged KV caches."),
+          registry->GetGauge("tvm_kv_cache_free_pages", "Free pages of the paged KV caches."),
+          registry->GetGauge("tvm_kv_cache_sequences", "Sequences held by the paged KV caches.")};
+    }();
+    return kv_cache_metrics;
+  }
+};
+
 /*!
  * \brief The paged KV cache for attention.
  * - It supports managing the K/V data of **multiple sequences**.
@@ -76,7 +111,11 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
  private:
   /********************* Configuration *********************/
 
-  /*! \brief The page size (the sequence length each page manages) of the cache. */
+  /*!
+   * \brief The page size (the sequence length each page manages) of the cache.
+   * It is shared by all sequences, since the page tensors of every layer and the attention
+   * kernels reading them (TIR and FlashInfer alike) take one fixed page size.
+   */
   const int64_t page_size_;
   /*! \brief The number of layers in the model. */
   const int64_t num_layers_;
@@ -117,6 +156,11 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
 
   /*! \brief The KV cache dtype. */
   const DLDataType kv_dtype_;
+  /*!
+   * \brief The dtype that the KV data is stored in, which differs from
+   * `kv_dtype_` when the KV data is quantized (e.g., to FP8 or INT8).
+   */
+  const DLDataType kv_storage_dtype_;
   /*! \brief We fix int32 to be the index dtype of auxiliary data. */
   const DLDataType dtype_aux_ = DLDataType{kDLInt, 32, 1};
 
@@ -124,8 +168,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
 
   /*!
    * \brief The KV data managed by the KV cache.
-   * If KV transfer function is specifed, pages_ will be allocated by NVSHMEM as a whole Tensor.
-   * pages_ will contain tensor view of each layer.
+   * If KV transfer is enabled with NVSHMEM, pages_ will be allocated by NVSHMEM as a whole
+   * Tensor. pages_ will contain tensor view of each layer.
    * Otherwise, pages_ has `num_layers` Tensors, each of them
    * has layout (num_pages, 2, num_heads, page_size, qk_head_dim).
    * Along on the "2" dimension, index 0 stands for K and 1 stands for V.
@@ -133,10 +177,34 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   std::vector<Tensor> pages_;
   /*! \brief The whole KV cache allocated by NVSHMEM*/
   Tensor nvshmem_pages_;
+  /*!
+   * \brief The uint64 completion signals of the KV receives, allocated by NVSHMEM.
+   * A sender adds one to the signal slot of a receive after sending all its KV data.
+   */
+  Tensor disagg_recv_signal_;
+  /*! \brief The signal slots that are not taken by any pending receive. */
+  std::vector<int32_t> free_disagg_signal_slots_;
+  /*! \brief The number of completions each signal slot has been waited for. */
+  std::vector<uint64_t> disagg_signal_wait_values_;
+  /*! \brief The pending receive of each sequence: its signal slot and reserved positions. */
+  std::unordered_map<int64_t, std::pair<int32_t, std::vector<int32_t>>> disagg_pending_recvs_;
+  /*!
+   * \brief The float32 scales of the quantized KV data, which is empty
+   * when the KV data is not quantized. Each of the `num_layers` Tensors
+   * has layout (num_pages, page_size, 2, num_heads), holding the scale of
+   * every head of every K/V slot in the pages. The dequantized value is
+   * the stored value times its scale.
+   * Keeping one scale per slot makes appending never requantize the data
+   * already in a page, and keeps the scales of a page prefix contiguous.
+   */
+  std::vector<Tensor> page_scales_;
   /*! \brief The list of ids of released pages for page reuse. */
   std::vector<int32_t> free_page_ids_;
   /*! \brief The mapping from sequence ids to sequences. */
   std::unordered_map<int64_t, Sequence> seq_map_;
+  /*! \brief The free page and sequence numbers last added to the process-wide metrics. */
+  int64_t reported_free_pages_ = 0;
+  int64_t reported_num_sequences_ = 0;
 
   /********************* Sequence Block Structures *********************/
 
@@ -145,6 +213,43 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   /*! \brief The list of free available blocks (in their indices). */
   std::vector<int32_t> free_block_idx_;
 
+  /********************* Prefix Cache Structures *********************/
+
+  /*! \brief The list of all prefix tree nodes once allocated. Node 0 is the root. */
+  std::vector<PrefixTreeNode> prefix_tree_nodes_;
+  /*! \brief The list of free available prefix tree nodes (in their indices). */
+  std::vector<int32_t> free_prefix_tree_node_idx_;
+  /*! \brief The logical clock for the LRU eviction of prefix tree nodes. */
+  uint64_t prefix_tree_clock_ = 0;
+  /*! \brief The temporary sequence ids used for prefix tree maintenance. */
+  static constexpr const int64_t kPrefixCacheTempSeqId = std::numeric_limits<int64_t>::min();
+  static constexpr const int64_t kPrefixCacheTempChildSeqId = kPrefixCacheTempSeqId + 1;
+
+  /********************* Snapshot Constants *********************/
+
+  /*! \brief The magic bytes that start a sequence snapshot file. */
+  static constexpr const char kSnapshotMagic[8] = {'T', 'V', 'M', 'K', 'V', 'S', 'N', 'P'};
+  /*! \brief The version of the snapshot file format. */
+  static constexpr const int64_t kSnapshotVersion = 1;
+  /*! \brief The alignment of the page data in a snapshot file, so that it can be mapped. */
+  static constexpr const int64_t kSnapshotAlignment = 4096;
+
+  /********************* Host Swap Structures *********************/
+
+  /*!
+   * \brief The host memory chunks holding the KV data of swapped-out sequences.
+   * Each chunk has a Tensor for each of the `pages_` and `page_scales_` Tensors,
+   * which has the same layout except for the number of pages.
+   * Chunks are allocated lazily on swap-out.
+   */
+  std::vector<std::vector<Tensor>> host_page_chunks_;
+  /*! \brief The id of the first host page in each host memory chunk. */
+  std::vector<int32_t> host_page_chunk_begin_;
+  /*! \brief The total number of host pages allocated. */
+  int32_t num_total_host_pages_ = 0;
+  /*! \brief The list of ids of released host pages for host page reuse. */
+  std::vector<int32_t> free_host_page_ids_;
+
   /*********** Current Batch Info & Auxiliary Arrays on Device ***********/
   //-------------------------------------------
   // The following fields are auxiliary arrays on device.
@@ -175,12 +280,24 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   std::vector<bool> use_decode_kernel_;
   /*! \brief Whether the attention request is a decode request, set in BeginForwardFunction. */
   bool is_decode_request_;
+  /*!
+   * \brief Whether the plan of the last forward is a plain decode step that the next decode step
+   * of the same batch can patch instead of building from scratch.
+   */
+  bool decode_plan_reusable_ = false;
   /*! \brief The KV transfer recver disco group's PE offset in this forward.
              If no KV is transfered, recver is -1.
              Assume that all the KV are transfered to the same recver in the forward.
              todo: support multiple recver. */
   bool transfer_kv_;
   bool page_to_page_transfer_kv_;
+  /*! \brief The sends completing in this forward, as pairs of recver PE offset and signal slot. */
+  std::vector<std::pair<int32_t, int32_t>> kv_transfer_completed_sends_;
+  /*!
+   * \brief The sends of this forward through the Disco CCL, as the index of the first token
+   * in the batch, the number of tokens and the receiver worker id of each send.
+   */
+  std::vector<std::array<int64_t, 3>> kv_transfer_ccl_sends_;
   /*! \brief The auxiliary data manager for attention. */
   std::unique_ptr<PagedKVCacheAuxDataManager> aux_data_manager_;
 
@@ -191,6 +308,9 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   Tensor temp_attn_output_device_;
   Tensor temp_attn_lse_device_;
   Tensor merged_attn_lse_device_;
+  /*! \brief The double buffers of the K/V shards rotated by ring attention, allocated lazily. */
+  std::array<Tensor, 2> ring_attn_k_device_;
+  std::array<Tensor, 2> ring_attn_v_device_;
   std::vector<Tensor> temp_int_attn_workspace_;
   std::vector<Tensor> temp_int_pinned_attn_workspace_;
   Tensor temp_float_attn_workspace_;
@@ -261,6 +381,11 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   ffi::Optional<ffi::Function> f_transpose_append_mla_;
   ffi::Optional<ffi::Function> f_transfer_kv_;
   ffi::Optional<ffi::Function> f_transfer_kv_page_to_page_ = std::nullopt;
+  ffi::Optional<ffi::Function> f_transfer_kv_signal_ = std::nullopt;
+  ffi::Optional<ffi::Function> f_transfer_kv_wait_signal_ = std::nullopt;
+  /*! \brief The Disco CCL send/recv of KV data, used when NVSHMEM is not enabled. */
+  ffi::Optional<ffi::Function> f_ccl_kv_transfer_send_ = std::nullopt;
+  ffi::Optional<ffi::Function> f_ccl_kv_transfer_recv_ = std::nullopt;
   ffi::Function f_compact_copy_;
   std::unique_ptr<RaggedPrefillFunc> f_attention_prefill_ragged_;
   std::unique_ptr<PagedPrefillFunc> f_attention_prefill_;
@@ -274,6 +399,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   ffi::Function f_split_rotary_;
   ffi::Function f_copy_single_page_;
   ffi::Optional<ffi::Function> f_debug_get_kv_;
+  /*! \brief The ring exchange of Disco, looked up at the first ring attention. */
+  ffi::Optional<ffi::Function> f_ring_exchange_ = std::nullopt;
 
   /*! \brief The device this PagedKVCache runs on. */
   Device device_;
@@ -293,7 +420,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       int64_t num_total_pages, int64_t prefill_chunk_size, bool support_sliding_window,
       RoPEMode rope_mode, double rotary_scale, double rotary_theta,
       ffi::Optional<Tensor> rope_ext_factors, bool enable_kv_transfer, DLDataType dtype,
-      Device device, ffi::Optional<ffi::Function> f_transpose_append_mha,
+      DLDataType kv_storage_dtype, Device device,
+      ffi::Optional<ffi::Function> f_transpose_append_mha,
       ffi::Optional<ffi::Function> f_transpose_append_mla, ffi::Function f_compact_copy,
       std::unique_ptr<RaggedPrefillFunc> f_attention_prefill_ragged,
       std::unique_ptr<PagedPrefillFunc> f_attention_prefill,
@@ -327,6 +455,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         rotary_theta_(rotary_theta),
         rope_ext_factors_(std::move(rope_ext_factors)),
         kv_dtype_(dtype),
+        kv_storage_dtype_(kv_storage_dtype),
         reserved_num_seqs_(reserved_num_seqs),
         f_transpose_append_mha_(std::move(f_transpose_append_mha)),
         f_transpose_append_mla_(std::move(f_transpose_append_mla)),
@@ -345,22 +474,46 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         f_copy_single_page_(std::move(f_copy_single_page)),
         f_debug_get_kv_(std::move(f_debug_get_kv)),
         device_(device) {
-    // Note: For MLA, sliding window and disaggregation are disabled for now.
+    // Note: For MLA, disaggregation is disabled for now. The sliding window attention of MLA
+    // is computed by the TIR kernel passed in the slot of the sliding window prefill function.
     if (std::find(attn_kinds_.begin(), attn_kinds_.end(), AttnKind::kMLA) != attn_kinds_.end()) {
-      TVM_FFI_ICHECK(!support_sliding_window_) << "Sliding window not supported yet for MLA";
+      TVM_FFI_ICHECK(!support_sliding_window_ ||
+                     (f_attention_prefill_sliding_window_ != nullptr &&
+                      f_attention_prefill_sliding_window_->backend_kind == AttnBackendKind::kTIR))
+          << "Sliding window for MLA requires the TIR sliding window MLA prefill function";
       TVM_FFI_ICHECK(!enable_kv_transfer) << "KV transfer not supported yet for MLA";
     }
 
     pages_.reserve(num_layers);
+    bool use_nvshmem = false;
     if (enable_kv_transfer) {
       // For now, KV transfer only supports MHA.
       for (AttnKind attn_kind : attn_kinds_) {
         TVM_FFI_ICHECK(attn_kind == AttnKind::kMHA);
       }
-      const auto f_nvshmem_init =
-          tvm::ffi::Function::GetGlobal("runtime.disco.nvshmem.init_nvshmem");
-      TVM_FFI_ICHECK(f_nvshmem_init.has_value())
-          << "NVSHMEM is not enabled. Please make sure NVSHMEM is enabled when compiling TVM.";
+      use_nvshmem =
+          tvm::ffi::Function::GetGlobal("runtime.disco.nvshmem.init_nvshmem").has_value();
+      if (!use_nvshmem) {
+        // Fall back to the point-to-point send/recv of the Disco CCL, which goes through
+        // NVLink, RDMA or sockets as the CCL is configured.
+        const auto f_compiled_ccl = tvm::ffi::Function::GetGlobal("runtime.disco.compiled_ccl");
+        TVM_FFI_ICHECK(f_compiled_ccl.has_value())
+            << "Neither NVSHMEM nor a Disco CCL is enabled. Please make sure NVSHMEM, NCCL "
+               "or RCCL is enabled when compiling TVM.";
+        std::string ccl = (*f_compiled_ccl)().cast<ffi::String>();
+        f_ccl_kv_transfer_send_ =
+            tvm::ffi::Function::GetGlobal("runtime.disco." + ccl + ".kv_transfer_send");
+        f_ccl_kv_transfer_recv_ =
+            tvm::ffi::Function::GetGlobal("runtime.disco." + ccl + ".kv_transfer_recv");
+        TVM_FFI_ICHECK(f_ccl_kv_transfer_send_.has_value());
+        TVM_FFI_ICHECK(f_ccl_kv_transfer_recv_.has_value());
+      }
+      for (int32_t slot = reserved_num_seqs - 1; slot >= 0; --slot) {
+        free_disagg_signal_slots_.push_back(slot);
+      }
+      disagg_signal_wait_values_.resize(reserved_num_seqs, 0);
+    }
+    if (use_nvshmem) {
       const auto f_nvshmem_empty = tvm::ffi::Function::GetGlobal("runtime.disco.nvshmem.empty");
       TVM_FFI_ICHECK(f_nvshmem_empty.has_value());
       nvshmem_pages_ =
@@ -374,6 +527,11 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
             i * num_total_pages_ * 2 * num_kv_heads_ * page_size_ * qk_head_dim_ *
                 (nvshmem_pages_.DataType().bits + 7) / 8));
       }
+      disagg_recv_signal_ =
+          (*f_nvshmem_empty)(ffi::Shape({reserved_num_seqs}), DLDataType{kDLUInt, 64, 1}, device)
+              .cast<Tensor>();
+      std::vector<uint64_t> zeros(reserved_num_seqs, 0);
+      disagg_recv_signal_.CopyFromBytes(zeros.data(), reserved_num_seqs * sizeof(uint64_t));
 
       const auto f_transfer_kv_ptr = tvm::ffi::Function::GetGlobal("nvshmem.KVTransfer");
       const auto f_transfer_kv_page_to_page_ptr =
@@ -382,12 +540,37 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       TVM_FFI_ICHECK(f_transfer_kv_page_to_page_ptr.has_value());
       f_transfer_kv_ = *f_transfer_kv_ptr;
       f_transfer_kv_page_to_page_ = *f_transfer_kv_page_to_page_ptr;
+      f_transfer_kv_signal_ = tvm::ffi::Function::GetGlobal("nvshmem.KVTransferSignal");
+      f_transfer_kv_wait_signal_ = tvm::ffi::Function::GetGlobal("nvshmem.KVTransferWaitSignal");
+      TVM_FFI_ICHECK(f_transfer_kv_signal_.has_value());
+      TVM_FFI_ICHECK(f_transfer_kv_wait_signal_.has_value());
     } else {
       for (int i = 0; i < num_layers; ++i) {
         ffi::Shape kv_cache_shape =
             GetKVCacheShape(attn_kinds_[layer_id_begin_offset_ + i], num_total_pages,
                             reserved_num_seqs, num_kv_heads, page_size, qk_head_dim, v_head_dim);
-        pages_.push_back(Tensor::Empty(kv_cache_shape, dtype, device));
+        pages_.push_back(Tensor::Empty(kv_cache_shape, kv_storage_dtype, device));
+      }
+    }
+
+    // Allocate the scales of the quantized KV data.
+    if (DataType(kv_storage_dtype) != DataType(dtype)) {
+      TVM_FFI_ICHECK(!enable_kv_transfer) << "KV transfer not supported yet for quantized KV data";
+      for (AttnKind attn_kind : attn_kinds_) {
+        TVM_FFI_ICHECK(attn_kind == AttnKind::kMHA || attn_kind == AttnKind::kMHASliding)
+            << "Quantized KV data is only supported for multi-head attention.";
+      }
+      for (const auto* f_attention : std::initializer_list<const AttnBackendFunc*>{
+               f_attention_prefill_.get(), f_attention_decode_.get(),
+               f_attention_prefill_sliding_window_.get(),
+               f_attention_decode_sliding_window_.get()}) {
+        TVM_FFI_ICHECK(f_attention == nullptr || f_attention->backend_kind == AttnBackendKind::kTIR)
+            << "Quantized KV data is only supported by the TIR attention kernels.";
+      }
+      page_scales_.reserve(num_layers);
+      for (int i = 0; i < num_layers; ++i) {
+        page_scales_.push_back(Tensor::Empty({num_total_pages, page_size, 2, num_kv_heads},
+                                             DLDataType{kDLFloat, 32, 1}, device));
       }
     }
 
@@ -494,6 +677,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     for (int64_t page_id = num_total_pages - 1; page_id >= 0; --page_id) {
       free_page_ids_.push_back(page_id);
     }
+    // The root node of the prefix tree.
+    prefix_tree_nodes_.push_back(PrefixTreeNode());
 
     // If the device is CUDA/ROCm, we create a standalone copy stream, in
     // purpose to hide the latency of auxiliary stream copy.
@@ -524,9 +709,19 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       TVM_FFI_ICHECK(rope_mode_ == RoPEMode::kNormal)
           << "The RoPE mode must be normal to support RoPE extension factors.";
     }
+    KVCacheMetrics::Get().total_pages->Add(num_total_pages_);
+    ReportMetrics();
   }
 
   ~PagedAttentionKVCacheObj() {
+    KVCacheMetrics& metrics = KVCacheMetrics::Get();
+    metrics.total_pages->Add(-num_total_pages_);
+    metrics.free_pages->Add(-reported_free_pages_);
+    metrics.sequences->Add(-reported_num_sequences_);
+    // Wait for the pending swap copies before the host memory is released.
+    if (!host_page_chunks_.empty()) {
+      DeviceAPI::Get(device_)->StreamSync(device_, copy_stream_);
+    }
     // Free the copy stream if defined.
     if (copy_stream_ != nullptr) {
       DeviceAPI::Get(device_)->FreeStream(device_, copy_stream_);
@@ -545,7 +740,17 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     }
     global_block_pool_.clear();
     free_block_idx_.clear();
+    prefix_tree_nodes_.clear();
+    free_prefix_tree_node_idx_.clear();
+    prefix_tree_nodes_.push_back(PrefixTreeNode());
+    prefix_tree_clock_ = 0;
+    free_host_page_ids_.clear();
+    for (int32_t host_page_id = num_total_host_pages_ - 1; host_page_id >= 0; --host_page_id) {
+      free_host_page_ids_.push_back(host_page_id);
+    }
     dirty_aux_data_device_ = false;
+    decode_plan_reusable_ = false;
+    ReportMetrics();
   }
 
   /************** Sequence Management **************/
@@ -556,33 +761,61 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     int32_t block_idx = GetFreeBlock();
     seq_map_.insert({seq_id, Sequence(&global_block_pool_, block_idx)});
     dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
   }
 
   void RemoveSequence(int64_t seq_id) final {
     auto it = seq_map_.find(seq_id);
     TVM_FFI_ICHECK(it != seq_map_.end())
         << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
-    int32_t block_idx = it->second.last_block_idx;
-    // The block should have at least one reference, which comes from the sequence.
-    TVM_FFI_ICHECK_GE(global_block_pool_[block_idx].external_ref_cnt, 1);
-    while (block_idx != -1 && global_block_pool_[block_idx].external_ref_cnt == 1) {
-      // - Free pages in the last block.
-      for (int32_t page_id : global_block_pool_[block_idx].page_ids) {
-        free_page_ids_.push_back(page_id);
-      }
-      free_block_idx_.push_back(block_idx);
-      block_idx = global_block_pool_[block_idx].parent_idx;
-    }
-    // - Decrease the external reference of the parent block.
-    if (block_idx != -1) {
-      TVM_FFI_ICHECK_GT(global_block_pool_[block_idx].external_ref_cnt, 1);
-      --global_block_pool_[block_idx].external_ref_cnt;
-    }
+    // The last block should have at least one reference, which comes from the sequence.
+    ReleaseBlockRef(it->second.last_block_idx);
     seq_map_.erase(it);
     dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
   }
 
   void ForkSequence(int64_t parent_seq_id, int64_t child_seq_id, int64_t fork_pos = -1) final {
+    ForkSequenceImpl(parent_seq_id, child_seq_id, fork_pos, /*page_prefix_copies=*/nullptr);
+  }
+
+  void BatchForkSequence(const ffi::Shape& parent_seq_ids, const ffi::Shape& child_seq_ids,
+                         const ffi::Shape& fork_pos) final {
+    TVM_FFI_ICHECK_EQ(parent_seq_ids.size(), child_seq_ids.size())
+        << "The parent_seq_ids size (" << parent_seq_ids.size() << ") and child_seq_ids size ("
+        << child_seq_ids.size() << ") mismatch.";
+    TVM_FFI_ICHECK_EQ(parent_seq_ids.size(), fork_pos.size())
+        << "The parent_seq_ids size (" << parent_seq_ids.size() << ") and fork_pos size ("
+        << fork_pos.size() << ") mismatch.";
+    // The compact copy kernel does not copy the page scales of quantized KV data,
+    // in which case the page copies are launched one by one.
+    bool merge_copies = page_scales_.empty() && f_compact_copy_.defined();
+    std::vector<PagePrefixCopy> page_prefix_copies;
+    std::unordered_set<int64_t> children_with_pending_copy;
+    for (int i = 0; i < static_cast<int>(parent_seq_ids.size()); ++i) {
+      if (children_with_pending_copy.count(parent_seq_ids[i])) {
+        // The page of a child forked earlier in this batch is read only after it is copied.
+        CopyPagePrefixes(page_prefix_copies);
+        page_prefix_copies.clear();
+        children_with_pending_copy.clear();
+      }
+      size_t num_copies = page_prefix_copies.size();
+      ForkSequenceImpl(parent_seq_ids[i], child_seq_ids[i], fork_pos[i],
+                       merge_copies ? &page_prefix_copies : nullptr);
+      if (page_prefix_copies.size() > num_copies) {
+        children_with_pending_copy.insert(child_seq_ids[i]);
+      }
+    }
+    CopyPagePrefixes(page_prefix_copies);
+  }
+
+  /*!
+   * \brief Fork the child sequence from the parent sequence.
+   * \param page_prefix_copies When defined, the copy of the page that the fork
+   * position falls within is recorded here instead of being launched immediately.
+   */
+  void ForkSequenceImpl(int64_t parent_seq_id, int64_t child_seq_id, int64_t fork_pos,
+                        std::vector<PagePrefixCopy>* page_prefix_copies) {
     auto parent_it = seq_map_.find(parent_seq_id);
     TVM_FFI_ICHECK(parent_it != seq_map_.end())
         << "The parent sequence \"" << parent_seq_id << "\" cannot be found in KV cache.";
@@ -595,6 +828,9 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     TVM_FFI_ICHECK(parent_it->second.accepted_indices_committed)
         << "The parent sequence's token tree computed in the last round of forward has not been "
            "committed with accepted nodes.";
+    TVM_FFI_ICHECK(!parent_it->second.is_swapped_out)
+        << "The parent sequence \"" << parent_seq_id
+        << "\" is swapped out to host memory and should be swapped in before forking.";
 
     if (fork_pos == -1) {
       fork_pos = parent_it->second.seq_length;
@@ -688,13 +924,18 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         int32_t src_page_id = global_block_pool_[forked_block_idx].page_ids[0];
         int32_t tgt_page_id = GetFreePage();
         global_block_pool_[child_block_idx].page_ids.push_back(tgt_page_id);
-        CopySinglePage(src_page_id, tgt_page_id, in_page_offset);
+        if (page_prefix_copies != nullptr) {
+          page_prefix_copies->push_back({src_page_id, tgt_page_id, in_page_offset});
+        } else {
+          CopySinglePage(src_page_id, tgt_page_id, in_page_offset);
+        }
       }
       break;
     }
     // Create the child sequence with the child block.
     seq_map_.insert({child_seq_id, Sequence(&global_block_pool_, child_block_idx)});
     dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
   }
 
   void CopySinglePage(int32_t src_page_id, int32_t tgt_page_id, int64_t copy_length) {
@@ -706,18 +947,71 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       Tensor page_layer_view = pages_[layer];
       f_copy_single_page_(page_layer_view, src_page_id, tgt_page_id, copy_length);
     }
+    // The scales of the first `copy_length` slots of a page are contiguous.
+    for (const Tensor& page_scales : page_scales_) {
+      int64_t slot_nbytes = 2 * num_kv_heads_ * sizeof(float);
+      ffi::Shape shape{copy_length, 2, num_kv_heads_};
+      Tensor src_view =
+          page_scales.CreateView(shape, page_scales->dtype, src_page_id * page_size_ * slot_nbytes);
+      Tensor tgt_view =
+          page_scales.CreateView(shape, page_scales->dtype, tgt_page_id * page_size_ * slot_nbytes);
+      DLTensor copy_src = *src_view.operator->();
+      DLTensor copy_dst = *tgt_view.operator->();
+      Tensor::CopyFromTo(&copy_src, &copy_dst, copy_stream_);
+    }
     if (copy_stream_ != compute_stream_) {
       // Set the compute stream back.
       DeviceAPI::Get(device_)->SetStream(device_, compute_stream_);
     }
   }
 
+  /*!
+   * \brief Copy the leading KV data of multiple pages with the compact copy kernel,
+   * merging the copies into as few kernel launches as the auxiliary buffers allow.
+   */
+  void CopyPagePrefixes(const std::vector<PagePrefixCopy>& copies) {
+    int64_t max_total_copy_length =
+        std::min(static_cast<int64_t>(kTreeAttnMaxTreeSize) * reserved_num_seqs_,
+                 prefill_chunk_size_);
+    size_t begin = 0;
+    while (begin < copies.size()) {
+      if (begin > 0) {
+        // The host auxiliary arrays of the last launch are reused after the copy completes.
+        DeviceAPI::Get(device_)->StreamSync(device_, copy_stream_);
+      }
+      commit_copy_length_indptr_host_.clear();
+      commit_copy_src_pos_in_page_table_host_.clear();
+      commit_copy_dst_pos_in_page_table_host_.clear();
+      commit_copy_length_indptr_host_.push_back(0);
+      size_t end = begin;
+      while (end < copies.size() && static_cast<int64_t>(end - begin) < reserved_num_seqs_ &&
+             commit_copy_length_indptr_host_.back() + copies[end].copy_length <=
+                 max_total_copy_length) {
+        const PagePrefixCopy& copy = copies[end];
+        for (int32_t pos = 0; pos < copy.copy_length; ++pos) {
+          commit_copy_src_pos_in_page_table_host_.push_back(copy.src_page_id * page_size_ + pos);
+          commit_copy_dst_pos_in_page_table_host_.push_back(copy.tgt_page_id * page_size_ + pos);
+        }
+        commit_copy_length_indptr_host_.push_back(commit_copy_length_indptr_host_.back() +
+                                                  copy.copy_length);
+        ++end;
+      }
+      TVM_FFI_ICHECK_GT(end, begin) << "The page copy length " << copies[begin].copy_length
+                                    << " exceeds the capacity " << max_total_copy_length;
+      CompactKVCopy();
+      begin = end;
+    }
+  }
+
   void CompactKVCopy() {
     int total_copy_length = commit_copy_length_indptr_host_.back();
     TVM_FFI_ICHECK_GE(total_copy_length, 0);
     if (total_copy_length == 0) {
       return;
     }
+    TVM_FFI_ICHECK(page_scales_.empty())
+        << "KV compaction is not supported yet for quantized KV data";
+    int num_copies = static_cast<int>(commit_copy_length_indptr_host_.size()) - 1;
 
     // Copy indptr/src/dst arrays to GPU.
     aux_data_manager_->ResetCompactKVAuxDataCopy();
@@ -736,7 +1030,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     TVM_FFI_ICHECK(f_compact_copy_.defined()) << "Function \"f_compact_copy\" is not defined.";
     for (int layer = 0; layer < num_layers_; ++layer) {
       f_compact_copy_(pages_[layer], commit_copy_length_indptr_view,
-                      commit_copy_src_dst_pos_in_page_table_view, cur_batch_size_);
+                      commit_copy_src_dst_pos_in_page_table_view, num_copies);
     }
     if (copy_stream_ != compute_stream_) {
       // Set the compute stream back.
@@ -779,10 +1073,22 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     it->second.sliding_window_size = sliding_window_size;
   }
 
+  void BatchPopN(const ffi::Shape& seq_ids, const ffi::Shape& ns) final {
+    TVM_FFI_ICHECK_EQ(seq_ids.size(), ns.size())
+        << "The seq_ids size (" << seq_ids.size() << ") and ns size (" << ns.size()
+        << ") mismatch.";
+    for (int i = 0; i < static_cast<int>(seq_ids.size()); ++i) {
+      PopN(seq_ids[i], static_cast<int32_t>(ns[i]));
+    }
+  }
+
   void PopN(int64_t seq_id, int32_t n) final {
     auto it = seq_map_.find(seq_id);
     TVM_FFI_ICHECK(it != seq_map_.end())
         << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    TVM_FFI_ICHECK(!it->second.is_swapped_out)
+        << "The sequence \"" << seq_id
+        << "\" is swapped out to host memory and should be swapped in before popping.";
 
     TVM_FFI_ICHECK_GE(n, 0) << "The length of popping " << n << " cannot be negative.";
     TVM_FFI_ICHECK_LE(n, it->second.seq_length)
@@ -838,6 +1144,408 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     }
 
     dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
+  }
+
+  /************** Prefix Cache **************/
+
+  void CommitSequencePrefix(int64_t seq_id, const ffi::Shape& token_ids) final {
+    auto it = seq_map_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_map_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    // Take the pointer since the map may be updated by the temporary sequences below.
+    Sequence* seq = &it->second;
+    TVM_FFI_ICHECK_EQ(seq->sliding_window_size, -1)
+        << "The sequence \"" << seq_id
+        << "\" is enabled with sliding window and thus cannot be committed to prefix cache.";
+    TVM_FFI_ICHECK(seq->accepted_indices_committed)
+        << "The sequence's token tree computed in the last round of forward has not been "
+           "committed with accepted nodes.";
+    TVM_FFI_ICHECK(!seq->is_swapped_out)
+        << "The sequence \"" << seq_id
+        << "\" is swapped out to host memory and cannot be committed to prefix cache.";
+    TVM_FFI_ICHECK_LE(static_cast<int64_t>(token_ids.size()), seq->seq_length)
+        << "The number of committed tokens " << token_ids.size()
+        << " exceeds the length of sequence \"" << seq_id << "\", which is " << seq->seq_length;
+
+    // Only the full pages are committed.
+    int64_t commit_length = static_cast<int64_t>(token_ids.size()) / page_size_ * page_size_;
+    if (commit_length == 0) {
+      return;
+    }
+
+    // - Walk down the tree along the given tokens.
+    int32_t node_idx = 0;
+    int64_t pos = 0;
+    while (pos < commit_length) {
+      prefix_tree_nodes_[node_idx].last_access_time = ++prefix_tree_clock_;
+      auto [child_idx, match_length] =
+          MatchPrefixTreeChild(node_idx, token_ids, pos, commit_length);
+      // A child node is shared only when at least one full page matches.
+      int64_t page_aligned_match_length = match_length / page_size_ * page_size_;
+      if (child_idx == -1 || page_aligned_match_length == 0) {
+        break;
+      }
+      if (page_aligned_match_length ==
+          static_cast<int64_t>(prefix_tree_nodes_[child_idx].token_ids.size())) {
+        node_idx = child_idx;
+        pos += page_aligned_match_length;
+        continue;
+      }
+      // The tokens diverge inside the child node. Split the child node.
+      node_idx = SplitPrefixTreeNode(child_idx, page_aligned_match_length);
+      prefix_tree_nodes_[node_idx].last_access_time = prefix_tree_clock_;
+      pos += page_aligned_match_length;
+      break;
+    }
+    if (pos == commit_length) {
+      return;
+    }
+
+    // - Insert a new leaf node that refers to the block chain of the sequence.
+    int32_t block_idx = AcquireBlockChainPrefix(seq->last_block_idx, commit_length);
+    int32_t new_node_idx = GetFreePrefixTreeNode();
+    PrefixTreeNode& new_node = prefix_tree_nodes_[new_node_idx];
+    new_node.token_ids.assign(token_ids.begin() + pos, token_ids.begin() + commit_length);
+    new_node.end_pos = commit_length;
+    new_node.block_idx = block_idx;
+    new_node.parent_idx = node_idx;
+    new_node.last_access_time = prefix_tree_clock_;
+    prefix_tree_nodes_[node_idx].child_indices.push_back(new_node_idx);
+
+    if (global_block_pool_[seq->last_block_idx].external_ref_cnt > 1) {
+      // The last block of the sequence is now referenced by the prefix tree.
+      // To enable the sequence to continue decode, we add a new empty block
+      // at the end of the sequence, just like what ForkSequence does.
+      int32_t new_block_idx = GetFreeBlock();
+      global_block_pool_[new_block_idx].start_pos = seq->seq_length;
+      global_block_pool_[new_block_idx].parent_idx = seq->last_block_idx;
+      global_block_pool_[new_block_idx].external_ref_cnt = 1;
+      seq->last_block_idx = new_block_idx;
+    }
+    dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
+  }
+
+  int64_t AddSequenceWithPrefixMatch(int64_t seq_id, const ffi::Shape& token_ids) final {
+    TVM_FFI_ICHECK(seq_map_.find(seq_id) == seq_map_.end())
+        << "The sequence \"" << seq_id << "\" is already in the KV cache.";
+
+    // - Find the longest matched prefix in the tree.
+    int32_t node_idx = 0;
+    int64_t pos = 0;
+    int64_t num_tokens = token_ids.size();
+    while (pos < num_tokens) {
+      prefix_tree_nodes_[node_idx].last_access_time = ++prefix_tree_clock_;
+      auto [child_idx, match_length] = MatchPrefixTreeChild(node_idx, token_ids, pos, num_tokens);
+      if (child_idx == -1 || match_length == 0) {
+        break;
+      }
+      node_idx = child_idx;
+      pos += match_length;
+      prefix_tree_nodes_[node_idx].last_access_time = prefix_tree_clock_;
+      if (match_length < static_cast<int64_t>(prefix_tree_nodes_[node_idx].token_ids.size())) {
+        break;
+      }
+    }
+
+    if (pos == 0) {
+      AddSequence(seq_id);
+      return 0;
+    }
+    // - Fork the new sequence from the block chain of the matched node.
+    // The partially matched page (if any) is copied to the new sequence in ForkSequence.
+    TVM_FFI_ICHECK(seq_map_.find(kPrefixCacheTempSeqId) == seq_map_.end());
+    seq_map_.insert(
+        {kPrefixCacheTempSeqId,
+         Sequence(&global_block_pool_, prefix_tree_nodes_[node_idx].block_idx)});
+    ForkSequence(kPrefixCacheTempSeqId, seq_id, pos);
+    RemoveSequence(kPrefixCacheTempSeqId);
+    return pos;
+  }
+
+  /************** Host Memory Swap **************/
+
+  void SwapOutSequence(int64_t seq_id) final {
+    auto it = seq_map_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_map_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    Sequence& seq = it->second;
+    TVM_FFI_ICHECK(!seq.is_swapped_out)
+        << "The sequence \"" << seq_id << "\" is already swapped out to host memory.";
+    TVM_FFI_ICHECK(seq.accepted_indices_committed)
+        << "The sequence's token tree computed in the last round of forward has not been "
+           "committed with accepted nodes.";
+    for (int layer = 0; layer < num_layers_; ++layer) {
+      TVM_FFI_ICHECK(attn_kinds_[layer_id_begin_offset_ + layer] != AttnKind::kLinearAttn)
+          << "Swapping sequences to host memory is not supported for linear attention.";
+    }
+
+    // - Collect the pages of the blocks exclusively owned by the sequence.
+    // The blocks shared with other sequences or the prefix cache stay on device.
+    std::vector<int32_t> block_ids;
+    int64_t num_pages = 0;
+    for (int32_t block_idx = seq.last_block_idx;
+         block_idx != -1 && global_block_pool_[block_idx].external_ref_cnt == 1;
+         block_idx = global_block_pool_[block_idx].parent_idx) {
+      block_ids.push_back(block_idx);
+      num_pages += global_block_pool_[block_idx].page_ids.size();
+    }
+    ReserveHostPages(num_pages);
+    std::vector<int32_t> page_ids;
+    std::vector<int32_t> host_page_ids;
+    page_ids.reserve(num_pages);
+    host_page_ids.reserve(num_pages);
+    for (int32_t block_idx : block_ids) {
+      Block& block = global_block_pool_[block_idx];
+      TVM_FFI_ICHECK(block.host_page_ids.empty());
+      for (int32_t page_id : block.page_ids) {
+        int32_t host_page_id = free_host_page_ids_.back();
+        free_host_page_ids_.pop_back();
+        block.host_page_ids.push_back(host_page_id);
+        page_ids.push_back(page_id);
+        host_page_ids.push_back(host_page_id);
+      }
+    }
+
+    // - Copy the pages to host, and release the device pages.
+    CopyPagesBetweenDeviceAndHost(page_ids, host_page_ids, /*to_host=*/true);
+    for (int32_t block_idx : block_ids) {
+      Block& block = global_block_pool_[block_idx];
+      for (int32_t page_id : block.page_ids) {
+        free_page_ids_.push_back(page_id);
+      }
+      block.page_ids.clear();
+    }
+    seq.is_swapped_out = true;
+    dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
+  }
+
+  void SwapInSequence(int64_t seq_id) final {
+    auto it = seq_map_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_map_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    Sequence& seq = it->second;
+    TVM_FFI_ICHECK(seq.is_swapped_out)
+        << "The sequence \"" << seq_id << "\" is not swapped out to host memory.";
+
+    // - Collect the swapped-out blocks, which are exactly the blocks
+    // exclusively owned by the sequence since the swap-out.
+    std::vector<int32_t> block_ids;
+    size_t num_pages = 0;
+    for (int32_t block_idx = seq.last_block_idx;
+         block_idx != -1 && global_block_pool_[block_idx].external_ref_cnt == 1;
+         block_idx = global_block_pool_[block_idx].parent_idx) {
+      block_ids.push_back(block_idx);
+      num_pages += global_block_pool_[block_idx].host_page_ids.size();
+    }
+    EvictPrefixTreeNodes(num_pages);
+    TVM_FFI_ICHECK_GE(free_page_ids_.size(), num_pages)
+        << "The KV cache does not have enough free pages to swap in sequence \"" << seq_id
+        << "\", which requires " << num_pages << " pages while only " << free_page_ids_.size()
+        << " pages are available.";
+    std::vector<int32_t> page_ids;
+    std::vector<int32_t> host_page_ids;
+    page_ids.reserve(num_pages);
+    host_page_ids.reserve(num_pages);
+    for (int32_t block_idx : block_ids) {
+      Block& block = global_block_pool_[block_idx];
+      TVM_FFI_ICHECK(block.page_ids.empty());
+      for (int32_t host_page_id : block.host_page_ids) {
+        int32_t page_id = GetFreePage();
+        block.page_ids.push_back(page_id);
+        page_ids.push_back(page_id);
+        host_page_ids.push_back(host_page_id);
+      }
+    }
+
+    // - Copy the pages back to device, and release the host pages.
+    // The host pages are safe to reuse right away, since all the swap copies
+    // are issued in order on the same stream.
+    CopyPagesBetweenDeviceAndHost(page_ids, host_page_ids, /*to_host=*/false);
+    for (int32_t block_idx : block_ids) {
+      Block& block = global_block_pool_[block_idx];
+      for (int32_t host_page_id : block.host_page_ids) {
+        free_host_page_ids_.push_back(host_page_id);
+      }
+      block.host_page_ids.clear();
+    }
+    seq.is_swapped_out = false;
+    dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
+  }
+
+  /************** Persistent Snapshots **************/
+
+  void SaveSequenceSnapshot(int64_t seq_id, const ffi::Shape& token_ids, const ffi::String& path,
+                            const ffi::String& model_hash) final {
+    auto it = seq_map_.find(seq_id);
+    TVM_FFI_ICHECK(it != seq_map_.end())
+        << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    const Sequence& seq = it->second;
+    CheckSnapshotSupported();
+    TVM_FFI_ICHECK_EQ(seq.sliding_window_size, -1)
+        << "The sequence \"" << seq_id
+        << "\" is enabled with sliding window and thus cannot be snapshotted.";
+    TVM_FFI_ICHECK(seq.accepted_indices_committed)
+        << "The sequence's token tree computed in the last round of forward has not been "
+           "committed with accepted nodes.";
+    TVM_FFI_ICHECK(!seq.is_swapped_out)
+        << "The sequence \"" << seq_id
+        << "\" is swapped out to host memory and cannot be snapshotted.";
+    TVM_FFI_ICHECK_EQ(static_cast<int64_t>(token_ids.size()), seq.seq_length)
+        << "The number of token ids " << token_ids.size()
+        << " differs from the length of sequence \"" << seq_id << "\", which is "
+        << seq.seq_length;
+
+    // - Copy the pages of the whole block chain to host.
+    std::vector<int32_t> block_ids = seq.GetBlockTrace(global_block_pool_);
+    std::vector<int32_t> page_ids;
+    for (int32_t block_idx : block_ids) {
+      const Block& block = global_block_pool_[block_idx];
+      page_ids.insert(page_ids.end(), block.page_ids.begin(), block.page_ids.end());
+    }
+    std::vector<int32_t> host_page_ids = TakeFreeHostPages(page_ids.size());
+    CopyPagesBetweenDeviceAndHost(page_ids, host_page_ids, /*to_host=*/true);
+    DeviceAPI::Get(device_)->StreamSync(device_, copy_stream_);
+
+    // - Write the header, the block chain, the token ids, and then the pages of each paged
+    // tensor at an aligned offset, in the layout of the paged tensor.
+    std::ofstream out(std::string(path), std::ios::binary | std::ios::trunc);
+    TVM_FFI_CHECK(out.is_open(), ValueError) << "Cannot open KV cache snapshot file " << path;
+    auto write_i64 = [&out](int64_t value) {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    write_i64(kSnapshotVersion);
+    write_i64(model_hash.size());
+    out.write(model_hash.data(), model_hash.size());
+    std::vector<int64_t> layout = SnapshotLayout();
+    write_i64(layout.size());
+    for (int64_t value : layout) write_i64(value);
+    write_i64(block_ids.size());
+    for (int32_t block_idx : block_ids) {
+      const Block& block = global_block_pool_[block_idx];
+      write_i64(block.seq_length);
+      write_i64(block.start_pos);
+      write_i64(block.page_ids.size());
+    }
+    write_i64(token_ids.size());
+    for (int64_t token_id : token_ids) write_i64(token_id);
+    int64_t data_offset = static_cast<int64_t>(out.tellp()) + sizeof(int64_t);
+    data_offset = (data_offset + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+    write_i64(data_offset);
+    out.seekp(data_offset);
+    std::vector<Tensor> paged_tensors = GetPagedTensors();
+    for (size_t i = 0; i < paged_tensors.size(); ++i) {
+      int64_t page_nbytes = GetPageNBytes(paged_tensors[i]);
+      for (int32_t host_page_id : host_page_ids) {
+        out.write(HostPageData(host_page_id, i, page_nbytes), page_nbytes);
+      }
+    }
+    free_host_page_ids_.insert(free_host_page_ids_.end(), host_page_ids.begin(),
+                               host_page_ids.end());
+    TVM_FFI_CHECK(out.good(), ValueError) << "Failed to write KV cache snapshot file " << path;
+  }
+
+  ffi::Shape RestoreSequenceSnapshot(int64_t seq_id, const ffi::String& path,
+                                     const ffi::String& model_hash) final {
+    TVM_FFI_ICHECK(seq_map_.find(seq_id) == seq_map_.end())
+        << "The sequence \"" << seq_id << "\" is already in the KV cache.";
+    CheckSnapshotSupported();
+
+    // - Read and validate the header.
+    std::ifstream in(std::string(path), std::ios::binary);
+    TVM_FFI_CHECK(in.is_open(), ValueError) << "Cannot open KV cache snapshot file " << path;
+    auto read_i64 = [&in, &path]() {
+      int64_t value = 0;
+      in.read(reinterpret_cast<char*>(&value), sizeof(value));
+      TVM_FFI_CHECK(in.good(), ValueError) << "The KV cache snapshot file " << path
+                                           << " is truncated";
+      return value;
+    };
+    char magic[sizeof(kSnapshotMagic)];
+    in.read(magic, sizeof(magic));
+    TVM_FFI_CHECK(in.good() && std::memcmp(magic, kSnapshotMagic, sizeof(magic)) == 0, ValueError)
+        << "The file " << path << " is not a KV cache snapshot";
+    int64_t version = read_i64();
+    TVM_FFI_CHECK_EQ(version, kSnapshotVersion, ValueError)
+        << "The KV cache snapshot " << path << " has version " << version
+        << ", which differs from the supported version " << kSnapshotVersion;
+    std::string file_model_hash(read_i64(), '\0');
+    in.read(file_model_hash.data(), file_model_hash.size());
+    TVM_FFI_CHECK(file_model_hash == std::string(model_hash), ValueError)
+        << "The KV cache snapshot " << path << " was saved for model \"" << file_model_hash
+        << "\", but the model is \"" << model_hash << "\"";
+    std::vector<int64_t> layout(read_i64());
+    for (int64_t& value : layout) value = read_i64();
+    TVM_FFI_CHECK(layout == SnapshotLayout(), ValueError)
+        << "The KV cache snapshot " << path
+        << " was saved from a KV cache of a different page size, head layout, dtype or RoPE "
+           "configuration";
+    std::vector<std::array<int64_t, 3>> blocks(read_i64());
+    int64_t num_pages = 0;
+    for (std::array<int64_t, 3>& block : blocks) {
+      for (int64_t& value : block) value = read_i64();
+      num_pages += block[2];
+    }
+    std::vector<int64_t> token_ids(read_i64());
+    for (int64_t& token_id : token_ids) token_id = read_i64();
+    int64_t data_offset = read_i64();
+
+    EvictPrefixTreeNodes(num_pages);
+    TVM_FFI_ICHECK_GE(static_cast<int64_t>(free_page_ids_.size()), num_pages)
+        << "The KV cache does not have enough free pages to restore the snapshot " << path
+        << ", which requires " << num_pages << " pages while only " << free_page_ids_.size()
+        << " pages are available.";
+
+    // - Read the pages into host pages. The earlier copies of the free host pages must finish
+    // before the host pages are overwritten.
+    DeviceAPI::Get(device_)->StreamSync(device_, copy_stream_);
+    std::vector<int32_t> host_page_ids = TakeFreeHostPages(num_pages);
+    in.seekg(data_offset);
+    std::vector<Tensor> paged_tensors = GetPagedTensors();
+    for (size_t i = 0; i < paged_tensors.size(); ++i) {
+      int64_t page_nbytes = GetPageNBytes(paged_tensors[i]);
+      for (int32_t host_page_id : host_page_ids) {
+        in.read(HostPageData(host_page_id, i, page_nbytes), page_nbytes);
+      }
+    }
+    if (!in.good()) {
+      free_host_page_ids_.insert(free_host_page_ids_.end(), host_page_ids.begin(),
+                                 host_page_ids.end());
+      TVM_FFI_THROW(ValueError) << "The KV cache snapshot file " << path << " is truncated";
+    }
+
+    // - Rebuild the block chain on free pages, and copy the pages to device asynchronously.
+    std::vector<int32_t> page_ids;
+    page_ids.reserve(num_pages);
+    int32_t parent_block_idx = -1;
+    for (const std::array<int64_t, 3>& block : blocks) {
+      int32_t block_idx = GetFreeBlock();
+      for (int64_t i = 0; i < block[2]; ++i) {
+        page_ids.push_back(GetFreePage());
+      }
+      Block& new_block = global_block_pool_[block_idx];
+      new_block.seq_length = block[0];
+      new_block.start_pos = block[1];
+      new_block.page_ids.assign(page_ids.end() - block[2], page_ids.end());
+      new_block.parent_idx = parent_block_idx;
+      if (parent_block_idx != -1) {
+        global_block_pool_[parent_block_idx].external_ref_cnt = 1;
+      }
+      parent_block_idx = block_idx;
+    }
+    TVM_FFI_ICHECK_NE(parent_block_idx, -1);
+    seq_map_.insert({seq_id, Sequence(&global_block_pool_, parent_block_idx)});
+    CopyPagesBetweenDeviceAndHost(page_ids, host_page_ids, /*to_host=*/false);
+    // The host pages are safe to reuse by later copies on the same stream.
+    free_host_page_ids_.insert(free_host_page_ids_.end(), host_page_ids.begin(),
+                               host_page_ids.end());
+    dirty_aux_data_device_ = true;
+    decode_plan_reusable_ = false;
+    return ffi::Shape(token_ids);
   }
 
   /************** Raw Info Query **************/
@@ -867,10 +1575,15 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       TVM_FFI_ICHECK(!opt_token_tree_parent_ptr.has_value())
           << "Tree attention is not supported yet for MLA";
     }
+    TVM_FFI_ICHECK(page_scales_.empty() || !opt_token_tree_parent_ptr.has_value())
+        << "Tree attention is not supported yet for quantized KV data";
 
     TVM_FFI_ICHECK_EQ(seq_ids.size(), append_lengths.size())
         << "The seq_ids size (" << seq_ids.size() << ") and append_lengths size ("
         << append_lengths.size() << ") mismatch.";
+    // - Check whether the plan of the previous decode step can be patched before the batch is
+    // overwritten.
+    bool patch_decode_plan = CanPatchDecodePlan(seq_ids, append_lengths, opt_token_tree_parent_ptr);
     cur_batch_size_ = seq_ids.size();
     cur_seq_ids_ = seq_ids;
     cur_append_lengths_ = append_lengths;
@@ -886,6 +1599,10 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       auto it = seq_map_.find(seq_ids[i]);
       TVM_FFI_ICHECK(it != seq_map_.end())
           << "The sequence \"" << seq_ids[i] << "\" cannot be found in KV cache.";
+      // Bring the preempted sequence back to device before it takes part in the forward.
+      if (it->second.is_swapped_out) {
+        SwapInSequence(seq_ids[i]);
+      }
       sequences.push_back(&it->second);
       last_block_length_before_append.push_back(
           global_block_pool_[it->second.last_block_idx].seq_length);
@@ -901,226 +1618,10 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       }
     }
 
-    auto [block_ids_on_depths, trailing_blocks] =
-        GetBlockIdsOnDepth(sequences, global_block_pool_, cur_batch_size_);
-    num_depths_ =
-        std::min(static_cast<int>(block_ids_on_depths.size()), kPagedKVCacheMaxBlockDepth);
-    TVM_FFI_ICHECK_LE(num_depths_, kPagedKVCacheMaxBlockDepth);
-
-    std::vector<std::vector<std::pair<int32_t, int32_t>>> chunked_block_ids_arr;
-    chunked_block_ids_arr.reserve(num_depths_);
-    use_decode_kernel_.clear();
-    for (int d = 0; d < num_depths_; ++d) {
-      // We force the blocks at maximum depth not to coalesce, so that it can be concatenated with
-      // trailing exceeding blocks.
-      auto [chunked_block_ids, use_decode_kernel] = GetChunkedBlockIds(
-          block_ids_on_depths[d], /*enable_coalesce=*/d != kPagedKVCacheMaxBlockDepth - 1,
-          cur_append_lengths_, global_block_pool_, is_decode_request_);
-      chunked_block_ids_arr.push_back(chunked_block_ids);
-      use_decode_kernel_.push_back(use_decode_kernel);
-    }
-
-    if (num_depths_ == kPagedKVCacheMaxBlockDepth) {
-      // Since we force the blocks at maximum depth not to coalesce, the output blocks at maximum
-      // depth must have the same size as current batch.
-      TVM_FFI_ICHECK_EQ(chunked_block_ids_arr[num_depths_ - 1].size(), cur_batch_size_);
-    }
-
-    append_before_attn_ = !support_sliding_window_ && use_decode_kernel_.back();
-    if (NeedKernelBeginForward() && num_qo_heads_ / num_kv_heads_ >= 4) {
-      // When GQA group size is at least 4 and FlashInfer is enabled,
-      // we always use prefill kernel for better performance.
-      // Note: For MLA, we always use prefill kernel, so values in `use_decode_kernel` will
-      // be ignored for MLA.
-      std::fill(use_decode_kernel_.begin(), use_decode_kernel_.end(), /*value=*/false);
-    }
-
-    bool has_previous_tree =
-        std::any_of(sequences.begin(), sequences.end(),
-                    [](const Sequence* sequence) { return !sequence->accepted_indices_committed; });
-    if (has_previous_tree) {
-      append_before_attn_ = true;
-    }
-
-    // - Check token tree validity and process the token tree.
-    if (opt_token_tree_parent_ptr.has_value()) {
-      TVM_FFI_ICHECK(!support_sliding_window_) << "Tree attention does not support sliding window.";
-      TVM_FFI_ICHECK(rope_mode_ != RoPEMode::kInline)
-          << "Tree attention does not support inline RoPE mode.";
-      ConstructTokenTreeMask(sequences, opt_token_tree_parent_ptr.value(), block_ids_on_depths,
-                             trailing_blocks);
+    if (patch_decode_plan) {
+      PatchDecodePlan(sequences);
     } else {
-      // The input batch does not form trees. So each sequence in the batch
-      // is required to have all past accepted tokens committed.
-      for (int i = 0; i < cur_batch_size_; ++i) {
-        Sequence* sequence = sequences[i];
-        TVM_FFI_ICHECK(sequence->accepted_indices_committed)
-            << "The input batch does not form a tree, in which case the sequences in the input "
-               "batch are expected to have their accepted tokens token tree nodes committed. "
-               "Please invoke CommitAcceptedTokenTreeNodes for sequence "
-            << seq_ids[i];
-        sequence->is_chain = true;
-        sequence->token_tree_parent_ptr.clear();
-        sequence->token_tree_node_depths.clear();
-      }
-      std::fill(is_chain_on_depths_.begin(), is_chain_on_depths_.end(), true);
-    }
-
-    if (append_before_attn_) {
-      // Right now we use different kernels when depth is 1 or not 1.
-      // For the case where maximum depth is 1, we create the auxiliary
-      // data structure with regard to the page table after appending.
-      for (int i = 0; i < cur_batch_size_; ++i) {
-        ReserveAppendLengthInSeq(sequences[i], append_lengths[i]);
-      }
-    }
-
-    for (int d = 0; d < num_depths_; ++d) {
-      HostMemoryVector& qo_indptr_h = qo_indptr_on_depths_host_[d];
-      HostMemoryVector& page_indptr_h = page_indptr_on_depths_host_[d];
-      HostMemoryVector& page_indices_h = page_indices_on_depths_host_[d];
-      HostMemoryVector& page_indptr_sliding_window_h =
-          page_indptr_sliding_window_on_depths_host_[d];
-      HostMemoryVector& page_indices_sliding_window_h =
-          page_indices_sliding_window_on_depths_host_[d];
-      HostMemoryVector& last_page_len_h = last_page_len_on_depths_host_[d];
-      HostMemoryVector& sliding_window_offset_h = sliding_window_offset_on_depths_host_[d];
-      HostMemoryVector& sink_size_h = sink_size_on_depths_host_[d];
-      HostMemoryVector& k_rope_pos_offset_h = k_rope_pos_offset_on_depths_host_[d];
-      HostMemoryVector& k_rope_pos_offset_sliding_window_h =
-          k_rope_pos_offset_sliding_window_on_depths_host_[d];
-      qo_indptr_h.clear();
-      page_indptr_h.clear();
-      page_indices_h.clear();
-      page_indptr_sliding_window_h.clear();
-      page_indices_sliding_window_h.clear();
-      last_page_len_h.clear();
-      sliding_window_offset_h.clear();
-      sink_size_h.clear();
-      k_rope_pos_offset_h.clear();
-      k_rope_pos_offset_sliding_window_h.clear();
-      qo_indptr_h.push_back(0);
-      page_indptr_h.push_back(0);
-      page_indptr_sliding_window_h.push_back(0);
-      for (int i = 0; i < static_cast<int>(chunked_block_ids_arr[d].size()); ++i) {
-        const auto& [block_id, chunk_append_length] = chunked_block_ids_arr[d][i];
-        qo_indptr_h.push_back(qo_indptr_h.back() + chunk_append_length);
-        if (block_id == -1) {
-          page_indptr_h.push_back(page_indptr_h.back());
-          page_indptr_sliding_window_h.push_back(page_indptr_sliding_window_h.back());
-          last_page_len_h.push_back(0);
-          sliding_window_offset_h.push_back(0);
-          sink_size_h.push_back(0);
-          k_rope_pos_offset_h.push_back(0);
-          k_rope_pos_offset_sliding_window_h.push_back(0);
-        } else {
-          if (d < kPagedKVCacheMaxBlockDepth - 1) {
-            // Blocks not at maximum depth
-            const Block& block = global_block_pool_[block_id];
-            page_indptr_h.push_back(page_indptr_h.back() + block.page_ids.size());
-            for (int32_t page_id : block.page_ids) {
-              page_indices_h.push_back(page_id);
-              // Do the same for page_indices_sliding_window
-            }
-
-            // For sliding window, the first page and last page will both be partially used
-            page_indptr_sliding_window_h.push_back(
-                page_indptr_sliding_window_h.back() +
-                std::min(static_cast<int32_t>(block.page_ids.size()),
-                         static_cast<int32_t>(1024 / page_size_ +
-                                              (block.seq_length % page_size_ ? 1 : 0))));
-            for (int i = page_indices_h.size() - page_indptr_sliding_window_h.back();
-                 i < static_cast<int32_t>(page_indices_h.size()); i++) {
-              page_indices_sliding_window_h.push_back(page_indices_h[i]);
-            }
-            // set up the page indices properly by choosing the last (sliding_window_size /
-            // page_size_) pages (at most)
-            last_page_len_h.push_back(
-                block.seq_length == 0
-                    ? 0
-                    : (block.seq_length - block.sink_length + block.sliding_window_offset - 1) %
-                              page_size_ +
-                          1);
-            if (support_layer_sliding_window_) {
-              if (block.seq_length < 1024) {
-                sliding_window_offset_h.push_back(0);
-              } else {
-                sliding_window_offset_h.push_back(block.seq_length % page_size_);
-              }
-            } else {
-              sliding_window_offset_h.push_back(block.sliding_window_offset);
-            }
-            sink_size_h.push_back(block.sink_length);
-            k_rope_pos_offset_h.push_back(block.start_pos);
-
-            // If sliding window, we need to calculate the positional offset
-            if (support_layer_sliding_window_) {
-              k_rope_pos_offset_sliding_window_h.push_back(
-                  std::max(0, block.start_pos + block.seq_length - 1024));
-            }
-          } else {
-            // Blocks at maximum depth
-            const Block& block = global_block_pool_[block_id];
-            int32_t num_pages = static_cast<int32_t>(block.page_ids.size());
-            int32_t total_seq_length = static_cast<int32_t>(block.seq_length);
-            int32_t last_block_id = block_id;
-            for (int32_t page_id : block.page_ids) {
-              page_indices_h.push_back(page_id);
-            }
-            for (int32_t id : trailing_blocks[i]) {
-              // Collect trailing blocks if available
-              const Block& block = global_block_pool_[id];
-              for (int32_t page_id : block.page_ids) {
-                page_indices_h.push_back(page_id);
-              }
-              num_pages += block.page_ids.size();
-              total_seq_length += block.seq_length;
-              last_block_id = id;
-            }
-            page_indptr_h.push_back(page_indptr_h.back() + num_pages);
-            page_indptr_sliding_window_h.push_back(
-                page_indptr_sliding_window_h.back() +
-                std::min(static_cast<int32_t>(block.page_ids.size()),
-                         static_cast<int32_t>(1024 / page_size_ +
-                                              (block.seq_length % page_size_ ? 1 : 0))));
-            for (int i = page_indices_h.size() - page_indptr_sliding_window_h.back();
-                 i < static_cast<int32_t>(page_indices_h.size()); i++) {
-              page_indices_sliding_window_h.push_back(page_indices_h[i]);
-            }
-            const Block& last_block = global_block_pool_[last_block_id];
-            last_page_len_h.push_back(total_seq_length == 0
-                                          ? 0
-                                          : (total_seq_length - last_block.sink_length +
-                                             last_block.sliding_window_offset - 1) %
-                                                    page_size_ +
-                                                1);
-            if (support_layer_sliding_window_) {
-              if (last_block.seq_length < 1024) {
-                sliding_window_offset_h.push_back(0);
-              } else {
-                sliding_window_offset_h.push_back(last_block.seq_length % page_size_);
-              }
-            } else {
-              sliding_window_offset_h.push_back(last_block.sliding_window_offset);
-            }
-            sink_size_h.push_back(last_block.sink_length);
-            k_rope_pos_offset_h.push_back(block.start_pos);
-            if (support_layer_sliding_window_) {
-              k_rope_pos_offset_sliding_window_h.push_back(
-                  std::max(0, block.start_pos + block.seq_length - 1024));
-            }
-          }
-        }
-      }
-    }
-
-    if (!append_before_attn_) {
-      // Right now we use different kernels when depth is 1 or not 1.
-      // For the case where maximum depth is not 1, we create the auxiliary
-      // data structure with regard to the page table before appending.
-      for (int i = 0; i < cur_batch_size_; ++i) {
-        ReserveAppendLengthInSeq(sequences[i], append_lengths[i]);
-      }
+      BuildForwardPlan(sequences, seq_ids, append_lengths, opt_token_tree_parent_ptr);
     }
 
     // Map each the token position in the input batch to the position
@@ -1135,6 +1636,9 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     kv_transfer_page_to_page_recver_id_host_.clear();
     transfer_kv_ = false;
     page_to_page_transfer_kv_ = false;
+    kv_transfer_completed_sends_.clear();
+    kv_transfer_ccl_sends_.clear();
+    int64_t batch_pos_begin = 0;
     for (int i = 0; i < cur_batch_size_; ++i) {
       int64_t append_length = append_lengths[i];
       const Block& block = global_block_pool_[sequences[i]->last_block_idx];
@@ -1196,13 +1700,89 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         }
         sequences[i]->kv_transfer_metadata.local_position_map.clear();
       }
+      KVTransferMetadata& transfer = sequences[i]->kv_transfer_metadata;
+      if (sequences[i]->seq_length > transfer.start) {
+        int64_t seq_pos_begin = sequences[i]->seq_length - append_length;
+        int64_t send_begin = std::max(seq_pos_begin, transfer.start);
+        int64_t send_end =
+            transfer.start + static_cast<int64_t>(transfer.remote_position_map.size());
+        if (f_ccl_kv_transfer_send_.has_value()) {
+          // The receiver receives the KV data of a sequence as a whole for each layer.
+          TVM_FFI_ICHECK(send_begin == transfer.start && sequences[i]->seq_length >= send_end)
+              << "The KV data of sequence " << seq_ids[i]
+              << " must be sent in a single forward when transferred through the Disco CCL.";
+          int64_t receiver_id = transfer.recver_pe_offset + GetDisaggLocalRank();
+          for (const std::array<int64_t, 3>& send : kv_transfer_ccl_sends_) {
+            TVM_FFI_ICHECK_NE(send[2], receiver_id)
+                << "The KV data of multiple sequences cannot be sent to the same receiver in "
+                   "one forward through the Disco CCL.";
+          }
+          kv_transfer_ccl_sends_.push_back(
+              {batch_pos_begin + send_begin - seq_pos_begin, send_end - send_begin, receiver_id});
+        }
+        if (sequences[i]->seq_length >= send_end) {
+          // All the KV data of the sequence are sent in this forward.
+          kv_transfer_completed_sends_.emplace_back(transfer.recver_pe_offset,
+                                                    transfer.recver_signal_slot);
+          transfer = KVTransferMetadata();
+        }
+      }
+      batch_pos_begin += append_length;
+    }
+  }
+
+  ffi::Shape BeginChunkedForward(const ffi::Shape& seq_ids, const ffi::Shape& pending_lengths,
+                                 int64_t token_budget) final {
+    TVM_FFI_ICHECK_EQ(seq_ids.size(), pending_lengths.size())
+        << "The seq_ids size (" << seq_ids.size() << ") and pending_lengths size ("
+        << pending_lengths.size() << ") mismatch.";
+    TVM_FFI_ICHECK_GT(token_budget, 0) << "The token budget must be positive.";
+    int64_t remaining_budget = std::min(token_budget, prefill_chunk_size_);
+    int64_t num_scheduled_seqs = 0;
+    std::vector<int64_t> scheduled_lengths(seq_ids.size(), 0);
+    auto f_schedule = [&](int i, int64_t length) {
+      if (remaining_budget == 0 || num_scheduled_seqs == reserved_num_seqs_) {
+        return;
+      }
+      scheduled_lengths[i] = std::min(length, remaining_budget);
+      remaining_budget -= scheduled_lengths[i];
+      ++num_scheduled_seqs;
+    };
+    // - Schedule the decode sequences first to keep the inter-token latency stable.
+    for (int i = 0; i < static_cast<int>(seq_ids.size()); ++i) {
+      TVM_FFI_ICHECK_GE(pending_lengths[i], 0)
+          << "The pending length of sequence \"" << seq_ids[i] << "\" is negative.";
+      if (pending_lengths[i] == 1) {
+        f_schedule(i, 1);
+      }
     }
+    // - Split the pending prefills into chunks with the remaining budget.
+    for (int i = 0; i < static_cast<int>(seq_ids.size()); ++i) {
+      if (pending_lengths[i] > 1) {
+        f_schedule(i, pending_lengths[i]);
+      }
+    }
+    TVM_FFI_ICHECK_GT(num_scheduled_seqs, 0) << "No sequence has pending tokens to schedule.";
+
+    std::vector<int64_t> forward_seq_ids;
+    std::vector<int64_t> forward_append_lengths;
+    forward_seq_ids.reserve(num_scheduled_seqs);
+    forward_append_lengths.reserve(num_scheduled_seqs);
+    for (int i = 0; i < static_cast<int>(seq_ids.size()); ++i) {
+      if (scheduled_lengths[i] > 0) {
+        forward_seq_ids.push_back(seq_ids[i]);
+        forward_append_lengths.push_back(scheduled_lengths[i]);
+      }
+    }
+    BeginForward(ffi::Shape(forward_seq_ids), ffi::Shape(forward_append_lengths), std::nullopt);
+    return ffi::Shape(scheduled_lengths);
   }
 
   void EndForward() final {
     if (kv_transfer_stream_ != nullptr) {
       DeviceAPI::Get(device_)->SyncStreamFromTo(device_, kv_transfer_stream_, compute_stream_);
     }
+    ReportMetrics();
   }
 
   ffi::Shape DisaggPrepareRecv(int64_t seq_id, int append_length) final {
@@ -1232,15 +1812,69 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
                                         compressed_append_pos_map.back() + 1);
     // The compressed array size should be "num_segments * 2 + 1".
     TVM_FFI_ICHECK_EQ(compressed_append_pos_map.size(), compressed_append_pos_map[0] * 2 + 1);
+    // (step 3.) take a completion signal slot for the receive.
+    int32_t signal_slot = -1;
+    if (!disagg_signal_wait_values_.empty()) {
+      TVM_FFI_ICHECK(disagg_pending_recvs_.find(seq_id) == disagg_pending_recvs_.end())
+          << "The sequence \"" << seq_id << "\" already has a pending KV receive.";
+      TVM_FFI_ICHECK(!free_disagg_signal_slots_.empty())
+          << "The number of pending KV receives exceeds the reserved number of sequences.";
+      signal_slot = free_disagg_signal_slots_.back();
+      free_disagg_signal_slots_.pop_back();
+      disagg_pending_recvs_[seq_id] = {
+          signal_slot, std::vector<int32_t>(append_position_map_host_.data(),
+                                            append_position_map_host_.data() + append_length)};
+    }
+    compressed_append_pos_map.push_back(signal_slot);
     return ffi::Shape{compressed_append_pos_map};
   }
 
+  void DisaggWaitRecv(int64_t seq_id, int32_t sender_pe_offset) final {
+    auto it = disagg_pending_recvs_.find(seq_id);
+    TVM_FFI_ICHECK(it != disagg_pending_recvs_.end())
+        << "The sequence \"" << seq_id << "\" has no pending KV receive.";
+    auto [signal_slot, position_map] = std::move(it->second);
+    disagg_pending_recvs_.erase(it);
+    if (f_transfer_kv_wait_signal_.has_value()) {
+      // The sender writes the KV data to the pages directly, and signals after the last write.
+      f_transfer_kv_wait_signal_.value()(disagg_recv_signal_, signal_slot,
+                                         ++disagg_signal_wait_values_[signal_slot],
+                                         compute_stream_);
+    } else {
+      // Receive the KV data of each layer sent by the sender, and append them to the
+      // positions reserved by DisaggPrepareRecv.
+      TVM_FFI_ICHECK(f_ccl_kv_transfer_recv_.has_value());
+      int64_t length = static_cast<int64_t>(position_map.size());
+      TVM_FFI_ICHECK_LE(length, prefill_chunk_size_)
+          << "The KV data to receive exceeds the prefill chunk size.";
+      Tensor position_map_device = Tensor::Empty({length}, dtype_aux_, device_);
+      position_map_device.CopyFromBytes(position_map.data(), length * sizeof(int32_t));
+      Tensor k_data =
+          temp_attn_k_device_.CreateView({length, num_kv_heads_, qk_head_dim_}, kv_dtype_);
+      Tensor v_data =
+          temp_attn_v_device_.CreateView({length, num_kv_heads_, qk_head_dim_}, kv_dtype_);
+      int32_t sender_id = sender_pe_offset + GetDisaggLocalRank();
+      for (int64_t local_layer_id = 0; local_layer_id < num_layers_; ++local_layer_id) {
+        // The staging buffers may be still in use by the compute stream.
+        DeviceAPI::Get(device_)->SyncStreamFromTo(device_, compute_stream_, kv_transfer_stream_);
+        f_ccl_kv_transfer_recv_.value()(k_data, v_data, sender_id, kv_transfer_stream_);
+        DeviceAPI::Get(device_)->SyncStreamFromTo(device_, kv_transfer_stream_, compute_stream_);
+        f_transpose_append_mha_.value()(pages_[local_layer_id], k_data, v_data,
+                                        position_map_device);
+      }
+    }
+    free_disagg_signal_slots_.push_back(signal_slot);
+  }
+
   void DisaggMarkSend(int64_t seq_id, int64_t begin,
                       const ffi::Shape& compressed_remote_position_map, int32_t recver_pe_offset) {
-    TVM_FFI_ICHECK(f_transfer_kv_.has_value());
+    TVM_FFI_ICHECK(f_transfer_kv_.has_value() || f_ccl_kv_transfer_send_.has_value())
+        << "KV transfer is not enabled in the KV cache.";
     auto it = seq_map_.find(seq_id);
     TVM_FFI_ICHECK(it != seq_map_.end())
         << "The sequence \"" << seq_id << "\" cannot be found in KV cache.";
+    TVM_FFI_ICHECK(!it->second.is_swapped_out)
+        << "The sequence \"" << seq_id << "\" is swapped out to host memory and cannot be sent.";
     Sequence* sequence = &it->second;
     sequence->kv_transfer_metadata.start = begin;
     int nsegments = compressed_remote_position_map[0];
@@ -1253,11 +1887,19 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       }
     }
     sequence->kv_transfer_metadata.recver_pe_offset = recver_pe_offset;
+    // The trailing signal slot of the receive, which is absent if the recver has no signal.
+    sequence->kv_transfer_metadata.recver_signal_slot =
+        static_cast<int>(compressed_remote_position_map.size()) > 2 * nsegments + 1
+            ? compressed_remote_position_map[2 * nsegments + 1]
+            : -1;
 
     sequence->kv_transfer_metadata.local_position_map.clear();
     if (begin >= sequence->seq_length) {
       return;
     }
+    TVM_FFI_ICHECK(!f_ccl_kv_transfer_send_.has_value())
+        << "Sending the existing KV data of a sequence is not supported when the KV data is "
+           "transferred through the Disco CCL.";
     // Need to send existing KV.
     TVM_FFI_ICHECK_GT(static_cast<int>(sequence->kv_transfer_metadata.remote_position_map.size()),
                       sequence->seq_length - begin)
@@ -1294,9 +1936,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     int64_t local_layer_id = layer_id - layer_id_begin_offset_;
     TVM_FFI_ICHECK_GE(local_layer_id, 0);
     TVM_FFI_ICHECK_LT(local_layer_id, num_layers_);
-    Tensor pages = pages_[local_layer_id];
-    TVM_FFI_ICHECK(qkv_data.DataType() == pages.DataType());
-    TVM_FFI_ICHECK(o_data.DataType() == pages.DataType());
+    TVM_FFI_ICHECK(qkv_data.DataType() == DataType(kv_dtype_));
+    TVM_FFI_ICHECK(o_data.DataType() == DataType(kv_dtype_));
     TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMHA ||
                    attn_kinds_[layer_id] == AttnKind::kMHASliding);
 
@@ -1356,8 +1997,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     // Part 3. Append k/v data to kv-cache if flag "append_before_attn" is set.
     TVM_FFI_ICHECK(f_transpose_append_mha_.has_value());
     if (append_before_attn_) {
-      f_transpose_append_mha_.value()(pages_[local_layer_id], k_data, v_data,
-                                      append_position_map_view_);
+      TransposeAppendMHA(local_layer_id, k_data, v_data);
     }
     // Part 4: KV transfer
     if (page_to_page_transfer_kv_) {
@@ -1376,16 +2016,37 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       // get the view of remote pages, and then take the specific remote layer.
       // The KV transfer stream nees to wait for the compute stream.
       DeviceAPI::Get(device_)->SyncStreamFromTo(device_, compute_stream_, kv_transfer_stream_);
-      f_transfer_kv_.value()(pages_[local_layer_id], k_data, v_data,
-                             kv_transfer_remote_position_map_view_, kv_transfer_recver_id_view_,
-                             kv_transfer_stream_);
+      if (f_transfer_kv_.has_value()) {
+        f_transfer_kv_.value()(pages_[local_layer_id], k_data, v_data,
+                               kv_transfer_remote_position_map_view_, kv_transfer_recver_id_view_,
+                               kv_transfer_stream_);
+      } else {
+        int64_t token_bytes =
+            num_kv_heads_ * qk_head_dim_ * ((k_data.DataType().bits() + 7) / 8);
+        for (const std::array<int64_t, 3>& send : kv_transfer_ccl_sends_) {
+          f_ccl_kv_transfer_send_.value()(
+              k_data.CreateView({send[1], num_kv_heads_, qk_head_dim_}, k_data->dtype,
+                                send[0] * token_bytes),
+              v_data.CreateView({send[1], num_kv_heads_, qk_head_dim_}, v_data->dtype,
+                                send[0] * token_bytes),
+              send[2], kv_transfer_stream_);
+        }
+      }
+      if (local_layer_id == num_layers_ - 1 && f_transfer_kv_signal_.has_value()) {
+        // Signal the recvers whose KV data are all sent after the last layer.
+        for (const auto& [recver_pe_offset, signal_slot] : kv_transfer_completed_sends_) {
+          if (signal_slot != -1) {
+            f_transfer_kv_signal_.value()(disagg_recv_signal_, signal_slot, recver_pe_offset,
+                                          kv_transfer_stream_);
+          }
+        }
+      }
     }
     // Part 5: perform attention
     AttentionInternal(layer_id, q_data, k_data, v_data, o_data_view, sm_scale);
     // Part 6. Append k/v data to kv-cache if flag "append_before_attn" is not set.
     if (!append_before_attn_) {
-      f_transpose_append_mha_.value()(pages_[local_layer_id], k_data, v_data,
-                                      append_position_map_view_);
+      TransposeAppendMHA(local_layer_id, k_data, v_data);
     }
   }
 
@@ -1395,11 +2056,10 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     int64_t local_layer_id = layer_id - layer_id_begin_offset_;
     TVM_FFI_ICHECK_GE(local_layer_id, 0);
     TVM_FFI_ICHECK_LT(local_layer_id, num_layers_);
-    Tensor pages = pages_[local_layer_id];
-    TVM_FFI_ICHECK(q_data.DataType() == pages.DataType());
-    TVM_FFI_ICHECK(k_data.DataType() == pages.DataType());
-    TVM_FFI_ICHECK(v_data.DataType() == pages.DataType());
-    TVM_FFI_ICHECK(o_data.DataType() == pages.DataType());
+    TVM_FFI_ICHECK(q_data.DataType() == DataType(kv_dtype_));
+    TVM_FFI_ICHECK(k_data.DataType() == DataType(kv_dtype_));
+    TVM_FFI_ICHECK(v_data.DataType() == DataType(kv_dtype_));
+    TVM_FFI_ICHECK(o_data.DataType() == DataType(kv_dtype_));
     AttnKind attn_kind = attn_kinds_[layer_id];
 
     // q_data: (num_total_length, num_qo_heads, qk_head_dim)
@@ -1432,15 +2092,70 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     }
   }
 
+  void RingSelfAttention(int64_t layer_id, Tensor q_data, Tensor k_data, Tensor v_data,
+                         Tensor o_data, Tensor lse_data, double sm_scale) final {
+    // The causal attention within the shard of this worker.
+    SelfAttention(layer_id, q_data, k_data, v_data, o_data, lse_data, sm_scale);
+    DiscoWorker* worker = ThreadLocalDiscoWorker::Get()->worker;
+    int group_size = worker != nullptr ? worker->num_workers / worker->num_groups : 1;
+    if (group_size == 1) {
+      return;
+    }
+    TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMHA)
+        << "Ring attention only supports the MHA layers.";
+    TVM_FFI_ICHECK(is_chain_on_depths_[0]) << "Ring attention does not support tree attention.";
+    // The shards of the other workers are at positions unknown here.
+    TVM_FFI_ICHECK(rope_mode_ != RoPEMode::kInline)
+        << "Ring attention requires RoPE to be applied before the attention.";
+    if (!f_ring_exchange_.has_value()) {
+      f_ring_exchange_ = ffi::Function::GetGlobal("runtime.disco.ring_exchange");
+      TVM_FFI_ICHECK(f_ring_exchange_.has_value())
+          << "Ring attention requires the collective communication library of Disco.";
+    }
+    if (!ring_attn_k_device_[0].defined()) {
+      for (int i = 0; i < 2; ++i) {
+        ring_attn_k_device_[i] = Tensor::Empty({prefill_chunk_size_, num_kv_heads_, qk_head_dim_},
+                                               kv_dtype_, device_);
+        ring_attn_v_device_[i] = Tensor::Empty({prefill_chunk_size_, num_kv_heads_, v_head_dim_},
+                                               kv_dtype_, device_);
+      }
+    }
+    int64_t total_seq_length = k_data->shape[0];
+    TVM_FFI_ICHECK_LE(total_seq_length, prefill_chunk_size_);
+    int rank = worker->worker_id % group_size;
+    Tensor send_k = k_data;
+    Tensor send_v = v_data;
+    // At step s, this worker receives the shard of worker (rank - s), which precedes its own
+    // shard when s <= rank. The later shards are relayed but masked out by causality.
+    for (int s = 1; s < group_size; ++s) {
+      Tensor recv_k = ring_attn_k_device_[s % 2].CreateView(
+          {total_seq_length, num_kv_heads_, qk_head_dim_}, kv_dtype_);
+      Tensor recv_v = ring_attn_v_device_[s % 2].CreateView(
+          {total_seq_length, num_kv_heads_, v_head_dim_}, kv_dtype_);
+      f_ring_exchange_.value()(send_k, /*in_group=*/true, recv_k);
+      f_ring_exchange_.value()(send_v, /*in_group=*/true, recv_v);
+      if (s <= rank) {
+        f_attention_prefill_ragged_->MHA(
+            q_data, recv_k, recv_v, cur_append_length_indptr_view_,
+            cur_append_length_indptr_view_, q_rope_position_map_view_,
+            k_ragged_rope_pos_offset_view_, /*causal=*/false, rope_mode_, rotary_scale_,
+            rotary_theta_, sm_scale, temp_attn_output_view_, temp_attn_lse_view_,
+            compute_stream_);
+        f_merge_inplace_[0](o_data, lse_data, temp_attn_output_view_, temp_attn_lse_view_);
+      }
+      send_k = recv_k;
+      send_v = recv_v;
+    }
+  }
+
   void CrossAttention(int64_t layer_id, Tensor q_data, Tensor o_data, Tensor lse_data,
                       double sm_scale) final {
     // Shape and dtype check.
     int64_t local_layer_id = layer_id - layer_id_begin_offset_;
     TVM_FFI_ICHECK_GE(local_layer_id, 0);
     TVM_FFI_ICHECK_LT(local_layer_id, num_layers_);
-    Tensor pages = pages_[local_layer_id];
-    TVM_FFI_ICHECK(q_data.DataType() == pages.DataType());
-    TVM_FFI_ICHECK(o_data.DataType() == pages.DataType());
+    TVM_FFI_ICHECK(q_data.DataType() == DataType(kv_dtype_));
+    TVM_FFI_ICHECK(o_data.DataType() == DataType(kv_dtype_));
     AttnKind attn_kind = attn_kinds_[layer_id];
 
     // q_data: (num_total_length, num_qo_heads, qk_head_dim)
@@ -1525,7 +2240,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       TVM_FFI_ICHECK(it != seq_map_.end())
           << "The sequence \"" << seq_ids[i] << "\" cannot be found in KV cache.";
       sequences.push_back(&it->second);
-      is_chain = it->second.is_chain;
+      // The KV data needs compaction as long as one of the trees is not a chain.
+      is_chain = is_chain && it->second.is_chain;
       TVM_FFI_ICHECK(leaf_indices[i] == -1 || !it->second.accepted_indices_committed)
           << "The accepted nodes of sequence " << seq_ids[i] << " are already committed.";
       TVM_FFI_ICHECK_GE(leaf_indices[i], -1)
@@ -1585,144 +2301,513 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         commit_copy_length_indptr_host_.push_back(commit_copy_length_indptr_host_.back() +
                                                   path_on_tree.size());
       }
-
-      // Compact the KV data for each sequence by copying KV data.
-      CompactKVCopy();
+
+      // Compact the KV data for each sequence by copying KV data.
+      CompactKVCopy();
+    }
+
+    // - Update the KV cache page data structure.
+    //   Note: Function "PopN" only changes the page table structure and does not
+    //         change the KV cache data. Therefore, we can directly use it, since
+    //         we have already launched all copies.
+    for (int i = 0; i < num_seq_to_commit; ++i) {
+      int64_t length_to_pop =
+          cur_append_lengths_[i] -
+          (leaf_indices[i] != -1 ? (sequences[i]->token_tree_node_depths[leaf_indices[i]] + 1) : 0);
+      PopN(cur_seq_ids_[i], length_to_pop);
+      // Reset the sequence states.
+      sequences[i]->accepted_indices_committed = true;
+      sequences[i]->token_tree_parent_ptr.clear();
+      sequences[i]->token_tree_node_depths.clear();
+    }
+  }
+
+  Tensor GetQueryPositions() final {
+    // Sync the copy stream and the compute stream.
+    ComputeStreamWaitForCopyStream();
+    // The auxiliary data structure on device must have been synchronized.
+    TVM_FFI_ICHECK(!dirty_aux_data_device_);
+    return q_rope_position_map_view_;
+  };
+
+  void DebugGetKV(int64_t seq_id, int64_t start_pos, int64_t end_pos, Tensor k_data,
+                  Tensor v_data) final {
+    TVM_FFI_ICHECK(f_debug_get_kv_.has_value())
+        << "PageAttentionKVCache requires the `f_debug_get_kv` to be explicitly passed in when "
+           "initialization. Please construct the KV cache with `f_debug_get_kv`.";
+
+    const Sequence& seq = seq_map_.at(seq_id);
+    TVM_FFI_ICHECK(!seq.is_swapped_out) << "DebugGetKV does not accept swapped-out sequences";
+    TVM_FFI_ICHECK_GE(start_pos, 0)
+        << "DebugGetKV does not accept negative start_pos " << start_pos;
+    TVM_FFI_ICHECK_LE(end_pos, seq.seq_length) << "DebugGetKV does not accept out-of-range end_pos";
+    TVM_FFI_ICHECK_LT(start_pos, end_pos) << "DebugGetKV does not accept \"start_pos >= end_pos\"";
+
+    // k/v_data: (num_layers, seq_length, num_kv_heads, qk_head_dim)
+    static constexpr const char* error_msg =
+        "DebugGetKV expects the k_data in layout (num_layers, seq_length, num_kv_heads, "
+        "qk_head_dim).";
+    std::vector<Tensor*> vec_kv_data = {&k_data, &v_data};
+    for (const Tensor* data_ptr : vec_kv_data) {
+      TVM_FFI_ICHECK_EQ((*data_ptr)->ndim, 4) << error_msg;
+      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[0], num_layers_)
+          << error_msg << " The number of layers mismatches.";
+      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[1], end_pos - start_pos)
+          << error_msg << " The sequence length mismatches.";
+      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[2], num_kv_heads_)
+          << error_msg << " The number of heads mismatches.";
+      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[3], qk_head_dim_)
+          << error_msg << " The number of head features mismatches.";
+    }
+
+    std::vector<int32_t> trace = seq.GetBlockTrace(global_block_pool_);
+    std::vector<int32_t> append_position_map;
+    append_position_map.reserve(seq.seq_length);
+    for (int32_t block_id : trace) {
+      const Block& block = global_block_pool_[block_id];
+      for (int i = 0; i < block.seq_length; ++i) {
+        int32_t offset =
+            i < block.sink_length ? i : i - block.sink_length + block.sliding_window_offset;
+        int page_id = block.page_ids[offset / page_size_];
+        int page_offset = offset % page_size_;
+        append_position_map.push_back(page_id * page_size_ + page_offset);
+      }
+    }
+    Tensor position_map_device = Tensor::Empty({end_pos - start_pos}, dtype_aux_, device_);
+    position_map_device.CopyFromBytes(
+        append_position_map.data() + start_pos,
+        (end_pos - start_pos) * ((dtype_aux_.bits * dtype_aux_.lanes + 7) / 8));
+    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
+      TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMHA)
+          << "Only MHA is supported for DebugGetKV";
+      if (page_scales_.empty()) {
+        f_debug_get_kv_.value()(pages_[layer_id], position_map_device, k_data, v_data, layer_id);
+      } else {
+        f_debug_get_kv_.value()(pages_[layer_id], page_scales_[layer_id], position_map_device,
+                                k_data, v_data, layer_id);
+      }
+    }
+  }
+
+  void DebugGetKVMLA(int64_t seq_id, int64_t start_pos, int64_t end_pos, Tensor kv_data) final {
+    TVM_FFI_ICHECK(f_debug_get_kv_.has_value())
+        << "PageAttentionKVCache requires the `f_debug_get_kv` to be explicitly passed in when "
+           "initialization. Please construct the KV cache with `f_debug_get_kv`.";
+
+    const Sequence& seq = seq_map_.at(seq_id);
+    TVM_FFI_ICHECK(!seq.is_swapped_out) << "DebugGetKV does not accept swapped-out sequences";
+    TVM_FFI_ICHECK_GE(start_pos, 0)
+        << "DebugGetKV does not accept negative start_pos " << start_pos;
+    TVM_FFI_ICHECK_LE(end_pos, seq.seq_length) << "DebugGetKV does not accept out-of-range end_pos";
+    TVM_FFI_ICHECK_LT(start_pos, end_pos) << "DebugGetKV does not accept \"start_pos >= end_pos\"";
+
+    // kv_data: (num_layers, seq_length, qk_head_dim)
+    static constexpr const char* error_msg =
+        "DebugGetKV expects the kv_data in layout (num_layers, seq_length, qk_head_dim).";
+    TVM_FFI_ICHECK_EQ(kv_data->ndim, 3) << error_msg;
+    TVM_FFI_ICHECK_EQ(kv_data->shape[0], num_layers_)
+        << error_msg << " The number of layers mismatches.";
+    TVM_FFI_ICHECK_EQ(kv_data->shape[1], end_pos - start_pos)
+        << error_msg << " The sequence length mismatches.";
+    TVM_FFI_ICHECK_EQ(kv_data->shape[2], qk_head_dim_)
+        << error_msg << " The number of head features mismatches.";
+
+    std::vector<int32_t> trace = seq.GetBlockTrace(global_block_pool_);
+    std::vector<int32_t> append_position_map;
+    append_position_map.reserve(seq.seq_length);
+    for (int32_t block_id : trace) {
+      const Block& block = global_block_pool_[block_id];
+      for (int i = 0; i < block.seq_length; ++i) {
+        int32_t offset =
+            i < block.sink_length ? i : i - block.sink_length + block.sliding_window_offset;
+        int page_id = block.page_ids[offset / page_size_];
+        int page_offset = offset % page_size_;
+        append_position_map.push_back(page_id * page_size_ + page_offset);
+      }
+    }
+    Tensor position_map_device = Tensor::Empty({end_pos - start_pos}, dtype_aux_, device_);
+    position_map_device.CopyFromBytes(
+        append_position_map.data() + start_pos,
+        (end_pos - start_pos) * ((dtype_aux_.bits * dtype_aux_.lanes + 7) / 8));
+    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
+      TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMLA)
+          << "Only MHA is supported for DebugGetKVMLA";
+      f_debug_get_kv_.value()(pages_[layer_id], position_map_device, kv_data, layer_id);
+    }
+  }
+
+  void DebugSetKV(int64_t seq_id, int64_t start_pos, Tensor k_data, Tensor v_data) final {
+    TVM_FFI_ICHECK(false) << "DebugSetKV for PageAttentionKVCache not implemented yet.";
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.vm.PagedAttentionKVCache", PagedAttentionKVCacheObj,
+                                    AttentionKVCacheObj);
+
+ private:
+  /*!
+   * \brief Build the page tables, the indptr arrays and the per-depth length information of the
+   * forward from scratch. The plan is marked reusable when it is a plain decode step, which
+   * lets the next decode step of the same batch patch it with PatchDecodePlan.
+   */
+  void BuildForwardPlan(const std::vector<Sequence*>& sequences, const ffi::Shape& seq_ids,
+                        const ffi::Shape& append_lengths,
+                        const ffi::Optional<ffi::Shape>& opt_token_tree_parent_ptr) {
+    auto [block_ids_on_depths, trailing_blocks] =
+        GetBlockIdsOnDepth(sequences, global_block_pool_, cur_batch_size_);
+    num_depths_ =
+        std::min(static_cast<int>(block_ids_on_depths.size()), kPagedKVCacheMaxBlockDepth);
+    TVM_FFI_ICHECK_LE(num_depths_, kPagedKVCacheMaxBlockDepth);
+
+    std::vector<std::vector<std::pair<int32_t, int32_t>>> chunked_block_ids_arr;
+    chunked_block_ids_arr.reserve(num_depths_);
+    use_decode_kernel_.clear();
+    for (int d = 0; d < num_depths_; ++d) {
+      // We force the blocks at maximum depth not to coalesce, so that it can be concatenated with
+      // trailing exceeding blocks.
+      auto [chunked_block_ids, use_decode_kernel] = GetChunkedBlockIds(
+          block_ids_on_depths[d], /*enable_coalesce=*/d != kPagedKVCacheMaxBlockDepth - 1,
+          cur_append_lengths_, global_block_pool_, is_decode_request_);
+      chunked_block_ids_arr.push_back(chunked_block_ids);
+      use_decode_kernel_.push_back(use_decode_kernel);
+    }
+
+    if (num_depths_ == kPagedKVCacheMaxBlockDepth) {
+      // Since we force the blocks at maximum depth not to coalesce, the output blocks at maximum
+      // depth must have the same size as current batch.
+      TVM_FFI_ICHECK_EQ(chunked_block_ids_arr[num_depths_ - 1].size(), cur_batch_size_);
+    }
+
+    // MLA keeps appending before the decode attention under sliding window, as its cached
+    // latents carry the RoPE of their original positions and need no inline RoPE.
+    append_before_attn_ = (!support_sliding_window_ || attn_kinds_[0] == AttnKind::kMLA) &&
+                          use_decode_kernel_.back();
+    if (NeedKernelBeginForward() && num_qo_heads_ / num_kv_heads_ >= 4) {
+      // When GQA group size is at least 4 and FlashInfer is enabled,
+      // we always use prefill kernel for better performance.
+      // Note: For MLA, we always use prefill kernel, so values in `use_decode_kernel` will
+      // be ignored for MLA.
+      std::fill(use_decode_kernel_.begin(), use_decode_kernel_.end(), /*value=*/false);
+    }
+
+    bool has_previous_tree =
+        std::any_of(sequences.begin(), sequences.end(),
+                    [](const Sequence* sequence) { return !sequence->accepted_indices_committed; });
+    if (has_previous_tree) {
+      append_before_attn_ = true;
+    }
+
+    // - Check token tree validity and process the token tree.
+    if (opt_token_tree_parent_ptr.has_value()) {
+      TVM_FFI_ICHECK(!support_sliding_window_) << "Tree attention does not support sliding window.";
+      TVM_FFI_ICHECK(rope_mode_ != RoPEMode::kInline)
+          << "Tree attention does not support inline RoPE mode.";
+      ConstructTokenTreeMask(sequences, opt_token_tree_parent_ptr.value(), block_ids_on_depths,
+                             trailing_blocks);
+    } else {
+      // The input batch does not form trees. So each sequence in the batch
+      // is required to have all past accepted tokens committed.
+      for (int i = 0; i < cur_batch_size_; ++i) {
+        Sequence* sequence = sequences[i];
+        TVM_FFI_ICHECK(sequence->accepted_indices_committed)
+            << "The input batch does not form a tree, in which case the sequences in the input "
+               "batch are expected to have their accepted tokens token tree nodes committed. "
+               "Please invoke CommitAcceptedTokenTreeNodes for sequence "
+            << seq_ids[i];
+        sequence->is_chain = true;
+        sequence->token_tree_parent_ptr.clear();
+        sequence->token_tree_node_depths.clear();
+      }
+      std::fill(is_chain_on_depths_.begin(), is_chain_on_depths_.end(), true);
+    }
+
+    if (append_before_attn_) {
+      // Right now we use different kernels when depth is 1 or not 1.
+      // For the case where maximum depth is 1, we create the auxiliary
+      // data structure with regard to the page table after appending.
+      for (int i = 0; i < cur_batch_size_; ++i) {
+        ReserveAppendLengthInSeq(sequences[i], append_lengths[i]);
+      }
+    }
+
+    for (int d = 0; d < num_depths_; ++d) {
+      HostMemoryVector& qo_indptr_h = qo_indptr_on_depths_host_[d];
+      HostMemoryVector& page_indptr_h = page_indptr_on_depths_host_[d];
+      HostMemoryVector& page_indices_h = page_indices_on_depths_host_[d];
+      HostMemoryVector& page_indptr_sliding_window_h =
+          page_indptr_sliding_window_on_depths_host_[d];
+      HostMemoryVector& page_indices_sliding_window_h =
+          page_indices_sliding_window_on_depths_host_[d];
+      HostMemoryVector& last_page_len_h = last_page_len_on_depths_host_[d];
+      HostMemoryVector& sliding_window_offset_h = sliding_window_offset_on_depths_host_[d];
+      HostMemoryVector& sink_size_h = sink_size_on_depths_host_[d];
+      HostMemoryVector& k_rope_pos_offset_h = k_rope_pos_offset_on_depths_host_[d];
+      HostMemoryVector& k_rope_pos_offset_sliding_window_h =
+          k_rope_pos_offset_sliding_window_on_depths_host_[d];
+      qo_indptr_h.clear();
+      page_indptr_h.clear();
+      page_indices_h.clear();
+      page_indptr_sliding_window_h.clear();
+      page_indices_sliding_window_h.clear();
+      last_page_len_h.clear();
+      sliding_window_offset_h.clear();
+      sink_size_h.clear();
+      k_rope_pos_offset_h.clear();
+      k_rope_pos_offset_sliding_window_h.clear();
+      qo_indptr_h.push_back(0);
+      page_indptr_h.push_back(0);
+      page_indptr_sliding_window_h.push_back(0);
+      for (int i = 0; i < static_cast<int>(chunked_block_ids_arr[d].size()); ++i) {
+        const auto& [block_id, chunk_append_length] = chunked_block_ids_arr[d][i];
+        qo_indptr_h.push_back(qo_indptr_h.back() + chunk_append_length);
+        if (block_id == -1) {
+          page_indptr_h.push_back(page_indptr_h.back());
+          page_indptr_sliding_window_h.push_back(page_indptr_sliding_window_h.back());
+          last_page_len_h.push_back(0);
+          sliding_window_offset_h.push_back(0);
+          sink_size_h.push_back(0);
+          k_rope_pos_offset_h.push_back(0);
+          k_rope_pos_offset_sliding_window_h.push_back(0);
+        } else {
+          if (d < kPagedKVCacheMaxBlockDepth - 1) {
+            // Blocks not at maximum depth
+            const Block& block = global_block_pool_[block_id];
+            page_indptr_h.push_back(page_indptr_h.back() + block.page_ids.size());
+            for (int32_t page_id : block.page_ids) {
+              page_indices_h.push_back(page_id);
+              // Do the same for page_indices_sliding_window
+            }
+
+            // For sliding window, the first page and last page will both be partially used
+            page_indptr_sliding_window_h.push_back(
+                page_indptr_sliding_window_h.back() +
+                std::min(static_cast<int32_t>(block.page_ids.size()),
+                         static_cast<int32_t>(1024 / page_size_ +
+                                              (block.seq_length % page_size_ ? 1 : 0))));
+            for (int i = page_indices_h.size() - page_indptr_sliding_window_h.back();
+                 i < static_cast<int32_t>(page_indices_h.size()); i++) {
+              page_indices_sliding_window_h.push_back(page_indices_h[i]);
+            }
+            // set up the page indices properly by choosing the last (sliding_window_size /
+            // page_size_) pages (at most)
+            last_page_len_h.push_back(
+                block.seq_length == 0
+                    ? 0
+                    : (block.seq_length - block.sink_length + block.sliding_window_offset - 1) %
+                              page_size_ +
+                          1);
+            if (support_layer_sliding_window_) {
+              if (block.seq_length < 1024) {
+                sliding_window_offset_h.push_back(0);
+              } else {
+                sliding_window_offset_h.push_back(block.seq_length % page_size_);
+              }
+            } else {
+              sliding_window_offset_h.push_back(block.sliding_window_offset);
+            }
+            sink_size_h.push_back(block.sink_length);
+            k_rope_pos_offset_h.push_back(block.start_pos);
+
+            // If sliding window, we need to calculate the positional offset
+            if (support_layer_sliding_window_) {
+              k_rope_pos_offset_sliding_window_h.push_back(
+                  std::max(0, block.start_pos + block.seq_length - 1024));
+            }
+          } else {
+            // Blocks at maximum depth
+            const Block& block = global_block_pool_[block_id];
+            int32_t num_pages = static_cast<int32_t>(block.page_ids.size());
+            int32_t total_seq_length = static_cast<int32_t>(block.seq_length);
+            int32_t last_block_id = block_id;
+            for (int32_t page_id : block.page_ids) {
+              page_indices_h.push_back(page_id);
+            }
+            for (int32_t id : trailing_blocks[i]) {
+              // Collect trailing blocks if available
+              const Block& block = global_block_pool_[id];
+              for (int32_t page_id : block.page_ids) {
+                page_indices_h.push_back(page_id);
+              }
+              num_pages += block.page_ids.size();
+              total_seq_length += block.seq_length;
+              last_block_id = id;
+            }
+            page_indptr_h.push_back(page_indptr_h.back() + num_pages);
+            page_indptr_sliding_window_h.push_back(
+                page_indptr_sliding_window_h.back() +
+                std::min(static_cast<int32_t>(block.page_ids.size()),
+                         static_cast<int32_t>(1024 / page_size_ +
+                                              (block.seq_length % page_size_ ? 1 : 0))));
+            for (int i = page_indices_h.size() - page_indptr_sliding_window_h.back();
+                 i < static_cast<int32_t>(page_indices_h.size()); i++) {
+              page_indices_sliding_window_h.push_back(page_indices_h[i]);
+            }
+            const Block& last_block = global_block_pool_[last_block_id];
+            last_page_len_h.push_back(total_seq_length == 0
+                                          ? 0
+                                          : (total_seq_length - last_block.sink_length +
+                                             last_block.sliding_window_offset - 1) %
+                                                    page_size_ +
+                                                1);
+            if (support_layer_sliding_window_) {
+              if (last_block.seq_length < 1024) {
+                sliding_window_offset_h.push_back(0);
+              } else {
+                sliding_window_offset_h.push_back(last_block.seq_length % page_size_);
+              }
+            } else {
+              sliding_window_offset_h.push_back(last_block.sliding_window_offset);
+            }
+            sink_size_h.push_back(last_block.sink_length);
+            k_rope_pos_offset_h.push_back(block.start_pos);
+            if (support_layer_sliding_window_) {
+              k_rope_pos_offset_sliding_window_h.push_back(
+                  std::max(0, block.start_pos + block.seq_length - 1024));
+            }
+          }
+        }
+      }
     }
 
-    // - Update the KV cache page data structure.
-    //   Note: Function "PopN" only changes the page table structure and does not
-    //         change the KV cache data. Therefore, we can directly use it, since
-    //         we have already launched all copies.
-    for (int i = 0; i < num_seq_to_commit; ++i) {
-      int64_t length_to_pop =
-          cur_append_lengths_[i] -
-          (leaf_indices[i] != -1 ? (sequences[i]->token_tree_node_depths[leaf_indices[i]] + 1) : 0);
-      PopN(cur_seq_ids_[i], length_to_pop);
-      // Reset the sequence states.
-      sequences[i]->accepted_indices_committed = true;
-      sequences[i]->token_tree_parent_ptr.clear();
-      sequences[i]->token_tree_node_depths.clear();
+    if (!append_before_attn_) {
+      // Right now we use different kernels when depth is 1 or not 1.
+      // For the case where maximum depth is not 1, we create the auxiliary
+      // data structure with regard to the page table before appending.
+      for (int i = 0; i < cur_batch_size_; ++i) {
+        ReserveAppendLengthInSeq(sequences[i], append_lengths[i]);
+      }
     }
-  }
-
-  Tensor GetQueryPositions() final {
-    // Sync the copy stream and the compute stream.
-    ComputeStreamWaitForCopyStream();
-    // The auxiliary data structure on device must have been synchronized.
-    TVM_FFI_ICHECK(!dirty_aux_data_device_);
-    return q_rope_position_map_view_;
-  };
 
-  void DebugGetKV(int64_t seq_id, int64_t start_pos, int64_t end_pos, Tensor k_data,
-                  Tensor v_data) final {
-    TVM_FFI_ICHECK(f_debug_get_kv_.has_value())
-        << "PageAttentionKVCache requires the `f_debug_get_kv` to be explicitly passed in when "
-           "initialization. Please construct the KV cache with `f_debug_get_kv`.";
+    decode_plan_reusable_ = is_decode_request_ && num_depths_ == 1 && !has_previous_tree &&
+                            !opt_token_tree_parent_ptr.has_value() &&
+                            static_cast<int64_t>(chunked_block_ids_arr[0].size()) ==
+                                cur_batch_size_ &&
+                            std::all_of(sequences.begin(), sequences.end(), [this](Sequence* seq) {
+                              return IsPlainDecodeSequence(*seq);
+                            });
+  }
 
-    const Sequence& seq = seq_map_.at(seq_id);
-    TVM_FFI_ICHECK_GE(start_pos, 0)
-        << "DebugGetKV does not accept negative start_pos " << start_pos;
-    TVM_FFI_ICHECK_LE(end_pos, seq.seq_length) << "DebugGetKV does not accept out-of-range end_pos";
-    TVM_FFI_ICHECK_LT(start_pos, end_pos) << "DebugGetKV does not accept \"start_pos >= end_pos\"";
+  /*!
+   * \brief Whether a sequence takes part in a decode step without features that change the
+   * plan beyond its own page table: common prefixes, token trees, swaps and KV transfer.
+   */
+  bool IsPlainDecodeSequence(const Sequence& seq) const {
+    return !seq.is_swapped_out && seq.accepted_indices_committed &&
+           global_block_pool_[seq.last_block_idx].parent_idx == -1 &&
+           seq.kv_transfer_metadata.start == std::numeric_limits<int64_t>::max() &&
+           seq.kv_transfer_metadata.local_position_map.empty();
+  }
 
-    // k/v_data: (num_layers, seq_length, num_kv_heads, qk_head_dim)
-    static constexpr const char* error_msg =
-        "DebugGetKV expects the k_data in layout (num_layers, seq_length, num_kv_heads, "
-        "qk_head_dim).";
-    std::vector<Tensor*> vec_kv_data = {&k_data, &v_data};
-    for (const Tensor* data_ptr : vec_kv_data) {
-      TVM_FFI_ICHECK_EQ((*data_ptr)->ndim, 4) << error_msg;
-      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[0], num_layers_)
-          << error_msg << " The number of layers mismatches.";
-      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[1], end_pos - start_pos)
-          << error_msg << " The sequence length mismatches.";
-      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[2], num_kv_heads_)
-          << error_msg << " The number of heads mismatches.";
-      TVM_FFI_ICHECK_EQ((*data_ptr)->shape[3], qk_head_dim_)
-          << error_msg << " The number of head features mismatches.";
+  /*!
+   * \brief Whether BeginForward can patch the plan of the previous step instead of building it.
+   * It holds for a decode step of the same batch as the previous decode step, when no sequence
+   * was added, removed, forked, popped or swapped in between.
+   */
+  bool CanPatchDecodePlan(const ffi::Shape& seq_ids, const ffi::Shape& append_lengths,
+                          const ffi::Optional<ffi::Shape>& opt_token_tree_parent_ptr) const {
+    if (!decode_plan_reusable_ || opt_token_tree_parent_ptr.has_value() ||
+        support_sliding_window_ || support_layer_sliding_window_ ||
+        seq_ids.size() != cur_seq_ids_.size()) {
+      return false;
     }
-
-    std::vector<int32_t> trace = seq.GetBlockTrace(global_block_pool_);
-    std::vector<int32_t> append_position_map;
-    append_position_map.reserve(seq.seq_length);
-    for (int32_t block_id : trace) {
-      const Block& block = global_block_pool_[block_id];
-      for (int i = 0; i < block.seq_length; ++i) {
-        int32_t offset =
-            i < block.sink_length ? i : i - block.sink_length + block.sliding_window_offset;
-        int page_id = block.page_ids[offset / page_size_];
-        int page_offset = offset % page_size_;
-        append_position_map.push_back(page_id * page_size_ + page_offset);
+    for (int i = 0; i < static_cast<int>(seq_ids.size()); ++i) {
+      if (seq_ids[i] != cur_seq_ids_[i] || append_lengths[i] != 1) {
+        return false;
+      }
+      auto it = seq_map_.find(seq_ids[i]);
+      if (it == seq_map_.end() || !IsPlainDecodeSequence(it->second)) {
+        return false;
       }
     }
-    Tensor position_map_device = Tensor::Empty({end_pos - start_pos}, dtype_aux_, device_);
-    position_map_device.CopyFromBytes(
-        append_position_map.data() + start_pos,
-        (end_pos - start_pos) * ((dtype_aux_.bits * dtype_aux_.lanes + 7) / 8));
-    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
-      TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMHA)
-          << "Only MHA is supported for DebugGetKV";
-      f_debug_get_kv_.value()(pages_[layer_id], position_map_device, k_data, v_data, layer_id);
-    }
+    return true;
   }
 
-  void DebugGetKVMLA(int64_t seq_id, int64_t start_pos, int64_t end_pos, Tensor kv_data) final {
-    TVM_FFI_ICHECK(f_debug_get_kv_.has_value())
-        << "PageAttentionKVCache requires the `f_debug_get_kv` to be explicitly passed in when "
-           "initialization. Please construct the KV cache with `f_debug_get_kv`.";
-
-    const Sequence& seq = seq_map_.at(seq_id);
-    TVM_FFI_ICHECK_GE(start_pos, 0)
-        << "DebugGetKV does not accept negative start_pos " << start_pos;
-    TVM_FFI_ICHECK_LE(end_pos, seq.seq_length) << "DebugGetKV does not accept out-of-range end_pos";
-    TVM_FFI_ICHECK_LT(start_pos, end_pos) << "DebugGetKV does not accept \"start_pos >= end_pos\"";
-
-    // kv_data: (num_layers, seq_length, qk_head_dim)
-    static constexpr const char* error_msg =
-        "DebugGetKV expects the kv_data in layout (num_layers, seq_length, qk_head_dim).";
-    TVM_FFI_ICHECK_EQ(kv_data->ndim, 3) << error_msg;
-    TVM_FFI_ICHECK_EQ(kv_data->shape[0], num_layers_)
-        << error_msg << " The number of layers mismatches.";
-    TVM_FFI_ICHECK_EQ(kv_data->shape[1], end_pos - start_pos)
-        << error_msg << " The sequence length mismatches.";
-    TVM_FFI_ICHECK_EQ(kv_data->shape[2], qk_head_dim_)
-        << error_msg << " The number of head features mismatches.";
-
-    std::vector<int32_t> trace = seq.GetBlockTrace(global_block_pool_);
-    std::vector<int32_t> append_position_map;
-    append_position_map.reserve(seq.seq_length);
-    for (int32_t block_id : trace) {
-      const Block& block = global_block_pool_[block_id];
-      for (int i = 0; i < block.seq_length; ++i) {
-        int32_t offset =
-            i < block.sink_length ? i : i - block.sink_length + block.sliding_window_offset;
-        int page_id = block.page_ids[offset / page_size_];
-        int page_offset = offset % page_size_;
-        append_position_map.push_back(page_id * page_size_ + page_offset);
+  /*!
+   * \brief Patch the plan of the previous decode step for the current decode step.
+   * Every sequence advances by one token, so only the last page lengths change, and the page
+   * tables change from the first sequence that got a new page.
+   */
+  void PatchDecodePlan(const std::vector<Sequence*>& sequences) {
+    if (append_before_attn_) {
+      for (int i = 0; i < cur_batch_size_; ++i) {
+        ReserveAppendLengthInSeq(sequences[i], 1);
       }
     }
-    Tensor position_map_device = Tensor::Empty({end_pos - start_pos}, dtype_aux_, device_);
-    position_map_device.CopyFromBytes(
-        append_position_map.data() + start_pos,
-        (end_pos - start_pos) * ((dtype_aux_.bits * dtype_aux_.lanes + 7) / 8));
-    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
-      TVM_FFI_ICHECK(attn_kinds_[layer_id] == AttnKind::kMLA)
-          << "Only MHA is supported for DebugGetKVMLA";
-      f_debug_get_kv_.value()(pages_[layer_id], position_map_device, kv_data, layer_id);
+    HostMemoryVector& page_indptr_h = page_indptr_on_depths_host_[0];
+    HostMemoryVector& page_indices_h = page_indices_on_depths_host_[0];
+    HostMemoryVector& last_page_len_h = last_page_len_on_depths_host_[0];
+    int first_changed_seq = cur_batch_size_;
+    for (int i = 0; i < cur_batch_size_; ++i) {
+      const Block& block = global_block_pool_[sequences[i]->last_block_idx];
+      int32_t num_pages = static_cast<int32_t>(block.page_ids.size());
+      if (first_changed_seq == cur_batch_size_ &&
+          page_indptr_h[i + 1] - page_indptr_h[i] != num_pages) {
+        first_changed_seq = i;
+      }
+      last_page_len_h.set(
+          i, block.seq_length == 0
+                 ? 0
+                 : (block.seq_length - block.sink_length + block.sliding_window_offset - 1) %
+                           page_size_ +
+                       1);
+    }
+    if (first_changed_seq < cur_batch_size_) {
+      page_indices_h.resize(page_indptr_h[first_changed_seq]);
+      for (int i = first_changed_seq; i < cur_batch_size_; ++i) {
+        const Block& block = global_block_pool_[sequences[i]->last_block_idx];
+        page_indices_h.push_back_vec(block.page_ids);
+        page_indptr_h.set(i + 1, page_indptr_h[i] + static_cast<int32_t>(block.page_ids.size()));
+      }
+    }
+    if (!append_before_attn_) {
+      for (int i = 0; i < cur_batch_size_; ++i) {
+        ReserveAppendLengthInSeq(sequences[i], 1);
+      }
     }
   }
 
-  void DebugSetKV(int64_t seq_id, int64_t start_pos, Tensor k_data, Tensor v_data) final {
-    TVM_FFI_ICHECK(false) << "DebugSetKV for PageAttentionKVCache not implemented yet.";
+  /*!
+   * \brief Publish the page and sequence occupancy of this cache to the runtime metrics.
+   * The gauges sum over all the caches of the process, so only the changes are added.
+   */
+  void ReportMetrics() {
+    KVCacheMetrics& metrics = KVCacheMetrics::Get();
+    int64_t free_pages = static_cast<int64_t>(free_page_ids_.size());
+    int64_t num_sequences = static_cast<int64_t>(seq_map_.size());
+    metrics.free_pages->Add(free_pages - reported_free_pages_);
+    metrics.sequences->Add(num_sequences - reported_num_sequences_);
+    reported_free_pages_ = free_pages;
+    reported_num_sequences_ = num_sequences;
   }
 
-  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.vm.PagedAttentionKVCache", PagedAttentionKVCacheObj,
-                                    AttentionKVCacheObj);
+  /*!
+   * \brief Append the k/v data of the current batch to the pages of the given layer.
+   * The k/v data is quantized to the pages when the KV data is quantized.
+   */
+  void TransposeAppendMHA(int64_t local_layer_id, Tensor k_data, Tensor v_data) {
+    if (page_scales_.empty()) {
+      f_transpose_append_mha_.value()(pages_[local_layer_id], k_data, v_data,
+                                      append_position_map_view_);
+    } else {
+      f_transpose_append_mha_.value()(pages_[local_layer_id], page_scales_[local_layer_id], k_data,
+                                      v_data, append_position_map_view_);
+    }
+  }
+
+  /*! \brief The rank of the current worker in its group, used to pair the KV transfer peers. */
+  int GetDisaggLocalRank() const {
+    DiscoWorker* worker = ThreadLocalDiscoWorker::Get()->worker;
+    if (worker == nullptr) {
+      return 0;
+    }
+    return worker->worker_id % (worker->num_workers / worker->num_groups);
+  }
 
- private:
   /*! \brief Get a new free page and return its id. */
   int32_t GetFreePage() {
+    // Reclaim the pages held by the prefix cache when there is no free page.
+    if (free_page_ids_.empty()) {
+      EvictPrefixTreeNodes(/*num_required_pages=*/1);
+    }
     // Find a page from the free page pools.
     TVM_FFI_ICHECK(!free_page_ids_.empty()) << "The KV cache is full. No page can be allocated.";
     int32_t page_id = free_page_ids_.back();
@@ -1745,6 +2830,325 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     return block_idx;
   }
 
+  /*!
+   * \brief Drop one external reference of the given block, and free
+   * the blocks (together with their pages) along the block chain that
+   * are no longer referenced.
+   */
+  void ReleaseBlockRef(int32_t block_idx) {
+    TVM_FFI_ICHECK_GE(global_block_pool_[block_idx].external_ref_cnt, 1);
+    while (block_idx != -1 && global_block_pool_[block_idx].external_ref_cnt == 1) {
+      // - Free pages in the last block.
+      for (int32_t page_id : global_block_pool_[block_idx].page_ids) {
+        free_page_ids_.push_back(page_id);
+      }
+      // - Free the host pages if the block is swapped out.
+      for (int32_t host_page_id : global_block_pool_[block_idx].host_page_ids) {
+        free_host_page_ids_.push_back(host_page_id);
+      }
+      free_block_idx_.push_back(block_idx);
+      block_idx = global_block_pool_[block_idx].parent_idx;
+    }
+    // - Decrease the external reference of the parent block.
+    if (block_idx != -1) {
+      TVM_FFI_ICHECK_GT(global_block_pool_[block_idx].external_ref_cnt, 1);
+      --global_block_pool_[block_idx].external_ref_cnt;
+    }
+  }
+
+  /*!
+   * \brief Get a block whose block chain holds exactly the first `length`
+   * positions of the block chain ending at the given block, splitting the
+   * blocks when necessary. An external reference of the returned block is
+   * added and owned by the caller.
+   * \param block_idx The last block of the source block chain.
+   * \param length The page-aligned prefix length, which should be positive.
+   * \return The index of the last block of the prefix block chain.
+   */
+  int32_t AcquireBlockChainPrefix(int32_t block_idx, int64_t length) {
+    TVM_FFI_ICHECK_GT(length, 0);
+    TVM_FFI_ICHECK_EQ(length % page_size_, 0);
+    TVM_FFI_ICHECK(seq_map_.find(kPrefixCacheTempSeqId) == seq_map_.end());
+    TVM_FFI_ICHECK(seq_map_.find(kPrefixCacheTempChildSeqId) == seq_map_.end());
+    // Forking at a page-aligned position makes the parent block of the child
+    // sequence end exactly at the fork position without any page copy.
+    seq_map_.insert({kPrefixCacheTempSeqId, Sequence(&global_block_pool_, block_idx)});
+    ForkSequence(kPrefixCacheTempSeqId, kPrefixCacheTempChildSeqId, length);
+    int32_t child_block_idx = seq_map_.at(kPrefixCacheTempChildSeqId).last_block_idx;
+    TVM_FFI_ICHECK(global_block_pool_[child_block_idx].page_ids.empty());
+    int32_t prefix_block_idx = global_block_pool_[child_block_idx].parent_idx;
+    TVM_FFI_ICHECK_NE(prefix_block_idx, -1);
+    ++global_block_pool_[prefix_block_idx].external_ref_cnt;
+    RemoveSequence(kPrefixCacheTempChildSeqId);
+    RemoveSequence(kPrefixCacheTempSeqId);
+    return prefix_block_idx;
+  }
+
+  /*! \brief Get a new free prefix tree node and return its index. */
+  int32_t GetFreePrefixTreeNode() {
+    if (!free_prefix_tree_node_idx_.empty()) {
+      int32_t node_idx = free_prefix_tree_node_idx_.back();
+      free_prefix_tree_node_idx_.pop_back();
+      prefix_tree_nodes_[node_idx].Reset();
+      return node_idx;
+    }
+    int32_t node_idx = prefix_tree_nodes_.size();
+    prefix_tree_nodes_.push_back(PrefixTreeNode());
+    return node_idx;
+  }
+
+  /*!
+   * \brief Find the child of the given prefix tree node that shares the
+   * longest common prefix with `token_ids[begin:end]`.
+   * \return The index of the child (or -1 if there is no child) and the
+   * length of the common prefix.
+   */
+  std::pair<int32_t, int64_t> MatchPrefixTreeChild(int32_t node_idx, const ffi::Shape& token_ids,
+                                                   int64_t begin, int64_t end) const {
+    int32_t best_child_idx = -1;
+    int64_t best_match_length = 0;
+    for (int32_t child_idx : prefix_tree_nodes_[node_idx].child_indices) {
+      const std::vector<int32_t>& child_tokens = prefix_tree_nodes_[child_idx].token_ids;
+      int64_t max_length = std::min(static_cast<int64_t>(child_tokens.size()), end - begin);
+      int64_t match_length = 0;
+      while (match_length < max_length &&
+             child_tokens[match_length] == token_ids[begin + match_length]) {
+        ++match_length;
+      }
+      if (match_length > best_match_length) {
+        best_child_idx = child_idx;
+        best_match_length = match_length;
+      }
+    }
+    return {best_child_idx, best_match_length};
+  }
+
+  /*!
+   * \brief Split the given prefix tree node into two nodes at the given
+   * page-aligned offset of its tokens.
+   * \return The index of the new node, which holds the leading tokens and
+   * becomes the parent of the given node.
+   */
+  int32_t SplitPrefixTreeNode(int32_t node_idx, int64_t split_offset) {
+    TVM_FFI_ICHECK_GT(split_offset, 0);
+    TVM_FFI_ICHECK_LT(split_offset,
+                      static_cast<int64_t>(prefix_tree_nodes_[node_idx].token_ids.size()));
+    TVM_FFI_ICHECK_EQ(split_offset % page_size_, 0);
+    int32_t new_node_idx = GetFreePrefixTreeNode();
+    PrefixTreeNode& node = prefix_tree_nodes_[node_idx];
+    PrefixTreeNode& new_node = prefix_tree_nodes_[new_node_idx];
+    new_node.token_ids.assign(node.token_ids.begin(), node.token_ids.begin() + split_offset);
+    new_node.end_pos = node.end_pos - static_cast<int32_t>(node.token_ids.size()) +
+                       static_cast<int32_t>(split_offset);
+    new_node.block_idx = AcquireBlockChainPrefix(node.block_idx, new_node.end_pos);
+    new_node.parent_idx = node.parent_idx;
+    new_node.child_indices = {node_idx};
+    new_node.last_access_time = node.last_access_time;
+    std::vector<int32_t>& siblings = prefix_tree_nodes_[node.parent_idx].child_indices;
+    std::replace(siblings.begin(), siblings.end(), node_idx, new_node_idx);
+    node.token_ids.erase(node.token_ids.begin(), node.token_ids.begin() + split_offset);
+    node.parent_idx = new_node_idx;
+    return new_node_idx;
+  }
+
+  /*! \brief Remove the given leaf node from the prefix tree and release its block. */
+  void RemovePrefixTreeNode(int32_t node_idx) {
+    PrefixTreeNode& node = prefix_tree_nodes_[node_idx];
+    TVM_FFI_ICHECK(node.child_indices.empty());
+    std::vector<int32_t>& siblings = prefix_tree_nodes_[node.parent_idx].child_indices;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node_idx));
+    ReleaseBlockRef(node.block_idx);
+    node.Reset();
+    free_prefix_tree_node_idx_.push_back(node_idx);
+  }
+
+  /*!
+   * \brief Evict the least recently used leaf nodes of the prefix tree,
+   * until there are enough free pages or there is no node to evict.
+   * \param num_required_pages The number of free pages required.
+   * \note Evicting a node does not free the pages still used by sequences.
+   */
+  void EvictPrefixTreeNodes(size_t num_required_pages) {
+    while (free_page_ids_.size() < num_required_pages) {
+      int32_t lru_node_idx = -1;
+      for (int32_t i = 1; i < static_cast<int32_t>(prefix_tree_nodes_.size()); ++i) {
+        const PrefixTreeNode& node = prefix_tree_nodes_[i];
+        // Skip the free nodes and the non-leaf nodes.
+        if (node.block_idx == -1 || !node.child_indices.empty()) {
+          continue;
+        }
+        if (lru_node_idx == -1 ||
+            node.last_access_time < prefix_tree_nodes_[lru_node_idx].last_access_time) {
+          lru_node_idx = i;
+        }
+      }
+      if (lru_node_idx == -1) {
+        return;
+      }
+      RemovePrefixTreeNode(lru_node_idx);
+    }
+  }
+
+  /*! \brief Return the device Tensors indexed by page id, i.e., the pages and the page scales. */
+  std::vector<Tensor> GetPagedTensors() const {
+    std::vector<Tensor> paged_tensors = pages_;
+    paged_tensors.insert(paged_tensors.end(), page_scales_.begin(), page_scales_.end());
+    return paged_tensors;
+  }
+
+  /*! \brief The number of bytes of a page in the given paged tensor. */
+  static int64_t GetPageNBytes(const Tensor& paged_tensor) {
+    int64_t page_nbytes = (paged_tensor->dtype.bits * paged_tensor->dtype.lanes + 7) / 8;
+    for (int d = 1; d < paged_tensor->ndim; ++d) {
+      page_nbytes *= paged_tensor->shape[d];
+    }
+    return page_nbytes;
+  }
+
+  /*! \brief Take the given number of free host pages, allocating host memory when needed. */
+  std::vector<int32_t> TakeFreeHostPages(int64_t num_pages) {
+    ReserveHostPages(num_pages);
+    std::vector<int32_t> host_page_ids(free_host_page_ids_.end() - num_pages,
+                                       free_host_page_ids_.end());
+    free_host_page_ids_.resize(free_host_page_ids_.size() - num_pages);
+    return host_page_ids;
+  }
+
+  /*! \brief The host memory of a host page in the host chunk of the given paged tensor. */
+  char* HostPageData(int32_t host_page_id, size_t tensor_idx, int64_t page_nbytes) {
+    int chunk_idx = std::upper_bound(host_page_chunk_begin_.begin(), host_page_chunk_begin_.end(),
+                                     host_page_id) -
+                    host_page_chunk_begin_.begin() - 1;
+    const Tensor& host_pages = host_page_chunks_[chunk_idx][tensor_idx];
+    return static_cast<char*>(host_pages->data) + host_pages->byte_offset +
+           (host_page_id - host_page_chunk_begin_[chunk_idx]) * page_nbytes;
+  }
+
+  /*! \brief Check that the KV data of every layer is in pages, which snapshots save. */
+  void CheckSnapshotSupported() const {
+    for (int layer = 0; layer < num_layers_; ++layer) {
+      TVM_FFI_ICHECK(attn_kinds_[layer_id_begin_offset_ + layer] != AttnKind::kLinearAttn)
+          << "Snapshotting sequences is not supported for linear attention.";
+    }
+  }
+
+  /*!
+   * \brief The configuration the KV data of a snapshot depends on, which must match for the
+   * snapshot to be restored: the page layout, the storage dtype and the RoPE parameters.
+   */
+  std::vector<int64_t> SnapshotLayout() const {
+    auto double_bits = [](double value) {
+      int64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    };
+    std::vector<int64_t> layout{page_size_,
+                                num_layers_,
+                                num_kv_heads_,
+                                qk_head_dim_,
+                                v_head_dim_,
+                                kv_storage_dtype_.code,
+                                kv_storage_dtype_.bits,
+                                kv_storage_dtype_.lanes,
+                                static_cast<int64_t>(rope_mode_),
+                                double_bits(rotary_scale_),
+                                double_bits(rotary_theta_)};
+    for (const Tensor& paged_tensor : GetPagedTensors()) {
+      layout.push_back(GetPageNBytes(paged_tensor));
+    }
+    return layout;
+  }
+
+  /*!
+   * \brief Make sure there are at least the given number of free host pages,
+   * allocating a new host memory chunk when needed.
+   */
+  void ReserveHostPages(int64_t num_pages) {
+    int64_t num_free_host_pages = free_host_page_ids_.size();
+    if (num_free_host_pages >= num_pages) {
+      return;
+    }
+    // Allocate at least 1/8 of the device pages at a time, to amortize the
+    // allocation of pinned host memory across swaps.
+    int64_t chunk_num_pages = std::max(num_pages - num_free_host_pages,
+                                       std::max<int64_t>(num_total_pages_ / 8, 1));
+    Device preferred_host_device = GetPreferredHostDevice(device_);
+    std::vector<Tensor> chunk;
+    for (const Tensor& paged_tensor : GetPagedTensors()) {
+      std::vector<int64_t> shape(paged_tensor->shape, paged_tensor->shape + paged_tensor->ndim);
+      shape[0] = chunk_num_pages;
+      chunk.push_back(Tensor::Empty(ffi::Shape(shape), paged_tensor->dtype, preferred_host_device));
+    }
+    host_page_chunks_.push_back(std::move(chunk));
+    host_page_chunk_begin_.push_back(num_total_host_pages_);
+    for (int64_t i = chunk_num_pages - 1; i >= 0; --i) {
+      free_host_page_ids_.push_back(num_total_host_pages_ + i);
+    }
+    num_total_host_pages_ += chunk_num_pages;
+  }
+
+  /*!
+   * \brief Copy the KV data of the given pages between device and host on the copy stream.
+   * Consecutive pages are coalesced into a single copy.
+   * \param page_ids The device page ids.
+   * \param host_page_ids The host page ids, which pair with the device page ids.
+   * \param to_host Copy from device to host if true, or from host to device otherwise.
+   */
+  void CopyPagesBetweenDeviceAndHost(const std::vector<int32_t>& page_ids,
+                                     const std::vector<int32_t>& host_page_ids, bool to_host) {
+    TVM_FFI_ICHECK_EQ(page_ids.size(), host_page_ids.size());
+    if (page_ids.empty()) {
+      return;
+    }
+    // - Order the copy after the computation issued on the pages.
+    if (copy_stream_ != compute_stream_) {
+      DeviceAPI::Get(device_)->SyncStreamFromTo(device_, compute_stream_, copy_stream_);
+    }
+    std::vector<Tensor> paged_tensors = GetPagedTensors();
+    for (size_t begin = 0; begin < page_ids.size();) {
+      int chunk_idx = std::upper_bound(host_page_chunk_begin_.begin(),
+                                       host_page_chunk_begin_.end(), host_page_ids[begin]) -
+                      host_page_chunk_begin_.begin() - 1;
+      int32_t chunk_begin = host_page_chunk_begin_[chunk_idx];
+      int32_t chunk_end = chunk_idx + 1 < static_cast<int>(host_page_chunk_begin_.size())
+                              ? host_page_chunk_begin_[chunk_idx + 1]
+                              : num_total_host_pages_;
+      size_t end = begin + 1;
+      while (end < page_ids.size() && page_ids[end] == page_ids[end - 1] + 1 &&
+             host_page_ids[end] == host_page_ids[end - 1] + 1 && host_page_ids[end] < chunk_end) {
+        ++end;
+      }
+      int64_t num_pages = end - begin;
+      for (size_t i = 0; i < paged_tensors.size(); ++i) {
+        const Tensor& device_pages = paged_tensors[i];
+        const Tensor& host_pages = host_page_chunks_[chunk_idx][i];
+        std::vector<int64_t> shape(device_pages->shape, device_pages->shape + device_pages->ndim);
+        int64_t page_nbytes = (device_pages->dtype.bits * device_pages->dtype.lanes + 7) / 8;
+        for (int d = 1; d < device_pages->ndim; ++d) {
+          page_nbytes *= shape[d];
+        }
+        shape[0] = num_pages;
+        Tensor device_view = device_pages.CreateView(ffi::Shape(shape), device_pages->dtype,
+                                                     page_ids[begin] * page_nbytes);
+        int64_t host_byte_offset = (host_page_ids[begin] - chunk_begin) * page_nbytes;
+        Tensor host_view =
+            host_pages.CreateView(ffi::Shape(shape), host_pages->dtype, host_byte_offset);
+        DLTensor device_tensor = *device_view.operator->();
+        DLTensor host_tensor = *host_view.operator->();
+        if (to_host) {
+          Tensor::CopyFromTo(&device_tensor, &host_tensor, copy_stream_);
+        } else {
+          Tensor::CopyFromTo(&host_tensor, &device_tensor, copy_stream_);
+        }
+      }
+      begin = end;
+    }
+    // - Order the later computation on the pages after the copy.
+    if (copy_stream_ != compute_stream_) {
+      DeviceAPI::Get(device_)->SyncStreamFromTo(device_, copy_stream_, compute_stream_);
+    }
+  }
+
   void ConstructTokenTreeMask(const std::vector<Sequence*>& sequences,
                               const ffi::Shape& token_tree_parent_ptr,
                               const std::vector<std::vector<int32_t>>& block_ids_on_depths,
@@ -1815,54 +3219,45 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
           continue;
         }
         int64_t tree_size = sequences[i]->token_tree_parent_ptr.size();
-        std::vector<std::vector<int32_t>> mask;
+        const std::vector<int32_t>& parent_ptr = sequences[i]->token_tree_parent_ptr;
         std::vector<int32_t> depth;
-        mask.reserve(tree_size);
         depth.reserve(tree_size);
         sequences[i]->is_chain = true;
         sequences[i]->accepted_indices_committed = false;
-        std::unordered_map<int, std::vector<int>> tree_parent_to_children;
-        std::vector<int> tree_roots;
         for (int n = 0; n < tree_size; ++n) {
-          TVM_FFI_ICHECK_LT(sequences[i]->token_tree_parent_ptr[n], n)
+          TVM_FFI_ICHECK_LT(parent_ptr[n], n)
               << "Invalid token tree. The parent of node " << n << " in tree " << i << " is "
-              << sequences[i]->token_tree_parent_ptr[n] << ", which is not smaller than " << n;
-          TVM_FFI_ICHECK_GE(sequences[i]->token_tree_parent_ptr[n], -1)
+              << parent_ptr[n] << ", which is not smaller than " << n;
+          TVM_FFI_ICHECK_GE(parent_ptr[n], -1)
               << "Invalid token tree. The parent of node " << n << " in tree " << i << " is "
-              << sequences[i]->token_tree_parent_ptr[n];
-          if (sequences[i]->token_tree_parent_ptr[n] != n - 1) {
+              << parent_ptr[n];
+          if (parent_ptr[n] != n - 1) {
             // The parent of the current node is not the last node.
             // Therefore the tree is not a chain.
             sequences[i]->is_chain = false;
             is_chain = false;
           }
-          tree_parent_to_children[sequences[i]->token_tree_parent_ptr[n]].push_back(n);
-
-          if (sequences[i]->token_tree_parent_ptr[n] != -1) {
-            depth.push_back(depth[sequences[i]->token_tree_parent_ptr[n]] + 1);
-          } else {
-            depth.push_back(0);
-            tree_roots.push_back(n);
-          }
+          depth.push_back(parent_ptr[n] != -1 ? depth[parent_ptr[n]] + 1 : 0);
         }
-        std::vector<std::pair<int, int>> tree_order(tree_size);
-        int order = 0;
-        std::function<int(int)> tree_dfs = [&order, &tree_order, &tree_parent_to_children,
-                                            &tree_dfs](int node) -> int {
-          tree_order[node].first = order++;
-          int upper_bound = tree_order[node].first + 1;
-          for (int child : tree_parent_to_children[node]) {
-            upper_bound = std::max(upper_bound, tree_dfs(child));
+        // The mask of a node is the range of the DFS order of its subtree, which visits the
+        // children in the node order. Since each parent precedes its children, the subtree
+        // sizes and the DFS orders are computed in two linear passes without a traversal.
+        std::vector<int32_t> subtree_size(tree_size, 1);
+        for (int n = tree_size - 1; n >= 0; --n) {
+          if (parent_ptr[n] != -1) {
+            subtree_size[parent_ptr[n]] += subtree_size[n];
           }
-          tree_order[node].second = upper_bound;
-          return upper_bound;
-        };
-        for (auto root : tree_roots) {
-          tree_dfs(root);
         }
+        // The DFS order of the next child of each node, and of the next root.
+        std::vector<int32_t> next_child_order(tree_size);
+        int32_t next_root_order = 0;
         for (int n = 0; n < tree_size; ++n) {
-          tree_attn_mask.push_back(tree_order[n].first);
-          tree_attn_mask.push_back(tree_order[n].second);
+          int32_t& slot = parent_ptr[n] != -1 ? next_child_order[parent_ptr[n]] : next_root_order;
+          int32_t order = slot;
+          slot += subtree_size[n];
+          next_child_order[n] = order + 1;
+          tree_attn_mask.push_back(order);
+          tree_attn_mask.push_back(order + subtree_size[n]);
         }
         sequences[i]->token_tree_node_depths = std::move(depth);
       }
@@ -2002,7 +3397,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
                                            f_attention_prefill_with_tree_mask_paged_kv_.get(),
                                            f_mla_prefill_.get()};
     for (AttnBackendFunc* func : funcs) {
-      if (func != nullptr && func->backend_kind == AttnBackendKind::kFlashInfer) {
+      if (func != nullptr && func->backend_kind != AttnBackendKind::kTIR) {
         return true;
       }
     }
@@ -2029,7 +3424,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
   void MHAKernelBeginForward() {
     if (!append_before_attn_) {
       if (is_chain_on_depths_[0] && f_attention_prefill_ragged_ != nullptr &&
-          f_attention_prefill_ragged_->backend_kind == AttnBackendKind::kFlashInfer) {
+          f_attention_prefill_ragged_->backend_kind != AttnBackendKind::kTIR) {
         f_attention_prefill_ragged_->BeginForward(
             temp_float_attn_workspace_, temp_int_attn_workspace_[0],
             temp_int_pinned_attn_workspace_[0], &cur_append_lengths_indptr_host_,
@@ -2046,7 +3441,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
           << "Kernel BeginForward doesn't support sliding window.";
       if (use_decode_kernel_[d]) {
         if (f_attention_decode_ != nullptr &&
-            f_attention_decode_->backend_kind == AttnBackendKind::kFlashInfer) {
+            f_attention_decode_->backend_kind != AttnBackendKind::kTIR) {
           f_attention_decode_->BeginForward(
               d, temp_float_attn_workspace_, temp_int_attn_workspace_[d + 1],
               temp_int_pinned_attn_workspace_[d + 1], &page_indptr_on_depths_host_[d],
@@ -2055,7 +3450,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         }
       } else {
         if (f_attention_prefill_ != nullptr &&
-            f_attention_prefill_->backend_kind == AttnBackendKind::kFlashInfer) {
+            f_attention_prefill_->backend_kind != AttnBackendKind::kTIR) {
           f_attention_prefill_->BeginForward(
               d, temp_float_attn_workspace_, temp_int_attn_workspace_[d + 1],
               temp_int_pinned_attn_workspace_[d + 1], &qo_indptr_on_depths_host_[d],
@@ -2073,7 +3468,7 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
     if (!append_before_attn_) {
       if (is_chain_on_depths_[0]) {
         if (f_attention_prefill_ragged_ != nullptr &&
-            f_attention_prefill_ragged_->backend_kind == AttnBackendKind::kFlashInfer) {
+            f_attention_prefill_ragged_->backend_kind != AttnBackendKind::kTIR) {
           f_attention_prefill_ragged_->BeginForward(
               temp_float_attn_workspace_, temp_int_attn_workspace_[0],
               temp_int_pinned_attn_workspace_[0], &cur_append_lengths_indptr_host_,
@@ -2087,10 +3482,12 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       if (page_indices_on_depths_view_[d]->shape[0] == 0) {
         continue;
       }
-      TVM_FFI_ICHECK(!support_sliding_window_)
-          << "Kernel BeginForward doesn't support sliding window.";
+      if (support_sliding_window_) {
+        // The sliding window MLA prefill function is a TIR kernel, which needs no plan.
+        continue;
+      }
       if (f_mla_prefill_ != nullptr &&
-          f_mla_prefill_->backend_kind == AttnBackendKind::kFlashInfer) {
+          f_mla_prefill_->backend_kind != AttnBackendKind::kTIR) {
         f_mla_prefill_->BeginForward(
             d, temp_float_attn_workspace_, temp_int_attn_workspace_[d + 1],
             temp_int_pinned_attn_workspace_[d + 1], &qo_indptr_on_depths_host_[d],
@@ -2173,6 +3570,10 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
             : f_attention_decode_sliding_window_;
     TVM_FFI_ICHECK_GE(num_depths_, 1)
         << "The number of effective depths must be greater or equal to 1.";
+    ffi::Optional<Tensor> page_scales = std::nullopt;
+    if (!page_scales_.empty()) {
+      page_scales = page_scales_[local_layer_id];
+    }
 
     bool cross_attn_computed = false;
     for (int d = 0; d < num_depths_; ++d) {
@@ -2222,14 +3623,15 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
       } else if (use_decode_kernel_[d]) {
         // Use decode kernel for depth d
         TVM_FFI_ICHECK_NOTNULL(f_decode);
-        f_decode->MHA(d, q_data, pages_[local_layer_id], page_indptr, page_indices, length_info,
-                      k_rope_pos, q_rope_position_map_view_, rope_mode_, rotary_scale, rotary_theta,
-                      sm_scale, attn_output, attn_lse, compute_stream_);
+        f_decode->MHA(d, q_data, pages_[local_layer_id], page_scales, page_indptr, page_indices,
+                      length_info, k_rope_pos, q_rope_position_map_view_, rope_mode_, rotary_scale,
+                      rotary_theta, sm_scale, attn_output, attn_lse, compute_stream_);
       } else {
         // Use prefill kernel for depth d
         TVM_FFI_ICHECK_NOTNULL(f_prefill);
-        f_prefill->MHA(d, q_data, qo_indptr_on_depths_view_[d], pages_[local_layer_id], page_indptr,
-                       page_indices, length_info, q_rope_position_map_view_, k_rope_pos,
+        f_prefill->MHA(d, q_data, qo_indptr_on_depths_view_[d], pages_[local_layer_id],
+                       page_scales, page_indptr, page_indices, length_info,
+                       q_rope_position_map_view_, k_rope_pos,
                        /*causal=*/false,
                        /*rotary_mode=*/rope_mode_, rotary_scale, rotary_theta, sm_scale,
                        attn_output, attn_lse, compute_stream_);
@@ -2250,6 +3652,8 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
                             double sm_scale) {
     TVM_FFI_ICHECK_GE(num_depths_, 1)
         << "The number of effective depths must be greater or equal to 1.";
+    std::unique_ptr<PagedPrefillFunc>& f_prefill =
+        support_sliding_window_ ? f_attention_prefill_sliding_window_ : f_mla_prefill_;
 
     bool is_first_kernel = true;
     for (int d = 0; d < num_depths_; ++d) {
@@ -2266,11 +3670,11 @@ class PagedAttentionKVCacheObj : public AttentionKVCacheObj {
         attn_lse = temp_attn_lse_view_;
       }
       TVM_FFI_ICHECK(is_chain_on_depths_[d]) << "Tree attn not able for MLA for now.";
-      TVM_FFI_ICHECK_NOTNULL(f_mla_prefill_);
-      f_mla_prefill_->MLA(d, q_data, qo_indptr_on_depths_view_[d], pages_[local_layer_id],
-                          page_indptr_on_depths_view_[d], page_indices_on_depths_view_[d],
-                          length_info_on_depths_view_[d], /*causal=*/false, sm_scale, attn_output,
-                          attn_lse, compute_stream_);
+      TVM_FFI_ICHECK_NOTNULL(f_prefill);
+      f_prefill->MLA(d, q_data, qo_indptr_on_depths_view_[d], pages_[local_layer_id],
+                     page_indptr_on_depths_view_[d], page_indices_on_depths_view_[d],
+                     length_info_on_depths_view_[d], /*causal=*/false, sm_scale, attn_output,
+                     attn_lse, compute_stream_);
 
       if (!is_first_kernel) {
         f_merge_inplace_[0](o_data, lse_data, temp_attn_output_view_, temp_attn_lse_view_);
@@ -2515,8 +3919,15 @@ TVM_FFI_STATIC_INIT_BLOCK() {
             ConvertPagedPrefillFunc(args[16].cast<ffi::Array<ffi::Any>>(), AttnKind::kMHA);
         std::unique_ptr<PagedDecodeFunc> f_attention_decode =
             ConvertPagedDecodeFunc(args[17].cast<ffi::Array<ffi::Any>>(), AttnKind::kMHA);
+        // For MLA, args[18] holds the sliding window MLA prefill function.
+        AttnKind sliding_window_prefill_kind =
+            std::find(attn_kinds.begin(), attn_kinds.end(),
+                      static_cast<int64_t>(AttnKind::kMLA)) != attn_kinds.end()
+                ? AttnKind::kMLA
+                : AttnKind::kMHA;
         std::unique_ptr<PagedPrefillFunc> f_attention_prefill_sliding_window =
-            ConvertPagedPrefillFunc(args[18].cast<ffi::Array<ffi::Any>>(), AttnKind::kMHA);
+            ConvertPagedPrefillFunc(args[18].cast<ffi::Array<ffi::Any>>(),
+                                    sliding_window_prefill_kind);
         std::unique_ptr<PagedDecodeFunc> f_attention_decode_sliding_window =
             ConvertPagedDecodeFunc(args[19].cast<ffi::Array<ffi::Any>>(), AttnKind::kMHA);
         std::unique_ptr<PagedPrefillTreeMaskFunc> f_attention_prefill_with_tree_mask_paged_kv =
@@ -2534,6 +3945,14 @@ TVM_FFI_STATIC_INIT_BLOCK() {
         if (auto opt_nd = args[11].as<Tensor>()) {
           rope_ext_factors = opt_nd.value();
         }
+        // The optional args[28] is a Tensor in the dtype that the KV data is stored in,
+        // which enables KV quantization when it differs from the dtype of `init`.
+        DLDataType kv_storage_dtype = init->dtype;
+        if (args.size() == 29) {
+          if (auto opt_kv_storage_init = args[28].as<Tensor>()) {
+            kv_storage_dtype = opt_kv_storage_init.value()->dtype;
+          }
+        }
         auto f_convert_optional_packed_func = [&args](int arg_idx) -> ffi::Optional<ffi::Function> {
           if (auto opt_func = args[arg_idx].as<ffi::Function>()) {
             return opt_func.value();
@@ -2568,7 +3987,7 @@ TVM_FFI_STATIC_INIT_BLOCK() {
             num_kv_heads, qk_head_dim, v_head_dim, attn_kinds_vec, reserved_num_seqs,
             num_total_pages, prefill_chunk_size, support_sliding_window, RoPEMode(rope_mode),
             rotary_scale, rotary_theta, std::move(rope_ext_factors), enable_kv_transfer,  //
-            init->dtype, init->device,                                                    //
+            init->dtype, kv_storage_dtype, init->device,                                  //
             std::move(f_transpose_append_mha), std::move(f_transpose_append_mla),
             std::move(f_compact_copy), std::move(f_attention_prefill_ragged),
             std::move(f_attention_prefill), std::move(f_attention_decode),
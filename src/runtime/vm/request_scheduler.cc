@@ -0,0 +1,529 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/vm/request_scheduler.cc
+ * \brief Runtime continuous batching scheduler of generation requests over a paged KV cache.
+ */
+
+#include <tvm/ffi/container/map.h>
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/metrics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kv_state.h"
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+//-----------------------------------------------------------------------------
+// We keep the implementation private as they may subject to future changes.
+//
+// Users can interact with it through the runtime API function calls
+//-----------------------------------------------------------------------------
+
+/*! \brief The process-wide metrics of the request schedulers. */
+struct RequestSchedulerMetrics {
+  metrics::Counter* steps;
+  metrics::Counter* prefill_tokens;
+  metrics::Counter* generated_tokens;
+  metrics::Counter* preemptions;
+  metrics::Histogram* step_seconds;
+  metrics::Histogram* time_to_first_token_seconds;
+  metrics::Histogram* time_per_output_token_seconds;
+
+  static RequestSchedulerMetrics& Get() {
+    static RequestSchedulerMetrics scheduler_metrics = [] {
+      metrics::Registry* registry = metrics::Registry::Global();
+      std::vector<double> latency_bounds = metrics::Histogram::ExponentialBounds(1e-3, 2, 16);
+      return RequestSchedulerMetrics{
+          registry->GetCounter("tvm_scheduler_steps_total", "Steps run by the schedulers."),
+          registry->GetCounter("tvm_scheduler_prefill_tokens_total",
+                               "Prompt tokens prefilled by the schedulers."),
+          registry->GetCounter("tvm_scheduler_generated_tokens_total",
+                               "Tokens generated by the schedulers."),
+          registry->GetCounter("tvm_scheduler_preemptions_total",
+                               "Requests preempted by the schedulers."),
+          registry->GetHistogram("tvm_scheduler_step_seconds", "Duration of a scheduler step."),
+          registry->GetHistogram("tvm_scheduler_time_to_first_token_seconds",
+                                 "Time from the arrival of a request to its first token.",
+                                 latency_bounds),
+          registry->GetHistogram("tvm_scheduler_time_per_output_token_seconds",
+                                 "Mean time between the tokens of a request after the first.",
+                                 latency_bounds)};
+    }();
+    return scheduler_metrics;
+  }
+};
+
+/*! \brief The way to preempt a request when the KV cache runs out of pages. */
+enum class PreemptMode : int {
+  /*! \brief Drop the KV data of the request, and prefill all its tokens again later. */
+  kRecompute = 0,
+  /*! \brief Swap the KV data of the request to host memory, and back in later. */
+  kSwap = 1,
+};
+
+/*!
+ * \brief The continuous batching scheduler of generation requests.
+ *
+ * The scheduler owns the queues of the requests and assembles each step of forwarding over the
+ * paged KV cache, so that the loop of serving runs without going back to the caller:
+ * - The swapped-out requests are swapped back in first, and then the waiting requests are
+ *   admitted, first come first served, while the number of running requests, the token budget
+ *   of the step and the free pages of the KV cache allow.
+ * - A step batches one token for each decoding request with chunks of the prompts being
+ *   prefilled, so a long prompt is prefilled over several steps within the token budget.
+ * - When the KV cache does not have the pages that the running requests need, the request that
+ *   was admitted last is preempted, by recomputation or by swapping it to host memory.
+ *
+ * The model runs through a function `fforward(seq_ids, append_lengths, token_ids)`, called
+ * between the BeginForward and EndForward of the KV cache, and returning the next token of each
+ * sequence of the batch, e.g. a VM function running the model and the sampling builtins. The
+ * next token of a sequence whose prompt is not fully prefilled yet is ignored. The request ids
+ * are used as the sequence ids in the KV cache.
+ */
+class RequestSchedulerObj : public ffi::Object {
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief The state of a request. */
+  enum class State : int { kWaiting, kRunning, kSwapped, kFinished };
+
+  /*! \brief A generation request. */
+  struct Request {
+    /*! \brief The prompt tokens followed by the generated tokens. */
+    std::vector<int64_t> tokens;
+    /*! \brief The number of prompt tokens. */
+    int64_t num_prompt_tokens;
+    /*! \brief The number of tokens whose KV data is in the KV cache. */
+    int64_t num_computed_tokens = 0;
+    /*! \brief The maximum number of tokens to generate. */
+    int64_t max_new_tokens;
+    /*! \brief The tokens which finish the generation. */
+    std::vector<int64_t> stop_token_ids;
+    /*! \brief The state of the request. */
+    State state = State::kWaiting;
+    /*! \brief The time the request was added. */
+    Clock::time_point arrival_time;
+    /*! \brief The time of the first generated token. */
+    Clock::time_point first_token_time;
+
+    int64_t NumGeneratedTokens() const {
+      return static_cast<int64_t>(tokens.size()) - num_prompt_tokens;
+    }
+  };
+
+  /********************* Configuration *********************/
+
+  /*! \brief The KV cache of the model. */
+  const AttentionKVCache kv_cache_;
+  /*! \brief The function running a step of the model. */
+  const ffi::Function fforward_;
+  /*! \brief The page size of the KV cache. */
+  const int64_t page_size_;
+  /*! \brief The maximum number of running requests. */
+  const int64_t max_num_seqs_;
+  /*! \brief The maximum number of tokens of a step. */
+  const int64_t max_num_batched_tokens_;
+  /*! \brief The way to preempt requests. */
+  const PreemptMode preempt_mode_;
+
+  /********************* Request Queues *********************/
+
+  /*! \brief The mapping from request ids to requests. */
+  std::unordered_map<int64_t, Request> requests_;
+  /*! \brief The requests waiting to be admitted, in order. */
+  std::deque<int64_t> waiting_;
+  /*! \brief The running requests, in the order of their admission. */
+  std::vector<int64_t> running_;
+  /*! \brief The requests swapped out to host memory, in order. */
+  std::deque<int64_t> swapped_;
+
+  /********************* Statistics *********************/
+
+  int64_t num_steps_ = 0;
+  int64_t num_prefill_tokens_ = 0;
+  int64_t num_generated_tokens_ = 0;
+  int64_t num_preemptions_ = 0;
+  int64_t num_finished_ = 0;
+  double total_step_seconds_ = 0;
+  double total_time_to_first_token_seconds_ = 0;
+  double total_time_per_output_token_seconds_ = 0;
+  double total_latency_seconds_ = 0;
+
+ public:
+  /*! \brief Constructor. Take the scheduler configuration. */
+  explicit RequestSchedulerObj(AttentionKVCache kv_cache, ffi::Function fforward,
+                               int64_t page_size, int64_t max_num_seqs,
+                               int64_t max_num_batched_tokens, PreemptMode preempt_mode)
+      : kv_cache_(std::move(kv_cache)),
+        fforward_(std::move(fforward)),
+        page_size_(page_size),
+        max_num_seqs_(max_num_seqs),
+        max_num_batched_tokens_(max_num_batched_tokens),
+        preempt_mode_(preempt_mode) {}
+
+  /************** Request Management **************/
+
+  /*!
+   * \brief Add a request to the end of the waiting queue.
+   * \param request_id The id of the request, which is also its sequence id in the KV cache.
+   * \param prompt_token_ids The tokens of the prompt.
+   * \param max_new_tokens The maximum number of tokens to generate.
+   * \param stop_token_ids The tokens which finish the generation.
+   */
+  void AddRequest(int64_t request_id, const ffi::Shape& prompt_token_ids, int64_t max_new_tokens,
+                  const ffi::Shape& stop_token_ids) {
+    TVM_FFI_CHECK(!requests_.count(request_id), ValueError)
+        << "The request \"" << request_id << "\" is already in the scheduler.";
+    TVM_FFI_CHECK(!prompt_token_ids.empty(), ValueError)
+        << "The prompt of request \"" << request_id << "\" is empty.";
+    TVM_FFI_CHECK_GT(max_new_tokens, 0, ValueError)
+        << "The request \"" << request_id << "\" should generate at least one token.";
+    Request request;
+    request.tokens.assign(prompt_token_ids.begin(), prompt_token_ids.end());
+    request.num_prompt_tokens = prompt_token_ids.size();
+    request.max_new_tokens = max_new_tokens;
+    request.stop_token_ids.assign(stop_token_ids.begin(), stop_token_ids.end());
+    request.arrival_time = Clock::now();
+    requests_.emplace(request_id, std::move(request));
+    waiting_.push_back(request_id);
+  }
+
+  /*!
+   * \brief Remove a request, aborting it if it is not finished, and release its KV data.
+   * \param request_id The id of the request.
+   */
+  void RemoveRequest(int64_t request_id) {
+    Request& request = GetRequest(request_id);
+    switch (request.state) {
+      case State::kWaiting:
+        waiting_.erase(std::find(waiting_.begin(), waiting_.end(), request_id));
+        break;
+      case State::kRunning:
+        running_.erase(std::find(running_.begin(), running_.end(), request_id));
+        kv_cache_->RemoveSequence(request_id);
+        break;
+      case State::kSwapped:
+        swapped_.erase(std::find(swapped_.begin(), swapped_.end(), request_id));
+        kv_cache_->RemoveSequence(request_id);
+        break;
+      case State::kFinished:
+        break;
+    }
+    requests_.erase(request_id);
+  }
+
+  /*! \brief Get the tokens generated so far by a request. */
+  ffi::Shape GetOutput(int64_t request_id) {
+    const Request& request = GetRequest(request_id);
+    return ffi::Shape(request.tokens.begin() + request.num_prompt_tokens, request.tokens.end());
+  }
+
+  /*! \brief Whether a request is finished. */
+  bool IsFinished(int64_t request_id) {
+    return GetRequest(request_id).state == State::kFinished;
+  }
+
+  /*! \brief Whether the scheduler has requests to run. */
+  bool HasUnfinishedRequests() const {
+    return !waiting_.empty() || !running_.empty() || !swapped_.empty();
+  }
+
+  /************** Scheduling **************/
+
+  /*!
+   * \brief Run a step: schedule the requests, forward the batch and append the next tokens.
+   * \return The ids of the requests finished by the step.
+   */
+  ffi::Shape Step() {
+    Clock::time_point step_begin = Clock::now();
+    std::vector<int64_t> seq_ids;
+    std::vector<int64_t> append_lengths;
+    Schedule(&seq_ids, &append_lengths);
+    std::vector<int64_t> finished;
+    if (seq_ids.empty()) return ffi::Shape(finished);
+
+    std::vector<int64_t> token_ids;
+    for (size_t i = 0; i < seq_ids.size(); ++i) {
+      const Request& request = requests_.at(seq_ids[i]);
+      auto begin = request.tokens.begin() + request.num_computed_tokens;
+      token_ids.insert(token_ids.end(), begin, begin + append_lengths[i]);
+    }
+    ffi::Shape seq_ids_shape(seq_ids);
+    ffi::Shape append_lengths_shape(append_lengths);
+    kv_cache_->BeginForward(seq_ids_shape, append_lengths_shape);
+    ffi::Shape next_token_ids =
+        fforward_(seq_ids_shape, append_lengths_shape, ffi::Shape(token_ids)).cast<ffi::Shape>();
+    kv_cache_->EndForward();
+    TVM_FFI_CHECK_EQ(next_token_ids.size(), seq_ids.size(), ValueError)
+        << "The forward function should return one token for each of the " << seq_ids.size()
+        << " sequences of the batch.";
+
+    RequestSchedulerMetrics& metrics = RequestSchedulerMetrics::Get();
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < seq_ids.size(); ++i) {
+      Request& request = requests_.at(seq_ids[i]);
+      if (request.num_computed_tokens < request.num_prompt_tokens) {
+        int64_t num_prompt = std::min(request.num_computed_tokens + append_lengths[i],
+                                      request.num_prompt_tokens) -
+                             request.num_computed_tokens;
+        num_prefill_tokens_ += num_prompt;
+        metrics.prefill_tokens->Increment(num_prompt);
+      }
+      request.num_computed_tokens += append_lengths[i];
+      // A chunk of a prompt does not generate a token until the prompt is fully prefilled.
+      if (request.num_computed_tokens < static_cast<int64_t>(request.tokens.size())) continue;
+      int64_t token_id = next_token_ids[i];
+      request.tokens.push_back(token_id);
+      ++num_generated_tokens_;
+      metrics.generated_tokens->Increment();
+      if (request.NumGeneratedTokens() == 1) {
+        request.first_token_time = now;
+        double ttft = std::chrono::duration<double>(now - request.arrival_time).count();
+        total_time_to_first_token_seconds_ += ttft;
+        metrics.time_to_first_token_seconds->Observe(ttft);
+      }
+      bool stopped = std::find(request.stop_token_ids.begin(), request.stop_token_ids.end(),
+                               token_id) != request.stop_token_ids.end();
+      if (stopped || request.NumGeneratedTokens() >= request.max_new_tokens) {
+        Finish(seq_ids[i], now);
+        finished.push_back(seq_ids[i]);
+      }
+    }
+
+    double step_seconds = std::chrono::duration<double>(Clock::now() - step_begin).count();
+    ++num_steps_;
+    total_step_seconds_ += step_seconds;
+    metrics.steps->Increment();
+    metrics.step_seconds->Observe(step_seconds);
+    return ffi::Shape(finished);
+  }
+
+  /*!
+   * \brief Get the statistics of the scheduler: the numbers of steps, prefilled and generated
+   * tokens, preemptions and finished requests, the sizes of the queues, the throughput of
+   * generation over the time of the steps, and the mean time to first token, time per output
+   * token and end-to-end latency of the finished requests, in seconds.
+   */
+  ffi::Map<ffi::String, ffi::Any> GetMetrics() const {
+    ffi::Map<ffi::String, ffi::Any> result;
+    result.Set("num_steps", num_steps_);
+    result.Set("num_prefill_tokens", num_prefill_tokens_);
+    result.Set("num_generated_tokens", num_generated_tokens_);
+    result.Set("num_preemptions", num_preemptions_);
+    result.Set("num_finished_requests", num_finished_);
+    result.Set("num_waiting_requests", static_cast<int64_t>(waiting_.size()));
+    result.Set("num_running_requests", static_cast<int64_t>(running_.size()));
+    result.Set("num_swapped_requests", static_cast<int64_t>(swapped_.size()));
+    result.Set("generation_throughput",
+               total_step_seconds_ > 0 ? num_generated_tokens_ / total_step_seconds_ : 0.0);
+    double num_finished = std::max<int64_t>(num_finished_, 1);
+    result.Set("mean_time_to_first_token", total_time_to_first_token_seconds_ / num_finished);
+    result.Set("mean_time_per_output_token", total_time_per_output_token_seconds_ / num_finished);
+    result.Set("mean_latency", total_latency_seconds_ / num_finished);
+    return result;
+  }
+
+ private:
+  Request& GetRequest(int64_t request_id) {
+    auto it = requests_.find(request_id);
+    TVM_FFI_CHECK(it != requests_.end(), ValueError)
+        << "The request \"" << request_id << "\" cannot be found in the scheduler.";
+    return it->second;
+  }
+
+  /*! \brief The number of pages holding the given number of tokens. */
+  int64_t NumPages(int64_t num_tokens) const { return (num_tokens + page_size_ - 1) / page_size_; }
+
+  /*!
+   * \brief Assemble the batch of the next step.
+   * \param seq_ids The sequences of the batch.
+   * \param append_lengths The number of tokens of each sequence in the batch.
+   */
+  void Schedule(std::vector<int64_t>* seq_ids, std::vector<int64_t>* append_lengths) {
+    int64_t num_free_pages = kv_cache_->GetNumAvailablePages();
+    // - Swap in the swapped-out requests, whose next decode may need one more page.
+    while (!swapped_.empty() && static_cast<int64_t>(running_.size()) < max_num_seqs_) {
+      Request& request = requests_.at(swapped_.front());
+      int64_t swap_pages = NumPages(request.num_computed_tokens + 1);
+      if (swap_pages > num_free_pages) break;
+      kv_cache_->SwapInSequence(swapped_.front());
+      num_free_pages = kv_cache_->GetNumAvailablePages();
+      request.state = State::kRunning;
+      running_.push_back(swapped_.front());
+      swapped_.pop_front();
+    }
+
+    // - Plan the running requests, preempting the last admitted ones until the pages suffice.
+    int64_t num_tokens = 0;
+    int64_t num_pages = 0;
+    bool preempted = false;
+    while (true) {
+      seq_ids->clear();
+      append_lengths->clear();
+      num_tokens = 0;
+      num_pages = 0;
+      for (int64_t request_id : running_) {
+        const Request& request = requests_.at(request_id);
+        int64_t length = std::min<int64_t>(request.tokens.size() - request.num_computed_tokens,
+                                           max_num_batched_tokens_ - num_tokens);
+        if (length <= 0) continue;
+        seq_ids->push_back(request_id);
+        append_lengths->push_back(length);
+        num_tokens += length;
+        num_pages += NumPages(request.num_computed_tokens + length) -
+                     NumPages(request.num_computed_tokens);
+      }
+      if (num_pages <= num_free_pages) break;
+      TVM_FFI_CHECK_GT(running_.size(), 1U, RuntimeError)
+          << "The KV cache does not have enough pages for request \"" << running_.front()
+          << "\" alone, which needs " << num_pages << " pages while " << num_free_pages
+          << " pages are free.";
+      Preempt(running_.back());
+      preempted = true;
+      num_free_pages = kv_cache_->GetNumAvailablePages();
+    }
+
+    // - Admit the waiting requests, unless requests are preempted or swapped out.
+    if (preempted || !swapped_.empty()) return;
+    while (!waiting_.empty() && static_cast<int64_t>(running_.size()) < max_num_seqs_ &&
+           num_tokens < max_num_batched_tokens_) {
+      int64_t request_id = waiting_.front();
+      Request& request = requests_.at(request_id);
+      int64_t length =
+          std::min<int64_t>(request.tokens.size(), max_num_batched_tokens_ - num_tokens);
+      // Keep a page for the growth of the running requests.
+      int64_t request_pages = NumPages(length);
+      if (num_pages + request_pages + 1 > num_free_pages) break;
+      kv_cache_->AddSequence(request_id);
+      request.state = State::kRunning;
+      running_.push_back(request_id);
+      waiting_.pop_front();
+      seq_ids->push_back(request_id);
+      append_lengths->push_back(length);
+      num_tokens += length;
+      num_pages += request_pages;
+    }
+  }
+
+  /*! \brief Preempt a running request. */
+  void Preempt(int64_t request_id) {
+    Request& request = requests_.at(request_id);
+    running_.erase(std::find(running_.begin(), running_.end(), request_id));
+    if (preempt_mode_ == PreemptMode::kSwap) {
+      kv_cache_->SwapOutSequence(request_id);
+      request.state = State::kSwapped;
+      swapped_.push_front(request_id);
+    } else {
+      // The tokens generated so far are prefilled again along the prompt.
+      kv_cache_->RemoveSequence(request_id);
+      request.num_computed_tokens = 0;
+      request.state = State::kWaiting;
+      waiting_.push_front(request_id);
+    }
+    VLOG(1) << "Preempt request " << request_id << " by "
+            << (preempt_mode_ == PreemptMode::kSwap ? "swap" : "recompute");
+    ++num_preemptions_;
+    RequestSchedulerMetrics::Get().preemptions->Increment();
+  }
+
+  /*! \brief Finish a running request and release its KV data. */
+  void Finish(int64_t request_id, Clock::time_point now) {
+    Request& request = requests_.at(request_id);
+    running_.erase(std::find(running_.begin(), running_.end(), request_id));
+    kv_cache_->RemoveSequence(request_id);
+    request.state = State::kFinished;
+    ++num_finished_;
+    total_latency_seconds_ += std::chrono::duration<double>(now - request.arrival_time).count();
+    if (request.NumGeneratedTokens() > 1) {
+      double tpot = std::chrono::duration<double>(now - request.first_token_time).count() /
+                    (request.NumGeneratedTokens() - 1);
+      total_time_per_output_token_seconds_ += tpot;
+      RequestSchedulerMetrics::Get().time_per_output_token_seconds->Observe(tpot);
+    }
+  }
+
+ public:
+  static constexpr const bool _type_mutable = true;
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("relax.vm.RequestScheduler", RequestSchedulerObj,
+                                    ffi::Object);
+};
+
+class RequestScheduler : public ffi::ObjectRef {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(RequestScheduler, ffi::ObjectRef,
+                                             RequestSchedulerObj);
+};
+
+//-------------------------------------------------
+//  Register runtime functions
+//-------------------------------------------------
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("vm.builtin.request_scheduler_create",
+           [](AttentionKVCache kv_cache, ffi::Function fforward, int64_t page_size,
+              int64_t max_num_seqs, int64_t max_num_batched_tokens, ffi::String preempt_mode) {
+             TVM_FFI_CHECK_GT(page_size, 0, ValueError) << "The page size should be positive.";
+             TVM_FFI_CHECK_GT(max_num_seqs, 0, ValueError)
+                 << "The maximum number of sequences should be positive.";
+             TVM_FFI_CHECK_GT(max_num_batched_tokens, 0, ValueError)
+                 << "The maximum number of batched tokens should be positive.";
+             PreemptMode mode;
+             if (preempt_mode == "recompute") {
+               mode = PreemptMode::kRecompute;
+             } else if (preempt_mode == "swap") {
+               mode = PreemptMode::kSwap;
+             } else {
+               TVM_FFI_THROW(ValueError) << "Unknown preempt mode \"" << preempt_mode
+                                         << "\", expected \"recompute\" or \"swap\".";
+             }
+             ffi::ObjectPtr<RequestSchedulerObj> n = ffi::make_object<RequestSchedulerObj>(
+                 std::move(kv_cache), std::move(fforward), page_size, max_num_seqs,
+                 max_num_batched_tokens, mode);
+             return RequestScheduler(std::move(n));
+           })
+      .def_method("vm.builtin.request_scheduler_add_request", &RequestSchedulerObj::AddRequest)
+      .def_method("vm.builtin.request_scheduler_remove_request",
+                  &RequestSchedulerObj::RemoveRequest)
+      .def_method("vm.builtin.request_scheduler_get_output", &RequestSchedulerObj::GetOutput)
+      .def_method("vm.builtin.request_scheduler_is_finished", &RequestSchedulerObj::IsFinished)
+      .def_method("vm.builtin.request_scheduler_has_unfinished_requests",
+                  &RequestSchedulerObj::HasUnfinishedRequests)
+      .def_method("vm.builtin.request_scheduler_step", &RequestSchedulerObj::Step)
+      .def_method("vm.builtin.request_scheduler_get_metrics", &RequestSchedulerObj::GetMetrics);
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
@@ -24,6 +24,7 @@
 #include <tvm/ffi/reflection/registry.h>
 
 #include <cstdint>
+#include <set>
 #include <vector>
 
 #include "kv_state.h"
@@ -53,7 +54,10 @@ class RNNStateImpObj : public RNNStateObj {
     int64_t available_history_num = 0;
     /*! \brief The index of history slot in the storage. */
     int64_t history_slot_id = 0;
-    /*! \brief The index of seq slot in the storage. */
+    /*!
+     * \brief The index of seq slot in the storage. A forked sequence shares the slot of its
+     * parent until the slot is written.
+     */
     int64_t seq_slot_id;
 
     /*! \brief Constructor. */
@@ -84,6 +88,12 @@ class RNNStateImpObj : public RNNStateObj {
 
   /*! \brief We fix int32 to be the index dtype of auxiliary data. */
   const DLDataType dtype_aux_ = DLDataType{kDLInt, 32, 1};
+  /*!
+   * \brief The max number of sequences moved to lower slots in each forward. Moving the live
+   * sequences to the lowest slots in the background keeps the slots accessed by the batched
+   * get/set functions dense as short sequences come and go.
+   */
+  const int64_t max_slot_moves_per_forward_ = 1;
 
   /******************* Storage Structures *******************/
 
@@ -95,8 +105,10 @@ class RNNStateImpObj : public RNNStateObj {
    * we use a 2D array to store the Tensors for each layer.
    */
   ffi::Array<ffi::Array<Tensor>> storages_;
-  /*! \brief The list of ids of released seq slot for reuse. */
-  std::vector<int64_t> free_slot_ids_;
+  /*! \brief The ids of released seq slot for reuse, the lowest ones are reused first. */
+  std::set<int64_t> free_slot_ids_;
+  /*! \brief The number of sequences sharing each seq slot, 0 for a free slot. */
+  std::vector<int64_t> slot_ref_counts_;
   /*! \brief The mapping from sequence ids to sequences. */
   std::unordered_map<int64_t, Sequence> seq_map_;
 
@@ -108,6 +120,11 @@ class RNNStateImpObj : public RNNStateObj {
   ffi::Shape cur_append_lengths_;
   /*! \brief The sequence ids of the current round of forwarding. */
   ffi::Shape cur_seq_ids_;
+  /*!
+   * \brief Whether some sequence of the current round of forwarding shares its seq slot, which
+   * is copied before the first `Set` of the round.
+   */
+  bool cur_has_shared_slots_ = false;
 
   /**************** Auxiliary Arrays on Device *****************/
 
@@ -116,15 +133,16 @@ class RNNStateImpObj : public RNNStateObj {
    * If it is dirty, an explicit "SyncAuxArrayToDevice" should be invoked.
    */
   bool dirty_aux_data_device_ = false;
-  /*! \brief The device array of the sequence ids. */
-  Tensor seq_slot_ids_device_;
+  /*!
+   * \brief The device array holding the sequence ids followed by the history slot ids, so that
+   * both are uploaded in a single copy.
+   */
+  Tensor aux_data_device_;
   /*!
    * \brief The view of the device array of the sequence ids.
    * The view is used to reuse the memory but with different shape.
    */
   Tensor seq_slot_ids_view_;
-  /*! \brief The device array of the history slot ids. */
-  Tensor history_slot_ids_device_;
   /*!
    * \brief The view of the device array of the history slot ids.
    * The view is used to reuse the memory but with different shape.
@@ -188,8 +206,7 @@ class RNNStateImpObj : public RNNStateObj {
     TVM_FFI_ICHECK_GT(max_history_, 0) << "At least 1 history slot to store the current state";
 
     // Allocate the auxiliary arrays on device.
-    seq_slot_ids_device_ = Tensor::Empty({reserved_num_seqs}, dtype_aux_, device);
-    history_slot_ids_device_ = Tensor::Empty({reserved_num_seqs}, dtype_aux_, device);
+    aux_data_device_ = Tensor::Empty({2 * AlignAuxOffset(reserved_num_seqs)}, dtype_aux_, device);
 
     Clear();
   }
@@ -199,9 +216,11 @@ class RNNStateImpObj : public RNNStateObj {
     seq_map_.clear();
     TVM_FFI_ICHECK(!storages_.empty());
     free_slot_ids_.clear();
-    for (int64_t slot_id = reserved_num_seqs_ - 1; slot_id >= 0; --slot_id) {
-      free_slot_ids_.push_back(slot_id);
+    for (int64_t slot_id = 0; slot_id < reserved_num_seqs_; ++slot_id) {
+      free_slot_ids_.insert(slot_id);
     }
+    slot_ref_counts_.assign(reserved_num_seqs_, 0);
+    cur_has_shared_slots_ = false;
     dirty_aux_data_device_ = false;
   }
 
@@ -229,6 +248,15 @@ class RNNStateImpObj : public RNNStateObj {
     cur_append_lengths_ = append_lengths;
     cur_seq_ids_ = seq_ids;
 
+    CompactSlots();
+    cur_has_shared_slots_ = false;
+    for (int64_t seq_id : seq_ids) {
+      auto it = seq_map_.find(seq_id);
+      TVM_FFI_ICHECK(it != seq_map_.end())
+          << "The sequence \"" << seq_id << "\" cannot be found in the space state storage.";
+      cur_has_shared_slots_ |= slot_ref_counts_[it->second.seq_slot_id] > 1;
+    }
+
     if (dirty_aux_data_device_) {
       SyncAuxArrayToDevice();
     }
@@ -282,6 +310,13 @@ class RNNStateImpObj : public RNNStateObj {
         << "The batch size is not consistent with the number of sequence ids.";
     TVM_FFI_ICHECK_GT(cur_batch_size_, 0) << "The curent batch size should be greater than 0.";
 
+    if (cur_has_shared_slots_) {
+      // Copy on write: the sequences stop sharing slots before any of them is written.
+      UnshareSlots();
+      SyncAuxArrayToDevice();
+      cur_has_shared_slots_ = false;
+    }
+
     Tensor state = storages_[layer_id][state_id];
     f_sets_[state_id](state, seq_slot_ids_view_, history_slot_ids_view_, data);
   }
@@ -309,6 +344,7 @@ class RNNStateImpObj : public RNNStateObj {
     TVM_FFI_ICHECK(seq_map_.find(seq_id) == seq_map_.end())
         << "The sequence \"" << seq_id << "\" is already in the space state storage.";
     int64_t seq_slot_id = GetFreeSlot();
+    slot_ref_counts_[seq_slot_id] = 1;
     seq_map_.insert({seq_id, Sequence(seq_slot_id)});
 
     // Initialize the state data with the init value.
@@ -329,7 +365,7 @@ class RNNStateImpObj : public RNNStateObj {
     TVM_FFI_ICHECK(it != seq_map_.end())
         << "The sequence \"" << seq_id << "\" cannot be found in the space state storage.";
 
-    free_slot_ids_.push_back(it->second.seq_slot_id);
+    ReleaseSlot(it->second.seq_slot_id);
     seq_map_.erase(it);
 
     dirty_aux_data_device_ = true;
@@ -342,19 +378,10 @@ class RNNStateImpObj : public RNNStateObj {
     TVM_FFI_ICHECK(seq_map_.find(child_seq_id) == seq_map_.end())
         << "The child sequence \"" << child_seq_id << "\" is already in the space state storage.";
 
-    // Create a child block with the parent block pointer.
-    int64_t child_slot_id = GetFreeSlot();
-    seq_map_.insert({child_seq_id, Sequence::Fork(parent_it->second, child_slot_id)});
-
-    // Copy the parent state data to the child state data.
+    // The child shares the slot of the parent, which is copied when either of them is set.
     int64_t parent_slot_id = parent_it->second.seq_slot_id;
-    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
-      for (int64_t state_id = 0; state_id < num_states_per_layer_; ++state_id) {
-        DLTensor copy_src = GetStatePtrBySeq(layer_id, state_id, parent_slot_id);
-        DLTensor copy_dst = GetStatePtrBySeq(layer_id, state_id, child_slot_id);
-        Tensor::CopyFromTo(&copy_src, &copy_dst);
-      }
-    }
+    ++slot_ref_counts_[parent_slot_id];
+    seq_map_.insert({child_seq_id, Sequence::Fork(parent_it->second, parent_slot_id)});
     dirty_aux_data_device_ = true;
   }
 
@@ -375,15 +402,81 @@ class RNNStateImpObj : public RNNStateObj {
   }
 
  private:
-  /*! \brief Get a new free block and return its index. */
+  /*! \brief Round up an element offset of the auxiliary data to 16 bytes. */
+  int64_t AlignAuxOffset(int64_t num_elems) const {
+    int64_t align_elems = 16 / (dtype_aux_.bits / 8);
+    return (num_elems + align_elems - 1) / align_elems * align_elems;
+  }
+
+  /*! \brief Get the lowest free slot and return its index. */
   int32_t GetFreeSlot() {
     TVM_FFI_ICHECK(!free_slot_ids_.empty())
         << "The Sequence slot is full, cannot accept new sequence.";
-    int32_t seq_slot_id = free_slot_ids_.back();
-    free_slot_ids_.pop_back();
+    int32_t seq_slot_id = *free_slot_ids_.begin();
+    free_slot_ids_.erase(free_slot_ids_.begin());
     return seq_slot_id;
   }
 
+  /*! \brief Drop a reference to the slot, which is freed when no sequence uses it. */
+  void ReleaseSlot(int64_t seq_slot_id) {
+    TVM_FFI_ICHECK_GT(slot_ref_counts_[seq_slot_id], 0);
+    if (--slot_ref_counts_[seq_slot_id] == 0) {
+      free_slot_ids_.insert(seq_slot_id);
+    }
+  }
+
+  /*! \brief Copy the states of all the history of a slot to another slot. */
+  void CopySlot(int64_t src_slot_id, int64_t dst_slot_id) {
+    for (int64_t layer_id = 0; layer_id < num_layers_; ++layer_id) {
+      for (int64_t state_id = 0; state_id < num_states_per_layer_; ++state_id) {
+        DLTensor copy_src = GetStatePtrBySeq(layer_id, state_id, src_slot_id);
+        DLTensor copy_dst = GetStatePtrBySeq(layer_id, state_id, dst_slot_id);
+        Tensor::CopyFromTo(&copy_src, &copy_dst);
+      }
+    }
+  }
+
+  /*!
+   * \brief Give each sequence of the current round of forwarding that shares its slot a copy
+   * of the slot. One of the sharers keeps the slot once the others have copied it.
+   */
+  void UnshareSlots() {
+    for (int64_t seq_id : cur_seq_ids_) {
+      Sequence& seq = seq_map_.at(seq_id);
+      if (slot_ref_counts_[seq.seq_slot_id] == 1) continue;
+      int64_t new_slot_id = GetFreeSlot();
+      CopySlot(seq.seq_slot_id, new_slot_id);
+      ReleaseSlot(seq.seq_slot_id);
+      slot_ref_counts_[new_slot_id] = 1;
+      seq.seq_slot_id = new_slot_id;
+    }
+    dirty_aux_data_device_ = true;
+  }
+
+  /*! \brief Move the sequences in the highest used slots to the lowest free slots. */
+  void CompactSlots() {
+    int64_t highest_used_slot_id = reserved_num_seqs_ - 1;
+    for (int64_t num_moves = 0; num_moves < max_slot_moves_per_forward_; ++num_moves) {
+      while (highest_used_slot_id >= 0 && slot_ref_counts_[highest_used_slot_id] == 0) {
+        --highest_used_slot_id;
+      }
+      if (free_slot_ids_.empty() || *free_slot_ids_.begin() > highest_used_slot_id) {
+        return;
+      }
+      int64_t new_slot_id = GetFreeSlot();
+      CopySlot(highest_used_slot_id, new_slot_id);
+      for (auto& [seq_id, seq] : seq_map_) {
+        if (seq.seq_slot_id == highest_used_slot_id) {
+          seq.seq_slot_id = new_slot_id;
+        }
+      }
+      slot_ref_counts_[new_slot_id] = slot_ref_counts_[highest_used_slot_id];
+      slot_ref_counts_[highest_used_slot_id] = 0;
+      free_slot_ids_.insert(highest_used_slot_id);
+      dirty_aux_data_device_ = true;
+    }
+  }
+
   DLTensor GetStatePtrBySeqHistory(int64_t layer_id, int64_t state_id, int64_t seq_slot_id,
                                    int64_t history_slot_id) {
     Tensor state = storages_[layer_id][state_id];
@@ -423,36 +516,30 @@ class RNNStateImpObj : public RNNStateObj {
    * invoked before running attention computation on device.
    */
   void SyncAuxArrayToDevice() {
-    auto fcopy_from_vec = [](Tensor array, std::vector<int32_t> vec_data) {
-      DLTensor copy_dst = *array.operator->();
-      DLTensor copy_src;
-      copy_src.data = vec_data.data();
-      copy_src.device = Device{kDLCPU, 0};
-      copy_src.ndim = 1;
-      copy_src.dtype = array->dtype;
-      copy_src.shape = array->shape;
-      copy_src.strides = array->strides;
-      copy_src.byte_offset = 0;
-      Tensor::CopyFromTo(&copy_src, &copy_dst);
-    };
-
-    std::vector<int32_t> seq_slot_ids;
-    std::vector<int32_t> history_slot_ids;
-    seq_slot_ids.reserve(cur_batch_size_);
-    history_slot_ids.reserve(cur_batch_size_);
-    for (int64_t seq_id : cur_seq_ids_) {
-      auto it = seq_map_.find(seq_id);
-      TVM_FFI_ICHECK(it != seq_map_.end())
-          << "The sequence \"" << seq_id << "\" cannot be found in the space state storage.";
+    // The history slot ids start at an aligned offset after the sequence ids.
+    int64_t history_offset = AlignAuxOffset(cur_batch_size_);
+    std::vector<int32_t> aux_data(history_offset + cur_batch_size_, 0);
+    for (int64_t i = 0; i < cur_batch_size_; ++i) {
+      auto it = seq_map_.find(cur_seq_ids_[i]);
+      TVM_FFI_ICHECK(it != seq_map_.end()) << "The sequence \"" << cur_seq_ids_[i]
+                                           << "\" cannot be found in the space state storage.";
       const Sequence& seq = it->second;
-      seq_slot_ids.push_back(seq.seq_slot_id);
-      history_slot_ids.push_back(seq.history_slot_id);
+      aux_data[i] = seq.seq_slot_id;
+      aux_data[history_offset + i] = seq.history_slot_id;
     }
-    seq_slot_ids_view_ = seq_slot_ids_device_.CreateView({cur_batch_size_}, dtype_aux_);
-    history_slot_ids_view_ = history_slot_ids_device_.CreateView({cur_batch_size_}, dtype_aux_);
-
-    fcopy_from_vec(seq_slot_ids_view_, seq_slot_ids);
-    fcopy_from_vec(history_slot_ids_view_, history_slot_ids);
+    int64_t elem_bytes = dtype_aux_.bits / 8;
+    seq_slot_ids_view_ = aux_data_device_.CreateView({cur_batch_size_}, dtype_aux_);
+    history_slot_ids_view_ =
+        aux_data_device_.CreateView({cur_batch_size_}, dtype_aux_, history_offset * elem_bytes);
+
+    Tensor copy_view =
+        aux_data_device_.CreateView({static_cast<int64_t>(aux_data.size())}, dtype_aux_);
+    DLTensor copy_dst = *copy_view.operator->();
+    DLTensor copy_src = copy_dst;
+    copy_src.data = aux_data.data();
+    copy_src.device = Device{kDLCPU, 0};
+    copy_src.byte_offset = 0;
+    Tensor::CopyFromTo(&copy_src, &copy_dst);
 
     // Reset the dirty flag to false.
     dirty_aux_data_device_ = false;
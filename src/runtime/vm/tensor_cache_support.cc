@@ -34,18 +34,38 @@
  * We will keep the impact minimum by puting it as a private
  * runtime builtin provide as in this file.
  */
+#include <tvm/ffi/container/map.h>
 #include <tvm/ffi/extra/json.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/runtime/tensor.h>
 #include <tvm/runtime/vm/tensor_cache_support.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../../support/utils.h"
 #include "../file_utils.h"
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TVM_TENSOR_CACHE_USE_MMAP 1
+#endif
+
 namespace tvm {
 namespace runtime {
 namespace vm {
@@ -68,6 +88,9 @@ TensorCacheMetadata::FileRecord::ParamRecord JSONAsParamRecord(const json::Objec
   result.format = json["format"].cast<ffi::String>();
   result.nbytes = json["nbytes"].cast<int64_t>();
   result.byte_offset = json["byteOffset"].cast<int64_t>();
+  if (json.count("contentHash")) {
+    result.content_hash = json["contentHash"].cast<ffi::String>();
+  }
   result.shape = ffi::Shape(std::move(shape));
   return result;
 }
@@ -151,47 +174,305 @@ void CopyTensorFromBytes(Tensor param, const void* data, size_t nbytes,
   DeviceAPI::Get(device)->StreamSync(device, nullptr);
 }
 
-Tensor TensorCacheMetadata::FileRecord::ParamRecord::Load(
-    Device device, const std::string* raw_data, ffi::Optional<Tensor>* staging_buffer) const {
-  Tensor arr = Tensor::Empty(shape, dtype, device);
-  if (dtype == DLDataType{kDLFloat, 32, 1} && format == "f32-to-bf16") {
+/*! \brief Whether the parameter is stored as bf16 and decoded to f32. */
+bool IsBF16Encoded(const TensorCacheMetadata::FileRecord::ParamRecord& rec) {
+  return rec.dtype == DLDataType{kDLFloat, 32, 1} && rec.format == "f32-to-bf16";
+}
+
+/*! \brief Load a parameter from the bytes of its shard. */
+Tensor LoadParamFromBytes(const TensorCacheMetadata::FileRecord::ParamRecord& rec, Device device,
+                          const char* raw_data, ffi::Optional<Tensor>* staging_buffer) {
+  Tensor arr = Tensor::Empty(rec.shape, rec.dtype, device);
+  if (IsBF16Encoded(rec)) {
     // decode bf16 to f32
-    std::vector<uint16_t> buffer(nbytes / 2);
-    std::vector<uint32_t> decoded(nbytes / 2);
-    std::memcpy(buffer.data(), raw_data->data() + byte_offset, nbytes);
+    std::vector<uint16_t> buffer(rec.nbytes / 2);
+    std::vector<uint32_t> decoded(rec.nbytes / 2);
+    std::memcpy(buffer.data(), raw_data + rec.byte_offset, rec.nbytes);
     for (size_t i = 0; i < buffer.size(); ++i) {
       decoded[i] = static_cast<uint32_t>(buffer[i]) << 16;
     }
     CopyTensorFromBytes(arr, decoded.data(), decoded.size() * sizeof(uint32_t), staging_buffer);
   } else {
-    CopyTensorFromBytes(arr, raw_data->data() + byte_offset, nbytes, staging_buffer);
+    CopyTensorFromBytes(arr, raw_data + rec.byte_offset, rec.nbytes, staging_buffer);
   }
   return arr;
 }
 
+Tensor TensorCacheMetadata::FileRecord::ParamRecord::Load(
+    Device device, const std::string* raw_data, ffi::Optional<Tensor>* staging_buffer) const {
+  return LoadParamFromBytes(*this, device, raw_data->data(), staging_buffer);
+}
+
+// The size of each half of the pinned staging buffer.
+constexpr int64_t kStreamChunkBytes = 16 << 20;
+
+/*!
+ * \brief Copy bytes to a CUDA or ROCm tensor through a pinned double buffer,
+ *  so that filling one half overlaps with the transfer out of the other half.
+ */
+void StreamTensorFromBytes(Tensor param, const char* data, int64_t nbytes,
+                           ffi::Optional<Tensor>* staging_buffer, TVMStreamHandle stream) {
+  Device device = param->device;
+  Device host{device.device_type == kDLROCM ? kDLROCMHost : kDLCUDAHost, 0};
+  DLDataType u8{kDLUInt, 8, 1};
+  if (!staging_buffer->has_value() ||
+      staging_buffer->value()->device.device_type != host.device_type ||
+      ffi::GetDataSize(*(staging_buffer->value().operator->())) <
+          static_cast<size_t>(2 * kStreamChunkBytes)) {
+    *staging_buffer = Tensor::Empty({2 * kStreamChunkBytes}, u8, host);
+  }
+  Tensor staging = staging_buffer->value();
+  DeviceAPI* device_api = DeviceAPI::Get(device);
+  int64_t chunk = 0;
+  for (int64_t offset = 0; offset < nbytes; offset += kStreamChunkBytes, ++chunk) {
+    int64_t size = std::min(kStreamChunkBytes, nbytes - offset);
+    int64_t half_offset = (chunk % 2) * kStreamChunkBytes;
+    if (chunk >= 2) {
+      // wait for the transfer out of this half two chunks ago
+      device_api->StreamSync(device, stream);
+    }
+    std::memcpy(static_cast<char*>(staging->data) + half_offset, data + offset, size);
+    Tensor src = staging.CreateView({size}, u8, half_offset);
+    Tensor dst = param.CreateView({size}, u8, offset);
+    Tensor::CopyFromTo(src.operator->(), const_cast<DLTensor*>(dst.operator->()), stream);
+  }
+  device_api->StreamSync(device, stream);
+}
+
+/*! \brief Load a parameter from the bytes of its shard, streaming it to CUDA and ROCm. */
+Tensor LoadRecordFromBytes(const TensorCacheMetadata::FileRecord::ParamRecord& rec,
+                           Device device, const char* raw_data,
+                           ffi::Optional<Tensor>* staging_buffer, TVMStreamHandle stream) {
+  if ((device.device_type == kDLCUDA || device.device_type == kDLROCM) && !IsBF16Encoded(rec)) {
+    ffi::Optional<Tensor> local_staging;
+    Tensor arr = Tensor::Empty(rec.shape, rec.dtype, device);
+    StreamTensorFromBytes(arr, raw_data + rec.byte_offset, rec.nbytes,
+                          staging_buffer != nullptr ? staging_buffer : &local_staging, stream);
+    return arr;
+  }
+  return LoadParamFromBytes(rec, device, raw_data, staging_buffer);
+}
+
+void CheckShard(const TensorCacheMetadata::FileRecord& file, size_t nbytes) {
+  TVM_FFI_CHECK_EQ(file.format, "raw-shard", ValueError) << "Only `raw-shard` format is supported";
+  TVM_FFI_CHECK_EQ(file.nbytes, nbytes, ValueError)
+      << "Encountered an corrupted parameter shard. It means it is not downloaded "
+         "completely or downloading is interrupted. Please try to download again.";
+}
+
 TVM_RUNTIME_DLL ffi::Array<Tensor> TensorCacheMetadata::FileRecord::Load(
     Device device,
     const std::string& path_prefix,  //
     std::string* raw_data_buffer,    //
     ffi::Optional<Tensor>* staging_buffer) const {
   LoadBinaryFromFile(path_prefix + "/" + this->data_path, raw_data_buffer);
-  TVM_FFI_CHECK_EQ(this->format, "raw-shard", ValueError) << "Only `raw-shard` format is supported";
-  TVM_FFI_CHECK_EQ(this->nbytes, raw_data_buffer->length(), ValueError)
-      << "Encountered an corrupted parameter shard. It means it is not downloaded "
-         "completely or downloading is interrupted. Please try to download again.";
+  return LoadFromBytes(device, *raw_data_buffer, staging_buffer);
+}
+
+TVM_RUNTIME_DLL ffi::Array<Tensor> TensorCacheMetadata::FileRecord::LoadFromBytes(
+    Device device, const std::string& raw_data, ffi::Optional<Tensor>* staging_buffer,
+    TVMStreamHandle stream) const {
+  CheckShard(*this, raw_data.length());
   ffi::Array<Tensor> result;
   result.reserve(this->records.size());
   for (const ParamRecord& nd_rec : this->records) {
-    result.push_back(nd_rec.Load(device, raw_data_buffer, staging_buffer));
+    result.push_back(LoadRecordFromBytes(nd_rec, device, raw_data.data(), staging_buffer, stream));
   }
   return result;
 }
 
+/*!
+ * \brief A private, copy-on-write mapping of a shard file.
+ *  It is shared by the zero-copy tensors viewing into it and unmapped with the last of them.
+ */
+class MappedFile {
+ public:
+  /*! \brief Map a file, returns nullptr when the file can not be mapped. */
+  static std::shared_ptr<MappedFile> Open(const std::string& path) {
+#ifdef TVM_TENSOR_CACHE_USE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    TVM_FFI_ICHECK_GE(fd, 0) << "Cannot open " << path;
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return nullptr;
+    return std::shared_ptr<MappedFile>(
+        new MappedFile(static_cast<char*>(data), static_cast<size_t>(st.st_size)));
+#else
+    return nullptr;
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef TVM_TENSOR_CACHE_USE_MMAP
+    munmap(data_, size_);
+#endif
+  }
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(char* data, size_t size) : data_(data), size_(size) {}
+
+  char* data_;
+  size_t size_;
+};
+
+/*! \brief Create a CPU tensor viewing into the mapping, keeping the mapping alive. */
+Tensor ViewMappedParam(const TensorCacheMetadata::FileRecord::ParamRecord& rec, Device device,
+                       std::shared_ptr<MappedFile> file) {
+  class MappedFileAlloc {
+   public:
+    MappedFileAlloc(std::shared_ptr<MappedFile> file, int64_t byte_offset)
+        : file_(std::move(file)), byte_offset_(byte_offset) {}
+    void AllocData(DLTensor* tensor) {
+      tensor->data = file_->data() + byte_offset_;
+      tensor->byte_offset = 0;
+    }
+    void FreeData(DLTensor* tensor) {}
+
+   private:
+    std::shared_ptr<MappedFile> file_;
+    int64_t byte_offset_;
+  };
+  return Tensor::FromNDAlloc(MappedFileAlloc(std::move(file), rec.byte_offset), rec.shape,
+                             rec.dtype, device);
+}
+
+TVM_RUNTIME_DLL ffi::Array<Tensor> TensorCacheMetadata::FileRecord::LoadMapped(
+    Device device, const std::string& path_prefix, ffi::Optional<Tensor>* staging_buffer) const {
+  std::string path = path_prefix + "/" + this->data_path;
+  std::shared_ptr<MappedFile> file = MappedFile::Open(path);
+  if (file == nullptr) {
+    std::string raw_data;
+    return Load(device, path_prefix, &raw_data, staging_buffer);
+  }
+  CheckShard(*this, file->size());
+  ffi::Array<Tensor> result;
+  result.reserve(this->records.size());
+  for (const ParamRecord& nd_rec : this->records) {
+    if (device.device_type == kDLCPU && !IsBF16Encoded(nd_rec) &&
+        nd_rec.byte_offset % kAllocAlignment == 0) {
+      // the kernels assume aligned data, so unaligned parameters are copied
+      result.push_back(ViewMappedParam(nd_rec, device, file));
+    } else {
+      result.push_back(
+          LoadRecordFromBytes(nd_rec, device, file->data(), staging_buffer, nullptr));
+    }
+  }
+  return result;
+}
+
+/*! \brief The state of the prefetcher shared with its reading threads. */
+class ShardPrefetcher::Impl {
+ public:
+  Impl(std::vector<std::pair<std::string, int64_t>> files, int num_threads,
+       int64_t max_inflight_bytes)
+      : files_(std::move(files)),
+        max_inflight_bytes_(max_inflight_bytes),
+        contents_(files_.size()),
+        errors_(files_.size()),
+        ready_(files_.size(), false) {
+    num_threads = std::max(1, std::min(num_threads, static_cast<int>(files_.size())));
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this] { this->Run(); });
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_) {
+      t.join();
+    }
+  }
+
+  std::string Take(int index) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    TVM_FFI_ICHECK_EQ(index, next_take_) << "The files must be taken in order";
+    cv_.wait(lock, [this, index] { return ready_[index]; });
+    ++next_take_;
+    inflight_bytes_ -= files_[index].second;
+    std::string content = std::move(contents_[index]);
+    std::exception_ptr error = errors_[index];
+    lock.unlock();
+    cv_.notify_all();
+    if (error) std::rethrow_exception(error);
+    return content;
+  }
+
+ private:
+  void Run() {
+    while (true) {
+      size_t index;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The files are reserved in order, and a file always fits when nothing is in flight,
+        // so the file a consumer waits for is never starved by later ones.
+        cv_.wait(lock, [this] {
+          return stop_ || next_read_ >= files_.size() || inflight_bytes_ == 0 ||
+                 inflight_bytes_ + files_[next_read_].second <= max_inflight_bytes_;
+        });
+        if (stop_ || next_read_ >= files_.size()) return;
+        index = next_read_++;
+        inflight_bytes_ += files_[index].second;
+      }
+      std::string content;
+      std::exception_ptr error;
+      try {
+        LoadBinaryFromFile(files_[index].first, &content);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        contents_[index] = std::move(content);
+        errors_[index] = error;
+        ready_[index] = true;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  std::vector<std::pair<std::string, int64_t>> files_;
+  int64_t max_inflight_bytes_;
+  std::vector<std::string> contents_;
+  std::vector<std::exception_ptr> errors_;
+  std::vector<bool> ready_;
+  size_t next_read_ = 0;
+  int next_take_ = 0;
+  int64_t inflight_bytes_ = 0;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::thread> threads_;
+};
+
+ShardPrefetcher::ShardPrefetcher(std::vector<std::pair<std::string, int64_t>> files,
+                                 int num_threads, int64_t max_inflight_bytes)
+    : impl_(std::make_unique<Impl>(std::move(files), num_threads, max_inflight_bytes)) {}
+
+ShardPrefetcher::~ShardPrefetcher() = default;
+
+std::string ShardPrefetcher::Take(int index) { return impl_->Take(index); }
+
 /*!
  * A Tensor cache to store pre-loaded arrays in the system.
  */
 class TensorCache {
  public:
+  /*! \brief The number of threads reading the shards ahead. */
+  static constexpr int kNumReadThreads = 4;
+  /*! \brief The maximum bytes of the shards read ahead but not uploaded yet. */
+  static constexpr int64_t kMaxInflightBytes = int64_t(2) << 30;
+
   static TensorCache* Global() {
     static TensorCache* inst = new TensorCache();
     return inst;
@@ -199,58 +480,337 @@ class TensorCache {
 
   static void Update(ffi::String name, Tensor arr, bool override) {
     TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
     if (!override) {
       TVM_FFI_ICHECK_EQ(pool->pool_.count(name), 0)
           << "Name " << name << " already exists in the cache";
     }
+    // an explicitly set tensor is never evicted
+    pool->Untrack(name);
+    pool->ReleaseShared(name);
     pool->pool_.Set(name, arr);
   }
 
   static ffi::Optional<Tensor> Get(ffi::String name) {
     TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
     auto it = pool->pool_.find(name);
     if (it != pool->pool_.end()) {
+      auto lru_it = pool->lru_pos_.find(name);
+      if (lru_it != pool->lru_pos_.end()) {
+        pool->lru_.splice(pool->lru_.begin(), pool->lru_, lru_it->second);
+      }
       return (*it).second;
-    } else {
-      return std::nullopt;
     }
+    auto lazy_it = pool->lazy_params_.find(name);
+    if (lazy_it != pool->lazy_params_.end()) {
+      return pool->Materialize(name, lazy_it->second);
+    }
+    return std::nullopt;
   }
 
   static void Remove(ffi::String name) {
     TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    pool->Untrack(name);
+    pool->ReleaseShared(name);
+    pool->lazy_params_.erase(name);
     pool->pool_.erase(name);
   }
 
-  static void Clear() { Global()->pool_.clear(); }
+  static void Clear() {
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    pool->pool_.clear();
+    pool->lazy_params_.clear();
+    pool->mapped_files_.clear();
+    pool->lru_.clear();
+    pool->lru_pos_.clear();
+    pool->lazy_resident_bytes_ = 0;
+    pool->num_faults_ = 0;
+    pool->num_evictions_ = 0;
+    pool->shared_.clear();
+    pool->name2shared_.clear();
+  }
+
+  /*!
+   * \brief Register the parameters of a cache to be loaded on their first access.
+   *  The lazily loaded parameters are evicted in LRU order when their total size exceeds
+   *  the budget, and are loaded again on their next access.
+   * \param cache_path The cache to path.
+   * \param device_type The type of device to be loaded.
+   * \param device_id The device id.
+   * \param budget_bytes The budget of the lazily loaded parameters, 0 means unlimited.
+   */
+  static void LoadLazy(const std::string& cache_path, int device_type, int device_id,
+                       int64_t budget_bytes) {
+    TVM_FFI_ICHECK_GE(budget_bytes, 0);
+    DLDevice device{static_cast<DLDeviceType>(device_type), device_id};
+    auto metadata = std::make_shared<TensorCacheMetadata>(TensorCacheMetadata::Load(cache_path));
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    pool->lazy_budget_bytes_ = budget_bytes;
+    for (const TensorCacheMetadata::FileRecord& shard_rec : metadata->records) {
+      for (const TensorCacheMetadata::FileRecord::ParamRecord& param_rec : shard_rec.records) {
+        pool->lazy_params_[param_rec.name] = LazyParam{metadata, &shard_rec, &param_rec, device};
+      }
+    }
+  }
+
+  /*! \brief Get the counters of the lazily loaded parameters. */
+  static ffi::Map<ffi::String, int64_t> LazyStats() {
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    ffi::Map<ffi::String, int64_t> result;
+    result.Set("num_faults", pool->num_faults_);
+    result.Set("num_evictions", pool->num_evictions_);
+    result.Set("resident_bytes", pool->lazy_resident_bytes_);
+    result.Set("num_resident", static_cast<int64_t>(pool->lru_.size()));
+    return result;
+  }
+
+  /*! \brief Get the counters of the parameters shared by their content hash. */
+  static ffi::Map<ffi::String, int64_t> SharedStats() {
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    int64_t num_refs = 0, saved_bytes = 0;
+    for (const auto& [key, shared] : pool->shared_) {
+      num_refs += shared.num_refs;
+      saved_bytes += (shared.num_refs - 1) * ffi::GetDataSize(*(shared.tensor.operator->()));
+    }
+    ffi::Map<ffi::String, int64_t> result;
+    result.Set("num_shared", static_cast<int64_t>(pool->shared_.size()));
+    result.Set("num_refs", num_refs);
+    result.Set("saved_bytes", saved_bytes);
+    return result;
+  }
 
   /*!
    * \brief Load parameters from path and append them.
+   *  A parameter with a content hash reuses the tensor of a loaded parameter of the same
+   *  content on the device, e.g. a base weight shared by several fine-tunes, instead of
+   *  being loaded again. A shard whose parameters are all shared is not read.
    * \param cache_path The cache to path.
    * \param device_type The type of device to be loaded.
    * \param device_id The device id.
+   * \param progress The callback of (loaded bytes, total bytes) after each shard.
+   * \param name_prefix The prefix of the names of the parameters in the cache, so that
+   *  several models can be loaded side by side.
    */
-  static void Load(const std::string& cache_path, int device_type, int device_id) {
+  static void Load(const std::string& cache_path, int device_type, int device_id,
+                   ffi::Optional<ffi::Function> progress = std::nullopt,
+                   const std::string& name_prefix = "") {
     DLDevice device{static_cast<DLDeviceType>(device_type), device_id};
     TensorCacheMetadata metadata = TensorCacheMetadata::Load(cache_path);
     ffi::Optional<Tensor> staging_buffer;
-    std::string raw_data;
     ffi::Array<Tensor> params;
+    int64_t total_bytes = 0, loaded_bytes = 0;
+    // The records of each shard left to load, after binding the shared parameters.
+    std::vector<TensorCacheMetadata::FileRecord> to_load;
+    std::vector<std::pair<std::string, int64_t>> files;
     for (const TensorCacheMetadata::FileRecord& shard_rec : metadata.records) {
+      TensorCacheMetadata::FileRecord rec = shard_rec;
+      rec.records.clear();
+      for (const TensorCacheMetadata::FileRecord::ParamRecord& param_rec : shard_rec.records) {
+        if (!BindShared(name_prefix + param_rec.name, SharedKey(param_rec, device))) {
+          rec.records.push_back(param_rec);
+        }
+      }
+      if (!rec.records.empty()) {
+        files.emplace_back(cache_path + "/" + shard_rec.data_path, shard_rec.nbytes);
+      }
+      to_load.push_back(std::move(rec));
+      total_bytes += shard_rec.nbytes;
+    }
+    // The CPU parameters are views over the mapped files. For other devices, the files are
+    // read ahead by a pool of threads, overlapping with the uploads on a dedicated stream.
+    std::unique_ptr<ShardPrefetcher> prefetcher;
+    TVMStreamHandle stream = nullptr;
+    if (device.device_type != kDLCPU) {
+      prefetcher = std::make_unique<ShardPrefetcher>(files, kNumReadThreads, kMaxInflightBytes);
+      stream = DeviceAPI::Get(device)->CreateStream(device);
+    }
+    int file_index = 0;
+    for (const TensorCacheMetadata::FileRecord& shard_rec : to_load) {
+      if (shard_rec.records.empty()) {
+        loaded_bytes += shard_rec.nbytes;
+        if (progress.has_value()) {
+          (*progress)(loaded_bytes, total_bytes);
+        }
+        continue;
+      }
       try {
-        params = shard_rec.Load(device, cache_path, &raw_data, &staging_buffer);
+        if (prefetcher != nullptr) {
+          std::string raw_data = prefetcher->Take(file_index++);
+          params = shard_rec.LoadFromBytes(device, raw_data, &staging_buffer, stream);
+        } else {
+          params = shard_rec.LoadMapped(device, cache_path, &staging_buffer);
+        }
       } catch (const std::runtime_error& e) {
+        if (stream != nullptr) DeviceAPI::Get(device)->FreeStream(device, stream);
         TVM_FFI_THROW(ValueError) << "Error when loading parameters from " << shard_rec.data_path
                                   << ": " << e.what();
       }
       int num_params = params.size();
       for (int i = 0; i < num_params; ++i) {
-        Update(shard_rec.records[i].name, params[i], true);
+        const TensorCacheMetadata::FileRecord::ParamRecord& param_rec = shard_rec.records[i];
+        Update(name_prefix + param_rec.name, params[i], true);
+        RegisterShared(name_prefix + param_rec.name, SharedKey(param_rec, device), params[i]);
+      }
+      loaded_bytes += shard_rec.nbytes;
+      if (progress.has_value()) {
+        (*progress)(loaded_bytes, total_bytes);
       }
     }
+    if (stream != nullptr) {
+      DeviceAPI::Get(device)->FreeStream(device, stream);
+    }
   }
 
  private:
+  /*! \brief A tensor shared by the parameters of the same content. */
+  struct SharedTensor {
+    Tensor tensor;
+    /*! \brief The number of names bound to the tensor */
+    int64_t num_refs = 0;
+  };
+
+  /*! \brief The key of a parameter shared by its content on a device, empty if it has no hash. */
+  static std::string SharedKey(const TensorCacheMetadata::FileRecord::ParamRecord& rec,
+                               Device device) {
+    if (rec.content_hash.empty()) return "";
+    std::ostringstream os;
+    os << rec.content_hash << ';' << rec.format << ';' << ffi::DLDataTypeToString(rec.dtype);
+    for (int64_t dim : rec.shape) {
+      os << ';' << dim;
+    }
+    os << ';' << static_cast<int>(device.device_type) << ':' << device.device_id;
+    return os.str();
+  }
+
+  /*! \brief Bind a name to the loaded tensor of a key, returns false if there is none. */
+  static bool BindShared(const ffi::String& name, const std::string& key) {
+    if (key.empty()) return false;
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    auto it = pool->shared_.find(key);
+    if (it == pool->shared_.end()) return false;
+    // Hold the tensor first, in case the name is its last reference.
+    Tensor tensor = it->second.tensor;
+    pool->Untrack(name);
+    pool->ReleaseShared(name);
+    pool->pool_.Set(name, tensor);
+    pool->shared_[key].num_refs += 1;
+    pool->name2shared_[name] = key;
+    return true;
+  }
+
+  /*! \brief Register a loaded tensor to be shared by the key. */
+  static void RegisterShared(const ffi::String& name, const std::string& key, Tensor tensor) {
+    if (key.empty()) return;
+    TensorCache* pool = Global();
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    SharedTensor& shared = pool->shared_[key];
+    if (shared.num_refs == 0) {
+      shared.tensor = tensor;
+    } else {
+      // A duplicate loaded in the same call, keep the first copy only.
+      pool->pool_.Set(name, shared.tensor);
+    }
+    shared.num_refs += 1;
+    pool->name2shared_[name] = key;
+  }
+
+  /*! \brief Unbind a name from its shared tensor, which is dropped with its last name. */
+  void ReleaseShared(const ffi::String& name) {
+    auto it = name2shared_.find(name);
+    if (it == name2shared_.end()) return;
+    auto shared_it = shared_.find(it->second);
+    if (shared_it != shared_.end() && --shared_it->second.num_refs == 0) {
+      shared_.erase(shared_it);
+    }
+    name2shared_.erase(it);
+  }
+
+  /*! \brief A parameter that is loaded from its shard on first access. */
+  struct LazyParam {
+    /*! \brief The metadata owning the records */
+    std::shared_ptr<TensorCacheMetadata> metadata;
+    const TensorCacheMetadata::FileRecord* file;
+    const TensorCacheMetadata::FileRecord::ParamRecord* param;
+    Device device;
+  };
+
+  /*! \brief Load a lazy parameter from its mapped shard, then evict to fit the budget. */
+  Tensor Materialize(const ffi::String& name, const LazyParam& lazy) {
+    std::string path = lazy.metadata->path + "/" + lazy.file->data_path;
+    std::shared_ptr<MappedFile>& file = mapped_files_[path];
+    if (file == nullptr) {
+      file = MappedFile::Open(path);
+    }
+    Tensor arr;
+    if (file == nullptr) {
+      // mapping is not supported, read the whole shard
+      std::string raw_data;
+      LoadBinaryFromFile(path, &raw_data);
+      CheckShard(*lazy.file, raw_data.length());
+      arr = LoadRecordFromBytes(*lazy.param, lazy.device, raw_data.data(), nullptr, nullptr);
+    } else {
+      CheckShard(*lazy.file, file->size());
+      if (lazy.device.device_type == kDLCPU && !IsBF16Encoded(*lazy.param) &&
+          lazy.param->byte_offset % kAllocAlignment == 0) {
+        arr = ViewMappedParam(*lazy.param, lazy.device, file);
+      } else {
+        arr = LoadRecordFromBytes(*lazy.param, lazy.device, file->data(), nullptr, nullptr);
+      }
+    }
+    ++num_faults_;
+    pool_.Set(name, arr);
+    lru_.push_front(name);
+    lru_pos_[name] = lru_.begin();
+    lazy_resident_bytes_ += ffi::GetDataSize(*(arr.operator->()));
+    // The tensors still used elsewhere stay alive after their eviction from the cache.
+    while (lazy_budget_bytes_ > 0 && lazy_resident_bytes_ > lazy_budget_bytes_ &&
+           lru_.size() > 1) {
+      ffi::String victim = lru_.back();
+      Untrack(victim);
+      pool_.erase(victim);
+      ++num_evictions_;
+    }
+    return arr;
+  }
+
+  /*! \brief Stop tracking a lazily loaded parameter in the LRU list. */
+  void Untrack(const ffi::String& name) {
+    auto it = lru_pos_.find(name);
+    if (it == lru_pos_.end()) return;
+    auto pool_it = pool_.find(name);
+    if (pool_it != pool_.end()) {
+      lazy_resident_bytes_ -= ffi::GetDataSize(*((*pool_it).second.operator->()));
+    }
+    lru_.erase(it->second);
+    lru_pos_.erase(it);
+  }
+
   ffi::Map<ffi::String, Tensor> pool_;
+  /*! \brief The parameters registered to be loaded on first access */
+  std::unordered_map<std::string, LazyParam> lazy_params_;
+  /*! \brief The mapped shards of the lazy parameters */
+  std::unordered_map<std::string, std::shared_ptr<MappedFile>> mapped_files_;
+  /*! \brief The resident lazily loaded parameters, the most recently used first */
+  std::list<ffi::String> lru_;
+  std::unordered_map<std::string, std::list<ffi::String>::iterator> lru_pos_;
+  /*! \brief The total size of the resident lazily loaded parameters */
+  int64_t lazy_resident_bytes_ = 0;
+  /*! \brief The budget of lazy_resident_bytes_, 0 means unlimited */
+  int64_t lazy_budget_bytes_ = 0;
+  int64_t num_faults_ = 0;
+  int64_t num_evictions_ = 0;
+  /*! \brief The tensors shared by their content, by their key */
+  std::unordered_map<std::string, SharedTensor> shared_;
+  /*! \brief The key of the shared tensor of each name */
+  std::unordered_map<std::string, std::string> name2shared_;
+  std::mutex mutex_;
 };
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -283,7 +843,23 @@ TVM_FFI_STATIC_INIT_BLOCK() {
                   })
       .def("vm.builtin.tensor_cache.remove", TensorCache::Remove)
       .def("vm.builtin.tensor_cache.clear", TensorCache::Clear)
-      .def("vm.builtin.tensor_cache.load", TensorCache::Load);
+      .def("vm.builtin.tensor_cache.load",
+           [](const std::string& cache_path, int device_type, int device_id) {
+             TensorCache::Load(cache_path, device_type, device_id);
+           })
+      .def("vm.builtin.tensor_cache.load_with_progress",
+           [](const std::string& cache_path, int device_type, int device_id,
+              ffi::Optional<ffi::Function> progress) {
+             TensorCache::Load(cache_path, device_type, device_id, progress);
+           })
+      .def("vm.builtin.tensor_cache.load_with_prefix",
+           [](const std::string& cache_path, int device_type, int device_id,
+              const std::string& name_prefix) {
+             TensorCache::Load(cache_path, device_type, device_id, std::nullopt, name_prefix);
+           })
+      .def("vm.builtin.tensor_cache.shared_stats", TensorCache::SharedStats)
+      .def("vm.builtin.tensor_cache.load_lazy", TensorCache::LoadLazy)
+      .def("vm.builtin.tensor_cache.lazy_stats", TensorCache::LazyStats);
 }
 
 // This param module node can be useful to get param dict in RPC mode
@@ -29,9 +29,12 @@
 #include <tvm/runtime/vm/vm.h>
 #include <tvm/support/cuda/nvtx.h>
 
+#include <algorithm>
+#include <memory>
 #include <thread>
 
 #include "./module_utils.h"
+#include "./vm_profiler.h"
 
 namespace tvm {
 namespace runtime {
@@ -145,6 +148,52 @@ ffi::Any ConvertRegToDevice(ffi::Any input, Device dev, Allocator* alloc,
   return ret;
 }
 
+/*! \brief Check that an input adopted without a copy lives on the device of the VM. */
+void CheckAdoptedOnDevice(const DLTensor* tensor, const Device& dev) {
+  TVM_FFI_CHECK(tensor->device.device_type == dev.device_type &&
+                    tensor->device.device_id == dev.device_id,
+                ValueError)
+      << "An input on " << tensor->device << " can not be adopted without a copy by a VM on "
+      << dev << ", use `set_input` to copy it";
+}
+
+Any AdoptObjectOnDevice(Any src, const Device& dev) {
+  if (auto opt_tensor = src.as<Tensor>()) {
+    CheckAdoptedOnDevice(opt_tensor.value().operator->(), dev);
+    return src;
+  } else if (src.as<ffi::ArrayObj>()) {
+    std::vector<Any> ret;
+    auto arr = src.cast<ffi::Array<Any>>();
+    for (size_t i = 0; i < arr.size(); i++) {
+      ret.push_back(AdoptObjectOnDevice(arr[i], dev));
+    }
+    return ffi::Array<Any>(ret.begin(), ret.end());
+  } else {
+    return src;
+  }
+}
+
+/*!
+ * \brief Adopt an input of the VM without copying it, the zero-copy variant of
+ *  ConvertArgToDevice. A DLTensor is wrapped in a view of its buffer, which the caller keeps
+ *  alive until the inputs are set again.
+ */
+ffi::Any AdoptArgOnDevice(ffi::AnyView input, Device dev) {
+  if (auto opt_obj = input.as<ffi::ObjectRef>()) {
+    return AdoptObjectOnDevice(opt_obj.value(), dev);
+  } else if (auto opt_dltensor = input.as<DLTensor*>()) {
+    DLTensor* tensor = opt_dltensor.value();
+    CheckAdoptedOnDevice(tensor, dev);
+    TVM_FFI_CHECK(ffi::IsContiguous(*tensor), ValueError)
+        << "A strided input can not be adopted without a copy, use `set_input` to copy it";
+    void* data = static_cast<char*>(tensor->data) + tensor->byte_offset;
+    return Tensor::FromExternalBuffer(data, ffi::Shape(tensor->shape, tensor->shape + tensor->ndim),
+                                      tensor->dtype, tensor->device);
+  } else {
+    return input;
+  }
+}
+
 //-----------------------------------------------------------
 // VM implementations.
 //-----------------------------------------------------------
@@ -169,6 +218,8 @@ struct VMFrame {
   RegName caller_return_register;
   /*! \brief Temporary argument tcode stack for packed func call. */
   std::vector<ffi::AnyView> call_args;
+  /*! \brief Temporary argument stack for direct kernel calls. */
+  std::vector<void*> direct_args;
 
   VMFrame(Index pc, Index register_file_size)
       : return_pc(pc), register_file(register_file_size), caller_return_register(0) {}
@@ -176,6 +227,7 @@ struct VMFrame {
   void Clear() {
     this->caller_return_register = 0;
     this->call_args.clear();
+    this->direct_args.clear();
     for (RegType& reg : register_file) {
       reg = nullptr;
     }
@@ -187,6 +239,67 @@ struct VMFrame {
   }
 };
 
+/*!
+ * \brief The direct C entry of a host kernel, which receives the data pointer of each tensor
+ *  argument and the value of each integer argument.
+ */
+using DirectKernelFunc = int32_t (*)(void* const* args);
+
+// The kernel reads every slot of the direct arguments as an int64.
+static_assert(sizeof(void*) == sizeof(int64_t), "Direct kernel calls require 64-bit pointers");
+
+/*! \brief Convert a call argument to its slot in the arguments of a direct kernel entry. */
+inline void* DirectKernelArg(ffi::AnyView value) {
+  if (auto opt_tensor = value.as<DLTensor*>()) {
+    DLTensor* tensor = opt_tensor.value();
+    return static_cast<char*>(tensor->data) + tensor->byte_offset;
+  }
+  return reinterpret_cast<void*>(static_cast<intptr_t>(value.cast<int64_t>()));
+}
+
+/*!
+ * \brief An instruction decoded when the VM is initialized, so that the
+ * dispatch loop does not decode the bytecode or resolve callees again.
+ */
+struct DecodedInstruction {
+  /*! \brief The instruction itself. */
+  Instruction instr;
+  /*! \brief The callee of a call instruction when it is a VM closure. */
+  const VMClosureObj* closure = nullptr;
+  /*! \brief The callee of a call instruction when it is a packed function. */
+  const ffi::Function::ContainerType* packed = nullptr;
+  /*! \brief The callee of a call instruction when it is a direct kernel entry. */
+  DirectKernelFunc direct = nullptr;
+  /*!
+   * \brief The number of consecutive call instructions starting from this one,
+   * which are dispatched together as one superinstruction.
+   */
+  Index call_run_length = 0;
+};
+
+/*!
+ * \brief The state of an executable loaded on the devices of a VM: the constants copied to
+ *  the devices, the resolved function pool and the decoded instructions.
+ *
+ * It is built once by Init and never modified afterwards, so the contexts created by
+ * CreateContext share it across threads without locking. Each context keeps its own frames,
+ * inputs and outputs, and is confined to one thread at a time.
+ */
+struct VMLoadedProgram {
+  /*! \brief The global constant pool */
+  std::vector<ffi::Any> const_pool;
+  /*!
+   * \brief Function pool to cache functions in func_table
+   */
+  std::vector<ffi::Any> func_pool;
+  /*! \brief The direct entries of the kernels in func_table, or nullptr for other functions. */
+  std::vector<DirectKernelFunc> direct_funcs;
+  /*! \brief The decoded instructions, indexed by the program counter. */
+  std::vector<DecodedInstruction> decoded_instrs;
+  /*! \brief The maximum size of the argument stack of call instructions. */
+  Index max_num_call_args{0};
+};
+
 class VirtualMachineImpl : public VirtualMachine {
  public:
   //---------------------------------------------------
@@ -201,6 +314,7 @@ class VirtualMachineImpl : public VirtualMachine {
   void InvokeClosurePacked(const ffi::ObjectRef& closure_or_packedfunc, ffi::PackedArgs args,
                            ffi::Any* rv) final;
   void SetInstrument(ffi::Function instrument) final { this->instrument_ = instrument; }
+  ffi::ObjectPtr<VirtualMachine> CreateContext() final;
 
   //---------------------------------------------------
   // Functions in the vtable of Module
@@ -210,13 +324,20 @@ class VirtualMachineImpl : public VirtualMachine {
   void _InvokeClosure(ffi::PackedArgs args, ffi::Any* rv);
   void _InvokeClosureStateful(std::string func_name);
   void _SetInstrument(ffi::PackedArgs args, ffi::Any* rv);
+  void _ProfilerStart();
+  void _ProfilerStop();
+  std::string _ProfilerReport();
+  std::string _ProfilerChromeTrace();
   void _GetOutputArity(ffi::PackedArgs args, ffi::Any* rv);
   void _GetOutput(ffi::PackedArgs args, ffi::Any* rv);
   void _SetInputWithoutParamModule(ffi::PackedArgs args, ffi::Any* rv);
   void _SetInputWithParamModule(ffi::PackedArgs args, ffi::Any* rv);
+  void _SetInputZeroCopy(ffi::PackedArgs args, ffi::Any* rv);
+  void _SetOutputBuffers(ffi::PackedArgs args, ffi::Any* rv);
   int _GetFunctionArity(std::string func_name);
   std::string _GetFunctionParamName(std::string func_name, int index);
   ffi::Function _LookupFunction(const ffi::String& name);
+  ffi::Module _CreateContext();
 
   TVM_MODULE_VTABLE_BEGIN("relax.VirtualMachine");
   TVM_MODULE_VTABLE_ENTRY_PACKED("vm_initialization", &VirtualMachineImpl::_Init);
@@ -224,13 +345,20 @@ class VirtualMachineImpl : public VirtualMachine {
   TVM_MODULE_VTABLE_ENTRY_PACKED("invoke_closure", &VirtualMachineImpl::_InvokeClosure);
   TVM_MODULE_VTABLE_ENTRY("invoke_stateful", &VirtualMachineImpl::_InvokeClosureStateful);
   TVM_MODULE_VTABLE_ENTRY_PACKED("set_instrument", &VirtualMachineImpl::_SetInstrument);
+  TVM_MODULE_VTABLE_ENTRY("profiler_start", &VirtualMachineImpl::_ProfilerStart);
+  TVM_MODULE_VTABLE_ENTRY("profiler_stop", &VirtualMachineImpl::_ProfilerStop);
+  TVM_MODULE_VTABLE_ENTRY("profiler_report", &VirtualMachineImpl::_ProfilerReport);
+  TVM_MODULE_VTABLE_ENTRY("profiler_chrome_trace", &VirtualMachineImpl::_ProfilerChromeTrace);
   TVM_MODULE_VTABLE_ENTRY_PACKED("get_output_arity", &VirtualMachineImpl::_GetOutputArity);
   TVM_MODULE_VTABLE_ENTRY_PACKED("get_output", &VirtualMachineImpl::_GetOutput);
   TVM_MODULE_VTABLE_ENTRY_PACKED("set_input", &VirtualMachineImpl::_SetInputWithoutParamModule);
   TVM_MODULE_VTABLE_ENTRY_PACKED("set_input_with_param_module",
                                  &VirtualMachineImpl::_SetInputWithParamModule);
+  TVM_MODULE_VTABLE_ENTRY_PACKED("set_input_zero_copy", &VirtualMachineImpl::_SetInputZeroCopy);
+  TVM_MODULE_VTABLE_ENTRY_PACKED("set_output_buffers", &VirtualMachineImpl::_SetOutputBuffers);
   TVM_MODULE_VTABLE_ENTRY("get_function_arity", &VirtualMachineImpl::_GetFunctionArity);
   TVM_MODULE_VTABLE_ENTRY("get_function_param_name", &VirtualMachineImpl::_GetFunctionParamName);
+  TVM_MODULE_VTABLE_ENTRY("create_context", &VirtualMachineImpl::_CreateContext);
   TVM_MODULE_VTABLE_END_WITH_DEFAULT(&VirtualMachineImpl::_LookupFunction);
 
   //--------------------------------------------------
@@ -254,8 +382,19 @@ class VirtualMachineImpl : public VirtualMachine {
    * objects. \note This interface works when using VM over RPC by internally converting Tensor in
    * the arguments to DLTensor, which is supported in RPC where remote could only have a minimal C
    * runtime.
+   * \param zero_copy If set to true, the tensors are adopted without a copy and must already be
+   *        on the device of the function.
    */
-  void SetInput(std::string func_name, bool with_param_module, ffi::PackedArgs args);
+  void SetInput(std::string func_name, bool with_param_module, ffi::PackedArgs args,
+                bool zero_copy = false);
+
+  /*!
+   * \brief Write the result of a stateful call into the output buffers bound to the function.
+   * \param result The result of the call.
+   * \param buffers The bound output buffers, one per tensor of the result.
+   * \return The result, with its tensors replaced by the bound buffers.
+   */
+  RegType WriteOutputBuffers(RegType result, const std::vector<Tensor>& buffers, size_t* index);
 
   /*!
    * \brief Look up whether the VM has a function by the given name.
@@ -298,7 +437,7 @@ class VirtualMachineImpl : public VirtualMachine {
    * \param args The arguments to the function.
    * \return The object representing the result.
    */
-  RegType InvokeBytecode(Index fidx, const std::vector<RegType>& args);
+  RegType InvokeBytecode(Index fidx, ffi::PackedArgs args);
 
  protected:
   /*!
@@ -316,8 +455,14 @@ class VirtualMachineImpl : public VirtualMachine {
   }
   /*!
    * \brief Initialize function pool.
+   * \param program The program being loaded.
+   */
+  void InitFuncPool(VMLoadedProgram* program);
+  /*!
+   * \brief Decode the bytecode of the executable into threaded code.
+   * \param program The program being loaded, whose function pool is initialized.
    */
-  void InitFuncPool();
+  void DecodeInstructions(VMLoadedProgram* program);
 
   /*!
    * \brief A RAII wrapper that pushes and pops VM frames.
@@ -336,6 +481,31 @@ class VirtualMachineImpl : public VirtualMachine {
       vm->frames_.pop_back();
     }
   };
+  /*!
+   * \brief A RAII wrapper that takes a register file for a compiled VM function
+   * from the pool, and returns it to the pool with all registers cleared.
+   */
+  class TIRRegisterFileGuard {
+   public:
+    VirtualMachineImpl* vm;
+    std::unique_ptr<std::vector<ffi::Any>> reg_file;
+    explicit TIRRegisterFileGuard(VirtualMachineImpl* vm, Index register_file_size) : vm(vm) {
+      if (!vm->tir_reg_file_free_list_.empty()) {
+        reg_file = std::move(vm->tir_reg_file_free_list_.back());
+        vm->tir_reg_file_free_list_.pop_back();
+      } else {
+        reg_file = std::make_unique<std::vector<ffi::Any>>();
+        reg_file->reserve(vm->max_register_file_size_);
+      }
+      reg_file->resize(register_file_size);
+    }
+    ~TIRRegisterFileGuard() {
+      for (ffi::Any& reg : *reg_file) {
+        reg = nullptr;
+      }
+      vm->tir_reg_file_free_list_.emplace_back(std::move(reg_file));
+    }
+  };
   //-------------------------------------------------
   // Instruction interpretations.
   //-------------------------------------------------
@@ -353,6 +523,10 @@ class VirtualMachineImpl : public VirtualMachine {
       new_frame->ResetForRecycle(ret_pc, vm_func.register_file_size);
     } else {
       new_frame = std::make_unique<VMFrame>(ret_pc, vm_func.register_file_size);
+      // Size the register file for every function, so that recycling the frame never reallocates.
+      new_frame->register_file.reserve(max_register_file_size_);
+      new_frame->call_args.reserve(program_->max_num_call_args);
+      new_frame->direct_args.reserve(program_->max_num_call_args);
     }
     return FrameGuard(this, std::move(new_frame));
   }
@@ -366,27 +540,26 @@ class VirtualMachineImpl : public VirtualMachine {
     TVM_FFI_ICHECK_LT(reg, frame->register_file.size());
     frame->register_file[reg] = obj;
   }
+  /*! \brief Move an object into a VM register, which saves the reference counting. */
+  TVM_FFI_INLINE void WriteRegister(VMFrame* frame, RegName reg, RegType&& obj) {
+    TVM_FFI_ICHECK_LT(reg, frame->register_file.size());
+    frame->register_file[reg] = std::move(obj);
+  }
   /*!
    * \brief Read a VM register.
    * \param frame current vm frame.
    * \param reg The register to read from.
-   * \return The value of the register.
+   * \return The value of the register, which stays valid until the register is written.
    */
-  TVM_FFI_INLINE RegType ReadRegister(VMFrame* frame, RegName reg) {
+  TVM_FFI_INLINE const RegType& ReadRegister(VMFrame* frame, RegName reg) {
     if (reg < Instruction::kBeginSpecialReg) {
       return frame->register_file[reg];
     }
-    RegType ret;
     if (reg == Instruction::kVoidRegister) {
-      ret = nullptr;
-    } else {
-      TVM_FFI_ICHECK_EQ(reg, Instruction::kVMRegister);
-      // per convention, ctx ptr must be VirtualMachine* casted to void.
-      // this and VirtualMachine* may or may not be the same
-      // do first cast to VirtualMachine* then to void*
-      ret = static_cast<void*>(static_cast<VirtualMachine*>(this));
+      return void_register_;
     }
-    return ret;
+    TVM_FFI_ICHECK_EQ(reg, Instruction::kVMRegister);
+    return vm_register_;
   }
   /*!
    * \brief Run call instruction.
@@ -394,6 +567,14 @@ class VirtualMachineImpl : public VirtualMachine {
    * \param inst The call instruction.
    */
   virtual void RunInstrCall(VMFrame* curr_frame, Instruction inst);
+  /*!
+   * \brief Run call instruction whose callee is a direct kernel entry, which passes the
+   *  arguments as raw pointers and values instead of boxing them.
+   * \param curr_frame The current frame.
+   * \param inst The call instruction.
+   * \param direct The direct entry of the callee.
+   */
+  void RunInstrDirectCall(VMFrame* curr_frame, const Instruction& inst, DirectKernelFunc direct);
 
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
@@ -421,12 +602,8 @@ class VirtualMachineImpl : public VirtualMachine {
   //--------------------------------------------------------
   /*! \brief The loaded executable. */
   ffi::ObjectPtr<VMExecutable> exec_;
-  /*! \brief The global constant pool */
-  std::vector<ffi::Any> const_pool_;
-  /*!
-   * \brief Function pool to cache functions in func_table
-   */
-  std::vector<ffi::Any> func_pool_;
+  /*! \brief The loaded program, shared with the contexts created from the VM. */
+  std::shared_ptr<const VMLoadedProgram> program_;
   //--------------------------------------------------------
   // Executor interface support
   //--------------------------------------------------------
@@ -434,6 +611,8 @@ class VirtualMachineImpl : public VirtualMachine {
   std::unordered_map<std::string, std::vector<RegType>> inputs_;
   /*! \brief The function name to output register. */
   std::unordered_map<std::string, RegType> outputs_;
+  /*! \brief The function name to the output buffers bound by `set_output_buffers`. */
+  std::unordered_map<std::string, std::vector<Tensor>> output_buffers_;
   /*! \brief A store of closures created by `save_function`. */
   std::unordered_map<std::string, VMClosure> saved_closures_;
   //------------------------------------------------------------
@@ -448,18 +627,41 @@ class VirtualMachineImpl : public VirtualMachine {
    * \brief A free list of frame
    */
   std::vector<std::unique_ptr<VMFrame>> frame_free_list_;
+  /*!
+   * \brief A free list of the register files of compiled VM functions.
+   * \note Use unique ptr so that a register file in use is not moved when the list grows.
+   */
+  std::vector<std::unique_ptr<std::vector<ffi::Any>>> tir_reg_file_free_list_;
 
   /*! \brief The virtual machine PC. */
   Index pc_{0};
   /*! \brief The special return register. */
   RegType return_value_;
+  /*! \brief The value of the special void register. */
+  const RegType void_register_ = nullptr;
+  /*!
+   * \brief The value of the special VM register.
+   * Per convention, ctx ptr must be VirtualMachine* casted to void.
+   * this and VirtualMachine* may or may not be the same
+   * do first cast to VirtualMachine* then to void*
+   */
+  const RegType vm_register_ = static_cast<void*>(static_cast<VirtualMachine*>(this));
+  /*! \brief The maximum register file size of the VM functions in the executable. */
+  Index max_register_file_size_{0};
   /*!\ brief instrument function. */
   ffi::Function instrument_ = nullptr;
+  /*! \brief The profiler of the last profiling session, kept after it stops for the reports. */
+  std::unique_ptr<VMProfiler> profiler_;
+  /*! \brief Whether the packed function calls are being profiled. */
+  bool profiling_{false};
 };
 
 void VirtualMachineImpl::LoadExecutable(ffi::ObjectPtr<VMExecutable> exec) {
   this->exec_ = exec;
   this->imports_ = exec->imports();
+  for (const VMFuncInfo& finfo : exec->func_table) {
+    max_register_file_size_ = std::max(max_register_file_size_, finfo.register_file_size);
+  }
 }
 
 void VirtualMachineImpl::Init(const std::vector<Device>& devices,
@@ -473,18 +675,34 @@ void VirtualMachineImpl::Init(const std::vector<Device>& devices,
     this->devices.push_back(devices[i]);
     this->allocators.push_back(alloc);
   }
+  auto program = std::make_shared<VMLoadedProgram>();
   // Setup constant sections.
-  this->const_pool_.reserve(exec_->constants.size());
+  program->const_pool.reserve(exec_->constants.size());
   for (size_t i = 0; i < exec_->constants.size(); ++i) {
     if (auto opt_nd = exec_->constants[i].as<Tensor>()) {
-      this->const_pool_.push_back(
+      program->const_pool.push_back(
           ConvertRegToDevice(opt_nd.value(), devices[0], allocators[0], exec_->memory_scopes[i]));
     } else {
-      this->const_pool_.push_back(exec_->constants[i]);
+      program->const_pool.push_back(exec_->constants[i]);
     }
   }
   // Setup function sections.
-  this->InitFuncPool();
+  this->InitFuncPool(program.get());
+  this->DecodeInstructions(program.get());
+  this->program_ = std::move(program);
+}
+
+ffi::ObjectPtr<VirtualMachine> VirtualMachineImpl::CreateContext() {
+  TVM_FFI_CHECK(program_ != nullptr, RuntimeError)
+      << "The VM must be initialized before creating contexts from it";
+  auto ctx = ffi::make_object<VirtualMachineImpl>();
+  ctx->exec_ = exec_;
+  ctx->imports_ = imports_;
+  ctx->devices = devices;
+  ctx->allocators = allocators;
+  ctx->program_ = program_;
+  ctx->max_register_file_size_ = max_register_file_size_;
+  return ctx;
 }
 
 VMFuncInfo VirtualMachineImpl::LookupVMFuncInfo(const std::string& func_name) {
@@ -504,19 +722,24 @@ RegType VirtualMachineImpl::LookupVMOutput(const std::string& func_name) {
 }
 
 void VirtualMachineImpl::SetInput(std::string func_name, bool with_param_module,
-                                  ffi::PackedArgs args) {
+                                  ffi::PackedArgs args, bool zero_copy) {
   const auto& m = exec_->func_map;
   if (m.find(func_name) != m.end()) {
     Index gf_idx = m.at(func_name);
     const VMFuncInfo& vm_func = exec_->func_table[gf_idx];
     size_t params_num = vm_func.num_args;
-    TVM_FFI_ICHECK_EQ(args.size(), params_num)
+    // The output parameters may be left to the buffers bound with `set_output_buffers`.
+    size_t num_output_params = vm_func.NumOutputParams();
+    TVM_FFI_ICHECK(static_cast<size_t>(args.size()) == params_num ||
+                   static_cast<size_t>(args.size()) == params_num - num_output_params)
         << "The number of provided parameters doesn't match the number of arguments for";
-    std::vector<RegType> func_args(params_num);
+    std::vector<RegType> func_args(args.size());
     for (int i = 0; i < args.size(); ++i) {
       if (with_param_module && i == args.size() - 1) {
         // call param func to get the arguments(usually corresponds to param pack.)
         func_args[i] = (args[i].cast<ffi::Module>())->GetFunction("get_params").value()();
+      } else if (zero_copy) {
+        func_args[i] = AdoptArgOnDevice(args[i], devices[0]);
       } else {
         func_args[i] = ConvertArgToDevice(args[i], devices[0], allocators[0]);
       }
@@ -617,12 +840,7 @@ ffi::Optional<VMClosure> VirtualMachineImpl::GetClosureInternal(const ffi::Strin
     auto impl = ffi::Function([gf_idx](ffi::PackedArgs args, ffi::Any* rv) {
       // Per convention, ctx ptr is a VirtualMachine*
       VirtualMachine* ctx_ptr = static_cast<VirtualMachine*>(args[0].cast<void*>());
-
-      std::vector<RegType> inputs(args.size() - 1);
-      for (size_t i = 0; i < inputs.size(); ++i) {
-        inputs[i] = args[i + 1];
-      }
-      *rv = static_cast<VirtualMachineImpl*>(ctx_ptr)->InvokeBytecode(gf_idx, inputs);
+      *rv = static_cast<VirtualMachineImpl*>(ctx_ptr)->InvokeBytecode(gf_idx, args.Slice(1));
     });
     return VMClosure(func_name, impl);
   } else {
@@ -631,24 +849,28 @@ ffi::Optional<VMClosure> VirtualMachineImpl::GetClosureInternal(const ffi::Strin
     ffi::Optional<ffi::Function> tir_func = GetFuncFromImports("__vmtir__" + finfo.name);
     TVM_FFI_ICHECK(tir_func.has_value())
         << "Cannot find underlying compiled tirx function of VMTIRFunc " << finfo.name;
-    auto impl = ffi::Function([this, finfo, tir_func](ffi::PackedArgs args, ffi::Any* rv) {
+    // NOTE: the closure runs on the VM of its ctx ptr, so that the contexts created from this
+    // VM share the function pool holding it.
+    auto impl = ffi::Function([finfo, tir_func](ffi::PackedArgs args, ffi::Any* rv) {
       // Per convention, ctx ptr is a VirtualMachine*
       VirtualMachine* ctx_ptr = static_cast<VirtualMachine*>(args[0].cast<void*>());
-      TVM_FFI_ICHECK(ctx_ptr == this);
+      auto* vm = static_cast<VirtualMachineImpl*>(ctx_ptr);
       TVM_FFI_ICHECK_EQ(args.size() - 1, finfo.num_args)
           << "Function " << finfo.name << " expects " << finfo.num_args << " arguments";
       TVM_FFI_ICHECK_GE(finfo.register_file_size, finfo.num_args + 1);
-      std::vector<ffi::Any> reg_file(finfo.register_file_size);
+      TIRRegisterFileGuard guard(vm, finfo.register_file_size);
+      std::vector<ffi::Any>& reg_file = *guard.reg_file;
       for (int64_t i = 0; i < finfo.num_args; ++i) {
         reg_file[i] = args[i + 1];
       }
       void* reg_anylist_handle = reg_file.data();
-      void* const_anylist_handle = this->const_pool_.data();
-      void* func_anylist_handle = this->func_pool_.data();
+      // The kernels only read the pools, which are shared by the contexts.
+      void* const_anylist_handle = const_cast<ffi::Any*>(vm->program_->const_pool.data());
+      void* func_anylist_handle = const_cast<ffi::Any*>(vm->program_->func_pool.data());
       (*tir_func)(static_cast<void*>(ctx_ptr), reg_anylist_handle, const_anylist_handle,
                   func_anylist_handle);
       // Return value always stored after inputs.
-      *rv = reg_file[finfo.num_args];
+      *rv = std::move(reg_file[finfo.num_args]);
     });
     return VMClosure(func_name, impl);
   }
@@ -657,7 +879,7 @@ ffi::Optional<VMClosure> VirtualMachineImpl::GetClosureInternal(const ffi::Strin
 //--------------------------------------------------------------------
 // Instruction interpretations.
 //--------------------------------------------------------------------
-RegType VirtualMachineImpl::InvokeBytecode(Index gf_idx, const std::vector<RegType>& args) {
+RegType VirtualMachineImpl::InvokeBytecode(Index gf_idx, ffi::PackedArgs args) {
   const VMFuncInfo& gfunc = exec_->func_table[gf_idx];
   TVM_FFI_ICHECK(gfunc.kind == VMFuncInfo::FuncKind::kVMFunc);
 
@@ -671,7 +893,7 @@ RegType VirtualMachineImpl::InvokeBytecode(Index gf_idx, const std::vector<RegTy
   }
 
   // load arguments to the register file
-  TVM_FFI_ICHECK_EQ(static_cast<size_t>(gfunc.num_args), args.size())
+  TVM_FFI_ICHECK_EQ(gfunc.num_args, args.size())
       << "Invoking function " << gfunc.name << " expects " << gfunc.num_args << " arguments" <<
       [&]() {
         std::stringstream ss;
@@ -688,8 +910,8 @@ RegType VirtualMachineImpl::InvokeBytecode(Index gf_idx, const std::vector<RegTy
         return ss.str();
       }()
       << ", but " << args.size() << " arguments were provided.";
-  for (size_t i = 0; i < args.size(); ++i) {
-    WriteRegister(frames_.back().get(), i, args[i]);
+  for (int i = 0; i < args.size(); ++i) {
+    WriteRegister(curr_frame, i, RegType(args[i]));
   }
   // set program counter
   pc_ = gfunc.start_instr;
@@ -697,8 +919,9 @@ RegType VirtualMachineImpl::InvokeBytecode(Index gf_idx, const std::vector<RegTy
   return return_value_;
 }
 
-void VirtualMachineImpl::InitFuncPool() {
-  func_pool_.resize(exec_->func_table.size());
+void VirtualMachineImpl::InitFuncPool(VMLoadedProgram* program) {
+  program->func_pool.resize(exec_->func_table.size());
+  program->direct_funcs.assign(exec_->func_table.size(), nullptr);
 
   for (size_t func_index = 0; func_index < exec_->func_table.size(); ++func_index) {
     const VMFuncInfo& info = exec_->func_table[func_index];
@@ -713,20 +936,72 @@ void VirtualMachineImpl::InitFuncPool() {
           << "Error: Cannot find ffi::Function " << info.name
           << " in either Relax VM kernel library, or in TVM runtime ffi::Function registry, or in "
              "global Relax functions of the VM executable";
-      func_pool_[func_index] = *func;
-
+      program->func_pool[func_index] = *func;
+
+    } else if (info.kind == VMFuncInfo::FuncKind::kDirectFunc) {
+      ffi::Optional<ffi::Function> get_address = GetFuncFromImports(info.name);
+      TVM_FFI_ICHECK(get_address.has_value())
+          << "Error: Cannot find the direct entry of kernel " << info.name
+          << " in the Relax VM kernel library";
+      auto direct = reinterpret_cast<DirectKernelFunc>((*get_address)().cast<void*>());
+      program->direct_funcs[func_index] = direct;
+      // The packed form of the kernel for the instrument, the profiler and closure calls. It
+      // keeps the kernel library alive through the address getter.
+      auto packed = [direct, get_address](ffi::PackedArgs args, ffi::Any* rv) {
+        std::vector<void*> direct_args(args.size());
+        for (int i = 0; i < args.size(); ++i) {
+          direct_args[i] = DirectKernelArg(args[i]);
+        }
+        TVM_FFI_CHECK_SAFE_CALL((*direct)(direct_args.data()));
+      };
+      program->func_pool[func_index] = ffi::Function(packed);
     } else {
       TVM_FFI_ICHECK(info.kind == VMFuncInfo::FuncKind::kVMFunc ||
                      info.kind == VMFuncInfo::FuncKind::kVMTIRFunc);
       auto clo = this->GetClosure(info.name);
-      func_pool_[func_index] = clo;
+      program->func_pool[func_index] = clo;
     }
   }
 }
 
+void VirtualMachineImpl::DecodeInstructions(VMLoadedProgram* program) {
+  std::vector<DecodedInstruction>& decoded_instrs = program->decoded_instrs;
+  Index num_instrs = static_cast<Index>(exec_->instr_offset.size());
+  decoded_instrs.resize(num_instrs);
+  // Reserve the leading slots used by the instrument.
+  program->max_num_call_args = 4;
+  for (Index pc = num_instrs - 1; pc >= 0; --pc) {
+    DecodedInstruction& decoded = decoded_instrs[pc];
+    decoded.instr = exec_->GetInstruction(pc);
+    if (decoded.instr.op != Opcode::Call) {
+      continue;
+    }
+    TVM_FFI_ICHECK_LT(static_cast<size_t>(decoded.instr.func_idx), program->func_pool.size());
+    const ffi::Any& func = program->func_pool[decoded.instr.func_idx];
+    decoded.closure = func.as<VMClosureObj>();
+    decoded.packed = func.as<ffi::Function::ContainerType>();
+    decoded.direct = program->direct_funcs[decoded.instr.func_idx];
+    decoded.call_run_length =
+        pc + 1 < num_instrs && decoded_instrs[pc + 1].instr.op == Opcode::Call
+            ? decoded_instrs[pc + 1].call_run_length + 1
+            : 1;
+    program->max_num_call_args =
+        std::max(program->max_num_call_args, decoded.instr.num_args + 4);
+  }
+}
+
 void VirtualMachineImpl::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
   DLOG(INFO) << "\n  pc = " << pc_ << ", execute: " << GetFuncName(instr.func_idx);
-  int args_begin_offset = instrument_ != nullptr ? 4 : 0;
+  // The instrument and the profiler observe the packed form of direct kernels.
+  if (instrument_ == nullptr && !profiling_) {
+    if (DirectKernelFunc direct = program_->decoded_instrs[pc_].direct) {
+      this->RunInstrDirectCall(curr_frame, instr, direct);
+      return;
+    }
+  }
+  // Without instrument, the slot ahead of the arguments is reserved for the ctx ptr
+  // of closure calls, so that the arguments are passed to closures without copy.
+  int args_begin_offset = instrument_ != nullptr ? 4 : 1;
   // Use the call arg stack from the current frame to increase reuse
   // and avoid re-allocation
   curr_frame->call_args.resize(args_begin_offset + instr.num_args);
@@ -748,12 +1023,12 @@ void VirtualMachineImpl::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
         break;
       }
       case Instruction::ArgKind::kConstIdx: {
-        call_args[arg_index] = this->const_pool_[arg.value()];
+        call_args[arg_index] = program_->const_pool[arg.value()];
         break;
       }
       case Instruction::ArgKind::kFuncIdx: {
-        TVM_FFI_ICHECK_LT(static_cast<size_t>(arg.value()), this->func_pool_.size());
-        call_args[arg_index] = this->func_pool_[arg.value()];
+        TVM_FFI_ICHECK_LT(static_cast<size_t>(arg.value()), program_->func_pool.size());
+        call_args[arg_index] = program_->func_pool[arg.value()];
         break;
       }
       default: {
@@ -764,13 +1039,29 @@ void VirtualMachineImpl::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
   ffi::PackedArgs args(call_args.data() + args_begin_offset, instr.num_args);
   ffi::Any ret;
 
-  TVM_FFI_ICHECK_LT(static_cast<size_t>(instr.func_idx), this->func_pool_.size());
+  TVM_FFI_ICHECK_LT(static_cast<size_t>(instr.func_idx), program_->func_pool.size());
 
   if (instrument_ == nullptr) {
-    this->InvokeClosurePacked(func_pool_[instr.func_idx].cast<ffi::ObjectRef>(), args, &ret);
+    const DecodedInstruction& decoded = program_->decoded_instrs[pc_];
+    if (decoded.packed != nullptr) {
+      if (!profiling_) {
+        decoded.packed->CallPacked(args.data(), args.size(), &ret);
+      } else {
+        profiler_->Enter(instr.func_idx, args);
+        decoded.packed->CallPacked(args.data(), args.size(), &ret);
+        profiler_->Exit();
+      }
+    } else if (decoded.closure != nullptr) {
+      call_args[0] = static_cast<void*>(static_cast<VirtualMachine*>(this));
+      support::NVTXScopedRange scope("RelaxVM: " + decoded.closure->func_name);
+      decoded.closure->impl.CallPacked(ffi::PackedArgs(call_args.data(), call_args.size()), &ret);
+    } else {
+      const ffi::Any& func = program_->func_pool[instr.func_idx];
+      this->InvokeClosurePacked(func.cast<ffi::ObjectRef>(), args, &ret);
+    }
   } else {
     // insert light-weight instrument callback
-    call_args[0] = func_pool_[instr.func_idx];
+    call_args[0] = program_->func_pool[instr.func_idx];
     call_args[1] = GetFuncName(instr.func_idx);
     call_args[2] = true;
     call_args[3] = nullptr;
@@ -792,7 +1083,8 @@ void VirtualMachineImpl::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
       ret_kind = opt_int.value();
     }
     if (ret_kind != static_cast<int>(VMInstrumentReturnKind::kSkipRun)) {
-      this->InvokeClosurePacked(func_pool_[instr.func_idx].cast<ffi::ObjectRef>(), args, &ret);
+      const ffi::Any& func = program_->func_pool[instr.func_idx];
+      this->InvokeClosurePacked(func.cast<ffi::ObjectRef>(), args, &ret);
       call_args[2] = false;
       call_args[3] = ret;
       instrument_.CallPacked(call_args.data(), call_args.size(), &rv);
@@ -802,22 +1094,58 @@ void VirtualMachineImpl::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
   // save the return value to the register
   // saving to special register is a NOP
   if (instr.dst < Instruction::kBeginSpecialReg) {
-    WriteRegister(curr_frame, instr.dst, ret);
+    WriteRegister(curr_frame, instr.dst, std::move(ret));
   }
   // increment pc
   pc_++;
 }
 
+void VirtualMachineImpl::RunInstrDirectCall(VMFrame* curr_frame, const Instruction& instr,
+                                            DirectKernelFunc direct) {
+  std::vector<void*>& direct_args = curr_frame->direct_args;
+  direct_args.resize(instr.num_args);
+  for (Index i = 0; i < instr.num_args; ++i) {
+    Instruction::Arg arg = instr.args[i];
+    switch (arg.kind()) {
+      case Instruction::ArgKind::kRegister: {
+        direct_args[i] = DirectKernelArg(ReadRegister(curr_frame, arg.value()));
+        break;
+      }
+      case Instruction::ArgKind::kImmediate: {
+        direct_args[i] = reinterpret_cast<void*>(static_cast<intptr_t>(arg.value()));
+        break;
+      }
+      case Instruction::ArgKind::kConstIdx: {
+        direct_args[i] = DirectKernelArg(program_->const_pool[arg.value()]);
+        break;
+      }
+      default: {
+        TVM_FFI_THROW(ValueError) << "Direct kernel " << GetFuncName(instr.func_idx)
+                                  << " cannot take argument kind " << int(arg.kind());
+      }
+    }
+  }
+  TVM_FFI_CHECK_SAFE_CALL((*direct)(direct_args.data()));
+  if (instr.dst < Instruction::kBeginSpecialReg) {
+    WriteRegister(curr_frame, instr.dst, RegType());
+  }
+  pc_++;
+}
+
 void VirtualMachineImpl::RunLoop() {
   VMFrame* curr_frame = frames_.back().get();
 
   while (true) {
-    TVM_FFI_ICHECK_LT(static_cast<size_t>(pc_), exec_->instr_offset.size())
+    TVM_FFI_ICHECK_LT(static_cast<size_t>(pc_), program_->decoded_instrs.size())
         << "run into invalid section";
-    Instruction instr = exec_->GetInstruction(pc_);
+    const Instruction& instr = program_->decoded_instrs[pc_].instr;
     switch (instr.op) {
       case Opcode::Call: {
-        this->RunInstrCall(curr_frame, instr);
+        // Run the consecutive calls without going through the dispatch switch.
+        Index run_end = pc_ + program_->decoded_instrs[pc_].call_run_length;
+        while (pc_ < run_end) {
+          this->RunInstrCall(curr_frame, program_->decoded_instrs[pc_].instr);
+        }
         break;
       }
       case Opcode::Ret: {
@@ -896,8 +1224,57 @@ void VirtualMachineImpl::_InvokeClosureStateful(std::string func_name) {
                               << "; use `set_input` first.";
     return;
   }
-  outputs_[func_name] = this->InvokeClosureInternal(
-      func_pool_[m.at(func_name)].cast<ffi::ObjectRef>(), inputs_[func_name]);
+  const VMFuncInfo& vm_func = exec_->func_table[m.at(func_name)];
+  std::vector<RegType> args = inputs_[func_name];
+  if (args.size() < static_cast<size_t>(vm_func.num_args)) {
+    // Pass the bound buffers to the output parameters, so the function writes into them.
+    auto it = output_buffers_.find(func_name);
+    size_t num_output_params = vm_func.num_args - args.size();
+    TVM_FFI_CHECK(it != output_buffers_.end() && it->second.size() == num_output_params,
+                  ValueError)
+        << func_name << " writes its outputs into " << num_output_params
+        << " buffers; use `set_output_buffers` to bind them first.";
+    args.insert(args.end(), it->second.begin(), it->second.end());
+  }
+  const ffi::Any& func = program_->func_pool[m.at(func_name)];
+  RegType result = this->InvokeClosureInternal(func.cast<ffi::ObjectRef>(), args);
+  if (auto it = output_buffers_.find(func_name); it != output_buffers_.end()) {
+    size_t index = 0;
+    result = WriteOutputBuffers(result, it->second, &index);
+    TVM_FFI_CHECK_EQ(index, it->second.size(), ValueError)
+        << "The result of " << func_name << " has " << index << " tensors, but "
+        << it->second.size() << " output buffers are bound";
+  }
+  outputs_[func_name] = result;
+}
+
+RegType VirtualMachineImpl::WriteOutputBuffers(RegType result, const std::vector<Tensor>& buffers,
+                                               size_t* index) {
+  if (auto opt_tensor = result.as<Tensor>()) {
+    TVM_FFI_CHECK_LT(*index, buffers.size(), ValueError)
+        << "The result has more tensors than the " << buffers.size() << " bound output buffers";
+    Tensor out = opt_tensor.value();
+    Tensor buffer = buffers[(*index)++];
+    // A function in destination-passing style has already written into the buffer.
+    if (!Tensor::IsStorageShared(out, buffer)) {
+      bool same_shape = out->ndim == buffer->ndim &&
+                        std::equal(out->shape, out->shape + out->ndim, buffer->shape);
+      TVM_FFI_CHECK(same_shape && out.DataType() == buffer.DataType(), ValueError)
+          << "The output of shape " << out.Shape() << " and dtype " << out.DataType()
+          << " does not match its bound buffer of shape " << buffer.Shape() << " and dtype "
+          << buffer.DataType();
+      buffer.CopyFrom(out);
+    }
+    return buffer;
+  } else if (auto opt_arr = result.as<ffi::Array<Any>>()) {
+    std::vector<Any> ret;
+    for (const Any& field : opt_arr.value()) {
+      ret.push_back(WriteOutputBuffers(field, buffers, index));
+    }
+    return ffi::Array<Any>(ret.begin(), ret.end());
+  } else {
+    return result;
+  }
 }
 
 void VirtualMachineImpl::_SetInstrument(ffi::PackedArgs args, ffi::Any* rv) {
@@ -913,6 +1290,30 @@ void VirtualMachineImpl::_SetInstrument(ffi::PackedArgs args, ffi::Any* rv) {
   }
 }
 
+void VirtualMachineImpl::_ProfilerStart() {
+  TVM_FFI_ICHECK(!devices.empty()) << "The VM is not initialized yet.";
+  std::vector<std::string> func_names;
+  func_names.reserve(exec_->func_table.size());
+  for (const VMFuncInfo& info : exec_->func_table) {
+    func_names.push_back(info.name);
+  }
+  // The first device is the one the kernels run on, the host device comes last.
+  profiler_ = std::make_unique<VMProfiler>(devices[0], allocators, std::move(func_names));
+  profiling_ = true;
+}
+
+void VirtualMachineImpl::_ProfilerStop() { profiling_ = false; }
+
+std::string VirtualMachineImpl::_ProfilerReport() {
+  TVM_FFI_ICHECK(profiler_ != nullptr) << "The profiler has not been started.";
+  return profiler_->Report();
+}
+
+std::string VirtualMachineImpl::_ProfilerChromeTrace() {
+  TVM_FFI_ICHECK(profiler_ != nullptr) << "The profiler has not been started.";
+  return profiler_->ChromeTrace();
+}
+
 void VirtualMachineImpl::_GetOutputArity(ffi::PackedArgs args, ffi::Any* rv) {
   std::string func_name = args[0].cast<std::string>();
   RegType out = LookupVMOutput(func_name);
@@ -946,6 +1347,27 @@ void VirtualMachineImpl::_SetInputWithParamModule(ffi::PackedArgs args, ffi::Any
   this->SetInput(func_name, true, args.Slice(1));
 }
 
+void VirtualMachineImpl::_SetInputZeroCopy(ffi::PackedArgs args, ffi::Any* rv) {
+  std::string func_name = args[0].cast<std::string>();
+  this->SetInput(func_name, false, args.Slice(1), /*zero_copy=*/true);
+}
+
+void VirtualMachineImpl::_SetOutputBuffers(ffi::PackedArgs args, ffi::Any* rv) {
+  std::string func_name = args[0].cast<std::string>();
+  LookupVMFuncInfo(func_name);
+  std::vector<Tensor> buffers;
+  for (int i = 1; i < args.size(); ++i) {
+    Tensor buffer = args[i].cast<Tensor>();
+    CheckAdoptedOnDevice(buffer.operator->(), devices[0]);
+    buffers.push_back(buffer);
+  }
+  if (buffers.empty()) {
+    output_buffers_.erase(func_name);
+  } else {
+    output_buffers_[func_name] = std::move(buffers);
+  }
+}
+
 int VirtualMachineImpl::_GetFunctionArity(std::string func_name) {
   const VMFuncInfo& vm_func = LookupVMFuncInfo(func_name);
   return vm_func.param_names.size();
@@ -972,6 +1394,8 @@ ffi::Function VirtualMachineImpl::_LookupFunction(const ffi::String& name) {
   return ffi::Function(nullptr);
 }
 
+ffi::Module VirtualMachineImpl::_CreateContext() { return ffi::Module(this->CreateContext()); }
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
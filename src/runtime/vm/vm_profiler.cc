@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/vm_profiler.cc
+ * \brief The built-in per-call profiler of the Relax VM.
+ */
+#include "./vm_profiler.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+namespace {
+
+/*! \brief Write a string as a JSON string literal. */
+void WriteJSONString(std::ostream& os, const std::string& str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << ' ';
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+}  // namespace
+
+VMProfiler::VMProfiler(Device device, std::vector<memory::Allocator*> allocators,
+                       std::vector<std::string> func_names)
+    : device_(device),
+      allocators_(std::move(allocators)),
+      func_names_(std::move(func_names)),
+      start_time_(std::chrono::steady_clock::now()) {
+  // Look the timer up once instead of on every call as Timer::Start does.
+  timer_factory_ = ffi::Function::GetGlobal(std::string("runtime.timer.") +
+                                            DLDeviceType2Str(device.device_type));
+}
+
+int64_t VMProfiler::UsedBytes() const {
+  int64_t used_bytes = 0;
+  for (const memory::Allocator* allocator : allocators_) {
+    if (allocator != nullptr) {
+      used_bytes += static_cast<int64_t>(allocator->UsedMemory());
+    }
+  }
+  return used_bytes;
+}
+
+void VMProfiler::Enter(Index func_idx, ffi::PackedArgs args) {
+  VMProfileRecord record;
+  record.func_idx = func_idx;
+  record.stream = DeviceAPI::Get(device_)->GetCurrentStream(device_);
+  for (int i = 0; i < args.size(); ++i) {
+    if (auto opt_tensor = args[i].try_cast<DLTensor*>()) {
+      const DLTensor* tensor = opt_tensor.value();
+      record.arg_dims.push_back(tensor->ndim);
+      record.arg_dims.insert(record.arg_dims.end(), tensor->shape, tensor->shape + tensor->ndim);
+    }
+  }
+  open_calls_.emplace_back(records_.size(), UsedBytes());
+  record.launch_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start_time_)
+                         .count();
+  if (timer_factory_.has_value()) {
+    record.timer = timer_factory_.value()(device_).cast<Timer>();
+    record.timer->Start();
+  } else {
+    record.timer = Timer::Start(device_);
+  }
+  records_.push_back(std::move(record));
+}
+
+void VMProfiler::Exit() {
+  TVM_FFI_ICHECK(!open_calls_.empty());
+  auto [record_idx, used_bytes_before] = open_calls_.back();
+  open_calls_.pop_back();
+  VMProfileRecord& record = records_[record_idx];
+  record.timer->Stop();
+  record.used_bytes = UsedBytes();
+  record.alloc_bytes = std::max<int64_t>(record.used_bytes - used_bytes_before, 0);
+  if (open_calls_.empty() && records_.size() - num_synced_ >= kMaxPendingTimers) {
+    SyncTimers();
+  }
+}
+
+void VMProfiler::SyncTimers() {
+  // The timers of the calls that are still open have not been stopped.
+  size_t end = open_calls_.empty() ? records_.size() : open_calls_.front().first;
+  for (; num_synced_ < end; ++num_synced_) {
+    VMProfileRecord& record = records_[num_synced_];
+    record.duration_ns = record.timer->SyncAndGetElapsedNanos();
+    record.timer = Timer();
+  }
+}
+
+std::string VMProfiler::Report() {
+  SyncTimers();
+  struct FuncStats {
+    int64_t calls = 0;
+    int64_t total_ns = 0;
+    int64_t min_ns = std::numeric_limits<int64_t>::max();
+    int64_t max_ns = 0;
+    int64_t alloc_bytes = 0;
+  };
+  std::unordered_map<Index, FuncStats> stats;
+  int64_t total_ns = 0;
+  int64_t peak_used_bytes = 0;
+  for (size_t i = 0; i < num_synced_; ++i) {
+    const VMProfileRecord& record = records_[i];
+    FuncStats& func_stats = stats[record.func_idx];
+    func_stats.calls += 1;
+    func_stats.total_ns += record.duration_ns;
+    func_stats.min_ns = std::min(func_stats.min_ns, record.duration_ns);
+    func_stats.max_ns = std::max(func_stats.max_ns, record.duration_ns);
+    func_stats.alloc_bytes += record.alloc_bytes;
+    total_ns += record.duration_ns;
+    peak_used_bytes = std::max(peak_used_bytes, record.used_bytes);
+  }
+  std::vector<std::pair<Index, FuncStats>> sorted(stats.begin(), stats.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.total_ns != rhs.second.total_ns ? lhs.second.total_ns > rhs.second.total_ns
+                                                      : lhs.first < rhs.first;
+  });
+
+  std::ostringstream os;
+  os << "{\"total_ns\": " << total_ns << ", \"peak_used_bytes\": " << peak_used_bytes
+     << ", \"functions\": [";
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const auto& [func_idx, func_stats] = sorted[i];
+    os << (i ? ", " : "") << "{\"name\": ";
+    WriteJSONString(os, func_names_[func_idx]);
+    os << ", \"calls\": " << func_stats.calls << ", \"total_ns\": " << func_stats.total_ns
+       << ", \"mean_ns\": " << func_stats.total_ns / func_stats.calls
+       << ", \"min_ns\": " << func_stats.min_ns << ", \"max_ns\": " << func_stats.max_ns
+       << ", \"percent\": "
+       << (total_ns > 0 ? 100.0 * static_cast<double>(func_stats.total_ns) / total_ns : 0.0)
+       << ", \"alloc_bytes\": " << func_stats.alloc_bytes << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
+std::string VMProfiler::ChromeTrace() {
+  SyncTimers();
+  // Number the streams in the order they are first used, so that each gets its own track.
+  std::unordered_map<TVMStreamHandle, int> stream_ids;
+  std::ostringstream os;
+  os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  for (size_t i = 0; i < num_synced_; ++i) {
+    const VMProfileRecord& record = records_[i];
+    int tid = stream_ids.emplace(record.stream, static_cast<int>(stream_ids.size())).first->second;
+    // The trace event format measures time in microseconds.
+    double ts_us = record.launch_ns / 1e3;
+    os << (i ? ", " : "") << "{\"name\": ";
+    WriteJSONString(os, func_names_[record.func_idx]);
+    os << ", \"cat\": \"kernel\", \"ph\": \"X\", \"ts\": " << ts_us
+       << ", \"dur\": " << record.duration_ns / 1e3 << ", \"pid\": " << device_.device_id
+       << ", \"tid\": " << tid << ", \"args\": {\"shapes\": \"";
+    for (size_t j = 0; j < record.arg_dims.size(); j += record.arg_dims[j] + 1) {
+      os << (j ? ", " : "") << "(";
+      for (int64_t k = 0; k < record.arg_dims[j]; ++k) {
+        os << (k ? ", " : "") << record.arg_dims[j + 1 + k];
+      }
+      os << ")";
+    }
+    os << "\", \"alloc_bytes\": " << record.alloc_bytes << "}}";
+    os << ", {\"name\": \"memory\", \"ph\": \"C\", \"ts\": " << ts_us
+       << ", \"pid\": " << device_.device_id << ", \"args\": {\"used_bytes\": "
+       << record.used_bytes << "}}";
+  }
+  os << "]}";
+  return os.str();
+}
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/vm_profiler.h
+ * \brief The built-in per-call profiler of the Relax VM.
+ *
+ * While enabled, the VM records for every packed function it calls the device time measured by
+ * the device timer, the host launch time, the shapes of the tensor arguments, the stream of the
+ * device, and the memory used by the VM allocators. The device timers are synchronized in
+ * batches rather than per call, so that the kernels still run asynchronously.
+ */
+#ifndef TVM_RUNTIME_VM_VM_PROFILER_H_
+#define TVM_RUNTIME_VM_VM_PROFILER_H_
+
+#include <tvm/ffi/function.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/memory/memory_manager.h>
+#include <tvm/runtime/timer.h>
+#include <tvm/runtime/vm/bytecode.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*! \brief The measurements of one packed function call. */
+struct VMProfileRecord {
+  /*! \brief The index of the function in the function table of the executable. */
+  Index func_idx;
+  /*! \brief The host time of the launch, in nanoseconds since the profiler was started. */
+  int64_t launch_ns;
+  /*! \brief The device time of the call in nanoseconds, -1 until its timer is synchronized. */
+  int64_t duration_ns = -1;
+  /*! \brief The device timer of the call, released once it is synchronized. */
+  Timer timer;
+  /*! \brief The stream of the device the call was launched on. */
+  TVMStreamHandle stream;
+  /*! \brief The bytes the VM allocators took from the device during the call. */
+  int64_t alloc_bytes = 0;
+  /*! \brief The bytes used by the VM allocators after the call. */
+  int64_t used_bytes = 0;
+  /*! \brief The shapes of the tensor arguments, each stored as its ndim followed by its dims. */
+  std::vector<int64_t> arg_dims;
+};
+
+/*! \brief The per-call profiler of a VM. */
+class VMProfiler {
+ public:
+  /*!
+   * \param device The device whose timer measures the calls.
+   * \param allocators The allocators of the VM, whose usage is recorded around each call.
+   * \param func_names The names of the functions in the function table of the executable.
+   */
+  VMProfiler(Device device, std::vector<memory::Allocator*> allocators,
+             std::vector<std::string> func_names);
+
+  /*!
+   * \brief Start recording a call.
+   * \param func_idx The index of the called function.
+   * \param args The arguments of the call.
+   */
+  void Enter(Index func_idx, ffi::PackedArgs args);
+
+  /*! \brief Finish recording the innermost open call. */
+  void Exit();
+
+  /*!
+   * \brief The per-function statistics as a JSON string, ordered by decreasing total time.
+   * \note This synchronizes the device.
+   */
+  std::string Report();
+
+  /*!
+   * \brief The recorded calls in the Chrome trace event format, with a counter track of the
+   * allocator usage. The events start at the host launch time and last the device time.
+   * \note This synchronizes the device.
+   */
+  std::string ChromeTrace();
+
+ private:
+  /*! \brief The maximum number of calls whose timers are not synchronized yet. */
+  static constexpr size_t kMaxPendingTimers = 1024;
+
+  /*! \brief Synchronize the pending timers and release them. */
+  void SyncTimers();
+
+  /*! \brief The total memory used by the allocators, in bytes. */
+  int64_t UsedBytes() const;
+
+  Device device_;
+  std::vector<memory::Allocator*> allocators_;
+  std::vector<std::string> func_names_;
+  /*! \brief The device timer factory, or null when the device has no timer. */
+  ffi::Optional<ffi::Function> timer_factory_;
+  std::chrono::steady_clock::time_point start_time_;
+  std::vector<VMProfileRecord> records_;
+  /*! \brief The open calls: the index of their record and the allocator usage at their start. */
+  std::vector<std::pair<size_t, int64_t>> open_calls_;
+  /*! \brief The index of the first record whose timer is not synchronized. */
+  size_t num_synced_ = 0;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_VM_PROFILER_H_
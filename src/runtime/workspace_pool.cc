@@ -23,118 +23,211 @@
  */
 #include "workspace_pool.h"
 
+#include <tvm/runtime/metrics.h>
+
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 namespace tvm {
 namespace runtime {
 
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
+// huge page size.
+constexpr size_t kWorkspaceHugePageSize = 2 << 20;
+
+namespace {
+
+/*! \brief The metrics of all workspace pools. */
+struct WorkspacePoolMetrics {
+  metrics::Gauge* allocated_bytes;
+  metrics::Gauge* free_bytes;
+  metrics::Counter* num_misses;
+
+  static const WorkspacePoolMetrics& Global() {
+    static WorkspacePoolMetrics global_metrics = [] {
+      metrics::Registry* registry = metrics::Registry::Global();
+      return WorkspacePoolMetrics{
+          registry->GetGauge("tvm_workspace_pool_allocated_bytes",
+                             "Device memory held by the workspace pools."),
+          registry->GetGauge("tvm_workspace_pool_free_bytes",
+                             "Memory cached in the free lists of the workspace pools."),
+          registry->GetCounter("tvm_workspace_pool_misses_total",
+                               "Workspace allocations that allocated a new page from the device.")};
+    }();
+    return global_metrics;
+  }
+};
+
+}  // namespace
 
 class WorkspacePool::Pool {
  public:
-  // constructor
-  Pool() {
-    // safe guard header on each list.
-    Entry e;
-    e.data = nullptr;
-    e.size = 0;
-    free_list_.push_back(e);
-    allocated_.push_back(e);
-  }
   // allocate from pool
-  void* Alloc(Device dev, DeviceAPI* device, size_t nbytes) {
+  void* Alloc(Device dev, DeviceAPI* device, size_t nbytes, bool use_huge_pages) {
     // Allocate align to page.
-    nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
+    nbytes = RoundUp(nbytes, kWorkspacePageSize);
     if (nbytes == 0) nbytes = kWorkspacePageSize;
+    size_t alignment = kTempAllocaAlignment;
+    bool huge_page =
+        use_huge_pages && dev.device_type == kDLCPU && nbytes >= kWorkspaceHugePageSize;
+    if (huge_page) {
+      nbytes = RoundUp(nbytes, kWorkspaceHugePageSize);
+      alignment = kWorkspaceHugePageSize;
+    }
     Entry e;
-    DLDataType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
-    if (free_list_.size() == 2) {
-      e = free_list_.back();
-      free_list_.pop_back();
-      if (e.size < nbytes) {
-        // resize the page
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
-      }
-    } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+    if (TakeBestFit(nbytes, &e)) {
+      ++stats_.num_hits;
     } else {
-      if (free_list_.back().size >= nbytes) {
-        // find smallest fit
-        auto it = free_list_.end() - 2;
-        for (; it->size >= nbytes; --it) {
-        }
-        e = *(it + 1);
-        free_list_.erase(it + 1);
-      } else {
-        // resize the page
-        e = free_list_.back();
-        free_list_.pop_back();
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+      ++stats_.num_misses;
+      WorkspacePoolMetrics::Global().num_misses->Increment();
+      DLDataType type;
+      type.code = kDLUInt;
+      type.bits = 8;
+      type.lanes = 1;
+      e.data = device->AllocDataSpace(dev, nbytes, alignment, type);
+      e.size = nbytes;
+      AddAllocatedBytes(nbytes);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      if (huge_page) {
+        // only a hint, the pages stay regular when transparent huge pages are disabled
+        madvise(e.data, nbytes, MADV_HUGEPAGE);
       }
+#endif
     }
     allocated_.push_back(e);
+    live_bytes_ += e.size;
+    peak_live_bytes_ = std::max(peak_live_bytes_, live_bytes_);
+    // Keep the cached pages within the peak live size, releasing the largest ones first.
+    // Unlike resizing a page on every miss, this keeps the pages of repeated patterns.
+    if (stats_.free_bytes > static_cast<int64_t>(peak_live_bytes_)) {
+      ++stats_.num_reallocs;
+      while (stats_.free_bytes > static_cast<int64_t>(peak_live_bytes_)) {
+        ReleaseLargest(dev, device);
+      }
+    }
     return e.data;
   }
   // free resource back to pool
   void Free(void* data) {
     Entry e;
-    if (allocated_.back().data == data) {
+    if (!allocated_.empty() && allocated_.back().data == data) {
       // quick path, last allocated.
       e = allocated_.back();
       allocated_.pop_back();
     } else {
       int index = static_cast<int>(allocated_.size()) - 2;
-      for (; index > 0 && allocated_[index].data != data; --index) {
+      for (; index >= 0 && allocated_[index].data != data; --index) {
       }
-      TVM_FFI_ICHECK_GT(index, 0) << "trying to free things that has not been allocated";
+      TVM_FFI_ICHECK_GE(index, 0) << "trying to free things that has not been allocated";
       e = allocated_[index];
       allocated_.erase(allocated_.begin() + index);
     }
-    if (free_list_.back().size < e.size) {
-      free_list_.push_back(e);
-    } else if (free_list_.size() == 2) {
-      free_list_.push_back(free_list_.back());
-      free_list_[1] = e;
-    } else {
-      size_t i = free_list_.size() - 1;
-      free_list_.resize(free_list_.size() + 1);
-      for (; e.size < free_list_[i].size; --i) {
-        free_list_[i + 1] = free_list_[i];
-      }
-      free_list_[i + 1] = e;
-    }
+    live_bytes_ -= e.size;
+    std::vector<Entry>& bucket = Bucket(e.size);
+    auto it = std::upper_bound(bucket.begin(), bucket.end(), e.size,
+                               [](size_t size, const Entry& entry) { return size < entry.size; });
+    bucket.insert(it, e);
+    AddFreeBytes(e.size);
   }
   // Release all resources
   void Release(Device dev, DeviceAPI* device) {
-    for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(dev, free_list_[i].data);
+    for (std::vector<Entry>& bucket : buckets_) {
+      for (const Entry& e : bucket) {
+        device->FreeDataSpace(dev, e.data);
+        AddAllocatedBytes(-static_cast<int64_t>(e.size));
+      }
+      bucket.clear();
     }
-    free_list_.clear();
+    AddFreeBytes(-stats_.free_bytes);
   }
 
+  const WorkspacePoolStats& stats() const { return stats_; }
+
  private:
   /*! \brief a single entry in the pool */
   struct Entry {
     void* data;
     size_t size;
   };
-  /*! \brief List of free items, sorted from small to big size */
-  std::vector<Entry> free_list_;
+
+  static size_t RoundUp(size_t nbytes, size_t page) { return (nbytes + page - 1) / page * page; }
+
+  void AddAllocatedBytes(int64_t delta) {
+    stats_.allocated_bytes += delta;
+    WorkspacePoolMetrics::Global().allocated_bytes->Add(delta);
+  }
+
+  void AddFreeBytes(int64_t delta) {
+    stats_.free_bytes += delta;
+    WorkspacePoolMetrics::Global().free_bytes->Add(delta);
+  }
+
+  /*! \brief Get the bucket of a size, bucket k holds the sizes of [2^k, 2^(k+1)) pages. */
+  std::vector<Entry>& Bucket(size_t nbytes) {
+    size_t index = 0;
+    for (size_t npages = nbytes / kWorkspacePageSize; npages > 1; npages >>= 1) {
+      ++index;
+    }
+    if (index >= buckets_.size()) {
+      buckets_.resize(index + 1);
+    }
+    return buckets_[index];
+  }
+
+  /*! \brief Take the smallest cached page that fits nbytes. */
+  bool TakeBestFit(size_t nbytes, Entry* e) {
+    // The buckets above the bucket of nbytes only hold fitting pages.
+    for (auto bucket = &Bucket(nbytes); bucket != buckets_.data() + buckets_.size(); ++bucket) {
+      auto it = std::lower_bound(
+          bucket->begin(), bucket->end(), nbytes,
+          [](const Entry& entry, size_t size) { return entry.size < size; });
+      if (it != bucket->end()) {
+        *e = *it;
+        bucket->erase(it);
+        AddFreeBytes(-static_cast<int64_t>(e->size));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*! \brief Release the largest cached page to the device. */
+  void ReleaseLargest(Device dev, DeviceAPI* device) {
+    for (auto bucket = buckets_.rbegin(); bucket != buckets_.rend(); ++bucket) {
+      if (!bucket->empty()) {
+        Entry e = bucket->back();
+        bucket->pop_back();
+        device->FreeDataSpace(dev, e.data);
+        AddFreeBytes(-static_cast<int64_t>(e.size));
+        AddAllocatedBytes(-static_cast<int64_t>(e.size));
+        return;
+      }
+    }
+  }
+
+  /*! \brief Free pages by size class, each bucket sorted from small to big size */
+  std::vector<std::vector<Entry>> buckets_;
   /*! \brief List of allocated items */
   std::vector<Entry> allocated_;
+  /*! \brief The bytes of the allocated items */
+  size_t live_bytes_{0};
+  /*! \brief The peak of live_bytes_ */
+  size_t peak_live_bytes_{0};
+  /*! \brief The counters */
+  WorkspacePoolStats stats_;
 };
 
 WorkspacePool::WorkspacePool(DLDeviceType device_type, DeviceAPI* device)
-    : device_type_(device_type), device_(device) {}
+    : device_type_(device_type), device_(device) {
+  const char* val = getenv("TVM_WORKSPACE_HUGE_PAGES");
+  use_huge_pages_ = val != nullptr && atoi(val) == 1;
+}
 
 WorkspacePool::~WorkspacePool() {
   for (size_t i = 0; i < array_.size(); ++i) {
@@ -155,7 +248,7 @@ void* WorkspacePool::AllocWorkspace(Device dev, size_t size) {
   if (array_[dev.device_id] == nullptr) {
     array_[dev.device_id] = new Pool();
   }
-  return array_[dev.device_id]->Alloc(dev, device_, size);
+  return array_[dev.device_id]->Alloc(dev, device_, size, use_huge_pages_);
 }
 
 void WorkspacePool::FreeWorkspace(Device dev, void* ptr) {
@@ -164,5 +257,19 @@ void WorkspacePool::FreeWorkspace(Device dev, void* ptr) {
   array_[dev.device_id]->Free(ptr);
 }
 
+WorkspacePoolStats WorkspacePool::GetStats() const {
+  WorkspacePoolStats stats;
+  for (const Pool* pool : array_) {
+    if (pool == nullptr) continue;
+    const WorkspacePoolStats& s = pool->stats();
+    stats.num_hits += s.num_hits;
+    stats.num_misses += s.num_misses;
+    stats.num_reallocs += s.num_reallocs;
+    stats.allocated_bytes += s.allocated_bytes;
+    stats.free_bytes += s.free_bytes;
+  }
+  return stats;
+}
+
 }  // namespace runtime
 }  // namespace tvm
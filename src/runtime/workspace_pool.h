@@ -26,11 +26,27 @@
 
 #include <tvm/runtime/device_api.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
+
+/*! \brief The counters of a workspace pool. */
+struct WorkspacePoolStats {
+  /*! \brief The number of allocations served by a cached free page. */
+  int64_t num_hits = 0;
+  /*! \brief The number of allocations that allocated a new page from the device. */
+  int64_t num_misses = 0;
+  /*! \brief The number of misses that released a cached page that was too small. */
+  int64_t num_reallocs = 0;
+  /*! \brief The number of bytes allocated from the device. */
+  int64_t allocated_bytes = 0;
+  /*! \brief The number of bytes cached in the free lists. */
+  int64_t free_bytes = 0;
+};
+
 /*!
  * \brief A workspace pool to manage
  *
@@ -41,6 +57,10 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  The free pages are kept in size-class buckets and an allocation takes the
+ *  smallest cached page that fits. Setting TVM_WORKSPACE_HUGE_PAGES=1 backs the
+ *  CPU workspaces of 2MB or more with transparent huge pages.
  */
 class TVM_RUNTIME_DLL WorkspacePool {
  public:
@@ -65,6 +85,8 @@ class TVM_RUNTIME_DLL WorkspacePool {
    * \param ptr The pointer to be freed.
    */
   void FreeWorkspace(Device dev, void* ptr);
+  /*! \brief Get the counters, summed over the devices of the pool. */
+  WorkspacePoolStats GetStats() const;
 
  private:
   class Pool;
@@ -74,6 +96,8 @@ class TVM_RUNTIME_DLL WorkspacePool {
   DLDeviceType device_type_;
   /*! \brief The device API */
   DeviceAPI* device_;
+  /*! \brief Whether to back large CPU workspaces with 2MB huge pages */
+  bool use_huge_pages_;
 };
 
 }  // namespace runtime
@@ -0,0 +1,688 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/reflection/registry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../../runtime/file_utils.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+namespace gbdt {
+
+/*! \brief The maximum number of bins a feature is quantized into when searching for splits. */
+constexpr int kMaxBins = 256;
+/*! \brief The number of rows times features below which the work is done on a single thread. */
+constexpr int64_t kMinParallelWork = 1 << 16;
+/*! \brief The magic string at the beginning of a saved model. */
+constexpr const char* kMagic = "TVMMSGB1";
+
+/*!
+ * \brief The feature rows of a batch of samples in the pack-sum format, where each sample is a
+ *  group of rows and its prediction is the sum of the predictions of its rows.
+ */
+struct PackedRows {
+  /*! \brief The length of a row */
+  int num_features = 0;
+  /*! \brief The rows, stored contiguously in row-major order */
+  std::vector<float> rows;
+  /*! \brief The rows of sample i are [row_ptr[i], row_ptr[i + 1]) */
+  std::vector<int64_t> row_ptr{0};
+
+  int64_t NumRows() const { return row_ptr.back(); }
+  int64_t NumSamples() const { return static_cast<int64_t>(row_ptr.size()) - 1; }
+  const float* Row(int64_t i) const { return rows.data() + i * num_features; }
+
+  /*! \brief Append a sample of `num_rows` rows. */
+  void Append(const float* data, int64_t num_rows) {
+    rows.insert(rows.end(), data, data + num_rows * num_features);
+    row_ptr.push_back(row_ptr.back() + num_rows);
+  }
+};
+
+/*! \brief A regression tree in arrays of nodes, where node 0 is the root. */
+struct Tree {
+  /*! \brief The feature a node splits on, -1 for a leaf */
+  std::vector<int32_t> feature;
+  /*! \brief The rows whose feature is less than the threshold go to the left child */
+  std::vector<float> threshold;
+  /*! \brief The left child of a node */
+  std::vector<int32_t> left;
+  /*! \brief The right child of a node */
+  std::vector<int32_t> right;
+  /*! \brief The output of a leaf */
+  std::vector<double> value;
+
+  /*! \brief Add a leaf and return its index. */
+  int32_t AddLeaf(double leaf_value) {
+    feature.push_back(-1);
+    threshold.push_back(0.0f);
+    left.push_back(-1);
+    right.push_back(-1);
+    value.push_back(leaf_value);
+    return static_cast<int32_t>(value.size()) - 1;
+  }
+
+  /*! \brief Predict the output of a row. */
+  double Predict(const float* row) const {
+    int32_t i = 0;
+    while (feature[i] >= 0) {
+      i = row[feature[i]] < threshold[i] ? left[i] : right[i];
+    }
+    return value[i];
+  }
+};
+
+/*! \brief The hyper-parameters of boosting. */
+struct BoostConfig {
+  int max_depth;
+  double eta;
+  double gamma;
+  double min_child_weight;
+  double reg_lambda;
+  int num_threads;
+};
+
+/*!
+ * \brief Boost regression trees with the square error of the pack-sum predictions, weighted by
+ *  the labels so that the fast candidates are predicted more precisely, which is the objective
+ *  of the XGBoost cost model. Features are quantized into histograms once, and the histograms
+ *  of the features are built in parallel during split finding.
+ */
+class Booster {
+ public:
+  Booster(const PackedRows* data, std::vector<double> labels, BoostConfig config)
+      : data_(data),
+        labels_(std::move(labels)),
+        config_(config),
+        row_pred_(data->NumRows(), 0.0),
+        grad_(data->NumRows(), 0.0),
+        hess_(data->NumRows(), 0.0) {
+    TVM_FFI_ICHECK_EQ(static_cast<int64_t>(labels_.size()), data_->NumSamples());
+    Quantize();
+  }
+
+  /*! \brief Start boosting from the predictions of existing trees. */
+  void InitPredictions(const std::vector<Tree>& trees) {
+    if (trees.empty()) {
+      return;
+    }
+    ParallelForRows([this, &trees](int64_t r) {
+      const float* row = data_->Row(r);
+      double pred = 0.0;
+      for (const Tree& tree : trees) {
+        pred += tree.Predict(row);
+      }
+      row_pred_[r] = pred;
+    });
+  }
+
+  /*!
+   * \brief Add trees until `max_num_trees` is reached, or the training error does not improve
+   *  for `early_stopping_rounds` rounds, when the trees after the best round are dropped.
+   * \param trees The trees to append to.
+   * \param max_num_trees The maximum number of trees to add.
+   * \param early_stopping_rounds The rounds without improvement to stop after, 0 to disable it.
+   * \return The training RMSE of the sample predictions.
+   */
+  double Boost(std::vector<Tree>* trees, int max_num_trees, int early_stopping_rounds) {
+    size_t base = trees->size();
+    double best_rmse = std::numeric_limits<double>::infinity();
+    int best_round = -1;
+    for (int round = 0; round < max_num_trees; ++round) {
+      ComputeGradients();
+      trees->push_back(GrowTree());
+      const Tree& tree = trees->back();
+      ParallelForRows([this, &tree](int64_t r) { row_pred_[r] += tree.Predict(data_->Row(r)); });
+      double rmse = RMSE();
+      if (rmse < best_rmse) {
+        best_rmse = rmse;
+        best_round = round;
+      } else if (early_stopping_rounds > 0 && round - best_round >= early_stopping_rounds) {
+        break;
+      }
+    }
+    if (early_stopping_rounds > 0) {
+      trees->resize(base + best_round + 1);
+    }
+    return best_rmse;
+  }
+
+ private:
+  /*! \brief The best split of a node on a feature. */
+  struct Split {
+    double gain = 0.0;
+    int feature = -1;
+    int bin = -1;
+  };
+
+  template <typename FRow>
+  void ParallelForRows(FRow f_row) const {
+    constexpr int64_t kChunk = 4096;
+    int64_t num_rows = data_->NumRows();
+    int num_chunks = static_cast<int>((num_rows + kChunk - 1) / kChunk);
+    int num_threads = num_rows * data_->num_features >= kMinParallelWork ? config_.num_threads : 1;
+    support::parallel_for_dynamic(0, num_chunks, num_threads, [&](int, int chunk) {
+      int64_t end = std::min(num_rows, (chunk + 1) * kChunk);
+      for (int64_t r = chunk * kChunk; r < end; ++r) {
+        f_row(r);
+      }
+    });
+  }
+
+  /*! \brief Compute the cut points of each feature and the bins of all rows, column-major. */
+  void Quantize() {
+    int num_features = data_->num_features;
+    int64_t num_rows = data_->NumRows();
+    cuts_.resize(num_features);
+    bins_.resize(num_features * num_rows);
+    auto f_quantize = [this, num_rows](int, int f) {
+      std::vector<float> values(num_rows);
+      for (int64_t r = 0; r < num_rows; ++r) {
+        values[r] = data_->Row(r)[f];
+      }
+      std::vector<float> sorted = values;
+      std::sort(sorted.begin(), sorted.end());
+      sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+      std::vector<float>& cuts = cuts_[f];
+      if (static_cast<int>(sorted.size()) <= kMaxBins) {
+        for (size_t i = 1; i < sorted.size(); ++i) {
+          cuts.push_back(sorted[i - 1] + (sorted[i] - sorted[i - 1]) / 2);
+        }
+      } else {
+        for (int i = 1; i < kMaxBins; ++i) {
+          cuts.push_back(sorted[i * sorted.size() / kMaxBins]);
+        }
+      }
+      cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+      uint8_t* col = bins_.data() + f * num_rows;
+      for (int64_t r = 0; r < num_rows; ++r) {
+        col[r] = std::upper_bound(cuts.begin(), cuts.end(), values[r]) - cuts.begin();
+      }
+    };
+    int num_threads = num_rows * num_features >= kMinParallelWork ? config_.num_threads : 1;
+    support::parallel_for_dynamic(0, num_features, num_threads, f_quantize);
+  }
+
+  void ComputeGradients() {
+    index_.clear();
+    for (int64_t s = 0, n = data_->NumSamples(); s < n; ++s) {
+      int64_t begin = data_->row_ptr[s];
+      int64_t end = data_->row_ptr[s + 1];
+      double pred = 0.0;
+      for (int64_t r = begin; r < end; ++r) {
+        pred += row_pred_[r];
+      }
+      double y = labels_[s];
+      for (int64_t r = begin; r < end; ++r) {
+        grad_[r] = (pred - y) * y;
+        hess_[r] = y;
+      }
+      // The rows of samples with zero labels have no gradient, leave them out of the search.
+      if (y > 0.0) {
+        for (int64_t r = begin; r < end; ++r) {
+          index_.push_back(r);
+        }
+      }
+    }
+  }
+
+  double RMSE() const {
+    double sum = 0.0;
+    for (int64_t s = 0, n = data_->NumSamples(); s < n; ++s) {
+      double pred = 0.0;
+      for (int64_t r = data_->row_ptr[s]; r < data_->row_ptr[s + 1]; ++r) {
+        pred += row_pred_[r];
+      }
+      sum += (pred - labels_[s]) * (pred - labels_[s]);
+    }
+    return std::sqrt(sum / std::max<int64_t>(1, data_->NumSamples()));
+  }
+
+  double Score(double g, double h) const { return g * g / (h + config_.reg_lambda); }
+
+  Tree GrowTree() {
+    Tree tree;
+    Grow(&tree, 0, index_.size(), 0);
+    return tree;
+  }
+
+  /*! \brief Grow the subtree of the rows index_[begin, end) and return its root. */
+  int32_t Grow(Tree* tree, size_t begin, size_t end, int depth) {
+    double g = 0.0, h = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+      g += grad_[index_[i]];
+      h += hess_[index_[i]];
+    }
+    int32_t node = tree->AddLeaf(-g / (h + config_.reg_lambda) * config_.eta);
+    if (depth >= config_.max_depth || end - begin < 2) {
+      return node;
+    }
+    Split split = FindSplit(begin, end, g, h);
+    if (split.feature < 0) {
+      return node;
+    }
+    const uint8_t* col = bins_.data() + split.feature * data_->NumRows();
+    size_t mid = std::partition(index_.begin() + begin, index_.begin() + end,
+                                [col, &split](int64_t r) { return col[r] <= split.bin; }) -
+                 index_.begin();
+    int32_t left = Grow(tree, begin, mid, depth + 1);
+    int32_t right = Grow(tree, mid, end, depth + 1);
+    tree->feature[node] = split.feature;
+    tree->threshold[node] = cuts_[split.feature][split.bin];
+    tree->left[node] = left;
+    tree->right[node] = right;
+    return node;
+  }
+
+  Split FindSplit(size_t begin, size_t end, double g, double h) const {
+    int num_features = data_->num_features;
+    int64_t num_rows = data_->NumRows();
+    double parent_score = Score(g, h);
+    std::vector<Split> splits(num_features);
+    auto f_feature = [&](int, int f) {
+      int num_bins = cuts_[f].size() + 1;
+      if (num_bins < 2) {
+        return;
+      }
+      std::vector<double> hist_g(num_bins, 0.0), hist_h(num_bins, 0.0);
+      std::vector<int64_t> hist_n(num_bins, 0);
+      const uint8_t* col = bins_.data() + f * num_rows;
+      for (size_t i = begin; i < end; ++i) {
+        int64_t r = index_[i];
+        hist_g[col[r]] += grad_[r];
+        hist_h[col[r]] += hess_[r];
+        hist_n[col[r]] += 1;
+      }
+      double gl = 0.0, hl = 0.0;
+      int64_t nl = 0;
+      Split& best = splits[f];
+      for (int b = 0; b + 1 < num_bins; ++b) {
+        gl += hist_g[b];
+        hl += hist_h[b];
+        nl += hist_n[b];
+        int64_t nr = static_cast<int64_t>(end - begin) - nl;
+        double hr = h - hl;
+        if (nl == 0 || nr == 0 || hl < config_.min_child_weight ||
+            hr < config_.min_child_weight) {
+          continue;
+        }
+        double gain = Score(gl, hl) + Score(g - gl, hr) - parent_score;
+        if (gain > config_.gamma && gain > best.gain) {
+          best.gain = gain;
+          best.feature = f;
+          best.bin = b;
+        }
+      }
+    };
+    int64_t work = static_cast<int64_t>(end - begin) * num_features;
+    int num_threads = work >= kMinParallelWork ? config_.num_threads : 1;
+    support::parallel_for_dynamic(0, num_features, num_threads, f_feature);
+    Split result;
+    for (const Split& split : splits) {
+      if (split.feature >= 0 && split.gain > result.gain) {
+        result = split;
+      }
+    }
+    return result;
+  }
+
+  const PackedRows* data_;
+  std::vector<double> labels_;
+  BoostConfig config_;
+  /*! \brief The prediction of each row */
+  std::vector<double> row_pred_;
+  /*! \brief The gradient of each row */
+  std::vector<double> grad_;
+  /*! \brief The hessian of each row */
+  std::vector<double> hess_;
+  /*! \brief The cut points of each feature */
+  std::vector<std::vector<float>> cuts_;
+  /*! \brief The bin of each row in each feature, where bins_[f * num_rows + r] is row r */
+  std::vector<uint8_t> bins_;
+  /*! \brief The rows in the search, partitioned by the nodes of the tree being grown */
+  std::vector<int64_t> index_;
+};
+
+}  // namespace gbdt
+
+/*!
+ * \brief A gradient-boosted decision tree cost model, trained and evaluated in C++ on the
+ *  batched features of the candidates, so that prediction does not go through Python.
+ */
+class GBDTModelNode : public CostModelNode {
+ public:
+  /*! \brief The feature extractor */
+  FeatureExtractor extractor{ffi::UnsafeInit()};
+  /*! \brief The maximum depth of a tree */
+  int max_depth;
+  /*! \brief The learning rate, by which the output of a leaf is shrunk */
+  double eta;
+  /*! \brief The minimum gain of a split */
+  double gamma;
+  /*! \brief The minimum sum of hessians of a child of a split */
+  double min_child_weight;
+  /*! \brief The L2 regularization of the output of a leaf */
+  double reg_lambda;
+  /*! \brief The maximum number of trees trained from scratch */
+  int max_num_trees;
+  /*! \brief The number of rounds without improvement to stop training from scratch after */
+  int early_stopping_rounds;
+  /*! \brief The number of trees added to the model when it is not retrained from scratch */
+  int num_incremental_trees;
+  /*! \brief The number of samples to predict random scores before */
+  int num_warmup_samples;
+  /*! \brief Whether to retrain from scratch only when the data grows by more than 20% */
+  bool adaptive_training;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<GBDTModelNode>()
+        .def_ro("extractor", &GBDTModelNode::extractor)
+        .def_ro("max_depth", &GBDTModelNode::max_depth)
+        .def_ro("eta", &GBDTModelNode::eta)
+        .def_ro("gamma", &GBDTModelNode::gamma)
+        .def_ro("min_child_weight", &GBDTModelNode::min_child_weight)
+        .def_ro("reg_lambda", &GBDTModelNode::reg_lambda)
+        .def_ro("max_num_trees", &GBDTModelNode::max_num_trees)
+        .def_ro("early_stopping_rounds", &GBDTModelNode::early_stopping_rounds)
+        .def_ro("num_incremental_trees", &GBDTModelNode::num_incremental_trees)
+        .def_ro("num_warmup_samples", &GBDTModelNode::num_warmup_samples)
+        .def_ro("adaptive_training", &GBDTModelNode::adaptive_training)
+        .def_ro("data_size", &GBDTModelNode::data_size_);
+  }
+
+  void Load(const ffi::String& path) final {
+    runtime::SimpleBinaryFileStream strm(path, "rb");
+    std::string magic;
+    TVM_FFI_CHECK(strm.Read(&magic) && magic == gbdt::kMagic, ValueError)
+        << "Not a GBDTModel file: " << path;
+    int num_features = 0;
+    int64_t data_size = 0, last_train_size = 0;
+    TRandState rand_state = 0;
+    uint64_t num_groups = 0, num_trees = 0;
+    bool ok = strm.Read(&num_features) && strm.Read(&data_size) && strm.Read(&last_train_size) &&
+              strm.Read(&rand_state) && strm.Read(&num_groups);
+    std::vector<FeatureGroup> groups(ok ? num_groups : 0);
+    for (FeatureGroup& group : groups) {
+      ok = ok && strm.Read(&group.key) && strm.Read(&group.data.rows) &&
+           strm.Read(&group.data.row_ptr) && strm.Read(&group.costs) && strm.Read(&group.min_cost);
+      group.data.num_features = num_features;
+    }
+    ok = ok && strm.Read(&num_trees);
+    std::vector<gbdt::Tree> trees(ok ? num_trees : 0);
+    for (gbdt::Tree& tree : trees) {
+      ok = ok && strm.Read(&tree.feature) && strm.Read(&tree.threshold) && strm.Read(&tree.left) &&
+           strm.Read(&tree.right) && strm.Read(&tree.value);
+    }
+    TVM_FFI_CHECK(ok, ValueError) << "The GBDTModel file is truncated: " << path;
+    num_features_ = num_features;
+    data_size_ = data_size;
+    last_train_size_ = last_train_size;
+    rand_state_ = rand_state;
+    groups_ = std::move(groups);
+    group_index_.clear();
+    for (size_t i = 0; i < groups_.size(); ++i) {
+      group_index_[groups_[i].key] = i;
+    }
+    trees_ = std::move(trees);
+  }
+
+  void Save(const ffi::String& path) final {
+    runtime::SimpleBinaryFileStream strm(path, "wb");
+    strm.Write(std::string(gbdt::kMagic));
+    strm.Write(num_features_);
+    strm.Write(data_size_);
+    strm.Write(last_train_size_);
+    strm.Write(rand_state_);
+    strm.Write(static_cast<uint64_t>(groups_.size()));
+    for (const FeatureGroup& group : groups_) {
+      strm.Write(group.key);
+      strm.Write(group.data.rows);
+      strm.Write(group.data.row_ptr);
+      strm.Write(group.costs);
+      strm.Write(group.min_cost);
+    }
+    strm.Write(static_cast<uint64_t>(trees_.size()));
+    for (const gbdt::Tree& tree : trees_) {
+      strm.Write(tree.feature);
+      strm.Write(tree.threshold);
+      strm.Write(tree.left);
+      strm.Write(tree.right);
+      strm.Write(tree.value);
+    }
+  }
+
+  void Update(const TuneContext& context, const ffi::Array<MeasureCandidate>& candidates,
+              const ffi::Array<RunnerResult>& results) final {
+    TVM_FFI_ICHECK_EQ(candidates.size(), results.size());
+    if (candidates.empty()) {
+      return;
+    }
+    auto _ = Profiler::TimedScope("GBDTModel/Update");
+    // Step 1. Add the features and the costs into the group of the workload
+    FeatureBatch batch;
+    extractor->ExtractBatch(context, candidates, &batch);
+    TVM_FFI_ICHECK_EQ(batch.row_ptr.size(), candidates.size() + 1);
+    std::string key = context->mod.has_value() ? std::string(SHash2Hex(context->mod.value()))
+                                               : std::string();
+    auto it = group_index_.find(key);
+    if (it == group_index_.end()) {
+      it = group_index_.emplace(key, groups_.size()).first;
+      groups_.emplace_back();
+      groups_.back().key = key;
+    }
+    FeatureGroup& group = groups_[it->second];
+    int64_t num_added = 0;
+    for (int i = 0, n = candidates.size(); i < n; ++i) {
+      int64_t num_rows = batch.row_ptr[i + 1] - batch.row_ptr[i];
+      if (num_rows == 0) {
+        continue;
+      }
+      if (num_features_ == 0) {
+        num_features_ = batch.num_features;
+      }
+      TVM_FFI_CHECK_EQ(batch.num_features, num_features_, ValueError)
+          << "The feature extractor returned features of a different length";
+      group.data.num_features = num_features_;
+      group.data.Append(batch.rows.data() + batch.row_ptr[i] * num_features_, num_rows);
+      group.costs.push_back(MedianCost(results[i]));
+      group.min_cost = std::min(group.min_cost, group.costs.back());
+      ++num_added;
+    }
+    if (num_added == 0) {
+      return;
+    }
+    data_size_ += num_added;
+    // Step 2. Retrain from scratch, or add a few trees when the data did not grow much since the
+    // last retraining.
+    gbdt::PackedRows data;
+    std::vector<double> labels;
+    CollectTrainingData(&data, &labels);
+    gbdt::Booster booster(&data, std::move(labels), MakeBoostConfig(context));
+    double rmse = 0.0;
+    if (adaptive_training && !trees_.empty() &&
+        data_size_ - last_train_size_ < last_train_size_ / 5) {
+      if (num_incremental_trees <= 0) {
+        return;
+      }
+      booster.InitPredictions(trees_);
+      rmse = booster.Boost(&trees_, num_incremental_trees, /*early_stopping_rounds=*/0);
+    } else {
+      last_train_size_ = data_size_;
+      trees_.clear();
+      rmse = booster.Boost(&trees_, max_num_trees, early_stopping_rounds);
+    }
+    TVM_PY_LOG(DEBUG, context->logger) << "GBDTModel has " << trees_.size() << " tree(s) on "
+                                       << data_size_ << " sample(s), training RMSE: " << rmse;
+  }
+
+  std::vector<double> Predict(const TuneContext& context,
+                              const ffi::Array<MeasureCandidate>& candidates) final {
+    int n = candidates.size();
+    std::vector<double> result(n, 0.0);
+    if (data_size_ < num_warmup_samples || trees_.empty()) {
+      LinearCongruentialEngine rand(&rand_state_);
+      std::uniform_real_distribution<double> dist(0.0, 1.0);
+      for (double& score : result) {
+        score = dist(rand);
+      }
+      return result;
+    }
+    auto _ = Profiler::TimedScope("GBDTModel/Predict");
+    FeatureBatch batch;
+    extractor->ExtractBatch(context, candidates, &batch);
+    TVM_FFI_ICHECK_EQ(batch.row_ptr.size(), candidates.size() + 1);
+    if (batch.row_ptr.back() == 0) {
+      return result;
+    }
+    TVM_FFI_CHECK_EQ(batch.num_features, num_features_, ValueError)
+        << "The feature extractor returned features of a different length";
+    auto f_predict = [this, &batch, &result](int, int i) {
+      const float* rows = batch.rows.data() + batch.row_ptr[i] * num_features_;
+      int64_t num_rows = batch.row_ptr[i + 1] - batch.row_ptr[i];
+      double score = 0.0;
+      for (const gbdt::Tree& tree : trees_) {
+        for (int64_t r = 0; r < num_rows; ++r) {
+          score += tree.Predict(rows + r * num_features_);
+        }
+      }
+      result[i] = score;
+    };
+    support::parallel_for_dynamic(0, n, std::max(1, context->num_threads), f_predict);
+    return result;
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.GBDTModel", GBDTModelNode,
+                                    CostModelNode);
+
+ private:
+  friend class CostModel;
+
+  /*! \brief The samples measured on a workload. */
+  struct FeatureGroup {
+    /*! \brief The structural hash of the workload */
+    std::string key;
+    /*! \brief The features of the samples */
+    gbdt::PackedRows data;
+    /*! \brief The median run time of each sample */
+    std::vector<double> costs;
+    /*! \brief The minimum of the costs, by which the labels are normalized */
+    double min_cost = std::numeric_limits<double>::infinity();
+  };
+
+  static double MedianCost(const RunnerResult& result) {
+    if (!result->run_secs.has_value() || result->run_secs.value().empty()) {
+      return 1e10;
+    }
+    std::vector<double> secs;
+    for (const FloatImm& sec : result->run_secs.value()) {
+      secs.push_back(sec->value);
+    }
+    std::sort(secs.begin(), secs.end());
+    size_t n = secs.size();
+    return n % 2 == 1 ? secs[n / 2] : (secs[n / 2 - 1] + secs[n / 2]) / 2;
+  }
+
+  /*! \brief Concatenate the groups, labelled by their throughput relative to the best one. */
+  void CollectTrainingData(gbdt::PackedRows* data, std::vector<double>* labels) const {
+    data->num_features = num_features_;
+    data->rows.reserve(std::accumulate(
+        groups_.begin(), groups_.end(), size_t(0),
+        [](size_t n, const FeatureGroup& group) { return n + group.data.rows.size(); }));
+    for (const FeatureGroup& group : groups_) {
+      for (int64_t s = 0; s < group.data.NumSamples(); ++s) {
+        int64_t begin = group.data.row_ptr[s];
+        data->Append(group.data.Row(begin), group.data.row_ptr[s + 1] - begin);
+        double cost = group.costs[s];
+        labels->push_back(cost != 0.0 ? group.min_cost / cost : 0.0);
+      }
+    }
+  }
+
+  gbdt::BoostConfig MakeBoostConfig(const TuneContext& context) const {
+    gbdt::BoostConfig config;
+    config.max_depth = max_depth;
+    config.eta = eta;
+    config.gamma = gamma;
+    config.min_child_weight = min_child_weight;
+    config.reg_lambda = reg_lambda;
+    config.num_threads = std::max(1, context->num_threads);
+    return config;
+  }
+
+  /*! \brief The length of a feature row, 0 before any feature is seen */
+  int num_features_ = 0;
+  /*! \brief The number of samples */
+  int64_t data_size_ = 0;
+  /*! \brief The number of samples when the model was last trained from scratch */
+  int64_t last_train_size_ = 0;
+  /*! \brief The random state for the scores predicted before warm-up */
+  TRandState rand_state_ = 0;
+  /*! \brief The samples, grouped by workload */
+  std::vector<FeatureGroup> groups_;
+  /*! \brief The index of the group of each workload */
+  std::unordered_map<std::string, size_t> group_index_;
+  /*! \brief The trees of the model */
+  std::vector<gbdt::Tree> trees_;
+};
+
+CostModel CostModel::GBDTModel(FeatureExtractor extractor, int max_depth, double eta,
+                               double gamma, double min_child_weight, double reg_lambda,
+                               int max_num_trees, int early_stopping_rounds,
+                               int num_incremental_trees, int num_warmup_samples,
+                               bool adaptive_training, int64_t seed) {
+  TVM_FFI_CHECK_GT(max_depth, 0, ValueError) << "max_depth must be positive";
+  TVM_FFI_CHECK_GT(reg_lambda, 0.0, ValueError) << "reg_lambda must be positive";
+  TVM_FFI_CHECK_GT(max_num_trees, 0, ValueError) << "max_num_trees must be positive";
+  ffi::ObjectPtr<GBDTModelNode> n = ffi::make_object<GBDTModelNode>();
+  n->extractor = std::move(extractor);
+  n->max_depth = max_depth;
+  n->eta = eta;
+  n->gamma = gamma;
+  n->min_child_weight = min_child_weight;
+  n->reg_lambda = reg_lambda;
+  n->max_num_trees = max_num_trees;
+  n->early_stopping_rounds = early_stopping_rounds;
+  n->num_incremental_trees = num_incremental_trees;
+  n->num_warmup_samples = num_warmup_samples;
+  n->adaptive_training = adaptive_training;
+  n->rand_state_ = LinearCongruentialEngine::NormalizeSeed(seed);
+  return CostModel(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  GBDTModelNode::RegisterReflection();
+  refl::GlobalDef().def("s_tir.meta_schedule.CostModelGBDTModel", CostModel::GBDTModel);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
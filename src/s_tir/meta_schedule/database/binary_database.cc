@@ -0,0 +1,442 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/ir/serialization.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+#include "../module_equality.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+/*!
+ * \brief The on-disk layout of a binary database.
+ *
+ *  The file starts with kMagic and is followed by entries, each of which is an EntryHeader and
+ *  a payload of `size` bytes. The payload of a workload is its JSON text, or, for the workloads
+ *  committed since the binary IR form, its structural hash and its module in that form, which
+ *  loads without parsing the JSON graph. The payload of a tuning record is a RecordHeader, its
+ *  run times as doubles, and the JSON text of the record.
+ *  The run times are stored in binary so that the records can be indexed and sorted without
+ *  parsing their JSON, which is only done once a record is selected. All integers are in the
+ *  byte order of the host.
+ */
+namespace binary_format {
+
+constexpr const char kMagic[8] = {'T', 'V', 'M', 'M', 'S', 'D', 'B', '1'};
+
+enum EntryKind : uint32_t {
+  kWorkload = 0,
+  kTuningRecord = 1,
+  kBinaryWorkload = 2,
+};
+
+struct EntryHeader {
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t size;
+};
+
+struct RecordHeader {
+  /*! \brief The index of the workload among the workload entries of the file */
+  uint32_t workload_index;
+  /*! \brief The number of run times, kNoRunSecs if the record has no run times */
+  uint32_t num_run_secs;
+};
+
+constexpr uint32_t kNoRunSecs = 0xFFFFFFFF;
+
+/*! \brief Serialize an entry. */
+std::string MakeEntry(EntryKind kind, const std::string& payload) {
+  EntryHeader header{kind, 0, payload.size()};
+  std::string entry(sizeof(header), '\0');
+  std::memcpy(entry.data(), &header, sizeof(header));
+  return entry + payload;
+}
+
+/*! \brief Serialize the payload of a workload in the binary IR form. */
+std::string MakeBinaryWorkloadPayload(const Workload& workload) {
+  uint64_t shash = workload->shash;
+  std::string payload(sizeof(shash), '\0');
+  std::memcpy(payload.data(), &shash, sizeof(shash));
+  return payload + SaveBinary(workload->mod);
+}
+
+/*! \brief Parse a workload entry of either kind. */
+Workload ParseWorkloadPayload(uint32_t kind, const std::string& payload) {
+  if (kind == kWorkload) {
+    return Workload::FromJSON(JSONLoads(payload).cast<ffi::ObjectRef>());
+  }
+  uint64_t shash;
+  TVM_FFI_CHECK_GE(payload.size(), sizeof(shash), ValueError)
+      << "Corrupted workload entry in a binary tuning database";
+  std::memcpy(&shash, payload.data(), sizeof(shash));
+  std::string_view mod(payload.data() + sizeof(shash), payload.size() - sizeof(shash));
+  return Workload(LoadBinary(mod).cast<IRModule>(), static_cast<Workload::THashCode>(shash));
+}
+
+/*! \brief Serialize the payload of a tuning record from its workload index and JSON form. */
+std::string MakeRecordPayload(uint32_t workload_index,
+                              const ffi::Optional<ffi::Array<FloatImm>>& run_secs,
+                              const std::string& record_json) {
+  std::vector<double> values;
+  if (run_secs.has_value()) {
+    for (const FloatImm& run_sec : run_secs.value()) {
+      values.push_back(run_sec->value);
+    }
+  }
+  RecordHeader header{workload_index, run_secs.has_value()
+                                          ? static_cast<uint32_t>(values.size())
+                                          : kNoRunSecs};
+  std::string payload(sizeof(header) + values.size() * sizeof(double), '\0');
+  std::memcpy(payload.data(), &header, sizeof(header));
+  std::memcpy(payload.data() + sizeof(header), values.data(), values.size() * sizeof(double));
+  return payload + record_json;
+}
+
+/*! \brief Append entries to a binary database file in a single write. */
+void AppendEntries(const std::string& path, const std::string& entries) {
+  std::ofstream os;
+  os.rdbuf()->pubsetbuf(nullptr, 0);
+  os.open(path, std::ofstream::app | std::ofstream::binary);
+  TVM_FFI_CHECK(os.good(), ValueError) << "Cannot open the file to write: " << path;
+  os.write(entries.data(), entries.size());
+  os.flush();
+}
+
+/*! \brief Create a binary database file with no entries. */
+void CreateFile(const std::string& path) {
+  std::ofstream os(path, std::ofstream::binary);
+  TVM_FFI_CHECK(os.good(), ValueError) << "Cannot create new file: " << path;
+  os.write(kMagic, sizeof(kMagic));
+}
+
+}  // namespace binary_format
+
+/*!
+ * \brief A database in a single binary file, which indexes the tuning records by their run times
+ *  on load and decodes the trace and the other fields of a record only when it is selected.
+ */
+class BinaryDatabaseNode : public DatabaseNode {
+ public:
+  explicit BinaryDatabaseNode(ffi::String mod_eq_name = "structural")
+      : DatabaseNode(mod_eq_name),
+        workloads2idx_(/*bucket_count*/ 0, WorkloadHash(), WorkloadEqual(GetModuleEquality())) {}
+
+  /*! \brief The path to the database file */
+  ffi::String path;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<BinaryDatabaseNode>().def_ro("path", &BinaryDatabaseNode::path);
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.BinaryDatabase", BinaryDatabaseNode,
+                                    DatabaseNode);
+
+ private:
+  /*! \brief A tuning record in the index, decoded on first use. */
+  struct RecordEntry {
+    /*! \brief The offset of the JSON text of the record in the file */
+    uint64_t offset;
+    /*! \brief The bytes of the JSON text of the record */
+    uint64_t size;
+    /*! \brief Whether the record has a run time other than the stub of a failed run */
+    bool has_valid_run_secs;
+    /*! \brief The decoded record */
+    ffi::Optional<TuningRecord> record;
+  };
+  /*! \brief The records of a workload by mean run time, ordered by insertion among equals. */
+  using RecordIndex = std::multimap<double, RecordEntry>;
+
+  /*! \brief All the workloads in the database */
+  std::unordered_map<Workload, int, WorkloadHash, WorkloadEqual> workloads2idx_;
+  /*! \brief The workloads by their index in the file */
+  std::vector<Workload> workloads_;
+  /*! \brief The records of each workload, by workload index */
+  std::vector<RecordIndex> records_;
+  /*! \brief The number of tuning records */
+  int64_t num_records_ = 0;
+
+ public:
+  /*! \brief Read the workloads and the record index from the database file. */
+  void Load(ffi::String path, bool allow_missing) {
+    namespace fmt = binary_format;
+    this->path = path;
+    std::ifstream is(path, std::ifstream::binary);
+    if (!is.good()) {
+      TVM_FFI_CHECK(allow_missing, ValueError) << "File doesn't exist: " << path;
+      fmt::CreateFile(path);
+      return;
+    }
+    char magic[sizeof(fmt::kMagic)];
+    TVM_FFI_CHECK(is.read(magic, sizeof(magic)) && !std::memcmp(magic, fmt::kMagic, sizeof(magic)),
+                  ValueError)
+        << "Not a binary tuning database: " << path;
+    is.seekg(0, std::ifstream::end);
+    uint64_t file_size = is.tellg();
+    is.seekg(sizeof(magic));
+    std::vector<std::pair<uint32_t, std::string>> workload_payloads;
+    std::vector<std::pair<uint32_t, std::pair<double, RecordEntry>>> records;
+    for (fmt::EntryHeader header; is.read(reinterpret_cast<char*>(&header), sizeof(header));) {
+      uint64_t begin = is.tellg();
+      uint64_t end = begin + header.size;
+      // A trailing entry that was cut short by an interrupted write is ignored.
+      if (end > file_size) {
+        break;
+      }
+      if (header.kind == fmt::kWorkload || header.kind == fmt::kBinaryWorkload) {
+        std::string payload(header.size, '\0');
+        is.read(payload.data(), header.size);
+        workload_payloads.emplace_back(header.kind, std::move(payload));
+      } else if (header.kind == fmt::kTuningRecord) {
+        fmt::RecordHeader record_header;
+        TVM_FFI_CHECK_GE(header.size, sizeof(record_header), ValueError)
+            << "Corrupted binary tuning database " << path << " at offset " << begin;
+        is.read(reinterpret_cast<char*>(&record_header), sizeof(record_header));
+        std::vector<double> run_secs;
+        if (record_header.num_run_secs != fmt::kNoRunSecs) {
+          run_secs.resize(record_header.num_run_secs);
+          TVM_FFI_CHECK_LE(sizeof(record_header) + run_secs.size() * sizeof(double), header.size,
+                           ValueError)
+              << "Corrupted binary tuning database " << path << " at offset " << begin;
+          is.read(reinterpret_cast<char*>(run_secs.data()), run_secs.size() * sizeof(double));
+        }
+        RecordEntry entry;
+        entry.offset = is.tellg();
+        entry.size = end - entry.offset;
+        entry.has_valid_run_secs = std::any_of(run_secs.begin(), run_secs.end(), [](double v) {
+          return v != SortTuningRecordByMeanRunSecs::kMaxMeanTime;
+        });
+        double mean = SortTuningRecordByMeanRunSecs::kMaxMeanTime;
+        if (!run_secs.empty()) {
+          mean = std::accumulate(run_secs.begin(), run_secs.end(), 0.0) / run_secs.size();
+        }
+        records.push_back({record_header.workload_index, {mean, std::move(entry)}});
+      }
+      is.seekg(end);
+    }
+    // Decode the workloads, which the lookups need, in parallel.
+    int num_threads = std::thread::hardware_concurrency();
+    std::vector<Workload> workloads(workload_payloads.size(), Workload{ffi::UnsafeInit()});
+    support::parallel_for_dynamic(
+        0, workload_payloads.size(), num_threads, [&](int thread_id, int task_id) {
+          const auto& [kind, payload] = workload_payloads[task_id];
+          Workload workload = fmt::ParseWorkloadPayload(kind, payload);
+          auto recalc_hash = GetModuleEquality().Hash(workload->mod);
+          if (recalc_hash != workload->shash) {
+            ffi::ObjectPtr<WorkloadNode> wkl = ffi::make_object<WorkloadNode>(*workload.get());
+            wkl->shash = recalc_hash;
+            workload = Workload(wkl);
+          }
+          workloads[task_id] = workload;
+        });
+    std::vector<int> file2idx;
+    file2idx.reserve(workloads.size());
+    for (const Workload& workload : workloads) {
+      file2idx.push_back(this->AddWorkload(workload));
+    }
+    for (auto& [workload_index, record] : records) {
+      TVM_FFI_CHECK_LT(workload_index, file2idx.size(), ValueError)
+          << "Corrupted binary tuning database " << path << ": a tuning record refers to the "
+          << "unknown workload #" << workload_index;
+      this->records_[file2idx[workload_index]].insert(std::move(record));
+      ++num_records_;
+    }
+  }
+
+  bool HasWorkload(const IRModule& mod) {
+    return workloads2idx_.find(Workload(mod, GetModuleEquality().Hash(mod))) !=
+           workloads2idx_.end();
+  }
+
+  Workload CommitWorkload(const IRModule& mod) {
+    Workload workload(mod, GetModuleEquality().Hash(mod));
+    auto it = workloads2idx_.find(workload);
+    if (it != workloads2idx_.end()) {
+      return it->first;
+    }
+    binary_format::AppendEntries(
+        path, binary_format::MakeEntry(binary_format::kBinaryWorkload,
+                                       binary_format::MakeBinaryWorkloadPayload(workload)));
+    return workloads_[this->AddWorkload(workload)];
+  }
+
+  void CommitTuningRecord(const TuningRecord& record) {
+    auto it = workloads2idx_.find(record->workload);
+    TVM_FFI_CHECK(it != workloads2idx_.end(), ValueError)
+        << "The workload of the tuning record is not committed to the database";
+    binary_format::AppendEntries(
+        path, binary_format::MakeEntry(
+                  binary_format::kTuningRecord,
+                  binary_format::MakeRecordPayload(it->second, record->run_secs,
+                                                   JSONDumps(record->AsJSON()))));
+    RecordEntry entry{0, 0, true, record};
+    double mean = SortTuningRecordByMeanRunSecs::Mean(record->run_secs.value_or({}));
+    this->records_[it->second].insert({mean, std::move(entry)});
+    ++num_records_;
+  }
+
+  ffi::Array<TuningRecord> GetTopK(const Workload& workload, int top_k) {
+    TVM_FFI_CHECK_GE(top_k, 0, ValueError) << "top_k must be non-negative";
+    if (top_k == 0) {
+      return {};
+    }
+    auto it = workloads2idx_.find(workload);
+    if (it == workloads2idx_.end()) {
+      return {};
+    }
+    ffi::Array<TuningRecord> results;
+    results.reserve(top_k);
+    for (auto& [mean, entry] : this->records_[it->second]) {
+      // Records without a successful run are invalid, skip them before decoding.
+      if (!entry.has_valid_run_secs) {
+        continue;
+      }
+      TuningRecord record = this->Decode(&entry, it->first);
+      if (!record->IsValid()) {
+        continue;
+      }
+      results.push_back(record);
+      if (results.size() == static_cast<size_t>(top_k)) {
+        break;
+      }
+    }
+    return results;
+  }
+
+  ffi::Array<TuningRecord> GetAllTuningRecords() {
+    std::vector<std::pair<double, TuningRecord>> records;
+    records.reserve(num_records_);
+    for (size_t i = 0; i < records_.size(); ++i) {
+      for (auto& [mean, entry] : records_[i]) {
+        records.emplace_back(mean, this->Decode(&entry, workloads_[i]));
+      }
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    ffi::Array<TuningRecord> results;
+    results.reserve(records.size());
+    for (auto& [mean, record] : records) {
+      results.push_back(std::move(record));
+    }
+    return results;
+  }
+
+  int64_t Size() { return num_records_; }
+
+ private:
+  /*!
+   * \brief Add the next workload entry of the file, returning the index of its records. A
+   *  workload that is in the file twice keeps the records of its first entry.
+   */
+  int AddWorkload(const Workload& workload) {
+    int file_index = workloads_.size();
+    auto [it, inserted] = workloads2idx_.emplace(workload, file_index);
+    workloads_.push_back(it->first);
+    records_.emplace_back();
+    return it->second;
+  }
+
+  TuningRecord Decode(RecordEntry* entry, const Workload& workload) {
+    if (!entry->record.has_value()) {
+      std::ifstream is(path, std::ifstream::binary);
+      std::string json(entry->size, '\0');
+      TVM_FFI_CHECK(is.seekg(entry->offset) && is.read(json.data(), entry->size), ValueError)
+          << "Cannot read the tuning record at offset " << entry->offset << " of " << path;
+      entry->record = TuningRecord::FromJSON(JSONLoads(json).cast<ffi::ObjectRef>(), workload);
+    }
+    return entry->record.value();
+  }
+};
+
+Database Database::BinaryDatabase(ffi::String path, bool allow_missing, ffi::String mod_eq_name) {
+  ffi::ObjectPtr<BinaryDatabaseNode> n = ffi::make_object<BinaryDatabaseNode>(mod_eq_name);
+  n->Load(path, allow_missing);
+  return Database(n);
+}
+
+/*!
+ * \brief Convert the two files of a JSON database to a binary database file. Neither the
+ *  workloads nor the traces are rebuilt, only the JSON text of the entries is moved.
+ * \param path_workload The path to the workload table of the JSON database.
+ * \param path_tuning_record The path to the tuning record table of the JSON database.
+ * \param path The path to the binary database file to write.
+ */
+void ConvertJSONDatabaseToBinary(ffi::String path_workload, ffi::String path_tuning_record,
+                                 ffi::String path) {
+  namespace fmt = binary_format;
+  std::string entries;
+  uint32_t num_workloads = 0;
+  {
+    std::ifstream is(path_workload);
+    TVM_FFI_CHECK(is.good(), ValueError) << "File doesn't exist: " << path_workload;
+    for (std::string line; std::getline(is, line);) {
+      if (!line.empty()) {
+        entries += fmt::MakeEntry(fmt::kWorkload, line);
+        ++num_workloads;
+      }
+    }
+  }
+  int num_threads = std::thread::hardware_concurrency();
+  std::vector<Any> json_objs = JSONFileReadLines(path_tuning_record, num_threads, false);
+  for (size_t i = 0; i < json_objs.size(); ++i) {
+    ffi::Array<Any> json = json_objs[i].cast<ffi::Array<Any>>();
+    TVM_FFI_CHECK_EQ(json.size(), 2, ValueError)
+        << "Unable to parse TuningRecord, on line " << (i + 1) << " of file "
+        << path_tuning_record;
+    int64_t workload_index = json[0].cast<IntImm>()->value;
+    TVM_FFI_CHECK(workload_index >= 0 && workload_index < num_workloads, ValueError)
+        << "Unknown workload #" << workload_index << ", on line " << (i + 1) << " of file "
+        << path_tuning_record;
+    ffi::Array<Any> record = json[1].cast<ffi::Array<Any>>();
+    TVM_FFI_CHECK_EQ(record.size(), 4, ValueError)
+        << "Unable to parse TuningRecord, on line " << (i + 1) << " of file "
+        << path_tuning_record;
+    ffi::Optional<ffi::Array<FloatImm>> run_secs;
+    if (record[1] != nullptr) {
+      run_secs = AsFloatArray(record[1].cast<ffi::ObjectRef>());
+    }
+    entries += fmt::MakeEntry(fmt::kTuningRecord,
+                              fmt::MakeRecordPayload(workload_index, run_secs, JSONDumps(record)));
+  }
+  fmt::CreateFile(path);
+  fmt::AppendEntries(path, entries);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { BinaryDatabaseNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef()
+      .def("s_tir.meta_schedule.DatabaseBinaryDatabase", Database::BinaryDatabase)
+      .def("s_tir.meta_schedule.DatabaseConvertJSONToBinary", ConvertJSONDatabaseToBinary);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
@@ -62,11 +62,17 @@ std::vector<Any> JSONFileReadLines(const ffi::String& path, int num_threads, boo
  * \brief Append a line to a json file.
  * \param path The path to the json file.
  * \param line The line to append.
+ * \note The line goes out in a single unbuffered write to a file opened for appending, so that
+ *  the lines appended by concurrent tuners do not interleave.
  */
 void JSONFileAppendLine(const ffi::String& path, const std::string& line) {
-  std::ofstream os(path, std::ofstream::app);
+  std::ofstream os;
+  os.rdbuf()->pubsetbuf(nullptr, 0);
+  os.open(path, std::ofstream::app);
   TVM_FFI_CHECK(os.good(), ValueError) << "Cannot open the file to write: " << path;
-  os << line << std::endl;
+  std::string buffer = line + '\n';
+  os.write(buffer.data(), buffer.size());
+  os.flush();
 }
 
 /*! \brief The default database implementation, which mimics two database tables with two files. */
@@ -74,7 +80,9 @@ class JSONDatabaseNode : public DatabaseNode {
  public:
   explicit JSONDatabaseNode(ffi::String mod_eq_name = "structural")
       : DatabaseNode(mod_eq_name),
-        workloads2idx_(/*bucket_count*/ 0, WorkloadHash(), WorkloadEqual(GetModuleEquality())) {}
+        workloads2idx_(/*bucket_count*/ 0, WorkloadHash(), WorkloadEqual(GetModuleEquality())),
+        workload2records_(/*bucket_count*/ 0, WorkloadHash(),
+                          WorkloadEqual(GetModuleEquality())) {}
 
   /*! \brief The path to the workload table */
   ffi::String path_workload;
@@ -84,6 +92,10 @@ class JSONDatabaseNode : public DatabaseNode {
   std::unordered_map<Workload, int, WorkloadHash, WorkloadEqual> workloads2idx_;
   /*! \brief All the tuning records in the database */
   std::multiset<TuningRecord, SortTuningRecordByMeanRunSecs> tuning_records_;
+  /*! \brief The tuning records of each workload, sorted by mean run time */
+  std::unordered_map<Workload, std::multiset<TuningRecord, SortTuningRecordByMeanRunSecs>,
+                     WorkloadHash, WorkloadEqual>
+      workload2records_;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -114,7 +126,7 @@ class JSONDatabaseNode : public DatabaseNode {
   }
 
   void CommitTuningRecord(const TuningRecord& record) {
-    this->tuning_records_.insert(record);
+    this->AddTuningRecord(record);
     JSONFileAppendLine(
         this->path_tuning_record,
         JSONDumps(ffi::Array<Any>{
@@ -128,19 +140,19 @@ class JSONDatabaseNode : public DatabaseNode {
     if (top_k == 0) {
       return {};
     }
+    auto it = this->workload2records_.find(workload);
+    if (it == this->workload2records_.end()) {
+      return {};
+    }
     ffi::Array<TuningRecord> results;
     results.reserve(top_k);
-    for (const TuningRecord& record : this->tuning_records_) {
-      auto run_secs = record->run_secs;
+    for (const TuningRecord& record : it->second) {
       if (!record->IsValid()) {
         continue;
       }
-      if (record->workload.same_as(workload) ||
-          WorkloadEqual(GetModuleEquality())(record->workload, workload)) {
-        results.push_back(record);
-        if (results.size() == static_cast<size_t>(top_k)) {
-          break;
-        }
+      results.push_back(record);
+      if (results.size() == static_cast<size_t>(top_k)) {
+        break;
       }
     }
     return results;
@@ -156,6 +168,12 @@ class JSONDatabaseNode : public DatabaseNode {
   }
 
   int64_t Size() { return tuning_records_.size(); }
+
+  /*! \brief Add a tuning record to the in-memory tables. */
+  void AddTuningRecord(const TuningRecord& record) {
+    this->tuning_records_.insert(record);
+    this->workload2records_[record->workload].insert(record);
+  }
 };
 
 Database Database::JSONDatabase(ffi::String path_workload, ffi::String path_tuning_record,
@@ -211,7 +229,7 @@ Database Database::JSONDatabase(ffi::String path_workload, ffi::String path_tuni
           }
         });
     for (const TuningRecord& record : records) {
-      n->tuning_records_.insert(record);
+      n->AddTuningRecord(record);
     }
   }
   n->path_workload = path_workload;
@@ -0,0 +1,297 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/reflection/registry.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "../module_equality.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+/*!
+ * \brief Read the complete lines of a file, dropping a trailing line that a concurrent tuner
+ *  is still appending.
+ * \param path The path to the file.
+ * \return The complete lines, empty when the file does not exist.
+ */
+std::vector<std::string> ReadCompleteLines(const std::string& path) {
+  std::ifstream is(path, std::ifstream::binary);
+  if (!is.good()) {
+    return {};
+  }
+  std::stringstream buffer;
+  buffer << is.rdbuf();
+  std::string content = buffer.str();
+  std::vector<std::string> lines;
+  size_t begin = 0;
+  for (size_t end; (end = content.find('\n', begin)) != std::string::npos; begin = end + 1) {
+    if (end > begin) {
+      lines.push_back(content.substr(begin, end - begin));
+    }
+  }
+  return lines;
+}
+
+/*!
+ * \brief The key of a workload in the shard files, a hash of its JSON form that is stable
+ *  across processes, so that concurrent tuners agree on it.
+ */
+std::string ShardWorkloadKey(const std::string& workload_json) {
+  // 64-bit FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : workload_json) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+  std::ostringstream os;
+  os << std::hex << hash;
+  return os.str();
+}
+
+/*!
+ * \brief A database that shards its workloads and tuning records over the files of a
+ *  directory, by the hash of the workload.
+ *
+ *  Shard `i` is the pair of files `workloads.<i>.json` and `records.<i>.json`. A shard is only
+ *  read the first time one of its workloads is looked up, and it indexes the records of each
+ *  workload sorted by mean run time, so a lookup neither reads nor scans the other workloads.
+ *  The files are append-only. A workload line is [key, workload] and a record line is
+ *  [key, record], where the key identifies the workload by content rather than by line
+ *  number, so that concurrent tuners can append to the same shard.
+ */
+class ShardedJSONDatabaseNode : public DatabaseNode {
+ public:
+  explicit ShardedJSONDatabaseNode(ffi::String mod_eq_name = "structural")
+      : DatabaseNode(mod_eq_name) {}
+
+  /*! \brief The directory of the shards */
+  ffi::String path;
+  /*! \brief The number of shards */
+  int64_t num_shards;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<ShardedJSONDatabaseNode>()
+        .def_ro("path", &ShardedJSONDatabaseNode::path)
+        .def_ro("num_shards", &ShardedJSONDatabaseNode::num_shards);
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.ShardedJSONDatabase",
+                                    ShardedJSONDatabaseNode, DatabaseNode);
+
+ private:
+  /*! \brief A workload of a shard and its records. */
+  struct Entry {
+    /*! \brief The key of the workload in the shard files */
+    std::string key;
+    /*! \brief The tuning records of the workload, sorted by mean run time */
+    std::multiset<TuningRecord, SortTuningRecordByMeanRunSecs> records;
+  };
+
+  /*! \brief The loaded workloads of a shard. */
+  struct Shard {
+    explicit Shard(const ModuleEquality& mod_eq)
+        : workloads(/*bucket_count*/ 0, WorkloadHash(), WorkloadEqual(mod_eq)) {}
+    std::unordered_map<Workload, Entry, WorkloadHash, WorkloadEqual> workloads;
+  };
+
+  /*! \brief The shards, nullptr until they are loaded */
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+ public:
+  /*! \brief Prepare the shards of the database, without reading them. */
+  void Init(ffi::String path, int64_t num_shards, bool allow_missing) {
+    TVM_FFI_CHECK_GT(num_shards, 0, ValueError) << "num_shards must be positive";
+    if (!std::filesystem::is_directory(std::string(path))) {
+      TVM_FFI_CHECK(allow_missing, ValueError) << "Directory doesn't exist: " << path;
+      std::filesystem::create_directories(std::string(path));
+    }
+    this->path = path;
+    this->num_shards = num_shards;
+    this->shards_.resize(num_shards);
+  }
+
+  bool HasWorkload(const IRModule& mod) {
+    size_t shash = GetModuleEquality().Hash(mod);
+    Shard* shard = this->GetShard(shash);
+    return shard->workloads.count(Workload(mod, shash)) != 0;
+  }
+
+  Workload CommitWorkload(const IRModule& mod) {
+    size_t shash = GetModuleEquality().Hash(mod);
+    Shard* shard = this->GetShard(shash);
+    auto [it, inserted] = shard->workloads.emplace(Workload(mod, shash), Entry());
+    if (inserted) {
+      std::string workload_json = JSONDumps(it->first->AsJSON());
+      it->second.key = ShardWorkloadKey(workload_json);
+      JSONFileAppendLine(this->ShardFile("workloads", shash),
+                         "[\"" + it->second.key + "\"," + workload_json + "]");
+    }
+    return it->first;
+  }
+
+  void CommitTuningRecord(const TuningRecord& record) {
+    const Workload& workload = record->workload;
+    Shard* shard = this->GetShard(workload->shash);
+    auto it = shard->workloads.find(workload);
+    TVM_FFI_CHECK(it != shard->workloads.end(), ValueError)
+        << "The workload of the tuning record is not committed to the database";
+    it->second.records.insert(record);
+    JSONFileAppendLine(this->ShardFile("records", workload->shash),
+                       "[\"" + it->second.key + "\"," + JSONDumps(record->AsJSON()) + "]");
+  }
+
+  ffi::Array<TuningRecord> GetTopK(const Workload& workload, int top_k) {
+    TVM_FFI_CHECK_GE(top_k, 0, ValueError) << "top_k must be non-negative";
+    if (top_k == 0) {
+      return {};
+    }
+    Shard* shard = this->GetShard(workload->shash);
+    auto it = shard->workloads.find(workload);
+    if (it == shard->workloads.end()) {
+      return {};
+    }
+    ffi::Array<TuningRecord> results;
+    results.reserve(top_k);
+    for (const TuningRecord& record : it->second.records) {
+      if (!record->IsValid()) {
+        continue;
+      }
+      results.push_back(record);
+      if (results.size() == static_cast<size_t>(top_k)) {
+        break;
+      }
+    }
+    return results;
+  }
+
+  ffi::Array<TuningRecord> GetAllTuningRecords() {
+    ffi::Array<TuningRecord> results;
+    for (int64_t i = 0; i < num_shards; ++i) {
+      for (const auto& [workload, entry] : this->GetShardByIndex(i)->workloads) {
+        results.insert(results.end(), entry.records.begin(), entry.records.end());
+      }
+    }
+    return results;
+  }
+
+  int64_t Size() {
+    int64_t size = 0;
+    for (int64_t i = 0; i < num_shards; ++i) {
+      for (const auto& [workload, entry] : this->GetShardByIndex(i)->workloads) {
+        size += entry.records.size();
+      }
+    }
+    return size;
+  }
+
+ private:
+  std::string ShardFile(const std::string& table, size_t shash) const {
+    return this->ShardFileByIndex(table, shash % num_shards);
+  }
+
+  std::string ShardFileByIndex(const std::string& table, int64_t index) const {
+    return std::string(path) + "/" + table + "." + std::to_string(index) + ".json";
+  }
+
+  Shard* GetShard(size_t shash) { return this->GetShardByIndex(shash % num_shards); }
+
+  Shard* GetShardByIndex(int64_t index) {
+    if (shards_[index] == nullptr) {
+      shards_[index] = this->LoadShard(index);
+    }
+    return shards_[index].get();
+  }
+
+  std::unique_ptr<Shard> LoadShard(int64_t index) {
+    int num_threads = std::thread::hardware_concurrency();
+    auto shard = std::make_unique<Shard>(GetModuleEquality());
+    std::unordered_map<std::string, Workload> key2workload;
+    // Read the workloads before the records: a tuner appends a workload before its records,
+    // so the records whose workload is not read yet are newer than this snapshot.
+    std::vector<std::string> workload_lines =
+        ReadCompleteLines(ShardFileByIndex("workloads", index));
+    std::vector<std::string> record_lines = ReadCompleteLines(ShardFileByIndex("records", index));
+    for (const std::string& line : workload_lines) {
+      ffi::Array<Any> json = JSONLoads(line).cast<ffi::Array<Any>>();
+      TVM_FFI_ICHECK_EQ(json.size(), 2);
+      std::string key = json[0].cast<std::string>();
+      Workload workload = Workload::FromJSON(json[1].cast<ffi::ObjectRef>());
+      auto recalc_hash = GetModuleEquality().Hash(workload->mod);
+      if (recalc_hash != workload->shash) {
+        ffi::ObjectPtr<WorkloadNode> wkl = ffi::make_object<WorkloadNode>(*workload.get());
+        wkl->shash = recalc_hash;
+        workload = Workload(wkl);
+      }
+      // Concurrent tuners may both append a new workload, keep the first one.
+      auto [it, inserted] = shard->workloads.emplace(workload, Entry());
+      if (inserted) {
+        it->second.key = key;
+      }
+      key2workload.emplace(key, it->first);
+    }
+    std::vector<TuningRecord> records(record_lines.size(), TuningRecord{ffi::UnsafeInit()});
+    // not std::vector<bool>, which the parsing threads cannot write concurrently
+    std::vector<char> has_workload(record_lines.size(), false);
+    support::parallel_for_dynamic(
+        0, record_lines.size(), num_threads, [&](int thread_id, int task_id) {
+          ffi::Array<Any> json = JSONLoads(record_lines[task_id]).cast<ffi::Array<Any>>();
+          TVM_FFI_ICHECK_EQ(json.size(), 2);
+          auto it = key2workload.find(json[0].cast<std::string>());
+          if (it == key2workload.end()) {
+            return;
+          }
+          records[task_id] = TuningRecord::FromJSON(json[1].cast<ffi::ObjectRef>(), it->second);
+          has_workload[task_id] = true;
+        });
+    for (size_t i = 0; i < records.size(); ++i) {
+      if (has_workload[i]) {
+        shard->workloads.at(records[i]->workload).records.insert(records[i]);
+      }
+    }
+    return shard;
+  }
+};
+
+Database Database::ShardedJSONDatabase(ffi::String path, int num_shards, bool allow_missing,
+                                       ffi::String mod_eq_name) {
+  ffi::ObjectPtr<ShardedJSONDatabaseNode> n =
+      ffi::make_object<ShardedJSONDatabaseNode>(mod_eq_name);
+  n->Init(path, num_shards, allow_missing);
+  return Database(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { ShardedJSONDatabaseNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("s_tir.meta_schedule.DatabaseShardedJSONDatabase",
+                        Database::ShardedJSONDatabase);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
@@ -24,6 +24,41 @@ namespace tvm {
 namespace s_tir {
 namespace meta_schedule {
 
+void FeatureExtractorNode::ExtractBatch(const TuneContext& context,
+                                        const ffi::Array<MeasureCandidate>& candidates,
+                                        FeatureBatch* batch) {
+  ffi::Array<tvm::runtime::Tensor> features = this->ExtractFrom(context, candidates);
+  TVM_FFI_ICHECK_EQ(features.size(), candidates.size());
+  batch->num_features = 0;
+  batch->rows.clear();
+  batch->row_ptr.assign(1, 0);
+  for (const tvm::runtime::Tensor& tensor : features) {
+    TVM_FFI_CHECK_EQ(tensor->ndim, 2, ValueError) << "The features must be a 2-D tensor";
+    TVM_FFI_CHECK_EQ(tensor->device.device_type, kDLCPU, ValueError)
+        << "The features must be on CPU";
+    int64_t num_rows = tensor->shape[0];
+    int num_features = static_cast<int>(tensor->shape[1]);
+    if (num_rows > 0 && batch->num_features != num_features) {
+      TVM_FFI_CHECK_EQ(batch->row_ptr.back(), 0, ValueError)
+          << "The features of the candidates have different lengths";
+      batch->num_features = num_features;
+    }
+    const char* data = static_cast<const char*>(tensor->data) + tensor->byte_offset;
+    int64_t size = num_rows * num_features;
+    DLDataType dtype = tensor->dtype;
+    if (dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1) {
+      const float* values = reinterpret_cast<const float*>(data);
+      batch->rows.insert(batch->rows.end(), values, values + size);
+    } else if (dtype.code == kDLFloat && dtype.bits == 64 && dtype.lanes == 1) {
+      const double* values = reinterpret_cast<const double*>(data);
+      batch->rows.insert(batch->rows.end(), values, values + size);
+    } else {
+      TVM_FFI_THROW(ValueError) << "The features must be float32 or float64";
+    }
+    batch->row_ptr.push_back(batch->row_ptr.back() + num_rows);
+  }
+}
+
 ffi::Array<tvm::runtime::Tensor> PyFeatureExtractorNode::ExtractFrom(
     const TuneContext& context, const ffi::Array<MeasureCandidate>& candidates) {
   TVM_FFI_ICHECK(f_extract_from != nullptr)
@@ -22,7 +22,9 @@
 #include <tvm/tirx/transform.h>
 
 #include <cmath>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -219,31 +221,6 @@ int64_t GetVarStride(const std::vector<MultiIndex>& multi_indices, const IntVec&
   return (result == kNotFound) ? 0 : result;
 }
 
-/*!
- * \brief Converts a 2-dimensional STL vector to a TVM Tensor
- * \param src The source 2-dimensional STL vector
- * \param second_dim_size The length of the second dimension. When the first dim of src is 0,
- * second_dim_size must be specified, and in such case the shape of the result Tensor is
- * (0, second_dim_size).
- * \return The converted TVM Tensor
- */
-runtime::Tensor AsTensor(const std::vector<std::vector<double>>& src, int second_dim_size = -1) {
-  int n = src.size();
-  TVM_FFI_ICHECK(!src.empty() || second_dim_size != -1);
-  int m = src.empty() ? second_dim_size : src[0].size();
-  runtime::Tensor tgt = runtime::Tensor::Empty(
-      /*shape=*/{n, m},
-      /*dtype=*/DLDataType{kDLFloat, 64, 1},
-      /*ctx=*/DLDevice{kDLCPU, 0});
-  double* data = static_cast<double*>(tgt->data);
-  for (const std::vector<double>& row : src) {
-    for (double v : row) {
-      *data++ = v;
-    }
-  }
-  return tgt;
-}
-
 }  // namespace utils
 
 namespace transform {
@@ -1378,6 +1355,8 @@ class PerStoreFeatureNode : public FeatureExtractorNode {
   int cache_line_bytes;
   bool extract_workload;
   int feature_vector_length;
+  /*! \brief The number of scheduled modules whose features are cached, 0 to disable caching */
+  int cache_size;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -1387,64 +1366,200 @@ class PerStoreFeatureNode : public FeatureExtractorNode {
                 &PerStoreFeatureNode::arith_intensity_curve_num_samples)
         .def_ro("cache_line_bytes", &PerStoreFeatureNode::cache_line_bytes)
         .def_ro("extract_workload", &PerStoreFeatureNode::extract_workload)
-        .def_ro("feature_vector_length", &PerStoreFeatureNode::feature_vector_length);
+        .def_ro("feature_vector_length", &PerStoreFeatureNode::feature_vector_length)
+        .def_ro("cache_size", &PerStoreFeatureNode::cache_size);
   }
 
-  void ExtractSingle(IRModule mod, bool is_gpu, std::vector<std::vector<double>>* results) {
+  /*!
+   * \brief Extract the per-store features of a scheduled module.
+   * \return The feature rows, one after another.
+   */
+  std::vector<double> ExtractSingle(IRModule mod, bool is_gpu) {
     static tvm::transform::Sequential passes = s_tir::transform::PassListForPerStoreFeature();
     mod = passes(std::move(mod));
     std::vector<s_tir::Feature> features = s_tir::PerStoreFeatureCollector::Collect(
         is_gpu, this->cache_line_bytes, this->arith_intensity_curve_num_samples, mod);
-    int n_features = features.size();
-    results->resize(n_features);
-    for (int i = 0; i < n_features; ++i) {
-      const s_tir::Feature& feature = features[i];
-      std::vector<double>& result = (*results)[i];
-      result.reserve(feature_vector_length);
+    std::vector<double> result;
+    result.reserve(features.size() * StoreFeatureLength());
+    for (const s_tir::Feature& feature : features) {
       feature.group1->Export(&result);
       feature.group2->Export(&result, this->buffers_per_store);
       feature.group3->Export(&result);
       feature.group4->Export(&result, feature.group5->outer_prod);
       feature.group5->Export(&result);
     }
+    return result;
   }
 
-  ffi::Array<runtime::Tensor> ExtractFrom(const TuneContext& tune_context,
-                                          const ffi::Array<MeasureCandidate>& candidates) {
+  /*!
+   * \brief Extract the per-store features of the candidates, reusing those of the scheduled
+   *  modules seen recently.
+   */
+  std::vector<std::shared_ptr<const std::vector<double>>> ExtractStoreFeatures(
+      const TuneContext& tune_context, const ffi::Array<MeasureCandidate>& candidates) {
+    auto _ = Profiler::TimedScope("PerStoreFeature/Extract");
     auto& target_keys = tune_context->target.value()->keys;
     bool is_gpu = std::find(target_keys.begin(), target_keys.end(), "gpu") != target_keys.end();
-    std::vector<runtime::Tensor> results;
-    results.resize(candidates.size());
-    std::unique_ptr<s_tir::group6::Feature> feature_group6 = nullptr;
-    if (extract_workload) {
-      feature_group6 = std::make_unique<s_tir::group6::Feature>(tune_context->mod.value());
-    }
-    auto f = [this, is_gpu, &feature_group6, &candidates, &results](int, int task_id) -> void {
-      const auto& candidate = candidates[task_id];
-      std::vector<std::vector<double>> features;
-      ExtractSingle(DeepCopyIRModule(candidate->sch->mod()), is_gpu, &features);
-      if (extract_workload) {
-        for (auto& feature : features) {
-          feature_group6->Export(&feature);
-        }
+    std::vector<std::shared_ptr<const std::vector<double>>> results(candidates.size());
+    auto f = [this, is_gpu, &candidates, &results](int, int task_id) -> void {
+      IRModule mod = candidates[task_id]->sch->mod();
+      size_t shash = ffi::StructuralHash()(mod);
+      std::shared_ptr<const std::vector<double>>& result = results[task_id];
+      if ((result = cache_.Get(mod, shash, is_gpu)) == nullptr) {
+        result = std::make_shared<const std::vector<double>>(
+            ExtractSingle(DeepCopyIRModule(mod), is_gpu));
+        cache_.Put(mod, shash, is_gpu, result);
       }
-      results[task_id] = s_tir::utils::AsTensor(features, this->feature_vector_length);
     };
     support::parallel_for_dynamic(0, candidates.size(), tune_context->num_threads, f);
     return results;
   }
+
+  /*! \brief The features of the workload appended to every row, empty if not extracted. */
+  std::vector<double> WorkloadFeatures(const TuneContext& tune_context) const {
+    std::vector<double> result;
+    if (extract_workload) {
+      s_tir::group6::Feature(tune_context->mod.value()).Export(&result);
+    }
+    return result;
+  }
+
+  /*! \brief The length of a feature row without the workload features. */
+  int StoreFeatureLength() const {
+    return feature_vector_length - (extract_workload ? s_tir::group6::Feature::kCount : 0);
+  }
+
+  /*!
+   * \brief Write the full feature rows of a candidate.
+   * \param store_features The per-store feature rows.
+   * \param workload_features The workload features appended to every row.
+   * \param out The output of `feature_vector_length` values per row.
+   */
+  template <typename T>
+  void ExportRows(const std::vector<double>& store_features,
+                  const std::vector<double>& workload_features, T* out) const {
+    int store_len = StoreFeatureLength();
+    for (auto it = store_features.begin(); it != store_features.end(); it += store_len) {
+      out = std::copy(it, it + store_len, out);
+      out = std::copy(workload_features.begin(), workload_features.end(), out);
+    }
+  }
+
+  ffi::Array<runtime::Tensor> ExtractFrom(const TuneContext& tune_context,
+                                          const ffi::Array<MeasureCandidate>& candidates) {
+    std::vector<std::shared_ptr<const std::vector<double>>> features =
+        ExtractStoreFeatures(tune_context, candidates);
+    std::vector<double> workload_features = WorkloadFeatures(tune_context);
+    ffi::Array<runtime::Tensor> results;
+    results.reserve(candidates.size());
+    for (const auto& store_features : features) {
+      int64_t num_rows = store_features->size() / StoreFeatureLength();
+      runtime::Tensor tensor = runtime::Tensor::Empty(
+          /*shape=*/{num_rows, feature_vector_length},
+          /*dtype=*/DLDataType{kDLFloat, 64, 1},
+          /*ctx=*/DLDevice{kDLCPU, 0});
+      ExportRows(*store_features, workload_features, static_cast<double*>(tensor->data));
+      results.push_back(tensor);
+    }
+    return results;
+  }
+
+  void ExtractBatch(const TuneContext& tune_context,
+                    const ffi::Array<MeasureCandidate>& candidates, FeatureBatch* batch) final {
+    std::vector<std::shared_ptr<const std::vector<double>>> features =
+        ExtractStoreFeatures(tune_context, candidates);
+    std::vector<double> workload_features = WorkloadFeatures(tune_context);
+    batch->num_features = feature_vector_length;
+    batch->row_ptr.assign(1, 0);
+    for (const auto& store_features : features) {
+      int64_t num_rows = store_features->size() / StoreFeatureLength();
+      batch->row_ptr.push_back(batch->row_ptr.back() + num_rows);
+    }
+    batch->rows.resize(batch->row_ptr.back() * feature_vector_length);
+    for (int i = 0, n = features.size(); i < n; ++i) {
+      ExportRows(*features[i], workload_features,
+                 batch->rows.data() + batch->row_ptr[i] * feature_vector_length);
+    }
+  }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.PerStoreFeature", PerStoreFeatureNode,
                                     FeatureExtractorNode);
+
+ private:
+  friend class FeatureExtractor;
+
+  /*!
+   * \brief The per-store features of the scheduled modules extracted recently, evicted in
+   *  least-recently-used order. Candidates repeat across the generations of the evolutionary
+   *  search, and their features only depend on the scheduled module and the target kind.
+   */
+  class FeatureCache {
+   public:
+    using Value = std::shared_ptr<const std::vector<double>>;
+
+    Value Get(const IRModule& mod, size_t shash, bool is_gpu) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto [begin, end] = index_.equal_range(shash);
+      for (auto it = begin; it != end; ++it) {
+        const Entry& entry = *it->second;
+        if (entry.is_gpu == is_gpu && ffi::StructuralEqual()(entry.mod, mod)) {
+          entries_.splice(entries_.begin(), entries_, it->second);
+          return entry.features;
+        }
+      }
+      return nullptr;
+    }
+
+    void Put(const IRModule& mod, size_t shash, bool is_gpu, Value features) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (capacity_ <= 0) {
+        return;
+      }
+      entries_.push_front(Entry{mod, shash, is_gpu, std::move(features)});
+      index_.emplace(shash, entries_.begin());
+      if (static_cast<int>(entries_.size()) > capacity_) {
+        auto last = std::prev(entries_.end());
+        auto [begin, end] = index_.equal_range(last->shash);
+        for (auto it = begin; it != end; ++it) {
+          if (it->second == last) {
+            index_.erase(it);
+            break;
+          }
+        }
+        entries_.pop_back();
+      }
+    }
+
+    void SetCapacity(int capacity) { capacity_ = capacity; }
+
+   private:
+    struct Entry {
+      IRModule mod;
+      size_t shash;
+      bool is_gpu;
+      Value features;
+    };
+
+    std::mutex mutex_;
+    int capacity_ = 0;
+    /*! \brief The entries, most recently used first */
+    std::list<Entry> entries_;
+    std::unordered_multimap<size_t, std::list<Entry>::iterator> index_;
+  };
+
+  FeatureCache cache_;
 };
 
 FeatureExtractor FeatureExtractor::PerStoreFeature(int buffers_per_store,
                                                    int arith_intensity_curve_num_samples,
-                                                   int cache_line_bytes, bool extract_workload) {
+                                                   int cache_line_bytes, bool extract_workload,
+                                                   int cache_size) {
   ffi::ObjectPtr<PerStoreFeatureNode> n = ffi::make_object<PerStoreFeatureNode>();
   n->buffers_per_store = buffers_per_store;
   n->arith_intensity_curve_num_samples = arith_intensity_curve_num_samples;
   n->cache_line_bytes = cache_line_bytes;
   n->extract_workload = extract_workload;
+  n->cache_size = cache_size;
+  n->cache_.SetCapacity(cache_size);
   n->feature_vector_length = s_tir::group1::Feature::kCount +                                  //
                              s_tir::group2::Feature::SubFeature::kCount * buffers_per_store +  //
                              arith_intensity_curve_num_samples +                               //
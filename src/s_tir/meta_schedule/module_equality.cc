@@ -24,29 +24,119 @@
 #include <tvm/ir/module.h>
 #include <tvm/tirx/analysis.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../support/utils.h"
+#include "../support/parallel_for.h"
 
 namespace tvm {
 namespace s_tir {
 namespace meta_schedule {
 
-class ModuleEqualityStructural : public ModuleEquality {
- public:
-  size_t Hash(IRModule mod) const { return ffi::StructuralHash()(mod); }
-  bool Equal(IRModule lhs, IRModule rhs) const { return ffi::StructuralEqual()(lhs, rhs); }
-  ffi::String GetName() const { return "structural"; }
-};
+/*! \brief The minimal number of functions for a module to be hashed and compared per function. */
+constexpr size_t kMinFunctionsForParallel = 2;
+
+/*!
+ * \brief Hash each function of a module on its own, in parallel across the functions. The
+ * GlobalVars referenced by a function are free in it and are hashed by their order of
+ * occurrence, so the per-function hashes of two structurally equal modules agree.
+ * \param mod The module whose functions are hashed
+ * \param skip_tensor_content Whether to skip the raw data of the tensors
+ * \return The hash of each function, sorted by the function name
+ */
+std::vector<uint64_t> HashFunctions(const IRModule& mod, bool skip_tensor_content) {
+  std::vector<std::pair<ffi::String, BaseFunc>> funcs;
+  for (const auto& [gv, func] : mod->functions) {
+    funcs.emplace_back(gv->name_hint, func);
+  }
+  std::sort(funcs.begin(), funcs.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+  std::vector<uint64_t> hashes(funcs.size());
+  int num_threads = std::min<int>(funcs.size(), std::thread::hardware_concurrency());
+  support::parallel_for_dynamic(0, funcs.size(), std::max(num_threads, 1), [&](int, int i) {
+    hashes[i] = ffi::StructuralHash::Hash(ffi::Array<ffi::Any>{funcs[i].first, funcs[i].second},
+                                          /*map_free_vars=*/true, skip_tensor_content);
+  });
+  return hashes;
+}
 
-class ModuleEqualityIgnoreTensor : public ModuleEquality {
+/*!
+ * \brief Check the functions of two modules with the same function names pairwise, in parallel.
+ * A pair that differs even with the GlobalVars mapped freely proves the modules unequal.
+ * \return False if the modules are proven unequal, true if they may be equal
+ */
+bool FunctionsMayBeEqual(const IRModule& lhs, const IRModule& rhs, bool skip_tensor_content) {
+  std::vector<std::pair<BaseFunc, BaseFunc>> pairs;
+  for (const auto& [gv, func] : lhs->functions) {
+    if (!rhs->ContainGlobalVar(gv->name_hint)) {
+      return false;
+    }
+    pairs.emplace_back(func, rhs->Lookup(gv->name_hint));
+  }
+  std::atomic<bool> may_be_equal{true};
+  int num_threads = std::min<int>(pairs.size(), std::thread::hardware_concurrency());
+  support::parallel_for_dynamic(0, pairs.size(), std::max(num_threads, 1), [&](int, int i) {
+    if (may_be_equal.load(std::memory_order_relaxed) &&
+        !ffi::StructuralEqual::Equal(pairs[i].first, pairs[i].second, /*map_free_vars=*/true,
+                                     skip_tensor_content)) {
+      may_be_equal.store(false, std::memory_order_relaxed);
+    }
+  });
+  return may_be_equal.load();
+}
+
+/*!
+ * \brief Structural equality and hashing of modules, optionally ignoring the tensor raw data.
+ * Modules with many functions are hashed per function in parallel, and compared pairwise per
+ * function first to exit early on a mismatching function.
+ */
+class ModuleEqualityStructuralBase : public ModuleEquality {
  public:
+  explicit ModuleEqualityStructuralBase(bool skip_tensor_content)
+      : skip_tensor_content_(skip_tensor_content) {}
+
   size_t Hash(IRModule mod) const {
-    return tvm::ffi::StructuralHash::Hash(mod, /*map_free_vars=*/false,
-                                          /*skip_tensor_content=*/true);
+    if (mod->functions.size() < kMinFunctionsForParallel) {
+      return ffi::StructuralHash::Hash(mod, /*map_free_vars=*/false, skip_tensor_content_);
+    }
+    uint64_t hash_value = ffi::StructuralHash::Hash(
+        ffi::Array<ffi::Any>{mod->attrs, mod->global_infos}, /*map_free_vars=*/false,
+        skip_tensor_content_);
+    for (uint64_t func_hash : HashFunctions(mod, skip_tensor_content_)) {
+      hash_value = support::HashCombine(hash_value, func_hash);
+    }
+    return hash_value;
   }
+
   bool Equal(IRModule lhs, IRModule rhs) const {
-    return tvm::ffi::StructuralEqual::Equal(lhs, rhs, /*map_free_vars=*/false,
-                                            /*skip_tensor_content=*/true);
+    if (lhs->functions.size() != rhs->functions.size()) {
+      return false;
+    }
+    if (lhs->functions.size() >= kMinFunctionsForParallel &&
+        !FunctionsMayBeEqual(lhs, rhs, skip_tensor_content_)) {
+      return false;
+    }
+    return ffi::StructuralEqual::Equal(lhs, rhs, /*map_free_vars=*/false, skip_tensor_content_);
   }
+
+ private:
+  bool skip_tensor_content_;
+};
+
+class ModuleEqualityStructural : public ModuleEqualityStructuralBase {
+ public:
+  ModuleEqualityStructural() : ModuleEqualityStructuralBase(/*skip_tensor_content=*/false) {}
+  ffi::String GetName() const { return "structural"; }
+};
+
+class ModuleEqualityIgnoreTensor : public ModuleEqualityStructuralBase {
+ public:
+  ModuleEqualityIgnoreTensor() : ModuleEqualityStructuralBase(/*skip_tensor_content=*/true) {}
   ffi::String GetName() const { return "ignore-tensor"; }
 };
 
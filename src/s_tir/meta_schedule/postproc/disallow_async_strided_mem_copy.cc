@@ -18,9 +18,12 @@
  */
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/reflection/registry.h>
+#include <tvm/s_tir/analysis.h>
 #include <tvm/s_tir/stmt.h>
 #include <tvm/s_tir/transform.h>
 
+#include <optional>
+
 #include "../utils.h"
 
 namespace tvm {
@@ -46,75 +49,32 @@ struct AsyncStridedMemCopyFinder : private StmtExprVisitor {
  private:
   void VisitStmt_(const ForNode* loop) final {
     if (!found_) {
-      input_iters.Set(loop->loop_var, Range(loop->min, loop->extent));
       StmtExprVisitor::VisitStmt_(loop);
     }
   }
 
   void VisitStmt_(const AttrStmtNode* attrStmt) final {
-    if (!found_) {
-      if (attrStmt->attr_key == s_tir::attr::async_commit_queue_scope) {
-        auto async_scope = attrStmt->body.as<AttrStmtNode>();
-        if (!async_scope) {
-          StmtExprVisitor::VisitStmt_(attrStmt);
-        }
-
-        auto for_loop = async_scope->body.as<ForNode>();
-        if (!for_loop) {
-          StmtExprVisitor::VisitStmt_(attrStmt);
-        }
-
-        input_iters.Set(for_loop->loop_var, Range(for_loop->min, for_loop->extent));
-
-        auto bufferstorenode = for_loop->body.as<BufferStoreNode>();
-        if (!bufferstorenode) {
-          StmtExprVisitor::VisitStmt_(attrStmt);
-        }
-
-        auto bufferloadnode = bufferstorenode->value.as<BufferLoadNode>();
-        if (!bufferloadnode) {
-          StmtExprVisitor::VisitStmt_(attrStmt);
-        }
-
-        // get store buffer; assert it exists and is contiguous given it uses a single index
-        auto bufferstore = bufferstorenode->buffer.as<BufferNode>();
-
-        // get load buffer; assert it exists and is contiguous given it uses a single index
-        auto bufferload = bufferloadnode->buffer.as<BufferNode>();
-
-        if (!bufferstore || !bufferload) {
-          StmtExprVisitor::VisitStmt_(attrStmt);
-        }
-
-        // map loop variable to zero for the store index & simplify
-        ffi::Array<PrimExpr> store_index = bufferstorenode->indices;
-
-        // Use DetectIterMap to detect whether store index is non-contiguous.
+    if (found_) return;
+    if (attrStmt->attr_key == s_tir::attr::async_commit_queue_scope) {
+      const auto* async_scope = attrStmt->body.as<AttrStmtNode>();
+      const ForNode* for_loop = async_scope ? async_scope->body.as<ForNode>() : nullptr;
+      if (for_loop != nullptr) {
+        // LowerAsyncDMA only lowers the copies of a contiguous region, which may span a nest of
+        // loops, e.g. a 2-d tile of full rows, to DMA.
         arith::Analyzer analyzer;
-        auto store_iter_map = DetectIterMap(store_index, input_iters, 1,
-                                            arith::IterMapLevel::Surjective, analyzer, false);
-        if (!store_iter_map->errors.empty()) {
+        std::optional<s_tir::MemCpyDetails> mem_copy =
+            s_tir::IdentifyMemCpy(ffi::GetRef<For>(for_loop), analyzer);
+        if (!mem_copy.has_value() || mem_copy->dest->region.size() != 1 ||
+            mem_copy->source->region.size() != 1) {
           found_ = true;
+          return;
         }
-
-        // map loop variable to zero for the load index & simplify
-        ffi::Array<PrimExpr> load_index = bufferloadnode->indices;
-
-        // Use DetectIterMap to detect whether load index is non-contiguous.
-        auto load_iter_map = DetectIterMap(load_index, input_iters, 1,
-                                           arith::IterMapLevel::Surjective, analyzer, false);
-        if (!load_iter_map->errors.empty()) {
-          found_ = true;
-        }
-      }
-      if (!found_) {
-        StmtExprVisitor::VisitStmt_(attrStmt);
       }
     }
+    StmtExprVisitor::VisitStmt_(attrStmt);
   }
 
   bool found_ = false;
-  ffi::Map<PrimVar, Range> input_iters = ffi::Map<PrimVar, Range>();
 };
 
 }  // namespace s_tir
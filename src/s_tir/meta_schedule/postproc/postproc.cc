@@ -105,7 +105,7 @@ ffi::Array<Postproc> Postproc::DefaultHexagon() {
   return ffi::Array<Postproc>{
       Postproc::DisallowDynamicLoop(),   Postproc::RewriteParallelVectorizeUnroll(),
       Postproc::RewriteReductionBlock(), Postproc::RewriteLayout(),
-      Postproc::VerifyVTCMLimit(),
+      Postproc::DisallowAsyncStridedMemCopy(), Postproc::VerifyVTCMLimit(),
   };
 }
 
@@ -0,0 +1,406 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/cast.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/s_tir/stmt.h>
+#include <tvm/s_tir/transform.h>
+#include <tvm/tirx/analysis.h>
+#include <tvm/tirx/stmt_functor.h>
+#include <tvm/tirx/transform.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../../tirx/transform/ir_utils.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+using namespace tvm::tirx;
+
+/*!
+ * \brief Estimate the number of registers a lowered function needs at its peak.
+ *
+ * Two kinds of values occupy registers:
+ * - Elements of small local allocations that are only accessed at constant indices once loops are
+ *   unrolled, such as the accumulators of a tiled reduction. They are counted as live throughout.
+ * - Values loaded from other buffers. Within each loop-free region, a load is live from the first
+ *   to the last statement using it, since the backend eliminates the repeated loads in between.
+ *
+ * Loops marked as unrolled are expanded first, like the backend would. A value of `bits * lanes`
+ * bits takes `ceil(bits * lanes / register_bits)` registers.
+ */
+class RegisterPressureEstimator : private StmtExprVisitor {
+ public:
+  static int64_t Estimate(const Stmt& body, int register_bits) {
+    Stmt expanded = UnrolledLoopExpander()(body);
+    RegisterPressureEstimator estimator(register_bits, FindRegisterBuffers(expanded));
+    estimator(expanded);
+    estimator.FlushRegion();
+    int64_t resident = 0;
+    for (const auto& [key, registers] : estimator.resident_) resident += registers;
+    return resident + estimator.max_transient_;
+  }
+
+ private:
+  /*! \brief Expand the loops marked as unrolled with a constant extent. */
+  class UnrolledLoopExpander : public StmtMutator {
+    Stmt VisitStmt_(const ForNode* op) final {
+      Stmt body = this->VisitStmt(op->body);
+      const auto* extent = op->extent.as<IntImmNode>();
+      if (op->kind != ForKind::kUnrolled || extent == nullptr) {
+        if (body.same_as(op->body)) return ffi::GetRef<Stmt>(op);
+        For loop = ffi::GetRef<For>(op);
+        loop.CopyOnWrite()->body = body;
+        return loop;
+      }
+      ffi::Array<Stmt> seq;
+      for (int64_t i = 0; i < extent->value; ++i) {
+        seq.push_back(Substitute(body, {{op->loop_var, op->min + IntImm(op->loop_var.ty(), i)}}));
+      }
+      return SeqStmt::Flatten(seq);
+    }
+  };
+
+  /*!
+   * \brief The local allocations with a constant size whose every access has a constant index.
+   */
+  static std::unordered_set<const VarNode*> FindRegisterBuffers(const Stmt& body) {
+    std::unordered_set<const VarNode*> candidates;
+    std::unordered_set<const VarNode*> rejected;
+    arith::Analyzer analyzer;
+    auto check_index = [&](const Buffer& buffer, const ffi::Array<PrimExpr>& indices) {
+      for (const PrimExpr& index : indices) {
+        PrimExpr simplified = analyzer.Simplify(index);
+        if (const auto* ramp = simplified.as<RampNode>()) simplified = ramp->base;
+        if (!simplified->IsInstance<IntImmNode>()) rejected.insert(buffer->data.get());
+      }
+    };
+    PostOrderVisit(body, [&](const ffi::ObjectRef& obj) {
+      if (const auto* alloc = obj.as<AllocBufferNode>()) {
+        runtime::StorageScope scope =
+            runtime::StorageScope::Create(GetPtrStorageScope(alloc->buffer->data));
+        bool local = scope.rank == runtime::StorageRank::kLocal ||
+                     scope.rank == runtime::StorageRank::kGlobal;
+        int64_t numel = 1;
+        for (const PrimExpr& dim : alloc->buffer->shape) {
+          const auto* int_dim = dim.as<IntImmNode>();
+          numel = int_dim == nullptr ? -1 : numel * int_dim->value;
+          if (numel < 0) break;
+        }
+        if (local && numel > 0) candidates.insert(alloc->buffer->data.get());
+      } else if (const auto* load = obj.as<BufferLoadNode>()) {
+        check_index(load->buffer, load->indices);
+      } else if (const auto* store = obj.as<BufferStoreNode>()) {
+        check_index(store->buffer, store->indices);
+      }
+    });
+    for (const VarNode* var : rejected) candidates.erase(var);
+    return candidates;
+  }
+
+  RegisterPressureEstimator(int register_bits, std::unordered_set<const VarNode*> register_buffers)
+      : register_bits_(register_bits), register_buffers_(std::move(register_buffers)) {}
+
+  int64_t NumRegisters(const PrimType& dtype, int lanes) const {
+    int64_t bits = static_cast<int64_t>(dtype.bits()) * lanes;
+    return (bits + register_bits_ - 1) / register_bits_;
+  }
+
+  template <typename Node>
+  void VisitAccess(const Node* op, const PrimType& dtype) {
+    int lanes = 1;
+    ffi::Array<PrimExpr> indices;
+    for (const PrimExpr& index : op->indices) {
+      PrimExpr simplified = analyzer_.Simplify(index);
+      // Scalable vectors encode their vscale factor as negative lanes.
+      lanes = std::max(lanes, std::abs(static_cast<int16_t>(simplified.ty()->dtype.lanes)));
+      indices.push_back(simplified);
+    }
+    if (register_buffers_.count(op->buffer->data.get())) {
+      std::ostringstream os;
+      os << op->buffer->data.get() << ":" << indices;
+      resident_[os.str()] = NumRegisters(dtype, lanes);
+      return;
+    }
+    if constexpr (std::is_same_v<Node, BufferLoadNode>) {
+      BufferLoad key(op->buffer, indices);
+      auto [it, inserted] = live_ranges_.emplace(key, std::make_pair(position_, position_));
+      it->second.second = position_;
+      if (inserted) registers_[key] = NumRegisters(dtype, lanes);
+    }
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    StmtExprVisitor::VisitExpr_(op);
+    VisitAccess(op, op->buffer->dtype);
+  }
+
+  // The operands of a statement are live at once, so positions advance per statement.
+  void VisitStmt_(const BufferStoreNode* op) final {
+    StmtExprVisitor::VisitStmt_(op);
+    VisitAccess(op, op->buffer->dtype);
+    ++position_;
+  }
+
+  void VisitStmt_(const EvaluateNode* op) final {
+    StmtExprVisitor::VisitStmt_(op);
+    ++position_;
+  }
+
+  void VisitStmt_(const ForNode* op) final {
+    // Values do not stay in registers across the iterations of a rolled loop.
+    FlushRegion();
+    StmtExprVisitor::VisitStmt_(op);
+    FlushRegion();
+  }
+
+  void VisitStmt_(const WhileNode* op) final {
+    FlushRegion();
+    StmtExprVisitor::VisitStmt_(op);
+    FlushRegion();
+  }
+
+  /*! \brief Record the peak of the loads live at once in the current region and reset it. */
+  void FlushRegion() {
+    std::vector<std::pair<int64_t, int64_t>> events;
+    for (const auto& [key, range] : live_ranges_) {
+      int64_t registers = registers_.at(key);
+      events.emplace_back(range.first, registers);
+      events.emplace_back(range.second + 1, -registers);
+    }
+    std::sort(events.begin(), events.end());
+    int64_t live = 0;
+    for (const auto& [position, delta] : events) {
+      live += delta;
+      max_transient_ = std::max(max_transient_, live);
+    }
+    live_ranges_.clear();
+    registers_.clear();
+  }
+
+  int register_bits_;
+  std::unordered_set<const VarNode*> register_buffers_;
+  arith::Analyzer analyzer_;
+  int64_t position_{0};
+  // The first and last position of each distinct load in the current region.
+  std::unordered_map<BufferLoad, std::pair<int64_t, int64_t>, ffi::StructuralHash, ExprDeepEqual>
+      live_ranges_;
+  std::unordered_map<BufferLoad, int64_t, ffi::StructuralHash, ExprDeepEqual> registers_;
+  // The registers of each distinct register-resident element.
+  std::unordered_map<std::string, int64_t> resident_;
+  int64_t max_transient_{0};
+};
+
+/*! \brief The passes lowering a scheduled function far enough to estimate its registers. */
+ffi::Array<tvm::transform::Pass> GetRegisterPressurePasses() {
+  ffi::Array<tvm::transform::Pass> pass_list;
+  pass_list.push_back(s_tir::transform::LowerCrossThreadReduction());
+  pass_list.push_back(s_tir::transform::LowerInitBlock());
+  pass_list.push_back(s_tir::transform::PlanAndUpdateBufferAllocationLocation());
+  pass_list.push_back(s_tir::transform::ConvertBlocksToOpaque());
+  pass_list.push_back(s_tir::transform::CompactBufferAllocation());
+  pass_list.push_back(tirx::transform::StmtSimplify());
+  pass_list.push_back(s_tir::transform::LowerMatchBuffer());
+  pass_list.push_back(s_tir::transform::LowerOpaqueBlock());
+  pass_list.push_back(tirx::transform::FlattenBuffer());
+  pass_list.push_back(tirx::transform::StmtSimplify());
+  pass_list.push_back(tirx::transform::VectorizeLoop(true));
+  pass_list.push_back(tirx::transform::UnrollLoop());
+  pass_list.push_back(tirx::transform::StmtSimplify());
+  return pass_list;
+}
+
+}  // namespace s_tir
+}  // namespace tvm
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+/*!
+ * \brief Verify that the estimated register pressure fits the registers of the target, halving
+ * the auto-unroll steps of the schedule until it does.
+ */
+class VerifyRegisterPressureNode : public PostprocNode {
+ public:
+  Target target_{ffi::UnsafeInit()};
+  /*! \brief Whether the target is a GPU, whose registers are 32-bit and shared by a block. */
+  bool is_gpu_ = false;
+  /*! \brief The width of a register in bits. */
+  int register_bits_ = 128;
+  /*! \brief The number of registers per thread on CPUs, per block on GPUs. */
+  int64_t num_registers_ = 16;
+
+  void InitializeWithTuneContext(const TuneContext& context) final {
+    TVM_FFI_ICHECK(context->target.has_value());
+    target_ = context->target.value();
+    is_gpu_ = target_->GetTargetDeviceType() != kDLCPU;
+    if (is_gpu_) {
+      register_bits_ = 32;
+      num_registers_ = target_->GetAttr<int64_t>("registers_per_block").value_or(65536);
+      return;
+    }
+    static auto llvm_get_vector_width =
+        tvm::ffi::Function::GetGlobal("target.llvm_get_vector_width");
+    if (llvm_get_vector_width.has_value() && target_->kind->name == "llvm") {
+      register_bits_ = std::max(register_bits_, (*llvm_get_vector_width)(target_).cast<int>());
+    }
+    if (ffi::Optional<int64_t> num_registers = target_->GetAttr<int64_t>("num-vector-registers")) {
+      num_registers_ = num_registers.value();
+      return;
+    }
+    // AVX-512, AArch64 and RISC-V V have 32 vector registers, older x86 extensions 16.
+    static auto target_has_feature = tvm::ffi::Function::GetGlobal("target.target_has_feature");
+    bool has_32_registers = false;
+    if (target_has_feature.has_value() && target_->kind->name == "llvm") {
+      has_32_registers = (*target_has_feature)("avx512f", target_).cast<bool>() ||
+                         (*target_has_feature)("v", target_).cast<bool>();
+    }
+    ffi::String mtriple = target_->GetAttr<ffi::String>("mtriple").value_or("");
+    if (support::StartsWith(mtriple, "aarch64") || support::StartsWith(mtriple, "arm64")) {
+      has_32_registers = true;
+    }
+    num_registers_ = has_32_registers ? 32 : 16;
+  }
+
+  /*! \brief The registers available to each thread of a lowered function. */
+  int64_t GetRegisterBudget(const tirx::PrimFunc& func) const {
+    if (!is_gpu_) return num_registers_;
+    int64_t num_threads = 1;
+    PostOrderVisit(func->body, [&num_threads](const ffi::ObjectRef& obj) {
+      if (const auto* attr = obj.as<AttrStmtNode>()) {
+        if (attr->attr_key != tirx::attr::thread_extent) return;
+        const auto* iter_var = attr->node.as<IterVarNode>();
+        const auto* extent = attr->value.as<IntImmNode>();
+        if (iter_var != nullptr && extent != nullptr &&
+            support::StartsWith(iter_var->thread_tag, "threadIdx")) {
+          num_threads *= extent->value;
+        }
+      }
+    });
+    // The ISA caps registers per thread at 255 regardless of the block size.
+    return std::min<int64_t>(255, num_registers_ / num_threads);
+  }
+
+  /*! \brief Whether every function of the module fits the registers once lowered. */
+  bool Fits(const IRModule& mod) const {
+    for (const auto& [g_var, base_func] : mod->functions) {
+      const auto* prim_func = base_func.as<tirx::PrimFuncNode>();
+      if (prim_func == nullptr) continue;
+      IRModule lowered{ffi::UnsafeInit()};
+      try {
+        tirx::PrimFunc f = WithAttr(ffi::GetRef<tirx::PrimFunc>(prim_func), "global_symbol",
+                                    ffi::String(g_var->name_hint));
+        f = WithAttr(f, tvm::attr::kTarget, target_);
+        IRModule func_mod(ffi::Map<GlobalVar, BaseFunc>({{GlobalVar(g_var->name_hint), f}}));
+        lowered = tvm::transform::Sequential(s_tir::GetRegisterPressurePasses())(func_mod);
+      } catch (const std::exception&) {
+        // Lowering failures are reported by the builder; nothing to estimate here.
+        continue;
+      }
+      for (const auto& [lowered_var, lowered_func] : lowered->functions) {
+        if (const auto* func = lowered_func.as<tirx::PrimFuncNode>()) {
+          int64_t pressure = s_tir::RegisterPressureEstimator::Estimate(func->body, register_bits_);
+          if (pressure > GetRegisterBudget(ffi::GetRef<tirx::PrimFunc>(func))) return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Halve every auto-unroll step of the schedule.
+   * \return Whether any step was lowered.
+   */
+  static bool HalveUnrollSteps(const s_tir::Schedule& sch) {
+    std::vector<std::pair<s_tir::LoopRV, int64_t>> updates;
+    for (const auto& [g_var, base_func] : sch->mod()->functions) {
+      const auto* prim_func = base_func.as<tirx::PrimFuncNode>();
+      if (prim_func == nullptr) continue;
+      std::unordered_set<const ForNode*> unrolled_loops;
+      std::vector<ffi::String> block_names;
+      PostOrderVisit(prim_func->body, [&](const ffi::ObjectRef& obj) {
+        if (const auto* loop = obj.as<ForNode>()) {
+          if (loop->annotations.count(tirx::attr::pragma_auto_unroll_max_step)) {
+            unrolled_loops.insert(loop);
+          }
+        } else if (const auto* block = obj.as<SBlockNode>()) {
+          block_names.push_back(block->name_hint);
+        }
+      });
+      for (const ffi::String& name : block_names) {
+        if (unrolled_loops.empty()) break;
+        s_tir::SBlockRV block_rv = sch->GetSBlock(name, g_var->name_hint);
+        for (const s_tir::LoopRV& loop_rv : sch->GetLoops(block_rv)) {
+          const auto* loop = sch->GetSRef(loop_rv)->StmtAs<ForNode>();
+          if (!unrolled_loops.erase(loop)) continue;
+          int64_t max_step =
+              GetAnn<IntImm>(loop, tirx::attr::pragma_auto_unroll_max_step).value()->value;
+          if (max_step > 1) updates.emplace_back(loop_rv, max_step / 2);
+        }
+      }
+    }
+    for (const auto& [loop_rv, max_step] : updates) {
+      sch->Annotate(loop_rv, tirx::attr::pragma_auto_unroll_max_step, IntImm::Int32(max_step));
+    }
+    return !updates.empty();
+  }
+
+  bool Apply(const s_tir::Schedule& sch) final {
+    while (!Fits(sch->mod())) {
+      if (!HalveUnrollSteps(sch)) return false;
+    }
+    return true;
+  }
+
+  Postproc Clone() const {
+    ffi::ObjectPtr<VerifyRegisterPressureNode> n =
+        ffi::make_object<VerifyRegisterPressureNode>(*this);
+    return Postproc(n);
+  }
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<VerifyRegisterPressureNode>();
+  }
+
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.VerifyRegisterPressure",
+                                    VerifyRegisterPressureNode, PostprocNode);
+};
+
+Postproc Postproc::VerifyRegisterPressure() {
+  ffi::ObjectPtr<VerifyRegisterPressureNode> n = ffi::make_object<VerifyRegisterPressureNode>();
+  return Postproc(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  VerifyRegisterPressureNode::RegisterReflection();
+  refl::GlobalDef().def("s_tir.meta_schedule.PostprocVerifyRegisterPressure",
+                        Postproc::VerifyRegisterPressure);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
@@ -19,8 +19,11 @@
 #include <tvm/ffi/reflection/registry.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <iomanip>
 
+#include "../../support/str_escape.h"
 #include "./utils.h"
 
 namespace tvm {
@@ -72,29 +75,117 @@ ffi::String ProfilerNode::Table() const {
   return p.AsStr();
 }
 
+void ProfilerNode::Record(const std::string& name, const std::string& task,
+                          std::chrono::high_resolution_clock::time_point start,
+                          std::chrono::high_resolution_clock::time_point end) {
+  using Micros = std::chrono::duration<double, std::micro>;
+  double start_us = Micros(start - origin).count();
+  double dur_us = Micros(end - start).count();
+  std::thread::id thread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex);
+  if (thread == owner_thread) {
+    stats_sec[name] += dur_us / 1e6;
+  }
+  auto it = thread_ids.find(thread);
+  if (it == thread_ids.end()) {
+    it = thread_ids.emplace(thread, thread_ids.size()).first;
+  }
+  events.push_back(ProfilerEvent{name, task, it->second, start_us, dur_us});
+}
+
+ffi::String ProfilerNode::ChromeTrace() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<const ProfilerEvent*> sorted;
+  sorted.reserve(events.size());
+  for (const ProfilerEvent& event : events) {
+    sorted.push_back(&event);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+    return a->start_us < b->start_us;
+  });
+  std::vector<int64_t> tids;
+  for (const auto& kv : thread_ids) {
+    tids.push_back(kv.second);
+  }
+  std::sort(tids.begin(), tids.end());
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  auto f_sep = [&os, &first]() {
+    if (!first) os << ",";
+    first = false;
+  };
+  for (int64_t tid : tids) {
+    f_sep();
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+       << ",\"args\":{\"name\":\"" << (tid == 0 ? "tuning" : "worker " + std::to_string(tid))
+       << "\"}}";
+  }
+  for (const ProfilerEvent* event : sorted) {
+    f_sep();
+    os << "{\"name\":\"" << support::StrEscape(event->name) << "\",\"cat\":\""
+       << support::StrEscape(event->task.empty() ? "meta_schedule" : event->task)
+       << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event->tid << ",\"ts\":" << event->start_us
+       << ",\"dur\":" << event->dur_us;
+    if (!event->task.empty()) {
+      os << ",\"args\":{\"task\":\"" << support::StrEscape(event->task) << "\"}";
+    }
+    os << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
 Profiler::Profiler() {
   ffi::ObjectPtr<ProfilerNode> n = ffi::make_object<ProfilerNode>();
   n->stats_sec.clear();
   n->total_timer = nullptr;
+  n->origin = std::chrono::high_resolution_clock::now();
+  n->owner_thread = std::this_thread::get_id();
   data_ = n;
 }
 
 ffi::Function ProfilerTimedScope(ffi::String name) {
   if (ffi::Optional<Profiler> opt_profiler = Profiler::Current()) {
-    return ffi::TypedFunction<void()>([profiler = opt_profiler.value(),                  //
+    Profiler profiler = opt_profiler.value();
+    std::string task;
+    {
+      std::lock_guard<std::mutex> lock(profiler->mutex);
+      task = profiler->current_task;
+    }
+    return ffi::TypedFunction<void()>([profiler = std::move(profiler),                   //
                                        tik = std::chrono::high_resolution_clock::now(),  //
-                                       name = std::move(name)]() {
-      auto tok = std::chrono::high_resolution_clock::now();
-      double duration =
-          std::chrono::duration_cast<std::chrono::nanoseconds>(tok - tik).count() / 1e9;
-      profiler->stats_sec[name] += duration;
+                                       name = std::string(name), task = std::move(task)]() {
+      profiler->Record(name, task, tik, std::chrono::high_resolution_clock::now());
     });
   }
   return nullptr;
 }
 
+ffi::Function ProfilerTaskScope(ffi::String task_name) {
+  if (ffi::Optional<Profiler> opt_profiler = Profiler::Current()) {
+    Profiler profiler = opt_profiler.value();
+    std::string prev_task;
+    {
+      std::lock_guard<std::mutex> lock(profiler->mutex);
+      prev_task = std::exchange(profiler->current_task, std::string(task_name));
+    }
+    return ffi::TypedFunction<void()>(
+        [profiler = std::move(profiler), prev_task = std::move(prev_task)]() {
+          std::lock_guard<std::mutex> lock(profiler->mutex);
+          profiler->current_task = prev_task;
+        });
+  }
+  return nullptr;
+}
+
 ScopedTimer Profiler::TimedScope(ffi::String name) { return ScopedTimer(ProfilerTimedScope(name)); }
 
+ScopedTimer Profiler::TaskScope(ffi::String task_name) {
+  return ScopedTimer(ProfilerTaskScope(task_name));
+}
+
 /**************** Context Manager ****************/
 
 std::vector<Profiler>* ThreadLocalProfilers() {
@@ -102,8 +193,33 @@ std::vector<Profiler>* ThreadLocalProfilers() {
   return &profilers;
 }
 
+/*! \brief The outermost profiler entered by any thread, seen by the threads without one. */
+struct GlobalProfiler {
+  std::mutex mutex;
+  std::atomic<bool> defined{false};
+  ffi::Optional<Profiler> profiler;
+
+  static GlobalProfiler* Get() {
+    static GlobalProfiler inst;
+    return &inst;
+  }
+};
+
 void Profiler::EnterWithScope() {
   ThreadLocalProfilers()->push_back(*this);
+  {
+    std::lock_guard<std::mutex> lock((*this)->mutex);
+    (*this)->owner_thread = std::this_thread::get_id();
+    (*this)->thread_ids[(*this)->owner_thread] = 0;
+  }
+  GlobalProfiler* global = GlobalProfiler::Get();
+  {
+    std::lock_guard<std::mutex> lock(global->mutex);
+    if (!global->profiler.has_value()) {
+      global->profiler = *this;
+      global->defined.store(true);
+    }
+  }
   (*this)->total_timer = ProfilerTimedScope("Total");
 }
 
@@ -113,15 +229,25 @@ void Profiler::ExitWithScope() {
     (*this)->total_timer();
     (*this)->total_timer = nullptr;
   }
+  GlobalProfiler* global = GlobalProfiler::Get();
+  std::lock_guard<std::mutex> lock(global->mutex);
+  if (global->profiler.has_value() && global->profiler.value().same_as(*this)) {
+    global->profiler = std::nullopt;
+    global->defined.store(false);
+  }
 }
 
 ffi::Optional<Profiler> Profiler::Current() {
   std::vector<Profiler>* profilers = ThreadLocalProfilers();
-  if (profilers->empty()) {
-    return std::nullopt;
-  } else {
+  if (!profilers->empty()) {
     return profilers->back();
   }
+  GlobalProfiler* global = GlobalProfiler::Get();
+  if (!global->defined.load()) {
+    return std::nullopt;
+  }
+  std::lock_guard<std::mutex> lock(global->mutex);
+  return global->profiler;
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() { ProfilerNode::RegisterReflection(); }
@@ -135,7 +261,9 @@ TVM_FFI_STATIC_INIT_BLOCK() {
       .def("s_tir.meta_schedule.ProfilerCurrent", Profiler::Current)
       .def_method("s_tir.meta_schedule.ProfilerGet", &ProfilerNode::Get)
       .def_method("s_tir.meta_schedule.ProfilerTable", &ProfilerNode::Table)
-      .def("s_tir.meta_schedule.ProfilerTimedScope", ProfilerTimedScope);
+      .def_method("s_tir.meta_schedule.ProfilerChromeTrace", &ProfilerNode::ChromeTrace)
+      .def("s_tir.meta_schedule.ProfilerTimedScope", ProfilerTimedScope)
+      .def("s_tir.meta_schedule.ProfilerTaskScope", ProfilerTaskScope);
 }
 
 }  // namespace meta_schedule
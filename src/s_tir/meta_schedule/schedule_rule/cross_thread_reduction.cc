@@ -18,6 +18,8 @@
  */
 #include <tvm/ffi/reflection/registry.h>
 
+#include <string>
+
 #include "../utils.h"
 
 namespace tvm {
@@ -47,6 +49,19 @@ class CrossThreadReductionNode : public ScheduleRuleNode {
     }
     max_threads_per_block = opt_max_threads_per_block.value_or(-1);
     warp_size = opt_warp_size.value_or(-1);
+    // Only sm_90 or higher supports thread block clusters.
+    supports_cluster = false;
+    if (ffi::Optional<ffi::String> opt_sm = target->GetAttr<ffi::String>("arch")) {
+      std::string sm = opt_sm.value();
+      if (target->kind->name == "cuda" && support::StartsWith(sm, "sm_")) {
+        try {
+          supports_cluster = std::stoi(sm.substr(3)) >= 90;
+        } catch (const std::invalid_argument& e) {
+          LOG(WARNING) << "ValueError: Unable to parse `target.arch`: " << sm
+                       << ". Details: " << e.what();
+        }
+      }
+    }
   }
 
   // Inherited from ScheduleRuleNode
@@ -63,6 +78,7 @@ class CrossThreadReductionNode : public ScheduleRuleNode {
     }
 
     // Step 1. Make a copy of the original schedule. The new copy is used for scheduling.
+    ffi::Optional<s_tir::Schedule> cluster_sch = ApplyClusterReduction(sch, block_rv);
     s_tir::Schedule tmp_sch = sch->Copy();
     tmp_sch->Seed(sch->ForkSeed());
 
@@ -116,6 +132,9 @@ class CrossThreadReductionNode : public ScheduleRuleNode {
         tmp_sch->Split(fused_reduce_loop, {std::nullopt, thread_extent});
     tmp_sch->Bind(split_res[1], "threadIdx.x");
 
+    if (cluster_sch.has_value()) {
+      return {cluster_sch.value(), tmp_sch, sch};
+    }
     return {tmp_sch, sch};
   }
 
@@ -126,6 +145,64 @@ class CrossThreadReductionNode : public ScheduleRuleNode {
   }
 
  private:
+  /*!
+   * \brief Split a long reduction across the thread blocks of a cluster, which combine their
+   * results through the distributed shared memory. The thread blocks of a cluster are bound to
+   * blockIdx.x and the spatial loops to blockIdx.y, so the block is not fused into its consumer.
+   * \param sch The TensorIR schedule
+   * \param block_rv The reduction block
+   * \return The new schedule, or nothing if the target has no cluster or the reduction is short
+   */
+  ffi::Optional<s_tir::Schedule> ApplyClusterReduction(const s_tir::Schedule& sch,
+                                                       const s_tir::SBlockRV& block_rv) {
+    if (!supports_cluster || cluster_extents.empty()) {
+      return std::nullopt;
+    }
+    auto [cum_space_len, cum_reduce_len] =
+        GetCumulativeSpaceAndReductionLength(sch->state(), sch->GetSRef(block_rv));
+    // blockIdx.y is at most 65535.
+    if (cum_space_len > 65535) {
+      return std::nullopt;
+    }
+    // Every thread block must still have more work than a full thread block can do at once.
+    ffi::Array<int64_t> extents;
+    for (int64_t extent : cluster_extents) {
+      if (cum_reduce_len % extent == 0 && cum_reduce_len / extent > max_threads_per_block) {
+        extents.push_back(extent);
+      }
+    }
+    if (extents.empty()) {
+      return std::nullopt;
+    }
+    s_tir::Schedule cluster_sch = sch->Copy();
+    cluster_sch->Seed(sch->ForkSeed());
+    size_t num_spatial_loops;
+    s_tir::LoopRV fused_reduce_loop;
+    ReorderAndFuseReductionLoops(cluster_sch, block_rv, &fused_reduce_loop, &num_spatial_loops);
+    int n_cluster = static_cast<int>(extents.size());
+    s_tir::ExprRV cluster_extent = cluster_sch->SampleCategorical(
+        extents, ffi::Array<FloatImm>(n_cluster, FloatImm(PrimType::Float(32), 1.0 / n_cluster)));
+    int n_thread = static_cast<int>(thread_extents.size());
+    s_tir::ExprRV thread_extent = cluster_sch->SampleCategorical(
+        thread_extents,
+        ffi::Array<FloatImm>(n_thread, FloatImm(PrimType::Float(32), 1.0 / n_thread)));
+    ffi::Array<s_tir::LoopRV> split =
+        cluster_sch->Split(fused_reduce_loop, {cluster_extent, std::nullopt, thread_extent});
+    if (num_spatial_loops > 0) {
+      ffi::Array<s_tir::LoopRV> loops = cluster_sch->GetLoops(block_rv);
+      s_tir::LoopRV spatial =
+          num_spatial_loops == 1
+              ? loops[0]
+              : cluster_sch->Fuse({loops.begin(), loops.begin() + num_spatial_loops});
+      cluster_sch->Bind(spatial, "blockIdx.y");
+    }
+    cluster_sch->Bind(split[0], "blockIdx.x");
+    cluster_sch->Bind(split[2], "threadIdx.x");
+    // The block is bound to the GPU here, so the rules after this one skip it.
+    cluster_sch->Annotate(block_rv, "schedule_rule", ffi::String("None"));
+    return cluster_sch;
+  }
+
   /*!
    * \brief Check whether the input block is in thread scope, i.e., some of its outer loop is
    * bound to threadIdx.
@@ -279,24 +356,38 @@ class CrossThreadReductionNode : public ScheduleRuleNode {
   int warp_size;
   /*! \brief Candidates of thread axis extent (values are required to be positive). */
   ffi::Array<int64_t> thread_extents;
+  /*!
+   * \brief Candidates of the number of thread blocks of a cluster that reduce a row together,
+   * empty to disable the reduction across thread blocks.
+   */
+  ffi::Array<int64_t> cluster_extents;
+  /*! \brief Whether the target supports thread block clusters */
+  bool supports_cluster = false;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
     refl::ObjectDef<CrossThreadReductionNode>()
         .def_ro("max_threads_per_block", &CrossThreadReductionNode::max_threads_per_block)
         .def_ro("warp_size", &CrossThreadReductionNode::warp_size)
-        .def_ro("thread_extents", &CrossThreadReductionNode::thread_extents);
+        .def_ro("thread_extents", &CrossThreadReductionNode::thread_extents)
+        .def_ro("cluster_extents", &CrossThreadReductionNode::cluster_extents);
   }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.CrossThreadReduction",
                                     CrossThreadReductionNode, ScheduleRuleNode);
 };
 
-ScheduleRule ScheduleRule::CrossThreadReduction(ffi::Array<int64_t> thread_extents) {
+ScheduleRule ScheduleRule::CrossThreadReduction(ffi::Array<int64_t> thread_extents,
+                                                ffi::Array<int64_t> cluster_extents) {
   for (int64_t extent : thread_extents) {
     TVM_FFI_CHECK(extent > 0, ValueError) << "The candidates of thread extent must be positive";
   }
+  for (int64_t extent : cluster_extents) {
+    TVM_FFI_CHECK(extent > 1 && extent <= 8, ValueError)
+        << "The candidates of cluster extent must be in [2, 8], but got " << extent;
+  }
   ffi::ObjectPtr<CrossThreadReductionNode> n = ffi::make_object<CrossThreadReductionNode>();
   n->thread_extents = std::move(thread_extents);
+  n->cluster_extents = std::move(cluster_extents);
   return ScheduleRule(n);
 }
 
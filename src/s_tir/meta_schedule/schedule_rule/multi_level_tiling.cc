@@ -94,12 +94,15 @@ void MultiLevelTilingNode::InitializeWithTuneContext(const TuneContext& context)
     if (support::StartsWith(sm, "sm_")) {
       sm = sm.substr(3);
       try {
+        int arch = std::stoi(sm);
         // only sm_80 or higher supports async memcopy
-        if (std::stoi(sm) >= 80) {
+        if (arch >= 80) {
           // only stage = 4 & 5 is tested. all integer that is bigger than 2
           // is theoretically feasible, but no guarantee for great performance.
           this->stages = {4, 5};
         }
+        // setmaxnreg needs sm_90 or higher
+        this->warp_specialization = arch >= 90;
       } catch (const std::invalid_argument& e) {
         LOG(WARNING) << "ValueError: Unable to parse `target.arch`: " << sm
                      << ". Details: " << e.what();
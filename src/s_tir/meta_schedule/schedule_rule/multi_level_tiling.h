@@ -224,6 +224,8 @@ class MultiLevelTilingNode : public ScheduleRuleNode {
   int max_threads_per_block_;
   /*! \brief All available async pipeline stages. */
   std::vector<int> stages;
+  /*! \brief Whether the target runs warp-specialized pipelines with register reallocation. */
+  bool warp_specialization = false;
   /*! \brief The logging function */
   ffi::Function logger;
   /*! \brief The function to overwrite the default condition for applying MultiLevelTiling. */
@@ -713,6 +713,19 @@ std::vector<State> MultiLevelTilingTensorCoreNode::AddSoftwarePipeline(
                 ffi::Array<int64_t>{0, 0, 1});
   sch->Annotate(state->tiles[r_indices_[1]].back(), s_tir::attr::software_pipeline_order,
                 ffi::Array<int64_t>{0, 1, 2});
+  std::vector<State> results;
+  if (state->is_mma && state->use_async && warp_specialization && thread_warp_size_ > 0) {
+    // Warp-specialized outer pipeline: a producer warpgroup copies the tiles of stage 0 into
+    // shared memory and the original warps consume them, handing over three versions of the
+    // tiles with mbarriers. The producers give up registers to the consumers.
+    State ws_state = state->Copy();
+    LoopRV outer_loop = state->tiles[r_indices_[0]].back();
+    ws_state->sch->Annotate(outer_loop, s_tir::attr::software_pipeline_stage,
+                            ffi::Array<int64_t>{0, 0, 1, 2, 2});
+    ws_state->sch->Annotate(outer_loop, s_tir::attr::software_pipeline_warp_specialize,
+                            ffi::Array<int64_t>{3, 128 / thread_warp_size_, 40, 232});
+    results.push_back(std::move(ws_state));
+  }
   if (state->is_mma && state->use_async) {
     sch->Annotate(state->tiles[r_indices_[0]].back(), s_tir::attr::software_pipeline_async_stages,
                   ffi::Array<int64_t>{0});
@@ -767,7 +780,8 @@ std::vector<State> MultiLevelTilingTensorCoreNode::AddSoftwarePipeline(
                   ffi::Array<int64_t>{0, 3, 1, 4, 5, 2, 6});
   }
 
-  return {state};
+  results.push_back(std::move(state));
+  return results;
 }
 
 ffi::Optional<LoopRV> MultiLevelTilingTensorCoreNode::TransformWithTensorIntrin(
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/cast.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/s_tir/stmt.h>
+
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+class PrefetchPipelineNode : public ScheduleRuleNode {
+ public:
+  // Inherited from ScheduleRuleNode
+  void InitializeWithTuneContext(const TuneContext& context) final {}
+
+  // Inherited from ScheduleRuleNode
+  ffi::Array<s_tir::Schedule> Apply(const s_tir::Schedule& sch,
+                                    const s_tir::SBlockRV& block_rv) final {
+    // Only blocks tiled by MultiLevelTiling have a reduction loop nest worth prefetching for.
+    if (!s_tir::GetAnn<ffi::String>(sch->GetSRef(block_rv),
+                                    s_tir::attr::meta_schedule_tiling_structure)
+             .has_value()) {
+      return {sch};
+    }
+    ffi::Optional<s_tir::LoopRV> reduction_loop;
+    for (const s_tir::LoopRV& loop_rv : sch->GetLoops(block_rv)) {
+      if (s_tir::GetLoopIterType(sch->GetSRef(loop_rv)) == IterVarType::kCommReduce) {
+        reduction_loop = loop_rv;
+        break;
+      }
+    }
+    if (!reduction_loop.has_value()) {
+      return {sch};
+    }
+    ffi::Array<s_tir::Schedule> results{sch};
+    for (int64_t distance : prefetch_distances) {
+      s_tir::Schedule new_sch = sch->Copy();
+      new_sch->Annotate(reduction_loop.value(), s_tir::attr::software_pipeline_stage,
+                        ffi::Array<int64_t>{distance});
+      new_sch->Annotate(reduction_loop.value(), s_tir::attr::software_pipeline_prefetch,
+                        IntImm::Int32(1));
+      results.push_back(new_sch);
+    }
+    return results;
+  }
+
+  // Inherited from ScheduleRuleNode
+  ScheduleRule Clone() const final {
+    ffi::ObjectPtr<PrefetchPipelineNode> n = ffi::make_object<PrefetchPipelineNode>(*this);
+    return ScheduleRule(n);
+  }
+
+ public:
+  /*! \brief The candidate numbers of iterations to prefetch ahead. */
+  ffi::Array<int64_t> prefetch_distances;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<PrefetchPipelineNode>().def_ro("prefetch_distances",
+                                                   &PrefetchPipelineNode::prefetch_distances);
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.PrefetchPipeline", PrefetchPipelineNode,
+                                    ScheduleRuleNode);
+};
+
+ScheduleRule ScheduleRule::PrefetchPipeline(ffi::Array<int64_t> prefetch_distances) {
+  for (int64_t distance : prefetch_distances) {
+    TVM_FFI_CHECK_GT(distance, 0, ValueError) << "Prefetch distances must be positive";
+  }
+  ffi::ObjectPtr<PrefetchPipelineNode> n = ffi::make_object<PrefetchPipelineNode>();
+  n->prefetch_distances = prefetch_distances;
+  return ScheduleRule(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { PrefetchPipelineNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("s_tir.meta_schedule.ScheduleRulePrefetchPipeline",
+                        ScheduleRule::PrefetchPipeline);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
@@ -88,50 +88,58 @@ ffi::Array<ScheduleRule> ScheduleRule::DefaultLLVM() {
 }
 
 ffi::Array<ScheduleRule> ScheduleRule::DefaultX86(const ffi::String& type) {
-  static const ffi::Map<ffi::String, ffi::String> intrins = {{"vnni", "dot_16x4_vnni"},
-                                                             {"avx512", "dot_16x4_avx512"}};
-  return {
-      ScheduleRule::ApplyCustomRule(),
-      ScheduleRule::InlineConstantScalars(),
-      ScheduleRule::AutoInline(
-          /*into_producer=*/false,
-          /*into_consumer=*/true,
-          /*inline_const_tensor=*/true,
-          /*disallow_if_then_else=*/true,
-          /*require_injective=*/true,
-          /*require_ordered=*/true,
-          /*disallow_op=*/ffi::Array<ffi::String>{"tirx.exp"}),
-      ScheduleRule::AddRFactor(
-          /*max_jobs_per_core=*/16,
-          /*max_innermost_factor=*/static_cast<int64_t>(64)),
-      ScheduleRule::MultiLevelTilingWithIntrin(
-          /*intrin_name=*/intrins[type],
-          /*structure=*/"SSRSRS",
-          /*tile_binds=*/std::nullopt,
-          /*max_innermost_factor=*/static_cast<int64_t>(64),
-          /*vector_load_lens=*/std::nullopt,
-          /*reuse_read=*/std::nullopt,
-          /*reuse_write=*/
-          ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
-                                          {"levels", ffi::Array<int64_t>{1, 2}},
-                                          {"scope", ffi::String("global")}}),
-      ScheduleRule::MultiLevelTiling(
-          /*structure=*/"SSRSRS",
-          /*tile_binds=*/std::nullopt,
-          /*max_innermost_factor=*/static_cast<int64_t>(64),
-          /*vector_load_lens=*/std::nullopt,
-          /*reuse_read=*/std::nullopt,
-          /*reuse_write=*/
-          ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
-                                          {"levels", ffi::Array<int64_t>{1, 2}},
-                                          {"scope", ffi::String("global")}}),
-      ScheduleRule::ParallelizeVectorizeUnroll(
-          /*max_jobs_per_core=*/16,
-          /*max_vectorize_extent=*/64,
-          /*unroll_max_steps=*/ffi::Array<int64_t>{0, 16, 64, 512},
-          /*unroll_explicit=*/true),
-      ScheduleRule::RandomComputeLocation(),
-  };
+  // AMX has a tile GEMM per input dtype, and each is tried in turn.
+  static const ffi::Map<ffi::String, ffi::Array<ffi::String>> intrins = {
+      {"vnni", {"dot_16x4_vnni"}},
+      {"avx512", {"dot_16x4_avx512"}},
+      {"amx",
+       {"dot_16x16x64_u8i8i32_amx", "dot_16x16x64_i8i8i32_amx", "dot_16x16x32_bf16bf16f32_amx"}}};
+  ffi::Array<ScheduleRule> rules;
+  rules.push_back(ScheduleRule::ApplyCustomRule());
+  rules.push_back(ScheduleRule::InlineConstantScalars());
+  rules.push_back(ScheduleRule::AutoInline(
+      /*into_producer=*/false,
+      /*into_consumer=*/true,
+      /*inline_const_tensor=*/true,
+      /*disallow_if_then_else=*/true,
+      /*require_injective=*/true,
+      /*require_ordered=*/true,
+      /*disallow_op=*/ffi::Array<ffi::String>{"tirx.exp"}));
+  rules.push_back(ScheduleRule::AddRFactor(
+      /*max_jobs_per_core=*/16,
+      /*max_innermost_factor=*/static_cast<int64_t>(64)));
+  for (const ffi::String& intrin_name : intrins.at(type)) {
+    rules.push_back(ScheduleRule::MultiLevelTilingWithIntrin(
+        /*intrin_name=*/intrin_name,
+        /*structure=*/"SSRSRS",
+        /*tile_binds=*/std::nullopt,
+        /*max_innermost_factor=*/static_cast<int64_t>(64),
+        /*vector_load_lens=*/std::nullopt,
+        /*reuse_read=*/std::nullopt,
+        /*reuse_write=*/
+        ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
+                                        {"levels", ffi::Array<int64_t>{1, 2}},
+                                        {"scope", ffi::String("global")}}));
+  }
+  rules.push_back(ScheduleRule::MultiLevelTiling(
+      /*structure=*/"SSRSRS",
+      /*tile_binds=*/std::nullopt,
+      /*max_innermost_factor=*/static_cast<int64_t>(64),
+      /*vector_load_lens=*/std::nullopt,
+      /*reuse_read=*/std::nullopt,
+      /*reuse_write=*/
+      ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
+                                      {"levels", ffi::Array<int64_t>{1, 2}},
+                                      {"scope", ffi::String("global")}}));
+  rules.push_back(
+      ScheduleRule::PrefetchPipeline(/*prefetch_distances=*/ffi::Array<int64_t>{1, 2}));
+  rules.push_back(ScheduleRule::ParallelizeVectorizeUnroll(
+      /*max_jobs_per_core=*/16,
+      /*max_vectorize_extent=*/64,
+      /*unroll_max_steps=*/ffi::Array<int64_t>{0, 16, 64, 512},
+      /*unroll_explicit=*/true));
+  rules.push_back(ScheduleRule::RandomComputeLocation());
+  return rules;
 }
 
 ffi::Array<ScheduleRule> ScheduleRule::DefaultCUDA() {
@@ -160,7 +168,8 @@ ffi::Array<ScheduleRule> ScheduleRule::DefaultCUDA() {
           /*require_ordered=*/false,
           /*disallow_op=*/ffi::Array<ffi::String>{}),
       ScheduleRule::CrossThreadReduction(
-          /*thread_extents=*/ffi::Array<int64_t>{4, 8, 16, 32, 64, 128, 256, 512}),
+          /*thread_extents=*/ffi::Array<int64_t>{4, 8, 16, 32, 64, 128, 256, 512},
+          /*cluster_extents=*/ffi::Array<int64_t>{2, 4, 8}),
       ScheduleRule::ParallelizeVectorizeUnroll(
           /*max_jobs_per_core=*/-1,
           /*max_vectorize_extent=*/-1,
@@ -219,6 +228,14 @@ ffi::Array<ScheduleRule> ScheduleRule::DefaultCUDATensorCore() {
           {"compute", "wmma_sync_16x16x16_s8s8s32_trans"},
           {"store", "wmma_store_16x16x16_s32_shared_dyn"},
       },
+      // Tensor Cores s32 += s4 * s4, only available with B in [N, K]
+      {
+          {"init", "wmma_fill_8x8x32_s32"},
+          {"load_a", "wmma_load_8x8x32_s4_a_shared_dyn"},
+          {"load_b", "wmma_load_8x8x32_s4_b_trans_shared_dyn"},
+          {"compute", "wmma_sync_8x8x32_s4s4s32_trans"},
+          {"store", "wmma_store_8x8x32_s32_shared_dyn"},
+      },
   };
   ffi::Array<ffi::Map<ffi::String, ffi::String>> mma_intrin_groups = {
       // Tensor Core MMA
@@ -296,6 +313,7 @@ ffi::Array<ScheduleRule> ScheduleRule::DefaultHexagon() {
           ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
                                           {"levels", ffi::Array<int64_t>{1, 2}},
                                           {"scope", ffi::String("global")}}),
+      ScheduleRule::VTCMPipeline(),
       ScheduleRule::ParallelizeVectorizeUnroll(
           /*max_jobs_per_core=*/16,
           /*max_vectorize_extent=*/128,
@@ -441,6 +459,7 @@ ffi::Array<ScheduleRule> ScheduleRule::DefaultARM(const ffi::String& type) {
           ffi::Map<ffi::String, ffi::Any>{{"req", ffi::String("may")},
                                           {"levels", ffi::Array<int64_t>{1, 2}},
                                           {"scope", ffi::String("global")}}),
+      ScheduleRule::PrefetchPipeline(/*prefetch_distances=*/ffi::Array<int64_t>{1, 2}),
       ScheduleRule::ParallelizeVectorizeUnroll(
           /*max_jobs_per_core=*/8,
           /*max_vectorize_extent=*/32,
@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/reflection/registry.h>
+
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+class SplitKNode : public ScheduleRuleNode {
+ public:
+  // Inherited from ScheduleRuleNode
+  void InitializeWithTuneContext(const TuneContext& context) final {
+    TVM_FFI_ICHECK(context->target.has_value());
+    Target target = context->target.value();
+    ffi::Optional<int64_t> opt_max_threads_per_block =
+        target->GetAttr<int64_t>("max_threads_per_block");
+    ffi::Optional<int64_t> opt_warp_size = target->GetAttr<int64_t>("thread_warp_size");
+    if (!opt_max_threads_per_block.has_value() || !opt_warp_size.has_value()) {
+      TVM_PY_LOG(WARNING, context->logger)
+          << "Target does not have attribute \"max_threads_per_block\" or \"thread_warp_size\", "
+             "therefore the rule SplitK will not be applied";
+    }
+    max_threads_per_block = opt_max_threads_per_block.value_or(-1);
+    warp_size = opt_warp_size.value_or(-1);
+  }
+
+  // Inherited from ScheduleRuleNode
+  ffi::Array<s_tir::Schedule> Apply(const s_tir::Schedule& sch, const s_tir::SBlockRV& block_rv);
+
+  // Inherited from ScheduleRuleNode
+  ScheduleRule Clone() const final {
+    ffi::ObjectPtr<SplitKNode> n = ffi::make_object<SplitKNode>(*this);
+    return ScheduleRule(n);
+  }
+
+ private:
+  /*!
+   * \brief Bind the loops of the block computing the partial sums, whose loops are the fused
+   * spatial loop, the split-K loop and the remaining reduction loop, from outer to inner.
+   * \param sch The schedule
+   * \param block_rf The rfactor block computing the partial sums
+   * \param num_spatial_loops The number of spatial loops outside the block
+   * \param thread_extent The extent of threadIdx.x
+   * \param stream_k Whether to distribute all the (output, split) work over a fixed grid
+   */
+  void BindPartialSums(const s_tir::Schedule& sch, const s_tir::SBlockRV& block_rf,
+                       size_t num_spatial_loops, const s_tir::ExprRV& thread_extent,
+                       bool stream_k) const {
+    ffi::Array<s_tir::LoopRV> loops = sch->GetLoops(block_rf);
+    TVM_FFI_ICHECK_EQ(loops.size(), num_spatial_loops + 2);
+    s_tir::LoopRV spatial = num_spatial_loops == 1
+                                ? loops[0]
+                                : sch->Fuse({loops.begin(), loops.begin() + num_spatial_loops});
+    s_tir::LoopRV split_k = loops[num_spatial_loops];
+    if (stream_k) {
+      s_tir::LoopRV work = sch->Fuse({spatial, split_k});
+      ffi::Array<s_tir::LoopRV> split =
+          sch->Split(work, {IntImm::Int32(stream_k_num_blocks), std::nullopt});
+      sch->Bind(split[0], "blockIdx.x");
+    } else {
+      sch->Bind(spatial, "blockIdx.x");
+      sch->Bind(split_k, "blockIdx.y");
+    }
+    // The remaining reduction is a cross-thread reduction inside each thread block.
+    ffi::Array<s_tir::LoopRV> split =
+        sch->Split(loops[num_spatial_loops + 1], {std::nullopt, thread_extent});
+    sch->Bind(split[1], "threadIdx.x");
+  }
+
+ public:
+  /*! \brief Candidates of the number of thread blocks each reduction is split across */
+  ffi::Array<int64_t> split_factors;
+  /*! \brief Candidates of thread axis extent (values are required to be positive) */
+  ffi::Array<int64_t> thread_extents;
+  /*! \brief The minimum reduction extent for the rule to apply */
+  int64_t min_reduction_extent;
+  /*! \brief The maximum spatial extent for the rule to apply */
+  int64_t max_spatial_extent;
+  /*! \brief The number of thread blocks of the Stream-K variant, -1 to disable the variant */
+  int64_t stream_k_num_blocks;
+  /*! \brief The maximum number of threads allowed in a thread block */
+  int64_t max_threads_per_block = -1;
+  /*! \brief The number of threads per warp */
+  int64_t warp_size = -1;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<SplitKNode>()
+        .def_ro("split_factors", &SplitKNode::split_factors)
+        .def_ro("thread_extents", &SplitKNode::thread_extents)
+        .def_ro("min_reduction_extent", &SplitKNode::min_reduction_extent)
+        .def_ro("max_spatial_extent", &SplitKNode::max_spatial_extent)
+        .def_ro("stream_k_num_blocks", &SplitKNode::stream_k_num_blocks);
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.SplitK", SplitKNode, ScheduleRuleNode);
+};
+
+ScheduleRule ScheduleRule::SplitK(ffi::Array<int64_t> split_factors,
+                                  ffi::Array<int64_t> thread_extents, int64_t min_reduction_extent,
+                                  int64_t max_spatial_extent,
+                                  ffi::Optional<int64_t> stream_k_num_blocks) {
+  for (int64_t factor : split_factors) {
+    TVM_FFI_CHECK(factor > 1, ValueError) << "The candidates of split factor must be larger than 1";
+  }
+  for (int64_t extent : thread_extents) {
+    TVM_FFI_CHECK(extent > 0, ValueError) << "The candidates of thread extent must be positive";
+  }
+  TVM_FFI_CHECK(!stream_k_num_blocks.has_value() || stream_k_num_blocks.value() > 0, ValueError)
+      << "The number of thread blocks of Stream-K must be positive";
+  ffi::ObjectPtr<SplitKNode> n = ffi::make_object<SplitKNode>();
+  n->split_factors = std::move(split_factors);
+  n->thread_extents = std::move(thread_extents);
+  n->min_reduction_extent = min_reduction_extent;
+  n->max_spatial_extent = max_spatial_extent;
+  n->stream_k_num_blocks = stream_k_num_blocks.value_or(-1);
+  return ScheduleRule(n);
+}
+
+ffi::Array<s_tir::Schedule> SplitKNode::Apply(const s_tir::Schedule& sch,
+                                              const s_tir::SBlockRV& block_rv) {
+  // Step 0. Check the conditions of this rule. Splitting a reduction across thread blocks only
+  // pays off when the spatial loops alone cannot fill the device, e.g. a matmul whose M is a few
+  // rows and whose K is in the thousands.
+  if (max_threads_per_block == -1 || warp_size == -1) {
+    return {sch};
+  }
+  tirx::StmtSRef block_sref = sch->GetSRef(block_rv);
+  if (!NeedsRFactorOrCrossThreadReduction(sch->state(), block_sref, max_spatial_extent,
+                                          max_threads_per_block)) {
+    return {sch};
+  }
+  auto [cum_space_len, cum_reduce_len] =
+      GetCumulativeSpaceAndReductionLength(sch->state(), block_sref);
+  if (cum_space_len > max_spatial_extent || cum_reduce_len < min_reduction_extent) {
+    return {sch};
+  }
+  // Each split must still leave at least a warp of work to the cross-thread reduction.
+  ffi::Array<int64_t> factors;
+  for (int64_t factor : split_factors) {
+    if (cum_reduce_len % factor == 0 && cum_reduce_len / factor >= warp_size) {
+      factors.push_back(factor);
+    }
+  }
+  ffi::Array<int64_t> extents;
+  for (int64_t extent : thread_extents) {
+    if (extent <= max_threads_per_block) {
+      extents.push_back(extent);
+    }
+  }
+  if (factors.empty() || extents.empty()) {
+    return {sch};
+  }
+
+  // Step 1. Make a copy of the original schedule.
+  s_tir::Schedule ori_sch = sch->Copy();
+  ori_sch->Seed(sch->ForkSeed());
+
+  // Step 2. Reorder the reduction loops innermost and fuse them, then split the fused loop into
+  // the split-K loop and the reduction done by each thread block.
+  size_t num_spatial_loops;
+  s_tir::LoopRV fused_reduce_loop;
+  ReorderAndFuseReductionLoops(sch, block_rv, &fused_reduce_loop, &num_spatial_loops);
+  if (num_spatial_loops == 0) {
+    return {ori_sch};
+  }
+  int n_factor = static_cast<int>(factors.size());
+  s_tir::ExprRV split_factor = sch->SampleCategorical(
+      factors, ffi::Array<FloatImm>(n_factor, FloatImm(PrimType::Float(32), 1.0 / n_factor)));
+  int n_extent = static_cast<int>(extents.size());
+  s_tir::ExprRV thread_extent = sch->SampleCategorical(
+      extents, ffi::Array<FloatImm>(n_extent, FloatImm(PrimType::Float(32), 1.0 / n_extent)));
+  ffi::Array<s_tir::LoopRV> split = sch->Split(fused_reduce_loop, {split_factor, std::nullopt});
+
+  // Step 3. Factor the split-K loop out into a block computing the partial sums, whose buffer is
+  // the workspace, and reduce the partial sums in the original block. Neither block is visited by
+  // the rules after this one, so both are bound to the GPU here.
+  ffi::Array<s_tir::Schedule> res;
+  for (bool stream_k : {false, true}) {
+    if (stream_k && stream_k_num_blocks == -1) {
+      continue;
+    }
+    s_tir::Schedule sch_tmp = sch->Copy();
+    sch_tmp->Seed(sch->ForkSeed());
+    try {
+      s_tir::SBlockRV block_rf = sch_tmp->RFactor(split[0], num_spatial_loops);
+      BindPartialSums(sch_tmp, block_rf, num_spatial_loops, thread_extent, stream_k);
+
+      ffi::Array<s_tir::LoopRV> loops = sch_tmp->GetLoops(block_rv);
+      TVM_FFI_ICHECK_EQ(loops.size(), num_spatial_loops + 1);
+      s_tir::LoopRV spatial =
+          num_spatial_loops == 1
+              ? loops[0]
+              : sch_tmp->Fuse({loops.begin(), loops.begin() + num_spatial_loops});
+      ffi::Array<s_tir::LoopRV> spatial_split =
+          sch_tmp->Split(spatial, {std::nullopt, thread_extent});
+      sch_tmp->Bind(spatial_split[0], "blockIdx.x");
+      sch_tmp->Bind(spatial_split[1], "threadIdx.x");
+      sch_tmp->Annotate(block_rv, "schedule_rule", ffi::String("None"));
+      res.push_back(sch_tmp);
+    } catch (const tvm::ffi::Error& e) {
+    }
+  }
+
+  res.push_back(ori_sch);
+  return res;
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { SplitKNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("s_tir.meta_schedule.ScheduleRuleSplitK", ScheduleRule::SplitK);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
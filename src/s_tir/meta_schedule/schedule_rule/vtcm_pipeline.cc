@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/cast.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/s_tir/stmt.h>
+
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+class VTCMPipelineNode : public ScheduleRuleNode {
+ public:
+  // Inherited from ScheduleRuleNode
+  void InitializeWithTuneContext(const TuneContext& context) final {}
+
+  // Inherited from ScheduleRuleNode
+  ffi::Array<s_tir::Schedule> Apply(const s_tir::Schedule& sch,
+                                    const s_tir::SBlockRV& block_rv) final {
+    // Only blocks tiled by MultiLevelTiling have a reduction loop nest whose tiles fit in VTCM.
+    if (!s_tir::GetAnn<ffi::String>(sch->GetSRef(block_rv),
+                                    s_tir::attr::meta_schedule_tiling_structure)
+             .has_value()) {
+      return {sch};
+    }
+    ffi::Optional<s_tir::LoopRV> reduction_loop;
+    for (const s_tir::LoopRV& loop_rv : sch->GetLoops(block_rv)) {
+      if (s_tir::GetLoopIterType(sch->GetSRef(loop_rv)) == IterVarType::kCommReduce) {
+        reduction_loop = loop_rv;
+        break;
+      }
+    }
+    if (!reduction_loop.has_value()) {
+      return {sch};
+    }
+    // The operands, i.e. the buffers read but not written by the block.
+    const SBlockNode* block = sch->Get(block_rv).get();
+    std::vector<int> operand_indices;
+    for (size_t i = 0; i < block->reads.size(); ++i) {
+      const tirx::Buffer& buffer = block->reads[i]->buffer;
+      if (std::none_of(block->writes.begin(), block->writes.end(),
+                       [&](const BufferRegion& write) { return write->buffer.same_as(buffer); })) {
+        operand_indices.push_back(static_cast<int>(i));
+      }
+    }
+    if (operand_indices.empty()) {
+      return {sch};
+    }
+
+    s_tir::Schedule new_sch = sch->Copy();
+    try {
+      // Copy the tiles of the operands read by each iteration of the reduction loop into VTCM.
+      for (int index : operand_indices) {
+        s_tir::SBlockRV cache = new_sch->CacheRead(block_rv, index, "global.vtcm");
+        new_sch->ComputeAt(cache, reduction_loop.value(), /*preserve_unit_loops=*/true);
+      }
+    } catch (const tvm::ffi::Error& e) {
+      return {sch};
+    }
+    const auto* body = TVM_SREF_TO_FOR(new_sch->GetSRef(reduction_loop.value()))
+                           ->body.as<tirx::SeqStmtNode>();
+    if (body == nullptr || body->seq.size() != operand_indices.size() + 1) {
+      return {sch};
+    }
+    // The copies form the asynchronous stage 0, lowered to DMA by LowerAsyncDMA, and the compute
+    // on the resident tiles forms stage 1, so the tiles of the next iteration are transferred
+    // while the current ones are used and the VTCM buffers are double-buffered.
+    ffi::Array<int64_t> stages(operand_indices.size(), 0);
+    stages.push_back(1);
+    ffi::Array<int64_t> orders;
+    for (size_t i = 0; i <= operand_indices.size(); ++i) {
+      orders.push_back(static_cast<int64_t>(i));
+    }
+    new_sch->Annotate(reduction_loop.value(), s_tir::attr::software_pipeline_stage, stages);
+    new_sch->Annotate(reduction_loop.value(), s_tir::attr::software_pipeline_order, orders);
+    new_sch->Annotate(reduction_loop.value(), s_tir::attr::software_pipeline_async_stages,
+                      ffi::Array<int64_t>{0});
+    return {sch, new_sch};
+  }
+
+  // Inherited from ScheduleRuleNode
+  ScheduleRule Clone() const final {
+    ffi::ObjectPtr<VTCMPipelineNode> n = ffi::make_object<VTCMPipelineNode>(*this);
+    return ScheduleRule(n);
+  }
+
+ public:
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<VTCMPipelineNode>();
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.VTCMPipeline", VTCMPipelineNode,
+                                    ScheduleRuleNode);
+};
+
+ScheduleRule ScheduleRule::VTCMPipeline() {
+  ffi::ObjectPtr<VTCMPipelineNode> n = ffi::make_object<VTCMPipelineNode>();
+  return ScheduleRule(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { VTCMPipelineNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("s_tir.meta_schedule.ScheduleRuleVTCMPipeline", ScheduleRule::VTCMPipeline);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
@@ -20,9 +20,17 @@
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/reflection/registry.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <mutex>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "../module_equality.h"
+#include "../trace_apply.h"
 #include "../utils.h"
 
 #define TVM_META_SCHEDULE_CHECK_PROB_RANGE(p, name)   \
@@ -210,6 +218,59 @@ struct ConcurrentBitmask {
   }
 };
 
+/*!
+ * \brief A concurrent set of the mutated traces that failed to replay or to pass the
+ *  postprocessors, so that a mutant sampled again is rejected without the replay.
+ */
+struct ConcurrentFailureCache {
+  /*! \brief The number of shards, each guarded by its own mutex. */
+  static constexpr const int kNumShards = 64;
+  /*! \brief The fingerprints of the failed traces, sharded by the fingerprint. */
+  std::vector<std::unordered_set<uint64_t>> shards;
+  /*! \brief The mutexes, one per shard. */
+  std::vector<std::mutex> mutexes;
+  /*! \brief The number of the mutants rejected by the cache. */
+  std::atomic<int64_t> num_hits{0};
+
+  ConcurrentFailureCache() : shards(kNumShards), mutexes(kNumShards) {}
+
+  /*!
+   * \brief The fingerprint of a trace, i.e. the instruction kinds and the decisions before the
+   *  postprocessing. A mutant only differs from the sampled trace in its decisions, so the
+   *  fingerprint identifies the mutant among the traces of the same design space.
+   */
+  static uint64_t Fingerprint(const s_tir::Trace& trace) {
+    uint64_t result = trace->insts.size();
+    for (const s_tir::Instruction& inst : trace->insts) {
+      if (inst->kind->IsPostproc()) {
+        break;
+      }
+      // The instruction kinds are singletons in the registry
+      result = support::HashCombine(result, reinterpret_cast<uintptr_t>(inst->kind.get()));
+      if (ffi::Optional<Any> decision = trace->decisions.Get(inst)) {
+        result = support::HashCombine(result, ffi::StructuralHash()(decision.value()));
+      }
+    }
+    return result;
+  }
+  /*! \brief Check if a trace with the fingerprint is known to fail, counting the hits. */
+  bool Query(uint64_t fingerprint) {
+    int shard = fingerprint % kNumShards;
+    std::unique_lock<std::mutex> lock(mutexes[shard]);
+    if (shards[shard].count(fingerprint)) {
+      ++num_hits;
+      return true;
+    }
+    return false;
+  }
+  /*! \brief Mark a trace with the fingerprint as failed. */
+  void Mark(uint64_t fingerprint) {
+    int shard = fingerprint % kNumShards;
+    std::unique_lock<std::mutex> lock(mutexes[shard]);
+    shards[shard].insert(fingerprint);
+  }
+};
+
 /**************** Util Functions ****************/
 
 /*!
@@ -270,17 +331,26 @@ class EvolutionarySearchNode : public SearchStrategyNode {
     ffi::Array<s_tir::Trace> design_spaces;
     /*! \brief Pre thread data including module to be tuned and random state. */
     std::vector<PerThreadData> per_thread_data_;
-    /*!
-     * \brief The workloads that are already measured.
-     * TODO(junrushao1994): add records from the database to avoid re-measuring.
-     * */
+    /*! \brief The workloads that are already measured, including those in the database. */
     IRModuleSet measured_workloads_;
+    /*! \brief The schedules transferred from the best records of similar workloads. */
+    std::vector<Schedule> warm_starts_;
+    /*! \brief The mutants that are known to fail, kept across the generations. */
+    ConcurrentFailureCache failed_mutants_;
     /*! \brief A Database for selecting useful candidates. */
     Database database_{ffi::UnsafeInit()};
     /*! \brief A cost model helping to explore the search space */
     CostModel cost_model_{ffi::UnsafeInit()};
     /*! \brief The token registered for the given workload in database. */
     Workload token_{ffi::UnsafeInit()};
+    /*!
+     * \brief The memoized hashes of the modules seen in the current round. A candidate is hashed
+     * when it is deduplicated in evolution, in picking and in the measured set, so the hash is
+     * computed once and looked up by identity afterwards. The memo keeps the modules alive, so a
+     * module in it is never mutated in place and its address is never reused.
+     */
+    mutable std::unordered_map<IRModule, size_t, ffi::ObjectPtrHash, ffi::ObjectPtrEqual>
+        shash_memo_;
 
     explicit State(EvolutionarySearchNode* self, int max_trials, int num_trials_per_iter,
                    ffi::Array<Schedule> design_space_schedules, Database database,
@@ -306,8 +376,30 @@ class EvolutionarySearchNode : public SearchStrategyNode {
       this->database_ = database;
       this->cost_model_ = cost_model;
       this->token_ = database->CommitWorkload(mod);
+      this->PruneDesignSpaces();
+      this->SeedFromDatabase();
     }
 
+    /*!
+     * \brief Score a few random samples of every design space with the cost model, and keep only
+     *  the design spaces with the best samples, as configured by `design_space_keep_ratio`.
+     */
+    inline void PruneDesignSpaces();
+
+    /*!
+     * \brief Mark the schedules that the database measured for the workload, and transfer the
+     *  best records of the workloads with the same anchor block into the warm starts.
+     */
+    inline void SeedFromDatabase();
+    /*!
+     * \brief Replay traces on the module to be tuned, followed by the postprocessors.
+     * \param traces The traces to replay.
+     * \param pp The trace applier, which collects the failures.
+     * \return The schedules of the traces that are replayed successfully.
+     */
+    inline std::vector<Schedule> ReplayTraces(const std::vector<s_tir::Trace>& traces,
+                                              ThreadedTraceApply* pp);
+
     /*!
      * \brief Pick up best candidates from database.
      * \param num The number of traces to produce.
@@ -386,6 +478,20 @@ class EvolutionarySearchNode : public SearchStrategyNode {
   /*** Configuration: pick states for measurement ***/
   /*! \brief The ratio of measurements to use randomly sampled states. */
   double eps_greedy;
+  /*** Configuration: warm start ***/
+  /*!
+   * \brief The number of best records taken from each workload in the database that shares the
+   *  anchor block of the tuned one, to warm-start the initial population. 0 to disable it.
+   */
+  int warm_start_top_k;
+  /*** Configuration: design space pruning ***/
+  /*!
+   * \brief The fraction of the design spaces kept for the search, ranked by the best predicted
+   *  score of their samples. 1.0 to keep all of them.
+   */
+  double design_space_keep_ratio;
+  /*! \brief The number of random samples of each design space scored to rank them. */
+  int design_space_prune_samples;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -399,7 +505,11 @@ class EvolutionarySearchNode : public SearchStrategyNode {
         .def_ro("genetic_num_iters", &EvolutionarySearchNode::genetic_num_iters)
         .def_ro("genetic_mutate_prob", &EvolutionarySearchNode::genetic_mutate_prob)
         .def_ro("genetic_max_fail_count", &EvolutionarySearchNode::genetic_max_fail_count)
-        .def_ro("eps_greedy", &EvolutionarySearchNode::eps_greedy);
+        .def_ro("eps_greedy", &EvolutionarySearchNode::eps_greedy)
+        .def_ro("warm_start_top_k", &EvolutionarySearchNode::warm_start_top_k)
+        .def_ro("design_space_keep_ratio", &EvolutionarySearchNode::design_space_keep_ratio)
+        .def_ro("design_space_prune_samples",
+                &EvolutionarySearchNode::design_space_prune_samples);
   }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.EvolutionarySearch",
                                     EvolutionarySearchNode, SearchStrategyNode);
@@ -471,6 +581,9 @@ class EvolutionarySearchNode : public SearchStrategyNode {
     n->genetic_mutate_prob = this->genetic_mutate_prob;
     n->genetic_max_fail_count = this->genetic_max_fail_count;
     n->eps_greedy = this->eps_greedy;
+    n->warm_start_top_k = this->warm_start_top_k;
+    n->design_space_keep_ratio = this->design_space_keep_ratio;
+    n->design_space_prune_samples = this->design_space_prune_samples;
     n->ctx_ = this->ctx_;
     n->rand_state_ = this->rand_state_;
     n->state_ = nullptr;  // cleared the state
@@ -478,6 +591,135 @@ class EvolutionarySearchNode : public SearchStrategyNode {
   }
 };
 
+void EvolutionarySearchNode::State::SeedFromDatabase() {
+  auto _ = Profiler::TimedScope("EvoSearch/SeedFromDatabase");
+  const IRModule& mod = self->ctx_->mod.value();
+  // Step 1. Mark the schedules measured in previous runs, so that they are not measured again.
+  {
+    int num_records = static_cast<int>(
+        std::min<int64_t>(database_->Size(), std::numeric_limits<int>::max()));
+    std::vector<s_tir::Trace> traces;
+    for (const TuningRecord& record : database_->GetTopK(token_, num_records)) {
+      traces.push_back(record->trace);
+    }
+    ThreadedTraceApply pp(self->postprocs_);
+    int num_marked = 0;
+    for (const Schedule& sch : ReplayTraces(traces, &pp)) {
+      IRModule measured = sch->mod();
+      size_t shash = ModuleHash(measured);
+      if (!measured_workloads_.Has(measured, shash)) {
+        measured_workloads_.Add(measured, shash);
+        ++num_marked;
+      }
+    }
+    TVM_PY_LOG(INFO, self->ctx_->logger)
+        << "Marked " << num_marked << " schedule(s) measured in the database";
+  }
+  // Step 2. Transfer the best records of the other workloads with the same anchor block.
+  if (self->warm_start_top_k <= 0) {
+    return;
+  }
+  std::unique_ptr<ModuleEquality> anchor_eq = ModuleEquality::Create("anchor-block");
+  std::unordered_set<const WorkloadNode*> visited;
+  std::vector<s_tir::Trace> traces;
+  for (const TuningRecord& record : database_->GetAllTuningRecords()) {
+    const Workload& workload = record->workload;
+    if (!visited.insert(workload.get()).second ||
+        database_->GetModuleEquality().Equal(workload->mod, mod) ||
+        !anchor_eq->Equal(workload->mod, mod)) {
+      continue;
+    }
+    for (const TuningRecord& similar : database_->GetTopK(workload, self->warm_start_top_k)) {
+      Schedule sch = Schedule::Traced(mod, /*seed=*/-1, /*debug_mask=*/0,
+                                      /*error_render_level=*/ScheduleErrorRenderLevel::kNone);
+      try {
+        ScheduleUsingAnchorTrace(sch, similar->trace, self->ctx_->target.value());
+      } catch (const std::exception&) {
+        // The anchor trace does not fit this workload, skip it.
+        continue;
+      }
+      traces.push_back(sch->trace().value());
+    }
+  }
+  ThreadedTraceApply pp(self->postprocs_);
+  this->warm_starts_ = ReplayTraces(traces, &pp);
+  TVM_PY_LOG(INFO, self->ctx_->logger)
+      << "Transferred " << warm_starts_.size() << " schedule(s) from similar workloads";
+}
+
+void EvolutionarySearchNode::State::PruneDesignSpaces() {
+  int num_spaces = design_spaces.size();
+  int num_keep = std::max(
+      1, static_cast<int>(std::ceil(num_spaces * self->design_space_keep_ratio - 1e-9)));
+  if (num_keep >= num_spaces || self->design_space_prune_samples <= 0) {
+    return;
+  }
+  auto _ = Profiler::TimedScope("EvoSearch/PruneDesignSpaces");
+  ThreadedTraceApply pp(self->postprocs_);
+  std::vector<Schedule> samples;
+  std::vector<int> space_of_sample;
+  for (int i = 0; i < num_spaces; ++i) {
+    std::vector<s_tir::Trace> traces(self->design_space_prune_samples,
+                                     s_tir::Trace(design_spaces[i]->insts, {}));
+    for (const Schedule& sch : ReplayTraces(traces, &pp)) {
+      samples.push_back(sch);
+      space_of_sample.push_back(i);
+    }
+  }
+  if (samples.empty()) {
+    TVM_PY_LOG(WARNING, self->ctx_->logger)
+        << "PruneDesignSpaces found no valid sample of any design space, keeping them all";
+    return;
+  }
+  // A design space without any valid sample ranks below all the others.
+  std::vector<double> best_score(num_spaces, -1.0);
+  std::vector<double> scores =
+      PredictNormalizedScore(samples, ffi::GetRef<TuneContext>(self->ctx_), this->cost_model_);
+  for (int i = 0, n = scores.size(); i < n; ++i) {
+    double& best = best_score[space_of_sample[i]];
+    best = std::max(best, scores[i]);
+  }
+  std::vector<int> order(num_spaces);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&best_score](int a, int b) { return best_score[a] > best_score[b]; });
+  // The kept design spaces stay in their original order.
+  order.resize(num_keep);
+  std::sort(order.begin(), order.end());
+  ffi::Array<s_tir::Trace> kept;
+  kept.reserve(num_keep);
+  for (int i : order) {
+    kept.push_back(design_spaces[i]);
+  }
+  design_spaces = kept;
+  TVM_PY_LOG(INFO, self->ctx_->logger)
+      << "Kept " << num_keep << " of " << num_spaces << " design space(s) after scoring "
+      << samples.size() << " sample(s) with the cost model";
+}
+
+std::vector<Schedule> EvolutionarySearchNode::State::ReplayTraces(
+    const std::vector<s_tir::Trace>& traces, ThreadedTraceApply* pp) {
+  int num = traces.size();
+  std::vector<Schedule> results(num, Schedule{nullptr});
+  auto f_proc = [this, &traces, &results, pp](int thread_id, int trace_id) -> void {
+    PerThreadData& data = this->per_thread_data_.at(thread_id);
+    Schedule& result = results.at(trace_id);
+    TVM_FFI_ICHECK(!result.defined());
+    if (ffi::Optional<Schedule> sch = pp->Apply(data.mod, traces.at(trace_id), &data.rand_state)) {
+      result = sch.value();
+    }
+  };
+  support::parallel_for_dynamic(0, num, self->ctx_->num_threads, f_proc);
+  std::vector<Schedule> filtered;
+  filtered.reserve(num);
+  for (const Schedule& sch : results) {
+    if (sch.defined()) {
+      filtered.push_back(sch);
+    }
+  }
+  return filtered;
+}
+
 std::vector<Schedule> EvolutionarySearchNode::State::PickBestFromDatabase(int num) {
   auto _ = Profiler::TimedScope("EvoSearch/PickBestFromDatabase");
   std::vector<s_tir::Trace> measured_traces;
@@ -486,22 +728,8 @@ std::vector<Schedule> EvolutionarySearchNode::State::PickBestFromDatabase(int nu
   for (TuningRecord record : top_records) {
     measured_traces.push_back(record->trace);
   }
-  int actual_num = measured_traces.size();
   ThreadedTraceApply pp(self->postprocs_);
-  std::vector<Schedule> results(actual_num, Schedule{nullptr});
-  auto f_proc_measured = [this, &measured_traces, &results, &pp](int thread_id,
-                                                                 int trace_id) -> void {
-    PerThreadData& data = this->per_thread_data_.at(thread_id);
-    TRandState* rand_state = &data.rand_state;
-    const IRModule& mod = data.mod;
-    s_tir::Trace trace = measured_traces.at(trace_id);
-    Schedule& result = results.at(trace_id);
-    TVM_FFI_ICHECK(!result.defined());
-    if (ffi::Optional<Schedule> sch = pp.Apply(mod, trace, rand_state)) {
-      result = sch.value();
-    }
-  };
-  support::parallel_for_dynamic(0, actual_num, self->ctx_->num_threads, f_proc_measured);
+  std::vector<Schedule> results = ReplayTraces(measured_traces, &pp);
   TVM_PY_LOG(INFO, self->ctx_->logger) << "Pick-Best-From-Database summary:\n"
                                        << pp.SummarizeFailures();
   if (pp.TraceFailCount() > 0) {
@@ -509,14 +737,7 @@ std::vector<Schedule> EvolutionarySearchNode::State::PickBestFromDatabase(int nu
         << "PickBestFromDatabase skipped " << pp.TraceFailCount()
         << " candidate(s) due to trace replay failures";
   }
-  std::vector<Schedule> filtered;
-  filtered.reserve(actual_num);
-  for (const Schedule& sch : results) {
-    if (sch.defined()) {
-      filtered.push_back(sch);
-    }
-  }
-  return filtered;
+  return results;
 }
 
 std::vector<Schedule> EvolutionarySearchNode::State::SampleInitPopulation(int num) {
@@ -602,6 +823,7 @@ std::vector<Schedule> EvolutionarySearchNode::State::EvolveWithCostModel(
       ConcurrentBitmask cbmask(self->population_size);
       std::vector<Schedule> next_population(self->population_size, Schedule{nullptr});
       // The worker function
+      int64_t num_hits_before = this->failed_mutants_.num_hits;
       auto f_find_candidate = [&cbmask, &population, &next_population, &pp, this](int thread_id,
                                                                                   int trace_id) {
         // Prepare samplers
@@ -621,12 +843,17 @@ std::vector<Schedule> EvolutionarySearchNode::State::EvolveWithCostModel(
             // Decision: mutate
             Mutator mutator = opt_mutator.value();
             if (ffi::Optional<s_tir::Trace> new_trace = mutator->Apply(trace, rand_state)) {
+              uint64_t fingerprint = ConcurrentFailureCache::Fingerprint(new_trace.value());
+              if (this->failed_mutants_.Query(fingerprint)) {
+                continue;
+              }
               if (ffi::Optional<Schedule> sch = pp.Apply(mod, new_trace.value(), rand_state)) {
                 // note that sch's trace is different from new_trace
                 // because it contains post-processing information
                 result = sch.value();
                 break;
               }
+              this->failed_mutants_.Mark(fingerprint);
             }
           } else if (cbmask.QueryAndMark(sampled_trace_id)) {
             // Decision: do not mutate
@@ -642,8 +869,10 @@ std::vector<Schedule> EvolutionarySearchNode::State::EvolveWithCostModel(
                                     f_find_candidate);
 
       population.swap(next_population);
-      TVM_PY_LOG(INFO, self->ctx_->logger) << "Evolve iter #" << iter << " done. Summary:\n"
-                                           << pp.SummarizeFailures();
+      TVM_PY_LOG(INFO, self->ctx_->logger)
+          << "Evolve iter #" << iter << " done. Summary:\n"
+          << pp.SummarizeFailures() << "\nKnown-invalid mutants rejected without replay: "
+          << this->failed_mutants_.num_hits - num_hits_before;
     }
   }
   // Return the best states from the heap, sorting from higher score to lower ones
@@ -731,6 +960,8 @@ EvolutionarySearchNode::State::GenerateMeasureCandidates() {
     ed = max_trials;
   }
   TVM_FFI_ICHECK_LT(st, ed);
+  // The candidates of the previous round are not queried again.
+  shash_memo_.clear();
   int pop = self->population_size;
   std::vector<Schedule> inits;
   inits.reserve(pop);
@@ -747,6 +978,7 @@ EvolutionarySearchNode::State::GenerateMeasureCandidates() {
   }
   TVM_PY_LOG(INFO, self->ctx_->logger) << "Sampled " << unmeasured.size() << " candidate(s)";
   inits.insert(inits.end(), measured.begin(), measured.end());
+  inits.insert(inits.end(), warm_starts_.begin(), warm_starts_.end());
   inits.insert(inits.end(), unmeasured.begin(), unmeasured.end());
   std::vector<Schedule> bests = EvolveWithCostModel(inits, sample_num);
   TVM_PY_LOG(INFO, self->ctx_->logger)
@@ -771,18 +1003,27 @@ void EvolutionarySearchNode::State::NotifyRunnerResults(
 }
 
 size_t EvolutionarySearchNode::State::ModuleHash(const IRModule& mod) const {
-  return database_->GetModuleEquality().Hash(mod);
+  auto it = shash_memo_.find(mod);
+  if (it == shash_memo_.end()) {
+    it = shash_memo_.emplace(mod, database_->GetModuleEquality().Hash(mod)).first;
+  }
+  return it->second;
 }
 
-SearchStrategy SearchStrategy::EvolutionarySearch(int population_size,         //
-                                                  double init_measured_ratio,  //
-                                                  int init_min_unmeasured,     //
-                                                  int max_fail_count,          //
-                                                  int genetic_num_iters,       //
-                                                  double genetic_mutate_prob,  //
-                                                  int genetic_max_fail_count,  //
-                                                  double eps_greedy) {
+SearchStrategy SearchStrategy::EvolutionarySearch(int population_size,             //
+                                                  double init_measured_ratio,      //
+                                                  int init_min_unmeasured,         //
+                                                  int max_fail_count,              //
+                                                  int genetic_num_iters,           //
+                                                  double genetic_mutate_prob,      //
+                                                  int genetic_max_fail_count,      //
+                                                  double eps_greedy,               //
+                                                  int warm_start_top_k,            //
+                                                  double design_space_keep_ratio,  //
+                                                  int design_space_prune_samples) {
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(init_measured_ratio, "Initial measured ratio");
+  TVM_FFI_CHECK(design_space_keep_ratio > 0.0 && design_space_keep_ratio <= 1.0, ValueError)
+      << "`design_space_keep_ratio` must be in (0, 1], but got " << design_space_keep_ratio;
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(genetic_mutate_prob, "Mutation probability");
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(eps_greedy, "Greedy pick probability");
   ffi::ObjectPtr<EvolutionarySearchNode> n = ffi::make_object<EvolutionarySearchNode>();
@@ -795,6 +1036,9 @@ SearchStrategy SearchStrategy::EvolutionarySearch(int population_size,         /
   n->genetic_max_fail_count = genetic_max_fail_count;
   n->genetic_mutate_prob = genetic_mutate_prob;
   n->eps_greedy = eps_greedy;
+  n->warm_start_top_k = warm_start_top_k;
+  n->design_space_keep_ratio = design_space_keep_ratio;
+  n->design_space_prune_samples = design_space_prune_samples;
   return SearchStrategy(n);
 }
 
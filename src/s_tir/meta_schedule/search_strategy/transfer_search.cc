@@ -0,0 +1,366 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/tirx/stmt_functor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../module_equality.h"
+#include "../trace_apply.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace s_tir {
+namespace meta_schedule {
+
+/*!
+ * \brief The shape-agnostic structure of a workload, and the static extents of its parameter
+ *  buffers. The workloads that only differ in the extents, like the sequence length buckets of a
+ *  dynamic-shape model, have the same structure.
+ */
+struct ShapeSignature {
+  /*! \brief The functions, the dtypes and ranks of their buffers, and the blocks in pre-order */
+  std::string structure;
+  /*! \brief The static extents of the parameter buffers */
+  std::vector<int64_t> extents;
+
+  static ShapeSignature Of(const IRModule& mod) {
+    ShapeSignature sig;
+    std::ostringstream os;
+    std::map<std::string, tirx::PrimFunc> funcs;
+    for (const auto& [gv, base_func] : mod->functions) {
+      if (const auto* func = base_func.as<tirx::PrimFuncNode>()) {
+        funcs.emplace(gv->name_hint, ffi::GetRef<tirx::PrimFunc>(func));
+      }
+    }
+    for (const auto& [name, func] : funcs) {
+      os << name << "(";
+      for (const tirx::Var& param : func->params) {
+        if (ffi::Optional<tirx::Buffer> buffer = func->buffer_map.Get(param)) {
+          os << buffer.value()->dtype << "[";
+          for (const PrimExpr& dim : buffer.value()->shape) {
+            if (const auto* imm = dim.as<IntImmNode>()) {
+              sig.extents.push_back(imm->value);
+              os << "_,";
+            } else {
+              os << dim << ",";
+            }
+          }
+          os << "]";
+        } else {
+          os << param->dtype;
+        }
+        os << ";";
+      }
+      os << ")";
+      tirx::PreOrderVisit(func->body, [&os](const ffi::ObjectRef& obj) -> bool {
+        if (const auto* block = obj.as<tirx::SBlockNode>()) {
+          os << block->name_hint << "{";
+          for (const tirx::IterVar& iter_var : block->iter_vars) {
+            os << static_cast<int>(iter_var->iter_type);
+          }
+          os << "|" << block->reads.size() << "|" << block->writes.size() << "}";
+        }
+        return true;
+      });
+    }
+    sig.structure = os.str();
+    return sig;
+  }
+
+  /*! \brief The distance to a shape variant, the L1 distance of the extents in log scale. */
+  double Distance(const ShapeSignature& other) const {
+    TVM_FFI_ICHECK_EQ(extents.size(), other.extents.size());
+    double result = 0.0;
+    for (size_t i = 0; i < extents.size(); ++i) {
+      result += std::abs(std::log(std::max<int64_t>(extents[i], 1)) -
+                         std::log(std::max<int64_t>(other.extents[i], 1)));
+    }
+    return result;
+  }
+};
+
+/*!
+ * \brief A search strategy that transfers the best schedules of the nearest tuned shape variant
+ *  in the database onto the workload, and then fine-tunes around them with a small budget.
+ */
+class TransferSearchNode : public SearchStrategyNode {
+ public:
+  /*! \brief The strategy to fine-tune with, or to tune with when no shape variant is found. */
+  SearchStrategy fine_tune;
+  /*! \brief The number of the best records of the shape variant to transfer. */
+  int num_transfer_records;
+  /*! \brief The number of attempts with re-sampled decisions when the decisions do not fit. */
+  int num_repair_trials;
+  /*! \brief The number of trials for fine-tuning after the transferred candidates. */
+  int max_fine_tune_trials;
+
+  /*! \brief The tuning context. */
+  const TuneContextNode* ctx_{nullptr};
+  /*! \brief The postprocessors. */
+  ffi::Array<Postproc> postprocs_ = {};
+  /*! \brief The random state. -1 means using random number. */
+  TRandState rand_state_ = -1;
+
+  /*! \brief The state of a tuning run. */
+  struct State {
+    /*! \brief The transferred candidates that are not measured yet. */
+    std::vector<MeasureCandidate> transferred;
+    /*! \brief The index of the next transferred candidate to measure. */
+    size_t next = 0;
+    /*! \brief The number of trials per iteration. */
+    int num_trials_per_iter;
+    /*! \brief The number of trials of the fine-tuning strategy, 0 to skip it. */
+    int fine_tune_trials;
+    /*! \brief Whether the fine-tuning strategy is running. */
+    bool fine_tuning = false;
+    /*! \brief The arguments of `PreTuning`, forwarded to the fine-tuning strategy. */
+    ffi::Array<s_tir::Schedule> design_spaces;
+    ffi::Optional<Database> database;
+    ffi::Optional<CostModel> cost_model;
+  };
+  std::unique_ptr<State> state_ = nullptr;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<TransferSearchNode>()
+        .def_ro("fine_tune", &TransferSearchNode::fine_tune)
+        .def_ro("num_transfer_records", &TransferSearchNode::num_transfer_records)
+        .def_ro("num_repair_trials", &TransferSearchNode::num_repair_trials)
+        .def_ro("max_fine_tune_trials", &TransferSearchNode::max_fine_tune_trials);
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.meta_schedule.TransferSearch", TransferSearchNode,
+                                    SearchStrategyNode);
+
+  void InitializeWithTuneContext(const TuneContext& ctx) final {
+    TVM_FFI_CHECK(ctx->mod.has_value(), ValueError) << "TuneContext.mod is not defined";
+    TVM_FFI_CHECK(ctx->target.has_value(), ValueError) << "TuneContext.target is not defined";
+    TVM_FFI_CHECK(ctx->space_generator.has_value(), ValueError)
+        << "TuneContext.space_generator is not defined";
+    this->ctx_ = ctx.get();
+    this->postprocs_ = ctx->space_generator.value()->postprocs.value_or({});
+    this->rand_state_ = ForkSeed(&ctx->rand_state);
+    this->state_.reset();
+    this->fine_tune->InitializeWithTuneContext(ctx);
+  }
+
+  void PreTuning(int max_trials, int num_trials_per_iter,
+                 const ffi::Array<s_tir::Schedule>& design_spaces,
+                 const ffi::Optional<Database>& database,
+                 const ffi::Optional<CostModel>& cost_model) final {
+    TVM_FFI_CHECK(this->ctx_ != nullptr, ValueError)
+        << "`InitializeWithTuneContext` is not invoked before `PreTuning`";
+    TVM_FFI_CHECK(this->state_ == nullptr, ValueError)
+        << "`PreTuning` is already invoked without corresponding `PostTuning`.";
+    this->state_ = std::make_unique<State>();
+    State& state = *this->state_;
+    state.num_trials_per_iter = num_trials_per_iter;
+    state.design_spaces = design_spaces;
+    state.database = database;
+    state.cost_model = cost_model;
+    if (database.has_value()) {
+      state.transferred = Transfer(database.value());
+    }
+    if (static_cast<int>(state.transferred.size()) > max_trials) {
+      state.transferred.resize(max_trials);
+    }
+    int num_transferred = state.transferred.size();
+    state.fine_tune_trials = num_transferred == 0
+                                 ? max_trials
+                                 : std::min(max_trials - num_transferred, max_fine_tune_trials);
+  }
+
+  void PostTuning() final {
+    TVM_FFI_ICHECK(this->state_ != nullptr);
+    if (this->state_->fine_tuning) {
+      this->fine_tune->PostTuning();
+    }
+    this->state_.reset();
+  }
+
+  ffi::Optional<ffi::Array<MeasureCandidate>> GenerateMeasureCandidates() final {
+    TVM_FFI_ICHECK(this->state_ != nullptr);
+    State& state = *this->state_;
+    if (state.next < state.transferred.size()) {
+      size_t end = std::min(state.transferred.size(),
+                            state.next + static_cast<size_t>(state.num_trials_per_iter));
+      ffi::Array<MeasureCandidate> results(state.transferred.begin() + state.next,
+                                           state.transferred.begin() + end);
+      state.next = end;
+      return results;
+    }
+    if (state.fine_tune_trials <= 0) {
+      return std::nullopt;
+    }
+    if (!state.fine_tuning) {
+      // Start fine-tuning once the transferred candidates are measured, so that they are in the
+      // database as the measured candidates to start from.
+      state.fine_tuning = true;
+      this->fine_tune->PreTuning(state.fine_tune_trials, state.num_trials_per_iter,
+                                 state.design_spaces, state.database, state.cost_model);
+    }
+    return this->fine_tune->GenerateMeasureCandidates();
+  }
+
+  void NotifyRunnerResults(const ffi::Array<MeasureCandidate>& measure_candidates,
+                           const ffi::Array<RunnerResult>& results) final {
+    TVM_FFI_ICHECK(this->state_ != nullptr);
+    if (this->state_->fine_tuning) {
+      this->fine_tune->NotifyRunnerResults(measure_candidates, results);
+    }
+  }
+
+  SearchStrategy Clone() const final {
+    ffi::ObjectPtr<TransferSearchNode> n = ffi::make_object<TransferSearchNode>();
+    n->fine_tune = this->fine_tune->Clone();
+    n->num_transfer_records = this->num_transfer_records;
+    n->num_repair_trials = this->num_repair_trials;
+    n->max_fine_tune_trials = this->max_fine_tune_trials;
+    n->ctx_ = this->ctx_;
+    n->postprocs_ = this->postprocs_;
+    n->rand_state_ = this->rand_state_;
+    n->state_ = nullptr;  // cleared the state
+    return SearchStrategy(n);
+  }
+
+ private:
+  /*! \brief Find the workload in the database that is the nearest shape variant of the module. */
+  ffi::Optional<Workload> FindNearestVariant(const Database& database) const {
+    const IRModule& mod = ctx_->mod.value();
+    ShapeSignature sig = ShapeSignature::Of(mod);
+    std::unordered_set<const WorkloadNode*> visited;
+    ffi::Optional<Workload> result = std::nullopt;
+    double best = std::numeric_limits<double>::infinity();
+    for (const TuningRecord& record : database->GetAllTuningRecords()) {
+      const Workload& workload = record->workload;
+      if (!visited.insert(workload.get()).second ||
+          database->GetModuleEquality().Equal(workload->mod, mod)) {
+        continue;
+      }
+      ShapeSignature other = ShapeSignature::Of(workload->mod);
+      if (other.structure != sig.structure) {
+        continue;
+      }
+      double distance = sig.Distance(other);
+      if (distance < best) {
+        best = distance;
+        result = workload;
+      }
+    }
+    return result;
+  }
+
+  /*!
+   * \brief Apply the best records of the nearest shape variant to the module. A trace is first
+   *  applied with its own decisions, and then with re-sampled decisions when they do not fit the
+   *  new extents or fail the postprocessors.
+   */
+  std::vector<MeasureCandidate> Transfer(const Database& database) {
+    ffi::Optional<Workload> variant = FindNearestVariant(database);
+    if (!variant.has_value()) {
+      TVM_PY_LOG(INFO, ctx_->logger) << "No tuned shape variant is found in the database";
+      return {};
+    }
+    ffi::Array<TuningRecord> records = database->GetTopK(variant.value(), num_transfer_records);
+    int num_records = records.size();
+    int num_threads = std::max(1, ctx_->num_threads);
+    std::vector<IRModule> per_thread_mod;
+    for (int i = 0; i < num_threads; ++i) {
+      per_thread_mod.push_back(DeepCopyIRModule(ctx_->mod.value()));
+    }
+    std::vector<TRandState> per_task_rand_state = ForkSeed(&rand_state_, num_records);
+    std::vector<ffi::Optional<s_tir::Schedule>> per_task_result(num_records, std::nullopt);
+    ThreadedTraceApply pp(postprocs_);
+    auto f_transfer = [&](int thread_id, int task_id) -> void {
+      const IRModule& mod = per_thread_mod[thread_id];
+      TRandState* rand_state = &per_task_rand_state[task_id];
+      s_tir::Trace anchor_trace = records[task_id]->trace->Simplified(/*remove_postproc=*/true);
+      for (int attempt = 0; attempt <= num_repair_trials; ++attempt) {
+        if (attempt > 0) {
+          anchor_trace = s_tir::Trace(anchor_trace->insts, {});
+        }
+        s_tir::Schedule sch = s_tir::Schedule::Traced(
+            mod, /*seed=*/ForkSeed(rand_state), /*debug_mask=*/0,
+            /*error_render_level=*/s_tir::ScheduleErrorRenderLevel::kNone);
+        try {
+          ScheduleUsingAnchorTrace(sch, anchor_trace, ctx_->target.value());
+        } catch (const std::exception&) {
+          continue;
+        }
+        if (ffi::Optional<s_tir::Schedule> result =
+                pp.Apply(mod, sch->trace().value(), rand_state)) {
+          per_task_result[task_id] = result;
+          return;
+        }
+      }
+    };
+    support::parallel_for_dynamic(0, num_records, num_threads, f_transfer);
+    std::vector<MeasureCandidate> results;
+    std::unordered_multimap<size_t, IRModule> seen;
+    for (const ffi::Optional<s_tir::Schedule>& result : per_task_result) {
+      if (!result.has_value()) {
+        continue;
+      }
+      IRModule mod = result.value()->mod();
+      size_t shash = ffi::StructuralHash()(mod);
+      auto [begin, end] = seen.equal_range(shash);
+      if (std::any_of(begin, end, [&mod](const auto& kv) {
+            return ffi::StructuralEqual()(kv.second, mod);
+          })) {
+        continue;
+      }
+      seen.emplace(shash, mod);
+      results.push_back(MeasureCandidate(
+          result.value(), ArgInfo::FromEntryFunc(mod, /*remove_preproc=*/true)));
+    }
+    TVM_PY_LOG(INFO, ctx_->logger) << "Transferred " << results.size() << " candidate(s) from "
+                                   << num_records << " record(s) of a shape variant";
+    return results;
+  }
+};
+
+SearchStrategy SearchStrategy::TransferSearch(SearchStrategy fine_tune, int num_transfer_records,
+                                              int num_repair_trials, int max_fine_tune_trials) {
+  TVM_FFI_CHECK_GE(num_transfer_records, 0, ValueError)
+      << "num_transfer_records must be non-negative";
+  TVM_FFI_CHECK_GE(num_repair_trials, 0, ValueError) << "num_repair_trials must be non-negative";
+  ffi::ObjectPtr<TransferSearchNode> n = ffi::make_object<TransferSearchNode>();
+  n->fine_tune = std::move(fine_tune);
+  n->num_transfer_records = num_transfer_records;
+  n->num_repair_trials = num_repair_trials;
+  n->max_fine_tune_trials = max_fine_tune_trials;
+  return SearchStrategy(n);
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() { TransferSearchNode::RegisterReflection(); }
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("s_tir.meta_schedule.SearchStrategyTransferSearch",
+                        SearchStrategy::TransferSearch);
+}
+
+}  // namespace meta_schedule
+}  // namespace s_tir
+}  // namespace tvm
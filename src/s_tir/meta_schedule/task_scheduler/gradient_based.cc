@@ -64,8 +64,14 @@ class GradientBasedNode final : public TaskSchedulerNode {
       this->PrintTuningStatistics();
     }
     if (round_robin_rounds_ < n_tasks) {
+      this->WaitForPipelineSlot();
       return round_robin_rounds_++;
     }
+    // The pipelined mode does not wait for the first round, tasks without results yet are
+    // skipped in the gradient computation.
+    if (round_robin_rounds_ == n_tasks && this->pipeline_depth > 0) {
+      ++round_robin_rounds_;
+    }
     if (round_robin_rounds_ == n_tasks) {
       for (int i = 0; i < n_tasks; ++i) {
         if (this->tasks_[i]->runner_futures.has_value()) {
@@ -80,6 +86,9 @@ class GradientBasedNode final : public TaskSchedulerNode {
       tasks_alive.reserve(n_tasks);
       for (int i = 0; i < n_tasks; ++i) {
         this->TouchTask(i);
+      }
+      this->WaitForPipelineSlot();
+      for (int i = 0; i < n_tasks; ++i) {
         if (!this->tasks_[i]->is_terminated) {
           tasks_alive.push_back(i);
         }
@@ -87,6 +96,18 @@ class GradientBasedNode final : public TaskSchedulerNode {
       if (tasks_alive.empty()) {
         return -1;
       }
+      // In the pipelined mode, pick among the tasks without a batch in flight if there are any.
+      if (this->pipeline_depth > 0) {
+        std::vector<int> tasks_idle;
+        for (int task_id : tasks_alive) {
+          if (!this->tasks_[task_id]->runner_futures.has_value()) {
+            tasks_idle.push_back(task_id);
+          }
+        }
+        if (!tasks_idle.empty()) {
+          tasks_alive = std::move(tasks_idle);
+        }
+      }
     }
     // Step 3. Calculate the gradient of each task alive
     std::vector<double> grad;
@@ -135,9 +156,12 @@ class GradientBasedNode final : public TaskSchedulerNode {
 };
 
 TaskScheduler TaskScheduler::GradientBased(ffi::Function logger, double alpha, int window_size,
-                                           LinearCongruentialEngine::TRandState seed) {
+                                           LinearCongruentialEngine::TRandState seed,
+                                           int pipeline_depth) {
+  TVM_FFI_CHECK_GE(pipeline_depth, 0, ValueError) << "pipeline_depth must be non-negative";
   ffi::ObjectPtr<GradientBasedNode> n = ffi::make_object<GradientBasedNode>();
   n->logger = logger;
+  n->pipeline_depth = pipeline_depth;
   n->alpha = alpha;
   n->window_size = window_size;
   n->rand_state = LinearCongruentialEngine::NormalizeSeed(seed);
@@ -43,6 +43,17 @@ class RoundRobinNode final : public TaskSchedulerNode {
     for (int i = 0; i < n_tasks; ++i) {
       this->TouchTask(i);
     }
+    if (this->pipeline_depth > 0) {
+      this->WaitForPipelineSlot();
+      // Prefer the next task without a batch in flight, which is built while the others run.
+      for (int i = 1; i <= n_tasks; ++i) {
+        int next_id = (task_id + i) % n_tasks;
+        TaskRecordNode* task = this->tasks_[next_id].get();
+        if (!task->is_terminated && !task->runner_futures.has_value()) {
+          return task_id = next_id;
+        }
+      }
+    }
     for (int i = 0; i < n_tasks; ++i) {
       task_id = (task_id + 1) % n_tasks;
       TaskRecordNode* task = this->tasks_[task_id].get();
@@ -57,9 +68,11 @@ class RoundRobinNode final : public TaskSchedulerNode {
   }
 };
 
-TaskScheduler TaskScheduler::RoundRobin(ffi::Function logger) {
+TaskScheduler TaskScheduler::RoundRobin(ffi::Function logger, int pipeline_depth) {
+  TVM_FFI_CHECK_GE(pipeline_depth, 0, ValueError) << "pipeline_depth must be non-negative";
   ffi::ObjectPtr<RoundRobinNode> n = ffi::make_object<RoundRobinNode>();
   n->logger = logger;
+  n->pipeline_depth = pipeline_depth;
   n->task_id = -1;
   return TaskScheduler(n);
 }
@@ -50,6 +50,14 @@ TaskRecord::TaskRecord(TuneContext ctx, double task_weight) {
   this->data_ = std::move(n);
 }
 
+/*! \brief The name to attribute the profiled scopes of a task to. */
+ffi::String ProfilerTaskName(const TuneContext& ctx, int task_id) {
+  if (ctx->task_name.has_value()) {
+    return ctx->task_name.value();
+  }
+  return "Task #" + std::to_string(task_id);
+}
+
 void SendToBuilder(TaskRecordNode* self, const Builder& builder) {
   auto _ = Profiler::TimedScope("SendToBuilder");
   ffi::Array<MeasureCandidate> candidates = self->measure_candidates.value();
@@ -166,6 +174,7 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
   this->measure_callbacks_ = measure_callbacks;
   this->database_ = database;
   this->cost_model_ = cost_model;
+  this->running_task_ids_.clear();
   this->tasks_.clear();
   this->tasks_.reserve(n_tasks);
   for (int i = 0; i < n_tasks; ++i) {
@@ -173,9 +182,13 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
     double weight = task_weights[i]->value;
     TVM_PY_LOG(INFO, this->logger) << "Initializing Task #" << i << ": " << ctx->task_name;
     TVM_PY_LOG(INFO, ctx->logger) << "Initializing Task #" << i << ": " << ctx->task_name;
+    auto task_scope = Profiler::TaskScope(ProfilerTaskName(ctx, i));
     this->tasks_.push_back(TaskRecord(ctx, weight));
-    ffi::Array<s_tir::Schedule> design_spaces =
-        ctx->space_generator.value()->GenerateDesignSpace(ctx->mod.value());
+    ffi::Array<s_tir::Schedule> design_spaces{nullptr};
+    {
+      auto _ = Profiler::TimedScope("GenerateDesignSpace");
+      design_spaces = ctx->space_generator.value()->GenerateDesignSpace(ctx->mod.value());
+    }
     TVM_PY_LOG(INFO, ctx->logger) << "Total " << design_spaces.size()
                                   << " design space(s) generated";
     for (int i = 0, n = design_spaces.size(); i < n; ++i) {
@@ -186,6 +199,7 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
                                     << sch->mod() << "\n"
                                     << Concat(trace->AsPython(false), "\n");
     }
+    auto _ = Profiler::TimedScope("PreTuning");
     ctx->search_strategy.value()->PreTuning(max_trials_per_task, num_trials_per_iter, design_spaces,
                                             database, cost_model);
   }
@@ -201,8 +215,12 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
       TerminateTask(task_id);
       continue;
     }
-    if (ffi::Optional<ffi::Array<MeasureCandidate>> candidates = task->measure_candidates =
-            task->ctx->search_strategy.value()->GenerateMeasureCandidates()) {
+    auto task_scope = Profiler::TaskScope(ProfilerTaskName(task->ctx, task_id));
+    {
+      auto _ = Profiler::TimedScope("GenerateMeasureCandidates");
+      task->measure_candidates = task->ctx->search_strategy.value()->GenerateMeasureCandidates();
+    }
+    if (ffi::Optional<ffi::Array<MeasureCandidate>> candidates = task->measure_candidates) {
       int num_candidates = candidates.value().size();
       num_trials_already += num_candidates;
       TVM_PY_LOG(INFO, this->logger) << "Sending " << num_candidates << " sample(s) to builder";
@@ -218,6 +236,7 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
       TVM_PY_LOG(INFO, this->logger)
           << "Sending " << num_candidates - n_build_errs << " valid sample(s) to runner";
       SendToRunner(task, runner);
+      this->running_task_ids_.push_back(task_id);
     } else {
       TerminateTask(task_id);
     }
@@ -237,6 +256,10 @@ void TaskSchedulerNode::Tune(ffi::Array<TuneContext> ctxs, ffi::Array<FloatImm>
 ffi::Array<RunnerResult> TaskSchedulerNode::JoinRunningTask(int task_id) {
   TaskRecordNode* task = this->tasks_[task_id].get();
   TVM_FFI_ICHECK(task->runner_futures.has_value());
+  auto task_scope = Profiler::TaskScope(ProfilerTaskName(task->ctx, task_id));
+  running_task_ids_.erase(
+      std::remove(running_task_ids_.begin(), running_task_ids_.end(), task_id),
+      running_task_ids_.end());
   ffi::Array<RunnerResult> results;
   {
     auto _ = Profiler::TimedScope("JoinRunnerFutures");
@@ -247,8 +270,11 @@ ffi::Array<RunnerResult> TaskSchedulerNode::JoinRunningTask(int task_id) {
     }
   }
   TVM_FFI_ICHECK(task->measure_candidates.has_value());
-  task->ctx->search_strategy.value()->NotifyRunnerResults(task->measure_candidates.value(),
-                                                          results);
+  {
+    auto _ = Profiler::TimedScope("NotifyRunnerResults");
+    task->ctx->search_strategy.value()->NotifyRunnerResults(task->measure_candidates.value(),
+                                                            results);
+  }
   TVM_FFI_ICHECK(task->builder_results.has_value());
   TVM_FFI_ICHECK_EQ(results.size(), task->measure_candidates.value().size());
   TVM_FFI_ICHECK_EQ(results.size(), task->builder_results.value().size());
@@ -275,6 +301,12 @@ void TaskSchedulerNode::TouchTask(int task_id) {
   }
 }
 
+void TaskSchedulerNode::WaitForPipelineSlot() {
+  while (pipeline_depth > 0 && static_cast<int>(running_task_ids_.size()) >= pipeline_depth) {
+    this->JoinRunningTask(running_task_ids_.front());
+  }
+}
+
 void TaskSchedulerNode::TerminateTask(int task_id) {
   TaskRecordNode* task = this->tasks_[task_id].get();
   TVM_FFI_ICHECK(!task->is_terminated);
@@ -349,6 +349,7 @@ struct ThreadedTraceApply {
       return std::nullopt;
     }
 
+    auto _ = Profiler::TimedScope("PostprocValidation");
     for (int i = 0; i < n_; ++i) {
       Item& item = items_[i];
       bool success = true;
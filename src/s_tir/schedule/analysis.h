@@ -53,6 +53,13 @@ void VerifySRefTree(const ScheduleState& self);
  * \throw An exception will be thrown if some srefs are not valid
  */
 void VerifyCachedFlags(const ScheduleState& self);
+/*!
+ * \brief Verifies the dependencies of each block scope in the schedule state against the ones
+ * computed from scratch, which checks the incremental update of the block scopes.
+ * \param self The schedule state to be verified
+ * \throw An exception will be thrown if the dependencies of some scope are not valid
+ */
+void VerifySBlockScope(const ScheduleState& self);
 
 /******** IR Module ********/
 /*!
@@ -680,6 +687,17 @@ bool NeedsMultiLevelTiling(const ScheduleState& self, const StmtSRef& block_sref
  */
 bool IsSpatialPrimFunc(const PrimFunc& func);
 
+/*!
+ * \brief Get the product of the extents of the spatial loops and that of the reduction loops
+ * outside the given block.
+ * \param self The schedule state.
+ * \param block_sref The block to be checked.
+ * \return The cumulative spatial and reduction lengths, or (-1, -1) if a loop is dynamic or is
+ * neither spatial nor reduction.
+ */
+std::pair<int64_t, int64_t> GetCumulativeSpaceAndReductionLength(const s_tir::ScheduleState& self,
+                                                                 const tirx::StmtSRef& block_sref);
+
 /*!
  * \brief Checks if the rfactor or cross thread reduction is beneficial to the given block.
  * \param self The schedule state.
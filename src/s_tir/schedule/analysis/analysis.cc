@@ -628,10 +628,9 @@ void CheckPartialAffineBinding(const ScheduleState& self, SBlock block,
   }
   if (block_sref->parent && high_exclusive.has_value()) {
     // if it is not of global affine binding, check affineness under high_exclusive,
-    arith::Analyzer analyzer;
     ffi::Map<Var, Range> dom_map =
         LoopDomainOfSRefTreePath(ffi::GetRef<StmtSRef>(block_sref->parent), high_exclusive);
-    if (IsAffineBinding(GetSBlockRealize(self, block_sref), dom_map, analyzer.get())) {
+    if (self->IsAffineBindingMemoized(GetSBlockRealize(self, block_sref), dom_map)) {
       return;
     }
   }
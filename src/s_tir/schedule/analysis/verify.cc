@@ -18,6 +18,9 @@
  */
 #include <tvm/ffi/cast.h>
 
+#include <set>
+#include <tuple>
+
 #include "../utils.h"
 
 namespace tvm {
@@ -246,5 +249,56 @@ void VerifyCachedFlags(const ScheduleState& self) {
   throw;
 }
 
+void VerifySBlockScope(const ScheduleState& self) {
+  using DepKey = std::tuple<const StmtNode*, const StmtNode*, int>;
+  auto f_collect_deps = [](const SBlockInfo& info) {
+    std::set<DepKey> deps;
+    for (const auto& kv : info.scope->src2deps) {
+      for (const Dependency& dep : kv.second) {
+        deps.emplace(dep->src->stmt, dep->dst->stmt, static_cast<int>(dep->kind));
+      }
+    }
+    return deps;
+  };
+  std::vector<const SBlockNode*> block_info_not_found;
+  std::vector<const SBlockNode*> block_info_wrong_deps;
+
+  ScheduleState new_state(self->mod);
+  for (const auto& kv : new_state->stmt2ref) {
+    const StmtNode* stmt = kv.first;
+    if (stmt->IsInstance<ForNode>() || !self->stmt2ref.count(stmt)) {
+      continue;
+    }
+    const auto* block = static_cast<const SBlockNode*>(stmt);
+    auto it = self->block_info.find(self->stmt2ref.at(stmt));
+    if (it == self->block_info.end()) {
+      block_info_not_found.push_back(block);
+    } else if (f_collect_deps(it->second) != f_collect_deps(new_state->block_info.at(kv.second))) {
+      block_info_wrong_deps.push_back(block);
+    }
+  }
+  if (block_info_not_found.empty() && block_info_wrong_deps.empty()) {
+    return;
+  }
+  std::ostringstream os;
+  if (!block_info_not_found.empty()) {
+    os << "- SBlockInfo not found:";
+    for (const SBlockNode* block : block_info_not_found) {
+      os << " " << block->name_hint;
+    }
+    os << std::endl;
+  }
+  if (!block_info_wrong_deps.empty()) {
+    os << "- Wrong dependencies in the scope of:";
+    for (const SBlockNode* block : block_info_wrong_deps) {
+      os << " " << block->name_hint;
+    }
+    os << std::endl;
+  }
+  TVM_FFI_THROW(InternalError) << "Schedule verification failed. The IR is:\n"
+                               << self->mod << "\nThe errors are:\n"
+                               << os.str();
+}
+
 }  // namespace s_tir
 }  // namespace tvm
@@ -65,6 +65,7 @@ class ScheduleCopier {
     n->stmt2ref = copier.Copy(src_state->stmt2ref);
     n->debug_mask = src_state->debug_mask;
     n->enable_check = src_state->enable_check;
+    n->affine_binding_memo = src_state->affine_binding_memo;
     *new_state = ScheduleState(std::move(n));
     *new_symbol_table = copier.Copy(self->symbol_table_);
   }
@@ -183,6 +183,7 @@ class SBlockInfoCollector : private StmtVisitor {
     // Calculate `SBlockInfo::scope`
     ffi::Array<StmtSRef> child_block_srefs = std::move(block_frames_.back());
     SBlockInfo& info = self_->block_info[scope_root] = SBlockInfo(SBlockScope(child_block_srefs));
+    info.computed_from = ffi::GetRef<SBlock>(TVM_SREF_TO_SBLOCK(scope_root));
     // Set `affine_binding`
     if (is_root_block) {
       // If the block doesn't have outer loops and BlockRealize,
@@ -190,10 +191,9 @@ class SBlockInfoCollector : private StmtVisitor {
       const SBlockNode* block = TVM_SREF_TO_SBLOCK(scope_root);
       if (block->iter_vars.empty()) info.affine_binding = true;
     } else {
-      info.affine_binding =
-          IsAffineBinding(/*realize=*/block2realize_.at(scope_root->stmt),
-                          /*loop_var_ranges=*/LoopDomainOfSRefTreePath(srefs_.back()),
-                          /*analyzer=*/analyzer_.get());
+      info.affine_binding = self_->IsAffineBindingMemoized(
+          /*realize=*/block2realize_.at(scope_root->stmt),
+          /*loop_var_ranges=*/LoopDomainOfSRefTreePath(srefs_.back()));
     }
     // Set `region_cover` to true, will be updated on its scope block
     info.region_cover = true;
@@ -298,7 +298,7 @@ class SBlockInfoCollector : private StmtVisitor {
                   /*predicate=*/producer_realize->predicate,
                   /*dom_low_inclusive=*/parent_sref,
                   /*dom_high_exclusive=*/lca,
-                  /*analyzer=*/analyzer_.get()));
+                  /*analyzer=*/self_->analyzer.get()));
             }
           }
         }
@@ -317,9 +317,9 @@ class SBlockInfoCollector : private StmtVisitor {
                   /*predicate=*/consumer_realize->predicate,
                   /*dom_low_inclusive=*/parent_sref,
                   /*dom_high_exclusive=*/lca,
-                  /*analyzer=*/analyzer_.get());
+                  /*analyzer=*/self_->analyzer.get());
               if (!ProducerCoversConsumer(buffer->shape, produced_region, consumed_region,
-                                          analyzer_.get())) {
+                                          self_->analyzer.get())) {
                 region_cover = false;
                 self_->block_info.at(consumer_block_sref).region_cover = region_cover;
                 break;
@@ -334,16 +334,19 @@ class SBlockInfoCollector : private StmtVisitor {
   }
 
   void VisitStmt_(const ForNode* loop) final {
-    analyzer_->Bind(loop->loop_var, Range::FromMinExtent(loop->min, loop->extent));
+    self_->BindLoopVar(loop->loop_var, Range::FromMinExtent(loop->min, loop->extent));
     PushSRef(loop);
     VisitStmt(loop->body);
     PopSRef();
   }
 
   void VisitStmt_(const SBlockRealizeNode* realize) final {
-    block_frames_.emplace_back();
     const SBlockNode* block = realize->block.get();
     block2realize_.emplace(block, ffi::GetRef<SBlockRealize>(realize));
+    if (ReuseSBlockInfo(realize)) {
+      return;
+    }
+    block_frames_.emplace_back();
     // Recursive visit
     PushSRef(block);
     VisitStmt(block->body);  // `block->init` is not visited
@@ -361,6 +364,38 @@ class SBlockInfoCollector : private StmtVisitor {
     SetSeqIndexInChildren(self_->stmt2ref, seq_stmt);
   }
 
+  /*!
+   * \brief Reuse the info of a nested block whose subtree is unchanged since the info was
+   * computed. Only the flags that depend on the outer scope are updated, and the block is added
+   * to its parent scope without visiting the subtree.
+   * \param realize The block realize being visited
+   * \return Whether the info is reused
+   */
+  bool ReuseSBlockInfo(const SBlockRealizeNode* realize) {
+    if (srefs_.empty()) {
+      // The root of the collection is always recomputed
+      return false;
+    }
+    auto sref_it = self_->stmt2ref.find(realize->block.get());
+    if (sref_it == self_->stmt2ref.end()) {
+      return false;
+    }
+    const StmtSRef& sref = sref_it->second;
+    auto it = self_->block_info.find(sref);
+    if (it == self_->block_info.end() || !it->second.computed_from.has_value() ||
+        !it->second.computed_from.value().same_as(realize->block)) {
+      return false;
+    }
+    SBlockInfo& info = it->second;
+    info.affine_binding = self_->IsAffineBindingMemoized(
+        /*realize=*/ffi::GetRef<SBlockRealize>(realize),
+        /*loop_var_ranges=*/LoopDomainOfSRefTreePath(srefs_.back()));
+    // Set `region_cover` to true, will be updated on its scope block
+    info.region_cover = true;
+    block_frames_.back().push_back(sref);
+    return true;
+  }
+
   /*! \brief The ScheduleStateNode we are operating on */
   ScheduleStateNode* self_;
   /*! \brief The stack frame used to indicate the current scope */
@@ -369,8 +404,6 @@ class SBlockInfoCollector : private StmtVisitor {
   std::unordered_map<const StmtNode*, SBlockRealize> block2realize_;
   /*! \brief The stack frames of blocks in the DFS visit. */
   std::vector<ffi::Array<StmtSRef>> block_frames_;
-  /*! \brief The auxiliary analyzer */
-  arith::Analyzer analyzer_;
 };
 
 /**************** Constructor ****************/
@@ -455,6 +488,8 @@ struct ReuseInfo {
    * indicating the sref to the old block should be reused in the sref to the new block.
    */
   std::unordered_map<const SBlockNode*, const SBlockNode*> block_sref_reuse;
+  /*! \brief The loops in `tgt_stmt` that are not intact, whose ranges may have changed. */
+  std::vector<const ForNode*> new_loops;
 };
 
 /*!
@@ -477,6 +512,7 @@ class ReuseCollector : public StmtVisitor {
     ReuseInfo result;
     result.intact = {collector.intact_.begin(), collector.intact_.end()};
     result.loop_sref_possible_reuse = {collector.loop_vars_.begin(), collector.loop_vars_.end()};
+    result.new_loops = std::move(collector.new_loops_);
     // `result.block_reuse ` is not set here because ReuseCollector doesn't collect it,
     // and it is supposed to be properly set by the caller.
     return result;
@@ -491,6 +527,7 @@ class ReuseCollector : public StmtVisitor {
     } else {
       // Collect loop vars for detecting reuse of loop sref
       loop_vars_.push_back(op->loop_var.get());
+      new_loops_.push_back(op);
       StmtVisitor::VisitStmt_(op);
     }
   }
@@ -509,6 +546,8 @@ class ReuseCollector : public StmtVisitor {
   std::vector<const StmtNode*> intact_;
   /*! \brief The loop variable we collected in the tgt_stmt */
   std::vector<const VarNode*> loop_vars_;
+  /*! \brief The loops we collected in the tgt_stmt */
+  std::vector<const ForNode*> new_loops_;
 };
 
 /*!
@@ -862,6 +901,12 @@ void ScheduleStateNode::Replace(const tirx::StmtSRef& _src_sref, const Stmt& tgt
     // 2) loop/block reuse
     ReuseInfo reuse_info = ReuseCollector::Collect(this, tgt_stmt);
     reuse_info.block_sref_reuse = std::move(block_sref_reuse);
+    // Rebind the loop vars reused with new ranges, the analyzer is stale only for them.
+    for (const ForNode* loop : reuse_info.new_loops) {
+      if (this->bound_loop_ranges.count(loop->loop_var)) {
+        this->BindLoopVar(loop->loop_var, Range::FromMinExtent(loop->min, loop->extent));
+      }
+    }
     // Step 1.2. Collect loop/block reuse to their corresponding srefs
     // and remove those srefs in the `src_stmt` that are no longer used after replacement
     std::unordered_map<const ffi::Object*, StmtSRef> reused_srefs =
@@ -998,6 +1043,9 @@ void ScheduleStateNode::DebugVerify() const {
   if (flag & ScheduleDebugMask::kVerifyCachedFlags) {
     VerifyCachedFlags(ffi::GetRef<ScheduleState>(this));
   }
+  if (flag & ScheduleDebugMask::kVerifySBlockScope) {
+    VerifySBlockScope(ffi::GetRef<ScheduleState>(this));
+  }
 }
 
 /**************** SBlockInfo-related ****************/
@@ -1015,6 +1063,30 @@ void ScheduleStateNode::UpdateScopeSBlockInfo(const Stmt& stmt) {
   SBlockInfoCollector::Collect(this, stmt);
 }
 
+void ScheduleStateNode::BindLoopVar(const Var& loop_var, const Range& dom) {
+  auto it = this->bound_loop_ranges.find(loop_var);
+  if (it != this->bound_loop_ranges.end() && ffi::StructuralEqual()(it->second, dom)) {
+    return;
+  }
+  this->analyzer->Bind(loop_var, dom, /*allow_override=*/true);
+  this->bound_loop_ranges[loop_var] = dom;
+}
+
+bool ScheduleStateNode::IsAffineBindingMemoized(const SBlockRealize& realize,
+                                                const ffi::Map<Var, Range>& loop_var_ranges) {
+  ffi::Array<ffi::Any> key{realize->iter_values, realize->predicate, loop_var_ranges};
+  auto it = this->affine_binding_memo.find(key);
+  if (it != this->affine_binding_memo.end()) {
+    return it->second;
+  }
+  for (const auto& [loop_var, dom] : loop_var_ranges) {
+    this->BindLoopVar(loop_var, dom);
+  }
+  bool result = IsAffineBinding(realize, loop_var_ranges, this->analyzer.get());
+  this->affine_binding_memo.emplace(std::move(key), result);
+  return result;
+}
+
 TVM_DLL ffi::Array<IntImm> GetCachedFlags(const ScheduleState& self, const StmtSRef& block_sref) {
   const SBlockInfo& info = self->GetSBlockInfo(block_sref);
   return {IntImm::Bool(info.affine_binding),  //
@@ -30,8 +30,11 @@
 #include <tvm/target/target.h>
 #include <tvm/tirx/builtin.h>
 
+#include <algorithm>
 #include <map>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "../../support/utils.h"
 #include "../../tirx/transform/ir_utils.h"
@@ -70,6 +73,24 @@ SBlock MakeSBlock(const Stmt& body, const ffi::Map<Var, Buffer>& buffer_data_to_
   return block;
 }
 
+/*!
+ * \brief Rewrite buffer allocation to keep multiple versions of original buffer for pipelined
+ * accesses.
+ * \param buffer The buffer to be resized.
+ * \param num_versions The number of versions to keep.
+ * \return The resized buffer.
+ */
+Buffer RewriteAllocBuffer(const Buffer& buffer, int num_versions) {
+  ffi::ObjectPtr<BufferNode> new_buffer = ffi::make_object<BufferNode>(*(buffer.get()));
+  new_buffer->shape.insert(new_buffer->shape.begin(), PrimExpr(num_versions));
+  if (new_buffer->strides.size()) {
+    TVM_FFI_ICHECK(new_buffer->strides.size() + 1 == new_buffer->shape.size());
+    PrimExpr stride_0 = new_buffer->strides[0] * new_buffer->shape[1];
+    new_buffer->strides.insert(new_buffer->strides.begin(), stride_0);
+  }
+  return Buffer(new_buffer);
+}
+
 /*! Structure that represents the provided annotation per block or loop. */
 struct PipelineAnnotation {
   int stage;
@@ -529,24 +550,6 @@ class PipelineRewriter : public StmtExprMutator {
     return num_versions;
   }
 
-  /*!
-   * \brief Rewrite buffer allocation to keep multiple versions of original buffer for pipelined
-   * accesses.
-   * \param buffer The buffer to be resized.
-   * \param num_versions The number of versions to keep.
-   * \return The resized buffer.
-   */
-  Buffer RewriteAllocBuffer(const Buffer& buffer, int num_versions) {
-    ffi::ObjectPtr<BufferNode> new_buffer = ffi::make_object<BufferNode>(*(buffer.get()));
-    new_buffer->shape.insert(new_buffer->shape.begin(), PrimExpr(num_versions));
-    if (new_buffer->strides.size()) {
-      TVM_FFI_ICHECK(new_buffer->strides.size() + 1 == new_buffer->shape.size());
-      PrimExpr stride_0 = new_buffer->strides[0] * new_buffer->shape[1];
-      new_buffer->strides.insert(new_buffer->strides.begin(), stride_0);
-    }
-    return Buffer(new_buffer);
-  }
-
   // Per-stage states that need to be tracked across pipeline prologue, body, and epilogue.
   struct AsyncStateGlobal {
     // Buffers that this stage asynchronously writes.
@@ -1032,6 +1035,467 @@ void BuildDependencyGraph(const ffi::Array<SBlock>& blocks,
   }
 }
 
+/*!
+ * \brief Split the threads of a kernel into producer and consumer warps for the software pipeline
+ * annotated with `software_pipeline_warp_specialize`.
+ *
+ * The statements in stage 0 of the pipeline are the producers, which write shared buffers that the
+ * other statements, the consumers, read. The outermost thread dimension of the kernel is extended
+ * by the producer threads. The original threads run the kernel without the producers, and the
+ * producer threads run the pipeline loop with only the producers, of the work of the original
+ * threads in rounds. The shared buffers of the producers get one version per stage, and each
+ * version is handed over with a pair of mbarriers:
+ *
+ *   consumer:                             producer:
+ *   for k in range(K):                    for k in range(K):
+ *     wait(full[k % S], k / S % 2)          wait(empty[k % S], 1 - k / S % 2)
+ *     consumers of version k % S            producers of version k % S
+ *     arrive(empty[k % S])                  arrive(full[k % S])
+ *
+ * Each role is a named barrier scope, so that ThreadSync synchronizes the threads of a role
+ * without waiting for the other role.
+ */
+class WarpSpecializer : public StmtMutator {
+ public:
+  static Stmt Rewrite(const PrimFunc& func,
+                      const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info) {
+    WarpSpecializer specializer(fragment_info);
+    for (const auto& kv : func->buffer_map) {
+      specializer.buffer_data_to_buffer_.Set(kv.second->data, kv.second);
+    }
+    PostOrderVisit(func->body, [&specializer](const ffi::ObjectRef& obj) {
+      if (const auto* block = obj.as<SBlockNode>()) {
+        for (const Buffer& buffer : block->alloc_buffers) {
+          specializer.buffer_data_to_buffer_.Set(buffer->data, buffer);
+        }
+      }
+    });
+    return specializer(func->body);
+  }
+
+ private:
+  explicit WarpSpecializer(const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info)
+      : fragment_info_(fragment_info) {}
+
+  /*! \brief The threads of a role must be whole warps. */
+  static constexpr int64_t kWarpSize = 32;
+  /*! \brief setmaxnreg applies to whole warpgroups. */
+  static constexpr int64_t kWarpgroupSize = 128;
+  /*! \brief The registers of a thread block. */
+  static constexpr int64_t kRegisterFileSize = 65536;
+
+  /*! \brief The thread roles of a warp-specialized kernel. */
+  struct WarpRoles {
+    /*! \brief The versions of the producer buffers. */
+    int64_t num_stages;
+    /*! \brief The original extent of the role thread dimension. */
+    int64_t num_consumers;
+    /*! \brief The producer extent of the role thread dimension. */
+    int64_t num_producers;
+    /*! \brief The product of the extents of the other thread dimensions. */
+    int64_t others;
+    /*! \brief The registers per producer and consumer thread, 0 to keep them. */
+    int64_t producer_regs;
+    int64_t consumer_regs;
+    /*! \brief The variable of the role thread dimension. */
+    PrimVar role_var;
+    /*! \brief Whether the thread is the first one of the block. */
+    PrimExpr is_leader;
+
+    int64_t ConsumerThreads() const { return num_consumers * others; }
+    int64_t ProducerThreads() const { return num_producers * others; }
+  };
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    if (op->kind != ForKind::kThreadBinding) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    // The thread bindings of a kernel are a perfect loop nest after UnifyThreadBinding.
+    std::vector<const ForNode*> launch{op};
+    while (const auto* loop = launch.back()->body.as<ForNode>()) {
+      if (loop->kind != ForKind::kThreadBinding) break;
+      launch.push_back(loop);
+    }
+    const Stmt& kernel_body = launch.back()->body;
+    const ForNode* pipeline = FindPipeline(kernel_body);
+    if (pipeline == nullptr) {
+      return ffi::GetRef<Stmt>(op);
+    }
+
+    // The producers extend the outermost thread dimension, so that each role is a contiguous
+    // range of the linear thread index.
+    const ForNode* role = nullptr;
+    std::string role_tag;
+    int64_t num_threads = 1;
+    PrimExpr is_leader = IntImm::Bool(true);
+    for (const ForNode* loop : launch) {
+      std::string tag = loop->thread_binding.value()->thread_tag;
+      if (!support::StartsWith(tag, "threadIdx.")) continue;
+      const auto* extent = loop->extent.as<IntImmNode>();
+      TVM_FFI_CHECK(extent != nullptr && is_zero(loop->min), ValueError)
+          << "The warp-specialized pipeline requires constant thread extents, but " << tag
+          << " has extent " << loop->extent;
+      num_threads *= extent->value;
+      is_leader =
+          is_leader && static_cast<PrimExpr>(loop->loop_var) == IntImm(loop->loop_var.ty(), 0);
+      if (role == nullptr || tag > role_tag) {
+        role = loop;
+        role_tag = tag;
+      }
+    }
+    TVM_FFI_CHECK(role != nullptr, ValueError)
+        << "The warp-specialized pipeline should be in a kernel bound to threadIdx";
+
+    auto config = pipeline->annotations.at(s_tir::attr::software_pipeline_warp_specialize)
+                      .as_or_throw<ffi::Array<int64_t>>();
+    TVM_FFI_CHECK_EQ(config.size(), 4U, ValueError)
+        << "The warp specialization should be [num_stages, producer_extent, producer_regs, "
+           "consumer_regs], but got "
+        << config;
+    WarpRoles roles;
+    roles.num_stages = config[0];
+    roles.num_consumers = role->extent.as_or_throw<IntImm>()->value;
+    roles.num_producers = config[1];
+    roles.others = num_threads / roles.num_consumers;
+    TVM_FFI_CHECK(roles.num_stages >= 1 && roles.num_producers >= 1, ValueError)
+        << "The warp-specialized pipeline needs at least one stage and one producer, but got "
+        << config;
+    TVM_FFI_CHECK(roles.ConsumerThreads() % kWarpSize == 0 &&
+                      roles.ProducerThreads() % kWarpSize == 0,
+                  ValueError)
+        << "The producer and consumer roles should be whole warps, but they have "
+        << roles.ProducerThreads() << " and " << roles.ConsumerThreads() << " threads";
+    roles.role_var = role->loop_var;
+    roles.is_leader = is_leader;
+    roles.producer_regs = config[2];
+    roles.consumer_regs = config[3];
+
+    Stmt body = SpecializeKernel(kernel_body, pipeline, roles);
+    for (auto it = launch.rbegin(); it != launch.rend(); ++it) {
+      For loop = ffi::GetRef<For>(*it);
+      ForNode* n = loop.CopyOnWrite();
+      n->body = body;
+      if (*it == role) {
+        n->extent = IntImm(role->extent.ty(), roles.num_consumers + roles.num_producers);
+      }
+      body = loop;
+    }
+    return body;
+  }
+
+  /*! \brief Find the warp-specialized pipeline in the body of a kernel. */
+  static const ForNode* FindPipeline(const Stmt& kernel_body) {
+    const ForNode* pipeline = nullptr;
+    bool has_thread_binding = false;
+    PostOrderVisit(kernel_body, [&](const ffi::ObjectRef& obj) {
+      const auto* loop = obj.as<ForNode>();
+      if (loop == nullptr) return;
+      has_thread_binding |= loop->kind == ForKind::kThreadBinding;
+      if (loop->annotations.count(s_tir::attr::software_pipeline_warp_specialize)) {
+        TVM_FFI_CHECK(pipeline == nullptr, ValueError)
+            << "A kernel can have at most one warp-specialized pipeline";
+        pipeline = loop;
+      }
+    });
+    TVM_FFI_CHECK(pipeline == nullptr || !has_thread_binding, ValueError)
+        << "The warp-specialized pipeline requires the thread bindings to be unified at the "
+           "start of the kernel";
+    return pipeline;
+  }
+
+  Stmt SpecializeKernel(const Stmt& kernel_body, const ForNode* pipeline, const WarpRoles& roles) {
+    // Step 1: Classify the statements of the pipeline body by their stages.
+    TVM_FFI_CHECK(pipeline->annotations.count(s_tir::attr::software_pipeline_stage), ValueError)
+        << "Stage of the software pipeline is not defined.";
+    auto stages = pipeline->annotations.at(s_tir::attr::software_pipeline_stage)
+                      .as_or_throw<ffi::Array<int64_t>>();
+    Stmt pipeline_body = pipeline->body;
+    ffi::Array<Buffer> pipeline_allocs;
+    if (const auto* realize = pipeline_body.as<SBlockRealizeNode>()) {
+      pipeline_allocs = realize->block->alloc_buffers;
+      pipeline_body = realize->block->body;
+    }
+    const auto* seq = pipeline_body.as<SeqStmtNode>();
+    TVM_FFI_CHECK(seq, ValueError) << "The body of the software pipeline should be SeqStmt, got "
+                                   << pipeline_body->GetTypeKey();
+    TVM_FFI_CHECK_EQ(stages.size(), seq->size(), ValueError)
+        << "The warp-specialized pipeline has " << seq->size()
+        << " statements, but pipeline annotation is " << stages;
+
+    std::unordered_set<const VarNode*> local_allocs;
+    for (const Buffer& buffer : pipeline_allocs) {
+      local_allocs.insert(buffer->data.get());
+    }
+    ffi::Array<Stmt> producers, consumers;
+    std::vector<SBlock> producer_blocks;
+    std::unordered_set<const VarNode*> producer_buffers, consumer_writes;
+    for (size_t i = 0; i < seq->size(); ++i) {
+      SBlock block = MakeSBlock(seq->seq[i], buffer_data_to_buffer_);
+      if (stages[i] != 0) {
+        consumers.push_back(seq->seq[i]);
+        for (const BufferRegion& write : block->writes) {
+          consumer_writes.insert(write->buffer->data.get());
+        }
+        continue;
+      }
+      for (const BufferRegion& write : block->writes) {
+        const Buffer& buffer = write->buffer;
+        TVM_FFI_CHECK(local_allocs.count(buffer->data.get()) &&
+                          support::StartsWith(buffer.scope(), "shared"),
+                      ValueError)
+            << "The producers of the warp-specialized pipeline can only write shared buffers "
+               "allocated in the pipeline, but write "
+            << buffer->name;
+        producer_buffers.insert(buffer->data.get());
+      }
+      producers.push_back(seq->seq[i]);
+      producer_blocks.push_back(block);
+    }
+    TVM_FFI_CHECK(!producers.empty() && !consumers.empty(), ValueError)
+        << "The warp-specialized pipeline needs statements in stage 0 and in later stages, but "
+           "the stages are "
+        << stages;
+    for (const SBlock& block : producer_blocks) {
+      for (const BufferRegion& read : block->reads) {
+        TVM_FFI_CHECK(!consumer_writes.count(read->buffer->data.get()), ValueError)
+            << "The producers of the warp-specialized pipeline cannot read " << read->buffer->name
+            << ", which the consumers write";
+      }
+    }
+    for (const VarNode* data : consumer_writes) {
+      TVM_FFI_CHECK(!producer_buffers.count(data), ValueError)
+          << "The consumers of the warp-specialized pipeline cannot write the buffers of the "
+             "producers";
+    }
+
+    // Step 2: Keep one version of the producer buffers per stage.
+    ffi::Map<Buffer, Buffer> buffer_remap;
+    ffi::Array<Buffer> kernel_allocs, consumer_allocs;
+    for (const Buffer& buffer : pipeline_allocs) {
+      if (!producer_buffers.count(buffer->data.get())) {
+        consumer_allocs.push_back(buffer);
+      } else if (roles.num_stages > 1) {
+        Buffer new_buffer = RewriteAllocBuffer(buffer, roles.num_stages);
+        buffer_remap.Set(buffer, new_buffer);
+        kernel_allocs.push_back(new_buffer);
+      } else {
+        kernel_allocs.push_back(buffer);
+      }
+    }
+    For loop = ffi::GetRef<For>(pipeline);
+    PipelineBodyRewriter rewriter(buffer_data_to_buffer_, buffer_remap, loop,
+                                  /*access_all_versions=*/false, fragment_info_);
+
+    // Step 3: Hand the versions over with the mbarriers.
+    PrimType index_ty = loop->loop_var.ty();
+    PrimExpr iter = is_zero(loop->min) ? PrimExpr(loop->loop_var) : loop->loop_var - loop->min;
+    PrimExpr num_stages = IntImm(index_ty, roles.num_stages);
+    PrimExpr version = floormod(iter, num_stages);
+    PrimExpr phase =
+        cast(PrimType::Int(32), floormod(floordiv(iter, num_stages), IntImm(index_ty, 2)));
+    Buffer full = decl_buffer({IntImm::Int32(roles.num_stages)}, PrimType::UInt(64),
+                              "full_barrier", "shared");
+    Buffer empty = decl_buffer({IntImm::Int32(roles.num_stages)}, PrimType::UInt(64),
+                               "empty_barrier", "shared");
+    buffer_data_to_buffer_.Set(full->data, full);
+    buffer_data_to_buffer_.Set(empty->data, empty);
+    kernel_allocs.push_back(full);
+    kernel_allocs.push_back(empty);
+
+    ffi::Array<Stmt> consumer_seq{MakeIntrin("tirx.ptx.mbarrier_try_wait",
+                                             {BarrierPtr(full, version), phase})};
+    for (const Stmt& stmt : consumers) {
+      consumer_seq.push_back(rewriter(stmt));
+    }
+    consumer_seq.push_back(MakeIntrin("tirx.ptx.mbarrier_arrive", {BarrierPtr(empty, version)}));
+    Stmt consumer_body = SeqStmt::Flatten(consumer_seq);
+    if (!consumer_allocs.empty()) {
+      SBlock block = MakeSBlock(consumer_body, buffer_data_to_buffer_);
+      block.CopyOnWrite()->alloc_buffers = consumer_allocs;
+      consumer_body = SBlockRealize({}, IntImm::Bool(true), block);
+    }
+
+    // The producer threads cover the work of the consumer threads in rounds.
+    PrimType role_ty = roles.role_var.ty();
+    PrimExpr producer_index = roles.role_var - IntImm(role_ty, roles.num_consumers);
+    int64_t num_rounds = (roles.num_consumers + roles.num_producers - 1) / roles.num_producers;
+    ffi::Array<Stmt> producer_seq{MakeIntrin(
+        "tirx.ptx.mbarrier_try_wait", {BarrierPtr(empty, version), IntImm::Int32(1) - phase})};
+    for (const Stmt& stmt : producers) {
+      PrimVar round("producer_round", role_ty);
+      PrimExpr index = num_rounds == 1
+                           ? producer_index
+                           : round * IntImm(role_ty, roles.num_producers) + producer_index;
+      Stmt body = Substitute(rewriter(stmt), ffi::Map<Var, Expr>{{roles.role_var, index}});
+      if (roles.num_consumers % roles.num_producers != 0) {
+        body = IfThenElse(index < IntImm(role_ty, roles.num_consumers), body);
+      }
+      if (num_rounds > 1) {
+        body = For(round, IntImm(role_ty, 0), IntImm(role_ty, num_rounds), ForKind::kSerial, body);
+      }
+      producer_seq.push_back(body);
+    }
+    producer_seq.push_back(MakeIntrin("tirx.ptx.mbarrier_arrive", {BarrierPtr(full, version)}));
+
+    For consumer_loop = loop;
+    For producer_loop = loop;
+    for (For* new_loop : {&consumer_loop, &producer_loop}) {
+      ForNode* n = new_loop->CopyOnWrite();
+      for (const char* key :
+           {s_tir::attr::software_pipeline_stage, s_tir::attr::software_pipeline_order,
+            s_tir::attr::software_pipeline_async_stages,
+            s_tir::attr::software_pipeline_warp_specialize}) {
+        n->annotations.erase(key);
+      }
+    }
+    consumer_loop.CopyOnWrite()->body = consumer_body;
+    producer_loop.CopyOnWrite()->body = SeqStmt::Flatten(producer_seq);
+
+    // Step 4: Split the kernel into the two roles.
+    Stmt consumer_kernel, producer_kernel;
+    enclosing_allocs_.clear();
+    TVM_FFI_ICHECK(SplitRoles(kernel_body, pipeline, consumer_loop, producer_loop,
+                              &consumer_kernel, &producer_kernel));
+    for (const SBlock& block : producer_blocks) {
+      for (const auto& regions : {block->reads, block->writes}) {
+        for (const BufferRegion& region : regions) {
+          TVM_FFI_CHECK(!enclosing_allocs_.count(region->buffer->data.get()), ValueError)
+              << "The producers of the warp-specialized pipeline cannot access "
+              << region->buffer->name << ", which is allocated outside of the pipeline";
+        }
+      }
+    }
+
+    ffi::Array<Stmt> consumer_role, producer_role;
+    if (ReallocatesRegisters(roles)) {
+      consumer_role.push_back(MakeIntrin(
+          "tirx.ptx.setmaxnreg", {IntImm::Bool(true), IntImm::Int32(roles.consumer_regs)}));
+      producer_role.push_back(MakeIntrin(
+          "tirx.ptx.setmaxnreg", {IntImm::Bool(false), IntImm::Int32(roles.producer_regs)}));
+    }
+    consumer_role.push_back(consumer_kernel);
+    producer_role.push_back(producer_kernel);
+
+    ffi::Array<Stmt> init;
+    for (int64_t s = 0; s < roles.num_stages; ++s) {
+      init.push_back(MakeIntrin("tirx.ptx.mbarrier_init",
+                                {BarrierPtr(full, IntImm::Int32(s)),
+                                 IntImm::Int32(roles.ProducerThreads())}));
+      init.push_back(MakeIntrin("tirx.ptx.mbarrier_init",
+                                {BarrierPtr(empty, IntImm::Int32(s)),
+                                 IntImm::Int32(roles.ConsumerThreads())}));
+    }
+    Stmt sync = Evaluate(Call(PrimType::Int(32), builtin::tvm_storage_sync(), {StringImm("shared")})
+                             .as_or_throw<PrimExpr>());
+    Stmt consumer_scope =
+        AttrStmt(IntImm::Int32(1), s_tir::attr::named_barrier_scope,
+                 IntImm::Int32(roles.ConsumerThreads()), SeqStmt::Flatten(consumer_role));
+    Stmt producer_scope =
+        AttrStmt(IntImm::Int32(2), s_tir::attr::named_barrier_scope,
+                 IntImm::Int32(roles.ProducerThreads()), SeqStmt::Flatten(producer_role));
+    PrimExpr is_consumer =
+        static_cast<PrimExpr>(roles.role_var) < IntImm(role_ty, roles.num_consumers);
+    Stmt body = SeqStmt({IfThenElse(roles.is_leader, SeqStmt::Flatten(init)), sync,
+                         IfThenElse(is_consumer, consumer_scope, producer_scope)});
+    SBlock block = MakeSBlock(body, buffer_data_to_buffer_);
+    block.CopyOnWrite()->alloc_buffers = kernel_allocs;
+    return SBlockRealize({}, IntImm::Bool(true), block);
+  }
+
+  /*!
+   * \brief Whether to move registers from the producers to the consumers. The counts need whole
+   * warpgroups and must fit into the register file, or setmaxnreg would not return.
+   */
+  static bool ReallocatesRegisters(const WarpRoles& roles) {
+    if (roles.producer_regs == 0 && roles.consumer_regs == 0) return false;
+    for (int64_t regs : {roles.producer_regs, roles.consumer_regs}) {
+      TVM_FFI_CHECK(regs % 8 == 0 && regs >= 24 && regs <= 256, ValueError)
+          << "setmaxnreg takes a multiple of 8 registers in [24, 256], but got " << regs;
+    }
+    return roles.ProducerThreads() % kWarpgroupSize == 0 &&
+           roles.ConsumerThreads() % kWarpgroupSize == 0 &&
+           roles.producer_regs * roles.ProducerThreads() +
+                   roles.consumer_regs * roles.ConsumerThreads() <=
+               kRegisterFileSize;
+  }
+
+  /*!
+   * \brief Split the statements around the pipeline loop into the kernels of the two roles. The
+   * consumer kernel keeps all the statements, and the producer kernel keeps the blocks that
+   * enclose the pipeline loop, without their allocations.
+   * \return Whether the statement contains the pipeline loop.
+   */
+  bool SplitRoles(const Stmt& stmt, const ForNode* pipeline, const For& consumer_loop,
+                  const For& producer_loop, Stmt* consumer, Stmt* producer) {
+    if (stmt.get() == pipeline) {
+      *consumer = consumer_loop;
+      *producer = producer_loop;
+      return true;
+    }
+    if (const auto* seq = stmt.as<SeqStmtNode>()) {
+      for (size_t i = 0; i < seq->size(); ++i) {
+        if (SplitRoles(seq->seq[i], pipeline, consumer_loop, producer_loop, consumer, producer)) {
+          SeqStmt new_seq = ffi::GetRef<SeqStmt>(seq);
+          new_seq.CopyOnWrite()->seq.Set(i, *consumer);
+          *consumer = new_seq;
+          return true;
+        }
+      }
+      return false;
+    }
+    if (const auto* realize = stmt.as<SBlockRealizeNode>()) {
+      const SBlock& block = realize->block;
+      if (!SplitRoles(block->body, pipeline, consumer_loop, producer_loop, consumer, producer)) {
+        return false;
+      }
+      TVM_FFI_CHECK(block->iter_vars.empty() && is_one(realize->predicate), ValueError)
+          << "The warp-specialized pipeline cannot be nested in block " << block->name_hint
+          << " with block iters or a predicate";
+      for (const Buffer& buffer : block->alloc_buffers) {
+        enclosing_allocs_.insert(buffer->data.get());
+      }
+      SBlock new_block = block;
+      new_block.CopyOnWrite()->body = *consumer;
+      SBlockRealize new_realize = ffi::GetRef<SBlockRealize>(realize);
+      new_realize.CopyOnWrite()->block = new_block;
+      *consumer = new_realize;
+      return true;
+    }
+    if (const auto* attr = stmt.as<AttrStmtNode>()) {
+      if (!SplitRoles(attr->body, pipeline, consumer_loop, producer_loop, consumer, producer)) {
+        return false;
+      }
+      *producer = AttrStmt(attr->node, attr->attr_key, attr->value, *producer);
+      AttrStmt new_attr = ffi::GetRef<AttrStmt>(attr);
+      new_attr.CopyOnWrite()->body = *consumer;
+      *consumer = new_attr;
+      return true;
+    }
+    // Loops and conditions would run the pipeline a different number of times on each role.
+    bool contains = false;
+    PostOrderVisit(stmt, [&](const ffi::ObjectRef& obj) { contains |= obj.get() == pipeline; });
+    TVM_FFI_CHECK(!contains, ValueError)
+        << "The warp-specialized pipeline cannot be nested in " << stmt->GetTypeKey();
+    return false;
+  }
+
+  /*! \brief The address of a barrier. */
+  static PrimExpr BarrierPtr(const Buffer& barriers, PrimExpr index) {
+    return Call(barriers->data->ty, builtin::address_of(), {BufferLoad(barriers, {index})})
+        .as_or_throw<PrimExpr>();
+  }
+
+  /*! \brief Evaluate a void intrinsic. */
+  static Stmt MakeIntrin(const char* op_name, ffi::Array<Expr> args) {
+    return Evaluate(Call(PrimType::Void(), Op::Get(op_name), args).as_or_throw<PrimExpr>());
+  }
+
+  ffi::Map<Var, Buffer> buffer_data_to_buffer_;
+  const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info_;
+  /*! \brief The buffers allocated by the blocks that enclose the pipeline loop. */
+  std::unordered_set<const VarNode*> enclosing_allocs_;
+};
+
 class PipelineInjector : private StmtExprMutator {
  public:
   static Stmt Inject(const PrimFunc& func) {
@@ -1042,7 +1506,8 @@ class PipelineInjector : private StmtExprMutator {
       injector.buffer_data_to_buffer_.Set(buffer->data, buffer);
     }
     injector.fragment_info_ = GetTensorCoreFragmentInfo(func->body);
-    return injector(func->body);
+    Stmt body = WarpSpecializer::Rewrite(func, injector.fragment_info_);
+    return injector(body);
   }
 
  private:
@@ -1117,6 +1582,10 @@ class PipelineInjector : private StmtExprMutator {
       pipeline_body = for_node->body;
     }
 
+    if (op->annotations.count(s_tir::attr::software_pipeline_prefetch)) {
+      return InjectPrefetch(for_node, pipeline_body, pipeline_allocs);
+    }
+
     const SeqStmtNode* pipeline_body_seq = pipeline_body.as<SeqStmtNode>();
     TVM_FFI_CHECK(pipeline_body_seq, ValueError)
         << "The body of the software pipeline should be SeqStmt, got "
@@ -1204,6 +1673,106 @@ class PipelineInjector : private StmtExprMutator {
     return pipeline;
   }
 
+  /*!
+   * \brief Prefetch the reads of each pipeline stage into the CPU cache ahead of their use.
+   *
+   * The reads of a statement in stage N at iteration `i + N` are prefetched at iteration `i`,
+   * one `tirx.prefetch` per cache line, so that loads of later iterations overlap with the
+   * computation of the current one. Unlike the multi-buffered pipeline, the statements keep
+   * their original order, and buffers allocated inside the pipeline are not prefetched.
+   *
+   * \param loop The pipelined loop.
+   * \param pipeline_body The statements of the pipeline.
+   * \param pipeline_allocs The buffers allocated inside the pipeline.
+   * \return The loop with the prefetches inserted at the start of its body.
+   */
+  Stmt InjectPrefetch(const For& loop, const Stmt& pipeline_body,
+                      const ffi::Array<Buffer>& pipeline_allocs) {
+    auto stages = loop->annotations.at(s_tir::attr::software_pipeline_stage)
+                      .as_or_throw<ffi::Array<int64_t>>();
+    // A single stage applies to the whole body.
+    ffi::Array<Stmt> children{pipeline_body};
+    if (const auto* seq = pipeline_body.as<SeqStmtNode>(); seq && stages.size() != 1) {
+      children = seq->seq;
+    }
+    TVM_FFI_CHECK_EQ(stages.size(), children.size(), ValueError)
+        << "PrimFunc " << global_symbol_ << " has " << children.size()
+        << " statements in the prefetched pipeline, but pipeline annotation is " << stages;
+    std::unordered_set<const BufferNode*> local_buffers;
+    for (const Buffer& buffer : pipeline_allocs) {
+      local_buffers.insert(buffer.get());
+    }
+
+    std::map<int64_t, ffi::Array<Stmt>> prefetches;
+    for (size_t i = 0; i < children.size(); ++i) {
+      int64_t distance = stages[i];
+      if (distance <= 0) continue;
+      SBlock block = MakeSBlock(children[i], buffer_data_to_buffer_);
+      PrimExpr ahead_index = loop->loop_var + IntImm(loop->loop_var.ty(), distance);
+      ffi::Map<Var, Expr> ahead{{loop->loop_var, ahead_index}};
+      for (const BufferRegion& read : block->reads) {
+        const Buffer& buffer = read->buffer;
+        if (local_buffers.count(buffer.get()) || buffer.scope() != "global" ||
+            read->region.empty()) {
+          continue;
+        }
+        prefetches[distance].push_back(MakePrefetch(buffer, Substitute(read->region, ahead)));
+      }
+    }
+
+    PrimExpr loop_end = is_zero(loop->min) ? loop->extent : loop->min + loop->extent;
+    ffi::Array<Stmt> body;
+    for (const auto& [distance, stmts] : prefetches) {
+      PrimExpr in_range = loop->loop_var + IntImm(loop->loop_var.ty(), distance) < loop_end;
+      body.push_back(IfThenElse(in_range, SeqStmt::Flatten(stmts)));
+    }
+    body.push_back(loop->body);
+
+    For new_loop = loop;
+    ForNode* n = new_loop.CopyOnWrite();
+    n->body = SeqStmt::Flatten(body);
+    for (const char* key :
+         {s_tir::attr::software_pipeline_stage, s_tir::attr::software_pipeline_order,
+          s_tir::attr::software_pipeline_async_stages, s_tir::attr::software_pipeline_prefetch}) {
+      n->annotations.erase(key);
+    }
+    return new_loop;
+  }
+
+  /*!
+   * \brief Prefetch every cache line of a buffer region.
+   * \param buffer The buffer to prefetch.
+   * \param region The region of the buffer, whose innermost dimension is contiguous.
+   * \return The loop nest of `tirx.prefetch` calls.
+   */
+  static Stmt MakePrefetch(const Buffer& buffer, const Region& region) {
+    constexpr int kCacheLineBytes = 64;
+    int64_t elem_bytes = std::max(1, buffer->dtype.bytes() * buffer->dtype.lanes());
+    int64_t step = std::max<int64_t>(1, kCacheLineBytes / elem_bytes);
+    size_t ndim = region.size();
+    std::vector<PrimVar> vars;
+    ffi::Array<PrimExpr> indices;
+    for (size_t i = 0; i < ndim; ++i) {
+      PrimType index_dtype = region[i]->min.ty();
+      vars.emplace_back("prefetch_ax" + std::to_string(i), index_dtype);
+      PrimExpr offset = vars.back();
+      if (i + 1 == ndim) offset = offset * IntImm(index_dtype, step);
+      indices.push_back(region[i]->min + offset);
+    }
+    PrimExpr address =
+        Call(buffer->data->ty, builtin::address_of(), {BufferLoad(buffer, indices)})
+            .as_or_throw<PrimExpr>();
+    // Read access, high temporal locality, data cache, as in llvm.prefetch.
+    Stmt body = Evaluate(Call(PrimType::Void(), builtin::prefetch(),
+                              {address, IntImm::Int32(0), IntImm::Int32(3), IntImm::Int32(1)}));
+    for (size_t i = ndim; i-- > 0;) {
+      PrimExpr extent = region[i]->extent;
+      if (i + 1 == ndim) extent = ceildiv(extent, IntImm(extent.ty(), step));
+      body = For(vars[i], IntImm(vars[i].ty(), 0), extent, ForKind::kSerial, body);
+    }
+    return body;
+  }
+
   /*!
    * \brief Add buffer allocations to a block and update the write region of the block.
    * \param n The block pointer to which the buffer allocations are added.
@@ -1244,11 +1813,16 @@ class PipelineInjector : private StmtExprMutator {
   }
 
   bool HasPipelineAnnotation(const ForNode* op) const {
+    TVM_FFI_CHECK(!op->annotations.count(s_tir::attr::software_pipeline_warp_specialize),
+                  ValueError)
+        << "The warp-specialized pipeline should be in a kernel bound to threadIdx";
     auto it1 = op->annotations.find(s_tir::attr::software_pipeline_stage);
     auto it2 = op->annotations.find(s_tir::attr::software_pipeline_order);
     bool has_stage = it1 != op->annotations.end();
     bool has_order = it2 != op->annotations.end();
-    if (has_stage && has_order) {
+    // Prefetched pipelines keep the original order of the statements.
+    bool has_prefetch = op->annotations.count(s_tir::attr::software_pipeline_prefetch);
+    if (has_stage && (has_order || has_prefetch)) {
       return true;
     }
     if (has_stage) {
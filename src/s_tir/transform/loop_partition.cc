@@ -49,6 +49,7 @@ struct LoopPartitionConfigNode : public ffi::Object {
   bool partition_const_loop;
   bool no_unroll_loop_with_extent_one;
   bool unroll_loop_with_partition_hint_no_interval;
+  double max_code_growth;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -61,7 +62,11 @@ struct LoopPartitionConfigNode : public ffi::Object {
         .def_ro("unroll_loop_with_partition_hint_no_interval",
                 &LoopPartitionConfigNode::unroll_loop_with_partition_hint_no_interval,
                 "Unroll loops with pragma_loop_partition_hint and no interval",
-                refl::DefaultValue(false));
+                refl::DefaultValue(false))
+        .def_ro("max_code_growth", &LoopPartitionConfigNode::max_code_growth,
+                "The maximum ratio of the size of a function after partitioning to its size "
+                "before, 0 for no bound",
+                refl::DefaultValue(0.0));
   }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("s_tir.transform.LoopPartitionConfig", LoopPartitionConfigNode,
                                     ffi::Object);
@@ -107,13 +112,27 @@ using ExpressionSet = std::unordered_set<PrimExpr, ffi::ObjectPtrHash, ffi::Obje
 // Rule:
 //   - the range should not be const
 //   - there exist a condition expression in the scope that use the var
+//   - with masked vector tails, conditions inside vectorized loops are left to the vectorizer
 class CandidateSelector final : public StmtExprVisitor {
  public:
   using VarIsUsed = bool;
-  explicit CandidateSelector(bool partition_const_loop)
-      : partition_const_loop_(partition_const_loop) {}
+  explicit CandidateSelector(bool partition_const_loop, bool masked_vector_tail = false)
+      : partition_const_loop_(partition_const_loop), masked_vector_tail_(masked_vector_tail) {}
 
   void VisitStmt_(const ForNode* op) final {
+    if (masked_vector_tail_ && op->kind == ForKind::kVectorized) {
+      // The vectorizer turns the guard into masked loads and stores, so peeling the
+      // remainder off the enclosing loops would only add a scalar epilogue.
+      bool in_masked_vector = in_masked_vector_;
+      in_masked_vector_ = true;
+      VisitForImpl(op);
+      in_masked_vector_ = in_masked_vector;
+      return;
+    }
+    VisitForImpl(op);
+  }
+
+  void VisitForImpl(const ForNode* op) {
     // always treat var with hint to be partitioned
     const VarNode* var = op->loop_var.get();
     if (partition_hint_vars.count(var)) {
@@ -198,7 +217,7 @@ class CandidateSelector final : public StmtExprVisitor {
   }
 
   void VisitExpr_(const VarNode* op) final {
-    if (in_likely_ && record_.count(op)) {
+    if (in_likely_ && !in_masked_vector_ && record_.count(op)) {
       record_.at(op) = true;
     }
   }
@@ -210,6 +229,8 @@ class CandidateSelector final : public StmtExprVisitor {
   bool in_likely_{false};
   bool no_split_{false};
   bool partition_const_loop_{false};
+  bool masked_vector_tail_{false};
+  bool in_masked_vector_{false};
   std::unordered_map<const VarNode*, VarIsUsed> record_;
   arith::Analyzer analyzer_;
 };
@@ -413,15 +434,44 @@ class ThreadPartitionInserter : public StmtMutator {
   bool innermost_thread_scope_;
 };
 
+// Count the statements and expressions of a statement, as a measure of its code size.
+class CodeSizeCounter : public StmtExprVisitor {
+ public:
+  static int64_t Count(const Stmt& stmt) {
+    CodeSizeCounter counter;
+    counter(stmt);
+    return counter.size_;
+  }
+
+  void VisitStmt(const Stmt& stmt) final {
+    ++size_;
+    StmtExprVisitor::VisitStmt(stmt);
+  }
+
+  void VisitExpr(const Expr& expr) final {
+    ++size_;
+    StmtExprVisitor::VisitExpr(expr);
+  }
+
+ private:
+  int64_t size_{0};
+};
+
 // Try to partition range of iteration variables in order to remove (some)
 // likely conditions
+//
+// With a code size budget, the inner loops are partitioned before the loops around them, as
+// partitioning an inner loop copies less code, and a partition that does not fit in the rest of
+// the budget is not done, leaving its conditions as predicates.
 class LoopPartitioner : public StmtMutator {
  public:
   explicit LoopPartitioner(bool partition_const_loop, bool no_unroll_loop_with_extent_one,
-                           bool unroll_loop_with_partition_hint_no_interval)
-      : selector(CandidateSelector(partition_const_loop)),
+                           bool unroll_loop_with_partition_hint_no_interval,
+                           bool masked_vector_tail, int64_t size_budget = -1)
+      : selector(CandidateSelector(partition_const_loop, masked_vector_tail)),
         no_unroll_loop_with_extent_one_(no_unroll_loop_with_extent_one),
-        unroll_loop_with_partition_hint_no_interval_(unroll_loop_with_partition_hint_no_interval) {}
+        unroll_loop_with_partition_hint_no_interval_(unroll_loop_with_partition_hint_no_interval),
+        size_budget_(size_budget) {}
 
   Stmt VisitAndMutate(Stmt stmt) {
     selector(stmt);
@@ -431,7 +481,8 @@ class LoopPartitioner : public StmtMutator {
   Stmt VisitStmt_(const ForNode* op) final {
     analyzer_->Bind(op->loop_var, Range::FromMinExtent(op->min, op->extent), true);
     auto fs = ffi::GetRef<Stmt>(op);
-    if (selector.candidates.count(fs)) {
+    bool is_candidate = selector.candidates.count(fs);
+    if (is_candidate && size_budget_ < 0) {
       Stmt s = TryPartition(fs, op->loop_var, op->min, op->min + op->extent - 1, op->body, false);
       if (s.defined()) return s;
     }
@@ -441,6 +492,14 @@ class LoopPartitioner : public StmtMutator {
     hint_map_.insert({op->loop_var.get(), IntSet::Interval(op->min, op->min + op->extent - 1)});
     Stmt res = StmtMutator::VisitStmt_(op);
     hint_map_.erase(op->loop_var.get());
+    if (is_candidate && size_budget_ >= 0) {
+      // Partition the loop over its partitioned inner loops.
+      const ForNode* new_op = res.as<ForNode>();
+      TVM_FFI_ICHECK(new_op);
+      Stmt s = TryPartition(res, new_op->loop_var, new_op->min,
+                            new_op->min + new_op->extent - 1, new_op->body, false);
+      if (s.defined()) return s;
+    }
     return res;
   }
 
@@ -486,6 +545,16 @@ class LoopPartitioner : public StmtMutator {
 
   inline Stmt MakeFor(const ffi::Object* op, PrimExpr extent, Stmt body);
 
+  /*!
+   * \brief Check whether the partition of a statement fits in the code size budget, and
+   *  charge its growth to the budget if so.
+   * \param before The statement before partitioning.
+   * \param after The statement after partitioning.
+   * \param used_before The budget used before partitioning the statement, which does not
+   *  include the partitions done inside of it.
+   */
+  bool ChargeBudget(const Stmt& before, const Stmt& after, int64_t used_before);
+
   /* Candidate IRs that may be partitioned potentially */
   std::unordered_map<const VarNode*, IntSet> hint_map_;
   std::unordered_map<const VarNode*, IntSet> relax_map_;
@@ -493,8 +562,23 @@ class LoopPartitioner : public StmtMutator {
   CandidateSelector selector;
   bool no_unroll_loop_with_extent_one_;
   bool unroll_loop_with_partition_hint_no_interval_;
+  /*! \brief The number of nodes partitioning may add, -1 for no bound. */
+  int64_t size_budget_;
+  /*! \brief The number of nodes added by partitioning. */
+  int64_t size_used_{0};
 };
 
+bool LoopPartitioner::ChargeBudget(const Stmt& before, const Stmt& after, int64_t used_before) {
+  if (size_budget_ < 0) return true;
+  int64_t growth = CodeSizeCounter::Count(after) - CodeSizeCounter::Count(before);
+  if (used_before + growth > size_budget_) {
+    size_used_ = used_before;
+    return false;
+  }
+  size_used_ = used_before + std::max<int64_t>(growth, 0);
+  return true;
+}
+
 // Returns an interval (in the first component) in which all the conditions
 // given in the second component provably have value given by cond_value
 std::pair<IntSet, ExpressionSet> LoopPartitioner::GetIntervalAndCondset(
@@ -594,6 +678,7 @@ std::pair<IntSet, ExpressionSet> LoopPartitioner::GetIntervalAndCondset(
 Stmt LoopPartitioner::TryPartition(const Stmt& stmt, Var var, PrimExpr min, PrimExpr max, Stmt body,
                                    bool partition_thread_scope) {
   using namespace arith;
+  int64_t size_used_before = size_used_;
   // include hint of var.
   hint_map_.insert({var.get(), IntSet::Interval(min, max)});
 
@@ -771,6 +856,10 @@ Stmt LoopPartitioner::TryPartition(const Stmt& stmt, Var var, PrimExpr min, Prim
       cond = cond && (var.as_or_throw<PrimExpr>() < post_doubt_begin);
     s = ThreadPartitionInserter(cond_set, cond)(stmt);
   }
+  // A partition over the budget is dropped, and its conditions stay as predicates.
+  if (!ChargeBudget(stmt, s, size_used_before)) {
+    return Stmt();
+  }
   s = ConvertSSA(s);
   return s;
 }
@@ -816,9 +905,11 @@ class RemoveLikelyTagsAndHints : public StmtExprMutator {
 };
 
 Stmt LoopPartition(Stmt stmt, bool partition_const_loop, bool no_unroll_loop_with_extent_one,
-                   bool unroll_loop_with_partition_hint_no_interval) {
+                   bool unroll_loop_with_partition_hint_no_interval, bool masked_vector_tail,
+                   int64_t size_budget) {
   stmt = LoopPartitioner(partition_const_loop, no_unroll_loop_with_extent_one,
-                         unroll_loop_with_partition_hint_no_interval)
+                         unroll_loop_with_partition_hint_no_interval, masked_vector_tail,
+                         size_budget)
              .VisitAndMutate(std::move(stmt));
   stmt = RemoveLikelyTagsAndHints()(std::move(stmt));
   return stmt;
@@ -833,9 +924,29 @@ Pass LoopPartition() {
     if (!cfg.has_value()) {
       cfg = tvm::transform::PassConfigWithDefaults<LoopPartitionConfig>();
     }
+    bool masked_vector_tail = ctx->GetConfig<bool>("tirx.vectorize_masked_tail").value_or(false);
+    double max_code_growth = cfg.value()->max_code_growth;
+    TVM_FFI_CHECK(max_code_growth == 0 || max_code_growth >= 1, ValueError)
+        << "max_code_growth of s_tir.LoopPartition must be 0 or at least 1, but got "
+        << max_code_growth;
+    int64_t size_before = -1;
+    int64_t size_budget = -1;
+    if (max_code_growth != 0) {
+      size_before = CodeSizeCounter::Count(n->body);
+      size_budget = static_cast<int64_t>((max_code_growth - 1) * size_before);
+    }
     n->body = s_tir::LoopPartition(std::move(n->body), cfg.value()->partition_const_loop,
                                    cfg.value()->no_unroll_loop_with_extent_one,
-                                   cfg.value()->unroll_loop_with_partition_hint_no_interval);
+                                   cfg.value()->unroll_loop_with_partition_hint_no_interval,
+                                   masked_vector_tail, size_budget);
+    if (size_before > 0) {
+      // Report the growth of each kernel under a budget.
+      double code_growth = static_cast<double>(CodeSizeCounter::Count(n->body)) / size_before;
+      VLOG(1) << "LoopPartition of " << f->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol)
+              << " grows the code by " << code_growth << "x";
+      f = WithAttr(std::move(f), "s_tir.loop_partition_code_growth",
+                   FloatImm(DataType::Float(64), code_growth));
+    }
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "s_tir.LoopPartition", {});
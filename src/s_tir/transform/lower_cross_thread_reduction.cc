@@ -68,6 +68,16 @@ bool IsBoundToThreadIdx(const ForNode* loop) {
   return scope.rank == 1 && scope.dim_index >= 0;
 }
 
+/*!
+ * \brief Checks if a loop is bound to blockIdx.x, whose thread blocks reduce together as a cluster
+ * \param loop The loop to be checked
+ * \return True if the loop is bound to blockIdx.x
+ */
+bool IsBoundToClusterBlockIdx(const ForNode* loop) {
+  return loop->thread_binding.has_value() &&
+         loop->thread_binding.value()->thread_tag == "blockIdx.x";
+}
+
 /*!
  * \brief Check the dominant property of a block:
  * the block is the only writer of its output, dominating the reader of its output buffers
@@ -661,14 +671,17 @@ class CrossThreadReductionTransformer : public StmtMutator {
            "the deepest statements, which violates the condition.";
 
     // Condition 2. All the reduction-related loops that are bound to thread axes should only be
-    // bound to `threadIdx.x/y/z`.
+    // bound to `threadIdx.x/y/z`, or to `blockIdx.x` for a reduction across thread blocks.
     int n_bound_reduction_loops = 0;
     for (const ForNode* reduction_loop : reduction_loops) {
       if (reduction_loop->thread_binding.has_value()) {
         ++n_bound_reduction_loops;
-        TVM_FFI_CHECK(IsBoundToThreadIdx(reduction_loop), ValueError)
+        TVM_FFI_CHECK(
+            IsBoundToThreadIdx(reduction_loop) || IsBoundToClusterBlockIdx(reduction_loop),
+            ValueError)
             << "Cross-thread reduction requires all the reduction-related loops that "
-               "are bound to GPU thread axes to only be bound `threadIdx.x/y/z`. However, loop "
+               "are bound to GPU thread axes to only be bound `threadIdx.x/y/z` or "
+               "`blockIdx.x`. However, loop "
             << reduction_loop->loop_var->name << " violates the condition.";
       }
     }
@@ -841,7 +854,8 @@ class CrossThreadReductionTransformer : public StmtMutator {
     std::vector<std::pair<ThreadScope, Range>> reduction_threads;
     reduction_threads.reserve(reduction_loops.size());
     for (const ForNode* loop : reduction_loops) {
-      if (loop->thread_binding.has_value()) {
+      // The consumers never share a thread block with the other thread blocks of a cluster.
+      if (IsBoundToThreadIdx(loop)) {
         reduction_threads.emplace_back(
             ThreadScope::Create(loop->thread_binding.value()->thread_tag),
             Range::FromMinExtent(loop->min, loop->extent));
@@ -53,6 +53,14 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       thread_extents_.push_back(op);
       Stmt ret = StmtExprMutator::VisitStmt_(op);
       thread_extents_.pop_back();
+      // The CTAs along blockIdx.x reduce together, so they are launched as one cluster.
+      IterVar iv = op->node.as_or_throw<IterVar>();
+      if (cluster_block_vars_.erase(iv->var.get())) {
+        std::string tag = "clusterCtaIdx.x";
+        IterVar cluster_iv(Range::FromMinExtent(0, op->value), PrimVar(tag),
+                           IterVarType::kThreadIndex, tag);
+        ret = AttrStmt(cluster_iv, tirx::attr::thread_extent, op->value, ret);
+      }
       return ret;
     } else if (op->attr_key == s_tir::attr::reduce_scope) {
       const CommReducerNode* combiner = op->node.as<CommReducerNode>();
@@ -218,6 +226,8 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
 
     size_t nmatch = 0;
     std::vector<ThreadEntry> vred, vpar;
+    // The extent of blockIdx.x when the thread blocks along it reduce together.
+    int cluster_extent = 1;
     for (const AttrStmtNode* attr : thread_extents_) {
       ThreadEntry e;
       IterVar iv = attr->node.as_or_throw<IterVar>();
@@ -225,7 +235,21 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       e.iv = iv;
       TVM_FFI_ICHECK_LE(e.scope.rank, 1);
       TVM_FFI_ICHECK_GE(e.scope.dim_index, 0) << "vthread do not work with cross thread reduction";
-      if (e.scope.rank == 1) {
+      if (e.scope.rank == 0 && reduce_set.count(iv->var.get())) {
+        const auto* ptr = attr->value.as<IntImmNode>();
+        TVM_FFI_CHECK(e.scope.dim_index == 0 && ptr, ValueError)
+            << "Only a constant blockIdx.x can be reduced across, but got " << iv->thread_tag
+            << " of extent " << attr->value;
+        TVM_FFI_CHECK(target_->kind->name == "cuda" && ptr->value <= kMaxClusterSize, ValueError)
+            << "A reduction across thread blocks needs a CUDA cluster of at most "
+            << kMaxClusterSize << " blocks, but got " << ptr->value << " blocks on "
+            << target_->kind->name;
+        cluster_extent = static_cast<int>(ptr->value);
+        if (cluster_extent > 1) {
+          cluster_block_vars_.insert(iv->var.get());
+        }
+        ++nmatch;
+      } else if (e.scope.rank == 1) {
         const auto* ptr = attr->value.as<IntImmNode>();
         TVM_FFI_ICHECK(ptr) << "Need constant extent for reduce set " << iv;
         e.extent = static_cast<int>(ptr->value);
@@ -308,7 +332,9 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     // the remaining elements, and this reduction can also be optimized by
     // shuffle_down warp-level primitives.
     PrimExpr zero_index = IntImm(reduce_index.ty(), 0);
-    if (IsWarpReduction(dtypes, group_extent, reduce_extent, contiguous_reduce_extent)) {
+    if (reduce_extent == 1 && cluster_extent > 1) {
+      // Only the thread blocks of the cluster take part in the reduction.
+    } else if (IsWarpReduction(dtypes, group_extent, reduce_extent, contiguous_reduce_extent)) {
       std::vector<PrimExpr> reduce_results;
       PrimExpr mask =
           Call(PrimType::UInt(32), builtin::tvm_warp_activemask(), {}).as_or_throw<PrimExpr>();
@@ -441,6 +467,30 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       }
     }
 
+    // Reduce the results of the thread blocks of the cluster, so that every thread of the cluster
+    // reads the same result.
+    if (cluster_extent > 1) {
+      std::vector<PrimExpr> block_results(size);
+      for (size_t i = 0; i < size; ++i) {
+        block_results[i] =
+            reduce_extent == 1 ? values[i] : load_remap_.at(buffers[i]->data.get());
+      }
+      std::vector<Buffer> results =
+          MakeClusterAllreduce(combiner, dtypes, block_results, reduce_index, group_index,
+                               group_extent, cluster_extent, &seq, &new_alloc_bufs);
+      for (size_t i = 0; i < size; ++i) {
+        const VarNode* data = buffers[i]->data.get();
+        // The result of the thread block is no longer the rewritten allocation.
+        if (auto it = alloc_remap_.find(data); it != alloc_remap_.end()) {
+          new_alloc_bufs.push_back(it->second);
+        }
+        load_remap_[data] = BufferLoad(results[i], {zero_index});
+        alloc_remap_[data] = results[i];
+        var_remap_[data] = results[i]->data;
+        buf_remap_[buffers[i].get()] = results[i];
+      }
+    }
+
     // Fix all local allocations as all statements are built.
     ffi::Array<Stmt> alloc_stmts;
     for (Buffer buf : new_alloc_bufs) {
@@ -455,6 +505,65 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     return body;
   }
 
+  /*!
+   * \brief Reduce the results of the thread blocks of a cluster through the distributed shared
+   *  memory. Every thread block publishes its result in shared memory, and after a cluster
+   *  barrier every thread combines the results of all the thread blocks in rank order, so that
+   *  they all compute the same value.
+   * \return The local buffers holding the results of the cluster.
+   */
+  std::vector<Buffer> MakeClusterAllreduce(const CommReducerNode* combiner,
+                                           const std::vector<PrimType>& dtypes,
+                                           const std::vector<PrimExpr>& block_results,
+                                           PrimExpr reduce_index, PrimExpr group_index,
+                                           int group_extent, int cluster_extent,
+                                           std::vector<Stmt>* seq,
+                                           std::vector<Buffer>* new_alloc_bufs) {
+    static const Op& mapa_op = Op::Get("tirx.ptx.mapa");
+    size_t size = dtypes.size();
+    PrimExpr zero_index = IntImm(reduce_index.ty(), 0);
+    ffi::Array<PrimExpr> shape = {IntImm(group_index.ty(), group_extent)};
+    std::vector<Buffer> cluster_bufs, result_bufs;
+    std::vector<Stmt> publish;
+    for (size_t i = 0; i < size; ++i) {
+      cluster_bufs.push_back(
+          decl_buffer(shape, dtypes[i], "red_buf_cluster" + std::to_string(i), "shared"));
+      result_bufs.push_back(
+          decl_buffer({1}, dtypes[i], "red_result_cluster" + std::to_string(i), "local"));
+      publish.push_back(BufferStore(cluster_bufs[i], block_results[i], {group_index}));
+    }
+    new_alloc_bufs->insert(new_alloc_bufs->end(), cluster_bufs.begin(), cluster_bufs.end());
+    // Every thread of a group holds the result of the thread block, the first one publishes it.
+    seq->push_back(IfThenElse(reduce_index == zero_index, SeqStmt::Flatten(publish)));
+    seq->push_back(ClusterSync());
+    for (int rank = 0; rank < cluster_extent; ++rank) {
+      ffi::Array<PrimExpr> acc, peer;
+      for (size_t i = 0; i < size; ++i) {
+        std::string name = cluster_bufs[i]->name + "_rank" + std::to_string(rank);
+        Var ptr(name, PointerType(dtypes[i], "global"));
+        PrimExpr local_addr = Call(cluster_bufs[i]->data->ty, builtin::address_of(),
+                                   {BufferLoad(cluster_bufs[i], {zero_index})})
+                                  .as_or_throw<PrimExpr>();
+        PrimExpr peer_addr =
+            Call(PrimType::UInt(64), mapa_op,
+                 {local_addr, IntImm::Int32(rank), StringImm(""), StringImm("u64"),
+                  StringImm("uint64")})
+                .as_or_throw<PrimExpr>();
+        seq->push_back(Bind(ptr, Call(ptr->ty, builtin::reinterpret(), {peer_addr})));
+        Buffer peer_buf(ptr, dtypes[i], shape, {}, PrimExpr(), name, 0, 0);
+        peer.push_back(BufferLoad(peer_buf, {group_index}));
+        acc.push_back(BufferLoad(result_bufs[i], {zero_index}));
+      }
+      ffi::Array<PrimExpr> ret = rank == 0 ? peer : (*combiner)(acc, peer);
+      for (size_t i = 0; i < size; ++i) {
+        seq->push_back(BufferStore(result_bufs[i], ret[i], {zero_index}));
+      }
+    }
+    // No thread block may exit or reuse its shared memory while the others read it.
+    seq->push_back(ClusterSync());
+    return result_bufs;
+  }
+
   std::pair<std::vector<PrimExpr>, std::vector<Buffer>> MakeWarpAllreduce(
       std::vector<PrimExpr> src_values,                  //
       std::vector<PrimType> dtypes,                      //
@@ -724,6 +833,13 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
                         .as_or_throw<PrimExpr>());
   }
 
+  // Barrier of all the threads of the thread block cluster, which orders their shared memory
+  // accesses.
+  static Stmt ClusterSync() {
+    static const Op& cluster_sync_op = Op::Get("tirx.cuda.cluster_sync");
+    return Evaluate(Call(PrimType::Void(), cluster_sync_op, {}).as_or_throw<PrimExpr>());
+  }
+
   // Emit warp shuffle  calls.
   PrimExpr WarpShuffle(const Op& op, ffi::Optional<Buffer> mask_buffer, PrimExpr val,
                        PrimExpr delta_or_lane) {
@@ -802,6 +918,8 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     }
   }
 
+  // The largest portable size of a thread block cluster.
+  static constexpr int kMaxClusterSize = 8;
   // The target.
   const TargetNode* target_ = nullptr;
 
@@ -815,6 +933,8 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
   // surrounding scope of thread extent.
   std::vector<const AttrStmtNode*> thread_extents_;
   std::vector<const CommReducerNode*> reduce_combiner_;
+  // The blockIdx.x of the kernels whose thread blocks reduce together.
+  std::unordered_set<const VarNode*> cluster_block_vars_;
   // The load remap
   std::unordered_map<const VarNode*, PrimExpr> load_remap_;
   // Internal analyzer
@@ -34,8 +34,10 @@
 #include <tvm/tirx/op.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <algorithm>
 #include <list>
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -100,6 +102,40 @@ class AllocateCollector : public StmtExprVisitor {
   bool is_dynamic_;
 };
 
+/*!
+ * \brief Collect the buffers addressed by async copies (cp.async and the bulk/TMA copies), whose
+ * shared memory addresses must be aligned to the copy granularity.
+ */
+class AsyncCopyBufferCollector : public StmtExprVisitor {
+ public:
+  void VisitExpr_(const CallNode* op) final {
+    const auto* op_node = op->op.as<OpNode>();
+    if (op_node != nullptr && std::string(op_node->name).rfind("tirx.ptx.cp_async", 0) == 0) {
+      bool outer = in_async_copy_;
+      in_async_copy_ = true;
+      StmtExprVisitor::VisitExpr_(op);
+      in_async_copy_ = outer;
+    } else {
+      StmtExprVisitor::VisitExpr_(op);
+    }
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    if (in_async_copy_) buffers_.insert(op);
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    if (in_async_copy_) buffers_.insert(op->buffer->data.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  // The data vars of the buffers used by async copies
+  std::unordered_set<const VarNode*> buffers_;
+
+ private:
+  bool in_async_copy_{false};
+};
+
 // Find a linear pattern of storage access
 // Used for liveness analysis.
 // "linear" means fitting a complex access pattern into an array of StmtEntry
@@ -287,7 +323,11 @@ class SharedMemLinearAccessPatternFinder final : public StmtExprVisitor {
  */
 class SharedMemoryRewriter : public StmtExprMutator {
  public:
-  explicit SharedMemoryRewriter(bool is_dynamic = true) : is_dynamic_{is_dynamic} {}
+  explicit SharedMemoryRewriter(bool is_dynamic = true, bool pack_offsets = false,
+                                int64_t async_copy_align = 16)
+      : is_dynamic_{is_dynamic},
+        pack_offsets_{pack_offsets},
+        async_copy_align_{async_copy_align} {}
 
  private:
   using StmtEntry = SharedMemLinearAccessPatternFinder::StmtEntry;
@@ -375,11 +415,13 @@ class SharedMemoryRewriter : public StmtExprMutator {
       // VisitNewScope creates the proper scope pair entry for the thread_extent.
       SharedMemLinearAccessPatternFinder finder(is_dynamic_);
       finder(ffi::GetRef<Stmt>(op));
-      this->LivenessAnalysis(finder.linear_seq_, scope);
-      this->PlanMemory(finder.linear_seq_, scope);
+      if (!pack_offsets_ || !this->PackOffsets(finder.linear_seq_, op->body, scope)) {
+        this->LivenessAnalysis(finder.linear_seq_, scope);
+        this->PlanMemory(finder.linear_seq_, scope);
 
-      // 4. Compute byte offsets / merged_alloc_size.
-      this->ComputeOffsets(scope);
+        // 4. Compute byte offsets / merged_alloc_size.
+        this->ComputeOffsets(scope);
+      }
 
       // 5. Recursively mutate the body — reads scope_stack_.back() for all rewrites.
       Stmt visited_body = StmtExprMutator::VisitStmt(op->body);
@@ -690,6 +732,94 @@ class SharedMemoryRewriter : public StmtExprMutator {
     }
   }
 
+  /*!
+   * \brief Assign byte offsets by packing the live ranges of the buffers.
+   *
+   * Buffers are placed from the largest to the smallest, each at the lowest offset that honours
+   * its alignment and does not overlap any placed buffer whose live range intersects its own.
+   * Unlike PlanMemory, a buffer may span the space of several dead buffers at arbitrary offsets,
+   * which gives a smaller footprint when sizes differ. Buffers used by async copies are aligned
+   * to `async_copy_align_` bytes, as cp.async needs 16 and swizzled TMA copies 128.
+   *
+   * \param seq the linear pattern of storage access
+   * \param body the body of the kernel launch
+   * \param scope the kernel scope to write results into
+   * \return Whether the offsets were assigned; false if some buffer has a symbolic size.
+   */
+  bool PackOffsets(const std::vector<StmtEntry>& seq, const Stmt& body, KernelScope& scope) {
+    struct Placement {
+      const VarNode* var;
+      int64_t bytes;
+      int64_t align;
+      // The first and last positions in `seq` where the buffer is live.
+      int64_t begin;
+      int64_t end;
+      int64_t offset{0};
+    };
+    std::unordered_map<const VarNode*, std::pair<int64_t, int64_t>> live_ranges;
+    for (size_t i = 0; i < seq.size(); ++i) {
+      // Accesses inside a nested scope are recorded at its end; the buffer is live from its begin.
+      int64_t pos = static_cast<int64_t>(i);
+      int64_t begin = seq[i].scope_pair_offset < 0 ? pos + seq[i].scope_pair_offset : pos;
+      for (const VarNode* var : seq[i].touched) {
+        auto [it, inserted] = live_ranges.emplace(var, std::make_pair(begin, pos));
+        if (!inserted) {
+          it->second.first = std::min(it->second.first, begin);
+          it->second.second = pos;
+        }
+      }
+    }
+    AsyncCopyBufferCollector async_collector;
+    async_collector(body);
+
+    std::vector<Placement> placements;
+    for (const auto& [var, range] : live_ranges) {
+      const Buffer& buf = scope.shmem_allocs.at(var);
+      int64_t numel = ConstantAllocationSize(GetBufferAllocationShape(buf));
+      if (numel == 0) return false;
+      int64_t elem_bytes = static_cast<int64_t>(buf->dtype.StorageBytes());
+      int64_t align = elem_bytes;
+      if (buf->data_alignment > 0) {
+        TVM_FFI_ICHECK(buf->data_alignment % elem_bytes == 0)
+            << "The alignment of the buffer is not a multiple of the data type size.";
+        align = buf->data_alignment;
+      }
+      if (async_collector.buffers_.count(var)) {
+        align = std::max(align, async_copy_align_);
+      }
+      placements.push_back({var, numel * elem_bytes, align, range.first, range.second});
+    }
+    std::sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) {
+      return a.bytes != b.bytes ? a.bytes > b.bytes : a.begin < b.begin;
+    });
+
+    auto align_up = [](int64_t value, int64_t align) {
+      return (value + align - 1) / align * align;
+    };
+    int64_t total_bytes = 0;
+    for (size_t i = 0; i < placements.size(); ++i) {
+      Placement& cur = placements[i];
+      std::vector<const Placement*> conflicts;
+      for (size_t j = 0; j < i; ++j) {
+        if (placements[j].begin <= cur.end && cur.begin <= placements[j].end) {
+          conflicts.push_back(&placements[j]);
+        }
+      }
+      std::sort(conflicts.begin(), conflicts.end(),
+                [](const Placement* a, const Placement* b) { return a->offset < b->offset; });
+      int64_t offset = 0;
+      for (const Placement* other : conflicts) {
+        if (offset + cur.bytes <= other->offset) break;
+        offset = std::max(offset, align_up(other->offset + other->bytes, cur.align));
+      }
+      cur.offset = offset;
+      total_bytes = std::max(total_bytes, offset + cur.bytes);
+      scope.buffer_byte_offsets[cur.var] = PrimExpr(static_cast<int>(offset));
+    }
+    scope.merged_alloc_size = PrimExpr(static_cast<int>(total_bytes));
+    return true;
+  }
+
   /*!
    * \brief Allocate new storage entry.
    * \param buf the buffer object
@@ -810,6 +940,10 @@ class SharedMemoryRewriter : public StmtExprMutator {
 
   // Whether enable dynamic analysis.
   bool is_dynamic_{true};
+  // Whether to assign offsets with PackOffsets instead of PlanMemory.
+  bool pack_offsets_{false};
+  // The alignment in bytes of the buffers used by async copies when packing.
+  int64_t async_copy_align_{16};
   // Whether already inside a thread_extent (outermost only).
   bool in_thread_env_{false};
   // Stack of per-kernel-launch scopes. Pushed on thread_extent entry, popped on exit.
@@ -818,14 +952,15 @@ class SharedMemoryRewriter : public StmtExprMutator {
   support::Arena arena_;
 };
 
-Stmt MergeSharedMemoryAllocations(Stmt stmt, bool merge_static_smem) {
+Stmt MergeSharedMemoryAllocations(Stmt stmt, bool merge_static_smem, bool pack_offsets,
+                                  int64_t async_copy_align) {
   // Function-level early-out: skip the rewriter entirely if the PrimFunc
   // has ≤1 dynamic shared-memory allocation (nothing to merge).
   {
     AllocateCollector dyn_probe(/*is_dynamic=*/true);
     dyn_probe(stmt);
     if (dyn_probe.shmem_allocs_.size() > 1) {
-      SharedMemoryRewriter dyn_rewriter(/*is_dynamic=*/true);
+      SharedMemoryRewriter dyn_rewriter(/*is_dynamic=*/true, pack_offsets, async_copy_align);
       stmt = dyn_rewriter(std::move(stmt));
     }
   }
@@ -834,7 +969,7 @@ Stmt MergeSharedMemoryAllocations(Stmt stmt, bool merge_static_smem) {
     AllocateCollector static_probe(/*is_dynamic=*/false);
     static_probe(stmt);
     if (static_probe.shmem_allocs_.size() > 1) {
-      SharedMemoryRewriter static_rewriter(/*is_dynamic=*/false);
+      SharedMemoryRewriter static_rewriter(/*is_dynamic=*/false, pack_offsets, async_copy_align);
       stmt = static_rewriter(std::move(stmt));
     }
   }
@@ -846,8 +981,14 @@ namespace transform {
 Pass MergeSharedMemoryAllocations() {
   auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
     bool merge_static_smem = ctx->GetConfig<bool>("tirx.merge_static_smem", false).value();
+    bool pack_offsets = ctx->GetConfig<bool>("tirx.merge_smem_packing", false).value();
+    int64_t async_copy_align =
+        ctx->GetConfig<int64_t>("tirx.merge_smem_async_copy_align", 16).value();
+    TVM_FFI_CHECK_GT(async_copy_align, 0, ValueError)
+        << "tirx.merge_smem_async_copy_align must be positive";
     auto* n = f.CopyOnWrite();
-    n->body = s_tir::MergeSharedMemoryAllocations(std::move(n->body), merge_static_smem);
+    n->body = s_tir::MergeSharedMemoryAllocations(std::move(n->body), merge_static_smem,
+                                                  pack_offsets, async_copy_align);
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "s_tir.MergeSharedMemoryAllocations", {});
@@ -127,6 +127,22 @@ void StorageAccessVisitor::VisitStmt_(const AttrStmtNode* op) {
       scope_.back().emplace_back(std::move(s));
     }
     double_buffer_write_ = nullptr;
+  } else if (op->attr_key == s_tir::attr::named_barrier_scope) {
+    const AttrStmtNode* outer_scope = named_barrier_scope_;
+    int outer_condition_base = named_barrier_condition_base_;
+    named_barrier_scope_ = op;
+    named_barrier_condition_base_ = condition_counter_;
+    scope_.push_back(std::vector<StmtEntry>());
+    StmtExprVisitor::VisitStmt_(op);
+    StmtEntry s;
+    s.stmt = op;
+    s.access = Summarize(std::move(scope_.back()), nullptr);
+    scope_.pop_back();
+    named_barrier_scope_ = outer_scope;
+    named_barrier_condition_base_ = outer_condition_base;
+    if (!s.access.empty()) {
+      scope_.back().emplace_back(std::move(s));
+    }
   } else if (op->attr_key == tirx::attr::thread_extent) {
     IterVar iv = op->node.as_or_throw<IterVar>();
     env_threads_.push_back(iv);
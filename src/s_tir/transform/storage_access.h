@@ -96,6 +96,10 @@ class StorageAccessVisitor : public StmtExprVisitor {
   StorageAccessVisitor() { scope_.push_back(std::vector<StmtEntry>()); }
   /*! \return number of conditions in the current scope. */
   int condition_counter() const { return condition_counter_; }
+  /*! \return the innermost named barrier scope, nullptr outside of any. */
+  const AttrStmtNode* named_barrier_scope() const { return named_barrier_scope_; }
+  /*! \return number of conditions outside of the innermost named barrier scope. */
+  int named_barrier_condition_base() const { return named_barrier_condition_base_; }
   /*! \return whether we are in device environment. */
   bool in_device_env() const { return in_device_env_; }
   /*! \return environment threads */
@@ -134,6 +138,10 @@ class StorageAccessVisitor : public StmtExprVisitor {
   bool in_device_env_{false};
   // Whether we are inside condition.
   int condition_counter_{0};
+  // The innermost named barrier scope.
+  const AttrStmtNode* named_barrier_scope_{nullptr};
+  // The condition counter at the entry into the innermost named barrier scope.
+  int named_barrier_condition_base_{0};
   // The current double buffer write scope.
   const VarNode* double_buffer_write_{nullptr};
   // the current free stmt entry.
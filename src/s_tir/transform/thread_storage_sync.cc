@@ -20,6 +20,8 @@
 /*!
  * \file thread_storage_sync.cc
  */
+#include <tvm/arith/analyzer.h>
+#include <tvm/arith/pattern.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/s_tir/stmt.h>
@@ -30,6 +32,7 @@
 #include <tvm/tirx/op.h>
 #include <tvm/tirx/stmt_functor.h>
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "../../runtime/thread_storage_scope.h"
@@ -45,6 +48,8 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
 
   // The syncs inserted before each statement
   std::unordered_set<const ffi::Object*> syncs_inserted_;
+  // The named barrier scope of the syncs that only synchronize the threads of the scope
+  std::unordered_map<const ffi::Object*, const AttrStmtNode*> named_barriers_;
 
  protected:
   bool Enabled(const VarNode* buf, const StorageScope& scope) const final {
@@ -115,8 +120,7 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
         }
       }
       if (sync_before_stmt) {
-        TVM_FFI_ICHECK_EQ(condition_counter(), 0) << "Cannot insert syncs inside condition";
-        syncs_inserted_.insert(s.stmt);
+        InsertSync(s.stmt);
       }
     }
     if (loop != nullptr) {
@@ -142,8 +146,7 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
           }
         }
         if (sync_before_stmt) {
-          TVM_FFI_ICHECK_EQ(condition_counter(), 0) << "Cannot insert syncs inside condition";
-          syncs_inserted_.insert(s.stmt);
+          InsertSync(s.stmt);
           break;
         }
       }
@@ -194,6 +197,19 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
   }
 
  private:
+  // Insert a sync before the statement, with a named barrier inside of a named barrier scope.
+  void InsertSync(const ffi::Object* stmt) {
+    const AttrStmtNode* named_barrier =
+        sync_scope_.rank == StorageRank::kShared ? named_barrier_scope() : nullptr;
+    int condition_base = named_barrier != nullptr ? named_barrier_condition_base() : 0;
+    TVM_FFI_ICHECK_EQ(condition_counter(), condition_base)
+        << "Cannot insert syncs inside condition";
+    syncs_inserted_.insert(stmt);
+    if (named_barrier != nullptr) {
+      named_barriers_[stmt] = named_barrier;
+    }
+  }
+
   // find conflicting entry in vec.
   bool FindConflict(const std::vector<AccessEntry>& prev, const AccessEntry& curr,
                     bool loop_carry) {
@@ -250,6 +266,11 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
     if (has_same_index && depends_on_thread_index) {
       return false;
     }
+    // The iterations of the loop carried accesses are unknown, so that the thread index
+    // alone does not tell the touched elements apart.
+    if (!loop_carry && ProveThreadDisjoint(prev, curr)) {
+      return false;
+    }
 
     // If this is a read into a double buffer that was previously
     // swapped out, then it doesn't conflict.
@@ -262,11 +283,66 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
     return true;
   }
 
+  /*!
+   * \brief Prove that no two different threads touch the same element of the accesses.
+   *
+   *  It is the case when an index of both accesses is c * t + b and c * t + b + d for the
+   *  innermost thread index t, a constant c, and a constant d that is not a multiple of c,
+   *  while b depends on no thread index. The buffers of "shared.dyn" share a single buffer
+   *  var, so that their indices are only comparable for the same data type.
+   */
+  bool ProveThreadDisjoint(const AccessEntry& prev, const AccessEntry& curr) {
+    if (curr.threads.empty() || prev.touched.size() != curr.touched.size()) return false;
+    if (curr.scope.tag == ".dyn" ||
+        !prev.dtype.MatchesElementType(curr.dtype.code(), curr.dtype.bits())) {
+      return false;
+    }
+    PrimVar thread_var = curr.threads.back()->var.as_or_throw<PrimVar>();
+    auto f_uses_thread_index = [&](const tvm::tirx::VarNode* var) {
+      for (const IterVar& iv : curr.threads) {
+        if (iv->var.get() == var) return true;
+      }
+      return false;
+    };
+    for (size_t i = 0; i < prev.touched.size(); ++i) {
+      if (!prev.touched[i].IsSinglePoint() || !curr.touched[i].IsSinglePoint()) continue;
+      ffi::Array<PrimExpr> prev_linear =
+          arith::DetectLinearEquation(prev.touched[i].PointValue(), {thread_var});
+      ffi::Array<PrimExpr> curr_linear =
+          arith::DetectLinearEquation(curr.touched[i].PointValue(), {thread_var});
+      if (prev_linear.size() != 2 || curr_linear.size() != 2) continue;
+      if (UsesVar(prev_linear[1], f_uses_thread_index) ||
+          UsesVar(curr_linear[1], f_uses_thread_index)) {
+        continue;
+      }
+      const auto* prev_coeff = analyzer_.Simplify(prev_linear[0]).as<IntImmNode>();
+      const auto* curr_coeff = analyzer_.Simplify(curr_linear[0]).as<IntImmNode>();
+      const auto* offset = analyzer_.Simplify(curr_linear[1] - prev_linear[1]).as<IntImmNode>();
+      if (prev_coeff == nullptr || curr_coeff == nullptr || offset == nullptr) continue;
+      if (prev_coeff->value == curr_coeff->value && prev_coeff->value != 0 &&
+          offset->value % prev_coeff->value != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
  private:
   // synchronization scope
   StorageScope sync_scope_;
+  // analyzer for the affine thread index analysis
+  arith::Analyzer analyzer_;
 };
 
+// Whether the statement is a barrier of the whole block in the sync scope.
+static bool IsStorageSync(const Stmt& stmt, const StorageScope& sync_scope) {
+  const auto* eval = stmt.as<EvaluateNode>();
+  const CallNode* call = eval != nullptr ? eval->value.as<CallNode>() : nullptr;
+  if (call == nullptr || !call->op.same_as(builtin::tvm_storage_sync())) return false;
+  const auto* scope = call->args[0].as<StringImmNode>();
+  return call->args.size() == 1 && scope != nullptr && scope->value == sync_scope.to_string();
+}
+
 // There are cases where necessary syncthreads is not inserted by ThreadSyncInserter.
 // For example, syncthreads is needed after async_wait_queue in the second loop below,
 // but since ThreadSyncInserter is not aware of the asynchronous semantics, it cannot tell
@@ -287,39 +363,64 @@ class ThreadSyncPlanner : public StorageAccessVisitor {
 // This class adds syncthreads after all async_wait_queue. That includes syncthreads that
 // can be inserted by ThreadSyncInserter as well, but ThreadSyncInserter will not insert
 // duplicate syncthreads if it finds an existing one at the synchronization point.
+//
+// No syncthreads is added when the body of the wait starts with a syncthreads already, or
+// with another async_wait_queue, whose syncthreads also orders the writes of the outer one.
 class ThreadSyncAfterWaitQueueInserter : public StmtExprMutator {
  public:
   explicit ThreadSyncAfterWaitQueueInserter(StorageScope sync_scope) : sync_scope_(sync_scope) {}
 
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == s_tir::attr::async_wait_queue_scope) {
-      auto sync = Evaluate(
-          Call(PrimType::Int(32), builtin::tvm_storage_sync(), {StringImm(sync_scope_.to_string())})
-              .as_or_throw<PrimExpr>());
       auto inner = op->body.as<AttrStmtNode>();
       TVM_FFI_ICHECK(inner && inner->attr_key == s_tir::attr::async_wait_inflight_count);
-      auto new_body = SeqStmt({sync, inner->body});
+      Stmt body = VisitStmt(inner->body);
+      if (!IsSyncedOnEntry(body)) {
+        auto sync = Evaluate(Call(PrimType::Int(32), builtin::tvm_storage_sync(),
+                                  {StringImm(sync_scope_.to_string())})
+                                 .as_or_throw<PrimExpr>());
+        body = SeqStmt({sync, body});
+      }
       return AttrStmt(0, s_tir::attr::async_wait_queue_scope, op->value,
-                      AttrStmt(0, s_tir::attr::async_wait_inflight_count, inner->value, new_body));
+                      AttrStmt(0, s_tir::attr::async_wait_inflight_count, inner->value, body));
     }
     return StmtExprMutator::VisitStmt_(op);
   }
 
+ private:
+  bool IsSyncedOnEntry(Stmt stmt) const {
+    while (const auto* seq = stmt.as<SeqStmtNode>()) {
+      if (seq->seq.empty()) return false;
+      stmt = seq->seq[0];
+    }
+    if (const auto* attr = stmt.as<AttrStmtNode>()) {
+      return attr->attr_key == s_tir::attr::async_wait_queue_scope;
+    }
+    return IsStorageSync(stmt, sync_scope_);
+  }
+
  private:
   StorageScope sync_scope_;
 };
 
 class ThreadSyncInserter : public StmtExprMutator {
  public:
-  ThreadSyncInserter(StorageScope sync_scope, const std::unordered_set<const ffi::Object*>& syncs)
-      : sync_scope_(sync_scope), syncs_(syncs) {}
+  ThreadSyncInserter(StorageScope sync_scope, const std::unordered_set<const ffi::Object*>& syncs,
+                     const std::unordered_map<const ffi::Object*, const AttrStmtNode*>& named)
+      : sync_scope_(sync_scope), syncs_(syncs), named_barriers_(named) {}
 
   Stmt VisitStmt(const Stmt& stmt) final {
     if (syncs_.size() == 0) return stmt;
     if (syncs_.count(stmt.get())) {
+      ffi::Array<Expr> args = {StringImm(sync_scope_.to_string())};
+      // A named barrier takes its id and the number of threads that arrive at it.
+      auto it = named_barriers_.find(stmt.get());
+      if (it != named_barriers_.end()) {
+        args.push_back(it->second->node.as_or_throw<PrimExpr>());
+        args.push_back(it->second->value);
+      }
       Stmt barrier = Evaluate(
-          Call(PrimType::Int(32), builtin::tvm_storage_sync(), {StringImm(sync_scope_.to_string())})
-              .as_or_throw<PrimExpr>());
+          Call(PrimType::Int(32), builtin::tvm_storage_sync(), args).as_or_throw<PrimExpr>());
       // Mutate after query, to avoid stmt change.
       auto ret = StmtExprMutator::VisitStmt(stmt);
       ret = SeqStmt({barrier, ret});
@@ -333,6 +434,41 @@ class ThreadSyncInserter : public StmtExprMutator {
   // data structure.
   StorageScope sync_scope_;
   const std::unordered_set<const ffi::Object*>& syncs_;
+  const std::unordered_map<const ffi::Object*, const AttrStmtNode*>& named_barriers_;
+};
+
+// Remove the barriers that directly follow another barrier of the same scope, such as the
+// ones of an async_wait_queue and of the planner, or the ones of the lowered reductions.
+class ThreadSyncMerger : public StmtMutator {
+ public:
+  explicit ThreadSyncMerger(StorageScope sync_scope) : sync_scope_(sync_scope) {}
+
+  Stmt VisitStmt_(const SeqStmtNode* op) final {
+    ffi::Array<Stmt> seq;
+    bool changed = false;
+    for (const Stmt& stmt : op->seq) {
+      Stmt new_stmt = VisitStmt(stmt);
+      changed = changed || !new_stmt.same_as(stmt);
+      if (!seq.empty() && IsStorageSync(new_stmt, sync_scope_) && EndsWithSync(seq.back())) {
+        changed = true;
+        continue;
+      }
+      seq.push_back(new_stmt);
+    }
+    if (!changed) return ffi::GetRef<Stmt>(op);
+    return seq.size() == 1 ? seq[0] : SeqStmt(seq);
+  }
+
+ private:
+  bool EndsWithSync(Stmt stmt) const {
+    while (const auto* seq = stmt.as<SeqStmtNode>()) {
+      if (seq->seq.empty()) return false;
+      stmt = seq->seq.back();
+    }
+    return IsStorageSync(stmt, sync_scope_);
+  }
+
+  StorageScope sync_scope_;
 };
 
 Stmt ThreadSync(Stmt stmt, std::string storage_scope) {
@@ -342,7 +478,9 @@ Stmt ThreadSync(Stmt stmt, std::string storage_scope) {
   }
   ThreadSyncPlanner planner(sync_scope);
   planner(stmt);
-  return ThreadSyncInserter(sync_scope, planner.syncs_inserted_)(std::move(stmt));
+  stmt = ThreadSyncInserter(sync_scope, planner.syncs_inserted_, planner.named_barriers_)(
+      std::move(stmt));
+  return ThreadSyncMerger(sync_scope)(std::move(stmt));
 }
 
 namespace transform {
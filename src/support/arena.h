@@ -67,6 +67,11 @@ struct ArenaPageHeader {
 /*!
  * \brief Arena allocator that allocates memory from continuous
  *  chunk and frees them all only during destruction.
+ *
+ * \note The arena should not back reference counted IR nodes. A node
+ *  created inside a pass may be kept by the IRModule the pass returns, or
+ *  by caches that outlive it, so its memory cannot be freed in bulk when
+ *  the pass ends.
  */
 template <typename PageAllocator>
 class GenericArena {
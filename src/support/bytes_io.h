@@ -66,6 +66,16 @@ class BytesInStream : public Stream {
     return 0;
   }
 
+  /*! \brief The offset of the next byte to read. */
+  size_t Tell() const { return pos_; }
+
+  /*! \brief Skip over the next bytes, and return the number of bytes skipped. */
+  size_t Skip(size_t size) {
+    size_t nskip = std::min(size_ - pos_, size);
+    pos_ += nskip;
+    return nskip;
+  }
+
  private:
   const char* data_;
   size_t size_;
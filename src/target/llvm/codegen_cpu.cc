@@ -488,6 +488,8 @@ void CodeGenCPU::InitGlobalContext(bool dynamic_lookup) {
       // Mark as context functions
       gv_func_map_["TVMBackendAllocWorkspace"] = nullptr;
       gv_func_map_["TVMBackendFreeWorkspace"] = nullptr;
+      gv_func_map_["TVMBackendProfileStart"] = nullptr;
+      gv_func_map_["TVMBackendProfileEnd"] = nullptr;
     }
   }
 }
@@ -1022,6 +1024,13 @@ llvm::Value* CodeGenCPU::CreateIntrinsic(const CallNode* op) {
     return CreateCallPacked(op);
   } else if (op->op.same_as(builtin::tvm_static_handle())) {
     return CreateStaticHandle();
+  } else if (op->op.same_as(builtin::function_address())) {
+    TVM_FFI_ICHECK_EQ(args.size(), 1U);
+    ffi::String symbol = args[0].as_or_throw<StringImm>()->value;
+    llvm::Function* function = module_->getFunction(MakeStringRef(symbol));
+    TVM_FFI_ICHECK(function != nullptr)
+        << "Cannot take the address of function " << symbol << ", which is not in the module";
+    return builder_->CreatePointerCast(function, t_void_p_);
   } else if (op->op.same_as(builtin::tvm_throw_last_error())) {
     builder_->CreateRet(ConstInt32(-1));
     auto next_block = std::next(builder_->GetInsertBlock()->getIterator());
@@ -1100,6 +1109,14 @@ llvm::Value* CodeGenCPU::CreateIntrinsic(const CallNode* op) {
         TVM_FFI_THROW(InternalError) << "Unknown stack alloca type " << type;
       }
     });
+  } else if (op->op.same_as(builtin::start_profile_intrinsic()) ||
+             op->op.same_as(builtin::end_profile_intrinsic())) {
+    // The runtime keys the measurements by the enclosing function and the region id.
+    ffi::String symbol = op->op.same_as(builtin::start_profile_intrinsic())
+                             ? "TVMBackendProfileStart"
+                             : "TVMBackendProfileEnd";
+    ffi::Array<Expr> call_args = {StringImm(function_->getName().str()), args[0]};
+    return CreateCallExtern(PrimType::Int(32), symbol, call_args, /*skip_first_arg=*/false);
   } else {
     return CodeGenLLVM::CreateIntrinsic(op);
   }
@@ -23,15 +23,19 @@
  */
 #ifdef TVM_LLVM_VERSION
 
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/IntrinsicsX86.h>
 #include <llvm/Support/Casting.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 
+#include <array>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "codegen_cpu.h"
@@ -44,11 +48,45 @@ class CodeGenX86_64 final : public CodeGenCPU {
  public:
   llvm::Value* VisitExpr_(const CastNode* op) override;
 
+ protected:
+  llvm::Value* CreateIntrinsic(const CallNode* op) override;
+
  private:
   llvm::Value* CallVectorIntrin(llvm::Intrinsic::ID id, size_t intrin_lanes, llvm::Type* result_ty,
                                 const std::vector<llvm::Value*>& args);
+  /*!
+   * \brief Load the AMX tile configuration at the entry of the current function, once.
+   *  The AMX tensor intrinsics address tiles by number and expect every tile to hold
+   *  16 rows of 64 bytes, so a single palette serves all of them.
+   */
+  void ConfigureAMXTiles();
+
+  /*! \brief The functions whose entry already loads the AMX tile configuration. */
+  std::unordered_set<llvm::Function*> amx_configured_functions_;
+  /*! \brief The constant AMX tile configuration of the module. */
+  llvm::GlobalVariable* amx_tile_config_{nullptr};
 };
 
+#if TVM_LLVM_VERSION >= 120
+/*! \brief Whether the intrinsic reads or writes the AMX tile registers. */
+bool IsAMXTileIntrinsic(llvm::Intrinsic::ID id) {
+  switch (id) {
+    case llvm::Intrinsic::x86_tileloadd64:
+    case llvm::Intrinsic::x86_tileloaddt164:
+    case llvm::Intrinsic::x86_tilestored64:
+    case llvm::Intrinsic::x86_tilezero:
+    case llvm::Intrinsic::x86_tdpbssd:
+    case llvm::Intrinsic::x86_tdpbsud:
+    case llvm::Intrinsic::x86_tdpbusd:
+    case llvm::Intrinsic::x86_tdpbuud:
+    case llvm::Intrinsic::x86_tdpbf16ps:
+      return true;
+    default:
+      return false;
+  }
+}
+#endif
+
 llvm::Value* CodeGenX86_64::VisitExpr_(const CastNode* op) {
   // LLVM does not automatically generate the correct instruction sequences for
   // half -> float conversion (i.e. using AVX2/AVX-512 vectorized variants of
@@ -113,6 +151,49 @@ llvm::Value* CodeGenX86_64::CallVectorIntrin(llvm::Intrinsic::ID id, size_t intr
   return CreateVecSlice(CreateVecConcat(split_results), 0, num_elems);
 }
 
+llvm::Value* CodeGenX86_64::CreateIntrinsic(const CallNode* op) {
+#if TVM_LLVM_VERSION >= 120
+  if (op->op.same_as(builtin_call_llvm_intrin_) || op->op.same_as(builtin_call_llvm_pure_intrin_)) {
+    auto id = static_cast<llvm::Intrinsic::ID>(op->args[0].as_or_throw<IntImm>()->value);
+    if (id == llvm::Intrinsic::x86_ldtilecfg) {
+      // The function manages its own tile configuration.
+      amx_configured_functions_.insert(function_);
+    } else if (IsAMXTileIntrinsic(id)) {
+      ConfigureAMXTiles();
+    }
+  }
+#endif
+  return CodeGenCPU::CreateIntrinsic(op);
+}
+
+void CodeGenX86_64::ConfigureAMXTiles() {
+#if TVM_LLVM_VERSION >= 120
+  if (!amx_configured_functions_.insert(function_).second) return;
+  if (amx_tile_config_ == nullptr || amx_tile_config_->getParent() != module_.get()) {
+    // The 64 byte tileconfig: palette 1, then the bytes per row of each tile as uint16 from
+    // offset 16, then the rows of each tile from offset 48.
+    std::array<uint8_t, 64> config{};
+    config[0] = 1;
+    for (int i = 0; i < 8; ++i) {
+      config[16 + 2 * i] = 64;
+      config[48 + i] = 16;
+    }
+    llvm::Constant* init = llvm::ConstantDataArray::get(*llvm_target_->GetContext(), config);
+    amx_tile_config_ =
+        new llvm::GlobalVariable(*module_, init->getType(), /*isConstant=*/true,
+                                 llvm::GlobalValue::PrivateLinkage, init, "__tvm_amx_tile_config");
+    amx_tile_config_->setAlignment(llvm::Align(64));
+  }
+  // Loading the configuration zeroes the tiles, so it happens once before any tile is used.
+  llvm::BasicBlock* current = builder_->GetInsertBlock();
+  llvm::BasicBlock* entry = &(function_->getEntryBlock());
+  builder_->SetInsertPoint(entry, entry->getFirstInsertionPt());
+  builder_->CreateCall(GetIntrinsicDecl(llvm::Intrinsic::x86_ldtilecfg, t_void_, {t_void_p_}),
+                       {amx_tile_config_});
+  builder_->SetInsertPoint(current);
+#endif
+}
+
 TVM_FFI_STATIC_INIT_BLOCK() {
   namespace refl = tvm::ffi::reflection;
   refl::GlobalDef().def_packed("tvm.codegen.llvm.target_x86-64",
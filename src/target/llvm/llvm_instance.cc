@@ -52,6 +52,7 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/target/target.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cctype>
 #include <memory>
@@ -60,6 +61,7 @@
 #include <sstream>
 #include <string>
 #include <system_error>
+#include <unordered_map>
 #include <utility>
 
 #if TVM_LLVM_VERSION < 180
@@ -308,6 +310,15 @@ LLVMTargetInfo::LLVMTargetInfo(LLVMInstance& instance,
     }
   }
 
+  // WebAssembly SIMD is supported by every major browser and by node, so the wasm targets
+  // vectorize to 128-bit lanes unless the attributes mention simd128 (e.g. "-simd128").
+  if (llvm::Triple(triple_).isWasm() &&
+      std::none_of(attrs_.begin(), attrs_.end(), [](const std::string& attr) {
+        return attr.find("simd128") != std::string::npos;
+      })) {
+    attrs_.push_back("+simd128");
+  }
+
   // Target options
   // In clang, these are fed from LangOpts which describe language specific features
   // TODO(AndrewZhaoLuo): figure out how these relate to fast math flags
@@ -435,6 +446,28 @@ static std::unique_ptr<llvm::TargetMachine> CreateLLVMTargetMachine(
 llvm::TargetMachine* LLVMTargetInfo::GetOrCreateTargetMachine(bool allow_missing) {
   if (target_machine_) return target_machine_.get();
 
+  // Creating the TargetMachine dominates the setup of small builds, such as
+  // the candidates of tuning, so each thread keeps the machines it created
+  // for the configurations it saw.  A TargetMachine does not depend on the
+  // LLVMContext, and a cached one is only used by the thread that owns it.
+  // The targets with command line options are not cached, because these
+  // options are global state that the key does not capture.
+  constexpr size_t kMaxCachedTargetMachines = 16;
+  thread_local std::unordered_map<std::string, std::shared_ptr<llvm::TargetMachine>> cache;
+  std::string key;
+  if (llvm_options_.empty()) {
+    std::ostringstream os;
+    os << triple_ << '|' << cpu_ << '|' << GetTargetFeatureString() << '|'
+       << static_cast<int>(target_options_.FloatABIType) << '|'
+       << target_options_.MCOptions.ABIName << '|' << static_cast<int>(reloc_model_) << '|'
+       << static_cast<int>(code_model_) << '|' << static_cast<int>(opt_level_);
+    key = os.str();
+    if (auto it = cache.find(key); it != cache.end()) {
+      target_machine_ = it->second;
+      return target_machine_.get();
+    }
+  }
+
   std::string error;
   if (const llvm::Target* llvm_instance = CreateLLVMTargetInstance(triple_, allow_missing)) {
     target_machine_ =
@@ -442,9 +475,19 @@ llvm::TargetMachine* LLVMTargetInfo::GetOrCreateTargetMachine(bool allow_missing
                                 target_options_, reloc_model_, code_model_, opt_level_);
   }
   TVM_FFI_ICHECK(target_machine_ != nullptr);
+  if (!key.empty()) {
+    if (cache.size() >= kMaxCachedTargetMachines) cache.clear();
+    cache.emplace(std::move(key), target_machine_);
+  }
   return target_machine_.get();
 }
 
+std::unique_ptr<llvm::TargetMachine> LLVMTargetInfo::CreateTargetMachine() const {
+  const llvm::Target* llvm_instance = CreateLLVMTargetInstance(triple_, false);
+  return CreateLLVMTargetMachine(llvm_instance, triple_, cpu_, GetTargetFeatureString(),
+                                 target_options_, reloc_model_, code_model_, opt_level_);
+}
+
 bool LLVMTargetInfo::IsValidCPU(const std::string& cpu) const {
   auto llvm_instance = CreateLLVMTargetInstance(triple_, true);
   if (!llvm_instance) return false;
@@ -195,6 +195,15 @@ class LLVMTargetInfo {
    */
   llvm::TargetMachine* GetOrCreateTargetMachine(bool allow_missing = false);
 
+  /*!
+   * \brief Create a new LLVM `TargetMachine` with the configuration of this target
+   * \return The new `TargetMachine`, owned by the caller
+   *
+   * Unlike `GetOrCreateTargetMachine`, the result is not shared, so it can
+   * be used on another thread, e.g. to emit a part of a module in parallel.
+   */
+  std::unique_ptr<llvm::TargetMachine> CreateTargetMachine() const;
+
   /*!
    * \brief Get the target triple
    * \return the target triple
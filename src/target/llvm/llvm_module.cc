@@ -24,10 +24,13 @@
 #ifdef TVM_LLVM_VERSION
 
 #include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/CodeGen/ParallelCG.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
 #include <tvm/ffi/reflection/registry.h>
@@ -38,6 +41,7 @@
 #endif
 #include <llvm/IR/DataLayout.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/LegacyPassManager.h>
@@ -45,7 +49,11 @@
 #include <llvm/IR/Metadata.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/MC/MCSubtargetInfo.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/xxhash.h>
 #if TVM_LLVM_VERSION >= 180
 #include <llvm/TargetParser/Host.h>
 #else
@@ -62,12 +70,14 @@
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/string.h>
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/ir/with_context.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/target/codegen.h>
 #include <tvm/target/target.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -76,6 +86,7 @@
 #include <utility>
 #include <vector>
 
+#include "../../runtime/cpu_features.h"
 #include "../../runtime/file_utils.h"
 #include "codegen_blob.h"
 #include "codegen_cpu.h"
@@ -89,6 +100,103 @@ using ffi::Any;
 using ffi::Function;
 using ffi::PackedArgs;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.num_object_shards", int64_t);
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.orcjit_lazy", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.orcjit_cache_dir", ffi::String);
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.isa_variants", ffi::Array<ffi::String>);
+
+namespace {
+/*! \brief The file of the i-th object shard, e.g. lib0.o, lib0.shard1.o, lib0.shard2.o. */
+std::string ObjectShardFileName(const std::string& file_name, int index) {
+  if (index == 0) return file_name;
+  size_t dot = file_name.rfind('.');
+  size_t slash = file_name.find_last_of("/\\");
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    dot = file_name.size();
+  }
+  return file_name.substr(0, dot) + ".shard" + std::to_string(index) + file_name.substr(dot);
+}
+
+/*! \brief Hide a function that the dispatcher of its exported symbol calls. */
+void MakeInternal(llvm::Function* func) {
+  func->setLinkage(llvm::GlobalValue::InternalLinkage);
+  func->setVisibility(llvm::GlobalValue::DefaultVisibility);
+  func->setDLLStorageClass(llvm::GlobalValue::DefaultStorageClass);
+}
+
+/*! \brief A private constant array of pointers to the strings. */
+llvm::Constant* CreateStringTable(llvm::Module* module, const std::vector<std::string>& strs,
+                                  const std::string& name) {
+  llvm::LLVMContext& ctx = module->getContext();
+  llvm::Type* t_char_p = llvmGetPointerTo(llvm::Type::getInt8Ty(ctx), 0);
+  std::vector<llvm::Constant*> elems;
+  for (const std::string& str : strs) {
+    llvm::Constant* init = llvm::ConstantDataArray::getString(ctx, str);
+    auto* gv = new llvm::GlobalVariable(*module, init->getType(), true,
+                                        llvm::GlobalValue::PrivateLinkage, init, name + ".str");
+    elems.push_back(llvm::ConstantExpr::getPointerCast(gv, t_char_p));
+  }
+  llvm::ArrayType* table_ty = llvm::ArrayType::get(t_char_p, elems.size());
+  auto* table =
+      new llvm::GlobalVariable(*module, table_ty, true, llvm::GlobalValue::PrivateLinkage,
+                               llvm::ConstantArray::get(table_ty, elems), name);
+  return llvm::ConstantExpr::getPointerCast(table, llvmGetPointerTo(t_char_p, 0));
+}
+
+/*!
+ * \brief An object cache of ORCJIT that keeps the compiled objects in a directory.
+ *
+ * An entry is keyed by the bitcode of the module being compiled together with the
+ * target it is compiled for, so that a process which JITs the same functions again
+ * skips the code generation.
+ */
+class LLVMObjectCache : public llvm::ObjectCache {
+ public:
+  LLVMObjectCache(std::string cache_dir, std::string target_key)
+      : cache_dir_(std::move(cache_dir)), target_key_(std::move(target_key)) {}
+
+  void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj) final {
+    std::string path = EntryPath(*module);
+    // Write to a temporary file first so that a concurrent reader never sees a partial entry.
+    std::string tmp_path = path + ".tmp" + std::to_string(reinterpret_cast<uintptr_t>(this));
+    std::error_code ecode;
+    llvm::raw_fd_ostream dest(tmp_path, ecode, llvm::sys::fs::OF_None);
+    if (ecode) return;
+    dest << obj.getBuffer();
+    dest.close();
+    if (dest.has_error() || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      dest.clear_error();
+      std::remove(tmp_path.c_str());
+    }
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) final {
+    auto buffer = llvm::MemoryBuffer::getFile(EntryPath(*module));
+    if (!buffer) return nullptr;
+    return std::move(buffer.get());
+  }
+
+ private:
+  std::string EntryPath(const llvm::Module& module) const {
+    std::string bitcode = target_key_;
+    llvm::raw_string_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(module, os);
+    os.flush();
+#if TVM_LLVM_VERSION >= 170
+    uint64_t key = llvm::xxh3_64bits(llvm::arrayRefFromStringRef(bitcode));
+#else
+    uint64_t key = llvm::xxHash64(bitcode);
+#endif
+    return cache_dir_ + "/" + llvm::utohexstr(key) + ".o";
+  }
+
+  /*! \brief The directory of the cache entries. */
+  std::string cache_dir_;
+  /*! \brief The triple, cpu and features the objects are compiled for. */
+  std::string target_key_;
+};
+}  // namespace
+
 class LLVMModuleNode final : public ffi::ModuleObj {
  public:
   ~LLVMModuleNode();
@@ -119,6 +227,16 @@ class LLVMModuleNode final : public ffi::ModuleObj {
   void InitMCJIT();
   void InitORCJIT();
   bool IsCompatibleWithHost(const llvm::TargetMachine* tm) const;
+  /*! \brief The number of object files the module is emitted into. */
+  int NumObjectShards() const;
+  /*! \brief Emit the object files of the module in parallel. */
+  void WriteObjectShards(const std::string& file_name) const;
+  /*!
+   * \brief Build the functions once more for each CPU of `codegen.llvm.isa_variants`, and turn
+   *  each exported symbol into a dispatcher that calls the variant the host supports.
+   */
+  void AddISAVariants(const IRModule& mod, const Target& target,
+                      const ffi::Array<ffi::String>& cpus);
   void* GetGlobalAddr(const std::string& name, const LLVMTarget& llvm_target) const;
   void* GetFunctionAddr(const std::string& name, const LLVMTarget& llvm_target) const;
 
@@ -137,6 +255,14 @@ class LLVMModuleNode final : public ffi::ModuleObj {
   /* \brief names of the external functions declared in this module */
   ffi::Array<ffi::String> function_names_;
   std::string jit_engine_;
+  /* \brief the requested number of object files, from `codegen.llvm.num_object_shards` */
+  int num_object_shards_{1};
+  /* \brief whether ORCJIT compiles a function on its first call, from `codegen.llvm.orcjit_lazy` */
+  bool orcjit_lazy_{false};
+  /* \brief the object cache directory of ORCJIT, from `codegen.llvm.orcjit_cache_dir` */
+  std::string orcjit_cache_dir_;
+  /* \brief the object cache used by the ORCJIT compiler, if any */
+  std::unique_ptr<llvm::ObjectCache> orcjit_object_cache_;
 };
 
 LLVMModuleNode::~LLVMModuleNode() {
@@ -152,6 +278,7 @@ LLVMModuleNode::~LLVMModuleNode() {
     TVM_FFI_ICHECK(!err) << llvm::toString(std::move(err));
     orcjit_ee_.reset();
   }
+  orcjit_object_cache_.reset();
   module_owning_ptr_.reset();
 }
 
@@ -172,6 +299,14 @@ ffi::Optional<ffi::Function> LLVMModuleNode::GetFunction(const ffi::String& name
   } else if (name == "get_func_names") {
     return ffi::Function(
         [sptr_to_self, this](ffi::PackedArgs args, ffi::Any* rv) { *rv = this->function_names_; });
+  } else if (name == "get_object_shard_files") {
+    return ffi::Function::FromTyped([sptr_to_self, this](const ffi::String& file_name) {
+      ffi::Array<ffi::String> shard_files;
+      for (int i = 1; i < NumObjectShards(); ++i) {
+        shard_files.push_back(ObjectShardFileName(file_name, i));
+      }
+      return shard_files;
+    });
   } else if (name == "get_symbol") {
     return std::nullopt;
   } else if (name == "get_const_vars") {
@@ -226,6 +361,10 @@ void LLVMModuleNode::WriteToFile(const ffi::String& file_name_str,
   // TVM_FFI_ICHECK(imports_.empty()) << "SaveToFile does not handle imported modules";
   std::string file_name = file_name_str;
   std::string fmt = runtime::GetFileFormat(file_name, format);
+  if ((fmt == "o" || fmt == "obj") && NumObjectShards() > 1) {
+    WriteObjectShards(file_name);
+    return;
+  }
   std::error_code ecode;
   llvm::raw_fd_ostream dest(file_name, ecode, llvm_open_output_flag);
   TVM_FFI_ICHECK_EQ(ecode.value(), 0)
@@ -254,6 +393,49 @@ void LLVMModuleNode::WriteToFile(const ffi::String& file_name_str,
   dest.close();
 }
 
+int LLVMModuleNode::NumObjectShards() const {
+  // A system library registers its functions in a global constructor, which must stay
+  // in a single object.
+  if (num_object_shards_ <= 1 || module_->getNamedGlobal("llvm.global_ctors") != nullptr) {
+    return 1;
+  }
+  return num_object_shards_;
+}
+
+void LLVMModuleNode::WriteObjectShards(const std::string& file_name) const {
+  int num_shards = NumObjectShards();
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> streams;
+  std::vector<llvm::raw_pwrite_stream*> outputs;
+  for (int i = 0; i < num_shards; ++i) {
+    std::string shard_file_name = ObjectShardFileName(file_name, i);
+    std::error_code ecode;
+    streams.push_back(
+        std::make_unique<llvm::raw_fd_ostream>(shard_file_name, ecode, llvm_open_output_flag));
+    TVM_FFI_ICHECK_EQ(ecode.value(), 0)
+        << "Cannot open file: " << shard_file_name << " " << ecode.message();
+    outputs.push_back(streams.back().get());
+  }
+
+  With<LLVMTarget> llvm_target(*llvm_instance_, LLVMTarget::GetTargetMetadata(*module_));
+  std::unique_ptr<llvm::Module> module = CloneLLVMModule(module_);
+  // The context pointers such as __tvm_ffi__library_ctx are link-once definitions, which
+  // the shards that only refer to them could discard. Keep exactly one definition of each.
+  for (llvm::GlobalVariable& gv : module->globals()) {
+    if (gv.hasLinkOnceODRLinkage()) {
+      gv.setLinkage(llvm::GlobalValue::WeakODRLinkage);
+    } else if (gv.hasLinkOnceLinkage()) {
+      gv.setLinkage(llvm::GlobalValue::WeakAnyLinkage);
+    }
+  }
+  // The module is split so that the shards refer to each other through external symbols,
+  // with the local constants they share promoted to hidden globals. Each shard is
+  // emitted in its own LLVM context on a thread of its own.
+  const LLVMTarget* target = llvm_target.get();
+  llvm::splitCodeGen(
+      *module, outputs, {}, [target]() { return target->CreateTargetMachine(); },
+      llvm_object_file_target);
+}
+
 ffi::Bytes LLVMModuleNode::SaveToBytes() const {
   TVM_FFI_THROW(InternalError) << "LLVMModule: SaveToBytes not supported";
 }
@@ -334,7 +516,26 @@ void LLVMModuleNode::Init(const IRModule& mod, const Target& target) {
 
   module_owning_ptr_ = cg->Finish();
   module_ = module_owning_ptr_.get();
+  ffi::Array<ffi::String> isa_variants =
+      transform::PassContext::Current()
+          ->GetConfig<ffi::Array<ffi::String>>("codegen.llvm.isa_variants",
+                                               ffi::Array<ffi::String>())
+          .value();
+  if (!isa_variants.empty()) {
+    TVM_FFI_CHECK(!system_lib_prefix.has_value(), ValueError)
+        << "codegen.llvm.isa_variants is not supported for a system library";
+    AddISAVariants(mod, target, isa_variants);
+  }
   jit_engine_ = llvm_target->GetJITEngine();
+  num_object_shards_ = static_cast<int>(
+      transform::PassContext::Current()
+          ->GetConfig<int64_t>("codegen.llvm.num_object_shards", 1)
+          .value());
+  orcjit_lazy_ =
+      transform::PassContext::Current()->GetConfig<bool>("codegen.llvm.orcjit_lazy", false).value();
+  orcjit_cache_dir_ = transform::PassContext::Current()
+                          ->GetConfig<ffi::String>("codegen.llvm.orcjit_cache_dir", "")
+                          .value();
   llvm_target->SetTargetMetadata(module_);
   module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
                          llvm::DEBUG_METADATA_VERSION);
@@ -349,6 +550,154 @@ void LLVMModuleNode::Init(const IRModule& mod, const Target& target) {
                          tm->getTargetTriple().isOSDarwin() ? 2 : 4);
 }
 
+void LLVMModuleNode::AddISAVariants(const IRModule& mod, const Target& target,
+                                    const ffi::Array<ffi::String>& cpus) {
+  llvm::LLVMContext& ctx = module_->getContext();
+  std::vector<std::string> symbols;
+  for (const llvm::Function& func : module_->functions()) {
+    if (!func.isDeclaration() && func.hasExternalLinkage() &&
+        std::find(function_names_.begin(), function_names_.end(), func.getName().str()) !=
+            function_names_.end()) {
+      symbols.push_back(func.getName().str());
+    }
+  }
+  // Step 1. Build every variant in a module of its own, each exported function renamed with
+  // the CPU as suffix, and link it into the base module.
+  std::vector<std::string> names;
+  std::vector<std::string> features;
+  for (const ffi::String& cpu : cpus) {
+    ffi::Map<ffi::String, ffi::Any> config = target->ToConfig();
+    config.Set("mcpu", cpu);
+    LLVMTargetInfo target_info(*llvm_instance_, config);
+    TVM_FFI_CHECK(target_info.IsValidCPU(cpu), ValueError)
+        << "Unknown CPU " << cpu << " in codegen.llvm.isa_variants for "
+        << target_info.GetTargetTriple();
+    With<LLVMTarget> variant_target(*llvm_instance_, target_info);
+    std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(variant_target.get());
+    cg->Init("TVMMod", variant_target.get(), std::nullopt, false, false);
+    cg->SetFastMathFlags(variant_target->GetFastMathFlags());
+    cg->AddFunctionsOrdered(mod->functions.begin(), mod->functions.end());
+    std::unique_ptr<llvm::Module> variant = cg->Finish();
+    std::string suffix = ".isa." + std::string(cpu);
+    for (const std::string& symbol : symbols) {
+      if (llvm::Function* func = variant->getFunction(symbol)) func->setName(symbol + suffix);
+    }
+    TVM_FFI_ICHECK(!llvm::Linker::linkModules(*module_, std::move(variant)))
+        << "Failed to link the " << cpu << " variant";
+    // The features the host must support to run the variant.
+    const llvm::MCSubtargetInfo* sti =
+        variant_target->GetOrCreateTargetMachine()->getMCSubtargetInfo();
+    std::string required;
+    for (const llvm::SubtargetFeatureKV& kv : sti->getAllProcessorFeatures()) {
+      if (sti->getFeatureBits()[kv.Value] && runtime::IsDetectableCPUFeature(kv.Key)) {
+        required += (required.empty() ? "" : ",") + std::string(kv.Key);
+      }
+    }
+    names.push_back(cpu);
+    features.push_back(required);
+  }
+  // Step 2. Each exported symbol loads the chosen variant on its first call, through
+  // TVMBackendSelectISAVariant, and tail calls it.
+  llvm::Type* t_int = llvm::Type::getInt32Ty(ctx);
+  llvm::Type* t_char_pp = llvmGetPointerTo(llvmGetPointerTo(llvm::Type::getInt8Ty(ctx), 0), 0);
+  llvm::FunctionType* ftype_select =
+      llvm::FunctionType::get(t_int, {t_int, t_char_pp, t_char_pp}, false);
+  llvm::PointerType* t_select_p = llvmGetPointerTo(ftype_select, 0);
+  const llvm::DataLayout& layout = module_->getDataLayout();
+  llvm::Align ptr_align(layout.getPointerABIAlignment(0));
+  // The context pointer, set when the module is loaded as for the other backend functions.
+  std::string select_symbol = "__TVMBackendSelectISAVariant";
+  auto* gv_select = new llvm::GlobalVariable(
+      *module_, t_select_p, false, llvm::GlobalValue::LinkOnceAnyLinkage,
+      llvm::Constant::getNullValue(t_select_p), select_symbol);
+  gv_select->setAlignment(ptr_align);
+  gv_select->setDLLStorageClass(llvm::GlobalValue::DLLStorageClassTypes::DLLExportStorageClass);
+  if (llvm::Triple(module_->getTargetTriple()).isOSWindows()) {
+    llvm::Comdat* comdat = module_->getOrInsertComdat(select_symbol);
+    comdat->setSelectionKind(llvm::Comdat::Any);
+    gv_select->setComdat(comdat);
+  }
+  llvm::Constant* name_table = CreateStringTable(module_, names, ".tvm_isa_names");
+  llvm::Constant* feature_table = CreateStringTable(module_, features, ".tvm_isa_features");
+
+  for (const std::string& symbol : symbols) {
+    llvm::Function* base = module_->getFunction(symbol);
+    base->setName(symbol + ".isa.default");
+    llvm::FunctionType* ftype = base->getFunctionType();
+    llvm::PointerType* t_func_p = llvmGetPointerTo(ftype, 0);
+    llvm::Function* dispatch =
+        llvm::Function::Create(ftype, llvm::Function::ExternalLinkage, symbol, module_);
+    dispatch->copyAttributesFrom(base);
+    // The callers in the module, such as the main wrapper, go through the dispatcher.
+    base->replaceAllUsesWith(dispatch);
+    // The implementations in the order of the selected index plus one.
+    std::vector<llvm::Constant*> impls = {llvm::ConstantExpr::getPointerCast(base, t_func_p)};
+    MakeInternal(base);
+    for (const std::string& name : names) {
+      llvm::Function* variant = module_->getFunction(symbol + ".isa." + name);
+      TVM_FFI_ICHECK(variant != nullptr) << "The " << name << " variant of " << symbol
+                                         << " is missing";
+      MakeInternal(variant);
+      impls.push_back(llvm::ConstantExpr::getPointerCast(variant, t_func_p));
+    }
+    llvm::ArrayType* impl_table_ty = llvm::ArrayType::get(t_func_p, impls.size());
+    auto* impl_table = new llvm::GlobalVariable(
+        *module_, impl_table_ty, true, llvm::GlobalValue::PrivateLinkage,
+        llvm::ConstantArray::get(impl_table_ty, impls), symbol + ".isa.table");
+    auto* slot =
+        new llvm::GlobalVariable(*module_, t_func_p, false, llvm::GlobalValue::InternalLinkage,
+                                 llvm::Constant::getNullValue(t_func_p), symbol + ".isa.slot");
+    slot->setAlignment(ptr_align);
+
+    llvm::IRBuilder<> builder(ctx);
+    auto* entry_block = llvm::BasicBlock::Create(ctx, "entry", dispatch);
+    auto* resolve_block = llvm::BasicBlock::Create(ctx, "resolve", dispatch);
+    auto* select_block = llvm::BasicBlock::Create(ctx, "select", dispatch);
+    auto* pick_block = llvm::BasicBlock::Create(ctx, "pick", dispatch);
+    auto* call_block = llvm::BasicBlock::Create(ctx, "call", dispatch);
+    builder.SetInsertPoint(entry_block);
+    llvm::LoadInst* cached = builder.CreateAlignedLoad(t_func_p, slot, ptr_align);
+    cached->setAtomic(llvm::AtomicOrdering::Monotonic);
+    builder.CreateCondBr(builder.CreateIsNull(cached), resolve_block, call_block);
+    // A runtime without TVMBackendSelectISAVariant runs the base build.
+    builder.SetInsertPoint(resolve_block);
+    llvm::LoadInst* fselect = builder.CreateAlignedLoad(t_select_p, gv_select, ptr_align);
+    builder.CreateCondBr(builder.CreateIsNull(fselect), pick_block, select_block);
+    builder.SetInsertPoint(select_block);
+    llvm::Value* selected = builder.CreateCall(
+        ftype_select, fselect,
+        {llvm::ConstantInt::get(t_int, names.size()), name_table, feature_table});
+    builder.CreateBr(pick_block);
+    builder.SetInsertPoint(pick_block);
+    llvm::PHINode* index = builder.CreatePHI(t_int, 2);
+    index->addIncoming(llvm::ConstantInt::get(t_int, -1, true), resolve_block);
+    index->addIncoming(selected, select_block);
+    llvm::Value* position = builder.CreateAdd(index, llvm::ConstantInt::get(t_int, 1));
+    llvm::Value* impl_ptr = builder.CreateInBoundsGEP(
+        impl_table_ty, impl_table, {llvm::ConstantInt::get(t_int, 0), position});
+    llvm::LoadInst* resolved = builder.CreateAlignedLoad(t_func_p, impl_ptr, ptr_align);
+    llvm::StoreInst* store = builder.CreateAlignedStore(resolved, slot, ptr_align);
+    store->setAtomic(llvm::AtomicOrdering::Monotonic);
+    builder.CreateBr(call_block);
+    builder.SetInsertPoint(call_block);
+    llvm::PHINode* impl = builder.CreatePHI(t_func_p, 2);
+    impl->addIncoming(cached, entry_block);
+    impl->addIncoming(resolved, pick_block);
+    std::vector<llvm::Value*> args;
+    for (llvm::Argument& arg : dispatch->args()) {
+      args.push_back(&arg);
+    }
+    llvm::CallInst* call = builder.CreateCall(ftype, impl, args);
+    call->setTailCall();
+    call->setCallingConv(base->getCallingConv());
+    if (ftype->getReturnType()->isVoidTy()) {
+      builder.CreateRetVoid();
+    } else {
+      builder.CreateRet(call);
+    }
+  }
+}
+
 void LLVMModuleNode::Init(std::unique_ptr<llvm::Module> module,
                           std::unique_ptr<LLVMInstance> llvm_instance) {
   module_owning_ptr_ = std::move(module);
@@ -476,10 +825,21 @@ void LLVMModuleNode::InitORCJIT() {
       << module_->getDataLayout().getStringRepresentation() << ")"
       << " and ExecutionEngine (" << layout.getStringRepresentation() << ")";
 
+  // object cache
+  if (!orcjit_cache_dir_.empty()) {
+    std::error_code ecode = llvm::sys::fs::create_directories(orcjit_cache_dir_);
+    TVM_FFI_ICHECK(!ecode) << "Cannot create the ORCJIT cache directory " << orcjit_cache_dir_
+                           << ": " << ecode.message();
+    orcjit_object_cache_ = std::make_unique<LLVMObjectCache>(
+        orcjit_cache_dir_, llvm_target->GetTargetTriple() + ";" + llvm_target->GetCPU() + ";" +
+                               llvm_target->GetTargetFeatureString());
+  }
+
   // compiler
   const auto compilerBuilder = [&](const llvm::orc::JITTargetMachineBuilder&)
       -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
-    return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(tm));
+    return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(tm),
+                                                               orcjit_object_cache_.get());
   };
 
   // linker
@@ -519,12 +879,25 @@ void LLVMModuleNode::InitORCJIT() {
 #endif
   };  // NOLINT(readability/braces)
 
-  // create LLJIT
-  orcjit_ee_ = llvm::cantFail(llvm::orc::LLJITBuilder()
-                                  .setDataLayout(layout)
-                                  .setCompileFunctionCreator(compilerBuilder)
-                                  .setObjectLinkingLayerCreator(linkerBuilder)
-                                  .create());
+  // create LLJIT, or LLLazyJIT which emits a stub per function and only compiles a function
+  // the first time the stub is called.
+  llvm::orc::LLLazyJIT* lazy_jit = nullptr;
+  if (orcjit_lazy_) {
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit =
+        llvm::cantFail(llvm::orc::LLLazyJITBuilder()
+                           .setDataLayout(layout)
+                           .setCompileFunctionCreator(compilerBuilder)
+                           .setObjectLinkingLayerCreator(linkerBuilder)
+                           .create());
+    lazy_jit = jit.get();
+    orcjit_ee_ = std::move(jit);
+  } else {
+    orcjit_ee_ = llvm::cantFail(llvm::orc::LLJITBuilder()
+                                    .setDataLayout(layout)
+                                    .setCompileFunctionCreator(compilerBuilder)
+                                    .setObjectLinkingLayerCreator(linkerBuilder)
+                                    .create());
+  }
 
   TVM_FFI_ICHECK(orcjit_ee_ != nullptr) << "Failed to initialize LLVM ORCJIT engine for "
 #if TVM_LLVM_VERSION >= 210
@@ -550,7 +923,8 @@ void LLVMModuleNode::InitORCJIT() {
 
   // add the llvm module to run
   llvm::orc::ThreadSafeModule tsm(std::move(umod), std::move(uctx));
-  auto err = orcjit_ee_->addIRModule(std::move(tsm));
+  auto err = lazy_jit != nullptr ? lazy_jit->addLazyIRModule(std::move(tsm))
+                                 : orcjit_ee_->addIRModule(std::move(tsm));
   TVM_FFI_ICHECK(!err) << llvm::toString(std::move(err));
 
   VLOG(2) << "LLVM ORCJIT execute " << module_->getModuleIdentifier() << " for triple `"
@@ -24,7 +24,9 @@
 
 #include <tvm/ffi/extra/module.h>
 #include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/target/codegen.h>
+#include <tvm/tirx/transform.h>
 
 #include <algorithm>
 #include <string>
@@ -62,6 +64,15 @@ void CodeGenCHost::InitGlobalContext() {
 
 void CodeGenCHost::DefineModuleName() { decl_stream << "void* " << module_name_ << " = NULL;\n"; }
 
+void CodeGenCHost::DefineStaticWorkspace(int64_t nbytes, int64_t alignment) {
+  // The arena is zero initialized, so that it lives in .bss, and gets its own section, so that a
+  // linker script can place it.
+  decl_stream << "// The static workspace of the module: " << nbytes << " bytes\n";
+  decl_stream << "static uint8_t __tvm_static_workspace[" << nbytes << "]\n"
+              << "    __attribute__((aligned(" << alignment << "), "
+              << "section(\".bss.tvm_static_workspace\")));\n";
+}
+
 void CodeGenCHost::AddFunction(const GlobalVar& gvar, const PrimFunc& func) {
   return AddFunction(gvar, func, /*emit_fwd_func_decl=*/false);
 }
@@ -315,6 +326,14 @@ void CodeGenCHost::VisitExpr_(const CallNode* op, std::ostream& os) {  // NOLINT
   } else if (op->op.same_as(builtin::tvm_throw_last_error())) {
     this->PrintIndent();
     this->stream << "return -1;\n";
+  } else if (op->op.same_as(builtin::function_address())) {
+    TVM_FFI_ICHECK_EQ(op->args.size(), 1U);
+    os << "((void*)(&" << op->args[0].as_or_throw<StringImm>()->value << "))";
+  } else if (op->op.same_as(builtin::static_workspace_ptr())) {
+    TVM_FFI_ICHECK_EQ(op->args.size(), 1U);
+    os << "((void*)(__tvm_static_workspace + ";
+    this->PrintExpr(op->args[0], os);
+    os << "))";
   } else {
     CodeGenC::VisitExpr_(op, os);
   }
@@ -385,6 +404,12 @@ ffi::Module BuildCHost(IRModule mod, Target target) {
   CodeGenCHost cg;
   cg.Init(output_ssa, emit_asserts, emit_fwd_func_decl, target->str(), devices);
   cg.SetConstantsByteAlignment(target->GetAttr<int64_t>("constants-byte-alignment").value_or(16));
+  auto workspace_bytes = mod->GetAttr<IntImm>(tirx::transform::kStaticWorkspaceBytes);
+  if (workspace_bytes && workspace_bytes.value()->value > 0) {
+    cg.DefineStaticWorkspace(
+        workspace_bytes.value()->value,
+        target->GetAttr<int64_t>("workspace-byte-alignment").value_or(runtime::kAllocAlignment));
+  }
 
   auto is_aot_executor_fn = [](const PrimFunc& func) -> bool {
     return func->GetAttr<bool>("runner_function", false).value();
@@ -55,6 +55,12 @@ class CodeGenCHost : public CodeGenC {
    */
   void AddFunctionsOrdered(std::vector<std::pair<tvm::GlobalVar, tvm::BaseFunc>> functions);
   void DefineModuleName();
+  /*!
+   * \brief Define the static workspace arena of the module, planned by PlanStaticWorkspace.
+   * \param nbytes The bytes of the arena.
+   * \param alignment The byte alignment of the arena.
+   */
+  void DefineStaticWorkspace(int64_t nbytes, int64_t alignment);
 
   using CodeGenC::PrintType;
   void PrintType(const PrimType& t, std::ostream& os) final;  // NOLINT(*)
@@ -45,12 +45,37 @@
 namespace tvm {
 namespace tirx {
 
-/*! \brief The helper mutator that transforms ProducerLoad to BufferLoad */
+/*!
+ * \brief The helper mutator that transforms ProducerLoad to BufferLoad, and
+ * optionally remaps the TE compute axes to the block vars in the same pass.
+ */
 class ProducerToBufferTransformer : public StmtExprMutator {
  public:
   explicit ProducerToBufferTransformer(const std::unordered_map<te::Tensor, Buffer>& tensor2buffers)
       : tensor2buffers_(tensor2buffers) {}
 
+  /*!
+   * \brief Transform the ProducerLoads of an expression and remap its vars.
+   * \param expr The expression to be transformed.
+   * \param var_map The var re-mapping applied during the transformation.
+   * \return The transformed expression.
+   */
+  PrimExpr TransformAndRemap(const PrimExpr& expr, const ffi::Map<Var, PrimExpr>& var_map) {
+    var_map_ = &var_map;
+    PrimExpr result = VisitExpr(expr).as_or_throw<PrimExpr>();
+    var_map_ = nullptr;
+    return result;
+  }
+
+  Expr VisitExpr_(const VarNode* op) final {
+    if (var_map_ != nullptr) {
+      if (auto value = var_map_->Get(ffi::GetRef<Var>(op))) {
+        return value.value();
+      }
+    }
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
   Expr VisitExpr_(const ProducerLoadNode* op) final {
     auto visited_op = StmtExprMutator::VisitExpr_(op).as_or_throw<ProducerLoad>();
     te::Tensor tensor = visited_op->producer.as_or_throw<te::Tensor>();
@@ -63,6 +88,8 @@ class ProducerToBufferTransformer : public StmtExprMutator {
  private:
   /*! \brief The Map from Operations to buffers */
   const std::unordered_map<te::Tensor, Buffer>& tensor2buffers_;
+  /*! \brief The var re-mapping of the current transformation, if any. */
+  const ffi::Map<Var, PrimExpr>* var_map_{nullptr};
 };
 
 /*! \brief The helper mutator to rewrite buffer and buffer var accessed by block body */
@@ -115,9 +142,23 @@ struct CreateFuncInfo {
   ffi::Array<Buffer> root_alloc;
   /*! \brief The unique name supply to make block name unique. */
   UniqueNameSupply name_supply;
+  /*!
+   * \brief The memoized simplification results. The analyzer holds no
+   * constraints during the conversion, so results can be reused for the same
+   * expression, e.g. the domains of axes shared by many stages.
+   */
+  std::unordered_map<PrimExpr, PrimExpr, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> simplify_cache;
 
   ffi::String FreshName(ffi::String base_name) { return name_supply->FreshName(base_name); }
 
+  PrimExpr Simplify(const PrimExpr& expr, arith::AnalyzerObj* analyzer) {
+    auto it = simplify_cache.find(expr);
+    if (it == simplify_cache.end()) {
+      it = simplify_cache.emplace(expr, analyzer->Simplify(expr)).first;
+    }
+    return it->second;
+  }
+
   explicit CreateFuncInfo(ffi::Array<te::Tensor> arg_list)
       : arg_list(std::move(arg_list)), transformer(tensor2buffers) {}
 
@@ -192,7 +233,7 @@ class LayoutFreePlaceholdersNormalizer : public StmtMutator {
  **/
 using NestedIterLevels = std::vector<std::vector<IterVar>>;
 
-NestedIterLevels GenerateNestedIterLevels(const ffi::Array<IterVar>& axes,
+NestedIterLevels GenerateNestedIterLevels(const ffi::Array<IterVar>& axes, CreateFuncInfo* info,
                                           arith::AnalyzerObj* analyzer) {
   int global_max_depth = 0;
   std::unordered_map<Var, int> depth;
@@ -207,10 +248,10 @@ NestedIterLevels GenerateNestedIterLevels(const ffi::Array<IterVar>& axes,
       return depth_it->second;
     }
     std::vector<Var> dep_vars;
-    for (const Var& v : UndefinedVars(analyzer->Simplify(axis->dom->min))) {
+    for (const Var& v : UndefinedVars(info->Simplify(axis->dom->min, analyzer))) {
       dep_vars.push_back(v);
     }
-    for (const Var& v : UndefinedVars(analyzer->Simplify(axis->dom->extent))) {
+    for (const Var& v : UndefinedVars(info->Simplify(axis->dom->extent, analyzer))) {
       dep_vars.push_back(v);
     }
     int cur_depth = 0;
@@ -338,7 +379,7 @@ Stmt GenerateInitStmt(const ffi::Array<PrimExpr>& indices, const ffi::Array<Buff
                       CreateFuncInfo* info) {
   // helper to transform the expr and remap iters to the block domain
   auto f_transform_and_remap = [&](const PrimExpr& e) {
-    return Substitute(info->transformer(e).as_or_throw<PrimExpr>(), var_map);
+    return info->transformer.TransformAndRemap(e, var_map);
   };
   ffi::Optional<Stmt> init = std::nullopt;
   Stmt body;
@@ -368,7 +409,7 @@ Stmt GenerateBodyStmt(const ffi::Array<PrimExpr>& indices, const ffi::Array<Buff
                       CreateFuncInfo* info, arith::AnalyzerObj* analyzer) {
   // helper to transform the expr and remap iters to the block domain
   auto f_transform_and_remap = [&](const PrimExpr& e) {
-    return Substitute(info->transformer(e).as_or_throw<PrimExpr>(), var_map);
+    return info->transformer.TransformAndRemap(e, var_map);
   };
   Stmt body;
   if (const auto* reduce = expr_body.as<ReduceNode>()) {
@@ -391,6 +432,9 @@ Stmt GenerateBodyStmt(const ffi::Array<PrimExpr>& indices, const ffi::Array<Buff
       TVM_FFI_ICHECK_EQ(left.ty()->dtype, right.ty()->dtype);
     }
 
+    // The combined results of all the buffers come from a single combiner call.
+    ffi::Array<PrimExpr> combined = reduce->combiner.get()->operator()(lhs, rhs);
+
     ffi::Array<Var> temp_vars;
     ffi::Array<Stmt> body_stmts;
     temp_vars.reserve(n_buffers);
@@ -408,8 +452,7 @@ Stmt GenerateBodyStmt(const ffi::Array<PrimExpr>& indices, const ffi::Array<Buff
         temp_vars.push_back(Var("v_" + buffer->name, lhs[i].ty()));
         value = temp_vars.back().as_or_throw<PrimExpr>();
       } else {
-        PrimExpr combined = reduce->combiner.get()->operator()(lhs, rhs)[i];
-        value = f_transform_and_remap(combined);
+        value = f_transform_and_remap(combined[i]);
       }
       body_stmts.push_back(BufferStore(buffer, value, indices));
     }
@@ -418,7 +461,7 @@ Stmt GenerateBodyStmt(const ffi::Array<PrimExpr>& indices, const ffi::Array<Buff
       // When there are multiple buffers, we wrap the body with Bind stmts.
       ffi::Array<Stmt> bind_stmts;
       for (int i = 0; i < n_buffers; ++i) {
-        PrimExpr value = f_transform_and_remap(reduce->combiner.get()->operator()(lhs, rhs)[i]);
+        PrimExpr value = f_transform_and_remap(combined[i]);
         bind_stmts.push_back(Bind(temp_vars[i], std::move(value)));
       }
       bind_stmts.push_back(body);
@@ -485,7 +528,7 @@ Stmt GenerateStmtFromCompute(const te::ComputeOp& compute_op, CreateFuncInfo* in
   // Step 2. Prepare nested iteration scopes.
   // For each axis, we generate loop and the first block binding at the level it belongs to.
   // In lower levels, we just create new block var and bind it to the previous level block var.
-  auto axes_levels = GenerateNestedIterLevels(axes, analyzer);
+  auto axes_levels = GenerateNestedIterLevels(axes, info, analyzer);
   TVM_FFI_ICHECK(!axes_levels.empty());
   std::vector<NestedScopeInfo> scopes;
   scopes.reserve(axes_levels.size());
@@ -508,7 +551,8 @@ Stmt GenerateStmtFromCompute(const te::ComputeOp& compute_op, CreateFuncInfo* in
           min = Substitute(min, scope_repl);
           extent = Substitute(extent, scope_repl);
         }
-        Range dom = Range::FromMinExtent(analyzer->Simplify(min), analyzer->Simplify(extent));
+        Range dom =
+            Range::FromMinExtent(info->Simplify(min, analyzer), info->Simplify(extent, analyzer));
         IterVar new_block_iter(dom, block_var.as_or_throw<PrimVar>(), axis->iter_type,
                                axis->thread_tag, axis->span);
         cur_scope.loop_vars.emplace_back(loop_var, dom);
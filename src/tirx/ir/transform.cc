@@ -27,6 +27,13 @@
 #include <tvm/ffi/rvalue_ref.h>
 #include <tvm/tirx/transform.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace tvm {
 namespace tirx {
 namespace transform {
@@ -37,18 +44,24 @@ TVM_REGISTER_PASS_CONFIG_OPTION("tirx.instrument_bound_checkers", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.disable_assert", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.disable_vectorize", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.enable_buffer_level_predication", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.vectorize_scalable", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.vectorize_masked_tail", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.disable_cse_tir", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.enable_debug", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.disable_storage_rewrite", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.static_workspace_plan", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.is_entry_func", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.add_lower_pass", ffi::Array<ffi::Array<ffi::ObjectRef>>);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.debug_keep_trivial_loop", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.use_async_copy", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.merge_static_smem", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.merge_smem_packing", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.merge_smem_async_copy_align", int64_t);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.instrument_lwp", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.vtcm_capacity", int64_t);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.ptx.ldg32", bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tirx.enable_fast_math", bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.num_function_pass_threads", int64_t);
 
 /*!
  * \brief Function level pass that applies transformations to all
@@ -62,9 +75,14 @@ class PrimFuncPassNode : public PassNode {
   /*! \brief The pass function called on each. */
   std::function<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func;
 
+  /*! \brief Whether pass_func may run on several functions at once. */
+  bool thread_safe{false};
+
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
-    refl::ObjectDef<PrimFuncPassNode>().def_ro("pass_info", &PrimFuncPassNode::pass_info);
+    refl::ObjectDef<PrimFuncPassNode>()
+        .def_ro("pass_info", &PrimFuncPassNode::pass_info)
+        .def_ro("thread_safe", &PrimFuncPassNode::thread_safe);
   }
 
   /*!
@@ -82,6 +100,22 @@ class PrimFuncPassNode : public PassNode {
    */
   PassInfo Info() const override { return pass_info; }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("tirx.PrimFuncPass", PrimFuncPassNode, PassNode);
+
+ private:
+  /*!
+   * \brief Run pass_func on the functions on num_threads threads.
+   *
+   *  The functions in the module are left untouched while the threads run, and the
+   *  results are written back in the order of the functions afterwards. If any function
+   *  fails, the error of the first failing function is rethrown.
+   */
+  std::vector<PrimFunc> ParallelApply(const std::vector<PrimFunc>& funcs, const IRModule& mod,
+                                      const PassContext& pass_ctx, const PassCache& cache,
+                                      int num_threads) const;
+
+  /*! \brief Run pass_func on func, reusing the output in the pass cache if there is one. */
+  PrimFunc CachedApply(PrimFunc func, const IRModule& mod, const PassContext& pass_ctx,
+                       const PassCache& cache) const;
 };
 
 class PrimFuncPass : public Pass {
@@ -90,26 +124,116 @@ class PrimFuncPass : public Pass {
    * \brief The constructor
    * \param pass_func The packed function which implements a pass.
    * \param pass_info The pass info.
+   * \param thread_safe Whether pass_func may run on several functions at once.
    */
   TVM_DLL PrimFuncPass(std::function<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
-                       PassInfo pass_info);
+                       PassInfo pass_info, bool thread_safe = false);
 
   TVM_FFI_DEFINE_OBJECT_REF_METHODS_NULLABLE(PrimFuncPass, Pass, PrimFuncPassNode);
 };
 
 PrimFuncPass::PrimFuncPass(std::function<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
-                           PassInfo pass_info) {
+                           PassInfo pass_info, bool thread_safe) {
   auto n = ffi::make_object<PrimFuncPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->thread_safe = thread_safe;
   data_ = std::move(n);
 }
 
+PrimFunc PrimFuncPassNode::CachedApply(PrimFunc func, const IRModule& mod,
+                                       const PassContext& pass_ctx, const PassCache& cache) const {
+  if (!cache.enabled()) {
+    return pass_func(std::move(func), mod, pass_ctx);
+  }
+  uint64_t key;
+  if (auto cached = cache.Lookup(func, &key)) {
+    if (auto cached_func = cached.value().as<PrimFunc>()) {
+      return cached_func.value();
+    }
+  }
+  PrimFunc input = func;
+  PrimFunc result = pass_func(std::move(func), mod, pass_ctx);
+  if (result.defined()) {
+    cache.Insert(key, input, result);
+  }
+  return result;
+}
+
+std::vector<PrimFunc> PrimFuncPassNode::ParallelApply(const std::vector<PrimFunc>& funcs,
+                                                      const IRModule& mod,
+                                                      const PassContext& pass_ctx,
+                                                      const PassCache& cache,
+                                                      int num_threads) const {
+  int num_funcs = static_cast<int>(funcs.size());
+  std::vector<PrimFunc> results(num_funcs);
+  std::vector<std::exception_ptr> errors(num_funcs);
+  std::atomic<int> counter{0};
+  auto run = [&]() {
+    for (int i; (i = counter++) < num_funcs;) {
+      try {
+        results[i] = CachedApply(funcs[i], mod, pass_ctx, cache);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back([&]() {
+      PassContext::WorkerScope scope(pass_ctx);
+      run();
+    });
+  }
+  // The current thread already has pass_ctx as its current context.
+  run();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+  return results;
+}
+
 // Perform Module -> Module optimizations at the PrimFunc level.
 IRModule PrimFuncPassNode::operator()(IRModule mod, const PassContext& pass_ctx) const {
   TVM_FFI_ICHECK(mod.defined());
   std::vector<GlobalVar> deleted_list;
 
+  // Only thread-safe passes depend on nothing but their function and the pass context.
+  PassCache cache;
+  int num_threads = 1;
+  if (thread_safe) {
+    cache = PassCache(pass_ctx, pass_info);
+    num_threads = static_cast<int>(
+        pass_ctx->GetConfig<int64_t>("tirx.num_function_pass_threads", 1).value());
+  }
+  if (num_threads > 1) {
+    std::vector<GlobalVar> gvars;
+    std::vector<PrimFunc> funcs;
+    for (const auto& kv : mod->functions) {
+      if (auto func = kv.second.as<PrimFunc>()) {
+        gvars.push_back(kv.first);
+        funcs.push_back(func.value());
+      }
+    }
+    if (funcs.size() > 1) {
+      num_threads = std::min(num_threads, static_cast<int>(funcs.size()));
+      std::vector<PrimFunc> results = ParallelApply(funcs, mod, pass_ctx, cache, num_threads);
+      IRModuleNode* mod_ptr = mod.CopyOnWrite();
+      for (size_t i = 0; i < gvars.size(); ++i) {
+        if (results[i].defined()) {
+          mod_ptr->Update(gvars[i], results[i]);
+        } else {
+          mod_ptr->Remove(gvars[i]);
+        }
+      }
+      return mod;
+    }
+  }
+
   IRModuleNode* mod_ptr = mod.CopyOnWrite();
   auto* func_dict = mod_ptr->functions.CopyOnWrite();
   // directly loop over the underlying dict
@@ -120,7 +244,11 @@ IRModule PrimFuncPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
       // use move semantics as follows to avoid only copy.
       kv.second.reset();
       PrimFunc func = *std::move(opt_func);
-      func = pass_func(std::move(func), mod, pass_ctx);
+      {
+        instrument::FunctionPassProfileScope profile_scope(
+            pass_ctx->instruments, kv.first.as_or_throw<GlobalVar>()->name_hint);
+        func = CachedApply(std::move(func), mod, pass_ctx, cache);
+      }
       kv.second = Any(std::move(func));
       if (kv.second == nullptr) {
         deleted_list.push_back(kv.first.as_or_throw<GlobalVar>());
@@ -139,9 +267,9 @@ IRModule PrimFuncPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
 
 Pass CreatePrimFuncPass(std::function<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
                         int opt_level, ffi::String name, tvm::ffi::Array<ffi::String> required,
-                        bool traceable) {
+                        bool traceable, bool thread_safe) {
   PassInfo pass_info = PassInfo(opt_level, name, required, traceable);
-  return PrimFuncPass(std::move(pass_func), pass_info);
+  return PrimFuncPass(std::move(pass_func), pass_info, thread_safe);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() { PrimFuncPassNode::RegisterReflection(); }
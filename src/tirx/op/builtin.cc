@@ -213,6 +213,14 @@ TIR_DEFINE_BUILTIN_FUNC(lookup_param)
     .set_attr<TCallEffectKind>("TCallEffectKind",
                                static_cast<int64_t>(CallEffectKind::kUpdateState));
 
+TIR_DEFINE_BUILTIN_FUNC(static_workspace_ptr)
+    .set_num_inputs(1)
+    .set_attr<TCallEffectKind>("TCallEffectKind", static_cast<int64_t>(CallEffectKind::kPure));
+
+TIR_DEFINE_BUILTIN_FUNC(function_address)
+    .set_num_inputs(1)
+    .set_attr<TCallEffectKind>("TCallEffectKind", static_cast<int64_t>(CallEffectKind::kPure));
+
 TIR_DEFINE_BUILTIN_FUNC(tvm_throw_last_error)
     .set_num_inputs(0)
     .set_attr<TCallEffectKind>("TCallEffectKind", static_cast<int64_t>(CallEffectKind::kOpaque));
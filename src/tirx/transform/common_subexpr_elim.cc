@@ -60,6 +60,16 @@
  * scope. The scope tree enables computing the Lowest Common Ancestor (LCA) of
  * all scopes where an expression occurs, which determines the correct insertion
  * point — the narrowest scope that dominates all uses.
+ *
+ * Loop-invariant hoisting
+ * -----------------------
+ * When enabled through the `tirx.CommonSubexprElim` pass config, a binding is
+ * further hoisted out of the serial and unrolled loops in which all variables
+ * of its expression are invariant, such as the address computation of an
+ * inner loop that only depends on outer loop variables. An expression used
+ * once is hoisted only if its ExprComplexity reaches `min_hoist_complexity`.
+ * On GPU targets, at most `max_hoisted_per_loop` bindings are hoisted in
+ * front of a loop, since each of them holds a register across the loop.
  */
 
 #include <tvm/ffi/cast.h>
@@ -69,6 +79,7 @@
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/ffi/string.h>
 #include <tvm/ir/transform.h>
+#include <tvm/target/target.h>
 #include <tvm/tirx/analysis.h>
 #include <tvm/tirx/expr.h>
 #include <tvm/tirx/expr_functor.h>
@@ -89,6 +100,43 @@
 namespace tvm {
 namespace tirx {
 
+// ============================================================================
+// Pass configuration
+// ============================================================================
+
+struct CommonSubexprElimConfigNode : public ffi::Object {
+  bool hoist_loop_invariant;
+  int min_hoist_complexity;
+  int max_hoisted_per_loop;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<CommonSubexprElimConfigNode>()
+        .def_ro("hoist_loop_invariant", &CommonSubexprElimConfigNode::hoist_loop_invariant,
+                "Whether to hoist loop-invariant expressions out of serial and unrolled loops",
+                refl::DefaultValue(false))
+        .def_ro("min_hoist_complexity", &CommonSubexprElimConfigNode::min_hoist_complexity,
+                "The minimum complexity of a hoisted expression that is used only once",
+                refl::DefaultValue(4))
+        .def_ro("max_hoisted_per_loop", &CommonSubexprElimConfigNode::max_hoisted_per_loop,
+                "The maximum number of bindings hoisted in front of a loop on GPU targets, "
+                "or 0 for no limit",
+                refl::DefaultValue(8));
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("tirx.transform.CommonSubexprElimConfig",
+                                    CommonSubexprElimConfigNode, ffi::Object);
+};
+
+class CommonSubexprElimConfig : public ffi::ObjectRef {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NOTNULLABLE(CommonSubexprElimConfig, ffi::ObjectRef,
+                                                CommonSubexprElimConfigNode);
+};
+
+TVM_FFI_STATIC_INIT_BLOCK() { CommonSubexprElimConfigNode::RegisterReflection(); }
+
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.CommonSubexprElim", CommonSubexprElimConfig);
+
 // ============================================================================
 // Plan interface types (internal, C++ only)
 // ============================================================================
@@ -133,7 +181,7 @@ using InsertBeforeTable =
  *
  * Usage:
  * \code
- *   auto [insert_before, expr_remap] = CSEPlanner::Plan(body, params);
+ *   auto [insert_before, expr_remap] = CSEPlanner::Plan(body, config, max_hoisted_per_loop);
  * \endcode
  */
 class CSEPlanner : public StmtExprVisitor {
@@ -145,14 +193,25 @@ class CSEPlanner : public StmtExprVisitor {
    * and returns the computed plan.
    *
    * \param body The TIR function body to analyze.
+   * \param config The pass config, which controls loop-invariant hoisting.
+   * \param max_hoisted_per_loop The maximum number of bindings hoisted in front
+   *        of a loop, or 0 for no limit.
    * \return A pair of (InsertBeforeTable, ExprRemapTable) describing the
    *         planned CSE transformations.
    */
-  static std::pair<InsertBeforeTable, ExprRemapTable> Plan(const Stmt& body) {
-    CSEPlanner planner;
+  static std::pair<InsertBeforeTable, ExprRemapTable> Plan(const Stmt& body,
+                                                           CommonSubexprElimConfig config,
+                                                           int max_hoisted_per_loop) {
+    CSEPlanner planner(std::move(config), max_hoisted_per_loop);
     // Root scope (no parent, depth 0, no creator statement)
     planner.scopes_.push_back({-1, 0, Stmt()});
     planner.current_scope_ = 0;
+    if (planner.config_->hoist_loop_invariant) {
+      // Variables that are free in the body, such as parameters, are defined at the root.
+      for (const Var& var : UndefinedVars(body, {})) {
+        planner.var_def_scope_[var.get()] = 0;
+      }
+    }
     // Scan the tree (VisitStmt sets current_stmt_ automatically)
     planner.VisitStmt(body);
     // Convert scan results into the plan
@@ -160,6 +219,9 @@ class CSEPlanner : public StmtExprVisitor {
   }
 
  private:
+  CSEPlanner(CommonSubexprElimConfig config, int max_hoisted_per_loop)
+      : config_(std::move(config)), max_hoisted_per_loop_(max_hoisted_per_loop) {}
+
   /*!
    * \brief One node in the scope tree.
    *
@@ -238,6 +300,16 @@ class CSEPlanner : public StmtExprVisitor {
      * are CSE candidates.
      */
     int consumed{0};
+    /*!
+     * \brief Whether the single independent occurrence is bound because it is
+     *        hoisted out of a loop (loop-invariant hoisting only).
+     */
+    bool hoist_single{false};
+    /*!
+     * \brief Whether the expression only occurs inside an expression chosen
+     *        by hoist_single, whose binding already computes it once.
+     */
+    bool covered{false};
   };
 
   /*!
@@ -302,6 +374,32 @@ class CSEPlanner : public StmtExprVisitor {
     return true;
   }
 
+  /*!
+   * \brief Check if evaluating an expression node may trap.
+   *
+   * A division by a non-constant may divide by zero, so it is not hoisted out
+   * of a loop that might not run it at all.
+   */
+  static bool MayTrap(const PrimExpr& expr) {
+    auto non_constant = [](const PrimExpr& divisor) { return divisor.as<IntImmNode>() == nullptr; };
+    if (const auto* op = expr.as<DivNode>()) return non_constant(op->b);
+    if (const auto* op = expr.as<ModNode>()) return non_constant(op->b);
+    if (const auto* op = expr.as<FloorDivNode>()) return non_constant(op->b);
+    if (const auto* op = expr.as<FloorModNode>()) return non_constant(op->b);
+    return false;
+  }
+
+  /*!
+   * \brief Check if a scope-creating statement is a loop that bindings may be hoisted out of.
+   *
+   * Only serial and unrolled loops qualify. Thread-bound loops are left alone
+   * so that hoisted values stay inside the kernel.
+   */
+  static bool IsHoistableLoop(const Stmt& stmt) {
+    const auto* loop = stmt.as<ForNode>();
+    return loop != nullptr && (loop->kind == ForKind::kSerial || loop->kind == ForKind::kUnrolled);
+  }
+
   // ------------------------------------------------------------------
   // Expression substitution
   // ------------------------------------------------------------------
@@ -376,23 +474,51 @@ class CSEPlanner : public StmtExprVisitor {
    * \brief Find the statement to insert a CSE binding before.
    *
    * Two cases:
-   *   - LCA == first-use scope: insert before the first_use_stmt directly.
-   *   - LCA is an ancestor: walk from first_use_scope upward to find the
-   *     scope-creating statement that is a direct child of the LCA scope,
+   *   - Target == first-use scope: insert before the first_use_stmt directly.
+   *   - Target is an ancestor: walk from first_use_scope upward to find the
+   *     scope-creating statement that is a direct child of the target scope,
    *     and insert before that statement.
    *
    * \param entry The expression entry containing scope and first-use metadata.
+   * \param target_scope The scope of the binding, the LCA scope or an ancestor
+   *        it is hoisted to.
    * \return The statement before which the CSE Bind should be inserted.
    */
-  Stmt FindInsertionStmt(const ExprEntry& entry) const {
-    if (entry.first_use_scope == entry.lca_scope) {
+  Stmt FindInsertionStmt(const ExprEntry& entry, int target_scope) const {
+    if (entry.first_use_scope == target_scope) {
       return entry.first_use_stmt;
     }
     int s = entry.first_use_scope;
-    while (scopes_[s].parent != entry.lca_scope) s = scopes_[s].parent;
+    while (scopes_[s].parent != target_scope) s = scopes_[s].parent;
     return scopes_[s].creator_stmt;
   }
 
+  /*!
+   * \brief Find the outermost scope the binding of an entry can be hoisted to.
+   *
+   * Starting from the LCA scope, climbs out of the hoistable loops until
+   * reaching the innermost scope that defines a variable of the expression.
+   * If, While and AttrStmt scopes are never crossed: a branch or a loop body
+   * may not run, and an AttrStmt may define thread variables.
+   *
+   * \param entry The expression entry, whose repr may use earlier CSE variables.
+   * \return The scope to insert the binding in, entry.lca_scope if it cannot move.
+   */
+  int FindHoistScope(const ExprEntry& entry) const {
+    if (!config_->hoist_loop_invariant) return entry.lca_scope;
+    if (CheckContains::ExprContains(entry.repr, MayTrap)) return entry.lca_scope;
+    int def_scope = 0;
+    for (const Var& var : UndefinedVars(entry.repr)) {
+      auto it = var_def_scope_.find(var.get());
+      // Defined by a statement that is not tracked, e.g. the iterators of a block.
+      if (it == var_def_scope_.end()) return entry.lca_scope;
+      if (scopes_[it->second].depth > scopes_[def_scope].depth) def_scope = it->second;
+    }
+    int s = entry.lca_scope;
+    while (s != def_scope && IsHoistableLoop(scopes_[s].creator_stmt)) s = scopes_[s].parent;
+    return s;
+  }
+
   // ------------------------------------------------------------------
   // Expression recording
   // ------------------------------------------------------------------
@@ -539,12 +665,13 @@ class CSEPlanner : public StmtExprVisitor {
     StmtExprVisitor::VisitStmt(stmt);
   }
 
-  /*! \brief For loops: bounds in parent scope, body in child scope. */
+  /*! \brief For loops: bounds in parent scope, body (and loop var) in child scope. */
   void VisitStmt_(const ForNode* op) override {
     VisitExpr(op->min);
     VisitExpr(op->extent);
     int saved = current_scope_;
     current_scope_ = AllocScope(saved, ffi::GetRef<Stmt>(op));
+    var_def_scope_[op->loop_var.get()] = current_scope_;
     VisitStmt(op->body);
     current_scope_ = saved;
   }
@@ -588,6 +715,12 @@ class CSEPlanner : public StmtExprVisitor {
     current_scope_ = saved;
   }
 
+  /*! \brief Bind is flat (no body). Its variable is defined in the current scope. */
+  void VisitStmt_(const BindNode* op) override {
+    StmtExprVisitor::VisitStmt_(op);
+    var_def_scope_[op->var.get()] = current_scope_;
+  }
+
   /*! \brief AllocBuffer is flat (no body). Visit buffer shape expressions. */
   void VisitStmt_(const AllocBufferNode* op) override { VisitBufferDef(op->buffer, true); }
 
@@ -610,8 +743,11 @@ class CSEPlanner : public StmtExprVisitor {
    *      are incremented by `(P.count - 1) * multiplicity` (the Bind value
    *      retains one copy). An entry with fewer than 2 independent occurrences
    *      is skipped (avoids unnecessary single-use bindings).
-   *   3. For each entry with independent_count >= 2:
-   *      a. Determine the insertion point.
+   *   2b. With loop-invariant hoisting, choose the entries used once that are
+   *      hoisted on their own (deeper first, so that the children of a chosen
+   *      entry are covered by its binding instead of getting their own).
+   *   3. For each entry with independent_count >= 2 or chosen in step 2b:
+   *      a. Determine the insertion point, hoisting it out of invariant loops.
    *      b. Create a CSE variable and Bind statement (using the entry's repr,
    *         which may already reference CSE vars from shallower entries).
    *      c. Add to insert_before and expr_remap.
@@ -648,16 +784,49 @@ class CSEPlanner : public StmtExprVisitor {
       }
     }
 
+    // Step 2b: Choose the single-use entries worth a binding of their own,
+    // which are the complex enough ones that can leave at least one loop.
+    if (config_->hoist_loop_invariant) {
+      for (auto it = all_entries.rbegin(); it != all_entries.rend(); ++it) {
+        ExprEntry* entry = it->second;
+        if (!entry->covered && entry->count - entry->consumed == 1 &&
+            FindHoistScope(*entry) != entry->lca_scope &&
+            static_cast<int64_t>(CalculateExprComplexity(entry->repr)) >=
+                config_->min_hoist_complexity) {
+          entry->hoist_single = true;
+        }
+        if (!entry->hoist_single && !entry->covered) continue;
+        for (const auto& child : entry->children) {
+          auto cit = table_.find(child.first);
+          if (cit != table_.end()) cit->second.covered = true;
+        }
+      }
+    }
+
     InsertBeforeTable insert_before;
     ExprRemapTable expr_remap;
     int counter = 0;
+    // Number of bindings hoisted in front of each loop.
+    std::unordered_map<Stmt, int, ffi::ObjectPtrHash, ffi::ObjectPtrEqual> num_hoisted;
 
     // Step 3: Process each candidate (shallower first)
     for (auto& [expr, entry] : all_entries) {
-      if (entry->count - entry->consumed < 2) continue;
-
-      // Step 3a: Determine where to insert the Bind
-      Stmt insert_at = FindInsertionStmt(*entry);
+      bool repeated = entry->count - entry->consumed >= 2;
+      if (!repeated && !entry->hoist_single) continue;
+
+      // Step 3a: Determine where to insert the Bind. entry->repr may use CSE
+      // vars of shallower entries, which bounds how far it can be hoisted.
+      int scope = FindHoistScope(*entry);
+      Stmt insert_at = FindInsertionStmt(*entry, scope);
+      if (scope != entry->lca_scope) {
+        if (max_hoisted_per_loop_ > 0 && num_hoisted[insert_at] >= max_hoisted_per_loop_) {
+          scope = entry->lca_scope;
+          insert_at = FindInsertionStmt(*entry, scope);
+        } else {
+          ++num_hoisted[insert_at];
+        }
+      }
+      if (!repeated && scope == entry->lca_scope) continue;
 
       // Step 3b: Create CSE variable and Bind statement.
       // entry->repr may already contain CSE vars from shallower entries.
@@ -665,6 +834,7 @@ class CSEPlanner : public StmtExprVisitor {
       std::string name = "cse_v" + std::to_string(counter);
       Var cse_var(name, entry->repr.ty());
       Stmt bind = Bind(cse_var, entry->repr);
+      var_def_scope_[cse_var.get()] = scope;
 
       // Step 3c: Record in output tables.
       // expr_remap maps the ORIGINAL expression (for tree matching by the rewriter).
@@ -698,6 +868,15 @@ class CSEPlanner : public StmtExprVisitor {
   Stmt current_stmt_;
   /*! \brief Nesting depth of Let expression bodies. When > 0, recording is suppressed. */
   int let_depth_ = 0;
+  /*! \brief The pass config. */
+  CommonSubexprElimConfig config_;
+  /*! \brief The maximum number of bindings hoisted in front of a loop, 0 for no limit. */
+  int max_hoisted_per_loop_;
+  /*!
+   * \brief Scope ID defining each variable visible to the scan: loop vars,
+   *        Bind vars, CSE vars, and the free variables of the body.
+   */
+  std::unordered_map<const ffi::Object*, int> var_def_scope_;
 };
 
 // ============================================================================
@@ -797,7 +976,19 @@ namespace transform {
  */
 Pass CommonSubexprElim() {
   auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
-    auto [insert_before, expr_remap] = CSEPlanner::Plan(f->body);
+    auto cfg = ctx->GetConfig<CommonSubexprElimConfig>("tirx.CommonSubexprElim");
+    if (!cfg.has_value()) {
+      cfg = tvm::transform::PassConfigWithDefaults<CommonSubexprElimConfig>();
+    }
+    // Hoisted bindings stay live across their loop, which register pressure bounds on GPUs.
+    int max_hoisted_per_loop = 0;
+    if (auto target = f->GetAttr<Target>(tvm::attr::kTarget)) {
+      if (target.value()->GetTargetDeviceType() != kDLCPU) {
+        max_hoisted_per_loop = cfg.value()->max_hoisted_per_loop;
+      }
+    }
+    auto [insert_before, expr_remap] =
+        CSEPlanner::Plan(f->body, cfg.value(), max_hoisted_per_loop);
     if (!insert_before.empty()) {
       auto* n = f.CopyOnWrite();
       n->body = CSERewriter(std::move(insert_before), std::move(expr_remap)).Rewrite(f->body);
@@ -225,7 +225,8 @@ Pass FlattenBuffer() {
   auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
     return FlattenBuffer(std::move(f));
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.FlattenBuffer", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.FlattenBuffer", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
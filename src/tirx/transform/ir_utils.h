@@ -216,6 +216,13 @@ inline Call StackAlloca(Type ret_type, std::string type, size_t num) {
  */
 Stmt ConvertSSA(Stmt stmt);
 
+/*!
+ * \brief Replace every AssertStmt by a no-op.
+ * \param stmt The source statement.
+ * \return The statement without assertions.
+ */
+Stmt SkipAssert(Stmt stmt);
+
 /*!
  * \brief Return the storage scope associated with a buffer variable.
  * \param buffer_var The input buffer variable.
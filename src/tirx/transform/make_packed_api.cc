@@ -31,6 +31,7 @@
 #include <tvm/tirx/buffer.h>
 #include <tvm/tirx/builtin.h>
 #include <tvm/tirx/expr.h>
+#include <tvm/tirx/op.h>
 #include <tvm/tirx/stmt_functor.h>
 #include <tvm/tirx/transform.h>
 
@@ -192,7 +193,13 @@ ffi::Optional<ffi::String> RequiresPackedAPI(const PrimFunc& func) {
   return global_symbol.value();
 }
 
-PrimFunc MakePackedAPI(PrimFunc func) {
+/*!
+ * \brief Lower the PrimFunc to the packed function API.
+ * \param func The function to be lowered.
+ * \param check_args Whether the entry validates the count, types, shapes, strides and devices
+ *  of its arguments. Without the checks, the arguments are only decoded.
+ */
+PrimFunc MakePackedAPI(PrimFunc func, bool check_args = true) {
   auto global_symbol = RequiresPackedAPI(func);
   if (!global_symbol.has_value()) {
     return func;
@@ -236,6 +243,12 @@ PrimFunc MakePackedAPI(PrimFunc func) {
 
   auto result = binder.Finalize();
   bool need_set_device = result.var_defs.count(device_id.get());
+  if (!check_args) {
+    // The asserts are leaves, so the definitions and alignment hints around them are kept.
+    for (std::vector<Stmt>* nest : {&result.init_nest, &result.asserts}) {
+      for (Stmt& stmt : *nest) stmt = SkipAssert(stmt);
+    }
+  }
 
   std::vector<Stmt> seq_check;
 
@@ -286,6 +299,82 @@ PrimFunc MakePackedAPI(PrimFunc func) {
   return func;
 }
 
+/*!
+ * \brief Lower the host PrimFunc to its direct C entry, `int32_t entry(void* const* args)`,
+ *  and the packed function that returns the address of the entry.
+ *
+ * Each slot of args holds the data pointer of a buffer or the value of an integer parameter.
+ * The entry neither receives nor checks shapes, strides and devices, so the buffers must have
+ * static compact shapes.
+ *
+ * \param func The function to be lowered.
+ * \param global_symbol The global symbol of the packed entry of the function.
+ * \return The direct entry and the address getter.
+ */
+ffi::Map<GlobalVar, PrimFunc> MakeDirectAPI(const PrimFunc& func,
+                                            const ffi::String& global_symbol) {
+  Target target = func->GetAttr<Target>(tvm::attr::kTarget).value();
+  TVM_FFI_ICHECK_EQ(target->GetTargetDeviceType(), kDLCPU)
+      << "The direct entry of " << global_symbol << " requires a host kernel, but the target is "
+      << target;
+  TVM_FFI_ICHECK(IsVoidType(func->ret_type))
+      << "The direct entry of " << global_symbol << " cannot return a value";
+  ffi::String entry_symbol = global_symbol + attr::kDirectEntrySuffix + "_entry";
+  ffi::String getter_symbol = global_symbol + attr::kDirectEntrySuffix;
+
+  Var v_args("args", PointerType::VoidPointerTy());
+  std::vector<Stmt> init_nest;
+  for (size_t i = 0; i < func->params.size(); ++i) {
+    const Var& param = func->params[i];
+    PrimExpr slot =
+        TVMStructGet(PrimType::Int(64), v_args, static_cast<int>(i), builtin::kInt64ArrayElem);
+    if (auto opt_buffer = func->buffer_map.Get(param)) {
+      const Buffer& buffer = opt_buffer.value();
+      bool is_static = buffer->strides.empty() && is_zero(buffer->elem_offset);
+      for (const PrimExpr& dim : buffer->shape) {
+        is_static = is_static && dim.as<IntImmNode>() != nullptr;
+      }
+      TVM_FFI_ICHECK(is_static) << "The direct entry of " << global_symbol
+                                << " requires the static compact buffer, but got " << buffer;
+      Expr data = Call(buffer->data->ty, builtin::reinterpret(), {slot});
+      init_nest.push_back(Bind(buffer->data, data));
+    } else {
+      auto prim_type = param->ty.as<PrimType>();
+      TVM_FFI_ICHECK(prim_type.has_value() &&
+                     prim_type.value().MatchesCode(DLDataTypeCode::kDLInt, DLDataTypeCode::kDLUInt,
+                                                   DLDataTypeCode::kDLBool))
+          << "The direct entry of " << global_symbol << " only passes integer values, but "
+          << param << " has type " << param->ty;
+      init_nest.push_back(Bind(param, cast(prim_type.value(), slot)));
+    }
+  }
+  // The workspace of the body is allocated on the host.
+  ffi::Any node = ffi::String("default");
+  init_nest.push_back(AttrStmt(node, attr::device_id, IntImm::Int32(0), Evaluate(0)));
+  init_nest.push_back(
+      AttrStmt(node, attr::device_type, IntImm::Int32(static_cast<int>(kDLCPU)), Evaluate(0)));
+
+  Stmt body = AttrStmt(0, attr::compute_scope, StringImm(entry_symbol + "_compute_"), func->body);
+  body = MergeNest(init_nest, SeqStmt({body, Return(IntImm::Int32(0))}));
+  ffi::Array<Var> undefined = UndefinedVars(body, {v_args});
+  TVM_FFI_ICHECK_EQ(undefined.size(), 0)
+      << "In the direct entry of " << global_symbol << " variables " << undefined
+      << " are used, but are not passed in as API arguments";
+
+  PrimFunc entry({v_args}, body, PrimType::Int(32), {}, func->attrs);
+  entry = WithAttrs(std::move(entry), {{tvm::attr::kCallingConv, CallingConv::kDefault},
+                                       {tvm::attr::kTarget, target->GetHost().value()},
+                                       {tvm::attr::kGlobalSymbol, entry_symbol}});
+
+  Stmt get_address = Return(Call(PointerType::VoidPointerTy(), builtin::function_address(),
+                                 {StringImm(entry_symbol)}));
+  PrimFunc getter({}, get_address, PointerType::VoidPointerTy());
+  getter = WithAttrs(std::move(getter),
+                     {{tvm::attr::kTarget, target}, {tvm::attr::kGlobalSymbol, getter_symbol}});
+
+  return {{GlobalVar(entry_symbol), entry}, {GlobalVar(getter_symbol), MakePackedAPI(getter)}};
+}
+
 namespace transform {
 
 Pass MakePackedAPI() {
@@ -312,6 +401,24 @@ Pass MakePackedAPI() {
           func.CopyOnWrite()->body = body.value();
         }
 
+        if (func->GetAttr<bool>(attr::kEmitUncheckedEntry).value_or(false)) {
+          if (auto global_symbol = RequiresPackedAPI(func)) {
+            ffi::String unchecked_symbol = global_symbol.value() + attr::kUncheckedEntrySuffix;
+            PrimFunc unchecked = MakePackedAPI(
+                WithAttr(func, tvm::attr::kGlobalSymbol, unchecked_symbol), /*check_args=*/false);
+            updates->Add(GlobalVar(unchecked_symbol), unchecked);
+          }
+        }
+
+        if (func->GetAttr<bool>(attr::kEmitDirectEntry).value_or(false)) {
+          if (auto global_symbol = RequiresPackedAPI(func)) {
+            for (const auto& [direct_gvar, direct_func] :
+                 MakeDirectAPI(func, global_symbol.value())) {
+              updates->Add(direct_gvar, direct_func);
+            }
+          }
+        }
+
         func = MakePackedAPI(std::move(func));
 
         if (!func.same_as(orig_func)) {
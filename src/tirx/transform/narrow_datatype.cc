@@ -26,13 +26,17 @@
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
 #include <tvm/s_tir/stmt.h>
+#include <tvm/tirx/analysis.h>
 #include <tvm/tirx/builtin.h>
 #include <tvm/tirx/op.h>
 #include <tvm/tirx/transform.h>
 
+#include <unordered_set>
+
 #include "../../arith/ir_mutator_with_analyzer.h"
 #include "../../arith/ir_visitor_with_analyzer.h"
 #include "../ir/data_type_rewriter.h"
+#include "ir_utils.h"
 
 namespace tvm {
 namespace tirx {
@@ -59,6 +63,14 @@ namespace tirx {
 // Algorithm:
 // - Use DataTypeVisitor to determine whether a Var can be narrowed or not.
 // - Use DataTypeRewritter to rewrite the components of an indexing expression.
+//
+// With `tirx.narrow_datatype_runtime_check`, an expression whose constant
+// bound does not fit may still be narrowed when its symbolic bound over the
+// loops only depends on the integer parameters of the function, e.g.
+// `i * n + j` with `i < n, j < n` is bounded by `n * n - 1`. The conditions
+// for these bounds to fit are checked once at runtime, and the function body
+// becomes `if (cond) { narrowed params; narrowed body } else { body }`, where
+// the else branch is narrowed by constant bounds only.
 
 using arith::Analyzer;
 using arith::ConstIntBound;
@@ -95,7 +107,8 @@ class DataTypeVisitor final : public StmtExprVisitor {
       int64_t ubound = max_value(PrimType::Int(target_bits_)).as_or_throw<IntImm>()->value;
       int64_t lbound = min_value(PrimType::Int(target_bits_)).as_or_throw<IntImm>()->value;
       if (e_ty.bits() <= target_bits_ ||
-          (bound->max_value <= ubound && bound->min_value >= lbound)) {
+          (bound->max_value <= ubound && bound->min_value >= lbound) ||
+          (guarded_ && FitsUnderGuard(e, lbound, ubound))) {
         bits = target_bits_;
       }
       int tmp = bits > bits_ ? bits : bits_;
@@ -114,9 +127,23 @@ class DataTypeVisitor final : public StmtExprVisitor {
     bits_ = tmp;
   }
 
+  /*!
+   * \brief Also narrow the expressions that fit under runtime conditions on the params.
+   * \param params The integer vars defined on entry of the function, which are narrowed
+   *  like loop vars.
+   */
+  void EnableGuards(const std::vector<Var>& params) {
+    for (const Var& param : params) {
+      params_.insert(param.get());
+      vextent_.insert_or_assign(param.get(), param->ty.as_or_throw<PrimType>());
+    }
+    guarded_ = true;
+  }
+
   void VisitStmt_(const ForNode* op) {
     analyzer_->Bind(op->loop_var, Range::FromMinExtent(op->min, op->extent));
     vextent_.insert_or_assign(op->loop_var.as<VarNode>(), op->extent.ty());
+    RelaxDomain(op->loop_var.as<VarNode>(), Range::FromMinExtent(op->min, op->extent));
     return StmtExprVisitor::VisitStmt_(op);
   }
 
@@ -124,6 +151,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
     for (const IterVar& iter : op->iter_vars) {
       analyzer_->Bind(iter->var, Range::FromMinExtent(iter->dom->min, iter->dom->extent));
       vextent_.insert_or_assign(iter->var.as<VarNode>(), iter->dom->extent.ty());
+      RelaxDomain(iter->var.as<VarNode>(), iter->dom);
     }
     StmtExprVisitor::VisitStmt_(op);
   }
@@ -134,6 +162,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
       TVM_FFI_ICHECK_NE(iv->thread_tag.length(), 0U);
       analyzer_->Bind(iv->var, Range::FromMinExtent(0, op->value));
       vextent_.insert_or_assign(iv->var.as<VarNode>(), op->value.ty());
+      RelaxDomain(iv->var.as<VarNode>(), Range::FromMinExtent(0, op->value));
       StmtExprVisitor::VisitStmt_(op);
     } else {
       StmtExprVisitor::VisitStmt_(op);
@@ -198,12 +227,38 @@ class DataTypeVisitor final : public StmtExprVisitor {
 
   // the narrowed datatype of Var and IntImm
   std::unordered_map<const ExprNode*, PrimType> vmap;
+  // the runtime conditions under which the narrowed expressions fit
+  std::vector<PrimExpr> guards;
 
  protected:
   // internal analyzer
   arith::Analyzer analyzer_;
 
  private:
+  void RelaxDomain(const VarNode* var, const Range& dom) {
+    if (guarded_) dom_map_[var] = arith::EvalSet(dom, dom_map_);
+  }
+
+  // Whether the bound of `e` over the enclosing loops fits under a condition on the params,
+  // which is recorded into `guards`.
+  bool FitsUnderGuard(const PrimExpr& e, int64_t lbound, int64_t ubound) {
+    arith::IntSet set = arith::EvalSet(e, dom_map_);
+    if (!set.HasLowerBound() || !set.HasUpperBound()) return false;
+    PrimExpr lo = analyzer_->Simplify(set.min());
+    PrimExpr hi = analyzer_->Simplify(set.max());
+    auto is_local = [this](const VarNode* var) { return params_.count(var) == 0; };
+    if (UsesVar(lo, is_local) || UsesVar(hi, is_local)) return false;
+    PrimType ty = e.ty();
+    PrimExpr guard = analyzer_->Simplify(lo >= IntImm(ty, lbound) && hi <= IntImm(ty, ubound));
+    if (is_zero(guard)) return false;
+    if (is_one(guard)) return true;
+    for (const PrimExpr& other : guards) {
+      if (ffi::StructuralEqual()(other, guard)) return true;
+    }
+    guards.push_back(guard);
+    return true;
+  }
+
   // the maximum possible bits, which serves as an init value
   static constexpr const int max_bits_ = 64;
   // the maximum possible bit of the current expression's return dtype
@@ -214,6 +269,12 @@ class DataTypeVisitor final : public StmtExprVisitor {
   std::unordered_map<const VarNode*, PrimType> vextent_;
   // the memorized bound generated by ConstIntBoundAnalyzer
   arith::ConstIntBoundAnalyzer::BoundMapType bound_;
+  // whether to narrow the expressions that fit under runtime conditions
+  bool guarded_{false};
+  // the integer vars the runtime conditions may use
+  std::unordered_set<const VarNode*> params_;
+  // the domains of the loop vars, relaxed into the params
+  std::unordered_map<const VarNode*, arith::IntSet> dom_map_;
 };
 
 class NarrowDataTypeRewriter : public IndexDataTypeRewriter {
@@ -221,6 +282,24 @@ class NarrowDataTypeRewriter : public IndexDataTypeRewriter {
   using Parent = IndexDataTypeRewriter;
   explicit NarrowDataTypeRewriter(int target_bits) : visitor_(target_bits) {}
 
+  /*!
+   * \brief Narrow under runtime conditions on the params.
+   * \param params The integer vars defined on entry of the function.
+   */
+  NarrowDataTypeRewriter(int target_bits, const std::vector<Var>& params)
+      : visitor_(target_bits) {
+    visitor_.EnableGuards(params);
+  }
+
+  /*! \brief The runtime conditions under which the rewritten statement is valid. */
+  const std::vector<PrimExpr>& guards() const { return visitor_.guards; }
+
+  /*! \brief The narrowed replacement of the var, or a null Var if it is unchanged. */
+  Var Remapped(const Var& var) const {
+    auto it = var_remap_.find(var.get());
+    return it != var_remap_.end() ? it->second : Var();
+  }
+
   Stmt operator()(Stmt s) {
     visitor_(s);
     for (auto i = visitor_.vmap.begin(), last = visitor_.vmap.end(); i != last;) {
@@ -322,15 +401,66 @@ Stmt NarrowDataType(Stmt stmt, int target_bits) {
   return NarrowDataTypeRewriter(target_bits)(stmt);
 }
 
+/*!
+ * \brief Version the body of the function into a narrowed fast path, valid when the runtime
+ *  conditions on the integer params hold, and the conservatively narrowed fallback.
+ */
+Stmt NarrowDataTypeWithRuntimeCheck(const PrimFunc& func, int target_bits) {
+  Stmt fallback = NarrowDataTypeRewriter(target_bits)(func->body);
+  std::vector<Var> params;
+  std::unordered_set<const VarNode*> visited;
+  auto add_param = [&](const Var& var) {
+    auto ty = var->ty.as<PrimType>();
+    if (ty && ty.value().MatchesCode(DLDataTypeCode::kDLInt) && ty.value().bits() > target_bits &&
+        visited.insert(var.get()).second) {
+      params.push_back(var);
+    }
+  };
+  for (const Var& param : func->params) add_param(param);
+  for (const auto& kv : func->buffer_map) {
+    for (const PrimExpr& dim : kv.second->shape) {
+      if (auto var = dim.as<Var>()) add_param(var.value());
+    }
+    for (const PrimExpr& stride : kv.second->strides) {
+      if (auto var = stride.as<Var>()) add_param(var.value());
+    }
+  }
+  if (params.empty()) return fallback;
+  NarrowDataTypeRewriter rewriter(target_bits, params);
+  Stmt fast = rewriter(func->body);
+  if (rewriter.guards().empty()) return fallback;
+  ffi::Array<Stmt> seq;
+  for (const Var& param : params) {
+    if (Var narrowed = rewriter.Remapped(param); narrowed.defined()) {
+      PrimType ty = narrowed->ty.as_or_throw<PrimType>();
+      seq.push_back(Bind(narrowed, cast(ty, param.as_or_throw<PrimExpr>())));
+    }
+  }
+  if (seq.empty()) return fallback;
+  seq.push_back(fast);
+  PrimExpr cond = rewriter.guards()[0];
+  for (size_t i = 1; i < rewriter.guards().size(); ++i) cond = cond && rewriter.guards()[i];
+  // Both versions define the same loop vars and buffers.
+  return ConvertSSA(IfThenElse(cond, SeqStmt(seq), fallback));
+}
+
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.narrow_datatype_runtime_check", bool);
+
 Pass NarrowDataType(int target_bits) {
   auto pass_func = [target_bits](PrimFunc f, IRModule m, PassContext ctx) {
+    if (ctx->GetConfig<bool>("tirx.narrow_datatype_runtime_check").value_or(false)) {
+      Stmt body = NarrowDataTypeWithRuntimeCheck(f, target_bits);
+      f.CopyOnWrite()->body = std::move(body);
+      return f;
+    }
     auto* n = f.CopyOnWrite();
     n->body = NarrowDataTypeRewriter(target_bits)(std::move(n->body));
     return f;
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.NarrowDataType", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.NarrowDataType", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
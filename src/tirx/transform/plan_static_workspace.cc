@@ -0,0 +1,365 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file plan_static_workspace.cc
+ * \brief Plan the workspaces of the host functions into one static arena of the module.
+ *
+ * The CPU allocations that LowerTVMBuiltin would turn into TVMBackendAllocWorkspace calls get
+ * a constant offset in an arena that the C host codegen emits as a static buffer, so that the
+ * generated code allocates no memory at runtime. The allocations of a function whose lifetimes
+ * do not overlap share memory. The region of a function follows the regions of all of its
+ * callers, and the functions that can not be live at the same time share the same region.
+ */
+#include <tvm/ffi/function.h>
+#include <tvm/ffi/reflection/registry.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/target/target.h>
+#include <tvm/tirx/builtin.h>
+#include <tvm/tirx/stmt_functor.h>
+#include <tvm/tirx/transform.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ir_utils.h"
+
+namespace tvm {
+namespace tirx {
+
+namespace {
+
+int64_t AlignUp(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/*! \brief An allocation placed in the arena, live in the statement positions [start, end]. */
+struct WorkspaceAlloc {
+  const VarNode* data;
+  int64_t nbytes;
+  int64_t start;
+  int64_t end;
+  int64_t offset{-1};
+};
+
+/*!
+ * \brief Collect the allocations of a function that become workspaces, and their lifetimes in
+ * the order of the statements.
+ */
+class WorkspaceCollector : public StmtExprVisitor {
+ public:
+  static std::vector<WorkspaceAlloc> Collect(const PrimFunc& func) {
+    WorkspaceCollector collector;
+    if (auto target = func->GetAttr<Target>(tvm::attr::kTarget)) {
+      collector.device_type_ = IntImm::Int32(target.value()->kind->default_device_type);
+    }
+    collector(func->body);
+    return collector.Finalize();
+  }
+
+ private:
+  void VisitStmt(const Stmt& stmt) final {
+    ++pos_;
+    StmtExprVisitor::VisitStmt(stmt);
+  }
+
+  void VisitStmt_(const AllocBufferNode* op) final {
+    StmtExprVisitor::VisitStmt_(op);
+    if (std::optional<int64_t> nbytes = WorkspaceBytes(op)) {
+      alloc_index_[op->buffer->data.get()] = allocs_.size();
+      allocs_.push_back({op->buffer->data.get(), nbytes.value(), pos_, pos_});
+    }
+  }
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::device_type) {
+      auto cache = device_type_;
+      device_type_ = op->value;
+      StmtExprVisitor::VisitStmt_(op);
+      device_type_ = cache;
+    } else {
+      StmtExprVisitor::VisitStmt_(op);
+    }
+  }
+
+  void VisitStmt_(const ForNode* op) final {
+    int64_t start = pos_;
+    parallel_depth_ += op->kind == ForKind::kParallel;
+    StmtExprVisitor::VisitStmt_(op);
+    parallel_depth_ -= op->kind == ForKind::kParallel;
+    loops_.push_back({start, pos_});
+  }
+
+  void VisitStmt_(const WhileNode* op) final {
+    int64_t start = pos_;
+    StmtExprVisitor::VisitStmt_(op);
+    loops_.push_back({start, pos_});
+  }
+
+  void VisitStmt_(const BufferStoreNode* op) final {
+    Touch(op->buffer->data.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    Touch(op->buffer->data.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const VarNode* op) final { Touch(op); }
+
+  void Touch(const VarNode* data) {
+    auto it = alloc_index_.find(data);
+    if (it != alloc_index_.end()) {
+      WorkspaceAlloc& alloc = allocs_[it->second];
+      alloc.end = std::max(alloc.end, pos_);
+    }
+  }
+
+  /*! \brief The bytes of the workspace of the allocation, if it is planned. */
+  std::optional<int64_t> WorkspaceBytes(const AllocBufferNode* op) {
+    if (op->annotations.count(transform::kDisableLowerTVMBuiltin)) {
+      if (op->annotations[transform::kDisableLowerTVMBuiltin].as_or_throw<IntImm>()->value) {
+        return std::nullopt;
+      }
+    }
+    const auto* dev_type = device_type_.as<IntImmNode>();
+    if (!dev_type || dev_type->value != kDLCPU || op->buffer->dtype.IsScalableVector()) {
+      return std::nullopt;
+    }
+    auto storage_scope = op->buffer->data->ty.as_or_throw<PointerType>()->storage_scope;
+    if (storage_scope != "global") {
+      return std::nullopt;
+    }
+    std::optional<int64_t> num_elem = ffi::GetRef<AllocBuffer>(op).ConstantAllocationSize();
+    if (!num_elem.has_value()) {
+      LOG(WARNING) << "The allocation of " << op->buffer->name
+                   << " has a dynamic shape, and stays a runtime workspace";
+      return std::nullopt;
+    }
+    int64_t nbytes = num_elem.value() * op->buffer->dtype.StorageBytes();
+    // LowerTVMBuiltin keeps these on the stack.
+    if (nbytes <= 0 || nbytes < runtime::kMaxStackAlloca) {
+      return std::nullopt;
+    }
+    if (parallel_depth_ > 0) {
+      LOG(WARNING) << "The allocation of " << op->buffer->name
+                   << " is private to the tasks of a parallel loop, and stays a runtime workspace";
+      return std::nullopt;
+    }
+    return nbytes;
+  }
+
+  std::vector<WorkspaceAlloc> Finalize() {
+    // An allocation that is live into a loop is live until the end of the loop, as the next
+    // iteration uses it again. The inner loops end first, so the extension propagates outwards.
+    std::sort(loops_.begin(), loops_.end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
+    for (WorkspaceAlloc& alloc : allocs_) {
+      for (const auto& [start, end] : loops_) {
+        if (alloc.start < start && start <= alloc.end && alloc.end < end) {
+          alloc.end = end;
+        }
+      }
+    }
+    return std::move(allocs_);
+  }
+
+  int64_t pos_{0};
+  int parallel_depth_{0};
+  ffi::Optional<PrimExpr> device_type_{std::nullopt};
+  std::vector<WorkspaceAlloc> allocs_;
+  std::unordered_map<const VarNode*, size_t> alloc_index_;
+  std::vector<std::pair<int64_t, int64_t>> loops_;
+};
+
+/*!
+ * \brief Assign the offsets of the allocations of a function, greedily by decreasing size.
+ * \return The size of the region of the function.
+ */
+int64_t PlaceWorkspaces(std::vector<WorkspaceAlloc>* allocs, int64_t alignment) {
+  std::vector<WorkspaceAlloc*> order;
+  for (WorkspaceAlloc& alloc : *allocs) {
+    order.push_back(&alloc);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const WorkspaceAlloc* a, const WorkspaceAlloc* b) {
+                     return a->nbytes > b->nbytes;
+                   });
+  int64_t region_bytes = 0;
+  std::vector<const WorkspaceAlloc*> placed;
+  for (WorkspaceAlloc* alloc : order) {
+    std::vector<const WorkspaceAlloc*> live;
+    for (const WorkspaceAlloc* other : placed) {
+      if (other->start <= alloc->end && alloc->start <= other->end) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(), [](const WorkspaceAlloc* a, const WorkspaceAlloc* b) {
+      return a->offset < b->offset;
+    });
+    // The lowest aligned offset that overlaps none of the live allocations.
+    int64_t offset = 0;
+    for (const WorkspaceAlloc* other : live) {
+      if (offset + alloc->nbytes <= other->offset) break;
+      offset = std::max(offset, AlignUp(other->offset + other->nbytes, alignment));
+    }
+    alloc->offset = offset;
+    region_bytes = std::max(region_bytes, offset + alloc->nbytes);
+    placed.push_back(alloc);
+  }
+  return AlignUp(region_bytes, alignment);
+}
+
+/*! \brief Replace the planned allocations by pointers into the static arena. */
+class WorkspaceRewriter : public StmtExprMutator {
+ public:
+  explicit WorkspaceRewriter(const std::vector<WorkspaceAlloc>& allocs, int64_t base) {
+    for (const WorkspaceAlloc& alloc : allocs) {
+      offsets_[alloc.data] = base + alloc.offset;
+    }
+  }
+
+ private:
+  Stmt VisitStmt_(const AllocBufferNode* op) final {
+    auto it = offsets_.find(op->buffer->data.get());
+    if (it == offsets_.end()) {
+      return StmtExprMutator::VisitStmt_(op);
+    }
+    const Var& data = op->buffer->data;
+    return Bind(data, Call(data->ty, builtin::static_workspace_ptr(), {IntImm::Int64(it->second)}));
+  }
+
+  std::unordered_map<const VarNode*, int64_t> offsets_;
+};
+
+/*! \brief The symbol of the function that a call invokes by name, if any. */
+ffi::Optional<ffi::String> CalleeSymbol(const CallNode* op) {
+  if (!op->op.same_as(builtin::call_extern()) && !op->op.same_as(builtin::tvm_call_packed()) &&
+      !op->op.same_as(builtin::tvm_call_cpacked())) {
+    return std::nullopt;
+  }
+  if (op->args.empty()) return std::nullopt;
+  if (const auto* name = op->args[0].as<StringImmNode>()) {
+    return name->value;
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+namespace transform {
+
+Pass PlanStaticWorkspace() {
+  auto pass_func = [](IRModule mod, PassContext ctx) {
+    int64_t alignment = runtime::kAllocAlignment;
+    std::unordered_map<std::string, GlobalVar> gvar_by_symbol;
+    std::vector<GlobalVar> planned;
+    for (const auto& [gvar, base_func] : mod->functions) {
+      auto func = base_func.as<PrimFunc>();
+      if (!func) continue;
+      if (auto symbol = func.value()->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol)) {
+        gvar_by_symbol[symbol.value()] = gvar;
+      }
+      auto target = func.value()->GetAttr<Target>(tvm::attr::kTarget);
+      if (IsHostFunc(func.value()).value_or(false) && target &&
+          target.value()->kind->name == "c") {
+        planned.push_back(gvar);
+        int64_t target_alignment = target.value()
+                                       ->GetAttr<int64_t>("workspace-byte-alignment")
+                                       .value_or(runtime::kAllocAlignment);
+        alignment = std::max(alignment, target_alignment);
+      }
+    }
+    if (planned.empty()) return mod;
+
+    // The callers of each function of the module.
+    std::unordered_map<const GlobalVarNode*, std::unordered_set<const GlobalVarNode*>> callers;
+    for (const auto& [caller, base_func] : mod->functions) {
+      auto func = base_func.as<PrimFunc>();
+      if (!func) continue;
+      PostOrderVisit(func.value()->body, [&](const ObjectRef& node) {
+        const auto* call = node.as<CallNode>();
+        if (!call) return;
+        if (auto gvar = call->op.as<GlobalVar>()) {
+          callers[gvar.value().get()].insert(caller.get());
+        } else if (auto symbol = CalleeSymbol(call)) {
+          auto it = gvar_by_symbol.find(symbol.value());
+          if (it != gvar_by_symbol.end()) callers[it->second.get()].insert(caller.get());
+        }
+      });
+    }
+
+    std::unordered_map<const GlobalVarNode*, std::vector<WorkspaceAlloc>> allocs;
+    std::unordered_map<const GlobalVarNode*, int64_t> region_bytes;
+    for (const GlobalVar& gvar : planned) {
+      allocs[gvar.get()] = WorkspaceCollector::Collect(mod->Lookup(gvar).as_or_throw<PrimFunc>());
+      region_bytes[gvar.get()] = PlaceWorkspaces(&allocs[gvar.get()], alignment);
+    }
+
+    // The region of a function starts after the regions of all functions on its call stacks.
+    std::unordered_map<const GlobalVarNode*, int64_t> base;
+    std::unordered_set<const GlobalVarNode*> visiting;
+    std::function<int64_t(const GlobalVarNode*)> get_base = [&](const GlobalVarNode* gvar) {
+      if (auto it = base.find(gvar); it != base.end()) return it->second;
+      TVM_FFI_CHECK(visiting.insert(gvar).second, ValueError)
+          << "PlanStaticWorkspace does not support the recursive function " << gvar->name_hint;
+      int64_t value = 0;
+      for (const GlobalVarNode* caller : callers[gvar]) {
+        auto it = region_bytes.find(caller);
+        int64_t caller_bytes = it == region_bytes.end() ? 0 : it->second;
+        value = std::max(value, get_base(caller) + caller_bytes);
+      }
+      visiting.erase(gvar);
+      base[gvar] = value;
+      return value;
+    };
+
+    int64_t arena_bytes = 0;
+    IRModule updates;
+    for (const GlobalVar& gvar : planned) {
+      int64_t func_base = get_base(gvar.get());
+      arena_bytes = std::max(arena_bytes, func_base + region_bytes[gvar.get()]);
+      if (allocs[gvar.get()].empty()) continue;
+      PrimFunc func = mod->Lookup(gvar).as_or_throw<PrimFunc>();
+      func.CopyOnWrite()->body = WorkspaceRewriter(allocs[gvar.get()], func_base)(func->body);
+      updates->Add(gvar, func);
+    }
+    VLOG(1) << "PlanStaticWorkspace: the static workspace arena takes " << arena_bytes << " bytes";
+
+    if (updates->functions.size()) {
+      mod.CopyOnWrite()->Update(updates);
+    }
+    return WithAttr(std::move(mod), kStaticWorkspaceBytes, IntImm::Int64(arena_bytes));
+  };
+  return tvm::transform::CreateModulePass(pass_func, 0, "tirx.PlanStaticWorkspace", {});
+}
+
+TVM_FFI_STATIC_INIT_BLOCK() {
+  namespace refl = tvm::ffi::reflection;
+  refl::GlobalDef().def("tirx.transform.PlanStaticWorkspace", PlanStaticWorkspace);
+}
+
+}  // namespace transform
+}  // namespace tirx
+}  // namespace tvm
@@ -55,7 +55,8 @@ Pass RemoveAssumeInternal() {
     n->body = AssumeRemover()(std::move(n->body));
     return f;
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.RemoveAssumeInternal", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.RemoveAssumeInternal", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 Pass RemoveAssume() {
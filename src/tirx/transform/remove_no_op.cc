@@ -298,7 +298,8 @@ Pass RemoveNoOp() {
     }
     return f;
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.RemoveNoOp", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.RemoveNoOp", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -23,6 +23,8 @@
 #include <tvm/tirx/stmt_functor.h>
 #include <tvm/tirx/transform.h>
 
+#include "ir_utils.h"
+
 namespace tvm {
 namespace tirx {
 
@@ -44,7 +46,8 @@ Pass SkipAssert() {
     n->body = AssertSkipper()(std::move(n->body));
     return f;
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.SkipAssert", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.SkipAssert", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -21,6 +21,7 @@
  * \file split_host_device.cc
  * \brief Annotate and split device functions from host, then lower kernel launches.
  */
+#include <tvm/arith/analyzer.h>
 #include <tvm/ffi/cast.h>
 #include <tvm/ffi/function.h>
 #include <tvm/ffi/reflection/registry.h>
@@ -34,7 +35,13 @@
 #include <tvm/tirx/stmt_functor.h>
 #include <tvm/tirx/transform.h>
 
+#include <algorithm>
+#include <map>
 #include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "../../runtime/thread_storage_scope.h"
 #include "../analysis/var_use_def_analysis.h"
@@ -43,6 +50,38 @@
 namespace tvm {
 namespace tirx {
 
+struct SplitHostDeviceConfigNode : public ffi::Object {
+  bool coalesce_kernels;
+  int64_t grid_sync_blocks;
+
+  static void RegisterReflection() {
+    namespace refl = tvm::ffi::reflection;
+    refl::ObjectDef<SplitHostDeviceConfigNode>()
+        .def_ro("coalesce_kernels", &SplitHostDeviceConfigNode::coalesce_kernels,
+                "If true, consecutive device regions with the same target and thread extents "
+                "are merged into one kernel, to save the launch overhead of small kernels.",
+                refl::DefaultValue(false))
+        .def_ro("grid_sync_blocks", &SplitHostDeviceConfigNode::grid_sync_blocks,
+                "The number of blocks of the persistent kernel that merges CUDA regions which "
+                "depend on each other, separated by grid-wide syncs under a cooperative launch.  "
+                "It must not exceed the blocks that can be resident on the device at once.  "
+                "If zero, only the independent regions are merged.",
+                refl::DefaultValue(0));
+  }
+  TVM_FFI_DECLARE_OBJECT_INFO_FINAL("tirx.transform.SplitHostDeviceConfig",
+                                    SplitHostDeviceConfigNode, ffi::Object);
+};
+
+class SplitHostDeviceConfig : public ffi::ObjectRef {
+ public:
+  TVM_FFI_DEFINE_OBJECT_REF_METHODS_NOTNULLABLE(SplitHostDeviceConfig, ffi::ObjectRef,
+                                                SplitHostDeviceConfigNode);
+};
+
+TVM_FFI_STATIC_INIT_BLOCK() { SplitHostDeviceConfigNode::RegisterReflection(); }
+
+TVM_REGISTER_PASS_CONFIG_OPTION("tirx.SplitHostDevice", SplitHostDeviceConfig);
+
 // Device-region annotation
 
 class DeviceRegionAnnotater : public StmtMutator {
@@ -115,11 +154,353 @@ class LaunchBoundsAttrExtractor : public StmtMutator {
   std::optional<int64_t> min_blocks_per_sm_;
 };
 
+// Kernel launch coalescing
+
+namespace {
+
+/*! \brief The static shared memory available to one block without an opt-in, in bytes. */
+constexpr int64_t kMaxStaticSharedBytes = 48 * 1024;
+
+/*! \brief The variable and the tag of the thread axis bound by a thread_extent attribute. */
+std::pair<PrimVar, ffi::String> GetThreadAxis(const AttrStmtNode* op) {
+  if (auto iv = op->node.as<IterVar>()) {
+    return {iv.value()->var, iv.value()->thread_tag};
+  }
+  auto var = op->node.as<Var>();
+  if (!var) {
+    TVM_FFI_THROW(TypeError) << "thread_extent node must be an IterVar or Var, but was "
+                             << op->node.GetTypeKey();
+  }
+  return {var.value().as_or_throw<PrimVar>(), var.value()->name};
+}
+
+/*! \brief A device region that may be merged with the regions next to it into one kernel. */
+struct CoalescableRegion {
+  /*! \brief The device target of the region. */
+  Target target;
+  /*! \brief The body of the region, under its target attribute. */
+  Stmt body;
+  /*! \brief The extent of blockIdx.x, 1 when the region does not bind it. */
+  PrimExpr num_blocks;
+  /*! \brief The extent of each threadIdx axis, by tag. */
+  std::map<std::string, PrimExpr> thread_extents;
+  /*! \brief The data of the buffers read by the region. */
+  std::unordered_set<const VarNode*> reads;
+  /*! \brief The data of the buffers written by the region. */
+  std::unordered_set<const VarNode*> writes;
+  /*! \brief The static shared memory allocated by the region, in bytes. */
+  int64_t shared_bytes{0};
+
+  /*! \brief Whether the region must wait for an earlier region to complete. */
+  bool DependsOn(const CoalescableRegion& earlier) const {
+    for (const VarNode* data : earlier.writes) {
+      if (reads.count(data) || writes.count(data)) return true;
+    }
+    for (const VarNode* data : writes) {
+      if (earlier.reads.count(data)) return true;
+    }
+    return false;
+  }
+};
+
+/*!
+ * \brief Visitor class to analyze a device region for merging.
+ *
+ * A region may be merged when its only block axis is blockIdx.x, each of its thread axes has the
+ * same extent wherever it is bound, the extents are defined outside of the region, and it does
+ * not use dynamic shared memory, launch bounds, or grid-wide syncs of its own.
+ */
+class CoalescableRegionCollector : public StmtExprVisitor {
+ public:
+  static std::optional<CoalescableRegion> Collect(const AttrStmtNode* op) {
+    if (op->attr_key != tvm::attr::kTarget) return std::nullopt;
+    Target target = op->node.as<Target>().value().WithoutHost();
+    auto device_type = target->GetTargetDeviceType();
+    if (device_type == kDLCPU || device_type == kDLExtDev || device_type == kDLHexagon) {
+      return std::nullopt;
+    }
+
+    CoalescableRegionCollector collector;
+    collector(op->body);
+    if (!collector.can_merge_ || collector.extents_.empty()) return std::nullopt;
+
+    // The extents are bound once for the merged kernel, outside of the regions.
+    VarUseDefAnalyzer use_def(/*defined_vars=*/{}, /*visit_thread_extent=*/true);
+    use_def(op->body);
+    std::unordered_set<const VarNode*> free_vars;
+    for (const Var& var : use_def.undefined_) {
+      free_vars.insert(var.get());
+    }
+    for (const auto& [tag, extent] : collector.extents_) {
+      if (UsesVar(extent, [&](const VarNode* var) { return !free_vars.count(var); })) {
+        return std::nullopt;
+      }
+    }
+
+    CoalescableRegion region;
+    region.target = target;
+    region.body = op->body;
+    region.num_blocks = IntImm(PrimType::Int(32), 1);
+    for (const auto& [tag, extent] : collector.extents_) {
+      if (tag == "blockIdx.x") {
+        region.num_blocks = extent;
+      } else {
+        region.thread_extents[tag] = extent;
+      }
+    }
+    region.reads = std::move(collector.reads_);
+    region.writes = std::move(collector.writes_);
+    region.shared_bytes = collector.shared_bytes_;
+    return region;
+  }
+
+ private:
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent) {
+      std::string tag = GetThreadAxis(op).second;
+      if (tag != "blockIdx.x" && tag.rfind("threadIdx.", 0) != 0) {
+        can_merge_ = false;
+      } else if (auto it = extents_.find(tag); it == extents_.end()) {
+        extents_.emplace(tag, op->value);
+      } else if (!analyzer_->CanProveEqual(it->second, op->value)) {
+        can_merge_ = false;
+      }
+    } else if (op->attr_key == tirx::attr::kLaunchBoundsMinBlocksPerSM ||
+               op->attr_key == tvm::attr::kTarget) {
+      can_merge_ = false;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AllocBufferNode* op) final {
+    auto storage_scope = runtime::StorageScope::Create(GetPtrStorageScope(op->buffer->data));
+    if (storage_scope.rank == runtime::StorageRank::kShared) {
+      // The dynamic shared memory of a kernel is a single allocation.
+      can_merge_ = can_merge_ && storage_scope.tag != ".dyn";
+      int64_t bytes = op->buffer->dtype.StorageBytes();
+      for (const PrimExpr& extent : op->buffer->shape) {
+        if (const auto* int_extent = extent.as<IntImmNode>()) {
+          bytes *= int_extent->value;
+        } else {
+          can_merge_ = false;
+        }
+      }
+      shared_bytes_ += bytes;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const BufferStoreNode* op) final {
+    writes_.insert(op->buffer->data.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const ReturnNode* op) final {
+    can_merge_ = false;
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    reads_.insert(op->buffer->data.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    static const Op& grid_sync_op = Op::Get("tirx.cuda.grid_sync");
+    if (op->op.same_as(grid_sync_op)) {
+      can_merge_ = false;
+    } else if (op->op.same_as(builtin::address_of())) {
+      // The address may be written through.
+      for (const Expr& arg : op->args) {
+        if (const auto* load = arg.as<BufferLoadNode>()) {
+          writes_.insert(load->buffer->data.get());
+        }
+      }
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    // A pointer used other than by a buffer access, e.g. passed to an intrinsic, may be both
+    // read and written.
+    if (op->ty.as<PointerTypeNode>()) {
+      reads_.insert(op);
+      writes_.insert(op);
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  // Whether the region may be merged.
+  bool can_merge_{true};
+  // The extent of each launch axis, by tag.
+  std::map<std::string, PrimExpr> extents_;
+  // The data of the buffers read and written.
+  std::unordered_set<const VarNode*> reads_;
+  std::unordered_set<const VarNode*> writes_;
+  // The static shared memory allocated, in bytes.
+  int64_t shared_bytes_{0};
+  arith::Analyzer analyzer_;
+};
+
+/*!
+ * \brief Mutator class to move a device region onto the launch axes of a merged kernel.
+ *
+ * The thread_extent attributes of the region are removed, and its launch axes are replaced by
+ * the given expressions of the axes of the merged kernel.
+ */
+class LaunchAxisRewriter : public StmtExprMutator {
+ public:
+  static Stmt Rewrite(const Stmt& body, const std::unordered_map<std::string, PrimExpr>& axes) {
+    LaunchAxisRewriter rewriter(axes);
+    return rewriter(body);
+  }
+
+ private:
+  explicit LaunchAxisRewriter(const std::unordered_map<std::string, PrimExpr>& axes)
+      : axes_(axes) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent) {
+      auto [var, tag] = GetThreadAxis(op);
+      auto it = axes_.find(tag);
+      TVM_FFI_ICHECK(it != axes_.end()) << "The merged kernel does not bind " << tag;
+      vmap_[var.get()] = cast(var.ty(), it->second);
+      return VisitStmt(op->body);
+    }
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
+  Expr VisitExpr_(const VarNode* op) final {
+    auto it = vmap_.find(op);
+    if (it != vmap_.end()) return it->second;
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
+  // The expression of each launch axis of the region, by tag.
+  const std::unordered_map<std::string, PrimExpr>& axes_;
+  // The replacement of each launch axis variable of the region.
+  std::unordered_map<const VarNode*, PrimExpr> vmap_;
+};
+
+/*! \brief Create the IterVar of a launch axis of a merged kernel. */
+IterVar MakeLaunchAxis(const std::string& tag, const PrimExpr& extent) {
+  std::string name = tag;
+  std::replace(name.begin(), name.end(), '.', '_');
+  PrimType dtype = extent.ty();
+  return IterVar(Range::FromMinExtent(IntImm(dtype, 0), extent), PrimVar(name, dtype),
+                 IterVarType::kThreadIndex, tag);
+}
+
+/*!
+ * \brief Merge a run of device regions into the body of one kernel.
+ *
+ * Without a grid-wide sync, the kernel launches the blocks of all regions, and each block runs
+ * the region its index falls in.  With it, the kernel is persistent: it launches at most the
+ * given number of blocks, each region strides over its own blocks, and a grid-wide sync
+ * separates each region from the earlier regions it depends on.
+ */
+Stmt MergeDeviceRegions(const std::vector<CoalescableRegion>& regions, bool use_grid_sync,
+                        int64_t grid_sync_blocks) {
+  static const Op& grid_sync_op = Op::Get("tirx.cuda.grid_sync");
+  arith::Analyzer analyzer;
+  PrimType block_dtype = regions[0].num_blocks.ty();
+  std::vector<PrimExpr> num_blocks;
+  for (const CoalescableRegion& region : regions) {
+    num_blocks.push_back(cast(block_dtype, region.num_blocks));
+  }
+
+  PrimExpr grid_extent;
+  if (!use_grid_sync) {
+    grid_extent = num_blocks[0];
+    for (size_t i = 1; i < regions.size(); ++i) {
+      grid_extent = grid_extent + num_blocks[i];
+    }
+  } else {
+    grid_extent = IntImm(block_dtype, grid_sync_blocks);
+    PrimExpr max_blocks = num_blocks[0];
+    for (size_t i = 1; i < regions.size(); ++i) {
+      max_blocks = max(max_blocks, num_blocks[i]);
+    }
+    if (const auto* int_max_blocks = analyzer->Simplify(max_blocks).as<IntImmNode>()) {
+      grid_extent = IntImm(block_dtype, std::min(int_max_blocks->value, grid_sync_blocks));
+    }
+  }
+  IterVar block_axis = MakeLaunchAxis("blockIdx.x", analyzer->Simplify(grid_extent));
+  PrimExpr block_var = block_axis->var;
+
+  std::unordered_map<std::string, PrimExpr> axes;
+  std::vector<IterVar> thread_axes;
+  for (const auto& [tag, extent] : regions[0].thread_extents) {
+    thread_axes.push_back(MakeLaunchAxis(tag, extent));
+    axes[tag] = thread_axes.back()->var;
+  }
+  auto rewrite_region = [&](size_t i, PrimExpr block_index) {
+    axes["blockIdx.x"] = analyzer->Simplify(block_index);
+    return LaunchAxisRewriter::Rewrite(regions[i].body, axes);
+  };
+
+  Stmt body;
+  if (!use_grid_sync) {
+    // Each region is dispatched to its own range of blocks by a branch, with the last region
+    // taking the remaining blocks.
+    std::vector<PrimExpr> offsets{IntImm(block_dtype, 0)};
+    for (size_t i = 0; i + 1 < regions.size(); ++i) {
+      offsets.push_back(analyzer->Simplify(offsets.back() + num_blocks[i]));
+    }
+    for (size_t i = regions.size(); i-- > 0;) {
+      Stmt region_body = rewrite_region(i, block_var - offsets[i]);
+      if (body.defined()) {
+        body = IfThenElse(block_var < offsets[i + 1], region_body, body);
+      } else {
+        body = region_body;
+      }
+    }
+  } else {
+    std::vector<Stmt> seq;
+    size_t synced = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+      bool depends = std::any_of(regions.begin() + synced, regions.begin() + i,
+                                 [&](const CoalescableRegion& earlier) {
+                                   return regions[i].DependsOn(earlier);
+                                 });
+      if (depends) {
+        seq.push_back(Evaluate(Call(PrimType::Void(), grid_sync_op, {}).as_or_throw<PrimExpr>()));
+        synced = i;
+      }
+      if (analyzer->CanProveEqual(num_blocks[i], block_axis->dom->extent)) {
+        seq.push_back(rewrite_region(i, block_var));
+      } else if (analyzer->CanProve(num_blocks[i] <= block_axis->dom->extent)) {
+        seq.push_back(IfThenElse(block_var < num_blocks[i], rewrite_region(i, block_var)));
+      } else {
+        // The blocks of the region are strided over by the blocks of the kernel.
+        PrimVar block_iter("block_iter", block_dtype);
+        PrimExpr block_index = block_var + block_iter * block_axis->dom->extent;
+        Stmt region_body =
+            IfThenElse(block_index < num_blocks[i], rewrite_region(i, block_index));
+        seq.push_back(For(block_iter, IntImm(block_dtype, 0),
+                          analyzer->Simplify(ceildiv(num_blocks[i], block_axis->dom->extent)),
+                          ForKind::kSerial, region_body));
+      }
+    }
+    body = SeqStmt::Flatten(seq);
+  }
+
+  for (auto it = thread_axes.rbegin(); it != thread_axes.rend(); ++it) {
+    body = AttrStmt(*it, attr::thread_extent, (*it)->dom->extent, body);
+  }
+  return AttrStmt(block_axis, attr::thread_extent, block_axis->dom->extent, body);
+}
+
+}  // namespace
+
 class HostDeviceSplitter : public StmtMutator {
  public:
   explicit HostDeviceSplitter(IRModule* device_mod, std::function<GlobalVar()> var_supply,
-                              PrimFunc cur_func)
-      : device_mod_(device_mod), var_supply_(var_supply), cur_func_(cur_func) {}
+                              PrimFunc cur_func, SplitHostDeviceConfig config)
+      : device_mod_(device_mod),
+        var_supply_(var_supply),
+        cur_func_(cur_func),
+        config_(std::move(config)) {}
 
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == tvm::attr::kTarget) {
@@ -129,7 +510,78 @@ class HostDeviceSplitter : public StmtMutator {
     return StmtMutator::VisitStmt_(op);
   }
 
+  Stmt VisitStmt_(const SeqStmtNode* op) final {
+    if (!config_->coalesce_kernels) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    ffi::Array<Stmt> seq;
+    size_t i = 0;
+    while (i < op->seq.size()) {
+      // Collect the longest run of device regions from i that may share one kernel.
+      std::vector<CoalescableRegion> run;
+      bool use_grid_sync = false;
+      for (size_t j = i; j < op->seq.size(); ++j) {
+        const auto* attr = op->seq[j].as<AttrStmtNode>();
+        std::optional<CoalescableRegion> region =
+            attr ? CoalescableRegionCollector::Collect(attr) : std::nullopt;
+        if (!region.has_value() || (!run.empty() && !CanAppend(run, *region, &use_grid_sync))) {
+          break;
+        }
+        run.push_back(std::move(region.value()));
+      }
+      if (run.size() > 1) {
+        Stmt body = MergeDeviceRegions(run, use_grid_sync, config_->grid_sync_blocks);
+        seq.push_back(SplitDeviceFunc(body, run[0].target));
+        i += run.size();
+      } else {
+        seq.push_back(VisitStmt(op->seq[i]));
+        ++i;
+      }
+    }
+    return SeqStmt::Flatten(seq);
+  }
+
  private:
+  /*!
+   * \brief Whether a device region may join a run of regions in one kernel.
+   *
+   * The regions must share the target and the thread extents, and fit the static shared
+   * memory of a block together.  A region that depends on an earlier one requires the run to
+   * use grid-wide syncs, which are only available to CUDA with `grid_sync_blocks` set.
+   */
+  bool CanAppend(const std::vector<CoalescableRegion>& run, const CoalescableRegion& region,
+                 bool* use_grid_sync) const {
+    const CoalescableRegion& first = run[0];
+    if (region.target->str() != first.target->str() ||
+        region.thread_extents.size() != first.thread_extents.size()) {
+      return false;
+    }
+    arith::Analyzer analyzer;
+    for (const auto& [tag, extent] : first.thread_extents) {
+      auto it = region.thread_extents.find(tag);
+      if (it == region.thread_extents.end() || !analyzer->CanProveEqual(it->second, extent)) {
+        return false;
+      }
+    }
+    int64_t shared_bytes = region.shared_bytes;
+    for (const CoalescableRegion& earlier : run) {
+      shared_bytes += earlier.shared_bytes;
+    }
+    if (shared_bytes > kMaxStaticSharedBytes) {
+      return false;
+    }
+    bool depends = std::any_of(run.begin(), run.end(), [&](const CoalescableRegion& earlier) {
+      return region.DependsOn(earlier);
+    });
+    if (depends) {
+      if (region.target->kind->name != "cuda" || config_->grid_sync_blocks <= 0) {
+        return false;
+      }
+      *use_grid_sync = true;
+    }
+    return true;
+  }
+
   Stmt SplitDeviceFunc(Stmt body, Target device_target) {
     auto [params, buffers_to_declare] = [&]() -> std::tuple<ffi::Array<Var>, ffi::Array<Buffer>> {
       VarUseDefAnalyzer use_def(/*defined_vars=*/{}, /*visit_thread_extent=*/true);
@@ -222,11 +674,13 @@ class HostDeviceSplitter : public StmtMutator {
   std::function<GlobalVar()> var_supply_;
   // Current function being split
   PrimFunc cur_func_;
+  // The configuration of the pass
+  SplitHostDeviceConfig config_;
 };
 
-PrimFunc SplitHostDevice(PrimFunc func, IRModule* device_mod,
-                         std::function<GlobalVar()> var_supply) {
-  HostDeviceSplitter splitter(device_mod, var_supply, func);
+PrimFunc SplitHostDevice(PrimFunc func, IRModule* device_mod, std::function<GlobalVar()> var_supply,
+                         SplitHostDeviceConfig config) {
+  HostDeviceSplitter splitter(device_mod, var_supply, func, std::move(config));
 
   if (auto body = splitter(func->body); !body.same_as(func->body)) {
     func.CopyOnWrite()->body = body;
@@ -274,6 +728,10 @@ class DeviceInfoCollector : public StmtVisitor {
 
     collector(func->body);
 
+    // A grid-wide sync requires all blocks to be resident at once.
+    if (collector.uses_grid_sync) {
+      collector.info_.launch_params.push_back(tvm::runtime::launch_param::kUseCooperativeLaunch);
+    }
     // The dynamic shared memory is required to be the last of the
     // kernel launch parameters.
     if (collector.dyn_shmem_size) {
@@ -284,8 +742,12 @@ class DeviceInfoCollector : public StmtVisitor {
     collector.info_.global_symbol =
         func->GetAttr<ffi::String>(tvm::attr::kGlobalSymbol).value_or(gvar->name_hint);
 
-    collector.info_.launch_args = collector.info_.launch_params.Map(
-        [&](const auto& param) { return collector.GetArgument(param); });
+    // The cooperative launch is a flag, without an argument.
+    for (const auto& param : collector.info_.launch_params) {
+      if (param != tvm::runtime::launch_param::kUseCooperativeLaunch) {
+        collector.info_.launch_args.push_back(collector.GetArgument(param));
+      }
+    }
 
     return collector.info_;
   }
@@ -373,6 +835,14 @@ class DeviceInfoCollector : public StmtVisitor {
     StmtVisitor::VisitStmt_(op);
   }
 
+  void VisitStmt_(const EvaluateNode* op) final {
+    static const Op& grid_sync_op = Op::Get("tirx.cuda.grid_sync");
+    if (const auto* call = op->value.as<CallNode>(); call && call->op.same_as(grid_sync_op)) {
+      uses_grid_sync = true;
+    }
+    StmtVisitor::VisitStmt_(op);
+  }
+
   // The collected results.
   KernelInfo info_;
   // Recording what thread axis have been visited.
@@ -381,6 +851,8 @@ class DeviceInfoCollector : public StmtVisitor {
   ffi::Map<ffi::String, PrimExpr> thread_extent;
   // The amount of dynamic shared memory used.
   ffi::Optional<PrimExpr> dyn_shmem_size{std::nullopt};
+  // Whether the kernel syncs the whole grid.
+  bool uses_grid_sync{false};
   // Accumulated Bind definitions for inlining into extent/size expressions.
   ffi::Map<Var, PrimExpr> bind_map_;
 };
@@ -676,6 +1148,10 @@ namespace transform {
 
 Pass SplitHostDevice() {
   auto pass_func = [](IRModule mod, PassContext ctx) {
+    auto config = ctx->GetConfig<SplitHostDeviceConfig>("tirx.SplitHostDevice");
+    if (!config.has_value()) {
+      config = tvm::transform::PassConfigWithDefaults<SplitHostDeviceConfig>();
+    }
     UniqueNameSupply global_names(mod->functions.begin(), mod->functions.end(),
                                   [](const auto& kv) { return kv.first->name_hint; });
 
@@ -694,7 +1170,7 @@ Pass SplitHostDevice() {
           return GlobalVar(global_names->FreshName(kernel_name, false));
         };
 
-        func = SplitHostDevice(std::move(func), &device_mod, var_supply);
+        func = SplitHostDevice(std::move(func), &device_mod, var_supply, config.value());
         if (!func.same_as(base_func)) {
           updates->Add(gvar, func);
         }
@@ -45,6 +45,7 @@ struct StmtSimplifyConfigNode : public ffi::Object {
   bool transitively_prove_inequalities;
   bool convert_boolean_to_and_of_ors;
   bool apply_constraints_to_boolean_branches;
+  int64_t memo_table_size;
 
   static void RegisterReflection() {
     namespace refl = tvm::ffi::reflection;
@@ -60,7 +61,10 @@ struct StmtSimplifyConfigNode : public ffi::Object {
                 &StmtSimplifyConfigNode::apply_constraints_to_boolean_branches,
                 "If true, simplify each branch of AND/OR under constraints provided by the other "
                 "branch",
-                refl::DefaultValue(false));
+                refl::DefaultValue(false))
+        .def_ro("memo_table_size", &StmtSimplifyConfigNode::memo_table_size,
+                "If positive, memoize up to this many top-level simplification results",
+                refl::DefaultValue(0));
   }
   TVM_FFI_DECLARE_OBJECT_INFO_FINAL("tirx.transform.StmtSimplifyConfig", StmtSimplifyConfigNode,
                                     ffi::Object);
@@ -102,6 +106,10 @@ class StmtSimplifier : public IRMutatorWithAnalyzer {
                         ffi::Optional<StmtSimplifyConfig> config_opt = std::nullopt) {
     auto config = config_opt.value_or(MakeDefaultStmtSimplifyConfig());
     analyzer->rewrite_simplify.SetEnabledExtensions(config->GetEnabledExtensions());
+    if (config->memo_table_size > 0) {
+      analyzer->rewrite_simplify.SetMemoTableSize(config->memo_table_size);
+      analyzer->canonical_simplify.SetMemoTableSize(config->memo_table_size);
+    }
 
     StmtSimplifier simplifier(analyzer, config);
     simplifier.MarkBufferMapShapes(func);
@@ -273,7 +281,8 @@ Pass StmtSimplify() {
 
     return arith::StmtSimplifier::Apply(f, analyzer, cfg);
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.StmtSimplify", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.StmtSimplify", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
@@ -290,7 +290,8 @@ Pass UnrollLoop() {
     n->body = UnrollLoop(std::move(f->body), cfg.value());
     return f;
   };
-  return CreatePrimFuncPass(pass_func, 0, "tirx.UnrollLoop", {});
+  return CreatePrimFuncPass(pass_func, 0, "tirx.UnrollLoop", {}, /*traceable=*/false,
+                            /*thread_safe=*/true);
 }
 
 TVM_FFI_STATIC_INIT_BLOCK() {
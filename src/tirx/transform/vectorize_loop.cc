@@ -35,6 +35,8 @@
 #include <tvm/tirx/stmt_functor.h>
 #include <tvm/tirx/transform.h>
 
+#include <algorithm>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -86,6 +88,71 @@ bool TargetHasVLA(Target target) {
   return has_vla;
 }
 
+/*!
+ * \brief Whether fixed-width and symbolic vectorized loops are lowered to scalable vectors.
+ *
+ * Controlled by "tirx.vectorize_scalable". When unset, only RVV targets use scalable chunks.
+ */
+bool EnableScalableVectorization(Target target) {
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  ffi::Optional<bool> enable = pass_ctx->GetConfig<bool>("tirx.vectorize_scalable");
+  if (enable.has_value()) {
+    return enable.value() && TargetHasVLA(target);
+  }
+  return TargetHasRVV(target);
+}
+
+// File-local helper: true if the target has AVX-512 masked loads and stores.
+bool TargetHasAVX512(Target target) {
+  if (!target.defined()) return false;
+  static auto target_has_feature_fn = tvm::ffi::Function::GetGlobal("target.target_has_feature");
+  return target_has_feature_fn.has_value() &&
+         (*target_has_feature_fn)("avx512f", target).cast<bool>();
+}
+
+/*!
+ * \brief Whether vectorized loops whose extent is not a multiple of the native vector width
+ * are lowered to full-width chunks with a masked tail.
+ *
+ * Controlled by "tirx.vectorize_masked_tail" and limited to targets with masked memory
+ * accesses (AVX-512, SVE, RVV). Disabled when unset.
+ */
+bool EnableMaskedTail(Target target) {
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  ffi::Optional<bool> enable = pass_ctx->GetConfig<bool>("tirx.vectorize_masked_tail");
+  return enable.value_or(false) && (TargetHasAVX512(target) || TargetHasVLA(target));
+}
+
+/*! \brief The widest element in bits accessed by `body`, 32 if there is no access. */
+int GetMaxElementBits(const Stmt& body) {
+  int max_bits = 0;
+  PostOrderVisit(body, [&max_bits](const ffi::ObjectRef& obj) {
+    if (const auto* load = obj.as<BufferLoadNode>()) {
+      max_bits = std::max(max_bits, static_cast<int>(load->buffer->dtype.bits()));
+    } else if (const auto* store = obj.as<BufferStoreNode>()) {
+      max_bits = std::max(max_bits, static_cast<int>(store->buffer->dtype.bits()));
+    }
+  });
+  return max_bits == 0 ? 32 : max_bits;
+}
+
+/*!
+ * \brief The number of lanes per unit of vscale for a scalable loop over `body`.
+ *
+ * One unit of vscale spans 128 bits, so the lane count follows the widest element accessed.
+ */
+int GetScalableLanesFactor(const Stmt& body) { return std::max(1, 128 / GetMaxElementBits(body)); }
+
+/*! \brief The number of lanes filling one native vector register of `target` for `body`. */
+int GetNativeLanes(Target target, const Stmt& body) {
+  int vector_bits = 128;
+  static auto vector_width_fn = tvm::ffi::Function::GetGlobal("target.llvm_get_vector_width");
+  if (vector_width_fn.has_value() && target.defined() && target->kind->name == "llvm") {
+    vector_bits = std::max(vector_bits, (*vector_width_fn)(target).cast<int>());
+  }
+  return std::max(1, vector_bits / GetMaxElementBits(body));
+}
+
 bool ContainsCallNode(const Stmt& stmt) {
   return CheckContains::StmtContains(
       stmt, [](const PrimExpr& expr) { return expr.as<CallNode>() != nullptr; });
@@ -130,8 +197,8 @@ bool EnableBufferLevelPredication(Target target) {
     return enable_buffer_predication.value();
   }
 
-  // Use buffer-level predication by default for VLA targets
-  return TargetHasVLA(target);
+  // Use buffer-level predication by default for VLA targets, and for masked tails
+  return TargetHasVLA(target) || EnableMaskedTail(target);
 }
 
 /*!
@@ -921,7 +988,8 @@ class Vectorizer : public StmtMutator, public ExprFunctor<Expr(const Expr&)> {
         (condition.ty().IsScalableVector() || condition.ty().IsFixedLengthVector()) &&
         !else_case.has_value()) {
       std::pair<bool, Stmt> success_stmt_pair =
-          TryPredicateBufferAccesses(TargetHasRVV(target_)).Run(then_case, condition);
+          TryPredicateBufferAccesses(TargetHasRVV(target_) || EnableMaskedTail(target_))
+              .Run(then_case, condition);
       bool can_remove_if_then_else = success_stmt_pair.first;
       if (can_remove_if_then_else) {
         return success_stmt_pair.second;
@@ -1114,14 +1182,21 @@ class LoopVectorizer : public StmtMutator {
       TVM_FFI_ICHECK(is_zero(op->min));
       // General calls still have vectorization paths that query a compile-time
       // lane count, so keep them on the existing fixed-width path for now.
-      if (extent_as_int && extent_as_int->value > 1 && TargetHasRVV(target_) &&
-          !ContainsCallNode(op->body)) {
-        return VectorizeFixedLoopForRVV(op, extent_as_int->value);
+      bool is_scalable_extent = CheckContains::ExprContains(op->extent, IsVScaleCall);
+      if ((!extent_as_int || extent_as_int->value > 1) && !is_scalable_extent &&
+          EnableScalableVectorization(target_) && !ContainsCallNode(op->body)) {
+        return VectorizeLoopScalable(op);
+      }
+      if (!is_scalable_extent && EnableMaskedTail(target_) && !ContainsCallNode(op->body)) {
+        int native_lanes = GetNativeLanes(target_, op->body);
+        if (!extent_as_int ||
+            (extent_as_int->value > native_lanes && extent_as_int->value % native_lanes != 0)) {
+          return VectorizeLoopInChunks(op, native_lanes, /*is_scalable=*/false);
+        }
       }
 
       if (!extent_as_int || extent_as_int->value < 1) {
-        bool is_scalable_expr = CheckContains::ExprContains(op->extent, IsVScaleCall);
-        TVM_FFI_ICHECK(is_scalable_expr && TargetHasVLA(target_))
+        TVM_FFI_ICHECK(is_scalable_extent && TargetHasVLA(target_))
             << "Failed to vectorize loop with extent " << op->extent << " for target " << target_;
       }
       return Vectorizer(op->loop_var, op->extent, target_)(op->body);
@@ -1142,31 +1217,46 @@ class LoopVectorizer : public StmtMutator {
   }
 
  private:
-  Stmt VectorizeFixedLoopForRVV(const ForNode* op, int64_t extent) {
-    // Match the existing TIRx scalable-vector convention.  LLVM/RVV still
-    // selects the runtime vector length with vsetvli.
-    static constexpr int kDefaultVScaleFactor = 4;
+  /*!
+   * \brief Split a vectorized loop into chunks of vscale-multiple lanes with a predicated tail.
+   *
+   * The extent may be a constant or symbolic. The guard on the last chunk is turned into
+   * buffer-level predicates by the vectorizer when the target supports it, and LLVM selects
+   * the runtime vector length (vsetvli on RVV, the SVE vector length on AArch64).
+   */
+  Stmt VectorizeLoopScalable(const ForNode* op) {
+    return VectorizeLoopInChunks(op, GetScalableLanesFactor(op->body), /*is_scalable=*/true);
+  }
+
+  /*!
+   * \brief Split a vectorized loop into chunks of `lanes_or_vscale_factor` lanes, guarding the
+   * last chunk with `index < extent` so that it lowers to masked loads and stores.
+   */
+  Stmt VectorizeLoopInChunks(const ForNode* op, int lanes_or_vscale_factor, bool is_scalable) {
     PrimType index_dtype = op->loop_var.ty();
     PrimExpr zero = IntImm(index_dtype, 0);
-    PrimExpr fixed_extent = IntImm(index_dtype, extent);
-    PrimExpr scalable_lanes = CreateNewLanes(/*is_scalable=*/true, kDefaultVScaleFactor);
-    PrimType lane_dtype = scalable_lanes.ty();
-    PrimExpr scalable_lanes_index = scalable_lanes;
-    if (scalable_lanes_index.ty() != index_dtype) {
-      scalable_lanes_index = Cast(index_dtype, scalable_lanes_index);
+    PrimExpr fixed_extent = op->extent;
+    PrimExpr chunk_lanes = CreateNewLanes(is_scalable, lanes_or_vscale_factor);
+    PrimType lane_dtype = is_scalable ? chunk_lanes.ty() : index_dtype;
+    PrimExpr chunk_lanes_index =
+        is_scalable ? chunk_lanes : IntImm(index_dtype, lanes_or_vscale_factor);
+    if (chunk_lanes_index.ty() != index_dtype) {
+      chunk_lanes_index = Cast(index_dtype, chunk_lanes_index);
     }
-    PrimExpr num_chunks = ceildiv(fixed_extent, scalable_lanes_index);
+    PrimExpr num_chunks = ceildiv(fixed_extent, chunk_lanes_index);
 
-    PrimVar outer(op->loop_var->name + ".vla.o", index_dtype);
-    PrimVar inner(op->loop_var->name + ".vla.i", lane_dtype);
+    std::string suffix = is_scalable ? ".vla" : ".vec";
+    PrimVar outer(op->loop_var->name + suffix + ".o", index_dtype);
+    PrimVar inner(op->loop_var->name + suffix + ".i", lane_dtype);
     PrimExpr inner_index = inner;
     if (inner_index.ty() != index_dtype) {
       inner_index = Cast(index_dtype, inner_index);
     }
-    PrimExpr index = outer * scalable_lanes_index + inner_index;
+    PrimExpr index = outer * chunk_lanes_index + inner_index;
     Stmt body = Substitute(op->body, {{op->loop_var, index}});
     Stmt guarded_body = IfThenElse(index < fixed_extent, body, std::nullopt, op->span);
-    Stmt vector_loop = For(inner, IntImm(lane_dtype, 0), scalable_lanes, ForKind::kVectorized,
+    PrimExpr inner_extent = is_scalable ? chunk_lanes : IntImm(lane_dtype, lanes_or_vscale_factor);
+    Stmt vector_loop = For(inner, IntImm(lane_dtype, 0), inner_extent, ForKind::kVectorized,
                            guarded_body, std::nullopt, op->annotations, std::nullopt, op->span);
     Stmt loop = For(outer, zero, num_chunks, ForKind::kSerial, vector_loop, std::nullopt, {},
                     std::nullopt, op->span);
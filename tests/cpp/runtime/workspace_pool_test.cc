@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "../../../src/runtime/workspace_pool.h"
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/device_api.h>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+Device CPU() {
+  Device dev;
+  dev.device_type = kDLCPU;
+  dev.device_id = 0;
+  return dev;
+}
+
+TEST(WorkspacePool, RepeatedPatternHits) {
+  WorkspacePool pool(kDLCPU, DeviceAPI::Get(CPU()));
+  // Several large temporaries of growing sizes, released in reverse order.
+  for (int run = 0; run < 3; ++run) {
+    void* a = pool.AllocWorkspace(CPU(), 1 << 20);
+    void* b = pool.AllocWorkspace(CPU(), 4 << 20);
+    void* c = pool.AllocWorkspace(CPU(), 16 << 20);
+    pool.FreeWorkspace(CPU(), c);
+    pool.FreeWorkspace(CPU(), b);
+    pool.FreeWorkspace(CPU(), a);
+  }
+  WorkspacePoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_misses, 3);
+  EXPECT_EQ(stats.num_hits, 6);
+  EXPECT_EQ(stats.num_reallocs, 0);
+  EXPECT_EQ(stats.allocated_bytes, (1 + 4 + 16) << 20);
+  EXPECT_EQ(stats.free_bytes, stats.allocated_bytes);
+}
+
+TEST(WorkspacePool, BestFit) {
+  WorkspacePool pool(kDLCPU, DeviceAPI::Get(CPU()));
+  void* small = pool.AllocWorkspace(CPU(), 8 << 10);
+  void* large = pool.AllocWorkspace(CPU(), 64 << 10);
+  pool.FreeWorkspace(CPU(), small);
+  pool.FreeWorkspace(CPU(), large);
+  // The smallest fitting page is taken, in the same or in a larger size class.
+  EXPECT_EQ(pool.AllocWorkspace(CPU(), 6 << 10), small);
+  EXPECT_EQ(pool.AllocWorkspace(CPU(), 20 << 10), large);
+}
+
+TEST(WorkspacePool, CacheBoundedByPeak) {
+  WorkspacePool pool(kDLCPU, DeviceAPI::Get(CPU()));
+  // Each request misses the smaller cached pages, which are released once the cache
+  // outgrows the peak live size.
+  for (size_t size : {16 << 10, 20 << 10, 24 << 10, 28 << 10}) {
+    pool.FreeWorkspace(CPU(), pool.AllocWorkspace(CPU(), size));
+  }
+  WorkspacePoolStats stats = pool.GetStats();
+  EXPECT_EQ(stats.num_misses, 4);
+  EXPECT_EQ(stats.num_reallocs, 2);
+  EXPECT_EQ(stats.allocated_bytes, (16 + 28) << 10);
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace tvm
@@ -20,16 +20,20 @@
 #include "../../src/runtime/threading_backend.h"
 
 #include <gtest/gtest.h>
+#include <tvm/ffi/container/map.h>
+#include <tvm/ffi/function.h>
 #include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/logging.h>
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 constexpr size_t N = 128;
 void AtomicCompute(int task_id, size_t n, std::atomic<size_t>* acc, TVMParallelGroupEnv* penv) {
@@ -147,6 +151,112 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
   }
 }
 
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  int max_concurrency = tvm::runtime::threading::MaxConcurrency();
+  if (max_concurrency <= 1) {
+    return;
+  }
+  constexpr int kChunksPerWorker = 4;
+  tvm::runtime::threading::ConfigureWorkStealing(kChunksPerWorker);
+  // Tasks with a skewed workload, so that the idle workers steal from the stragglers.
+  static FTVMParallelLambda skewed_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                             void* cdata) -> int {
+    auto* data = reinterpret_cast<std::atomic<size_t>*>(cdata);
+    if (task_id == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    AtomicCompute(task_id, N, data, penv);
+    data[1].fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  };
+  for (int iter = 0; iter < 3; ++iter) {
+    std::atomic<size_t> acc[2];
+    acc[0] = 0;
+    acc[1] = 0;
+    EXPECT_EQ(TVMBackendParallelLaunch(skewed_task, acc, 0), 0);
+    EXPECT_EQ(acc[0].load(std::memory_order_relaxed), N * (N - 1) / 2);
+    EXPECT_EQ(acc[1].load(std::memory_order_relaxed),
+              static_cast<size_t>(tvm::runtime::threading::NumThreads() * kChunksPerWorker));
+  }
+  // Barriers are rejected, as the tasks do not run concurrently.
+  static FTVMParallelLambda barrier_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                              void* cdata) -> int {
+    TVMBackendParallelBarrier(task_id, penv);
+    return 0;
+  };
+  EXPECT_NE(TVMBackendParallelLaunch(barrier_task, nullptr, 0), 0);
+  tvm::runtime::threading::ConfigureWorkStealing(0);
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchNested) {
+  // Each outer task launches an inner job, on its sub-team of idle workers or inline.
+  static FTVMParallelLambda outer_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                            void* cdata) -> int {
+    auto* data = reinterpret_cast<std::atomic<size_t>*>(cdata);
+    return TVMBackendParallelLaunch(atomic_add_task_id, &data[task_id], 0);
+  };
+  for (int num_outer_task : {1, 2, 0}) {
+    int num_task = num_outer_task != 0 ? num_outer_task : tvm::runtime::threading::NumThreads();
+    if (num_task > tvm::runtime::threading::NumThreads()) {
+      continue;
+    }
+    std::vector<std::atomic<size_t>> acc(num_task);
+    for (std::atomic<size_t>& a : acc) {
+      a = 0;
+    }
+    EXPECT_EQ(TVMBackendParallelLaunch(outer_task, acc.data(), num_outer_task), 0);
+    for (std::atomic<size_t>& a : acc) {
+      EXPECT_EQ(a.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    }
+  }
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchWaitStats) {
+  if (tvm::runtime::threading::MaxConcurrency() <= 1) {
+    return;
+  }
+  auto config_spin_count =
+      tvm::ffi::Function::GetGlobalRequired("runtime.config_threadpool_spin_count");
+  auto get_wait_stats = tvm::ffi::Function::GetGlobalRequired("runtime.thread_pool_wait_stats");
+  // Without spinning, every idle wait parks.
+  config_spin_count(0);
+  for (int i = 0; i < 3; ++i) {
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto stats = get_wait_stats().cast<tvm::ffi::Map<tvm::ffi::String, int64_t>>();
+  EXPECT_GT(stats["worker_num_parks"], 0);
+  EXPECT_GT(stats["worker_park_ns"], 0);
+  EXPECT_GE(stats["main_num_parks"] + stats["main_num_spin_wakeups"], 3);
+  config_spin_count(300000);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchNuma) {
+  const auto& nodes = tvm::runtime::threading::NumaNodeCpus();
+  ASSERT_GE(nodes.size(), 1);
+  EXPECT_LT(tvm::runtime::threading::CurrentNumaNode(), static_cast<int>(nodes.size()));
+  std::atomic<size_t> acc(0);
+  EXPECT_EQ(TVMBackendParallelLaunchNuma(atomic_add_task_id, &acc), 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  // Configure a fresh thread pool in a new thread so that the other tests keep theirs.
+  std::thread t([]() {
+    tvm::runtime::threading::Configure(tvm::runtime::threading::ThreadGroup::kNuma, 0, {});
+    EXPECT_TRUE(tvm::runtime::threading::NumaAwarePlacement());
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunchNuma(atomic_add_task_id, &acc), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    void* workspace = TVMBackendAllocWorkspace(kDLCPU, 0, 1 << 20, kDLFloat, 32);
+    ASSERT_NE(workspace, nullptr);
+    EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, workspace), 0);
+  });
+  t.join();
+}
+
 TEST(ThreadingBackend, TVMBackendAffinityConfigure) {
   int max_concurrency = tvm::runtime::threading::MaxConcurrency();
   std::vector<std::unique_ptr<std::thread>> ts;
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file create_primfunc_bench.cc
+ * \brief Compile-time benchmarks of the TE to TIR conversion of representative TOPI ops.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/function.h>
+#include <tvm/te/operation.h>
+#include <tvm/topi/broadcast.h>
+#include <tvm/topi/einsum.h>
+#include <tvm/topi/elemwise.h>
+#include <tvm/topi/nn/softmax.h>
+#include <tvm/topi/reduction.h>
+
+#include <cstdint>
+
+namespace {
+
+using tvm::PrimType;
+using tvm::ffi::Array;
+using tvm::ffi::Function;
+using tvm::ffi::ObjectRef;
+using tvm::te::placeholder;
+using tvm::te::Tensor;
+
+/*! \brief Convert the TE graph between the arguments to a PrimFunc in every iteration. */
+void BenchCreatePrimFunc(benchmark::State& state, const Array<ObjectRef>& arg_list) {
+  auto f_create = Function::GetGlobalRequired("te.CreatePrimFunc");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f_create(arg_list, nullptr));
+  }
+}
+
+/*! \brief A chain of fused elementwise stages, as produced by operator fusion. */
+void BM_CreatePrimFuncElemwiseChain(benchmark::State& state) {
+  Tensor a = placeholder({128, 128}, PrimType::Float(32), "A");
+  Tensor x = a;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    x = tvm::topi::add(tvm::topi::exp(x), a);
+  }
+  BenchCreatePrimFunc(state, {a, x});
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_CreatePrimFuncElemwiseChain)->Arg(8)->Arg(64);
+
+/*! \brief A softmax, whose reductions and elementwise stages become separate blocks. */
+void BM_CreatePrimFuncSoftmax(benchmark::State& state) {
+  Tensor x = placeholder({32, 1024}, PrimType::Float(32), "x");
+  BenchCreatePrimFunc(state, {x, tvm::topi::nn::softmax(x)});
+}
+BENCHMARK(BM_CreatePrimFuncSoftmax);
+
+/*! \brief A three operand einsum, which reduces over two axes. */
+void BM_CreatePrimFuncEinsum(benchmark::State& state) {
+  Tensor a = placeholder({4, 64, 64}, PrimType::Float(32), "a");
+  Tensor b = placeholder({4, 64, 64}, PrimType::Float(32), "b");
+  Tensor c = placeholder({4, 64, 64}, PrimType::Float(32), "c");
+  BenchCreatePrimFunc(state, {a, b, c, tvm::topi::einsum("bij,bjk,bkl->bil", {a, b, c})});
+}
+BENCHMARK(BM_CreatePrimFuncEinsum);
+
+/*! \brief A reduction over the inner axes of a tensor with a symbolic outer axis. */
+void BM_CreatePrimFuncSum(benchmark::State& state) {
+  tvm::tirx::PrimVar n("n", PrimType::Int(64));
+  Tensor x = placeholder({n, 64, 64}, PrimType::Float(32), "x");
+  BenchCreatePrimFunc(state, {x, tvm::topi::sum(x, Array<int64_t>{1, 2})});
+}
+BENCHMARK(BM_CreatePrimFuncSum);
+
+}  // namespace
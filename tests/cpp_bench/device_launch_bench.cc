@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file device_launch_bench.cc
+ * \brief Benchmarks of the host overhead of launching an empty kernel on CUDA and Metal.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/ffi/extra/module.h>
+#include <tvm/ffi/function.h>
+#include <tvm/runtime/device_api.h>
+
+#include <cstdint>
+#include <string>
+
+#include "../../src/runtime/metadata.h"
+
+namespace {
+
+using tvm::ffi::Array;
+using tvm::ffi::Bytes;
+using tvm::ffi::Function;
+using tvm::ffi::Map;
+using tvm::ffi::Module;
+using tvm::ffi::Optional;
+using tvm::ffi::String;
+using tvm::runtime::ArgExtraTags;
+using tvm::runtime::DeviceAPI;
+using tvm::runtime::FunctionInfo;
+using tvm::runtime::kExist;
+
+constexpr const char* kKernelName = "empty_kernel";
+constexpr int64_t kNumElems = 1024;
+
+/*! \brief The empty kernel takes a buffer and an int32 and launches over threadIdx.x. */
+Map<String, FunctionInfo> EmptyKernelInfo() {
+  Array<DLDataType> arg_types = {DLDataType{kDLOpaqueHandle, 64, 1}, DLDataType{kDLInt, 32, 1}};
+  Map<String, FunctionInfo> fmap;
+  fmap.Set(kKernelName, FunctionInfo(kKernelName, arg_types, {"threadIdx.x"},
+                                     {ArgExtraTags::kNone, ArgExtraTags::kNone}));
+  return fmap;
+}
+
+/*!
+ * \brief Launch the kernel of the module with the same arguments in every iteration,
+ *  as the VM does when it runs a model step by step.
+ */
+void BenchEmptyKernelLaunch(benchmark::State& state, DLDevice dev, const Optional<Module>& mod) {
+  DeviceAPI* api = DeviceAPI::Get(dev, /*allow_missing=*/true);
+  if (!mod.has_value() || api == nullptr) {
+    state.SkipWithError("the device runtime is not enabled in this build");
+    return;
+  }
+  tvm::ffi::Any exist;
+  api->GetAttr(dev, kExist, &exist);
+  if (exist.cast<int64_t>() == 0) {
+    state.SkipWithError("no device is available");
+    return;
+  }
+  Function f = mod.value()->GetFunction(kKernelName).value();
+  api->SetDevice(dev);
+  void* data = api->AllocDataSpace(dev, kNumElems * sizeof(float), 64, {kDLFloat, 32, 1});
+  for (auto _ : state) {
+    f(data, static_cast<int32_t>(kNumElems), 1);
+  }
+  api->StreamSync(dev, nullptr);
+  api->FreeDataSpace(dev, data);
+  state.SetItemsProcessed(state.iterations());
+}
+
+/*! \brief Create a module through the registered factory, or none when it is missing. */
+template <typename Code>
+Optional<Module> CreateModule(const std::string& factory, Code code, const std::string& fmt) {
+  Optional<Function> fcreate = Function::GetGlobal(factory);
+  if (!fcreate.has_value()) return std::nullopt;
+  Map<String, String> source;
+  return fcreate.value()(code, String(fmt), EmptyKernelInfo(), source).cast<Module>();
+}
+
+/*! \brief The launch overhead of cuLaunchKernelEx through CUDAWrappedFunc. */
+void BM_CUDAEmptyKernelLaunch(benchmark::State& state) {
+  std::string ptx =
+      ".version 7.0\n"
+      ".target sm_52\n"
+      ".address_size 64\n"
+      ".visible .entry empty_kernel(.param .u64 A, .param .u32 n)\n"
+      "{\n"
+      "  ret;\n"
+      "}\n";
+  DLDevice dev{kDLCUDA, 0};
+  BenchEmptyKernelLaunch(state, dev, CreateModule("ffi.Module.create.cuda", Bytes(ptx), "ptx"));
+}
+BENCHMARK(BM_CUDAEmptyKernelLaunch);
+
+/*!
+ * \brief The launch overhead of encoding a dispatch through MetalWrappedFunc, where the
+ *  repeated pipeline state and argument bindings are skipped.
+ */
+void BM_MetalEmptyKernelLaunch(benchmark::State& state) {
+  std::string msl =
+      "#include <metal_stdlib>\n"
+      "using namespace metal;\n"
+      "struct empty_kernel_args_t {\n"
+      "  int n;\n"
+      "};\n"
+      "kernel void empty_kernel(device float* A [[buffer(0)]],\n"
+      "                         constant empty_kernel_args_t& arg [[buffer(1)]],\n"
+      "                         uint tid [[thread_position_in_threadgroup]]) {}\n";
+  Map<String, Bytes> smap;
+  smap.Set(kKernelName, Bytes(msl));
+  DLDevice dev{kDLMetal, 0};
+  BenchEmptyKernelLaunch(state, dev, CreateModule("ffi.Module.create.metal", smap, "metal"));
+}
+BENCHMARK(BM_MetalEmptyKernelLaunch);
+
+}  // namespace
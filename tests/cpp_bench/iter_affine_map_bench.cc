@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_affine_map_bench.cc
+ * \brief Compile-time benchmarks of DetectIterMap on the bindings of tiled and fused loops.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/arith/analyzer.h>
+#include <tvm/arith/iter_affine_map.h>
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/container/map.h>
+#include <tvm/tirx/op.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using tvm::PrimExpr;
+using tvm::PrimType;
+using tvm::Range;
+using tvm::arith::Analyzer;
+using tvm::arith::DetectIterMap;
+using tvm::arith::DetectIterMapBatch;
+using tvm::arith::IterMapLevel;
+using tvm::ffi::Array;
+using tvm::ffi::Map;
+using tvm::tirx::PrimVar;
+
+/*! \brief The block bindings of a loop nest and the domain of its loops. */
+struct LoopNest {
+  Array<PrimExpr> bindings;
+  Map<PrimVar, Range> loops;
+};
+
+/*!
+ * \brief The bindings after every axis is split into levels and the loops of each level are
+ *  fused, as MultiLevelTiling does before binding the fused loops to threads.
+ * \param factors The split factors of each axis, from the outermost level to the innermost.
+ */
+LoopNest TileAndFuse(const std::vector<std::vector<int64_t>>& factors) {
+  LoopNest nest;
+  size_t num_levels = factors[0].size();
+  std::vector<PrimExpr> bindings(factors.size());
+  for (size_t level = 0; level < num_levels; ++level) {
+    int64_t extent = 1;
+    for (const std::vector<int64_t>& axis : factors) extent *= axis[level];
+    PrimVar fused("fused_" + std::to_string(level), PrimType::Int(32));
+    nest.loops.Set(fused, Range::FromMinExtent(0, static_cast<int32_t>(extent)));
+    // The innermost axis varies fastest in the fused loop.
+    int64_t stride = 1;
+    for (size_t i = factors.size(); i-- > 0;) {
+      int32_t factor = static_cast<int32_t>(factors[i][level]);
+      PrimExpr part = tvm::floormod(tvm::floordiv(fused, static_cast<int32_t>(stride)), factor);
+      bindings[i] = level == 0 ? part : bindings[i] * factor + part;
+      stride *= factor;
+    }
+  }
+  nest.bindings = Array<PrimExpr>(bindings.begin(), bindings.end());
+  return nest;
+}
+
+/*! \brief A conv2d output of shape [1, 56, 56, 64] tiled in four levels. */
+LoopNest TiledConv2d() {
+  return TileAndFuse({{1, 1, 1, 1}, {2, 7, 2, 2}, {2, 2, 7, 2}, {4, 2, 8, 1}});
+}
+
+/*! \brief An attention output of shape [8, 32, 128] whose fused loop vectorizes by 4. */
+LoopNest FusedAttention() {
+  PrimVar outer("fused_outer", PrimType::Int(32));
+  PrimVar vec("fused_vec", PrimType::Int(32));
+  PrimExpr fused = outer * 4 + vec;
+  LoopNest nest;
+  nest.loops.Set(outer, Range::FromMinExtent(0, 8 * 32 * 128 / 4));
+  nest.loops.Set(vec, Range::FromMinExtent(0, 4));
+  nest.bindings = {tvm::floordiv(fused, 32 * 128), tvm::floormod(tvm::floordiv(fused, 128), 32),
+                   tvm::floormod(fused, 128)};
+  return nest;
+}
+
+void BenchDetectIterMap(benchmark::State& state, const LoopNest& nest) {
+  Analyzer analyzer;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        DetectIterMap(nest.bindings, nest.loops, 1, IterMapLevel::Surjective, analyzer));
+  }
+  state.SetItemsProcessed(state.iterations() * nest.bindings.size());
+}
+
+/*! \brief Detect the bindings of a conv2d block tiled by MultiLevelTiling. */
+void BM_DetectIterMapTiledConv2d(benchmark::State& state) {
+  BenchDetectIterMap(state, TiledConv2d());
+}
+BENCHMARK(BM_DetectIterMapTiledConv2d);
+
+/*! \brief Detect the bindings of a vectorized attention block over a single fused loop. */
+void BM_DetectIterMapFusedAttention(benchmark::State& state) {
+  BenchDetectIterMap(state, FusedAttention());
+}
+BENCHMARK(BM_DetectIterMapFusedAttention);
+
+/*! \brief Detect the indices of every buffer access of a tiled conv2d block in one batch. */
+void BM_DetectIterMapBatchTiledConv2d(benchmark::State& state) {
+  LoopNest nest = TiledConv2d();
+  const Array<PrimExpr>& b = nest.bindings;
+  // The output, the input without padding and the per-channel bias.
+  Array<Array<PrimExpr>> indices_list = {b, {b[0], b[1], b[2]}, {b[3]}};
+  Analyzer analyzer;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        DetectIterMapBatch(indices_list, nest.loops, 1, IterMapLevel::Surjective, analyzer));
+  }
+  state.SetItemsProcessed(state.iterations() * indices_list.size());
+}
+BENCHMARK(BM_DetectIterMapBatchTiledConv2d);
+
+}  // namespace
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rpc_bench.cc
+ * \brief Benchmarks of the RPC round trip over an in-process pipe.
+ */
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/extra/module.h>
+#include <tvm/ffi/function.h>
+#include <unistd.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "../../src/runtime/rpc/rpc_endpoint.h"
+#include "../../src/runtime/rpc/rpc_session.h"
+
+namespace {
+
+using namespace tvm::runtime;  // NOLINT(*)
+
+/*! \brief An RPC channel over one end of a socket pair. */
+class SocketPairChannel final : public RPCChannel {
+ public:
+  explicit SocketPairChannel(int fd) : fd_(fd) {}
+  ~SocketPairChannel() { close(fd_); }
+
+  size_t Send(const void* data, size_t size) final {
+    ssize_t n = write(fd_, data, size);
+    return n < 0 ? 0 : static_cast<size_t>(n);
+  }
+
+  size_t Recv(void* data, size_t size) final {
+    ssize_t n = read(fd_, data, size);
+    return n < 0 ? 0 : static_cast<size_t>(n);
+  }
+
+ private:
+  int fd_;
+};
+
+/*! \brief A client session connected to a server loop running on another thread. */
+class LoopbackSession {
+ public:
+  LoopbackSession() {
+    int fds[2];
+    TVM_FFI_ICHECK_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    server_ = std::thread([fd = fds[1]]() {
+      RPCEndpoint::Create(std::make_unique<SocketPairChannel>(fd), "bench_server", "")
+          ->ServerLoop();
+    });
+    auto endpoint =
+        RPCEndpoint::Create(std::make_unique<SocketPairChannel>(fds[0]), "bench", "bench_server");
+    endpoint->InitRemoteSession(tvm::ffi::PackedArgs(nullptr, 0));
+    module_ = CreateRPCSessionModule(CreateClientSession(std::move(endpoint)));
+  }
+
+  ~LoopbackSession() {
+    module_.value()->GetFunction("CloseRPCConnection").value()();
+    server_.join();
+  }
+
+  tvm::ffi::Function GetFunction(const char* name) {
+    return module_.value()->GetFunction(name).value();
+  }
+
+ private:
+  std::thread server_;
+  tvm::ffi::Optional<tvm::ffi::Module> module_;
+};
+
+/*! \brief The round trip latency of a remote call with a small argument. */
+void BM_RPCRoundTrip(benchmark::State& state) {
+  LoopbackSession session;
+  tvm::ffi::Function get_shape_size = session.GetFunction("rpc.testing.GetShapeSize");
+  tvm::ffi::Shape shape{1, 2, 3, 4};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(get_shape_size(shape));
+  }
+}
+BENCHMARK(BM_RPCRoundTrip)->UseRealTime();
+
+}  // namespace
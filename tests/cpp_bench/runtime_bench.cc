@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file runtime_bench.cc
+ * \brief Benchmarks of the thread pool, the allocators, tensor copies and FFI calls.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/ffi/function.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/memory/memory_manager.h>
+#include <tvm/runtime/tensor.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace {
+
+using tvm::runtime::kExist;
+using tvm::runtime::Tensor;
+using tvm::runtime::memory::Allocator;
+using tvm::runtime::memory::AllocatorType;
+using tvm::runtime::memory::Buffer;
+using tvm::runtime::memory::MemoryManager;
+
+constexpr DLDevice kCPU{kDLCPU, 0};
+constexpr DLDataType kFloat32{kDLFloat, 32, 1};
+
+int EmptyLambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  static_cast<std::atomic<int64_t>*>(cdata)->fetch_add(1, std::memory_order_relaxed);
+  return 0;
+}
+
+/*! \brief The latency of launching an empty parallel region on the given number of tasks. */
+void BM_ParallelLaunch(benchmark::State& state) {
+  int num_task = static_cast<int>(state.range(0));
+  std::atomic<int64_t> num_runs{0};
+  for (auto _ : state) {
+    TVMBackendParallelLaunch(EmptyLambda, &num_runs, num_task);
+  }
+  benchmark::DoNotOptimize(num_runs.load());
+}
+BENCHMARK(BM_ParallelLaunch)->Arg(0)->Arg(2)->Arg(4)->UseRealTime();
+
+/*! \brief The alloc/free throughput of the allocator of the given type. */
+void AllocFree(benchmark::State& state, AllocatorType type) {
+  Allocator* allocator = MemoryManager::GetOrCreateAllocator(kCPU, type);
+  size_t nbytes = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    Buffer buffer = allocator->Alloc(kCPU, nbytes, 64, kFloat32);
+    benchmark::DoNotOptimize(buffer.data);
+    allocator->Free(buffer);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+void BM_PooledAllocFree(benchmark::State& state) { AllocFree(state, AllocatorType::kPooled); }
+void BM_NaiveAllocFree(benchmark::State& state) { AllocFree(state, AllocatorType::kNaive); }
+BENCHMARK(BM_PooledAllocFree)->Range(64, 1 << 22);
+BENCHMARK(BM_NaiveAllocFree)->Range(64, 1 << 22);
+
+/*! \brief The bandwidth of Tensor::CopyFrom between host tensors. */
+void BM_TensorCopyFrom(benchmark::State& state) {
+  int64_t numel = state.range(0);
+  Tensor src = Tensor::Empty({numel}, kFloat32, kCPU);
+  Tensor dst = Tensor::Empty({numel}, kFloat32, kCPU);
+  for (auto _ : state) {
+    dst.CopyFrom(src);
+  }
+  state.SetBytesProcessed(state.iterations() * numel * sizeof(float));
+}
+BENCHMARK(BM_TensorCopyFrom)->Range(256, 1 << 22);
+
+/*! \brief The overhead of calling a typed function through the packed calling convention. */
+void BM_FFIPackedCall(benchmark::State& state) {
+  tvm::ffi::Function add_one = tvm::ffi::Function::FromTyped([](int64_t x) { return x + 1; });
+  int64_t value = 0;
+  for (auto _ : state) {
+    value = add_one(value).cast<int64_t>();
+  }
+  benchmark::DoNotOptimize(value);
+}
+BENCHMARK(BM_FFIPackedCall);
+
+/*! \brief The overhead of looking a global function up and calling it. */
+void BM_FFIGlobalFunctionCall(benchmark::State& state) {
+  for (auto _ : state) {
+    auto f = tvm::ffi::Function::GetGlobalRequired("runtime.GetDeviceAttr");
+    tvm::ffi::Any exist = f(static_cast<int>(kDLCPU), 0, static_cast<int>(kExist));
+    benchmark::DoNotOptimize(exist);
+  }
+}
+BENCHMARK(BM_FFIGlobalFunctionCall);
+
+}  // namespace
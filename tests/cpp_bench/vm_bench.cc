@@ -0,0 +1,145 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file vm_bench.cc
+ * \brief Benchmarks of the Relax VM instruction dispatch and the KV cache host planning.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/ffi/container/array.h>
+#include <tvm/ffi/container/shape.h>
+#include <tvm/ffi/function.h>
+#include <tvm/ir/expr.h>
+#include <tvm/runtime/memory/memory_manager.h>
+#include <tvm/runtime/tensor.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using tvm::ffi::Any;
+using tvm::ffi::Array;
+using tvm::ffi::Function;
+using tvm::ffi::Module;
+using tvm::ffi::Shape;
+using tvm::runtime::Tensor;
+
+constexpr DLDevice kCPU{kDLCPU, 0};
+constexpr int kNumInstrs = 64;
+
+/*!
+ * \brief Build a VM function that passes its input through a chain of
+ * `vm.builtin.copy` calls, so that a call runs kNumInstrs call instructions.
+ */
+Function BuildCopyChain() {
+  auto f_create = Function::GetGlobalRequired("relax.ExecBuilderCreate");
+  auto f_emit_function = Function::GetGlobalRequired("relax.ExecBuilderEmitFunction");
+  auto f_emit_call = Function::GetGlobalRequired("relax.ExecBuilderEmitCall");
+  auto f_emit_ret = Function::GetGlobalRequired("relax.ExecBuilderEmitRet");
+  auto f_end_function = Function::GetGlobalRequired("relax.ExecBuilderEndFunction");
+  auto f_reg = Function::GetGlobalRequired("relax.ExecBuilderR");
+  auto f_get = Function::GetGlobalRequired("relax.ExecBuilderGet");
+
+  Any builder = f_create();
+  f_emit_function(builder, "main", 1, Array<tvm::ffi::String>{"x"});
+  for (int64_t i = 1; i <= kNumInstrs; ++i) {
+    int64_t src = f_reg(builder, i - 1).cast<int64_t>();
+    Array<tvm::IntImm> args{tvm::IntImm(tvm::DataType::Int(64), src)};
+    f_emit_call(builder, "vm.builtin.copy", args, i);
+  }
+  f_emit_ret(builder, f_reg(builder, kNumInstrs));
+  f_end_function(builder, "main");
+
+  Module exec = f_get(builder).cast<Module>();
+  Module vm = exec->GetFunction("vm_load_executable").value()().cast<Module>();
+  vm->GetFunction("vm_initialization")
+      .value()(static_cast<int>(kDLCPU), 0,
+               static_cast<int>(tvm::runtime::memory::AllocatorType::kPooled));
+  return vm->GetFunction("main").value();
+}
+
+/*! \brief The dispatch cost of the VM call instructions. */
+void BM_VMInstructionDispatch(benchmark::State& state) {
+  Function main = BuildCopyChain();
+  Shape x{1, 2, 3};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(main(x));
+  }
+  state.SetItemsProcessed(state.iterations() * kNumInstrs);
+}
+BENCHMARK(BM_VMInstructionDispatch);
+
+/*!
+ * \brief Create a CPU paged KV cache without attention kernels. The host planning in
+ * BeginForward does not call the kernels.
+ */
+Any CreateKVCache(int64_t num_seqs, int64_t page_size) {
+  constexpr int64_t kNumLayers = 2;
+  constexpr int64_t kMaxSeqLength = 1024;
+  Function f_noop = Function::FromPacked([](tvm::ffi::PackedArgs args, Any* rv) {});
+  Array<Any> no_kernel;
+  auto f_create = Function::GetGlobalRequired("vm.builtin.paged_attention_kv_cache_create");
+  return f_create(Shape{num_seqs, num_seqs * kMaxSeqLength, 2048, page_size, 0},
+                  Shape{0, kNumLayers}, /*num_qo_heads=*/4, /*num_kv_heads=*/1,
+                  /*qk_head_dim=*/64, /*v_head_dim=*/64, Shape{0, 0},
+                  /*enable_kv_transfer=*/false, /*rope_mode=*/0, /*rotary_scale=*/1.0,
+                  /*rotary_theta=*/1e4, /*rope_ext_factors=*/nullptr,
+                  Tensor::Empty({}, DLDataType{kDLFloat, 16, 1}, kCPU),
+                  /*f_transpose_append_mha=*/nullptr, /*f_transpose_append_mla=*/nullptr,
+                  no_kernel, no_kernel, no_kernel, no_kernel, no_kernel, no_kernel, no_kernel,
+                  no_kernel, Array<Function>{f_noop}, f_noop, f_noop, f_noop, f_noop);
+}
+
+/*!
+ * \brief The host planning cost of a decode step of PagedAttentionKVCacheObj::BeginForward
+ * over sequences with 300 tokens of history.
+ */
+void BM_KVCacheBeginForwardDecode(benchmark::State& state) {
+  int64_t num_seqs = state.range(0);
+  Any kv_cache = CreateKVCache(num_seqs, /*page_size=*/16);
+  auto f_add_sequence = Function::GetGlobalRequired("vm.builtin.kv_state_add_sequence");
+  auto f_begin_forward = Function::GetGlobalRequired("vm.builtin.kv_state_begin_forward");
+  auto f_end_forward = Function::GetGlobalRequired("vm.builtin.kv_state_end_forward");
+  auto f_popn = Function::GetGlobalRequired("vm.builtin.kv_state_popn");
+
+  std::vector<int64_t> seq_ids;
+  for (int64_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+    f_add_sequence(kv_cache, seq_id);
+    f_begin_forward(kv_cache, Shape{seq_id}, Shape{300});
+    f_end_forward(kv_cache);
+    seq_ids.push_back(seq_id);
+  }
+  Shape shape_seq_ids(seq_ids);
+  Shape append_lengths(std::vector<int64_t>(num_seqs, 1));
+  for (auto _ : state) {
+    f_begin_forward(kv_cache, shape_seq_ids, append_lengths);
+    f_end_forward(kv_cache);
+    // Drop the decoded tokens so that every step plans the same history.
+    state.PauseTiming();
+    for (int64_t seq_id : seq_ids) {
+      f_popn(kv_cache, seq_id, 1);
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * num_seqs);
+}
+BENCHMARK(BM_KVCacheBeginForwardDecode)->Arg(1)->Arg(16)->Arg(64);
+
+}  // namespace
@@ -189,6 +189,32 @@ def test_analyzer_object_rewrite_simplify_stats():
     assert analyzer.rewrite_simplify_stats.nodes_visited == 0
 
 
+def test_analyzer_object_simplify_memo_table():
+    analyzer = tvm.arith.Analyzer()
+    analyzer.set_simplify_memo_table_size(16)
+    x = tirx.Var("x", "int32")
+    y = tirx.Var("y", "int32")
+
+    analyzer.rewrite_simplify(x * 1 + y * 0)
+    assert analyzer.rewrite_simplify_stats.memo_hits == 0
+    tvm.ir.assert_structural_equal(analyzer.rewrite_simplify(x * 1 + y * 0), x)
+    assert analyzer.rewrite_simplify_stats.memo_hits == 1
+
+    # A constraint scope changes the known facts, and restores them on exit.
+    with analyzer.constraint_scope(x < 4):
+        tvm.ir.assert_structural_equal(analyzer.rewrite_simplify(x * 1 + y * 0), x)
+        assert analyzer.rewrite_simplify_stats.memo_hits == 1
+    analyzer.rewrite_simplify(x * 1 + y * 0)
+    assert analyzer.rewrite_simplify_stats.memo_hits == 2
+
+    # A binding invalidates the memoized results.
+    analyzer.bind(x, tirx.const(3, "int32"))
+    tvm.ir.assert_structural_equal(
+        analyzer.rewrite_simplify(x * 1 + y * 0), tirx.const(3, "int32")
+    )
+    assert analyzer.rewrite_simplify_stats.memo_hits == 2
+
+
 def test_analyzer_object_state_persists_across_ffi_calls():
     analyzer = tvm.arith.Analyzer()
     tile = tirx.Var("tile", "int32")
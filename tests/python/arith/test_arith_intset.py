@@ -245,6 +245,13 @@ def test_region_bound_stride_too_wide():
     check_region_bound({(i * 4, i * 4 + 2): (0, 254)}, var_dom, mode="upperbound")
 
 
+def test_region_upper_bound_stride_too_wide_with_predicate():
+    i = tvm.tirx.Var("i", "int32")
+    var_dom = {i: tvm.ir.Range(begin=0, end=64)}
+    # The hull of the strided access stops at the last iteration allowed by the predicate.
+    check_region_bound({(i * 4, i * 4 + 2): (0, 38)}, var_dom, predicate=i < 10, mode="upperbound")
+
+
 def test_region_bound_small_stride():
     i = tvm.tirx.Var("i", "int32")
     var_dom = {
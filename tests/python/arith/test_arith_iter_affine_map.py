@@ -1442,5 +1442,32 @@ def test_iter_map_simplify_accepts_external_analyzer():
     tvm.ir.assert_structural_equal(simplified, [i % 8])
 
 
+def test_detect_iter_map_batch():
+    x = tvm.tirx.Var("x", "int32")
+    y = tvm.tirx.Var("y", "int32")
+    z = tvm.tirx.Var("z", "int32")
+    dom = var_dom([(x, 4), (y, 18), (z, 3)])
+    fused = x * 54 + y * 3 + z
+    predicate = y * 3 + z < 50
+    indices_list = [
+        [fused // 6, fused % 6],
+        [y // 4, y % 4],
+        [x + y],
+        [(y * 3 + z) // 5, (y * 3 + z) % 5, x],
+    ]
+    results = tvm.arith.detect_iter_map_batch(indices_list, dom, predicate)
+    assert len(results) == len(indices_list)
+    for indices, res in zip(indices_list, results):
+        expected = tvm.arith.detect_iter_map(indices, dom, predicate)
+        tvm.ir.assert_structural_equal(res.indices, expected.indices)
+        tvm.ir.assert_structural_equal(res.padding_predicate, expected.padding_predicate)
+        assert len(res.errors) == len(expected.errors)
+    # [y // 4, y % 4] is padded, which must not leak into the lists after it.
+    assert len(results[2].indices) == 0
+
+    invalid = tvm.arith.detect_iter_map_batch([[x], [y]], {x: tvm.ir.Range(0, y), y: dom[y]})
+    assert all(len(res.indices) == 0 and len(res.errors) == 1 for res in invalid)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
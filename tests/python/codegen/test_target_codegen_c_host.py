@@ -245,5 +245,31 @@ def test_workspace_allocation_cast():
     built.export_library(temp.relpath("workspace.so"))
 
 
+def test_static_workspace_plan():
+    @I.ir_module
+    class Module:
+        @T.prim_func
+        def main(A: T.Buffer((1024,), "float32")):
+            workspace = T.alloc_buffer((1024,), "float32", scope="global")
+            for i in range(1024):
+                workspace[i] = A[i]
+            for i in range(1024):
+                A[i] = workspace[i] * T.float32(2)
+
+    with tvm.transform.PassContext(config={"tirx.static_workspace_plan": True}):
+        built = tvm.tirx.build(Module, target="c")
+    source = built.inspect_source()
+    assert "TVMBackendAllocWorkspace" not in source
+    assert "static uint8_t __tvm_static_workspace[4096]" in source
+
+    temp = utils.tempdir()
+    built.export_library(temp.relpath("static_workspace.so"))
+    f = tvm.runtime.load_module(temp.relpath("static_workspace.so"))["main"]
+    a_np = np.random.uniform(size=1024).astype("float32")
+    a = tvm.runtime.tensor(a_np, tvm.cpu(0))
+    f(a)
+    tvm.testing.assert_allclose(a.numpy(), a_np * 2)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
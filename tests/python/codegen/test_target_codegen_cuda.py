@@ -1214,5 +1214,31 @@ def test_export_load_with_fallback(monkeypatch, tmp_path):
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
+def test_preload():
+    @T.prim_func(s_tir=True)
+    def add_one(A: T.Buffer((256,), "float32"), B: T.Buffer((256,), "float32")):
+        for bx in T.thread_binding(2, "blockIdx.x"):
+            for tx in T.thread_binding(128, "threadIdx.x"):
+                B[bx * 128 + tx] = A[bx * 128 + tx] + T.float32(1)
+
+    lib = tvm.compile(add_one, target="cuda")
+    a_np = np.random.uniform(size=(256,)).astype("float32")
+
+    def run_and_check():
+        lib.mod.preload()
+        lib.mod.preload(["add_one_kernel"], [0])
+        with pytest.raises(ValueError):
+            lib.mod.imports[0].get_function("__tvm_preload")(["missing_kernel"], [0])
+        dev = tvm.cuda(0)
+        a_nd = tvm.runtime.tensor(a_np, dev)
+        b_nd = tvm.runtime.tensor(np.zeros((256,), "float32"), dev)
+        lib["add_one"](a_nd, b_nd)
+        tvm.testing.assert_allclose(b_nd.numpy(), a_np + 1)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -16,6 +16,7 @@
 # under the License.
 # ruff: noqa: E501, E731, E741, F841
 import math
+import os
 import re
 
 import numpy as np
@@ -361,6 +362,129 @@ def test_multiple_func():
     tvm.testing.assert_allclose(c.numpy(), a.numpy() + b.numpy())
 
 
+@pytest.mark.skipif(not env.has_llvm(), reason="need llvm")
+def test_multiple_func_object_shards():
+    @I.ir_module(s_tir=True)
+    class Module:
+        @T.prim_func(s_tir=True)
+        def fadd(A: T.Buffer((16,), "float32"), C: T.Buffer((16,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(16):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(16, i)
+                    C[v_i] = A[v_i] + T.float32(1.0)
+
+        @T.prim_func(s_tir=True)
+        def fmul(A: T.Buffer((16,), "float32"), C: T.Buffer((16,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(16):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(16, i)
+                    C[v_i] = A[v_i] * T.float32(2.0)
+
+        @T.prim_func(s_tir=True)
+        def fsub(A: T.Buffer((16,), "float32"), C: T.Buffer((16,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(16):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(16, i)
+                    C[v_i] = A[v_i] - T.float32(3.0)
+
+    with tvm.transform.PassContext(config={"codegen.llvm.num_object_shards": 3}):
+        f = tvm.compile(Module, target="llvm")
+    temp = utils.tempdir()
+    path_dso = temp.relpath("sharded.so")
+    f.export_library(path_dso)
+    f = tvm.runtime.load_module(path_dso)
+
+    dev = tvm.cpu(0)
+    a = tvm.runtime.tensor(np.random.uniform(size=16).astype("float32"), dev)
+    c = tvm.runtime.empty((16,), "float32", dev)
+    f["fadd"](a, c)
+    tvm.testing.assert_allclose(c.numpy(), a.numpy() + 1)
+    f["fmul"](a, c)
+    tvm.testing.assert_allclose(c.numpy(), a.numpy() * 2)
+    f["fsub"](a, c)
+    tvm.testing.assert_allclose(c.numpy(), a.numpy() - 3)
+
+
+@pytest.mark.skipif(
+    not env.has_llvm() or "x86_64" not in tvm.target.codegen.llvm_get_system_triple(),
+    reason="need an x86_64 host",
+)
+def test_llvm_isa_variants(monkeypatch):
+    @I.ir_module(s_tir=True)
+    class Module:
+        @T.prim_func(s_tir=True)
+        def fadd(A: T.Buffer((64,), "float32"), C: T.Buffer((64,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(64):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(64, i)
+                    C[v_i] = A[v_i] + T.float32(1.0)
+
+    config = {"codegen.llvm.isa_variants": ["skylake-avx512", "haswell"]}
+    with tvm.transform.PassContext(config=config):
+        f = tvm.compile(Module, target="llvm")
+    source = f.inspect_source("ll")
+    assert ".isa.skylake-avx512" in source
+    assert ".isa.haswell" in source
+    temp = utils.tempdir()
+    dev = tvm.cpu(0)
+    a = tvm.runtime.tensor(np.random.uniform(size=64).astype("float32"), dev)
+    # The variant is selected once per loaded library, so each setting loads its own copy.
+    variants = [None, "default"]
+    if tvm.get_global_func("runtime.HostSupportsCPUFeature")("avx2"):
+        variants.append("haswell")
+    for i, variant in enumerate(variants):
+        if variant is None:
+            monkeypatch.delenv("TVM_CPU_ISA_VARIANT", raising=False)
+        else:
+            monkeypatch.setenv("TVM_CPU_ISA_VARIANT", variant)
+        path_dso = temp.relpath(f"isa_variants{i}.so")
+        f.export_library(path_dso)
+        loaded = tvm.runtime.load_module(path_dso)
+        c = tvm.runtime.empty((64,), "float32", dev)
+        loaded["fadd"](a, c)
+        tvm.testing.assert_allclose(c.numpy(), a.numpy() + 1)
+
+
+@pytest.mark.skipif(not env.has_llvm(), reason="need llvm")
+def test_orcjit_lazy_object_cache():
+    @I.ir_module(s_tir=True)
+    class Module:
+        @T.prim_func(s_tir=True)
+        def fadd(A: T.Buffer((16,), "float32"), C: T.Buffer((16,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(16):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(16, i)
+                    C[v_i] = A[v_i] + T.float32(1.0)
+
+        @T.prim_func(s_tir=True)
+        def fmul(A: T.Buffer((16,), "float32"), C: T.Buffer((16,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i in range(16):
+                with T.sblock("C"):
+                    v_i = T.axis.spatial(16, i)
+                    C[v_i] = A[v_i] * T.float32(2.0)
+
+    temp = utils.tempdir()
+    cache_dir = temp.relpath("orcjit_cache")
+    config = {"codegen.llvm.orcjit_lazy": True, "codegen.llvm.orcjit_cache_dir": cache_dir}
+    dev = tvm.cpu(0)
+    a = tvm.runtime.tensor(np.random.uniform(size=16).astype("float32"), dev)
+    c = tvm.runtime.empty((16,), "float32", dev)
+    for _ in range(2):
+        with tvm.transform.PassContext(config=config):
+            f = tvm.compile(Module, target={"kind": "llvm", "jit": "orcjit"})
+        f["fadd"](a, c)
+        tvm.testing.assert_allclose(c.numpy(), a.numpy() + 1)
+        f["fmul"](a, c)
+        tvm.testing.assert_allclose(c.numpy(), a.numpy() * 2)
+        assert os.listdir(cache_dir)
+
+
 @pytest.mark.skipif(not env.has_llvm(), reason="need llvm")
 def test_llvm_condition():
     @I.ir_module(s_tir=True)
@@ -1097,6 +1221,27 @@ def test_llvm_target_attributes():
         assert re.match('.*"target-features"=".*[+]avx512f.*".*', attribute_definitions[attr_num])
 
 
+@pytest.mark.skipif(not env.has_llvm(), reason="need llvm")
+def test_llvm_wasm_simd128_by_default():
+    if "wasm32" not in tvm.target.codegen.llvm_get_targets():
+        pytest.skip("LLVM is built without the WebAssembly backend")
+
+    @T.prim_func(s_tir=True)
+    def func(A: T.Buffer((64,), "float32"), B: T.Buffer((64,), "float32")):
+        for i in T.vectorized(64):
+            B[i] = A[i] + T.float32(1)
+
+    target = tvm.target.Target({"kind": "llvm", "mtriple": "wasm32-unknown-unknown-wasm"})
+    llvm_ir = tvm.tirx.build(func, target=target).inspect_source()
+    assert re.search('"target-features"="[^"]*[+]simd128', llvm_ir)
+
+    target = tvm.target.Target(
+        {"kind": "llvm", "mtriple": "wasm32-unknown-unknown-wasm", "mattr": ["-simd128"]}
+    )
+    llvm_ir = tvm.tirx.build(func, target=target).inspect_source()
+    assert not re.search('"target-features"="[^"]*[+]simd128', llvm_ir)
+
+
 @pytest.mark.skipif(not env.has_llvm(), reason="need llvm")
 def test_llvm_assume():
     """
@@ -330,5 +330,54 @@ def test_export_load_with_fallback(monkeypatch, tmp_path):
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_opencl(), reason="need opencl")
+def test_program_binary_cache(tmp_path):
+    import numpy as np
+
+    n = 1024
+
+    @I.ir_module(s_tir=True)
+    class Module:
+        @T.prim_func(s_tir=True)
+        def main(A: T.Buffer((n,), "float32"), B: T.Buffer((n,), "float32")):
+            T.func_attr({"tirx.noalias": True})
+            for i_0 in T.thread_binding(n // 32, thread="blockIdx.x"):
+                for i_1 in T.thread_binding(32, thread="threadIdx.x"):
+                    with T.sblock("B"):
+                        v_i = T.axis.spatial(n, i_0 * 32 + i_1)
+                        T.reads(A[v_i])
+                        T.writes(B[v_i])
+                        B[v_i] = A[v_i] * 2.0
+
+    set_cache = tvm.get_global_func("runtime.opencl.SetProgramBinaryCache")
+    lib_path = str(tmp_path / "lib.so")
+    tvm.compile(Module, target=target).export_library(lib_path)
+    a_np = np.random.uniform(size=(n,)).astype("float32")
+
+    def run_and_check():
+        dev = tvm.opencl(0)
+        a = tvm.runtime.tensor(a_np, dev)
+        b = tvm.runtime.tensor(np.zeros((n,), dtype="float32"), dev)
+        tvm.runtime.load_module(lib_path)["main"](a, b)
+        np.testing.assert_allclose(b.numpy(), a_np * 2.0, rtol=1e-5)
+
+    cache_dir = tmp_path / "cache"
+    set_cache(str(cache_dir), 1 << 26)
+    try:
+        # The first load builds from source and stores the binary, the second loads it.
+        tvm.testing.run_with_gpu_lock(run_and_check)
+        assert len(list(cache_dir.glob("*.clbin"))) == 1
+        tvm.testing.run_with_gpu_lock(run_and_check)
+        assert len(list(cache_dir.glob("*.clbin"))) == 1
+        # Entries beyond the size bound are evicted.
+        set_cache(str(cache_dir), 1)
+        next(cache_dir.glob("*.clbin")).unlink()
+        tvm.testing.run_with_gpu_lock(run_and_check)
+        assert len(list(cache_dir.glob("*.clbin"))) == 0
+    finally:
+        set_cache("", 1 << 26)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -192,6 +192,38 @@ def test_vulkan_bool_load():
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+@pytest.mark.gpu
+@pytest.mark.skipif(
+    not tvm.testing.device_enabled({"kind": "vulkan", "from_device": 0}),
+    reason="vulkan not enabled",
+)
+def test_vulkan_preload():
+    target = tvm.target.Target({"kind": "vulkan", "from_device": 0})
+
+    @T.prim_func(s_tir=True)
+    def add_one(A: T.Buffer((256,), "float32"), B: T.Buffer((256,), "float32")):
+        for bx in T.thread_binding(2, "blockIdx.x"):
+            for tx in T.thread_binding(128, "threadIdx.x"):
+                B[bx * 128 + tx] = A[bx * 128 + tx] + T.float32(1)
+
+    lib = tvm.compile(add_one, target=target)
+    a_np = np.random.uniform(size=(256,)).astype("float32")
+
+    def run_and_check():
+        # Create the pipelines in the background while the inputs are copied.
+        future = lib.mod.preload(background=True)
+        dev = tvm.vulkan()
+        a = tvm.runtime.tensor(a_np, dev)
+        b = tvm.runtime.tensor(np.zeros((256,), "float32"), dev)
+        future.result()
+        with pytest.raises(ValueError):
+            lib.mod.imports[0].get_function("__tvm_preload")(["missing_kernel"], [0])
+        lib["add_one"](a, b)
+        tvm.testing.assert_allclose(b.numpy(), a_np + 1)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
 vulkan_parameter_impl = tvm.testing.parameter("push_constants", "ubo")
 vulkan_parameter_dtype = tvm.testing.parameter("int32", "float32", "int64")
 
@@ -295,7 +295,50 @@ def test_batch_matmul():
     verify_batch_matmul(1, 1, 1, 16, 3, mkl)
 
 
+def verify_grouped_matmul(group_rows, matrix_l, matrix_m, lib, transb=False, dtype="float32"):
+    """Tests matmul op where each row group of the lhs has its own rhs"""
+    if not tvm.get_global_func(lib.__name__ + ".grouped_matmul", True):
+        print("skip because extern function is not available")
+        return
+    num_groups = len(group_rows)
+    total_rows = sum(group_rows)
+    bshape = (num_groups, matrix_m, matrix_l) if transb else (num_groups, matrix_l, matrix_m)
+    input1_data = te.placeholder((total_rows, matrix_l), name="input1_data", dtype=dtype)
+    input2_data = te.placeholder(bshape, name="input2_data", dtype=dtype)
+    indptr_data = te.placeholder((num_groups + 1,), name="indptr", dtype="int64")
+    matmul_result = lib.grouped_matmul(input1_data, input2_data, indptr_data, transb)
+    f = tvm.compile(
+        te.create_prim_func([input1_data, input2_data, indptr_data, matmul_result]),
+        target="llvm",
+    )
+    dev = tvm.cpu(0)
+    a = np.random.uniform(size=(total_rows, matrix_l)).astype(dtype)
+    b = np.random.uniform(size=bshape).astype(dtype)
+    indptr = np.concatenate([[0], np.cumsum(group_rows)]).astype("int64")
+    result = tvm.runtime.tensor(np.zeros((total_rows, matrix_m), dtype=dtype), dev)
+    f(
+        tvm.runtime.tensor(a, dev),
+        tvm.runtime.tensor(b, dev),
+        tvm.runtime.tensor(indptr, dev),
+        result,
+    )
+    expected = np.zeros((total_rows, matrix_m), dtype=dtype)
+    for g in range(num_groups):
+        rhs = b[g].T if transb else b[g]
+        expected[indptr[g] : indptr[g + 1]] = a[indptr[g] : indptr[g + 1]] @ rhs
+    tvm.testing.assert_allclose(result.numpy(), expected, rtol=1e-5)
+
+
+def test_grouped_matmul():
+    """Tests of matmul op over ragged row groups, including empty groups"""
+    for lib in [cblas, mkl]:
+        verify_grouped_matmul([3, 0, 17, 1], 64, 48, lib)
+        verify_grouped_matmul([3, 0, 17, 1], 64, 48, lib, True)
+        verify_grouped_matmul([0, 0, 5], 16, 8, lib, dtype="float64")
+
+
 if __name__ == "__main__":
     test_matmul_add()
     test_quantized_matmul_add()
     test_batch_matmul()
+    test_grouped_matmul()
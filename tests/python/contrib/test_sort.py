@@ -97,6 +97,28 @@ def test_sort_np():
     tvm.testing.assert_allclose(c.numpy(), np_out, rtol=1e-5)
 
 
+def test_topk_np():
+    """Tests topk on rows large enough to be selected in parallel, with ties"""
+    topk = tvm.get_global_func("tvm.contrib.sort.topk")
+    dev = tvm.cpu(0)
+    dshape = (64, 1024)
+    np_data = np.random.randint(0, 50, size=dshape).astype("float32")
+    a = tvm.runtime.tensor(np_data, dev)
+    # k = 8 keeps a running heap, k = 256 and k = 0 (the whole row) select from the row.
+    for k in [8, 256, 0]:
+        for is_ascend in [True, False]:
+            num = k if k > 0 else dshape[1]
+            keys = np_data if is_ascend else -np_data
+            np_indices = np.argsort(keys, axis=1, kind="stable")[:, :num]
+            np_values = np.take_along_axis(np_data, np_indices, axis=1)
+            values = tvm.runtime.tensor(np.zeros((dshape[0], num), dtype="float32"), dev)
+            indices = tvm.runtime.tensor(np.zeros((dshape[0], num), dtype="int32"), dev)
+            topk(a, values, indices, k, 1, "both", is_ascend)
+            tvm.testing.assert_allclose(values.numpy(), np_values)
+            tvm.testing.assert_allclose(indices.numpy(), np_indices)
+
+
 if __name__ == "__main__":
     test_sort()
     test_sort_np()
+    test_topk_np()
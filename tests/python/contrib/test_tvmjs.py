@@ -60,5 +60,101 @@ def test_save_load_float8(dtype):
     np.testing.assert_array_equal(arr, after_roundtrip)
 
 
+def test_tensor_cache_load_mapped():
+    params = {
+        "a": np.arange(1000, dtype="float32"),
+        "b": np.arange(7, dtype="int8"),
+        "c": np.random.uniform(size=(33, 17)).astype("float16"),
+    }
+    get = tvm.get_global_func("vm.builtin.tensor_cache.get")
+    with tempfile.TemporaryDirectory(prefix="tvm_") as temp_dir:
+        tvmjs.dump_tensor_cache(params, temp_dir, encode_format="raw", show_progress=False)
+        device = tvm.cpu()
+        tvm.get_global_func("vm.builtin.tensor_cache.load")(
+            temp_dir, device.dlpack_device_type(), device.index
+        )
+    # The parameters viewing into the mapping stay valid after the files are removed.
+    for name, arr in params.items():
+        np.testing.assert_array_equal(get(name).numpy(), arr)
+    tvm.get_global_func("vm.builtin.tensor_cache.clear")()
+
+
+def test_tensor_cache_load_with_progress():
+    params = {f"p{i}": np.full((256, 1024), i, dtype="float32") for i in range(4)}
+    progress = []
+    with tempfile.TemporaryDirectory(prefix="tvm_") as temp_dir:
+        # 1MB per parameter and shard
+        tvmjs.dump_tensor_cache(
+            params, temp_dir, encode_format="raw", shard_cap_mb=1, show_progress=False
+        )
+        device = tvm.cpu()
+        tvm.get_global_func("vm.builtin.tensor_cache.load_with_progress")(
+            temp_dir,
+            device.dlpack_device_type(),
+            device.index,
+            lambda loaded, total: progress.append((loaded, total)),
+        )
+    total = 4 * 256 * 1024 * 4
+    assert progress[-1] == (total, total)
+    assert [loaded for loaded, _ in progress] == sorted(loaded for loaded, _ in progress)
+    get = tvm.get_global_func("vm.builtin.tensor_cache.get")
+    for name, arr in params.items():
+        np.testing.assert_array_equal(get(name).numpy(), arr)
+    tvm.get_global_func("vm.builtin.tensor_cache.clear")()
+
+
+def test_tensor_cache_load_lazy():
+    params = {f"expert{i}": np.full((64, 64), i, dtype="float32") for i in range(4)}
+    nbytes = 64 * 64 * 4
+    get = tvm.get_global_func("vm.builtin.tensor_cache.get")
+    stats = tvm.get_global_func("vm.builtin.tensor_cache.lazy_stats")
+    with tempfile.TemporaryDirectory(prefix="tvm_") as temp_dir:
+        tvmjs.dump_tensor_cache(params, temp_dir, encode_format="raw", show_progress=False)
+        device = tvm.cpu()
+        # The budget holds two parameters.
+        tvm.get_global_func("vm.builtin.tensor_cache.load_lazy")(
+            temp_dir, device.dlpack_device_type(), device.index, 2 * nbytes
+        )
+        assert stats()["num_faults"] == 0
+        for name, arr in params.items():
+            np.testing.assert_array_equal(get(name).numpy(), arr)
+        assert stats()["num_faults"] == 4
+        assert stats()["num_evictions"] == 2
+        assert stats()["resident_bytes"] == 2 * nbytes
+        # The recently used parameters are resident, the evicted ones are loaded again.
+        get("expert3")
+        assert stats()["num_faults"] == 4
+        np.testing.assert_array_equal(get("expert0").numpy(), params["expert0"])
+        assert stats()["num_faults"] == 5
+    tvm.get_global_func("vm.builtin.tensor_cache.clear")()
+
+
+def test_tensor_cache_share_by_content():
+    base = np.random.uniform(size=(64, 64)).astype("float32")
+    get = tvm.get_global_func("vm.builtin.tensor_cache.get")
+    remove = tvm.get_global_func("vm.builtin.tensor_cache.remove")
+    stats = tvm.get_global_func("vm.builtin.tensor_cache.shared_stats")
+    storage_shared = tvm.get_global_func("runtime.TVMTensorIsStorageShared")
+    device = tvm.cpu()
+    for name in ["ft0", "ft1"]:
+        params = {"base": base, "head": np.random.uniform(size=(8,)).astype("float32")}
+        with tempfile.TemporaryDirectory(prefix="tvm_") as temp_dir:
+            tvmjs.dump_tensor_cache(params, temp_dir, encode_format="raw", show_progress=False)
+            tvm.get_global_func("vm.builtin.tensor_cache.load_with_prefix")(
+                temp_dir, device.dlpack_device_type(), device.index, name + "."
+            )
+        np.testing.assert_array_equal(get(name + ".head").numpy(), params["head"])
+    # The fine-tunes share the base weight, but not their different heads.
+    assert storage_shared(get("ft0.base"), get("ft1.base"))
+    assert not storage_shared(get("ft0.head"), get("ft1.head"))
+    np.testing.assert_array_equal(get("ft1.base").numpy(), base)
+    assert stats()["saved_bytes"] == base.nbytes
+    remove("ft0.base")
+    assert stats()["saved_bytes"] == 0
+    np.testing.assert_array_equal(get("ft1.base").numpy(), base)
+    tvm.get_global_func("vm.builtin.tensor_cache.clear")()
+    assert stats()["num_shared"] == 0
+
+
 if __name__ == "__main__":
     tvm.testing.main()
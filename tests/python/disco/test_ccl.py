@@ -161,6 +161,57 @@ def test_allgather(session_kind, ccl):
     _run_with_ccl_session(session_kind, ccl, devices, run_test)
 
 
+@pytest.mark.parametrize("session_kind", _all_session_kinds)
+@pytest.mark.parametrize("ccl", _ccl)
+def test_group_ring_exchange(session_kind, ccl):
+    devices = [0, 1, 2, 3]
+    num_groups = 2
+    arrays = [np.full((2, 3), i, dtype="float32") for i in range(4)]
+
+    def run_test(sess):
+        d_src = sess.empty((2, 3), "float32")
+        d_dst = sess.empty((2, 3), "float32")
+        for worker_id, array in enumerate(arrays):
+            d_src.debug_copy_from(worker_id, array)
+        sess.ring_exchange(d_src, d_dst)
+        # Worker 0 and 1 form a ring, and worker 2 and 3 form another one.
+        for worker_id, prev_worker_id in enumerate([1, 0, 3, 2]):
+            np.testing.assert_equal(
+                d_dst.debug_get_from_remote(worker_id).numpy(), arrays[prev_worker_id]
+            )
+
+    _run_with_ccl_session(session_kind, ccl, devices, run_test, num_groups=num_groups)
+
+
+@pytest.mark.parametrize("session_kind", _all_session_kinds)
+@pytest.mark.parametrize("ccl", _ccl)
+def test_async_collectives(session_kind, ccl):
+    devices = [0, 1]
+    array_1 = np.arange(12, dtype="float32").reshape(3, 4)
+    array_2 = np.arange(start=1, stop=-11, step=-1, dtype="float32").reshape(3, 4)
+
+    def run_test(sess):
+        d_array = sess.empty((3, 4), "float32")
+        d_array.debug_copy_from(0, array_1)
+        d_array.debug_copy_from(1, array_2)
+        d_reduced = sess.empty((3, 4), "float32")
+        d_gathered = sess.empty((2, 3, 4), "float32")
+        reduce_handle = sess.allreduce_start(d_array, d_reduced, op="sum")
+        gather_handle = sess.allgather_start(d_array, d_gathered)
+        sess.collective_wait(reduce_handle)
+        sess.collective_wait(gather_handle)
+        for worker_id in range(2):
+            np.testing.assert_equal(
+                d_reduced.debug_get_from_remote(worker_id).numpy(), array_1 + array_2
+            )
+            np.testing.assert_equal(
+                d_gathered.debug_get_from_remote(worker_id).numpy(),
+                np.stack([array_1, array_2]),
+            )
+
+    _run_with_ccl_session(session_kind, ccl, devices, run_test)
+
+
 @pytest.mark.parametrize("session_kind", _all_session_kinds)
 @pytest.mark.parametrize("ccl", _ccl)
 def test_group_allgather(session_kind, ccl):
@@ -441,6 +492,29 @@ def test_send_to_next_group_receive_from_prev_group(session_kind, ccl):
     _run_with_ccl_session(session_kind, ccl, devices, run_test, num_groups=2)
 
 
+@pytest.mark.parametrize("session_kind", _all_session_kinds)
+@pytest.mark.parametrize("ccl", _ccl)
+def test_pipeline_run(session_kind, ccl):
+    devices = [0, 1, 2, 3]
+    num_micro_batches = 3
+    inputs = np.arange(num_micro_batches * 8, dtype="float32").reshape(num_micro_batches, 2, 4)
+
+    def run_test(sess):
+        d_inputs = sess.empty((num_micro_batches, 2, 4), "float32")
+        d_outputs = sess.empty((num_micro_batches, 2, 4), "float32")
+        d_inputs.debug_copy_from(0, inputs)
+        d_inputs.debug_copy_from(1, inputs * 2)
+        stage_func = sess.get_global_func("tests.disco.pipeline_stage_add_one")
+        sess.pipeline_run(stage_func, num_micro_batches, d_inputs, d_outputs, (2, 4), "float32")
+
+        # Each of the two stages adds `micro_batch + 1` to the micro-batch.
+        offsets = 2 * (np.arange(num_micro_batches, dtype="float32") + 1).reshape(-1, 1, 1)
+        np.testing.assert_equal(d_outputs.debug_get_from_remote(2).numpy(), inputs + offsets)
+        np.testing.assert_equal(d_outputs.debug_get_from_remote(3).numpy(), inputs * 2 + offsets)
+
+    _run_with_ccl_session(session_kind, ccl, devices, run_test, num_groups=2)
+
+
 @pytest.mark.parametrize("session_kind", _all_session_kinds)
 @pytest.mark.parametrize("ccl", _ccl)
 def test_worker2_send_to_worker0(session_kind, ccl):
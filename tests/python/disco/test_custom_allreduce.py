@@ -83,6 +83,37 @@ def test_allreduce(shape, ccl, strategy):
     np.testing.assert_equal(result_2, expected)
 
 
+
+@pytest.mark.parametrize("shape", _shapes)
+@pytest.mark.parametrize("ccl", _ccl)
+@pytest.mark.parametrize("use_ipc_memory", [True, False])
+def test_dispatch_allreduce(shape, ccl, use_ipc_memory):
+    devices = [0, 1]
+    sess = disco.ProcessSession(num_workers=len(devices))
+    sess.init_ccl(ccl, *devices)
+
+    num_elements = reduce(lambda x, y: x * y, shape)
+    dtype = "float32"
+    if use_ipc_memory:
+        falloc_ipc_storage = sess.get_global_func("runtime.disco.cuda_ipc.alloc_storage")
+        falloc_tensor = sess.get_global_func("vm.builtin.alloc_tensor")
+        d_storage = sess.call_packed(falloc_ipc_storage, Shape(shape), DataType(dtype))
+        d_input = sess.call_packed(falloc_tensor, d_storage, 0, Shape(shape), DataType(dtype))
+    else:
+        d_input = sess.empty(shape, dtype)
+    fallreduce = sess.get_global_func("runtime.disco.cuda_ipc.dispatch_allreduce")
+
+    array_1 = np.arange(num_elements, dtype="float32").reshape(*shape)
+    array_2 = np.arange(start=1, stop=-(num_elements - 1), step=-1, dtype="float32").reshape(*shape)
+    d_input.debug_copy_from(0, array_1)
+    d_input.debug_copy_from(1, array_2)
+    d_output = sess.empty(shape, "float32")
+
+    sess.call_packed(fallreduce, d_input, 0, True, d_output)
+    expected = np.add(array_1, array_2)
+    np.testing.assert_equal(d_output.debug_get_from_remote(0).numpy(), expected)
+    np.testing.assert_equal(d_output.debug_get_from_remote(1).numpy(), expected)
+
 if __name__ == "__main__":
     for shape, strategy in product(_shapes, _strategies):
         test_allreduce(shape, "nccl", strategy)
@@ -408,6 +408,41 @@ def test_load_all_presharded():
         _run_with_nccl_session(devices, run_test)
 
 
+def test_load_all_dumped_presharded():
+    devices = [0, 1]
+    num_shards = len(devices)
+    param_dict = {
+        "param_0": np.random.uniform(size=[64, 128]).astype("float16"),
+        "param_1": np.random.uniform(size=[32, 128]).astype("float32"),
+        "param_2": np.random.uniform(size=[16]).astype("float32"),
+    }
+    shard_info = {
+        "param_0": [["tests.disco.shard_dim_1", [(num_shards, 64, 64), "float16"], num_shards]],
+        "param_1": [["tests.disco.shard_dim_0", [(num_shards, 16, 128), "float32"], num_shards]],
+    }
+    with tempfile.TemporaryDirectory() as path:
+        tvmjs.dump_presharded_tensor_cache(param_dict, path, shard_info, num_shards)
+        with open(path + "/tensor-cache.json", encoding="utf-8") as i_f:
+            records = json.load(i_f)["records"]
+        # The binary files of the workers are disjoint.
+        for record in records:
+            assert len({rec["name"].rsplit("_shard-", 1)[1] for rec in record["records"]}) == 1
+
+        def run_test(sess):
+            loader = _create_presharded_loader(sess, path)
+            params = sess.get_global_func("runtime.disco.ShardLoaderLoadAll")(loader)
+            p_0 = params.debug_get_from_remote(0)
+            p_1 = params.debug_get_from_remote(1)
+            np.testing.assert_equal(param_dict["param_0"][:, 0:64], p_0[0].numpy())
+            np.testing.assert_equal(param_dict["param_0"][:, 64:128], p_1[0].numpy())
+            np.testing.assert_equal(param_dict["param_1"][0:16, :], p_0[1].numpy())
+            np.testing.assert_equal(param_dict["param_1"][16:32, :], p_1[1].numpy())
+            np.testing.assert_equal(param_dict["param_2"], p_0[2].numpy())
+            np.testing.assert_equal(param_dict["param_2"], p_1[2].numpy())
+
+        _run_with_nccl_session(devices, run_test)
+
+
 def test_load_shard_broadcast():
     devices = [0, 1]
     param_dict = {
@@ -149,7 +149,13 @@ def _numpy_from_worker_0(sess: di.Session, remote_array, shape, dtype):
     return host_array.numpy()
 
 
+def create_shm_process_session(num_workers):
+    return di.ProcessSession(num_workers=num_workers, transport="shm")
+
+
 _all_session_kinds = [di.ThreadedSession, di.ProcessSession, create_socket_session]
+if sys.platform.startswith("linux"):
+    _all_session_kinds.append(create_shm_process_session)
 
 
 @pytest.mark.parametrize("session_kind", _all_session_kinds)
@@ -343,5 +349,25 @@ def test_num_workers(session_kind, num_workers):
     assert sess.num_workers == num_workers
 
 
+
+@pytest.mark.parametrize("session_kind", _all_session_kinds)
+def test_command_graph(session_kind):
+    num_workers = 2
+    sess = session_kind(num_workers=num_workers)
+    add_one: di.DPackedFunc = sess.get_global_func("tests.disco.add_one")
+    x = add_one(0)
+    sess.begin_capture()
+    y = add_one(x)
+    z = add_one(y)
+    graph = sess.end_capture([x])
+    for i in range(num_workers):
+        assert x.debug_get_from_remote(i) == 1
+    for step in range(3):
+        graph(step * 10)
+        for i in range(num_workers):
+            assert y.debug_get_from_remote(i) == step * 10 + 1
+            assert z.debug_get_from_remote(i) == step * 10 + 2
+
+
 if __name__ == "__main__":
     tvm.testing.main()
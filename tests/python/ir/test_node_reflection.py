@@ -46,6 +46,34 @@ def test_save_json_metadata_version():
     assert list(tvm.ir.load_json(json_str)) == [1, 2]
 
 
+def test_save_load_binary():
+    x = tvm.tirx.Var("x", "int32")
+    y = x + tvm.tirx.const(1, "int32")
+    # The shared node, the strings of the map and the tensor round trip.
+    obj = tvm.runtime.convert(
+        {
+            "expr": [y, y * y],
+            "op": tvm.ir.Op.get("tirx.if_then_else"),
+            "shape": tvm_ffi.Shape([2, 3]),
+            "tensor": tvm.runtime.tensor(np.arange(6, dtype="float32").reshape(2, 3)),
+            "value": 1.5,
+        }
+    )
+    data = tvm.ir.save_binary(obj)
+    assert isinstance(data, bytes)
+    loaded = tvm.ir.load_binary(data)
+    exprs = loaded["expr"]
+    tvm.ir.assert_structural_equal(exprs, obj["expr"], map_free_vars=True)
+    assert exprs[0].same_as(exprs[1].a)
+    assert loaded["op"].same_as(obj["op"])
+    assert list(loaded["shape"]) == [2, 3]
+    np.testing.assert_equal(loaded["tensor"].numpy(), obj["tensor"].numpy())
+    assert loaded["value"] == 1.5
+
+    with pytest.raises(ValueError):
+        tvm.ir.load_binary(data[:-1])
+
+
 _LEGACY_RELAX_VAR_JSON = """{
   "root_index": 9,
   "nodes": [
@@ -17,9 +17,11 @@
 # ruff: noqa: E741
 """Instrument test cases."""
 
+import json
+
 import tvm
 from tvm import relax
-from tvm.ir.instrument import PrintAfterAll, PrintBeforeAll
+from tvm.ir.instrument import PassProfilingInstrument, PrintAfterAll, PrintBeforeAll
 from tvm.script import ir as I
 from tvm.script import relax as R
 from tvm.script import tirx as T
@@ -61,3 +63,58 @@ def test_relax_print_all_passes(capsys):
     assert "Before Running Pass:" in all_passes_output
     assert "After Running Pass:" in all_passes_output
     assert 'name="_pipeline"' in all_passes_output
+
+
+def test_relax_pass_profiling():
+    @I.ir_module(s_tir=True)
+    class Module:
+        @R.function
+        def func(x: R.Tensor((16,), "float32"), y: R.Tensor((16,), "float32")):
+            z = R.add(x, y)
+            y = z
+            return y
+
+    profiling_inst = PassProfilingInstrument()
+    pipeline = relax.get_pipeline("default_build")
+    with tvm.transform.PassContext(opt_level=3, instruments=[profiling_inst]):
+        pipeline(Module)
+    # The profile is kept after the pass context exits.
+    profile = json.loads(profiling_inst.render_json())
+    assert profile["total_us"] > 0
+    (pipeline_profile,) = profile["passes"]
+    assert pipeline_profile["name"] == "_pipeline"
+    assert pipeline_profile["nodes_before"] > 0
+    assert pipeline_profile["peak_rss_kb"] != 0
+
+    def walk(passes):
+        for p in passes:
+            yield p
+            yield from walk(p.get("passes", []))
+
+    passes = list(walk(profile["passes"]))
+    assert all(p["self_us"] <= p["duration_us"] for p in passes)
+    function_names = {f["name"] for p in passes for f in p.get("functions", [])}
+    assert "func" in function_names
+
+
+def test_tir_pass_profiling_chrome_trace():
+    @T.prim_func(s_tir=True)
+    def func(a: T.handle, b: T.handle) -> None:
+        A = T.match_buffer(a, (128,))
+        B = T.match_buffer(b, (128,))
+        for i in range(128):
+            with T.sblock("B"):
+                vi = T.axis.spatial(128, i)
+                B[vi] = A[vi] * 2.0
+
+    profiling_inst = PassProfilingInstrument(count_nodes=False)
+    with tvm.transform.PassContext(opt_level=3, instruments=[profiling_inst]):
+        tvm.compile(func)
+    events = json.loads(profiling_inst.render_chrome_trace())["traceEvents"]
+    pass_events = [e for e in events if e["ph"] == "X" and e["cat"] == "pass"]
+    function_events = [e for e in events if e["ph"] == "X" and e["cat"] == "function"]
+    counter_events = [e for e in events if e["ph"] == "C"]
+    assert any(e["name"].startswith("tirx.") for e in pass_events)
+    assert function_events
+    assert len(counter_events) == len(pass_events)
+    assert all("ir_nodes" not in e["args"] for e in counter_events)
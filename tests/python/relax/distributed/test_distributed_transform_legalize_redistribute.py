@@ -65,5 +65,100 @@ def test_simple():
     tvm.ir.assert_structural_equal(after, Expected)
 
 
+def _call_ops(func):
+    return [
+        binding.value.op.name
+        for block in func.body.blocks
+        for binding in block.bindings
+        if isinstance(binding.value, relax.Call) and isinstance(binding.value.op, tvm.ir.Op)
+    ]
+
+
+def test_allgather():
+    @I.ir_module
+    class Before:
+        I.module_attrs({"device_num": 2})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(
+            x1: R.DTensor((128, 64), "float32", "mesh[0]", "S[0]"),
+            x2: R.DTensor((128, 64), "float32", "mesh[0]", "S[1]"),
+        ):
+            R.func_attr({"num_input": 1})
+            lv0 = R.dist.redistribute(x1, "mesh[0]", "R")
+            lv1 = R.dist.redistribute(x2, "mesh[0]", "R")
+            return (lv0, lv1)
+
+    after = relax.distributed.transform.LegalizeRedistribute()(Before)
+    assert _call_ops(after["foo"]) == [
+        "relax.ccl.allgather",
+        "relax.permute_dims",
+        "relax.ccl.allgather",
+        "relax.permute_dims",
+    ]
+    tvm.ir.assert_structural_equal(after["foo"].ret_ty, Before["foo"].ret_ty)
+    lowered = relax.distributed.transform.LowerDistIR()(after)
+    tvm.ir.assert_structural_equal(
+        lowered["foo"].ret_ty,
+        R.Tuple(R.Tensor((128, 64), "float32"), R.Tensor((128, 64), "float32")),
+    )
+
+
+def test_allgather_matmul_pipeline():
+    @I.ir_module
+    class Before:
+        I.module_attrs({"device_num": 2})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(
+            x: R.DTensor((128, 64), "float32", "mesh[0]", "S[0]"),
+            w: R.DTensor((64, 256), "float32", "mesh[0]", "S[1]"),
+        ):
+            R.func_attr({"num_input": 1})
+            with R.dataflow():
+                lv0 = R.dist.redistribute(x, "mesh[0]", "R")
+                lv1 = R.matmul(lv0, w)
+                R.output(lv1)
+            return lv1
+
+    after = relax.distributed.transform.LegalizeRedistribute(num_chunks=2)(Before)
+    ops = _call_ops(after["foo"])
+    assert "relax.dist.redistribute" not in ops
+    assert ops.count("relax.ccl.allgather") == 2
+    assert ops.count("relax.matmul") == 2
+    assert ops[-2:] == ["relax.concat", "relax.reshape"]
+    tvm.ir.assert_structural_equal(after["foo"].ret_ty, Before["foo"].ret_ty)
+    lowered = relax.distributed.transform.LowerDistIR()(after)
+    tvm.ir.assert_structural_equal(lowered["foo"].ret_ty, R.Tensor((128, 128), "float32"))
+
+    # Without pipelining, the allgather is emitted as a standalone collective.
+    after = relax.distributed.transform.LegalizeRedistribute(num_chunks=1)(Before)
+    assert _call_ops(after["foo"]) == ["relax.ccl.allgather", "relax.matmul"]
+
+
+def test_allreduce_to_reducescatter():
+    @I.ir_module
+    class Before:
+        I.module_attrs({"device_num": 2})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(x: R.DTensor((128, 128), "float32", "mesh[0]", "R")):
+            R.func_attr({"num_input": 1})
+            with R.dataflow():
+                lv0 = R.ccl.allreduce(x, "sum")
+                lv1 = R.dist.redistribute(lv0, "mesh[0]", "S[0]")
+                R.output(lv1)
+            return lv1
+
+    after = relax.distributed.transform.LegalizeRedistribute()(Before)
+    assert _call_ops(after["foo"]) == ["relax.ccl.reducescatter"]
+    tvm.ir.assert_structural_equal(after["foo"].ret_ty, Before["foo"].ret_ty)
+    lowered = relax.distributed.transform.LowerDistIR()(after)
+    tvm.ir.assert_structural_equal(lowered["foo"].ret_ty, R.Tensor((64, 128), "float32"))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -0,0 +1,88 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+#  type: ignore
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.ir import assert_structural_equal
+from tvm.relax.distributed import Placement
+from tvm.script.parser import ir as I
+from tvm.script.parser import relax as R
+
+
+def _mlp(hidden_size):
+    @I.ir_module(s_tir=True)
+    class MLP:
+        I.module_attrs({"device_num": 10})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(
+            x: R.Tensor((128, hidden_size), "float32"),
+            weight1: R.Tensor((hidden_size, hidden_size), "float32"),
+            weight2: R.Tensor((hidden_size, hidden_size), "float32"),
+        ) -> R.Tensor((128, hidden_size), "float32"):
+            with R.dataflow():
+                lv0 = R.matmul(x, weight1)
+                lv1 = R.nn.gelu(lv0)
+                lv2 = R.matmul(lv1, weight2)
+                R.output(lv2)
+            return lv2
+
+    return MLP
+
+
+def _plan_and_propagate(mod, **kwargs):
+    mesh = mod.global_infos["mesh"][0]
+    mod = relax.distributed.transform.PlanSharding(mesh, **kwargs)(mod)
+    return relax.distributed.transform.PropagateSharding()(mod)
+
+
+def _check_placements(func, placements):
+    for param, placement in zip(func.params, placements):
+        assert_structural_equal(param.ty.placement, Placement.from_text(placement))
+
+
+def test_mlp_data_parallel():
+    # Sharding the batch halves the computation and only gathers the output.
+    after = _plan_and_propagate(_mlp(4096))
+    _check_placements(after["foo"], ["S[0]", "R", "R"])
+
+
+def test_mlp_tensor_parallel():
+    # The replicated weights take 128MB per device, beyond the budget.
+    after = _plan_and_propagate(_mlp(4096), memory_budget=80 * 1024 * 1024)
+    # The column parallel and then row parallel matmul with one all-reduce.
+    _check_placements(after["foo"], ["R", "S[1]", "S[0]"])
+
+
+def test_small_mlp_replicated():
+    # The collective latency outweighs the saved computation.
+    after = _plan_and_propagate(_mlp(128))
+    _check_placements(after["foo"], ["R", "R", "R"])
+
+
+def test_small_mlp_memory_budget():
+    # The parameters take 192KB per device when replicated, and 128KB with the weights sharded.
+    after = _plan_and_propagate(_mlp(128), memory_budget=128 * 1024)
+    _check_placements(after["foo"], ["R", "S[1]", "S[0]"])
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -74,6 +74,36 @@ def test_mlp():
     assert_structural_equal(after, ShardedMLP)
 
 
+def test_alltoall():
+    @I.ir_module(s_tir=True)
+    class AllToAll:
+        I.module_attrs({"device_num": 10})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(x: R.Tensor((128, 128), "float32")) -> R.Tensor((128, 128), "float32"):
+            lv0 = R.dist.annotate_sharding(x, device_mesh="mesh[0]", placement="S[1]")
+            lv1 = R.ccl.alltoall(lv0, 2)
+            lv2 = R.nn.gelu(lv1)
+            return lv2
+
+    @I.ir_module(s_tir=True)
+    class ShardedAllToAll:
+        I.module_attrs({"device_num": 10})
+        I.module_global_infos({"mesh": [R.device_mesh((2,), I.Range(0, 2))]})
+
+        @R.function
+        def foo(
+            x: R.DTensor((128, 128), "float32", "mesh[0]", "S[1]"),
+        ) -> R.DTensor((128, 128), "float32", "mesh[0]", "S[1]"):
+            lv1: R.DTensor((128, 128), "float32", "mesh[0]", "S[1]") = R.ccl.alltoall(x, 2)
+            lv2: R.DTensor((128, 128), "float32", "mesh[0]", "S[1]") = R.nn.gelu(lv1)
+            return lv2
+
+    after = relax.distributed.transform.PropagateSharding()(AllToAll)
+    assert_structural_equal(after, ShardedAllToAll)
+
+
 def test_mlp_with_tuple():
     @I.ir_module(s_tir=True)
     class MLPWithTuple:
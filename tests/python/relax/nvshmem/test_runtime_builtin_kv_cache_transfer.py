@@ -96,6 +96,7 @@ fnvshmem_get_uid = None
 fnvshmem_init = None
 fdisagg_mark_send = None
 fdisagg_prepare_recv = None
+fdisagg_wait_recv = None
 
 ftranspose_append = None
 fcopy_cache = None
@@ -125,6 +126,7 @@ def set_global_func(head_dim, dtype, target):
     global fattn_prefill_sliding_window, fattn_decode_sliding_window
     global fmerge_state, fsplit_rotary, fattention_rotary, fcopy_single_page, fcompact_copy
     global fnvshmem_get_uid, fnvshmem_init, fdisagg_mark_send, fdisagg_prepare_recv
+    global fdisagg_wait_recv
 
     fclear = tvm.get_global_func("vm.builtin.kv_state_clear")
     fadd_sequence = tvm.get_global_func("vm.builtin.kv_state_add_sequence")
@@ -149,6 +151,7 @@ def set_global_func(head_dim, dtype, target):
     fnvshmem_init = tvm.get_global_func("runtime.disco.nvshmem.init_nvshmem")
     fdisagg_mark_send = tvm.get_global_func("vm.builtin.kv_cache_disagg_mark_send")
     fdisagg_prepare_recv = tvm.get_global_func("vm.builtin.kv_cache_disagg_prepare_recv")
+    fdisagg_wait_recv = tvm.get_global_func("vm.builtin.kv_cache_disagg_wait_recv")
 
     builts = []
     for tir_func in [
@@ -749,6 +752,8 @@ def test_paged_attention_kv_cache_transfer(kv_cache_and_config):
                 skip_add_sequence=True,
             )
         comm.Barrier()
+        for seq_id in prefill_len.keys():
+            fdisagg_wait_recv(kv_cache, seq_id, 0)
         for batch in decode_operation_seq:
             apply_attention(kv_cache, rope_mode, batch, cached_k, cached_v, skip_add_sequence=True)
 
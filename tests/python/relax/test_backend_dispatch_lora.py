@@ -0,0 +1,156 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=missing-docstring
+import numpy as np
+import pytest
+from tvm_ffi import Shape
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.relax.backend import DispatchLoRA
+from tvm.script import ir as I
+from tvm.script import relax as R
+
+HIDDEN_SIZE, OUT_SIZE, RANK, NUM_SLOTS = 24, 40, 4, 2
+
+
+def _get_mod():
+    @I.ir_module
+    class Module:
+        @R.function
+        def main(
+            x: R.Tensor(("n", HIDDEN_SIZE), "float32"),
+            a: R.Tensor((NUM_SLOTS, RANK, HIDDEN_SIZE), "float32"),
+            b: R.Tensor((NUM_SLOTS, OUT_SIZE, RANK), "float32"),
+            seg_indptr: R.Tensor(ndim=1, dtype="int32"),
+            weight_indices: R.Tensor(ndim=1, dtype="int32"),
+        ):
+            with R.dataflow():
+                h = R.lora.sgmv(x, a, seg_indptr, weight_indices)
+                gv = R.lora.sgmv(h, b, seg_indptr, weight_indices)
+                R.output(gv)
+            return gv
+
+    return Module
+
+
+def _random_adapter():
+    return [
+        np.random.uniform(-1, 1, (RANK, HIDDEN_SIZE)).astype("float32"),
+        np.random.uniform(-1, 1, (OUT_SIZE, RANK)).astype("float32"),
+    ]
+
+
+def _check(target, dev):
+    np.random.seed(0)
+    adapters = {7: _random_adapter(), 9: _random_adapter()}
+    pool = tvm.get_global_func("vm.builtin.lora_adapter_pool_create")(
+        1,
+        NUM_SLOTS,
+        [Shape([RANK, HIDDEN_SIZE]), Shape([OUT_SIZE, RANK])],
+        tvm.runtime.tensor(np.zeros((), "float32"), dev),
+    )
+    f_load = tvm.get_global_func("vm.builtin.lora_adapter_pool_load")
+    for adapter_id, weights in adapters.items():
+        f_load(pool, adapter_id, [tvm.runtime.tensor(w, dev) for w in weights])
+
+    # The two sequences of adapter 9 form one segment, the base model sequence has no adapter.
+    seq_adapters, lengths = [9, 9, -1, 7], [3, 2, 4, 5]
+    tvm.get_global_func("vm.builtin.lora_adapter_pool_begin_forward")(
+        pool, Shape(seq_adapters), Shape(lengths)
+    )
+    seg_indptr = tvm.get_global_func("vm.builtin.lora_adapter_pool_get_seg_indptr")(pool)
+    weight_indices = tvm.get_global_func("vm.builtin.lora_adapter_pool_get_weight_indices")(pool)
+    np.testing.assert_equal(seg_indptr.numpy(), [0, 5, 9, 14])
+    assert weight_indices.numpy()[1] == -1
+
+    with tvm.target.Target(target):
+        mod = DispatchLoRA()(_get_mod())
+        assert not any(
+            isinstance(func, relax.Function) and "relax.lora." in func.script()
+            for func in mod.functions.values()
+        )
+        ex = tvm.compile(mod, target)
+    vm = relax.VirtualMachine(ex, dev)
+    f_get_weight = tvm.get_global_func("vm.builtin.lora_adapter_pool_get_weight")
+    x = np.random.uniform(-1, 1, (sum(lengths), HIDDEN_SIZE)).astype("float32")
+    out = vm["main"](
+        tvm.runtime.tensor(x, dev),
+        f_get_weight(pool, 0, 0),
+        f_get_weight(pool, 0, 1),
+        seg_indptr,
+        weight_indices,
+    )
+
+    expected = np.zeros((sum(lengths), OUT_SIZE), "float32")
+    row = 0
+    for adapter_id, length in zip(seq_adapters, lengths):
+        if adapter_id >= 0:
+            a, b = adapters[adapter_id]
+            expected[row : row + length] = x[row : row + length] @ a.T @ b.T
+        row += length
+    tvm.testing.assert_allclose(out.numpy(), expected, rtol=1e-5, atol=1e-5)
+
+
+def test_dispatch_lora_cpu():
+    _check("llvm", tvm.cpu())
+
+
+@pytest.mark.gpu
+def test_dispatch_lora_cuda():
+    if not tvm.testing.device_enabled("cuda"):
+        pytest.skip("cuda not enabled")
+
+    def run_and_check():
+        _check("cuda", tvm.cuda())
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
+def test_lora_adapter_pool_eviction():
+    dev = tvm.cpu()
+    pool = tvm.get_global_func("vm.builtin.lora_adapter_pool_create")(
+        2, NUM_SLOTS, [Shape([RANK, HIDDEN_SIZE])], tvm.runtime.tensor(np.zeros((), "float32"))
+    )
+    f_load = tvm.get_global_func("vm.builtin.lora_adapter_pool_load")
+    f_has_adapter = tvm.get_global_func("vm.builtin.lora_adapter_pool_has_adapter")
+    f_begin_forward = tvm.get_global_func("vm.builtin.lora_adapter_pool_begin_forward")
+
+    def weights(value):
+        return [tvm.runtime.tensor(np.full((RANK, HIDDEN_SIZE), value, "float32"), dev)] * 2
+
+    f_load(pool, 0, weights(0))
+    f_load(pool, 1, weights(1))
+    f_begin_forward(pool, Shape([0]), Shape([1]))
+    # Adapter 1 is the least recently used one and not in the current batch.
+    f_load(pool, 2, weights(2))
+    assert f_has_adapter(pool, 0) and not f_has_adapter(pool, 1) and f_has_adapter(pool, 2)
+    storage = tvm.get_global_func("vm.builtin.lora_adapter_pool_get_weight")(pool, 1, 0).numpy()
+    assert np.all(storage[0] == 0) and np.all(storage[1] == 2)
+
+    f_begin_forward(pool, Shape([0, 2]), Shape([1, 1]))
+    with pytest.raises(RuntimeError):
+        f_load(pool, 3, weights(3))
+    tvm.get_global_func("vm.builtin.lora_adapter_pool_unload")(pool, 0)
+    assert tvm.get_global_func("vm.builtin.lora_adapter_pool_num_free_slots")(pool) == 1
+    with pytest.raises(ValueError):
+        f_begin_forward(pool, Shape([0]), Shape([1]))
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
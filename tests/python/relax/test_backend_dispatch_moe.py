@@ -0,0 +1,108 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-docstring
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.relax.backend import DispatchMoE
+from tvm.script import ir as I
+from tvm.script import relax as R
+
+NUM_TOKENS, HIDDEN_SIZE, INTER_SIZE, NUM_EXPERTS, TOP_K = 13, 24, 40, 6, 2
+
+
+def _get_mod(capacity: int):
+    @I.ir_module
+    class Module:
+        @R.function
+        def main(
+            x: R.Tensor((NUM_TOKENS, HIDDEN_SIZE), "float32"),
+            logits: R.Tensor((NUM_TOKENS, NUM_EXPERTS), "float32"),
+            w: R.Tensor((NUM_EXPERTS, INTER_SIZE, HIDDEN_SIZE), "float32"),
+        ):
+            with R.dataflow():
+                gating = R.moe.topk_gating(logits, TOP_K)
+                permuted = R.moe.permute(x, gating[1], NUM_EXPERTS, capacity=capacity)
+                y = R.moe.group_matmul(permuted[0], w, permuted[1])
+                gv = R.moe.unpermute(y, permuted[2], gating[0])
+                R.output(gv)
+            return gv
+
+    return Module
+
+
+def _reference(x, logits, w, capacity):
+    prob = np.exp(logits - logits.max(axis=1, keepdims=True))
+    prob = prob / prob.sum(axis=1, keepdims=True)
+    out = np.zeros((NUM_TOKENS, INTER_SIZE), "float32")
+    counts = [0] * NUM_EXPERTS
+    slots = []
+    for t in range(NUM_TOKENS):
+        # Stable order of the experts: descending logits, then ascending indices.
+        experts = sorted(range(NUM_EXPERTS), key=lambda e: (-logits[t, e], e))[:TOP_K]
+        weights = prob[t, experts] / prob[t, experts].sum()
+        slots.append(list(zip(experts, weights)))
+    for t in range(NUM_TOKENS):
+        for e, weight in slots[t]:
+            rank = counts[e]
+            counts[e] += 1
+            if capacity == 0 or rank < capacity:
+                out[t] += weight * (w[e] @ x[t])
+    return out
+
+
+def _check(target, dev, capacity):
+    np.random.seed(0)
+    x = np.random.uniform(-1, 1, (NUM_TOKENS, HIDDEN_SIZE)).astype("float32")
+    logits = np.random.uniform(-1, 1, (NUM_TOKENS, NUM_EXPERTS)).astype("float32")
+    w = np.random.uniform(-1, 1, (NUM_EXPERTS, INTER_SIZE, HIDDEN_SIZE)).astype("float32")
+    with tvm.target.Target(target):
+        mod = DispatchMoE()(_get_mod(capacity))
+        assert not any(
+            isinstance(func, relax.Function) and "relax.moe." in func.script()
+            for func in mod.functions.values()
+        )
+        ex = tvm.compile(mod, target)
+    vm = relax.VirtualMachine(ex, dev)
+    out = vm["main"](*[tvm.runtime.tensor(a, dev) for a in (x, logits, w)])
+    tvm.testing.assert_allclose(
+        out.numpy(), _reference(x, logits, w, capacity), rtol=1e-5, atol=1e-5
+    )
+
+
+@pytest.mark.parametrize("capacity", [0, 3])
+def test_dispatch_moe_cpu(capacity):
+    _check("llvm", tvm.cpu(), capacity)
+
+
+@pytest.mark.gpu
+@pytest.mark.parametrize("capacity", [0, 3])
+def test_dispatch_moe_cuda(capacity):
+    if not tvm.testing.device_enabled("cuda"):
+        pytest.skip("cuda not enabled")
+
+    def run_and_check():
+        _check("cuda", tvm.cuda(), capacity)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
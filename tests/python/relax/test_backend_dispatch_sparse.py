@@ -0,0 +1,149 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# pylint: disable=missing-docstring
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.relax.backend import DispatchSparse
+from tvm.script import ir as I
+from tvm.script import relax as R
+from tvm.testing import env
+
+OUT_FEATURES, IN_FEATURES = 32, 64
+
+
+def _get_mod(dtype):
+    @I.ir_module
+    class Module:
+        @R.function
+        def compress(w: R.Tensor((OUT_FEATURES, IN_FEATURES), dtype)):
+            with R.dataflow():
+                gv = R.sparse.compress_2_4(w)
+                R.output(gv)
+            return gv
+
+        @R.function
+        def main(
+            x: R.Tensor((2, "n", IN_FEATURES), dtype),
+            values: R.Tensor((OUT_FEATURES, IN_FEATURES // 2), dtype),
+            metadata: R.Tensor((OUT_FEATURES // 16, IN_FEATURES // 16, 8), "uint32"),
+        ):
+            with R.dataflow():
+                gv = R.sparse.matmul_2_4(x, values, metadata)
+                R.output(gv)
+            return gv
+
+    return Module
+
+
+def _random_2_4_weight(dtype):
+    w = np.random.uniform(-1, 1, (OUT_FEATURES, IN_FEATURES // 4, 4)).astype(dtype)
+    for n in range(OUT_FEATURES):
+        for g in range(IN_FEATURES // 4):
+            # Some groups keep a single nonzero, the others two.
+            num_pruned = 3 if (n + g) % 5 == 0 else 2
+            w[n, g, np.random.choice(4, num_pruned, replace=False)] = 0
+    return w.reshape(OUT_FEATURES, IN_FEATURES)
+
+
+def _reference_metadata(w):
+    """The metadata of the mma.sp m16n8k16 layout, from the positions of the kept values."""
+    positions = np.zeros((OUT_FEATURES, IN_FEATURES // 2), "uint32")
+    for n in range(OUT_FEATURES):
+        for g in range(IN_FEATURES // 4):
+            nonzeros = list(np.nonzero(w[n, g * 4 : g * 4 + 4])[0])
+            if len(nonzeros) == 1:
+                p = nonzeros[0]
+                nonzeros = [2, 3] if p == 3 else [p, p + 1]
+            positions[n, g * 2 : g * 2 + 2] = nonzeros
+    metadata = np.zeros((OUT_FEATURES // 16, IN_FEATURES // 16, 8), "uint32")
+    for i in range(OUT_FEATURES // 16):
+        for j in range(IN_FEATURES // 16):
+            for g in range(8):
+                for half in range(2):
+                    for c in range(8):
+                        position = positions[i * 16 + half * 8 + g, j * 8 + c]
+                        metadata[i, j, g] |= position << (half * 16 + c * 2)
+    return metadata
+
+
+def _check(target, dev, dtype, atol):
+    np.random.seed(0)
+    w = _random_2_4_weight(dtype)
+    x = np.random.uniform(-1, 1, (2, 5, IN_FEATURES)).astype(dtype)
+    with tvm.target.Target(target):
+        mod = DispatchSparse()(_get_mod(dtype))
+        assert not any(
+            isinstance(func, relax.Function) and "relax.sparse." in func.script()
+            for func in mod.functions.values()
+        )
+        ex = tvm.compile(mod, target)
+    vm = relax.VirtualMachine(ex, dev)
+
+    values, metadata = vm["compress"](tvm.runtime.tensor(w, dev))
+    np.testing.assert_equal(metadata.numpy(), _reference_metadata(w))
+    out = vm["main"](tvm.runtime.tensor(x, dev), values, metadata)
+    expected = x.astype("float32") @ w.astype("float32").T
+    tvm.testing.assert_allclose(out.numpy().astype("float32"), expected, rtol=atol, atol=atol)
+
+
+def test_dispatch_sparse_cpu():
+    _check("llvm", tvm.cpu(), "float32", 1e-5)
+
+
+def test_compress_sparse_weights_end_to_end():
+    np.random.seed(0)
+    w = _random_2_4_weight("float32")
+    x = np.random.uniform(-1, 1, (3, IN_FEATURES)).astype("float32")
+
+    @I.ir_module
+    class Module:
+        @R.function
+        def main(
+            x: R.Tensor(("n", IN_FEATURES), "float32"),
+            w: R.Tensor((OUT_FEATURES, IN_FEATURES), "float32"),
+        ):
+            R.func_attr({"num_input": 1, "sparse_2_4_params": ["w"]})
+            with R.dataflow():
+                gv = R.matmul(x, R.permute_dims(w, [1, 0]))
+                R.output(gv)
+            return gv
+
+    mod = relax.transform.CompressSparseWeights()(Module)
+    mod = relax.transform.LiftTransformParams()(mod)
+    ex = tvm.compile(mod, "llvm")
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    params = vm["main_transform_params"]([tvm.runtime.tensor(w)])
+    out = vm["main"](tvm.runtime.tensor(x), *params)
+    tvm.testing.assert_allclose(out.numpy(), x @ w.T, rtol=1e-5, atol=1e-5)
+
+
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda_compute(8), reason="need cuda compute >= 8.0")
+def test_dispatch_sparse_cuda_mma_sp():
+    def run_and_check():
+        dev = tvm.cuda()
+        _check(tvm.target.Target.from_device(dev), dev, "float16", 1e-2)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
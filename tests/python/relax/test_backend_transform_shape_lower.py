@@ -16,6 +16,8 @@
 # under the License.
 # ruff: noqa: F841
 
+import numpy as np
+
 import tvm.script
 import tvm.testing
 from tvm import relax
@@ -815,5 +817,33 @@ def test_check_weights_with_dynamic_shape():
     assert_structural_equal(after, expected)
 
 
+def test_cached_shape_heap():
+    @I.ir_module
+    class Before:
+        @R.function
+        def main(x: R.Tensor(["n"], "float32")) -> R.Shape(ndim=1):
+            R.func_attr({"relax.force_pure": True})
+            n = T.int64()
+            return R.shape([n * 2 + 1])
+
+    with tvm.transform.PassContext(config={"relax.backend.cache_shape_heap": True}):
+        after = relax.transform.VMShapeLower(emit_err_ctx=False)(Before)
+    # slot assignment: 0: n, 1: n * 2 + 1, then the saved n at 2 + 0 and the valid flag at 4
+    alloc = after["main"].body.blocks[0].bindings[0].value
+    assert alloc.args[0].global_symbol == "vm.builtin.alloc_cached_shape_heap"
+    heap_size, func_name = alloc.args[1].fields
+    assert heap_size.value.value == 5 and func_name.value == "main"
+    shape_func = after["shape_func"]
+    assert isinstance(shape_func.body, tvm.tirx.IfThenElse)
+
+    with tvm.transform.PassContext(config={"relax.backend.cache_shape_heap": True}):
+        ex = tvm.compile(Before, "llvm")
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    # The shape is recomputed whenever n changes, and reused otherwise.
+    for n in [3, 3, 5, 3]:
+        x = tvm.runtime.tensor(np.zeros(n, "float32"))
+        assert list(vm["main"](x)) == [n * 2 + 1]
+
+
 if __name__ == "__main__":
     tvm.testing.main()
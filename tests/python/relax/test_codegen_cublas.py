@@ -510,12 +510,19 @@ def test_cublas_partition_fp8_matmul_multiply():
     assert len(mod["main"].body.blocks[0].bindings) == 1
 
 
-def test_cublas_partition_matmul_without_bias():
-    # cuBLAS does not handle 2D bias (residual input)
+def test_cublas_partition_matmul_residual():
+    # A 2D bias is not a bias vector, but is fused as the residual input
     mod = get_relax_matmul_module((16, 32), (32, 32), "float16", "float16", bias_shape=(16, 32))
     mod = partition_for_cublas(mod)
+    assert len(mod["main"].body.blocks[0].bindings) == 1
+    assert "fused_relax_matmul_relax_add_cublas" in mod["main"].script()
 
-    # R.add is still in the main function
+    # The residual input must have the shape of the output
+    mod = get_relax_matmul_module((16, 32), (32, 32), "float16", "float16", bias_shape=(1, 32))
+    mod = partition_for_cublas(mod)
+    assert "fused_relax_matmul_relax_add_cublas" in mod["main"].script()
+    mod = get_relax_matmul_module((16, 32), (32, 32), "float16", "float16", bias_shape=(2, 16, 32))
+    mod = partition_for_cublas(mod)
     assert len(mod["main"].body.blocks[0].bindings) == 2
 
 
@@ -570,5 +577,111 @@ def test_cublas_matmul_cuda_graph():
     tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
 
 
+@pytest.mark.parametrize(
+    "x_shape, y_shape, transpose_y, with_bias",
+    [
+        ((32, 8), (8, 16), False, False),
+        ((32, 8), (8, 16), True, True),
+        ((4, 32, 8), (4, 8, 16), False, True),
+        ((4, 32, 8), (8, 16), True, False),
+    ],
+)
+def test_matmul_residual_offload(x_shape, y_shape, transpose_y, with_bias):
+    dtype = "float16"
+    x = np.random.randn(*x_shape).astype(dtype)
+    y = np.random.randn(*y_shape).astype(dtype)
+    out_shape = (*x_shape[:-1], y_shape[-1])
+    residual = np.random.randn(*out_shape).astype(dtype)
+    bias = np.random.randn(y_shape[-1]).astype(dtype)
+    if transpose_y:
+        y = np.swapaxes(y, -2, -1)
+
+    with IRBuilder() as builder:
+        with relax_builder.function():
+            R.func_name("main")
+            lhs = R.arg("x", R.Tensor(x.shape, dtype))
+            rhs = R.arg("y", R.Tensor(y.shape, dtype))
+            res = R.arg("residual", R.Tensor(residual.shape, dtype))
+            if with_bias:
+                bias_arg = R.arg("bias", R.Tensor(bias.shape, dtype))
+            with R.dataflow() as frame:
+                if transpose_y:
+                    axes = list(range(len(y.shape) - 2)) + [-1, -2]
+                    rhs = R.emit(R.permute_dims(rhs, axes=axes))
+                result = R.emit(R.matmul(lhs, rhs))
+                if with_bias:
+                    result = R.emit(result + bias_arg)
+                result = R.emit(result + res)
+                R.output(result)
+            R.func_ret_value(frame.output_vars[0])
+    mod = tvm.IRModule({"main": builder.get()})
+
+    args = (x, y, residual, bias) if with_bias else (x, y, residual)
+    assert len(partition_for_cublas(mod)["main"].body.blocks[0].bindings) == 1
+    out = get_result_with_relax_cublas_offload(mod, args)
+    ref = build_and_run(mod, args, "llvm", legalize=True)
+
+    tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+
+
+@pytest.mark.parametrize("transpose_y, with_bias", [(False, False), (True, True)])
+def test_matmul_channel_scale_offload(transpose_y, with_bias):
+    in_dtype, out_dtype = "float16", "float32"
+    x = np.random.randn(32, 64).astype(in_dtype)
+    y = np.random.randn(64, 48).astype(in_dtype)
+    scale = np.random.uniform(0.5, 2, size=(48,)).astype(out_dtype)
+    bias = np.random.randn(48).astype(out_dtype)
+    if transpose_y:
+        y = np.swapaxes(y, -2, -1)
+
+    with IRBuilder() as builder:
+        with relax_builder.function():
+            R.func_name("main")
+            lhs = R.arg("x", R.Tensor(x.shape, in_dtype))
+            rhs = R.arg("y", R.Tensor(y.shape, in_dtype))
+            scale_arg = R.arg("scale", R.Tensor(scale.shape, out_dtype))
+            if with_bias:
+                bias_arg = R.arg("bias", R.Tensor(bias.shape, out_dtype))
+            with R.dataflow() as frame:
+                if transpose_y:
+                    rhs = R.emit(R.permute_dims(rhs))
+                result = R.emit(R.matmul(lhs, rhs, out_dtype=out_dtype))
+                result = R.emit(result * scale_arg)
+                if with_bias:
+                    result = R.emit(result + bias_arg)
+                R.output(result)
+            R.func_ret_value(frame.output_vars[0])
+    mod = tvm.IRModule({"main": builder.get()})
+
+    args = (x, y, scale, bias) if with_bias else (x, y, scale)
+    assert len(partition_for_cublas(mod)["main"].body.blocks[0].bindings) == 1
+    out = get_result_with_relax_cublas_offload(mod, args)
+    ref = build_and_run(mod, args, "llvm", legalize=True)
+
+    tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+
+
+def test_matmul_algo_cache(tmp_path):
+    cache_file = tmp_path / "cublaslt_algos.txt"
+    set_algo_cache = tvm.get_global_func("runtime.cublaslt.SetAlgoCache")
+    x = np.random.randn(32, 256).astype("float16")
+    y = np.random.randn(256, 128).astype("float16")
+    mod = get_relax_matmul_module((32, 256), (256, 128), "float16", "float16")
+    ref = build_and_run(mod, (x, y), "llvm", legalize=True)
+    try:
+        set_algo_cache(str(cache_file), 4)
+        out = get_result_with_relax_cublas_offload(mod, (x, y))
+        tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+        entries = cache_file.read_text().splitlines()
+        assert len(entries) == 1
+        # A new process reads the tuned algorithm back instead of tuning again.
+        set_algo_cache(str(cache_file), 4)
+        out = get_result_with_relax_cublas_offload(mod, (x, y))
+        tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+        assert cache_file.read_text().splitlines() == entries
+    finally:
+        set_algo_cache("", 0)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -462,6 +462,45 @@ def test_matmul_with_3d_bias_offload():
     tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
 
 
+def test_matmul_silu_gating_offload():
+    dtype = "float16"
+    x = np.random.randn(32, 64).astype(dtype)
+    w_gate = (np.random.randn(128, 64) / 8).astype(dtype)
+    w_up = (np.random.randn(128, 64) / 8).astype(dtype)
+    args = (x, w_gate, w_up)
+
+    @tvm.script.ir_module
+    class Mod:
+        @R.function
+        def main(
+            x: R.Tensor((32, 64), "float16"),
+            w_gate: R.Tensor((128, 64), "float16"),
+            w_up: R.Tensor((128, 64), "float16"),
+        ):
+            with R.dataflow():
+                gate = R.matmul(x, R.permute_dims(w_gate))
+                up = R.matmul(x, R.permute_dims(w_up))
+                gv = R.nn.silu(gate) * up
+                R.output(gv)
+            return gv
+
+    # The gate matmul is fused with SiLU and the multiply, the up matmul is offloaded alone.
+    composites = [
+        func.attrs["Composite"]
+        for func in partition_for_cutlass(Mod, annotate_codegen=False).functions.values()
+        if "Composite" in func.attrs
+    ]
+    assert sorted(composites) == [
+        "cutlass.matmul_transposed",
+        "cutlass.matmul_transposed_silu_residual_multiply",
+    ]
+
+    out = get_result_with_relax_cutlass_offload(Mod, *args, num_final_bindings=2)
+    ref = build_and_run(Mod, args, "llvm", legalize=True)
+
+    tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+
+
 @pytest.mark.parametrize(
     "x_shape, y_shape, expected",
     [
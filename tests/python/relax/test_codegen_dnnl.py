@@ -21,7 +21,7 @@ import tvm
 import tvm.testing
 from tvm import relax
 from tvm.contrib.pickle_memoize import memoize
-from tvm.relax.dpl import make_fused_bias_activation_pattern
+from tvm.relax.dpl import is_op, make_fused_bias_activation_pattern, wildcard
 from tvm.script import relax as R
 
 
@@ -41,6 +41,23 @@ class Conv2dReLUx2:
         return conv2
 
 
+@tvm.script.ir_module
+class Conv2dBiasReLUResidual:
+    @R.function
+    def main(
+        data: R.Tensor((1, 64, 56, 56), "float32"),
+        weight: R.Tensor((64, 64, 3, 3), "float32"),
+        bias: R.Tensor((1, 64, 1, 1), "float32"),
+        residual: R.Tensor((1, 64, 56, 56), "float32"),
+    ):
+        with R.dataflow():
+            conv = relax.op.nn.conv2d(data, weight, padding=(1, 1))
+            out = relax.op.add(relax.op.nn.relu(relax.op.add(conv, bias)), residual)
+            R.output(out)
+
+        return out
+
+
 has_dnnl = tvm.get_global_func("relax.ext.dnnl", True)
 
 dnnl_enabled = pytest.mark.skipif(
@@ -92,5 +109,31 @@ def test_dnnl_offload():
     tvm.testing.assert_allclose(out, ref, rtol=1e-3, atol=1e-3)
 
 
+def test_dnnl_offload_binary_post_op():
+    conv = is_op("relax.nn.conv2d")(wildcard(), wildcard())
+    out = is_op("relax.nn.relu")(is_op("relax.add")(conv, wildcard()))
+    pat = is_op("relax.add")(out, wildcard())
+
+    seq = tvm.transform.Sequential(
+        [
+            relax.transform.FuseOpsByPattern([("dnnl.conv2d_bias_relu_add", pat)]),
+            relax.transform.MergeCompositeFunctions(),
+            relax.transform.RunCodegen(),
+        ]
+    )
+
+    data_np = np.random.randn(1, 64, 56, 56).astype("float32")
+    weight_np = np.random.randn(64, 64, 3, 3).astype("float32")
+    bias_np = np.random.randn(1, 64, 1, 1).astype("float32")
+    residual_np = np.random.randn(1, 64, 56, 56).astype("float32")
+    inputs = [data_np, weight_np, bias_np, residual_np]
+    ref = build_and_run(Conv2dBiasReLUResidual, inputs, legalize=True)
+
+    out = build_and_run(seq(Conv2dBiasReLUResidual), inputs)
+
+    tvm.testing.assert_allclose(out, ref, rtol=1e-3, atol=1e-3)
+
+
 if __name__ == "__main__":
     test_dnnl_offload()
+    test_dnnl_offload_binary_post_op()
@@ -354,6 +354,50 @@ def test_tensorrt_int8_calibration(monkeypatch):
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+def test_tensorrt_profile_batch_sizes_and_engine_cache(monkeypatch, tmp_path):
+    # A dynamic-batch engine built with one optimization profile per batch size bucket serves all
+    # the batch sizes up to the largest bucket, and is cached on disk under its profile hash.
+    @tvm.script.ir_module
+    class Conv2dDynamicBatch:
+        @R.function
+        def main(
+            data: R.Tensor(("n", 8, 16, 16), "float32"), weight: R.Tensor((4, 8, 3, 3), "float32")
+        ):
+            with R.dataflow():
+                out = relax.op.nn.conv2d(data, weight, padding=1)
+                R.output(out)
+            return out
+
+    weight = np.random.randn(4, 8, 3, 3).astype("float32")
+    patterns = [("tensorrt.nn.conv2d", is_op("relax.nn.conv2d")(wildcard(), wildcard()))]
+    offloaded = tvm.transform.Sequential(
+        [
+            relax.transform.BindParams("main", {"weight": weight}),
+            relax.transform.FuseOpsByPattern(patterns),
+            relax.transform.MergeCompositeFunctions(),
+            relax.transform.RunCodegen(),
+        ]
+    )(Conv2dDynamicBatch)
+
+    monkeypatch.setenv("TVM_TENSORRT_PROFILE_BATCH_SIZES", "2,8")
+    monkeypatch.setenv("TVM_TENSORRT_CACHE_DIR", str(tmp_path))
+
+    ex = tvm.compile(offloaded, "cuda")
+
+    def run_and_check():
+        dev = tvm.cuda(0)
+        vm = relax.VirtualMachine(ex, dev)
+        for batch_size in [1, 8, 5]:
+            data = np.random.randn(batch_size, 8, 16, 16).astype("float32")
+            ref = build_and_run(Conv2dDynamicBatch, [data, weight], "llvm", legalize=True)
+            out = vm["main"](tvm.runtime.tensor(data, dev)).numpy()
+            tvm.testing.assert_allclose(out, ref, rtol=1e-2, atol=1e-2)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+    assert len(list(tmp_path.glob("*.plan"))) == 1
+    assert len(list(tmp_path.glob("*.meta"))) == 1
+
+
 def test_tensorrt_matmul():
     # Regression test: Relax matmul has no transpose_a/transpose_b attrs (Relay's batch_matmul did).
     @tvm.script.ir_module
@@ -646,6 +646,49 @@ def test_dynamic_mismatch():
     tvm.ir.assert_structural_equal(new_mod, DynamicMistmatchTestCase)
 
 
+def test_call_tir_inplace_from_access_pattern():
+    @I.ir_module(s_tir=True)
+    class Legalized:
+        @T.prim_func(private=True, s_tir=True)
+        def relu(A: T.Buffer((2, 3), "float32"), B: T.Buffer((2, 3), "float32")):
+            for i, j in T.grid(2, 3):
+                with T.sblock("relu"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.max(A[vi, vj], T.float32(0))
+
+        @T.prim_func(private=True, s_tir=True)
+        def shift(A: T.Buffer((2, 3), "float32"), B: T.Buffer((2, 3), "float32")):
+            for i, j in T.grid(2, 3):
+                with T.sblock("shift"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[(vi + 1) % 2, vj]
+
+        @R.function
+        def main(x: R.Tensor((2, 3), "float32")) -> R.Tensor((2, 3), "float32"):
+            cls = Legalized
+            with R.dataflow():
+                y = R.call_tir(cls.shift, (x,), out_ty=R.Tensor((2, 3), "float32"))
+                z = R.call_tir(cls.relu, (y,), out_ty=R.Tensor((2, 3), "float32"))
+                # Reads other elements than the one it writes, so it needs its own output
+                w = R.call_tir(cls.shift, (z,), out_ty=R.Tensor((2, 3), "float32"))
+                R.output(w)
+            return w
+
+    new_mod = DataflowUseInplaceCalls()(Legalized)
+    bindings = new_mod["main"].body.blocks[0].bindings
+    ops = [binding.value.op.name for binding in bindings]
+    assert ops == ["relax.call_tir", "relax.call_tir_inplace", "relax.call_tir"]
+    assert list(bindings[1].value.attrs.inplace_indices) == [0]
+    # The original PrimFunc is left in the module, as other calls may use it.
+    assert "relu" in [gv.name_hint for gv in new_mod.get_global_vars()]
+
+    x = np.random.rand(2, 3).astype("float32") - 0.5
+    ex = tvm.compile(new_mod, "llvm")
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    res = vm["main"](tvm.runtime.tensor(x))
+    np.testing.assert_allclose(res.numpy(), np.maximum(x, 0))
+
+
 class TestViewOpSharedStorageAndNoInplace:
     storage_ptr_x_1d = np.array([1.0, 2.0, 3.0, 4.0], dtype=np.float32)
     storage_ptr_x_2d = np.array([[1.0, 2.0, 3.0, 4.0]], dtype=np.float32)
@@ -993,6 +993,151 @@ def test_multinomial_from_uniform():
     )
 
 
+def _philox4x32_10_ref(counter, key):
+    mask = 0xFFFFFFFF
+    c, k = list(counter), list(key)
+    for _ in range(10):
+        prod0, prod1 = 0xD2511F53 * c[0], 0xCD9E8D57 * c[2]
+        c = [(prod1 >> 32) ^ c[1] ^ k[0], prod1 & mask, (prod0 >> 32) ^ c[3] ^ k[1], prod0 & mask]
+        k = [(k[0] + 0x9E3779B9) & mask, (k[1] + 0xBB67AE85) & mask]
+    return c
+
+
+def _philox_uniform_ref(seed, offset, numel):
+    words = []
+    for block in range((numel + 3) // 4):
+        counter = offset + block
+        words += _philox4x32_10_ref(
+            [counter & 0xFFFFFFFF, counter >> 32, 0, 0], [seed & 0xFFFFFFFF, seed >> 32]
+        )
+    return (np.array(words[:numel], dtype=np.uint64) >> 8).astype(np.float32) * np.float32(2**-24)
+
+
+def test_philox_random():
+    # The known answer of the Random123 test vectors for a zero counter and key.
+    assert _philox4x32_10_ref([0, 0, 0, 0], [0, 0]) == [
+        0x6627E8D5,
+        0xE169C58D,
+        0xBC57AC4C,
+        0x9B00DBD8,
+    ]
+
+    class Model(Module):
+        def foo(self, x: Tensor, state: Tensor):
+            uniform = op.philox_uniform(state, (5, 7))
+            out, mask = op.philox_dropout(x, state, rate=0.25)
+            return uniform, out, mask
+
+    m = Model()
+    mod, _ = m.export_tvm(
+        spec={
+            "foo": {"x": spec.Tensor((5, 7), "float32"), "state": spec.Tensor((2,), "uint64")}
+        }
+    )
+    ex = tvm.compile(mod, "llvm")
+    dev = tvm.cpu()
+    vm = relax.VirtualMachine(ex, dev)
+
+    seed, offset = 0x0123456789ABCDEF, (1 << 32) - 3
+    np_x = np.random.rand(5, 7).astype(np.float32)
+    np_state = np.array([seed, offset], dtype=np.uint64)
+    uniform, out, mask = vm["foo"](tvm.runtime.tensor(np_x), tvm.runtime.tensor(np_state))
+
+    expected_uniform = _philox_uniform_ref(seed, offset, 35).reshape(5, 7)
+    np.testing.assert_array_equal(uniform.numpy(), expected_uniform)
+    expected_mask = (expected_uniform >= 0.25).astype(np.float32)
+    np.testing.assert_array_equal(mask.numpy(), expected_mask)
+    tvm.testing.assert_allclose(out.numpy(), np_x * expected_mask / 0.75, rtol=1e-6)
+
+
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
+def test_fused_sample_from_logits():
+    batch, vocab_size, num_penalty_tokens = 4, 1000, 2
+
+    class Model(Module):
+        def foo(
+            self,
+            logits: Tensor,
+            penalty_token_ids: Tensor,
+            penalty_token_freqs: Tensor,
+            repetition_penalty: Tensor,
+            presence_penalty: Tensor,
+            frequency_penalty: Tensor,
+            temperature: Tensor,
+            top_p: Tensor,
+            top_k: Tensor,
+            min_p: Tensor,
+            uniform_sample: Tensor,
+        ):
+            return op.fused_sample_from_logits(
+                logits,
+                penalty_token_ids,
+                penalty_token_freqs,
+                repetition_penalty,
+                presence_penalty,
+                frequency_penalty,
+                temperature,
+                top_p,
+                top_k,
+                min_p,
+                uniform_sample,
+            )
+
+    row_spec = spec.Tensor((batch, 1), "float32")
+    m = Model()
+    mod, _ = m.export_tvm(
+        spec={
+            "foo": {
+                "logits": spec.Tensor((batch, vocab_size), "float32"),
+                "penalty_token_ids": spec.Tensor((batch, num_penalty_tokens), "int32"),
+                "penalty_token_freqs": spec.Tensor((batch, num_penalty_tokens), "int32"),
+                "repetition_penalty": row_spec,
+                "presence_penalty": row_spec,
+                "frequency_penalty": row_spec,
+                "temperature": row_spec,
+                "top_p": row_spec,
+                "top_k": spec.Tensor((batch, 1), "int32"),
+                "min_p": row_spec,
+                "uniform_sample": row_spec,
+            }
+        },
+    )
+
+    target = tvm.target.Target("cuda", host="llvm")
+    ex = tvm.compile(mod, target)
+    dev = tvm.cuda(0)
+    vm = relax.VirtualMachine(ex, dev)
+
+    np_logits = np.random.uniform(-5, 5, size=(batch, vocab_size)).astype("float32")
+    order = np.argsort(-np_logits, axis=1)
+    np_token_ids = np.full((batch, num_penalty_tokens), -1, dtype="int32")
+    np_presence_penalty = np.zeros((batch, 1), dtype="float32")
+    # Row 3 penalizes its argmax away.
+    np_token_ids[3, 0] = order[3, 0]
+    np_presence_penalty[3, 0] = 1e4
+
+    def row_values(values, dtype="float32"):
+        return tvm.runtime.tensor(np.array(values, dtype=dtype).reshape(batch, 1), dev)
+
+    # Row 0 and 3 are greedy, row 1 keeps the top 1 and row 2 keeps the smallest top-p.
+    res = vm["foo"](
+        tvm.runtime.tensor(np_logits, dev),
+        tvm.runtime.tensor(np_token_ids, dev),
+        tvm.runtime.tensor(np.ones((batch, num_penalty_tokens), dtype="int32"), dev),
+        row_values([1, 1, 1, 1]),
+        tvm.runtime.tensor(np_presence_penalty, dev),
+        row_values([0, 0, 0, 0]),
+        row_values([0, 1, 1, 0]),
+        row_values([1, 1, 1e-4, 1]),
+        row_values([0, 1, 0, 0], "int32"),
+        row_values([0, 0, 0, 0]),
+        row_values([0.5, 0.9, 0.9, 0.5]),
+    )
+    expected = [order[0, 0], order[1, 0], order[2, 0], order[3, 1]]
+    tvm.testing.assert_allclose(res.numpy(), np.array(expected).reshape(batch, 1))
+
+
 @pytest.mark.gpu
 @pytest.mark.skipif(not env.has_gpu(), reason="need gpu")
 def test_sample_top_p_top_k_from_sorted_prob():
@@ -102,5 +102,91 @@ def test_track_usage_across_trivial_rebindings_in_match_cast():
     tvm.ir.assert_structural_equal(Expected, After)
 
 
+def test_kill_in_each_branch():
+    """Tensors live into an If die in each branch, at their last use or at entry"""
+
+    @I.ir_module
+    class Before:
+        @R.function(pure=False)
+        def main(cond: R.Prim("bool"), w: R.Tensor([16], "float32")):
+            x = R.add(w, R.const(1, "float32"))
+            y = R.add(w, R.const(2, "float32"))
+            if cond:
+                z = R.multiply(x, y)
+                out = R.add(z, R.const(1, "float32"))
+            else:
+                out = R.add(x, R.const(1, "float32"))
+            return out
+
+    @I.ir_module
+    class Expected:
+        @R.function(pure=False)
+        def main(cond: R.Prim("bool"), w: R.Tensor([16], "float32")):
+            x = R.add(w, R.const(1, "float32"))
+            y = R.add(w, R.const(2, "float32"))
+            if cond:
+                z = R.multiply(x, y)
+                _ = R.memory.kill_tensor(x)
+                _ = R.memory.kill_tensor(y)
+                out = R.add(z, R.const(1, "float32"))
+                _ = R.memory.kill_tensor(z)
+            else:
+                _ = R.memory.kill_tensor(y)
+                out = R.add(x, R.const(1, "float32"))
+                _ = R.memory.kill_tensor(x)
+            return out
+
+    After = KillAfterLastUse()(Before)
+    tvm.ir.assert_structural_equal(Expected, After)
+
+
+def test_kill_closure_after_last_invocation():
+    """The captured tensors are released with the closure, after its last invocation"""
+
+    @I.ir_module
+    class Before:
+        @R.function
+        def add_captured(
+            x: R.Tensor([16], "float32"), y: R.Tensor([16], "float32")
+        ) -> R.Tensor([16], "float32"):
+            z = R.add(x, y)
+            return z
+
+        @R.function(pure=False)
+        def main(cond: R.Prim("bool"), w: R.Tensor([16], "float32")):
+            x = R.add(w, R.const(1, "float32"))
+            clo = R.make_closure(Before.add_captured, (x,))
+            if cond:
+                out = R.invoke_closure(clo, (w,), ty_args=R.Tensor([16], "float32"))
+            else:
+                out = R.add(w, R.const(1, "float32"))
+            return out
+
+    @I.ir_module
+    class Expected:
+        @R.function
+        def add_captured(
+            x: R.Tensor([16], "float32"), y: R.Tensor([16], "float32")
+        ) -> R.Tensor([16], "float32"):
+            z = R.add(x, y)
+            return z
+
+        @R.function(pure=False)
+        def main(cond: R.Prim("bool"), w: R.Tensor([16], "float32")):
+            x = R.add(w, R.const(1, "float32"))
+            clo = R.make_closure(Expected.add_captured, (x,))
+            _ = R.memory.kill_tensor(x)
+            if cond:
+                out = R.invoke_closure(clo, (w,), ty_args=R.Tensor([16], "float32"))
+                _ = R.vm.kill_object(clo)
+            else:
+                _ = R.vm.kill_object(clo)
+                out = R.add(w, R.const(1, "float32"))
+            return out
+
+    After = KillAfterLastUse()(Before)
+    tvm.ir.assert_structural_equal(Expected, After)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -29,6 +29,8 @@ def test_op_correctness():
     assert relax.op.ccl.allreduce(x).op == Op.get("relax.ccl.allreduce")
     assert relax.op.ccl.broadcast_from_worker0(x).op == Op.get("relax.ccl.broadcast_from_worker0")
     assert relax.op.ccl.allgather(x, 2).op == Op.get("relax.ccl.allgather")
+    assert relax.op.ccl.alltoall(x, 2).op == Op.get("relax.ccl.alltoall")
+    assert relax.op.ccl.reducescatter(x, "sum", 2).op == Op.get("relax.ccl.reducescatter")
 
 
 def _check_inference(bb: relax.BlockBuilder, call: relax.Call, expected_ty: relax.Type):
@@ -136,6 +138,42 @@ def test_allgather_infer_ty_more_input_dtype():
     _check_inference(bb, relax.op.ccl.allgather(x2, 2), relax.TensorType((4, 3), "int64"))
 
 
+def test_alltoall_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    x0 = relax.Var("x", R.Tensor((4, 3), "float32"))
+    x1 = relax.Var("x", R.Tensor((n, 3), "float16"))
+    x2 = relax.Var("x", R.Tensor("float32", ndim=2))
+    x3 = relax.Var("x", R.Tensor((3, 4), "float32"))
+
+    _check_inference(bb, relax.op.ccl.alltoall(x0, 2), relax.TensorType((4, 3), "float32"))
+    _check_inference(bb, relax.op.ccl.alltoall(x1, 2), relax.TensorType((n, 3), "float16"))
+    _check_inference(bb, relax.op.ccl.alltoall(x2, 2), relax.TensorType(dtype="float32", ndim=2))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.ccl.alltoall(x3, 2))
+
+
+def test_reducescatter_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    x0 = relax.Var("x", R.Tensor((4, 3), "float32"))
+    x1 = relax.Var("x", R.Tensor((n, 3), "float16"))
+    x2 = relax.Var("x", R.Tensor("float32", ndim=2))
+    x3 = relax.Var("x", R.Tensor((3, 4), "float32"))
+
+    _check_inference(
+        bb, relax.op.ccl.reducescatter(x0, "sum", 2), relax.TensorType((2, 3), "float32")
+    )
+    _check_inference(
+        bb, relax.op.ccl.reducescatter(x1, "max", 2), relax.TensorType((n // 2, 3), "float16")
+    )
+    _check_inference(
+        bb, relax.op.ccl.reducescatter(x2, "sum", 2), relax.TensorType(dtype="float32", ndim=2)
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.ccl.reducescatter(x3, "sum", 2))
+
+
 def test_broadcast_from_worker0_infer_ty():
     bb = relax.BlockBuilder()
     x0 = relax.Var("x", R.Tensor((2, 3), "float32"))
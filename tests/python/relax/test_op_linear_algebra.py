@@ -322,5 +322,45 @@ def test_einsum_infer_ty_wrong_inputs():
         bb.normalize(relax.op.einsum(x1, subscripts="ijk"))
 
 
+def test_csr_matmul_infer_ty():
+    bb = relax.BlockBuilder()
+    nnz = tirx.Var("nnz", "int64")
+    m = tirx.Var("m", "int64")
+    data = relax.Var("data", R.Tensor((nnz,), "float32"))
+    indices = relax.Var("indices", R.Tensor((nnz,), "int32"))
+    indptr0 = relax.Var("indptr", R.Tensor((m + 1,), "int32"))
+    indptr1 = relax.Var("indptr", R.Tensor("int32", ndim=1))
+    dense = relax.Var("dense", R.Tensor((8, 16), "float32"))
+
+    _check_inference(
+        bb,
+        relax.op.csr_matmul(data, indices, indptr0, dense),
+        relax.TensorType((m, 16), "float32"),
+    )
+    _check_inference(
+        bb,
+        relax.op.csr_matmul(data, indices, indptr1, dense),
+        relax.TensorType(dtype="float32", ndim=2),
+    )
+
+
+def test_csr_matmul_infer_ty_wrong_input():
+    bb = relax.BlockBuilder()
+    data = relax.Var("data", R.Tensor((5,), "float32"))
+    indices0 = relax.Var("indices", R.Tensor((5,), "int32"))
+    indices1 = relax.Var("indices", R.Tensor((4,), "int32"))
+    indices2 = relax.Var("indices", R.Tensor((5,), "float32"))
+    indptr = relax.Var("indptr", R.Tensor((4,), "int32"))
+    dense0 = relax.Var("dense", R.Tensor((8, 16), "float32"))
+    dense1 = relax.Var("dense", R.Tensor((8,), "float32"))
+
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.csr_matmul(data, indices1, indptr, dense0))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.csr_matmul(data, indices2, indptr, dense0))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.csr_matmul(data, indices0, indptr, dense1))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
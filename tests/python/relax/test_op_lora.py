@@ -0,0 +1,69 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax, tirx
+from tvm.script import relax as R
+
+
+def _check_inference(bb: relax.BlockBuilder, call: relax.Call, expected_ty: relax.Type):
+    ret = bb.normalize(call)
+    tvm.ir.assert_structural_equal(ret.ty, expected_ty)
+
+
+def test_op_correctness():
+    x = relax.Var("x", R.Tensor((4, 8), "float16"))
+    w = relax.Var("w", R.Tensor((3, 2, 8), "float16"))
+    indptr = relax.Var("indptr", R.Tensor((3,), "int32"))
+    indices = relax.Var("indices", R.Tensor((2,), "int32"))
+    assert relax.op.lora.sgmv(x, w, indptr, indices).op == tvm.ir.Op.get("relax.lora.sgmv")
+
+
+def test_sgmv_infer_ty():
+    bb = relax.BlockBuilder()
+    r = tirx.Var("r", "int64")
+    s = tirx.Var("s", "int64")
+    x0 = relax.Var("x", R.Tensor((r, 8), "float16"))
+    x1 = relax.Var("x", R.Tensor((r, 4), "float16"))
+    w0 = relax.Var("w", R.Tensor((3, 2, 8), "float16"))
+    w1 = relax.Var("w", R.Tensor((3, 2, 8), "float32"))
+    indptr0 = relax.Var("indptr", R.Tensor((s + 1,), "int32"))
+    indptr1 = relax.Var("indptr", R.Tensor((s,), "int32"))
+    indptr2 = relax.Var("indptr", R.Tensor(ndim=1, dtype="int32"))
+    indices0 = relax.Var("indices", R.Tensor((s,), "int32"))
+    indices1 = relax.Var("indices", R.Tensor((s,), "float32"))
+
+    _check_inference(
+        bb, relax.op.lora.sgmv(x0, w0, indptr0, indices0), R.Tensor((r, 2), "float16")
+    )
+    _check_inference(
+        bb, relax.op.lora.sgmv(x0, w0, indptr2, indices0), R.Tensor((r, 2), "float16")
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.lora.sgmv(x1, w0, indptr0, indices0))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.lora.sgmv(x0, w0, indptr1, indices0))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.lora.sgmv(x0, w1, indptr0, indices0))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.lora.sgmv(x0, w0, indptr0, indices1))
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -0,0 +1,131 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax, tirx
+from tvm.script import relax as R
+
+
+def _check_inference(bb: relax.BlockBuilder, call: relax.Call, expected_ty: relax.Type):
+    ret = bb.normalize(call)
+    tvm.ir.assert_structural_equal(ret.ty, expected_ty)
+
+
+def test_op_correctness():
+    x = relax.Var("x", R.Tensor((4, 8), "float16"))
+    indices = relax.Var("indices", R.Tensor((4, 2), "int32"))
+    weights = relax.Var("weights", R.Tensor((4, 2), "float16"))
+    w = relax.Var("w", R.Tensor((3, 16, 8), "float16"))
+    indptr = relax.Var("indptr", R.Tensor((4,), "int32"))
+    assert relax.op.moe.topk_gating(x, 2).op == tvm.ir.Op.get("relax.moe.topk_gating")
+    assert relax.op.moe.permute(x, indices, 3).op == tvm.ir.Op.get("relax.moe.permute")
+    assert relax.op.moe.group_matmul(x, w, indptr).op == tvm.ir.Op.get("relax.moe.group_matmul")
+    assert relax.op.moe.unpermute(x, indices, weights).op == tvm.ir.Op.get("relax.moe.unpermute")
+
+
+def test_topk_gating_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    x0 = relax.Var("x", R.Tensor((4, 8), "float16"))
+    x1 = relax.Var("x", R.Tensor((n, 8), "float32"))
+    x2 = relax.Var("x", R.Tensor((4, 2), "float32"))
+
+    _check_inference(
+        bb,
+        relax.op.moe.topk_gating(x0, 2),
+        relax.TupleType([R.Tensor((4, 2), "float16"), R.Tensor((4, 2), "int32")]),
+    )
+    _check_inference(
+        bb,
+        relax.op.moe.topk_gating(x1, 3, normalize=False),
+        relax.TupleType([R.Tensor((n, 3), "float32"), R.Tensor((n, 3), "int32")]),
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.moe.topk_gating(x2, 3))
+
+
+def test_permute_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    x0 = relax.Var("x", R.Tensor((n, 8), "float16"))
+    x1 = relax.Var("x", R.Tensor((5, 8), "float16"))
+    indices0 = relax.Var("indices", R.Tensor((n, 2), "int32"))
+    indices1 = relax.Var("indices", R.Tensor((n, 2), "float32"))
+    indices2 = relax.Var("indices", R.Tensor((4, 2), "int32"))
+
+    _check_inference(
+        bb,
+        relax.op.moe.permute(x0, indices0, 4),
+        relax.TupleType(
+            [
+                R.Tensor((n * 2, 8), "float16"),
+                R.Tensor((5,), "int32"),
+                R.Tensor((n, 2), "int32"),
+            ]
+        ),
+    )
+    _check_inference(
+        bb,
+        relax.op.moe.permute(x0, indices0, 4, capacity=6),
+        relax.TupleType(
+            [R.Tensor((24, 8), "float16"), R.Tensor((5,), "int32"), R.Tensor((n, 2), "int32")]
+        ),
+    )
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.moe.permute(x0, indices1, 4))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.moe.permute(x1, indices2, 4))
+
+
+def test_group_matmul_infer_ty():
+    bb = relax.BlockBuilder()
+    r = tirx.Var("r", "int64")
+    x0 = relax.Var("x", R.Tensor((r, 8), "float16"))
+    x1 = relax.Var("x", R.Tensor((r, 4), "float16"))
+    w0 = relax.Var("w", R.Tensor((3, 16, 8), "float16"))
+    w1 = relax.Var("w", R.Tensor((3, 16, 8), "float32"))
+    indptr0 = relax.Var("indptr", R.Tensor((4,), "int32"))
+    indptr1 = relax.Var("indptr", R.Tensor((3,), "int32"))
+
+    _check_inference(bb, relax.op.moe.group_matmul(x0, w0, indptr0), R.Tensor((r, 16), "float16"))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.moe.group_matmul(x1, w0, indptr0))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.moe.group_matmul(x0, w0, indptr1))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.moe.group_matmul(x0, w1, indptr0))
+
+
+def test_unpermute_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    x = relax.Var("x", R.Tensor((12, 16), "float16"))
+    token_rows0 = relax.Var("token_rows", R.Tensor((n, 2), "int32"))
+    token_rows1 = relax.Var("token_rows", R.Tensor((n, 3), "int32"))
+    weights = relax.Var("weights", R.Tensor((n, 2), "float32"))
+
+    _check_inference(
+        bb, relax.op.moe.unpermute(x, token_rows0, weights), R.Tensor((n, 16), "float16")
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.moe.unpermute(x, token_rows1, weights))
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
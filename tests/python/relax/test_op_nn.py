@@ -1860,5 +1860,51 @@ def test_batch_flatten_infer_ty_wrong_ndim():
         bb.normalize(relax.op.nn.batch_flatten(x0))
 
 
+def test_embedding_bag_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    w0 = relax.Var("w", R.Tensor((10, 4), "float32"))
+    w1 = relax.Var("w", R.Tensor("float32", ndim=2))
+    i0 = relax.Var("i", R.Tensor((n,), "int64"))
+    o0 = relax.Var("o", R.Tensor((3,), "int32"))
+    p0 = relax.Var("p", R.Tensor((n,), "float32"))
+
+    _check_inference(
+        bb, relax.op.nn.embedding_bag(w0, i0, o0), relax.TensorType((3, 4), "float32")
+    )
+    _check_inference(
+        bb,
+        relax.op.nn.embedding_bag(w0, i0, o0, p0, mode="sum"),
+        relax.TensorType((3, 4), "float32"),
+    )
+    _check_inference(
+        bb,
+        relax.op.nn.embedding_bag(w0, i0, o0, mode="mean"),
+        relax.TensorType((3, 4), "float32"),
+    )
+    _check_inference(
+        bb, relax.op.nn.embedding_bag(w1, i0, o0), relax.TensorType(dtype="float32", ndim=2)
+    )
+
+
+def test_embedding_bag_infer_ty_wrong_input():
+    bb = relax.BlockBuilder()
+    w0 = relax.Var("w", R.Tensor((10, 4), "float32"))
+    w1 = relax.Var("w", R.Tensor((10,), "float32"))
+    i0 = relax.Var("i", R.Tensor((6,), "int64"))
+    i1 = relax.Var("i", R.Tensor((6,), "float32"))
+    o0 = relax.Var("o", R.Tensor((3,), "int64"))
+    p0 = relax.Var("p", R.Tensor((6,), "float32"))
+
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.nn.embedding_bag(w0, i1, o0))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.nn.embedding_bag(w1, i0, o0))
+    with pytest.raises(tvm.error.InternalError):
+        relax.op.nn.embedding_bag(w0, i0, o0, mode="min")
+    with pytest.raises(tvm.error.InternalError):
+        relax.op.nn.embedding_bag(w0, i0, o0, p0, mode="mean")
+
+
 if __name__ == "__main__":
     tvm.testing.main()
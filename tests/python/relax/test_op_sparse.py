@@ -0,0 +1,100 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax, tirx
+from tvm.script import relax as R
+
+
+def _check_inference(bb: relax.BlockBuilder, call: relax.Call, expected_ty: relax.Type):
+    ret = bb.normalize(call)
+    tvm.ir.assert_structural_equal(ret.ty, expected_ty)
+
+
+def test_op_correctness():
+    w = relax.Var("w", R.Tensor((32, 64), "float16"))
+    x = relax.Var("x", R.Tensor((4, 64), "float16"))
+    values = relax.Var("values", R.Tensor((32, 32), "float16"))
+    metadata = relax.Var("metadata", R.Tensor((2, 4, 8), "uint32"))
+    assert relax.op.sparse.compress_2_4(w).op == tvm.ir.Op.get("relax.sparse.compress_2_4")
+    assert relax.op.sparse.matmul_2_4(x, values, metadata).op == tvm.ir.Op.get(
+        "relax.sparse.matmul_2_4"
+    )
+
+
+def test_compress_2_4_infer_ty():
+    bb = relax.BlockBuilder()
+    n = tirx.Var("n", "int64")
+    w0 = relax.Var("w", R.Tensor((32, 64), "float16"))
+    w1 = relax.Var("w", R.Tensor(ndim=2, dtype="float16"))
+    w2 = relax.Var("w", R.Tensor((32, 40), "float16"))
+    w3 = relax.Var("w", R.Tensor((32, 64), "int8"))
+    w4 = relax.Var("w", R.Tensor((n * 16, 64), "float32"))
+
+    _check_inference(
+        bb,
+        relax.op.sparse.compress_2_4(w0),
+        relax.TupleType([R.Tensor((32, 32), "float16"), R.Tensor((2, 4, 8), "uint32")]),
+    )
+    _check_inference(
+        bb,
+        relax.op.sparse.compress_2_4(w1),
+        relax.TupleType([R.Tensor(ndim=2, dtype="float16"), R.Tensor(ndim=3, dtype="uint32")]),
+    )
+    _check_inference(
+        bb,
+        relax.op.sparse.compress_2_4(w4),
+        relax.TupleType([R.Tensor((n * 16, 32), "float32"), R.Tensor((n, 4, 8), "uint32")]),
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.sparse.compress_2_4(w2))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.sparse.compress_2_4(w3))
+
+
+def test_matmul_2_4_infer_ty():
+    bb = relax.BlockBuilder()
+    m = tirx.Var("m", "int64")
+    x0 = relax.Var("x", R.Tensor((2, m, 64), "float16"))
+    x1 = relax.Var("x", R.Tensor((m, 48), "float16"))
+    x2 = relax.Var("x", R.Tensor((m, 64), "float32"))
+    x3 = relax.Var("x", R.Tensor(ndim=2, dtype="float16"))
+    values0 = relax.Var("values", R.Tensor((32, 32), "float16"))
+    values1 = relax.Var("values", R.Tensor((48, 32), "float16"))
+    metadata0 = relax.Var("metadata", R.Tensor((2, 4, 8), "uint32"))
+    metadata1 = relax.Var("metadata", R.Tensor((2, 4, 8), "int32"))
+
+    _check_inference(
+        bb, relax.op.sparse.matmul_2_4(x0, values0, metadata0), R.Tensor((2, m, 32), "float16")
+    )
+    _check_inference(
+        bb, relax.op.sparse.matmul_2_4(x3, values0, metadata0), R.Tensor(ndim=2, dtype="float16")
+    )
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.sparse.matmul_2_4(x1, values0, metadata0))
+    with pytest.raises(ValueError):
+        bb.normalize(relax.op.sparse.matmul_2_4(x0, values1, metadata0))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.sparse.matmul_2_4(x2, values0, metadata0))
+    with pytest.raises(TypeError):
+        bb.normalize(relax.op.sparse.matmul_2_4(x0, values0, metadata1))
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
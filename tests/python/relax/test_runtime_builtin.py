@@ -285,5 +285,60 @@ def test_attention_kv_cache_window_override_with_sinks():
     ).all()
 
 
+
+def test_batch_sampling():
+    fsample = tvm.get_global_func("vm.builtin.sample_top_p_from_prob")
+    fbatch_sample = tvm.get_global_func("vm.builtin.batch_sample_top_p_from_prob")
+    fsoftmax = tvm.get_global_func("vm.builtin.apply_softmax_with_temperature")
+    fbatch_softmax = tvm.get_global_func("vm.builtin.batch_apply_softmax_with_temperature")
+    fpenalty = tvm.get_global_func("vm.builtin.apply_repetition_penalty")
+    fbatch_penalty = tvm.get_global_func("vm.builtin.batch_apply_repetition_penalty")
+
+    batch_size, vocab_size = 16, 1003
+    np_logits = np.random.uniform(-5, 5, size=(batch_size, vocab_size)).astype("float32")
+    np_token_ids = np.random.randint(0, vocab_size, size=(batch_size, 4)).astype("int32")
+    np_token_ids[::2, 2:] = -1
+    penalties = np.random.uniform(1, 2, size=(batch_size,)).astype("float32")
+    temperatures = np.random.uniform(0.5, 1.5, size=(batch_size,)).astype("float32")
+    top_p = np.random.uniform(0.5, 1, size=(batch_size,)).astype("float32")
+    uniform_samples = np.random.uniform(0, 1, size=(batch_size,)).astype("float32")
+
+    logits = tvm.runtime.tensor(np_logits)
+    fbatch_penalty(logits, tvm.runtime.tensor(np_token_ids), tvm.runtime.tensor(penalties))
+    fbatch_softmax(logits, tvm.runtime.tensor(temperatures))
+    sampled = tvm.runtime.tensor(np.zeros((batch_size,), dtype="int64"))
+    fbatch_sample(
+        logits, tvm.runtime.tensor(top_p), tvm.runtime.tensor(uniform_samples), sampled
+    )
+
+    for i in range(batch_size):
+        row = tvm.runtime.tensor(np_logits[i : i + 1])
+        token_ids = np_token_ids[i : i + 1]
+        fpenalty(row, tvm.runtime.tensor(token_ids[token_ids >= 0][None, :]), float(penalties[i]))
+        fsoftmax(row, float(temperatures[i]))
+        tvm.testing.assert_allclose(logits.numpy()[i], row.numpy()[0], rtol=1e-5, atol=1e-7)
+        assert sampled.numpy()[i] == fsample(row, float(top_p[i]), float(uniform_samples[i]))
+
+
+@tvm.testing.requires_cuda
+def test_async_host_device_copy():
+    falloc_pinned = tvm.get_global_func("vm.builtin.alloc_pinned_host_tensor")
+    fto_device_async = tvm.get_global_func("vm.builtin.to_device_async")
+    fto_host_async = tvm.get_global_func("vm.builtin.to_host_async")
+
+    dev = tvm.cuda(0)
+    np_data = np.random.rand(4, 8).astype("float32")
+    pinned = falloc_pinned(tvm_ffi.Shape([4, 8]), "float32", dev)
+    # kDLCUDAHost
+    assert pinned.device.dlpack_device_type() == 3
+    pinned.copyfrom(np_data)
+
+    data = fto_device_async(pinned, dev.dlpack_device_type(), dev.index)
+    assert data.device == dev
+    readback = fto_host_async(data)
+    dev.sync()
+    tvm.testing.assert_allclose(readback.numpy(), np_data)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
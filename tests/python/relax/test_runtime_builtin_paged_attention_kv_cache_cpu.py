@@ -18,6 +18,8 @@
 import enum
 import itertools
 import json
+import os
+import tempfile
 
 import numpy as np
 import pytest
@@ -30,6 +32,7 @@ from tvm_ffi import Shape
 
 import tvm
 import tvm.testing
+from tvm.relax.frontend.nn.llm._kernel_common import _dequantize_kv_pages
 from tvm.relax.frontend.nn.llm.kv_cache import (
     AttnKind,
     _attention_decode_cpu,
@@ -39,6 +42,7 @@ from tvm.relax.frontend.nn.llm.kv_cache import (
     _copy_single_page_cpu,
     _kv_cache_debug_get_kv,
     _kv_cache_transpose_append,
+    _kv_cache_transpose_append_quantized,
     _merge_state_inplace_cpu,
     llama_rope_with_position_map,
     tree_attn_cpu,
@@ -187,7 +191,13 @@ def set_global_func(head_dim, dtype):
     ) = builts
 
 
-def create_kv_cache(head_dim, dtype, rope_mode, support_sliding_window):
+def create_kv_cache(head_dim, dtype, rope_mode, support_sliding_window, auto_backend=False):
+    prefill_function = ["tirx", fattn_prefill]
+    decode_function = ["tirx", fattn_decode]
+    if auto_backend:
+        # Two candidates of the same kernel exercise the per-shape selection and its warm-up.
+        prefill_function = ["auto", prefill_function, prefill_function]
+        decode_function = ["auto", decode_function, decode_function]
     fcreate = tvm.get_global_func("vm.builtin.paged_attention_kv_cache_create")
     cache = fcreate(
         tvm_ffi.Shape(
@@ -214,8 +224,8 @@ def create_kv_cache(head_dim, dtype, rope_mode, support_sliding_window):
         ftranspose_append,
         None,  # f_transpose_append_mla
         ["tirx", fattn_prefill_ragged],
-        ["tirx", fattn_prefill],
-        ["tirx", fattn_decode],
+        prefill_function,
+        decode_function,
         ["tirx", fattn_prefill_sliding_window],
         ["tirx", fattn_decode_sliding_window],
         ["tirx", fattn_prefill_with_tree_mask_paged_kv_cache],
@@ -743,6 +753,34 @@ def test_paged_attention_kv_cache_unlimited_depth(kv_cache_and_config):
     assert fis_empty(kv_cache), "The KV cache is not empty after removing all sequences"
 
 
+def test_paged_attention_kv_cache_cascade_decode(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 100)], cached_k, cached_v)
+    # The n-best children share the prompt of sequence 0, whose attention is computed once for
+    # the queries of all children and merged with the attention over their own tokens.
+    num_children = 6
+    apply_attention(
+        kv_cache,
+        rope_mode,
+        [((i, 0, -1), 1) for i in range(1, num_children + 1)],
+        cached_k,
+        cached_v,
+    )
+    for _ in range(20):
+        batch = [(i, 1) for i in range(1, num_children + 1)]
+        apply_attention(kv_cache, rope_mode, batch, cached_k, cached_v)
+
+    for seq_id in cached_k:
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
 def test_paged_attention_kv_cache_popn(kv_cache_and_config):
     kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
     if support_sliding_window and rope_mode == RopeMode.NORMAL:
@@ -776,6 +814,420 @@ def test_paged_attention_kv_cache_popn(kv_cache_and_config):
     assert fis_empty(kv_cache), "The KV cache is not empty after removing all sequences"
 
 
+def test_paged_attention_kv_cache_repeated_decode(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 13), (1, 16), (2, 3), (3, 30)], cached_k, cached_v)
+    # The consecutive decode steps of the same batch patch the plan of the previous step,
+    # and cross page boundaries of every sequence.
+    decode_batch = [(0, 1), (1, 1), (2, 1), (3, 1)]
+    for _ in range(page_size + 3):
+        apply_attention(kv_cache, rope_mode, decode_batch, cached_k, cached_v)
+
+    # Popping tokens and adding sequences between the decode steps rebuild the plan.
+    fpopn(kv_cache, 1, 5)
+    cached_k[1] = cached_k[1][:, :-5, ...]
+    cached_v[1] = cached_v[1][:, :-5, ...]
+    for _ in range(3):
+        apply_attention(kv_cache, rope_mode, decode_batch, cached_k, cached_v)
+    apply_attention(kv_cache, rope_mode, [(4, 9)], cached_k, cached_v)
+    for _ in range(page_size):
+        apply_attention(kv_cache, rope_mode, decode_batch + [(4, 1)], cached_k, cached_v)
+
+
+def test_paged_attention_kv_cache_prefix_cache(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+    fcommit_sequence_prefix = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_commit_sequence_prefix"
+    )
+    fadd_sequence_with_prefix_match = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_add_sequence_with_prefix_match"
+    )
+
+    cached_k = {}
+    cached_v = {}
+    tokens_0 = list(range(50))
+    apply_attention(kv_cache, rope_mode, [(0, 50)], cached_k, cached_v)
+    # Only the 3 full pages (48 tokens) are committed.
+    fcommit_sequence_prefix(kv_cache, 0, Shape(tokens_0))
+    committed_k = cached_k[0][:, :48]
+    committed_v = cached_v[0][:, :48]
+
+    # Match in the middle of a page, which copies the partially matched page.
+    tokens_1 = tokens_0[:40] + [1000 + i for i in range(10)]
+    assert fadd_sequence_with_prefix_match(kv_cache, 1, Shape(tokens_1)) == 40
+    cached_k[1] = cached_k[0][:, :40]
+    cached_v[1] = cached_v[0][:, :40]
+    apply_attention(kv_cache, rope_mode, [(1, 10), (0, 1)], cached_k, cached_v)
+
+    # The committed prefix outlives the sequence.
+    fremove_sequence(kv_cache, 0)
+    cached_k.pop(0)
+    cached_v.pop(0)
+    assert fadd_sequence_with_prefix_match(kv_cache, 2, Shape(tokens_0[:48] + [7])) == 48
+    cached_k[2] = committed_k
+    cached_v[2] = committed_v
+    apply_attention(kv_cache, rope_mode, [(2, 5), (1, 1)], cached_k, cached_v)
+
+    # Committing a diverged sequence splits the tree node at the page boundary.
+    fcommit_sequence_prefix(kv_cache, 1, Shape(tokens_1))
+    assert fadd_sequence_with_prefix_match(kv_cache, 3, Shape(tokens_1[:48] + [9])) == 48
+    cached_k[3] = cached_k[1][:, :48]
+    cached_v[3] = cached_v[1][:, :48]
+    assert fadd_sequence_with_prefix_match(kv_cache, 4, Shape([5000, 5001])) == 0
+    cached_k[4] = np.zeros((num_layers, 0, num_kv_heads, head_dim), dtype)
+    cached_v[4] = np.zeros((num_layers, 0, num_kv_heads, head_dim), dtype)
+    apply_attention(kv_cache, rope_mode, [(3, 3), (4, 2), (2, 1), (1, 1)], cached_k, cached_v)
+
+    for seq_id in [1, 2, 3, 4]:
+        fremove_sequence(kv_cache, seq_id)
+    # The prefix cache still holds the committed pages.
+    assert not fis_empty(kv_cache)
+    fclear(kv_cache)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_swap(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+    fswap_out_sequence = tvm.get_global_func("vm.builtin.attention_kv_cache_swap_out_sequence")
+    fswap_in_sequence = tvm.get_global_func("vm.builtin.attention_kv_cache_swap_in_sequence")
+    fget_num_available_pages = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_get_num_available_pages"
+    )
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 40), (1, 25)], cached_k, cached_v)
+    # Sequence 2 shares the first page of sequence 0.
+    apply_attention(kv_cache, rope_mode, [((2, 0, 16), 7)], cached_k, cached_v)
+
+    num_available_pages = fget_num_available_pages(kv_cache)
+    fswap_out_sequence(kv_cache, 0)
+    fswap_out_sequence(kv_cache, 1)
+    # The shared page stays on device, and the other 4 pages are released.
+    assert fget_num_available_pages(kv_cache) == num_available_pages + 4
+
+    # The other sequences keep running when sequences are swapped out.
+    apply_attention(kv_cache, rope_mode, [(2, 1), (3, 20)], cached_k, cached_v)
+    # Swap in explicitly, or implicitly in the forward.
+    fswap_in_sequence(kv_cache, 1)
+    apply_attention(kv_cache, rope_mode, [(0, 1), (1, 3), (2, 1)], cached_k, cached_v)
+    apply_attention(kv_cache, rope_mode, [(0, 17), (3, 1)], cached_k, cached_v)
+
+    # Removing a swapped-out sequence releases its host pages.
+    fswap_out_sequence(kv_cache, 3)
+    for seq_id in range(4):
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
+def test_request_scheduler(kv_cache_and_config):
+    kv_cache, _, _ = kv_cache_and_config
+    fclear(kv_cache)
+    fcreate = tvm.get_global_func("vm.builtin.request_scheduler_create")
+    fadd_request = tvm.get_global_func("vm.builtin.request_scheduler_add_request")
+    fremove_request = tvm.get_global_func("vm.builtin.request_scheduler_remove_request")
+    fstep = tvm.get_global_func("vm.builtin.request_scheduler_step")
+    fhas_unfinished = tvm.get_global_func("vm.builtin.request_scheduler_has_unfinished_requests")
+    fget_output = tvm.get_global_func("vm.builtin.request_scheduler_get_output")
+    fget_metrics = tvm.get_global_func("vm.builtin.request_scheduler_get_metrics")
+
+    batches = []
+
+    def fforward(seq_ids, append_lengths, token_ids):
+        batches.append((list(seq_ids), list(append_lengths)))
+        # The next token of a sequence is its last token plus one.
+        next_token_ids = []
+        offset = 0
+        for length in append_lengths:
+            offset += length
+            next_token_ids.append(token_ids[offset - 1] + 1)
+        return tvm_ffi.Shape(next_token_ids)
+
+    scheduler = fcreate(kv_cache, fforward, page_size, 4, 64, "recompute")
+    fadd_request(scheduler, 0, tvm_ffi.Shape([1] * 100), 3, tvm_ffi.Shape([]))
+    fadd_request(scheduler, 1, tvm_ffi.Shape([10, 11]), 5, tvm_ffi.Shape([14]))
+    finished = []
+    while fhas_unfinished(scheduler):
+        finished += list(fstep(scheduler))
+
+    # The long prompt is prefilled in two chunks within the token budget, and the second
+    # request is admitted along the second chunk.
+    assert batches[:3] == [([0], [64]), ([0, 1], [36, 2]), ([0, 1], [1, 1])]
+    assert list(fget_output(scheduler, 0)) == [2, 3, 4]
+    # The second request finishes at its stop token.
+    assert list(fget_output(scheduler, 1)) == [12, 13, 14]
+    assert sorted(finished) == [0, 1]
+    metrics = fget_metrics(scheduler)
+    assert metrics["num_prefill_tokens"] == 102
+    assert metrics["num_generated_tokens"] == 6
+    assert metrics["num_finished_requests"] == 2
+    assert metrics["num_preemptions"] == 0
+    fremove_request(scheduler, 0)
+    fremove_request(scheduler, 1)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_snapshot(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+    fsave_snapshot = tvm.get_global_func("vm.builtin.attention_kv_cache_save_sequence_snapshot")
+    frestore_snapshot = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_restore_sequence_snapshot"
+    )
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 40), (1, 25)], cached_k, cached_v)
+    # Sequence 2 shares the first page of sequence 0, and the shared block is saved too.
+    apply_attention(kv_cache, rope_mode, [((2, 0, 16), 7)], cached_k, cached_v)
+    token_ids = list(range(100, 123))
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        path = os.path.join(tmp_dir, "seq2.kvsnap")
+        fsave_snapshot(kv_cache, 2, Shape(token_ids), path, "model-a")
+        fremove_sequence(kv_cache, 2)
+        fremove_sequence(kv_cache, 0)
+        with pytest.raises(ValueError):
+            frestore_snapshot(kv_cache, 3, path, "model-b")
+
+        assert list(frestore_snapshot(kv_cache, 3, path, "model-a")) == token_ids
+        cached_k[3] = cached_k.pop(2)
+        cached_v[3] = cached_v.pop(2)
+        del cached_k[0]
+        del cached_v[0]
+        verify_cached_kv(kv_cache, [1, 3], cached_k, cached_v)
+        apply_attention(kv_cache, rope_mode, [(1, 3), (3, 1)], cached_k, cached_v)
+        apply_attention(kv_cache, rope_mode, [(3, 10)], cached_k, cached_v)
+
+    for seq_id in cached_k:
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_auto_backend(kv_cache_and_config):
+    _, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window:
+        return
+    kv_cache = create_kv_cache(head_dim, dtype, rope_mode, support_sliding_window, True)
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 35), (1, 88), (2, 17), (3, 4)], cached_k, cached_v)
+    # The first decode steps of the batch shape time each candidate before one is kept.
+    for _ in range(8):
+        apply_attention(kv_cache, rope_mode, [(0, 1), (1, 1), (2, 1), (3, 1)], cached_k, cached_v)
+    apply_attention(kv_cache, rope_mode, [(0, 7), (2, 20)], cached_k, cached_v)
+
+    for seq_id in cached_k:
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_batch_fork_and_popn(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+    fbatch_fork_sequence = tvm.get_global_func("vm.builtin.attention_kv_cache_batch_fork_sequence")
+    fbatch_popn = tvm.get_global_func("vm.builtin.attention_kv_cache_batch_popn")
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 50), (1, 37)], cached_k, cached_v)
+    # Sequence 4 is forked from sequence 2 which is forked within a page in the same batch.
+    parent_ids = [0, 0, 1, 2, 1]
+    child_ids = [2, 3, 5, 4, 6]
+    fork_pos = [21, 50, 33, 19, -1]
+    fbatch_fork_sequence(kv_cache, Shape(parent_ids), Shape(child_ids), Shape(fork_pos))
+    for parent_id, child_id, pos in zip(parent_ids, child_ids, fork_pos):
+        pos = cached_k[parent_id].shape[1] if pos == -1 else pos
+        cached_k[child_id] = cached_k[parent_id][:, :pos]
+        cached_v[child_id] = cached_v[parent_id][:, :pos]
+    verify_cached_kv(kv_cache, child_ids, cached_k, cached_v)
+    apply_attention(kv_cache, rope_mode, [(2, 1), (3, 1), (4, 5), (5, 1), (6, 1)], cached_k, cached_v)
+
+    pop_ids = [0, 4, 5]
+    pop_lengths = [3, 6, 10]
+    fbatch_popn(kv_cache, Shape(pop_ids), Shape(pop_lengths))
+    for seq_id, pop_length in zip(pop_ids, pop_lengths):
+        cached_k[seq_id] = cached_k[seq_id][:, : cached_k[seq_id].shape[1] - pop_length]
+        cached_v[seq_id] = cached_v[seq_id][:, : cached_v[seq_id].shape[1] - pop_length]
+    verify_cached_kv(kv_cache, pop_ids, cached_k, cached_v)
+    apply_attention(kv_cache, rope_mode, [(0, 1), (4, 1), (5, 1)], cached_k, cached_v)
+
+    for seq_id in cached_k:
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_chunked_forward(kv_cache_and_config):
+    kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
+    if support_sliding_window and rope_mode == RopeMode.NORMAL:
+        return
+    fclear(kv_cache)
+    fbegin_chunked_forward = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_begin_chunked_forward"
+    )
+    fget_query_positions = tvm.get_global_func("vm.builtin.attention_kv_cache_get_query_positions")
+
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 20), (1, 30)], cached_k, cached_v)
+    fadd_sequence(kv_cache, 2)
+    fadd_sequence(kv_cache, 3)
+
+    # The decode sequences are scheduled first, and the prefills share the rest of the budget.
+    scheduled_lengths = fbegin_chunked_forward(kv_cache, Shape([2, 0, 3, 1]), Shape([100, 1, 50, 1]), 64)
+    assert list(scheduled_lengths) == [62, 1, 0, 1]
+    query_positions = fget_query_positions(kv_cache).numpy()
+    expected_positions = np.concatenate([np.arange(62), [20], [30]])
+    tvm.testing.assert_allclose(query_positions, expected_positions)
+    fend_forward(kv_cache)
+
+    # The budget is capped by the prefill chunk size.
+    scheduled_lengths = fbegin_chunked_forward(kv_cache, Shape([2, 3]), Shape([38, 1000]), 4096)
+    assert list(scheduled_lengths) == [38, prefill_chunk_size - 38]
+    fend_forward(kv_cache)
+
+    for seq_id in range(4):
+        fremove_sequence(kv_cache, seq_id)
+    assert fis_empty(kv_cache)
+
+
+def test_paged_attention_kv_cache_quantized():
+    kv_storage_dtype = "int8"
+    qk_dim, kv_dtype = 64, "float32"
+    set_global_func(qk_dim, kv_dtype)
+    target = tvm.target.Target.from_device(device)
+    builts = []
+    for tir_func in [
+        _kv_cache_transpose_append_quantized(num_kv_heads, qk_dim, kv_dtype, kv_storage_dtype),
+        _dequantize_kv_pages(_kv_cache_debug_get_kv(num_layers, num_kv_heads, qk_dim, kv_dtype), kv_storage_dtype),
+        _dequantize_kv_pages(_attention_prefill_cpu(num_kv_heads, num_qo_heads, qk_dim, kv_dtype, False, rope_scaling), kv_storage_dtype),
+        _dequantize_kv_pages(_attention_decode_cpu(num_kv_heads, num_qo_heads, qk_dim, kv_dtype, False, rope_scaling), kv_storage_dtype),
+        _copy_single_page_cpu(num_kv_heads, page_size, qk_dim, kv_storage_dtype),
+        _compact_kv_copy_cpu(num_kv_heads, qk_dim, kv_storage_dtype),
+    ]:
+        mod = tvm.IRModule({"main": tir_func})
+        with target:
+            mod = dl.ApplyDefaultSchedule(dl.gpu.Fallback())(mod)
+        builts.append(tvm.tirx.build(mod["main"], target=target).main)
+    fappend, fdebug_get, fprefill, fdecode, fcopy_page, fcompact = builts
+
+    fcreate = tvm.get_global_func("vm.builtin.paged_attention_kv_cache_create")
+    kv_cache = fcreate(
+        tvm_ffi.Shape([reserved_nseq, maximum_total_seq_length, prefill_chunk_size, page_size, 0]),
+        tvm_ffi.Shape([0, num_layers]),
+        num_qo_heads,
+        num_kv_heads,
+        qk_dim,
+        qk_dim,  # v_head_dim
+        tvm_ffi.Shape([int(AttnKind.MHA) for _ in range(num_layers)]),
+        False,  # enable_kv_transfer
+        RopeMode.NONE,
+        rope_scale,
+        rope_theta,
+        None,  # rope_ext_factors
+        tvm.runtime.empty((), kv_dtype, device=device),
+        fappend,
+        None,  # f_transpose_append_mla
+        ["tirx", fattn_prefill_ragged],
+        ["tirx", fprefill],
+        ["tirx", fdecode],
+        [],  # f_attention_prefill_sliding_window
+        [],  # f_attention_decode_sliding_window
+        [],  # f_attention_prefill_with_tree_mask_paged_kv_cache
+        ["tirx", fattn_prefill_with_tree_mask],
+        [],  # f_mla_prefill
+        [fmerge_state],
+        fsplit_rotary,
+        fcopy_page,
+        fdebug_get,
+        fcompact,
+        tvm.runtime.empty((), kv_storage_dtype, device=device),
+    )
+
+    # Prefill two sequences, fork one of them in the middle of a page, and decode.
+    cached_k = {}
+    cached_v = {}
+    for batch in [[(0, 37), (1, 20)], [((2, 0, 21), 3)], [(0, 1), (1, 1), (2, 1)]]:
+        seq_ids = []
+        append_lengths = []
+        new_q, new_k, new_v = [], [], []
+        for seq_id, append_length in batch:
+            if isinstance(seq_id, tuple):
+                seq_id, parent_id, fork_pos = seq_id
+                ffork_sequence(kv_cache, parent_id, seq_id, fork_pos)
+                cached_k[seq_id] = cached_k[parent_id][:, :fork_pos]
+                cached_v[seq_id] = cached_v[parent_id][:, :fork_pos]
+            elif seq_id not in cached_k:
+                fadd_sequence(kv_cache, seq_id)
+                cached_k[seq_id] = np.zeros((num_layers, 0, num_kv_heads, qk_dim), kv_dtype)
+                cached_v[seq_id] = np.zeros((num_layers, 0, num_kv_heads, qk_dim), kv_dtype)
+            seq_ids.append(seq_id)
+            append_lengths.append(append_length)
+            q = np.random.uniform(-1, 1, (num_layers, append_length, num_qo_heads, qk_dim))
+            k = np.random.uniform(-1, 1, (num_layers, append_length, num_kv_heads, qk_dim))
+            v = np.random.uniform(-1, 1, (num_layers, append_length, num_kv_heads, qk_dim))
+            new_q.append(q.astype(kv_dtype))
+            new_k.append(k.astype(kv_dtype))
+            new_v.append(v.astype(kv_dtype))
+            cached_k[seq_id] = np.concatenate([cached_k[seq_id], new_k[-1]], axis=1)
+            cached_v[seq_id] = np.concatenate([cached_v[seq_id], new_v[-1]], axis=1)
+
+        fbegin_forward(kv_cache, Shape(seq_ids), Shape(append_lengths))
+        for layer_id in range(num_layers):
+            q = np.concatenate([x[layer_id] for x in new_q], axis=0)
+            k = np.concatenate([x[layer_id] for x in new_k], axis=0)
+            v = np.concatenate([x[layer_id] for x in new_v], axis=0)
+            qkv = tvm.runtime.tensor(np.concatenate([q, k, v], axis=1), device)
+            outputs = tvm.runtime.empty(q.shape, kv_dtype, device=device)
+            fattention_with_fuse_qkv(kv_cache, layer_id, qk_dim ** (-0.5), qkv, outputs)
+            outputs = outputs.numpy()
+
+            sum_length = 0
+            for i, (seq_id, append_length) in enumerate(zip(seq_ids, append_lengths)):
+                q_seq = new_q[i][layer_id].transpose(1, 0, 2)
+                k_seq = np.repeat(cached_k[seq_id][layer_id], num_qo_heads // num_kv_heads, axis=1)
+                v_seq = np.repeat(cached_v[seq_id][layer_id], num_qo_heads // num_kv_heads, axis=1)
+                kv_len = k_seq.shape[0]
+                softmax_input = (q_seq @ k_seq.transpose(1, 2, 0)) * qk_dim ** (-0.5)
+                mask = np.tril(np.ones((append_length, kv_len)), k=kv_len - append_length)
+                softmax_input = np.where(mask, softmax_input, -np.inf)
+                results = scipy.special.softmax(softmax_input, axis=-1) @ v_seq.transpose(1, 0, 2)
+                tvm.testing.assert_allclose(
+                    outputs[sum_length : sum_length + append_length],
+                    results.transpose(1, 0, 2),
+                    rtol=5e-2,
+                    atol=5e-2,
+                )
+                sum_length += append_length
+        fend_forward(kv_cache)
+
+    # The dequantized KV data matches the appended data up to the quantization error.
+    for seq_id in cached_k:
+        seq_length = cached_k[seq_id].shape[1]
+        keys = tvm.runtime.empty(cached_k[seq_id].shape, kv_dtype, device=device)
+        values = tvm.runtime.empty(cached_v[seq_id].shape, kv_dtype, device=device)
+        fdebug_get_kv(kv_cache, seq_id, 0, seq_length, keys, values)
+        tvm.testing.assert_allclose(keys.numpy(), cached_k[seq_id], rtol=0, atol=1e-2)
+        tvm.testing.assert_allclose(values.numpy(), cached_v[seq_id], rtol=0, atol=1e-2)
+
+
 def test_paged_attention_kv_cache_sliding_window(kv_cache_and_config):
     kv_cache, rope_mode, support_sliding_window = kv_cache_and_config
     if not support_sliding_window or rope_mode == RopeMode.NORMAL:
@@ -922,6 +1374,26 @@ def test_paged_attention_kv_cache_tree_attn(kv_cache_and_config):
     for _ in range(5):
         apply_attention(kv_cache, rope_mode, [(0, 1), (1, 1), (2, 1), (3, 1)], cached_k, cached_v)
 
+    # Test the cases of a large tree followed by a chain, which still needs the KV compaction.
+    fclear(kv_cache)
+    cached_k = {}
+    cached_v = {}
+    apply_attention(kv_cache, rope_mode, [(0, 10), (1, 20)], cached_k, cached_v)
+    apply_attention(
+        kv_cache,
+        rope_mode,
+        [(0, 80), (1, 6)],
+        cached_k,
+        cached_v,
+        token_tree_parent_ptr_list=[
+            [-1] + [(k - 1) // 3 for k in range(1, 80)],  # complete ternary tree of 80 nodes
+            [-1, 0, 1, 2, 3, 4],  # chain of length 6
+        ],
+        accepted_leaf_indices=[79, 3],
+    )
+    for _ in range(3):
+        apply_attention(kv_cache, rope_mode, [(0, 1), (1, 1)], cached_k, cached_v)
+
     # Test the cases where all trees are chains.
     fclear(kv_cache)
     cached_k = {}
@@ -986,7 +1458,16 @@ if __name__ == "__main__":
         test_paged_attention_kv_cache_prefill_and_decode(cache_and_config)
         test_paged_attention_kv_cache_remove_sequence(cache_and_config)
         test_paged_attention_kv_cache_fork_sequence(cache_and_config)
+        test_paged_attention_kv_cache_cascade_decode(cache_and_config)
         test_paged_attention_kv_cache_popn(cache_and_config)
+        test_paged_attention_kv_cache_prefix_cache(cache_and_config)
+        test_paged_attention_kv_cache_swap(cache_and_config)
+        test_request_scheduler(cache_and_config)
+        test_paged_attention_kv_cache_snapshot(cache_and_config)
+        test_paged_attention_kv_cache_auto_backend(cache_and_config)
+        test_paged_attention_kv_cache_batch_fork_and_popn(cache_and_config)
+        test_paged_attention_kv_cache_chunked_forward(cache_and_config)
         test_paged_attention_kv_cache_sliding_window(cache_and_config)
         test_paged_attention_kv_cache_tree_attn(cache_and_config)
         test_paged_attention_kv_cache_unlimited_depth(cache_and_config)
+    test_paged_attention_kv_cache_quantized()
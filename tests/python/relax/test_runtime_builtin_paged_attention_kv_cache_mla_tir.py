@@ -57,6 +57,7 @@ fclear = None
 fadd_sequence = None
 fremove_sequence = None
 ffork_sequence = None
+fenable_sliding_window_for_seq = None
 fpopn = None
 fbegin_forward = None
 fend_forward = None
@@ -70,6 +71,7 @@ fdebug_get_kv = None
 ftranspose_append = None
 fcopy_cache = None
 fmla_prefill = None
+fmla_prefill_sliding_window = None
 fmla_prefill_ragged = None
 fmerge_state = None
 fcopy_single_page = None
@@ -86,17 +88,21 @@ def _dumb_function():
 
 
 def set_global_func(dtype, target):
-    global fclear, fadd_sequence, fremove_sequence, ffork_sequence
+    global fclear, fadd_sequence, fremove_sequence, ffork_sequence, fenable_sliding_window_for_seq
     global fpopn, fbegin_forward, fend_forward
     global fself_attn, fcross_attn, fappend_mla_kv, fkv_merge_attn_output
     global fis_empty, fdebug_get_kv
-    global ftranspose_append, fcopy_cache, fmla_prefill, fmla_prefill_ragged
+    global ftranspose_append, fcopy_cache, fmla_prefill, fmla_prefill_sliding_window
+    global fmla_prefill_ragged
     global fmerge_state, fmerge_state_additional, fcopy_single_page
 
     fclear = tvm.get_global_func("vm.builtin.kv_state_clear")
     fadd_sequence = tvm.get_global_func("vm.builtin.kv_state_add_sequence")
     fremove_sequence = tvm.get_global_func("vm.builtin.kv_state_remove_sequence")
     ffork_sequence = tvm.get_global_func("vm.builtin.kv_state_fork_sequence")
+    fenable_sliding_window_for_seq = tvm.get_global_func(
+        "vm.builtin.attention_kv_cache_enable_sliding_window_for_seq"
+    )
     fpopn = tvm.get_global_func("vm.builtin.kv_state_popn")
     fbegin_forward = tvm.get_global_func("vm.builtin.kv_state_begin_forward")
     fend_forward = tvm.get_global_func("vm.builtin.kv_state_end_forward")
@@ -116,6 +122,9 @@ def set_global_func(dtype, target):
         _attention_prefill_mla(
             num_attention_heads, kv_lora_rank, qk_rope_head_dim, dtype, False, target
         ),
+        _attention_prefill_mla(
+            num_attention_heads, kv_lora_rank, qk_rope_head_dim, dtype, True, target
+        ),
         _attention_prefill_ragged(
             num_attention_heads,
             num_attention_heads,
@@ -139,6 +148,7 @@ def set_global_func(dtype, target):
         ftranspose_append,
         fcopy_cache,
         fmla_prefill,
+        fmla_prefill_sliding_window,
         fmla_prefill_ragged,
         fmerge_state,
         fmerge_state_additional,
@@ -146,7 +156,7 @@ def set_global_func(dtype, target):
     ) = builts
 
 
-def create_kv_cache(dtype):
+def create_kv_cache(dtype, support_sliding_window=False):
     fcreate = tvm.get_global_func("vm.builtin.paged_attention_kv_cache_create")
     fdumb = tvm.get_global_func("test.dumb_function")
     cache = fcreate(
@@ -156,7 +166,7 @@ def create_kv_cache(dtype):
                 maximum_total_seq_length,
                 prefill_chunk_size,
                 page_size,
-                0,
+                int(support_sliding_window),
             ]
         ),
         tvm_ffi.Shape([0, num_layers]),
@@ -176,7 +186,8 @@ def create_kv_cache(dtype):
         ["tirx", fmla_prefill_ragged],  # fattn_prefill_ragged
         [],  # fattn_prefill
         [],  # fattn_decode
-        [],  # fattn_prefill_sliding_window
+        # The sliding window MLA prefill takes the slot of fattn_prefill_sliding_window.
+        ["tirx", fmla_prefill_sliding_window] if support_sliding_window else [],
         [],  # fattn_decode_sliding_window
         [],  # fattn_prefill_with_tree_mask_paged_kv_cache
         [],  # fattn_prefill_with_tree_mask
@@ -219,6 +230,8 @@ def apply_attention(
     kv_cache,
     batch: list[tuple[int | tuple[int, int, int], int]],
     cached_kv: dict[int, torch.Tensor],
+    sliding_window_sizes: list[int] | None = None,
+    attn_sink_sizes: list[int] | None = None,
 ) -> None:
     seq_ids = []
     append_lengths = []
@@ -247,6 +260,7 @@ def apply_attention(
             )
 
     fbegin_forward(kv_cache, Shape(seq_ids), Shape(append_lengths), None)
+    is_decode_request = all(append_length == 1 for append_length in append_lengths)
 
     global_new_q = torch.zeros(
         (num_layers, 0, num_attention_heads, qk_nope_head_dim + qk_rope_head_dim),
@@ -260,7 +274,6 @@ def apply_attention(
     )
 
     q_array = []
-    is_decode_request = True
     all_new_sequences = True
     for i, (seq_id, append_length) in enumerate(batch):
         new_q_np = np.random.uniform(
@@ -284,12 +297,14 @@ def apply_attention(
 
         all_new_sequences = all_new_sequences and cached_kv[seq_id].shape[1] == 0
         cached_kv[seq_id] = torch.cat([cached_kv[seq_id], new_kv_tensor], dim=1)
+        if is_decode_request:
+            # Decode attends to the window after appending the new token.
+            cached_kv[seq_id] = _slide_window(
+                cached_kv[seq_id], seq_id, sliding_window_sizes, attn_sink_sizes
+            )
         global_new_q = torch.cat([global_new_q, new_q_tensor], dim=1)
         global_new_kv = torch.cat([global_new_kv, new_kv_tensor], dim=1)
 
-        if append_length > 1:
-            is_decode_request = False
-
     for layer_id in range(num_layers):
         queries = tvm.runtime.tensor(global_new_q[layer_id].cpu().numpy(), device)
         key_value = tvm.runtime.tensor(global_new_kv[layer_id].cpu().numpy(), device)
@@ -398,10 +413,29 @@ def apply_attention(
             sum_length += append_length
     fend_forward(kv_cache)
 
+    for seq_id in seq_ids:
+        cached_kv[seq_id] = _slide_window(
+            cached_kv[seq_id], seq_id, sliding_window_sizes, attn_sink_sizes
+        )
+
     # Verify
     verify_cached_kv(kv_cache, seq_ids, cached_kv)
 
 
+def _slide_window(kv, seq_id, sliding_window_sizes, attn_sink_sizes):
+    """Keep the attention sink and the most recent tokens of the sliding window of a sequence."""
+    if sliding_window_sizes is None or len(sliding_window_sizes) <= seq_id:
+        return kv
+    sliding_window_size = sliding_window_sizes[seq_id]
+    attn_sink_size = attn_sink_sizes[seq_id]
+    if sliding_window_size == 0 or kv.shape[1] <= sliding_window_size:
+        return kv
+    length_to_slide = kv.shape[1] - sliding_window_size
+    return torch.cat(
+        [kv[:, :attn_sink_size, ...], kv[:, attn_sink_size + length_to_slide :, ...]], dim=1
+    )
+
+
 @pytest.mark.gpu
 @pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
 def test_paged_attention_kv_cache_prefill_and_decode(kv_cache_and_config):
@@ -655,5 +689,63 @@ def test_paged_attention_kv_cache_popn(kv_cache_and_config):
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
+def test_paged_attention_kv_cache_sliding_window(kv_cache_and_config):
+    def run_and_check():
+        global device, w_kv, w_uk, w_uv
+        device = tvm.cuda()
+        (dtype,) = kv_cache_and_config
+        try:
+            w_kv = torch.empty(
+                (kv_lora_rank, num_attention_heads * (qk_nope_head_dim + v_head_dim)),
+                device=device_torch,
+                dtype=dtype_torch,
+            )
+            w_kv.uniform_(-0.1, 0.1)
+            w_uk, w_uv = torch.split(
+                w_kv.view(kv_lora_rank, num_attention_heads, qk_nope_head_dim + v_head_dim),
+                [qk_nope_head_dim, v_head_dim],
+                dim=2,
+            )
+            w_uk = w_uk.permute(1, 2, 0)
+            w_uv = w_uv.permute(1, 0, 2)
+            kv_cache = create_kv_cache(dtype, support_sliding_window=True)
+            fclear(kv_cache)
+
+            cached_kv = {}
+            sliding_window_sizes = [20, 25, 30, 35, 40]
+            attn_sink_sizes = [6, 4, 8, 3, 7]
+            for seq_id, (sliding_window_size, attn_sink_size) in enumerate(
+                zip(sliding_window_sizes, attn_sink_sizes)
+            ):
+                fadd_sequence(kv_cache, seq_id)
+                fenable_sliding_window_for_seq(
+                    kv_cache, seq_id, sliding_window_size, attn_sink_size
+                )
+                cached_kv[seq_id] = torch.zeros(
+                    (num_layers, 0, kv_lora_rank + qk_rope_head_dim),
+                    dtype=dtype_torch,
+                    device=device_torch,
+                )
+
+            # Prefill within and beyond the sliding windows.
+            operation_seq = [[(0, 12)], [(1, 18)], [(2, 28)], [(3, 15)], [(4, 31)]]
+            operation_seq += [[(0, 9), (1, 12), (3, 25)], [(2, 13), (4, 22)]]
+            # Decode across page boundaries, recycling the slidden pages.
+            for _ in range(40):
+                operation_seq.append([(seq_id, 1) for seq_id in range(5)])
+            operation_seq += [[(0, 33), (2, 7)], [(3, 44), (4, 16)]]
+            for batch in operation_seq:
+                apply_attention(kv_cache, batch, cached_kv, sliding_window_sizes, attn_sink_sizes)
+        finally:
+            device = None
+            w_kv = None
+            w_uk = None
+            w_uv = None
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
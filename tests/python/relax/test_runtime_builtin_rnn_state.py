@@ -206,6 +206,54 @@ def test_rnn_state_fork_sequence(rnn_state):  # pylint: disable=redefined-outer-
     tvm.testing.run_with_gpu_lock(run_and_check)
 
 
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
+def test_rnn_state_copy_on_write_fork(rnn_state):  # pylint: disable=redefined-outer-name
+    def run_and_check():
+        device = tvm.cuda()
+        state = rnn_state(device)
+        f_clear(state)
+        f_add_sequence(state, 0)
+        # The forks share the slot of the parent, so they are not bounded by the slots.
+        for seq_id in range(1, reserved_nseq + 2):
+            f_fork_sequence(state, 0, seq_id, -1)
+        for seq_id in range(2, reserved_nseq + 2):
+            f_remove_sequence(state, seq_id)
+        f_begin_forward(state, Shape([1]), Shape([1]))
+        f_set(state, 0, 0, tvm.runtime.tensor(np_two.reshape(1, 16, 16), device=device))
+        f_set(state, 0, 1, tvm.runtime.tensor(np_three.reshape(1, 32, 32), device=device))
+        f_end_forward(state)
+        verify_state(state, [0, 1], [[np_zero, np_one], [np_two, np_three]])
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda(), reason="need cuda")
+def test_rnn_state_slot_compaction(rnn_state):  # pylint: disable=redefined-outer-name
+    def run_and_check():
+        device = tvm.cuda()
+        state = rnn_state(device)
+        f_clear(state)
+        for seq_id in range(3):
+            f_add_sequence(state, seq_id)
+        f_begin_forward(state, Shape([2]), Shape([1]))
+        f_set(state, 0, 0, tvm.runtime.tensor(np_two.reshape(1, 16, 16), device=device))
+        f_set(state, 0, 1, tvm.runtime.tensor(np_three.reshape(1, 32, 32), device=device))
+        f_end_forward(state)
+        f_remove_sequence(state, 0)
+        # The sequence 2 is moved to the slot released by the sequence 0.
+        f_begin_forward(state, Shape([1, 2]), Shape([1, 1]))
+        f_end_forward(state)
+        f_popn(state, 1, 1)
+        f_popn(state, 2, 1)
+        verify_state(state, [1, 2], [None, [np_zero, np_one], [np_two, np_three]])
+        for seq_id in range(3, 3 + reserved_nseq - 2):
+            f_add_sequence(state, seq_id)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
 def rnn_state_get(
     shape: Sequence[int],
     dtype: str,
@@ -287,3 +335,5 @@ if __name__ == "__main__":
     test_rnn_state_set(rnn_state)
     test_rnn_state_popn(rnn_state)
     test_rnn_state_fork_sequence(rnn_state)
+    test_rnn_state_copy_on_write_fork(rnn_state)
+    test_rnn_state_slot_compaction(rnn_state)
@@ -179,5 +179,35 @@ def test_adam(lr, betas, eps, weight_decay):
     _test_optimizer(target, np_func, Adam, lr, betas, eps, weight_decay)
 
 
+@pytest.mark.parametrize(
+    "opt_type,args",
+    [
+        (SGD, (0.01, 0.02)),
+        (MomentumSGD, (0.01, 0.9, 0.85, 0.02, True)),
+        (Adam, (0.01, (0.8, 0.85), 1e-07, 0.1)),
+    ],
+)
+@pytest.mark.skipif(not tvm.testing.device_enabled("llvm"), reason="llvm not enabled")
+def test_fused_optimizer(opt_type, args):
+    target = "llvm"
+    x = relax.Var("x", R.Tensor((3, 3), "float32"))
+    y = relax.Var("y", R.Tensor((3,), "float32"))
+    z = relax.Var("z", R.Tensor((), "float32"))
+
+    def step_twice(fused):
+        opt = opt_type(*args, fused=fused).init([x, y, z])
+        mod = IRModule.from_expr(opt.get_function().with_attr("global_symbol", "main"))
+        tvm_func = _legalize_and_build(mod, target)["main"]
+        params, state = _numpy_to_tvm(param_arr), opt.state
+        for grads in grad_arrs:
+            params, state = tvm_func(params, _numpy_to_tvm(grads), state)
+        return _tvm_to_numpy(params)
+
+    shapes = [(3, 3), (3,), ()]
+    param_arr = [np.random.rand(*shape).astype(np.float32) for shape in shapes]
+    grad_arrs = [[np.random.rand(*shape).astype(np.float32) for shape in shapes] for _ in range(2)]
+    _assert_allclose_nested(step_twice(True), step_twice(False))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
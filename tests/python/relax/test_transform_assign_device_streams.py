@@ -0,0 +1,155 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.script import ir as I
+from tvm.script import relax as R
+from tvm.script import tirx as T
+
+
+# fmt: off
+@I.ir_module(s_tir=True)
+class Experts:
+    @T.prim_func(s_tir=True)
+    def expert(A: T.Buffer((T.int64(8),), "float32"), B: T.Buffer((T.int64(8),), "float32")):
+        for i in range(T.int64(8)):
+            with T.sblock("expert"):
+                vi = T.axis.spatial(T.int64(8), i)
+                T.reads(A[vi])
+                T.writes(B[vi])
+                B[vi] = A[vi] * T.float32(2)
+
+    @T.prim_func(s_tir=True)
+    def combine(A: T.Buffer((T.int64(8),), "float32"), B: T.Buffer((T.int64(8),), "float32"), C: T.Buffer((T.int64(8),), "float32")):
+        for i in range(T.int64(8)):
+            with T.sblock("combine"):
+                vi = T.axis.spatial(T.int64(8), i)
+                T.reads(A[vi], B[vi])
+                T.writes(C[vi])
+                C[vi] = A[vi] + B[vi]
+
+    @R.function
+    def main(x: R.Tensor((8,), dtype="float32")) -> R.Tensor((8,), dtype="float32"):
+        R.func_attr({"relax.force_pure": True})
+        cls = Experts
+        storage: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+        alloc: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+        _: R.Tuple = cls.expert(x, alloc)
+        storage1: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+        alloc1: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage1, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+        _1: R.Tuple = cls.expert(x, alloc1)
+        storage2: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+        alloc2: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage2, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+        _2: R.Tuple = cls.combine(alloc, alloc1, alloc2)
+        return alloc2
+# fmt: on
+
+
+def test_independent_branches():
+    # fmt: off
+    @I.ir_module(s_tir=True)
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def expert(A: T.Buffer((T.int64(8),), "float32"), B: T.Buffer((T.int64(8),), "float32")):
+            for i in range(T.int64(8)):
+                with T.sblock("expert"):
+                    vi = T.axis.spatial(T.int64(8), i)
+                    T.reads(A[vi])
+                    T.writes(B[vi])
+                    B[vi] = A[vi] * T.float32(2)
+
+        @T.prim_func(s_tir=True)
+        def combine(A: T.Buffer((T.int64(8),), "float32"), B: T.Buffer((T.int64(8),), "float32"), C: T.Buffer((T.int64(8),), "float32")):
+            for i in range(T.int64(8)):
+                with T.sblock("combine"):
+                    vi = T.axis.spatial(T.int64(8), i)
+                    T.reads(A[vi], B[vi])
+                    T.writes(C[vi])
+                    C[vi] = A[vi] + B[vi]
+
+        @R.function
+        def main(x: R.Tensor((8,), dtype="float32")) -> R.Tensor((8,), dtype="float32"):
+            R.func_attr({"relax.force_pure": True})
+            cls = Expected
+            storage: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+            alloc: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+            _: R.Tuple = cls.expert(x, alloc)
+            storage1: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+            alloc1: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage1, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+            _3: R.Tuple = R.call_builtin_with_ctx("vm.builtin.device_stream.wait", (R.prim_value(0), R.prim_value(0), R.prim_value(1)), ty_args=(R.Tuple,))
+            _4: R.Tuple = R.call_builtin_with_ctx("vm.builtin.device_stream.set_current", (R.prim_value(0), R.prim_value(1)), ty_args=(R.Tuple,))
+            _1: R.Tuple = cls.expert(x, alloc1)
+            storage2: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+            alloc2: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage2, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+            _2: R.Tuple = cls.combine(alloc, alloc1, alloc2)
+            _5: R.Tuple = R.call_builtin_with_ctx("vm.builtin.device_stream.join", (R.prim_value(0), R.shape([1]), x, storage, storage1, storage2), ty_args=(R.Tuple,))
+            return alloc2
+    # fmt: on
+
+    with tvm.transform.PassContext(config={"relax.backend.num_device_streams": 2}):
+        after = relax.transform.AssignDeviceStreams()(Experts)
+    tvm.ir.assert_structural_equal(after, Expected)
+
+
+def test_single_stream():
+    with tvm.transform.PassContext(config={"relax.backend.num_device_streams": 1}):
+        after = relax.transform.AssignDeviceStreams()(Experts)
+    tvm.ir.assert_structural_equal(after, Experts)
+
+
+def test_disabled_with_cuda_graph():
+    config = {"relax.backend.num_device_streams": 2, "relax.backend.use_cuda_graph": True}
+    with tvm.transform.PassContext(config=config):
+        after = relax.transform.AssignDeviceStreams()(Experts)
+    tvm.ir.assert_structural_equal(after, Experts)
+
+
+def test_dependent_chain():
+    # fmt: off
+    @I.ir_module(s_tir=True)
+    class Before:
+        @T.prim_func(s_tir=True)
+        def expert(A: T.Buffer((T.int64(8),), "float32"), B: T.Buffer((T.int64(8),), "float32")):
+            for i in range(T.int64(8)):
+                with T.sblock("expert"):
+                    vi = T.axis.spatial(T.int64(8), i)
+                    T.reads(A[vi])
+                    T.writes(B[vi])
+                    B[vi] = A[vi] * T.float32(2)
+
+        @R.function
+        def main(x: R.Tensor((8,), dtype="float32")) -> R.Tensor((8,), dtype="float32"):
+            R.func_attr({"relax.force_pure": True})
+            cls = Before
+            storage: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+            alloc: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+            _: R.Tuple = cls.expert(x, alloc)
+            storage1: R.Any = R.memory.alloc_storage(R.shape([32]), R.prim_value(0), R.str("global"), R.dtype("uint8"))
+            alloc1: R.Tensor((8,), dtype="float32") = R.memory.alloc_tensor(storage1, R.prim_value(0), R.shape([8]), R.dtype("float32"))
+            _1: R.Tuple = cls.expert(alloc, alloc1)
+            return alloc1
+    # fmt: on
+
+    with tvm.transform.PassContext(config={"relax.backend.num_device_streams": 2}):
+        after = relax.transform.AssignDeviceStreams()(Before)
+    tvm.ir.assert_structural_equal(after, Before)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -0,0 +1,78 @@
+# isort: skip_file
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.script import ir as I
+from tvm.script import relax as R
+
+
+def _get_mod(out_features=32, in_features=64, sparse=True):
+    @I.ir_module
+    class Module:
+        @R.function
+        def main(
+            x: R.Tensor(("n", in_features), "float32"),
+            w: R.Tensor((out_features, in_features), "float32"),
+        ):
+            R.func_attr({"num_input": 1, "sparse_2_4_params": ["w"] if sparse else []})
+            with R.dataflow():
+                wT = R.permute_dims(w, [1, 0])
+                o = R.matmul(x, wT)
+                R.output(o)
+            return o
+
+    return Module
+
+
+def _count_calls(func, name):
+    count = 0
+
+    def fvisit(expr):
+        nonlocal count
+        if isinstance(expr, relax.Call) and isinstance(expr.op, tvm.ir.Op):
+            count += expr.op.name == name
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return count
+
+
+def test_annotated_weight_is_compressed_in_transform_params():
+    mod = relax.transform.CompressSparseWeights()(_get_mod())
+    assert _count_calls(mod["main"], "relax.matmul") == 0
+    assert _count_calls(mod["main"], "relax.sparse.compress_2_4") == 1
+    assert _count_calls(mod["main"], "relax.sparse.matmul_2_4") == 1
+
+    mod = relax.transform.LiftTransformParams()(mod)
+    # Only the sparse matmul is left at inference; the compression moves to the weight transform.
+    assert _count_calls(mod["main"], "relax.sparse.compress_2_4") == 0
+    assert _count_calls(mod["main"], "relax.sparse.matmul_2_4") == 1
+    assert _count_calls(mod["main_transform_params"], "relax.sparse.compress_2_4") == 1
+
+
+def test_unannotated_weight_unchanged():
+    mod = _get_mod(sparse=False)
+    tvm.ir.assert_structural_equal(relax.transform.CompressSparseWeights()(mod), mod)
+
+
+def test_non_tile_multiple_weight_unchanged():
+    mod = _get_mod(out_features=24)
+    tvm.ir.assert_structural_equal(relax.transform.CompressSparseWeights()(mod), mod)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
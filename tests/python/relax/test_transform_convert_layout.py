@@ -77,6 +77,43 @@ def test_conv2d():
     verify(Input, Input, {"relax.nn.conv2d": ["NHWC4c", "OHWI4o"]})
 
 
+def test_conv2d_plan_globally():
+    @I.ir_module
+    class Input:
+        @R.function
+        def main(
+            x: R.Tensor((2, 3, 28, 28), "float32"), w: R.Tensor((4, 3, 3, 3), "float32")
+        ) -> R.Tensor(None, "float32", ndim=4):
+            with R.dataflow():
+                lv: R.Tensor((2, 3, 28, 28), "float32") = R.nn.relu(x)
+                lv1: R.Tensor((2, 4, 26, 26), "float32") = R.nn.conv2d(lv, w, out_dtype="float32")
+                gv: R.Tensor((2, 4, 26, 26), "float32") = R.nn.softmax(lv1, axis=1)
+                R.output(gv)
+            return gv
+
+    desired_layouts = {"relax.nn.conv2d": ["NHWC", "OHWI"]}
+    # Converting the lone conv2d costs a transform of its input and of its output for a gain of
+    # one, so the planner keeps it in its own layout.
+    with tvm.transform.PassContext(config={"relax.ConvertLayout.plan_globally": True}):
+        mod = ConvertLayout(desired_layouts)(Input)
+    tvm.ir.assert_structural_equal(Normalize()(mod), Input)
+
+    # When the conv2d gains more than the two transforms cost, it is converted as without
+    # planning.
+    @tvm.register_global_func("testing.convert_layout_gain", override=True)
+    def _gain(call, desired_layouts):
+        return 4.0
+
+    config = {
+        "relax.ConvertLayout.plan_globally": True,
+        "relax.ConvertLayout.cost_hook": "testing.convert_layout_gain",
+    }
+    with tvm.transform.PassContext(config=config):
+        mod = ConvertLayout(desired_layouts)(Input)
+    expected = Normalize()(ConvertLayout(desired_layouts)(Input))
+    tvm.ir.assert_structural_equal(Normalize()(mod), expected)
+
+
 def test_conv2d_onlydim():
     @I.ir_module
     class Input:
@@ -0,0 +1,156 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relax
+
+
+def _qdq_matmul(w_scale, bias=True, relu=True):
+    a_scale, a_zp = 0.02, 3
+    y_scale, y_zp = 0.05, -4
+    w_np = np.random.randint(-127, 128, size=(16, 8)).astype("int8")
+    bias_np = np.random.randint(-500, 500, size=(8,)).astype("int32")
+
+    bb = relax.BlockBuilder()
+    a = relax.Var("a", relax.TensorType((4, 16), "uint8"))
+    with bb.function("main", [a]):
+        with bb.dataflow():
+            dq_a = bb.emit(
+                relax.op.dequantize(
+                    a, relax.const(a_scale, "float32"), relax.const(a_zp, "uint8"), axis=1
+                )
+            )
+            dq_w = bb.emit(
+                relax.op.dequantize(
+                    relax.const(w_np),
+                    relax.const(np.array(w_scale, "float32")),
+                    relax.const(0, "int8"),
+                    axis=1,
+                )
+            )
+            out = bb.emit(relax.op.matmul(dq_a, dq_w))
+            if bias:
+                dq_bias = bb.emit(
+                    relax.op.dequantize(
+                        relax.const(bias_np),
+                        relax.const(np.array(w_scale, "float32") * a_scale),
+                        relax.const(0, "int32"),
+                        axis=0,
+                    )
+                )
+                out = bb.emit(relax.op.add(out, dq_bias))
+            if relu:
+                out = bb.emit(relax.op.nn.relu(out))
+            q = bb.emit_output(
+                relax.op.quantize(
+                    out, relax.const(y_scale, "float32"), relax.const(y_zp, "int8"), axis=1
+                )
+            )
+        bb.emit_func_output(q)
+    return bb.get()
+
+
+def _count_calls(func, op_name):
+    count = 0
+
+    def fvisit(expr):
+        nonlocal count
+        if isinstance(expr, relax.Call) and isinstance(expr.op, tvm.ir.Op):
+            count += expr.op.name == op_name
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return count
+
+
+def _run(mod, a_np):
+    ex = tvm.compile(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    return vm["main"](tvm.runtime.tensor(a_np)).numpy()
+
+
+def test_matmul_bias_relu():
+    mod = _qdq_matmul(0.01)
+    after = relax.transform.FakeQuantizationToInteger()(mod)
+    assert _count_calls(after["main"], "relax.dequantize") == 0
+    assert _count_calls(after["main"], "relax.quantize") == 0
+    assert _count_calls(after["main"], "relax.matmul") == 1
+
+
+@tvm.testing.requires_llvm
+def test_matmul_matches_float_path():
+    w_scale = np.linspace(0.005, 0.02, 8).astype("float32")
+    for bias, relu in [(False, False), (True, False), (True, True)]:
+        mod = _qdq_matmul(w_scale, bias=bias, relu=relu)
+        after = relax.transform.FakeQuantizationToInteger()(mod)
+        assert _count_calls(after["main"], "relax.dequantize") == 0
+        a_np = np.random.randint(0, 256, size=(4, 16)).astype("uint8")
+        expected = _run(mod, a_np).astype("int32")
+        actual = _run(after, a_np).astype("int32")
+        # Rounding the rescale in fixed point may differ from float by one step.
+        assert np.max(np.abs(expected - actual)) <= 1
+
+
+@tvm.testing.requires_llvm
+def test_requantize():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", relax.TensorType((2, 8), "int8"))
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            dq = bb.emit(
+                relax.op.dequantize(x, relax.const(0.1, "float32"), relax.const(2, "int8"), axis=1)
+            )
+            q = bb.emit_output(
+                relax.op.quantize(
+                    dq,
+                    relax.const(0.03, "float32"),
+                    relax.const(128, "uint8"),
+                    axis=1,
+                    out_dtype="uint8",
+                )
+            )
+        bb.emit_func_output(q)
+    mod = bb.get()
+    after = relax.transform.FakeQuantizationToInteger()(mod)
+    assert _count_calls(after["main"], "relax.dequantize") == 0
+
+    x_np = np.random.randint(-128, 128, size=(2, 8)).astype("int8")
+    expected = _run(mod, x_np).astype("int32")
+    actual = _run(after, x_np).astype("int32")
+    assert np.max(np.abs(expected - actual)) <= 1
+
+
+def test_non_constant_scale_unchanged():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", relax.TensorType((2, 8), "int8"))
+    scale = relax.Var("scale", relax.TensorType((), "float32"))
+    with bb.function("main", [x, scale]):
+        with bb.dataflow():
+            dq = bb.emit(relax.op.dequantize(x, scale, relax.const(0, "int8"), axis=1))
+            q = bb.emit_output(
+                relax.op.quantize(dq, relax.const(0.03, "float32"), relax.const(0, "int8"))
+            )
+        bb.emit_func_output(q)
+    mod = bb.get()
+    after = relax.transform.FakeQuantizationToInteger()(mod)
+    tvm.ir.assert_structural_equal(mod, after)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
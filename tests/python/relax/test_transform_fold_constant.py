@@ -608,5 +608,105 @@ def test_call_tir_with_primitive_args_not_folded():
     tvm.ir.assert_structural_equal(after, Module)
 
 
+def test_fold_chain_of_large_functions():
+    """The large functions of a constant chain are built in one module ahead of folding."""
+
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def addone(A: T.Buffer((64, 128), "float32"), B: T.Buffer((64, 128), "float32")) -> None:
+            for i, j in T.grid(64, 128):
+                with T.sblock("addone"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @T.prim_func(s_tir=True)
+        def double(A: T.Buffer((64, 128), "float32"), B: T.Buffer((64, 128), "float32")) -> None:
+            for i, j in T.grid(64, 128):
+                with T.sblock("double"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] * T.float32(2)
+
+        @R.function
+        def before(c0: R.Tensor((64, 128), "float32")):
+            cls = Module
+            lv0 = relax.call_tir(cls.addone, (c0,), R.Tensor((64, 128), dtype="float32"))
+            lv1 = relax.call_tir(cls.double, (lv0,), R.Tensor((64, 128), dtype="float32"))
+            lv2 = relax.call_tir(cls.addone, (lv1,), R.Tensor((64, 128), dtype="float32"))
+            return lv2
+
+        @R.function
+        def expected(c1: R.Tensor((64, 128), "float32")):
+            return c1
+
+    c0_np = np.arange(64 * 128).astype("float32").reshape(64, 128)
+    c1_np = (c0_np + 1) * 2 + 1
+    before = gen_mod(Module, "before", {"c0": c0_np})
+    expected = gen_mod(Module, "expected", {"c1": c1_np})
+
+    after = relax.transform.FoldConstant()(before)
+    tvm.ir.assert_structural_equal(after, expected)
+
+
+def test_fold_tiny_integer_arith():
+    """Tiny folds are interpreted with the wrap-around and floor semantics of the compiled code."""
+
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def func(A: T.Buffer((16,), "int32"), B: T.Buffer((16,), "int8")) -> None:
+            for i in range(16):
+                with T.sblock("compute"):
+                    vi = T.axis.remap("S", [i])
+                    B[vi] = T.Cast("int8", A[vi] * 20) + T.Cast(
+                        "int8", T.floordiv(A[vi], 3) + T.floormod(A[vi], 3)
+                    )
+
+        @R.function
+        def before(c0: R.Tensor((16,), "int32")):
+            cls = Module
+            lv0 = relax.call_tir(cls.func, (c0,), R.Tensor((16,), dtype="int8"))
+            return lv0
+
+        @R.function
+        def expected(c1: R.Tensor((16,), "int8")):
+            return c1
+
+    c0_np = np.arange(-8, 8).astype("int32")
+    c1_np = (c0_np * 20).astype("int8") + (c0_np // 3 + c0_np % 3).astype("int8")
+    before = gen_mod(Module, "before", {"c0": c0_np})
+    expected = gen_mod(Module, "expected", {"c1": c1_np})
+
+    after = relax.transform.FoldConstant()(before)
+    tvm.ir.assert_structural_equal(after, expected)
+
+
+def test_fold_tiny_function_beyond_interpreter():
+    """Tiny folds the interpreter does not support, such as math intrinsics, are compiled."""
+
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def func(A: T.Buffer((4, 4), "float32"), B: T.Buffer((4, 4), "float32")) -> None:
+            for i, j in T.grid(4, 4):
+                with T.sblock("exp"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.exp(A[vi, vj])
+
+        @R.function
+        def before(c0: R.Tensor((4, 4), "float32")):
+            cls = Module
+            lv0 = relax.call_tir(cls.func, (c0,), R.Tensor((4, 4), dtype="float32"))
+            return lv0
+
+    c0_np = np.linspace(-1, 1, 16).astype("float32").reshape(4, 4)
+    before = gen_mod(Module, "before", {"c0": c0_np})
+
+    after = relax.transform.FoldConstant()(before)
+    folded = after["main"].body.body
+    assert isinstance(folded, relax.Constant)
+    tvm.testing.assert_allclose(folded.data.numpy(), np.exp(c0_np), rtol=1e-5)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -73,6 +73,66 @@ def test_fuse_simple():
     _check(before(), expected())
 
 
+def _num_fused_functions(mod):
+    return sum(
+        1
+        for func in mod.functions.values()
+        if isinstance(func, relax.Function) and func.attrs and "Primitive" in func.attrs
+    )
+
+
+def test_fuse_cost_hook():
+    """The cost hook sees the intermediate tensor sizes and can refuse fusions."""
+
+    def before():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", R.Tensor([10, 20], "float32"))
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                lv0 = bb.emit_te(topi.add, x, relax.const(1, "float32"))
+                lv1 = bb.emit_te(topi.exp, lv0)
+                gv = bb.emit_output(bb.call_te(topi.squeeze, lv1))
+            bb.emit_func_output(gv)
+
+        return bb.get()
+
+    calls = []
+
+    @tvm.register_global_func("testing.fuse_ops_refuse_all", override=True)
+    def refuse_all(lhs, rhs, num_bytes, horizontal):
+        calls.append((lhs.name_hint, rhs.name_hint, num_bytes, horizontal))
+        return False
+
+    mod = relax.transform.AnnotateTIROpPattern()(before())
+    with tvm.transform.PassContext(config={"relax.FuseOps.cost_hook": "testing.fuse_ops_refuse_all"}):
+        mod = relax.transform.FuseOps()(mod)
+    assert _num_fused_functions(mod) == 0
+    assert ("lv", "lv1", 10 * 20 * 4, False) in calls
+
+
+def test_horizontal_fuse_siblings():
+    """Sibling elementwise ops that read the same input are fused horizontally."""
+
+    def before():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", R.Tensor([10, 20], "float32"))
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                lv0 = bb.emit_te(topi.add, x, relax.const(1, "float32"))
+                lv1 = bb.emit_te(topi.exp, lv0)
+                lv2 = bb.emit_te(topi.log, lv0)
+                gv = bb.emit_output(relax.Tuple([lv1, lv2]))
+            bb.emit_func_output(gv)
+
+        return bb.get()
+
+    mod = relax.transform.AnnotateTIROpPattern()(before())
+    assert _num_fused_functions(relax.transform.FuseOps()(mod)) == 0
+    with tvm.transform.PassContext(config={"relax.FuseOps.horizontal": True}):
+        fused = relax.transform.FuseOps()(mod)
+    assert _num_fused_functions(fused) == 1
+
+
 def test_conv2d_fuse():
     """Test fusion case of conv2d"""
 
@@ -0,0 +1,110 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.script import ir as I
+from tvm.script import relax as R
+
+
+@I.ir_module
+class Linear:
+    @R.function
+    def main(
+        x: R.Tensor((1, 64), "float32"),
+        w: R.Tensor((16, 64), "float32"),
+    ) -> R.Tensor((1, 16), "float32"):
+        R.func_attr({"num_input": 1})
+        with R.dataflow():
+            wT = R.permute_dims(w, [1, 0])
+            o = R.matmul(x, wT)
+            R.output(o)
+        return o
+
+
+def _count_calls(func, name):
+    count = 0
+
+    def fvisit(expr):
+        nonlocal count
+        if isinstance(expr, relax.Call) and isinstance(expr.op, tvm.ir.Op):
+            count += expr.op.name == name
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return count
+
+
+def _reference(w_np, bits, group_size, symmetric):
+    """The weight as decoded after grouped quantization along its last axis."""
+    max_q = (1 << bits) - 1
+    groups = w_np.reshape(w_np.shape[0], -1, group_size)
+    if symmetric:
+        zero = max_q // 2
+        scale = np.maximum(np.abs(groups).max(axis=-1, keepdims=True), 1e-6) / zero
+    else:
+        low, high = groups.min(axis=-1, keepdims=True), groups.max(axis=-1, keepdims=True)
+        scale = np.maximum(high - low, 1e-6) / max_q
+        zero = np.clip(np.round(-low / scale), 0, max_q)
+    q = np.clip(np.round(groups / scale) + zero, 0, max_q)
+    return ((q - zero) * scale).reshape(w_np.shape)
+
+
+def test_parameter_weight_is_encoded_in_transform_params():
+    mod = relax.transform.GroupQuantizeWeights(bits=4, group_size=32)(Linear)
+    assert _count_calls(mod["main"], "relax.matmul") == 0
+    assert _count_calls(mod["main"], "relax.call_tir") == 2
+
+    mod = relax.transform.LiftTransformParams()(mod)
+    # Only the decode-matmul is left at inference; the encoding moves to the weight transform.
+    assert _count_calls(mod["main"], "relax.call_tir") == 1
+    assert _count_calls(mod["main_transform_params"], "relax.call_tir") == 1
+
+
+def test_non_divisible_reduction_unchanged():
+    mod = relax.transform.GroupQuantizeWeights(bits=4, group_size=48)(Linear)
+    tvm.ir.assert_structural_equal(mod, Linear)
+
+
+def test_invalid_group_size():
+    with pytest.raises(ValueError):
+        relax.transform.GroupQuantizeWeights(bits=4, group_size=12)
+
+
+@tvm.testing.requires_llvm
+@pytest.mark.parametrize("bits, symmetric", [(4, True), (4, False), (8, True), (8, False)])
+def test_constant_weight_numerics(bits, symmetric):
+    np.random.seed(0)
+    x_np = np.random.uniform(-1, 1, size=(1, 64)).astype("float32")
+    w_np = np.random.uniform(-1, 1, size=(16, 64)).astype("float32")
+    mod = relax.transform.BindParams("main", {"w": w_np})(Linear)
+    mod = relax.transform.GroupQuantizeWeights(bits=bits, group_size=32, symmetric=symmetric)(mod)
+    mod = relax.transform.FoldConstant()(mod)
+    assert _count_calls(mod["main"], "relax.call_tir") == 1
+
+    ex = tvm.compile(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    res = vm["main"](tvm.runtime.tensor(x_np)).numpy()
+    expected = x_np @ _reference(w_np, bits, 32, symmetric).T
+    tvm.testing.assert_allclose(res, expected, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
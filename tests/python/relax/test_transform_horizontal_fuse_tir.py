@@ -0,0 +1,110 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# ruff: noqa: E501, F841
+
+import tvm
+import tvm.testing
+from tvm import relax, tirx
+from tvm.script import ir as I
+from tvm.script import relax as R
+from tvm.script import tirx as T
+
+
+# fmt: off
+@I.ir_module(s_tir=True)
+class Module:
+    @T.prim_func(s_tir=True, private=True)
+    def exp(A: T.Buffer((T.int64(2), T.int64(4)), "float32"), B: T.Buffer((T.int64(2), T.int64(4)), "float32")):
+        T.func_attr({"tirx.noalias": True})
+        for i_0 in T.thread_binding(T.int64(1), thread="blockIdx.x"):
+            for i_1 in T.thread_binding(T.int64(8), thread="threadIdx.x"):
+                with T.sblock("compute"):
+                    v0 = T.axis.spatial(T.int64(2), (i_0 * T.int64(8) + i_1) // T.int64(4))
+                    v1 = T.axis.spatial(T.int64(4), (i_0 * T.int64(8) + i_1) % T.int64(4))
+                    B[v0, v1] = T.exp(A[v0, v1])
+
+    @T.prim_func(s_tir=True, private=True)
+    def add_one(A: T.Buffer((T.int64(16),), "float32"), B: T.Buffer((T.int64(16),), "float32")):
+        T.func_attr({"tirx.noalias": True})
+        for i_0 in T.thread_binding(T.int64(2), thread="blockIdx.x"):
+            for i_1 in T.thread_binding(T.int64(8), thread="threadIdx.x"):
+                with T.sblock("compute"):
+                    v0 = T.axis.spatial(T.int64(16), i_0 * T.int64(8) + i_1)
+                    B[v0] = A[v0] + T.float32(1)
+
+    @R.function
+    def main(x: R.Tensor((2, 4), dtype="float32"), y: R.Tensor((16,), dtype="float32")):
+        cls = Module
+        with R.dataflow():
+            a = R.call_tir(cls.exp, (x,), out_ty=R.Tensor((2, 4), dtype="float32"))
+            b = R.call_tir(cls.add_one, (y,), out_ty=R.Tensor((16,), dtype="float32"))
+            c = R.call_tir(cls.exp, (x,), out_ty=R.Tensor((2, 4), dtype="float32"))
+            d = R.call_tir(cls.exp, (a,), out_ty=R.Tensor((2, 4), dtype="float32"))
+            gv = (b, c, d)
+            R.output(gv)
+        return gv
+# fmt: on
+
+
+def _call_tir_callees(func):
+    callees = []
+
+    def fvisit(expr):
+        if isinstance(expr, relax.Call) and expr.op == tvm.ir.Op.get("relax.call_tir"):
+            callees.append(expr.args[0].name_hint)
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return callees
+
+
+def _block_loops(func):
+    loops = []
+
+    def fvisit(stmt):
+        if isinstance(stmt, tirx.For) and stmt.kind == tirx.ForKind.THREAD_BINDING:
+            if stmt.thread_binding.thread_tag == "blockIdx.x":
+                loops.append(stmt)
+
+    tirx.stmt_functor.post_order_visit(func.body, fvisit)
+    return loops
+
+
+def test_merge_independent_kernels():
+    after = relax.transform.HorizontalFuseTIR()(Module)
+    callees = _call_tir_callees(after["main"])
+    # The three calls at the first level share a launch; `d` depends on `a`.
+    assert len(callees) == 2
+    merged = after[callees[0]]
+    assert callees[1] == "exp"
+    assert len(merged.params) == 6
+    (loop,) = _block_loops(merged)
+    assert loop.extent.value == 4
+    assert "global_symbol" not in merged.attrs
+
+
+def test_max_num_blocks():
+    after = relax.transform.HorizontalFuseTIR(max_num_blocks=1)(Module)
+    callees = _call_tir_callees(after["main"])
+    # `add_one` launches two blocks, leaving the two level-one `exp` calls to be merged.
+    assert len(callees) == 3
+    assert "add_one" in callees
+    (loop,) = _block_loops(after[callees[0]])
+    assert loop.extent.value == 2
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
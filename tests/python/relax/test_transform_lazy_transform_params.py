@@ -15,11 +15,15 @@
 # specific language governing permissions and limitations
 # under the License.
 # ruff: noqa: F841
+import os
+import tempfile
+
 import numpy as np
 
 import tvm
 import tvm.testing
 from tvm import relax
+from tvm.contrib import tvmjs
 from tvm.relax.transform import LazyTransformParams
 from tvm.script import ir as I
 from tvm.script import relax as R
@@ -667,6 +671,57 @@ def test_output():
         tvm.testing.assert_allclose(expected_i, transformed_i)
 
 
+def test_stream_transform_params():
+    target = "llvm"
+    dev = tvm.cpu()
+
+    @I.ir_module(s_tir=True)
+    class TransformModule:
+        @R.function
+        def transform_params(
+            params: R.Tuple(
+                R.Tensor((64, 64), dtype="float32"),
+                R.Tensor((64, 64), dtype="float32"),
+            ),
+        ) -> R.Tuple(R.Tensor((64, 64), dtype="float32"), R.Tensor((64, 64), dtype="float32")):
+            R.func_attr({"relax.force_pure": True})
+            param0 = params[0]
+            param1 = params[1]
+            transformed0 = R.permute_dims(param0, [1, 0])
+            transformed1 = R.add(param1, R.const(1, "float32"))
+            transformed = (transformed0, transformed1)
+            return transformed
+
+    mod = relax.transform.LazyTransformParams()(TransformModule)
+    mod = relax.transform.LegalizeOps()(mod)
+    built = tvm.compile(mod, target=target)
+    vm = relax.VirtualMachine(built, dev)
+
+    params = {
+        "w0": np.random.random(size=(64, 64)).astype("float32"),
+        "w1": np.random.random(size=(64, 64)).astype("float32"),
+    }
+    with tempfile.TemporaryDirectory(prefix="tvm_") as temp_dir:
+        src_dir = os.path.join(temp_dir, "src")
+        out_dir = os.path.join(temp_dir, "out")
+        # One shard per raw parameter
+        tvmjs.dump_tensor_cache(
+            params, src_dir, encode_format="raw", shard_cap_mb=0.02, show_progress=False
+        )
+        tvmjs.stream_transform_params(
+            vm["transform_params"],
+            input_names=["w0", "w1"],
+            output_names=["w0_t", "w1_t"],
+            src_cache_dir=src_dir,
+            cache_dir=out_dir,
+            device=dev,
+        )
+        transformed, _ = tvmjs.load_tensor_cache(out_dir, dev)
+
+    tvm.testing.assert_allclose(transformed["w0_t"].numpy(), params["w0"].T)
+    tvm.testing.assert_allclose(transformed["w1_t"].numpy(), params["w1"] + 1)
+
+
 def test_duplicate_outputs():
     """A tensor may be repeated in the output
 
@@ -20,7 +20,7 @@ import pytest
 
 import tvm
 import tvm.testing
-from tvm import relax
+from tvm import relax, topi
 from tvm.relax.transform import LegalizeOps
 from tvm.relax.transform.legalize_ops.common import register_legalize
 from tvm.script import ir as I
@@ -436,5 +436,48 @@ def test_legalize_with_vdevice():
     tvm.ir.assert_structural_equal(Expected, After)
 
 
+def test_legalize_reuses_identical_calls():
+    """Identical op instances are legalized once and share a PrimFunc"""
+
+    @I.ir_module
+    class Before:
+        @R.function
+        def main(
+            x: R.Tensor((2, 3), "float32"),
+            y: R.Tensor((2, 3), "float32"),
+            z: R.Tensor((3, 2), "float32"),
+        ):
+            a = R.add(x, y)
+            b = R.add(a, y)
+            c = R.add(b, b)
+            d = R.add(c, a)
+            e = R.add(z, z)
+            return (d, e)
+
+    num_legalized = 0
+
+    def counting_legalize_add(bb: relax.BlockBuilder, call: relax.Call):
+        nonlocal num_legalized
+        num_legalized += 1
+        return bb.call_te(topi.add, call.args[0], call.args[1])
+
+    After = LegalizeOps({"relax.add": counting_legalize_add})(Before)
+
+    # One legalization for distinct arguments, one for a repeated
+    # argument, and one for the differently-shaped call.
+    assert num_legalized == 3
+    x, y, z = Before["main"].params
+    bindings = After["main"].body.blocks[0].bindings
+    a, b, c = (binding.var for binding in bindings[:3])
+    expected_args = [(x, y), (a, y), (b, b), (c, a), (z, z)]
+    for binding, args in zip(bindings, expected_args):
+        fields = binding.value.args[1].fields
+        assert len(fields) == len(args)
+        assert all(field.same_as(arg) for field, arg in zip(fields, args))
+
+    gvars = [binding.value.args[0] for binding in bindings]
+    assert gvars[0].same_as(gvars[1]) and gvars[0].same_as(gvars[3])
+    assert not gvars[0].same_as(gvars[4])
+
 if __name__ == "__main__":
     tvm.testing.main()
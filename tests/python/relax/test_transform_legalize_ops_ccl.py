@@ -76,6 +76,50 @@ def test_allgather():
     tvm.ir.assert_structural_equal(mod, Expected)
 
 
+def test_alltoall():
+    # fmt: off
+    @tvm.script.ir_module
+    class AllToAll:
+        @R.function
+        def main(x: R.Tensor((8, 10), "float32"))  -> R.Tensor((8, 10), "float32"):
+            gv0: R.Tensor((8, 10), "float32") = R.ccl.alltoall(x, 2)
+            return gv0
+
+    @I.ir_module(s_tir=True)
+    class Expected:
+        @R.function
+        def main(x: R.Tensor((8, 10), dtype="float32")) -> R.Tensor((8, 10), dtype="float32"):
+            gv0: R.Tensor((8, 10), dtype="float32") = R.call_dps_packed("runtime.disco.alltoall", [x, True], out_ty=R.Tensor((8, 10), dtype="float32"))
+            return gv0
+    # fmt: on
+
+    mod = LegalizeOps()(AllToAll)
+    tvm.ir.assert_structural_equal(mod, Expected)
+
+
+def test_reducescatter():
+    # fmt: off
+    @tvm.script.ir_module
+    class ReduceScatter:
+        @R.function
+        def main(x: R.Tensor((8, 10), "float32"))  -> R.Tensor((4, 10), "float32"):
+            gv0: R.Tensor((4, 10), "float32") = R.ccl.reducescatter(x, "sum", 2)
+            gv1: R.Tensor((4, 10), "float32") = R.ccl.reducescatter(x, "avg", 2, in_group=False)
+            return gv0
+
+    @I.ir_module(s_tir=True)
+    class Expected:
+        @R.function
+        def main(x: R.Tensor((8, 10), dtype="float32")) -> R.Tensor((4, 10), dtype="float32"):
+            gv0: R.Tensor((4, 10), dtype="float32") = R.call_dps_packed("runtime.disco.reducescatter", [x, R.shape([0]), True], out_ty=R.Tensor((4, 10), dtype="float32"))
+            gv1: R.Tensor((4, 10), dtype="float32") = R.call_dps_packed("runtime.disco.reducescatter", [x, R.shape([4]), False], out_ty=R.Tensor((4, 10), dtype="float32"))
+            return gv0
+    # fmt: on
+
+    mod = LegalizeOps()(ReduceScatter)
+    tvm.ir.assert_structural_equal(mod, Expected)
+
+
 def test_broadcast_from_zero():
     # fmt: off
     @tvm.script.ir_module
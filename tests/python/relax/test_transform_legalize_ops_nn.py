@@ -17,10 +17,12 @@
 # ruff: noqa: E501, F821, F841
 
 
+import numpy as np
 import pytest
 
 import tvm
 import tvm.testing
+from tvm import relax
 from tvm.relax.transform import LegalizeOps
 from tvm.script import ir as I
 from tvm.script import relax as R
@@ -4255,5 +4257,96 @@ def test_dropout():
     tvm.ir.assert_structural_equal(mod, Expected)
 
 
+def _embedding_bag_ref(weight, indices, offsets, per_sample_weights, mode):
+    bounds = list(offsets) + [len(indices)]
+    out = np.zeros((len(offsets), weight.shape[1]), weight.dtype)
+    for b in range(len(offsets)):
+        bag = range(bounds[b], bounds[b + 1])
+        if len(bag) == 0:
+            continue
+        rows = weight[indices[bag.start : bag.stop]]
+        if per_sample_weights is not None:
+            rows = rows * per_sample_weights[bag.start : bag.stop, None]
+        out[b] = {"sum": np.sum, "mean": np.mean, "max": np.max}[mode](rows, axis=0)
+    return out
+
+
+@pytest.mark.parametrize("mode", ["sum", "mean", "max"])
+@pytest.mark.parametrize("with_weights", [False, True])
+def test_embedding_bag(mode, with_weights):
+    if with_weights and mode != "sum":
+        pytest.skip("per sample weights are only supported in sum mode")
+    bb = relax.BlockBuilder()
+    weight = relax.Var("weight", R.Tensor((10, 5), "float32"))
+    indices = relax.Var("indices", R.Tensor((7,), "int64"))
+    offsets = relax.Var("offsets", R.Tensor((4,), "int64"))
+    params = [weight, indices, offsets]
+    if with_weights:
+        params.append(relax.Var("per_sample_weights", R.Tensor((7,), "float32")))
+    with bb.function("main", params):
+        gv = bb.emit(relax.op.nn.embedding_bag(*params, mode=mode))
+        bb.emit_func_output(gv)
+    mod = LegalizeOps()(bb.get())
+
+    weight_np = np.random.uniform(-1, 1, (10, 5)).astype("float32")
+    indices_np = np.array([1, 4, 4, 9, 0, 2, 7], "int64")
+    # The third bag is empty.
+    offsets_np = np.array([0, 3, 5, 5], "int64")
+    psw_np = np.random.uniform(0, 1, (7,)).astype("float32") if with_weights else None
+    inputs = [weight_np, indices_np, offsets_np] + ([psw_np] if with_weights else [])
+
+    vm = relax.VirtualMachine(tvm.compile(mod, target="llvm"), tvm.cpu())
+    out = vm["main"](*[tvm.runtime.tensor(x) for x in inputs]).numpy()
+    ref = _embedding_bag_ref(weight_np, indices_np, offsets_np, psw_np, mode)
+    tvm.testing.assert_allclose(out, ref, rtol=1e-5, atol=1e-5)
+
+
+def test_csr_matmul():
+    bb = relax.BlockBuilder()
+    data = relax.Var("data", R.Tensor((5,), "float32"))
+    indices = relax.Var("indices", R.Tensor((5,), "int32"))
+    indptr = relax.Var("indptr", R.Tensor((5,), "int32"))
+    dense = relax.Var("dense", R.Tensor((6, 3), "float32"))
+    with bb.function("main", [data, indices, indptr, dense]):
+        gv = bb.emit(relax.op.csr_matmul(data, indices, indptr, dense))
+        bb.emit_func_output(gv)
+    mod = LegalizeOps()(bb.get())
+
+    sparse_np = np.zeros((4, 6), "float32")
+    # The second row is empty.
+    sparse_np[0, [1, 5]] = [1.5, -2.0]
+    sparse_np[2, 0] = 3.0
+    sparse_np[3, [2, 4]] = [0.5, 4.0]
+    indptr_np = np.array([0, 2, 2, 3, 5], "int32")
+    indices_np = np.array([1, 5, 0, 2, 4], "int32")
+    data_np = sparse_np[sparse_np != 0]
+    dense_np = np.random.uniform(-1, 1, (6, 3)).astype("float32")
+
+    vm = relax.VirtualMachine(tvm.compile(mod, target="llvm"), tvm.cpu())
+    inputs = [data_np, indices_np, indptr_np, dense_np]
+    out = vm["main"](*[tvm.runtime.tensor(x) for x in inputs]).numpy()
+    tvm.testing.assert_allclose(out, sparse_np @ dense_np, rtol=1e-5, atol=1e-5)
+
+
+@tvm.testing.requires_cuda
+def test_embedding_bag_and_csr_matmul_gpu():
+    """embedding_bag and csr_matmul lowered for GPU must build"""
+    target = "cuda"
+    bb = relax.BlockBuilder()
+    weight = relax.Var("weight", R.Tensor((10, 5), "float32"))
+    indices = relax.Var("indices", R.Tensor((7,), "int64"))
+    offsets = relax.Var("offsets", R.Tensor((4,), "int64"))
+    data = relax.Var("data", R.Tensor((7,), "float32"))
+    indptr = relax.Var("indptr", R.Tensor((5,), "int64"))
+    with bb.function("main", [weight, indices, offsets, data, indptr]):
+        bag = bb.emit(relax.op.nn.embedding_bag(weight, indices, offsets, mode="mean"))
+        gv = bb.emit(relax.op.csr_matmul(data, indices, indptr, weight))
+        bb.emit_func_output(relax.Tuple([bag, gv]))
+
+    with tvm.target.Target(target):
+        mod = LegalizeOps()(bb.get())
+    relax.build(mod, target=target)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
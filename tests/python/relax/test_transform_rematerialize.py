@@ -0,0 +1,68 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# ruff: noqa: F841
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.script import ir as I
+from tvm.script import relax as R
+
+
+@I.ir_module
+class Before:
+    @R.function
+    def main(x: R.Tensor((1024,), "float32")):
+        with R.dataflow():
+            a = R.exp(x)
+            b = R.sin(a)
+            c = R.cos(b)
+            d = R.add(c, b)
+            e = R.add(d, a)
+            R.output(e)
+        return e
+
+
+def test_recompute_across_peak():
+    """`a` is live across the peak only for its last use, so it is recomputed from `x`"""
+
+    @I.ir_module
+    class Expected:
+        @R.function
+        def main(x: R.Tensor((1024,), "float32")):
+            with R.dataflow():
+                a = R.exp(x)
+                b = R.sin(a)
+                c = R.cos(b)
+                d = R.add(c, b)
+                a_remat = R.exp(x)
+                e = R.add(d, a_remat)
+                R.output(e)
+            return e
+
+    After = relax.transform.Rematerialize(memory_budget=3 * 4096)(Before)
+    tvm.ir.assert_structural_equal(After, Expected)
+
+
+def test_within_budget():
+    """Nothing is recomputed when the peak already fits the budget"""
+    After = relax.transform.Rematerialize(memory_budget=4 * 4096)(Before)
+    tvm.ir.assert_structural_equal(After, Before)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -1189,5 +1189,59 @@ def test_static_input_with_symbolic_shape():
     tvm.ir.assert_structural_equal(After, Expected)
 
 
+def test_vulkan_target():
+    @I.ir_module(s_tir=True)
+    class Before:
+        @R.function(pure=False)
+        def main():
+            storage0 = R.memory.alloc_storage(R.shape([8]), 0, "global", "float32")
+            alloc0 = R.memory.alloc_tensor(storage0, 0, R.shape([8]), "float32")
+            _ = R.call_packed("dummy_func", alloc0, R.dtype("float32"), R.str("string"))
+            return R.tuple()
+
+    with tvm.target.Target("vulkan"):
+        mod = relax.transform.RewriteCUDAGraph()(Before)
+    script = mod.script()
+    assert "vm.builtin.vulkan_graph.get_cached_alloc" in script
+    assert "vm.builtin.vulkan_graph.run_or_capture" in script
+    assert "vm.builtin.cuda_graph" not in script
+
+
+def test_metal_target():
+    @I.ir_module(s_tir=True)
+    class Before:
+        @R.function(pure=False)
+        def main():
+            storage0 = R.memory.alloc_storage(R.shape([8]), 0, "global", "float32")
+            alloc0 = R.memory.alloc_tensor(storage0, 0, R.shape([8]), "float32")
+            _ = R.call_packed("dummy_func", alloc0, R.dtype("float32"), R.str("string"))
+            return R.tuple()
+
+    with tvm.target.Target("metal"):
+        mod = relax.transform.RewriteCUDAGraph()(Before)
+    script = mod.script()
+    assert "vm.builtin.metal_graph.get_cached_alloc" in script
+    assert "vm.builtin.metal_graph.run_or_capture" in script
+    assert "vm.builtin.cuda_graph" not in script
+
+
+def test_rocm_target():
+    @I.ir_module(s_tir=True)
+    class Before:
+        @R.function(pure=False)
+        def main():
+            storage0 = R.memory.alloc_storage(R.shape([8]), 0, "global", "float32")
+            alloc0 = R.memory.alloc_tensor(storage0, 0, R.shape([8]), "float32")
+            _ = R.call_packed("dummy_func", alloc0, R.dtype("float32"), R.str("string"))
+            return R.tuple()
+
+    with tvm.target.Target("rocm"):
+        mod = relax.transform.RewriteCUDAGraph()(Before)
+    script = mod.script()
+    assert "vm.builtin.rocm_graph.get_cached_alloc" in script
+    assert "vm.builtin.rocm_graph.run_or_capture" in script
+    assert "vm.builtin.cuda_graph" not in script
+
+
 if __name__ == "__main__":
     tvm.testing.main()
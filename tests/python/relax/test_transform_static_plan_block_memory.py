@@ -387,6 +387,160 @@ def test_same_dtype():
     tvm.ir.assert_structural_equal(mod, Expected)
 
 
+def test_arena_offset_packing():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def add(
+            A: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+            B: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+            C: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+        ):
+            T.evaluate(0)
+
+        @R.function
+        def prefill(
+            x: R.Tensor((2, 3), dtype="float32"), y: R.Tensor((2, 3), dtype="float32")
+        ) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True, "relax.memory_arena_group": "llm"})
+            cls = Module
+            alloc: R.Tensor((2, 3), dtype="float32") = R.builtin.alloc_tensor(
+                R.shape([2, 3]), dtype="float32", runtime_device_index=0
+            )
+            _: R.Tuple() = cls.add(x, y, alloc)
+            alloc1: R.Tensor((2, 3), dtype="float32") = R.builtin.alloc_tensor(
+                R.shape([2, 3]), dtype="float32", runtime_device_index=0
+            )
+            _1: R.Tuple() = cls.add(alloc, y, alloc1)
+            alloc2: R.Tensor((2, 3), dtype="float32") = R.builtin.alloc_tensor(
+                R.shape([2, 3]), dtype="float32", runtime_device_index=0
+            )
+            _2: R.Tuple() = cls.add(alloc1, y, alloc2)
+            return x
+
+        @R.function
+        def decode(
+            x: R.Tensor((2, 3), dtype="float32"), y: R.Tensor((2, 3), dtype="float32")
+        ) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True, "relax.memory_arena_group": "llm"})
+            cls = Module
+            alloc: R.Tensor((2, 3), dtype="float32") = R.builtin.alloc_tensor(
+                R.shape([2, 3]), dtype="float32", runtime_device_index=0
+            )
+            _: R.Tuple() = cls.add(x, y, alloc)
+            return x
+
+    @tvm.script.ir_module
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def add(
+            A: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+            B: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+            C: T.Buffer((T.int64(2), T.int64(3)), "float32"),
+        ):
+            T.evaluate(0)
+
+        @R.function
+        def prefill(
+            x: R.Tensor((2, 3), dtype="float32"), y: R.Tensor((2, 3), dtype="float32")
+        ) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True, "relax.memory_arena_group": "llm"})
+            cls = Expected
+            storage: R.Any = R.memory.alloc_storage(
+                R.shape([128]), virtual_device_index=0, storage_scope="global", dtype="uint8"
+            )
+            alloc: R.Tensor((2, 3), dtype="float32") = R.memory.alloc_tensor(
+                storage, 0, R.shape([2, 3]), dtype="float32"
+            )
+            _: R.Tuple() = cls.add(x, y, alloc)
+            alloc1: R.Tensor((2, 3), dtype="float32") = R.memory.alloc_tensor(
+                storage, 64, R.shape([2, 3]), dtype="float32"
+            )
+            _1: R.Tuple() = cls.add(alloc, y, alloc1)
+            alloc2: R.Tensor((2, 3), dtype="float32") = R.memory.alloc_tensor(
+                storage, 0, R.shape([2, 3]), dtype="float32"
+            )
+            _2: R.Tuple() = cls.add(alloc1, y, alloc2)
+            return x
+
+        @R.function
+        def decode(
+            x: R.Tensor((2, 3), dtype="float32"), y: R.Tensor((2, 3), dtype="float32")
+        ) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True, "relax.memory_arena_group": "llm"})
+            cls = Expected
+            storage: R.Any = R.memory.alloc_storage(
+                R.shape([128]), virtual_device_index=0, storage_scope="global", dtype="uint8"
+            )
+            alloc: R.Tensor((2, 3), dtype="float32") = R.memory.alloc_tensor(
+                storage, 0, R.shape([2, 3]), dtype="float32"
+            )
+            _: R.Tuple() = cls.add(x, y, alloc)
+            return x
+
+    with tvm.transform.PassContext(config={"relax.memory_plan_arena": True}):
+        mod = relax.transform.StaticPlanBlockMemory()(Module)
+    # The decode arena is sized to the peak of its group, while its own peak is reported.
+    assert mod["prefill"].attrs["relax.memory_plan_peak_bytes"] == 128
+    assert mod["decode"].attrs["relax.memory_plan_peak_bytes"] == 64
+    for name in ["prefill", "decode"]:
+        mod[name] = mod[name].without_attr("relax.memory_plan_peak_bytes")
+    tvm.ir.assert_structural_equal(mod, Expected)
+
+
+def test_output_params():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def exp(A: T.Buffer((2, 3), "float32"), B: T.Buffer((2, 3), "float32")):
+            T.evaluate(0)
+
+        @R.function
+        def main(x: R.Tensor((2, 3), dtype="float32")) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True})
+            cls = Module
+            alloc: R.Tensor((2, 3), dtype="float32") = R.builtin.alloc_tensor(
+                R.shape([2, 3]), dtype="float32", runtime_device_index=0
+            )
+            _: R.Tuple() = cls.exp(x, alloc)
+            y: R.Tensor((2, 3), dtype="float32") = alloc
+            return y
+
+        @R.function
+        def identity(x: R.Tensor((2, 3), dtype="float32")) -> R.Tensor((2, 3), dtype="float32"):
+            return x
+
+    @tvm.script.ir_module
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def exp(A: T.Buffer((2, 3), "float32"), B: T.Buffer((2, 3), "float32")):
+            T.evaluate(0)
+
+        @R.function
+        def main(
+            x: R.Tensor((2, 3), dtype="float32"),
+            output_buffer_0: R.Tensor((2, 3), dtype="float32"),
+        ) -> R.Tensor((2, 3), dtype="float32"):
+            R.func_attr({"relax.force_pure": True})
+            cls = Expected
+            alloc: R.Tensor((2, 3), dtype="float32") = output_buffer_0
+            _: R.Tuple() = cls.exp(x, alloc)
+            y: R.Tensor((2, 3), dtype="float32") = alloc
+            return y
+
+        @R.function
+        def identity(x: R.Tensor((2, 3), dtype="float32")) -> R.Tensor((2, 3), dtype="float32"):
+            return x
+
+    with tvm.transform.PassContext(config={"relax.memory_output_params": True}):
+        mod = relax.transform.StaticPlanBlockMemory()(Module)
+    # Only the function returning its own allocation gets an output parameter.
+    assert mod["main"].attrs["relax.num_output_params"] == 1
+    assert "relax.num_output_params" not in mod["identity"].attrs
+    mod["main"] = mod["main"].without_attr("relax.num_output_params")
+    tvm.ir.assert_structural_equal(mod, Expected)
+
+
 def test_if_cond():
     @tvm.script.ir_module
     class Module:
@@ -1019,6 +1173,47 @@ def test_tir_var_upper_bound():
     tvm.ir.assert_structural_equal(mod, Expected)
 
 
+def test_match_cast_upper_bound():
+    # fmt: off
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def exp(rxplaceholder: T.handle, compute: T.handle):
+            T.evaluate(0)
+
+        @R.function
+        def main(x: R.Tensor(("n",), dtype="float32")) -> R.Tensor(("n",), dtype="float32"):
+            R.func_attr({"tir_var_upper_bound": {"n": 4}, "relax.force_pure": True})
+            m = T.int64()
+            cls = Module
+            lv: R.Tensor((m,), dtype="float32") = R.match_cast(x, R.Tensor((m,), dtype="float32"))
+            alloc: R.Tensor((m,), dtype="float32") = R.builtin.alloc_tensor(R.shape([m]), dtype="float32", runtime_device_index=0)
+            _: R.Tuple() = cls.exp(lv, alloc)
+            return x
+
+    @I.ir_module
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def exp(rxplaceholder: T.handle, compute: T.handle):
+            T.evaluate(0)
+
+        @R.function
+        def main(x: R.Tensor(("n",), dtype="float32")) -> R.Tensor(("n",), dtype="float32"):
+            m = T.int64()
+            R.func_attr({"tir_var_upper_bound": {"n": 4}, "relax.force_pure": True})
+            cls = Expected
+            lv: R.Tensor((m,), dtype="float32") = R.match_cast(x, R.Tensor((m,), dtype="float32"))
+            storage: R.Any = R.memory.alloc_storage(R.shape([16]), R.prim_value(0), R.str("global"), R.dtype("float32"))
+            alloc: R.Tensor((m,), dtype="float32") = R.memory.alloc_tensor(storage, R.prim_value(0), R.shape([m]), R.dtype("float32"))
+            _: R.Tuple = cls.exp(lv, alloc)
+            return x
+    # fmt: on
+
+    # The bound of `m` is derived from the bound of `n` through the match_cast.
+    mod = relax.transform.StaticPlanBlockMemory()(Module)
+    tvm.ir.assert_structural_equal(mod, Expected)
+
+
 def test_lower_bound_only():
     # fmt: off
     @tvm.script.ir_module
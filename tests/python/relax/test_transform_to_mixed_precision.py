@@ -1134,5 +1134,43 @@ def test_dynamic_strided_slice():
     _assert_test(Input, Expected)
 
 
+def test_profile_guided_conv2d():
+    @I.ir_module
+    class Input:
+        @R.function
+        def main(
+            x: R.Tensor((2, 3, 28, 28), "float32"),
+            w0: R.Tensor((3, 3, 3, 3), "float32"),
+            w1: R.Tensor((4, 3, 3, 3), "float32"),
+        ) -> R.Tensor(None, "float32", ndim=4):
+            with R.dataflow():
+                lv0: R.Tensor((2, 3, 26, 26), "float32") = R.nn.conv2d(x, w0, out_dtype="float32")
+                gv: R.Tensor((2, 4, 24, 24), "float32") = R.nn.conv2d(lv0, w1, out_dtype="float32")
+                R.output(gv)
+            return gv
+
+    def conv2d_input_dtypes(mod):
+        conv2d = tvm.ir.Op.get("relax.nn.conv2d")
+        return {
+            binding.var.name_hint: binding.value.args[0].ty.dtype
+            for binding in mod["main"].body.blocks[0].bindings
+            if isinstance(binding.value, relax.Call) and binding.value.op.same_as(conv2d)
+        }
+
+    # Both convs together exceed the budget, so the one with the least speedup per unit of error
+    # stays in fp32.
+    profile = {"lv0": (0.5, 1.0), "gv": (0.5, 3.0)}
+    mod = ToMixedPrecision(op_profile=profile, error_budget=0.6)(Input)
+    assert conv2d_input_dtypes(mod) == {"lv0": "float32", "gv": "float16"}
+
+    mod = ToMixedPrecision(op_profile=profile, error_budget=1.0)(Input)
+    assert conv2d_input_dtypes(mod) == {"lv0": "float16", "gv": "float16"}
+
+    # A conv that does not save time is kept in fp32 whatever the budget.
+    profile = {"lv0": (0.0, -1.0), "gv": (0.5, 3.0)}
+    mod = ToMixedPrecision(op_profile=profile, error_budget=1.0)(Input)
+    assert conv2d_input_dtypes(mod) == {"lv0": "float32", "gv": "float16"}
+
+
 if __name__ == "__main__":
     tvm.testing.main()
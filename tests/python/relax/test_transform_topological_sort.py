@@ -480,5 +480,46 @@ def test_breadth_first_break_ties_by_existing_order():
     tvm.ir.assert_structural_equal(After, Expected)
 
 
+def test_min_memory():
+    """Sort DataflowBlock bindings to reduce the peak live tensor bytes
+
+    Each branch produces a large intermediate and reduces it to a
+    scalar.  Emitting the reduction as soon as it is ready releases
+    the intermediate before the other branch allocates its own.
+    """
+
+    @I.ir_module
+    class Before:
+        @R.function
+        def main(A: R.Tensor((1024,), "float32")):
+            with R.dataflow():
+                B1 = R.exp(A)
+                B2 = R.sigmoid(A)
+                C1 = R.sum(B1)
+                C2 = R.sum(B2)
+                D = R.add(C1, C2)
+                R.output(D)
+            return D
+
+    @I.ir_module
+    class Expected:
+        @R.function
+        def main(A: R.Tensor((1024,), "float32")):
+            with R.dataflow():
+                B1 = R.exp(A)
+                C1 = R.sum(B1)
+                B2 = R.sigmoid(A)
+                C2 = R.sum(B2)
+                D = R.add(C1, C2)
+                R.output(D)
+            return D
+
+    After = tvm.relax.transform.TopologicalSort(
+        order="min-memory",
+        direction="from-inputs",
+    )(Before)
+    tvm.ir.assert_structural_equal(After, Expected)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
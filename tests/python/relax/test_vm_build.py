@@ -17,6 +17,7 @@
 # ruff: noqa: F841
 
 import ctypes
+import threading
 from collections.abc import Callable
 
 import numpy as np
@@ -84,6 +85,27 @@ def test_vm_compile_without_target_arg(exec_mode):
     tvm.testing.assert_allclose(inp2.numpy(), inp1.numpy(), rtol=1e-7, atol=1e-7)
 
 
+def test_tvm_compile_exec_mode(exec_mode):
+    """tvm.compile forwards exec_mode, and repeated calls reuse the register file"""
+
+    @tvm.script.ir_module
+    class mod:
+        @R.function
+        def foo(x: R.Tensor((3, 4), "float32"), y: R.Tensor((3, 4), "float32")):
+            z = R.call_pure_packed(
+                "test.vm.identity", x, y, ty_args=(R.Tensor(ndim=2, dtype="float32"))
+            )
+            return y
+
+    ex = tvm.compile(mod, "llvm", exec_mode=exec_mode)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    for _ in range(3):
+        inp1 = tvm.runtime.tensor(np.random.rand(3, 4).astype(np.float32))
+        inp2 = tvm.runtime.tensor(np.random.rand(3, 4).astype(np.float32))
+        out = vm["foo"](inp1, inp2)
+        tvm.testing.assert_allclose(out.numpy(), inp1.numpy(), rtol=1e-7, atol=1e-7)
+
+
 def test_match_check(exec_mode):
     @tvm.script.ir_module
     class TestMatchCheck:
@@ -187,6 +209,125 @@ def test_vm_compile_e2e(exec_mode):
     tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
 
 
+def test_vm_buddy_allocator(exec_mode):
+    @tvm.script.ir_module
+    class TestVMBuddyAllocator:
+        @R.function
+        def foo(x: R.Tensor(dtype="float32")) -> R.Tensor:
+            with R.dataflow():
+                n, m = T.int64(), T.int64()
+                _ = R.match_cast(x, R.Tensor((n, m), "float32"))
+                y = R.call_dps_packed("test.vm.tile", (x), R.Tensor((n, m * 2), dtype="float32"))
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.build(TestVMBuddyAllocator, target, exec_mode=exec_mode)
+    dev = tvm.cpu()
+    vm = relax.VirtualMachine(ex, dev, memory_cfg="buddy")
+    get_stats = tvm.get_global_func("vm.builtin.memory_manager.buddy_allocator_stats")
+
+    # Outputs of different dynamic shapes are carved out of the same slab.
+    for shape in [(32, 16), (7, 5), (64, 33), (32, 16)]:
+        inp = tvm.runtime.tensor(np.random.rand(*shape).astype(np.float32))
+        res = vm["foo"](inp)
+        tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
+        del res
+    stats = get_stats(dev)
+    assert stats["num_slabs"] == 1
+    assert stats["used_bytes"] == 0
+    assert stats["free_bytes"] == stats["reserved_bytes"]
+    assert stats["largest_free_block"] == stats["reserved_bytes"]
+
+    # A high-water mark releases the free slabs.
+    tvm.get_global_func("vm.builtin.memory_manager.buddy_allocator_set_high_water_mark")(dev, 1)
+    assert get_stats(dev)["reserved_bytes"] == 0
+    tvm.get_global_func("vm.builtin.memory_manager.buddy_allocator_set_high_water_mark")(dev, 0)
+
+
+def test_vm_pooled_allocator_thread_cache(exec_mode):
+    @tvm.script.ir_module
+    class TestVMPooledAllocator:
+        @R.function
+        def foo(x: R.Tensor(dtype="float32")) -> R.Tensor:
+            with R.dataflow():
+                n, m = T.int64(), T.int64()
+                _ = R.match_cast(x, R.Tensor((n, m), "float32"))
+                y = R.call_dps_packed("test.vm.tile", (x), R.Tensor((n, m * 2), dtype="float32"))
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.build(TestVMPooledAllocator, target, exec_mode=exec_mode)
+    dev = tvm.cpu()
+    get_stats = tvm.get_global_func("vm.builtin.memory_manager.pooled_allocator_stats")
+
+    def run():
+        vm = relax.VirtualMachine(ex, dev, memory_cfg="pooled")
+        inp = tvm.runtime.tensor(np.random.rand(32, 16).astype(np.float32))
+        for _ in range(4):
+            res = vm["foo"](inp)
+            tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)))
+
+    run()
+    stats = get_stats(dev)
+    assert stats["num_thread_cache_hits"] > 0
+    assert stats["num_allocs"] == (
+        stats["num_thread_cache_hits"] + stats["num_pool_hits"] + stats["num_device_allocs"]
+    )
+
+    # The cache of an exited thread is returned to the global pool.
+    num_thread_caches = stats["num_thread_caches"]
+    thread = threading.Thread(target=run)
+    thread.start()
+    thread.join()
+    assert get_stats(dev)["num_thread_caches"] == num_thread_caches
+
+
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_gpu(), reason="need gpu")
+def test_vm_stream_ordered_allocator(exec_mode):
+    @tvm.script.ir_module
+    class TestVMStreamOrderedAllocator:
+        @R.function
+        def foo(x: R.Tensor((32, 16), "float32")) -> R.Tensor((32, 16), "float32"):
+            with R.dataflow():
+                y = R.add(x, x)
+                z = R.multiply(y, x)
+                R.output(z)
+            return z
+
+    with tvm.target.Target("cuda"):
+        mod = relax.transform.LegalizeOps()(TestVMStreamOrderedAllocator)
+        mod = tvm.s_tir.transform.DefaultGPUSchedule()(mod)
+    ex = relax.build(mod, "cuda", exec_mode=exec_mode)
+
+    def run_and_check():
+        dev = tvm.cuda()
+        vm = relax.VirtualMachine(ex, dev, memory_cfg="stream_ordered")
+        get_stats = tvm.get_global_func("vm.builtin.memory_manager.stream_ordered_allocator_stats")
+        x_np = np.random.rand(32, 16).astype("float32")
+        for _ in range(3):
+            res = vm["foo"](tvm.runtime.tensor(x_np, dev))
+            tvm.testing.assert_allclose(res.numpy(), (x_np + x_np) * x_np, rtol=1e-6, atol=1e-6)
+            del res
+        dev.sync()
+        stats = get_stats(dev)
+        assert stats["used_bytes"] == 0
+        assert stats["reserved_bytes"] > 0
+
+        # A zero release threshold returns the freed memory at the next synchronization.
+        set_threshold = tvm.get_global_func(
+            "vm.builtin.memory_manager.stream_ordered_allocator_set_release_threshold"
+        )
+        set_threshold(dev, 0)
+        dev.sync()
+        assert get_stats(dev)["release_threshold"] == 0
+        set_threshold(dev, 2**63 - 1)
+
+    tvm.testing.run_with_gpu_lock(run_and_check)
+
+
 def test_vm_compile_e2e_func_param_with_shape(exec_mode):
     @tvm.script.ir_module
     class TestVMCompileE2E2:
@@ -287,6 +428,83 @@ def test_call_tir_inplace_e2e_simple(exec_mode):
     tvm.testing.assert_allclose(outs[2].numpy(), z.numpy(), rtol=1e-7, atol=1e-7)
 
 
+def test_vm_unchecked_kernel_entry():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def add(
+            A: T.Buffer((2, 3), "float32"),
+            B: T.Buffer((2, 3), "float32"),
+            C: T.Buffer((2, 3), "float32"),
+        ):
+            for i, j in T.grid(2, 3):
+                with T.sblock("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    C[vi, vj] = A[vi, vj] + B[vi, vj]
+
+        @R.function
+        def main(x: R.Tensor((2, 3), "float32"), y: R.Tensor(("n", 3), "float32")):
+            # The shapes of x prove the checks of add, but the symbolic shape of y does not.
+            z = R.call_tir(Module.add, (x, x), R.Tensor((2, 3), "float32"))
+            w = R.call_tir(Module.add, (z, y), R.Tensor((2, 3), "float32"))
+            return w
+
+    target = tvm.target.Target("llvm", host="llvm")
+    with tvm.transform.PassContext(config={"relax.backend.use_unchecked_kernel_entry": True}):
+        ex = relax.build(Module, target, exec_mode="bytecode")
+    text = ex.as_text()
+    assert "add_unchecked" in text
+    # The call whose arguments are not proven keeps the checked entry.
+    assert any(line.split()[:2] == ["call", "add"] for line in text.splitlines())
+
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    x = np.random.rand(2, 3).astype(np.float32)
+    y = np.random.rand(2, 3).astype(np.float32)
+    res = vm["main"](tvm.runtime.tensor(x), tvm.runtime.tensor(y))
+    tvm.testing.assert_allclose(res.numpy(), x + x + y, rtol=1e-7, atol=1e-7)
+    # The checked entry still rejects a mismatched shape.
+    with pytest.raises(ValueError):
+        vm["main"](tvm.runtime.tensor(x), tvm.runtime.tensor(np.zeros((4, 3), "float32")))
+
+
+def test_vm_direct_kernel_call():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func(s_tir=True)
+        def add(
+            A: T.Buffer((2, 3), "float32"),
+            B: T.Buffer((2, 3), "float32"),
+            C: T.Buffer((2, 3), "float32"),
+        ):
+            for i, j in T.grid(2, 3):
+                with T.sblock("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    C[vi, vj] = A[vi, vj] + B[vi, vj]
+
+        @R.function
+        def main(x: R.Tensor((2, 3), "float32"), y: R.Tensor(("n", 3), "float32")):
+            # The shapes of x prove the checks of add, but the symbolic shape of y does not.
+            z = R.call_tir(Module.add, (x, x), R.Tensor((2, 3), "float32"))
+            w = R.call_tir(Module.add, (z, y), R.Tensor((2, 3), "float32"))
+            return w
+
+    target = tvm.target.Target("llvm", host="llvm")
+    with tvm.transform.PassContext(config={"relax.backend.use_direct_kernel_call": True}):
+        ex = relax.build(Module, target, exec_mode="bytecode")
+    text = ex.as_text()
+    assert "@add_direct direct_func;" in text
+    assert "@add packed_func;" in text
+
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    x = np.random.rand(2, 3).astype(np.float32)
+    y = np.random.rand(2, 3).astype(np.float32)
+    res = vm["main"](tvm.runtime.tensor(x), tvm.runtime.tensor(y))
+    tvm.testing.assert_allclose(res.numpy(), x + x + y, rtol=1e-7, atol=1e-7)
+    # The call that is not proven still goes through the checked packed entry.
+    with pytest.raises(ValueError):
+        vm["main"](tvm.runtime.tensor(x), tvm.runtime.tensor(np.zeros((4, 3), "float32")))
+
+
 def test_call_tir_inplace_e2e_rw(exec_mode):
     # read and write from the same tensor
     @tvm.script.ir_module
@@ -1095,6 +1313,110 @@ def test_set_input_tuple(exec_mode):
     vm.invoke_stateful("main")
 
 
+def _aligned_empty(shape, dtype, alignment=64):
+    nbytes = int(np.prod(shape)) * np.dtype(dtype).itemsize
+    raw = np.empty(nbytes + alignment, dtype="uint8")
+    offset = -raw.ctypes.data % alignment
+    return raw[offset : offset + nbytes].view(dtype).reshape(shape)
+
+
+def test_set_input_zero_copy(exec_mode):
+    temp = utils.tempdir()
+    vm, device = make_vm(TestVMSetInput, exec_mode, temp)
+    storage_shared = tvm.get_global_func("runtime.TVMTensorIsStorageShared")
+    a_np = _aligned_empty((32, 32), "float32")
+    b_np = _aligned_empty((32, 32), "float32")
+    a_np[:] = np.random.rand(32, 32)
+    b_np[:] = np.random.rand(32, 32)
+    released = []
+    a = tvm.runtime.from_external_buffer(
+        a_np.ctypes.data, a_np.shape, "float32", device, release=lambda: released.append(True)
+    )
+    b = tvm.runtime.from_external_buffer(b_np.ctypes.data, b_np.shape, "float32", device)
+    out = tvm.runtime.empty((32, 32), "float32", device)
+    vm.set_input_zero_copy("main", a, b)
+    vm.set_output_buffers("main", out)
+    vm.invoke_stateful("main")
+    assert storage_shared(vm.get_outputs("main"), out)
+    tvm.testing.assert_allclose(out.numpy(), a_np * b_np, rtol=1e-7, atol=1e-7)
+
+    # The inputs are views of the caller buffers, so the next call sees their new values.
+    a_np[:] = 1.0
+    vm.invoke_stateful("main")
+    tvm.testing.assert_allclose(out.numpy(), b_np, rtol=1e-7, atol=1e-7)
+
+    vm.set_input("main", b, b)
+    del a
+    assert released == [True]
+
+    with pytest.raises(ValueError):
+        tvm.runtime.from_external_buffer(a_np.ctypes.data + 4, (4,), "float32", device)
+
+    vm.set_output_buffers("main", tvm.runtime.empty((32,), "float32", device))
+    with pytest.raises(ValueError):
+        vm.invoke_stateful("main")
+
+
+def test_set_output_buffers_output_params(exec_mode):
+    target = tvm.target.Target("llvm", host="llvm")
+    with tvm.transform.PassContext(config={"relax.memory_output_params": True}):
+        ex = relax.build(TestVMSetInput, target, exec_mode=exec_mode)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    device = tvm.cpu()
+    a = tvm.runtime.tensor(np.random.rand(32, 32).astype("float32"), device)
+    b = tvm.runtime.tensor(np.random.rand(32, 32).astype("float32"), device)
+    out = tvm.runtime.empty((32, 32), "float32", device)
+    assert vm.module["get_function_param_name"]("main", 2) == "output_buffer_0"
+
+    vm.set_input("main", a, b)
+    with pytest.raises(ValueError):
+        vm.invoke_stateful("main")
+    vm.set_output_buffers("main", out)
+    vm.invoke_stateful("main")
+    res = vm.get_outputs("main")
+    assert tvm.get_global_func("runtime.TVMTensorIsStorageShared")(res, out)
+    tvm.testing.assert_allclose(out.numpy(), a.numpy() * b.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_context_pool_threads(exec_mode):
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.build(TestVMSetInput, target, exec_mode=exec_mode)
+    device = tvm.cpu()
+    pool = relax.VirtualMachinePool(relax.VirtualMachine(ex, device))
+    errors = []
+
+    def serve(seed):
+        rng = np.random.default_rng(seed)
+        try:
+            for _ in range(8):
+                with pool.acquire() as vm:
+                    a_np = rng.random((32, 32), dtype="float32")
+                    b_np = rng.random((32, 32), dtype="float32")
+                    a = tvm.runtime.tensor(a_np, device)
+                    b = tvm.runtime.tensor(b_np, device)
+                    vm.set_input("main", a, b)
+                    vm.invoke_stateful("main")
+                    res = vm.get_outputs("main")
+                    tvm.testing.assert_allclose(res.numpy(), a_np * b_np, rtol=1e-7, atol=1e-7)
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    threads = [threading.Thread(target=serve, args=(i,)) for i in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not errors
+    assert 1 <= pool.num_idle() <= 4
+
+    # A context has its own inputs, which the VM it is created from does not see.
+    ctx = pool.vm.create_context()
+    x = tvm.runtime.empty((32, 32), "float32", device)
+    ctx.set_input("main", x, x)
+    with pytest.raises(ValueError):
+        pool.vm.invoke_stateful("main")
+
+
 def save_function_kwargs_trial(vm: relax.VirtualMachine, device: tvm.runtime.Device) -> None:
     # just checking that we can use kwargs for the args when saving a function
     a = tvm.runtime.tensor(np.random.rand(32, 32).astype("float32"), device)
@@ -212,6 +212,39 @@ def test_vm_const_as_call_arg(exec_mode):
     tvm.testing.assert_allclose(res.numpy(), np.array([4, 6]) + inp.numpy())
 
 
+def test_vm_exec_serialize_mapped_constants():
+    @tvm.script.ir_module
+    class TestVMConstants:
+        @R.function(pure=False)
+        def main(x: R.Tensor(ndim=2, dtype="float32")):
+            R.func_attr({"global_symbol": "main"})
+            a = R.call_packed(
+                "test.vm.add",
+                relax.const(np.arange(6, dtype="float32").reshape(2, 3)),
+                relax.const(np.ones((2, 3), dtype="float32")),
+                ty_args=(R.Tensor(ndim=2, dtype="float32")),
+            )
+            b = R.call_packed("test.vm.add", a, x, ty_args=(R.Tensor(ndim=2, dtype="float32")))
+            return b
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = codegen(TestVMConstants, target)
+    from tvm.support import utils
+
+    temp_dir = utils.tempdir()
+    path_exec = temp_dir.relpath("exec.bin")
+    ex.mod.write_to_file(path_exec)
+
+    # The tensor constants of the loaded executable view into the mapped file.
+    loaded_exec = tvm.get_global_func("relax.ExecutableLoadFromFile")(path_exec)
+    assert ex.as_text() == loaded_exec["as_text"]()
+    vm = relax.VirtualMachine(loaded_exec, tvm.cpu())
+    inp = tvm.runtime.tensor(np.random.rand(2, 3).astype("float32"))
+    res = vm["main"](inp)
+    expected = np.arange(6, dtype="float32").reshape(2, 3) + 1 + inp.numpy()
+    tvm.testing.assert_allclose(res.numpy(), expected)
+
+
 @pytest.mark.parametrize("exec_mode", EXEC_MODE)
 def test_shape_check_builtin(exec_mode):
     MS = MatchShapeCode
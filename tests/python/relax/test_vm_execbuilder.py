@@ -268,6 +268,29 @@ def test_vm_invoke_closure():
     )
 
 
+def test_vm_instruction_throughput():
+    """Microbenchmark of the VM interpreter with cheap packed calls and nested VM calls."""
+    num_copies, num_steps = 64, 16
+    ib = relax.ExecBuilder()
+    with ib.function("step", num_inputs=1):
+        for _ in range(num_copies):
+            ib.emit_call("vm.builtin.copy", args=[ib.r(0)], dst=ib.r(0))
+        ib.emit_ret(ib.r(0))
+    with ib.function("main", num_inputs=1):
+        for _ in range(num_steps):
+            ib.emit_call("step", args=[ib.r(0)], dst=ib.r(0))
+        ib.emit_ret(ib.r(0))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.runtime.tensor(np.random.rand(4))
+    tvm.testing.assert_allclose(vm["main"](inp).numpy(), inp.numpy())
+
+    num_instrs = num_steps * (num_copies + 1) + num_steps + 1
+    vm.save_function("main", "saved_main", inp)
+    timing_res = vm.time_evaluator("saved_main", tvm.cpu(), number=100)()
+    print(f"VM executes {num_instrs / timing_res.mean / 1e6:.2f}M instructions per second")
+
+
 def test_vm_stack_restore_after_failure():
     @tvm.script.ir_module
     class Module:
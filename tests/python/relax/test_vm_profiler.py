@@ -0,0 +1,90 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import json
+
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relax
+from tvm.relax.testing import nn
+
+
+def get_exec(data_shape):
+    builder = relax.BlockBuilder()
+    with builder.function("main"):
+        model = nn.Sequential(
+            nn.Linear(data_shape[1], 64, bias=False),
+            nn.ReLU(),
+            nn.Linear(64, 64, bias=False),
+            nn.ReLU(),
+        )
+        data = nn.Placeholder(data_shape, name="data")
+        output = model(data)
+        params = [data] + model.parameters()
+        builder.emit_func_output(output, params=params)
+
+    mod = builder.get()
+    params = {
+        "linear_weight": np.random.randn(data_shape[1], 64).astype("float32"),
+        "linear_weight1": np.random.randn(64, 64).astype("float32"),
+    }
+    mod = relax.transform.BindParams("main", params)(mod)
+    return tvm.compile(mod, "llvm")
+
+
+def test_profiler_report():
+    data_np = np.random.randn(1, 64).astype("float32")
+    vm = relax.VirtualMachine(get_exec(data_np.shape), tvm.cpu())
+    vm.profiler_start()
+    for _ in range(3):
+        vm["main"](tvm.runtime.tensor(data_np))
+    vm.profiler_stop()
+    # Calls after stopping are not recorded.
+    vm["main"](tvm.runtime.tensor(data_np))
+
+    report = vm.profiler_report()
+    functions = {func["name"]: func for func in report["functions"]}
+    assert functions["matmul"]["calls"] == 6
+    assert functions["relu"]["calls"] == 6
+    totals = [func["total_ns"] for func in report["functions"]]
+    assert totals == sorted(totals, reverse=True)
+    assert report["total_ns"] == sum(totals)
+    for func in report["functions"]:
+        assert func["min_ns"] <= func["mean_ns"] <= func["max_ns"]
+
+
+def test_profiler_chrome_trace():
+    data_np = np.random.randn(1, 64).astype("float32")
+    vm = relax.VirtualMachine(get_exec(data_np.shape), tvm.cpu())
+    vm.profiler_start()
+    vm["main"](tvm.runtime.tensor(data_np))
+    vm.profiler_stop()
+
+    trace = json.loads(vm.profiler_chrome_trace())
+    kernels = [event for event in trace["traceEvents"] if event["ph"] == "X"]
+    counters = [event for event in trace["traceEvents"] if event["ph"] == "C"]
+    assert len(kernels) == len(counters)
+    matmuls = [event for event in kernels if event["name"] == "matmul"]
+    assert len(matmuls) == 2
+    assert matmuls[0]["args"]["shapes"].startswith("(1, 64), (64, 64)")
+    timestamps = [event["ts"] for event in kernels]
+    assert timestamps == sorted(timestamps)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
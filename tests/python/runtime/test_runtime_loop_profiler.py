@@ -0,0 +1,79 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import te
+from tvm.runtime import loop_profiler
+
+
+def _build_instrumented(n):
+    x = te.placeholder((n, n), name="X", dtype="float32")
+    y = te.compute(x.shape, lambda i, j: x[i, j] * 2.0, name="Y")
+    func = te.create_prim_func([x, y]).with_attr("global_symbol", "scale")
+    with tvm.transform.PassContext(
+        config={"tirx.instrument_lwp": True, "s_tir.reset_start_id": True}
+    ):
+        return tvm.compile(func, target="llvm")
+
+
+@tvm.testing.requires_llvm
+def test_cpu_loop_report():
+    f = _build_instrumented(16)
+    x = tvm.runtime.tensor(np.ones((16, 16), dtype="float32"))
+    y = tvm.runtime.tensor(np.zeros((16, 16), dtype="float32"))
+
+    loop_profiler.start()
+    f(x, y)
+    f(x, y)
+    loop_profiler.stop()
+    report = loop_profiler.report(f)
+
+    np.testing.assert_equal(y.numpy(), 2 * np.ones((16, 16)))
+    assert "time_ns" in report.counters
+    records = report.records()
+    # The function itself and its outermost loop are instrumented.
+    assert len(records) >= 2
+    assert all(entry["calls"] == 2 for entry in records.values())
+    assert "calls" in report.table()
+
+    # Stopped profiler records nothing more.
+    f(x, y)
+    assert loop_profiler.report(f).records() == records
+
+
+def test_report_diff():
+    baseline = loop_profiler.LoopProfileReport(
+        ["time_ns", "cycles"],
+        [{"kernel": "main", "loop": 1, "calls": 1, "time_ns": 200, "cycles": 400}],
+    )
+    candidate = loop_profiler.LoopProfileReport(
+        ["time_ns", "cycles"],
+        [
+            {"kernel": "main", "loop": 1, "calls": 1, "time_ns": 100, "cycles": 100},
+            {"kernel": "main", "loop": 2, "calls": 1, "time_ns": 50, "cycles": 10},
+        ],
+    )
+    lines = candidate.diff(baseline).splitlines()
+    assert lines[0].split() == ["kernel", "loop", "time_ns", "cycles"]
+    assert lines[1].split() == ["main", "1", "0.500x", "0.250x"]
+    assert lines[2].split() == ["main", "2", "-", "-"]
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -18,6 +18,8 @@
 import ctypes
 import time
 
+import numpy as np
+
 import tvm
 from tvm import te
 from tvm.runtime.module import BenchmarkResult
@@ -64,8 +66,27 @@ def test_benchmark_result():
     assert r.min == 1
     assert r.max == 5
     assert r.std == 1.5
+    assert r.p99 == np.percentile([1, 2, 2, 5], 99)
+
+
+def test_adaptive_repeat():
+    X = te.placeholder((1024,), name="X")
+    Y = te.compute((1024,), lambda i: X[i] + 1.0, name="Y")
+    func = tvm.tirx.build(te.create_prim_func([X, Y]))
+    x = tvm.runtime.empty((1024,), dtype="float32")
+    y = tvm.runtime.empty((1024,), dtype="float32")
+
+    # Any interval is within a huge relative width, so the measurement stops at the minimum.
+    ftimer = func.time_evaluator(func.entry_name, tvm.cpu(), repeat=100, max_relative_ci=1e9)
+    assert len(ftimer(x, y).results) == 3
+
+    ftimer = func.time_evaluator(
+        func.entry_name, tvm.cpu(), repeat=5, cache_flush_bytes=1 << 20, cold=True
+    )
+    assert len(ftimer(x, y).results) == 5
 
 
 if __name__ == "__main__":
     test_min_repeat_ms()
     test_benchmark_result()
+    test_adaptive_repeat()
@@ -0,0 +1,71 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm.runtime import metrics
+
+
+def test_counter_and_gauge():
+    before = metrics.snapshot().get("test_metrics_events_total", 0.0)
+    metrics.increment("test_metrics_events_total")
+    metrics.increment("test_metrics_events_total", 4)
+    metrics.set_gauge("test_metrics_level", 7)
+    values = metrics.snapshot()
+    assert values["test_metrics_events_total"] == before + 5
+    assert values["test_metrics_level"] == 7
+
+    text = metrics.prometheus_text()
+    assert "# TYPE test_metrics_events_total counter" in text
+    assert "test_metrics_level 7\n" in text
+
+
+def test_histogram():
+    for value in [2e-6, 5e-4, 10.0]:
+        metrics.observe("test_metrics_latency_seconds", value)
+    values = metrics.snapshot()
+    assert values["test_metrics_latency_seconds_count"] >= 3
+    text = metrics.prometheus_text()
+    assert "# TYPE test_metrics_latency_seconds histogram" in text
+    lines = [line for line in text.splitlines() if line.startswith("test_metrics_latency_seconds")]
+    buckets = [int(line.split()[-1]) for line in lines if "_bucket" in line]
+    # The buckets are cumulative and end with the total count.
+    assert buckets == sorted(buckets)
+    assert 'le="+Inf"' in lines[len(buckets) - 1]
+    assert buckets[-1] == values["test_metrics_latency_seconds_count"]
+
+
+def test_kind_mismatch():
+    metrics.increment("test_metrics_kind_total")
+    with pytest.raises(ValueError):
+        metrics.set_gauge("test_metrics_kind_total", 1)
+
+
+def test_runtime_counters_are_monotonic():
+    before = metrics.snapshot()
+    x = tvm.runtime.tensor(np.ones((64,), dtype="float32"))
+    np.testing.assert_equal(x.numpy(), np.ones((64,), dtype="float32"))
+    after = metrics.snapshot()
+    for name in before:
+        if name.endswith("_total"):
+            assert after[name] >= before[name]
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
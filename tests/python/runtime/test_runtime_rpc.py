@@ -164,6 +164,46 @@ def test_rpc_large_array():
     check_remote()
 
 
+@pytest.mark.skipif(not env.build_flag_enabled("USE_RPC"), reason="need rpc")
+def test_rpc_pipelined_upload():
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+
+    def check_remote():
+        dev = remote.cpu(0)
+        inputs = [np.full((64, 32), i, dtype="float32") for i in range(100)]
+        tensors = [tvm.runtime.empty(x.shape, x.dtype, dev) for x in inputs]
+        with remote.pipelined():
+            for tensor, x in zip(tensors, inputs):
+                tensor.copyfrom(x)
+        for tensor, x in zip(tensors, inputs):
+            np.testing.assert_equal(tensor.numpy(), x)
+
+    check_remote()
+
+
+@pytest.mark.skipif(not env.build_flag_enabled("USE_RPC"), reason="need rpc")
+def test_rpc_compressed_copy():
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    try:
+        assert remote.enable_compression("zstd", min_bytes=1024)
+    except ValueError:
+        pytest.skip("need zstd")
+
+    dev = remote.cpu(0)
+    x = np.zeros((256, 256), dtype="float32")
+    x[::7] = 1.0
+    y = np.random.uniform(size=(256, 256)).astype("float32")
+    r_x = tvm.runtime.tensor(x, dev)
+    r_y = tvm.runtime.tensor(y, dev)
+    np.testing.assert_equal(r_x.numpy(), x)
+    np.testing.assert_equal(r_y.numpy(), y)
+    stats = remote.transfer_stats()
+    assert stats["logical_bytes"] == 2 * (x.nbytes + y.nbytes)
+    assert stats["wire_bytes"] < stats["logical_bytes"]
+
+
 @tvm.testing.skip_if_32bit(reason="skipping test for i386.")
 @pytest.mark.skipif(not env.build_flag_enabled("USE_RPC"), reason="need rpc")
 def test_rpc_echo():
@@ -32,6 +32,7 @@ from tvm.s_tir.meta_schedule.builder import (
     BuilderResult,
     LocalBuilder,
     PyBuilder,
+    RPCBuilder,
 )
 from tvm.script import tirx as T
 from tvm.target import Target
@@ -224,6 +225,35 @@ def test_meta_schedule_error_handle_time_out():
         assert error_msg.startswith("LocalBuilder: Timeout")
 
 
+@pytest.mark.skip("Tuning test - launches builder hosts")
+def test_meta_schedule_rpc_build():
+    """Test the builds on builder hosts behind the RPC tracker"""
+    pytest.importorskip("tornado")
+    # pylint: disable=import-outside-toplevel
+    from tvm.s_tir.meta_schedule.builder.rpc_builder import _builder_server_init
+    from tvm.s_tir.meta_schedule.runner import RPCConfig
+    from tvm.s_tir.meta_schedule.testing.local_rpc import LocalRPC
+
+    # pylint: enable=import-outside-toplevel
+    with LocalRPC(tracker_key="builder", server_init_callback=_builder_server_init) as rpc:
+        builder = RPCBuilder(
+            RPCConfig(
+                tracker_host=rpc.tracker_host,
+                tracker_port=rpc.tracker_port,
+                tracker_key=rpc.tracker_key,
+                session_timeout_sec=100,
+            ),
+            max_workers=2,
+        )
+        builder_inputs = [
+            BuilderInput(MatmulModule, Target("llvm")),
+            BuilderInput(MatmulReluModule, Target("llvm")),
+        ]
+        builder_results = builder.build(builder_inputs)
+    assert len(builder_results) == len(builder_inputs)
+    _check_build_results(builder_results)
+
+
 def test_meta_schedule_missing_build_func():
     pytest.importorskip("cloudpickle")
     with pytest.raises(ValueError):
@@ -29,7 +29,7 @@ import pytest
 import tvm
 import tvm.testing
 from tvm.ir.utils import derived_object
-from tvm.s_tir.meta_schedule.cost_model import PyCostModel, RandomModel, XGBModel
+from tvm.s_tir.meta_schedule.cost_model import GBDTModel, PyCostModel, RandomModel, XGBModel
 from tvm.s_tir.meta_schedule.cost_model.xgb_model import PackSum, _get_custom_call_back
 from tvm.s_tir.meta_schedule.feature_extractor import RandomFeatureExtractor
 from tvm.s_tir.meta_schedule.runner import RunnerResult
@@ -146,6 +146,48 @@ def _dummy_result(num_samples: int = 4, max_run_sec: int = 10):
     return RunnerResult(list(np.random.rand(num_samples) * max_run_sec + 1e-6), None)
 
 
+def test_meta_schedule_gbdt_model():
+    extractor = RandomFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=2)
+    update_sample_count = 60
+    predict_sample_count = 100
+    for _ in range(3):
+        model.update(
+            TuneContext(),
+            [_dummy_candidate() for i in range(update_sample_count)],
+            [_dummy_result() for i in range(update_sample_count)],
+        )
+    assert model.data_size == 3 * update_sample_count
+    res = model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
+    assert res.shape == (predict_sample_count,)
+
+
+def test_meta_schedule_gbdt_model_reload():
+    extractor = RandomFeatureExtractor()
+    model = GBDTModel(extractor=extractor, num_warmup_samples=10)
+    update_sample_count = 20
+    predict_sample_count = 30
+    model.update(
+        TuneContext(),
+        [_dummy_candidate() for i in range(update_sample_count)],
+        [_dummy_result() for i in range(update_sample_count)],
+    )
+    with tempfile.NamedTemporaryFile() as path:
+        random_state = extractor.random_state  # save feature extractor's random state
+        model.save(path.name)
+        res1 = model.predict(
+            TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)]
+        )
+        new_model = GBDTModel(extractor=extractor, num_warmup_samples=10)
+        extractor.random_state = random_state  # load feature extractor's random state
+        new_model.load(path.name)
+        res2 = new_model.predict(
+            TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)]
+        )
+    assert new_model.data_size == update_sample_count
+    assert (res1 == res2).all()
+
+
 @requires_xgboost
 def test_meta_schedule_xgb_model():
     extractor = RandomFeatureExtractor()
@@ -588,6 +588,125 @@ def test_json_database_get_top_k(k, expected):
     assert result == expected
 
 
+@pytest.mark.parametrize(
+    "k,expected",
+    [
+        (0, []),
+        (4, [[0.0, 2.0], [2.0], [1.5, 4.5], [3.0, 1e10]]),
+        (5, [[0.0, 2.0], [2.0], [1.5, 4.5], [3.0, 1e10]]),
+    ],
+)
+def test_sharded_json_database_get_top_k(k, expected):
+    run_secs_list = [[1.5, 4.5], [], [0.0, 2.0], None, [2.0], [3.0, 1e10], [1e10]]
+    with tempfile.TemporaryDirectory() as tmpdir:
+        database = ms.database.ShardedJSONDatabase(osp.join(tmpdir, "db"), num_shards=4)
+        result = call_get_top_k(run_secs_list, database, k)
+    assert result == expected
+
+
+def test_sharded_json_database_reload():
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "db")
+        database = ms.database.ShardedJSONDatabase(path, num_shards=4)
+        call_get_top_k([[3.0], [1.0], [2.0]], database, 0)
+        call_get_top_k([[4.0]], database, 0)
+        # A line that a concurrent tuner is still appending is ignored.
+        for i in range(4):
+            with open(osp.join(path, f"records.{i}.json"), "a") as f:
+                f.write('["partial", ')
+        new_database = ms.database.ShardedJSONDatabase(path, num_shards=4)
+        workload = new_database.commit_workload(Matmul)
+        assert new_database.has_workload(Matmul)
+        assert len(new_database) == 4
+        top_k = new_database.get_top_k(workload, 2)
+        assert [[v.value for v in record.run_secs] for record in top_k] == [[1.0], [2.0]]
+
+
+@pytest.mark.parametrize(
+    "k,expected",
+    [
+        (0, []),
+        (4, [[0.0, 2.0], [2.0], [1.5, 4.5], [3.0, 1e10]]),
+        (5, [[0.0, 2.0], [2.0], [1.5, 4.5], [3.0, 1e10]]),
+    ],
+)
+def test_binary_database_get_top_k(k, expected):
+    run_secs_list = [[1.5, 4.5], [], [0.0, 2.0], None, [2.0], [3.0, 1e10], [1e10]]
+    with tempfile.TemporaryDirectory() as tmpdir:
+        database = ms.database.BinaryDatabase(osp.join(tmpdir, "database.bin"))
+        result = call_get_top_k(run_secs_list, database, k)
+    assert result == expected
+
+
+def test_binary_database_convert_and_reload():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        database = _create_tmp_database(tmpdir)
+        token = database.commit_workload(mod)
+        trace = _create_schedule(mod, _schedule_matmul).trace
+        records = [
+            ms.database.TuningRecord(
+                trace,
+                token,
+                run_secs,
+                tvm.target.Target("llvm"),
+                ms.arg_info.ArgInfo.from_prim_func(func=mod["main"]),
+            )
+            for run_secs in [[7.0, 8.0, 9.0], [1.0, 2.0, 3.0], [4.0, 5.0, 6.0]]
+        ]
+        for record in records:
+            database.commit_tuning_record(record)
+        path = osp.join(tmpdir, "database.bin")
+        ms.database.convert_json_to_binary(
+            database.path_workload, database.path_tuning_record, path
+        )
+        binary_database = ms.database.BinaryDatabase(path, allow_missing=False)
+        assert len(binary_database) == 3
+        assert binary_database.has_workload(mod)
+        token = binary_database.commit_workload(mod)
+        ret = binary_database.get_top_k(token, 2)
+        assert len(ret) == 2
+        _equal_record(ret[0], records[1])
+        _equal_record(ret[1], records[2])
+        # Records committed to the binary database survive a reload.
+        binary_database.commit_tuning_record(
+            ms.database.TuningRecord(
+                trace,
+                token,
+                [0.5],
+                tvm.target.Target("llvm"),
+                ms.arg_info.ArgInfo.from_prim_func(func=mod["main"]),
+            )
+        )
+        new_database = ms.database.BinaryDatabase(path, allow_missing=False)
+        assert len(new_database) == 4
+        ret = new_database.get_top_k(new_database.commit_workload(mod), 1)
+        assert [v.value for v in ret[0].run_secs] == [0.5]
+
+
+def test_binary_database_binary_workload_reload():
+    mod: IRModule = Matmul
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "database.bin")
+        database = ms.database.BinaryDatabase(path)
+        token = database.commit_workload(mod)
+        trace = _create_schedule(mod, _schedule_matmul).trace
+        record = ms.database.TuningRecord(
+            trace,
+            token,
+            [1.0],
+            tvm.target.Target("llvm"),
+            ms.arg_info.ArgInfo.from_prim_func(func=mod["main"]),
+        )
+        database.commit_tuning_record(record)
+        # The workload is stored in the binary IR form and loads back to the same module.
+        new_database = ms.database.BinaryDatabase(path, allow_missing=False)
+        assert new_database.has_workload(mod)
+        new_token = new_database.commit_workload(mod)
+        tvm.ir.assert_structural_equal(new_token.mod, mod)
+        _equal_record(new_database.get_top_k(new_token, 1)[0], record)
+
+
 def MatmulPrimFunc() -> IRModule:
     return Matmul
 
@@ -609,5 +728,19 @@ def test_memory_database_commit_workload(f_mod, mod_eq):
     database.commit_workload(mod)
 
 
+@pytest.mark.parametrize("mod_eq", ["structural", "ignore-tensor"])
+def test_memory_database_multi_function_workload(mod_eq):
+    def _make_mod(funcs):
+        return IRModule({name: func for name, func in funcs})
+
+    matmul, matmul_relu = Matmul["main"], MatmulRelu["main"]
+    database = ms.database.MemoryDatabase(module_equality=mod_eq)
+    database.commit_workload(_make_mod([("a", matmul), ("b", matmul_relu)]))
+    # Equal modules are found, regardless of the GlobalVars and the order of the functions
+    assert database.has_workload(_make_mod([("b", matmul_relu), ("a", matmul)]))
+    assert not database.has_workload(_make_mod([("a", matmul_relu), ("b", matmul)]))
+    assert not database.has_workload(_make_mod([("a", matmul), ("c", matmul_relu)]))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
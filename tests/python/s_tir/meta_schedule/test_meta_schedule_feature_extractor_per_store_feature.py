@@ -1641,5 +1641,26 @@ def test_negative_extent():
     assert named_features["B0.unique_bytes"] == 0
 
 
+
+def test_cached_features():
+    def _create_schedule(factor: int):
+        sch = tvm.s_tir.Schedule(matmul, debug_mask="all")
+        i, _, _ = sch.get_loops(sch.get_sblock("C"))
+        sch.split(i, factors=[None, factor])
+        return sch
+
+    context = _make_context(tvm.target.Target("llvm"))
+    extractor = ms.feature_extractor.PerStoreFeature()
+    uncached = ms.feature_extractor.PerStoreFeature(cache_size=0)
+    for _ in range(2):
+        # Structurally equal candidates hit the cache populated by the previous round.
+        candidates = [_make_candidate(lambda f=f: _create_schedule(f)) for f in [4, 8, 4]]
+        features = extractor.extract_from(context, candidates)
+        expected = uncached.extract_from(context, candidates)
+        assert len(features) == len(candidates)
+        for feature, desired in zip(features, expected):
+            assert_allclose(actual=feature.numpy(), desired=desired.numpy(), rtol=0, atol=0)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
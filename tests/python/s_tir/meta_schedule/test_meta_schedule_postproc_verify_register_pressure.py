@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+import tvm
+import tvm.testing
+from tvm.s_tir import meta_schedule as ms
+from tvm.script import tirx as T
+from tvm.target import Target
+
+
+def _create_context(mod, target) -> ms.TuneContext:
+    ctx = ms.TuneContext(
+        mod=mod,
+        target=target,
+        space_generator=ms.space_generator.PostOrderApply(
+            sch_rules=[],
+            postprocs=[ms.postproc.VerifyRegisterPressure()],
+            mutator_probs={},
+        ),
+        task_name="test",
+    )
+    return ctx
+
+
+# pylint: disable=invalid-name,no-member,line-too-long,too-many-nested-blocks,no-self-argument,not-callable
+# fmt: off
+
+
+@tvm.script.ir_module
+class Accumulate:
+    @T.prim_func(s_tir=True)
+    def main(A: T.Buffer((128,), "float32"), B: T.Buffer((128, 16), "float32"), C: T.Buffer((16,), "float32")) -> None:
+        T.func_attr({"global_symbol": "main", "tirx.noalias": True})
+        acc = T.sblock_alloc_buffer((16,), "float32", scope="local")
+        for k in range(128):
+            for j in T.serial(16, annotations={"pragma_auto_unroll_max_step": 16, "pragma_unroll_explicit": 1}):
+                with T.sblock("update"):
+                    vk = T.axis.reduce(128, k)
+                    vj = T.axis.spatial(16, j)
+                    T.reads(acc[vj], A[vk], B[vk, vj])
+                    T.writes(acc[vj])
+                    acc[vj] = acc[vj] + A[vk] * B[vk, vj]
+        for j in T.serial(16, annotations={"pragma_auto_unroll_max_step": 16, "pragma_unroll_explicit": 1}):
+            with T.sblock("store"):
+                vj = T.axis.spatial(16, j)
+                T.reads(acc[vj])
+                T.writes(C[vj])
+                C[vj] = acc[vj]
+
+
+# fmt: on
+# pylint: enable=invalid-name,no-member,line-too-long,too-many-nested-blocks,no-self-argument,not-callable
+
+
+def _unroll_steps(sch):
+    return [
+        int(sch.get(loop).annotations["pragma_auto_unroll_max_step"])
+        for block in ["update", "store"]
+        for loop in sch.get_loops(sch.get_sblock(block))
+        if "pragma_auto_unroll_max_step" in sch.get(loop).annotations
+    ]
+
+
+def test_clamp_unroll():
+    # Unrolled by 16, the 16 accumulators, A[k] and B[k, j] need 18 registers.
+    target = Target({"kind": "llvm", "num-vector-registers": 16})
+    ctx = _create_context(Accumulate, target)
+    sch = tvm.s_tir.Schedule(Accumulate, debug_mask="all")
+    assert ctx.space_generator.postprocs[0].apply(sch)
+    assert _unroll_steps(sch) == [8, 8]
+
+
+def test_enough_registers():
+    target = Target({"kind": "llvm", "num-vector-registers": 32})
+    ctx = _create_context(Accumulate, target)
+    sch = tvm.s_tir.Schedule(Accumulate, debug_mask="all")
+    assert ctx.space_generator.postprocs[0].apply(sch)
+    assert _unroll_steps(sch) == [16, 16]
+
+
+def test_reject_spilling_candidate():
+    # Even without unrolling, acc[j], A[k] and B[k, j] are live at once.
+    target = Target({"kind": "llvm", "num-vector-registers": 2})
+    ctx = _create_context(Accumulate, target)
+    sch = tvm.s_tir.Schedule(Accumulate, debug_mask="all")
+    assert not ctx.space_generator.postprocs[0].apply(sch)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
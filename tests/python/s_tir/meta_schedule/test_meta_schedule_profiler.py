@@ -16,6 +16,8 @@
 # under the License.
 """Test Meta Schedule Profiler"""
 
+import json
+import threading
 import time
 
 from tvm.s_tir import meta_schedule as ms
@@ -37,6 +39,35 @@ def test_meta_schedule_profiler_context_manager():
     assert 1.9 <= result["Level1"] <= 2.1
 
 
+def test_meta_schedule_profiler_chrome_trace():
+    def _worker():
+        with ms.Profiler.timeit("Worker"):
+            time.sleep(0.1)
+
+    with ms.Profiler() as profiler:
+        with ms.Profiler.task("task_0"):
+            with ms.Profiler.timeit("Level0"):
+                thread = threading.Thread(target=_worker)
+                thread.start()
+                thread.join()
+        with ms.Profiler.timeit("Level0"):
+            time.sleep(0.1)
+
+    # The scopes on the worker thread are traced, but not counted in the table
+    assert "Worker" not in profiler.get()
+    events = json.loads(profiler.chrome_trace())["traceEvents"]
+    scopes = [e for e in events if e["ph"] == "X"]
+    assert sorted(e["name"] for e in scopes) == ["Level0", "Level0", "Total", "Worker"]
+    level0 = [e for e in scopes if e["name"] == "Level0"]
+    assert level0[0]["args"]["task"] == "task_0"
+    assert "args" not in level0[1]
+    worker = next(e for e in scopes if e["name"] == "Worker")
+    assert worker["args"]["task"] == "task_0"
+    assert worker["tid"] != level0[0]["tid"]
+    assert level0[0]["ts"] <= worker["ts"]
+    assert worker["ts"] + worker["dur"] <= level0[0]["ts"] + level0[0]["dur"]
+
+
 def test_meta_schedule_no_context():
     with ms.Profiler.timeit("Level0"):
         assert ms.Profiler.current() is None
@@ -44,4 +75,5 @@ def test_meta_schedule_no_context():
 
 if __name__ == "__main__":
     test_meta_schedule_profiler_context_manager()
+    test_meta_schedule_profiler_chrome_trace()
     test_meta_schedule_no_context()
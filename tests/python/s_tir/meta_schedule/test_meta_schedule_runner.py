@@ -385,6 +385,44 @@ def test_meta_schedule_local_multiple_runs():
         _clean_build(builder_result.artifact_path)
 
 
+@pytest.mark.skip("Tuning test - launches runner")
+def test_meta_schedule_local_multi_device_runs():
+    """Test meta schedule local runner fanning out to several devices"""
+    builder = LocalBuilder()
+    (builder_result,) = builder.build([BuilderInput(MatmulModule, Target("llvm"))])
+    assert builder_result.artifact_path is not None
+    assert builder_result.error_msg is None
+
+    args_info = [
+        TensorInfo("float32", (MATMUL_N, MATMUL_N)),
+        TensorInfo("float32", (MATMUL_N, MATMUL_N)),
+        TensorInfo("float32", (MATMUL_N, MATMUL_N)),
+    ]
+    # The candidate with a missing artifact fails, which shows where each result lands.
+    artifact_paths = [builder_result.artifact_path, "missing", builder_result.artifact_path] * 2
+    runner_inputs = [RunnerInput(path, "llvm", args_info) for path in artifact_paths]
+
+    evaluator_config = EvaluatorConfig(
+        number=1,
+        repeat=1,
+        min_repeat_ms=0,
+        enable_cpu_cache_flush=False,
+    )
+    runner = LocalRunner(timeout_sec=100, evaluator_config=evaluator_config, device_ids=[0, 0])
+
+    runner_futures = runner.run(runner_inputs)
+    runner_results = [runner_future.result() for runner_future in runner_futures]
+
+    for path, runner_result in zip(artifact_paths, runner_results):
+        if path == "missing":
+            assert runner_result.error_msg is not None
+            assert runner_result.run_secs is None
+        else:
+            assert runner_result.error_msg is None
+            assert all(float(result) >= 0.0 for result in runner_result.run_secs)
+    _clean_build(builder_result.artifact_path)
+
+
 @pytest.mark.skip("Tuning test - launches runner")
 def test_meta_schedule_py_runner():
     """Test meta schedule PyRunner"""
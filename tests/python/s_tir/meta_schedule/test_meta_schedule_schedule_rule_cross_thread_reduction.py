@@ -17,6 +17,7 @@
 # pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
 
 import tvm
+from tvm import te
 from tvm.s_tir import meta_schedule as ms
 from tvm.s_tir.meta_schedule.testing import te_workload
 from tvm.s_tir.meta_schedule.testing.space_generation import (
@@ -769,9 +770,36 @@ def test_gpu_argmax_32():
     )
 
 
+def test_gpu_cluster_row_max():
+    A = te.placeholder((16, 131072), name="A")
+    k = te.reduce_axis((0, 131072), name="k")
+    B = te.compute((16,), lambda i: te.max(A[i, k], axis=k), name="B")
+    mod = create_prim_func([A, B])
+    rule = ms.schedule_rule.CrossThreadReduction(
+        thread_extents=[256, 1024], cluster_extents=[2, 4, 8]
+    )
+
+    def _sketches(target):
+        return generate_design_space(
+            kind="cuda",
+            mod=mod,
+            target=Target(target, host="llvm"),
+            types=None,
+            sch_rules=[rule],
+        )
+
+    # The rows are split across the thread blocks of a cluster only on sm_90 or higher.
+    assert len(_sketches("nvidia/geforce-rtx-3090")) == 2
+    sketches = _sketches("nvidia/nvidia-h100")
+    assert len(sketches) == 3
+    (cluster_sketch,) = [sch for sch in sketches if '"blockIdx.y"' in str(sch.trace)]
+    assert '"blockIdx.x"' in str(cluster_sketch.trace)
+
+
 if __name__ == "__main__":
     test_gpu_softmax_mn()
     test_gpu_softmax_mn_after_inline()
     test_gpu_batch_norm_bmn()
     test_gpu_argmax()
     test_gpu_argmax_32()
+    test_gpu_cluster_row_max()
@@ -753,6 +753,32 @@ def test_matmul_relu_non_tensorizable():
     tvm.ir.assert_structural_equal(mod, sch.mod["main"])
 
 
+def test_matmul_int4():
+    a = te.placeholder((128, 128), name="A", dtype="int4")
+    b = te.placeholder((128, 128), name="B", dtype="int4")
+    k = te.reduce_axis((0, 128), name="k")
+    c = te.compute(
+        (128, 128),
+        lambda i, j: te.sum(a[i, k].astype("int32") * b[j, k].astype("int32"), axis=[k]),
+        name="C",
+    )
+    (sch,) = generate_design_space(
+        kind="cuda",
+        mod=te.create_prim_func([a, b, c]),
+        target=tvm.target.Target({"kind": "cuda", "arch": "sm_80"}),
+        types=None,
+        sch_rules=[
+            multi_level_tiling_tensor_core(
+                write_reuse_scope="shared", in_dtype="int4", out_dtype="int32", trans_b=True
+            )
+        ]
+        + get_rules("cuda", ms.schedule_rule.AutoInline),
+    )
+    trace = str(sch.trace)
+    assert "wmma_sync_8x8x32_s4s4s32_trans" in trace
+    assert "wmma_load_8x8x32_s4_b_trans_shared" in trace
+
+
 def test_padded_matmul_relu():
     # fmt: off
     @T.prim_func(s_tir=True)
@@ -0,0 +1,89 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+import tvm
+import tvm.testing
+from tvm.s_tir import meta_schedule as ms
+from tvm.s_tir.meta_schedule.testing.space_generation import generate_design_space
+from tvm.script import tirx as T
+from tvm.target import Target
+
+# fmt: off
+# pylint: disable=no-member,invalid-name,unused-variable,no-self-argument
+
+
+@tvm.script.ir_module
+class Matmul:
+    @T.prim_func(s_tir=True)
+    def main(A: T.Buffer((512, 512), "float32"), B: T.Buffer((512, 512), "float32"), C: T.Buffer((512, 512), "float32")) -> None:
+        T.func_attr({"global_symbol": "main"})
+        for i, j, k in T.grid(512, 512, 512):
+            with T.sblock("matmul"):
+                vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                with T.init():
+                    C[vi, vj] = 0.0
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
+
+
+# pylint: enable=no-member,invalid-name,unused-variable,no-self-argument
+# fmt: on
+
+
+def _pipelined_loops(sch):
+    loops = []
+    for loop in sch.get_loops(sch.get_sblock("matmul")):
+        annotations = sch.get(loop).annotations
+        if "software_pipeline_prefetch" in annotations:
+            loops.append((sch.get(loop), list(annotations["software_pipeline_stage"])))
+    return loops
+
+
+def test_prefetch_pipeline_matmul():
+    target = Target("llvm --num-cores=16")
+    spaces = generate_design_space(
+        kind="llvm",
+        mod=Matmul,
+        target=target,
+        types=None,
+        sch_rules=[
+            ms.schedule_rule.MultiLevelTiling(structure="SSRSRS"),
+            ms.schedule_rule.PrefetchPipeline(prefetch_distances=[1, 2]),
+        ],
+    )
+    assert len(spaces) == 3
+    assert _pipelined_loops(spaces[0]) == []
+    for space, distance in zip(spaces[1:], [1, 2]):
+        ((loop, stages),) = _pipelined_loops(space)
+        assert stages == [distance]
+        # The outermost reduction loop is pipelined.
+        assert loop.loop_var.name == "k_0"
+
+
+def test_prefetch_pipeline_skips_untiled_blocks():
+    spaces = generate_design_space(
+        kind="llvm",
+        mod=Matmul,
+        target=Target("llvm --num-cores=16"),
+        types=None,
+        sch_rules=[ms.schedule_rule.PrefetchPipeline()],
+    )
+    assert len(spaces) == 1
+    assert _pipelined_loops(spaces[0]) == []
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
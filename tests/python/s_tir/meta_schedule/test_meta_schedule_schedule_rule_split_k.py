@@ -0,0 +1,105 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm.s_tir import meta_schedule as ms
+from tvm.s_tir.meta_schedule.testing import te_workload
+from tvm.s_tir.meta_schedule.testing.space_generation import generate_design_space
+from tvm.target import Target
+from tvm.te import create_prim_func
+
+
+def _design_space(mod, rule):
+    return generate_design_space(
+        kind="cuda",
+        mod=mod,
+        target=Target("nvidia/geforce-rtx-3090", host="llvm"),
+        types=None,
+        sch_rules=[rule],
+    )
+
+
+def _thread_bindings(sch, block_name):
+    bindings = []
+    for loop in sch.get_loops(sch.get_sblock(block_name)):
+        thread_binding = sch.get(loop).thread_binding
+        if thread_binding is not None:
+            bindings.append(thread_binding.thread_tag)
+    return bindings
+
+
+def _split(spaces):
+    """The split-K spaces, with an rfactor, and the original spaces."""
+    split_k = [sch for sch in spaces if any(i.kind.name == "RFactor" for i in sch.trace.insts)]
+    return split_k, [sch for sch in spaces if sch not in split_k]
+
+
+def test_skinny_matmul():
+    mod = create_prim_func(te_workload.matmul(n=4, m=64, k=8192))
+    spaces = _design_space(mod, ms.schedule_rule.SplitK(split_factors=[4, 8]))
+    assert len(spaces) == 2
+    (split_k,), (original,) = _split(spaces)
+    assert _thread_bindings(split_k, "C_rf") == ["blockIdx.x", "blockIdx.y", "threadIdx.x"]
+    assert _thread_bindings(split_k, "C") == ["blockIdx.x", "threadIdx.x"]
+    tvm.ir.assert_structural_equal(original.mod, mod)
+
+
+def test_skinny_matmul_stream_k():
+    mod = create_prim_func(te_workload.matmul(n=4, m=64, k=8192))
+    spaces = _design_space(mod, ms.schedule_rule.SplitK(stream_k_num_blocks=82))
+    assert len(spaces) == 3
+    split_k, _ = _split(spaces)
+    bindings = sorted(_thread_bindings(sch, "C_rf") for sch in split_k)
+    assert bindings == [
+        ["blockIdx.x", "blockIdx.y", "threadIdx.x"],
+        ["blockIdx.x", "threadIdx.x"],
+    ]
+
+
+def test_enough_spatial_parallelism():
+    mod = create_prim_func(te_workload.matmul(n=512, m=512, k=8192))
+    spaces = _design_space(mod, ms.schedule_rule.SplitK())
+    assert len(spaces) == 1
+    tvm.ir.assert_structural_equal(spaces[0].mod, mod)
+
+
+def test_short_reduction():
+    mod = create_prim_func(te_workload.matmul(n=4, m=64, k=256))
+    spaces = _design_space(mod, ms.schedule_rule.SplitK())
+    assert len(spaces) == 1
+
+
+@tvm.testing.requires_cuda
+def test_skinny_matmul_numeric():
+    mod = create_prim_func(te_workload.matmul(n=4, m=64, k=8192))
+    rule = ms.schedule_rule.SplitK(split_factors=[8], thread_extents=[128], stream_k_num_blocks=82)
+    a_np = np.random.uniform(-1, 1, size=(4, 8192)).astype("float32")
+    b_np = np.random.uniform(-1, 1, size=(8192, 64)).astype("float32")
+    dev = tvm.cuda()
+    for sch in _split(_design_space(mod, rule))[0]:
+        lib = tvm.compile(sch.mod, target="cuda")
+        a, b = tvm.runtime.tensor(a_np, dev), tvm.runtime.tensor(b_np, dev)
+        c = tvm.runtime.tensor(np.zeros((4, 64), "float32"), dev)
+        lib(a, b, c)
+        tvm.testing.assert_allclose(c.numpy(), a_np @ b_np, rtol=1e-4, atol=1e-3)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
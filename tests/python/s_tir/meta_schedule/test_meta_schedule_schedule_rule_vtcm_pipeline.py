@@ -0,0 +1,105 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+import tvm
+import tvm.testing
+from tvm.s_tir import meta_schedule as ms
+from tvm.s_tir.meta_schedule.testing.space_generation import generate_design_space
+from tvm.script import tirx as T
+from tvm.target import Target
+
+# fmt: off
+# pylint: disable=no-member,invalid-name,unused-variable,no-self-argument
+
+
+@tvm.script.ir_module
+class Matmul:
+    @T.prim_func(s_tir=True)
+    def main(A: T.Buffer((512, 512), "float16"), B: T.Buffer((512, 512), "float16"), C: T.Buffer((512, 512), "float16")) -> None:
+        T.func_attr({"global_symbol": "main"})
+        for i, j, k in T.grid(512, 512, 512):
+            with T.sblock("matmul"):
+                vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                with T.init():
+                    C[vi, vj] = T.float16(0)
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
+
+
+# pylint: enable=no-member,invalid-name,unused-variable,no-self-argument
+# fmt: on
+
+
+def _target():
+    return Target("qcom/hexagon-v68", host="llvm")
+
+
+def _vtcm_caches(sch):
+    return [
+        region
+        for region in sch.get(sch.get_sblock("matmul")).reads
+        if region.buffer.scope() == "global.vtcm"
+    ]
+
+
+def test_vtcm_pipeline_matmul():
+    spaces = generate_design_space(
+        kind="hexagon",
+        mod=Matmul,
+        target=_target(),
+        types=None,
+        sch_rules=[
+            ms.schedule_rule.MultiLevelTilingWideVector(
+                structure="SRSRS",
+                vector_length_in_bits=1024,
+                max_innermost_factor=128,
+                reuse_read=None,
+                reuse_write=None,
+            ),
+            ms.schedule_rule.VTCMPipeline(),
+        ],
+    )
+    assert len(spaces) == 2
+    assert _vtcm_caches(spaces[0]) == []
+    # Both operands are read from VTCM, copied by the async stage of the outermost reduction loop.
+    assert len(_vtcm_caches(spaces[1])) == 2
+    loops = spaces[1].get_loops(spaces[1].get_sblock("matmul"))
+    (pipelined,) = [
+        spaces[1].get(loop)
+        for loop in loops
+        if "software_pipeline_stage" in spaces[1].get(loop).annotations
+    ]
+    assert pipelined.loop_var.name == "k_0"
+    annotations = pipelined.annotations
+    assert list(annotations["software_pipeline_stage"]) == [0, 0, 1]
+    assert list(annotations["software_pipeline_order"]) == [0, 1, 2]
+    assert list(annotations["software_pipeline_async_stages"]) == [0]
+
+
+def test_vtcm_pipeline_skips_untiled_blocks():
+    spaces = generate_design_space(
+        kind="hexagon",
+        mod=Matmul,
+        target=_target(),
+        types=None,
+        sch_rules=[ms.schedule_rule.VTCMPipeline()],
+    )
+    assert len(spaces) == 1
+    assert _vtcm_caches(spaces[0]) == []
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
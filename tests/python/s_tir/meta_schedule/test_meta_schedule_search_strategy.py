@@ -19,6 +19,7 @@
 
 # pylint: disable=missing-function-docstring
 
+import numpy as np
 import pytest
 
 import tvm
@@ -50,6 +51,22 @@ class Matmul:
                 C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
 
 
+@tvm.script.ir_module
+class MatmulLarge:
+    @T.prim_func(s_tir=True)
+    def main(a: T.handle, b: T.handle, c: T.handle) -> None: # type: ignore
+        T.func_attr({"global_symbol": "main"})
+        A = T.match_buffer(a, (64, 64), "float32")
+        B = T.match_buffer(b, (64, 64), "float32")
+        C = T.match_buffer(c, (64, 64), "float32")
+        for i, j, k in T.grid(64, 64, 64):
+            with T.sblock("matmul"):
+                vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                with T.init():
+                    C[vi, vj] = 0.0 # type: ignore
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
+
+
 @tvm.script.ir_module
 class OtherBlock:
     @T.prim_func(s_tir=True)
@@ -382,6 +399,180 @@ def test_meta_schedule_evolutionary_search_skip_invalid_measured_trace():  # pyl
     assert candidates is not None
 
 
+def test_meta_schedule_evolutionary_search_skip_database_measured():  # pylint: disable = invalid-name
+    def _schedule_matmul_empty(sch: Schedule):
+        return sch
+
+    # The only schedule of the design space is already measured in a previous run.
+    database = ms.database.MemoryDatabase()
+    database.commit_tuning_record(
+        ms.database.TuningRecord(
+            trace=Schedule(Matmul).trace,
+            workload=database.commit_workload(Matmul),
+            run_secs=[0.1],
+            target=tvm.target.Target("llvm"),
+            args_info=ms.arg_info.ArgInfo.from_prim_func(func=Matmul["main"]),
+        )
+    )
+
+    context = ms.TuneContext(
+        mod=Matmul,
+        search_strategy=ms.search_strategy.EvolutionarySearch(
+            population_size=5,
+            init_measured_ratio=0.1,
+            init_min_unmeasured=50,
+            genetic_num_iters=3,
+            genetic_mutate_prob=0.5,
+            genetic_max_fail_count=10,
+            eps_greedy=0.9,
+        ),
+        space_generator=ms.space_generator.ScheduleFn(
+            sch_fn=_schedule_matmul_empty,
+            sch_rules=[],
+            postprocs=[],
+            mutator_probs={
+                DummyMutator(): 1.0,
+            },
+        ),
+        target=tvm.target.Target("llvm"),
+        num_threads=1,
+    )
+    strategy = context.search_strategy
+    strategy.pre_tuning(
+        max_trials=100,
+        num_trials_per_iter=10,
+        design_spaces=context.space_generator.generate_design_space(context.mod),
+        database=database,
+        cost_model=ms.cost_model.RandomModel(),
+    )
+    num_trials_each_iter: list[int] = []
+    candidates = strategy.generate_measure_candidates()
+    while candidates is not None:
+        num_trials_each_iter.append(len(candidates))
+        strategy.notify_runner_results(candidates, [])
+        candidates = strategy.generate_measure_candidates()
+    strategy.post_tuning()
+    assert num_trials_each_iter == [0, 0, 0, 0, 0]
+
+
+def test_meta_schedule_evolutionary_search_prune_design_spaces():  # pylint: disable = invalid-name
+    def _schedule_matmul_two_spaces(sch: Schedule):
+        tiled = sch.copy()
+        _schedule_matmul(tiled)
+        return [sch, tiled]
+
+    @derived_object
+    class PreferTiledModel(ms.cost_model.PyCostModel):
+        """A cost model that only likes the tiled schedules."""
+
+        def load(self, path: str) -> None:
+            pass
+
+        def save(self, path: str) -> None:
+            pass
+
+        def update(self, context, candidates, results) -> None:
+            pass
+
+        def predict(self, context, candidates) -> np.ndarray:
+            return np.array(
+                [1.0 if "split" in str(candidate.sch.trace) else 0.0 for candidate in candidates]
+            )
+
+    context = ms.TuneContext(
+        mod=Matmul,
+        search_strategy=ms.search_strategy.EvolutionarySearch(
+            population_size=5,
+            init_measured_ratio=0.1,
+            init_min_unmeasured=50,
+            genetic_num_iters=3,
+            genetic_mutate_prob=0.5,
+            genetic_max_fail_count=10,
+            eps_greedy=0.9,
+            design_space_keep_ratio=0.5,
+            design_space_prune_samples=4,
+        ),
+        space_generator=ms.space_generator.ScheduleFn(
+            sch_fn=_schedule_matmul_two_spaces,
+            sch_rules=[],
+            postprocs=[],
+            mutator_probs={
+                DummyMutator(): 1.0,
+            },
+        ),
+        target=tvm.target.Target("llvm"),
+        num_threads=1,
+    )
+    strategy = context.search_strategy
+    strategy.pre_tuning(
+        max_trials=10,
+        num_trials_per_iter=5,
+        design_spaces=context.space_generator.generate_design_space(context.mod),
+        database=ms.database.MemoryDatabase(),
+        cost_model=PreferTiledModel(),
+    )
+    # Only the tiled design space is left to sample from.
+    candidates = strategy.generate_measure_candidates()
+    assert candidates
+    for candidate in candidates:
+        assert "split" in str(candidate.sch.trace)
+    strategy.post_tuning()
+
+
+def test_meta_schedule_transfer_search():  # pylint: disable = invalid-name
+    # The database has a tuned record of the 32x32 shape variant of the 64x64 workload.
+    tuned = Schedule(Matmul)
+    _schedule_matmul(tuned)
+    database = ms.database.MemoryDatabase()
+    database.commit_tuning_record(
+        ms.database.TuningRecord(
+            trace=tuned.trace,
+            workload=database.commit_workload(Matmul),
+            run_secs=[0.1],
+            target=tvm.target.Target("llvm"),
+            args_info=ms.arg_info.ArgInfo.from_prim_func(func=Matmul["main"]),
+        )
+    )
+
+    context = ms.TuneContext(
+        mod=MatmulLarge,
+        space_generator=ms.space_generator.ScheduleFn(
+            sch_fn=_schedule_matmul,
+            sch_rules=[],
+            postprocs=[],
+            mutator_probs={},
+        ),
+        search_strategy=ms.search_strategy.TransferSearch(
+            ms.search_strategy.ReplayTrace(),
+            max_fine_tune_trials=4,
+        ),
+        target=tvm.target.Target("llvm"),
+        num_threads=1,
+    )
+    strategy = context.search_strategy
+    strategy.pre_tuning(
+        max_trials=20,
+        num_trials_per_iter=10,
+        design_spaces=context.space_generator.generate_design_space(context.mod),
+        database=database,
+        cost_model=None,
+    )
+    num_trials_each_iter: list[int] = []
+    candidates = strategy.generate_measure_candidates()
+    # The transferred schedule is measured first, before fine-tuning.
+    assert len(candidates) == 1
+    assert _is_trace_equal(candidates[0].sch, tuned)
+    while candidates is not None:
+        num_trials_each_iter.append(len(candidates))
+        runner_results: list[ms.runner.RunnerResult] = []
+        for _ in candidates:
+            runner_results.append(ms.runner.RunnerResult(run_secs=[0.5], error_msg=None))
+        strategy.notify_runner_results(candidates, runner_results)
+        candidates = strategy.generate_measure_candidates()
+    strategy.post_tuning()
+    assert num_trials_each_iter == [1, 4]
+
+
 def test_search_strategy_abstract_class_instantiation():
     """Test that directly instantiating abstract SearchStrategy raises TypeError instead of segfault."""
     from tvm.s_tir.meta_schedule import SearchStrategy, TuneContext
@@ -417,4 +608,7 @@ if __name__ == "__main__":
     test_meta_schedule_evolutionary_search()
     test_meta_schedule_evolutionary_search_early_stop()
     test_meta_schedule_evolutionary_search_fail_init_population()
+    test_meta_schedule_evolutionary_search_skip_database_measured()
+    test_meta_schedule_evolutionary_search_prune_design_spaces()
+    test_meta_schedule_transfer_search()
     test_search_strategy_abstract_class_instantiation()
@@ -246,6 +246,54 @@ def test_meta_schedule_task_scheduler_multiple():
         )
 
 
+@pytest.mark.parametrize(
+    "make_scheduler",
+    [
+        lambda: ms.task_scheduler.RoundRobin(pipeline_depth=2),
+        lambda: ms.task_scheduler.GradientBased(pipeline_depth=2),
+    ],
+)
+def test_meta_schedule_task_scheduler_pipelined(make_scheduler):
+    max_trials_per_task = 31
+    tasks = [
+        ms.TuneContext(
+            mod,
+            num_threads=1,
+            target=tvm.target.Target("llvm"),
+            space_generator=space,
+            search_strategy=ms.search_strategy.ReplayTrace(),
+            task_name=name,
+            rand_state=42,
+        )
+        for mod, space, name in [
+            (MatmulModule, _schedule_matmul, "Matmul"),
+            (MatmulReluModule, _schedule_matmul, "MatmulRelu"),
+            (BatchMatmulModule, _schedule_batch_matmul, "BatchMatmul"),
+        ]
+    ]
+    database = ms.database.MemoryDatabase()
+    scheduler = make_scheduler()
+    assert scheduler.pipeline_depth == 2
+    scheduler.tune(
+        tasks,
+        task_weights=[1.0, 1.0, 1.0],
+        builder=DummyBuilder(),
+        runner=DummyRunner(),
+        database=database,
+        measure_callbacks=[ms.measure_callback.AddToDatabase()],
+        max_trials_global=max_trials_per_task * len(tasks),
+        max_trials_per_task=max_trials_per_task,
+        num_trials_per_iter=6,
+        cost_model=None,
+    )
+    assert len(database) == max_trials_per_task * len(tasks)
+    for task in tasks:
+        assert (
+            len(database.get_top_k(database.commit_workload(task.mod), 10000))
+            == max_trials_per_task
+        )
+
+
 def test_meta_schedule_task_scheduler_NIE():  # pylint: disable=invalid-name
     @derived_object
     class NIETaskScheduler(ms.task_scheduler.PyTaskScheduler):
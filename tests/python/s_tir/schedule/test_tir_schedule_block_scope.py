@@ -153,5 +153,21 @@ def test_war_dependency():
     assert dep.kind == DepKind.WAR
 
 
+def test_unchanged_nested_scope_is_reused():
+    sch = tvm.s_tir.Schedule(elementwise, debug_mask="all")
+    _, j = sch.get_loops(sch.get_sblock("B"))
+    sch.blockize(j)
+    block_b_o = sch.get_sref(sch.get_sblock("B_o"))
+    scope_b_o = sch.state.get_sblock_scope(block_b_o)
+    # Blockizing "C" recomputes the root scope, where the subtree of "B_o" is unchanged
+    _, j = sch.get_loops(sch.get_sblock("C"))
+    sch.blockize(j)
+    assert sch.state.get_sblock_scope(block_b_o).same_as(scope_b_o)
+    root = sch.get_sref(sch.get_sblock("root"))
+    (dep,) = sch.state.get_sblock_scope(root).get_deps_by_src(block_b_o)
+    assert dep.dst.same_as(sch.get_sref(sch.get_sblock("C_o")))
+    assert dep.kind == DepKind.RAW
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -36,7 +36,12 @@ from tvm.s_tir.tensor_intrin.arm_cpu import (
 )
 from tvm.s_tir.tensor_intrin.hexagon import VDMPY_i16i16i32_INTRIN, VRMPY_u8u8i32_INTRIN
 from tvm.s_tir.tensor_intrin.rocm import AMDGPU_SDOT4_INTRIN
-from tvm.s_tir.tensor_intrin.x86 import AVX512_DOT_16x4_INTRIN, VNNI_DOT_16x4_INTRIN
+from tvm.s_tir.tensor_intrin.x86 import (
+    AMX_DOT_16x16x64_i8i8i32_INTRIN,
+    AMX_DOT_16x16x64_u8i8i32_INTRIN,
+    AVX512_DOT_16x4_INTRIN,
+    VNNI_DOT_16x4_INTRIN,
+)
 from tvm.script import tirx as T
 
 # fmt: off
@@ -631,6 +636,34 @@ def test_tensorize_avx512():
     tensorize_16x4_test(AVX512_DOT_16x4_INTRIN)
 
 
+def test_tensorize_amx():
+    m, n, k = 128, 128, 128
+
+    for lhs_type, intrin in [
+        ("uint8", AMX_DOT_16x16x64_u8i8i32_INTRIN),
+        ("int8", AMX_DOT_16x16x64_i8i8i32_INTRIN),
+    ]:
+        func = get_matmul_packed(m, n, k, lhs_type)
+
+        sch = tvm.s_tir.Schedule(func, debug_mask="all")
+        block = sch.get_sblock("compute")
+        # Each 16x64 tile of W is packed as [16, 16, 4] for the B tile of AMX.
+        sch.transform_layout(
+            block, "W", lambda i, j: [i // 16, j // 64, j % 64 // 4, i % 16, j % 4]
+        )
+        i, j, k = sch.get_loops(block)
+
+        io, ii = sch.split(i, factors=[None, 16])
+        jo, ji = sch.split(j, factors=[None, 16])
+        ko, ki = sch.split(k, factors=[None, 64])
+        sch.reorder(io, jo, ko, ii, ji, ki)
+
+        sch.decompose_reduction(block, ko)
+        sch.tensorize(ii, intrin)
+
+        verify_trace_roundtrip(sch=sch, mod=func)
+
+
 def test_tensorize_arm_dot():
     m, n, k = 128, 128, 128
 
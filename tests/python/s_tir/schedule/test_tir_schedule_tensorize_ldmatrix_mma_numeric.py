@@ -29,6 +29,8 @@ from tvm.s_tir.tensor_intrin.cuda import (
     LDMATRIX_f16_A_INTRIN,
     LDMATRIX_f16_B_INTRIN,
     LDMATRIX_f16_B_TRANS_INTRIN,
+    LDMATRIX_i4_A_INTRIN,
+    LDMATRIX_i4_B_TRANS_INTRIN,
     LDMATRIX_i8_A_INTRIN,
     LDMATRIX_i8_B_INTRIN,
     LDMATRIX_i8_B_TRANS_INTRIN,
@@ -41,6 +43,7 @@ from tvm.s_tir.tensor_intrin.cuda import (
     MMA_fill_16x16_f16_INTRIN,
     MMA_fill_16x16_f32_INTRIN,
     MMA_fill_16x16_i32_INTRIN,
+    MMA_i4i4i32_TRANS_B_INTRIN,
     MMA_i8i8i32_INTRIN,
     MMA_i8i8i32_TRANS_B_INTRIN,
     MMA_store_16x16_f16_global_INTRIN,
@@ -48,6 +51,7 @@ from tvm.s_tir.tensor_intrin.cuda import (
     MMA_store_16x16_i32_global_INTRIN,
     shared_16x16_to_ldmatrix_32x8_layout,
     shared_16x32_to_ldmatrix_32x16_layout,
+    shared_16x64_to_ldmatrix_32x32_layout,
     shared_32x16_to_ldmatrix_32x16_layout,
 )
 from tvm.testing import env
@@ -156,6 +160,9 @@ def run_test(
                 .astype(typemap[in_dtype])
             )
             c_np = np.dot(a_np.astype("float32"), b_np.astype("float32")).astype(out_dtype)
+    elif in_dtype == "int4":
+        # numpy has no int4, so the inputs are left uninitialized and only the run is checked.
+        a_np = b_np = c_np = None
     else:
         a_np = np.random.randint(-128, 128, (M, K)).astype("int8")
 
@@ -170,14 +177,18 @@ def run_test(
 
     def run_and_check(measure=False):
         dev = tvm.cuda(0)
-        a = tvm.runtime.tensor(a_np, dev)
-        b = tvm.runtime.tensor(b_np, dev)
+        if in_dtype == "int4":
+            a = tvm.runtime.empty((M, K), "int4", dev)
+            b = tvm.runtime.empty((N, K) if b_transposed else (K, N), "int4", dev)
+        else:
+            a = tvm.runtime.tensor(a_np, dev)
+            b = tvm.runtime.tensor(b_np, dev)
         c = tvm.runtime.tensor(np.zeros((M, N), dtype=out_dtype), dev)
         if measure:
             return f.time_evaluator(f.entry_name, dev, number=500)(a, b, c)
         f(a, b, c)
         dev.sync()
-        if out_dtype != "float16" and in_dtype not in ["float8_e4m3fn", "float8_e5m2"]:
+        if out_dtype != "float16" and in_dtype not in ["float8_e4m3fn", "float8_e5m2", "int4"]:
             tvm.testing.assert_allclose(c.numpy(), c_np, rtol=1e-2, atol=1e-2)
 
     tvm.testing.run_with_gpu_lock(run_and_check)
@@ -460,5 +471,50 @@ def test_e5m2e5m2f32_m16n16k32():
         print("e5m2e5m2f32_m16n16k32_trans: %f GOPS" % (gflops / (timer().mean)))
 
 
+
+@pytest.mark.gpu
+@pytest.mark.skipif(not env.has_cuda_compute(8), reason="need cuda compute >= 8.0")
+def test_i4i4i32_m16n16k64():
+    def index_map_A(i, j):
+        return (
+            i // 16,
+            j // 64,
+            *shared_16x64_to_ldmatrix_32x32_layout(i % 16, j % 64),
+        )
+
+    def index_map_C(i, j):
+        return (
+            i // 16,
+            j // 16,
+            *shared_16x16_to_ldmatrix_32x8_layout(i % 16, j % 16),
+        )
+
+    k_inner = 64
+    in_dtype = "int4"
+    out_dtype = "int32"
+    i_factors, j_factors, k_factors = [1, 32, 1, 4, 2], [8, 4, 4, 2, 1], [16, 2, 2]
+
+    timer = run_test(
+        k_inner,
+        in_dtype,
+        out_dtype,
+        True,  # b_transposed
+        i_factors,
+        j_factors,
+        k_factors,
+        index_map_A,
+        index_map_A,
+        index_map_C,
+        LDMATRIX_i4_A_INTRIN,
+        LDMATRIX_i4_B_TRANS_INTRIN,
+        MMA_i4i4i32_TRANS_B_INTRIN,
+        MMA_fill_16x16_i32_INTRIN,
+        MMA_store_16x16_i32_global_INTRIN,
+    )
+
+    if measure_perf and timer:
+        print("i4i4i32_m16n16k64_trans: %f GOPS" % (gflops / (timer().mean)))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
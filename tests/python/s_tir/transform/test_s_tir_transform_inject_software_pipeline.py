@@ -1820,5 +1820,120 @@ def test_less_loop_than_num_stage_dynamic():
     _check(before, after)
 
 
+def test_cpu_prefetch_pipeline():
+    @T.prim_func(s_tir=True)
+    def before(A: T.Buffer((16, 32), "float32"), C: T.Buffer((32,), "float32")):
+        for k in T.serial(
+            0,
+            16,
+            annotations={"software_pipeline_stage": [2], "software_pipeline_prefetch": 1},
+        ):
+            for j in range(32):
+                with T.sblock("update"):
+                    T.reads(A[k, j], C[j])
+                    T.writes(C[j])
+                    C[j] = C[j] + A[k, j]
+
+    mod = tvm.IRModule.from_expr(before.with_attr("global_symbol", "main"))
+    mod = tvm.s_tir.transform.InjectSoftwarePipeline()(mod)
+
+    loops = []
+    guards = []
+    prefetches = []
+
+    def fvisit(node):
+        if isinstance(node, tvm.tirx.For) and node.loop_var.name == "k":
+            loops.append(node)
+        elif isinstance(node, tvm.tirx.IfThenElse):
+            guards.append(node)
+        elif isinstance(node, tvm.tirx.Call) and node.op.name == "tirx.prefetch":
+            prefetches.append(node)
+
+    tvm.tirx.stmt_functor.post_order_visit(mod["main"].body, fvisit)
+    # The statements keep their order and no buffers are multi-versioned.
+    assert len(loops) == 1
+    assert "software_pipeline_stage" not in loops[0].annotations
+    assert "software_pipeline_prefetch" not in loops[0].annotations
+    # The rows of A and C read two iterations ahead, one call per 64-byte line.
+    assert len(guards) == 1
+    tvm.ir.assert_structural_equal(guards[0].condition, loops[0].loop_var + 2 < 16)
+    assert len(prefetches) == 2
+    loads = [call.args[0].args[0] for call in prefetches]
+    assert sorted(load.buffer.name for load in loads) == ["A", "C"]
+
+
+def _warp_specialized_pipeline(producer_scope):
+    @T.prim_func(s_tir=True)
+    def func(A: T.Buffer((16, 4, 32), "float32"), C: T.Buffer((16, 4, 32), "float32")):
+        for ty in T.thread_binding(4, thread="threadIdx.y"):
+            for tx in T.thread_binding(32, thread="threadIdx.x"):
+                for k in T.serial(
+                    0,
+                    16,
+                    annotations={
+                        "software_pipeline_stage": [0, 1],
+                        "software_pipeline_warp_specialize": [2, 4, 40, 232],
+                    },
+                ):
+                    with T.sblock():
+                        T.reads(A[k, ty, tx])
+                        T.writes(C[k, ty, tx])
+                        B = T.sblock_alloc_buffer((4, 32), dtype="float32", scope=producer_scope)
+                        with T.sblock():
+                            T.reads(A[k, ty, tx])
+                            T.writes(B[ty, tx])
+                            B[ty, tx] = A[k, ty, tx]
+                        with T.sblock():
+                            T.reads(B[ty, 31 - tx])
+                            T.writes(C[k, ty, tx])
+                            C[k, ty, tx] = B[ty, 31 - tx] * T.float32(2)
+
+    return func
+
+
+def test_warp_specialized_pipeline():
+    func = _warp_specialized_pipeline("shared")
+    mod = tvm.IRModule.from_expr(func.with_attr("global_symbol", "main"))
+    mod = tvm.s_tir.transform.InjectSoftwarePipeline()(mod)
+
+    thread_extents = {}
+    loops = []
+    scopes = []
+    calls = {}
+    allocs = {}
+
+    def fvisit(node):
+        if isinstance(node, tvm.tirx.For) and node.thread_binding is not None:
+            thread_extents[node.thread_binding.thread_tag] = int(node.extent)
+        elif isinstance(node, tvm.tirx.For) and node.loop_var.name.startswith("k"):
+            loops.append(node)
+        elif isinstance(node, tvm.tirx.AttrStmt) and node.attr_key == "named_barrier_scope":
+            scopes.append((int(node.node), int(node.value)))
+        elif isinstance(node, tvm.tirx.Call) and node.op.name.startswith("tirx.ptx."):
+            calls.setdefault(node.op.name, []).append(node)
+        elif isinstance(node, tvm.tirx.SBlock):
+            for buffer in node.alloc_buffers:
+                allocs[buffer.name] = [int(dim) for dim in buffer.shape]
+
+    tvm.tirx.stmt_functor.post_order_visit(mod["main"].body, fvisit)
+    # Four producer warps run after the four consumer warps.
+    assert thread_extents == {"threadIdx.y": 8, "threadIdx.x": 32}
+    assert sorted(scopes) == [(1, 128), (2, 128)]
+    # Each role runs the pipeline loop, with two versions of the shared buffer.
+    assert len(loops) == 2
+    assert all("software_pipeline_stage" not in loop.annotations for loop in loops)
+    assert allocs["B"] == [2, 4, 32]
+    assert allocs["full_barrier"] == [2] and allocs["empty_barrier"] == [2]
+    assert [int(call.args[1]) for call in calls["tirx.ptx.mbarrier_init"]] == [128] * 4
+    assert len(calls["tirx.ptx.mbarrier_try_wait"]) == 2
+    assert len(calls["tirx.ptx.mbarrier_arrive"]) == 2
+    regs = sorted((bool(call.args[0]), int(call.args[1])) for call in calls["tirx.ptx.setmaxnreg"])
+    assert regs == [(False, 40), (True, 232)]
+
+
+def test_error_warp_specialized_pipeline_local_producer():
+    _check_error(_warp_specialized_pipeline("local"))
+
+
 if __name__ == "__main__":
     tvm.testing.main()
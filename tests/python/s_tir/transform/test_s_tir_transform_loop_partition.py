@@ -70,6 +70,33 @@ def test_multi_if():
     assert not any(collect_visit(stmt.body[0], lambda x: isinstance(x, tvm.tirx.IfThenElse)))
 
 
+def test_max_code_growth():
+    @T.prim_func(s_tir=True)
+    def func(n: T.int64, m: T.int64):
+        for i in range(4):
+            for j in T.serial(n):
+                for k in T.serial(m):
+                    if T.likely(i * m + j + k < n):
+                        T.evaluate(m)
+                    else:
+                        T.evaluate(n)
+
+    def partition(max_code_growth):
+        mod = tvm.IRModule.from_expr(func.with_attr("global_symbol", "main"))
+        config = {"s_tir.LoopPartition": {"max_code_growth": max_code_growth}}
+        with tvm.transform.PassContext(config=config):
+            return tvm.s_tir.transform.LoopPartition()(mod)["main"]
+
+    # No budget for any growth keeps the condition as a predicate.
+    f = partition(1.0)
+    assert any(collect_visit(f.body, lambda x: isinstance(x, tvm.tirx.IfThenElse)))
+    assert f.attrs["s_tir.loop_partition_code_growth"].value == 1.0
+
+    # A large budget allows the partition.
+    f = partition(100.0)
+    assert 1.0 < f.attrs["s_tir.loop_partition_code_growth"].value <= 100.0
+
+
 def test_condition():
     @T.prim_func(s_tir=True)
     def func(m: T.int64, n: T.int64):
@@ -519,5 +519,46 @@ def test_webgpu_multi_warp_reduce():
     assert "T.uint32(" not in After_script
 
 
+def test_cluster_reduce():
+    transform = tvm.s_tir.transform.LowerThreadAllreduce()
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(private=True, s_tir=True)
+        def main(A: T.Buffer((16, 8192), "float32"), B: T.Buffer((16,), "float32")):
+            T.func_attr({"target": T.target("nvidia/nvidia-h100", host="llvm")})
+            blockIdx_y = T.launch_thread("blockIdx.y", 16)
+            blockIdx_x = T.launch_thread("blockIdx.x", 4)
+            threadIdx_x = T.launch_thread("threadIdx.x", 1024)
+            cross_thread_B = T.alloc_buffer((1,), scope="local")
+            cross_thread_B_1 = T.decl_buffer((1,), data=cross_thread_B.data, scope="local")
+            with T.attr(
+                T.comm_reducer(lambda x0, y0: T.max(x0, y0), [T.float32(-3.4e38)]),
+                "reduce_scope",
+                T.int32(0),
+            ):
+                A_1 = T.decl_buffer((131072,), data=A.data)
+                T.tvm_thread_allreduce(
+                    T.uint32(1),
+                    A_1[blockIdx_y * 8192 + blockIdx_x * 2048 + threadIdx_x],
+                    T.bool(True),
+                    cross_thread_B_1[0],
+                    blockIdx_x,
+                    threadIdx_x,
+                )
+            if blockIdx_x == 0 and threadIdx_x == 0:
+                B_1 = T.decl_buffer((16,), data=B.data)
+                B_1[blockIdx_y] = cross_thread_B_1[0]
+
+    After = transform(Before)
+    After_script = After.script()
+    # The thread blocks along blockIdx.x are launched as one cluster, and exchange their results
+    # through the distributed shared memory after the reduction inside each thread block.
+    assert "clusterCtaIdx.x" in After_script
+    assert "tvm_warp_shuffle_down" in After_script
+    assert "mapa" in After_script
+    assert "cluster_sync" in After_script
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -16,6 +16,7 @@
 # under the License.
 # ruff: noqa: F401, F841
 import numpy as np
+import pytest
 
 import tvm
 import tvm.testing
@@ -345,5 +346,53 @@ def test_multi_thread_extent_blocks():
     split(mod_with_target)
 
 
+def test_packing_reuses_across_sizes():
+    """The offset packer places two small buffers in the space of one large dead buffer."""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main():
+            threadIdx_x = T.launch_thread("threadIdx.x", 128)
+            A_sh = T.alloc_buffer((256,), "float32", scope="shared.dyn")
+            B_sh = T.alloc_buffer((128,), "float32", scope="shared.dyn")
+            C_sh = T.alloc_buffer((128,), "float32", scope="shared.dyn")
+            A_sh[threadIdx_x] = T.float32(0)
+            B_sh[threadIdx_x] = T.float32(1)
+            C_sh[threadIdx_x] = T.float32(2)
+            B_sh[threadIdx_x] = B_sh[threadIdx_x] + C_sh[threadIdx_x]
+
+    def merged_script(packing):
+        with tvm.transform.PassContext(config={"tirx.merge_smem_packing": packing}):
+            return tvm.s_tir.transform.MergeSharedMemoryAllocations()(Before)["main"].script()
+
+    # The default planner stacks B_sh on A_sh and appends C_sh.
+    assert "alloc_buffer((1536,)" in merged_script(False)
+    # Packing puts B_sh and C_sh side by side in the space of A_sh.
+    assert "alloc_buffer((1024,)" in merged_script(True)
+
+
+@pytest.mark.parametrize("align, total_bytes", [(16, 1040), (128, 1152)])
+def test_packing_aligns_async_copies(align, total_bytes):
+    """Destinations of cp.async are aligned to the configured number of bytes."""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(A: T.Buffer((128,), "float32")):
+            threadIdx_x = T.launch_thread("threadIdx.x", 128)
+            X_sh = T.alloc_buffer((130,), "float32", scope="shared.dyn")
+            Y_sh = T.alloc_buffer((128,), "float32", scope="shared.dyn")
+            X_sh[threadIdx_x] = T.float32(0)
+            T.ptx.cp_async("float32", Y_sh.data, threadIdx_x, A.data, threadIdx_x, 4)
+            X_sh[threadIdx_x] = X_sh[threadIdx_x] + Y_sh[threadIdx_x]
+
+    config = {"tirx.merge_smem_packing": True, "tirx.merge_smem_async_copy_align": align}
+    with tvm.transform.PassContext(config=config):
+        After = tvm.s_tir.transform.MergeSharedMemoryAllocations()(Before)
+    # X_sh takes the first 520 bytes and Y_sh starts at the next aligned offset.
+    assert f"alloc_buffer(({total_bytes},)" in After["main"].script()
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -181,9 +181,92 @@ def test_sync_bind():
     tvm.ir.assert_structural_equal(mod["main"], expected)
 
 
+def test_sync_thread_disjoint_affine_index():
+    @T.prim_func(private=True, s_tir=True)
+    def func(A: T.Buffer((32,), "float32"), B: T.Buffer((32,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 16)
+        S = T.alloc_buffer((34,), "float32", scope="shared")
+        S_1 = T.decl_buffer((34,), data=S.data, scope="shared")
+        S_1[threadIdx_x * 2] = A[threadIdx_x]
+        B[threadIdx_x] = S_1[threadIdx_x * 2]
+        S_1[threadIdx_x * 2 + 1] = A[threadIdx_x + 16]
+        B[threadIdx_x + 16] = S_1[threadIdx_x * 2 + 2]
+
+    @T.prim_func(private=True, s_tir=True)
+    def expected(A: T.Buffer((32,), "float32"), B: T.Buffer((32,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 16)
+        S = T.alloc_buffer((34,), "float32", scope="shared")
+        S_1 = T.decl_buffer((34,), data=S.data, scope="shared")
+        S_1[threadIdx_x * 2] = A[threadIdx_x]
+        B[threadIdx_x] = S_1[threadIdx_x * 2]
+        # The odd elements written by a thread are never read by the others.
+        S_1[threadIdx_x * 2 + 1] = A[threadIdx_x + 16]
+        T.evaluate(T.call_intrin("int32", "tirx.tvm_storage_sync", "shared"))
+        B[threadIdx_x + 16] = S_1[threadIdx_x * 2 + 2]
+
+    mod = tvm.IRModule({"main": func})
+    mod = tvm.s_tir.transform.ThreadSync("shared")(mod)
+    tvm.ir.assert_structural_equal(mod["main"], expected)
+
+
+def test_sync_merge_adjacent_barriers():
+    @T.prim_func(private=True, s_tir=True)
+    def func(A: T.Buffer((16,), "float32"), B: T.Buffer((16,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 16)
+        S = T.alloc_buffer((16,), "float32", scope="shared")
+        S_1 = T.decl_buffer((16,), data=S.data, scope="shared")
+        S_1[threadIdx_x] = A[threadIdx_x]
+        T.evaluate(T.call_intrin("int32", "tirx.tvm_storage_sync", "shared"))
+        T.evaluate(T.call_intrin("int32", "tirx.tvm_storage_sync", "shared"))
+        B[threadIdx_x] = S_1[15 - threadIdx_x]
+
+    @T.prim_func(private=True, s_tir=True)
+    def expected(A: T.Buffer((16,), "float32"), B: T.Buffer((16,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 16)
+        S = T.alloc_buffer((16,), "float32", scope="shared")
+        S_1 = T.decl_buffer((16,), data=S.data, scope="shared")
+        S_1[threadIdx_x] = A[threadIdx_x]
+        T.evaluate(T.call_intrin("int32", "tirx.tvm_storage_sync", "shared"))
+        B[threadIdx_x] = S_1[15 - threadIdx_x]
+
+    mod = tvm.IRModule({"main": func})
+    mod = tvm.s_tir.transform.ThreadSync("shared")(mod)
+    tvm.ir.assert_structural_equal(mod["main"], expected)
+
+
+def test_sync_named_barrier_scope():
+    @T.prim_func(private=True, s_tir=True)
+    def func(A: T.Buffer((256,), "float32"), B: T.Buffer((256,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 256)
+        S = T.alloc_buffer((128,), "float32", scope="shared")
+        S_1 = T.decl_buffer((128,), data=S.data, scope="shared")
+        if threadIdx_x >= 128:
+            with T.attr(T.int32(1), "named_barrier_scope", 128):
+                S_1[threadIdx_x - 128] = A[threadIdx_x]
+                B[threadIdx_x] = S_1[255 - threadIdx_x]
+
+    @T.prim_func(private=True, s_tir=True)
+    def expected(A: T.Buffer((256,), "float32"), B: T.Buffer((256,), "float32")):
+        threadIdx_x = T.launch_thread("threadIdx.x", 256)
+        S = T.alloc_buffer((128,), "float32", scope="shared")
+        S_1 = T.decl_buffer((128,), data=S.data, scope="shared")
+        if threadIdx_x >= 128:
+            with T.attr(T.int32(1), "named_barrier_scope", 128):
+                S_1[threadIdx_x - 128] = A[threadIdx_x]
+                T.evaluate(T.call_intrin("int32", "tirx.tvm_storage_sync", "shared", 1, 128))
+                B[threadIdx_x] = S_1[255 - threadIdx_x]
+
+    mod = tvm.IRModule({"main": func})
+    mod = tvm.s_tir.transform.ThreadSync("shared")(mod)
+    tvm.ir.assert_structural_equal(mod["main"], expected)
+
+
 if __name__ == "__main__":
     test_thread_storage_sync()
     test_sync_else_branch()
     test_sync_read_thread_id_independent_location()
     test_sync_shared_dyn()
     test_sync_bind()
+    test_sync_thread_disjoint_affine_index()
+    test_sync_merge_adjacent_barriers()
+    test_sync_named_barrier_scope()
@@ -754,6 +754,69 @@ def test_no_lift_bool_logical():
     assert "cse_v" not in after["main"].script()
 
 
+# =====================================================================
+# T24: Loop-invariant hoisting
+# A single-use expression of the outer loop var is hoisted out of the
+# inner loop, and its sub-expressions are not bound separately.
+# =====================================================================
+def test_hoist_loop_invariant():
+    @tvm.script.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(B: T.Buffer((8, 64), "int32"), n: T.int32):
+            for i in range(8):
+                for j in range(64):
+                    B[i, j] = (i * n + 3) * 7 + j
+
+    @tvm.script.ir_module
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def main(B: T.Buffer((8, 64), "int32"), n: T.int32):
+            for i in range(8):
+                cse_v1 = T.bind((i * n + 3) * 7)
+                for j in range(64):
+                    B[i, j] = cse_v1 + j
+
+    # Hoisting is opt-in, so the default pass leaves single uses alone.
+    tvm.ir.assert_structural_equal(tvm.tirx.transform.CommonSubexprElim()(Before), Before)
+    config = {"tirx.CommonSubexprElim": {"hoist_loop_invariant": True}}
+    with tvm.transform.PassContext(config=config):
+        after = tvm.tirx.transform.CommonSubexprElim()(Before)
+    tvm.ir.assert_structural_equal(after, Expected)
+
+
+# =====================================================================
+# T25: Loop-invariant hoisting is bounded on GPU targets
+# Only max_hoisted_per_loop bindings are hoisted in front of a loop.
+# =====================================================================
+def test_hoist_loop_invariant_bounded_on_gpu():
+    @tvm.script.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(B: T.Buffer((16, 64), "int32"), n: T.int32, m: T.int32):
+            T.func_attr({"target": T.target("cuda")})
+            for i in range(8):
+                for j in range(64):
+                    B[i, j] = (i * n + 3) * 7 + j
+                    B[i + 8, j] = (i * m + 5) * 9 + j
+
+    @tvm.script.ir_module
+    class Expected:
+        @T.prim_func(s_tir=True)
+        def main(B: T.Buffer((16, 64), "int32"), n: T.int32, m: T.int32):
+            T.func_attr({"target": T.target("cuda")})
+            for i in range(8):
+                cse_v1 = T.bind((i * n + 3) * 7)
+                for j in range(64):
+                    B[i, j] = cse_v1 + j
+                    B[i + 8, j] = (i * m + 5) * 9 + j
+
+    config = {"tirx.CommonSubexprElim": {"hoist_loop_invariant": True, "max_hoisted_per_loop": 1}}
+    with tvm.transform.PassContext(config=config):
+        after = tvm.tirx.transform.CommonSubexprElim()(Before)
+    tvm.ir.assert_structural_equal(after, Expected)
+
+
 if __name__ == "__main__":
     test_basic()
     test_if_single_branch()
@@ -778,3 +841,5 @@ if __name__ == "__main__":
     test_let_floordiv_pattern()
     test_no_lift_bool_predicate()
     test_no_lift_bool_logical()
+    test_hoist_loop_invariant()
+    test_hoist_loop_invariant_bounded_on_gpu()
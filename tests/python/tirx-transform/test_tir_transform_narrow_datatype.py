@@ -318,5 +318,35 @@ def test_narrow_i64_valued_bufferload_index_to_i32():
     tvm.ir.assert_structural_equal(after, expect.with_attr("global_symbol", "main"))
 
 
+
+def test_narrow_with_runtime_check():
+    @T.prim_func(s_tir=True)
+    def func(A: T.handle("float32"), B: T.handle("float32"), m: T.int64, n: T.int64):
+        A_buf = T.decl_buffer((m * n,), "float32", data=A)
+        B_buf = T.decl_buffer((m * n,), "float32", data=B)
+        for i in T.serial(m):
+            for j in T.serial(n):
+                B_buf[i * n + j] = A_buf[i * n + j] + T.float32(1)
+
+    mod = tvm.IRModule.from_expr(func.with_attr("global_symbol", "main"))
+    with tvm.transform.PassContext(config={"tirx.narrow_datatype_runtime_check": True}):
+        body = tvm.tirx.transform.NarrowDataType(32)(mod)["main"].body
+    assert isinstance(body, tvm.tirx.IfThenElse)
+
+    def loop_dtypes(stmt):
+        dtypes = []
+
+        def fvisit(node):
+            if isinstance(node, tvm.tirx.For):
+                dtypes.append(node.loop_var.ty.dtype)
+
+        tvm.tirx.stmt_functor.post_order_visit(stmt, fvisit)
+        return dtypes
+
+    assert loop_dtypes(body.then_case) == ["int32", "int32"]
+    assert loop_dtypes(body.else_case) == ["int64", "int64"]
+    binds = [stmt for stmt in body.then_case if isinstance(stmt, tvm.tirx.Bind)]
+    assert [bind.var.ty.dtype for bind in binds] == ["int32", "int32"]
+
 if __name__ == "__main__":
     tvm.testing.main()
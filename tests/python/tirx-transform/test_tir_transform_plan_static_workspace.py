@@ -0,0 +1,146 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import tvm
+import tvm.testing
+from tvm.script import ir as I
+from tvm.script import tirx as T
+
+
+def _plan(mod):
+    After = tvm.tirx.transform.PlanStaticWorkspace()(mod)
+    lowered = tvm.tirx.transform.LowerTVMBuiltin()(After).script()
+    assert "TVMBackendAllocWorkspace" not in lowered
+    return After, int(After.attrs["tirx.static_workspace_bytes"])
+
+
+def test_disjoint_lifetimes_share_memory():
+    """Allocations that are not live at the same time get the same offset"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func
+        def main(A: T.Buffer((512,), "float32")):
+            T.func_attr({"target": T.target("c")})
+            a = T.alloc_buffer((512,), "float32")
+            for i in range(512):
+                a[i] = A[i]
+            for i in range(512):
+                A[i] = a[i] * T.float32(2)
+            b = T.alloc_buffer((512,), "float32")
+            for i in range(512):
+                b[i] = A[i]
+            for i in range(512):
+                A[i] = b[i] + T.float32(1)
+
+    After, nbytes = _plan(Before)
+    assert nbytes == 2048
+    assert After.script().count("tirx.static_workspace_ptr") == 2
+
+
+def test_overlapping_lifetimes():
+    """Allocations that are live at the same time get disjoint offsets"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func
+        def main(A: T.Buffer((512,), "float32")):
+            T.func_attr({"target": T.target("c")})
+            a = T.alloc_buffer((512,), "float32")
+            b = T.alloc_buffer((256,), "float64")
+            for i in range(512):
+                a[i] = A[i]
+            for i in range(256):
+                b[i] = T.Cast("float64", a[i])
+            for i in range(256):
+                A[i] = T.Cast("float32", b[i]) + a[i + 256]
+
+    _, nbytes = _plan(Before)
+    assert nbytes == 4096
+
+
+def test_loop_carried_lifetime():
+    """An allocation used across loop iterations does not share memory with the body"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func
+        def main(A: T.Buffer((512,), "float32")):
+            T.func_attr({"target": T.target("c")})
+            acc = T.alloc_buffer((512,), "float32")
+            for k in range(4):
+                for i in range(512):
+                    acc[i] = acc[i] + A[i]
+                tmp = T.alloc_buffer((512,), "float32")
+                for i in range(512):
+                    tmp[i] = A[i] * T.float32(2)
+                for i in range(512):
+                    A[i] = tmp[i]
+
+    _, nbytes = _plan(Before)
+    assert nbytes == 4096
+
+
+def test_callee_follows_caller():
+    """The region of a subroutine does not overlap the region of its caller"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func
+        def main(A: T.Buffer((512,), "float32")):
+            T.func_attr({"target": T.target("c"), "global_symbol": "main"})
+            a = T.alloc_buffer((512,), "float32")
+            for i in range(512):
+                a[i] = A[i]
+            Before.subroutine(A.data)
+            for i in range(512):
+                A[i] = A[i] + a[i]
+
+        @T.prim_func(private=True)
+        def subroutine(A_data: T.handle("float32")):
+            T.func_attr({"target": T.target("c")})
+            A = T.decl_buffer(512, "float32", data=A_data)
+            b = T.alloc_buffer((1024,), "float32")
+            for i in range(512):
+                b[i] = A[i]
+            for i in range(512):
+                A[i] = b[i] * T.float32(2)
+
+    _, nbytes = _plan(Before)
+    assert nbytes == 2048 + 4096
+
+
+def test_non_c_target_is_unchanged():
+    """Only the functions of the C host target are planned"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func
+        def main(A: T.Buffer((512,), "float32")):
+            T.func_attr({"target": T.target("llvm")})
+            a = T.alloc_buffer((512,), "float32")
+            for i in range(512):
+                a[i] = A[i]
+            for i in range(512):
+                A[i] = a[i]
+
+    After = tvm.tirx.transform.PlanStaticWorkspace()(Before)
+    tvm.ir.assert_structural_equal(After, Before)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
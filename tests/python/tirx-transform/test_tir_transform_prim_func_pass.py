@@ -16,6 +16,7 @@
 # under the License.
 import tvm
 import tvm.testing
+from tvm.support import utils
 
 
 def test_prim_func_pass():
@@ -62,6 +63,56 @@ def test_cow_pass():
     assert func_hash == mod["main"].__hash__()
 
 
+def test_thread_safe_pass_on_threads():
+    funcs = {}
+    for i in range(8):
+        x = tvm.tirx.Var("x", "int32")
+        stmt = tvm.tirx.Evaluate(x * 1 + (i + 1) - (i + 1))
+        funcs[f"func{i}"] = tvm.tirx.PrimFunc([x], stmt)
+    mod = tvm.IRModule(funcs)
+    expected = tvm.tirx.transform.StmtSimplify()(mod)
+
+    @tvm.instrument.pass_instrument
+    class CountRuns:
+        def __init__(self):
+            self.num_runs = 0
+
+        def run_before_pass(self, mod, info):
+            if info.name == "tirx.StmtSimplify":
+                self.num_runs += 1
+
+    counter = CountRuns()
+    config = {"tirx.num_function_pass_threads": 4}
+    with tvm.transform.PassContext(config=config, instruments=[counter]):
+        actual = tvm.tirx.transform.StmtSimplify()(mod)
+
+    assert counter.num_runs == 1
+    assert [gv.name_hint for gv in actual.functions] == [gv.name_hint for gv in expected.functions]
+    tvm.ir.assert_structural_equal(actual, expected)
+
+
+def test_thread_safe_pass_cache():
+    x = tvm.tirx.Var("x", "int32")
+    func = tvm.tirx.PrimFunc([x], tvm.tirx.Evaluate(x * 1 + 2 - 2))
+    mod = tvm.IRModule({"main": func})
+    expected = tvm.tirx.transform.StmtSimplify()(mod)
+
+    temp = utils.tempdir()
+    config = {"ir.pass_cache_dir": temp.path}
+    results = []
+    for _ in range(2):
+        cache_inst = tvm.instrument.PassCacheInstrument()
+        with tvm.transform.PassContext(config=config, instruments=[cache_inst]):
+            actual = tvm.tirx.transform.StmtSimplify()(mod)
+            results.append(cache_inst.render())
+        tvm.ir.assert_structural_equal(actual, expected)
+
+    assert "tirx.StmtSimplify: 0/1 hits" in results[0]
+    assert "tirx.StmtSimplify: 1/1 hits" in results[1]
+
+
 if __name__ == "__main__":
     test_cow_pass()
     test_prim_func_pass()
+    test_thread_safe_pass_on_threads()
+    test_thread_safe_pass_cache()
@@ -635,5 +635,114 @@ def test_bind_before_thread_extent():
     tvm.ir.assert_structural_equal(After, Expected)
 
 
+
+def _coalesce(mod, **config):
+    config = {"tirx.SplitHostDevice": {"coalesce_kernels": True, **config}}
+    with tvm.transform.PassContext(config=config):
+        return tvm.tirx.transform.SplitHostDevice()(mod)
+
+
+def _kernel_info(func):
+    """The thread extents of a kernel and the intrinsics it calls"""
+    extents = {}
+    ops = set()
+
+    def fvisit(node):
+        if isinstance(node, tvm.tirx.AttrStmt) and node.attr_key == "thread_extent":
+            extents[node.node.thread_tag] = node.value
+        elif isinstance(node, tvm.tirx.Call) and isinstance(node.op, tvm.ir.Op):
+            ops.add(node.op.name)
+
+    tvm.tirx.stmt_functor.post_order_visit(func.body, fvisit)
+    return extents, ops
+
+
+def _kernel_names(mod):
+    return sorted(gvar.name_hint for gvar in mod.functions if gvar.name_hint != "main")
+
+
+def test_coalesce_independent_kernels():
+    """Independent device regions are merged into one kernel, dispatched by block"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(
+            A: T.Buffer(128, "float32"), B: T.Buffer(128, "float32"), C: T.Buffer(64, "float32")
+        ):
+            T.func_attr({"target": T.target("cuda", host="llvm")})
+            with T.launch_thread("blockIdx.x", 4) as bx:
+                tx = T.launch_thread("threadIdx.x", 32)
+                B[bx * 32 + tx] = A[bx * 32 + tx] * 2.0
+            with T.launch_thread("blockIdx.x", 2) as bx:
+                tx = T.launch_thread("threadIdx.x", 32)
+                C[bx * 32 + tx] = A[bx * 32 + tx] + 1.0
+
+    assert _kernel_names(tvm.tirx.transform.SplitHostDevice()(Before)) == [
+        "main_kernel",
+        "main_kernel_1",
+    ]
+
+    After = _coalesce(Before)
+    tvm.tirx.analysis.verify_well_formed(After)
+    assert _kernel_names(After) == ["main_kernel"]
+    kernel = After["main_kernel"]
+    assert list(kernel.attrs["tirx.kernel_launch_params"]) == ["blockIdx.x", "threadIdx.x"]
+    extents, _ = _kernel_info(kernel)
+    assert extents["blockIdx.x"].value == 6
+    assert extents["threadIdx.x"].value == 32
+
+
+def test_coalesce_dependent_kernels_with_grid_sync():
+    """Dependent device regions are merged into a persistent cooperative kernel"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(
+            A: T.Buffer(128, "float32"), B: T.Buffer(128, "float32"), C: T.Buffer(64, "float32")
+        ):
+            T.func_attr({"target": T.target("cuda", host="llvm")})
+            with T.launch_thread("blockIdx.x", 4) as bx:
+                tx = T.launch_thread("threadIdx.x", 32)
+                B[bx * 32 + tx] = A[bx * 32 + tx] * 2.0
+            with T.launch_thread("blockIdx.x", 2) as bx:
+                tx = T.launch_thread("threadIdx.x", 32)
+                C[bx * 32 + tx] = B[bx * 64 + tx] + B[bx * 64 + tx + 32]
+
+    # Without the number of co-resident blocks, the dependent regions stay apart.
+    assert _kernel_names(_coalesce(Before)) == ["main_kernel", "main_kernel_1"]
+
+    After = _coalesce(Before, grid_sync_blocks=3)
+    tvm.tirx.analysis.verify_well_formed(After)
+    assert _kernel_names(After) == ["main_kernel"]
+    kernel = After["main_kernel"]
+    assert list(kernel.attrs["tirx.kernel_launch_params"]) == [
+        "blockIdx.x",
+        "threadIdx.x",
+        "tirx.use_cooperative_launch",
+    ]
+    extents, ops = _kernel_info(kernel)
+    assert extents["blockIdx.x"].value == 3
+    assert "tirx.cuda.grid_sync" in ops
+
+
+def test_coalesce_requires_matching_thread_extents():
+    """Device regions with different thread extents are not merged"""
+
+    @I.ir_module
+    class Before:
+        @T.prim_func(s_tir=True)
+        def main(A: T.Buffer(128, "float32"), B: T.Buffer(128, "float32")):
+            T.func_attr({"target": T.target("cuda", host="llvm")})
+            with T.launch_thread("blockIdx.x", 4) as bx:
+                tx = T.launch_thread("threadIdx.x", 32)
+                A[bx * 32 + tx] = 0.0
+            with T.launch_thread("blockIdx.x", 2) as bx:
+                tx = T.launch_thread("threadIdx.x", 64)
+                B[bx * 64 + tx] = 0.0
+
+    assert _kernel_names(_coalesce(Before)) == ["main_kernel", "main_kernel_1"]
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -757,6 +757,72 @@ def test_vectorize_and_predicate_buffer_load_stores_with_sve_attr_scope_target()
     tvm.ir.assert_structural_equal(after, expected)
 
 
+@pytest.mark.parametrize("extent", [16, "n"])
+def test_vectorize_scalable_with_predicated_tail(extent):
+    # With scalable vectorization enabled, a fixed or symbolic extent is split into chunks of
+    # vscale-multiple lanes, and the guard of the tail becomes a buffer-level predicate.
+    n = tvm.tirx.Var("n", "int32") if extent == "n" else extent
+
+    @T.prim_func(s_tir=True)
+    def before(a: T.handle, b: T.handle):
+        A = T.match_buffer(a, (n,), "float32")
+        B = T.match_buffer(b, (n,), "float32")
+        T.func_attr({"global_symbol": "main", "tirx.noalias": True})
+        for i in T.vectorized(n):
+            B[i] = A[i] + 1.0
+
+    mod = tvm.IRModule.from_expr(before)
+    with tvm.transform.PassContext(config={"tirx.vectorize_scalable": True}):
+        with tvm.target.Target(sve_target):
+            after = tvm.tirx.transform.VectorizeLoop()(mod)["main"]
+
+    stores = []
+
+    def fvisit(node):
+        if isinstance(node, tvm.tirx.BufferStore):
+            stores.append(node)
+
+    tvm.tirx.stmt_functor.post_order_visit(after.body, fvisit)
+    assert len(stores) == 1
+    assert stores[0].value.dtype == "float32xvscalex4"
+    assert stores[0].predicate is not None
+
+
+@pytest.mark.parametrize("extent", [4097, "n"])
+def test_vectorize_masked_tail(extent):
+    # With masked tails, an extent that is not a multiple of the AVX-512 width is split into
+    # full-width chunks, and the last one uses masked loads and stores instead of scalar code.
+    n = tvm.tirx.Var("n", "int32") if extent == "n" else extent
+
+    @T.prim_func(s_tir=True)
+    def before(a: T.handle, b: T.handle):
+        A = T.match_buffer(a, (n,), "float32")
+        B = T.match_buffer(b, (n,), "float32")
+        T.func_attr({"global_symbol": "main", "tirx.noalias": True})
+        for i in T.vectorized(n):
+            B[i] = A[i] + 1.0
+
+    mod = tvm.IRModule.from_expr(before)
+    with tvm.transform.PassContext(config={"tirx.vectorize_masked_tail": True}):
+        with tvm.target.Target("llvm -mtriple=x86_64-linux-gnu -mcpu=skylake-avx512"):
+            after = tvm.tirx.transform.VectorizeLoop()(mod)["main"]
+
+    stores = []
+    loads = []
+
+    def fvisit(node):
+        if isinstance(node, tvm.tirx.BufferStore):
+            stores.append(node)
+        elif isinstance(node, tvm.tirx.BufferLoad):
+            loads.append(node)
+
+    tvm.tirx.stmt_functor.post_order_visit(after.body, fvisit)
+    assert len(stores) == 1 and len(loads) == 1
+    assert stores[0].value.dtype == "float32x16"
+    assert stores[0].predicate is not None
+    assert loads[0].predicate is not None
+
+
 @pytest.mark.parametrize(
     "extent, vec_str, target",
     [(4, "float32x4", simple_target)],
@@ -38,6 +38,7 @@
 #include "src/runtime/file_utils.cc"
 #include "src/runtime/logging.cc"
 #include "src/runtime/rpc/rpc_channel.cc"
+#include "src/runtime/rpc/rpc_compression.cc"
 #include "src/runtime/rpc/rpc_endpoint.cc"
 #include "src/runtime/rpc/rpc_event_impl.cc"
 #include "src/runtime/rpc/rpc_local_session.cc"
@@ -77,6 +78,12 @@
 
 // --- Implementations of backend and wasm runtime API. ---
 
+#ifdef __EMSCRIPTEN_PTHREADS__
+// With -pthread, emscripten runs std::thread on Web Workers that share the wasm memory
+// through a SharedArrayBuffer, so the parallel loops use the native thread pool.
+#include "src/runtime/thread_pool.cc"
+#include "src/runtime/threading_backend.cc"
+#else
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
   TVMParallelGroupEnv env;
   env.num_task = 1;
@@ -85,6 +92,7 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
 }
 
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) { return 0; }
+#endif
 
 // --- Environment ffi::Functions for testing ---
 namespace tvm {
@@ -17,9 +17,13 @@
  * under the License.
  */
 
-import { OPFSStore, type OPFSAccessMode } from "./opfs_store";
+import {
+  OPFSStore,
+  type OPFSAccessMode,
+  type OPFSChunkCallback,
+} from "./opfs_store";
 
-export type { OPFSAccessMode } from "./opfs_store";
+export type { OPFSAccessMode, OPFSChunkCallback } from "./opfs_store";
 
 export interface TensorCacheEntry {
   name: string;
@@ -85,6 +89,23 @@ export interface ArtifactCacheTemplate {
     * Note: This is an async function.
    */
   deleteInCache(url: string): Promise<void>;
+
+  /**
+   * Optional. Pass the data of `url` to `onChunk` in order while it is fetched and added to the
+   * cache, so that the consumer does not wait for the whole download. A cached url is passed
+   * from the cache.
+   *
+   * @param url The url to the data to be cached.
+   * @param onChunk Receives each chunk with its byte offset; the next chunk waits for its promise.
+   * @param signal An optional AbortSignal to abort data retrival.
+   *
+   * Note: This is an async function.
+   */
+  fetchStreamWithCache?(
+    url: string,
+    onChunk: OPFSChunkCallback,
+    signal?: AbortSignal,
+  ): Promise<void>;
 }
 
 export type ArtifactCacheType = "cache" | "indexeddb" | "cross-origin" | "opfs";
@@ -599,6 +620,34 @@ export class ArtifactIndexedDBCache implements ArtifactCacheTemplate {
   }
 }
 
+/**
+ * Pass the body of the response to `onChunk` in order, from byte `offset`.
+ */
+async function streamResponse(
+  response: Response,
+  onChunk: OPFSChunkCallback,
+  offset: number,
+): Promise<number> {
+  if (response.body === null) {
+    const payload = new Uint8Array(await response.arrayBuffer());
+    await onChunk(payload, offset);
+    return offset + payload.byteLength;
+  }
+  const reader = response.body.getReader();
+  try {
+    while (true) {
+      const { done, value } = await reader.read();
+      if (done) {
+        return offset;
+      }
+      await onChunk(value, offset);
+      offset += value.byteLength;
+    }
+  } finally {
+    reader.releaseLock();
+  }
+}
+
 /**
  * Cache by Origin Private File System (OPFS).
  */
@@ -653,17 +702,81 @@ export class ArtifactOPFSCache implements ArtifactCacheTemplate {
     if (await this.store.has(url)) {
       return;
     }
-    const request = new Request(
-      url,
-      signal ? { ...DEFAULT_FETCH_OPTIONS, signal } : DEFAULT_FETCH_OPTIONS,
-    );
+    await this.fetchIntoStore(url, signal);
+  }
+
+  async fetchStreamWithCache(
+    url: string,
+    onChunk: OPFSChunkCallback,
+    signal?: AbortSignal,
+  ): Promise<void> {
+    const cached = await this.store.read(url);
+    if (cached !== undefined) {
+      await streamResponse(cached, onChunk, 0);
+      return;
+    }
+    await this.fetchIntoStore(url, signal, onChunk);
+  }
+
+  /**
+   * Download `url` into the store, resuming from the bytes of an interrupted download when the
+   * server answers the range request for the same version of the data.
+   */
+  private async fetchIntoStore(
+    url: string,
+    signal?: AbortSignal,
+    onChunk?: OPFSChunkCallback,
+  ): Promise<void> {
+    const partial = await this.store.readPartial(url);
+    let response: Response | undefined;
+    if (partial !== undefined) {
+      const offset = partial.payload.size;
+      try {
+        response = await this.fetchResponse(url, signal, {
+          Range: `bytes=${offset}-`,
+          "If-Range": partial.validator,
+        });
+      } catch (err) {
+        if (signal?.aborted) {
+          throw err;
+        }
+        // e.g. 416 when the stored bytes are not a prefix of the data anymore.
+        response = undefined;
+      }
+      const contentRange = response?.headers.get("content-range") ?? "";
+      if (response?.status === 206 && contentRange.startsWith(`bytes ${offset}-`)) {
+        if (onChunk !== undefined) {
+          await streamResponse(new Response(partial.payload), onChunk, 0);
+        }
+        await this.store.writeStream(url, response, offset, onChunk);
+        return;
+      }
+      if (response !== undefined && response.status !== 200) {
+        await response.body?.cancel();
+        response = undefined;
+      }
+    }
+    response = response ?? (await this.fetchResponse(url, signal));
+    await this.store.writeStream(url, response, 0, onChunk);
+  }
+
+  private async fetchResponse(
+    url: string,
+    signal?: AbortSignal,
+    headers?: Record<string, string>,
+  ): Promise<Response> {
+    const request = new Request(url, {
+      ...DEFAULT_FETCH_OPTIONS,
+      ...(signal ? { signal } : {}),
+      ...(headers ? { headers } : {}),
+    });
     const response = await fetch(request);
     if (!response.ok) {
       throw new Error(
         `ArtifactOPFSCache: Unable to fetch ${url}, received status ${response.status}`,
       );
     }
-    await this.store.write(url, response);
+    return response;
   }
 
   async hasAllKeys(keys: string[]): Promise<boolean> {
@@ -24,12 +24,16 @@ type OPFSSyncAccessHandleMode = "read-only" | "readwrite";
 
 interface OPFSWritableFileStream extends WritableStream<Uint8Array> {
   write(value: Blob | BufferSource | Uint8Array | string): Promise<void>;
+  seek(position: number): Promise<void>;
+  truncate(size: number): Promise<void>;
   close(): Promise<void>;
 }
 
 interface OPFSFileHandle {
   getFile(): Promise<Blob>;
-  createWritable(): Promise<OPFSWritableFileStream>;
+  createWritable(options?: {
+    keepExistingData?: boolean;
+  }): Promise<OPFSWritableFileStream>;
   createSyncAccessHandle?: (options?: {
     mode?: OPFSSyncAccessHandleMode;
   }) => Promise<OPFSSyncAccessHandle>;
@@ -57,6 +61,24 @@ interface OPFSStoreRecord {
   contentType?: string;
 }
 
+/**
+ * The response an incomplete payload comes from, kept until the payload is complete.
+ * `validator` is the ETag or Last-Modified header of the response.
+ */
+interface OPFSPartialRecord {
+  url: string;
+  validator: string;
+}
+
+/**
+ * Receives the bytes of a payload in order. `offset` is the byte offset of `chunk` in the
+ * payload, and the next chunk is only read once the returned promise resolves.
+ */
+export type OPFSChunkCallback = (
+  chunk: Uint8Array,
+  offset: number,
+) => void | Promise<void>;
+
 interface OPFSStoredEntry {
   payloadHandle: OPFSFileHandle;
   record: OPFSStoreRecord;
@@ -162,6 +184,63 @@ export class OPFSStore {
   }
 
   async write(url: string, response: Response): Promise<void> {
+    await this.writeStream(url, response, 0);
+  }
+
+  /**
+   * Get the bytes of an interrupted write of `url`, and the validator of the response they
+   * come from, so that the download can resume with a range request.
+   */
+  async readPartial(
+    url: string,
+  ): Promise<{ payload: Blob; validator: string } | undefined> {
+    try {
+      const directory = await this.getScopedDirectory();
+      const baseName = await this.hashUrl(url);
+      const partialHandle = await this.getFileHandleIfExists(
+        directory,
+        this.getPartialFilename(baseName),
+        false,
+      );
+      if (partialHandle === undefined) {
+        return undefined;
+      }
+      const partial = await this.readPartialRecord(partialHandle);
+      if (partial === undefined || partial.url !== url) {
+        return undefined;
+      }
+      const payloadHandle = await this.getFileHandleIfExists(
+        directory,
+        this.getPayloadFilename(baseName),
+        false,
+      );
+      if (payloadHandle === undefined) {
+        return undefined;
+      }
+      const payload = await payloadHandle.getFile();
+      return payload.size > 0
+        ? { payload, validator: partial.validator }
+        : undefined;
+    } catch (err) {
+      if (this.handleCacheMissStateError(err)) {
+        return undefined;
+      }
+      throw err;
+    }
+  }
+
+  /**
+   * Write the body of `response` from byte `offset` of the payload of `url`, keeping the
+   * stored bytes before it, and pass the written chunks to `onChunk`. The payload can only be
+   * read once the whole body is written. Until then, the validator of the response is kept, so
+   * that an interrupted write can be resumed by `readPartial`.
+   */
+  async writeStream(
+    url: string,
+    response: Response,
+    offset: number,
+    onChunk?: OPFSChunkCallback,
+  ): Promise<void> {
     try {
       const directory = await this.getScopedDirectory();
       const baseName = await this.hashUrl(url);
@@ -169,11 +248,31 @@ export class OPFSStore {
         directory,
         this.getRecordFilename(baseName),
       );
+      const validator =
+        response.headers.get("etag") ?? response.headers.get("last-modified");
+      if (validator !== null) {
+        const partialHandle = await directory.getFileHandle(
+          this.getPartialFilename(baseName),
+          { create: true },
+        );
+        const partial: OPFSPartialRecord = { url, validator };
+        await this.writeJSON(partialHandle, partial);
+      } else {
+        await this.removeEntryIfExists(
+          directory,
+          this.getPartialFilename(baseName),
+        );
+      }
       const payloadHandle = await directory.getFileHandle(
         this.getPayloadFilename(baseName),
         { create: true },
       );
-      const nbytes = await this.writePayload(payloadHandle, response);
+      const nbytes = await this.writePayload(
+        payloadHandle,
+        response,
+        offset,
+        onChunk,
+      );
       const recordHandle = await directory.getFileHandle(
         this.getRecordFilename(baseName),
         { create: true },
@@ -183,7 +282,11 @@ export class OPFSStore {
         nbytes,
         contentType: response.headers.get("content-type") ?? undefined,
       };
-      await this.writeRecord(recordHandle, record);
+      await this.writeJSON(recordHandle, record);
+      await this.removeEntryIfExists(
+        directory,
+        this.getPartialFilename(baseName),
+      );
     } catch (err) {
       this.resetDirectoryOnInvalidStateError(err);
       throw err;
@@ -202,6 +305,10 @@ export class OPFSStore {
         directory,
         this.getRecordFilename(baseName),
       );
+      await this.removeEntryIfExists(
+        directory,
+        this.getPartialFilename(baseName),
+      );
     } catch (err) {
       this.resetDirectoryOnInvalidStateError(err);
       throw err;
@@ -311,6 +418,32 @@ export class OPFSStore {
     }
   }
 
+  private async readPartialRecord(
+    fileHandle: OPFSFileHandle,
+  ): Promise<OPFSPartialRecord | undefined> {
+    try {
+      const parsed = JSON.parse(await (await fileHandle.getFile()).text());
+      if (
+        parsed === undefined ||
+        parsed === null ||
+        typeof parsed !== "object" ||
+        typeof parsed.url !== "string" ||
+        typeof parsed.validator !== "string"
+      ) {
+        return undefined;
+      }
+      return { url: parsed.url, validator: parsed.validator };
+    } catch (err) {
+      if (
+        OPFSStore.getErrorName(err) === "SyntaxError" ||
+        this.handleCacheMissStateError(err)
+      ) {
+        return undefined;
+      }
+      throw err;
+    }
+  }
+
   private getResponseInit(
     record: OPFSStoreRecord,
   ): ResponseInit | undefined {
@@ -319,9 +452,9 @@ export class OPFSStore {
       : undefined;
   }
 
-  private async writeRecord(
+  private async writeJSON(
     handle: OPFSFileHandle,
-    record: OPFSStoreRecord,
+    record: OPFSStoreRecord | OPFSPartialRecord,
   ): Promise<void> {
     const writable = await handle.createWritable();
     try {
@@ -367,22 +500,37 @@ export class OPFSStore {
   private async writePayload(
     handle: OPFSFileHandle,
     response: Response,
+    offset: number,
+    onChunk?: OPFSChunkCallback,
   ): Promise<number> {
     const syncHandle = await this.openSyncAccessHandle(handle, "readwrite");
     if (syncHandle !== undefined) {
-      return this.writePayloadWithSyncHandle(syncHandle, response);
+      return this.writePayloadWithSyncHandle(
+        syncHandle,
+        response,
+        offset,
+        onChunk,
+      );
     }
-    return this.writePayloadWithWritable(handle, response);
+    return this.writePayloadWithWritable(handle, response, offset, onChunk);
   }
 
   private async writePayloadWithWritable(
     handle: OPFSFileHandle,
     response: Response,
+    offset: number,
+    onChunk?: OPFSChunkCallback,
   ): Promise<number> {
-    const writable = await handle.createWritable();
+    const writable = await handle.createWritable({
+      keepExistingData: offset > 0,
+    });
     try {
+      if (offset > 0) {
+        await writable.truncate(offset);
+        await writable.seek(offset);
+      }
+      let nbytes = offset;
       if (response.body !== null) {
-        let nbytes = 0;
         const reader = response.body.getReader();
         try {
           while (true) {
@@ -391,6 +539,7 @@ export class OPFSStore {
               break;
             }
             await writable.write(value);
+            await onChunk?.(value, nbytes);
             nbytes += value.byteLength;
           }
         } finally {
@@ -399,13 +548,15 @@ export class OPFSStore {
         await writable.close();
         return nbytes;
       }
-      const payload = await response.arrayBuffer();
+      const payload = new Uint8Array(await response.arrayBuffer());
       await writable.write(payload);
       await writable.close();
-      return payload.byteLength;
+      await onChunk?.(payload, nbytes);
+      return nbytes + payload.byteLength;
     } catch (err) {
       try {
-        await writable.abort();
+        // Commit the written prefix, which `readPartial` resumes from.
+        await writable.close();
       } catch {
         // Preserve the original write error.
       }
@@ -429,10 +580,12 @@ export class OPFSStore {
   private async writePayloadWithSyncHandle(
     syncHandle: OPFSSyncAccessHandle,
     response: Response,
+    start: number,
+    onChunk?: OPFSChunkCallback,
   ): Promise<number> {
     try {
-      syncHandle.truncate(0);
-      let offset = 0;
+      syncHandle.truncate(start);
+      let offset = start;
       if (response.body !== null) {
         const reader = response.body.getReader();
         try {
@@ -442,15 +595,17 @@ export class OPFSStore {
               break;
             }
             syncHandle.write(value, { at: offset });
+            await onChunk?.(value, offset);
             offset += value.byteLength;
           }
         } finally {
           reader.releaseLock();
         }
       } else {
-        const payload = await response.arrayBuffer();
-        syncHandle.write(new Uint8Array(payload), { at: 0 });
-        offset = payload.byteLength;
+        const payload = new Uint8Array(await response.arrayBuffer());
+        syncHandle.write(payload, { at: offset });
+        await onChunk?.(payload, offset);
+        offset += payload.byteLength;
       }
       syncHandle.flush();
       return offset;
@@ -568,6 +723,10 @@ export class OPFSStore {
     return `${baseName}.record.json`;
   }
 
+  private getPartialFilename(baseName: string): string {
+    return `${baseName}.partial.json`;
+  }
+
   private createSyncUnavailableError(): Error {
     const err = new Error(
       "OPFSStore: createSyncAccessHandle unavailable; sync OPFS access requires a supported dedicated worker context.",
@@ -37,6 +37,7 @@ import {
   ArtifactCacheTemplate,
   ArtifactCacheType,
   TensorCacheAccessOptions,
+  TensorCacheEntry,
   TensorShardEntry,
   createArtifactCache,
 } from "./artifact_cache";
@@ -1374,6 +1375,34 @@ export class Instance implements Disposable {
       });
     }
 
+    // Caches that stream upload every record as soon as its bytes arrive, instead of
+    // waiting for all shards to be downloaded.
+    if (artifactCache.fetchStreamWithCache !== undefined) {
+      const streamShards = async (start: number, end: number) => {
+        for (let i = start; i < end; i++) {
+          const shard = list[i];
+          const dataUrl = new URL(shard.dataPath, tensorCacheUrl).href;
+          try {
+            await this.streamTensorShard(shard, dataUrl, device, artifactCache, signal);
+          } catch (err) {
+            this.env.logger("Error: Cannot fetch " + dataUrl + " err= " + err);
+            throw err;
+          }
+          timeElapsed = Math.ceil((perf.now() - tstart) / 1000);
+          fetchedBytes += shard.nbytes;
+          reportCallback(++fetchedShards, /*loading=*/cacheOnly);
+        }
+      };
+      const loopSize = Math.floor(list.length / 4);
+      await Promise.all([
+        streamShards(0, loopSize),
+        streamShards(loopSize, 2 * loopSize),
+        streamShards(2 * loopSize, 3 * loopSize),
+        streamShards(3 * loopSize, list.length)
+      ]);
+      return;
+    }
+
     // First download all shards to cache parallely if not yet in cache
     const downloadCache = async (start: number, end: number) => {
       // Download params [start, end) from `list`
@@ -1419,40 +1448,9 @@ export class Instance implements Disposable {
       }
       const shardRecords = shard.records;
       for (let j = 0; j < shardRecords.length; ++j) {
-        try {
-          const rec = shardRecords[j];
-          const cpu_arr = this.withNewScope(() => {
-            return this.detachFromCurrentScope(
-              this.empty(rec.shape, rec.dtype, this.cpu())
-            )
-          });
-          const recSource = buffer.slice(rec.byteOffset, rec.byteOffset + rec.nbytes);
-          // first sync copy to cpu.
-          this.ctx.arrayDecodeStorage(cpu_arr, new Uint8Array(recSource), rec.format, rec.dtype);
-          // then async stream into GPU if needed
-          if (device.deviceType === DeviceStrToEnum.cpu) {
-            this.tensorCacheUpdate(rec.name, cpu_arr, false);
-            cpu_arr.dispose();
-          } else {
-            // allocate a gpu arr and async copy to it.
-            const gpu_arr = this.withNewScope(() => {
-              return this.detachFromCurrentScope(
-                this.empty(rec.shape, rec.dtype, device)
-              )
-            });
-            gpu_arr.copyFrom(cpu_arr);
-            await device.sync();
-            this.tensorCacheUpdate(rec.name, gpu_arr, false);
-            cpu_arr.dispose();
-            gpu_arr.dispose();
-          }
-        } catch (err) {
-          this.env.logger(
-            "Failed to load shard " + i + "'s record: " + JSON.stringify(shardRecords[j]) + "\n" +
-            "Error: " + err
-          );
-          throw err;
-        }
+        const rec = shardRecords[j];
+        const recSource = buffer.slice(rec.byteOffset, rec.byteOffset + rec.nbytes);
+        await this.loadTensorRecord(rec, new Uint8Array(recSource), device, i);
       }
       fetchedBytes += shard.nbytes;
       timeElapsed = Math.ceil((perf.now() - tstart) / 1000);
@@ -1460,6 +1458,98 @@ export class Instance implements Disposable {
     }
   }
 
+  /**
+   * Stream a shard from the artifact cache, and load each of its records onto the device once
+   * its bytes have arrived.
+   *
+   * @param shard The shard entry.
+   * @param dataUrl The url of the shard data.
+   * @param device The device to store the data to.
+   * @param artifactCache The artifact cache, which supports streaming.
+   * @param signal An optional AbortSignal to abort the fetch
+   */
+  private async streamTensorShard(
+    shard: TensorShardEntry,
+    dataUrl: string,
+    device: DLDevice,
+    artifactCache: ArtifactCacheTemplate,
+    signal?: AbortSignal,
+  ) {
+    const staging = new Uint8Array(shard.nbytes);
+    const records = [...shard.records].sort((a, b) => a.byteOffset - b.byteOffset);
+    let next = 0;
+    let received = 0;
+    const loadReady = async () => {
+      while (next < records.length &&
+             records[next].byteOffset + records[next].nbytes <= received) {
+        const rec = records[next++];
+        await this.loadTensorRecord(
+          rec, staging.subarray(rec.byteOffset, rec.byteOffset + rec.nbytes), device, dataUrl);
+      }
+    };
+    await artifactCache.fetchStreamWithCache!(dataUrl, async (chunk, offset) => {
+      if (offset + chunk.byteLength > staging.byteLength) {
+        throw new Error(
+          "Shard " + dataUrl + " has more than the " + shard.nbytes + " bytes of its entry");
+      }
+      staging.set(chunk, offset);
+      received = offset + chunk.byteLength;
+      await loadReady();
+    }, signal);
+    if (next !== records.length) {
+      throw new Error(
+        "Shard " + dataUrl + " ended after " + received + " of its " + shard.nbytes + " bytes");
+    }
+  }
+
+  /**
+   * Decode a record of a shard and load it into the tensor cache on the device.
+   *
+   * @param rec The record entry.
+   * @param bytes The bytes of the record.
+   * @param device The device to store the data to.
+   * @param shard The shard index or url, for the error message.
+   */
+  private async loadTensorRecord(
+    rec: TensorCacheEntry,
+    bytes: Uint8Array,
+    device: DLDevice,
+    shard: number | string,
+  ) {
+    try {
+      const cpu_arr = this.withNewScope(() => {
+        return this.detachFromCurrentScope(
+          this.empty(rec.shape, rec.dtype, this.cpu())
+        )
+      });
+      // first sync copy to cpu.
+      this.ctx.arrayDecodeStorage(cpu_arr, bytes, rec.format, rec.dtype);
+      // then async stream into GPU if needed
+      if (device.deviceType === DeviceStrToEnum.cpu) {
+        this.tensorCacheUpdate(rec.name, cpu_arr, false);
+        cpu_arr.dispose();
+      } else {
+        // allocate a gpu arr and async copy to it.
+        const gpu_arr = this.withNewScope(() => {
+          return this.detachFromCurrentScope(
+            this.empty(rec.shape, rec.dtype, device)
+          )
+        });
+        gpu_arr.copyFrom(cpu_arr);
+        await device.sync();
+        this.tensorCacheUpdate(rec.name, gpu_arr, false);
+        cpu_arr.dispose();
+        gpu_arr.dispose();
+      }
+    } catch (err) {
+      this.env.logger(
+        "Failed to load shard " + shard + "'s record: " + JSON.stringify(rec) + "\n" +
+        "Error: " + err
+      );
+      throw err;
+    }
+  }
+
   /**
    * Create a new {@link Scalar} that can be passed to a PackedFunc.
    * @param value The number value.
@@ -405,6 +405,20 @@ export interface FunctionInfo {
   launch_param_tags: Array<string>;
 }
 
+/**
+ * A compute pipeline shared by the shaders whose WGSL only differs in the entry point name.
+ */
+interface ComputePipelineEntry {
+  bindGroupLayout: GPUBindGroupLayout;
+  pipelineLayout: GPUPipelineLayout;
+  shaderModule: GPUShaderModule;
+  // The entry point name of the shader the pipeline is created for.
+  entryPoint: string;
+  pipeline?: GPUComputePipeline;
+  // The pending createComputePipelineAsync while the pipeline is being created.
+  pendingPipeline?: Promise<GPUComputePipeline>;
+}
+
 /**
  * WebGPU context
  * Manages all the webgpu resources here.
@@ -434,6 +448,11 @@ export class WebGPUContext {
   private uniformBufferPool: Array<GPUBuffer> = [];
   private uniformBufferPoolSizes: Array<number> = [];
   private pendingDispatchCount = 0;
+  // Compute pipelines keyed by the bind group layout and the WGSL with the entry point name
+  // normalized, so that structurally identical kernels are compiled once.
+  private computePipelineCache: Map<string, ComputePipelineEntry> = new Map();
+  // number of shaders which reused a cached compute pipeline
+  private computePipelineCacheHits = 0;
   // flags for debugging
   // stats of the runtime.
   // peak allocation
@@ -520,6 +539,7 @@ export class WebGPUContext {
     let info = "peak-memory=" + Math.ceil(this.peakAllocatedBytes / (1 << 20)) + " MB";
     info += ", all-memory=" + Math.ceil(this.allAllocatedBytes / (1 << 20)) + " MB";
     info += ", shader-submissions=" + this.shaderSubmitCounter;
+    info += ", shared-pipelines=" + this.computePipelineCacheHits;
     return info;
   }
 
@@ -704,12 +724,8 @@ export class WebGPUContext {
       }
     });
 
-    const bindGroupLayout = this.device.createBindGroupLayout({
-      entries: layoutEntries
-    });
-    const pipelineLayout = this.device.createPipelineLayout({
-      bindGroupLayouts: [bindGroupLayout]
-    });
+    const entry = this.getComputePipelineEntry(finfo, code, layoutEntries);
+    const bindGroupLayout = entry.bindGroupLayout;
 
     // Function to create the pipeline.
     const createShaderFunc = (pipeline: GPUComputePipeline): Function => {
@@ -823,36 +839,83 @@ export class WebGPUContext {
       return submitShader;
     };
 
+    const pipelineDescriptor: GPUComputePipelineDescriptor = {
+      layout: entry.pipelineLayout,
+      compute: {
+        module: entry.shaderModule,
+        entryPoint: entry.entryPoint
+      }
+    };
+    if (entry.pipeline !== undefined) {
+      const func = createShaderFunc(entry.pipeline);
+      return asyncMode ? Promise.resolve(func) : func;
+    }
+    if (asyncMode) {
+      if (entry.pendingPipeline === undefined) {
+        entry.pendingPipeline = this.device.createComputePipelineAsync(pipelineDescriptor)
+          .then((pipeline: GPUComputePipeline) => {
+            entry.pipeline = pipeline;
+            entry.pendingPipeline = undefined;
+            return pipeline;
+          });
+      }
+      return entry.pendingPipeline.then((pipeline: GPUComputePipeline) => {
+        return createShaderFunc(pipeline);
+      });
+    } else {
+      entry.pipeline = this.device.createComputePipeline(pipelineDescriptor);
+      return createShaderFunc(entry.pipeline);
+    }
+  }
+
+  /**
+   * Get the compute pipeline entry of the shader, creating its shader module if no
+   * structurally identical shader has been created before.
+   *
+   * Kernels generated for different functions often have the same WGSL except for the
+   * name of the entry point, e.g. the same fused elementwise op applied at several places
+   * of a model, and can share a single pipeline.
+   *
+   * @param finfo The function information already parsed as a record.
+   * @param code The shader data(in WGSL)
+   * @param layoutEntries The entries of the bind group layout of the shader.
+   * @returns The compute pipeline entry.
+   */
+  private getComputePipelineEntry(
+    finfo: FunctionInfo,
+    code: string,
+    layoutEntries: Array<GPUBindGroupLayoutEntry>
+  ): ComputePipelineEntry {
+    const normalizedCode = code.replace(new RegExp("\\b" + finfo.name + "\\b", "g"), "__entry__");
+    const key = JSON.stringify(layoutEntries) + "\n" + normalizedCode;
+    const cached = this.computePipelineCache.get(key);
+    if (cached !== undefined) {
+      this.computePipelineCacheHits += 1;
+      return cached;
+    }
+    const bindGroupLayout = this.device.createBindGroupLayout({
+      entries: layoutEntries
+    });
+    const pipelineLayout = this.device.createPipelineLayout({
+      bindGroupLayouts: [bindGroupLayout]
+    });
     const shaderModule = this.device.createShaderModule({
       code: code,
       compilationHints: [
         {
-          entryPoint: "main",
+          entryPoint: finfo.name,
           layout: pipelineLayout
         }
       ]
     });
-
-    if (asyncMode) {
-      return this.device.createComputePipelineAsync({
-        layout: pipelineLayout,
-        compute: {
-          module: shaderModule,
-          entryPoint: finfo.name
-        }
-      }).then((pipeline: GPUComputePipeline) => {
-        return createShaderFunc(pipeline);
-      });
-    } else {
-      const pipeline = this.device.createComputePipeline({
-        layout: pipelineLayout,
-        compute: {
-          module: shaderModule,
-          entryPoint: finfo.name
-        }
-      });
-      return createShaderFunc(pipeline);
-    }
+    const entry: ComputePipelineEntry = {
+      bindGroupLayout: bindGroupLayout,
+      pipelineLayout: pipelineLayout,
+      shaderModule: shaderModule,
+      entryPoint: finfo.name
+    };
+    this.computePipelineCache.set(key, entry);
+    return entry;
   }
 
   /**